@@ -0,0 +1,216 @@
+#!/bin/sh
+
+# -----------------------------------------------------------------------
+#  Copyright (c) 2010-2013, Plausible Labs Cooperative, Inc.
+#
+#  Permission is hereby granted, free of charge, to any person obtaining
+#  a copy of this software and associated documentation files (the
+#  ``Software''), to deal in the Software without restriction, including
+#  without limitation the rights to use, copy, modify, merge, publish,
+#  distribute, sublicense, and/or sell copies of the Software, and to
+#  permit persons to whom the Software is furnished to do so, subject to
+#  the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included
+#  in all copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED ``AS IS'', WITHOUT WARRANTY OF ANY KIND,
+#  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+#  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+#  NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+#  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+#  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+#  DEALINGS IN THE SOFTWARE.
+#  -----------------------------------------------------------------------
+
+# Run plcrashutil's commands against a checked-in crash report, verifying their output.
+#
+# Usage: run-tests.sh <plcrashutil> <report.plcrash>
+
+PLCRASHUTIL="$1"
+REPORT="$2"
+FAILURES=0
+
+if [ ! -x "${PLCRASHUTIL}" ] || [ ! -f "${REPORT}" ]; then
+	echo "Usage: $0 <plcrashutil> <report.plcrash>" >&2
+	exit 1
+fi
+
+fail() {
+	echo "FAIL: $1" >&2
+	FAILURES=`expr $FAILURES + 1`
+}
+
+# Print the size of the given file, in bytes
+file_size() {
+	wc -c < "$1" | tr -d ' '
+}
+
+WORK=`mktemp -d "${TMPDIR:-/tmp}/plcrashutil-tests.XXXXXX"` || exit 1
+trap 'rm -rf "${WORK}"' EXIT
+
+# A directory of identical reports, and one that additionally contains a file that is not a report
+mkdir "${WORK}/reports" "${WORK}/mixed" || exit 1
+for name in a b c; do
+	cp "${REPORT}" "${WORK}/reports/${name}.plcrash" || exit 1
+	cp "${REPORT}" "${WORK}/mixed/${name}.plcrash" || exit 1
+done
+echo "not a crash report" > "${WORK}/mixed/junk.plcrash"
+
+# The single-report conversion, against which the other output is compared
+"${PLCRASHUTIL}" convert --format=ios "${REPORT}" > "${WORK}/expected.crash" || fail "convert failed"
+grep -q '^Binary Images:$' "${WORK}/expected.crash" || fail "convert output is missing its binary images"
+
+test_convert_batch() {
+	# Directory input, streamed to an output directory
+	mkdir "${WORK}/out" || exit 1
+	"${PLCRASHUTIL}" convert --batch --jobs=2 --output-dir="${WORK}/out" --format=ios "${WORK}/reports" || fail "convert --batch --output-dir failed"
+	for name in a b c; do
+		cmp -s "${WORK}/expected.crash" "${WORK}/out/${name}.crash" || fail "convert --batch --output-dir: ${name}.crash does not match convert"
+	done
+	[ `ls "${WORK}/out" | wc -l | tr -d ' '` -eq 3 ] || fail "convert --batch --output-dir: unexpected output files"
+
+	# Paths read from stdin, written to stdout behind a header per report
+	ls "${WORK}"/reports/*.plcrash | "${PLCRASHUTIL}" convert --batch --jobs=3 --format=ios - > "${WORK}/batch.out" || fail "convert --batch - failed"
+	for name in a b c; do
+		[ `grep -c "^==> ${WORK}/reports/${name}.plcrash <==$" "${WORK}/batch.out"` -eq 1 ] || fail "convert --batch -: missing header for ${name}.plcrash"
+	done
+
+	# Each report is written whole: the output is exactly the three headers, each followed by the report and a newline
+	local expected_size=`file_size "${WORK}/expected.crash"`
+	local header_size=`grep '^==> .* <==$' "${WORK}/batch.out" | wc -c | tr -d ' '`
+	[ `file_size "${WORK}/batch.out"` -eq `expr ${header_size} + 3 \* \( ${expected_size} + 1 \)` ] || fail "convert --batch -: reports are incomplete or interleaved"
+
+	# A report that can't be decoded is reported, and the remaining reports are still converted
+	mkdir "${WORK}/mixed-out" || exit 1
+	if "${PLCRASHUTIL}" convert --batch --output-dir="${WORK}/mixed-out" --format=ios "${WORK}/mixed" 2> "${WORK}/batch.err"; then
+		fail "convert --batch: an invalid report did not fail the conversion"
+	fi
+	grep -q '^1 of 4 crash logs could not be converted$' "${WORK}/batch.err" || fail "convert --batch: the failure count was not reported"
+	for name in a b c; do
+		cmp -s "${WORK}/expected.crash" "${WORK}/mixed-out/${name}.crash" || fail "convert --batch: ${name}.crash was not converted alongside an invalid report"
+	done
+}
+
+test_bucket() {
+	# Identical reports share a single bucket, whether named individually, by directory, or on stdin
+	"${PLCRASHUTIL}" bucket "${WORK}/reports/a.plcrash" "${WORK}/reports/b.plcrash" "${WORK}/reports/c.plcrash" > "${WORK}/bucket.files" || fail "bucket failed"
+	[ `wc -l < "${WORK}/bucket.files" | tr -d ' '` -eq 1 ] || fail "bucket: identical reports were placed in more than one bucket"
+	grep -q "^3[[:space:]]" "${WORK}/bucket.files" || fail "bucket: the bucket does not count all three reports"
+
+	"${PLCRASHUTIL}" bucket --jobs=2 "${WORK}/reports" > "${WORK}/bucket.dir" || fail "bucket <dir> failed"
+	cmp -s "${WORK}/bucket.files" "${WORK}/bucket.dir" || fail "bucket <dir>: output differs from the named files"
+
+	ls "${WORK}"/reports/*.plcrash | "${PLCRASHUTIL}" bucket - > "${WORK}/bucket.stdin" || fail "bucket - failed"
+	cmp -s "${WORK}/bucket.files" "${WORK}/bucket.stdin" || fail "bucket -: output differs from the named files"
+
+	# The signature is the exception or signal, followed by at most --frames frames
+	"${PLCRASHUTIL}" bucket --frames=1 "${REPORT}" > "${WORK}/bucket.one" || fail "bucket --frames=1 failed"
+	[ `grep -o ' | ' "${WORK}/bucket.one" | wc -l | tr -d ' '` -eq 1 ] || fail "bucket --frames=1: the signature does not contain exactly one frame"
+	[ `grep -o ' | ' "${WORK}/bucket.files" | wc -l | tr -d ' '` -le 5 ] || fail "bucket: the signature contains more than the default five frames"
+
+	# The shorter signature is a prefix of the default signature
+	local one=`cut -f 2- "${WORK}/bucket.one"`
+	case `cut -f 2- "${WORK}/bucket.files"` in
+		"${one}"*) ;;
+		*) fail "bucket --frames=1: the signature is not a prefix of the default signature" ;;
+	esac
+
+	# A file that is not a report is counted as a failure, and is not bucketed
+	if "${PLCRASHUTIL}" bucket "${WORK}/mixed" > "${WORK}/bucket.mixed" 2> "${WORK}/bucket.err"; then
+		fail "bucket: an invalid report did not fail the command"
+	fi
+	grep -q '^1 of 4 crash logs could not be loaded$' "${WORK}/bucket.err" || fail "bucket: the failure count was not reported"
+	cmp -s "${WORK}/bucket.files" "${WORK}/bucket.mixed" || fail "bucket: an invalid report changed the buckets"
+}
+
+# Print the thread headers of the given serve or convert output
+thread_headers() {
+	grep -E '^Thread [0-9]+( Crashed)?:$' "$1"
+}
+
+test_serve() {
+	# With no symbols available, every thread of the report is listed, and an unreadable path is reported inline
+	mkdir "${WORK}/dsyms" || exit 1
+	printf '%s\n%s\n' "${REPORT}" "${WORK}/missing.plcrash" | "${PLCRASHUTIL}" serve --jobs=2 --dsyms="${WORK}/dsyms" > "${WORK}/serve.out" 2> /dev/null || fail "serve failed"
+	[ `grep -c '^==> .* <==$' "${WORK}/serve.out" | tr -d ' '` -eq 2 ] || fail "serve: expected a result for each request"
+	grep -q "^==> ${REPORT} <==$" "${WORK}/serve.out" || fail "serve: missing the result for the report"
+	grep -A 1 "^==> ${WORK}/missing.plcrash <==$" "${WORK}/serve.out" | grep -q '^error: ' || fail "serve: an unreadable report was not reported as an error"
+
+	thread_headers "${WORK}/expected.crash" > "${WORK}/threads.expected"
+	thread_headers "${WORK}/serve.out" > "${WORK}/threads.serve"
+	[ -s "${WORK}/threads.expected" ] || fail "convert: no threads were found"
+	cmp -s "${WORK}/threads.expected" "${WORK}/threads.serve" || fail "serve: the threads do not match convert"
+
+	# Each frame is listed by its index, image and address
+	grep -qE '^0 +[^ ]+ +0x[0-9a-f]{16}$' "${WORK}/serve.out" || fail "serve: unsymbolicated frames are not listed"
+
+	# Requests may also be made over a Unix domain socket
+	local sock="${WORK}/serve.sock"
+	"${PLCRASHUTIL}" serve --dsyms="${WORK}/dsyms" --socket="${sock}" 2> /dev/null &
+	local pid=$!
+	local tries=0
+	while [ ! -S "${sock}" ] && [ ${tries} -lt 50 ]; do
+		sleep 0.1
+		tries=`expr ${tries} + 1`
+	done
+
+	perl -MIO::Socket::UNIX -e '
+		my $s = IO::Socket::UNIX->new(Peer => $ARGV[0]) or die "connect: $!\n";
+		print $s "$ARGV[1]\n";
+		shutdown($s, 1);
+		print while <$s>;' "${sock}" "${REPORT}" > "${WORK}/serve.sock.out" 2> /dev/null || fail "serve --socket: could not connect"
+	kill ${pid} 2> /dev/null
+	wait ${pid} 2> /dev/null
+
+	thread_headers "${WORK}/serve.sock.out" > "${WORK}/threads.sock"
+	cmp -s "${WORK}/threads.expected" "${WORK}/threads.sock" || fail "serve --socket: the threads do not match convert"
+}
+
+# Print the given field of the stats summary line; 1 is the report count, 3 the encoded bytes, and 6 the stored bytes
+stats_summary_field() {
+	head -n 1 "$1" | tr -d '(' | cut -d ' ' -f "$2"
+}
+
+test_stats() {
+	"${PLCRASHUTIL}" stats "${REPORT}" > "${WORK}/stats.one" || fail "stats failed"
+	grep -qE '^1 reports, [0-9]+ encoded bytes \([0-9]+ bytes as stored\), [0-9]+ bytes/report$' "${WORK}/stats.one" || fail "stats: missing the summary line"
+	[ `stats_summary_field "${WORK}/stats.one" 6` -eq `file_size "${REPORT}"` ] || fail "stats: the stored size does not match the report"
+
+	# Every byte of the encoded report is attributed to exactly one top-level section
+	local encoded=`stats_summary_field "${WORK}/stats.one" 3`
+	local sections=`sed -n '/^Sections:$/,/^$/p' "${WORK}/stats.one" | awk '/^  / { sum += $(NF - 1) } END { print sum }'`
+	[ "${sections}" -eq "${encoded}" ] || fail "stats: the sections total ${sections} of ${encoded} encoded bytes"
+	sed -n '/^Sections:$/,/^$/p' "${WORK}/stats.one" | grep -qE '^  threads +[1-9]' || fail "stats: missing the threads section"
+	sed -n '/^Sections:$/,/^$/p' "${WORK}/stats.one" | grep -qE '^  binary_images +[1-9]' || fail "stats: missing the binary images section"
+
+	# The threads walked in encoded form are those written by the single-report conversion
+	local threads=`thread_headers "${WORK}/expected.crash" | wc -l | tr -d ' '`
+	grep -qE "^  ${threads} threads, [0-9]+ frames" "${WORK}/stats.one" || fail "stats: the thread count does not match convert"
+
+	# Totals accumulate across reports
+	"${PLCRASHUTIL}" stats "${WORK}/reports" > "${WORK}/stats.dir" || fail "stats <dir> failed"
+	[ `stats_summary_field "${WORK}/stats.dir" 1` -eq 3 ] || fail "stats <dir>: incorrect report count"
+	[ `stats_summary_field "${WORK}/stats.dir" 3` -eq `expr 3 \* ${encoded}` ] || fail "stats <dir>: incorrect encoded size"
+	grep -qE "^  `expr 3 \* ${threads}` threads," "${WORK}/stats.dir" || fail "stats <dir>: incorrect thread count"
+
+	# A file that is not a report is counted as a failure, and the remaining reports are still analyzed
+	if "${PLCRASHUTIL}" stats "${WORK}/mixed" > "${WORK}/stats.mixed" 2> "${WORK}/stats.err"; then
+		fail "stats: an invalid report did not fail the command"
+	fi
+	grep -q '^1 of 4 crash logs could not be parsed$' "${WORK}/stats.err" || fail "stats: the failure count was not reported"
+	cmp -s "${WORK}/stats.dir" "${WORK}/stats.mixed" || fail "stats: an invalid report changed the totals"
+}
+
+test_convert_batch
+test_bucket
+test_serve
+test_stats
+
+if [ ${FAILURES} -ne 0 ]; then
+	echo "${FAILURES} plcrashutil test(s) failed" >&2
+	exit 1
+fi
+
+echo "All plcrashutil tests passed"
@@ -28,6 +28,7 @@
 
 #include "AsyncAllocator.hpp"
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncInstrumentation.h"
 
 #include "AsyncPageAllocator.hpp"
 
@@ -68,28 +69,97 @@ PLCR_CPP_BEGIN_ASYNC_NS
  *
  * @param pageAllocator The initial set of pages to be used as our allocation pool. The allocator will claim ownership of this pointer.
  * @param initial_size The initial requested pool size.
+ * @param options The AsyncAllocatorOption flags to be used by this allocator.
  * @param first_block_address The naturally aligned address of the initial free block.
  * @param first_block_size The size in bytes of the initial free block.
  */
-AsyncAllocator::AsyncAllocator (AsyncPageAllocator *pageAllocator, size_t initial_size, vm_address_t first_block_address, vm_size_t first_block_size) :
+AsyncAllocator::AsyncAllocator (AsyncPageAllocator *pageAllocator, size_t initial_size, uint32_t options, vm_address_t first_block_address, vm_size_t first_block_size) :
     _initial_size(initial_size),
+    _options(options),
     _initial_page_control(pageAllocator),
     _pageControls(&_initial_page_control),
-    _free_list(NULL)
+    _reserve_target(0),
+    _reserve_count(0),
+    _free_list(NULL),
+    _trace(NULL),
+    _trace_capacity(0),
+    _trace_count(0),
+    _has_magazine_key(false)
 {
+    /* Start with empty bins */
+    for (size_t i = 0; i < bin_count; i++)
+        _bins[i] = NULL;
+
+    _stats.bin_hits = 0;
+    _stats.bin_misses = 0;
+    _stats.bin_frees = 0;
+    _stats.freelist_allocs = 0;
+    _stats.binned_bytes = 0;
+    _stats.magazine_hits = 0;
+    _stats.magazine_frees = 0;
+    _stats.freelist_walk_steps = 0;
+    _stats.grows = 0;
+    _stats.free_blocks = 0;
+    _stats.free_bytes = 0;
+    _stats.largest_free_block = 0;
+    _stats.high_water_bytes = 0;
+
+    /* All magazines start unclaimed and empty */
+    for (size_t i = 0; i < max_magazines; i++) {
+        magazine *m = &_magazines[i];
+
+        m->_owner = 0;
+        m->_allocator = this;
+        for (size_t c = 0; c < bin_count; c++) {
+            m->_blocks[c] = NULL;
+            m->_counts[c] = 0;
+        }
+        m->_bytes = 0;
+        m->_hits = 0;
+        m->_frees = 0;
+    }
+
+    /* Magazines are released on thread exit; if no key is available, magazines are never claimed */
+    if (_options & ThreadMagazines) {
+        if (pthread_key_create(&_magazine_key, thread_magazine_exit) == 0) {
+            _has_magazine_key = true;
+        } else {
+            PLCF_DEBUG("Failed to create the thread magazine key; magazines will be disabled");
+        }
+    }
+    __sync_synchronize();
+
+    /* Arenas bump-allocate from the initial block, and do not maintain a free list */
+    _arena_base = _arena_cursor = first_block_address;
+    _arena_base_end = _arena_end = first_block_address + first_block_size;
+    _arena_allocated = 0;
+
+    _expected_unleaked_free_bytes = first_block_size;
+    if (_options & Arena)
+        return;
+
     /* Construct the first free list entry in-place, covering all remaining unallocated data */
     _free_list = new (placement_new_tag_t(), first_block_address) control_block(this, NULL, first_block_size);
     _free_list->_next = _free_list;
-    
-    _expected_unleaked_free_bytes = first_block_size;
 }
 
 AsyncAllocator::~AsyncAllocator () {
     PLCF_ASSERT(_pageControls != NULL);
+
+    /* Deleting the key ensures that no magazine release will be attempted by threads that exit after this point */
+    if (_has_magazine_key)
+        pthread_key_delete(_magazine_key);
     
-    /* Check for leaks */
-    if (_expected_unleaked_free_bytes != debug_bytes_free())
+    /* Check for leaks; arena allocations are never individually freed, and are exempt. */
+    if (!(_options & Arena) && _expected_unleaked_free_bytes != debug_bytes_free())
         PLCF_DEBUG("WARNING! Leaked %zd bytes in allocator %p", (ssize_t) (_expected_unleaked_free_bytes - debug_bytes_free()), this);
+
+    /* Release any unused reserve regions. The batch must be released explicitly, as our own storage is deallocated below,
+     * prior to any member destructors. */
+    for (size_t i = 0; i < _reserve_count; i++)
+        delete _reserve[i];
+    _reserve_count = 0;
+    _batch.nasync_release();
     
     /* Clean up our backing allocations. Note that we copy out the next page control, as deallocating
      * the previous page will also deallocate its control. */
@@ -115,19 +185,37 @@ plcrash_error_t AsyncAllocator::grow (vm_size_t required) {
     PLCF_ASSERT(!_lock.tryLock());
 
     plcrash_error_t err;
+
+    plcrash_async_instrumentation_count(PLCRASH_ASYNC_COUNTER_ALLOCATOR_GROWS);
+    _stats.grows++;
     
-    /* While vm_allocate is generally async-safe, it is not gauranteed to be so. Ideally this allocator will be initialized once without
-     * sufficient free space for all crash-time allocation operations. */
-    PLCF_DEBUG("WARNING: Growing the AsyncAllocator free list via vm_allocate(). Increasing the initial size of this allocator is recommended.");
-    
-    /* Try allocating a new page pool */
-    AsyncPageAllocator *newPages;
-    err = AsyncPageAllocator::Create(&newPages, _initial_size + required, AsyncPageAllocator::GuardLowPage | AsyncPageAllocator::GuardHighPage);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("AsyncPageAllocator::Create() failed while attempting to grow the pool: %d", err);
-        
-        _lock.unlock();
-        return err;
+    /* Prefer a pre-allocated reserve region large enough to satisfy the request; this avoids a syscall entirely. */
+    AsyncPageAllocator *newPages = NULL;
+    for (size_t i = 0; i < _reserve_count; i++) {
+        if (_reserve[i]->usable_size() < reserve_overhead() + required)
+            continue;
+
+        newPages = _reserve[i];
+        _reserve[i] = _reserve[--_reserve_count];
+        break;
+    }
+
+    /* Otherwise, take the next region from our batch; this requires no kernel calls, and the region's pages are
+     * committed by first touch. */
+    if (newPages == NULL && _batch.usable_size() >= reserve_overhead() + required)
+        _batch.take(&newPages);
+
+    if (newPages == NULL) {
+        /* While vm_allocate is generally async-safe, it is not gauranteed to be so. Ideally this allocator will be initialized once without
+         * sufficient free space for all crash-time allocation operations. */
+        PLCF_DEBUG("WARNING: Growing the AsyncAllocator free list via vm_allocate(). Increasing the initial size or reserve of this allocator is recommended.");
+
+        /* Try allocating a new page pool */
+        err = AsyncPageAllocator::Create(&newPages, _initial_size + required, AsyncPageAllocator::GuardLowPage | AsyncPageAllocator::GuardHighPage);
+        if (err != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("AsyncPageAllocator::Create() failed while attempting to grow the pool: %d", err);
+            return err;
+        }
     }
 
     /* Calculate the first usable address at which we can construct our page control. This must be aligned to natural_alignment(). */
@@ -142,6 +230,13 @@ plcrash_error_t AsyncAllocator::grow (vm_size_t required) {
     page_control_block *pcb = new (placement_new_tag_t(), aligned_address) page_control_block(newPages, _pageControls);
     _pageControls = pcb;
 
+    /* Arenas simply abandon the remainder of the current region and continue bump allocation within the new pages */
+    if (_options & Arena) {
+        _arena_cursor = free_block_address;
+        _arena_end = free_block_address + trunc_align(free_block_size);
+        return PLCRASH_ESUCCESS;
+    }
+
     /* Construct the first free list entry in-place, covering all remaining unallocated data */
     control_block *new_block = new (placement_new_tag_t(), free_block_address) control_block(this, NULL, free_block_size);
     
@@ -150,7 +245,7 @@ plcrash_error_t AsyncAllocator::grow (vm_size_t required) {
     
     /* Use the deallocation machinery to insert the new block into the free list, while maintaining sorting/coalescing */
     _lock.unlock(); /* Avoid deadlock */
-    dealloc((void *) new_block->data());
+    dealloc_block((void *) new_block->data());
     _lock.lock();
 
     return PLCRASH_ESUCCESS;
@@ -170,10 +265,11 @@ void AsyncAllocator::operator delete (void *ptr, size_t size) {}
  * @param allocator On success, will contain a pointer to the newly created allocator.
  * @param initial_size The initial size of the allocated memory pool to be available for user allocations. This pool
  * will automatically grow as required.
+ * @param options A bitwise OR of AsyncAllocatorOption flags.
  *
  * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
  */
-plcrash_error_t AsyncAllocator::Create (AsyncAllocator **allocator, size_t initial_size) {
+plcrash_error_t AsyncAllocator::Create (AsyncAllocator **allocator, size_t initial_size, uint32_t options) {
     plcrash_error_t err;
     
     /* Allocate memory pool */
@@ -194,7 +290,7 @@ plcrash_error_t AsyncAllocator::Create (AsyncAllocator **allocator, size_t initi
     vm_size_t free_block_size = trunc_align(aligned_size - (free_block_address - aligned_address));
 
     /* Construct the allocator state in-place at the start of our allocated page.  */
-    AsyncAllocator *a = new (placement_new_tag_t(), aligned_address) AsyncAllocator(pageAllocator, initial_size, free_block_address, free_block_size);
+    AsyncAllocator *a = new (placement_new_tag_t(), aligned_address) AsyncAllocator(pageAllocator, initial_size, options, free_block_address, free_block_size);
     
     /* Provide the newly allocated (and self-referential) structure to the caller. */
     *allocator = a;
@@ -211,6 +307,195 @@ vm_address_t AsyncAllocator::control_block::data () { return round_align(head()
 /** Return the tail address of this entry. */
 vm_address_t AsyncAllocator::control_block::tail () { return head() + _size; }
 
+/**
+ * @internal
+ *
+ * Determine the size class of blocks with @a data_size usable bytes.
+ *
+ * @param data_size The number of usable bytes following the block's control block.
+ * @param index On success, the size class index, in the range [0, bin_count).
+ *
+ * @return Returns true if @a data_size is exactly representable by a size class.
+ */
+bool AsyncAllocator::size_class (vm_size_t data_size, size_t *index) {
+    if (data_size == 0 || data_size > max_binned_size || data_size != round_align(data_size))
+        return false;
+
+    *index = (data_size / natural_alignment()) - 1;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Determine the size-class bin to be used for blocks with @a data_size usable bytes.
+ *
+ * @param data_size The number of usable bytes following the block's control block.
+ * @param index On success, the bin index.
+ *
+ * @return Returns true if size-class bins are enabled and @a data_size is exactly representable by a bin.
+ */
+bool AsyncAllocator::bin_index (vm_size_t data_size, size_t *index) {
+    if ((_options & SizeClassBins) == 0)
+        return false;
+
+    return size_class(data_size, index);
+}
+
+/**
+ * @internal
+ *
+ * Return the calling thread's magazine, claiming an unused magazine if necessary. Returns NULL if ThreadMagazines
+ * is not enabled, or all magazines have been claimed by other threads.
+ *
+ * A claimed magazine is registered with _magazine_key, and is released via release_magazine() when the claiming
+ * thread exits.
+ */
+AsyncAllocator::magazine *AsyncAllocator::thread_magazine () {
+    if ((_options & ThreadMagazines) == 0 || !_has_magazine_key)
+        return NULL;
+
+    uintptr_t self = (uintptr_t) pthread_self();
+
+    /* Look for an existing claim */
+    for (size_t i = 0; i < max_magazines; i++) {
+        if (_magazines[i]._owner == self)
+            return &_magazines[i];
+    }
+
+    /* Try to claim a free magazine */
+    for (size_t i = 0; i < max_magazines; i++) {
+        if (_magazines[i]._owner == 0 && __sync_bool_compare_and_swap(&_magazines[i]._owner, 0, self)) {
+            /* If the exit handler can't be registered, the magazine would never be released; give it back */
+            if (pthread_setspecific(_magazine_key, &_magazines[i]) != 0) {
+                __sync_bool_compare_and_swap(&_magazines[i]._owner, self, 0);
+                return NULL;
+            }
+
+            return &_magazines[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Return all blocks held by @a mag to the shared allocator state, and release the magazine for use by other threads.
+ * Must only be called by the thread owning @a mag.
+ *
+ * @param mag The magazine to be released.
+ */
+void AsyncAllocator::release_magazine (magazine *mag) {
+    for (size_t c = 0; c < bin_count; c++) {
+        control_block *cb = mag->_blocks[c];
+        while (cb != NULL) {
+            control_block *next = cb->_next;
+
+            cb->_next = NULL;
+            dealloc_shared(cb);
+            cb = next;
+        }
+
+        mag->_blocks[c] = NULL;
+        mag->_counts[c] = 0;
+    }
+    mag->_bytes = 0;
+
+    /* The drained magazine must be visible before it may be claimed by another thread */
+    __sync_synchronize();
+    mag->_owner = 0;
+}
+
+/**
+ * @internal
+ *
+ * Thread-specific data destructor registered for _magazine_key; releases the exiting thread's magazine.
+ *
+ * @param mag The exiting thread's magazine.
+ */
+void AsyncAllocator::thread_magazine_exit (void *mag) {
+    magazine *m = (magazine *) mag;
+    m->_allocator->release_magazine(m);
+}
+
+/**
+ * Return a snapshot of the allocator's statistics.
+ */
+AsyncAllocator::Stats AsyncAllocator::stats () {
+    _lock.lock();
+    Stats result = _stats;
+
+    /* Summarize the free list; the ratio of largest_free_block to free_bytes provides a measure of fragmentation */
+    if (_options & Arena) {
+        result.free_bytes = _arena_end - _arena_cursor;
+        result.largest_free_block = result.free_bytes;
+    } else {
+        control_block *first = _free_list;
+        for (control_block *b = _free_list; b != NULL; b = b->_next) {
+            result.free_blocks++;
+            result.free_bytes += b->_size;
+            if (b->_size > result.largest_free_block)
+                result.largest_free_block = b->_size;
+
+            if (b->_next == first)
+                break;
+        }
+    }
+    _lock.unlock();
+
+    for (size_t i = 0; i < max_magazines; i++) {
+        result.magazine_hits += _magazines[i]._hits;
+        result.magazine_frees += _magazines[i]._frees;
+    }
+
+    return result;
+}
+
+
+/**
+ * Record all subsequent allocations and deallocations to @a events, for later replay by a benchmark or profiler. Events
+ * beyond @a capacity are counted, but not recorded.
+ *
+ * @param events The buffer to which events will be recorded, or NULL to disable tracing.
+ * @param capacity The number of events that may be written to @a events.
+ *
+ * @warning This method is not thread-safe, and must not be called while other threads are using the allocator.
+ */
+void AsyncAllocator::set_trace (TraceEvent *events, size_t capacity) {
+    _trace_count = 0;
+    _trace_capacity = capacity;
+    _trace = events;
+    __sync_synchronize();
+}
+
+/**
+ * Return the number of events recorded since the last call to set_trace(). This may exceed the trace buffer's
+ * capacity, in which case the trace was truncated.
+ */
+size_t AsyncAllocator::trace_count () {
+    return _trace_count;
+}
+
+/**
+ * @internal
+ *
+ * Record a trace event, if tracing is enabled.
+ *
+ * @param ptr The allocated or deallocated address.
+ * @param size The requested size, or 0 for a deallocation.
+ */
+inline void AsyncAllocator::record_trace (uintptr_t ptr, size_t size) {
+    if (__builtin_expect(_trace == NULL, 1))
+        return;
+
+    size_t idx = __sync_fetch_and_add(&_trace_count, 1);
+    if (idx < _trace_capacity) {
+        _trace[idx].ptr = ptr;
+        _trace[idx].size = size;
+    }
+}
 
 /**
  * Attempt to allocate @a size bytes, returning a pointer to the allocation in @a allocated on success. If insufficient space
@@ -222,6 +507,19 @@ vm_address_t AsyncAllocator::control_block::tail () { return head() + _size; }
  * @return On success, returns PLCRASH_ESUCCESS. If additional bytes can not be allocated, PLCRASH_ENOMEM will be returned.
  */
 plcrash_error_t AsyncAllocator::alloc (void **allocated, size_t size) {
+    plcrash_error_t err = alloc_block(allocated, size);
+    if (err == PLCRASH_ESUCCESS)
+        record_trace((uintptr_t) *allocated, size);
+
+    return err;
+}
+
+/**
+ * @internal
+ *
+ * Perform an allocation; see alloc().
+ */
+plcrash_error_t AsyncAllocator::alloc_block (void **allocated, size_t size) {
     plcrash_error_t err;
     
     /* Sanity check that adding size to sizeof(control_block) won't overflow */
@@ -231,9 +529,74 @@ plcrash_error_t AsyncAllocator::alloc (void **allocated, size_t size) {
     /* Compute the total number of bytes our allocation will need -- we have to lead with a control block. */
     size_t new_block_size = round_align(round_align(sizeof(control_block)) + size);
     
+    /* Try the calling thread's magazine; this does not require the lock. */
+    size_t size_idx;
+    magazine *mag;
+    if (!(_options & Arena) && size_class(round_align(size), &size_idx) && (mag = thread_magazine()) != NULL) {
+        control_block *cb = mag->_blocks[size_idx];
+        if (cb != NULL) {
+            mag->_blocks[size_idx] = cb->_next;
+            mag->_counts[size_idx]--;
+            mag->_bytes -= cb->_size;
+            mag->_hits++;
+
+            cb->_next = NULL;
+            *allocated = (void *) cb->data();
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
     /* Acquire our state lock */
     _lock.lock();
-    
+
+    /* Arena allocations are bumped from the current region, growing the pool if required. */
+    if (_options & Arena) {
+        if (_arena_end - _arena_cursor < new_block_size) {
+            if ((err = grow(new_block_size)) != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to grow the arena: %d", err);
+
+                _lock.unlock();
+                return PLCRASH_ENOMEM;
+            }
+
+            PLCF_ASSERT(_arena_end - _arena_cursor >= new_block_size);
+        }
+
+        /* The control block is retained so that allocator() and dealloc() continue to function */
+        control_block *cb = new (placement_new_tag_t(), _arena_cursor) control_block(this, NULL, new_block_size);
+        _arena_cursor += new_block_size;
+
+        _arena_allocated += new_block_size;
+        if (_arena_allocated > _stats.high_water_bytes)
+            _stats.high_water_bytes = _arena_allocated;
+
+        *allocated = (void *) cb->data();
+
+        _lock.unlock();
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Try the size-class bin, if any */
+    size_t bin;
+    if (bin_index(round_align(size), &bin)) {
+        control_block *cb = _bins[bin];
+        if (cb != NULL) {
+            _bins[bin] = cb->_next;
+            cb->_next = NULL;
+
+            _stats.bin_hits++;
+            _stats.binned_bytes -= cb->_size;
+
+            *allocated = (void *) cb->data();
+
+            _lock.unlock();
+            return PLCRASH_ESUCCESS;
+        }
+
+        _stats.bin_misses++;
+    }
+    _stats.freelist_allocs++;
+
     /* If our pool has been exhausted, try to allocate additional pages from the OS. */
     if (_free_list == NULL) {
         if ((err = grow(size)) != PLCRASH_ESUCCESS) {
@@ -251,6 +614,8 @@ retry:
     control_block *prev_cb = _free_list;
     control_block *start_cb = prev_cb;
     for (control_block *cb = _free_list;; prev_cb = cb, cb = cb->_next) {
+        _stats.freelist_walk_steps++;
+
         /* Sanity check; blocks must be owned by this allocator */
         PLCF_ASSERT(cb->_allocator == this);
 
@@ -333,6 +698,150 @@ AsyncAllocator *AsyncAllocator::allocator (void *ptr) {
     return block->_allocator;
 }
 
+/**
+ * Pre-allocate up to @a count spare page regions, each sized to this allocator's initial size, that may later be
+ * consumed by pool growth without a vm_allocate() call. The reserve target is retained, and may be restored after
+ * regions have been consumed via refill_reserve().
+ *
+ * @param count The number of reserve regions to maintain. This value is clamped to max_reserve.
+ *
+ * @warning This method is not async-safe, and should be called prior to the crash, eg, when enabling the crash reporter.
+ */
+plcrash_error_t AsyncAllocator::reserve (size_t count) {
+    _lock.lock();
+    _reserve_target = count < max_reserve ? count : max_reserve;
+    
+    /* Release any regions in excess of the new target, preferring to retain the (unconstructed) batch regions */
+    while (_reserve_count > 0 && _reserve_count + _batch.available() > _reserve_target)
+        delete _reserve[--_reserve_count];
+    _batch.nasync_trim(_reserve_target - _reserve_count);
+    _lock.unlock();
+
+    return refill_reserve();
+}
+
+/**
+ * Allocate reserve regions until the reserve target configured via reserve() has been reached. This should be called
+ * off the crash path after an operation (such as generating a live report) may have consumed reserve regions.
+ *
+ * All missing regions are allocated together as a single AsyncPageBatch, with one vm_allocate() call. As a batch can
+ * not be extended, any untaken regions of the previous batch are released and replaced by the new batch; these
+ * regions must be re-prefaulted via nasync_prefault() if required.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t AsyncAllocator::refill_reserve () {
+    /* Determine the number of batch regions required */
+    _lock.lock();
+    size_t available = _reserve_count + _batch.available();
+    size_t required = _reserve_target > _reserve_count ? _reserve_target - _reserve_count : 0;
+    _lock.unlock();
+
+    if (available >= _reserve_target)
+        return PLCRASH_ESUCCESS;
+
+    /* Allocate the batch outside of our lock */
+    AsyncPageBatch batch;
+    plcrash_error_t err = batch.nasync_init(_initial_size + reserve_overhead(), required);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("AsyncPageBatch::nasync_init() failed while attempting to fill the reserve: %d", err);
+        return err;
+    }
+
+    /* Install the batch, unless another thread has filled the reserve in the meantime */
+    _lock.lock();
+    if (_reserve_count + _batch.available() < _reserve_target)
+        _batch.swap(batch);
+    _lock.unlock();
+
+    /* Release whichever batch was not installed */
+    batch.nasync_release();
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the number of unused reserve regions currently available to pool growth.
+ */
+size_t AsyncAllocator::reserve_count () {
+    _lock.lock();
+    size_t count = _reserve_count + _batch.available();
+    _lock.unlock();
+
+    return count;
+}
+
+/**
+ * Fault in, and optionally wire, all pages currently held by this allocator, including any reserve regions. This
+ * avoids first-touch page faults -- which may be slow, or fail outright under memory pressure -- when the pages are
+ * first used at crash time.
+ *
+ * Pages acquired after this call (eg, via pool growth or refill_reserve()) are not prefaulted.
+ *
+ * @param wire If true, the pages will also be wired via mlock(). See AsyncPageAllocator::nasync_prefault().
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. If wiring any region fails, the remaining regions are still
+ * prefaulted, and the first error is returned.
+ *
+ * @warning This method is not async-safe, and should be called prior to the crash, eg, when enabling the crash reporter.
+ */
+plcrash_error_t AsyncAllocator::nasync_prefault (bool wire) {
+    plcrash_error_t result = PLCRASH_ESUCCESS;
+    plcrash_error_t err;
+
+    _lock.lock();
+    for (page_control_block *pageControl = _pageControls; pageControl != NULL; pageControl = pageControl->_next) {
+        if ((err = pageControl->_pageAllocator->nasync_prefault(wire)) != PLCRASH_ESUCCESS && result == PLCRASH_ESUCCESS)
+            result = err;
+    }
+
+    for (size_t i = 0; i < _reserve_count; i++) {
+        if ((err = _reserve[i]->nasync_prefault(wire)) != PLCRASH_ESUCCESS && result == PLCRASH_ESUCCESS)
+            result = err;
+    }
+
+    if ((err = _batch.nasync_prefault(wire)) != PLCRASH_ESUCCESS && result == PLCRASH_ESUCCESS)
+        result = err;
+    _lock.unlock();
+
+    return result;
+}
+
+/**
+ * Release all allocations made from an Arena allocator in a single step. Any pages acquired while growing the
+ * arena are returned to the system, and bump allocation restarts at the beginning of the initial pool. Up to the configured reserve() target,
+ * these pages are retained as reserve regions.
+ *
+ * @warning All memory previously allocated from this allocator becomes invalid; the caller is responsible for
+ * ensuring that no outstanding references remain.
+ */
+void AsyncAllocator::reset () {
+    PLCF_ASSERT(_options & Arena);
+
+    _lock.lock();
+
+    /* Release all pages other than our initial pool; these are always found prior to the initial page control. Note that
+     * we copy out the next page control, as deallocating the pages will also deallocate their control. Pages are
+     * returned to the reserve when it has room for them. */
+    page_control_block *next = NULL;
+    for (page_control_block *pageControl = _pageControls; pageControl != &_initial_page_control; pageControl = next) {
+        next = pageControl->_next;
+
+        if (_reserve_count + _batch.available() < _reserve_target)
+            _reserve[_reserve_count++] = pageControl->_pageAllocator;
+        else
+            delete pageControl->_pageAllocator;
+    }
+    _pageControls = &_initial_page_control;
+
+    /* Restart bump allocation */
+    _arena_cursor = _arena_base;
+    _arena_end = _arena_base_end;
+    _arena_allocated = 0;
+    _expected_unleaked_free_bytes = _arena_base_end - _arena_base;
+
+    _lock.unlock();
+}
+
 
 /**
  * Deallocate the memory associated with @a ptr.
@@ -340,6 +849,18 @@ AsyncAllocator *AsyncAllocator::allocator (void *ptr) {
  * @param ptr A pointer previously returned from alloc(), for which all associated memory will be deallocated.
  */
 void AsyncAllocator::dealloc (void *ptr) {
+    record_trace((uintptr_t) ptr, 0);
+    dealloc_block(ptr);
+}
+
+/**
+ * @internal
+ *
+ * Return the block containing @a ptr to the free list; see dealloc().
+ *
+ * @param ptr A pointer previously returned from alloc(), or the data address of a newly constructed free block.
+ */
+void AsyncAllocator::dealloc_block (void *ptr) {
     /* Fetch the control block */
     control_block *freeblock = (control_block *) ((vm_address_t) ptr - round_align(sizeof(control_block)));
     
@@ -348,10 +869,52 @@ void AsyncAllocator::dealloc (void *ptr) {
     
     /* Allocated blocks must have a NULL next value */
     PLCF_ASSERT(freeblock->_next == NULL);
-    
+
+    /* Arena allocations are only released via reset() */
+    if (_options & Arena)
+        return;
+
+    /* Return small blocks to the calling thread's magazine, if it has room; this does not require the lock. */
+    size_t size_idx;
+    magazine *mag;
+    if (size_class(freeblock->_size - round_align(sizeof(control_block)), &size_idx) && (mag = thread_magazine()) != NULL) {
+        if (mag->_counts[size_idx] < magazine_depth) {
+            freeblock->_next = mag->_blocks[size_idx];
+            mag->_blocks[size_idx] = freeblock;
+            mag->_counts[size_idx]++;
+            mag->_bytes += freeblock->_size;
+            mag->_frees++;
+            return;
+        }
+    }
+
+    dealloc_shared(freeblock);
+}
+
+/**
+ * @internal
+ *
+ * Return @a freeblock to the shared size-class bins or free list, bypassing any thread magazine.
+ *
+ * @param freeblock The control block of an allocated block.
+ */
+void AsyncAllocator::dealloc_shared (control_block *freeblock) {
     /* Acquire our state lock */
     _lock.lock();
-    
+
+    /* Return small blocks to their size-class bin */
+    size_t bin;
+    if (bin_index(freeblock->_size - round_align(sizeof(control_block)), &bin)) {
+        freeblock->_next = _bins[bin];
+        _bins[bin] = freeblock;
+
+        _stats.bin_frees++;
+        _stats.binned_bytes += freeblock->_size;
+
+        _lock.unlock();
+        return;
+    }
+
     /* If the free list is empty, we can simply re-initialize it without worrying about sorting. */
     if (_free_list == NULL) {
         _free_list = freeblock;
@@ -31,11 +31,13 @@
 
 #include <unistd.h>
 #include <stdint.h>
+#include <pthread.h>
 
 #include "PLCrashMacros.h"
 
 #include "PLCrashAsync.h"
 #include "SpinLock.hpp"
+#include "AsyncPageAllocator.hpp"
 
 /**
  * @internal
@@ -60,9 +62,6 @@ void *operator new[] (size_t, const plcrash::async::placement_new_tag_t &tag, vm
 
 PLCR_CPP_BEGIN_ASYNC_NS
 
-/* Forward declarations */
-class AsyncPageAllocator;
-
 /**
  * @internal
  *
@@ -97,7 +96,118 @@ class AsyncPageAllocator;
  */
 class AsyncAllocator {
 public:
-    static plcrash_error_t Create (AsyncAllocator **allocator, size_t initial_size);
+    /**
+     * Initialization options for AsyncAllocator.
+     */
+    typedef enum {
+        /**
+         * Maintain segregated free lists for small allocations of up to max_binned_size bytes. Deallocated small
+         * blocks are retained in a per-size-class bin, rather than being coalesced into the address-sorted free list,
+         * allowing subsequent allocations of the same size class to be served in constant time.
+         */
+        SizeClassBins = 1 << 0,
+
+        /**
+         * Operate as a bump-pointer arena. Allocations are carved sequentially from the allocator's pool in constant
+         * time, dealloc() is a no-op that never acquires the allocator's lock, and all allocations are released at once
+         * via reset(). This is intended for short-lived scratch allocations, such as those made while writing a single
+         * crash report.
+         */
+        Arena = 1 << 1,
+
+        /**
+         * Maintain small per-thread magazines of recently freed small blocks (up to max_binned_size bytes). Up to
+         * max_magazines threads may each claim a magazine; allocations and deallocations that can be satisfied by the
+         * calling thread's magazine do not acquire the allocator's lock. Threads that fail to claim a magazine fall
+         * back to the shared allocator state. A thread's magazine is drained back to the shared allocator state and
+         * released for use by other threads when the thread exits.
+         *
+         * Each allocator with magazines enabled holds a pthread key for its lifetime, of which only PTHREAD_KEYS_MAX
+         * are available per process. Magazines should only be enabled for long-lived allocators shared by several
+         * threads; if no key is available, the allocator operates without magazines.
+         *
+         * @warning A magazine is only safe against concurrent access from other threads; a signal handler that interrupts
+         * an allocator operation on the same thread must not use the same allocator. This matches the existing
+         * constraint imposed by the allocator's lock, which would otherwise deadlock.
+         */
+        ThreadMagazines = 1 << 2,
+    } AsyncAllocatorOption;
+
+    /**
+     * Allocator statistics, as returned by stats().
+     */
+    struct Stats {
+        /** The number of small allocations served directly from a size-class bin. */
+        size_t bin_hits;
+
+        /** The number of small allocations for which the size-class bin was empty. */
+        size_t bin_misses;
+
+        /** The number of deallocations returned to a size-class bin. */
+        size_t bin_frees;
+
+        /** The number of allocations served from the address-sorted free list, including bin misses. */
+        size_t freelist_allocs;
+
+        /** The number of bytes, including control blocks, currently held in size-class bins. */
+        vm_size_t binned_bytes;
+
+        /** The number of allocations served from a per-thread magazine. */
+        size_t magazine_hits;
+
+        /** The number of deallocations returned to a per-thread magazine. */
+        size_t magazine_frees;
+
+        /** The number of free list blocks visited while searching for an allocation. */
+        size_t freelist_walk_steps;
+
+        /** The number of times the pool has been grown. */
+        size_t grows;
+
+        /** The number of blocks currently in the address-sorted free list. */
+        size_t free_blocks;
+
+        /** The number of bytes, including control blocks, currently in the address-sorted free list (or, for an
+         * Arena, remaining in the current bump region). */
+        vm_size_t free_bytes;
+
+        /** The size, in bytes, of the largest block in the address-sorted free list (or, for an Arena, the number
+         * of bytes remaining in the current bump region). */
+        vm_size_t largest_free_block;
+
+        /** For an Arena, the largest number of bytes, including control blocks, allocated between any two calls to
+         * reset(). This may be used to size the arena's initial pool such that future use does not require growth.
+         * Always 0 for other allocators. */
+        vm_size_t high_water_bytes;
+    };
+
+    /**
+     * An allocation trace event, as recorded via set_trace().
+     */
+    struct TraceEvent {
+        /** The allocated or deallocated address. */
+        uintptr_t ptr;
+
+        /** The requested allocation size, or 0 if this event records a deallocation. */
+        size_t size;
+    };
+
+    /** The largest allocation, in bytes, that will be served from a size-class bin. */
+    static constexpr size_t max_binned_size = 512;
+
+    /** The number of size-class bins; one for each 16 byte natural_alignment() multiple up to max_binned_size. */
+    static constexpr size_t bin_count = max_binned_size / 16;
+
+    /** The maximum number of threads that may claim a per-thread magazine. */
+    static constexpr size_t max_magazines = 8;
+
+    /** The maximum number of free blocks retained per size class within a single magazine. */
+    static constexpr size_t magazine_depth = 8;
+
+    /** The maximum number of pre-allocated reserve regions that may be retained via reserve(). */
+    static constexpr size_t max_reserve = 8;
+
+    static plcrash_error_t Create (AsyncAllocator **allocator, size_t initial_size, uint32_t options = 0);
     ~AsyncAllocator ();
     void operator delete (void *ptr, size_t size);
 
@@ -105,6 +215,19 @@ public:
     void dealloc (void *ptr);
     
     static AsyncAllocator *allocator (void *ptr);
+
+    void reset ();
+
+    plcrash_error_t reserve (size_t count);
+    plcrash_error_t refill_reserve ();
+    size_t reserve_count ();
+
+    plcrash_error_t nasync_prefault (bool wire);
+
+    Stats stats ();
+
+    void set_trace (TraceEvent *events, size_t capacity);
+    size_t trace_count ();
     
     /* An allocation instance may not be copied or moved; all access must be performed through the pointer returned
      * via Create(). */
@@ -152,9 +275,12 @@ public:
 #ifndef PLCF_ASYNCALLOCATOR_DEBUG
 private:
 #endif
-    AsyncAllocator (AsyncPageAllocator *pageAllocator, size_t initial_size, vm_address_t first_block, vm_size_t first_block_size);
+    AsyncAllocator (AsyncPageAllocator *pageAllocator, size_t initial_size, uint32_t options, vm_address_t first_block, vm_size_t first_block_size);
     
     plcrash_error_t grow (vm_size_t required);
+    plcrash_error_t alloc_block (void **allocated, size_t size);
+    void dealloc_block (void *ptr);
+    void record_trace (uintptr_t ptr, size_t size);
     
     /**
      * @internal
@@ -178,6 +304,9 @@ private:
     
     /** The initial requested size. */
     const size_t _initial_size;
+
+    /** The AsyncAllocatorOption flags provided at creation time. */
+    const uint32_t _options;
     
     /** Lock that must be held when operating on the non-const allocator state */
     SpinLock _lock;
@@ -191,6 +320,27 @@ private:
     /** All backing page controls. */
     page_control_block *_pageControls;
 
+    /** The number of reserve regions to be maintained by refill_reserve(). */
+    size_t _reserve_target;
+
+    /** The number of valid entries in _reserve. */
+    size_t _reserve_count;
+
+    /** Spare page regions available to grow() without a vm_allocate() call, such as those returned by reset(). */
+    AsyncPageAllocator *_reserve[max_reserve];
+
+    /** Reserve regions allocated by refill_reserve(), taken by grow() once _reserve has no suitable region. Counted
+     * towards _reserve_target alongside _reserve_count. */
+    AsyncPageBatch _batch;
+
+    /**
+     * Return the number of bytes within a page region that are consumed by grow() prior to the first usable
+     * block, including worst-case alignment.
+     */
+    static inline vm_size_t reserve_overhead () {
+        return round_align(sizeof(page_control_block)) + (2 * natural_alignment());
+    }
+
     /**
      * @internal
      * 
@@ -230,9 +380,89 @@ private:
      * - The 'next' element in a single element list will refer cyclically to itself.
      */
     control_block *_free_list;
-    
+
+    /**
+     * Size-class bins, indexed by (block data size / 16) - 1. Each bin is a NULL-terminated singly linked list of free
+     * blocks with exactly the bin's data size, linked via their _next pointers. Only used if SizeClassBins is enabled.
+     */
+    control_block *_bins[bin_count];
+
+    /** Allocation statistics. */
+    Stats _stats;
+
+    /** If non-NULL, the buffer to which allocation trace events are recorded. See set_trace(). */
+    TraceEvent *_trace;
+
+    /** The capacity of _trace. */
+    size_t _trace_capacity;
+
+    /** The number of events written to _trace, or that would have been written had _trace_capacity been sufficient. */
+    volatile size_t _trace_count;
+
+    /**
+     * @internal
+     *
+     * A per-thread cache of free small blocks. A magazine is claimed by atomically setting its _owner, and
+     * is thereafter only modified by the owning thread until that thread exits.
+     */
+    struct magazine {
+        /** The owning thread's pthread_t, or 0 if unclaimed. */
+        volatile uintptr_t _owner;
+
+        /** The allocator to which this magazine belongs. */
+        AsyncAllocator *_allocator;
+
+        /** Per size-class NULL-terminated lists of free blocks, linked via their _next pointers. */
+        control_block *_blocks[bin_count];
+
+        /** The number of blocks in each of the _blocks lists. */
+        uint8_t _counts[bin_count];
+
+        /** The number of bytes, including control blocks, currently held in this magazine. */
+        vm_size_t _bytes;
+
+        /** The number of allocations served from this magazine. */
+        size_t _hits;
+
+        /** The number of deallocations returned to this magazine. */
+        size_t _frees;
+    };
+
+    /** Per-thread magazines. Only used if ThreadMagazines is enabled. */
+    magazine _magazines[max_magazines];
+
+    /** Thread-specific key referencing the calling thread's claimed magazine; used to release the magazine on thread
+     * exit. Only valid if _has_magazine_key is true. */
+    pthread_key_t _magazine_key;
+
+    /** True if _magazine_key was successfully created. */
+    bool _has_magazine_key;
+
+    magazine *thread_magazine ();
+    void release_magazine (magazine *mag);
+    static void thread_magazine_exit (void *mag);
+    void dealloc_shared (control_block *freeblock);
+
+    static bool size_class (vm_size_t data_size, size_t *index);
+    bool bin_index (vm_size_t data_size, size_t *index);
+
+    /** If Arena is enabled, the start of the initial bump region; reset() restores _arena_cursor to this address. */
+    vm_address_t _arena_base;
+
+    /** If Arena is enabled, the end of the initial bump region. */
+    vm_address_t _arena_base_end;
+
+    /** If Arena is enabled, the next free address within the current bump region. */
+    vm_address_t _arena_cursor;
+
+    /** If Arena is enabled, the end of the current bump region. */
+    vm_address_t _arena_end;
+
+    /** If Arena is enabled, the number of bytes, including control blocks, allocated since the last reset(). */
+    vm_size_t _arena_allocated;
+
     /**
-     * Return the number of bytes consumed by all free list blocks.
+     * Return the number of bytes consumed by all free list blocks, including those held in size-class bins.
      *
      * This does not define the number of bytes available for actual usable allocation, and should not be used
      * by non-implementation code outside of unit tests or debugging.
@@ -241,6 +471,9 @@ private:
         vm_size_t bytes_free = 0;
         
         _lock.lock();
+        if (_options & Arena)
+            bytes_free += _arena_end - _arena_cursor;
+
         control_block *first = _free_list;
         for (control_block *b = _free_list; b != NULL; b = b->_next) {
             bytes_free += b->_size;
@@ -248,7 +481,12 @@ private:
             if (b->_next == first)
                 break;
         }
+        bytes_free += _stats.binned_bytes;
         _lock.unlock();
+
+        /* Magazine state is owned by other threads; this is only accurate when no other threads are active */
+        for (size_t i = 0; i < max_magazines; i++)
+            bytes_free += _magazines[i]._bytes;
         
         return bytes_free;
     }
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#define PLCF_ASYNCALLOCATOR_DEBUG 1
+#import "AsyncAllocator.hpp"
+
+#import "PLCrashLogWriter.h"
+#import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashTestThread.h"
+
+#import <mach/mach_time.h>
+
+using namespace plcrash::async;
+
+/** The maximum number of trace events recorded from a single report. */
+#define TRACE_CAPACITY (64 * 1024)
+
+/**
+ * A single operation within a replayable allocation trace.
+ */
+struct replay_op {
+    /** The index of the allocation slot to be allocated into or freed. */
+    size_t slot;
+
+    /** The allocation size, or 0 if this operation frees the slot. */
+    size_t size;
+};
+
+/**
+ * Benchmarks and fragmentation profiling for AsyncAllocator.
+ *
+ * Allocation traces are recorded from real crash report writes via AsyncAllocator::set_trace(), and then replayed
+ * against allocators configured with each AsyncAllocatorOption mode and a range of initial sizes. Results are reported
+ * via NSLog(); the tests verify only that the replay succeeded.
+ */
+@interface PLCrashAsyncAllocatorBenchmarkTests : SenTestCase {
+@private
+    /** Test thread used as the report's crashed thread. */
+    plcrash_test_thread_t _thr_args;
+
+    /** The replayable operations. */
+    struct replay_op *_ops;
+
+    /** The number of operations in _ops. */
+    size_t _op_count;
+
+    /** The number of allocation slots referenced by _ops. */
+    size_t _slot_count;
+}
+@end
+
+@implementation PLCrashAsyncAllocatorBenchmarkTests
+
+- (void) setUp {
+    plcrash_test_thread_spawn(&_thr_args);
+    [self recordTrace];
+}
+
+- (void) tearDown {
+    free(_ops);
+    plcrash_test_thread_stop(&_thr_args);
+}
+
+/*
+ * Record the allocation trace of a crash report write, and convert it to a sequence of replayable operations.
+ */
+- (void) recordTrace {
+    const size_t bufferSize = 4 * 1024 * 1024;
+    plcrash_async_allocator_t *allocator;
+    plcrash_async_dynloader_t *loader;
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_thread_state_t thread_state;
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+
+    STAssertEquals(plcrash_async_allocator_create(&allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    bsd_info.address = (void *) 0x42;
+    bsd_info.code = SEGV_MAPERR;
+    bsd_info.signo = SIGSEGV;
+    info.mach_info = NULL;
+    info.bsd_info = &bsd_info;
+    plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+
+    void *buffer = malloc(bufferSize);
+    AsyncAllocator::TraceEvent *events = (AsyncAllocator::TraceEvent *) malloc(sizeof(AsyncAllocator::TraceEvent) * TRACE_CAPACITY);
+
+    /* Write a report, tracing the writer's crash-time allocator */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_async_file_init_memory(&file, buffer, bufferSize);
+
+    writer.allocator->set_trace(events, TRACE_CAPACITY);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state), @"Crash log failed");
+    size_t event_count = writer.allocator->trace_count();
+    writer.allocator->set_trace(NULL, 0);
+
+    STAssertTrue(event_count <= TRACE_CAPACITY, @"Trace was truncated");
+    if (event_count > TRACE_CAPACITY)
+        event_count = TRACE_CAPACITY;
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_async_file_close(&file);
+    plcrash_async_dynloader_free(loader);
+    plcrash_async_allocator_free(allocator);
+
+    /* Map the recorded addresses to allocation slots. Frees of allocations made prior to tracing are discarded. */
+    NSMutableDictionary *live = [NSMutableDictionary dictionary];
+    _ops = (struct replay_op *) malloc(sizeof(struct replay_op) * (event_count + 1));
+    _op_count = 0;
+    _slot_count = 0;
+
+    for (size_t i = 0; i < event_count; i++) {
+        NSNumber *key = [NSNumber numberWithUnsignedLongLong: events[i].ptr];
+
+        if (events[i].size != 0) {
+            [live setObject: [NSNumber numberWithUnsignedLongLong: _slot_count] forKey: key];
+            _ops[_op_count].slot = _slot_count++;
+            _ops[_op_count].size = events[i].size;
+            _op_count++;
+        } else {
+            NSNumber *slot = [live objectForKey: key];
+            if (slot == nil)
+                continue;
+
+            [live removeObjectForKey: key];
+            _ops[_op_count].slot = (size_t) [slot unsignedLongLongValue];
+            _ops[_op_count].size = 0;
+            _op_count++;
+        }
+    }
+
+    free(events);
+    free(buffer);
+
+    STAssertTrue(_slot_count > 0, @"No allocations were recorded");
+}
+
+/* qsort() comparator for uint64_t latencies */
+static int compare_latency (const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *) a;
+    uint64_t rhs = *(const uint64_t *) b;
+
+    if (lhs < rhs)
+        return -1;
+    else if (lhs > rhs)
+        return 1;
+    return 0;
+}
+
+/* Return the @a percentile latency from the sorted @a latencies, in nanoseconds */
+static uint64_t latency_percentile (const uint64_t *latencies, size_t count, unsigned int percentile, const mach_timebase_info_data_t *timebase) {
+    if (count == 0)
+        return 0;
+
+    size_t idx = (count * percentile) / 100;
+    if (idx >= count)
+        idx = count - 1;
+
+    return (latencies[idx] * timebase->numer) / timebase->denom;
+}
+
+/*
+ * Replay the recorded trace against an allocator created with @a initialSize and @a options, and log the results.
+ */
+- (void) replayWithInitialSize: (size_t) initialSize options: (uint32_t) options name: (NSString *) name {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, initialSize, options), @"Failed to create allocator");
+
+    void **slots = (void **) calloc(_slot_count, sizeof(void *));
+    uint64_t *alloc_latency = (uint64_t *) malloc(sizeof(uint64_t) * _op_count);
+    uint64_t *free_latency = (uint64_t *) malloc(sizeof(uint64_t) * _op_count);
+    size_t alloc_count = 0;
+    size_t free_count = 0;
+
+    /* Replay the trace, recording the worst fragmentation observed */
+    double worst_fragmentation = 0;
+    for (size_t i = 0; i < _op_count; i++) {
+        const struct replay_op *op = &_ops[i];
+
+        if (op->size != 0) {
+            uint64_t start = mach_absolute_time();
+            plcrash_error_t err = allocator->alloc(&slots[op->slot], op->size);
+            alloc_latency[alloc_count++] = mach_absolute_time() - start;
+
+            STAssertEquals(PLCRASH_ESUCCESS, err, @"%@: allocation of %zu bytes failed", name, op->size);
+            if (err != PLCRASH_ESUCCESS)
+                break;
+        } else {
+            uint64_t start = mach_absolute_time();
+            allocator->dealloc(slots[op->slot]);
+            free_latency[free_count++] = mach_absolute_time() - start;
+
+            slots[op->slot] = NULL;
+        }
+
+        /* Sample fragmentation periodically; stats() walks the free list */
+        if (i % 64 == 0) {
+            AsyncAllocator::Stats stats = allocator->stats();
+            if (stats.free_bytes > 0) {
+                double fragmentation = 1.0 - ((double) stats.largest_free_block / (double) stats.free_bytes);
+                if (fragmentation > worst_fragmentation)
+                    worst_fragmentation = fragmentation;
+            }
+        }
+    }
+
+    AsyncAllocator::Stats stats = allocator->stats();
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    qsort(alloc_latency, alloc_count, sizeof(uint64_t), compare_latency);
+    qsort(free_latency, free_count, sizeof(uint64_t), compare_latency);
+
+    NSLog(@"%@ (initial_size %zu): alloc p50/p90/p99/max %llu/%llu/%llu/%llu ns, free p50/p90/p99/max %llu/%llu/%llu/%llu ns, "
+          "%.2f free list steps/alloc, worst fragmentation %.2f, %zu grows (%zu allocs, %zu frees)",
+          name, initialSize,
+          latency_percentile(alloc_latency, alloc_count, 50, &timebase), latency_percentile(alloc_latency, alloc_count, 90, &timebase),
+          latency_percentile(alloc_latency, alloc_count, 99, &timebase), latency_percentile(alloc_latency, alloc_count, 100, &timebase),
+          latency_percentile(free_latency, free_count, 50, &timebase), latency_percentile(free_latency, free_count, 90, &timebase),
+          latency_percentile(free_latency, free_count, 99, &timebase), latency_percentile(free_latency, free_count, 100, &timebase),
+          alloc_count > 0 ? (double) stats.freelist_walk_steps / (double) alloc_count : 0.0,
+          worst_fragmentation, stats.grows, alloc_count, free_count);
+
+    /* Release any allocations that were live at the end of the trace */
+    for (size_t i = 0; i < _slot_count; i++) {
+        if (slots[i] != NULL)
+            allocator->dealloc(slots[i]);
+    }
+
+    free(slots);
+    free(alloc_latency);
+    free(free_latency);
+    delete allocator;
+}
+
+/**
+ * Replay the recorded crash report allocation trace against each allocator mode, across a range of initial sizes.
+ */
+- (void) testReplayTrace {
+    const size_t initialSizes[] = { 16 * 1024, 64 * 1024, 256 * 1024 };
+
+    for (size_t i = 0; i < sizeof(initialSizes) / sizeof(initialSizes[0]); i++) {
+        [self replayWithInitialSize: initialSizes[i] options: 0 name: @"free list"];
+        [self replayWithInitialSize: initialSizes[i] options: AsyncAllocator::SizeClassBins name: @"size class bins"];
+        [self replayWithInitialSize: initialSizes[i] options: AsyncAllocator::ThreadMagazines name: @"thread magazines"];
+        [self replayWithInitialSize: initialSizes[i] options: AsyncAllocator::Arena name: @"arena"];
+    }
+}
+
+/**
+ * Verify that tracing records allocations and deallocations, but not internal pool growth.
+ */
+- (void) testTraceRecording {
+    AsyncAllocator *allocator;
+    AsyncAllocator::TraceEvent events[4];
+    void *ptr;
+
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE), @"Failed to create allocator");
+    allocator->set_trace(events, sizeof(events) / sizeof(events[0]));
+
+    /* Force a grow(), which must not be recorded */
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&ptr, PAGE_SIZE * 2), @"Allocation failed");
+    allocator->dealloc(ptr);
+
+    STAssertEquals(allocator->trace_count(), (size_t) 2, @"Incorrect event count");
+    STAssertEquals(events[0].ptr, (uintptr_t) ptr, @"Incorrect allocation address");
+    STAssertEquals(events[0].size, (size_t) PAGE_SIZE * 2, @"Incorrect allocation size");
+    STAssertEquals(events[1].ptr, (uintptr_t) ptr, @"Incorrect deallocation address");
+    STAssertEquals(events[1].size, (size_t) 0, @"Deallocation was not recorded as such");
+    STAssertEquals(allocator->stats().grows, (size_t) 1, @"Pool growth was not counted");
+
+    allocator->set_trace(NULL, 0);
+    delete allocator;
+}
+
+@end
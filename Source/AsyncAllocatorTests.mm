@@ -32,6 +32,9 @@
 
 #define PLCF_ASYNCALLOCATOR_DEBUG 1
 #import "AsyncAllocator.hpp"
+#import "PLCrashAsyncAllocator.h"
+
+#import <limits.h>
 
 #import <mach/vm_region.h>
 
@@ -257,4 +260,296 @@ using namespace plcrash::async;
     delete allocator;
 }
 
+/* Test allocation from (and deallocation to) the segregated size-class free lists */
+- (void) testSizeClassBins {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::SizeClassBins), @"Failed to construct allocator");
+    vm_size_t orig_free = allocator->debug_bytes_free();
+
+    /* The first small allocation must miss the empty bin */
+    void *buffer;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 24), @"Allocation failed");
+    AsyncAllocator::Stats stats = allocator->stats();
+    STAssertEquals(stats.bin_hits, (size_t) 0, @"Unexpected bin hit");
+    STAssertEquals(stats.bin_misses, (size_t) 1, @"Bin miss was not recorded");
+    STAssertEquals(stats.freelist_allocs, (size_t) 1, @"Free list allocation was not recorded");
+
+    /* Deallocation should place the block in its bin, without returning it to the free list */
+    AsyncAllocator::control_block *orig_free_list = allocator->_free_list;
+    allocator->dealloc(buffer);
+    stats = allocator->stats();
+    STAssertEquals(stats.bin_frees, (size_t) 1, @"Bin free was not recorded");
+    STAssertEquals(stats.binned_bytes, (vm_size_t) (AsyncAllocator::round_align(sizeof(AsyncAllocator::control_block)) + 32), @"Incorrect binned byte count");
+    STAssertEquals(allocator->_free_list, orig_free_list, @"The block was returned to the free list");
+    STAssertEquals(orig_free, allocator->debug_bytes_free(), @"Binned bytes were not accounted for as free");
+
+    /* A subsequent allocation in the same size class should be served from the bin */
+    void *buffer_2;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer_2, 32), @"Allocation failed");
+    STAssertEquals(buffer, buffer_2, @"Allocation was not served from the bin");
+    stats = allocator->stats();
+    STAssertEquals(stats.bin_hits, (size_t) 1, @"Bin hit was not recorded");
+    STAssertEquals(stats.freelist_allocs, (size_t) 1, @"Bin hit was recorded as a free list allocation");
+    STAssertEquals(stats.binned_bytes, (vm_size_t) 0, @"Incorrect binned byte count");
+
+    /* Allocations larger than max_binned_size bypass the bins entirely */
+    void *large;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&large, AsyncAllocator::max_binned_size + 1), @"Allocation failed");
+    allocator->dealloc(large);
+    stats = allocator->stats();
+    STAssertEquals(stats.bin_misses, (size_t) 1, @"Large allocation was recorded as a bin miss");
+    STAssertEquals(stats.bin_frees, (size_t) 1, @"Large allocation was returned to a bin");
+    STAssertEquals(stats.freelist_allocs, (size_t) 2, @"Large allocation was not recorded");
+
+    allocator->dealloc(buffer_2);
+    STAssertEquals(orig_free, allocator->debug_bytes_free(), @"Bytes were leaked");
+
+    delete allocator;
+}
+
+/* Test bump allocation and bulk reset in arena mode */
+- (void) testArena {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::Arena), @"Failed to construct allocator");
+    vm_size_t orig_free = allocator->debug_bytes_free();
+
+    /* Allocations should be carved sequentially, and deallocation should not make space available */
+    void *buffer;
+    void *buffer_2;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 24), @"Allocation failed");
+    allocator->dealloc(buffer);
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer_2, 24), @"Allocation failed");
+
+    vm_size_t block_size = AsyncAllocator::round_align(sizeof(AsyncAllocator::control_block)) + 32;
+    STAssertEquals((vm_address_t) buffer_2, (vm_address_t) buffer + block_size, @"Allocations were not bumped sequentially");
+    STAssertEquals(allocator->debug_bytes_free(), orig_free - (block_size * 2), @"Incorrect free byte count");
+    STAssertEquals(AsyncAllocator::allocator(buffer_2), allocator, @"Incorrect owning allocator");
+    STAssertNULL(allocator->_free_list, @"Arenas should not maintain a free list");
+
+    /* Exhausting the initial pool should trigger the allocation of additional pages */
+    void *large;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&large, orig_free), @"Allocation failed");
+    STAssertNotEquals(allocator->_pageControls, &allocator->_initial_page_control, @"No additional pages were allocated");
+
+    /* Resetting should release the additional pages, and restart allocation at the start of the initial pool */
+    allocator->reset();
+    STAssertEquals(allocator->_pageControls, &allocator->_initial_page_control, @"Additional pages were not released");
+    STAssertEquals(orig_free, allocator->debug_bytes_free(), @"Reset did not release all allocations");
+
+    void *buffer_3;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer_3, 24), @"Allocation failed");
+    STAssertEquals(buffer, buffer_3, @"Allocation did not restart at the start of the pool");
+
+    delete allocator;
+}
+
+/* Test tracking of the largest number of bytes allocated from an arena between resets */
+- (void) testArenaHighWater {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::Arena), @"Failed to construct allocator");
+    STAssertEquals(allocator->stats().high_water_bytes, (vm_size_t) 0, @"Unused arena should have no high-water mark");
+
+    vm_size_t block_size = AsyncAllocator::round_align(sizeof(AsyncAllocator::control_block)) + 32;
+    void *buffer;
+    for (int i = 0; i < 3; i++)
+        STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 24), @"Allocation failed");
+    STAssertEquals(allocator->stats().high_water_bytes, block_size * 3, @"Incorrect high-water mark");
+
+    /* Resetting restarts the count, but must not lower the high-water mark */
+    allocator->reset();
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 24), @"Allocation failed");
+    STAssertEquals(allocator->stats().high_water_bytes, block_size * 3, @"High-water mark was lowered by reset");
+
+    /* Growth beyond the initial pool must be counted */
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, PAGE_SIZE * 2), @"Allocation failed");
+    STAssertTrue(allocator->stats().high_water_bytes > PAGE_SIZE * 2, @"Growth was not included in the high-water mark");
+
+    delete allocator;
+
+    /* Non-arena allocators do not track a high-water mark */
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE), @"Failed to construct allocator");
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 24), @"Allocation failed");
+    STAssertEquals(allocator->stats().high_water_bytes, (vm_size_t) 0, @"Unexpected high-water mark");
+    allocator->dealloc(buffer);
+
+    delete allocator;
+}
+
+/* Test lock-free allocation from (and deallocation to) per-thread magazines */
+- (void) testThreadMagazines {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::ThreadMagazines), @"Failed to construct allocator");
+    vm_size_t orig_free = allocator->debug_bytes_free();
+
+    /* A freed small block should be returned to our magazine, and reused by the next allocation of the same size */
+    void *buffer;
+    void *buffer_2;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 32), @"Allocation failed");
+    allocator->dealloc(buffer);
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer_2, 32), @"Allocation failed");
+    STAssertEquals(buffer, buffer_2, @"Allocation was not served from the magazine");
+
+    AsyncAllocator::Stats stats = allocator->stats();
+    STAssertEquals(stats.magazine_frees, (size_t) 1, @"Magazine free was not recorded");
+    STAssertEquals(stats.magazine_hits, (size_t) 1, @"Magazine hit was not recorded");
+    STAssertEquals(stats.freelist_allocs, (size_t) 1, @"Magazine hit was recorded as a free list allocation");
+    allocator->dealloc(buffer_2);
+
+    /* Once a magazine's size class is full, blocks should be returned to the shared free list */
+    void *buffers[AsyncAllocator::magazine_depth + 1];
+    for (size_t i = 0; i < AsyncAllocator::magazine_depth + 1; i++)
+        STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffers[i], 32), @"Allocation failed");
+
+    for (size_t i = 0; i < AsyncAllocator::magazine_depth + 1; i++)
+        allocator->dealloc(buffers[i]);
+
+    stats = allocator->stats();
+    STAssertEquals(stats.magazine_frees, (size_t) (2 + AsyncAllocator::magazine_depth), @"Magazine depth was not enforced");
+    STAssertEquals(orig_free, allocator->debug_bytes_free(), @"Bytes were leaked");
+
+    delete allocator;
+}
+
+static void *magazine_thread (void *arg) {
+    AsyncAllocator *allocator = (AsyncAllocator *) arg;
+    void *buffer;
+
+    /* Claim a magazine and leave a block cached in it */
+    if (allocator->alloc(&buffer, 32) == PLCRASH_ESUCCESS)
+        allocator->dealloc(buffer);
+
+    return NULL;
+}
+
+/* Test that per-thread magazines are drained and released when their owning thread exits */
+- (void) testThreadMagazineRelease {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::ThreadMagazines), @"Failed to construct allocator");
+    vm_size_t orig_free = allocator->debug_bytes_free();
+
+    /* Run enough short-lived threads to claim every magazine, were they not released at thread exit */
+    for (size_t i = 0; i < AsyncAllocator::max_magazines; i++) {
+        pthread_t thr;
+        STAssertEquals(pthread_create(&thr, NULL, magazine_thread, allocator), 0, @"Failed to create thread");
+        STAssertEquals(pthread_join(thr, NULL), 0, @"Failed to join thread");
+    }
+
+    /* All magazines should have been drained back to the free list */
+    STAssertEquals(orig_free, allocator->debug_bytes_free(), @"Bytes were leaked");
+
+    /* ... and released for use by this thread */
+    void *buffer;
+    void *buffer_2;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, 32), @"Allocation failed");
+    allocator->dealloc(buffer);
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer_2, 32), @"Allocation failed");
+
+    AsyncAllocator::Stats stats = allocator->stats();
+    STAssertEquals(stats.magazine_hits, (size_t) 1, @"No magazine was available to a new thread");
+    allocator->dealloc(buffer_2);
+
+    delete allocator;
+}
+
+/* Test that creating more allocators than there are pthread keys neither fails nor leaks keys */
+- (void) testAllocatorKeyExhaustion {
+    const size_t count = PTHREAD_KEYS_MAX + 1;
+    plcrash_async_allocator_t **allocators = (plcrash_async_allocator_t **) calloc(count, sizeof(allocators[0]));
+
+    /* Allocators without magazines don't consume a key, and may all coexist */
+    for (size_t i = 0; i < count; i++) {
+        void *buffer;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_create(&allocators[i], PAGE_SIZE), @"Failed to construct allocator %zu", i);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_alloc(allocators[i], &buffer, 32), @"Allocation failed");
+        plcrash_async_allocator_dealloc(allocators[i], buffer);
+    }
+
+    for (size_t i = 0; i < count; i++)
+        plcrash_async_allocator_free(allocators[i]);
+    free(allocators);
+
+    /* Magazine allocators release their key when freed; each of a sequence of allocators must still claim a magazine */
+    for (size_t i = 0; i < count; i++) {
+        plcrash_async_allocator_t *allocator;
+        void *buffer;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_magazine_allocator_create(&allocator, PAGE_SIZE), @"Failed to construct allocator %zu", i);
+
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_alloc(allocator, &buffer, 32), @"Allocation failed");
+        plcrash_async_allocator_dealloc(allocator, buffer);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_alloc(allocator, &buffer, 32), @"Allocation failed");
+        plcrash_async_allocator_dealloc(allocator, buffer);
+
+        STAssertEquals(allocator->stats().magazine_hits, (size_t) 1, @"Allocator %zu could not claim a magazine", i);
+        plcrash_async_allocator_free(allocator);
+    }
+}
+
+/* Test consumption and refill of pre-allocated reserve regions */
+- (void) testReserve {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE), @"Failed to construct allocator");
+
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->reserve(2), @"Failed to fill the reserve");
+    STAssertEquals(allocator->reserve_count(), (size_t) 2, @"Incorrect reserve count");
+
+    /* Exhausting the initial pool should consume a reserve region */
+    void *buffer;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, allocator->debug_bytes_free()), @"Allocation failed");
+    STAssertEquals(allocator->reserve_count(), (size_t) 1, @"Growth did not consume a reserve region");
+
+    /* Refilling should restore the target */
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->refill_reserve(), @"Failed to refill the reserve");
+    STAssertEquals(allocator->reserve_count(), (size_t) 2, @"Reserve was not refilled");
+
+    /* Requests larger than the reserve regions should not consume them */
+    void *large;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&large, PAGE_SIZE * 4), @"Allocation failed");
+    STAssertEquals(allocator->reserve_count(), (size_t) 2, @"An undersized reserve region was consumed");
+
+    allocator->dealloc(buffer);
+    allocator->dealloc(large);
+    delete allocator;
+}
+
+/* Test that resetting an arena returns grown pages to the reserve */
+- (void) testArenaReserve {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE, AsyncAllocator::Arena), @"Failed to construct allocator");
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->reserve(1), @"Failed to fill the reserve");
+
+    void *buffer;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc(&buffer, allocator->debug_bytes_free()), @"Allocation failed");
+    STAssertEquals(allocator->reserve_count(), (size_t) 0, @"Growth did not consume a reserve region");
+
+    allocator->reset();
+    STAssertEquals(allocator->reserve_count(), (size_t) 1, @"Reset did not return pages to the reserve");
+
+    delete allocator;
+}
+
+/* Test that prefaulting and wiring the allocator's pages leaves existing allocations intact */
+- (void) testPrefault {
+    AsyncAllocator *allocator;
+    STAssertEquals(PLCRASH_ESUCCESS, AsyncAllocator::Create(&allocator, PAGE_SIZE * 4), @"Failed to construct allocator");
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->reserve(1), @"Failed to fill the reserve");
+
+    uint8_t *buffer;
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->alloc((void **) &buffer, PAGE_SIZE * 2), @"Allocation failed");
+    memset(buffer, 0xAB, PAGE_SIZE * 2);
+
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->nasync_prefault(true), @"Failed to prefault the allocator");
+    for (size_t i = 0; i < PAGE_SIZE * 2; i++) {
+        if (buffer[i] != 0xAB) {
+            STFail(@"Allocation modified at offset %zu", i);
+            break;
+        }
+    }
+
+    /* Repeated prefaulting is permitted, and must not re-wire the pages */
+    STAssertEquals(PLCRASH_ESUCCESS, allocator->nasync_prefault(true), @"Failed to prefault the allocator");
+
+    allocator->dealloc(buffer);
+    delete allocator;
+}
+
 @end
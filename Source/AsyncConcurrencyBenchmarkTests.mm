@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncLinkedList.hpp"
+#import "SpinLock.hpp"
+#import "AsyncAllocator.hpp"
+
+#import <pthread.h>
+#import <mach/mach_time.h>
+
+using namespace plcrash::async;
+
+/** The maximum number of threads started by any benchmark. */
+#define STRESS_MAX_THREADS 8
+
+/** The thread counts benchmarked by the lock and allocator benchmarks. */
+static const unsigned int stress_thread_counts[] = { 1, 2, 4, 8 };
+
+/** The number of latency samples recorded by each thread. */
+#define STRESS_SAMPLES 20000
+
+/** The number of values maintained in the list by the list benchmark's writers. */
+#define STRESS_LIST_VALUES 64
+
+/** The number of live allocations maintained by each allocator benchmark thread. */
+#define STRESS_ALLOC_WINDOW 32
+
+/**
+ * Shared state for a single stress run.
+ */
+struct stress_state {
+    /** Set once all threads have been started; threads spin until set. */
+    volatile bool go;
+
+    /** Set to stop the list benchmark's writer threads. */
+    volatile bool stop;
+
+    /** The list under test. */
+    async_list<int> *list;
+
+    /** If true, list readers use the legacy set_reading() protocol rather than begin_reading(). */
+    bool legacy_readers;
+
+    /** The lock under test. */
+    SpinLock *lock;
+
+    /** A counter modified only while holding the lock, used to verify mutual exclusion. */
+    volatile uint64_t locked_counter;
+
+    /** The allocator under test. */
+    AsyncAllocator *allocator;
+
+    /** Set if any thread observed an invalid value, or a failed operation. */
+    volatile bool failed;
+};
+
+/**
+ * Per-thread state for a single stress run.
+ */
+struct stress_thread {
+    /** The shared state. */
+    struct stress_state *state;
+
+    /** The thread's index. */
+    unsigned int index;
+
+    /** Primary latency samples, in mach_absolute_time() units. */
+    uint64_t *samples;
+
+    /** Secondary latency samples, in mach_absolute_time() units. */
+    uint64_t *secondary_samples;
+
+    /** The number of samples recorded in samples (and, where used, secondary_samples). */
+    size_t sample_count;
+
+    /** The number of operations performed. */
+    uint64_t operations;
+};
+
+/* Compare two latency samples */
+static int stress_compare_latency (const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *) a;
+    uint64_t rhs = *(const uint64_t *) b;
+
+    if (lhs < rhs)
+        return -1;
+    else if (lhs > rhs)
+        return 1;
+    return 0;
+}
+
+/* Return the @a percentile latency from the sorted @a latencies, in nanoseconds */
+static uint64_t stress_percentile (const uint64_t *latencies, size_t count, unsigned int percentile, const mach_timebase_info_data_t *timebase) {
+    if (count == 0)
+        return 0;
+
+    size_t idx = (count * percentile) / 100;
+    if (idx >= count)
+        idx = count - 1;
+
+    return (latencies[idx] * timebase->numer) / timebase->denom;
+}
+
+/*
+ * Merge and sort the samples recorded by @a threads, returning a p50/p90/p99/max summary.
+ */
+static NSString *stress_summary (struct stress_thread *threads, unsigned int count, bool secondary) {
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    size_t total = 0;
+    for (unsigned int i = 0; i < count; i++)
+        total += threads[i].sample_count;
+
+    uint64_t *merged = (uint64_t *) malloc(sizeof(uint64_t) * (total + 1));
+    size_t n = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        const uint64_t *samples = secondary ? threads[i].secondary_samples : threads[i].samples;
+        if (samples == NULL)
+            continue;
+
+        memcpy(merged + n, samples, sizeof(uint64_t) * threads[i].sample_count);
+        n += threads[i].sample_count;
+    }
+    qsort(merged, n, sizeof(uint64_t), stress_compare_latency);
+
+    NSString *summary = [NSString stringWithFormat: @"p50/p90/p99/max %llu/%llu/%llu/%llu ns",
+                         stress_percentile(merged, n, 50, &timebase), stress_percentile(merged, n, 90, &timebase),
+                         stress_percentile(merged, n, 99, &timebase), stress_percentile(merged, n, 100, &timebase)];
+    free(merged);
+
+    return summary;
+}
+
+/* Wait for all threads to start */
+static void stress_wait_start (struct stress_state *state) {
+    while (!state->go)
+        __sync_synchronize();
+}
+
+/* Run @a fn on @a count threads, returning the elapsed wall time in nanoseconds. Threads are started together. */
+static uint64_t stress_run (void *(*fn)(void *), struct stress_thread *threads, unsigned int count) {
+    pthread_t pthreads[STRESS_MAX_THREADS * 2];
+    struct stress_state *state = threads[0].state;
+
+    state->go = false;
+    for (unsigned int i = 0; i < count; i++)
+        pthread_create(&pthreads[i], NULL, fn, &threads[i]);
+
+    uint64_t start = mach_absolute_time();
+    state->go = true;
+    __sync_synchronize();
+
+    for (unsigned int i = 0; i < count; i++)
+        pthread_join(pthreads[i], NULL);
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    return (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+}
+
+/* List reader; measures the latency of a complete iteration, and verifies each value read */
+static void *stress_list_reader (void *arg) {
+    struct stress_thread *thr = (struct stress_thread *) arg;
+    struct stress_state *state = thr->state;
+    async_list<int> *list = state->list;
+
+    stress_wait_start(state);
+
+    for (size_t i = 0; i < STRESS_SAMPLES; i++) {
+        uint64_t start = mach_absolute_time();
+
+        async_list<int>::read_token token = 0;
+        if (state->legacy_readers)
+            list->set_reading(true);
+        else
+            token = list->begin_reading();
+
+        async_list<int>::node *node = NULL;
+        while ((node = list->next(node)) != NULL) {
+            int value = node->value();
+            if (value < 1 || value > STRESS_LIST_VALUES)
+                state->failed = true;
+        }
+
+        if (state->legacy_readers)
+            list->set_reading(false);
+        else
+            list->end_reading(token);
+
+        thr->samples[thr->sample_count++] = mach_absolute_time() - start;
+    }
+
+    return NULL;
+}
+
+/* List writer; repeatedly removes and re-appends values until stopped, measuring the latency of each */
+static void *stress_list_writer (void *arg) {
+    struct stress_thread *thr = (struct stress_thread *) arg;
+    struct stress_state *state = thr->state;
+
+    stress_wait_start(state);
+
+    for (int value = 1 + (int) thr->index; !state->stop; value = (value % STRESS_LIST_VALUES) + 1) {
+        uint64_t start = mach_absolute_time();
+        state->list->nasync_remove_first_value(value);
+        uint64_t removed = mach_absolute_time();
+        state->list->nasync_append(value);
+        uint64_t appended = mach_absolute_time();
+
+        if (thr->sample_count < STRESS_SAMPLES) {
+            thr->samples[thr->sample_count] = appended - removed;
+            thr->secondary_samples[thr->sample_count] = removed - start;
+            thr->sample_count++;
+        }
+        thr->operations++;
+    }
+
+    return NULL;
+}
+
+/* Lock contender; measures the time spent waiting for, and holding, the lock */
+static void *stress_lock_contender (void *arg) {
+    struct stress_thread *thr = (struct stress_thread *) arg;
+    struct stress_state *state = thr->state;
+
+    stress_wait_start(state);
+
+    for (size_t i = 0; i < STRESS_SAMPLES; i++) {
+        uint64_t start = mach_absolute_time();
+        state->lock->lock();
+        uint64_t acquired = mach_absolute_time();
+
+        /* A short critical section, comparable to a free list update */
+        uint64_t counter = state->locked_counter;
+        for (volatile int j = 0; j < 16; j++)
+            ;
+        state->locked_counter = counter + 1;
+
+        uint64_t released = mach_absolute_time();
+        state->lock->unlock();
+
+        thr->samples[thr->sample_count] = acquired - start;
+        thr->secondary_samples[thr->sample_count] = released - acquired;
+        thr->sample_count++;
+    }
+
+    return NULL;
+}
+
+/* Allocator client; allocates and frees small blocks, maintaining a window of live allocations */
+static void *stress_allocator_client (void *arg) {
+    struct stress_thread *thr = (struct stress_thread *) arg;
+    struct stress_state *state = thr->state;
+    void *window[STRESS_ALLOC_WINDOW] = { NULL };
+
+    stress_wait_start(state);
+
+    for (size_t i = 0; i < STRESS_SAMPLES; i++) {
+        size_t slot = i % STRESS_ALLOC_WINDOW;
+        size_t size = 16 << (i % 6);
+
+        uint64_t start = mach_absolute_time();
+        if (window[slot] != NULL)
+            state->allocator->dealloc(window[slot]);
+
+        if (state->allocator->alloc(&window[slot], size) != PLCRASH_ESUCCESS) {
+            window[slot] = NULL;
+            state->failed = true;
+        } else {
+            /* Touch the allocation, verifying that it is not shared with any other thread */
+            memset(window[slot], (int) thr->index, size);
+        }
+        thr->samples[thr->sample_count++] = mach_absolute_time() - start;
+        thr->operations++;
+    }
+
+    for (size_t i = 0; i < STRESS_ALLOC_WINDOW; i++) {
+        if (window[i] == NULL)
+            continue;
+
+        /* The window's final contents must still hold this thread's fill value */
+        if (((uint8_t *) window[i])[0] != (uint8_t) thr->index)
+            state->failed = true;
+        state->allocator->dealloc(window[i]);
+    }
+
+    return NULL;
+}
+
+/**
+ * Multi-threaded stress benchmarks for async_list, SpinLock, and AsyncAllocator.
+ *
+ * Each benchmark runs its operations on a range of thread counts, reporting latency distributions and throughput via
+ * NSLog(). Unlike the other benchmarks, these tests also verify that the structures remained consistent under
+ * contention: list readers must only observe valid values, the lock must provide mutual exclusion, and allocations
+ * must not be shared between threads.
+ */
+@interface PLCrashAsyncConcurrencyBenchmarkTests : SenTestCase {
+@private
+    /** Per-thread state. */
+    struct stress_thread _threads[STRESS_MAX_THREADS * 2];
+}
+@end
+
+@implementation PLCrashAsyncConcurrencyBenchmarkTests
+
+- (void) setUp {
+    for (unsigned int i = 0; i < STRESS_MAX_THREADS * 2; i++) {
+        _threads[i].samples = (uint64_t *) malloc(sizeof(uint64_t) * STRESS_SAMPLES);
+        _threads[i].secondary_samples = (uint64_t *) malloc(sizeof(uint64_t) * STRESS_SAMPLES);
+    }
+}
+
+- (void) tearDown {
+    for (unsigned int i = 0; i < STRESS_MAX_THREADS * 2; i++) {
+        free(_threads[i].samples);
+        free(_threads[i].secondary_samples);
+    }
+}
+
+/* Reset the per-thread state for a run of @a count threads sharing @a state */
+- (void) resetThreads: (unsigned int) count state: (struct stress_state *) state {
+    for (unsigned int i = 0; i < count; i++) {
+        _threads[i].state = state;
+        _threads[i].index = i;
+        _threads[i].sample_count = 0;
+        _threads[i].operations = 0;
+    }
+}
+
+/*
+ * Measure list iteration latency with @a readers readers and @a writers concurrent writers.
+ */
+- (void) benchmarkListWithReaders: (unsigned int) readers writers: (unsigned int) writers legacy: (bool) legacy {
+    async_list<int> list;
+    struct stress_state state = {};
+    pthread_t writer_threads[STRESS_MAX_THREADS];
+
+    for (int i = 1; i <= STRESS_LIST_VALUES; i++)
+        list.nasync_append(i);
+
+    state.list = &list;
+    state.legacy_readers = legacy;
+    [self resetThreads: readers + writers state: &state];
+
+    /* Start the writers; they run until the readers have completed */
+    state.go = true;
+    for (unsigned int i = 0; i < writers; i++)
+        pthread_create(&writer_threads[i], NULL, stress_list_writer, &_threads[readers + i]);
+
+    stress_run(stress_list_reader, _threads, readers);
+
+    state.stop = true;
+    __sync_synchronize();
+    for (unsigned int i = 0; i < writers; i++)
+        pthread_join(writer_threads[i], NULL);
+
+    STAssertFalse(state.failed, @"A reader observed an invalid value");
+    list.assert_list_valid();
+
+    uint64_t writes = 0;
+    for (unsigned int i = 0; i < writers; i++)
+        writes += _threads[readers + i].operations;
+
+    NSLog(@"async_list (%s, %u readers, %u writers): iteration %@; append %@; remove %@ (%llu writes)",
+          legacy ? "set_reading" : "epoch", readers, writers,
+          stress_summary(_threads, readers, false),
+          writers > 0 ? stress_summary(_threads + readers, writers, false) : @"-",
+          writers > 0 ? stress_summary(_threads + readers, writers, true) : @"-",
+          (unsigned long long) writes);
+}
+
+/**
+ * Measure async_list reader latency under concurrent nasync_append() and nasync_remove_node(), using both reader
+ * protocols.
+ */
+- (void) testListReaderLatency {
+    static const unsigned int writer_counts[] = { 0, 1, 2, 4 };
+
+    for (size_t i = 0; i < sizeof(writer_counts) / sizeof(writer_counts[0]); i++) {
+        [self benchmarkListWithReaders: 1 writers: writer_counts[i] legacy: false];
+        [self benchmarkListWithReaders: 4 writers: writer_counts[i] legacy: false];
+        [self benchmarkListWithReaders: 4 writers: writer_counts[i] legacy: true];
+    }
+}
+
+/**
+ * Measure SpinLock wait and hold time distributions as the number of contending threads grows, with and without
+ * backoff and thread switching.
+ */
+- (void) testSpinLockContention {
+    static const struct { uint32_t policy; const char *name; } policies[] = {
+        { SpinLock::SpinDefault, "default" },
+        { SpinLock::SpinPause, "pause" },
+    };
+
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        for (size_t i = 0; i < sizeof(stress_thread_counts) / sizeof(stress_thread_counts[0]); i++) {
+            unsigned int count = stress_thread_counts[i];
+            SpinLock lock(policies[p].policy);
+            struct stress_state state = {};
+
+            state.lock = &lock;
+            [self resetThreads: count state: &state];
+
+            uint64_t elapsed = stress_run(stress_lock_contender, _threads, count);
+            STAssertEquals(state.locked_counter, (uint64_t) count * STRESS_SAMPLES, @"Lost updates; the lock did not provide mutual exclusion");
+
+            NSLog(@"SpinLock (%s, %u threads): wait %@; hold %@; %u contended acquisitions, %.0f acquisitions/s",
+                  policies[p].name, count, stress_summary(_threads, count, false), stress_summary(_threads, count, true),
+                  lock.contention_count(), elapsed > 0 ? (double) state.locked_counter * NSEC_PER_SEC / (double) elapsed : 0.0);
+        }
+    }
+}
+
+/**
+ * Measure AsyncAllocator throughput and latency as the number of allocating threads grows, for each allocator mode.
+ */
+- (void) testAllocatorThroughput {
+    static const struct { uint32_t options; const char *name; } modes[] = {
+        { 0, "free list" },
+        { AsyncAllocator::SizeClassBins, "size class bins" },
+        { AsyncAllocator::ThreadMagazines, "thread magazines" },
+    };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (size_t i = 0; i < sizeof(stress_thread_counts) / sizeof(stress_thread_counts[0]); i++) {
+            unsigned int count = stress_thread_counts[i];
+            struct stress_state state = {};
+
+            STAssertEquals(AsyncAllocator::Create(&state.allocator, PAGE_SIZE * 64, modes[m].options), PLCRASH_ESUCCESS, @"Failed to create allocator");
+            [self resetThreads: count state: &state];
+
+            uint64_t elapsed = stress_run(stress_allocator_client, _threads, count);
+            STAssertFalse(state.failed, @"%s: an allocation failed, or was shared between threads", modes[m].name);
+
+            uint64_t operations = 0;
+            for (unsigned int j = 0; j < count; j++)
+                operations += _threads[j].operations;
+
+            NSLog(@"AsyncAllocator (%s, %u threads): %.0f ops/s; latency %@; %zu grows", modes[m].name, count,
+                  elapsed > 0 ? (double) operations * NSEC_PER_SEC / (double) elapsed : 0.0,
+                  stress_summary(_threads, count, false), state.allocator->stats().grows);
+
+            delete state.allocator;
+        }
+    }
+}
+
+@end
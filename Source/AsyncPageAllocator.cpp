@@ -32,6 +32,8 @@
 #include "PLCrashAsync.h"
 
 #include <libkern/OSAtomic.h>
+#include <sys/mman.h>
+#include <errno.h>
 
 PLCR_CPP_BEGIN_ASYNC_NS
 
@@ -48,7 +50,8 @@ AsyncPageAllocator::AsyncPageAllocator (vm_address_t base_page, vm_size_t total_
     _base_page(base_page),
     _total_size(total_size),
     _usable_address(usable_address),
-    _usable_size(usable_size)
+    _usable_size(usable_size),
+    _wired(false)
 {
     /* assert sane parameters */
     PLCF_ASSERT(base_page <= usable_address);
@@ -58,6 +61,10 @@ AsyncPageAllocator::AsyncPageAllocator (vm_address_t base_page, vm_size_t total_
 
 AsyncPageAllocator::~AsyncPageAllocator () {
     PLCF_ASSERT(_base_page != 0x0);
+
+    /* Release any wiring established via nasync_prefault() */
+    if (_wired && munlock((void *) trunc_page(_usable_address), round_page(_usable_address + _usable_size) - trunc_page(_usable_address)) != 0)
+        PLCF_DEBUG("[AsyncPageAllocator] munlock() failure: %d", errno);
     
     /* Clean up our backing allocation. */
     kern_return_t kr = vm_deallocate(mach_task_self(), _base_page, _total_size);
@@ -70,6 +77,41 @@ AsyncPageAllocator::~AsyncPageAllocator () {
 /* Deallocation of the allocator's memory is handled by the destructor itself; there's nothing for us to do. */
 void AsyncPageAllocator::operator delete (void *ptr, size_t size) {}
 
+/**
+ * Fault in all usable pages, ensuring that the first write to these pages at crash time will not incur a
+ * zero-fill page fault -- which may be slow, or may fail outright under memory pressure.
+ *
+ * @param wire If true, the usable pages will also be wired via mlock(), preventing them from being paged out or
+ * compressed. The pages will be unwired when the allocator is deallocated. Wiring may fail if the process has
+ * exceeded its wired memory limit; in that case, the pages are still prefaulted, and an error is returned.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. If wiring was requested and mlock() fails, returns PLCRASH_ENOMEM.
+ *
+ * @warning This method is not async-safe, and should be called prior to the crash, eg, when enabling the crash reporter.
+ */
+plcrash_error_t AsyncPageAllocator::nasync_prefault (bool wire) {
+    vm_address_t start = trunc_page(_usable_address);
+    vm_address_t end = round_page(_usable_address + _usable_size);
+
+    /* Touch every page. The first page holds our own state, and is necessarily already resident. A read-write of the
+     * existing value ensures that any page holding live allocations is left unmodified. */
+    for (vm_address_t page = start + PAGE_SIZE; page < end; page += PAGE_SIZE) {
+        volatile uint8_t *p = (volatile uint8_t *) page;
+        *p = *p;
+    }
+
+    if (!wire || _wired)
+        return PLCRASH_ESUCCESS;
+
+    if (mlock((void *) start, end - start) != 0) {
+        PLCF_DEBUG("[AsyncPageAllocator] mlock() failure: %d", errno);
+        return PLCRASH_ENOMEM;
+    }
+
+    _wired = true;
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Create a new allocator instance, returning the pointer to the allocator in @a allocator on success. It is the caller's
  * responsibility to free this allocator (which will in turn free any memory allocated by the allocator) via `delete`.
@@ -88,7 +130,6 @@ plcrash_error_t AsyncPageAllocator::Create (AsyncPageAllocator **allocator, size
     
     /* Set defaults. */
     vm_size_t total_size = round_page(size);
-    vm_size_t usable_size = total_size;
     
     /* Adjust total size to account for guard pages */
     if (options & GuardLowPage)
@@ -105,12 +146,8 @@ plcrash_error_t AsyncPageAllocator::Create (AsyncPageAllocator **allocator, size
         return PLCRASH_ENOMEM;
     }
     
-    vm_address_t usable_page = base_page;
-    
     /* Protect the guard pages */
     if (options & GuardLowPage) {
-        usable_page += PAGE_SIZE;
-        
         kt = vm_protect(mach_task_self(), base_page, PAGE_SIZE, false, VM_PROT_NONE);
         
         if (kt != KERN_SUCCESS) {
@@ -138,17 +175,197 @@ plcrash_error_t AsyncPageAllocator::Create (AsyncPageAllocator **allocator, size
     }
     
     
-    /* Construct the allocator state in-place at the start of our allocated page.  */
-    AsyncPageAllocator *a = ::new (placement_new_tag_t(), usable_page) AsyncPageAllocator(
+    /* Provide the newly allocated (and self-referential) structure to the caller. */
+    *allocator = Construct(base_page, total_size, options);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Construct the allocator state in-place at the start of the usable pages of an existing allocation, the guard pages
+ * of which have already been protected.
+ *
+ * @param base_page The base address of the allocation, including the leading guard page, if any.
+ * @param total_size The total number of bytes allocated at @a base_page, including all guard pages.
+ * @param options The AsyncAllocatorOption flags with which the allocation was laid out.
+ *
+ * @warning This method is async-safe.
+ */
+AsyncPageAllocator *AsyncPageAllocator::Construct (vm_address_t base_page, vm_size_t total_size, uint32_t options) {
+    vm_address_t usable_page = base_page;
+    vm_size_t usable_size = total_size;
+
+    if (options & GuardLowPage) {
+        usable_page += PAGE_SIZE;
+        usable_size -= PAGE_SIZE;
+    }
+
+    if (options & GuardHighPage)
+        usable_size -= PAGE_SIZE;
+
+    return ::new (placement_new_tag_t(), usable_page) AsyncPageAllocator(
         base_page,
         total_size,
         usable_page + sizeof(AsyncPageAllocator), /* Skip this initial allocation. */
         usable_size - sizeof(AsyncPageAllocator)
     );
+}
+
+/**
+ * Reserve @a count regions of at least @a size usable bytes each via a single vm_allocate(), protecting every region's
+ * guard pages. Any regions remaining from a previous call are first released.
+ *
+ * @param size The minimum size of each region, as would be passed to AsyncPageAllocator::Create(). This will be
+ * rounded up to the nearest page size and must not be zero.
+ * @param count The number of regions to reserve.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, the batch is left empty, and one of the plcrash_error_t
+ * error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t AsyncPageBatch::nasync_init (size_t size, size_t count) {
+    kern_return_t kt;
+
+    nasync_release();
+    if (count == 0)
+        return PLCRASH_ESUCCESS;
+
+    vm_size_t stride = round_page(size) + (2 * PAGE_SIZE);
+    vm_address_t base;
+    kt = vm_allocate(mach_task_self(), &base, stride * count, VM_FLAGS_ANYWHERE);
+    if (kt != KERN_SUCCESS) {
+        PLCF_DEBUG("[AsyncPageBatch] vm_allocate() failure: %d", kt);
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Each region's high guard page is adjacent to the next region's low guard page; protect each pair together. */
+    for (size_t i = 0; i <= count; i++) {
+        vm_address_t guard = (i == 0) ? base : base + (i * stride) - PAGE_SIZE;
+        vm_size_t guard_size = (i == 0 || i == count) ? PAGE_SIZE : 2 * PAGE_SIZE;
+
+        kt = vm_protect(mach_task_self(), guard, guard_size, false, VM_PROT_NONE);
+        if (kt != KERN_SUCCESS) {
+            PLCF_DEBUG("[AsyncPageBatch] vm_protect() failure: %d", kt);
+
+            kt = vm_deallocate(mach_task_self(), base, stride * count);
+            if (kt != KERN_SUCCESS)
+                PLCF_DEBUG("[AsyncPageBatch] vm_deallocate() failure: %d", kt);
+
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    _base = base;
+    _stride = stride;
+    _count = count;
+    _next = 0;
 
-    /* Provide the newly allocated (and self-referential) structure to the caller. */
-    *allocator = a;
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Release all untaken regions in excess of @a count.
+ *
+ * @param count The maximum number of untaken regions to retain.
+ *
+ * @warning This method is not async-safe.
+ */
+void AsyncPageBatch::nasync_trim (size_t count) {
+    if (available() <= count)
+        return;
+
+    size_t retained = _next + count;
+    kern_return_t kt = vm_deallocate(mach_task_self(), _base + (retained * _stride), (_count - retained) * _stride);
+    if (kt != KERN_SUCCESS)
+        PLCF_DEBUG("[AsyncPageBatch] vm_deallocate() failure: %d", kt);
+
+    _count = retained;
+}
+
+/**
+ * Release all untaken regions, leaving the batch empty. Regions that have been taken remain owned by their
+ * AsyncPageAllocator instances.
+ *
+ * @warning This method is not async-safe.
+ */
+void AsyncPageBatch::nasync_release () {
+    nasync_trim(0);
+
+    _base = 0;
+    _stride = 0;
+    _count = 0;
+    _next = 0;
+}
+
+/**
+ * Fault in, and optionally wire, the usable pages of all untaken regions. The wiring is released when a region is
+ * deallocated, whether by its AsyncPageAllocator or by the batch.
+ *
+ * @param wire If true, the pages will also be wired via mlock().
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. If mlock() fails, the remaining regions are still prefaulted, and
+ * PLCRASH_ENOMEM is returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t AsyncPageBatch::nasync_prefault (bool wire) {
+    plcrash_error_t result = PLCRASH_ESUCCESS;
+
+    for (size_t i = _next; i < _count; i++) {
+        vm_address_t start = _base + (i * _stride) + PAGE_SIZE;
+        vm_address_t end = _base + ((i + 1) * _stride) - PAGE_SIZE;
+
+        /* Untaken regions have never been written; a read-write of the existing value leaves them zero-filled. */
+        for (vm_address_t page = start; page < end; page += PAGE_SIZE) {
+            volatile uint8_t *p = (volatile uint8_t *) page;
+            *p = *p;
+        }
+
+        if (wire && mlock((void *) start, end - start) != 0) {
+            PLCF_DEBUG("[AsyncPageBatch] mlock() failure: %d", errno);
+            result = PLCRASH_ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Take the next untaken region, constructing its AsyncPageAllocator in-place. No kernel calls are made.
+ *
+ * @param allocator On success, will contain a pointer to the region's allocator. It is the caller's responsibility to
+ * free this allocator via `delete`.
+ *
+ * @return Returns true on success, or false if the batch has been exhausted.
+ *
+ * @warning This method is async-safe.
+ */
+bool AsyncPageBatch::take (AsyncPageAllocator **allocator) {
+    if (_next == _count)
+        return false;
+
+    vm_address_t region = _base + (_next * _stride);
+    _next++;
+
+    *allocator = AsyncPageAllocator::Construct(region, _stride, AsyncPageAllocator::GuardLowPage | AsyncPageAllocator::GuardHighPage);
+    return true;
+}
+
+/**
+ * Exchange the regions held by this batch with those held by @a other.
+ *
+ * @param other The batch with which this batch's state will be exchanged.
+ *
+ * @warning This method is async-safe.
+ */
+void AsyncPageBatch::swap (AsyncPageBatch &other) {
+    AsyncPageBatch tmp;
+
+    tmp._base = _base; tmp._stride = _stride; tmp._count = _count; tmp._next = _next;
+    _base = other._base; _stride = other._stride; _count = other._count; _next = other._next;
+    other._base = tmp._base; other._stride = tmp._stride; other._count = tmp._count; other._next = tmp._next;
+}
+
 PLCR_CPP_END_ASYNC_NS
@@ -89,9 +89,15 @@ public:
     
     /** Return the number of usable bytes at the address returned by usable_address(). */
     vm_address_t usable_size () { return _usable_size; }
+
+    plcrash_error_t nasync_prefault (bool wire);
     
 private:
+    friend class AsyncPageBatch;
+
     AsyncPageAllocator (vm_address_t base_page, vm_size_t total_size, vm_address_t usable_address, vm_size_t usable_size);
+
+    static AsyncPageAllocator *Construct (vm_address_t base_page, vm_size_t total_size, uint32_t options);
     
     /** The address base of the allocation. */
     const vm_address_t _base_page;
@@ -104,6 +110,64 @@ private:
 
     /** The usable size of the allocation (ie, total size, minus guard pages and any internal AsyncPageAllocator state) */
     const vm_size_t _usable_size;
+
+    /** True if the usable pages have been wired via nasync_prefault(), and must be unwired on deallocation. */
+    bool _wired;
+};
+
+/**
+ * @internal
+ *
+ * A batch of identically sized, guarded page regions, reserved via a single vm_allocate() and handed out as
+ * AsyncPageAllocator instances on demand.
+ *
+ * All kernel calls -- the allocation itself, and the protection of every region's guard pages -- are performed by
+ * nasync_init(). Taking a region from the batch only constructs the AsyncPageAllocator in-place at the start of the
+ * region's (zero-fill on demand) pages, and is async-safe. Each region is laid out exactly as by
+ * AsyncPageAllocator::Create() with both guard pages enabled, and once taken, is owned (and deallocated) by its
+ * AsyncPageAllocator independently of the batch.
+ *
+ * The batch has a trivial destructor, allowing it to be embedded within memory that is itself released before the
+ * owner's member destructors run; the owner must call nasync_release() to release any regions that were not taken.
+ *
+ * The batch performs no internal synchronization; concurrent access must be externally synchronized.
+ */
+class AsyncPageBatch {
+public:
+    /** Construct an empty batch. */
+    AsyncPageBatch () : _base(0), _stride(0), _count(0), _next(0) {}
+
+    /* Copying would alias the untaken regions; use swap() to transfer them. */
+    AsyncPageBatch (const AsyncPageBatch &other) = delete;
+    AsyncPageBatch &operator= (const AsyncPageBatch &other) = delete;
+
+    plcrash_error_t nasync_init (size_t size, size_t count);
+    void nasync_trim (size_t count);
+    void nasync_release ();
+    plcrash_error_t nasync_prefault (bool wire);
+
+    bool take (AsyncPageAllocator **allocator);
+
+    /** Return the number of regions that have not yet been taken. */
+    size_t available () const { return _count - _next; }
+
+    /** Return the number of bytes available to the user of each region, via AsyncPageAllocator::usable_size(). */
+    vm_size_t usable_size () const { return _stride == 0 ? 0 : _stride - (2 * PAGE_SIZE) - sizeof(AsyncPageAllocator); }
+
+    void swap (AsyncPageBatch &other);
+
+private:
+    /** The base address of the first untaken region's allocation, or 0 if the batch is empty. */
+    vm_address_t _base;
+
+    /** The size of each region, including both guard pages. */
+    vm_size_t _stride;
+
+    /** The total number of regions, taken or untaken, at _base. */
+    size_t _count;
+
+    /** The index of the next region to be taken. */
+    size_t _next;
 };
     
 PLCR_CPP_END_ASYNC_NS
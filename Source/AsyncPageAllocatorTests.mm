@@ -99,4 +99,47 @@ using namespace plcrash::async;
     delete allocator;
 }
 
+/**
+ * Test allocation of guarded regions from a single batch mapping.
+ */
+- (void) testBatch {
+    AsyncPageBatch batch;
+    AsyncPageAllocator *allocators[3];
+
+    STAssertEquals(PLCRASH_ESUCCESS, batch.nasync_init(PAGE_SIZE, 4), @"Failed to reserve batch");
+    STAssertEquals(batch.available(), (size_t) 4, @"Incorrect region count");
+
+    /* Releasing the excess region must leave the remaining regions intact */
+    batch.nasync_trim(3);
+    STAssertEquals(batch.available(), (size_t) 3, @"Region was not trimmed");
+
+    for (size_t i = 0; i < 3; i++) {
+        STAssertTrue(batch.take(&allocators[i]), @"Failed to take region");
+        STAssertEquals((vm_size_t) allocators[i]->usable_size(), batch.usable_size(), @"Incorrect usable size");
+
+        /* The region must be writable in its entirety */
+        memset((void *) allocators[i]->usable_address(), 0xAB, allocators[i]->usable_size());
+    }
+    STAssertFalse(batch.take(&allocators[0]), @"Exhausted batch returned a region");
+    STAssertEquals(batch.available(), (size_t) 0, @"Incorrect region count");
+
+    /* Each region must be bracketed by guard pages */
+    vm_address_t guard_addr = allocators[1]->usable_address() + allocators[1]->usable_size();
+    vm_size_t guard_size = PAGE_SIZE;
+    vm_region_basic_info_data_64_t guard_vm_info;
+    mach_msg_type_number_t guard_vm_info_len = VM_REGION_BASIC_INFO_COUNT_64;
+    mach_port_t vm_obj;
+
+    kern_return_t kr = vm_region_64(mach_task_self(), &guard_addr, &guard_size, VM_REGION_BASIC_INFO_64, (vm_region_info_t) &guard_vm_info, &guard_vm_info_len, &vm_obj);
+    STAssertEquals(KERN_SUCCESS, kr, @"Failed to fetch VM info");
+    STAssertEquals(guard_addr, (vm_address_t) (allocators[1]->usable_address() + allocators[1]->usable_size()), @"Incorrect base address");
+    STAssertTrue((guard_vm_info.protection & (VM_PROT_READ|VM_PROT_WRITE)) == 0, @"Guard page should not be accessible!");
+
+    /* Each taken region is independently owned */
+    for (size_t i = 0; i < 3; i++)
+        delete allocators[i];
+
+    batch.nasync_release();
+}
+
 @end
@@ -39,6 +39,13 @@
 #import "PLCrashReporter.h"
 #import "PLCrashReport.h"
 #import "PLCrashReportTextFormatter.h"
+#import "PLCrashReportJSONFormatter.h"
+#import "PLCrashSampler.h"
+#import "PLCrashHangDetector.h"
+#import "PLCrashReportLog.h"
+#import "PLCrashReportBundle.h"
+#import "PLCrashBacktrace.h"
+#import "PLCrashHelperServer.h"
 
 /**
  * @defgroup functions Crash Reporter Functions Reference
@@ -109,6 +116,13 @@ typedef enum {
 #import "PLCrashReporter.h"
 #import "PLCrashReport.h"
 #import "PLCrashReportTextFormatter.h"
+#import "PLCrashReportJSONFormatter.h"
+#import "PLCrashSampler.h"
+#import "PLCrashHangDetector.h"
+#import "PLCrashReportLog.h"
+#import "PLCrashReportBundle.h"
+#import "PLCrashBacktrace.h"
+#import "PLCrashHelperServer.h"
 
 /**
  * @mainpage Plausible Crash Reporter
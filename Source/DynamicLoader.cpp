@@ -28,9 +28,15 @@
 
 #include "DynamicLoader.hpp"
 #include <inttypes.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <mach-o/dyld.h>
 
 #include "PLCrashAsyncMObject.h"
-#include "PLCrashAsyncMachOString.h"
+#include "PLCrashAsyncObjCSection.h"
+#include "MObjectPool.hpp"
+#include "PLCrashAsyncImageIndexCache.h"
+#include "PLCrashScheduler.h"
 
 PLCR_CPP_BEGIN_ASYNC_NS
 
@@ -71,7 +77,143 @@ private:
         /** A pointer to an array of `struct dyld_image_info` values */
         machine_ptr     _infoArray;
     };
-    
+
+    /**
+     * The maximum span of header addresses that will be mapped as a single range by readImagesBulk(). The headers of
+     * the dyld shared cache's images are densely packed within the cache's text region, and the majority of a process'
+     * images will fall within a small number of such ranges.
+     */
+    static constexpr pl_vm_size_t bulk_span = 32 * 1024 * 1024;
+
+    /** The number of bytes following the last header of a range that will be mapped to cover its load commands. */
+    static constexpr pl_vm_size_t bulk_header_length = 32 * 1024;
+
+    /**
+     * Restore the max-heap property of the first @a count entries of @a order, ordered by the header address of the
+     * referenced @a infos entry, beginning at @a parent.
+     */
+    static void siftDown (const image_info *infos, uint32_t *order, uint32_t parent, uint32_t count) {
+        while (true) {
+            uint32_t child = (parent * 2) + 1;
+            if (child >= count)
+                return;
+
+            if (child + 1 < count && infos[order[child]]._imageLoadAddress < infos[order[child + 1]]._imageLoadAddress)
+                child++;
+
+            if (infos[order[parent]]._imageLoadAddress >= infos[order[child]]._imageLoadAddress)
+                return;
+
+            uint32_t tmp = order[parent];
+            order[parent] = order[child];
+            order[child] = tmp;
+            parent = child;
+        }
+    }
+
+    /**
+     * Initialize @a images from the @a count entries of @a infos, mapping the images' headers and load commands in
+     * a small number of large ranges rather than individually.
+     *
+     * The images are visited in header address order; each run of headers falling within bulk_span of the run's first
+     * header is mapped via a single pooled mapping, over which the run's images are then initialized. Images that can
+     * not be parsed are skipped, and the remaining images are compacted into @a images in their original order.
+     *
+     * @param allocator The allocator to be used for the images and any temporary state.
+     * @param task The task from which the images will be read.
+     * @param infos The dyld image info entries.
+     * @param count The number of entries in @a infos.
+     * @param images The destination array, with room for @a count images.
+     * @param[out] loaded On success, the number of images initialized in @a images.
+     *
+     * @return On success, returns PLCRASH_ESUCCESS. If the temporary state can not be allocated, an error is returned
+     * and no images will have been initialized.
+     */
+    static plcrash_error_t readImagesBulk (AsyncAllocator *allocator, task_t task, const image_info *infos, uint32_t count, plcrash_async_macho_t *images, size_t *loaded) {
+        uint32_t *order;
+        bool *valid;
+        plcrash_error_t err;
+
+        if (count == 0) {
+            *loaded = 0;
+            return PLCRASH_ESUCCESS;
+        }
+
+        /* The validity flags follow the sort order, preserving the alignment of each */
+        void *storage;
+        if ((err = allocator->alloc(&storage, (sizeof(uint32_t) + sizeof(bool)) * count)) != PLCRASH_ESUCCESS)
+            return err;
+
+        order = (uint32_t *) storage;
+        valid = (bool *) (order + count);
+
+        MObjectPool *pool = new (allocator) MObjectPool(allocator);
+        if (pool == nullptr) {
+            allocator->dealloc(storage);
+            return PLCRASH_ENOMEM;
+        }
+
+        /* Heap sort the entries by header address; this is async-safe, and is never quadratic. */
+        for (uint32_t i = 0; i < count; i++)
+            order[i] = i;
+
+        for (uint32_t i = count / 2; i > 0; i--)
+            siftDown(infos, order, i - 1, count);
+
+        for (uint32_t n = count; n > 1; n--) {
+            uint32_t tmp = order[0];
+            order[0] = order[n - 1];
+            order[n - 1] = tmp;
+            siftDown(infos, order, 0, n - 1);
+        }
+
+        /* Initialize the images, one run of nearby headers at a time */
+        for (uint32_t start = 0; start < count;) {
+            pl_vm_address_t run_base = infos[order[start]]._imageLoadAddress;
+            uint32_t end = start + 1;
+            while (end < count && infos[order[end]]._imageLoadAddress - run_base < bulk_span)
+                end++;
+
+            /* Map the full run up front. Single-image runs are left to the image itself, as are any images
+             * whose load commands fall outside of a short mapping; the pool will map those individually. */
+            if (end - start > 1) {
+                pl_vm_address_t run_end = infos[order[end - 1]]._imageLoadAddress + bulk_header_length;
+                shared_ptr<MObjectPool::Mapping> mapping;
+                if ((err = pool->map(task, run_base, run_end - run_base, false, &mapping)) != PLCRASH_ESUCCESS)
+                    PLCF_DEBUG("Failed to map image headers at 0x%" PRIx64 ", mapping individually: %d", (uint64_t) run_base, err);
+            }
+
+            for (uint32_t i = start; i < end; i++) {
+                const image_info *info = &infos[order[i]];
+                err = plcrash_async_macho_init_pooled(&images[order[i]], allocator, task, info->_imageFilePath, info->_imageLoadAddress, pool);
+                if (err != PLCRASH_ESUCCESS)
+                    PLCF_DEBUG("Failed to load Mach-O image info from base address %" PRIu64 ", skipping: %d", (uint64_t) info->_imageLoadAddress, err);
+
+                valid[order[i]] = (err == PLCRASH_ESUCCESS);
+            }
+
+            start = end;
+        }
+
+        /* Compact the initialized images, preserving dyld's image order. The images hold their own references to
+         * any pooled mappings, and the pool itself may be discarded. */
+        size_t n = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!valid[i])
+                continue;
+
+            if (n != i)
+                images[n] = images[i];
+            n++;
+        }
+
+        delete pool;
+        allocator->dealloc(storage);
+
+        *loaded = n;
+        return PLCRASH_ESUCCESS;
+    }
+
 public:
     /**
      * Read the image list from @a target, returning a valid image list via @a image_list on success. The caller
@@ -135,23 +277,21 @@ public:
             
         }
         
+        /* When reading from another task, map the images' headers in bulk; most images reside within the dyld shared
+         * cache, and would otherwise require a separate mapping each. The current task's images are referenced in
+         * place, and require no mappings. */
+        if (task != mach_task_self() && readImagesBulk(allocator, task, info, all_infos._infoArrayCount, images_array, &image_list_count) == PLCRASH_ESUCCESS) {
+            *image_list = new (allocator) DynamicLoader::ImageList(allocator, images_array, image_list_count);
+            err = PLCRASH_ESUCCESS;
+            goto cleanup;
+        }
+
         /* Initialize our plcrash_async_macho_t from the all_infos array. */
         invalid_info_count = 0;
         for (uint32_t i = 0; i < all_infos._infoArrayCount; i++) {
-            plcrash_async_macho_string_t name_str;
-            const char *name = NULL;
-
-            /* Try to fetch a reference to the image's path string. Failure to fetch the name is not a fatal error, but it should generally not happen. */
-            if ((err = plcrash_async_macho_string_init(&name_str, task, info->_imageFilePath)) != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Failed to initialize plcrash_async_macho_string_t for string address %" PRIu64 ": %d", (uint64_t) info->_imageFilePath, err);
-            } else {
-                if ((err = plcrash_async_macho_string_get_pointer(&name_str, &name)) != PLCRASH_ESUCCESS) {
-                    PLCF_DEBUG("Failed to fetch image name string pointer at address %" PRIu64 ": %d", (uint64_t) info->_imageFilePath, err);
-                }
-            }
-            
-            /* Initialize our actual mach-o image instance */
-            if ((err = plcrash_async_macho_init(&images_array[i - invalid_info_count], allocator, task, name, info->_imageLoadAddress)) != PLCRASH_ESUCCESS) {
+            /* Initialize our actual mach-o image instance. The image's path is only read from the target if it is
+             * requested, as most reports reference a small subset of the loaded images. */
+            if ((err = plcrash_async_macho_init_lazy_name(&images_array[i - invalid_info_count], allocator, task, info->_imageFilePath, info->_imageLoadAddress)) != PLCRASH_ESUCCESS) {
                 /* If we can't read the image, update the failed image count and continue. We still want to gather as many images
                  * as we can. */
                 PLCF_DEBUG("Failed to load Mach-O image info from base address %" PRIu64 ", skipping: %d", (uint64_t) info->_imageLoadAddress, err);
@@ -161,9 +301,6 @@ public:
             
             /* Iterate */
             info++;
-            
-            /* Clean up! */
-            plcrash_async_macho_string_free(&name_str);
         }
         
         /* Success! We just need to adjust our total count and return our ImageList. */
@@ -221,6 +358,10 @@ plcrash_error_t DynamicLoader::NonAsync_Create (DynamicLoader **loader, AsyncAll
  * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
  */
 plcrash_error_t DynamicLoader::readImageList (AsyncAllocator *allocator, DynamicLoader::ImageList **image_list) {
+    /* Prefer the already-parsed images maintained by our monitor, if any */
+    if (_monitor != NULL)
+        return _monitor->readImageList(allocator, image_list);
+
     switch (_dyld_info.all_image_info_format) {
         case TASK_DYLD_ALL_IMAGE_INFO_32:
             return DyldImageInfo<uint32_t>::readImageList(allocator, _task, _dyld_info, image_list);
@@ -240,7 +381,7 @@ plcrash_error_t DynamicLoader::readImageList (AsyncAllocator *allocator, Dynamic
  * @param task The target task.
  * @param dyld_info The TASK_DYLD_INFO data fetched from @a task.
  */
-DynamicLoader::DynamicLoader (task_t task, struct task_dyld_info dyld_info) : _task(MACH_PORT_NULL), _dyld_info(dyld_info) {
+DynamicLoader::DynamicLoader (task_t task, struct task_dyld_info dyld_info) : _task(MACH_PORT_NULL), _dyld_info(dyld_info), _monitor(NULL) {
     /* Add a proper refcount for the task */
     setTask(task);
 }
@@ -267,6 +408,104 @@ void DynamicLoader::setTask (task_t new_task) {
         mach_port_mod_refs(mach_task_self(), _task, MACH_PORT_RIGHT_SEND, 1);
 }
 
+/**
+ * Enable use of the shared ImageListMonitor; subsequent calls to readImageList() will return the monitor's
+ * incrementally maintained images rather than reading and parsing the image list from dyld.
+ *
+ * The monitor is only available when the target task is the current process.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned,
+ * and the loader will continue to read the image list directly from dyld.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t DynamicLoader::NonAsync_EnableImageListMonitor () {
+    if (_task != mach_task_self()) {
+        PLCF_DEBUG("The image list monitor is only supported for the current task");
+        return PLCRASH_ENOTSUP;
+    }
+
+    return ImageListMonitor::NonAsync_Shared(&_monitor);
+}
+
+/**
+ * Enable background construction of Objective-C method indexes for all images maintained by the shared
+ * ImageListMonitor, allowing crash-time ObjC symbolication to binary search a prebuilt index rather than parsing
+ * each image's class metadata.
+ *
+ * The image list monitor must have already been enabled via NonAsync_EnableImageListMonitor().
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t DynamicLoader::NonAsync_EnableObjCMethodIndex () {
+    if (_monitor == NULL) {
+        PLCF_DEBUG("The ObjC method index requires the image list monitor");
+        return PLCRASH_ENOTSUP;
+    }
+
+    return _monitor->nasync_enableObjCMethodIndex();
+}
+
+/**
+ * Enable the persistent image index cache for all images maintained by the shared ImageListMonitor. Each image's
+ * symbol and ObjC method indexes are loaded from @a directory if previously cached; otherwise, they are built in the
+ * background and then written to @a directory, keyed by the image's UUID.
+ *
+ * This must be called prior to NonAsync_EnableObjCMethodIndex(), which starts the background index builds.
+ *
+ * @param directory The cache directory, which must already exist. The path is copied.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t DynamicLoader::NonAsync_EnableIndexCache (const char *directory) {
+    if (_monitor == NULL) {
+        PLCF_DEBUG("The image index cache requires the image list monitor");
+        return PLCRASH_ENOTSUP;
+    }
+
+    return _monitor->nasync_enableIndexCache(directory);
+}
+
+/**
+ * Fetch the number of images that have been unloaded from the current process. Callers that cache state derived
+ * from previously read image lists (such as class or symbol table references) may compare this value across
+ * reads to determine whether that state may refer to an unloaded image.
+ *
+ * @param[out] count On success, the number of images unloaded since the image list monitor was enabled.
+ *
+ * @return Returns true on success, or false if the image list monitor has not been enabled via
+ * NonAsync_EnableImageListMonitor(), in which case no unload count is available.
+ */
+bool DynamicLoader::imageUnloadCount (uint32_t *count) {
+    if (_monitor == NULL)
+        return false;
+
+    *count = _monitor->unloadCount();
+    return true;
+}
+
+/**
+ * Fetch the current image list generation. The generation changes each time an image is added to or removed from
+ * the process' image list; callers that persist an image list once and then refer to it from multiple reports may
+ * compare this value across reads to determine whether the persisted list is still current.
+ *
+ * @param[out] generation On success, the current image list generation.
+ *
+ * @return Returns true on success, or false if the image list monitor has not been enabled via
+ * NonAsync_EnableImageListMonitor(), in which case no generation is available.
+ */
+bool DynamicLoader::imageGeneration (uint32_t *generation) {
+    if (_monitor == NULL)
+        return false;
+
+    *generation = _monitor->generation();
+    return true;
+}
+
 DynamicLoader::~DynamicLoader () {
     /* Discard our task port reference, if any */
     setTask(MACH_PORT_NULL);
@@ -305,16 +544,193 @@ plcrash_error_t DynamicLoader::ImageList::NonAsync_Read (DynamicLoader::ImageLis
     return err;
 }
 
+/**
+ * Construct an image list from the Mach-O images at the given header addresses within @a task, rather than from the
+ * task's dyld image list. This supports tasks for which no dyld image list is available, such as a virtual task
+ * reconstructed from a crash report's binary image list.
+ *
+ * Images that can not be parsed are skipped.
+ *
+ * @param[out] imageList On success, will be initialized with a pointer to a new ImageList instance. It is the caller's
+ * responsibility to free this instance via `delete`.
+ * @param allocator The allocator to be used when instantiating the new ImageList instance.
+ * @param task The target task.
+ * @param headers The task-relative addresses of the images' Mach-O headers.
+ * @param names The images' file names or paths, parallel to @a headers. The names are copied.
+ * @param count The number of entries in @a headers and @a names.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t DynamicLoader::ImageList::NonAsync_Create (DynamicLoader::ImageList **imageList, AsyncAllocator *allocator, task_t task, const pl_vm_address_t *headers, const char * const *names, size_t count) {
+    plcrash_async_macho_t *images;
+    plcrash_error_t err;
+    size_t loaded = 0;
+
+    if ((err = allocator->alloc((void **) &images, sizeof(*images) * (count > 0 ? count : 1))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate plcrash_async_macho_t array: %d", err);
+        return err;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if ((err = plcrash_async_macho_init(&images[loaded], allocator, task, names[i], headers[i])) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to load Mach-O image info from base address %" PRIu64 ", skipping: %d", (uint64_t) headers[i], err);
+            continue;
+        }
+
+        loaded++;
+    }
+
+    *imageList = new (allocator) DynamicLoader::ImageList(allocator, images, loaded);
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Construct an empty image list.
  */
-DynamicLoader::ImageList::ImageList () : _allocator(NULL), _images(NULL), _count(0) {}
+DynamicLoader::ImageList::ImageList () : _allocator(NULL), _images(NULL), _image_refs(NULL), _monitor(NULL), _generation(NULL), _count(0), _range_starts(NULL), _range_ends(NULL), _range_images(NULL), _last_hit(SIZE_MAX), _lowest_start(0), _highest_end(0) {}
+
+/**
+ * Construct a new image list; the new list will assume ownership of @a images.
+ *
+ * @param allocator A borrowed reference to the allocator to be used to deallocate @a images.
+ * @param images An array of images. Ownership of this value will be assumed.
+ * @param count The total number of images in @a images.
+ */
+DynamicLoader::ImageList::ImageList (AsyncAllocator *allocator, plcrash_async_macho_t *images, size_t count) :
+    _allocator(allocator), _images(images), _image_refs(NULL), _monitor(NULL), _generation(NULL), _count(count), _range_starts(NULL), _range_ends(NULL), _range_images(NULL), _last_hit(SIZE_MAX), _lowest_start(0), _highest_end(0)
+{
+    buildAddressIndex();
+}
+
+/**
+ * Construct a new image list that borrows its images from @a monitor; the new list will assume ownership of
+ * @a image_refs, and of the caller's read reference on @a monitor.
+ *
+ * @param allocator A borrowed reference to the allocator to be used to deallocate @a image_refs.
+ * @param image_refs An array of borrowed image references. Ownership of this array will be assumed.
+ * @param count The total number of images in @a image_refs.
+ * @param monitor The monitor that owns all images in @a image_refs.
+ */
+DynamicLoader::ImageList::ImageList (AsyncAllocator *allocator, plcrash_async_macho_t **image_refs, size_t count, ImageListMonitor *monitor) :
+    _allocator(allocator), _images(NULL), _image_refs(image_refs), _monitor(monitor), _generation(NULL), _count(count), _range_starts(NULL), _range_ends(NULL), _range_images(NULL), _last_hit(SIZE_MAX), _lowest_start(0), _highest_end(0)
+{
+    buildAddressIndex();
+}
+
+/**
+ * Construct a new image list that borrows its images and address index from @a generation; the new list will
+ * assume ownership of the caller's reference to @a generation.
+ *
+ * @param generation The generation from which the list's contents will be borrowed.
+ */
+DynamicLoader::ImageList::ImageList (ImageListGeneration *generation) :
+    _allocator(NULL), _images(NULL), _image_refs(generation->_list->_image_refs), _monitor(NULL), _generation(generation),
+    _count(generation->_list->_count), _range_starts(generation->_list->_range_starts), _range_ends(generation->_list->_range_ends),
+    _range_images(generation->_list->_range_images), _last_hit(SIZE_MAX), _lowest_start(generation->_list->_lowest_start),
+    _highest_end(generation->_list->_highest_end)
+{
+}
+
+/**
+ * @internal
+ *
+ * Exchange the range index entries at slots @a a and @a b.
+ */
+void DynamicLoader::ImageList::swapRanges (size_t a, size_t b) {
+    pl_vm_address_t start = _range_starts[a];
+    pl_vm_address_t end = _range_ends[a];
+    size_t image = _range_images[a];
+
+    _range_starts[a] = _range_starts[b];
+    _range_ends[a] = _range_ends[b];
+    _range_images[a] = _range_images[b];
+
+    _range_starts[b] = start;
+    _range_ends[b] = end;
+    _range_images[b] = image;
+}
+
+/**
+ * @internal
+ *
+ * Restore the max-heap property of the first @a count range index entries, beginning at @a parent.
+ */
+void DynamicLoader::ImageList::siftDown (size_t parent, size_t count) {
+    while (true) {
+        size_t child = (parent * 2) + 1;
+        if (child >= count)
+            return;
+
+        if (child + 1 < count && _range_starts[child] < _range_starts[child + 1])
+            child++;
+
+        if (_range_starts[parent] >= _range_starts[child])
+            return;
+
+        swapRanges(parent, child);
+        parent = child;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Populate the range index with the TEXT ranges of all images, sorted by start address. If the index can not be
+ * allocated, _range_starts will be left NULL.
+ */
+void DynamicLoader::ImageList::buildAddressIndex () {
+    if (_count == 0)
+        return;
+
+    /* The start and end arrays precede the image index array, preserving the alignment of each */
+    plcrash_error_t err;
+    void *storage;
+    if ((err = _allocator->alloc(&storage, (sizeof(pl_vm_address_t) * 2 + sizeof(size_t)) * _count)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate image address index, falling back to linear lookup: %d", err);
+        return;
+    }
+
+    _range_starts = (pl_vm_address_t *) storage;
+    _range_ends = _range_starts + _count;
+    _range_images = (size_t *) (_range_ends + _count);
+
+    for (size_t i = 0; i < _count; i++) {
+        plcrash_async_macho_t *image = getImage(i);
+
+        _range_starts[i] = image->header_addr;
+        _range_ends[i] = image->header_addr + image->text_size;
+        _range_images[i] = i;
+    }
+
+    /* Heap sort by start address; this is async-safe, requires no additional storage, and is never quadratic. */
+    for (size_t i = _count / 2; i > 0; i--)
+        siftDown(i - 1, _count);
+
+    for (size_t n = _count; n > 1; n--) {
+        swapRanges(0, n - 1);
+        siftDown(0, n - 1);
+    }
+
+    /* Record the span of the index, allowing classifyAddresses() to reject most addresses without searching */
+    _lowest_start = _range_starts[0];
+    _highest_end = _range_ends[0];
+    for (size_t i = 1; i < _count; i++) {
+        if (_range_ends[i] > _highest_end)
+            _highest_end = _range_ends[i];
+    }
+}
 
 /**
  * Return a borrowed reference to the Mach-O image entry at @a index.
  */
 plcrash_async_macho_t *DynamicLoader::ImageList::getImage (size_t index) {
     PLCF_ASSERT(index < _count);
+
+    if (_image_refs != NULL)
+        return _image_refs[index];
+
     return &_images[index];
 }
 
@@ -332,16 +748,171 @@ size_t DynamicLoader::ImageList::count () { return _count; }
  * @warning The list must be retained for reading via plcrash_async_image_list_set_reading() before calling this function.
  */
 plcrash_async_macho_t *DynamicLoader::ImageList::imageContainingAddress (pl_vm_address_t address) {
-    for (size_t i = 0; i < _count; i++) {
-        if (plcrash_async_macho_contains_address(getImage(i), address))
-            return getImage(i);
-    }
+    size_t index;
+    if (!indexOfImageContainingAddress(address, &index))
+        return NULL;
+
+    return getImage(index);
+}
+
+/**
+ * Find the index of the image containing the given @a address within its TEXT segment.
+ *
+ * @param address The target-relative address to be searched for.
+ * @param index On success, the index of the image within this list.
+ *
+ * @return Returns true if the image was found, or false otherwise.
+ */
+bool DynamicLoader::ImageList::indexOfImageContainingAddress (pl_vm_address_t address, size_t *index) {
+    /* If the index could not be allocated, fall back to a linear search */
+    if (_range_starts == NULL) {
+        for (size_t i = 0; i < _count; i++) {
+            if (plcrash_async_macho_contains_address(getImage(i), address)) {
+                *index = i;
+                return true;
+            }
+        }
     
-    /* Not found */
-    return NULL;
+        /* Not found */
+        return false;
+    }
+
+    /* Successive lookups frequently target the same image */
+    size_t last = _last_hit;
+    if (last != SIZE_MAX && address >= _range_starts[last] && address < _range_ends[last]) {
+        *index = _range_images[last];
+        return true;
+    }
+
+    size_t slot;
+    if (!findRange(address, &slot))
+        return false;
+
+    _last_hit = slot;
+    *index = _range_images[slot];
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Search the range index for the slot containing @a address. _range_starts must be non-NULL.
+ *
+ * @param address The address to be searched for.
+ * @param slot On success, the index of the matching range index slot.
+ *
+ * @return Returns true if @a address lies within an indexed range, or false otherwise.
+ */
+bool DynamicLoader::ImageList::findRange (pl_vm_address_t address, size_t *slot) {
+    /* Find the last entry with a start address <= address */
+    size_t low = 0;
+    size_t high = _count;
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if (_range_starts[mid] <= address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return false;
+
+    if (address >= _range_ends[low - 1])
+        return false;
+
+    *slot = low - 1;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * The number of addresses tested at once by classifyAddresses().
+ */
+#define CLASSIFY_LANES 4
+
+/**
+ * @internal
+ *
+ * A vector of CLASSIFY_LANES target addresses. This maps to a pair of NEON/SSE2 registers (or a single AVX2
+ * register) for 64-bit addresses, and to a single register for 32-bit addresses.
+ */
+typedef pl_vm_address_t classify_vector __attribute__((vector_size(CLASSIFY_LANES * sizeof(pl_vm_address_t))));
+
+/**
+ * Determine which of @a addresses fall within the TEXT segment of an image in this list. This is intended for
+ * heuristic scanning of stack and register memory for return addresses, in which the vast majority of candidate
+ * words are not code addresses.
+ *
+ * Addresses are tested CLASSIFY_LANES at a time against the overall span of the address index using vector
+ * comparisons; only those lanes that fall within the span are resolved via a search of the index.
+ *
+ * @param addresses The target-relative addresses to be classified.
+ * @param count The number of addresses in @a addresses.
+ * @param[out] matches An array of @a count entries; on return, each entry will be set to true if the corresponding
+ * address lies within an image's TEXT segment, or false otherwise.
+ *
+ * @return Returns the number of addresses that lie within an image's TEXT segment.
+ *
+ * @warning The list must be retained for reading via plcrash_async_image_list_set_reading() before calling this function.
+ */
+size_t DynamicLoader::ImageList::classifyAddresses (const pl_vm_address_t *addresses, size_t count, bool *matches) {
+    size_t found = 0;
+    size_t i = 0;
+
+    /* Without an index, fall back on individual lookups */
+    if (_range_starts == NULL) {
+        for (i = 0; i < count; i++) {
+            size_t index;
+            matches[i] = indexOfImageContainingAddress(addresses[i], &index);
+            found += matches[i];
+        }
+        return found;
+    }
+
+    for (; i + CLASSIFY_LANES <= count; i += CLASSIFY_LANES) {
+        classify_vector words;
+        for (size_t lane = 0; lane < CLASSIFY_LANES; lane++)
+            words[lane] = addresses[i + lane];
+
+        /* Each lane is all-ones if the word lies within the span of the index, zero otherwise */
+        classify_vector candidates = (classify_vector) ((words >= _lowest_start) & (words < _highest_end));
+
+        bool any = false;
+        for (size_t lane = 0; lane < CLASSIFY_LANES; lane++)
+            any |= (candidates[lane] != 0);
+
+        if (!any) {
+            for (size_t lane = 0; lane < CLASSIFY_LANES; lane++)
+                matches[i + lane] = false;
+            continue;
+        }
+
+        for (size_t lane = 0; lane < CLASSIFY_LANES; lane++) {
+            size_t slot;
+            matches[i + lane] = (candidates[lane] != 0 && findRange(words[lane], &slot));
+            found += matches[i + lane];
+        }
+    }
+
+    /* Classify any remaining addresses individually */
+    for (; i < count; i++) {
+        size_t slot;
+        matches[i] = (addresses[i] >= _lowest_start && addresses[i] < _highest_end && findRange(addresses[i], &slot));
+        found += matches[i];
+    }
+
+    return found;
 }
 
 DynamicLoader::ImageList::~ImageList () {
+    /* Everything else is borrowed from our generation */
+    if (_generation != NULL) {
+        _generation->release();
+        return;
+    }
+
     if (_images != NULL) {
         /* Clean up all image instances. */
         for (size_t i = 0; i < _count; i++) {
@@ -351,6 +922,478 @@ DynamicLoader::ImageList::~ImageList () {
         /* And now the actual array */
         _allocator->dealloc(_images);
     }
+
+    if (_range_starts != NULL)
+        _allocator->dealloc(_range_starts);
+
+    /* Borrowed images are owned by our monitor; we only need to release our array and read reference */
+    if (_image_refs != NULL)
+        _allocator->dealloc(_image_refs);
+
+    if (_monitor != NULL)
+        _monitor->endReading();
+}
+
+/** The shared image list monitor, or NULL if not yet created. */
+static ImageListMonitor *shared_image_list_monitor = NULL;
+
+/** Lock that must be held when creating shared_image_list_monitor. */
+static OSSpinLock shared_image_list_monitor_lock = OS_SPINLOCK_INIT;
+
+/**
+ * Return the shared monitor, creating it and registering for dyld image callbacks if necessary.
+ *
+ * @param[out] monitor On success, a borrowed reference to the shared monitor instance.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t ImageListMonitor::NonAsync_Shared (ImageListMonitor **monitor) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+
+    OSSpinLockLock(&shared_image_list_monitor_lock);
+    if (shared_image_list_monitor == NULL) {
+        /* The monitor is never deallocated; its allocator will continue to back all image entries for the life of the process */
+        AsyncAllocator *allocator;
+        if ((err = AsyncAllocator::Create(&allocator, PAGE_SIZE * 16)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to create image list monitor allocator: %d", err);
+            goto cleanup;
+        }
+
+        ImageListMonitor *m = new (allocator) ImageListMonitor(allocator);
+        if (m == NULL) {
+            PLCF_DEBUG("Failed to allocate image list monitor");
+            delete allocator;
+            err = PLCRASH_ENOMEM;
+            goto cleanup;
+        }
+
+        /* The monitor must be visible prior to registration; dyld will immediately call our add callback for all
+         * currently loaded images. */
+        shared_image_list_monitor = m;
+        OSMemoryBarrier();
+
+        _dyld_register_func_for_add_image(dyldAddImage);
+        _dyld_register_func_for_remove_image(dyldRemoveImage);
+    }
+
+    *monitor = shared_image_list_monitor;
+
+cleanup:
+    OSSpinLockUnlock(&shared_image_list_monitor_lock);
+    return err;
+}
+
+/**
+ * dyld image added callback; parses and appends the new image to the shared monitor's image list.
+ */
+void ImageListMonitor::dyldAddImage (const struct mach_header *header, intptr_t slide) {
+    ImageListMonitor *m = shared_image_list_monitor;
+    plcrash_error_t err;
+
+    /* Opportunistically release any unloaded images that are no longer referenced */
+    m->nasync_releaseRetired();
+
+    /* Fetch the image path */
+    Dl_info info;
+    const char *name = "";
+    if (dladdr(header, &info) != 0 && info.dli_fname != NULL)
+        name = info.dli_fname;
+
+    plcrash_async_macho_t *image;
+    if ((err = m->_allocator->alloc((void **) &image, sizeof(*image))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate image entry for %s: %d", name, err);
+        return;
+    }
+
+    if ((err = plcrash_async_macho_init(image, m->_allocator, mach_task_self(), name, (pl_vm_address_t) header)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to load Mach-O image info from base address %" PRIu64 ", skipping: %d", (uint64_t) (uintptr_t) header, err);
+        m->_allocator->dealloc(image);
+        return;
+    }
+
+    m->_images.nasync_append(image);
+    OSAtomicIncrement32Barrier((volatile int32_t *) &m->_generation);
+    m->nasync_publishGeneration();
+
+    /* Index the image in the background, if enabled */
+    if (m->_index_enabled)
+        m->nasync_scheduleImageIndexes(image);
+}
+
+/**
+ * dyld image removed callback; removes the image from the shared monitor's image list. The image will be
+ * deallocated once no outstanding ImageList instances may refer to it.
+ */
+void ImageListMonitor::dyldRemoveImage (const struct mach_header *header, intptr_t slide) {
+    ImageListMonitor *m = shared_image_list_monitor;
+    plcrash_async_macho_t *image = NULL;
+
+    /* Find the image entry */
+    async_list<plcrash_async_macho_t *>::read_token token = m->_images.begin_reading(); {
+        async_list<plcrash_async_macho_t *>::node *n = NULL;
+        while ((n = m->_images.next(n)) != NULL) {
+            if (n->value()->header_addr == (pl_vm_address_t) header) {
+                image = n->value();
+                break;
+            }
+        }
+    } m->_images.end_reading(token);
+
+    if (image == NULL)
+        return;
+
+    /* Drop any pending index build, releasing its read reference */
+    if (m->_index_enabled)
+        plcrash_nasync_scheduler_cancel_key((uintptr_t) image);
+
+    /* Unlink the entry, and then defer its destruction until no readers are active */
+    m->_images.nasync_remove_first_value(image);
+    if (m->_retired.append(image) != PLCRASH_ESUCCESS) {
+        /* The image may still be referenced by a reader; leaking it is the only safe option */
+        PLCF_DEBUG("Failed to retire unloaded image %s; it will not be deallocated", image->name);
+    }
+    OSAtomicIncrement32Barrier((volatile int32_t *) &m->_unload_count);
+    OSAtomicIncrement32Barrier((volatile int32_t *) &m->_generation);
+    m->nasync_publishGeneration();
+
+    m->nasync_releaseRetired();
+}
+
+/**
+ * Build and publish a new generation containing all currently linked images, retiring the previous generation. If the
+ * generation can not be allocated, no generation is published, and readers will fall back on copying the image list.
+ * This must only be called from the (serialized) dyld callbacks.
+ */
+void ImageListMonitor::nasync_publishGeneration () {
+    ImageListGeneration *generation = NULL;
+    plcrash_async_macho_t **refs;
+    size_t count;
+    plcrash_error_t err;
+
+    /* Only the dyld callbacks unlink images, and they are serialized with this call; no read reference is required. */
+    if ((err = copyImageRefs(_allocator, &refs, &count)) == PLCRASH_ESUCCESS) {
+        DynamicLoader::ImageList *list = new (_allocator) DynamicLoader::ImageList(_allocator, refs, count, NULL);
+        if (list == NULL) {
+            if (refs != NULL)
+                _allocator->dealloc(refs);
+        } else if ((generation = new (_allocator) ImageListGeneration(_allocator, _generation, list)) == NULL) {
+            delete list;
+        }
+    }
+
+    if (generation == NULL)
+        PLCF_DEBUG("Failed to allocate image list generation; image lists will be copied");
+
+    /* Publish the new generation. A reader that loaded the previous generation either holds a reference to it, or is
+     * still registered in _readers; either prevents it from being released. */
+    ImageListGeneration *previous = _current;
+    OSMemoryBarrier();
+    _current = generation;
+    OSMemoryBarrier();
+
+    if (previous != NULL && _retired_generations.append(previous) != PLCRASH_ESUCCESS) {
+        /* The generation may still be referenced by a reader; leaking it is the only safe option */
+        PLCF_DEBUG("Failed to retire image list generation %" PRIu32 "; it will not be deallocated", previous->_number);
+    }
+}
+
+/**
+ * Release all retired images, unless an outstanding ImageList may still refer to them. This must only be called
+ * from the (serialized) dyld callbacks.
+ */
+void ImageListMonitor::nasync_releaseRetired () {
+    /* Readers register prior to iterating _images or loading _current; if none are registered after an image has been
+     * unlinked or a generation replaced, no reader can newly observe it. */
+    OSMemoryBarrier();
+    if (_readers != 0)
+        return;
+
+    /* Release any retired generations whose readers have all left */
+    for (size_t i = _retired_generations.count(); i > 0; i--) {
+        ImageListGeneration *generation = _retired_generations[i - 1];
+        if (generation->_refs != 0)
+            continue;
+
+        delete generation;
+
+        size_t last = _retired_generations.count() - 1;
+        _retired_generations[i - 1] = _retired_generations[last];
+        _retired_generations.remove_last();
+    }
+
+    /* Retired images may be referenced by any retired generation */
+    if (_retired_generations.count() != 0)
+        return;
+
+    for (plcrash_async_macho_t **image = _retired.begin(); image != _retired.end(); image++) {
+        plcrash_async_macho_free(*image);
+        _allocator->dealloc(*image);
+    }
+
+    _retired.clear();
+}
+
+/**
+ * @internal
+ *
+ * The interval after which a pending image index build is promoted from background to utility QoS, bounding the
+ * period for which a loaded image may remain unindexed -- and thus unavailable to the indexed symbol lookups of a
+ * subsequent report -- on a busy device.
+ */
+#define IMAGE_INDEX_DEADLINE_NS (60 * NSEC_PER_SEC)
+
+/**
+ * @internal
+ * A pending image index build.
+ */
+struct image_index_request {
+    /** The monitor holding a read reference on behalf of this request. */
+    ImageListMonitor *monitor;
+
+    /** The image to be indexed. */
+    plcrash_async_macho_t *image;
+};
+
+/**
+ * Enable background construction of ObjC method indexes. Indexes will be built for all currently loaded images,
+ * and for all images subsequently loaded.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t ImageListMonitor::nasync_enableObjCMethodIndex () {
+    /* If we lose the race, indexing has already been enabled. */
+    if (!OSAtomicCompareAndSwap32Barrier(0, 1, &_index_enabled))
+        return PLCRASH_ESUCCESS;
+
+    /* Schedule indexing of all current images. Images appended concurrently may be scheduled twice; the second
+     * submission is coalesced with the first if it is still pending, and otherwise finds the existing index and
+     * returns immediately. */
+    OSAtomicIncrement32Barrier(&_readers);
+    async_list<plcrash_async_macho_t *>::read_token token = _images.begin_reading(); {
+        async_list<plcrash_async_macho_t *>::node *n = NULL;
+        while ((n = _images.next(n)) != NULL)
+            nasync_scheduleImageIndexes(n->value());
+    } _images.end_reading(token);
+    endReading();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Enable the persistent image index cache. Refer to DynamicLoader::NonAsync_EnableIndexCache().
+ *
+ * @param directory The cache directory. The path is copied.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t ImageListMonitor::nasync_enableIndexCache (const char *directory) {
+    size_t len = strlen(directory) + 1;
+    char *copy;
+    plcrash_error_t err;
+
+    if ((err = _allocator->alloc((void **) &copy, len)) != PLCRASH_ESUCCESS)
+        return err;
+    memcpy(copy, directory, len);
+
+    /* Only one directory may be installed; if we lose the race, the existing directory is retained. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, copy, (void * volatile *) &_index_cache_dir))
+        _allocator->dealloc(copy);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Schedule a background index build for @a image on the shared scheduler, keyed by the image address. A read
+ * reference is held until the build completes or is cancelled, preventing the image from being released.
+ *
+ * @param image The image to be indexed.
+ */
+void ImageListMonitor::nasync_scheduleImageIndexes (plcrash_async_macho_t *image) {
+    image_index_request *req;
+    plcrash_error_t err;
+
+    if ((err = _allocator->alloc((void **) &req, sizeof(*req))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate image index request for %s: %d", image->name, err);
+        return;
+    }
+
+    req->monitor = this;
+    req->image = image;
+
+    OSAtomicIncrement32Barrier(&_readers);
+    err = plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, (uintptr_t) image, dispatch_time(DISPATCH_TIME_NOW, (int64_t) IMAGE_INDEX_DEADLINE_NS),
+                                          buildImageIndexes, releaseImageIndexRequest, req, NULL);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to schedule image index build for %s: %d", image->name, err);
+        releaseImageIndexRequest(req);
+    }
+}
+
+/**
+ * Scheduler function that builds the indexes for an image_index_request. The request is released by
+ * releaseImageIndexRequest().
+ *
+ * If the index cache is enabled, the indexes are loaded from the cache when available; otherwise, both the ObjC
+ * method and symbol indexes are built and then written to the cache.
+ */
+void ImageListMonitor::buildImageIndexes (void *context) {
+    image_index_request *req = (image_index_request *) context;
+    ImageListMonitor *m = req->monitor;
+    const char *cache_dir = m->_index_cache_dir;
+    plcrash_error_t err;
+
+    if (cache_dir != NULL && plcrash_nasync_image_index_cache_load(req->image, cache_dir) == PLCRASH_ESUCCESS)
+        return;
+
+    if ((err = plcrash_nasync_objc_build_method_index(req->image)) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Failed to build ObjC method index for %s: %d", req->image->name, err);
+
+    if (cache_dir != NULL) {
+        if ((err = plcrash_nasync_macho_build_symbol_index(req->image)) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Failed to build symbol index for %s: %d", req->image->name, err);
+
+        if ((err = plcrash_nasync_image_index_cache_store(req->image, cache_dir)) != PLCRASH_ESUCCESS && err != PLCRASH_ENOTSUP)
+            PLCF_DEBUG("Failed to cache indexes for %s: %d", req->image->name, err);
+    }
+}
+
+/**
+ * Scheduler release function that frees an image_index_request once its build has completed or been cancelled, and
+ * then releases the request's read reference.
+ */
+void ImageListMonitor::releaseImageIndexRequest (void *context) {
+    image_index_request *req = (image_index_request *) context;
+    ImageListMonitor *m = req->monitor;
+
+    m->_allocator->dealloc(req);
+    m->endReading();
+}
+
+/**
+ * Release a read reference acquired via readImageList().
+ */
+void ImageListMonitor::endReading () {
+    OSAtomicDecrement32Barrier(&_readers);
+}
+
+/**
+ * Copy borrowed references to all currently linked images into a new array allocated from @a allocator. The caller
+ * must hold a read reference, unless called from the dyld callbacks.
+ *
+ * @param allocator The allocator from which the array will be allocated.
+ * @param[out] refs On success, the new array, or NULL if no images are linked. The caller is responsible for
+ * deallocating a non-NULL array.
+ * @param[out] count On success, the number of entries in @a refs.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ */
+plcrash_error_t ImageListMonitor::copyImageRefs (AsyncAllocator *allocator, plcrash_async_macho_t ***refs, size_t *count) {
+    plcrash_async_macho_t **result = NULL;
+    size_t n_images = 0;
+    plcrash_error_t err;
+
+    async_list<plcrash_async_macho_t *>::read_token token = _images.begin_reading(); {
+        async_list<plcrash_async_macho_t *>::node *n = NULL;
+        while ((n = _images.next(n)) != NULL)
+            n_images++;
+
+        if (n_images > 0 && (err = allocator->alloc((void **) &result, sizeof(*result) * n_images)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to allocate image reference array: %d", err);
+            _images.end_reading(token);
+            return err;
+        }
+
+        /* Images may have been added since we counted; those will be omitted. */
+        size_t i = 0;
+        n = NULL;
+        while (i < n_images && (n = _images.next(n)) != NULL)
+            result[i++] = n->value();
+        n_images = i;
+    } _images.end_reading(token);
+
+    *refs = result;
+    *count = n_images;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return a new image list containing borrowed references to all currently loaded images. The caller is responsible
+ * for deallocating a non-NULL @a image_list value via `delete`; the monitor will not release any images referenced by
+ * the list until it has been deallocated.
+ *
+ * If a generation has been published, the returned list borrows the current generation's images and address index,
+ * and neither copies the image list nor acquires any lock.
+ *
+ * @param allocator The allocator to be used when instantiating the image list.
+ * @param image_list On success, a newly allocated DynamicLoader::ImageList.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ */
+plcrash_error_t ImageListMonitor::readImageList (AsyncAllocator *allocator, DynamicLoader::ImageList **image_list) {
+    plcrash_async_macho_t **refs = NULL;
+    size_t count = 0;
+    plcrash_error_t err;
+
+    /* Register as a reader prior to loading the current generation, or iterating the list */
+    OSAtomicIncrement32Barrier(&_readers);
+
+    /* Borrow the current generation, if any; this requires neither copying the image list nor building its index */
+    ImageListGeneration *generation = _current;
+    if (generation != NULL) {
+        generation->retain();
+        endReading();
+
+        *image_list = new (allocator) DynamicLoader::ImageList(generation);
+        if (*image_list == NULL) {
+            generation->release();
+            return PLCRASH_ENOMEM;
+        }
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    if ((err = copyImageRefs(allocator, &refs, &count)) != PLCRASH_ESUCCESS) {
+        endReading();
+        return err;
+    }
+
+    *image_list = new (allocator) DynamicLoader::ImageList(allocator, refs, count, this);
+    if (*image_list == NULL) {
+        if (refs != NULL)
+            allocator->dealloc(refs);
+        endReading();
+        return PLCRASH_ENOMEM;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Release the generation's image list. The generation's images remain owned by the monitor.
+ */
+ImageListGeneration::~ImageListGeneration () {
+    delete _list;
+}
+
+/**
+ * Acquire a reader reference to the generation.
+ */
+void ImageListGeneration::retain () {
+    OSAtomicIncrement32Barrier(&_refs);
+}
+
+/**
+ * Release a reader reference acquired via retain(). The generation is released by its monitor once retired and
+ * unreferenced.
+ */
+void ImageListGeneration::release () {
+    OSAtomicDecrement32Barrier(&_refs);
 }
 
 PLCR_CPP_END_ASYNC_NS
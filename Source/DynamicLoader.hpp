@@ -31,6 +31,7 @@
 
 #include <mach/mach.h>
 #include <mach/task_info.h>
+#include <dispatch/dispatch.h>
 
 #include "PLCrashMacros.h"
 #include "PLCrashAsync.h"
@@ -40,11 +41,15 @@
 
 #include "PLCrashAsyncMachOImage.h"
 #include "PLCrashAsyncAllocator.h"
+#include "PLCrashAsyncLinkedList.hpp"
+#include "PLCrashAsyncVector.hpp"
 
 PLCR_CPP_BEGIN_ASYNC_NS
 
-/* Forward declaration */
+/* Forward declarations */
 template<typename machine_ptr> class DyldImageInfo;
+class ImageListMonitor;
+class ImageListGeneration;
 
 /**
  * An immutable reference to a source of dynamic loader data for
@@ -57,9 +62,12 @@ public:
      */
     class ImageList : public AsyncAllocatable {
         template<typename> friend class DyldImageInfo;
+        friend class plcrash::async::ImageListMonitor;
+        friend class plcrash::async::ImageListGeneration;
         
     public:
         static plcrash_error_t NonAsync_Read (ImageList **imageList, AsyncAllocator *allocator, task_t task);
+        static plcrash_error_t NonAsync_Create (ImageList **imageList, AsyncAllocator *allocator, task_t task, const pl_vm_address_t *headers, const char * const *names, size_t count);
 
         /* Copy/move are not supported. */
         ImageList (const ImageList &) = delete;
@@ -73,41 +81,93 @@ public:
         size_t count ();
         
         plcrash_async_macho_t *imageContainingAddress (pl_vm_address_t address);
+        bool indexOfImageContainingAddress (pl_vm_address_t address, size_t *index);
+
+        size_t classifyAddresses (const pl_vm_address_t *addresses, size_t count, bool *matches);
         
         ImageList ();
         ~ImageList ();
 
     private:
-        /**
-         * Construct a new image list; the new list will assume ownership of @a images.
-         *
-         * @param allocator A borrowed reference to the allocator to be used to deallocate @a images.
-         * @param images An array of images. Ownership of this value will be assumed.
-         * @param count The total number of images in @a images.
-         */
-        ImageList (AsyncAllocator *allocator, plcrash_async_macho_t *images, size_t count) : _allocator(allocator), _images(images), _count(count) {}
-        
+        ImageList (AsyncAllocator *allocator, plcrash_async_macho_t *images, size_t count);
+        ImageList (AsyncAllocator *allocator, plcrash_async_macho_t **image_refs, size_t count, ImageListMonitor *monitor);
+        ImageList (ImageListGeneration *generation);
+
+        void buildAddressIndex ();
+        bool findRange (pl_vm_address_t address, size_t *slot);
+        void siftDown (size_t parent, size_t count);
+        void swapRanges (size_t a, size_t b);
+
         /** A borrowed reference to the allocator to be used to deallocate _images */
         AsyncAllocator *_allocator;
         
-        /** The array of Mach-O image instances. */
+        /** The array of Mach-O image instances, or NULL if this list borrows its images via _image_refs. */
         plcrash_async_macho_t *_images;
 
+        /**
+         * An array of borrowed references to Mach-O image instances owned by _monitor, or NULL if this list
+         * owns its images via _images.
+         */
+        plcrash_async_macho_t **_image_refs;
+
+        /** The monitor from which _image_refs was read, or NULL. The monitor will not release any images while this list exists. */
+        ImageListMonitor *_monitor;
+
+        /**
+         * The generation from which _image_refs and the range index are borrowed, or NULL. A reference to the generation
+         * is held for the lifetime of this list.
+         */
+        ImageListGeneration *_generation;
+
         /** The number of images in this image list. */
         size_t _count;
+
+        /**
+         * The start addresses of the _count image TEXT ranges, sorted in ascending order, or NULL if the index could
+         * not be allocated; in that case, lookups fall back to a linear scan of the images.
+         *
+         * The range index is stored as parallel arrays, rather than as an array of range structures, so that a search
+         * streams through only the densely packed start addresses; the remaining arrays are consulted once for the
+         * matching slot. All three arrays share a single allocation, beginning at _range_starts.
+         */
+        pl_vm_address_t *_range_starts;
+
+        /** The address immediately following each image's TEXT segment, parallel to _range_starts. */
+        pl_vm_address_t *_range_ends;
+
+        /** The index of each image within the list, parallel to _range_starts. */
+        size_t *_range_images;
+
+        /** The most recently matched range slot, or SIZE_MAX. This is consulted prior to searching the index. */
+        volatile size_t _last_hit;
+
+        /** The lowest start address in the range index, or 0 if _range_starts is NULL. */
+        pl_vm_address_t _lowest_start;
+
+        /** The highest end address in the range index, or 0 if _range_starts is NULL. */
+        pl_vm_address_t _highest_end;
     };
     
     static plcrash_error_t NonAsync_Create (DynamicLoader **loader, AsyncAllocator *allocator, task_t task);
     
     plcrash_error_t readImageList (AsyncAllocator *allocator, DynamicLoader::ImageList **image_list);
+
+    plcrash_error_t NonAsync_EnableImageListMonitor ();
+    plcrash_error_t NonAsync_EnableObjCMethodIndex ();
+    plcrash_error_t NonAsync_EnableIndexCache (const char *directory);
+
+    bool imageUnloadCount (uint32_t *count);
+    bool imageGeneration (uint32_t *generation);
     
     ~DynamicLoader ();
     
     /** Copy constructor */
-    DynamicLoader (const DynamicLoader &other) : DynamicLoader(other._task, other._dyld_info) {}
+    DynamicLoader (const DynamicLoader &other) : DynamicLoader(other._task, other._dyld_info) {
+        _monitor = other._monitor;
+    }
 
     /** Move constructor */
-    DynamicLoader (DynamicLoader &&other) : _task(other._task), _dyld_info(other._dyld_info) {
+    DynamicLoader (DynamicLoader &&other) : _task(other._task), _dyld_info(other._dyld_info), _monitor(other._monitor) {
         other._task = MACH_PORT_NULL;
     }
     
@@ -118,6 +178,7 @@ public:
         
         /* Update dyld info */
         _dyld_info = other._dyld_info;
+        _monitor = other._monitor;
         
         return *this;
     }
@@ -130,6 +191,7 @@ public:
         
         /* Update dyld info */
         _dyld_info = other._dyld_info;
+        _monitor = other._monitor;
         
         return *this;
     }
@@ -148,6 +210,136 @@ private:
 
     /** The dyld info fetched from _task */
     struct task_dyld_info _dyld_info;
+
+    /** If non-NULL, a borrowed reference to the monitor from which image lists will be read. */
+    ImageListMonitor *_monitor;
+};
+
+/**
+ * An immutable, reference counted snapshot of an ImageListMonitor's images.
+ *
+ * The monitor publishes a new generation, with a fully built address index, each time an image is added or removed.
+ * Readers borrow the current generation without locking or copying, and a retired generation is released by the
+ * monitor once all of its readers have released their references.
+ */
+class ImageListGeneration : public AsyncAllocatable {
+    friend class ImageListMonitor;
+    friend class DynamicLoader::ImageList;
+
+public:
+    /** Return the monitor generation at which this snapshot was taken. See ImageListMonitor::generation(). */
+    uint32_t number () const { return _number; }
+
+    /* Copy/move are not supported. */
+    ImageListGeneration (const ImageListGeneration &) = delete;
+    ImageListGeneration (ImageListGeneration &&) = delete;
+
+    ImageListGeneration &operator= (const ImageListGeneration &) = delete;
+    ImageListGeneration &operator= (ImageListGeneration &&) = delete;
+
+private:
+    ImageListGeneration (AsyncAllocator *allocator, uint32_t number, DynamicLoader::ImageList *list) : _allocator(allocator), _number(number), _refs(0), _list(list) {}
+    ~ImageListGeneration ();
+
+    void retain ();
+    void release ();
+
+    /** The allocator from which this generation and _list were allocated. */
+    AsyncAllocator *_allocator;
+
+    /** The monitor generation at which this snapshot was taken. */
+    uint32_t _number;
+
+    /** The number of outstanding references held by readers. */
+    volatile int32_t _refs;
+
+    /** The snapshot's image list, borrowing its images from the monitor. */
+    DynamicLoader::ImageList *_list;
+};
+
+/**
+ * An incrementally maintained list of the current process' Mach-O images.
+ *
+ * The monitor registers dyld add/remove image callbacks and parses each image as it is loaded, allowing
+ * crash-time image lists to be produced from already-parsed image descriptors, rather than requiring that dyld's
+ * all_image_infos be walked and every Mach-O header be re-parsed at crash time.
+ *
+ * As dyld callbacks can not be unregistered, a single shared monitor is maintained for the lifetime of the process.
+ */
+class ImageListMonitor : public AsyncAllocatable {
+    friend class DynamicLoader::ImageList;
+
+public:
+    static plcrash_error_t NonAsync_Shared (ImageListMonitor **monitor);
+
+    plcrash_error_t readImageList (AsyncAllocator *allocator, DynamicLoader::ImageList **image_list);
+
+    plcrash_error_t nasync_enableObjCMethodIndex ();
+    plcrash_error_t nasync_enableIndexCache (const char *directory);
+
+    /** Return the number of images that have been unloaded since the monitor was created. */
+    uint32_t unloadCount () const { return _unload_count; }
+
+    /** Return the image list generation; incremented each time an image is added to or removed from the list. */
+    uint32_t generation () const { return _generation; }
+
+    /* Copy/move are not supported. */
+    ImageListMonitor (const ImageListMonitor &) = delete;
+    ImageListMonitor (ImageListMonitor &&) = delete;
+
+    ImageListMonitor &operator= (const ImageListMonitor &) = delete;
+    ImageListMonitor &operator= (ImageListMonitor &&) = delete;
+
+private:
+    ImageListMonitor (AsyncAllocator *allocator) : _allocator(allocator), _retired(allocator), _current(NULL), _retired_generations(allocator), _readers(0), _unload_count(0), _generation(0), _index_enabled(0), _index_cache_dir(NULL) {}
+
+    static void dyldAddImage (const struct mach_header *header, intptr_t slide);
+    static void dyldRemoveImage (const struct mach_header *header, intptr_t slide);
+    static void buildImageIndexes (void *context);
+    static void releaseImageIndexRequest (void *context);
+
+    void endReading ();
+    plcrash_error_t copyImageRefs (AsyncAllocator *allocator, plcrash_async_macho_t ***refs, size_t *count);
+    void nasync_publishGeneration ();
+    void nasync_releaseRetired ();
+    void nasync_scheduleImageIndexes (plcrash_async_macho_t *image);
+
+    /** The allocator used for all image instances. */
+    AsyncAllocator *_allocator;
+
+    /** The currently loaded images, in load order. */
+    async_list<plcrash_async_macho_t *> _images;
+
+    /** Unloaded images that may still be referenced by an outstanding ImageList. */
+    async_vector<plcrash_async_macho_t *> _retired;
+
+    /** The current image list generation, or NULL if the generation could not be allocated. */
+    ImageListGeneration * volatile _current;
+
+    /** Replaced generations that may still be referenced by an outstanding ImageList. */
+    async_vector<ImageListGeneration *> _retired_generations;
+
+    /**
+     * The number of outstanding ImageList instances (and pending index builds) that borrow images directly from this
+     * monitor, and of readers in the process of acquiring a reference to _current.
+     */
+    volatile int32_t _readers;
+
+    /** The number of images that have been unloaded; incremented once an unloaded image has been unlinked. */
+    volatile uint32_t _unload_count;
+
+    /** The image list generation; incremented once an added image has been linked, or a removed image unlinked. */
+    volatile uint32_t _generation;
+
+    /** Non-zero if ObjC method indexes are built, on the background scheduler, for all loaded images. */
+    volatile int32_t _index_enabled;
+
+    /**
+     * The directory in which image indexes are cached, allocated from _allocator, or NULL if index caching is
+     * disabled. If set, symbol indexes are also built by the index builds, and all indexes are loaded from and stored to
+     * the cache.
+     */
+    char * volatile _index_cache_dir;
 };
 
 PLCR_CPP_END_ASYNC_NS
@@ -177,4 +177,222 @@ using namespace plcrash::async;
     delete allocator;
 }
 
+/* Verify that image names are only copied from the target when requested */
+- (void) testLazyImageName {
+    DynamicLoader::ImageList *images = nullptr;
+    AsyncAllocator *allocator = nullptr;
+
+    STAssertEquals(AsyncAllocator::Create(&allocator, 64 * 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::ImageList::NonAsync_Read(&images, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to fetch dyld info");
+
+    Dl_info dli;
+    STAssertTrue(dladdr((void *) class_getMethodImplementation([self class], _cmd), &dli) != 0, @"Failed to look up symbol");
+
+    plcrash_async_macho_t *image = images->imageContainingAddress((pl_vm_address_t) dli.dli_fbase);
+    STAssertNotNULL(image, @"Failed to find our image");
+    STAssertNULL(image->name, @"The image name should not be copied until requested");
+
+    const char *name = plcrash_async_macho_name(image);
+    STAssertNotNULL(name, @"Failed to read image name");
+    STAssertEqualCStrings(name, dli.dli_fname, @"Incorrect name");
+    STAssertEquals(name, plcrash_async_macho_name(image), @"The copied name should be memoized");
+
+    delete images;
+    delete allocator;
+}
+
+/* Verify that indexed lookups agree with a linear scan of the image list for every image's TEXT range */
+- (void) testIndexedImageLookup {
+    DynamicLoader::ImageList *images = nullptr;
+    AsyncAllocator *allocator = nullptr;
+    
+    STAssertEquals(AsyncAllocator::Create(&allocator, 64 * 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::ImageList::NonAsync_Read(&images, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to fetch dyld info");
+    STAssertNotNULL(images, @"Reading of images succeeded, but returned NULL!");
+
+    for (size_t i = 0; i < images->count(); i++) {
+        plcrash_async_macho_t *image = images->getImage(i);
+        if (image->text_size == 0)
+            continue;
+
+        /* Look up the first and last TEXT addresses; lookups of the same image in succession exercise the last-hit cache */
+        pl_vm_address_t addrs[] = { image->header_addr, image->header_addr + image->text_size - 1 };
+        for (size_t a = 0; a < sizeof(addrs) / sizeof(addrs[0]); a++) {
+            plcrash_async_macho_t *expected = NULL;
+            for (size_t j = 0; j < images->count(); j++) {
+                if (plcrash_async_macho_contains_address(images->getImage(j), addrs[a])) {
+                    expected = images->getImage(j);
+                    break;
+                }
+            }
+
+            plcrash_async_macho_t *found = images->imageContainingAddress(addrs[a]);
+            STAssertNotNULL(found, @"Failed to find image for address 0x%" PRIx64, (uint64_t) addrs[a]);
+            STAssertEquals(found->header_addr, expected->header_addr, @"Indexed lookup disagrees with linear scan for address 0x%" PRIx64, (uint64_t) addrs[a]);
+        }
+    }
+
+    delete images;
+    delete allocator;
+}
+
+/* Verify that the sorted range index maps each TEXT range back to its image's position in the list, and that the
+ * range ends are exclusive, when alternating between images so that each lookup misses the last-hit cache */
+- (void) testIndexedLookupReturnsListIndex {
+    DynamicLoader::ImageList *images = nullptr;
+    AsyncAllocator *allocator = nullptr;
+
+    STAssertEquals(AsyncAllocator::Create(&allocator, 64 * 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::ImageList::NonAsync_Read(&images, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to fetch dyld info");
+    STAssertNotNULL(images, @"Reading of images succeeded, but returned NULL!");
+    STAssertTrue(images->count() > 1, @"Need at least two images to alternate lookups");
+
+    for (size_t i = 0; i < images->count(); i++) {
+        /* Look up the image at the opposite end of the list, so that the slot cached for it is not this image's */
+        size_t other = images->count() - i - 1;
+        plcrash_async_macho_t *image = images->getImage(i);
+        plcrash_async_macho_t *other_image = images->getImage(other);
+        if (image->text_size == 0 || other_image->text_size == 0)
+            continue;
+
+        size_t index;
+        STAssertTrue(images->indexOfImageContainingAddress(other_image->header_addr, &index), @"Failed to find image %zu", other);
+        STAssertEquals(index, other, @"Lookup returned the wrong list index");
+
+        pl_vm_address_t last = image->header_addr + image->text_size - 1;
+        STAssertTrue(images->indexOfImageContainingAddress(last, &index), @"Failed to find the last TEXT address of image %zu", i);
+        STAssertEquals(index, i, @"Lookup returned the wrong list index");
+        STAssertEquals(images->imageContainingAddress(last), image, @"Lookup returned the wrong image");
+
+        /* The address following the TEXT range must not resolve to this image, whether or not another image follows */
+        if (images->indexOfImageContainingAddress(last + 1, &index))
+            STAssertTrue(index != i, @"Address past the end of image %zu was attributed to it", i);
+    }
+
+    delete images;
+    delete allocator;
+}
+
+/* Verify that batch address classification agrees with individual lookups, including for a trailing partial batch */
+- (void) testClassifyAddresses {
+    DynamicLoader::ImageList *images = nullptr;
+    AsyncAllocator *allocator = nullptr;
+
+    STAssertEquals(AsyncAllocator::Create(&allocator, 64 * 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::ImageList::NonAsync_Read(&images, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to fetch dyld info");
+    STAssertNotNULL(images, @"Reading of images succeeded, but returned NULL!");
+
+    /* A mix of code addresses, stack and heap addresses, and small integers */
+    int local;
+    void *heap = malloc(16);
+    pl_vm_address_t addrs[] = {
+        0x0,
+        0x42,
+        (pl_vm_address_t) &local,
+        (pl_vm_address_t) heap,
+        (pl_vm_address_t) &objc_msgSend,
+        (pl_vm_address_t) images->getImage(0)->header_addr,
+        PL_VM_ADDRESS_MAX,
+        (pl_vm_address_t) &dladdr,
+        (pl_vm_address_t) images->getImage(0)->header_addr - 1,
+    };
+    size_t count = sizeof(addrs) / sizeof(addrs[0]);
+    bool matches[sizeof(addrs) / sizeof(addrs[0])];
+
+    size_t expected = 0;
+    size_t found = images->classifyAddresses(addrs, count, matches);
+    for (size_t i = 0; i < count; i++) {
+        size_t index;
+        bool contained = images->indexOfImageContainingAddress(addrs[i], &index);
+        STAssertEquals(matches[i], contained, @"Classification disagrees with lookup for address 0x%" PRIx64, (uint64_t) addrs[i]);
+        expected += contained;
+    }
+    STAssertEquals(found, expected, @"Incorrect match count");
+    STAssertTrue(matches[4] && matches[5] && matches[7], @"Failed to classify code addresses");
+    STAssertFalse(matches[0] || matches[1] || matches[6], @"Misclassified non-code addresses");
+
+    free(heap);
+    delete images;
+    delete allocator;
+}
+
+/* Verify that the image list monitor produces the same set of images as a direct read of the dyld image list */
+- (void) testImageListMonitor {
+    DynamicLoader *loader = nullptr;
+    DynamicLoader::ImageList *images = nullptr;
+    DynamicLoader::ImageList *monitored = nullptr;
+    AsyncAllocator *allocator = nullptr;
+
+    STAssertEquals(AsyncAllocator::Create(&allocator, 64 * 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::ImageList::NonAsync_Read(&images, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to fetch dyld info");
+
+    STAssertEquals(DynamicLoader::NonAsync_Create(&loader, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader");
+    STAssertEquals(loader->NonAsync_EnableImageListMonitor(), PLCRASH_ESUCCESS, @"Failed to enable the image list monitor");
+    STAssertEquals(loader->readImageList(allocator, &monitored), PLCRASH_ESUCCESS, @"Failed to read the monitored image list");
+    STAssertNotNULL(monitored, @"Reading of images succeeded, but returned NULL!");
+
+    /* Every image known to dyld should be found in the monitored list */
+    for (size_t i = 0; i < images->count(); i++) {
+        plcrash_async_macho_t *image = images->getImage(i);
+        plcrash_async_macho_t *found = monitored->imageContainingAddress(image->header_addr);
+
+        STAssertNotNULL(found, @"Monitored list is missing image %s", image->name);
+        STAssertEquals(found->header_addr, image->header_addr, @"Incorrect image returned for %s", image->name);
+    }
+
+    delete monitored;
+    delete images;
+    delete loader;
+    delete allocator;
+}
+
+/* Verify that concurrently held monitored image lists share the monitor's published generation */
+- (void) testImageListGenerations {
+    DynamicLoader *loader = nullptr;
+    DynamicLoader::ImageList *first = nullptr;
+    DynamicLoader::ImageList *second = nullptr;
+    AsyncAllocator *allocator = nullptr;
+    uint32_t generation;
+
+    STAssertEquals(AsyncAllocator::Create(&allocator, 1024 * 1024), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(DynamicLoader::NonAsync_Create(&loader, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader");
+    STAssertEquals(loader->NonAsync_EnableImageListMonitor(), PLCRASH_ESUCCESS, @"Failed to enable the image list monitor");
+
+    /* Retry if an image is loaded or unloaded between the two reads */
+    for (int attempt = 0; attempt < 10; attempt++) {
+        STAssertTrue(loader->imageGeneration(&generation), @"Failed to fetch the image generation");
+        STAssertEquals(loader->readImageList(allocator, &first), PLCRASH_ESUCCESS, @"Failed to read the monitored image list");
+        STAssertEquals(loader->readImageList(allocator, &second), PLCRASH_ESUCCESS, @"Failed to read the monitored image list");
+
+        uint32_t current;
+        if (loader->imageGeneration(&current) && current == generation)
+            break;
+
+        delete first;
+        delete second;
+        first = second = nullptr;
+    }
+    STAssertNotNULL(first, @"Image generation did not settle");
+    if (first == nullptr) {
+        delete loader;
+        delete allocator;
+        return;
+    }
+
+    /* Both lists must borrow the same image instances, without copying them */
+    STAssertTrue(first->count() > 0, @"Monitored list is empty");
+    STAssertEquals(first->count(), second->count(), @"Lists from the same generation differ in length");
+    for (size_t i = 0; i < first->count(); i++)
+        STAssertEquals(first->getImage(i), second->getImage(i), @"Lists from the same generation reference different images");
+
+    /* Lookups must succeed via the borrowed address index, and each list remains valid once the other is released */
+    plcrash_async_macho_t *image = first->getImage(0);
+    delete first;
+    STAssertEquals(second->imageContainingAddress(image->header_addr), image, @"Address lookup via the borrowed index failed");
+
+    delete second;
+    delete loader;
+    delete allocator;
+}
+
 @end
@@ -8,24 +8,106 @@
 
 #import <CrashReporter/CrashReporter.h>
 
+#import "fuzz.h"
+
+/*
+ * Fuzz targets are run in-process, and may be driven either by libFuzzer (via LLVMFuzzerTestOneInput(), when linked
+ * with -fsanitize=fuzzer and built with PLCRASH_FUZZ_LIBFUZZER defined), or by the standalone main() below, which
+ * runs the target over every file named on the command line.
+ *
+ * The target is selected via the PLCRASH_FUZZ_TARGET environment variable: "report" (the default), "dwarf", or
+ * "compact_unwind".
+ */
+
+/** A fuzz target entry point. */
+typedef void (*fuzz_target_fn) (const uint8_t *data, size_t size);
+
+/**
+ * Decode a crash report, in both the eager and lazy modes, including the lazily decoded thread and image records.
+ */
+static void fuzz_report (const uint8_t *data, size_t size) {
+    /* All objects allocated by the decoder, including its arena, are released at the end of each input */
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSData *reportData = [NSData dataWithBytesNoCopy: (void *) data length: size freeWhenDone: NO];
+    PLCrashReport *report;
+
+    report = [[PLCrashReport alloc] initWithData: reportData error: NULL];
+    [report release];
+
+    report = [[PLCrashReport alloc] initWithData: reportData options: PLCrashReportDecodingOptionLazy error: NULL];
+    if (report != nil) {
+        [report crashedThread];
+        [report threads];
+        [report images];
+        [report release];
+    }
+
+    [pool release];
+}
+
+/**
+ * Return the fuzz target selected by the PLCRASH_FUZZ_TARGET environment variable, or NULL if unknown.
+ */
+static fuzz_target_fn fuzz_selected_target (void) {
+    const char *name = getenv("PLCRASH_FUZZ_TARGET");
+
+    if (name == NULL || strcmp(name, "report") == 0)
+        return fuzz_report;
+    else if (strcmp(name, "dwarf") == 0)
+        return plcrash_fuzz_dwarf;
+    else if (strcmp(name, "compact_unwind") == 0)
+        return plcrash_fuzz_compact_unwind;
+
+    return NULL;
+}
+
+#ifdef PLCRASH_FUZZ_LIBFUZZER
+
+/** The selected target; resolved once, rather than per input. */
+static fuzz_target_fn fuzz_target = NULL;
+
+int LLVMFuzzerInitialize (int *argc, char ***argv) {
+    if ((fuzz_target = fuzz_selected_target()) == NULL) {
+        fprintf(stderr, "Unknown PLCRASH_FUZZ_TARGET: %s\n", getenv("PLCRASH_FUZZ_TARGET"));
+        exit(1);
+    }
+
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput (const uint8_t *data, size_t size) {
+    fuzz_target(data, size);
+    return 0;
+}
+
+#else /* !PLCRASH_FUZZ_LIBFUZZER */
+
 int main (int argc, char *argv[]) {
     NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
-    NSError *error;
-    
+
     if (argc < 2)
         return 1;
 
-    /* Try to open and decode a crash report passed as the second argument */
-    NSString *file = [NSString stringWithUTF8String: argv[1]];
-    NSData *data = [NSData dataWithContentsOfFile: file];
-    if (data == nil) {
-        NSLog(@"Could not load crash report data from %@", file);
+    fuzz_target_fn target = fuzz_selected_target();
+    if (target == NULL) {
+        NSLog(@"Unknown PLCRASH_FUZZ_TARGET: %s", getenv("PLCRASH_FUZZ_TARGET"));
         exit(1);
     }
 
-    PLCrashReport *report = [[PLCrashReport alloc] initWithData: data error: &error];
-    if (report)
-        [report release];
+    /* Run the target over each input passed as an argument */
+    for (int i = 1; i < argc; i++) {
+        NSString *file = [NSString stringWithUTF8String: argv[i]];
+        NSData *data = [NSData dataWithContentsOfFile: file];
+        if (data == nil) {
+            NSLog(@"Could not load fuzz input data from %@", file);
+            exit(1);
+        }
+
+        target([data bytes], [data length]);
+    }
 
     [pool release];
+    return 0;
 }
+
+#endif /* PLCRASH_FUZZ_LIBFUZZER */
@@ -0,0 +1,140 @@
+/*
+ *  fuzz-unwind.cpp
+ *  CrashReporter
+ *
+ *  Copyright 2009 Plausible Labs Cooperative, Inc.. All rights reserved.
+ */
+
+#include "fuzz.h"
+
+#include "PLCrashAsyncMObject.h"
+#include "PLCrashAsyncCompactUnwindEncoding.h"
+#include "PLCrashAsyncDwarfEncoding.hpp"
+#include "PLCrashAsyncDwarfCIE.hpp"
+#include "PLCrashAsyncDwarfFDE.hpp"
+#include "PLCrashAsyncDwarfCFAState.hpp"
+#include "PLCrashCompatConstants.h"
+
+#include <string.h>
+
+using namespace plcrash::async;
+
+/*
+ * Unwind parser fuzz targets. These parsers are run from the crash handler against the memory of the crashed process,
+ * and so must tolerate arbitrary section contents.
+ *
+ * Each input begins with a small header selecting the parser configuration, followed by the section data. All state
+ * is stack allocated and released before returning, so that the targets may be run repeatedly in-process.
+ */
+
+/** Input header: flags (1 byte) followed by the PC to look up (8 bytes). */
+#define FUZZ_UNWIND_HEADER_SIZE 9
+
+/** Header flag: parse 64-bit data. */
+#define FUZZ_UNWIND_FLAG_M64 (1 << 0)
+
+/** Header flag: parse the DWARF data as __debug_frame, rather than __eh_frame. */
+#define FUZZ_UNWIND_FLAG_DEBUG_FRAME (1 << 1)
+
+/** Header flag: decode 64-bit compact unwind encodings as ARM64, rather than x86-64. */
+#define FUZZ_UNWIND_FLAG_ARM (1 << 2)
+
+/**
+ * Split @a data into its header values and section, and map the section. Returns false if the input is too short,
+ * or the section could not be mapped.
+ */
+static bool fuzz_unwind_map (const uint8_t *data, size_t size, uint8_t *flags, uint64_t *pc, plcrash_async_mobject_t *mobj) {
+    if (size <= FUZZ_UNWIND_HEADER_SIZE)
+        return false;
+
+    *flags = data[0];
+    memcpy(pc, data + 1, sizeof(*pc));
+
+    return plcrash_async_mobject_init(mobj, mach_task_self(), (pl_vm_address_t) (data + FUZZ_UNWIND_HEADER_SIZE), size - FUZZ_UNWIND_HEADER_SIZE, true) == PLCRASH_ESUCCESS;
+}
+
+/**
+ * Find and evaluate the FDE for @a pc, exactly as is done by the DWARF frame reader.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static void fuzz_dwarf_eval (plcrash_async_mobject_t *mobj, bool m64, bool debug_frame, machine_ptr pc) {
+    const plcrash_async_byteorder_t *byteorder = plcrash_async_byteorder_little_endian();
+    gnu_ehptr_reader<machine_ptr> ptr_state(byteorder);
+    dwarf_frame_reader reader;
+    plcrash_async_dwarf_fde_info_t fde_info;
+    plcrash_async_dwarf_cie_info_t cie_info;
+    dwarf_cfa_state<machine_ptr, machine_ptr_s> cfa_state;
+
+    if (reader.init(mobj, byteorder, m64, debug_frame) != PLCRASH_ESUCCESS)
+        return;
+
+    if (reader.find_fde(0x0, pc, &fde_info) != PLCRASH_ESUCCESS)
+        return;
+
+    pl_vm_address_t base = plcrash_async_mobject_base_address(mobj);
+    if (plcrash_async_dwarf_cie_info_init(&cie_info, mobj, byteorder, &ptr_state, base + fde_info.cie_offset) == PLCRASH_ESUCCESS) {
+        if (cfa_state.eval_program(mobj, pc, (machine_ptr) fde_info.pc_start, &cie_info, &ptr_state, byteorder, base, cie_info.initial_instructions_offset, cie_info.initial_instructions_length) == PLCRASH_ESUCCESS)
+            cfa_state.eval_program(mobj, pc, (machine_ptr) fde_info.pc_start, &cie_info, &ptr_state, byteorder, base, fde_info.instructions_offset, fde_info.instructions_length);
+
+        plcrash_async_dwarf_cie_info_free(&cie_info);
+    }
+
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+}
+
+/**
+ * Fuzz the DWARF eh_frame/debug_frame parser and CFA evaluator.
+ */
+void plcrash_fuzz_dwarf (const uint8_t *data, size_t size) {
+    plcrash_async_mobject_t mobj;
+    uint8_t flags;
+    uint64_t pc;
+
+    if (!fuzz_unwind_map(data, size, &flags, &pc, &mobj))
+        return;
+
+    bool debug_frame = (flags & FUZZ_UNWIND_FLAG_DEBUG_FRAME) != 0;
+    if (flags & FUZZ_UNWIND_FLAG_M64)
+        fuzz_dwarf_eval<uint64_t, int64_t>(&mobj, true, debug_frame, pc);
+    else
+        fuzz_dwarf_eval<uint32_t, int32_t>(&mobj, false, debug_frame, (uint32_t) pc);
+
+    plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Fuzz the compact unwind __unwind_info parser and encoding decoder.
+ */
+void plcrash_fuzz_compact_unwind (const uint8_t *data, size_t size) {
+    plcrash_async_mobject_t mobj;
+    plcrash_async_cfe_reader_t reader;
+    plcrash_async_cfe_entry_t entry;
+    pl_vm_address_t function_base;
+    pl_vm_address_t function_end;
+    uint32_t encoding;
+    uint8_t flags;
+    uint64_t pc;
+
+    if (!fuzz_unwind_map(data, size, &flags, &pc, &mobj))
+        return;
+
+    cpu_type_t cputype = CPU_TYPE_X86;
+    if (flags & FUZZ_UNWIND_FLAG_M64)
+        cputype = (flags & FUZZ_UNWIND_FLAG_ARM) ? CPU_TYPE_ARM64 : CPU_TYPE_X86_64;
+
+    if (plcrash_async_cfe_reader_init(&reader, &mobj, cputype) == PLCRASH_ESUCCESS) {
+        if (plcrash_async_cfe_reader_find_pc_range(&reader, (pl_vm_address_t) pc, &function_base, &function_end, &encoding) == PLCRASH_ESUCCESS) {
+            if (plcrash_async_cfe_entry_init(&entry, cputype, encoding) == PLCRASH_ESUCCESS) {
+                plcrash_regnum_t registers[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
+                if (plcrash_async_cfe_entry_register_count(&entry) <= PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX)
+                    plcrash_async_cfe_entry_register_list(&entry, registers);
+
+                plcrash_async_cfe_entry_free(&entry);
+            }
+        }
+
+        plcrash_async_cfe_reader_free(&reader);
+    }
+
+    plcrash_async_mobject_free(&mobj);
+}
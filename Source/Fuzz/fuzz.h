@@ -0,0 +1,25 @@
+/*
+ *  fuzz.h
+ *  CrashReporter
+ *
+ *  Copyright 2009 Plausible Labs Cooperative, Inc.. All rights reserved.
+ */
+
+#ifndef PLCRASH_FUZZ_H
+#define PLCRASH_FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void plcrash_fuzz_dwarf (const uint8_t *data, size_t size);
+void plcrash_fuzz_compact_unwind (const uint8_t *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_FUZZ_H */
@@ -24,8 +24,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <inttypes.h>
 
+#include <dlfcn.h>
+#include <mach/mach_time.h>
 #include <mach-o/dyld.h>
 
 #include "PLCrashFrameWalker.h"
@@ -35,6 +38,7 @@
 #include "PLCrashFrameDWARFUnwind.h"
 
 #include "PLCrashFeatureConfig.h"
+#include "PLCrashAsyncInstrumentation.h"
 
 /* Enable libunwind verification on supported platforms.
  * unw_resume() et al are unsupported on 32-bit ARM */
@@ -194,6 +198,12 @@ static struct unwind_test_case unwind_test_cases[] = {
 struct  {
     /** The current test case */
     struct unwind_test_case *test_case;
+
+    /** If non-zero, the number of times each test function's frames should be re-unwound for benchmarking. */
+    uint32_t benchmark_iterations;
+
+    /** Benchmark results for the current test case. */
+    unwind_benchmark_result_t benchmark_result;
 } global_harness_state;
 
 /*
@@ -216,6 +226,106 @@ bool unwind_test_harness (void) {
 	return true;
 }
 
+/* Return a human-readable name for a test case's frame readers */
+static const char *unwind_test_readers_name (plframe_cursor_frame_reader_t **readers) {
+    if (readers == NULL)
+        return "default";
+    else if (readers == frame_readers_frame)
+        return "frame";
+    else if (readers == frame_readers_compact)
+        return "compact";
+    else if (readers == frame_readers_dwarf)
+        return "dwarf";
+
+    return "unknown";
+}
+
+/**
+ * Run the regression tests, additionally re-unwinding each test function @a iterations times, and report the
+ * throughput of each test case to @a callback.
+ *
+ * @param iterations The number of times each test function's frames should be unwound.
+ * @param callback The callback to be invoked with each test case's results.
+ * @param ctx A context value to be passed to @a callback.
+ */
+bool unwind_test_benchmark (uint32_t iterations, unwind_benchmark_cb callback, void *ctx) {
+    for (struct unwind_test_case *tc = unwind_test_cases; tc->test_list != NULL; tc++) {
+        unwind_benchmark_result_t *result = &global_harness_state.benchmark_result;
+        Dl_info info;
+
+        memset(result, 0, sizeof(*result));
+        result->readers = unwind_test_readers_name(tc->frame_readers_dwarf);
+        result->test_list = "unknown";
+        if (dladdr(tc->test_list, &info) != 0 && info.dli_sname != NULL)
+            result->test_list = info.dli_sname;
+
+        global_harness_state.test_case = tc;
+        global_harness_state.benchmark_iterations = iterations;
+        for (void **tests = tc->test_list; *tests != NULL; tests++) {
+            int ret;
+            if ((ret = unwind_tester(*tests, &tc->expected_sp)) != 0) {
+                PLCF_DEBUG("Tester returned error %d for %p", ret, *tests);
+                __builtin_trap();
+            }
+        }
+        global_harness_state.benchmark_iterations = 0;
+
+        callback(result, ctx);
+    }
+
+    return true;
+}
+
+/*
+ * Repeatedly unwind from @a state through the current test function, accumulating the results in the
+ * harness' benchmark state.
+ */
+static void unwind_benchmark_state (plcrash_async_thread_state_t *state, plcrash_async_image_list_t *image_list, plframe_cursor_frame_reader_t **readers, size_t reader_count) {
+    unwind_benchmark_result_t *result = &global_harness_state.benchmark_result;
+    uint32_t intermediate_frames = global_harness_state.test_case->intermediate_frames;
+    plcrash_async_instrumentation_t instr;
+    mach_timebase_info_data_t timebase;
+    uint64_t elapsed = 0;
+
+    mach_timebase_info(&timebase);
+
+    plcrash_async_instrumentation_init(&instr);
+    plcrash_async_instrumentation_set_current(&instr);
+
+    for (uint32_t iter = 0; iter < global_harness_state.benchmark_iterations; iter++) {
+        plframe_cursor_t cursor;
+        plframe_error_t err = PLFRAME_ESUCCESS;
+
+        uint64_t start = mach_absolute_time();
+        plframe_cursor_init(&cursor, mach_task_self(), state, image_list);
+        for (uint32_t i = 0; i < intermediate_frames && err == PLFRAME_ESUCCESS; i++)
+            err = plframe_cursor_next(&cursor);
+
+        if (err == PLFRAME_ESUCCESS) {
+            if (readers != NULL)
+                err = plframe_cursor_next_with_readers(&cursor, readers, reader_count);
+            else
+                err = plframe_cursor_next(&cursor);
+        }
+        elapsed += mach_absolute_time() - start;
+        plframe_cursor_free(&cursor);
+
+        /* The verified unwind succeeded; a failure here indicates non-deterministic unwinding */
+        if (err != PLFRAME_ESUCCESS) {
+            PLCF_DEBUG("Benchmark step failed: %d", err);
+            __builtin_trap();
+        }
+
+        result->frames += intermediate_frames + 1;
+    }
+
+    plcrash_async_instrumentation_set_current(NULL);
+
+    result->elapsed_ns += (elapsed * timebase.numer) / timebase.denom;
+    result->task_memcpy_calls += (uint64_t) instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY];
+    result->mobject_maps += (uint64_t) instr.counters[PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS];
+}
+
 #define VERIFY_NV_REG(cursor, rnum, value) do { \
     plcrash_greg_t reg; \
     if (plframe_cursor_get_reg(cursor, rnum, &reg) != PLFRAME_ESUCCESS) { \
@@ -287,6 +397,10 @@ static plcrash_error_t unwind_current_state (plcrash_async_thread_state_t *state
         plcrash_async_allocator_free(allocator);
         return PLFRAME_EINVAL;
     }
+
+    /* If benchmarking, re-unwind the same frames using the already-verified configuration */
+    if (global_harness_state.benchmark_iterations > 0)
+        unwind_benchmark_state(state, image_list, readers, reader_count);
     
     /* Clean up */
     plcrash_async_image_list_free(image_list);
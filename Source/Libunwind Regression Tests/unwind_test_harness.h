@@ -23,12 +23,46 @@
 #define PLCRASH_UNWIND_TEST_HARNESS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 bool unwind_test_harness (void);
+
+/**
+ * Throughput results for a single unwind test case, accumulated across all of the case's test functions.
+ */
+typedef struct unwind_benchmark_result {
+    /** The symbol name of the test case's test function list. */
+    const char *test_list;
+
+    /** The frame readers used by the test case ("frame", "compact", "dwarf", or "default"). */
+    const char *readers;
+
+    /** The total number of frames unwound. */
+    uint64_t frames;
+
+    /** The total time spent unwinding, in nanoseconds. */
+    uint64_t elapsed_ns;
+
+    /** The total number of task memory reads issued. */
+    uint64_t task_memcpy_calls;
+
+    /** The total number of memory objects mapped. */
+    uint64_t mobject_maps;
+} unwind_benchmark_result_t;
+
+/**
+ * Benchmark result callback.
+ *
+ * @param result The test case's results.
+ * @param ctx The context value supplied to unwind_test_benchmark().
+ */
+typedef void (*unwind_benchmark_cb)(const unwind_benchmark_result_t *result, void *ctx);
+
+bool unwind_test_benchmark (uint32_t iterations, unwind_benchmark_cb callback, void *ctx);
     
 #ifdef __cplusplus
 }
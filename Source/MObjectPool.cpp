@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "MObjectPool.hpp"
+#include "PLCrashAsyncMObject.h"
+
+using namespace plcrash::async;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @{
+ */
+
+/**
+ * Construct a new mapping, assuming ownership of the local pages at @a vm_address. A new send right will
+ * be acquired for @a task.
+ *
+ * @param task The task from which the pages were mapped.
+ * @param task_address The page-aligned task-relative address of the mapping.
+ * @param vm_address The page-aligned local address of the mapping.
+ * @param vm_length The length of the mapping.
+ */
+MObjectPool::Mapping::Mapping (task_t task, pl_vm_address_t task_address, pl_vm_address_t vm_address, pl_vm_size_t vm_length) :
+    _task(task), _task_address(task_address), _vm_address(vm_address), _vm_length(vm_length)
+{
+    mach_port_mod_refs(mach_task_self(), _task, MACH_PORT_RIGHT_SEND, 1);
+}
+
+MObjectPool::Mapping::~Mapping () {
+    kern_return_t kt;
+
+#ifdef PL_HAVE_MACH_VM
+    kt = mach_vm_deallocate(mach_task_self(), _vm_address, _vm_length);
+#else
+    kt = vm_deallocate(mach_task_self(), _vm_address, _vm_length);
+#endif
+
+    if (kt != KERN_SUCCESS)
+        PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+
+    mach_port_mod_refs(mach_task_self(), _task, MACH_PORT_RIGHT_SEND, -1);
+}
+
+/**
+ * Return true if the @a length bytes at @a address in @a task fall entirely within this mapping.
+ */
+bool MObjectPool::Mapping::contains (task_t task, pl_vm_address_t address, pl_vm_size_t length) const {
+    if (task != _task || address < _task_address)
+        return false;
+
+    pl_vm_size_t offset = address - _task_address;
+    return offset <= _vm_length && length <= _vm_length - offset;
+}
+
+/**
+ * Construct a new, empty pool.
+ *
+ * @param allocator The allocator to be used to allocate new mappings. This must outlive the pool.
+ */
+MObjectPool::MObjectPool (AsyncAllocator *allocator) : _allocator(allocator), _next(0) {}
+
+/**
+ * Map the @a length bytes at @a task_addr from @a task, returning an existing mapping if one contains the requested
+ * range.
+ *
+ * @param task The task from which the memory will be mapped.
+ * @param task_addr The task-relative address of the memory to be mapped.
+ * @param length The number of bytes to be mapped.
+ * @param require_full If false, a mapping will be returned even if the full range can not be mapped. See
+ * plcrash_async_mobject_init().
+ * @param result On success, a reference to a mapping containing at least the first page of the requested range.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the range could not be mapped.
+ */
+plcrash_error_t MObjectPool::map (task_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, shared_ptr<Mapping> *result) {
+    /* If another thread is using the pool, provide an unpooled mapping rather than waiting */
+    if (!_lock.tryLock())
+        return newMapping(task, task_addr, length, require_full, result);
+
+    /* Return an existing mapping, if any */
+    shared_ptr<Mapping> *existing = findLocked(task, task_addr, length);
+    if (existing != nullptr) {
+        *result = *existing;
+        _lock.unlock();
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* If there's an overlapping or adjacent mapping, try to replace it with a single mapping covering both ranges */
+    shared_ptr<Mapping> *coalescable = findCoalescableLocked(task, task_addr, length);
+    if (coalescable != nullptr) {
+        pl_vm_address_t start = mach_vm_trunc_page(task_addr);
+        pl_vm_address_t end = mach_vm_round_page(task_addr + length);
+        const Mapping *entry = coalescable->get();
+
+        if (entry->task_address() < start)
+            start = entry->task_address();
+
+        if (entry->task_address() + entry->vm_length() > end)
+            end = entry->task_address() + entry->vm_length();
+
+        shared_ptr<Mapping> coalesced;
+        if (newMapping(task, start, end - start, false, &coalesced) == PLCRASH_ESUCCESS &&
+            coalesced->contains(task, task_addr, require_full ? length : 1))
+        {
+            *coalescable = coalesced;
+            *result = coalesced;
+            _lock.unlock();
+            return PLCRASH_ESUCCESS;
+        }
+
+        /* Otherwise, fall through and map only the requested range; the partial coalesced mapping (if any) is
+         * released here. */
+    }
+
+    /* Map the requested range */
+    plcrash_error_t err;
+    shared_ptr<Mapping> mapping;
+    if ((err = newMapping(task, task_addr, length, require_full, &mapping)) != PLCRASH_ESUCCESS) {
+        _lock.unlock();
+        return err;
+    }
+
+    /* Insert the new mapping into the first free entry, or replace the oldest entry if the pool is full */
+    size_t index = capacity;
+    for (size_t i = 0; i < capacity; i++) {
+        if (_entries[i].isEmpty()) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index == capacity) {
+        index = _next;
+        _next = (_next + 1) % capacity;
+    }
+
+    _entries[index] = mapping;
+    *result = mapping;
+
+    _lock.unlock();
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Map the @a length bytes at @a task_addr from @a task, returning a new mapping that is not retained by the pool.
+ */
+plcrash_error_t MObjectPool::newMapping (task_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, shared_ptr<Mapping> *result) {
+    pl_vm_address_t vm_address;
+    pl_vm_size_t vm_length;
+    plcrash_error_t err;
+
+    if ((err = plcrash_async_mobject_remap_pages(task, task_addr, length, require_full, &vm_address, &vm_length)) != PLCRASH_ESUCCESS)
+        return err;
+
+    *result = make_shared<Mapping>(_allocator, task, mach_vm_trunc_page(task_addr), vm_address, vm_length);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the pooled mapping containing the @a length bytes at @a address, or NULL if none. The pool lock must be held.
+ */
+shared_ptr<MObjectPool::Mapping> *MObjectPool::findLocked (task_t task, pl_vm_address_t address, pl_vm_size_t length) {
+    for (size_t i = 0; i < capacity; i++) {
+        if (!_entries[i].isEmpty() && _entries[i]->contains(task, address, length))
+            return &_entries[i];
+    }
+
+    return nullptr;
+}
+
+/**
+ * Return a pooled mapping that overlaps or adjoins the page-aligned range containing the @a length bytes at @a address,
+ * such that the combined range would not exceed max_coalesced_length, or NULL if none. The pool lock must be held.
+ */
+shared_ptr<MObjectPool::Mapping> *MObjectPool::findCoalescableLocked (task_t task, pl_vm_address_t address, pl_vm_size_t length) {
+    pl_vm_address_t start = mach_vm_trunc_page(address);
+    pl_vm_address_t end = mach_vm_round_page(address + length);
+
+    /* Refuse to coalesce ranges that overflow */
+    if (end < start)
+        return nullptr;
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (_entries[i].isEmpty() || _entries[i]->task() != task)
+            continue;
+
+        pl_vm_address_t entry_start = _entries[i]->task_address();
+        pl_vm_address_t entry_end = entry_start + _entries[i]->vm_length();
+
+        /* Must overlap or adjoin */
+        if (start > entry_end || entry_start > end)
+            continue;
+
+        pl_vm_address_t coalesced_start = start < entry_start ? start : entry_start;
+        pl_vm_address_t coalesced_end = end > entry_end ? end : entry_end;
+        if (coalesced_end - coalesced_start <= max_coalesced_length)
+            return &_entries[i];
+    }
+
+    return nullptr;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_MOBJECT_POOL_H
+#define PLCRASH_ASYNC_MOBJECT_POOL_H
+
+#include <mach/mach.h>
+
+#include "PLCrashMacros.h"
+#include "PLCrashAsync.h"
+
+#include "AsyncAllocator.hpp"
+#include "AsyncAllocatable.hpp"
+#include "SpinLock.hpp"
+#include "shared_ptr.hpp"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @{
+ */
+
+PLCR_CPP_BEGIN_ASYNC_NS
+
+/**
+ * A pool of reference counted page mappings of a target task's memory.
+ *
+ * Memory objects frequently map overlapping ranges of the same pages (eg, a Mach-O image's __LINKEDIT or __TEXT
+ * segments); the pool returns an existing mapping when a requested range falls within it, and when a requested
+ * range overlaps or adjoins an existing mapping, the two are coalesced into a single mapping that will satisfy
+ * later requests for either range.
+ *
+ * Mappings are only evicted from the pool once the pool is full; an evicted mapping remains valid until the last
+ * Mapping reference is released.
+ *
+ * @par Thread Safety
+ * The pool may be used concurrently from multiple threads. If the pool's lock is held by another thread, map()
+ * does not wait, and instead returns a new mapping that is not retained by the pool.
+ */
+class MObjectPool : public AsyncAllocatable {
+public:
+    /**
+     * A local mapping of a page-aligned range of a target task's memory.
+     */
+    class Mapping {
+    public:
+        Mapping (task_t task, pl_vm_address_t task_address, pl_vm_address_t vm_address, pl_vm_size_t vm_length);
+        ~Mapping ();
+
+        /* Copy/move are not supported. */
+        Mapping (const Mapping &) = delete;
+        Mapping (Mapping &&) = delete;
+
+        Mapping &operator= (const Mapping &) = delete;
+        Mapping &operator= (Mapping &&) = delete;
+
+        bool contains (task_t task, pl_vm_address_t address, pl_vm_size_t length) const;
+
+        /** The task from which the pages were mapped. */
+        task_t task () const { return _task; }
+
+        /** The page-aligned task-relative address of the mapping. */
+        pl_vm_address_t task_address () const { return _task_address; }
+
+        /** The page-aligned local address of the mapping. */
+        pl_vm_address_t vm_address () const { return _vm_address; }
+
+        /** The length of the mapping. */
+        pl_vm_size_t vm_length () const { return _vm_length; }
+
+    private:
+        /** The task from which the pages were mapped. A send right is held for the lifetime of the mapping. */
+        task_t _task;
+
+        /** The page-aligned task-relative address of the mapping. */
+        pl_vm_address_t _task_address;
+
+        /** The page-aligned local address of the mapping. */
+        pl_vm_address_t _vm_address;
+
+        /** The length of the mapping. */
+        pl_vm_size_t _vm_length;
+    };
+
+    /** The maximum number of mappings retained by the pool. */
+    static constexpr size_t capacity = 16;
+
+    /** The maximum length of a mapping produced by coalescing two overlapping or adjacent ranges. */
+    static constexpr pl_vm_size_t max_coalesced_length = 1024 * 1024;
+
+    MObjectPool (AsyncAllocator *allocator);
+
+    /* Copy/move are not supported. */
+    MObjectPool (const MObjectPool &) = delete;
+    MObjectPool (MObjectPool &&) = delete;
+
+    MObjectPool &operator= (const MObjectPool &) = delete;
+    MObjectPool &operator= (MObjectPool &&) = delete;
+
+    plcrash_error_t map (task_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, shared_ptr<Mapping> *result);
+
+private:
+    plcrash_error_t newMapping (task_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, shared_ptr<Mapping> *result);
+    shared_ptr<Mapping> *findLocked (task_t task, pl_vm_address_t address, pl_vm_size_t length);
+    shared_ptr<Mapping> *findCoalescableLocked (task_t task, pl_vm_address_t address, pl_vm_size_t length);
+
+    /** The allocator used to allocate new mappings. */
+    AsyncAllocator *_allocator;
+
+    /** Lock guarding all pool state. */
+    SpinLock _lock;
+
+    /** The pooled mappings; empty entries are unused. */
+    shared_ptr<Mapping> _entries[capacity];
+
+    /** The index of the next entry to be replaced once the pool is full. */
+    size_t _next;
+};
+
+PLCR_CPP_END_ASYNC_NS
+
+/**
+ * @}
+ */
+
+#endif /* PLCRASH_ASYNC_MOBJECT_POOL_H */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+#import "MObjectPool.hpp"
+#import "PLCrashAsyncMObjectPool.h"
+#import "PLCrashAsyncMObject.h"
+
+using namespace plcrash::async;
+
+@interface PLCrashAsyncMObjectPoolTests : SenTestCase {
+    /** Allocator used by our pools. */
+    AsyncAllocator *_allocator;
+
+    /** Target pages to be mapped. */
+    vm_address_t _pages;
+}
+@end
+
+@implementation PLCrashAsyncMObjectPoolTests
+
+- (void) setUp {
+    STAssertEquals(AsyncAllocator::Create(&_allocator, PAGE_SIZE * 4), PLCRASH_ESUCCESS, @"Failed to create allocator");
+
+    _pages = 0x0;
+    STAssertEquals(KERN_SUCCESS, vm_allocate(mach_task_self(), &_pages, vm_page_size * 4, VM_FLAGS_ANYWHERE), @"Failed to allocate pages");
+    memset_pattern4((void *) _pages, (const uint8_t[]){ 0xC, 0xA, 0xF, 0xE }, vm_page_size * 4);
+}
+
+- (void) tearDown {
+    vm_deallocate(mach_task_self(), _pages, vm_page_size * 4);
+    delete _allocator;
+}
+
+/**
+ * Verify that a range falling within an existing mapping returns that mapping.
+ */
+- (void) testReuseMapping {
+    MObjectPool pool(_allocator);
+    shared_ptr<MObjectPool::Mapping> first;
+    shared_ptr<MObjectPool::Mapping> second;
+
+    STAssertEquals(PLCRASH_ESUCCESS, pool.map(mach_task_self(), _pages, vm_page_size * 2, true, &first), @"Failed to map pages");
+    STAssertEquals(PLCRASH_ESUCCESS, pool.map(mach_task_self(), _pages + 16, vm_page_size, true, &second), @"Failed to map pages");
+
+    STAssertTrue(first == second, @"Existing mapping was not returned");
+    STAssertTrue(memcmp((void *) first->vm_address(), (void *) _pages, vm_page_size * 2) == 0, @"Mapping appears to be incorrect");
+}
+
+/**
+ * Verify that overlapping ranges are coalesced into a single mapping, and that the replaced mapping remains valid.
+ */
+- (void) testCoalesceMapping {
+    MObjectPool pool(_allocator);
+    shared_ptr<MObjectPool::Mapping> first;
+    shared_ptr<MObjectPool::Mapping> second;
+    shared_ptr<MObjectPool::Mapping> third;
+
+    STAssertEquals(PLCRASH_ESUCCESS, pool.map(mach_task_self(), _pages, vm_page_size * 2, true, &first), @"Failed to map pages");
+    STAssertEquals(PLCRASH_ESUCCESS, pool.map(mach_task_self(), _pages + vm_page_size, vm_page_size * 2, true, &second), @"Failed to map pages");
+
+    STAssertTrue(first != second, @"Coalesced mapping was not returned");
+    STAssertTrue(second->contains(mach_task_self(), _pages, vm_page_size * 3), @"Mapping was not coalesced");
+    STAssertTrue(memcmp((void *) second->vm_address(), (void *) _pages, vm_page_size * 3) == 0, @"Mapping appears to be incorrect");
+
+    /* The replaced mapping must remain valid while referenced */
+    STAssertTrue(memcmp((void *) first->vm_address(), (void *) _pages, vm_page_size * 2) == 0, @"Mapping appears to be incorrect");
+
+    /* Either of the original ranges should now be satisfied by the coalesced mapping */
+    STAssertEquals(PLCRASH_ESUCCESS, pool.map(mach_task_self(), _pages, vm_page_size, true, &third), @"Failed to map pages");
+    STAssertTrue(second == third, @"Coalesced mapping was not returned");
+}
+
+/**
+ * Test the C interface to the pool.
+ */
+- (void) testCInterface {
+    plcrash_async_mobject_pool_t *pool;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_pool_new(&pool, _allocator), @"Failed to create pool");
+
+    plcrash_async_mobject_pool_ref_t *first;
+    plcrash_async_mobject_pool_ref_t *second;
+    pl_vm_address_t first_address, second_address;
+    pl_vm_size_t first_length, second_length;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_pool_map(pool, mach_task_self(), _pages, vm_page_size * 2, true, &first, &first_address, &first_length), @"Failed to map pages");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_pool_map(pool, mach_task_self(), _pages + vm_page_size + 8, 8, true, &second, &second_address, &second_length), @"Failed to map pages");
+
+    /* The second range should be served from the first mapping, starting at the page containing the target address */
+    STAssertEquals(second_address, first_address + vm_page_size, @"Mapping was not shared");
+    STAssertEquals(second_length, first_length - vm_page_size, @"Incorrect mapping length");
+    STAssertTrue(memcmp((void *) (second_address + 8), (void *) (_pages + vm_page_size + 8), 8) == 0, @"Mapping appears to be incorrect");
+
+    plcrash_async_mobject_pool_ref_free(first);
+    plcrash_async_mobject_pool_ref_free(second);
+    plcrash_async_mobject_pool_free(pool);
+}
+
+@end
@@ -27,11 +27,18 @@
  */
 
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncCompressor.h"
+#include "PLCrashAsyncChecksum.h"
+#include "PLCrashAsyncRegionMap.h"
+#include "PLCrashAsyncInstrumentation.h"
+#include "PLCrashAsyncVirtualTask.h"
 
 #include <stdint.h>
 #include <errno.h>
 #include <string.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 /**
  * @internal
@@ -194,15 +201,41 @@ thread_t pl_mach_thread_self (void) {
  * @return On success, returns PLCRASH_ESUCCESS. If the pages containing @a source + len are unmapped, PLCRASH_ENOTFOUND
  * will be returned. If the pages can not be read due to access restrictions, PLCRASH_EACCESS will be returned. If
  * the proivded address + offset would overflow pl_vm_address_t, PLCRASH_ENOMEM is returned.
+ *
+ * @note If @a task is the current task and a region map has been installed via plcrash_async_region_map_set_current(),
+ * the range is validated against the map and copied directly. If a recorder has been installed via
+ * plcrash_async_vtask_recorder_set_current(), the copied bytes are recorded.
  */
 plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len) {
     pl_vm_address_t target;
     kern_return_t kt;
 
+    plcrash_async_instrumentation_count(PLCRASH_ASYNC_COUNTER_TASK_MEMCPY);
+
     /* Compute the target address and check for overflow */
     if (!plcrash_async_address_apply_offset(address, offset, &target))
         return PLCRASH_ENOMEM;
 
+    /* Serve reads from virtual tasks from their captured memory */
+    plcrash_async_vtask_t *vtask;
+    if (task != mach_task_self() && (vtask = plcrash_async_vtask_lookup(task)) != NULL)
+        return plcrash_async_vtask_memcpy(vtask, target, dest, len);
+
+    /* If a region map is installed for the current task, validate the range against the map and copy directly,
+     * avoiding the kernel trap */
+    const plcrash_async_region_map_t *map;
+    if (task == mach_task_self() && (map = plcrash_async_region_map_current()) != NULL) {
+        if (!plcrash_async_region_map_verify(map, target, len, VM_PROT_NONE))
+            return PLCRASH_ENOTFOUND;
+
+        if (!plcrash_async_region_map_verify(map, target, len, VM_PROT_READ))
+            return PLCRASH_EACCESS;
+
+        plcrash_async_memcpy(dest, (const void *) (uintptr_t) target, len);
+        plcrash_async_vtask_record(target, dest, len);
+        return PLCRASH_ESUCCESS;
+    }
+
 #ifdef PL_HAVE_MACH_VM
     pl_vm_size_t read_size = len;
     kt = mach_vm_read_overwrite(task, target, len, (pointer_t) dest, &read_size);
@@ -213,6 +246,7 @@ plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t add
     
     switch (kt) {
         case KERN_SUCCESS:
+            plcrash_async_vtask_record(target, dest, len);
             return PLCRASH_ESUCCESS;
 
         case KERN_INVALID_ADDRESS:
@@ -264,7 +298,7 @@ plcrash_error_t plcrash_async_task_read_uint16 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint16_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap16(*result);
+    *result = plcrash_async_byteorder_swap16(byteorder, *result);
     return err;
 }
 
@@ -288,7 +322,7 @@ plcrash_error_t plcrash_async_task_read_uint32 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint32_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap32(*result);
+    *result = plcrash_async_byteorder_swap32(byteorder, *result);
     return err;
 }
 
@@ -312,13 +346,33 @@ plcrash_error_t plcrash_async_task_read_uint64 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint64_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap64(*result);
+    *result = plcrash_async_byteorder_swap64(byteorder, *result);
     return err;
 }
 
 /**
- * An intentionally naive async-safe implementation of strcmp(). strcmp() itself is not declared to be async-safe,
- * though in reality, it is.
+ * @internal
+ * A machine word that may alias any other type, used by the word-at-a-time string and memory primitives below.
+ */
+typedef uintptr_t __attribute__((__may_alias__)) plcrash_async_word_t;
+
+/** The size of a plcrash_async_word_t, in bytes. */
+#define PLCRASH_ASYNC_WORD_SIZE sizeof(plcrash_async_word_t)
+
+/** Mask of the low-order address bits that must be zero for a word-aligned address. */
+#define PLCRASH_ASYNC_WORD_MASK (PLCRASH_ASYNC_WORD_SIZE - 1)
+
+/** A word with every byte set to 0x01. */
+#define PLCRASH_ASYNC_WORD_ONES ((uintptr_t) -1 / 0xFF)
+
+/** Evaluates to non-zero if any byte of the word @a w is zero. */
+#define PLCRASH_ASYNC_WORD_HAS_ZERO(w) (((w) - PLCRASH_ASYNC_WORD_ONES) & ~(w) & (PLCRASH_ASYNC_WORD_ONES * 0x80))
+
+/**
+ * An async-safe implementation of strcmp(). strcmp() itself is not declared to be async-safe, though in reality, it is.
+ *
+ * If both strings share the same word alignment, they are compared a word at a time once aligned. An aligned word
+ * read can never cross a page boundary, and as such, can not fault when reading past the terminating NUL.
  *
  * @param s1 First string.
  * @param s2 Second string.
@@ -326,17 +380,39 @@ plcrash_error_t plcrash_async_task_read_uint64 (task_t task, const plcrash_async
  * equal to, or less than the string @a s2.
  */
 int plcrash_async_strcmp(const char *s1, const char *s2) {
-    while (*s1 == *s2++) {
-        if (*s1++ == 0)
+    if ((((uintptr_t) s1 ^ (uintptr_t) s2) & PLCRASH_ASYNC_WORD_MASK) == 0) {
+        /* Compare the unaligned prefix */
+        for (; ((uintptr_t) s1 & PLCRASH_ASYNC_WORD_MASK) != 0; s1++, s2++) {
+            if (*s1 != *s2 || *s1 == '\0')
+                return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
+        }
+
+        /* Skip all identical words that do not contain a NUL; the mismatch (or terminator), if any, will be found
+         * by the byte comparison below. */
+        const plcrash_async_word_t *w1 = (const plcrash_async_word_t *) s1;
+        const plcrash_async_word_t *w2 = (const plcrash_async_word_t *) s2;
+        while (*w1 == *w2 && !PLCRASH_ASYNC_WORD_HAS_ZERO(*w1)) {
+            w1++;
+            w2++;
+        }
+
+        s1 = (const char *) w1;
+        s2 = (const char *) w2;
+    }
+
+    for (; *s1 == *s2; s1++, s2++) {
+        if (*s1 == '\0')
             return (0);
     }
-    
-    return (*(const unsigned char *)s1 - *(const unsigned char *)(s2 - 1));
+
+    return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
 }
 
 /**
- * An intentionally naive async-safe implementation of strncmp(). strncmp() itself is not declared to be async-safe,
- * though in reality, it is.
+ * An async-safe implementation of strncmp(). strncmp() itself is not declared to be async-safe, though in reality,
+ * it is.
+ *
+ * As with plcrash_async_strcmp(), mutually aligned strings are compared a word at a time.
  *
  * @param s1 First string.
  * @param s2 Second string.
@@ -345,38 +421,80 @@ int plcrash_async_strcmp(const char *s1, const char *s2) {
  * equal to, or less than the string @a s2.
  */
 int plcrash_async_strncmp(const char *s1, const char *s2, size_t n) {
-    while (*s1 == *s2++ && n-- > 0) {
-        if (*s1++ == 0)
-            return (0);
+    if ((((uintptr_t) s1 ^ (uintptr_t) s2) & PLCRASH_ASYNC_WORD_MASK) == 0) {
+        /* Compare the unaligned prefix */
+        for (; n > 0 && ((uintptr_t) s1 & PLCRASH_ASYNC_WORD_MASK) != 0; s1++, s2++, n--) {
+            if (*s1 != *s2 || *s1 == '\0')
+                return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
+        }
+
+        /* Skip all identical words that do not contain a NUL */
+        const plcrash_async_word_t *w1 = (const plcrash_async_word_t *) s1;
+        const plcrash_async_word_t *w2 = (const plcrash_async_word_t *) s2;
+        while (n >= PLCRASH_ASYNC_WORD_SIZE && *w1 == *w2 && !PLCRASH_ASYNC_WORD_HAS_ZERO(*w1)) {
+            w1++;
+            w2++;
+            n -= PLCRASH_ASYNC_WORD_SIZE;
+        }
+
+        s1 = (const char *) w1;
+        s2 = (const char *) w2;
+    }
+
+    for (; n > 0; s1++, s2++, n--) {
+        if (*s1 != *s2 || *s1 == '\0')
+            return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
     }
-    
-    if (n == 0)
-        return 0;
 
-    return (*(const unsigned char *)s1 - *(const unsigned char *)(s2 - 1));
+    return 0;
 }
 
 /**
- * An intentionally naive async-safe implementation of memcpy(). memcpy() itself is not declared to be async-safe,
- * though in reality, it is.
+ * An async-safe implementation of memcpy(). memcpy() itself is not declared to be async-safe, though in reality, it is.
+ *
+ * If @a dest and @a source share the same word alignment, the data is copied a word at a time once aligned; otherwise,
+ * the data is copied a byte at a time.
  *
  * @param dest Destination.
  * @param source Source.
  * @param n Number of bytes to copy.
  */
 void *plcrash_async_memcpy (void *dest, const void *source, size_t n) {
-    uint8_t *s = (uint8_t *) source;
+    const uint8_t *s = (const uint8_t *) source;
     uint8_t *d = (uint8_t *) dest;
 
-    for (size_t count = 0; count < n; count++)
+    if ((((uintptr_t) d ^ (uintptr_t) s) & PLCRASH_ASYNC_WORD_MASK) == 0) {
+        for (; n > 0 && ((uintptr_t) d & PLCRASH_ASYNC_WORD_MASK) != 0; n--)
+            *d++ = *s++;
+
+        plcrash_async_word_t *wd = (plcrash_async_word_t *) d;
+        const plcrash_async_word_t *ws = (const plcrash_async_word_t *) s;
+
+        /* Copy four words per iteration */
+        for (; n >= PLCRASH_ASYNC_WORD_SIZE * 4; n -= PLCRASH_ASYNC_WORD_SIZE * 4) {
+            wd[0] = ws[0];
+            wd[1] = ws[1];
+            wd[2] = ws[2];
+            wd[3] = ws[3];
+            wd += 4;
+            ws += 4;
+        }
+
+        for (; n >= PLCRASH_ASYNC_WORD_SIZE; n -= PLCRASH_ASYNC_WORD_SIZE)
+            *wd++ = *ws++;
+
+        d = (uint8_t *) wd;
+        s = (const uint8_t *) ws;
+    }
+
+    for (; n > 0; n--)
         *d++ = *s++;
 
     return (void *) source;
 }
 
 /**
- * An intentionally naive async-safe implementation of memset(). memset() itself is not declared to be async-safe,
- * though in reality, it is.
+ * An async-safe implementation of memset(). memset() itself is not declared to be async-safe, though in reality, it is.
  *
  * @param dest Destination.
  * @param value Value to write to @a dest.
@@ -384,8 +502,26 @@ void *plcrash_async_memcpy (void *dest, const void *source, size_t n) {
  */
 void *plcrash_async_memset(void *dest, uint8_t value, size_t n) {
     uint8_t *d = (uint8_t *) dest;
-    
-    for (size_t count = 0; count < n; count++)
+
+    for (; n > 0 && ((uintptr_t) d & PLCRASH_ASYNC_WORD_MASK) != 0; n--)
+        *d++ = value;
+
+    /* Fill whole words with the replicated byte value */
+    plcrash_async_word_t pattern = PLCRASH_ASYNC_WORD_ONES * value;
+    plcrash_async_word_t *wd = (plcrash_async_word_t *) d;
+    for (; n >= PLCRASH_ASYNC_WORD_SIZE * 4; n -= PLCRASH_ASYNC_WORD_SIZE * 4) {
+        wd[0] = pattern;
+        wd[1] = pattern;
+        wd[2] = pattern;
+        wd[3] = pattern;
+        wd += 4;
+    }
+
+    for (; n >= PLCRASH_ASYNC_WORD_SIZE; n -= PLCRASH_ASYNC_WORD_SIZE)
+        *wd++ = pattern;
+
+    d = (uint8_t *) wd;
+    for (; n > 0; n--)
         *d++ = value;
 
     return (void *) dest;
@@ -408,6 +544,7 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
     const uint8_t *p;
     size_t left;
     ssize_t written = 0;
+    uint64_t start = plcrash_async_instrumentation_begin();
     
     /* Loop until all bytes are written */
     p = (const uint8_t *) data;
@@ -418,6 +555,7 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
                 // Try again
                 written = 0;
             } else {
+                plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_FLUSH, start);
                 return -1;
             }
         }
@@ -426,6 +564,7 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
         p += written;
     }
     
+    plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_FLUSH, start);
     return written;
 }
 
@@ -440,27 +579,253 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
  * @param fd Open file descriptor.
  */
 void plcrash_async_file_init (plcrash_async_file_t *file, int fd, off_t output_limit) {
+    plcrash_async_file_init_buffer(file, fd, output_limit, NULL, 0);
+}
+
+/**
+ * Initialize the plcrash_async_file_t instance, using a caller-provided write buffer. Larger buffers reduce
+ * the number of write(2) calls issued while writing a report; a buffer sized to hold the entire report
+ * will result in a single write at flush time.
+ *
+ * @param file File structure to initialize.
+ * @param fd Open file descriptor.
+ * @param output_limit Maximum number of bytes that will be written to disk. Specify 0 to disable any limits.
+ * See plcrash_async_file_init().
+ * @param buffer The buffer to be used for output buffering, or NULL to use the default inline buffer. The buffer
+ * must remain valid until the file has been flushed or closed.
+ * @param buffer_size The size of @a buffer, in bytes. If 0, the default inline buffer will be used.
+ */
+void plcrash_async_file_init_buffer (plcrash_async_file_t *file, int fd, off_t output_limit, void *buffer, size_t buffer_size) {
+    if (buffer != NULL && buffer_size > 0) {
+        file->buffer = buffer;
+        file->bufsize = buffer_size;
+    } else {
+        file->buffer = file->inline_buffer;
+        file->bufsize = sizeof(file->inline_buffer);
+    }
+
     file->fd = fd;
+    file->mapped = false;
+    file->compressor = NULL;
+    file->sync = PLCRASH_ASYNC_FILE_SYNC_NONE;
+    file->checksum = false;
+    file->crc32c = 0;
+    file->checksum_readback = false;
+    file->checksum_stale = false;
     file->buflen = 0;
     file->total_bytes = 0;
     file->limit_bytes = output_limit;
+
+    /* Record our starting offset; if the descriptor does not support seeking (eg, a pipe), lseek() will return -1 and
+     * positional writes will be disabled. */
+    file->base_offset = lseek(fd, 0, SEEK_CUR);
 }
 
+/**
+ * Initialize the plcrash_async_file_t instance, writing directly to a shared memory mapping of the backing file.
+ *
+ * The caller is responsible for sizing the file (eg, via ftruncate()) and mapping it MAP_SHARED prior to the crash;
+ * all subsequent writes are performed via memcpy() into the mapping, and no write(2) calls are issued. The mapping
+ * size acts as the output limit. When the file is closed, it is truncated to the number of bytes actually written.
+ *
+ * @param file File structure to initialize.
+ * @param fd Open file descriptor for the mapped file.
+ * @param mapping A writable MAP_SHARED mapping of @a fd, starting at file offset 0. The mapping is borrowed, and
+ * must remain valid until the file has been closed.
+ * @param mapping_size The size of @a mapping, in bytes.
+ */
+void plcrash_async_file_init_mapped (plcrash_async_file_t *file, int fd, void *mapping, size_t mapping_size) {
+    plcrash_async_file_init_buffer(file, fd, mapping_size, mapping, mapping_size);
+    file->mapped = true;
+
+    /* All positional writes are performed within the mapping */
+    file->base_offset = 0;
+}
 
 /**
- * Write all bytes from @a data to the file buffer. Returns true on success,
+ * Initialize the plcrash_async_file_t instance as a memory-only sink; all output is written directly to @a buffer,
+ * and no file descriptor is used. The buffer size acts as the output limit, and the number of bytes written may
+ * be fetched via plcrash_async_file_position().
+ *
+ * @param file File structure to initialize.
+ * @param buffer The destination buffer. The buffer is borrowed, and must remain valid until the file has been closed.
+ * @param buffer_size The size of @a buffer, in bytes.
+ */
+void plcrash_async_file_init_memory (plcrash_async_file_t *file, void *buffer, size_t buffer_size) {
+    plcrash_async_file_init_mapped(file, -1, buffer, buffer_size);
+}
+
+
+/**
+ * Flush @a file's backing file to stable storage according to @a sync when the file is closed. The default
+ * policy, PLCRASH_ASYNC_FILE_SYNC_NONE, leaves write-back to the kernel. This has no effect on memory-only sinks.
+ *
+ * @param file The file instance.
+ * @param sync The policy to apply.
+ */
+void plcrash_async_file_set_sync (plcrash_async_file_t *file, plcrash_async_file_sync_t sync) {
+    file->sync = sync;
+}
+
+/**
+ * Maintain a CRC-32C of all data subsequently written to @a file, appending it as a plcrash_async_checksum_trailer_t
+ * when the file is closed. The checksum is computed as data is written, and covers the bytes as stored -- after
+ * compression, if enabled -- allowing a reader to validate the file in a single pass prior to decoding it; see
+ * plcrash_async_checksum_trailer_verify(). This must be called prior to writing any data to @a file, and prior to
+ * plcrash_async_file_set_compressor().
+ *
+ * Positional writes remain supported if the final output can be read back when the file is closed -- that is, if
+ * the file is mapped, or its descriptor was opened O_RDWR. Any backpatched output is then checksummed in a single
+ * additional pass over the written bytes at close. Otherwise, positional writes are no longer supported, and
+ * plcrash_async_file_seekable() will return false.
+ *
+ * @param file The file instance.
+ */
+void plcrash_async_file_set_checksum (plcrash_async_file_t *file) {
+    file->checksum = true;
+    file->crc32c = 0;
+    file->checksum_stale = false;
+
+    if (file->mapped) {
+        file->checksum_readback = true;
+    } else if (file->fd >= 0 && file->base_offset >= 0) {
+        int flags = fcntl(file->fd, F_GETFL);
+        file->checksum_readback = (flags != -1 && (flags & O_ACCMODE) == O_RDWR);
+    } else {
+        file->checksum_readback = false;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Recompute @a file's CRC-32C from its final, already flushed output. Returns true on success, or false if the
+ * output could not be read back.
+ */
+static bool plcrash_async_file_recompute_checksum (plcrash_async_file_t *file) {
+    /* Mapped output is entirely resident in the mapping */
+    if (file->mapped) {
+        file->crc32c = plcrash_async_crc32c(0, file->buffer, file->buflen);
+        return true;
+    }
+
+    /* Otherwise, read back the written range, using our (now empty) write buffer as scratch space */
+    PLCF_ASSERT(file->buflen == 0);
+
+    uint32_t crc = 0;
+    off_t offset = 0;
+    while (offset < file->total_bytes) {
+        size_t chunk = file->bufsize;
+        if ((off_t) chunk > file->total_bytes - offset)
+            chunk = (size_t) (file->total_bytes - offset);
+
+        ssize_t nread = pread(file->fd, file->buffer, chunk, file->base_offset + offset);
+        if (nread <= 0) {
+            if (nread < 0 && errno == EINTR)
+                continue;
+
+            PLCF_DEBUG("Error reading back crash log: %s", nread < 0 ? strerror(errno) : "unexpected EOF");
+            return false;
+        }
+
+        crc = plcrash_async_crc32c(crc, file->buffer, nread);
+        offset += nread;
+    }
+
+    file->crc32c = crc;
+    return true;
+}
+
+/**
+ * Reserve @a length bytes of storage for @a fd via F_PREALLOCATE, so that subsequent writes within that range
+ * do not require the file system to allocate blocks. Contiguous storage is requested first; if unavailable,
+ * any storage is accepted. The file's length is not modified.
+ *
+ * @param fd An open, writable file descriptor.
+ * @param length The number of bytes to reserve.
+ *
+ * @return Returns true on success, or false if the storage could not be reserved, or if F_PREALLOCATE is unsupported.
+ */
+bool plcrash_async_file_preallocate (int fd, off_t length) {
+#ifdef F_PREALLOCATE
+    fstore_t store = {
+        .fst_flags = F_ALLOCATECONTIG,
+        .fst_posmode = F_PEOFPOSMODE,
+        .fst_offset = 0,
+        .fst_length = length
+    };
+
+    if (fcntl(fd, F_PREALLOCATE, &store) == 0)
+        return true;
+
+    store.fst_flags = F_ALLOCATEALL;
+    if (fcntl(fd, F_PREALLOCATE, &store) == 0)
+        return true;
+
+    PLCF_DEBUG("Could not preallocate %" PRId64 " bytes: %s", (int64_t) length, strerror(errno));
+    return false;
+#else
+    return false;
+#endif /* F_PREALLOCATE */
+}
+
+/**
+ * @internal
+ *
+ * Flush the backing file of @a file to stable storage, according to its configured sync policy.
+ */
+static bool plcrash_async_file_sync (plcrash_async_file_t *file) {
+    if (file->sync == PLCRASH_ASYNC_FILE_SYNC_NONE)
+        return true;
+
+    /* Write back the dirty pages of a shared mapping; fsync() alone does not guarantee this */
+    if (file->mapped && file->buflen > 0 && msync(file->buffer, file->buflen, MS_SYNC) != 0) {
+        PLCF_DEBUG("Error syncing crash log mapping: %s", strerror(errno));
+        return false;
+    }
+
+#ifdef F_FULLFSYNC
+    /* F_FULLFSYNC is not supported by all file systems; fall back on fsync() */
+    if (file->sync == PLCRASH_ASYNC_FILE_SYNC_FULLFSYNC && fcntl(file->fd, F_FULLFSYNC) == 0)
+        return true;
+#endif /* F_FULLFSYNC */
+
+    if (fsync(file->fd) != 0) {
+        PLCF_DEBUG("Error syncing crash log: %s", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Write all bytes from @a data to the file buffer, bypassing any configured compressor. Returns true on success,
  * or false if an error occurs.
  */
-bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, size_t len) {
+static bool plcrash_async_file_write_raw (plcrash_async_file_t *file, const void *data, size_t len) {
     /* Check and update output limit */
     if (file->limit_bytes != 0 && len + file->total_bytes > file->limit_bytes) {
         return false;
-    } else if (file->limit_bytes != 0) {
-        file->total_bytes += len;
+    }
+    file->total_bytes += len;
+
+    if (file->checksum)
+        file->crc32c = plcrash_async_crc32c(file->crc32c, data, len);
+
+    /* A mapped file may only be written within the bounds of its mapping */
+    if (file->mapped) {
+        if (file->buflen + len > file->bufsize)
+            return false;
+
+        plcrash_async_memcpy(file->buffer + file->buflen, data, len);
+        file->buflen += len;
+        return true;
     }
 
     /* Check if the buffer will fill */
-    if (file->buflen + len > sizeof(file->buffer)) {
+    if (file->buflen + len > file->bufsize) {
         /* Flush the buffer */
         if (plcrash_async_writen(file->fd, file->buffer, file->buflen) < 0) {
             PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
@@ -471,7 +836,7 @@ bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, siz
     }
     
     /* Check if the new data fits within the buffer, if so, buffer it */
-    if (len + file->buflen <= sizeof(file->buffer)) {
+    if (len + file->buflen <= file->bufsize) {
         plcrash_async_memcpy(file->buffer + file->buflen, data, len);
         file->buflen += len;
         
@@ -489,10 +854,285 @@ bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, siz
 }
 
 
+/**
+ * @internal
+ *
+ * Encode the compressor's pending block (or, if no data is pending, the stream terminator), and write it to the file.
+ */
+static bool plcrash_async_file_write_block (plcrash_async_file_t *file) {
+    const void *block;
+    size_t block_length;
+
+    plcrash_async_compressor_encode_block(file->compressor, &block, &block_length);
+    return plcrash_async_file_write_raw(file, block, block_length);
+}
+
+/**
+ * Compress all subsequent output written to @a file using @a compressor. The compressed report header is written
+ * immediately; this must be called prior to writing any other data to @a file.
+ *
+ * Once compression is enabled, positional writes are no longer supported, and plcrash_async_file_seekable() will
+ * return false. The file position reflects the compressed bytes written, and only includes data that has been
+ * compressed; buffered input is compressed when a full block is available, or when the file is flushed. The
+ * compressed stream is terminated when the file is closed.
+ *
+ * @param file The file instance.
+ * @param compressor The compressor to use. The compressor is borrowed, and must remain valid until the file has been
+ * closed. Any pending input in @a compressor will be discarded.
+ */
+void plcrash_async_file_set_compressor (plcrash_async_file_t *file, plcrash_async_compressor_t *compressor) {
+    plcrash_async_compressed_header_t header;
+
+    plcrash_async_memcpy(header.magic, PLCRASH_ASYNC_COMPRESSED_MAGIC, sizeof(header.magic));
+    header.version = PLCRASH_ASYNC_COMPRESSED_VERSION;
+    plcrash_async_file_write_raw(file, &header, sizeof(header));
+
+    plcrash_async_compressor_reset(compressor);
+    file->compressor = compressor;
+}
+
+/**
+ * Write all bytes from @a data to the file buffer. Returns true on success,
+ * or false if an error occurs.
+ */
+bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, size_t len) {
+    if (file->compressor == NULL)
+        return plcrash_async_file_write_raw(file, data, len);
+
+    /* Feed the compressor, writing out each block as it fills */
+    const uint8_t *p = data;
+    while (len > 0) {
+        size_t consumed = plcrash_async_compressor_append(file->compressor, p, len);
+        p += consumed;
+        len -= consumed;
+
+        if (plcrash_async_compressor_full(file->compressor) && !plcrash_async_file_write_block(file))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Write @a len bytes of @a task's memory at @a address, copying directly from the task into the file's buffer (or, if
+ * compression is enabled, into the compressor's pending block) without an intermediate copy.
+ *
+ * If any portion of the range can not be read, zeros are written in its place; the full @a len bytes are always
+ * written unless an output error occurs. This allows a length-prefixed field to be written prior to reading its
+ * contents.
+ *
+ * Ranges of the current task at least as large as the file's buffer are written to an unmapped, uncompressed file with
+ * a single write() directly from @a address, bypassing the buffer entirely. The kernel reports an unreadable source
+ * range as EFAULT rather than raising a signal; any portion of the range not written directly falls back to the
+ * buffered copy, which zero-fills the unreadable bytes.
+ *
+ * @param file The file instance.
+ * @param task The task from which the data will be read.
+ * @param address The address of the data within @a task.
+ * @param len The number of bytes to be written.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_OUTPUT_ERR if an output error occurs, or the error returned by
+ * plcrash_async_task_memcpy() if any portion of the range could not be read.
+ */
+plcrash_error_t plcrash_async_file_write_task (plcrash_async_file_t *file, task_t task, pl_vm_address_t address, size_t len) {
+    plcrash_error_t result = PLCRASH_ESUCCESS;
+    plcrash_error_t err;
+
+    /* Feed the compressor, writing out each block as it fills */
+    if (file->compressor != NULL) {
+        while (len > 0) {
+            size_t consumed;
+            if ((err = plcrash_async_compressor_append_task(file->compressor, task, address, len, &consumed)) != PLCRASH_ESUCCESS)
+                result = err;
+
+            address += consumed;
+            len -= consumed;
+
+            if (plcrash_async_compressor_full(file->compressor) && !plcrash_async_file_write_block(file))
+                return PLCRASH_OUTPUT_ERR;
+        }
+
+        return result;
+    }
+
+    /* Check and update output limit */
+    if (file->limit_bytes != 0 && len + file->total_bytes > file->limit_bytes)
+        return PLCRASH_OUTPUT_ERR;
+
+    /* A mapped file may only be written within the bounds of its mapping */
+    if (file->mapped && file->buflen + len > file->bufsize)
+        return PLCRASH_OUTPUT_ERR;
+
+    file->total_bytes += len;
+
+    /* Write large local ranges directly from the source memory. This is skipped when checksumming, as the source may
+     * change (or become unreadable) between the write and the checksum. */
+    if (task == mach_task_self() && !file->mapped && !file->checksum && len >= file->bufsize) {
+        if (file->buflen > 0) {
+            if (plcrash_async_writen(file->fd, file->buffer, file->buflen) < 0) {
+                PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
+                return PLCRASH_OUTPUT_ERR;
+            }
+
+            file->buflen = 0;
+        }
+
+        while (len > 0) {
+            ssize_t written = write(file->fd, (const void *) (uintptr_t) address, len);
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            /* Leave any unreadable (or unwritable) remainder to the buffered path */
+            if (written <= 0)
+                break;
+
+            address += written;
+            len -= written;
+        }
+    }
+
+    /* Copy directly into the file buffer, flushing it as it fills */
+    while (len > 0) {
+        if (file->buflen == file->bufsize) {
+            if (plcrash_async_writen(file->fd, file->buffer, file->buflen) < 0) {
+                PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
+                return PLCRASH_OUTPUT_ERR;
+            }
+
+            file->buflen = 0;
+        }
+
+        size_t chunk = file->bufsize - file->buflen;
+        if (chunk > len)
+            chunk = len;
+
+        char *dest = file->buffer + file->buflen;
+        if ((err = plcrash_async_task_memcpy(task, address, 0, dest, chunk)) != PLCRASH_ESUCCESS) {
+            plcrash_async_memset(dest, 0, chunk);
+            result = err;
+        }
+
+        if (file->checksum)
+            file->crc32c = plcrash_async_crc32c(file->crc32c, dest, chunk);
+
+        file->buflen += chunk;
+        address += chunk;
+        len -= chunk;
+    }
+
+    return result;
+}
+
+/**
+ * Return the current write position, relative to the position of the file descriptor at the time
+ * plcrash_async_file_init() was called. This includes any data that is buffered but has not yet been
+ * flushed.
+ *
+ * @param file The file instance.
+ */
+off_t plcrash_async_file_position (plcrash_async_file_t *file) {
+    return file->total_bytes;
+}
+
+/**
+ * Return true if the backing file descriptor supports positional writes via plcrash_async_file_pwrite(), false
+ * otherwise.
+ *
+ * @param file The file instance.
+ */
+bool plcrash_async_file_seekable (plcrash_async_file_t *file) {
+    /* Compressed output can not be backpatched, nor can checksummed output that can't be read back at close */
+    if (file->compressor != NULL || (file->checksum && !file->checksum_readback))
+        return false;
+
+    return file->base_offset >= 0;
+}
+
+/**
+ * Overwrite @a len bytes of previously written data at @a position. This is used to backpatch data (such as
+ * length prefixes) that could not be computed at the time it was originally written.
+ *
+ * If the target range is still buffered, the buffer is modified in place; otherwise, the data is written
+ * via pwrite(). The file's current write position is not modified.
+ *
+ * @param file The file instance.
+ * @param position The position at which @a data will be written, as returned by plcrash_async_file_position().
+ * @param data The data to be written.
+ * @param len The number of bytes to be written.
+ *
+ * @return Returns true on success, or false if the target range has not yet been written, the file does not
+ * support positional writes, or an error occurs.
+ */
+bool plcrash_async_file_pwrite (plcrash_async_file_t *file, off_t position, const void *data, size_t len) {
+    const uint8_t *p = data;
+
+    /* Compressed output can not be backpatched, nor can checksummed output that can't be read back at close */
+    if (file->compressor != NULL || (file->checksum && !file->checksum_readback))
+        return false;
+
+    /* Only data that has already been written may be overwritten */
+    if (position < 0 || position + (off_t) len > file->total_bytes)
+        return false;
+
+    /* The streamed checksum no longer describes the output */
+    if (file->checksum)
+        file->checksum_stale = true;
+
+    /* Handle any portion of the range that has already been flushed to disk */
+    off_t buffer_start = file->total_bytes - file->buflen;
+    if (position < buffer_start) {
+        if (!plcrash_async_file_seekable(file))
+            return false;
+
+        size_t flushed_len = len;
+        if (position + (off_t) flushed_len > buffer_start)
+            flushed_len = (size_t) (buffer_start - position);
+
+        size_t left = flushed_len;
+        off_t offset = file->base_offset + position;
+        uint64_t start = plcrash_async_instrumentation_begin();
+        while (left > 0) {
+            ssize_t written = pwrite(file->fd, p, left, offset);
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR)
+                    continue;
+
+                PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
+                plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_FLUSH, start);
+                return false;
+            }
+
+            left -= written;
+            p += written;
+            offset += written;
+        }
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_FLUSH, start);
+
+        position += flushed_len;
+        len -= flushed_len;
+    }
+
+    /* Patch any remaining bytes within our buffer */
+    if (len > 0)
+        plcrash_async_memcpy(file->buffer + (position - buffer_start), p, len);
+
+    return true;
+}
+
 /**
  * Flush all buffered bytes from the file buffer.
  */
 bool plcrash_async_file_flush (plcrash_async_file_t *file) {
+    /* Compress any pending input */
+    if (file->compressor != NULL && plcrash_async_compressor_pending(file->compressor) > 0) {
+        if (!plcrash_async_file_write_block(file))
+            return false;
+    }
+
+    /* Mapped data is already in place; the file will be trimmed to the written length on close */
+    if (file->mapped)
+        return true;
+
     /* Anything to do? */
     if (file->buflen == 0)
         return true;
@@ -510,13 +1150,62 @@ bool plcrash_async_file_flush (plcrash_async_file_t *file) {
 
 
 /**
- * Close the backing file descriptor.
+ * Close the backing file descriptor, if any.
  */
 bool plcrash_async_file_close (plcrash_async_file_t *file) {
+    /* Compress any pending input, and terminate the compressed stream */
+    if (file->compressor != NULL) {
+        if (plcrash_async_compressor_pending(file->compressor) > 0 && !plcrash_async_file_write_block(file))
+            return false;
+
+        if (!plcrash_async_file_write_block(file))
+            return false;
+
+        file->compressor = NULL;
+    }
+
+    /* Recompute the checksum over the final output if it was backpatched. This is non-fatal; should the output not be
+     * readable, the file is left unchecksummed. */
+    if (file->checksum && file->checksum_stale) {
+        if (!plcrash_async_file_flush(file))
+            return false;
+
+        file->checksum_stale = false;
+        if (!plcrash_async_file_recompute_checksum(file))
+            file->checksum = false;
+    }
+
+    /* Append the checksum trailer. This is non-fatal; should the output limit leave no room for the trailer, the file
+     * is left unchecksummed, and readers will decode it as-is. */
+    if (file->checksum) {
+        plcrash_async_checksum_trailer_t trailer;
+        trailer.length = (uint64_t) file->total_bytes;
+        trailer.crc32c = file->crc32c;
+        trailer.reserved = 0;
+        plcrash_async_memcpy(trailer.magic, PLCRASH_ASYNC_CHECKSUM_TRAILER_MAGIC, sizeof(trailer.magic));
+
+        file->checksum = false;
+        if (!plcrash_async_file_write_raw(file, &trailer, sizeof(trailer)))
+            PLCF_DEBUG("Could not write the checksum trailer");
+    }
+
     /* Flush any pending data */
     if (!plcrash_async_file_flush(file))
         return false;
 
+    /* Memory-only output has no backing file descriptor */
+    if (file->fd < 0)
+        return true;
+
+    /* Trim a mapped file to the length actually written */
+    if (file->mapped && ftruncate(file->fd, file->total_bytes) != 0) {
+        PLCF_DEBUG("Error truncating crash log: %s", strerror(errno));
+        return false;
+    }
+
+    /* Flush to stable storage, if requested. This is not fatal; the data has already been handed to the kernel. */
+    plcrash_async_file_sync(file);
+
     /* Close the file descriptor */
     if (close(file->fd) != 0) {
         PLCF_DEBUG("Error closing file: %s", strerror(errno));
@@ -131,8 +131,9 @@ typedef int64_t pl_vm_off_t;
 
 #endif /* PLCF_RELEASE_BUILD */
 
-// Debug output support. Lines are capped at 128 (stack space is scarce). This implemention
-// is not async-safe and should not be enabled in release builds
+// Debug output support. Lines are capped at 256 bytes (stack space is scarce), and are written with a single call
+// to plcrash_async_debug_write(), which buffers the line if a debug log is installed (see PLCrashAsyncDebugLog.h).
+// Formatting is not async-safe, and this should not be enabled in release builds
 #ifdef PLCF_RELEASE_BUILD
 
 #define PLCF_DEBUG(msg, args...)
@@ -140,19 +141,14 @@ typedef int64_t pl_vm_off_t;
 #else
 
 #define PLCF_DEBUG(msg, args...) {\
-    char __tmp_output[128];\
-    snprintf(__tmp_output, sizeof(__tmp_output), "[PLCrashReport] "); \
-    plcrash_async_writen(STDERR_FILENO, __tmp_output, strlen(__tmp_output));\
-    \
-    snprintf(__tmp_output, sizeof(__tmp_output), ":%d: ", __LINE__); \
-    plcrash_async_writen(STDERR_FILENO, __func__, strlen(__func__));\
-    plcrash_async_writen(STDERR_FILENO, __tmp_output, strlen(__tmp_output));\
-    \
-    snprintf(__tmp_output, sizeof(__tmp_output), msg, ## args); \
-    plcrash_async_writen(STDERR_FILENO, __tmp_output, strlen(__tmp_output));\
-    \
-    __tmp_output[0] = '\n'; \
-    plcrash_async_writen(STDERR_FILENO, __tmp_output, 1); \
+    char __tmp_output[256];\
+    int __tmp_len = snprintf(__tmp_output, sizeof(__tmp_output) - 1, "[PLCrashReport] %s:%d: " msg, __func__, __LINE__, ## args); \
+    if (__tmp_len >= 0) { \
+        if ((size_t) __tmp_len > sizeof(__tmp_output) - 2) \
+            __tmp_len = sizeof(__tmp_output) - 2; \
+        __tmp_output[__tmp_len++] = '\n'; \
+        plcrash_async_debug_write(__tmp_output, (size_t) __tmp_len); \
+    } \
 }
 
 #endif /* PLCF_RELEASE_BUILD */
@@ -220,19 +216,63 @@ typedef struct plcrash_async_byteorder {
 #ifdef __cplusplus
 public:
     /** Byte swap a 16-bit value */
-    uint16_t swap (uint16_t v) const { return swap16(v); }
+    inline uint16_t swap (uint16_t v) const;
     
     /** Byte swap a 32-bit value */
-    uint32_t swap (uint32_t v) const { return swap32(v); }
+    inline uint32_t swap (uint32_t v) const;
     
     /** Byte swap a 64-bit value */
-    uint64_t swap (uint64_t v) const { return swap64(v); }
+    inline uint64_t swap (uint64_t v) const;
 #endif
 } plcrash_async_byteorder_t;
 
 extern const plcrash_async_byteorder_t plcrash_async_byteorder_swapped;
 extern const plcrash_async_byteorder_t plcrash_async_byteorder_direct;
 
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap @a v from @a byteorder to the host byte order. Targets using the host's byte order are by far the common case;
+ * for plcrash_async_byteorder_direct, the value is returned directly, avoiding an indirect call through
+ * @a byteorder.
+ */
+static inline uint16_t plcrash_async_byteorder_swap16 (const plcrash_async_byteorder_t *byteorder, uint16_t v) {
+    if (__builtin_expect(byteorder == &plcrash_async_byteorder_direct, 1))
+        return v;
+    return byteorder->swap16(v);
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap @a v from @a byteorder to the host byte order. See plcrash_async_byteorder_swap16().
+ */
+static inline uint32_t plcrash_async_byteorder_swap32 (const plcrash_async_byteorder_t *byteorder, uint32_t v) {
+    if (__builtin_expect(byteorder == &plcrash_async_byteorder_direct, 1))
+        return v;
+    return byteorder->swap32(v);
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap @a v from @a byteorder to the host byte order. See plcrash_async_byteorder_swap16().
+ */
+static inline uint64_t plcrash_async_byteorder_swap64 (const plcrash_async_byteorder_t *byteorder, uint64_t v) {
+    if (__builtin_expect(byteorder == &plcrash_async_byteorder_direct, 1))
+        return v;
+    return byteorder->swap64(v);
+}
+
+#ifdef __cplusplus
+inline uint16_t plcrash_async_byteorder::swap (uint16_t v) const { return plcrash_async_byteorder_swap16(this, v); }
+inline uint32_t plcrash_async_byteorder::swap (uint32_t v) const { return plcrash_async_byteorder_swap32(this, v); }
+inline uint64_t plcrash_async_byteorder::swap (uint64_t v) const { return plcrash_async_byteorder_swap64(this, v); }
+#endif
+
 extern const plcrash_async_byteorder_t *plcrash_async_byteorder_little_endian (void);
 extern const plcrash_async_byteorder_t *plcrash_async_byteorder_big_endian (void);
 
@@ -256,6 +296,16 @@ void *plcrash_async_memcpy(void *dest, const void *source, size_t n);
 void *plcrash_async_memset(void *dest, uint8_t value, size_t n);
 
 ssize_t plcrash_async_writen (int fd, const void *data, size_t len);
+void plcrash_async_debug_write (const char *line, size_t len);
+
+/**
+ * @internal
+ * @ingroup plcrash_async_bufio
+ *
+ * Size of the default write buffer embedded within plcrash_async_file_t. A larger buffer may be
+ * supplied via plcrash_async_file_init_buffer().
+ */
+#define PLCRASH_ASYNC_FILE_INLINE_BUFFER_SIZE 256
 
 /**
  * @internal
@@ -264,6 +314,23 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len);
  * Async-safe buffered file output. This implementation is only intended for use
  * within signal handler execution of crash log output.
  */
+/**
+ * @internal
+ * @ingroup plcrash_async_bufio
+ *
+ * Policies for flushing a plcrash_async_file_t's backing file to stable storage when it is closed.
+ */
+typedef enum {
+    /** Do not explicitly flush the file. */
+    PLCRASH_ASYNC_FILE_SYNC_NONE = 0,
+
+    /** Flush the file via fsync(). */
+    PLCRASH_ASYNC_FILE_SYNC_FSYNC = 1,
+
+    /** Flush the file and the device's write cache via F_FULLFSYNC, falling back on fsync() if unsupported. */
+    PLCRASH_ASYNC_FILE_SYNC_FULLFSYNC = 2
+} plcrash_async_file_sync_t;
+
 typedef struct plcrash_async_file {
     /** Output file descriptor */
     int fd;
@@ -274,16 +341,63 @@ typedef struct plcrash_async_file {
     /** Total bytes written */
     off_t total_bytes;
 
+    /** The file descriptor offset at which this writer began writing, or -1 if the descriptor is not seekable. */
+    off_t base_offset;
+
     /** Current length of data in buffer */
     size_t buflen;
 
-    /** Buffered output */
-    char buffer[256];
+    /** Total capacity of buffer, in bytes */
+    size_t bufsize;
+
+    /** Buffered output; either inline_buffer, or a caller-provided buffer */
+    char *buffer;
+
+    /** If true, buffer is the final destination of all output (either a shared memory mapping of the backing file,
+     * or, if fd is -1, a memory-only sink), and data is never written via write(). */
+    bool mapped;
+
+    /** If non-NULL, all output is compressed via this compressor prior to being written. See
+     * plcrash_async_file_set_compressor(). */
+    struct plcrash_async_compressor *compressor;
+
+    /** The policy used to flush the backing file to stable storage when the file is closed. See
+     * plcrash_async_file_set_sync(). */
+    plcrash_async_file_sync_t sync;
+
+    /** If true, a CRC-32C of all output is maintained in crc32c, and appended as a trailer when the file is closed.
+     * See plcrash_async_file_set_checksum(). */
+    bool checksum;
+
+    /** The CRC-32C of all bytes written, including any compressed report header. Only valid if checksum is true. */
+    uint32_t crc32c;
+
+    /** If true, the final output may be read back (from the mapping, or via pread()), and positional writes are
+     * supported while checksumming. Only valid if checksum is true. */
+    bool checksum_readback;
+
+    /** If true, previously written data has been overwritten via plcrash_async_file_pwrite(), and crc32c must be
+     * recomputed from the final output when the file is closed. */
+    bool checksum_stale;
+
+    /** Default buffer storage */
+    char inline_buffer[PLCRASH_ASYNC_FILE_INLINE_BUFFER_SIZE];
 } plcrash_async_file_t;
 
 
 void plcrash_async_file_init (plcrash_async_file_t *file, int fd, off_t output_limit);
+void plcrash_async_file_init_buffer (plcrash_async_file_t *file, int fd, off_t output_limit, void *buffer, size_t buffer_size);
+void plcrash_async_file_init_mapped (plcrash_async_file_t *file, int fd, void *mapping, size_t mapping_size);
+void plcrash_async_file_init_memory (plcrash_async_file_t *file, void *buffer, size_t buffer_size);
+void plcrash_async_file_set_compressor (plcrash_async_file_t *file, struct plcrash_async_compressor *compressor);
+void plcrash_async_file_set_sync (plcrash_async_file_t *file, plcrash_async_file_sync_t sync);
+void plcrash_async_file_set_checksum (plcrash_async_file_t *file);
+bool plcrash_async_file_preallocate (int fd, off_t length);
 bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, size_t len);
+plcrash_error_t plcrash_async_file_write_task (plcrash_async_file_t *file, task_t task, pl_vm_address_t address, size_t len);
+off_t plcrash_async_file_position (plcrash_async_file_t *file);
+bool plcrash_async_file_seekable (plcrash_async_file_t *file);
+bool plcrash_async_file_pwrite (plcrash_async_file_t *file, off_t position, const void *data, size_t len);
 bool plcrash_async_file_flush (plcrash_async_file_t *file);
 bool plcrash_async_file_close (plcrash_async_file_t *file);
     
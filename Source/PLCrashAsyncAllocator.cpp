@@ -31,10 +31,27 @@
 using namespace plcrash::async;
 
 /**
- * Equivalent to AsyncAllocator::Create();
+ * Equivalent to AsyncAllocator::Create(), with AsyncAllocator::SizeClassBins enabled.
  */
 plcrash_error_t plcrash_async_allocator_create (plcrash_async_allocator_t **allocator, size_t initial_size) {
-    return AsyncAllocator::Create(allocator, initial_size);
+    return AsyncAllocator::Create(allocator, initial_size, AsyncAllocator::SizeClassBins);
+}
+
+/**
+ * Equivalent to AsyncAllocator::Create(), with AsyncAllocator::SizeClassBins and AsyncAllocator::ThreadMagazines enabled.
+ *
+ * Each such allocator holds a pthread key for its lifetime; this should only be used for long-lived allocators shared
+ * by multiple threads.
+ */
+plcrash_error_t plcrash_async_magazine_allocator_create (plcrash_async_allocator_t **allocator, size_t initial_size) {
+    return AsyncAllocator::Create(allocator, initial_size, AsyncAllocator::SizeClassBins | AsyncAllocator::ThreadMagazines);
+}
+
+/**
+ * Equivalent to AsyncAllocator::Create(), with AsyncAllocator::Arena enabled.
+ */
+plcrash_error_t plcrash_async_arena_create (plcrash_async_allocator_t **allocator, size_t initial_size) {
+    return AsyncAllocator::Create(allocator, initial_size, AsyncAllocator::Arena);
 }
 
 /**
@@ -51,6 +68,41 @@ void plcrash_async_allocator_dealloc (plcrash_async_allocator_t *allocator, void
     return allocator->dealloc(ptr);
 }
 
+/**
+ * Equivalent to AsyncAllocator::reset();
+ */
+void plcrash_async_allocator_reset (plcrash_async_allocator_t *allocator) {
+    allocator->reset();
+}
+
+/**
+ * Equivalent to AsyncAllocator::reserve();
+ */
+plcrash_error_t plcrash_async_allocator_reserve (plcrash_async_allocator_t *allocator, size_t count) {
+    return allocator->reserve(count);
+}
+
+/**
+ * Equivalent to AsyncAllocator::refill_reserve();
+ */
+plcrash_error_t plcrash_async_allocator_refill_reserve (plcrash_async_allocator_t *allocator) {
+    return allocator->refill_reserve();
+}
+
+/**
+ * Equivalent to AsyncAllocator::nasync_prefault();
+ */
+plcrash_error_t plcrash_nasync_allocator_prefault (plcrash_async_allocator_t *allocator, bool wire) {
+    return allocator->nasync_prefault(wire);
+}
+
+/**
+ * Equivalent to AsyncAllocator::stats().high_water_bytes;
+ */
+size_t plcrash_async_allocator_high_water (plcrash_async_allocator_t *allocator) {
+    return allocator->stats().high_water_bytes;
+}
+
 /**
  * Equivalent to `delete AsyncAllocator`;
  */
@@ -49,9 +49,19 @@ typedef struct plcrash_async_allocator plcrash_async_allocator_t;
 PLCR_C_BEGIN_DECLS
 
 PLCR_EXPORT plcrash_error_t plcrash_async_allocator_create (plcrash_async_allocator_t **allocator, size_t initial_size);
+PLCR_EXPORT plcrash_error_t plcrash_async_magazine_allocator_create (plcrash_async_allocator_t **allocator, size_t initial_size);
+PLCR_EXPORT plcrash_error_t plcrash_async_arena_create (plcrash_async_allocator_t **allocator, size_t initial_size);
 
 PLCR_EXPORT plcrash_error_t plcrash_async_allocator_alloc (plcrash_async_allocator_t *allocator, void **allocated, size_t size);
 PLCR_EXPORT void plcrash_async_allocator_dealloc (plcrash_async_allocator_t *allocator, void *ptr);
+PLCR_EXPORT void plcrash_async_allocator_reset (plcrash_async_allocator_t *allocator);
+
+PLCR_EXPORT plcrash_error_t plcrash_async_allocator_reserve (plcrash_async_allocator_t *allocator, size_t count);
+PLCR_EXPORT plcrash_error_t plcrash_async_allocator_refill_reserve (plcrash_async_allocator_t *allocator);
+
+PLCR_EXPORT plcrash_error_t plcrash_nasync_allocator_prefault (plcrash_async_allocator_t *allocator, bool wire);
+
+PLCR_EXPORT size_t plcrash_async_allocator_high_water (plcrash_async_allocator_t *allocator);
 
 PLCR_EXPORT void plcrash_async_allocator_free (plcrash_async_allocator_t *allocator);
 
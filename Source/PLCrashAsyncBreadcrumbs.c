@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncBreadcrumbs.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_breadcrumbs Breadcrumb Ring
+ *
+ * Implements a fixed-size, lock-free ring of application breadcrumbs. Breadcrumbs are appended by application
+ * threads via a single atomic increment, and the ring's raw contents are copied into crash reports as-is; they
+ * are only decoded when the report is read.
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Return the entry at @a index (modulo the entry count) of the ring described by @a header.
+ */
+static inline plcrash_async_breadcrumb_entry_t *breadcrumb_entry (const plcrash_async_breadcrumbs_header_t *header, int64_t index) {
+    size_t slot = (size_t) ((uint64_t) index & (header->entry_count - 1));
+    return (plcrash_async_breadcrumb_entry_t *) ((uint8_t *) (header + 1) + (slot * header->entry_size));
+}
+
+/**
+ * Initialize @a ring with room for at least @a entry_count breadcrumbs of up to @a entry_size bytes each, including
+ * the per-entry header.
+ *
+ * @param ring The ring to initialize.
+ * @param path The path of the file to back the ring, or NULL to use anonymous memory. Any existing file will be
+ * replaced.
+ * @param entry_count The minimum number of entries; this will be rounded up to a power of two.
+ * @param entry_size The size of each entry, in bytes; this will be rounded up to a multiple of 8.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a entry_count or @a entry_size is out of range, or
+ * PLCRASH_ENOMEM if the backing file could not be created or mapped.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_breadcrumbs_init (plcrash_async_breadcrumbs_t *ring, const char *path, uint32_t entry_count, uint32_t entry_size) {
+    if (entry_count == 0 || entry_count > (UINT32_C(1) << 20))
+        return PLCRASH_EINVAL;
+
+    if (entry_size <= sizeof(plcrash_async_breadcrumb_entry_t) || entry_size > (UINT32_C(1) << 16))
+        return PLCRASH_EINVAL;
+
+    uint32_t count = 1;
+    while (count < entry_count)
+        count <<= 1;
+
+    entry_size = (entry_size + 7) & ~UINT32_C(7);
+
+    size_t size = sizeof(plcrash_async_breadcrumbs_header_t) + ((size_t) count * entry_size);
+    size = (size + PAGE_SIZE - 1) & ~((size_t) PAGE_SIZE - 1);
+
+    /* Set up the backing store */
+    int fd = -1;
+    void *addr;
+    if (path != NULL) {
+        fd = open(path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+        if (fd < 0) {
+            PLCF_DEBUG("Could not open the breadcrumb file: %s", strerror(errno));
+            return PLCRASH_ENOMEM;
+        }
+
+        if (ftruncate(fd, size) != 0) {
+            PLCF_DEBUG("Could not size the breadcrumb file: %s", strerror(errno));
+            close(fd);
+            unlink(path);
+            return PLCRASH_ENOMEM;
+        }
+
+        addr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    } else {
+        addr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE, -1, 0);
+    }
+
+    if (addr == MAP_FAILED) {
+        PLCF_DEBUG("Could not map the breadcrumb ring: %s", strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Fault in the mapping, so that appends do not fault in new pages */
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        ((volatile uint8_t *) addr)[offset] = 0;
+
+    ring->header = addr;
+    ring->size = size;
+    ring->fd = fd;
+
+    ring->header->magic = PLCRASH_ASYNC_BREADCRUMBS_MAGIC;
+    ring->header->version = PLCRASH_ASYNC_BREADCRUMBS_VERSION;
+    ring->header->entry_count = count;
+    ring->header->entry_size = entry_size;
+    ring->header->next = 0;
+    ring->header->reserved = 0;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Append a breadcrumb to @a ring, overwriting the oldest breadcrumb if the ring is full. Messages longer than the
+ * ring's entry size permits are truncated.
+ *
+ * This function is async-safe and lock-free, and may be called concurrently from any number of threads.
+ *
+ * @param ring The breadcrumb ring.
+ * @param message The breadcrumb message.
+ * @param length The length of @a message, in bytes.
+ */
+void plcrash_async_breadcrumbs_append (plcrash_async_breadcrumbs_t *ring, const char *message, size_t length) {
+    plcrash_async_breadcrumbs_header_t *header = ring->header;
+
+    /* Claim the next entry */
+    int64_t index = OSAtomicIncrement64(&header->next) - 1;
+    plcrash_async_breadcrumb_entry_t *entry = breadcrumb_entry(header, index);
+
+    /* Invalidate the entry while it is being written */
+    entry->sequence = 0;
+    OSMemoryBarrier();
+
+    struct timeval tv;
+    if (gettimeofday(&tv, NULL) == 0) {
+        entry->timestamp = ((uint64_t) tv.tv_sec * 1000000) + (uint64_t) tv.tv_usec;
+    } else {
+        entry->timestamp = 0;
+    }
+
+    size_t max_length = header->entry_size - sizeof(plcrash_async_breadcrumb_entry_t);
+    if (length > max_length)
+        length = max_length;
+
+    plcrash_async_memcpy(entry->message, message, length);
+    entry->length = (uint32_t) length;
+    entry->reserved = 0;
+
+    /* Publish the entry */
+    OSMemoryBarrier();
+    entry->sequence = index + 1;
+}
+
+/**
+ * Return the raw contents of @a ring, suitable for decoding via plcrash_async_breadcrumbs_enumerate(). This function
+ * is async-safe.
+ *
+ * @param ring The breadcrumb ring.
+ * @param[out] length On return, the length of the returned snapshot, in bytes.
+ *
+ * @return Returns a pointer to the ring's mapping. Entries may continue to be appended while the snapshot is read;
+ * any entry that is overwritten while being copied will fail validation when the copy is enumerated.
+ */
+const void *plcrash_async_breadcrumbs_snapshot (plcrash_async_breadcrumbs_t *ring, size_t *length) {
+    *length = sizeof(plcrash_async_breadcrumbs_header_t) + ((size_t) ring->header->entry_count * ring->header->entry_size);
+    return ring->header;
+}
+
+/**
+ * Enumerate the valid breadcrumbs in @a snapshot, oldest first. Entries that were being written when the snapshot
+ * was taken are skipped. This function is async-safe.
+ *
+ * @param snapshot A ring snapshot, as returned by plcrash_async_breadcrumbs_snapshot().
+ * @param length The length of @a snapshot, in bytes.
+ * @param callback The callback to be called for each breadcrumb.
+ * @param context A context value to be passed to @a callback.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVALID_DATA if @a snapshot is not a valid ring.
+ */
+plcrash_error_t plcrash_async_breadcrumbs_enumerate (const void *snapshot, size_t length, plcrash_async_breadcrumbs_enumerate_fn callback, void *context) {
+    const plcrash_async_breadcrumbs_header_t *header = snapshot;
+
+    /* Validate the header */
+    if (length < sizeof(*header))
+        return PLCRASH_EINVALID_DATA;
+
+    if (header->magic != PLCRASH_ASYNC_BREADCRUMBS_MAGIC || header->version != PLCRASH_ASYNC_BREADCRUMBS_VERSION)
+        return PLCRASH_EINVALID_DATA;
+
+    uint32_t count = header->entry_count;
+    uint32_t entry_size = header->entry_size;
+    if (count == 0 || (count & (count - 1)) != 0 || entry_size <= sizeof(plcrash_async_breadcrumb_entry_t) || (entry_size % 8) != 0)
+        return PLCRASH_EINVALID_DATA;
+
+    if ((length - sizeof(*header)) / entry_size < count)
+        return PLCRASH_EINVALID_DATA;
+
+    /* Walk the most recent entries */
+    int64_t next = header->next;
+    if (next < 0)
+        return PLCRASH_EINVALID_DATA;
+
+    int64_t first = (next > (int64_t) count) ? next - count : 0;
+    size_t max_length = entry_size - sizeof(plcrash_async_breadcrumb_entry_t);
+
+    for (int64_t i = first; i < next; i++) {
+        const plcrash_async_breadcrumb_entry_t *entry = breadcrumb_entry(header, i);
+        if (entry->sequence != i + 1)
+            continue;
+
+        size_t entry_length = entry->length;
+        if (entry_length > max_length)
+            entry_length = max_length;
+
+        callback(entry->timestamp, entry->message, entry_length, context);
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free all resources associated with @a ring. The backing file, if any, is left in place.
+ *
+ * @param ring The breadcrumb ring.
+ *
+ * @warning This function is not async-safe, and no other thread may be using the ring.
+ */
+void plcrash_nasync_breadcrumbs_free (plcrash_async_breadcrumbs_t *ring) {
+    munmap(ring->header, ring->size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+}
+
+/**
+ * @}
+ */
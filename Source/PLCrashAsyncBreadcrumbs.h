@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_BREADCRUMBS_H
+#define PLCRASH_ASYNC_BREADCRUMBS_H
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_breadcrumbs
+ * @{
+ */
+
+/** Breadcrumb ring magic ('PLBC'). */
+#define PLCRASH_ASYNC_BREADCRUMBS_MAGIC 0x504C4243
+
+/** Breadcrumb ring format version. */
+#define PLCRASH_ASYNC_BREADCRUMBS_VERSION 1
+
+/**
+ * @internal
+ *
+ * The breadcrumb ring header. The ring is laid out as this header, followed by @a entry_count entries of
+ * @a entry_size bytes each. All values are in host byte order.
+ */
+typedef struct plcrash_async_breadcrumbs_header {
+    /** PLCRASH_ASYNC_BREADCRUMBS_MAGIC */
+    uint32_t magic;
+
+    /** PLCRASH_ASYNC_BREADCRUMBS_VERSION */
+    uint32_t version;
+
+    /** The number of entries in the ring; always a power of two. */
+    uint32_t entry_count;
+
+    /** The size of a single entry, including its header, in bytes; always a multiple of 8. */
+    uint32_t entry_size;
+
+    /** The number of entries that have been reserved by writers. The next entry is written to
+     * (next % entry_count). */
+    volatile int64_t next;
+
+    /** Reserved; must be 0. */
+    uint64_t reserved;
+} plcrash_async_breadcrumbs_header_t;
+
+/**
+ * @internal
+ *
+ * A single breadcrumb entry.
+ */
+typedef struct plcrash_async_breadcrumb_entry {
+    /** The entry's index in the ring's sequence, plus one; 0 while the entry is being written. An entry is only
+     * valid if its sequence matches the position at which it was found. */
+    volatile int64_t sequence;
+
+    /** The time at which the breadcrumb was recorded, in microseconds since the epoch. */
+    uint64_t timestamp;
+
+    /** The length of @a message, in bytes. */
+    uint32_t length;
+
+    /** Reserved; must be 0. */
+    uint32_t reserved;
+
+    /** The breadcrumb message. This is not NUL-terminated. */
+    char message[];
+} plcrash_async_breadcrumb_entry_t;
+
+/**
+ * @internal
+ *
+ * A fixed-size, lock-free breadcrumb ring, backed by a shared file mapping. Since the ring's contents are written
+ * directly to the file's pages, the most recent breadcrumbs survive the termination of the process, even should the
+ * crash handler itself fail.
+ */
+typedef struct plcrash_async_breadcrumbs {
+    /** The mapped ring. */
+    plcrash_async_breadcrumbs_header_t *header;
+
+    /** The size of the mapping, in bytes. */
+    size_t size;
+
+    /** The backing file descriptor, or -1 if the ring is backed by anonymous memory. */
+    int fd;
+} plcrash_async_breadcrumbs_t;
+
+/**
+ * @internal
+ *
+ * A breadcrumb enumeration callback.
+ *
+ * @param timestamp The time at which the breadcrumb was recorded, in microseconds since the epoch.
+ * @param message The breadcrumb message. This is not NUL-terminated.
+ * @param length The length of @a message, in bytes.
+ * @param context The context value supplied to plcrash_async_breadcrumbs_enumerate().
+ */
+typedef void (*plcrash_async_breadcrumbs_enumerate_fn)(uint64_t timestamp, const char *message, size_t length, void *context);
+
+plcrash_error_t plcrash_nasync_breadcrumbs_init (plcrash_async_breadcrumbs_t *ring, const char *path, uint32_t entry_count, uint32_t entry_size);
+
+void plcrash_async_breadcrumbs_append (plcrash_async_breadcrumbs_t *ring, const char *message, size_t length);
+const void *plcrash_async_breadcrumbs_snapshot (plcrash_async_breadcrumbs_t *ring, size_t *length);
+
+plcrash_error_t plcrash_async_breadcrumbs_enumerate (const void *snapshot, size_t length, plcrash_async_breadcrumbs_enumerate_fn callback, void *context);
+
+void plcrash_nasync_breadcrumbs_free (plcrash_async_breadcrumbs_t *ring);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_BREADCRUMBS_H */
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncBreadcrumbs.h"
+
+@interface PLCrashAsyncBreadcrumbsTests : SenTestCase {
+@private
+    /** Decoded breadcrumb messages */
+    NSMutableArray *_messages;
+}
+@end
+
+static void collect_breadcrumb (uint64_t timestamp, const char *message, size_t length, void *context) {
+    NSMutableArray *messages = context;
+    NSString *str = [[[NSString alloc] initWithBytes: message length: length encoding: NSUTF8StringEncoding] autorelease];
+    [messages addObject: str];
+}
+
+@implementation PLCrashAsyncBreadcrumbsTests
+
+- (void) setUp {
+    _messages = [[NSMutableArray alloc] init];
+}
+
+- (void) tearDown {
+    [_messages release];
+}
+
+/**
+ * Append a formatted breadcrumb to @a ring.
+ */
+- (void) appendTo: (plcrash_async_breadcrumbs_t *) ring message: (NSString *) message {
+    plcrash_async_breadcrumbs_append(ring, [message UTF8String], strlen([message UTF8String]));
+}
+
+/**
+ * Enumerate the breadcrumbs in @a ring into _messages.
+ */
+- (plcrash_error_t) enumerate: (plcrash_async_breadcrumbs_t *) ring {
+    size_t length;
+    const void *snapshot = plcrash_async_breadcrumbs_snapshot(ring, &length);
+
+    [_messages removeAllObjects];
+    return plcrash_async_breadcrumbs_enumerate(snapshot, length, collect_breadcrumb, _messages);
+}
+
+/**
+ * Verify that breadcrumbs are returned in order, and that the oldest breadcrumbs are overwritten once the
+ * ring is full.
+ */
+- (void) testAppendAndWrap {
+    plcrash_async_breadcrumbs_t ring;
+    STAssertEquals(plcrash_nasync_breadcrumbs_init(&ring, NULL, 3, 64), PLCRASH_ESUCCESS, @"Failed to initialize ring");
+    STAssertEquals(ring.header->entry_count, (uint32_t) 4, @"Entry count was not rounded to a power of two");
+
+    STAssertEquals([self enumerate: &ring], PLCRASH_ESUCCESS, @"Failed to enumerate empty ring");
+    STAssertEquals([_messages count], (NSUInteger) 0, @"Empty ring returned breadcrumbs");
+
+    for (int i = 0; i < 6; i++)
+        [self appendTo: &ring message: [NSString stringWithFormat: @"crumb %d", i]];
+
+    STAssertEquals([self enumerate: &ring], PLCRASH_ESUCCESS, @"Failed to enumerate ring");
+    NSArray *expected = [NSArray arrayWithObjects: @"crumb 2", @"crumb 3", @"crumb 4", @"crumb 5", nil];
+    STAssertEqualObjects(_messages, expected, @"Incorrect breadcrumbs");
+
+    plcrash_nasync_breadcrumbs_free(&ring);
+}
+
+/**
+ * Verify that overlong messages are truncated to the entry size.
+ */
+- (void) testTruncation {
+    plcrash_async_breadcrumbs_t ring;
+    STAssertEquals(plcrash_nasync_breadcrumbs_init(&ring, NULL, 2, sizeof(plcrash_async_breadcrumb_entry_t) + 8), PLCRASH_ESUCCESS, @"Failed to initialize ring");
+
+    [self appendTo: &ring message: @"0123456789"];
+    STAssertEquals([self enumerate: &ring], PLCRASH_ESUCCESS, @"Failed to enumerate ring");
+    STAssertEqualObjects(_messages, [NSArray arrayWithObject: @"01234567"], @"Message was not truncated");
+
+    plcrash_nasync_breadcrumbs_free(&ring);
+}
+
+/**
+ * Verify that incomplete entries are skipped, and that invalid rings are rejected.
+ */
+- (void) testValidation {
+    plcrash_async_breadcrumbs_t ring;
+    STAssertEquals(plcrash_nasync_breadcrumbs_init(&ring, NULL, 4, 64), PLCRASH_ESUCCESS, @"Failed to initialize ring");
+
+    [self appendTo: &ring message: @"complete"];
+    [self appendTo: &ring message: @"incomplete"];
+
+    /* Mark the second entry as in-progress */
+    plcrash_async_breadcrumb_entry_t *entry = (plcrash_async_breadcrumb_entry_t *) ((uint8_t *) (ring.header + 1) + ring.header->entry_size);
+    entry->sequence = 0;
+
+    STAssertEquals([self enumerate: &ring], PLCRASH_ESUCCESS, @"Failed to enumerate ring");
+    STAssertEqualObjects(_messages, [NSArray arrayWithObject: @"complete"], @"Incomplete entry was not skipped");
+
+    /* Truncated snapshot */
+    size_t length;
+    const void *snapshot = plcrash_async_breadcrumbs_snapshot(&ring, &length);
+    STAssertEquals(plcrash_async_breadcrumbs_enumerate(snapshot, length - 1, collect_breadcrumb, _messages), PLCRASH_EINVALID_DATA, @"Accepted a truncated ring");
+
+    /* Bad magic */
+    ring.header->magic = 0;
+    STAssertEquals([self enumerate: &ring], PLCRASH_EINVALID_DATA, @"Accepted an invalid ring");
+
+    plcrash_nasync_breadcrumbs_free(&ring);
+}
+
+/**
+ * Verify that a file-backed ring's contents are written to its file.
+ */
+- (void) testFileBacked {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    plcrash_async_breadcrumbs_t ring;
+    STAssertEquals(plcrash_nasync_breadcrumbs_init(&ring, [path fileSystemRepresentation], 4, 64), PLCRASH_ESUCCESS, @"Failed to initialize ring");
+
+    [self appendTo: &ring message: @"persisted"];
+    plcrash_nasync_breadcrumbs_free(&ring);
+
+    NSData *data = [NSData dataWithContentsOfFile: path];
+    STAssertNotNil(data, @"Breadcrumb file was not written");
+
+    [_messages removeAllObjects];
+    STAssertEquals(plcrash_async_breadcrumbs_enumerate([data bytes], [data length], collect_breadcrumb, _messages), PLCRASH_ESUCCESS, @"Failed to enumerate file");
+    STAssertEqualObjects(_messages, [NSArray arrayWithObject: @"persisted"], @"Incorrect breadcrumbs");
+
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+@end
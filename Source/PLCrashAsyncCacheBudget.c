@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncCacheBudget.h"
+
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_cache_budget Crash-Path Cache Budget
+ *
+ * Bounds the total memory retained by the caches consulted while writing a report, and tracks their use.
+ * @{
+ */
+
+/** The entry is unused. */
+#define PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_FREE 0
+
+/** The entry has been claimed, and is being initialized. */
+#define PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_CLAIMED 1
+
+/** The entry is registered. */
+#define PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_REGISTERED 2
+
+/**
+ * Initialize @a budget.
+ *
+ * @param budget The budget to initialize.
+ * @param limit The maximum total number of bytes that may be charged across all caches, or 0 if unlimited.
+ *
+ * @warning This function is not async-safe, and must be called prior to any cache registering with @a budget.
+ */
+void plcrash_async_cache_budget_init (plcrash_async_cache_budget_t *budget, size_t limit) {
+    plcrash_async_memset(budget, 0, sizeof(*budget));
+    budget->limit = limit;
+}
+
+/**
+ * Register a cache with @a budget.
+ *
+ * @param budget The budget with which the cache should be registered.
+ * @param name A descriptive, statically allocated name for the cache.
+ * @param max_bytes The maximum number of bytes that may be charged to this cache, or 0 if only the budget's overall
+ * limit applies.
+ * @param evictable If true, the cache may be asked to release its memory when another cache's charge would exceed the
+ * budget's limit, and must check for such requests via plcrash_async_cache_budget_record().
+ * @param id On success, will be set to the cache's handle. The cache must be unregistered via
+ * plcrash_async_cache_budget_unregister() when it is freed.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES caches are
+ * already registered.
+ */
+plcrash_error_t plcrash_async_cache_budget_register (plcrash_async_cache_budget_t *budget, const char *name, size_t max_bytes, bool evictable, plcrash_async_cache_id_t *id) {
+    for (int32_t i = 0; i < PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES; i++) {
+        plcrash_async_cache_budget_entry_t *entry = &budget->entries[i];
+        if (!OSAtomicCompareAndSwap32Barrier(PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_FREE, PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_CLAIMED, &entry->state))
+            continue;
+
+        entry->evict_requested = 0;
+        entry->name = name;
+        entry->max_bytes = max_bytes;
+        entry->evictable = evictable;
+        entry->bytes = 0;
+        entry->last_used = OSAtomicIncrement64Barrier(&budget->clock);
+        entry->hits = 0;
+        entry->misses = 0;
+        entry->evictions = 0;
+        entry->denials = 0;
+
+        /* Publish the fully initialized entry to plcrash_async_cache_budget_request_eviction() */
+        OSMemoryBarrier();
+        entry->state = PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_REGISTERED;
+
+        *id = i;
+        return PLCRASH_ESUCCESS;
+    }
+
+    PLCF_DEBUG("Could not register cache %s; all %d cache budget entries are in use", name, PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES);
+    return PLCRASH_ENOMEM;
+}
+
+/**
+ * Unregister a cache previously registered via plcrash_async_cache_budget_register(), releasing any bytes still
+ * charged to it.
+ *
+ * @param budget The budget with which the cache was registered.
+ * @param id The cache's handle. If PLCRASH_ASYNC_CACHE_ID_INVALID, this function does nothing.
+ */
+void plcrash_async_cache_budget_unregister (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id) {
+    if (id == PLCRASH_ASYNC_CACHE_ID_INVALID)
+        return;
+
+    plcrash_async_cache_budget_entry_t *entry = &budget->entries[id];
+    PLCF_ASSERT(entry->state == PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_REGISTERED);
+
+    plcrash_async_cache_budget_release(budget, id, (size_t) entry->bytes);
+
+    OSMemoryBarrier();
+    entry->state = PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_FREE;
+}
+
+/**
+ * @internal
+ *
+ * Ask the least recently used evictable cache, other than @a requester, to release its memory.
+ */
+static void plcrash_async_cache_budget_request_eviction (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t requester) {
+    plcrash_async_cache_budget_entry_t *victim = NULL;
+
+    for (int32_t i = 0; i < PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES; i++) {
+        plcrash_async_cache_budget_entry_t *entry = &budget->entries[i];
+        if (i == requester || entry->state != PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_REGISTERED)
+            continue;
+
+        if (!entry->evictable || entry->bytes == 0 || entry->evict_requested)
+            continue;
+
+        if (victim == NULL || entry->last_used < victim->last_used)
+            victim = entry;
+    }
+
+    if (victim != NULL)
+        OSAtomicCompareAndSwap32Barrier(0, 1, &victim->evict_requested);
+}
+
+/**
+ * Charge @a size bytes to the cache identified by @a id. If the charge would exceed the cache's cap or the budget's
+ * limit, it is refused; in the latter case, the least recently used evictable cache is asked to release its memory,
+ * and the charge may succeed if retried once it has done so.
+ *
+ * @param budget The budget to charge, or NULL, in which case the charge always succeeds.
+ * @param id The handle of the cache to which the bytes should be charged.
+ * @param size The number of bytes to charge.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the charge was accepted, or PLCRASH_ENOMEM if it was refused, in which case the
+ * cache must not retain the memory.
+ */
+plcrash_error_t plcrash_async_cache_budget_charge (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, size_t size) {
+    if (budget == NULL || id == PLCRASH_ASYNC_CACHE_ID_INVALID)
+        return PLCRASH_ESUCCESS;
+
+    plcrash_async_cache_budget_entry_t *entry = &budget->entries[id];
+
+    /* The cache's own cap */
+    if (entry->max_bytes != 0 && (size_t) entry->bytes + size > entry->max_bytes) {
+        OSAtomicIncrement64(&entry->denials);
+        return PLCRASH_ENOMEM;
+    }
+
+    /* The overall limit; the charge is applied optimistically, and backed out if the limit was exceeded */
+    int64_t used = OSAtomicAdd64Barrier((int64_t) size, &budget->used);
+    if (budget->limit != 0 && (size_t) used > budget->limit) {
+        OSAtomicAdd64Barrier(-(int64_t) size, &budget->used);
+        OSAtomicIncrement64(&entry->denials);
+
+        plcrash_async_cache_budget_request_eviction(budget, id);
+        return PLCRASH_ENOMEM;
+    }
+
+    OSAtomicAdd64Barrier((int64_t) size, &entry->bytes);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Release @a size bytes previously charged to the cache identified by @a id.
+ *
+ * @param budget The budget that was charged, or NULL.
+ * @param id The handle of the cache to which the bytes were charged.
+ * @param size The number of bytes to release.
+ */
+void plcrash_async_cache_budget_release (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, size_t size) {
+    if (budget == NULL || id == PLCRASH_ASYNC_CACHE_ID_INVALID || size == 0)
+        return;
+
+    OSAtomicAdd64Barrier(-(int64_t) size, &budget->entries[id].bytes);
+    OSAtomicAdd64Barrier(-(int64_t) size, &budget->used);
+}
+
+/**
+ * Record a lookup in the cache identified by @a id, marking the cache as most recently used.
+ *
+ * @param budget The budget with which the cache is registered, or NULL.
+ * @param id The handle of the cache.
+ * @param hit True if the lookup was satisfied by the cache.
+ *
+ * @return Returns true if the cache has been asked to release its memory, in which case it should release as much as
+ * it is able to -- via plcrash_async_cache_budget_release() -- before proceeding. The request is cleared.
+ */
+bool plcrash_async_cache_budget_record (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, bool hit) {
+    if (budget == NULL || id == PLCRASH_ASYNC_CACHE_ID_INVALID)
+        return false;
+
+    plcrash_async_cache_budget_entry_t *entry = &budget->entries[id];
+
+    OSAtomicIncrement64(hit ? &entry->hits : &entry->misses);
+    entry->last_used = OSAtomicIncrement64(&budget->clock);
+
+    if (entry->evict_requested && OSAtomicCompareAndSwap32Barrier(1, 0, &entry->evict_requested)) {
+        OSAtomicIncrement64(&entry->evictions);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Fetch the statistics of the cache identified by @a id.
+ *
+ * @param budget The budget with which the cache is registered.
+ * @param id The handle of the cache.
+ * @param stats On return, will be populated with the cache's statistics.
+ */
+void plcrash_async_cache_budget_stats (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, plcrash_async_cache_budget_stats_t *stats) {
+    plcrash_async_cache_budget_entry_t *entry = &budget->entries[id];
+
+    stats->bytes = (size_t) entry->bytes;
+    stats->hits = (uint64_t) entry->hits;
+    stats->misses = (uint64_t) entry->misses;
+    stats->evictions = (uint64_t) entry->evictions;
+    stats->denials = (uint64_t) entry->denials;
+}
+
+/**
+ * Return the total number of bytes currently charged across all caches registered with @a budget.
+ */
+size_t plcrash_async_cache_budget_used (plcrash_async_cache_budget_t *budget) {
+    return (size_t) budget->used;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_CACHE_BUDGET_H
+#define PLCRASH_ASYNC_CACHE_BUDGET_H
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @{
+ */
+
+/** The maximum number of caches that may be registered with a single plcrash_async_cache_budget_t. */
+#define PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES 32
+
+/** A cache handle, as returned by plcrash_async_cache_budget_register(). */
+typedef int32_t plcrash_async_cache_id_t;
+
+/** An invalid plcrash_async_cache_id_t value. */
+#define PLCRASH_ASYNC_CACHE_ID_INVALID ((plcrash_async_cache_id_t) -1)
+
+/**
+ * @internal
+ *
+ * Usage statistics for a single registered cache.
+ */
+typedef struct plcrash_async_cache_budget_stats {
+    /** The number of bytes currently charged to the cache. */
+    size_t bytes;
+
+    /** The number of lookups satisfied by the cache. */
+    uint64_t hits;
+
+    /** The number of lookups not satisfied by the cache. */
+    uint64_t misses;
+
+    /** The number of times the cache has released its memory at the request of the budget. */
+    uint64_t evictions;
+
+    /** The number of charges refused, either by the cache's own cap or by the budget's limit. */
+    uint64_t denials;
+} plcrash_async_cache_budget_stats_t;
+
+/**
+ * @internal
+ *
+ * A single cache registration. All fields are managed by the budget.
+ */
+typedef struct plcrash_async_cache_budget_entry {
+    /** The registration state; one of the PLCRASH_ASYNC_CACHE_BUDGET_ENTRY_* values defined in the implementation. */
+    volatile int32_t state;
+
+    /** If non-zero, the cache has been asked to release its memory. See plcrash_async_cache_budget_record(). */
+    volatile int32_t evict_requested;
+
+    /** A descriptive, statically allocated cache name. */
+    const char *name;
+
+    /** The maximum number of bytes that may be charged to this cache, or 0 if only the budget's limit applies. */
+    size_t max_bytes;
+
+    /** If true, the cache may be asked to release its memory when another cache's charge would exceed the limit. */
+    bool evictable;
+
+    /** The number of bytes currently charged to the cache. */
+    volatile int64_t bytes;
+
+    /** The value of the budget's use clock at the time of the cache's most recent lookup. */
+    volatile int64_t last_used;
+
+    /** Lookup and charge statistics; see plcrash_async_cache_budget_stats_t. */
+    volatile int64_t hits;
+    volatile int64_t misses;
+    volatile int64_t evictions;
+    volatile int64_t denials;
+} plcrash_async_cache_budget_entry_t;
+
+/**
+ * @internal
+ *
+ * A shared memory budget for the caches consulted while writing a report.
+ *
+ * Each cache registers with the budget, and charges the budget for any memory it retains. A charge that would exceed
+ * the cache's own cap, or the budget's overall limit, is refused; the cache must proceed without retaining the memory,
+ * as it would on an allocation failure. When the overall limit is reached, the least recently used evictable cache is
+ * asked to release its memory. As caches may be owned by other threads (such as the writer's unwind workers), the
+ * request is not serviced directly; the cache releases its memory the next time it records a lookup via
+ * plcrash_async_cache_budget_record(), after which the refused charge may be retried.
+ *
+ * A zero-filled budget is valid, and imposes no limit.
+ *
+ * All functions, other than plcrash_async_cache_budget_init(), are async-safe, and may be called concurrently.
+ */
+typedef struct plcrash_async_cache_budget {
+    /** The maximum total number of bytes that may be charged across all caches, or 0 if unlimited. */
+    size_t limit;
+
+    /** The total number of bytes currently charged across all caches. */
+    volatile int64_t used;
+
+    /** Monotonically increasing use clock, used to find the least recently used cache. */
+    volatile int64_t clock;
+
+    /** Cache registrations. */
+    plcrash_async_cache_budget_entry_t entries[PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES];
+} plcrash_async_cache_budget_t;
+
+void plcrash_async_cache_budget_init (plcrash_async_cache_budget_t *budget, size_t limit);
+
+plcrash_error_t plcrash_async_cache_budget_register (plcrash_async_cache_budget_t *budget, const char *name, size_t max_bytes, bool evictable, plcrash_async_cache_id_t *id);
+void plcrash_async_cache_budget_unregister (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id);
+
+plcrash_error_t plcrash_async_cache_budget_charge (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, size_t size);
+void plcrash_async_cache_budget_release (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, size_t size);
+bool plcrash_async_cache_budget_record (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, bool hit);
+
+void plcrash_async_cache_budget_stats (plcrash_async_cache_budget_t *budget, plcrash_async_cache_id_t id, plcrash_async_cache_budget_stats_t *stats);
+size_t plcrash_async_cache_budget_used (plcrash_async_cache_budget_t *budget);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_CACHE_BUDGET_H */
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncCacheBudget.h"
+
+@interface PLCrashAsyncCacheBudgetTests : SenTestCase {
+    /** The budget under test. */
+    plcrash_async_cache_budget_t _budget;
+}
+@end
+
+@implementation PLCrashAsyncCacheBudgetTests
+
+- (void) setUp {
+    plcrash_async_cache_budget_init(&_budget, 1000);
+}
+
+- (void) testChargeAndRelease {
+    plcrash_async_cache_id_t a, b;
+    plcrash_async_cache_budget_stats_t stats;
+
+    STAssertEquals(plcrash_async_cache_budget_register(&_budget, "a", 600, true, &a), PLCRASH_ESUCCESS, @"Failed to register cache");
+    STAssertEquals(plcrash_async_cache_budget_register(&_budget, "b", 0, false, &b), PLCRASH_ESUCCESS, @"Failed to register cache");
+
+    /* The per-cache cap */
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, a, 500), PLCRASH_ESUCCESS, @"Charge within the cap should succeed");
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, a, 200), PLCRASH_ENOMEM, @"Charge beyond the cap should fail");
+
+    /* The overall limit */
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, b, 500), PLCRASH_ESUCCESS, @"Charge within the limit should succeed");
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, b, 1), PLCRASH_ENOMEM, @"Charge beyond the limit should fail");
+    STAssertEquals(plcrash_async_cache_budget_used(&_budget), (size_t) 1000, @"Refused charges must not be retained");
+
+    plcrash_async_cache_budget_release(&_budget, b, 100);
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, b, 100), PLCRASH_ESUCCESS, @"Charge of released bytes should succeed");
+
+    plcrash_async_cache_budget_stats(&_budget, b, &stats);
+    STAssertEquals(stats.bytes, (size_t) 500, @"Incorrect byte count");
+    STAssertEquals(stats.denials, (uint64_t) 1, @"Incorrect denial count");
+
+    /* Unregistering releases any outstanding charge */
+    plcrash_async_cache_budget_unregister(&_budget, a);
+    STAssertEquals(plcrash_async_cache_budget_used(&_budget), (size_t) 500, @"Unregistration should release the cache's bytes");
+    plcrash_async_cache_budget_unregister(&_budget, b);
+    STAssertEquals(plcrash_async_cache_budget_used(&_budget), (size_t) 0, @"Unregistration should release the cache's bytes");
+}
+
+- (void) testEvictionRequest {
+    plcrash_async_cache_id_t older, newer, pinned, requester;
+    plcrash_async_cache_budget_stats_t stats;
+
+    plcrash_async_cache_budget_register(&_budget, "older", 0, true, &older);
+    plcrash_async_cache_budget_register(&_budget, "newer", 0, true, &newer);
+    plcrash_async_cache_budget_register(&_budget, "pinned", 0, false, &pinned);
+    plcrash_async_cache_budget_register(&_budget, "requester", 0, true, &requester);
+
+    plcrash_async_cache_budget_charge(&_budget, older, 300);
+    plcrash_async_cache_budget_charge(&_budget, newer, 300);
+    plcrash_async_cache_budget_charge(&_budget, pinned, 300);
+
+    /* Order the caches by use; the non-evictable cache is least recently used, but must never be selected */
+    plcrash_async_cache_budget_record(&_budget, pinned, true);
+    plcrash_async_cache_budget_record(&_budget, older, true);
+    plcrash_async_cache_budget_record(&_budget, newer, false);
+
+    /* A refused charge requests eviction of the least recently used evictable cache */
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, requester, 200), PLCRASH_ENOMEM, @"Charge beyond the limit should fail");
+    STAssertFalse(plcrash_async_cache_budget_record(&_budget, newer, true), @"The more recently used cache should not be asked to evict");
+    STAssertTrue(plcrash_async_cache_budget_record(&_budget, older, false), @"The least recently used cache should be asked to evict");
+    STAssertFalse(plcrash_async_cache_budget_record(&_budget, older, false), @"The eviction request should be cleared once observed");
+
+    /* Once the evicted cache releases its memory, the charge succeeds */
+    plcrash_async_cache_budget_release(&_budget, older, 300);
+    STAssertEquals(plcrash_async_cache_budget_charge(&_budget, requester, 200), PLCRASH_ESUCCESS, @"Charge should succeed after eviction");
+
+    plcrash_async_cache_budget_stats(&_budget, older, &stats);
+    STAssertEquals(stats.hits, (uint64_t) 1, @"Incorrect hit count");
+    STAssertEquals(stats.misses, (uint64_t) 2, @"Incorrect miss count");
+    STAssertEquals(stats.evictions, (uint64_t) 1, @"Incorrect eviction count");
+    STAssertEquals(stats.bytes, (size_t) 0, @"Incorrect byte count");
+}
+
+- (void) testUnlimited {
+    plcrash_async_cache_budget_t budget;
+    plcrash_async_cache_id_t id;
+
+    /* A zero-filled budget imposes no limit */
+    memset(&budget, 0, sizeof(budget));
+    STAssertEquals(plcrash_async_cache_budget_register(&budget, "unlimited", 0, true, &id), PLCRASH_ESUCCESS, @"Failed to register cache");
+    STAssertEquals(plcrash_async_cache_budget_charge(&budget, id, SIZE_MAX / 4), PLCRASH_ESUCCESS, @"Charge should succeed");
+    STAssertEquals(plcrash_async_cache_budget_used(&budget), (size_t) (SIZE_MAX / 4), @"Incorrect usage");
+    plcrash_async_cache_budget_unregister(&budget, id);
+}
+
+- (void) testRegistrationLimit {
+    plcrash_async_cache_id_t id;
+
+    for (int i = 0; i < PLCRASH_ASYNC_CACHE_BUDGET_MAX_CACHES; i++)
+        STAssertEquals(plcrash_async_cache_budget_register(&_budget, "cache", 0, true, &id), PLCRASH_ESUCCESS, @"Failed to register cache");
+
+    STAssertEquals(plcrash_async_cache_budget_register(&_budget, "cache", 0, true, &id), PLCRASH_ENOMEM, @"Registration beyond the maximum should fail");
+
+    /* Released slots are reused */
+    plcrash_async_cache_budget_unregister(&_budget, 3);
+    STAssertEquals(plcrash_async_cache_budget_register(&_budget, "cache", 0, true, &id), PLCRASH_ESUCCESS, @"Failed to register cache");
+    STAssertEquals(id, (plcrash_async_cache_id_t) 3, @"The released slot should be reused");
+}
+
+@end
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncChecksum.h"
+
+#include <string.h>
+#include <sys/sysctl.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <nmmintrin.h>
+#define PLCRASH_CRC32C_X86 1
+#elif defined(__arm64__) || defined(__aarch64__)
+#include <arm_acle.h>
+#define PLCRASH_CRC32C_ARM64 1
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_checksum Checksums
+ *
+ * Implements the CRC-32C (Castagnoli) checksum used to validate written reports and report containers. Where
+ * available, the ARMv8 CRC32 or SSE4.2 CRC32 instructions are used; otherwise, a table-driven implementation is used.
+ * All implementations produce identical results.
+ * @{
+ */
+
+/** The reflected CRC-32C lookup table, used when no hardware implementation is available. */
+static const uint32_t crc32c_table[256] = {
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+    0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+    0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+    0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+    0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+    0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+    0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+    0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+    0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+    0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+    0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+    0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+    0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+    0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+    0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+    0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+    0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+    0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+    0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+    0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+    0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+    0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+    0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+    0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+    0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+    0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+    0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+    0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+    0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+    0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+    0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+    0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+    0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+
+/**
+ * @internal
+ *
+ * Table-driven CRC-32C update of the pre-inverted @a crc.
+ */
+static uint32_t crc32c_software (uint32_t crc, const uint8_t *p, size_t len) {
+    while (len > 0) {
+        crc = crc32c_table[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+        p++;
+        len--;
+    }
+
+    return crc;
+}
+
+#if PLCRASH_CRC32C_X86
+
+/**
+ * @internal
+ *
+ * SSE4.2 CRC-32C update of the pre-inverted @a crc.
+ */
+__attribute__((target("sse4.2"))) static uint32_t crc32c_hardware (uint32_t crc, const uint8_t *p, size_t len) {
+    /* Align the input, so that the bulk of the data may be consumed in word-sized loads */
+    while (len > 0 && ((uintptr_t) p & (sizeof(uintptr_t) - 1)) != 0) {
+        crc = _mm_crc32_u8(crc, *p);
+        p++;
+        len--;
+    }
+
+#ifdef __x86_64__
+    while (len >= 8) {
+        crc = (uint32_t) _mm_crc32_u64(crc, *(const uint64_t *) p);
+        p += 8;
+        len -= 8;
+    }
+#else
+    while (len >= 4) {
+        crc = _mm_crc32_u32(crc, *(const uint32_t *) p);
+        p += 4;
+        len -= 4;
+    }
+#endif
+
+    while (len > 0) {
+        crc = _mm_crc32_u8(crc, *p);
+        p++;
+        len--;
+    }
+
+    return crc;
+}
+
+/**
+ * @internal
+ *
+ * Return true if the SSE4.2 CRC32 instruction is supported. This is async-safe.
+ */
+static bool crc32c_detect_hardware (void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    return (ecx & bit_SSE4_2) != 0;
+}
+
+#elif PLCRASH_CRC32C_ARM64
+
+/**
+ * @internal
+ *
+ * ARMv8 CRC-32C update of the pre-inverted @a crc.
+ */
+__attribute__((target("crc"))) static uint32_t crc32c_hardware (uint32_t crc, const uint8_t *p, size_t len) {
+    /* Align the input, so that the bulk of the data may be consumed in 8-byte loads */
+    while (len > 0 && ((uintptr_t) p & 7) != 0) {
+        crc = __crc32cb(crc, *p);
+        p++;
+        len--;
+    }
+
+    while (len >= 8) {
+        crc = __crc32cd(crc, *(const uint64_t *) p);
+        p += 8;
+        len -= 8;
+    }
+
+    while (len > 0) {
+        crc = __crc32cb(crc, *p);
+        p++;
+        len--;
+    }
+
+    return crc;
+}
+
+/**
+ * @internal
+ *
+ * Return true if the ARMv8 CRC32 instructions are supported. The CRC32 extension is optional prior to ARMv8.1, and
+ * is absent on the earliest arm64 devices.
+ */
+static bool crc32c_detect_hardware (void) {
+#ifdef __ARM_FEATURE_CRC32
+    return true;
+#else
+    int value = 0;
+    size_t size = sizeof(value);
+    if (sysctlbyname("hw.optional.armv8_crc32", &value, &size, NULL, 0) != 0)
+        return false;
+
+    return value != 0;
+#endif
+}
+
+#endif /* PLCRASH_CRC32C_ARM64 */
+
+/**
+ * @internal
+ *
+ * The cached result of crc32c_detect_hardware(); 0 if not yet determined, 1 if supported, and -1 if unsupported.
+ * Detection may race; all racing threads will store the same result.
+ */
+static volatile int crc32c_hardware_state = 0;
+
+/**
+ * Return true if CRC-32C checksums are computed using hardware CRC instructions. This function is async-safe.
+ */
+bool plcrash_async_crc32c_accelerated (void) {
+#if PLCRASH_CRC32C_X86 || PLCRASH_CRC32C_ARM64
+    int state = crc32c_hardware_state;
+    if (state == 0) {
+        state = crc32c_detect_hardware() ? 1 : -1;
+        crc32c_hardware_state = state;
+    }
+
+    return state > 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Update the CRC-32C checksum @a crc with @a len bytes of @a data. The checksum of a sequence of buffers may be
+ * computed incrementally, by passing the result of each call as the @a crc of the next; the initial value is 0.
+ *
+ * This function is async-safe.
+ *
+ * @param crc The checksum of all preceding data, or 0.
+ * @param data The data to be checksummed.
+ * @param len The length of @a data, in bytes.
+ *
+ * @return Returns the updated checksum.
+ */
+uint32_t plcrash_async_crc32c (uint32_t crc, const void *data, size_t len) {
+    crc = ~crc;
+
+#if PLCRASH_CRC32C_X86 || PLCRASH_CRC32C_ARM64
+    if (plcrash_async_crc32c_accelerated())
+        return ~crc32c_hardware(crc, data, len);
+#endif
+
+    return ~crc32c_software(crc, data, len);
+}
+
+/**
+ * Verify the checksum trailer, if any, terminating @a length bytes of @a data. This requires a single pass over the
+ * data, and may be used to reject a corrupt file prior to decoding it. This function is async-safe.
+ *
+ * @param data The file data, including any trailer.
+ * @param length The length of @a data, in bytes.
+ * @param[out] content_length On return, the length of the data covered by the trailer, or @a length if @a data has no
+ * trailer.
+ *
+ * @return Returns PLCRASH_ESUCCESS if @a data ends with a valid trailer, PLCRASH_ENOTFOUND if @a data has no trailer,
+ * or PLCRASH_EINVALID_DATA if the trailer does not match the data it covers.
+ */
+plcrash_error_t plcrash_async_checksum_trailer_verify (const void *data, size_t length, size_t *content_length) {
+    *content_length = length;
+
+    if (length < sizeof(plcrash_async_checksum_trailer_t))
+        return PLCRASH_ENOTFOUND;
+
+    /* The trailer may not be aligned */
+    plcrash_async_checksum_trailer_t trailer;
+    size_t covered = length - sizeof(trailer);
+    plcrash_async_memcpy(&trailer, (const uint8_t *) data + covered, sizeof(trailer));
+
+    if (memcmp(trailer.magic, PLCRASH_ASYNC_CHECKSUM_TRAILER_MAGIC, sizeof(trailer.magic)) != 0)
+        return PLCRASH_ENOTFOUND;
+
+    if (trailer.length != covered || plcrash_async_crc32c(0, data, covered) != trailer.crc32c)
+        return PLCRASH_EINVALID_DATA;
+
+    *content_length = covered;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_ASYNC_CHECKSUM_H
+#define PLCRASH_ASYNC_CHECKSUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_checksum
+ * @{
+ */
+
+/** The magic identifier terminating a checksum trailer, not NUL terminated. */
+#define PLCRASH_ASYNC_CHECKSUM_TRAILER_MAGIC "plcrc32c"
+
+/**
+ * @internal
+ *
+ * A checksum trailer, appended to the end of a file by plcrash_async_file_close() if checksumming was enabled via
+ * plcrash_async_file_set_checksum(). The trailer covers all data preceding it. All values are in host byte order.
+ */
+typedef struct plcrash_async_checksum_trailer {
+    /** The number of bytes preceding the trailer. */
+    uint64_t length;
+
+    /** The CRC-32C of the bytes preceding the trailer. */
+    uint32_t crc32c;
+
+    /** Reserved; must be 0. */
+    uint32_t reserved;
+
+    /** Trailer magic identifier (#PLCRASH_ASYNC_CHECKSUM_TRAILER_MAGIC), not NUL terminated. */
+    char magic[8];
+} plcrash_async_checksum_trailer_t;
+
+uint32_t plcrash_async_crc32c (uint32_t crc, const void *data, size_t len);
+bool plcrash_async_crc32c_accelerated (void);
+
+plcrash_error_t plcrash_async_checksum_trailer_verify (const void *data, size_t length, size_t *content_length);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_CHECKSUM_H */
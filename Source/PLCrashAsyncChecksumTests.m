@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncChecksum.h"
+
+#import <fcntl.h>
+
+@interface PLCrashAsyncChecksumTests : SenTestCase {
+@private
+}
+@end
+
+@implementation PLCrashAsyncChecksumTests
+
+/**
+ * Verify the CRC-32C of the standard check input, with both aligned and unaligned data.
+ */
+- (void) testCheckValue {
+    const char *check = "123456789";
+    STAssertEquals(plcrash_async_crc32c(0, check, strlen(check)), (uint32_t) 0xE3069283, @"Incorrect CRC-32C");
+    STAssertEquals(plcrash_async_crc32c(0, check, 0), (uint32_t) 0, @"Incorrect CRC-32C of empty input");
+
+    char unaligned[16];
+    memcpy(unaligned + 3, check, strlen(check));
+    STAssertEquals(plcrash_async_crc32c(0, unaligned + 3, strlen(check)), (uint32_t) 0xE3069283, @"Incorrect CRC-32C of unaligned input");
+}
+
+/**
+ * Verify that a checksum computed incrementally matches one computed in a single call.
+ */
+- (void) testStreaming {
+    uint8_t data[4099];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t) (i * 31 + 7);
+
+    uint32_t expected = plcrash_async_crc32c(0, data, sizeof(data));
+    uint32_t crc = 0;
+    for (size_t offset = 0; offset < sizeof(data); ) {
+        size_t len = MIN((size_t) 13 + offset % 97, sizeof(data) - offset);
+        crc = plcrash_async_crc32c(crc, data + offset, len);
+        offset += len;
+    }
+
+    STAssertEquals(crc, expected, @"Incremental CRC-32C does not match the one-shot CRC-32C");
+}
+
+/**
+ * Verify that a checksummed file is terminated by a valid trailer, and that corruption is detected.
+ */
+- (void) testFileTrailer {
+    uint8_t buffer[256];
+    uint8_t content[100];
+    plcrash_async_file_t file;
+    size_t length;
+
+    for (size_t i = 0; i < sizeof(content); i++)
+        content[i] = (uint8_t) i;
+
+    plcrash_async_file_init_memory(&file, buffer, sizeof(buffer));
+    plcrash_async_file_set_checksum(&file);
+    STAssertTrue(plcrash_async_file_seekable(&file), @"Checksummed memory output should remain seekable");
+
+    STAssertTrue(plcrash_async_file_write(&file, content, 60), @"Write failed");
+    STAssertTrue(plcrash_async_file_write(&file, content + 60, sizeof(content) - 60), @"Write failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"Close failed");
+
+    size_t total = (size_t) plcrash_async_file_position(&file);
+    STAssertEquals(total, sizeof(content) + sizeof(plcrash_async_checksum_trailer_t), @"Incorrect file length");
+
+    /* Verify the trailer */
+    STAssertEquals(plcrash_async_checksum_trailer_verify(buffer, total, &length), PLCRASH_ESUCCESS, @"Trailer verification failed");
+    STAssertEquals(length, sizeof(content), @"Incorrect content length");
+    STAssertTrue(memcmp(buffer, content, sizeof(content)) == 0, @"Incorrect content");
+
+    /* Data without a trailer is reported as such */
+    STAssertEquals(plcrash_async_checksum_trailer_verify(content, sizeof(content), &length), PLCRASH_ENOTFOUND, @"Found a trailer in unchecksummed data");
+    STAssertEquals(length, sizeof(content), @"Incorrect content length");
+
+    /* Corrupted content is rejected */
+    buffer[42] ^= 0x10;
+    STAssertEquals(plcrash_async_checksum_trailer_verify(buffer, total, &length), PLCRASH_EINVALID_DATA, @"Corruption was not detected");
+}
+
+/**
+ * Verify that backpatched output is checksummed as finally written, for both mapped and descriptor-backed files.
+ */
+- (void) testBackpatchedTrailer {
+    uint8_t buffer[256];
+    uint8_t content[100];
+    uint8_t patch[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+    plcrash_async_file_t file;
+    size_t length;
+
+    for (size_t i = 0; i < sizeof(content); i++)
+        content[i] = (uint8_t) i;
+
+    /* Memory output */
+    plcrash_async_file_init_memory(&file, buffer, sizeof(buffer));
+    plcrash_async_file_set_checksum(&file);
+    STAssertTrue(plcrash_async_file_write(&file, content, sizeof(content)), @"Write failed");
+    STAssertTrue(plcrash_async_file_pwrite(&file, 10, patch, sizeof(patch)), @"Backpatch failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"Close failed");
+
+    memcpy(content + 10, patch, sizeof(patch));
+    size_t total = (size_t) plcrash_async_file_position(&file);
+    STAssertEquals(plcrash_async_checksum_trailer_verify(buffer, total, &length), PLCRASH_ESUCCESS, @"Trailer verification failed");
+    STAssertTrue(memcmp(buffer, content, sizeof(content)) == 0, @"Incorrect content");
+
+    /* Descriptor output, patching a range that has already been flushed from a small write buffer */
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    int fd = open([path fileSystemRepresentation], O_RDWR|O_CREAT|O_TRUNC, 0644);
+    STAssertTrue(fd >= 0, @"Failed to open the test file");
+
+    uint8_t wbuf[16];
+    plcrash_async_file_init_buffer(&file, fd, 0, wbuf, sizeof(wbuf));
+    plcrash_async_file_set_checksum(&file);
+    STAssertTrue(plcrash_async_file_seekable(&file), @"Checksummed read-write file should remain seekable");
+    STAssertTrue(plcrash_async_file_write(&file, content, sizeof(content)), @"Write failed");
+    STAssertTrue(plcrash_async_file_pwrite(&file, 0, patch, sizeof(patch)), @"Backpatch failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"Close failed");
+
+    memcpy(content, patch, sizeof(patch));
+    NSData *written = [NSData dataWithContentsOfFile: path];
+    STAssertEquals(plcrash_async_checksum_trailer_verify([written bytes], [written length], &length), PLCRASH_ESUCCESS, @"Trailer verification failed");
+    STAssertTrue(length == sizeof(content) && memcmp([written bytes], content, sizeof(content)) == 0, @"Incorrect content");
+
+    /* A write-only descriptor can't be read back, and must not be backpatched */
+    fd = open([path fileSystemRepresentation], O_WRONLY|O_TRUNC);
+    STAssertTrue(fd >= 0, @"Failed to open the test file");
+    plcrash_async_file_init(&file, fd, 0);
+    plcrash_async_file_set_checksum(&file);
+    STAssertFalse(plcrash_async_file_seekable(&file), @"Write-only checksummed files must not be seekable");
+    STAssertTrue(plcrash_async_file_close(&file), @"Close failed");
+
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+@end
@@ -97,51 +97,134 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
     return PLCRASH_ESUCCESS;
 }
 
+/** The number of remaining entries below which the CFE table search switches from a binary search to a linear scan. */
+#define CFE_SEARCH_LINEAR_COUNT 32
+
+#ifdef __clang__
+/** @internal A vector of four 32-bit CFE function offsets. */
+typedef uint32_t pl_cfe_u32x4 __attribute__((ext_vector_type(4)));
+
+/** @internal A vector of four 32-bit comparison mask lanes. */
+typedef int32_t pl_cfe_i32x4 __attribute__((ext_vector_type(4)));
+#endif
+
 /**
  * @internal
  *
- * Binary search in macro form. Pass the table, count, and result
- * pointers.
+ * Fetch the function offset of the CFE table entry at @a index. See plcrash_async_cfe_search().
+ */
+static inline __attribute__((always_inline)) uint32_t plcrash_async_cfe_search_key (const uint8_t *table, size_t stride, uint32_t index, uint32_t mask, bool swap) {
+    uint32_t value = *(const uint32_t *) (table + (stride * index));
+    if (swap)
+        value = __builtin_bswap32(value);
+
+    return value & mask;
+}
+
+/**
+ * @internal
+ *
+ * Search an ascending table of CFE entries for the last entry with a function offset at or below @a target. The search
+ * is performed as a binary search until at most CFE_SEARCH_LINEAR_COUNT candidate entries remain, and the remaining
+ * entries are then compared four at a time.
+ *
+ * This is always inlined into plcrash_async_cfe_search(), allowing the compiler to produce distinct native and
+ * byte-swapped variants.
+ *
+ * @param table The table to search. The function offset must be the first 32-bit word of each entry.
+ * @param count The number of entries in @a table.
+ * @param stride The size of each entry, in bytes.
+ * @param mask The mask to be applied to each entry's first word to produce its function offset.
+ * @param target The function offset to search for.
+ * @param swap If true, the table's entries will be byte-swapped.
  *
- * CFE_FUN_BINARY_SEARCH_ENTVAL must also be defined, and it must
- * return the integer value to be compared.
+ * @return Returns the number of entries with a function offset at or below @a target.
  */
-#define CFE_FUN_BINARY_SEARCH(_pc, _table, _count, _result) do { \
-    uint32_t min = 0; \
-    uint32_t mid = 0; \
-    uint32_t max = _count - 1; \
-\
-    /* Search while _table[min:max] is not empty */ \
-    while (max >= min) { \
-        /* Calculate midpoint */ \
-        mid = (min + max) / 2; \
-\
-        /* Determine which half of the array to search */ \
-        uint32_t mid_fun_offset = CFE_FUN_BINARY_SEARCH_ENTVAL(_table[mid]); \
-        if (mid_fun_offset < _pc) { \
-            /* Check for inclusive equality */ \
-            if (mid == max || CFE_FUN_BINARY_SEARCH_ENTVAL(_table[mid+1]) > _pc) { \
-                _result = &_table[mid]; \
-                break; \
-            } \
-\
-            /* Base our search on the upper array */ \
-            min = mid + 1; \
-        } else if (mid_fun_offset > _pc) { \
-            /* Check for range exclusion; if we hit 0, then the range starts after our PC. */ \
-            if (mid == 0) { \
-                break; \
-            } \
-            \
-            /* Base our search on the lower array */ \
-            max = mid - 1; \
-        } else if (mid_fun_offset == _pc) { \
-            /* Direct match found */ \
-            _result = &_table[mid]; \
-            break; \
-        } \
-    } \
-} while (0)
+static inline __attribute__((always_inline)) uint32_t plcrash_async_cfe_search_table (const uint8_t *table, uint32_t count, size_t stride,
+                                                                                      uint32_t mask, uint32_t target, bool swap)
+{
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    /* Narrow the range; all entries below low are at or below the target, and all entries at or above high are above it */
+    while (high - low > CFE_SEARCH_LINEAR_COUNT) {
+        uint32_t mid = low + (high - low) / 2;
+        if (plcrash_async_cfe_search_key(table, stride, mid, mask, swap) <= target)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    /* As the table is sorted, the number of remaining entries at or below the target locates the boundary */
+    uint32_t matched = 0;
+    uint32_t i = low;
+
+#ifdef __clang__
+    const pl_cfe_u32x4 target_vec = (pl_cfe_u32x4) target;
+    pl_cfe_i32x4 matched_vec = (pl_cfe_i32x4) 0;
+
+    for (; i + 4 <= high; i += 4) {
+        pl_cfe_u32x4 keys = {
+            plcrash_async_cfe_search_key(table, stride, i + 0, mask, swap),
+            plcrash_async_cfe_search_key(table, stride, i + 1, mask, swap),
+            plcrash_async_cfe_search_key(table, stride, i + 2, mask, swap),
+            plcrash_async_cfe_search_key(table, stride, i + 3, mask, swap)
+        };
+
+        /* Matching lanes are -1 */
+        matched_vec -= (keys <= target_vec);
+    }
+
+    matched = (uint32_t) (matched_vec.x + matched_vec.y + matched_vec.z + matched_vec.w);
+#endif
+
+    for (; i < high; i++) {
+        if (plcrash_async_cfe_search_key(table, stride, i, mask, swap) <= target)
+            matched++;
+    }
+
+    return low + matched;
+}
+
+/**
+ * @internal
+ *
+ * Search an ascending table of CFE entries for the entry covering @a pc; this is the last entry with a function
+ * offset at or below @a pc.
+ *
+ * @param byteorder The byte order of @a table.
+ * @param table The table to search. The function offset must be the first 32-bit word of each entry.
+ * @param count The number of entries in @a table.
+ * @param stride The size of each entry, in bytes.
+ * @param mask The mask to be applied to each entry's first word to produce its function offset.
+ * @param base The base to which each entry's function offset is relative.
+ * @param pc The PC to search for, relative to the image's __TEXT vmaddr.
+ * @param index On success, will be set to the index of the matching entry.
+ *
+ * @return Returns true if a matching entry was found, or false if @a table is empty, or all entries begin after @a pc.
+ */
+static bool plcrash_async_cfe_search (const plcrash_async_byteorder_t *byteorder, const void *table, uint32_t count, size_t stride,
+                                      uint32_t mask, uint32_t base, pl_vm_address_t pc, uint32_t *index)
+{
+    if (pc < base)
+        return false;
+
+    /* Offsets are 32-bit; a PC beyond that range follows all entries */
+    uint32_t target = (pc - base > UINT32_MAX) ? UINT32_MAX : (uint32_t) (pc - base);
+
+    /* Produce a specialized search for the (common) host byte order case */
+    uint32_t matched;
+    if (byteorder == &plcrash_async_byteorder_direct)
+        matched = plcrash_async_cfe_search_table(table, count, stride, mask, target, false);
+    else
+        matched = plcrash_async_cfe_search_table(table, count, stride, mask, target, true);
+
+    if (matched == 0)
+        return false;
+
+    *index = matched - 1;
+    return true;
+}
 
 /* Evaluates to true if the length of @a _ecount * @a sizof(_etype) can not be represented
  * by size_t. */
@@ -161,6 +244,28 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
  * the entry can not be found, PLFRAME_ENOTFOUND will be returned.
  */
 plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding) {
+    pl_vm_address_t function_end;
+    return plcrash_async_cfe_reader_find_pc_range(reader, pc, function_base, &function_end, encoding);
+}
+
+/**
+ * Return the compact frame encoding entry for @a pc via @a encoding, along with the range of PC values to which the
+ * entry applies.
+ *
+ * @param reader The initialized CFE reader which will be searched for the entry.
+ * @param pc The PC value to search for within the CFE data. Note that this value must be relative to
+ * the target Mach-O image's __TEXT vmaddr.
+ * @param function_base On success, will be populated with the base address of the function. This value is relative to
+ * the image's load address, rather than the in-memory address of the loaded image.
+ * @param function_end On success, will be populated with the (exclusive) end of the PC range to which @a encoding
+ * applies, relative to the image's load address. If the end of the range can not be determined, a conservative
+ * value of @a pc + 1 is returned.
+ * @param encoding On success, will be populated with the compact frame encoding entry.
+ *
+ * @return Returns PLFRAME_ESUCCCESS on success, or one of the remaining error codes if a CFE parsing error occurs. If
+ * the entry can not be found, PLFRAME_ENOTFOUND will be returned.
+ */
+plcrash_error_t plcrash_async_cfe_reader_find_pc_range (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, pl_vm_address_t *function_end, uint32_t *encoding) {
     const plcrash_async_byteorder_t *byteorder = reader->byteorder;
     const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(reader->mobj);
 
@@ -184,6 +289,7 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
 
     /* Find and load the first level entry */
     struct unwind_info_section_header_index_entry *first_level_entry = NULL;
+    pl_vm_address_t page_end = pc + 1;
     {
         /* Find and map the index */
         uint32_t index_off = byteorder->swap32(reader->header.indexSectionOffset);
@@ -217,15 +323,26 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
             return PLCRASH_EINVAL;
         }
         
-        /* Binary search for the first-level entry */
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
-        CFE_FUN_BINARY_SEARCH(pc, index_entries, index_count, first_level_entry);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+        /* Search for the first-level entry */
+        uint32_t first_level_index;
+        if (plcrash_async_cfe_search(byteorder, index_entries, index_count, sizeof(index_entries[0]), UINT32_MAX, 0, pc, &first_level_index))
+            first_level_entry = &index_entries[first_level_index];
         
         if (first_level_entry == NULL) {
             PLCF_DEBUG("Could not find a first level CFE entry for pc=%" PRIx64, (uint64_t) pc);
             return PLCRASH_ENOTFOUND;
         }
+
+        /* Determine the end of the second-level page's range. The last page is bounded by the (otherwise ignored)
+         * trailing index entry, if available. */
+        if (first_level_entry != &index_entries[index_count - 1]) {
+            page_end = byteorder->swap32(first_level_entry[1].functionOffset);
+        } else {
+            struct unwind_info_section_header_index_entry *sentinel;
+            sentinel = plcrash_async_mobject_remap_address(reader->mobj, base_addr, index_off + index_len, sizeof(*sentinel));
+            if (sentinel != NULL && byteorder->swap32(sentinel->functionOffset) > pc)
+                page_end = byteorder->swap32(sentinel->functionOffset);
+        }
     }
 
     /* Locate and decode the second-level entry */
@@ -254,13 +371,13 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
                 return PLCRASH_EINVAL;
             }
             
-            /* Binary search for the target entry */
+            /* Search for the target entry */
             struct unwind_info_regular_second_level_entry *entries = (struct unwind_info_regular_second_level_entry *) (((uintptr_t)header) + entries_offset);
             struct unwind_info_regular_second_level_entry *entry = NULL;
-            
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
-            CFE_FUN_BINARY_SEARCH(pc, entries, entries_count, entry);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+            uint32_t entry_index;
+
+            if (plcrash_async_cfe_search(byteorder, entries, entries_count, sizeof(entries[0]), UINT32_MAX, 0, pc, &entry_index))
+                entry = &entries[entry_index];
             
             if (entry == NULL) {
                 PLCF_DEBUG("Could not find a second level regular CFE entry for pc=%" PRIx64, (uint64_t) pc);
@@ -269,6 +386,10 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
 
             *encoding = byteorder->swap32(entry->encoding);
             *function_base = byteorder->swap32(entry->functionOffset);
+            if (entry != &entries[entries_count - 1])
+                *function_end = byteorder->swap32(entry[1].functionOffset);
+            else
+                *function_end = page_end;
             return PLCRASH_ESUCCESS;
         }
 
@@ -297,13 +418,13 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
                 return PLCRASH_EINVAL;
             }
 
-            /* Binary search for the target entry */
+            /* Search for the target entry */
             uint32_t *compressed_entries = (uint32_t *) (((uintptr_t)header) + entries_offset);
             uint32_t *c_entry_ptr = NULL;
+            uint32_t c_entry_index;
 
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(_tval)))
-            CFE_FUN_BINARY_SEARCH(pc, compressed_entries, entries_count, c_entry_ptr);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+            if (plcrash_async_cfe_search(byteorder, compressed_entries, entries_count, sizeof(compressed_entries[0]), UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(UINT32_MAX), base_foffset, pc, &c_entry_index))
+                c_entry_ptr = &compressed_entries[c_entry_index];
             
             if (c_entry_ptr == NULL) {
                 PLCF_DEBUG("Could not find a second level compressed CFE entry for pc=%" PRIx64, (uint64_t) pc);
@@ -314,8 +435,12 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
             uint32_t c_entry = byteorder->swap32(*c_entry_ptr);
             uint8_t c_encoding_idx = UNWIND_INFO_COMPRESSED_ENTRY_ENCODING_INDEX(c_entry);
             
-            /* Save the function base */
-            *function_base = base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(c_entry));
+            /* Save the function range */
+            *function_base = base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(c_entry);
+            if (c_entry_ptr != &compressed_entries[entries_count - 1])
+                *function_end = base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(c_entry_ptr[1]));
+            else
+                *function_end = page_end;
             
             /* Handle common table entries */
             if (c_encoding_idx < common_enc_count) {
@@ -965,7 +1090,7 @@ plcrash_async_cfe_entry_type_t plcrash_async_cfe_entry_type (plcrash_async_cfe_e
  *
  *   TODO: Need a mechanism to define the actual size of the offset. For x86-32/x86-64, it is defined as being
  *   encoded in a subl instruction.
- * - PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF: Unused.
+ * - PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF: The offset of the function's DWARF FDE within the __eh_frame section.
  *
  * @param entry The entry from which the stack offset value will be fetched.
  */
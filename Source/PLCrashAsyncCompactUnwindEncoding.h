@@ -190,9 +190,12 @@ typedef struct plcrash_async_cfe_entry {
     plcrash_regnum_t register_list[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
 } plcrash_async_cfe_entry_t;
 
+PLCR_C_BEGIN_DECLS
+
 plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reader, plcrash_async_mobject_t *mobj, cpu_type_t cputype);
 
 plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding);
+plcrash_error_t plcrash_async_cfe_reader_find_pc_range (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, pl_vm_address_t *function_end, uint32_t *encoding);
 
 void plcrash_async_cfe_reader_free (plcrash_async_cfe_reader_t *reader);
 
@@ -217,6 +220,8 @@ void plcrash_async_cfe_entry_free (plcrash_async_cfe_entry_t *entry);
 uint32_t plcrash_async_cfe_register_encode (const uint32_t registers[], uint32_t count);
 plcrash_error_t plcrash_async_cfe_register_decode (uint32_t permutation, uint32_t count, uint32_t registers[]);
 
+PLCR_C_END_DECLS
+
 /**
  * @} plcrash_async_cfe
  */
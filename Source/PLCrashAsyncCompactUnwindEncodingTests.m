@@ -38,6 +38,7 @@
 #import <mach-o/fat.h>
 #import <mach-o/arch.h>
 #import <mach-o/dyld.h>
+#import <mach/mach_time.h>
 
 
 #if PLCRASH_FEATURE_UNWIND_COMPACT
@@ -810,6 +811,155 @@
     STAssertEquals(encoding, (uint32_t)PC_REGULAR_ENCODING, @"Incorrect encoding returned");
 }
 
+/**
+ * Test reading of the PC ranges covered by compressed and regular entries.
+ */
+- (void) testReadPCRange {
+    pl_vm_address_t function_base;
+    pl_vm_address_t function_end;
+    uint32_t encoding;
+    plcrash_error_t err;
+
+    /* Bounded by the next entry in the compressed page */
+    err = plcrash_async_cfe_reader_find_pc_range(&_reader, PC_COMPACT_COMMON, &function_base, &function_end, &encoding);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to locate CFE entry");
+    STAssertEquals(function_base, (pl_vm_address_t)PC_COMPACT_COMMON, @"Incorrect function base returned");
+    STAssertEquals(function_end, (pl_vm_address_t)PC_COMPACT_PRIVATE, @"Incorrect function end returned");
+
+    /* Bounded by the next first-level entry */
+    err = plcrash_async_cfe_reader_find_pc_range(&_reader, PC_COMPACT_PRIVATE, &function_base, &function_end, &encoding);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to locate CFE entry");
+    STAssertEquals(function_base, (pl_vm_address_t)PC_COMPACT_PRIVATE, @"Incorrect function base returned");
+    STAssertEquals(function_end, (pl_vm_address_t)PC_REGULAR, @"Incorrect function end returned");
+    STAssertEquals(encoding, (uint32_t)PC_COMPACT_PRIVATE_ENCODING, @"Incorrect encoding returned");
+
+    /* The test data's trailing index entry is empty, and so the final range can only be conservatively bounded */
+    err = plcrash_async_cfe_reader_find_pc_range(&_reader, PC_REGULAR, &function_base, &function_end, &encoding);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to locate CFE entry");
+    STAssertEquals(function_base, (pl_vm_address_t)PC_REGULAR, @"Incorrect function base returned");
+    STAssertEquals(function_end, (pl_vm_address_t)PC_REGULAR+1, @"Incorrect function end returned");
+}
+
+/* Number of entries in each of the synthetic second-level pages used by testSearchLargePages */
+#define LARGE_PAGE_ENTRIES 300
+
+/* Number of lookup passes performed over the synthetic pages when timing testSearchLargePages */
+#define LARGE_PAGE_BENCH_PASSES 1000
+
+/**
+ * Test lookups within second-level pages large enough to exercise both the binary and linear phases of the entry
+ * search, verifying the entry and range returned for every function in a synthetic regular page and compressed page.
+ * Lookup latency is reported via NSLog().
+ */
+- (void) testSearchLargePages {
+    const uint32_t regular_base = 0x1000;
+    const uint32_t compressed_base = regular_base + LARGE_PAGE_ENTRIES * 0x10;
+    const uint32_t sentinel_base = compressed_base + LARGE_PAGE_ENTRIES * 0x8;
+    const uint32_t common_encoding = 0x1234;
+    const uint32_t page_encodings[] = { 0x5678, 0x9abc };
+
+    /* Lay out the header, common encodings, index, and pages */
+    uint32_t common_offset = sizeof(struct unwind_info_section_header);
+    uint32_t index_offset = common_offset + sizeof(uint32_t);
+    uint32_t regular_offset = index_offset + 3 * sizeof(struct unwind_info_section_header_index_entry);
+    uint32_t regular_size = sizeof(struct unwind_info_regular_second_level_page_header) + LARGE_PAGE_ENTRIES * sizeof(struct unwind_info_regular_second_level_entry);
+    uint32_t compressed_offset = regular_offset + regular_size;
+    uint32_t compressed_entries_offset = sizeof(struct unwind_info_compressed_second_level_page_header);
+    uint32_t compressed_encodings_offset = compressed_entries_offset + LARGE_PAGE_ENTRIES * sizeof(uint32_t);
+    uint32_t compressed_size = compressed_encodings_offset + sizeof(page_encodings);
+
+    NSMutableData *data = [NSMutableData dataWithLength: compressed_offset + compressed_size];
+    uint8_t *bytes = [data mutableBytes];
+
+    struct unwind_info_section_header *header = (struct unwind_info_section_header *) bytes;
+    header->version = 1;
+    header->commonEncodingsArraySectionOffset = common_offset;
+    header->commonEncodingsArrayCount = 1;
+    header->indexSectionOffset = index_offset;
+    header->indexCount = 3;
+    *(uint32_t *) (bytes + common_offset) = common_encoding;
+
+    struct unwind_info_section_header_index_entry *index = (struct unwind_info_section_header_index_entry *) (bytes + index_offset);
+    index[0].functionOffset = regular_base;
+    index[0].secondLevelPagesSectionOffset = regular_offset;
+    index[1].functionOffset = compressed_base;
+    index[1].secondLevelPagesSectionOffset = compressed_offset;
+    index[2].functionOffset = sentinel_base;
+
+    struct unwind_info_regular_second_level_page_header *regular = (struct unwind_info_regular_second_level_page_header *) (bytes + regular_offset);
+    regular->kind = UNWIND_SECOND_LEVEL_REGULAR;
+    regular->entryPageOffset = sizeof(*regular);
+    regular->entryCount = LARGE_PAGE_ENTRIES;
+
+    struct unwind_info_regular_second_level_entry *regular_entries = (struct unwind_info_regular_second_level_entry *) (regular + 1);
+    for (uint32_t i = 0; i < LARGE_PAGE_ENTRIES; i++) {
+        regular_entries[i].functionOffset = regular_base + i * 0x10;
+        regular_entries[i].encoding = i + 1;
+    }
+
+    struct unwind_info_compressed_second_level_page_header *compressed = (struct unwind_info_compressed_second_level_page_header *) (bytes + compressed_offset);
+    compressed->kind = UNWIND_SECOND_LEVEL_COMPRESSED;
+    compressed->entryPageOffset = compressed_entries_offset;
+    compressed->entryCount = LARGE_PAGE_ENTRIES;
+    compressed->encodingsPageOffset = compressed_encodings_offset;
+    compressed->encodingsCount = 2;
+    memcpy(bytes + compressed_offset + compressed_encodings_offset, page_encodings, sizeof(page_encodings));
+
+    uint32_t *compressed_entries = (uint32_t *) (bytes + compressed_offset + compressed_entries_offset);
+    for (uint32_t i = 0; i < LARGE_PAGE_ENTRIES; i++)
+        compressed_entries[i] = ((i % 3) << 24) | (i * 0x8);
+
+    /* Initialize a reader for the synthetic data */
+    plcrash_async_mobject_t mobj;
+    plcrash_async_cfe_reader_t reader;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) bytes, [data length], true), PLCRASH_ESUCCESS, @"Failed to map CFE data");
+    STAssertEquals(plcrash_async_cfe_reader_init(&reader, &mobj, CPU_TYPE_X86_64), PLCRASH_ESUCCESS, @"Failed to initialize CFE reader");
+
+    pl_vm_address_t function_base;
+    pl_vm_address_t function_end;
+    uint32_t encoding;
+
+    /* Addresses preceding the first page must not match */
+    STAssertEquals(plcrash_async_cfe_reader_find_pc_range(&reader, regular_base - 1, &function_base, &function_end, &encoding), PLCRASH_ENOTFOUND, @"Unexpected match");
+
+    for (uint32_t i = 0; i < LARGE_PAGE_ENTRIES; i++) {
+        /* Regular entries */
+        pl_vm_address_t base = regular_base + i * 0x10;
+        for (pl_vm_address_t pc = base; pc < base + 0x10; pc += 0x7) {
+            STAssertEquals(plcrash_async_cfe_reader_find_pc_range(&reader, pc, &function_base, &function_end, &encoding), PLCRASH_ESUCCESS, @"Failed to locate CFE entry");
+            STAssertEquals(function_base, base, @"Incorrect function base returned for 0x%llx", (unsigned long long) pc);
+            STAssertEquals(function_end, base + 0x10, @"Incorrect function end returned for 0x%llx", (unsigned long long) pc);
+            STAssertEquals(encoding, i + 1, @"Incorrect encoding returned for 0x%llx", (unsigned long long) pc);
+        }
+
+        /* Compressed entries */
+        base = compressed_base + i * 0x8;
+        for (pl_vm_address_t pc = base; pc < base + 0x8; pc += 0x5) {
+            STAssertEquals(plcrash_async_cfe_reader_find_pc_range(&reader, pc, &function_base, &function_end, &encoding), PLCRASH_ESUCCESS, @"Failed to locate CFE entry");
+            STAssertEquals(function_base, base, @"Incorrect function base returned for 0x%llx", (unsigned long long) pc);
+            STAssertEquals(function_end, base + 0x8, @"Incorrect function end returned for 0x%llx", (unsigned long long) pc);
+            STAssertEquals(encoding, (i % 3) == 0 ? common_encoding : page_encodings[(i % 3) - 1], @"Incorrect encoding returned for 0x%llx", (unsigned long long) pc);
+        }
+    }
+
+    /* Time lookups of every function */
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    uint64_t start = mach_absolute_time();
+    for (uint32_t pass = 0; pass < LARGE_PAGE_BENCH_PASSES; pass++) {
+        for (pl_vm_address_t pc = regular_base; pc < sentinel_base; pc += 0x8)
+            plcrash_async_cfe_reader_find_pc_range(&reader, pc, &function_base, &function_end, &encoding);
+    }
+    uint64_t elapsed_ns = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+    uint64_t lookups = (uint64_t) LARGE_PAGE_BENCH_PASSES * ((sentinel_base - regular_base) / 0x8);
+
+    NSLog(@"CFE lookup (%d entries per page): %llu ns/lookup", LARGE_PAGE_ENTRIES, (unsigned long long) (elapsed_ns / lookups));
+
+    plcrash_async_cfe_reader_free(&reader);
+    plcrash_async_mobject_free(&mobj);
+}
+
 /*
  * The following tests can only be run with ARM64 thread state support.
  */
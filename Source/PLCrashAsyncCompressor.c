@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncCompressor.h"
+
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_compressor
+ * @{
+ */
+
+/** The log2 size of the match finder hash table. */
+#define LZ_HASH_LOG 12
+
+/** The number of entries in the match finder hash table. */
+#define LZ_HASH_SIZE (1 << LZ_HASH_LOG)
+
+/** Minimum LZ4 match length. */
+#define LZ_MIN_MATCH 4
+
+/** The final LZ_LAST_LITERALS bytes of a block must be encoded as literals. */
+#define LZ_LAST_LITERALS 5
+
+/** A match may not start within the final LZ_MATCH_LIMIT bytes of a block. */
+#define LZ_MATCH_LIMIT 12
+
+/** Maximum LZ4 match offset. */
+#define LZ_MAX_OFFSET 65535
+
+/**
+ * Allocate a new compressor from @a allocator.
+ *
+ * @param result On success, will be set to the new compressor. The compressor must be released via
+ * plcrash_nasync_compressor_free().
+ * @param allocator The allocator from which all compressor buffers will be allocated. This is a borrowed reference,
+ * and must remain valid for the lifetime of the compressor.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ *
+ * @warning This function is not async-safe, and must be called prior to the crash.
+ */
+plcrash_error_t plcrash_nasync_compressor_new (plcrash_async_compressor_t **result, plcrash_async_allocator_t *allocator) {
+    plcrash_async_compressor_t *compressor;
+    plcrash_error_t err;
+    void *buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(*compressor))) != PLCRASH_ESUCCESS)
+        return err;
+    compressor = buf;
+    compressor->allocator = allocator;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE)) != PLCRASH_ESUCCESS)
+        goto cleanup_compressor;
+    compressor->input = buf;
+
+    size_t output_size = sizeof(plcrash_async_compressed_block_t) + PLCRASH_ASYNC_LZ_COMPRESS_BOUND(PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE);
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, output_size)) != PLCRASH_ESUCCESS)
+        goto cleanup_input;
+    compressor->output = buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(uint16_t) * LZ_HASH_SIZE)) != PLCRASH_ESUCCESS)
+        goto cleanup_output;
+    compressor->hash_table = buf;
+
+    plcrash_async_compressor_reset(compressor);
+
+    *result = compressor;
+    return PLCRASH_ESUCCESS;
+
+cleanup_output:
+    plcrash_async_allocator_dealloc(allocator, compressor->output);
+
+cleanup_input:
+    plcrash_async_allocator_dealloc(allocator, compressor->input);
+
+cleanup_compressor:
+    plcrash_async_allocator_dealloc(allocator, compressor);
+    return err;
+}
+
+/**
+ * Free @a compressor.
+ *
+ * @param compressor The compressor to free.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_compressor_free (plcrash_async_compressor_t *compressor) {
+    plcrash_async_allocator_t *allocator = compressor->allocator;
+
+    plcrash_async_allocator_dealloc(allocator, compressor->hash_table);
+    plcrash_async_allocator_dealloc(allocator, compressor->output);
+    plcrash_async_allocator_dealloc(allocator, compressor->input);
+    plcrash_async_allocator_dealloc(allocator, compressor);
+}
+
+/**
+ * Discard any pending input, preparing @a compressor for use with a new stream.
+ *
+ * @param compressor The compressor to reset.
+ */
+void plcrash_async_compressor_reset (plcrash_async_compressor_t *compressor) {
+    compressor->input_length = 0;
+}
+
+/**
+ * Append up to @a len bytes from @a data to @a compressor's pending block.
+ *
+ * @param compressor The compressor.
+ * @param data The data to append.
+ * @param len The number of bytes available in @a data.
+ *
+ * @return Returns the number of bytes consumed. If less than @a len, the pending block is full, and must be encoded
+ * via plcrash_async_compressor_encode_block() before additional data may be appended.
+ */
+size_t plcrash_async_compressor_append (plcrash_async_compressor_t *compressor, const void *data, size_t len) {
+    size_t avail = PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE - compressor->input_length;
+    if (len > avail)
+        len = avail;
+
+    plcrash_async_memcpy(compressor->input + compressor->input_length, data, len);
+    compressor->input_length += len;
+
+    return len;
+}
+
+/**
+ * Append up to @a len bytes of @a task's memory at @a address to @a compressor's pending block, copying directly from
+ * the task into the block.
+ *
+ * If the memory can not be read, the appended bytes are zero-filled; they are consumed regardless, so that the caller
+ * may continue with the remainder of the range.
+ *
+ * @param compressor The compressor.
+ * @param task The task from which the data will be read.
+ * @param address The address of the data within @a task.
+ * @param len The number of bytes available at @a address.
+ * @param consumed On return, the number of bytes consumed. If less than @a len, the pending block is full, and must
+ * be encoded via plcrash_async_compressor_encode_block() before additional data may be appended.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or the error returned by plcrash_async_task_memcpy() if the memory
+ * could not be read.
+ */
+plcrash_error_t plcrash_async_compressor_append_task (plcrash_async_compressor_t *compressor, task_t task, pl_vm_address_t address, size_t len, size_t *consumed) {
+    size_t avail = PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE - compressor->input_length;
+    if (len > avail)
+        len = avail;
+
+    uint8_t *dest = compressor->input + compressor->input_length;
+    plcrash_error_t err = plcrash_async_task_memcpy(task, address, 0, dest, len);
+    if (err != PLCRASH_ESUCCESS)
+        plcrash_async_memset(dest, 0, len);
+
+    compressor->input_length += len;
+    *consumed = len;
+
+    return err;
+}
+
+/**
+ * Return true if @a compressor's pending block is full.
+ *
+ * @param compressor The compressor.
+ */
+bool plcrash_async_compressor_full (plcrash_async_compressor_t *compressor) {
+    return compressor->input_length == PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE;
+}
+
+/**
+ * Return the number of bytes pending in @a compressor's current block.
+ *
+ * @param compressor The compressor.
+ */
+size_t plcrash_async_compressor_pending (plcrash_async_compressor_t *compressor) {
+    return compressor->input_length;
+}
+
+/**
+ * @internal
+ * Write @a value to @a p in little-endian byte order.
+ */
+static void lz_write_le32 (uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t) (value >> 8);
+    p[2] = (uint8_t) (value >> 16);
+    p[3] = (uint8_t) (value >> 24);
+}
+
+/**
+ * @internal
+ * Read a little-endian 32-bit value from @a p.
+ */
+static uint32_t lz_read_le32 (const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/**
+ * Encode @a compressor's pending block, including its block header, and reset the pending block. If no data is pending,
+ * the stream terminator is returned.
+ *
+ * @param compressor The compressor.
+ * @param block On return, the encoded block. This buffer is owned by @a compressor, and is only valid until the next
+ * call to plcrash_async_compressor_encode_block().
+ * @param block_length On return, the length of @a block, in bytes.
+ */
+void plcrash_async_compressor_encode_block (plcrash_async_compressor_t *compressor, const void **block, size_t *block_length) {
+    const size_t hdr_size = sizeof(plcrash_async_compressed_block_t);
+    uint8_t *output = compressor->output;
+    size_t input_length = compressor->input_length;
+    uint32_t length;
+
+    /* Compress, falling back on the original data if compression would not reduce the size */
+    size_t compressed = 0;
+    if (input_length > 0)
+        compressed = plcrash_async_lz_compress(compressor->input, input_length, output + hdr_size, compressor->hash_table);
+
+    if (compressed < input_length) {
+        length = (uint32_t) compressed;
+    } else {
+        plcrash_async_memcpy(output + hdr_size, compressor->input, input_length);
+        compressed = input_length;
+        length = (uint32_t) input_length;
+        if (input_length > 0)
+            length |= PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED;
+    }
+
+    lz_write_le32(output, length);
+    lz_write_le32(output + 4, (uint32_t) input_length);
+
+    *block = output;
+    *block_length = hdr_size + compressed;
+
+    compressor->input_length = 0;
+}
+
+/**
+ * @internal
+ * Hash the 4 bytes at @a p.
+ */
+static uint32_t lz_hash (const uint8_t *p) {
+    return (lz_read_le32(p) * 2654435761U) >> (32 - LZ_HASH_LOG);
+}
+
+/**
+ * @internal
+ * Write an LZ4 length extension for @a len to @a op, returning the new output position.
+ */
+static uint8_t *lz_write_length (uint8_t *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t) len;
+
+    return op;
+}
+
+/**
+ * @internal
+ * Write an LZ4 sequence consisting of @a lit_len literals from @a literals, followed by a match of @a match_len bytes
+ * at @a offset. If @a match_len is 0, only the literals are written, as is required of a block's final sequence.
+ */
+static uint8_t *lz_write_sequence (uint8_t *op, const uint8_t *literals, size_t lit_len, size_t offset, size_t match_len) {
+    uint8_t *token = op++;
+
+    /* Literals */
+    if (lit_len >= 15) {
+        *token = 15 << 4;
+        op = lz_write_length(op, lit_len - 15);
+    } else {
+        *token = (uint8_t) (lit_len << 4);
+    }
+
+    plcrash_async_memcpy(op, literals, lit_len);
+    op += lit_len;
+
+    if (match_len == 0)
+        return op;
+
+    /* Match */
+    *op++ = (uint8_t) offset;
+    *op++ = (uint8_t) (offset >> 8);
+
+    size_t ml = match_len - LZ_MIN_MATCH;
+    if (ml >= 15) {
+        *token |= 15;
+        op = lz_write_length(op, ml - 15);
+    } else {
+        *token |= (uint8_t) ml;
+    }
+
+    return op;
+}
+
+/**
+ * Compress @a src_len bytes from @a src into @a dst as a single LZ4 block.
+ *
+ * @param src The data to compress. At most PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE bytes may be provided.
+ * @param src_len The number of bytes to compress.
+ * @param dst The output buffer. Must have a capacity of at least PLCRASH_ASYNC_LZ_COMPRESS_BOUND(@a src_len) bytes.
+ * @param hash_table Scratch match finder table, with capacity for 1 << 12 entries.
+ *
+ * @return Returns the number of bytes written to @a dst.
+ */
+size_t plcrash_async_lz_compress (const uint8_t *src, size_t src_len, uint8_t *dst, uint16_t *hash_table) {
+    uint8_t *op = dst;
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    /* Block offsets must fit within the hash table's 16-bit entries */
+    PLCR_ASSERT_STATIC(block_size_fits_offsets, PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE <= LZ_MAX_OFFSET + 1);
+    PLCF_ASSERT(src_len <= PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE);
+
+    /* Stale entries are harmless, as all candidates are verified; we only need to ensure that they're in range */
+    plcrash_async_memset(hash_table, 0, sizeof(uint16_t) * LZ_HASH_SIZE);
+
+    if (src_len > LZ_MATCH_LIMIT) {
+        size_t match_limit = src_len - LZ_MATCH_LIMIT;
+        size_t extend_limit = src_len - LZ_LAST_LITERALS;
+
+        while (ip < match_limit) {
+            uint32_t h = lz_hash(src + ip);
+            size_t ref = hash_table[h];
+            hash_table[h] = (uint16_t) ip;
+
+            if (ref >= ip || ip - ref > LZ_MAX_OFFSET || lz_read_le32(src + ref) != lz_read_le32(src + ip)) {
+                ip++;
+                continue;
+            }
+
+            /* Extend the match */
+            size_t match_len = LZ_MIN_MATCH;
+            while (ip + match_len < extend_limit && src[ref + match_len] == src[ip + match_len])
+                match_len++;
+
+            op = lz_write_sequence(op, src + anchor, ip - anchor, ip - ref, match_len);
+            ip += match_len;
+            anchor = ip;
+
+            /* Seed the table with the position preceding the next search */
+            if (ip < match_limit)
+                hash_table[lz_hash(src + ip - 2)] = (uint16_t) (ip - 2);
+        }
+    }
+
+    /* Trailing literals */
+    op = lz_write_sequence(op, src + anchor, src_len - anchor, 0, 0);
+
+    return op - dst;
+}
+
+/**
+ * @internal
+ * Read an LZ4 length extension from @a *ip, adding it to @a *len.
+ *
+ * @return Returns false if the input is truncated.
+ */
+static bool lz_read_length (const uint8_t **ip, const uint8_t *iend, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= iend)
+            return false;
+
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+
+    return true;
+}
+
+/**
+ * Decompress a single LZ4 block.
+ *
+ * @param src The compressed block.
+ * @param src_len The length of @a src.
+ * @param dst The output buffer.
+ * @param dst_capacity The capacity of @a dst.
+ * @param dst_len On success, will be set to the number of bytes written to @a dst.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVALID_DATA if the block is malformed or would
+ * overrun @a dst.
+ */
+plcrash_error_t plcrash_async_lz_decompress (const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity, size_t *dst_len) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + src_len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + dst_capacity;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        /* Literals */
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !lz_read_length(&ip, iend, &lit_len))
+            return PLCRASH_EINVALID_DATA;
+
+        if (lit_len > (size_t) (iend - ip) || lit_len > (size_t) (oend - op))
+            return PLCRASH_EINVALID_DATA;
+
+        plcrash_async_memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        /* The final sequence consists only of literals */
+        if (ip == iend)
+            break;
+
+        /* Match */
+        if (iend - ip < 2)
+            return PLCRASH_EINVALID_DATA;
+
+        size_t offset = ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t) (op - dst))
+            return PLCRASH_EINVALID_DATA;
+
+        size_t match_len = token & 15;
+        if (match_len == 15 && !lz_read_length(&ip, iend, &match_len))
+            return PLCRASH_EINVALID_DATA;
+        match_len += LZ_MIN_MATCH;
+
+        if (match_len > (size_t) (oend - op))
+            return PLCRASH_EINVALID_DATA;
+
+        /* Matches may overlap their output, and so must be copied bytewise */
+        const uint8_t *match = op - offset;
+        for (size_t i = 0; i < match_len; i++)
+            op[i] = match[i];
+        op += match_len;
+    }
+
+    *dst_len = op - dst;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return true if @a data begins with a compressed report header.
+ *
+ * @param data The report data.
+ * @param len The length of @a data.
+ */
+bool plcrash_async_compressed_is_compressed (const void *data, size_t len) {
+    const plcrash_async_compressed_header_t *header = data;
+
+    if (len < sizeof(*header))
+        return false;
+
+    return memcmp(header->magic, PLCRASH_ASYNC_COMPRESSED_MAGIC, sizeof(header->magic)) == 0;
+}
+
+/**
+ * @internal
+ *
+ * Walk the blocks of a compressed report, decoding them into @a output if non-NULL.
+ *
+ * @param data The compressed report, including its header.
+ * @param len The length of @a data.
+ * @param output The output buffer, or NULL if only the decoded length should be computed.
+ * @param output_capacity The capacity of @a output.
+ * @param decoded_len On success, the total decoded length.
+ */
+static plcrash_error_t plcrash_async_compressed_walk (const void *data, size_t len, uint8_t *output, size_t output_capacity, size_t *decoded_len) {
+    const plcrash_async_compressed_header_t *header = data;
+    const uint8_t *p = data;
+    size_t offset = sizeof(*header);
+    size_t total = 0;
+
+    if (!plcrash_async_compressed_is_compressed(data, len))
+        return PLCRASH_EINVALID_DATA;
+
+    if (header->version != PLCRASH_ASYNC_COMPRESSED_VERSION)
+        return PLCRASH_ENOTSUP;
+
+    while (true) {
+        /* A missing terminator indicates a truncated report */
+        if (len - offset < sizeof(plcrash_async_compressed_block_t))
+            return PLCRASH_EINVALID_DATA;
+
+        uint32_t length = lz_read_le32(p + offset);
+        uint32_t uncompressed_length = lz_read_le32(p + offset + 4);
+        offset += sizeof(plcrash_async_compressed_block_t);
+
+        if (length == 0)
+            break;
+
+        bool stored = (length & PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED) != 0;
+        length &= ~PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED;
+
+        if (length > len - offset || uncompressed_length > PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE)
+            return PLCRASH_EINVALID_DATA;
+
+        if (stored && length != uncompressed_length)
+            return PLCRASH_EINVALID_DATA;
+
+        if (output != NULL) {
+            if (uncompressed_length > output_capacity - total)
+                return PLCRASH_EINVALID_DATA;
+
+            if (stored) {
+                plcrash_async_memcpy(output + total, p + offset, length);
+            } else {
+                size_t block_len;
+                plcrash_error_t err = plcrash_async_lz_decompress(p + offset, length, output + total, uncompressed_length, &block_len);
+                if (err != PLCRASH_ESUCCESS)
+                    return err;
+
+                if (block_len != uncompressed_length)
+                    return PLCRASH_EINVALID_DATA;
+            }
+        }
+
+        offset += length;
+        total += uncompressed_length;
+    }
+
+    *decoded_len = total;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Determine the decompressed length of a compressed report.
+ *
+ * @param data The compressed report, including its header.
+ * @param len The length of @a data.
+ * @param decoded_len On success, will be set to the number of bytes required to decode the report.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the container version is not supported, or
+ * PLCRASH_EINVALID_DATA if the report is truncated or otherwise invalid.
+ */
+plcrash_error_t plcrash_async_compressed_decoded_length (const void *data, size_t len, size_t *decoded_len) {
+    return plcrash_async_compressed_walk(data, len, NULL, 0, decoded_len);
+}
+
+/**
+ * Decompress a compressed report.
+ *
+ * @param data The compressed report, including its header.
+ * @param len The length of @a data.
+ * @param output The output buffer. The required capacity may be determined via plcrash_async_compressed_decoded_length().
+ * @param output_capacity The capacity of @a output, in bytes.
+ * @param decoded_len On success, will be set to the number of bytes written to @a output.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the container version is not supported, or
+ * PLCRASH_EINVALID_DATA if the report is truncated, invalid, or would overrun @a output.
+ */
+plcrash_error_t plcrash_async_compressed_decode (const void *data, size_t len, void *output, size_t output_capacity, size_t *decoded_len) {
+    return plcrash_async_compressed_walk(data, len, output, output_capacity, decoded_len);
+}
+
+/**
+ * @} plcrash_async_compressor
+ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_ASYNC_COMPRESSOR_H
+#define PLCRASH_ASYNC_COMPRESSOR_H
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncAllocator.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ *
+ * @defgroup plcrash_async_compressor Async-Safe Streaming Compression
+ * @ingroup plcrash_async
+ *
+ * Provides async-safe, allocation-free LZ4 block compression of crash report output, and the corresponding
+ * decompression of compressed reports.
+ *
+ * A compressed report consists of a plcrash_async_compressed_header_t, followed by a sequence of blocks. Each block
+ * is preceded by a plcrash_async_compressed_block_t header, and contains either an LZ4-compressed block, or -- if
+ * the data could not be compressed -- the original bytes. The stream is terminated by a block header with a zero
+ * length. Once decompressed, the concatenated blocks contain the original, uncompressed report, including its
+ * standard file header.
+ *
+ * @{
+ */
+
+/** The magic identifier of a compressed crash report, not NUL terminated. */
+#define PLCRASH_ASYNC_COMPRESSED_MAGIC "plcrlz4"
+
+/** The compressed crash report container version. */
+#define PLCRASH_ASYNC_COMPRESSED_VERSION 1
+
+/** The maximum number of uncompressed bytes contained in a single block. Block offsets must be representable
+ * by the 16-bit LZ4 match offset. */
+#define PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE (64 * 1024)
+
+/** If set in plcrash_async_compressed_block_t::length, the block's data is stored uncompressed. */
+#define PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED 0x80000000U
+
+/**
+ * The maximum size of LZ4-compressed output for @a size bytes of input.
+ */
+#define PLCRASH_ASYNC_LZ_COMPRESS_BOUND(size) ((size) + ((size) / 255) + 16)
+
+/**
+ * Compressed crash report file header.
+ */
+typedef struct plcrash_async_compressed_header {
+    /** Compressed report magic identifier (#PLCRASH_ASYNC_COMPRESSED_MAGIC), not NUL terminated. */
+    char magic[7];
+
+    /** Container version (#PLCRASH_ASYNC_COMPRESSED_VERSION). */
+    uint8_t version;
+} __attribute__((packed)) plcrash_async_compressed_header_t;
+
+/**
+ * Compressed block header. All values are little-endian.
+ */
+typedef struct plcrash_async_compressed_block {
+    /** The number of bytes of block data following this header, optionally OR'd with
+     * PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED. A value of 0 terminates the stream. */
+    uint32_t length;
+
+    /** The number of bytes of uncompressed data represented by the block. */
+    uint32_t uncompressed_length;
+} __attribute__((packed)) plcrash_async_compressed_block_t;
+
+/**
+ * A streaming block compressor. All buffers are allocated when the compressor is created; no allocation is
+ * performed while compressing.
+ *
+ * Data is accumulated via plcrash_async_compressor_append(), and compressed once a full block (or the final partial
+ * block) is available via plcrash_async_compressor_encode_block().
+ */
+typedef struct plcrash_async_compressor {
+    /** The allocator from which the compressor was allocated. */
+    plcrash_async_allocator_t *allocator;
+
+    /** Uncompressed input buffer. Has a capacity of PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE bytes. */
+    uint8_t *input;
+
+    /** Number of bytes pending in @a input. */
+    size_t input_length;
+
+    /** Encoded block output buffer, including the block header. Has the capacity for a block header and
+     * PLCRASH_ASYNC_LZ_COMPRESS_BOUND(PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE) bytes. */
+    uint8_t *output;
+
+    /** Match finder hash table. */
+    uint16_t *hash_table;
+} plcrash_async_compressor_t;
+
+plcrash_error_t plcrash_nasync_compressor_new (plcrash_async_compressor_t **result, plcrash_async_allocator_t *allocator);
+void plcrash_nasync_compressor_free (plcrash_async_compressor_t *compressor);
+
+void plcrash_async_compressor_reset (plcrash_async_compressor_t *compressor);
+size_t plcrash_async_compressor_append (plcrash_async_compressor_t *compressor, const void *data, size_t len);
+plcrash_error_t plcrash_async_compressor_append_task (plcrash_async_compressor_t *compressor, task_t task, pl_vm_address_t address, size_t len, size_t *consumed);
+bool plcrash_async_compressor_full (plcrash_async_compressor_t *compressor);
+size_t plcrash_async_compressor_pending (plcrash_async_compressor_t *compressor);
+void plcrash_async_compressor_encode_block (plcrash_async_compressor_t *compressor, const void **block, size_t *block_length);
+
+size_t plcrash_async_lz_compress (const uint8_t *src, size_t src_len, uint8_t *dst, uint16_t *hash_table);
+plcrash_error_t plcrash_async_lz_decompress (const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity, size_t *dst_len);
+
+bool plcrash_async_compressed_is_compressed (const void *data, size_t len);
+plcrash_error_t plcrash_async_compressed_decoded_length (const void *data, size_t len, size_t *decoded_len);
+plcrash_error_t plcrash_async_compressed_decode (const void *data, size_t len, void *output, size_t output_capacity, size_t *decoded_len);
+
+/**
+ * @} plcrash_async_compressor
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_COMPRESSOR_H */
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncCompressor.h"
+
+@interface PLCrashAsyncCompressorTests : SenTestCase {
+    /** Allocator used for compressor buffers. */
+    plcrash_async_allocator_t *_allocator;
+
+    /** The compressor under test. */
+    plcrash_async_compressor_t *_compressor;
+}
+@end
+
+@implementation PLCrashAsyncCompressorTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(plcrash_nasync_compressor_new(&_compressor, _allocator), PLCRASH_ESUCCESS, @"Failed to create compressor");
+}
+
+- (void) tearDown {
+    plcrash_nasync_compressor_free(_compressor);
+    plcrash_async_allocator_free(_allocator);
+}
+
+/**
+ * Feed @a input through the compressor, returning the complete encoded container (header, blocks, and terminator).
+ */
+- (NSData *) encode: (NSData *) input {
+    NSMutableData *output = [NSMutableData data];
+    const uint8_t *bytes = [input bytes];
+    size_t remaining = [input length];
+    const void *block;
+    size_t block_len;
+
+    struct plcrash_async_compressed_header hdr;
+    memcpy(hdr.magic, PLCRASH_ASYNC_COMPRESSED_MAGIC, sizeof(hdr.magic));
+    hdr.version = PLCRASH_ASYNC_COMPRESSED_VERSION;
+    [output appendBytes: &hdr length: sizeof(hdr)];
+
+    plcrash_async_compressor_reset(_compressor);
+    while (remaining > 0) {
+        size_t consumed = plcrash_async_compressor_append(_compressor, bytes, remaining);
+        bytes += consumed;
+        remaining -= consumed;
+
+        if (plcrash_async_compressor_full(_compressor)) {
+            plcrash_async_compressor_encode_block(_compressor, &block, &block_len);
+            [output appendBytes: block length: block_len];
+        }
+    }
+
+    /* Flush the final partial block, and then emit the terminator */
+    if (plcrash_async_compressor_pending(_compressor) > 0) {
+        plcrash_async_compressor_encode_block(_compressor, &block, &block_len);
+        [output appendBytes: block length: block_len];
+    }
+    plcrash_async_compressor_encode_block(_compressor, &block, &block_len);
+    [output appendBytes: block length: block_len];
+
+    return output;
+}
+
+/**
+ * Decode @a data, returning nil and setting @a err on failure.
+ */
+- (NSData *) decode: (NSData *) data error: (plcrash_error_t *) err {
+    size_t decoded_len;
+    size_t written;
+
+    *err = plcrash_async_compressed_decoded_length([data bytes], [data length], &decoded_len);
+    if (*err != PLCRASH_ESUCCESS)
+        return nil;
+
+    NSMutableData *output = [NSMutableData dataWithLength: decoded_len];
+    *err = plcrash_async_compressed_decode([data bytes], [data length], [output mutableBytes], [output length], &written);
+    if (*err != PLCRASH_ESUCCESS)
+        return nil;
+
+    [output setLength: written];
+    return output;
+}
+
+/** Return @a length bytes of highly repetitive, report-like test data. */
+- (NSData *) compressibleDataWithLength: (size_t) length {
+    NSMutableData *data = [NSMutableData dataWithCapacity: length];
+    const char *line = "0x00000001000a3f2c libsystem_kernel.dylib __pthread_kill + 8\n";
+    size_t line_len = strlen(line);
+
+    for (size_t i = 0; [data length] < length; i++) {
+        size_t n = MIN(line_len, length - [data length]);
+        [data appendBytes: line length: n];
+
+        /* Vary the data slightly so that matches must be re-found */
+        if ([data length] < length) {
+            uint8_t b = (uint8_t) i;
+            [data appendBytes: &b length: 1];
+        }
+    }
+
+    return data;
+}
+
+/** Return @a length bytes of incompressible test data. */
+- (NSData *) randomDataWithLength: (size_t) length {
+    NSMutableData *data = [NSMutableData dataWithLength: length];
+    uint8_t *bytes = [data mutableBytes];
+    uint32_t state = 0x2545F491;
+
+    for (size_t i = 0; i < length; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        bytes[i] = (uint8_t) state;
+    }
+
+    return data;
+}
+
+/**
+ * Test round-tripping compressible data across multiple blocks.
+ */
+- (void) testRoundTrip {
+    NSData *input = [self compressibleDataWithLength: PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE * 2 + 1234];
+    NSData *encoded = [self encode: input];
+    plcrash_error_t err;
+
+    STAssertTrue(plcrash_async_compressed_is_compressed([encoded bytes], [encoded length]), @"Container magic not recognized");
+    STAssertFalse(plcrash_async_compressed_is_compressed([input bytes], [input length]), @"Uncompressed data misidentified");
+    STAssertTrue([encoded length] < [input length] / 2, @"Data was not meaningfully compressed (%lu of %lu bytes)", (unsigned long) [encoded length], (unsigned long) [input length]);
+
+    NSData *decoded = [self decode: encoded error: &err];
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode compressed data");
+    STAssertEqualObjects(decoded, input, @"Decoded data does not match the input");
+}
+
+/**
+ * Test that incompressible data is emitted as stored blocks, and still round-trips.
+ */
+- (void) testStoredBlocks {
+    NSData *input = [self randomDataWithLength: PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE + 100];
+    NSData *encoded = [self encode: input];
+    plcrash_error_t err;
+
+    /* The first block must have been stored rather than expanded */
+    plcrash_async_compressed_block_t block;
+    memcpy(&block, (const uint8_t *) [encoded bytes] + sizeof(plcrash_async_compressed_header_t), sizeof(block));
+    STAssertTrue((OSSwapLittleToHostInt32(block.length) & PLCRASH_ASYNC_COMPRESSED_BLOCK_STORED) != 0, @"Incompressible block was not stored");
+
+    size_t overhead = sizeof(plcrash_async_compressed_header_t) + sizeof(plcrash_async_compressed_block_t) * 3;
+    STAssertEquals([encoded length], [input length] + overhead, @"Unexpected container size");
+
+    NSData *decoded = [self decode: encoded error: &err];
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode stored data");
+    STAssertEqualObjects(decoded, input, @"Decoded data does not match the input");
+}
+
+/**
+ * Test that an empty stream encodes and decodes.
+ */
+- (void) testEmpty {
+    NSData *encoded = [self encode: [NSData data]];
+    plcrash_error_t err;
+
+    NSData *decoded = [self decode: encoded error: &err];
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode empty stream");
+    STAssertEquals([decoded length], (NSUInteger) 0, @"Non-empty output");
+}
+
+/**
+ * Test that truncated data (eg, from a crash during report writing) is rejected.
+ */
+- (void) testTruncated {
+    NSData *encoded = [self encode: [self compressibleDataWithLength: 4096]];
+    plcrash_error_t err;
+
+    /* Drop the terminator */
+    NSData *truncated = [encoded subdataWithRange: NSMakeRange(0, [encoded length] - sizeof(plcrash_async_compressed_block_t))];
+    STAssertNil([self decode: truncated error: &err], @"Decoded a stream without a terminator");
+    STAssertEquals(err, PLCRASH_EINVALID_DATA, @"Unexpected error");
+
+    /* Truncate mid-block */
+    truncated = [encoded subdataWithRange: NSMakeRange(0, [encoded length] / 2)];
+    STAssertNil([self decode: truncated error: &err], @"Decoded a truncated stream");
+    STAssertEquals(err, PLCRASH_EINVALID_DATA, @"Unexpected error");
+}
+
+/**
+ * Test that LZ block decoding rejects match offsets that point before the start of the output.
+ */
+- (void) testInvalidMatchOffset {
+    /* One literal ('A'), followed by a 4 byte match at offset 2, and the trailing literals */
+    const uint8_t block[] = { 0x10, 'A', 0x02, 0x00, 0x50, 'a', 'b', 'c', 'd', 'e' };
+    uint8_t output[64];
+    size_t output_len;
+
+    STAssertEquals(plcrash_async_lz_decompress(block, sizeof(block), output, sizeof(output), &output_len), PLCRASH_EINVALID_DATA, @"Accepted an out-of-bounds match offset");
+
+    /* Offset 1 is valid */
+    uint8_t valid[sizeof(block)];
+    memcpy(valid, block, sizeof(block));
+    valid[2] = 0x01;
+    STAssertEquals(plcrash_async_lz_decompress(valid, sizeof(valid), output, sizeof(output), &output_len), PLCRASH_ESUCCESS, @"Rejected a valid block");
+    STAssertEquals(output_len, (size_t) 10, @"Incorrect decoded length");
+    STAssertTrue(memcmp(output, "AAAAAabcde", 10) == 0, @"Incorrect decoded data");
+
+    /* The output capacity must be respected */
+    STAssertEquals(plcrash_async_lz_decompress(valid, sizeof(valid), output, 8, &output_len), PLCRASH_EINVALID_DATA, @"Wrote beyond the output buffer");
+}
+
+/**
+ * Test that unknown container versions are rejected.
+ */
+- (void) testUnsupportedVersion {
+    NSMutableData *encoded = [[[self encode: [self compressibleDataWithLength: 128]] mutableCopy] autorelease];
+    plcrash_async_compressed_header_t *hdr = [encoded mutableBytes];
+    size_t len;
+
+    hdr->version = PLCRASH_ASYNC_COMPRESSED_VERSION + 1;
+    STAssertEquals(plcrash_async_compressed_decoded_length([encoded bytes], [encoded length], &len), PLCRASH_ENOTSUP, @"Accepted an unsupported version");
+}
+
+@end
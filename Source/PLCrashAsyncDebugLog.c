@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncDebugLog.h"
+
+#include <libkern/OSAtomic.h>
+#include <mach/mach.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_debug_log Buffered Debug Output
+ *
+ * Implements an optional, async-safe in-memory sink for PLCF_DEBUG() output. Writing each debug message directly to
+ * stderr costs a system call per message; while a report is being written, the output may instead be buffered, and
+ * then flushed -- and optionally embedded in the report -- once the report is complete.
+ * @{
+ */
+
+/** The log installed via plcrash_async_debug_log_set_current(), or NULL. */
+static plcrash_async_debug_log_t * volatile current_debug_log = NULL;
+
+/**
+ * Initialize @a log with a ring of at least @a size bytes. The size is rounded up to a whole number of pages.
+ *
+ * @param log The log to initialize.
+ * @param size The minimum ring size, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the ring could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_debug_log_init (plcrash_async_debug_log_t *log, size_t size) {
+    vm_address_t addr;
+    kern_return_t kt;
+
+    size = round_page(size > 0 ? size : 1);
+    if ((kt = vm_allocate(mach_task_self(), &addr, size, VM_FLAGS_ANYWHERE)) != KERN_SUCCESS) {
+        PLCF_DEBUG("vm_allocate() of the debug log failed: %d", kt);
+        return PLCRASH_ENOMEM;
+    }
+
+    log->buffer = (char *) addr;
+    log->size = size;
+    log->written = 0;
+    log->linearized = false;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free @a log's ring. The log must not be installed.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_debug_log_free (plcrash_async_debug_log_t *log) {
+    PLCF_ASSERT(current_debug_log != log);
+
+    if (log->buffer != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) log->buffer, log->size);
+
+    log->buffer = NULL;
+    log->size = 0;
+}
+
+/**
+ * Install @a log as the current debug log, or uninstall the current log if NULL. While installed, PLCF_DEBUG() output
+ * from all threads is appended to @a log.
+ *
+ * @param log The log to install, or NULL.
+ */
+void plcrash_async_debug_log_set_current (plcrash_async_debug_log_t *log) {
+    OSMemoryBarrier();
+    current_debug_log = log;
+    OSMemoryBarrier();
+}
+
+/**
+ * Return the log installed via plcrash_async_debug_log_set_current(), or NULL if none.
+ */
+plcrash_async_debug_log_t *plcrash_async_debug_log_current (void) {
+    return current_debug_log;
+}
+
+/**
+ * Append @a len bytes of @a data to @a log, overwriting the oldest output if the ring is full. This function is
+ * async-safe, and may be called concurrently; each caller reserves its own range of the ring.
+ *
+ * @param log The log to append to.
+ * @param data The bytes to append.
+ * @param len The number of bytes to append.
+ */
+void plcrash_async_debug_log_append (plcrash_async_debug_log_t *log, const char *data, size_t len) {
+    PLCF_ASSERT(!log->linearized);
+
+    /* Only the trailing bytes of an oversized append can be retained */
+    if (len > log->size) {
+        data += len - log->size;
+        len = log->size;
+    }
+
+    int64_t end = OSAtomicAdd64Barrier((int64_t) len, &log->written);
+    size_t pos = (size_t) ((uint64_t) (end - (int64_t) len) % log->size);
+
+    /* Copy in at most two pieces, wrapping at the end of the ring */
+    size_t first = log->size - pos;
+    if (first > len)
+        first = len;
+
+    plcrash_async_memcpy(log->buffer + pos, data, first);
+    plcrash_async_memcpy(log->buffer, data + first, len - first);
+}
+
+/**
+ * @internal
+ *
+ * Reverse the @a len bytes at @a p in place.
+ */
+static void plcrash_async_debug_log_reverse (char *p, size_t len) {
+    for (size_t i = 0; i < len / 2; i++) {
+        char c = p[i];
+        p[i] = p[len - i - 1];
+        p[len - i - 1] = c;
+    }
+}
+
+/**
+ * Rotate @a log's ring in place such that its contents are contiguous, ordered from oldest to newest. This function
+ * is async-safe; no appends may be performed concurrently, and the log should be uninstalled prior to calling it.
+ * Once linearized, the log must be reset via plcrash_async_debug_log_reset() prior to any further appends.
+ *
+ * @param log The log to linearize.
+ * @param length On return, will be set to the number of bytes of retained output.
+ *
+ * @return Returns a pointer to the retained output, which remains valid until the next append or reset.
+ */
+const char *plcrash_async_debug_log_linearize (plcrash_async_debug_log_t *log, size_t *length) {
+    uint64_t written = (uint64_t) log->written;
+
+    if (written <= log->size) {
+        *length = (size_t) written;
+        return log->buffer;
+    }
+
+    /* The ring has wrapped; the oldest byte is at the current write position. Rotate it to the front. */
+    size_t head = (size_t) (written % log->size);
+    if (head != 0 && !log->linearized) {
+        plcrash_async_debug_log_reverse(log->buffer, head);
+        plcrash_async_debug_log_reverse(log->buffer + head, log->size - head);
+        plcrash_async_debug_log_reverse(log->buffer, log->size);
+    }
+
+    log->linearized = true;
+
+    *length = log->size;
+    return log->buffer;
+}
+
+/**
+ * Return the number of bytes of output that have been overwritten since @a log was last reset.
+ */
+size_t plcrash_async_debug_log_dropped (plcrash_async_debug_log_t *log) {
+    uint64_t written = (uint64_t) log->written;
+    return written > log->size ? (size_t) (written - log->size) : 0;
+}
+
+/**
+ * Discard all output in @a log. This function is async-safe; no appends may be performed concurrently.
+ */
+void plcrash_async_debug_log_reset (plcrash_async_debug_log_t *log) {
+    log->written = 0;
+    log->linearized = false;
+}
+
+/**
+ * Write a single line of debug output, either to the current debug log (see plcrash_async_debug_log_set_current()),
+ * or, if none is installed, to stderr. This function is async-safe.
+ *
+ * @param line The line to be written, including its trailing newline.
+ * @param len The length of @a line, in bytes.
+ */
+void plcrash_async_debug_write (const char *line, size_t len) {
+    plcrash_async_debug_log_t *log = current_debug_log;
+
+    if (log != NULL) {
+        plcrash_async_debug_log_append(log, line, len);
+        return;
+    }
+
+    plcrash_async_writen(STDERR_FILENO, line, len);
+}
+
+/**
+ * @}
+ */
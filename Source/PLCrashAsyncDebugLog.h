@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_ASYNC_DEBUG_LOG_H
+#define PLCRASH_ASYNC_DEBUG_LOG_H
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_debug_log
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A fixed-size ring buffer of PLCF_DEBUG() output. While installed via plcrash_async_debug_log_set_current(), debug
+ * output from all threads is appended to the ring rather than being written to stderr; once full, the oldest output
+ * is overwritten.
+ */
+typedef struct plcrash_async_debug_log {
+    /** The ring storage, or NULL if the log has not been initialized. */
+    char *buffer;
+
+    /** The size of @a buffer, in bytes. */
+    size_t size;
+
+    /** The total number of bytes appended since the log was last reset. The ring's current write position is
+     * @a written modulo @a size. */
+    volatile int64_t written;
+
+    /** If true, the ring has been rotated by plcrash_async_debug_log_linearize(), and must be reset prior to any
+     * further appends. */
+    bool linearized;
+} plcrash_async_debug_log_t;
+
+plcrash_error_t plcrash_nasync_debug_log_init (plcrash_async_debug_log_t *log, size_t size);
+void plcrash_nasync_debug_log_free (plcrash_async_debug_log_t *log);
+
+void plcrash_async_debug_log_set_current (plcrash_async_debug_log_t *log);
+plcrash_async_debug_log_t *plcrash_async_debug_log_current (void);
+
+void plcrash_async_debug_log_append (plcrash_async_debug_log_t *log, const char *data, size_t len);
+const char *plcrash_async_debug_log_linearize (plcrash_async_debug_log_t *log, size_t *length);
+size_t plcrash_async_debug_log_dropped (plcrash_async_debug_log_t *log);
+void plcrash_async_debug_log_reset (plcrash_async_debug_log_t *log);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_DEBUG_LOG_H */
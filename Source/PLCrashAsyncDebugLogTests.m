@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncDebugLog.h"
+
+@interface PLCrashAsyncDebugLogTests : SenTestCase {
+    /** The log under test. */
+    plcrash_async_debug_log_t _log;
+}
+@end
+
+@implementation PLCrashAsyncDebugLogTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_nasync_debug_log_init(&_log, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to initialize log");
+}
+
+- (void) tearDown {
+    plcrash_async_debug_log_set_current(NULL);
+    plcrash_nasync_debug_log_free(&_log);
+}
+
+/**
+ * Verify that debug output is buffered only while the log is installed.
+ */
+- (void) testInstall {
+    size_t length;
+
+    plcrash_async_debug_write("a\n", 2);
+    STAssertEquals((int64_t) _log.written, (int64_t) 0, @"Output was buffered without an installed log");
+
+    plcrash_async_debug_log_set_current(&_log);
+    STAssertEquals(plcrash_async_debug_log_current(), &_log, @"Log was not installed");
+    plcrash_async_debug_write("b\n", 2);
+    plcrash_async_debug_write("c\n", 2);
+    plcrash_async_debug_log_set_current(NULL);
+
+    const char *output = plcrash_async_debug_log_linearize(&_log, &length);
+    STAssertEquals(length, (size_t) 4, @"Incorrect length");
+    STAssertTrue(memcmp(output, "b\nc\n", 4) == 0, @"Incorrect output");
+}
+
+/**
+ * Verify that the ring retains the most recent output, in order, once it has wrapped.
+ */
+- (void) testWrap {
+    char line[32];
+    size_t total = 0;
+    size_t length;
+
+    for (int i = 0; total < _log.size * 3 + 7; i++) {
+        int len = snprintf(line, sizeof(line), "line %d\n", i);
+        plcrash_async_debug_log_append(&_log, line, (size_t) len);
+        total += (size_t) len;
+    }
+
+    STAssertEquals(plcrash_async_debug_log_dropped(&_log), total - _log.size, @"Incorrect dropped byte count");
+
+    const char *output = plcrash_async_debug_log_linearize(&_log, &length);
+    STAssertEquals(length, _log.size, @"The full ring should be retained");
+
+    /* The retained output must end with the last line appended, and every complete line must follow its predecessor */
+    NSString *str = [[[NSString alloc] initWithBytes: output length: length encoding: NSASCIIStringEncoding] autorelease];
+    NSArray *lines = [str componentsSeparatedByString: @"\n"];
+    STAssertEqualObjects([lines lastObject], @"", @"Output should end with a newline");
+
+    int previous = -1;
+    for (NSUInteger i = 1; i + 1 < [lines count]; i++) {
+        int n;
+        STAssertEquals(sscanf([[lines objectAtIndex: i] UTF8String], "line %d", &n), 1, @"Malformed line");
+        if (previous >= 0)
+            STAssertEquals(n, previous + 1, @"Lines are out of order");
+        previous = n;
+    }
+
+    /* Linearizing again must not disturb the output */
+    const char *again = plcrash_async_debug_log_linearize(&_log, &length);
+    STAssertTrue(again == output && memcmp(again, [str UTF8String], length) == 0, @"Second linearization altered the output");
+
+    /* Reset discards all output */
+    plcrash_async_debug_log_reset(&_log);
+    plcrash_async_debug_log_linearize(&_log, &length);
+    STAssertEquals(length, (size_t) 0, @"Reset did not discard the output");
+    STAssertEquals(plcrash_async_debug_log_dropped(&_log), (size_t) 0, @"Reset did not clear the dropped byte count");
+}
+
+/**
+ * Verify that an append larger than the ring retains only its trailing bytes.
+ */
+- (void) testOversizedAppend {
+    size_t size = _log.size + 10;
+    char *data = malloc(size);
+    size_t length;
+
+    for (size_t i = 0; i < size; i++)
+        data[i] = (char) ('a' + (i % 26));
+
+    plcrash_async_debug_log_append(&_log, data, size);
+
+    const char *output = plcrash_async_debug_log_linearize(&_log, &length);
+    STAssertEquals(length, _log.size, @"Incorrect length");
+    STAssertTrue(memcmp(output, data + 10, length) == 0, @"Only the trailing bytes should be retained");
+
+    free(data);
+}
+
+@end
@@ -59,6 +59,7 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::push_state (void) {
     _cfa_value[_table_depth].set_undefined_rule();
 
     plcrash_async_memset(_table_stack[_table_depth], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_table_stack[0]));
+    plcrash_async_memset(_direct_stack[_table_depth], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_direct_stack[0]));
     
     return true;
 }
@@ -102,6 +103,7 @@ dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_state (void) {
     /* Set up the table */
     _table_depth = 0;
     plcrash_async_memset(_table_stack[0], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_table_stack[0]));
+    plcrash_async_memset(_direct_stack[0], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_direct_stack[0]));
     
     /* Default CFA */
     _cfa_value[0].set_undefined_rule();
@@ -116,6 +118,18 @@ dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_state (void) {
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value) {
+    /* Directly indexed registers */
+    if (regnum < dwarf_cfa_state_traits<machine_ptr>::direct_regnum_count) {
+        uint8_t *slot = &_direct_stack[_table_depth][regnum];
+        if (*slot != DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
+            _entries[*slot].value = value;
+            _entries[*slot].rule = rule;
+            return true;
+        }
+
+        return alloc_entry(regnum, rule, value, slot);
+    }
+
     /* Check for an existing entry, or find the target entry off which we'll chain our entry */
     unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
     
@@ -136,17 +150,36 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_
     }
     
     /* 'parent' now either points to the end of the list, or is NULL (in which case the table
-     * slot was empty */
-    dwarf_cfa_reg_entry *entry = NULL;
-    uint8_t entry_idx;
-    
+     * slot was empty; either insert in the parent, or insert as the first table element */
+    if (parent == NULL) {
+        return alloc_entry(regnum, rule, value, &_table_stack[_table_depth][bucket]);
+    } else {
+        return alloc_entry(regnum, rule, value, &parent->next);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Allocate and initialize a new register entry from the free list, linking it in via @a entry_idx.
+ *
+ * @param regnum The DWARF register number.
+ * @param rule The DWARF CFA rule for @a regnum.
+ * @param value The data value to be used when interpreting @a rule.
+ * @param entry_idx On success, will be set to the index of the newly allocated entry.
+ *
+ * @return Returns true on success, or false if no free entries remain.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::alloc_entry (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value, uint8_t *entry_idx) {
     /* Fetch a free entry */
     if (_free_list == DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
         /* No free entries */
         return false;
     }
-    entry_idx = _free_list;
-    entry = &_entries[entry_idx];
+
+    uint8_t idx = _free_list;
+    dwarf_cfa_reg_entry_t *entry = &_entries[idx];
     _free_list = entry->next;
     
     /* Intialize the entry */
@@ -154,14 +187,8 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_
     entry->rule = rule;
     entry->value = value;
     entry->next = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
-    
-    /* Either insert in the parent, or insert as the first table element */
-    if (parent == NULL) {
-        _table_stack[_table_depth][bucket] = entry_idx;
-    } else {
-        parent->next = entry - _entries;
-    }
-    
+
+    *entry_idx = idx;
     _register_count[_table_depth]++;
     return true;
 }
@@ -176,6 +203,17 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_rule (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value) {
+    /* Directly indexed registers */
+    if (regnum < dwarf_cfa_state_traits<machine_ptr>::direct_regnum_count) {
+        uint8_t entry_idx = _direct_stack[_table_depth][regnum];
+        if (entry_idx == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
+            return false;
+
+        *value = _entries[entry_idx].value;
+        *rule = (plcrash_dwarf_cfa_reg_rule_t) _entries[entry_idx].rule;
+        return true;
+    }
+
     /* Search for the entry */
     unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
     
@@ -207,6 +245,22 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_rule (dwarf_cfa_s
  */
 template <typename machine_ptr, typename machine_ptr_s>
 void dwarf_cfa_state<machine_ptr, machine_ptr_s>::remove_register (dwarf_cfa_state_regnum_t regnum) {
+    /* Directly indexed registers */
+    if (regnum < dwarf_cfa_state_traits<machine_ptr>::direct_regnum_count) {
+        uint8_t *slot = &_direct_stack[_table_depth][regnum];
+        if (*slot == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
+            return;
+
+        /* Re-insert in the free list */
+        _entries[*slot].next = _free_list;
+        _free_list = *slot;
+        *slot = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
+
+        /* Decrement the register count */
+        _register_count[_table_depth]--;
+        return;
+    }
+
     /* Search for the entry */
     unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
     
@@ -294,6 +348,7 @@ dwarf_cfa_rule<machine_ptr, machine_ptr_s> dwarf_cfa_state<machine_ptr, machine_
 template <typename machine_ptr, typename machine_ptr_s>
 dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::dwarf_cfa_state_iterator(dwarf_cfa_state<machine_ptr, machine_ptr_s> *stack) {
     _stack = stack;
+    _direct_idx = 0;
     _bucket_idx = 0;
     _cur_entry_idx = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
 }
@@ -307,6 +362,21 @@ dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::dwarf_cfa_state_iterator(d
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::next (dwarf_cfa_state_regnum_t *regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value) {
+    /* Enumerate the directly indexed registers */
+    for (; _direct_idx < dwarf_cfa_state_traits<machine_ptr>::direct_regnum_count; _direct_idx++) {
+        uint8_t entry_idx = _stack->_direct_stack[_stack->_table_depth][_direct_idx];
+        if (entry_idx == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
+            continue;
+
+        typename dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_reg_entry_t *entry = &_stack->_entries[entry_idx];
+        *regnum = entry->regnum;
+        *value = entry->value;
+        *rule = (plcrash_dwarf_cfa_reg_rule_t) entry->rule;
+
+        _direct_idx++;
+        return true;
+    }
+
     /* Fetch the next entry in the bucket chain */
     if (_cur_entry_idx != DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
         _cur_entry_idx = _stack->_entries[_cur_entry_idx].next;
@@ -51,10 +51,31 @@ PLCR_CPP_BEGIN_ASYNC_NS
 /* Maximum DWARF register number supported by dwarf_cfa_state and dwarf_cfa_state_regnum_t. */
 #define DWARF_CFA_STATE_REGNUM_MAX UINT32_MAX
 
-/* Consumes around 1.65k (on 32-bit and 64-bit systems). */
+/* Consumes around 1.65k (on 32-bit and 64-bit systems), excluding the directly indexed register tables. */
 #define DWARF_CFA_STATE_MAX_REGISTERS 100
 
 template <typename machine_ptr, typename machine_ptr_s> class dwarf_cfa_state_iterator;
+template <typename machine_ptr, typename machine_ptr_s> struct dwarf_cfa_checkpoint;
+template <typename machine_ptr, typename machine_ptr_s> struct dwarf_cfa_checkpoint_recorder;
+class dwarf_expression_cache;
+
+/**
+ * @internal
+ *
+ * Per-word-size dwarf_cfa_state configuration. Register numbers below @a direct_regnum_count are stored in a directly
+ * indexed table; all others fall back on the bucketed lookup table.
+ */
+template <typename machine_ptr> struct dwarf_cfa_state_traits;
+
+/** 32-bit targets; covers the i386 (0-28) and ARM core (0-15) DWARF register numbers. */
+template <> struct dwarf_cfa_state_traits<uint32_t> {
+    static const uint32_t direct_regnum_count = 32;
+};
+
+/** 64-bit targets; covers the x86-64 (0-32) and ARM64 (0-31, v0-v31 as 64-95) DWARF register numbers. */
+template <> struct dwarf_cfa_state_traits<uint64_t> {
+    static const uint32_t direct_regnum_count = 96;
+};
 
 /** DWARF CFA-defined register number .*/
 typedef uint32_t dwarf_cfa_state_regnum_t;
@@ -294,6 +315,12 @@ private:
      */
     uint8_t _table_stack[DWARF_CFA_STATE_MAX_STATES][DWARF_CFA_STATE_BUCKET_COUNT];
 
+    /**
+     * Directly indexed entry lookup table for the target's commonly used register numbers, as defined by
+     * dwarf_cfa_state_traits. Maps from regnum to an entry index, or DWARF_CFA_STATE_INVALID_ENTRY_IDX.
+     */
+    uint8_t _direct_stack[DWARF_CFA_STATE_MAX_STATES][dwarf_cfa_state_traits<machine_ptr>::direct_regnum_count];
+
     /** Current position in the table stack */
     uint8_t _table_depth;
 
@@ -307,6 +334,8 @@ private:
      */
     dwarf_cfa_reg_entry_t _entries[DWARF_CFA_STATE_MAX_REGISTERS];
 
+    bool alloc_entry (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value, uint8_t *entry_idx);
+
 public:
     dwarf_cfa_state (void);
     
@@ -318,13 +347,17 @@ public:
                                   const plcrash_async_byteorder_t *byteorder,
                                   pl_vm_address_t address,
                                   pl_vm_off_t offset,
-                                  pl_vm_size_t length);
+                                  pl_vm_size_t length,
+                                  bool *location_dependent = NULL,
+                                  const dwarf_cfa_checkpoint<machine_ptr, machine_ptr_s> *resume = NULL,
+                                  const dwarf_cfa_checkpoint_recorder<machine_ptr, machine_ptr_s> *recorder = NULL);
     
     plcrash_error_t apply_state (task_t task,
                                  plcrash_async_dwarf_cie_info_t *cie_info,
                                  const plcrash_async_thread_state_t *thread_state,
                                  const plcrash_async_byteorder_t *byteorder,
-                                 plcrash_async_thread_state_t *new_thread_state);
+                                 plcrash_async_thread_state_t *new_thread_state,
+                                 dwarf_expression_cache *expr_cache = NULL);
     
     bool set_register (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value);
     bool get_register_rule (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value);
@@ -343,6 +376,54 @@ public:
     friend class dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>;
 };
 
+/**
+ * @internal
+ *
+ * A resumable position within a CFA program, recorded at a row boundary (immediately following a CFA location
+ * advance). Evaluation of the program for any PC at or beyond @a max_location may resume from the checkpoint, rather
+ * than replaying the program from its first opcode.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+struct dwarf_cfa_checkpoint {
+    /** The offset of the next opcode to be evaluated, relative to the start of the program. */
+    pl_vm_size_t position;
+
+    /** The CFA location at @a position. */
+    machine_ptr location;
+
+    /** The greatest CFA location reached prior to (and including) @a position. Evaluation terminates once the
+     * location exceeds the target PC, and so the checkpoint is only reachable for PCs not less than this value. */
+    machine_ptr max_location;
+
+    /** The CFA state at @a position, including any states saved via DW_CFA_remember_state. */
+    dwarf_cfa_state<machine_ptr, machine_ptr_s> state;
+};
+
+/**
+ * @internal
+ *
+ * Checkpoint recording configuration for dwarf_cfa_state::eval_program().
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+struct dwarf_cfa_checkpoint_recorder {
+    /** The minimum number of opcode bytes between recorded checkpoints. */
+    pl_vm_size_t interval;
+
+    /**
+     * Called with each recorded checkpoint. The callback must copy any values it wishes to retain.
+     *
+     * @param context The recorder's @a context value.
+     * @param position The checkpoint's dwarf_cfa_checkpoint::position.
+     * @param location The checkpoint's dwarf_cfa_checkpoint::location.
+     * @param max_location The checkpoint's dwarf_cfa_checkpoint::max_location.
+     * @param state The checkpoint's dwarf_cfa_checkpoint::state.
+     */
+    void (*record)(void *context, pl_vm_size_t position, machine_ptr location, machine_ptr max_location, const dwarf_cfa_state<machine_ptr, machine_ptr_s> *state);
+
+    /** Context value to be passed to @a record. */
+    void *context;
+};
+
 /**
  * @internal
  *
@@ -352,6 +433,9 @@ public:
 template <typename machine_ptr, typename machine_ptr_s>
 class dwarf_cfa_state_iterator {
 private:
+    /** Current directly indexed register number; registers in the direct table are enumerated before the buckets */
+    uint32_t _direct_idx;
+
     /** Current bucket index */
     uint8_t _bucket_idx;
     
@@ -52,7 +52,20 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
                                                                      machine_ptr cfa_val,
                                                                      plcrash_regnum_t pl_regnum,
                                                                      plcrash_dwarf_cfa_reg_rule_t dw_rule,
-                                                                     machine_ptr dw_value);
+                                                                     machine_ptr dw_value,
+                                                                     dwarf_expression_cache *expr_cache);
+
+template <typename machine_ptr, typename machine_ptr_s>
+static plcrash_error_t plcrash_async_dwarf_cfa_state_eval_expression (task_t task,
+                                                                      const plcrash_async_thread_state_t *thread_state,
+                                                                      const plcrash_async_byteorder_t *byteorder,
+                                                                      dwarf_expression_cache *expr_cache,
+                                                                      pl_vm_address_t expr_addr,
+                                                                      bool length_prefixed,
+                                                                      pl_vm_size_t expr_len,
+                                                                      machine_ptr initial_state[],
+                                                                      size_t initial_count,
+                                                                      machine_ptr *result);
 /**
  * Evaluate a DWARF CFA program, as defined in the DWARF 4 Specification, Section 6.4.2, fetching
  * any state -- and applying  any state changes -- to the target instance.
@@ -73,6 +86,15 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
  * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
  * @param offset An offset to be applied to @a address.
  * @param length The total length of the opcodes readable at @a address + @a offset.
+ * @param location_dependent If non-NULL, will be set to true if the program modified the CFA location (eg, via
+ * DW_CFA_advance_loc), or false otherwise. Provided that @a pc is not less than @a initial_pc_value, a program that
+ * does not modify the location executes to completion, and its result is independent of both values.
+ * @param resume If non-NULL, a checkpoint previously recorded while evaluating the same program with the same initial
+ * state. The checkpoint's max_location must not exceed @a pc. Evaluation will resume from the checkpoint's position and
+ * state, rather than the start of the program; the target's current state is still used as the initial state
+ * referenced by DW_CFA_restore.
+ * @param recorder If non-NULL, checkpoints will be reported to @a recorder as row boundaries are crossed, at intervals
+ * of at least recorder->interval opcode bytes.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t values
  * on failure. If an invalid opcode is detected, PLCRASH_ENOTSUP will be returned.
@@ -89,11 +111,19 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
                                                                            const plcrash_async_byteorder_t *byteorder,
                                                                            pl_vm_address_t address,
                                                                            pl_vm_off_t offset,
-                                                                           pl_vm_size_t length)
+                                                                           pl_vm_size_t length,
+                                                                           bool *location_dependent,
+                                                                           const dwarf_cfa_checkpoint<machine_ptr, machine_ptr_s> *resume,
+                                                                           const dwarf_cfa_checkpoint_recorder<machine_ptr, machine_ptr_s> *recorder)
 {
     plcrash::async::dwarf_opstream opstream;
     plcrash_error_t err;
     machine_ptr location = initial_pc_value;
+    machine_ptr max_location = initial_pc_value;
+    pl_vm_size_t next_checkpoint = 0;
+
+    if (location_dependent != NULL)
+        *location_dependent = false;
 
     /* Save the initial state; this is needed for DW_CFA_restore, et al. */
     // TODO - It would be preferrable to only allocate the number of registers actually required here.
@@ -128,6 +158,27 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
     /* Configure the opstream */
     if ((err = opstream.init(mobj, byteorder, address, offset, length)) != PLCRASH_ESUCCESS)
         return err;
+
+    /* Resume from the checkpoint, if any. The initial state saved above is preserved for DW_CFA_restore. */
+    if (resume != NULL) {
+        PLCF_ASSERT(pc == 0 || resume->max_location <= pc);
+
+        if (resume->position > length || !opstream.skip(resume->position)) {
+            PLCF_DEBUG("Checkpoint position exceeds the opcode stream length");
+            return PLCRASH_EINVAL;
+        }
+
+        plcrash_async_memcpy(this, &resume->state, sizeof(*this));
+        location = resume->location;
+        max_location = resume->max_location;
+
+        /* Checkpoints are only recorded by location dependent programs */
+        if (location_dependent != NULL)
+            *location_dependent = true;
+    }
+
+    if (recorder != NULL)
+        next_checkpoint = opstream.get_position() + recorder->interval;
     
 #define dw_expr_read_int(_type) ({ \
     _type v; \
@@ -196,6 +247,12 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
             opcode &= 0xC0;
         }
         
+        /* Note any modification of the CFA location */
+        bool advances = (opcode == DW_CFA_set_loc || opcode == DW_CFA_advance_loc || opcode == DW_CFA_advance_loc1 ||
+                         opcode == DW_CFA_advance_loc2 || opcode == DW_CFA_advance_loc4);
+        if (advances && location_dependent != NULL)
+            *location_dependent = true;
+
         switch (opcode) {
             case DW_CFA_set_loc:
                 if (cie_info->segment_size != 0) {
@@ -452,6 +509,17 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
                 PLCF_DEBUG("Unsupported opcode 0x%" PRIx8, opcode);
                 return PLCRASH_ENOTSUP;
         }
+
+        /* A new row begins at each location advance; record a checkpoint if the recording interval has elapsed */
+        if (advances) {
+            if (location > max_location)
+                max_location = location;
+
+            if (recorder != NULL && opstream.get_position() >= next_checkpoint) {
+                recorder->record(recorder->context, opstream.get_position(), location, max_location, this);
+                next_checkpoint = opstream.get_position() + recorder->interval;
+            }
+        }
     }
 
     return PLCRASH_ESUCCESS;
@@ -466,6 +534,8 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
  * @param thread_state The current thread state corresponding to @a entry.
  * @param byteorder The target's byte order.
  * @param new_thread_state The new thread state to be initialized.
+ * @param expr_cache If non-NULL, a cache of decoded DWARF expressions that will be used to evaluate (and will be
+ * populated with) any CFA or register rule expressions.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or a standard pclrash_error_t code if an error occurs.
  */
@@ -474,7 +544,8 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
                                                                           plcrash_async_dwarf_cie_info_t *cie_info,
                                                                           const plcrash_async_thread_state_t *thread_state,
                                                                           const plcrash_async_byteorder_t *byteorder,
-                                                                          plcrash_async_thread_state_t *new_thread_state)
+                                                                          plcrash_async_thread_state_t *new_thread_state,
+                                                                          dwarf_expression_cache *expr_cache)
 {
     plcrash_error_t err;
 
@@ -520,13 +591,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
         }
 
         case DWARF_CFA_STATE_CFA_TYPE_EXPRESSION: {
-            plcrash_async_mobject_t mobj;
-            if ((err = plcrash_async_mobject_init(&mobj, task, cfa_rule.expression_address(), cfa_rule.expression_length(), true)) != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Could not map CFA expression range");
-                return err;
-            }
-            
-            if ((err = plcrash_async_dwarf_expression_eval<machine_ptr, machine_ptr_s>(&mobj, task, thread_state, byteorder, cfa_rule.expression_address(), 0x0, cfa_rule.expression_length(), NULL, 0, &cfa_val)) != PLCRASH_ESUCCESS) {
+            if ((err = plcrash_async_dwarf_cfa_state_eval_expression<machine_ptr, machine_ptr_s>(task, thread_state, byteorder, expr_cache, cfa_rule.expression_address(), false, cfa_rule.expression_length(), NULL, 0, &cfa_val)) != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("CFA eval_64 failed");
                 return err;
             }
@@ -562,7 +627,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
         }
         
         /* Apply the register rule */
-        if ((err = plcrash_async_dwarf_cfa_state_apply_register<machine_ptr, machine_ptr_s>(task, thread_state, byteorder, new_thread_state, cfa_val, pl_regnum, dw_rule, dw_value)) != PLCRASH_ESUCCESS)
+        if ((err = plcrash_async_dwarf_cfa_state_apply_register<machine_ptr, machine_ptr_s>(task, thread_state, byteorder, new_thread_state, cfa_val, pl_regnum, dw_rule, dw_value, expr_cache)) != PLCRASH_ESUCCESS)
             return err;
         
         /* If the target register is defined as the return address (and is not already the IP), copy the value to the IP.  */
@@ -608,6 +673,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
  * @param pl_regnum The register to which @a dw_rule and @a dw_value will be applied.
  * @param dw_rule The DWARF register rule to be used to derive the value for @a pl_regnum.
  * @param dw_value The DWARF value to be used with @a dw_rule
+ * @param expr_cache If non-NULL, the decoded DWARF expression cache to be used when evaluating expression rules.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or a standard pclrash_error_t code if an error occurs.
  */
@@ -619,7 +685,8 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
                                                                      machine_ptr cfa_val,
                                                                      plcrash_regnum_t pl_regnum,
                                                                      plcrash_dwarf_cfa_reg_rule_t dw_rule,
-                                                                     machine_ptr dw_value)
+                                                                     machine_ptr dw_value,
+                                                                     dwarf_expression_cache *expr_cache)
 {
     plcrash_error_t err;
     uint8_t greg_size = plcrash_async_thread_state_get_greg_size(thread_state);
@@ -671,34 +738,14 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
             
         case PLCRASH_DWARF_CFA_REG_RULE_VAL_EXPRESSION:
         case PLCRASH_DWARF_CFA_REG_RULE_EXPRESSION: {
+            /* The expression is prefixed with a ULEB128 length header */
             pl_vm_address_t expr_addr = (pl_vm_address_t) dw_value;
-            /* Fetch the expression's length */
-            uint64_t expr_len;
-            pl_vm_size_t uleb128_len;
-            if ((err = plcrash_async_dwarf_read_task_uleb128(task, expr_addr, 0, &expr_len, &uleb128_len)) != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Failed to read uleb128 length header for rule expression");
-                return err;
-            }
-            
-            /* Skip the ULEB128 length header; expr_addr will not point at the expression opcodes. */
-            if (!plcrash_async_address_apply_offset(expr_addr, uleb128_len, &expr_addr)) {
-                PLCF_DEBUG("Overflow applying the ULEB128 length to our expression base address");
-                return PLCRASH_EINVAL;
-            }
-            
-            /* Map the expression data  */
-            plcrash_async_mobject_t mobj;
-            if ((err = plcrash_async_mobject_init(&mobj, task, expr_addr, expr_len, true)) != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Could not map CFA expression range");
-                return err;
-            }
-            
+
             /* Perform the evaluation */
             plcrash_greg_t regval;
             if (m64) {
                 uint64_t initial_state[] = { cfa_val };
-                if ((err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v64)) != PLCRASH_ESUCCESS) {
-                    plcrash_async_mobject_free(&mobj);
+                if ((err = plcrash_async_dwarf_cfa_state_eval_expression<uint64_t, int64_t>(task, thread_state, byteorder, expr_cache, expr_addr, true, 0, initial_state, 1, &rvalue.v64)) != PLCRASH_ESUCCESS) {
                     PLCF_DEBUG("CFA eval_64 failed");
                     return err;
                 }
@@ -706,8 +753,7 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
                 regval = rvalue.v64;
             } else {
                 uint32_t initial_state[] = { static_cast<uint32_t>(cfa_val) };
-                if ((err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v32)) != PLCRASH_ESUCCESS) {
-                    plcrash_async_mobject_free(&mobj);
+                if ((err = plcrash_async_dwarf_cfa_state_eval_expression<uint32_t, int32_t>(task, thread_state, byteorder, expr_cache, expr_addr, true, 0, initial_state, 1, &rvalue.v32)) != PLCRASH_ESUCCESS) {
                     PLCF_DEBUG("CFA eval_32 failed");
                     return err;
                 }
@@ -715,9 +761,6 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
                 regval = rvalue.v32;
             }
             
-            /* Clean up the memory mapping */
-            plcrash_async_mobject_free(&mobj);
-            
             /* Dereference the target address, if using the non-value EXPRESSION rule */
             if (dw_rule == PLCRASH_DWARF_CFA_REG_RULE_EXPRESSION) {
                 if ((err = plcrash_async_task_memcpy(task, regval, 0, vptr, greg_size)) != PLCRASH_ESUCCESS) {
@@ -755,6 +798,84 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Evaluate the DWARF expression at @a expr_addr. If @a expr_cache is non-NULL, the expression will be evaluated
+ * from its cached decoded program; on a cache miss, the expression will be decoded and added to the cache. Expressions
+ * that can not be represented as a decoded program are evaluated via plcrash_async_dwarf_expression_eval().
+ *
+ * @param task The task containing the expression, and any data referenced by @a thread_state.
+ * @param thread_state The thread state against which the expression will be evaluated.
+ * @param byteorder The target's byte order.
+ * @param expr_cache The decoded expression cache, or NULL.
+ * @param expr_addr The task-relative address of the expression.
+ * @param length_prefixed If true, @a expr_addr references a ULEB128 length header that immediately precedes the expression
+ * opcodes (DW_FORM_block), and @a expr_len is ignored.
+ * @param expr_len The length of the expression opcodes at @a expr_addr, if @a length_prefixed is false.
+ * @param initial_state Initial set of values to be pushed onto the evaluation stack.
+ * @param initial_count Number of values in the @a initial_state array.
+ * @param[out] result On success, the evaluation result.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or a standard pclrash_error_t code if an error occurs.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static plcrash_error_t plcrash_async_dwarf_cfa_state_eval_expression (task_t task,
+                                                                      const plcrash_async_thread_state_t *thread_state,
+                                                                      const plcrash_async_byteorder_t *byteorder,
+                                                                      dwarf_expression_cache *expr_cache,
+                                                                      pl_vm_address_t expr_addr,
+                                                                      bool length_prefixed,
+                                                                      pl_vm_size_t expr_len,
+                                                                      machine_ptr initial_state[],
+                                                                      size_t initial_count,
+                                                                      machine_ptr *result)
+{
+    dwarf_expression_program program;
+    plcrash_async_mobject_t mobj;
+    plcrash_error_t err;
+
+    /* Try the cache; on a hit, neither the length header nor the expression opcodes need to be read */
+    if (expr_cache != NULL && expr_cache->lookup(expr_addr, length_prefixed, &program))
+        return program.eval<machine_ptr, machine_ptr_s>(task, thread_state, initial_state, initial_count, result);
+
+    /* Fetch the expression's length */
+    pl_vm_address_t opcodes_addr = expr_addr;
+    if (length_prefixed) {
+        uint64_t block_len;
+        pl_vm_size_t uleb128_len;
+        if ((err = plcrash_async_dwarf_read_task_uleb128(task, expr_addr, 0, &block_len, &uleb128_len)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to read uleb128 length header for rule expression");
+            return err;
+        }
+
+        /* Skip the ULEB128 length header; opcodes_addr will now point at the expression opcodes. */
+        if (!plcrash_async_address_apply_offset(expr_addr, uleb128_len, &opcodes_addr)) {
+            PLCF_DEBUG("Overflow applying the ULEB128 length to our expression base address");
+            return PLCRASH_EINVAL;
+        }
+
+        expr_len = block_len;
+    }
+
+    /* Map the expression data  */
+    if ((err = plcrash_async_mobject_init(&mobj, task, opcodes_addr, expr_len, true)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not map CFA expression range");
+        return err;
+    }
+
+    /* Decode and cache the expression */
+    if (expr_cache != NULL && program.decode(&mobj, byteorder, opcodes_addr, 0, expr_len) == PLCRASH_ESUCCESS) {
+        plcrash_async_mobject_free(&mobj);
+        expr_cache->insert(expr_addr, length_prefixed, &program);
+        return program.eval<machine_ptr, machine_ptr_s>(task, thread_state, initial_state, initial_count, result);
+    }
+
+    /* Otherwise, fall back on the interpreter */
+    err = plcrash_async_dwarf_expression_eval<machine_ptr, machine_ptr_s>(&mobj, task, thread_state, byteorder, opcodes_addr, 0, expr_len, initial_state, initial_count, result);
+    plcrash_async_mobject_free(&mobj);
+
+    return err;
+}
+
 /* Provide explicit 32/64-bit instantiations */
 template class plcrash::async::dwarf_cfa_state<uint32_t, int32_t>;
 template class plcrash::async::dwarf_cfa_state<uint64_t, int64_t>;
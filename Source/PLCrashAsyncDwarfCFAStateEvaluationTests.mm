@@ -159,6 +159,106 @@ using namespace plcrash::async;
     PERFORM_EVAL_TEST(opcodes, 0x2, PLCRASH_ESUCCESS);
 }
 
+/** Test reporting of whether a program modified the CFA location */
+- (void) testLocationDependent {
+    uint8_t independent[] = { DW_CFA_def_cfa, 0x1, 0x2, DW_CFA_offset|0x3, 0x1 };
+    uint8_t dependent[] = { DW_CFA_def_cfa, 0x1, 0x2, DW_CFA_advance_loc|0x1, DW_CFA_def_cfa_offset, 0x4 };
+    plcrash_async_mobject_t mobj;
+    bool location_dependent;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &independent, sizeof(independent), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ESUCCESS, _stack.eval_program(&mobj, 0x10, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &independent, 0, sizeof(independent), &location_dependent), @"Evaluation failed");
+    STAssertFalse(location_dependent, @"Program should not be location dependent");
+    plcrash_async_mobject_free(&mobj);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &dependent, sizeof(dependent), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ESUCCESS, _stack.eval_program(&mobj, 0x10, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &dependent, 0, sizeof(dependent), &location_dependent), @"Evaluation failed");
+    STAssertTrue(location_dependent, @"Program should be location dependent");
+    plcrash_async_mobject_free(&mobj);
+}
+
+/** Checkpoints recorded by checkpoint_test_record() */
+struct checkpoint_test_ctx {
+    dwarf_cfa_checkpoint<uint64_t, int64_t> checkpoints[32];
+    size_t count;
+};
+
+static void checkpoint_test_record (void *context, pl_vm_size_t position, uint64_t location, uint64_t max_location, const dwarf_cfa_state<uint64_t, int64_t> *state) {
+    checkpoint_test_ctx *ctx = (checkpoint_test_ctx *) context;
+    if (ctx->count == sizeof(ctx->checkpoints) / sizeof(ctx->checkpoints[0]))
+        return;
+
+    ctx->checkpoints[ctx->count].position = position;
+    ctx->checkpoints[ctx->count].location = location;
+    ctx->checkpoints[ctx->count].max_location = max_location;
+    memcpy(&ctx->checkpoints[ctx->count].state, state, sizeof(*state));
+    ctx->count++;
+}
+
+/** Verify that evaluation resumed from a recorded checkpoint produces the same row as a full evaluation */
+- (void) testCheckpointResume {
+    uint8_t opcodes[512];
+    size_t len = 0;
+
+    /* Emit a long program of single-byte location advances, interleaving remembered and restored states */
+    opcodes[len++] = DW_CFA_def_cfa; opcodes[len++] = 0x1; opcodes[len++] = 0x10;
+    for (uint8_t row = 0; row < 40; row++) {
+        opcodes[len++] = DW_CFA_advance_loc|0x1;
+        opcodes[len++] = DW_CFA_def_cfa_offset; opcodes[len++] = 0x10 + row;
+        opcodes[len++] = DW_CFA_offset|(row % 8); opcodes[len++] = row;
+
+        if (row % 10 == 3)
+            opcodes[len++] = DW_CFA_remember_state;
+        else if (row % 10 == 7)
+            opcodes[len++] = DW_CFA_restore_state;
+    }
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) opcodes, len, true), @"Failed to initialize mobj");
+
+    /* Record checkpoints while evaluating the complete program */
+    checkpoint_test_ctx *ctx = new checkpoint_test_ctx();
+    dwarf_cfa_checkpoint_recorder<uint64_t, int64_t> recorder = { 16, checkpoint_test_record, ctx };
+    dwarf_cfa_state<uint64_t, int64_t> *recorded = new dwarf_cfa_state<uint64_t, int64_t>();
+    STAssertEquals(PLCRASH_ESUCCESS, recorded->eval_program(&mobj, 0, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) opcodes, 0, len, NULL, NULL, &recorder), @"Evaluation failed");
+    STAssertTrue(ctx->count > 2, @"Expected multiple checkpoints to be recorded");
+    delete recorded;
+
+    for (uint64_t pc = 0; pc <= 42; pc++) {
+        dwarf_cfa_state<uint64_t, int64_t> *full = new dwarf_cfa_state<uint64_t, int64_t>();
+        dwarf_cfa_state<uint64_t, int64_t> *resumed = new dwarf_cfa_state<uint64_t, int64_t>();
+
+        /* Find the latest reachable checkpoint */
+        const dwarf_cfa_checkpoint<uint64_t, int64_t> *resume = NULL;
+        for (size_t i = 0; i < ctx->count; i++) {
+            if (ctx->checkpoints[i].max_location <= pc)
+                resume = &ctx->checkpoints[i];
+        }
+
+        STAssertEquals(PLCRASH_ESUCCESS, full->eval_program(&mobj, pc, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) opcodes, 0, len), @"Evaluation failed");
+        STAssertEquals(PLCRASH_ESUCCESS, resumed->eval_program(&mobj, pc, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) opcodes, 0, len, NULL, resume), @"Resumed evaluation failed");
+
+        /* Compare the resulting rows */
+        STAssertEquals(full->get_cfa_rule().register_offset(), resumed->get_cfa_rule().register_offset(), @"Incorrect CFA offset at pc %llu", pc);
+        STAssertEquals(full->get_register_count(), resumed->get_register_count(), @"Incorrect register count at pc %llu", pc);
+        for (dwarf_cfa_state_regnum_t regnum = 0; regnum < 8; regnum++) {
+            plcrash_dwarf_cfa_reg_rule_t full_rule, resumed_rule;
+            uint64_t full_value, resumed_value;
+
+            bool has_full = full->get_register_rule(regnum, &full_rule, &full_value);
+            STAssertEquals(has_full, resumed->get_register_rule(regnum, &resumed_rule, &resumed_value), @"Register %u mismatch at pc %llu", regnum, pc);
+            if (has_full)
+                STAssertEquals(full_value, resumed_value, @"Register %u value mismatch at pc %llu", regnum, pc);
+        }
+
+        delete full;
+        delete resumed;
+    }
+
+    delete ctx;
+    plcrash_async_mobject_free(&mobj);
+}
+
 /** Test evaluation of DW_CFA_def_cfa */
 - (void) testDefineCFA {
     uint8_t opcodes[] = { DW_CFA_def_cfa, 0x1, 0x2};
@@ -148,6 +148,52 @@ using namespace plcrash::async;
     STAssertEquals(found_set, (uint32_t)0, @"Did not enumerate all 32 values: 0x%" PRIx32, found_set);
 }
 
+/**
+ * Test mixing directly indexed and bucketed register numbers, including across saved states.
+ */
+- (void) testDirectAndBucketedRegisters {
+    dwarf_cfa_state<uint64_t, int64_t> stack;
+    const dwarf_cfa_state_regnum_t direct = 5;
+    const dwarf_cfa_state_regnum_t bucketed = dwarf_cfa_state_traits<uint64_t>::direct_regnum_count + 5;
+    plcrash_dwarf_cfa_reg_rule_t rule;
+    uint64_t value;
+
+    STAssertTrue(stack.set_register(direct, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 1), @"Failed to add register");
+    STAssertTrue(stack.set_register(bucketed, PLCRASH_DWARF_CFA_REG_RULE_VAL_OFFSET, 2), @"Failed to add register");
+    STAssertEquals((uint8_t)2, stack.get_register_count(), @"Incorrect number of registers");
+
+    /* Registers set in a pushed state must not be visible once popped */
+    STAssertTrue(stack.push_state(), @"Failed to push state");
+    STAssertFalse(stack.get_register_rule(direct, &rule, &value), @"Register visible in pushed state");
+    STAssertTrue(stack.set_register(direct, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 3), @"Failed to add register");
+    STAssertTrue(stack.pop_state(), @"Failed to pop state");
+
+    STAssertTrue(stack.get_register_rule(direct, &rule, &value), @"Failed to fetch info for entry");
+    STAssertEquals((uint64_t)1, value, @"Incorrect value");
+    STAssertEquals(rule, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, @"Incorrect rule");
+
+    STAssertTrue(stack.get_register_rule(bucketed, &rule, &value), @"Failed to fetch info for entry");
+    STAssertEquals((uint64_t)2, value, @"Incorrect value");
+    STAssertEquals(rule, PLCRASH_DWARF_CFA_REG_RULE_VAL_OFFSET, @"Incorrect rule");
+
+    /* Both kinds of register must be enumerated */
+    dwarf_cfa_state_iterator<uint64_t, int64_t> iter = dwarf_cfa_state_iterator<uint64_t, int64_t>(&stack);
+    dwarf_cfa_state_regnum_t regnum;
+    bool found_direct = false, found_bucketed = false;
+    while (iter.next(&regnum, &rule, &value)) {
+        if (regnum == direct)
+            found_direct = true;
+        else if (regnum == bucketed)
+            found_bucketed = true;
+    }
+    STAssertTrue(found_direct && found_bucketed, @"Did not enumerate all registers");
+
+    /* Removal */
+    stack.remove_register(direct);
+    STAssertFalse(stack.get_register_rule(direct, &rule, &value), @"Register info was returned for a removed register");
+    STAssertEquals((uint8_t)1, stack.get_register_count(), @"Register count was not correctly updated");
+}
+
 /**
  * Test removing register values from the current state.
  */
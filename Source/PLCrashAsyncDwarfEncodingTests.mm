@@ -163,6 +163,29 @@ using namespace plcrash::async;
     STAssertEquals(PLCRASH_ENOTFOUND, err, @"FDE should not have been found");
 }
 
+/**
+ * Verify that an FDE may be located directly via a section offset hint, as supplied by the compact unwind encoding.
+ */
+- (void) testFindEHFrameDescriptorEntryWithOffsetHint {
+    plcrash_error_t err;
+    plcrash_async_dwarf_fde_info_t fde_info;
+
+    /* The FDE is the second entry in the table, immediately following the CIE */
+    err = _eh_reader.find_fde(sizeof(pl_cfi_entry), PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE-1, &fde_info);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"FDE search failed");
+
+    if (_m64)
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_64), @"Incorrect offset");
+    else
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_32), @"Incorrect offset");
+
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+
+    /* Verify that an out-of-range hint is rejected */
+    err = _eh_reader.find_fde(plcrash_async_mobject_length(&_eh_frame), PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE-1, &fde_info);
+    STAssertEquals(PLCRASH_EINVAL, err, @"Out-of-range offset hint should have been rejected");
+}
+
 - (void) testFindDebugFrameDescriptorEntry {
     plcrash_error_t err;
     plcrash_async_dwarf_fde_info_t fde_info;
@@ -725,6 +725,729 @@ template plcrash_error_t plcrash_async_dwarf_expression_eval<uint64_t, int64_t>
                                                                                  uint64_t initial_state[],
                                                                                  size_t initial_count,
                                                                                  uint64_t *result);
+
+/*
+ * Pre-decoded expression programs.
+ */
+
+/**
+ * dwarf_expression_op_t kinds.
+ *
+ * The order of these values must match the dispatch table defined in dwarf_expression_program::eval().
+ */
+enum {
+    /** End of program; the result is popped from the top of the stack. */
+    DW_EXPR_OP_END = 0,
+
+    /** Push the immediate value. Used for all DW_OP_lit and DW_OP_const opcodes. */
+    DW_EXPR_OP_PUSH,
+
+    /** Push the value of register @a aux, plus the immediate offset. Used for DW_OP_breg and DW_OP_bregx. */
+    DW_EXPR_OP_BREG,
+
+    DW_EXPR_OP_DUP,
+    DW_EXPR_OP_DROP,
+
+    /** Pick stack index @a aux. Used for DW_OP_pick and DW_OP_over. */
+    DW_EXPR_OP_PICK,
+
+    DW_EXPR_OP_SWAP,
+    DW_EXPR_OP_ROT,
+    DW_EXPR_OP_XDEREF,
+    DW_EXPR_OP_DEREF,
+
+    /** Dereference @a aux bytes, after discarding the address space value. */
+    DW_EXPR_OP_XDEREF_SIZE,
+
+    /** Dereference @a aux bytes. */
+    DW_EXPR_OP_DEREF_SIZE,
+
+    DW_EXPR_OP_ABS,
+    DW_EXPR_OP_AND,
+    DW_EXPR_OP_DIV,
+    DW_EXPR_OP_MINUS,
+    DW_EXPR_OP_MOD,
+    DW_EXPR_OP_MUL,
+    DW_EXPR_OP_NEG,
+    DW_EXPR_OP_NOT,
+    DW_EXPR_OP_OR,
+    DW_EXPR_OP_PLUS,
+    DW_EXPR_OP_PLUS_UCONST,
+    DW_EXPR_OP_SHL,
+    DW_EXPR_OP_SHR,
+    DW_EXPR_OP_SHRA,
+    DW_EXPR_OP_XOR,
+    DW_EXPR_OP_LE,
+    DW_EXPR_OP_GE,
+    DW_EXPR_OP_EQ,
+    DW_EXPR_OP_LT,
+    DW_EXPR_OP_GT,
+    DW_EXPR_OP_NE,
+
+    /** Branch to op index @a aux. */
+    DW_EXPR_OP_SKIP,
+
+    /** Pop a value, and if non-zero, branch to op index @a aux. */
+    DW_EXPR_OP_BRA,
+
+    DW_EXPR_OP_NOP,
+
+    /** The total number of op kinds. */
+    DW_EXPR_OP_KIND_COUNT
+};
+
+/**
+ * Decode the DWARF expression opcodes at @a address into this program, replacing any previously decoded operations.
+ *
+ * @param mobj The memory object from which the expression opcodes will be read.
+ * @param byteorder The byte order of the data referenced by @a mobj.
+ * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
+ * @param offset An offset to be applied to @a address.
+ * @param length The total length of the opcodes readable at @a address + @a offset.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t value if the expression can not
+ * be represented as a decoded program. In that case, the program will be left empty, and the expression should be evaluated via
+ * plcrash_async_dwarf_expression_eval(), which will report the actual evaluation result.
+ */
+plcrash_error_t dwarf_expression_program::decode (plcrash_async_mobject_t *mobj,
+                                                  const plcrash_async_byteorder_t *byteorder,
+                                                  pl_vm_address_t address,
+                                                  pl_vm_off_t offset,
+                                                  pl_vm_size_t length)
+{
+    /* The opstream position of each decoded op, used to resolve branch targets */
+    uintptr_t positions[DWARF_EXPRESSION_PROGRAM_MAX_OPS];
+    dwarf_opstream opstream;
+    plcrash_error_t err;
+
+    _count = 0;
+    _ops[0].kind = DW_EXPR_OP_END;
+
+    /* Configure the opstream */
+    if ((err = opstream.init(mobj, byteorder, address, offset, length)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Position-advancing read macros; on failure, these reject the expression */
+#define dw_decode_read_int(_type) ({ \
+    _type v; \
+    if (!opstream.read_intU<_type>(&v)) { \
+        err = PLCRASH_EINVAL; \
+        goto failed; \
+    } \
+    v; \
+})
+
+#define dw_decode_read_uleb128() ({ \
+    uint64_t v; \
+    if (!opstream.read_uleb128(&v)) { \
+        err = PLCRASH_EINVAL; \
+        goto failed; \
+    } \
+    v; \
+})
+
+#define dw_decode_read_sleb128() ({ \
+    int64_t v; \
+    if (!opstream.read_sleb128(&v)) { \
+        err = PLCRASH_EINVAL; \
+        goto failed; \
+    } \
+    v; \
+})
+
+    uint8_t opcode;
+    while (opstream.read_intU(&opcode)) {
+        if (_count == DWARF_EXPRESSION_PROGRAM_MAX_OPS) {
+            PLCF_DEBUG("Expression exceeds the maximum decoded program size of %d ops", DWARF_EXPRESSION_PROGRAM_MAX_OPS);
+            err = PLCRASH_ENOTSUP;
+            goto failed;
+        }
+
+        dwarf_expression_op_t *op = &_ops[_count];
+        positions[_count] = opstream.get_position() - 1;
+        op->aux = 0;
+        op->value = 0;
+
+        /* The literal and breg opcodes are defined in monotonically increasing order */
+        if (opcode >= DW_OP_lit0 && opcode <= DW_OP_lit31) {
+            op->kind = DW_EXPR_OP_PUSH;
+            op->value = opcode - DW_OP_lit0;
+            _count++;
+            continue;
+        }
+
+        if (opcode >= DW_OP_breg0 && opcode <= DW_OP_breg31) {
+            op->kind = DW_EXPR_OP_BREG;
+            op->aux = opcode - DW_OP_breg0;
+            op->value = dw_decode_read_sleb128();
+            _count++;
+            continue;
+        }
+
+        switch (opcode) {
+            /* Constants are widened here, and truncated to the target word size at evaluation time */
+            case DW_OP_const1u: op->kind = DW_EXPR_OP_PUSH; op->value = dw_decode_read_int(uint8_t); break;
+            case DW_OP_const1s: op->kind = DW_EXPR_OP_PUSH; op->value = (int64_t) dw_decode_read_int(int8_t); break;
+            case DW_OP_const2u: op->kind = DW_EXPR_OP_PUSH; op->value = dw_decode_read_int(uint16_t); break;
+            case DW_OP_const2s: op->kind = DW_EXPR_OP_PUSH; op->value = (int64_t) dw_decode_read_int(int16_t); break;
+            case DW_OP_const4u: op->kind = DW_EXPR_OP_PUSH; op->value = dw_decode_read_int(uint32_t); break;
+            case DW_OP_const4s: op->kind = DW_EXPR_OP_PUSH; op->value = (int64_t) dw_decode_read_int(int32_t); break;
+            case DW_OP_const8u: op->kind = DW_EXPR_OP_PUSH; op->value = dw_decode_read_int(uint64_t); break;
+            case DW_OP_const8s: op->kind = DW_EXPR_OP_PUSH; op->value = (uint64_t) dw_decode_read_int(int64_t); break;
+            case DW_OP_constu:  op->kind = DW_EXPR_OP_PUSH; op->value = dw_decode_read_uleb128(); break;
+            case DW_OP_consts:  op->kind = DW_EXPR_OP_PUSH; op->value = (uint64_t) dw_decode_read_sleb128(); break;
+
+            case DW_OP_bregx: {
+                uint64_t regnum = dw_decode_read_uleb128();
+                if (regnum > UINT32_MAX) {
+                    err = PLCRASH_ENOTSUP;
+                    goto failed;
+                }
+
+                op->kind = DW_EXPR_OP_BREG;
+                op->aux = (uint32_t) regnum;
+                op->value = (uint64_t) dw_decode_read_sleb128();
+                break;
+            }
+
+            case DW_OP_pick:
+                op->kind = DW_EXPR_OP_PICK;
+                op->aux = dw_decode_read_int(uint8_t);
+                break;
+
+            case DW_OP_over:
+                op->kind = DW_EXPR_OP_PICK;
+                op->aux = 1;
+                break;
+
+            case DW_OP_deref_size:
+                op->kind = DW_EXPR_OP_DEREF_SIZE;
+                op->aux = dw_decode_read_int(uint8_t);
+                break;
+
+            case DW_OP_xderef_size:
+                op->kind = DW_EXPR_OP_XDEREF_SIZE;
+                op->aux = dw_decode_read_int(uint8_t);
+                break;
+
+            case DW_OP_plus_uconst:
+                op->kind = DW_EXPR_OP_PLUS_UCONST;
+                op->value = dw_decode_read_uleb128();
+                break;
+
+            case DW_OP_skip:
+            case DW_OP_bra: {
+                int16_t skipOffset = dw_decode_read_int(int16_t);
+
+                /* Save the target position; this is resolved to an op index once all ops have been decoded */
+                op->kind = (opcode == DW_OP_skip) ? DW_EXPR_OP_SKIP : DW_EXPR_OP_BRA;
+                op->value = (uint64_t) ((int64_t) opstream.get_position() + skipOffset);
+                break;
+            }
+
+            case DW_OP_dup:     op->kind = DW_EXPR_OP_DUP; break;
+            case DW_OP_drop:    op->kind = DW_EXPR_OP_DROP; break;
+            case DW_OP_swap:    op->kind = DW_EXPR_OP_SWAP; break;
+            case DW_OP_rot:     op->kind = DW_EXPR_OP_ROT; break;
+            case DW_OP_xderef:  op->kind = DW_EXPR_OP_XDEREF; break;
+            case DW_OP_deref:   op->kind = DW_EXPR_OP_DEREF; break;
+            case DW_OP_abs:     op->kind = DW_EXPR_OP_ABS; break;
+            case DW_OP_and:     op->kind = DW_EXPR_OP_AND; break;
+            case DW_OP_div:     op->kind = DW_EXPR_OP_DIV; break;
+            case DW_OP_minus:   op->kind = DW_EXPR_OP_MINUS; break;
+            case DW_OP_mod:     op->kind = DW_EXPR_OP_MOD; break;
+            case DW_OP_mul:     op->kind = DW_EXPR_OP_MUL; break;
+            case DW_OP_neg:     op->kind = DW_EXPR_OP_NEG; break;
+            case DW_OP_not:     op->kind = DW_EXPR_OP_NOT; break;
+            case DW_OP_or:      op->kind = DW_EXPR_OP_OR; break;
+            case DW_OP_plus:    op->kind = DW_EXPR_OP_PLUS; break;
+            case DW_OP_shl:     op->kind = DW_EXPR_OP_SHL; break;
+            case DW_OP_shr:     op->kind = DW_EXPR_OP_SHR; break;
+            case DW_OP_shra:    op->kind = DW_EXPR_OP_SHRA; break;
+            case DW_OP_xor:     op->kind = DW_EXPR_OP_XOR; break;
+            case DW_OP_le:      op->kind = DW_EXPR_OP_LE; break;
+            case DW_OP_ge:      op->kind = DW_EXPR_OP_GE; break;
+            case DW_OP_eq:      op->kind = DW_EXPR_OP_EQ; break;
+            case DW_OP_lt:      op->kind = DW_EXPR_OP_LT; break;
+            case DW_OP_gt:      op->kind = DW_EXPR_OP_GT; break;
+            case DW_OP_ne:      op->kind = DW_EXPR_OP_NE; break;
+            case DW_OP_nop:     op->kind = DW_EXPR_OP_NOP; break;
+
+            default:
+                /* Includes all opcodes unsupported by the interpreter */
+                err = PLCRASH_ENOTSUP;
+                goto failed;
+        }
+
+        _count++;
+    }
+
+#undef dw_decode_read_int
+#undef dw_decode_read_uleb128
+#undef dw_decode_read_sleb128
+
+    /* Resolve branch targets to op indices. A branch to the end of the opcode stream targets the trailing end op. */
+    for (uint8_t i = 0; i < _count; i++) {
+        dwarf_expression_op_t *op = &_ops[i];
+        if (op->kind != DW_EXPR_OP_SKIP && op->kind != DW_EXPR_OP_BRA)
+            continue;
+
+        int64_t target = (int64_t) op->value;
+        bool resolved = false;
+
+        if (target == (int64_t) opstream.get_position()) {
+            op->aux = _count;
+            resolved = true;
+        } else {
+            for (uint8_t j = 0; j < _count; j++) {
+                if (target == (int64_t) positions[j]) {
+                    op->aux = j;
+                    resolved = true;
+                    break;
+                }
+            }
+        }
+
+        /* Branches that land outside the stream, or within an opcode's operands, are left to the interpreter */
+        if (!resolved) {
+            PLCF_DEBUG("Branch target 0x%" PRIx64 " does not fall on an opcode boundary", (uint64_t) target);
+            err = PLCRASH_ENOTSUP;
+            goto failed;
+        }
+    }
+
+    /* Terminate the program */
+    _ops[_count].kind = DW_EXPR_OP_END;
+    return PLCRASH_ESUCCESS;
+
+failed:
+    /* Leave the program empty */
+    _count = 0;
+    _ops[0].kind = DW_EXPR_OP_END;
+    return err;
+}
+
+/**
+ * Fetch the value of the DWARF register @a dw_regnum from @a thread_state.
+ *
+ * @param thread_state The thread state from which the register will be fetched.
+ * @param dw_regnum The DWARF register number.
+ * @param[out] value On success, the register value.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the register number is unsupported, or
+ * PLCRASH_ENOTFOUND if the register value is not available in @a thread_state.
+ */
+template <typename machine_ptr>
+static inline plcrash_error_t dwarf_expression_regval (const plcrash_async_thread_state_t *thread_state, uint64_t dw_regnum, machine_ptr *value) {
+    plcrash_regnum_t rn;
+    if (!plcrash_async_thread_state_map_dwarf_to_reg(thread_state, dw_regnum, &rn)) {
+        PLCF_DEBUG("Unsupported DWARF register value of 0x%" PRIx64, dw_regnum);
+        return PLCRASH_ENOTSUP;
+    }
+
+    if (!plcrash_async_thread_state_has_reg(thread_state, rn)) {
+        PLCF_DEBUG("Register value of %s unavailable in the current frame.", plcrash_async_thread_state_get_reg_name(thread_state, rn));
+        return PLCRASH_ENOTFOUND;
+    }
+
+    *value = (machine_ptr) plcrash_async_thread_state_get_reg(thread_state, rn);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Evaluate the decoded program. The semantics (including error results) are identical to those of
+ * plcrash_async_dwarf_expression_eval(); rather than switching on each opcode,
+ * the operations are dispatched directly via a table of label addresses (GCC/clang's labels-as-values extension).
+ *
+ * @param task The task from which any DWARF expression memory loads will be performed.
+ * @param thread_state The thread state against which the expression will be evaluated.
+ * @param initial_state Initial set of values to be pushed onto the evaluation stack. The values will be pushed
+ * on their natural order; eg, the top of the stack will be the last value in this array. If the initial stack
+ * state should be empty, this value may be NULL, and @a initial_count should be 0.
+ * @param initial_count Number of values in the @a initial_state array.
+ * @param[out] result On success, the evaluation result.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t values on failure.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+plcrash_error_t dwarf_expression_program::eval (task_t task,
+                                                const plcrash_async_thread_state_t *thread_state,
+                                                machine_ptr initial_state[],
+                                                size_t initial_count,
+                                                machine_ptr *result) const
+{
+    /* Must be kept in sync with the DW_EXPR_OP enumeration */
+    static const void *const dispatch[] = {
+        &&op_end, &&op_push, &&op_breg, &&op_dup, &&op_drop, &&op_pick, &&op_swap, &&op_rot, &&op_xderef,
+        &&op_deref, &&op_xderef_size, &&op_deref_size, &&op_abs, &&op_and, &&op_div, &&op_minus, &&op_mod,
+        &&op_mul, &&op_neg, &&op_not, &&op_or, &&op_plus, &&op_plus_uconst, &&op_shl, &&op_shr, &&op_shra,
+        &&op_xor, &&op_le, &&op_ge, &&op_eq, &&op_lt, &&op_gt, &&op_ne, &&op_skip, &&op_bra, &&op_nop
+    };
+    PLCR_ASSERT_STATIC(DW_EXPR_OP_DISPATCH_SIZE, sizeof(dispatch) / sizeof(dispatch[0]) == DW_EXPR_OP_KIND_COUNT);
+
+    dwarf_stack<machine_ptr, 100> stack;
+    const dwarf_expression_op_t *op = _ops;
+    machine_ptr v1, v2;
+    plcrash_error_t err;
+
+    /* Push and pop macros that handle reporting of stack overflow/underflow errors */
+#define dw_prog_push(v) if (!stack.push(v)) { \
+    PLCF_DEBUG("Hit stack limit; cannot push further values"); \
+    return PLCRASH_EINTERNAL; \
+}
+
+#define dw_prog_pop(v) if (!stack.pop(v)) { \
+    PLCF_DEBUG("Pop on an empty stack"); \
+    return PLCRASH_EINTERNAL; \
+}
+
+    /* Dispatch the next op, or the op at the given index */
+#define dw_prog_next() goto *dispatch[(++op)->kind]
+#define dw_prog_jump(index) do { op = &_ops[index]; goto *dispatch[op->kind]; } while (0)
+
+    /* Populate the initial state */
+    for (size_t i = 0; i < initial_count; i++)
+        dw_prog_push(initial_state[i]);
+
+    dw_prog_jump(0);
+
+op_push:
+    dw_prog_push((machine_ptr) op->value);
+    dw_prog_next();
+
+op_breg:
+    if ((err = dwarf_expression_regval<machine_ptr>(thread_state, op->aux, &v1)) != PLCRASH_ESUCCESS)
+        return err;
+    dw_prog_push(v1 + (machine_ptr) op->value);
+    dw_prog_next();
+
+op_dup:
+    if (!stack.dup()) {
+        PLCF_DEBUG("DW_OP_dup on an empty stack");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_next();
+
+op_drop:
+    if (!stack.drop()) {
+        PLCF_DEBUG("DW_OP_drop on an empty stack");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_next();
+
+op_pick:
+    if (!stack.pick(op->aux)) {
+        PLCF_DEBUG("DW_OP_pick on invalid index");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_next();
+
+op_swap:
+    if (!stack.swap()) {
+        PLCF_DEBUG("DW_OP_swap on stack with < 2 elements");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_next();
+
+op_rot:
+    if (!stack.rotate()) {
+        PLCF_DEBUG("DW_OP_rot on stack with < 3 elements");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_next();
+
+op_xderef:
+    /* Discard the address space value; see plcrash_async_dwarf_expression_eval() */
+    if (!stack.swap()) {
+        PLCF_DEBUG("DW_OP_xderef on stack with < 2 elements");
+        return PLCRASH_EINVAL;
+    }
+    stack.drop();
+    /* Fall through to the deref implementation */
+
+op_deref:
+    dw_prog_pop(&v1);
+    if ((err = plcrash_async_task_memcpy(task, v1, 0, &v2, sizeof(v2))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("DW_OP_deref referenced an invalid target address 0x%" PRIx64, (uint64_t) v1);
+        return err;
+    }
+    dw_prog_push(v2);
+    dw_prog_next();
+
+op_xderef_size:
+    /* Discard the address space value; see plcrash_async_dwarf_expression_eval() */
+    if (!stack.swap()) {
+        PLCF_DEBUG("DW_OP_xderef_size on stack with < 2 elements");
+        return PLCRASH_EINVAL;
+    }
+    stack.drop();
+    /* Fall through to the deref_size implementation */
+
+op_deref_size:
+    if (op->aux > sizeof(machine_ptr)) {
+        PLCF_DEBUG("DW_OP_deref_size specified a size larger than the native machine word");
+        return PLCRASH_EINVAL;
+    }
+
+    dw_prog_pop(&v1);
+
+    /* Perform the read */
+#define readval(_type) case sizeof(_type): { \
+    _type r; \
+    if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t)v1, 0, &r, sizeof(_type))) != PLCRASH_ESUCCESS) { \
+        PLCF_DEBUG("DW_OP_deref_size referenced an invalid target address 0x%" PRIx64, (uint64_t) v1); \
+        return err; \
+    } \
+    v2 = r; \
+    break; \
+}
+    switch (op->aux) {
+        readval(uint8_t);
+        readval(uint16_t);
+        readval(uint32_t);
+        readval(uint64_t);
+
+        default:
+            PLCF_DEBUG("DW_OP_deref_size specified an unsupported size of %" PRIu32, op->aux);
+            return PLCRASH_EINVAL;
+    }
+#undef readval
+
+    dw_prog_push(v2);
+    dw_prog_next();
+
+op_abs:
+    dw_prog_pop(&v1);
+    if ((machine_ptr_s) v1 < 0) {
+        dw_prog_push(-(machine_ptr_s) v1);
+    } else {
+        dw_prog_push(v1);
+    }
+    dw_prog_next();
+
+op_and:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v1 & v2);
+    dw_prog_next();
+
+op_div:
+    /* v1 is the divisor, v2 is the dividend */
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    if ((machine_ptr_s) v1 == 0) {
+        PLCF_DEBUG("DW_OP_div attempted divide by zero");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_push(v2 / (machine_ptr_s) v1);
+    dw_prog_next();
+
+op_minus:
+    /* v1 is the subtrahend, v2 is the minuend */
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v2 - v1);
+    dw_prog_next();
+
+op_mod:
+    /* v1 is the divisor, v2 is the dividend */
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    if (v1 == 0) {
+        PLCF_DEBUG("DW_OP_mod attempted divide by zero");
+        return PLCRASH_EINVAL;
+    }
+    dw_prog_push(v2 % v1);
+    dw_prog_next();
+
+op_mul:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v1 * v2);
+    dw_prog_next();
+
+op_neg:
+    dw_prog_pop(&v1);
+    dw_prog_push(0 - (machine_ptr_s) v1);
+    dw_prog_next();
+
+op_not:
+    dw_prog_pop(&v1);
+    dw_prog_push(~v1);
+    dw_prog_next();
+
+op_or:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v1 | v2);
+    dw_prog_next();
+
+op_plus:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v1 + v2);
+    dw_prog_next();
+
+op_plus_uconst:
+    dw_prog_pop(&v2);
+    dw_prog_push((machine_ptr) op->value + v2);
+    dw_prog_next();
+
+op_shl:
+    /* v1 is the shift, v2 is the value */
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v2 << v1);
+    dw_prog_next();
+
+op_shr:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v2 >> v1);
+    dw_prog_next();
+
+op_shra:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(((machine_ptr_s) v2) >> v1);
+    dw_prog_next();
+
+op_xor:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push(v1 ^ v2);
+    dw_prog_next();
+
+op_le:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 <= v1));
+    dw_prog_next();
+
+op_ge:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 >= v1));
+    dw_prog_next();
+
+op_eq:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 == v1));
+    dw_prog_next();
+
+op_lt:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 < v1));
+    dw_prog_next();
+
+op_gt:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 > v1));
+    dw_prog_next();
+
+op_ne:
+    dw_prog_pop(&v1);
+    dw_prog_pop(&v2);
+    dw_prog_push((v2 != v1));
+    dw_prog_next();
+
+op_skip:
+    dw_prog_jump(op->aux);
+
+op_bra:
+    dw_prog_pop(&v1);
+    if (v1 != 0)
+        dw_prog_jump(op->aux);
+    dw_prog_next();
+
+op_nop:
+    dw_prog_next();
+
+op_end:
+    /* Provide the result */
+    if (!stack.pop(result)) {
+        PLCF_DEBUG("Expression did not provide a result value.");
+        return PLCRASH_EINVAL;
+    }
+
+#undef dw_prog_push
+#undef dw_prog_pop
+#undef dw_prog_next
+#undef dw_prog_jump
+    return PLCRASH_ESUCCESS;
+}
+
+/* Provide explicit 32/64-bit instantiations */
+template plcrash_error_t dwarf_expression_program::eval<uint32_t, int32_t> (task_t task,
+                                                                          const plcrash_async_thread_state_t *thread_state,
+                                                                          uint32_t initial_state[],
+                                                                          size_t initial_count,
+                                                                          uint32_t *result) const;
+
+template plcrash_error_t dwarf_expression_program::eval<uint64_t, int64_t> (task_t task,
+                                                                          const plcrash_async_thread_state_t *thread_state,
+                                                                          uint64_t initial_state[],
+                                                                          size_t initial_count,
+                                                                          uint64_t *result) const;
+
+/**
+ * Initialize an empty cache.
+ */
+void dwarf_expression_cache::init (void) {
+    _lock = OS_SPINLOCK_INIT;
+    _next = 0;
+    for (size_t i = 0; i < DWARF_EXPRESSION_CACHE_SIZE; i++)
+        _entries[i].valid = false;
+}
+
+/**
+ * Look up the decoded program for the expression at @a address.
+ *
+ * @param address The task-relative address of the expression.
+ * @param length_prefixed If true, @a address references the expression's ULEB128 length header.
+ * @param[out] program On success, will be populated with a copy of the cached program.
+ *
+ * @return Returns true if a cached program was found, false otherwise.
+ */
+bool dwarf_expression_cache::lookup (pl_vm_address_t address, bool length_prefixed, dwarf_expression_program *program) {
+    bool found = false;
+
+    OSSpinLockLock(&_lock); {
+        for (size_t i = 0; i < DWARF_EXPRESSION_CACHE_SIZE; i++) {
+            if (_entries[i].valid && _entries[i].address == address && _entries[i].length_prefixed == length_prefixed) {
+                plcrash_async_memcpy(program, &_entries[i].program, sizeof(*program));
+                found = true;
+                break;
+            }
+        }
+    } OSSpinLockUnlock(&_lock);
+
+    return found;
+}
+
+/**
+ * Insert a decoded @a program for the expression at @a address, replacing the oldest entry if the
+ * cache is full.
+ *
+ * @param address The task-relative address of the expression.
+ * @param length_prefixed If true, @a address references the expression's ULEB128 length header.
+ * @param program The decoded program.
+ */
+void dwarf_expression_cache::insert (pl_vm_address_t address, bool length_prefixed, const dwarf_expression_program *program) {
+    OSSpinLockLock(&_lock); {
+        entry *e = &_entries[_next];
+        _next = (_next + 1) % DWARF_EXPRESSION_CACHE_SIZE;
+
+        e->valid = true;
+        e->address = address;
+        e->length_prefixed = length_prefixed;
+        plcrash_async_memcpy(&e->program, program, sizeof(*program));
+    } OSSpinLockUnlock(&_lock);
+}
+
 /**
  * @}
  */
@@ -31,6 +31,8 @@
 #include "PLCrashAsyncMObject.h"
 #include "PLCrashAsyncThread.h"
 
+#include <libkern/OSAtomic.h>
+
 #include "PLCrashFeatureConfig.h"
 #include "PLCrashMacros.h"
 
@@ -560,6 +562,111 @@ typedef enum DW_OP {
     DW_OP_hi_user = 0xff,
 } DW_OP_t;
 
+/** The maximum number of operations that may be held by a dwarf_expression_program. */
+#define DWARF_EXPRESSION_PROGRAM_MAX_OPS 32
+
+/** The number of programs retained by a dwarf_expression_cache. */
+#define DWARF_EXPRESSION_CACHE_SIZE 8
+
+/**
+ * @internal
+ *
+ * A single pre-decoded DWARF expression operation.
+ */
+typedef struct dwarf_expression_op {
+    /** The internal operation kind (see dwarf_expression_program). */
+    uint8_t kind;
+
+    /** The operation's auxiliary operand; a register number, stack index, dereference size, or branch target op index. */
+    uint32_t aux;
+
+    /** The operation's immediate value, widened to 64-bits. */
+    uint64_t value;
+} dwarf_expression_op_t;
+
+/**
+ * @internal
+ *
+ * A DWARF expression that has been decoded into a compact, fixed-size operation array. Operand decoding,
+ * LEB128 parsing, and branch offset resolution are all performed once by decode(); the resulting
+ * program may then be evaluated repeatedly -- against differing thread states -- without
+ * re-reading the expression's opcodes.
+ *
+ * Expressions that can not be represented (eg, those that contain unsupported opcodes, exceed
+ * DWARF_EXPRESSION_PROGRAM_MAX_OPS operations, or branch to a location other than an opcode boundary)
+ * are rejected by decode(); callers should fall back to plcrash_async_dwarf_expression_eval(), which
+ * will report the appropriate evaluation error.
+ */
+class dwarf_expression_program {
+private:
+    /** Decoded operations, terminated by an implicit end operation at _ops[_count]. */
+    dwarf_expression_op_t _ops[DWARF_EXPRESSION_PROGRAM_MAX_OPS + 1];
+
+    /** The number of decoded operations, not including the trailing end operation. */
+    uint8_t _count;
+
+public:
+    plcrash_error_t decode (plcrash_async_mobject_t *mobj,
+                            const plcrash_async_byteorder_t *byteorder,
+                            pl_vm_address_t address,
+                            pl_vm_off_t offset,
+                            pl_vm_size_t length);
+
+    template <typename machine_ptr, typename machine_ptr_s>
+    plcrash_error_t eval (task_t task,
+                          const plcrash_async_thread_state_t *thread_state,
+                          machine_ptr initial_state[],
+                          size_t initial_count,
+                          machine_ptr *result) const;
+
+    /** Return the number of decoded operations. */
+    size_t op_count (void) const { return _count; }
+};
+
+/**
+ * @internal
+ *
+ * A small, thread-safe cache of decoded DWARF expression programs, keyed by the task-relative address
+ * of the expression. Expressions may be referenced either by the address of their opcodes, or -- for the
+ * DW_FORM_block encoded expressions referenced by register rules -- by the address of their ULEB128 length
+ * header, avoiding the need to re-read the header on a cache hit. The cache is intended to be shared by all threads unwound within a single report,
+ * allowing the CFA and register expressions of frequently encountered functions to be decoded
+ * only once.
+ *
+ * The cache performs no allocation, and may be safely used from within a signal handler.
+ */
+class dwarf_expression_cache {
+private:
+    /** A single cache entry. */
+    struct entry {
+        /** If true, this entry is populated. */
+        bool valid;
+
+        /** The task-relative address of the cached expression. */
+        pl_vm_address_t address;
+
+        /** If true, @a address references the expression's ULEB128 length header, rather than its opcodes. */
+        bool length_prefixed;
+
+        /** The decoded program. */
+        dwarf_expression_program program;
+    };
+
+    /** Lock guarding all cache state. */
+    OSSpinLock _lock;
+
+    /** Cache entries. */
+    entry _entries[DWARF_EXPRESSION_CACHE_SIZE];
+
+    /** The next entry to be replaced. */
+    uint32_t _next;
+
+public:
+    void init (void);
+    bool lookup (pl_vm_address_t address, bool length_prefixed, dwarf_expression_program *program);
+    void insert (pl_vm_address_t address, bool length_prefixed, const dwarf_expression_program *program);
+};
+
 template <typename machine_ptr, typename machine_ptr_s>
 plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mobj,
                                                      task_t task,
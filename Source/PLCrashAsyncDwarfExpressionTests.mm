@@ -144,22 +144,40 @@ using namespace plcrash::async;
 
 /* Perform evaluation of the given opcodes, expecting a result of type @a type,
  * with an expected value of @a expected. The data is interpreted as big endian,
- * as to simplify formulating multi-byte test values in the opcode stream */
+ * as to simplify formulating multi-byte test values in the opcode stream.
+ *
+ * If the opcodes may be represented as a decoded dwarf_expression_program, the program's
+ * evaluation result is also verified. */
 #define PERFORM_EVAL_TEST(opcodes, type, expected) do { \
     plcrash_async_mobject_t mobj; \
     plcrash_error_t err; \
+    dwarf_expression_program program; \
+    bool decoded; \
     STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &opcodes, sizeof(opcodes), true), @"Failed to initialize mobj"); \
+    decoded = (program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes)) == PLCRASH_ESUCCESS); \
 \
     if (![self is32]) { \
         uint64_t result; \
         err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result); \
         STAssertEquals(err, PLCRASH_ESUCCESS, @"64-bit evaluation failed"); \
         STAssertEquals((type)result, (type)expected, @"Incorrect 64-bit result"); \
+\
+        if (decoded) { \
+            err = program.eval<uint64_t, int64_t>(mach_task_self(), &_ts, NULL, 0, &result); \
+            STAssertEquals(err, PLCRASH_ESUCCESS, @"64-bit program evaluation failed"); \
+            STAssertEquals((type)result, (type)expected, @"Incorrect 64-bit program result"); \
+        } \
     } else { \
         uint32_t result; \
         err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result); \
         STAssertEquals(err, PLCRASH_ESUCCESS, @"32-bit evaluation failed"); \
         STAssertEquals((type)result, (type)expected, @"Incorrect 32-bit result"); \
+\
+        if (decoded) { \
+            err = program.eval<uint32_t, int32_t>(mach_task_self(), &_ts, NULL, 0, &result); \
+            STAssertEquals(err, PLCRASH_ESUCCESS, @"32-bit program evaluation failed"); \
+            STAssertEquals((type)result, (type)expected, @"Incorrect 32-bit program result"); \
+        } \
     } \
 \
     plcrash_async_mobject_free(&mobj); \
@@ -172,14 +190,25 @@ using namespace plcrash::async;
     plcrash_error_t err; \
     STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &opcodes, sizeof(opcodes), true), @"Failed to initialize mobj"); \
     \
+    dwarf_expression_program program; \
+    bool decoded = (program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes)) == PLCRASH_ESUCCESS); \
+    \
     if (![self is32]) { \
         uint64_t result; \
         err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result); \
         STAssertEquals(err, errval, @"64-bit evaluation did not return expected error code"); \
+        if (decoded) { \
+            err = program.eval<uint64_t, int64_t>(mach_task_self(), &_ts, NULL, 0, &result); \
+            STAssertEquals(err, errval, @"64-bit program evaluation did not return expected error code"); \
+        } \
     } else { \
         uint32_t result; \
         err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result); \
         STAssertEquals(err, errval, @"32-bit evaluation did not return expected error code"); \
+        if (decoded) { \
+            err = program.eval<uint32_t, int32_t>(mach_task_self(), &_ts, NULL, 0, &result); \
+            STAssertEquals(err, errval, @"32-bit program evaluation did not return expected error code"); \
+        } \
     } \
     \
     plcrash_async_mobject_free(&mobj); \
@@ -819,6 +848,87 @@ using namespace plcrash::async;
     PERFORM_EVAL_TEST_ERROR(opcodes, PLCRASH_ENOTSUP);
 }
 
+/**
+ * Test decoding of expressions into a dwarf_expression_program.
+ */
+- (void) testDecodeProgram {
+    plcrash_async_mobject_t mobj;
+    dwarf_expression_program program;
+
+    /* Branches are resolved to op indices; this counts down from the initial state value, returning 0 */
+    uint8_t loop[] = { DW_OP_lit1, DW_OP_minus, DW_OP_dup, DW_OP_bra, 0xFF, 0xFA /* -6; jump to decrement */ };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &loop, sizeof(loop), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ESUCCESS, program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &loop, 0, sizeof(loop)), @"Failed to decode program");
+    STAssertEquals((size_t) 4, program.op_count(), @"Incorrect op count");
+
+    if (![self is32]) {
+        uint64_t result = 1;
+        uint64_t initial_state[] = { 10 };
+        STAssertEquals(PLCRASH_ESUCCESS, program.eval<uint64_t, int64_t>(mach_task_self(), &_ts, initial_state, 1, &result), @"64-bit program evaluation failed");
+        STAssertEquals((uint64_t) 0, result, @"Incorrect 64-bit result");
+    } else {
+        uint32_t result = 1;
+        uint32_t initial_state[] = { 10 };
+        STAssertEquals(PLCRASH_ESUCCESS, program.eval<uint32_t, int32_t>(mach_task_self(), &_ts, initial_state, 1, &result), @"32-bit program evaluation failed");
+        STAssertEquals((uint32_t) 0, result, @"Incorrect 32-bit result");
+    }
+    plcrash_async_mobject_free(&mobj);
+
+    /* Branches into an opcode's operands can not be represented, and must be rejected */
+    uint8_t operand_branch[] = { DW_OP_const1u, DW_OP_lit2, DW_OP_skip, 0xFF, 0xFC /* -4; jump into the const1u operand */ };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &operand_branch, sizeof(operand_branch), true), @"Failed to initialize mobj");
+    STAssertNotEquals(PLCRASH_ESUCCESS, program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &operand_branch, 0, sizeof(operand_branch)), @"Decoded a branch into an operand");
+    STAssertEquals((size_t) 0, program.op_count(), @"A rejected program should be left empty");
+    plcrash_async_mobject_free(&mobj);
+
+    /* Unsupported opcodes must be rejected */
+    uint8_t unsupported[] = { DW_OP_lit1, DW_OP_call_frame_cfa };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &unsupported, sizeof(unsupported), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ENOTSUP, program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &unsupported, 0, sizeof(unsupported)), @"Decoded an unsupported opcode");
+    plcrash_async_mobject_free(&mobj);
+
+    /* Programs exceeding the maximum op count must be rejected */
+    uint8_t oversized[DWARF_EXPRESSION_PROGRAM_MAX_OPS + 1];
+    memset(oversized, DW_OP_nop, sizeof(oversized));
+    oversized[0] = DW_OP_lit1;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &oversized, sizeof(oversized), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ENOTSUP, program.decode(&mobj, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &oversized, 0, sizeof(oversized)), @"Decoded an oversized program");
+    plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Test caching of decoded programs.
+ */
+- (void) testExpressionCache {
+    plcrash_async_mobject_t mobj;
+    dwarf_expression_program program;
+    dwarf_expression_cache cache;
+    cache.init();
+
+    uint8_t opcodes[] = { DW_OP_const1u, 0x42 };
+    pl_vm_address_t addr = (pl_vm_address_t) &opcodes;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), addr, sizeof(opcodes), true), @"Failed to initialize mobj");
+    STAssertEquals(PLCRASH_ESUCCESS, program.decode(&mobj, plcrash_async_byteorder_big_endian(), addr, 0, sizeof(opcodes)), @"Failed to decode program");
+    plcrash_async_mobject_free(&mobj);
+
+    STAssertFalse(cache.lookup(addr, false, &program), @"Lookup in an empty cache succeeded");
+    cache.insert(addr, false, &program);
+
+    /* Length-prefixed expressions are keyed separately */
+    dwarf_expression_program cached;
+    STAssertFalse(cache.lookup(addr, true, &cached), @"Lookup of a length-prefixed expression matched an unprefixed entry");
+    STAssertTrue(cache.lookup(addr, false, &cached), @"Lookup of a cached expression failed");
+
+    uint64_t result;
+    STAssertEquals(PLCRASH_ESUCCESS, cached.eval<uint64_t, int64_t>(mach_task_self(), &_ts, NULL, 0, &result), @"Evaluation of cached program failed");
+    STAssertEquals((uint64_t) 0x42, result, @"Incorrect result");
+
+    /* Filling the cache must evict the oldest entry */
+    for (pl_vm_address_t i = 1; i <= DWARF_EXPRESSION_CACHE_SIZE; i++)
+        cache.insert(addr + i, false, &program);
+    STAssertFalse(cache.lookup(addr, false, &cached), @"Oldest entry was not evicted");
+    STAssertTrue(cache.lookup(addr + DWARF_EXPRESSION_CACHE_SIZE, false, &cached), @"Newest entry was evicted");
+}
 
 @end
 
@@ -436,48 +436,146 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_read_task_uleb128 (task_t ta
 }
 
 /**
- * Read a ULEB128 value from @a location within @a mobj.
+ * @internal
  *
- * @param mobj The memory object from which the LEB128 data will be read.
- * @param location A task-relative location within @a mobj.
- * @param offset Offset to be applied to @a location.
- * @param result On success, the ULEB128 value.
- * @param size On success, will be set to the total size of the decoded LEB128 value at @a location, in bytes.
+ * Return the number of bytes available within @a mobj at the locally mapped pointer @a p.
  */
-plcrash_error_t plcrash::async::plcrash_async_dwarf_read_uleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, uint64_t *result, pl_vm_size_t *size) {
+static size_t plcrash_async_dwarf_mobject_available (plcrash_async_mobject_t *mobj, const uint8_t *p) {
+    return (size_t) ((mobj->address + mobj->length) - (uintptr_t) p);
+}
+
+/**
+ * @internal
+ *
+ * Decode a LEB128 value's payload bits from local memory, returning the decoded bits via @a result, the final byte via
+ * @a last_byte, and the total bit width of the payload via @a bits. The caller is responsible for any sign extension.
+ *
+ * The range [@a p, @a p + @a available) must have been validated by the caller; no further bounds checks are performed
+ * beyond comparing against @a available. Where at least 8 bytes are available, the terminating byte is located via a
+ * single 64-bit load, and the value is then decoded without per-byte termination checks.
+ */
+static plcrash_error_t plcrash_async_dwarf_decode_leb128 (const uint8_t *p, size_t available, uint64_t *result, uint8_t *last_byte, unsigned int *bits, pl_vm_size_t *size) {
+#if defined(__LITTLE_ENDIAN__) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* Fast path; find the first byte with a clear continuation bit within the next 8 bytes */
+    if (available >= sizeof(uint64_t)) {
+        uint64_t word;
+        __builtin_memcpy(&word, p, sizeof(word));
+
+        uint64_t stop = ~word & 0x8080808080808080ULL;
+        if (stop != 0) {
+            unsigned int length = (__builtin_ctzll(stop) >> 3) + 1;
+            uint64_t value = 0;
+
+            for (unsigned int i = 0; i < length; i++)
+                value |= ((word >> (i * 8)) & 0x7f) << (i * 7);
+
+            *result = value;
+            *last_byte = (uint8_t) (word >> ((length - 1) * 8));
+            *bits = length * 7;
+            *size = length;
+            return PLCRASH_ESUCCESS;
+        }
+    }
+#endif
+
     unsigned int shift = 0;
-    pl_vm_off_t position = 0;
-    *result = 0;
-    
-    uint8_t *p;
-    while ((p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, position + offset, 1)) != NULL) {
+    size_t position = 0;
+    uint64_t value = 0;
+
+    while (position < available) {
         /* LEB128 uses 7 bits for the number, the final bit to signal completion */
-        uint8_t byte = *p;
-        *result |= ((uint64_t) (byte & 0x7f)) << shift;
+        uint8_t byte = p[position];
+        value |= ((uint64_t) (byte & 0x7f)) << shift;
         shift += 7;
-        
+
         /* This is used to track length, so we must set it before
          * potentially terminating the loop below */
         position++;
-        
+
         /* Check for terminating bit */
-        if ((byte & 0x80) == 0)
-            break;
-        
-        /* Check for a ULEB128 larger than 64-bits */
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            *last_byte = byte;
+            *bits = shift;
+            *size = position;
+            return PLCRASH_ESUCCESS;
+        }
+
+        /* Check for a LEB128 larger than 64-bits */
         if (shift >= 64) {
-            PLCF_DEBUG("ULEB128 is larger than the maximum supported size of 64 bits");
+            PLCF_DEBUG("LEB128 is larger than the maximum supported size of 64 bits");
             return PLCRASH_ENOTSUP;
         }
     }
-    
+
+    PLCF_DEBUG("LEB128 value did not terminate within mapped memory range");
+    return PLCRASH_EINVAL;
+}
+
+/**
+ * Decode a ULEB128 value from local memory that has already been validated by the caller.
+ *
+ * @param p The locally mapped LEB128 data.
+ * @param available The number of bytes available at @a p.
+ * @param result On success, the ULEB128 value.
+ * @param size On success, will be set to the total size of the decoded LEB128 value at @a p, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the value does not terminate within @a available
+ * bytes, or PLCRASH_ENOTSUP if the value is larger than 64 bits.
+ */
+plcrash_error_t plcrash::async::plcrash_async_dwarf_decode_uleb128 (const uint8_t *p, size_t available, uint64_t *result, pl_vm_size_t *size) {
+    uint8_t last_byte;
+    unsigned int bits;
+
+    return plcrash_async_dwarf_decode_leb128(p, available, result, &last_byte, &bits, size);
+}
+
+/**
+ * Decode a SLEB128 value from local memory that has already been validated by the caller.
+ *
+ * @param p The locally mapped LEB128 data.
+ * @param available The number of bytes available at @a p.
+ * @param result On success, the SLEB128 value.
+ * @param size On success, will be set to the total size of the decoded LEB128 value at @a p, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the value does not terminate within @a available
+ * bytes, or PLCRASH_ENOTSUP if the value is larger than 64 bits.
+ */
+plcrash_error_t plcrash::async::plcrash_async_dwarf_decode_sleb128 (const uint8_t *p, size_t available, int64_t *result, pl_vm_size_t *size) {
+    uint64_t value;
+    uint8_t last_byte;
+    unsigned int bits;
+    plcrash_error_t err;
+
+    if ((err = plcrash_async_dwarf_decode_leb128(p, available, &value, &last_byte, &bits, size)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Sign bit is 2nd high order bit */
+    if (bits < 64 && (last_byte & 0x40))
+        value |= -(1ULL << bits);
+
+    *result = (int64_t) value;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Read a ULEB128 value from @a location within @a mobj.
+ *
+ * @param mobj The memory object from which the LEB128 data will be read.
+ * @param location A task-relative location within @a mobj.
+ * @param offset Offset to be applied to @a location.
+ * @param result On success, the ULEB128 value.
+ * @param size On success, will be set to the total size of the decoded LEB128 value at @a location, in bytes.
+ */
+plcrash_error_t plcrash::async::plcrash_async_dwarf_read_uleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, uint64_t *result, pl_vm_size_t *size) {
+    /* Validate the starting address once; the remainder of the value is bounded by the end of the mapping */
+    uint8_t *p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, offset, 1);
     if (p == NULL) {
         PLCF_DEBUG("ULEB128 value did not terminate within mapped memory range");
         return PLCRASH_EINVAL;
     }
-    
-    *size = position;
-    return PLCRASH_ESUCCESS;
+
+    return plcrash_async_dwarf_decode_uleb128(p, plcrash_async_dwarf_mobject_available(mobj, p), result, size);
 }
 
 /**
@@ -490,43 +588,14 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_read_uleb128 (plcrash_async_
  * @param size On success, will be set to the total size of the decoded LEB128 value, in bytes.
  */
 plcrash_error_t plcrash::async::plcrash_async_dwarf_read_sleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, int64_t *result, pl_vm_size_t *size) {
-    unsigned int shift = 0;
-    pl_vm_off_t position = 0;
-    *result = 0;
-    
-    uint8_t *p;
-    while ((p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, position + offset, 1)) != NULL) {
-        /* LEB128 uses 7 bits for the number, the final bit to signal completion */
-        uint8_t byte = *p;
-        *result |= ((uint64_t) (byte & 0x7f)) << shift;
-        shift += 7;
-        
-        /* This is used to track length, so we must set it before
-         * potentially terminating the loop below */
-        position++;
-        
-        /* Check for terminating bit */
-        if ((byte & 0x80) == 0)
-            break;
-        
-        /* Check for a ULEB128 larger than 64-bits */
-        if (shift >= 64) {
-            PLCF_DEBUG("ULEB128 is larger than the maximum supported size of 64 bits");
-            return PLCRASH_ENOTSUP;
-        }
-    }
-    
+    /* Validate the starting address once; the remainder of the value is bounded by the end of the mapping */
+    uint8_t *p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, offset, 1);
     if (p == NULL) {
-        PLCF_DEBUG("ULEB128 value did not terminate within mapped memory range");
+        PLCF_DEBUG("SLEB128 value did not terminate within mapped memory range");
         return PLCRASH_EINVAL;
     }
-    
-    /* Sign bit is 2nd high order bit */
-    if (shift < 64 && (*p & 0x40))
-        *result |= -(1ULL << shift);
-    
-    *size = position;
-    return PLCRASH_ESUCCESS;
+
+    return plcrash_async_dwarf_decode_sleb128(p, plcrash_async_dwarf_mobject_available(mobj, p), result, size);
 }
 
 /* Provide explicit 32/64-bit instantiations */
@@ -338,6 +338,9 @@ private:
     base_addr_t _func_base;
 };
 
+plcrash_error_t plcrash_async_dwarf_decode_uleb128 (const uint8_t *p, size_t available, uint64_t *result, pl_vm_size_t *size);
+plcrash_error_t plcrash_async_dwarf_decode_sleb128 (const uint8_t *p, size_t available, int64_t *result, pl_vm_size_t *size);
+
 plcrash_error_t plcrash_async_dwarf_read_uleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, uint64_t *result, pl_vm_size_t *size);
 plcrash_error_t plcrash_async_dwarf_read_sleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, int64_t *result, pl_vm_size_t *size);
 
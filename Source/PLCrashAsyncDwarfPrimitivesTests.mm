@@ -362,6 +362,50 @@ using namespace plcrash::async;
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Test direct decoding of LEB128 values from local memory, covering both the word-at-a-time and bytewise paths.
+ */
+- (void) testDecodeLEB128 {
+    plcrash_error_t err;
+    uint64_t uresult;
+    int64_t sresult;
+    pl_vm_size_t size;
+
+    /* Value terminates within the first word */
+    uint8_t buffer[16] = { 0xE5, 0x8E, 0x26, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    err = plcrash_async_dwarf_decode_uleb128(buffer, sizeof(buffer), &uresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode uleb128");
+    STAssertEquals(uresult, (uint64_t)624485, @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)3, @"Incorrect byte length");
+
+    /* Identical value, with fewer than a word's worth of bytes available */
+    err = plcrash_async_dwarf_decode_uleb128(buffer, 3, &uresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode uleb128");
+    STAssertEquals(uresult, (uint64_t)624485, @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)3, @"Incorrect byte length");
+
+    /* Truncated value */
+    err = plcrash_async_dwarf_decode_uleb128(buffer, 2, &uresult, &size);
+    STAssertEquals(err, PLCRASH_EINVAL, @"Truncated ULEB128 should not be decodable");
+
+    /* Negative SLEB128 */
+    buffer[0] = 0xC0;
+    buffer[1] = 0xBB;
+    buffer[2] = 0x78;
+    err = plcrash_async_dwarf_decode_sleb128(buffer, sizeof(buffer), &sresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode sleb128");
+    STAssertEquals(sresult, (int64_t)-123456, @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)3, @"Incorrect byte length");
+
+    /* Value that does not terminate within the first word */
+    memset(buffer, 0xFF, sizeof(buffer));
+    buffer[9] = 0x01;
+    err = plcrash_async_dwarf_decode_uleb128(buffer, sizeof(buffer), &uresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode uleb128");
+    STAssertEquals(uresult, (uint64_t)UINT64_MAX, @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)10, @"Incorrect byte length");
+}
+
 /**
  * Test direct task-based reading of a ULEB128 value. This uses the same ULEB128 parser as the plcrash_async_dwarf_read_uleb128() code,
  * so we only test that the out-of-process memory read works as expected.
@@ -46,6 +46,41 @@ plcrash_error_t plcrash_async_dynloader_read_image_list (plcrash_async_dynloader
     return loader->readImageList(allocator, image_list);
 }
 
+/**
+ * Equivalent to DynamicLoader::NonAsync_EnableImageListMonitor().
+ */
+plcrash_error_t plcrash_nasync_dynloader_enable_image_monitor (plcrash_async_dynloader_t *loader) {
+    return loader->NonAsync_EnableImageListMonitor();
+}
+
+/**
+ * Equivalent to DynamicLoader::NonAsync_EnableObjCMethodIndex().
+ */
+plcrash_error_t plcrash_nasync_dynloader_enable_objc_method_index (plcrash_async_dynloader_t *loader) {
+    return loader->NonAsync_EnableObjCMethodIndex();
+}
+
+/**
+ * Equivalent to DynamicLoader::NonAsync_EnableIndexCache().
+ */
+plcrash_error_t plcrash_nasync_dynloader_enable_index_cache (plcrash_async_dynloader_t *loader, const char *directory) {
+    return loader->NonAsync_EnableIndexCache(directory);
+}
+
+/**
+ * Equivalent to DynamicLoader::imageUnloadCount().
+ */
+bool plcrash_async_dynloader_image_unload_count (plcrash_async_dynloader_t *loader, uint32_t *count) {
+    return loader->imageUnloadCount(count);
+}
+
+/**
+ * Equivalent to DynamicLoader::imageGeneration().
+ */
+bool plcrash_async_dynloader_image_generation (plcrash_async_dynloader_t *loader, uint32_t *generation) {
+    return loader->imageGeneration(generation);
+}
+
 /**
  * Equivalent to `delete loader`.
  */
@@ -61,6 +96,16 @@ plcrash_error_t plcrash_nasync_image_list_new (plcrash_async_image_list_t **list
     return DynamicLoader::ImageList::NonAsync_Read(list, allocator, task);
 }
 
+/**
+ * Equivalent to DynamicLoader::ImageList::NonAsync_Create(). It the caller's responsibility to deallocate the returned
+ * image list via plcrash_async_image_list_free().
+ */
+plcrash_error_t plcrash_nasync_image_list_new_with_headers (plcrash_async_image_list_t **list, plcrash_async_allocator_t *allocator, task_t task,
+                                                            const pl_vm_address_t *headers, const char * const *names, size_t count)
+{
+    return DynamicLoader::ImageList::NonAsync_Create(list, allocator, task, headers, names, count);
+}
+
 /**
  *
  * Equivalent to DynamicLoader::ImageList(). It the caller's responsibility to deallocate the returned image
@@ -93,6 +138,20 @@ plcrash_async_macho_t *plcrash_async_image_containing_address (plcrash_async_ima
     return list->imageContainingAddress(address);
 }
 
+/**
+ * Equivalent to DynamicLoader::ImageList::indexOfImageContainingAddress().
+ */
+bool plcrash_async_image_list_index_containing_address (plcrash_async_image_list_t *list, pl_vm_address_t address, size_t *index) {
+    return list->indexOfImageContainingAddress(address, index);
+}
+
+/**
+ * Equivalent to DynamicLoader::ImageList::classifyAddresses().
+ */
+size_t plcrash_async_image_list_classify_addresses (plcrash_async_image_list_t *list, const pl_vm_address_t *addresses, size_t count, bool *matches) {
+    return list->classifyAddresses(addresses, count, matches);
+}
+
 /**
  * Equivalent to `delete list`.
  */
@@ -54,16 +54,25 @@ PLCR_C_BEGIN_DECLS
 
 plcrash_error_t plcrash_nasync_dynloader_new (plcrash_async_dynloader_t **loader, plcrash_async_allocator_t *allocator, task_t task);
 plcrash_error_t plcrash_async_dynloader_read_image_list (plcrash_async_dynloader_t *loader, plcrash_async_allocator_t *allocator, plcrash_async_image_list_t **image_list);
+plcrash_error_t plcrash_nasync_dynloader_enable_image_monitor (plcrash_async_dynloader_t *loader);
+plcrash_error_t plcrash_nasync_dynloader_enable_objc_method_index (plcrash_async_dynloader_t *loader);
+plcrash_error_t plcrash_nasync_dynloader_enable_index_cache (plcrash_async_dynloader_t *loader, const char *directory);
+bool plcrash_async_dynloader_image_unload_count (plcrash_async_dynloader_t *loader, uint32_t *count);
+bool plcrash_async_dynloader_image_generation (plcrash_async_dynloader_t *loader, uint32_t *generation);
 void plcrash_async_dynloader_free (plcrash_async_dynloader_t *loader);
 
 
 plcrash_error_t plcrash_nasync_image_list_new (plcrash_async_image_list_t **list, plcrash_async_allocator_t *allocator, task_t task);
+plcrash_error_t plcrash_nasync_image_list_new_with_headers (plcrash_async_image_list_t **list, plcrash_async_allocator_t *allocator, task_t task,
+                                                            const pl_vm_address_t *headers, const char * const *names, size_t count);
 
 plcrash_async_image_list_t *plcrash_async_image_list_new_empty (plcrash_async_allocator_t *allocator);
 
 plcrash_async_macho_t *plcrash_async_image_list_get_image (plcrash_async_image_list_t *list, size_t index);
 size_t plcrash_async_image_list_count (plcrash_async_image_list_t *list);
 plcrash_async_macho_t *plcrash_async_image_containing_address (plcrash_async_image_list_t *list, pl_vm_address_t address);
+bool plcrash_async_image_list_index_containing_address (plcrash_async_image_list_t *list, pl_vm_address_t address, size_t *index);
+size_t plcrash_async_image_list_classify_addresses (plcrash_async_image_list_t *list, const pl_vm_address_t *addresses, size_t count, bool *matches);
 void plcrash_async_image_list_free (plcrash_async_image_list_t *list);
 
 PLCR_C_END_DECLS
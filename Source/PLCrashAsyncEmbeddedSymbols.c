@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncEmbeddedSymbols.h"
+
+#include <inttypes.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @defgroup plcrash_async_embedded_symbols Embedded Symbol Tables
+ *
+ * Implements lookup of symbols from a build-time symbol table embedded within a stripped image.
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Implements plcrash_async_embedded_symbols_find_symbol(), searching the embedded symbol table mapped at @a mobj.
+ */
+static plcrash_error_t plcrash_async_embedded_symbols_find_symbol_mapped (plcrash_async_macho_t *image,
+                                                                         plcrash_async_mobject_t *mobj,
+                                                                         pl_vm_address_t pc,
+                                                                         pl_async_macho_found_symbol_cb symbol_cb,
+                                                                         void *context)
+{
+    /* Validate the header */
+    pl_vm_address_t base = plcrash_async_mobject_base_address(mobj);
+    plcrash_async_embedded_symbols_header_t header;
+    void *ptr;
+
+    if ((ptr = plcrash_async_mobject_remap_address(mobj, base, 0, sizeof(header))) == NULL) {
+        PLCF_DEBUG("Embedded symbol table in %s is too small to contain a header", image->name);
+        return PLCRASH_EINVALID_DATA;
+    }
+    plcrash_async_memcpy(&header, ptr, sizeof(header));
+
+    if (image->byteorder->swap32(header.magic) != PLCRASH_EMBEDDED_SYMBOLS_MAGIC) {
+        PLCF_DEBUG("Embedded symbol table in %s has an invalid magic", image->name);
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    if (image->byteorder->swap32(header.version) != PLCRASH_EMBEDDED_SYMBOLS_VERSION) {
+        PLCF_DEBUG("Embedded symbol table in %s has unsupported version %" PRIu32, image->name, image->byteorder->swap32(header.version));
+        return PLCRASH_ENOTSUP;
+    }
+
+    uint32_t symbol_count = image->byteorder->swap32(header.symbol_count);
+    uint32_t strings_size = image->byteorder->swap32(header.strings_size);
+    pl_vm_off_t entries_offset = sizeof(header);
+    pl_vm_off_t strings_offset = entries_offset + (pl_vm_off_t) symbol_count * sizeof(plcrash_async_embedded_symbol_t);
+
+    const char *strings = plcrash_async_mobject_remap_address(mobj, base, strings_offset, strings_size);
+    if (strings == NULL) {
+        PLCF_DEBUG("Embedded symbol table in %s exceeds its section", image->name);
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    /* Binary search for the last entry at or before the on-disk PC */
+    uint64_t slide_pc = pc - image->vmaddr_slide;
+    plcrash_async_embedded_symbol_t entry;
+    uint32_t lo = 0;
+    uint32_t hi = symbol_count;
+    bool found = false;
+    uint64_t best_address = 0;
+    uint32_t best_name = 0;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        ptr = plcrash_async_mobject_remap_address(mobj, base, entries_offset + (pl_vm_off_t) mid * sizeof(entry), sizeof(entry));
+        if (ptr == NULL)
+            return PLCRASH_EINVALID_DATA;
+        plcrash_async_memcpy(&entry, ptr, sizeof(entry));
+
+        uint64_t address = image->byteorder->swap64(entry.address);
+        if (address <= slide_pc) {
+            found = true;
+            best_address = address;
+            best_name = image->byteorder->swap32(entry.name_offset);
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (!found)
+        return PLCRASH_ENOTFOUND;
+
+    /* Verify that the name is NUL-terminated within the string table */
+    bool terminated = false;
+    for (uint32_t i = best_name; i < strings_size; i++) {
+        if (strings[i] == '\0') {
+            terminated = true;
+            break;
+        }
+    }
+
+    if (!terminated) {
+        PLCF_DEBUG("Embedded symbol name offset %" PRIu32 " is outside of the string table", best_name);
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    symbol_cb((pl_vm_address_t) best_address + image->vmaddr_slide, strings + best_name, context);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Attempt to locate the best-matching symbol for @a pc within @a image, using the symbol table embedded in the
+ * image's PLCRASH_EMBEDDED_SYMBOLS_SEGMENT,PLCRASH_EMBEDDED_SYMBOLS_SECTION section, if any.
+ *
+ * The table is sorted by address, and is binary searched for the closest symbol preceding @a pc; all reads are
+ * bounds-checked against the section mapping.
+ *
+ * @param section_cache The section cache to be used to map the embedded symbol table, or NULL.
+ * @param image The Mach-O image containing @a pc.
+ * @param pc The PC value within the target process for which symbol information should be found.
+ * @param symbol_cb A callback to be called if the symbol is found.
+ * @param context Context to be passed to @a symbol_cb.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the symbol is found. If the image has no embedded symbol table, or no symbol
+ * precedes @a pc, @a symbol_cb will not be called, and PLCRASH_ENOTFOUND (or another plcrash_error_t error value)
+ * will be returned.
+ */
+plcrash_error_t plcrash_async_embedded_symbols_find_symbol (plcrash_async_macho_section_cache_t *section_cache,
+                                                            plcrash_async_macho_t *image,
+                                                            pl_vm_address_t pc,
+                                                            pl_async_macho_found_symbol_cb symbol_cb,
+                                                            void *context)
+{
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *mobj;
+    plcrash_error_t err;
+
+    /* If a section cache is supplied, the mapping is shared across all lookups within the report */
+    err = plcrash_async_macho_section_cache_map(section_cache, image, PLCRASH_EMBEDDED_SYMBOLS_SEGMENT, PLCRASH_EMBEDDED_SYMBOLS_SECTION, &storage, &mobj);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    err = plcrash_async_embedded_symbols_find_symbol_mapped(image, mobj, pc, symbol_cb, context);
+    plcrash_async_macho_section_cache_unmap(section_cache, mobj);
+
+    return err;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_EMBEDDED_SYMBOLS_H
+#define PLCRASH_ASYNC_EMBEDDED_SYMBOLS_H
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @{
+ */
+
+/** The segment name of the embedded symbol table section. */
+#define PLCRASH_EMBEDDED_SYMBOLS_SEGMENT "__PLCRASH"
+
+/** The section name of the embedded symbol table section. */
+#define PLCRASH_EMBEDDED_SYMBOLS_SECTION "__syms"
+
+/** The embedded symbol table magic ('plsy'). */
+#define PLCRASH_EMBEDDED_SYMBOLS_MAGIC 0x706c7379
+
+/** The current embedded symbol table format version. */
+#define PLCRASH_EMBEDDED_SYMBOLS_VERSION 1
+
+/**
+ * @internal
+ *
+ * The embedded symbol table header.
+ *
+ * Stripped binaries retain no symbol names for their own (non-exported) functions. The plcrashutil embed-symbols
+ * command extracts these names from the unstripped binary prior to stripping, and the resulting table is linked
+ * into the final binary's PLCRASH_EMBEDDED_SYMBOLS_SEGMENT,PLCRASH_EMBEDDED_SYMBOLS_SECTION section.
+ *
+ * The header is followed by @a symbol_count plcrash_async_embedded_symbol_t entries, sorted by address, and then
+ * by a string table of @a strings_size bytes. All values are in the image's byte order.
+ */
+typedef struct plcrash_async_embedded_symbols_header {
+    /** PLCRASH_EMBEDDED_SYMBOLS_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_EMBEDDED_SYMBOLS_VERSION. */
+    uint32_t version;
+
+    /** The number of symbol entries following the header. */
+    uint32_t symbol_count;
+
+    /** The size, in bytes, of the string table following the symbol entries. */
+    uint32_t strings_size;
+} plcrash_async_embedded_symbols_header_t;
+
+/**
+ * @internal
+ *
+ * An embedded symbol table entry.
+ */
+typedef struct plcrash_async_embedded_symbol {
+    /** The symbol's unslid address, as recorded in the binary's symbol table. */
+    uint64_t address;
+
+    /** The offset of the symbol's NUL-terminated name within the string table. */
+    uint32_t name_offset;
+
+    /** Reserved; must be zero. */
+    uint32_t reserved;
+} plcrash_async_embedded_symbol_t;
+
+plcrash_error_t plcrash_async_embedded_symbols_find_symbol (plcrash_async_macho_section_cache_t *section_cache,
+                                                            plcrash_async_macho_t *image,
+                                                            pl_vm_address_t pc,
+                                                            pl_async_macho_found_symbol_cb symbol_cb,
+                                                            void *context);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_EMBEDDED_SYMBOLS_H */
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import <dlfcn.h>
+#import <objc/runtime.h>
+
+#import "PLCrashAsyncEmbeddedSymbols.h"
+
+/**
+ * An embedded symbol table, linked into the test bundle's own embedded symbols section. The addresses need not
+ * correspond to real code, as lookups are performed purely against the table.
+ */
+static const struct {
+    plcrash_async_embedded_symbols_header_t header;
+    plcrash_async_embedded_symbol_t symbols[3];
+    char strings[20];
+} test_embedded_symbols __attribute__((used, section(PLCRASH_EMBEDDED_SYMBOLS_SEGMENT "," PLCRASH_EMBEDDED_SYMBOLS_SECTION))) = {
+    { PLCRASH_EMBEDDED_SYMBOLS_MAGIC, PLCRASH_EMBEDDED_SYMBOLS_VERSION, 3, 20 },
+    {
+        { 0x1000, 0, 0 },
+        { 0x2000, 6, 0 },
+        { 0x3000, 13, 0 },
+    },
+    "first\0second\0third"
+};
+
+/** Symbol lookup results. */
+struct embedded_symbol_result {
+    bool found;
+    pl_vm_address_t address;
+    char name[32];
+};
+
+static void found_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    struct embedded_symbol_result *result = ctx;
+    result->found = true;
+    result->address = address;
+    strlcpy(result->name, name, sizeof(result->name));
+}
+
+@interface PLCrashAsyncEmbeddedSymbolsTests : SenTestCase {
+    /** Allocator used by our image. */
+    plcrash_async_allocator_t *_allocator;
+
+    /** The test bundle's image. */
+    plcrash_async_macho_t _image;
+}
+@end
+
+@implementation PLCrashAsyncEmbeddedSymbolsTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+
+    Dl_info info;
+    STAssertTrue(dladdr((void *) class_getMethodImplementation([self class], _cmd), &info) > 0, @"Could not fetch dyld info");
+    STAssertEquals(plcrash_async_macho_init(&_image, _allocator, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS, @"Failed to initialize image");
+}
+
+- (void) tearDown {
+    plcrash_async_macho_free(&_image);
+    plcrash_async_allocator_free(_allocator);
+}
+
+/** Look up @a address, relative to the image's slide. */
+- (plcrash_error_t) lookup: (pl_vm_address_t) address result: (struct embedded_symbol_result *) result {
+    memset(result, 0, sizeof(*result));
+    return plcrash_async_embedded_symbols_find_symbol(NULL, &_image, address + _image.vmaddr_slide, found_symbol_cb, result);
+}
+
+/**
+ * Verify that lookups return the closest preceding symbol.
+ */
+- (void) testFindSymbol {
+    struct embedded_symbol_result result;
+
+    STAssertEquals([self lookup: 0x1000 result: &result], PLCRASH_ESUCCESS, @"Lookup failed");
+    STAssertEquals(result.address, (pl_vm_address_t) (0x1000 + _image.vmaddr_slide), @"Incorrect address");
+    STAssertTrue(strcmp(result.name, "first") == 0, @"Incorrect name: %s", result.name);
+
+    STAssertEquals([self lookup: 0x2ffe result: &result], PLCRASH_ESUCCESS, @"Lookup failed");
+    STAssertEquals(result.address, (pl_vm_address_t) (0x2000 + _image.vmaddr_slide), @"Incorrect address");
+    STAssertTrue(strcmp(result.name, "second") == 0, @"Incorrect name: %s", result.name);
+
+    STAssertEquals([self lookup: 0x10000 result: &result], PLCRASH_ESUCCESS, @"Lookup failed");
+    STAssertTrue(strcmp(result.name, "third") == 0, @"Incorrect name: %s", result.name);
+}
+
+/**
+ * Verify that addresses preceding the first symbol are not matched.
+ */
+- (void) testSymbolNotFound {
+    struct embedded_symbol_result result;
+
+    STAssertEquals([self lookup: 0xfff result: &result], PLCRASH_ENOTFOUND, @"Lookup should fail");
+    STAssertFalse(result.found, @"Callback should not have been called");
+}
+
+@end
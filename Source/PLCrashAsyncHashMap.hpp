@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_HASH_MAP_H
+#define PLCRASH_ASYNC_HASH_MAP_H 1
+
+#include "PLCrashAsync.h"
+#include "PLCrashMacros.h"
+#include "AsyncAllocator.hpp"
+
+#include <stdint.h>
+
+PLCR_CPP_BEGIN_ASYNC_NS
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The default async_hash_map hash function, supporting integer and pointer keys.
+ *
+ * The key is mixed with the 64-bit MurmurHash3 finalizer, ensuring that keys differing only in their high or low
+ * bits -- such as aligned addresses -- are distributed across the table.
+ *
+ * @tparam K The key type.
+ */
+template <typename K>
+struct async_hash {
+    uint64_t operator() (const K &key) const {
+        uint64_t h = (uint64_t) key;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * An async-safe, fixed capacity, open-addressing hash map.
+ *
+ * Entries are stored inline in a power-of-two table of @a Capacity slots, and collisions are resolved via linear
+ * probing. Removal uses backward-shift deletion, and no tombstones are left behind; probe sequences remain as short
+ * as the table's current contents allow, regardless of how many entries have been removed.
+ *
+ * Lookup, insertion, and removal perform no allocation, and are async-safe. Insertion fails once the table reaches
+ * its maximum load of 3/4 of the table's capacity, bounding the length of any probe sequence.
+ *
+ * Tables that are populated outside of the crash path may be grown via nasync_insert() or nasync_reserve(), which
+ * rehash the table into storage allocated from an AsyncAllocator. Neither method is async-safe.
+ *
+ * The map performs no internal synchronization; concurrent access must be externally synchronized.
+ *
+ * @tparam K The key type. Must be a POD type supporting equality comparison.
+ * @tparam V The value type. Must be a POD type.
+ * @tparam Capacity The number of inline table slots. Must be a power of two, and at least 4.
+ * @tparam Hash The key hash function.
+ */
+template <typename K, typename V, size_t Capacity, typename Hash = async_hash<K> >
+class async_hash_map {
+    static_assert(Capacity >= 4 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two, and at least 4");
+
+private:
+    /** A single table slot. */
+    struct slot {
+        /** The entry key. Only valid if used is true. */
+        K key;
+
+        /** The entry value. Only valid if used is true. */
+        V value;
+
+        /** True if this slot holds an entry. */
+        bool used;
+    };
+
+public:
+    /**
+     * Construct an empty map backed by its inline table.
+     */
+    async_hash_map () : _slots(_inline), _mask(Capacity - 1), _count(0), _allocator(NULL) {
+        for (size_t i = 0; i < Capacity; i++)
+            _inline[i].used = false;
+    }
+
+    ~async_hash_map () {
+        if (_allocator != NULL)
+            _allocator->dealloc(_slots);
+    }
+
+    /**
+     * Return the number of entries in the map.
+     */
+    size_t count () const {
+        return _count;
+    }
+
+    /**
+     * Return the total number of table slots. At most 3/4 of these slots may be populated.
+     */
+    size_t capacity () const {
+        return _mask + 1;
+    }
+
+    /**
+     * Return a borrowed reference to the value for @a key, or NULL if @a key is not in the map. The reference is
+     * invalidated by any subsequent modification of the map.
+     *
+     * @param key The key to look up.
+     *
+     * @warning This method is async-safe.
+     */
+    V *find (const K &key) {
+        size_t idx;
+        if (!lookup(key, &idx))
+            return NULL;
+        return &_slots[idx].value;
+    }
+
+    /**
+     * Fetch the value for @a key.
+     *
+     * @param key The key to look up.
+     * @param value On success, will be populated with the value for @a key. May be NULL.
+     *
+     * @return Returns true if @a key was found in the map, false otherwise.
+     *
+     * @warning This method is async-safe.
+     */
+    bool get (const K &key, V *value) const {
+        size_t idx;
+        if (!lookup(key, &idx))
+            return false;
+
+        if (value != NULL)
+            *value = _slots[idx].value;
+        return true;
+    }
+
+    /**
+     * Insert @a value for @a key, replacing any existing value.
+     *
+     * @param key The entry key.
+     * @param value The entry value.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if @a key is not already in the map and the map
+     * has reached its maximum load.
+     *
+     * @warning This method is async-safe.
+     */
+    plcrash_error_t insert (const K &key, const V &value) {
+        size_t idx;
+        if (lookup(key, &idx)) {
+            _slots[idx].value = value;
+            return PLCRASH_ESUCCESS;
+        }
+
+        if (_count + 1 > max_load(_mask + 1))
+            return PLCRASH_ENOMEM;
+
+        /* lookup() terminates at the first free slot in the key's probe sequence */
+        _slots[idx].key = key;
+        _slots[idx].value = value;
+        _slots[idx].used = true;
+        _count++;
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    /**
+     * Remove the entry for @a key, if any.
+     *
+     * @param key The key to remove.
+     *
+     * @return Returns true if an entry was removed, false if @a key was not in the map.
+     *
+     * @warning This method is async-safe.
+     */
+    bool remove (const K &key) {
+        size_t hole;
+        if (!lookup(key, &hole))
+            return false;
+
+        /* Shift any displaced entries in the following run back into the hole, so that every remaining entry is still
+         * reachable from its home slot without passing a free slot. */
+        size_t idx = hole;
+        while (true) {
+            idx = (idx + 1) & _mask;
+            if (!_slots[idx].used)
+                break;
+
+            /* An entry may only fill the hole if the hole lies (cyclically) between its home slot and its current slot */
+            size_t home = home_slot(_slots[idx].key);
+            if (((idx - home) & _mask) < ((idx - hole) & _mask))
+                continue;
+
+            _slots[hole] = _slots[idx];
+            hole = idx;
+        }
+
+        _slots[hole].used = false;
+        _count--;
+
+        return true;
+    }
+
+    /**
+     * Remove all entries from the map. Any table allocated via nasync_reserve() is retained.
+     *
+     * @warning This method is async-safe.
+     */
+    void clear () {
+        for (size_t i = 0; i <= _mask; i++)
+            _slots[i].used = false;
+        _count = 0;
+    }
+
+    /**
+     * Iterate over all entries in the map, in table order, calling @a fn with the key and value of each entry.
+     * The map must not be modified during iteration.
+     *
+     * @param fn A callable accepting (const K &, V &).
+     *
+     * @warning This method is async-safe if @a fn is async-safe.
+     */
+    template <typename F> void for_each (F fn) {
+        for (size_t i = 0; i <= _mask; i++) {
+            if (_slots[i].used)
+                fn(_slots[i].key, _slots[i].value);
+        }
+    }
+
+    /**
+     * Grow the table as necessary to hold at least @a count entries without exceeding the maximum load, rehashing
+     * all existing entries into storage allocated from @a allocator.
+     *
+     * @param allocator The allocator from which the table will be allocated. Once a table has been allocated, all
+     * future growth must use the same allocator, which must outlive the map.
+     * @param count The number of entries to reserve space for.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or an error if the table could not be allocated; on failure, the map
+     * is left unmodified.
+     *
+     * @warning This method is not async-safe.
+     */
+    plcrash_error_t nasync_reserve (AsyncAllocator *allocator, size_t count) {
+        PLCF_ASSERT(_allocator == NULL || _allocator == allocator);
+
+        size_t size = _mask + 1;
+        while (max_load(size) < count)
+            size *= 2;
+
+        if (size == _mask + 1)
+            return PLCRASH_ESUCCESS;
+
+        /* Allocate and clear the new table */
+        slot *slots;
+        plcrash_error_t err = allocator->alloc((void **) &slots, sizeof(slot) * size);
+        if (err != PLCRASH_ESUCCESS)
+            return err;
+
+        for (size_t i = 0; i < size; i++)
+            slots[i].used = false;
+
+        /* Rehash our existing entries */
+        slot *old_slots = _slots;
+        size_t old_size = _mask + 1;
+
+        _slots = slots;
+        _mask = size - 1;
+        _count = 0;
+
+        for (size_t i = 0; i < old_size; i++) {
+            if (!old_slots[i].used)
+                continue;
+
+            err = insert(old_slots[i].key, old_slots[i].value);
+            PLCF_ASSERT(err == PLCRASH_ESUCCESS);
+        }
+
+        if (_allocator != NULL)
+            _allocator->dealloc(old_slots);
+        _allocator = allocator;
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    /**
+     * Insert @a value for @a key, replacing any existing value, and doubling the table size via @a allocator if the
+     * map has reached its maximum load.
+     *
+     * @param allocator The allocator from which a larger table will be allocated, if required. See nasync_reserve().
+     * @param key The entry key.
+     * @param value The entry value.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or an error if a larger table was required and could not be
+     * allocated.
+     *
+     * @warning This method is not async-safe.
+     */
+    plcrash_error_t nasync_insert (AsyncAllocator *allocator, const K &key, const V &value) {
+        if (_count + 1 > max_load(_mask + 1) && !lookup(key, NULL)) {
+            plcrash_error_t err = nasync_reserve(allocator, _count + 1);
+            if (err != PLCRASH_ESUCCESS)
+                return err;
+        }
+
+        return insert(key, value);
+    }
+
+private:
+    /** Return the maximum number of entries that may be held by a table of @a size slots. */
+    static size_t max_load (size_t size) {
+        return (size / 4) * 3;
+    }
+
+    /** Return the home slot for @a key. */
+    size_t home_slot (const K &key) const {
+        return (size_t) (Hash()(key) & _mask);
+    }
+
+    /**
+     * Search for @a key. If found, returns true and sets @a idx to the key's slot. Otherwise, returns false and sets
+     * @a idx to the first free slot in the key's probe sequence. @a idx may be NULL.
+     */
+    bool lookup (const K &key, size_t *idx) const {
+        size_t i = home_slot(key);
+
+        /* The maximum load guarantees that a free slot exists, terminating the probe */
+        while (_slots[i].used) {
+            if (_slots[i].key == key) {
+                if (idx != NULL)
+                    *idx = i;
+                return true;
+            }
+
+            i = (i + 1) & _mask;
+        }
+
+        if (idx != NULL)
+            *idx = i;
+        return false;
+    }
+
+    /* Copying would alias the allocated table */
+    async_hash_map (const async_hash_map &);
+    async_hash_map &operator= (const async_hash_map &);
+
+    /** The inline table. Unused once a larger table has been allocated. */
+    slot _inline[Capacity];
+
+    /** The current table; either _inline, or a table allocated from _allocator. */
+    slot *_slots;
+
+    /** The current table size, minus one. */
+    size_t _mask;
+
+    /** The number of entries in the map. */
+    size_t _count;
+
+    /** The allocator backing _slots, or NULL if the inline table is in use. */
+    AsyncAllocator *_allocator;
+};
+
+PLCR_CPP_END_ASYNC_NS
+
+#endif /* PLCRASH_ASYNC_HASH_MAP_H */
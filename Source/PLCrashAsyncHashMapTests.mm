@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncHashMap.hpp"
+
+#import <mach/mach_time.h>
+
+using namespace plcrash::async;
+
+/** Hash function that maps every key to the same slot, forcing all entries into a single probe sequence. */
+struct collide_hash {
+    uint64_t operator() (const uintptr_t &key) const {
+        return 0;
+    }
+};
+
+/** Number of entries populated by the lookup benchmark. */
+#define BENCH_ENTRIES 768
+
+/** Number of lookups performed by the lookup benchmark. */
+#define BENCH_LOOKUPS (1024 * 1024)
+
+@interface PLCrashAsyncHashMapTests : SenTestCase {
+    AsyncAllocator *_allocator;
+}
+@end
+
+/**
+ * Tests for the async_hash_map implementation.
+ */
+@implementation PLCrashAsyncHashMapTests
+
+- (void) setUp {
+    STAssertEquals(AsyncAllocator::Create(&_allocator, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to create allocator");
+}
+
+- (void) tearDown {
+    delete _allocator;
+}
+
+- (void) testInsertAndGet {
+    async_hash_map<uintptr_t, int, 16> map;
+    int value;
+
+    STAssertEquals(map.count(), (size_t) 0, @"Map should be empty");
+    STAssertFalse(map.get(1, &value), @"Lookup in an empty map should fail");
+
+    STAssertEquals(map.insert(1, 10), PLCRASH_ESUCCESS, @"Insert failed");
+    STAssertEquals(map.insert(2, 20), PLCRASH_ESUCCESS, @"Insert failed");
+    STAssertEquals(map.count(), (size_t) 2, @"Incorrect count");
+
+    STAssertTrue(map.get(1, &value), @"Lookup failed");
+    STAssertEquals(value, 10, @"Incorrect value");
+    STAssertTrue(map.get(2, &value), @"Lookup failed");
+    STAssertEquals(value, 20, @"Incorrect value");
+    STAssertFalse(map.get(3, &value), @"Lookup of a missing key should fail");
+
+    /* Replacing a value must not add an entry */
+    STAssertEquals(map.insert(1, 11), PLCRASH_ESUCCESS, @"Replace failed");
+    STAssertEquals(map.count(), (size_t) 2, @"Incorrect count");
+    STAssertEquals(*map.find(1), 11, @"Incorrect value");
+    STAssertNULL(map.find(3), @"Lookup of a missing key should return NULL");
+}
+
+- (void) testMaximumLoad {
+    async_hash_map<uintptr_t, int, 16> map;
+
+    /* The map accepts entries up to 3/4 of its capacity */
+    for (uintptr_t i = 0; i < 12; i++)
+        STAssertEquals(map.insert(i, (int) i), PLCRASH_ESUCCESS, @"Insert failed");
+
+    STAssertEquals(map.insert(12, 12), PLCRASH_ENOMEM, @"Insert beyond the maximum load should fail");
+    STAssertEquals(map.insert(0, 100), PLCRASH_ESUCCESS, @"Replacing a value in a full map should succeed");
+    STAssertEquals(map.count(), (size_t) 12, @"Incorrect count");
+    STAssertEquals(map.capacity(), (size_t) 16, @"The inline table should not have grown");
+}
+
+- (void) testRemove {
+    async_hash_map<uintptr_t, int, 16, collide_hash> map;
+    int value;
+
+    /* All entries share a single probe sequence, exercising the backward shift of displaced entries */
+    for (uintptr_t i = 0; i < 8; i++)
+        map.insert(i, (int) i);
+
+    STAssertTrue(map.remove(3), @"Remove failed");
+    STAssertFalse(map.remove(3), @"Removing a missing key should fail");
+    STAssertEquals(map.count(), (size_t) 7, @"Incorrect count");
+
+    for (uintptr_t i = 0; i < 8; i++) {
+        if (i == 3) {
+            STAssertFalse(map.get(i, &value), @"Removed key should not be found");
+        } else {
+            STAssertTrue(map.get(i, &value), @"Displaced key should still be found");
+            STAssertEquals(value, (int) i, @"Incorrect value");
+        }
+    }
+
+    /* Repeated insertion and removal must not exhaust the table */
+    for (uintptr_t i = 100; i < 1000; i++) {
+        STAssertEquals(map.insert(i, (int) i), PLCRASH_ESUCCESS, @"Insert failed");
+        STAssertTrue(map.remove(i), @"Remove failed");
+    }
+    STAssertEquals(map.count(), (size_t) 7, @"Incorrect count");
+
+    map.clear();
+    STAssertEquals(map.count(), (size_t) 0, @"Map should be empty");
+    STAssertFalse(map.get(0, &value), @"Cleared key should not be found");
+}
+
+- (void) testNonAsyncGrowth {
+    async_hash_map<uintptr_t, uintptr_t, 4> map;
+    uintptr_t value;
+
+    for (uintptr_t i = 0; i < 1000; i++)
+        STAssertEquals(map.nasync_insert(_allocator, i * PAGE_SIZE, i), PLCRASH_ESUCCESS, @"Insert failed");
+
+    STAssertEquals(map.count(), (size_t) 1000, @"Incorrect count");
+    STAssertTrue(map.capacity() >= 1000, @"The table should have grown");
+
+    for (uintptr_t i = 0; i < 1000; i++) {
+        STAssertTrue(map.get(i * PAGE_SIZE, &value), @"Lookup failed");
+        STAssertEquals(value, i, @"Incorrect value");
+    }
+
+    /* Reserving less than the current capacity is a no-op */
+    size_t capacity = map.capacity();
+    STAssertEquals(map.nasync_reserve(_allocator, 10), PLCRASH_ESUCCESS, @"Reserve failed");
+    STAssertEquals(map.capacity(), capacity, @"The table should not have changed");
+}
+
+- (void) testForEach {
+    async_hash_map<uintptr_t, uintptr_t, 16> map;
+    __block uintptr_t keys = 0;
+    __block uintptr_t values = 0;
+
+    for (uintptr_t i = 1; i <= 10; i++)
+        map.insert(i, i * 2);
+
+    map.for_each(^(const uintptr_t &key, uintptr_t &value) {
+        keys += key;
+        values += value;
+    });
+
+    STAssertEquals(keys, (uintptr_t) 55, @"Incorrect key sum");
+    STAssertEquals(values, (uintptr_t) 110, @"Incorrect value sum");
+}
+
+/**
+ * Compare lookup latency against a linear scan of the same entries. Results are reported via NSLog(); the test
+ * verifies only that every lookup succeeded.
+ */
+- (void) testBenchmarkLookup {
+    async_hash_map<uintptr_t, uintptr_t, 1024> map;
+    uintptr_t *keys = (uintptr_t *) malloc(sizeof(uintptr_t) * BENCH_ENTRIES);
+    mach_timebase_info_data_t timebase;
+    uintptr_t sum;
+    uint64_t start;
+
+    mach_timebase_info(&timebase);
+
+    /* Use page aligned keys, as is typical of image and region addresses */
+    for (size_t i = 0; i < BENCH_ENTRIES; i++) {
+        keys[i] = (uintptr_t) (i + 1) * PAGE_SIZE;
+        STAssertEquals(map.insert(keys[i], i), PLCRASH_ESUCCESS, @"Insert failed");
+    }
+
+    /* Hash map lookups */
+    sum = 0;
+    start = mach_absolute_time();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        uintptr_t value;
+        if (map.get(keys[(i * 7) % BENCH_ENTRIES], &value))
+            sum += value + 1;
+    }
+    uint64_t map_ns = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+    STAssertTrue(sum >= BENCH_LOOKUPS, @"Lookups failed");
+
+    /* Linear scan lookups */
+    sum = 0;
+    start = mach_absolute_time();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        uintptr_t key = keys[(i * 7) % BENCH_ENTRIES];
+        for (size_t j = 0; j < BENCH_ENTRIES; j++) {
+            if (keys[j] == key) {
+                sum += j + 1;
+                break;
+            }
+        }
+    }
+    uint64_t scan_ns = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+
+    NSLog(@"async_hash_map (%d entries): %llu ns/lookup; linear scan: %llu ns/lookup", BENCH_ENTRIES,
+          (unsigned long long) (map_ns / BENCH_LOOKUPS), (unsigned long long) (scan_ns / BENCH_LOOKUPS));
+
+    free(keys);
+}
+
+@end
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncImageIndexCache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libkern/OSAtomic.h>
+#include <mach-o/loader.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @defgroup plcrash_async_image_index_cache Persistent Image Index Cache
+ *
+ * Persists the symbol and ObjC method indexes built for an image, keyed by the image's LC_UUID, allowing later
+ * launches to load the indexes directly rather than rebuilding them from the image's symbol table and ObjC metadata.
+ * @{
+ */
+
+/** The number of ObjC method entries slid and written per write() call when storing a cache file. */
+#define INDEX_CACHE_WRITE_BATCH 128
+
+/**
+ * @internal
+ *
+ * Populate @a header with the identifying fields of @a image.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOTSUP if @a image has no LC_UUID, in which case its
+ * indexes can not be cached.
+ */
+static plcrash_error_t plcrash_image_index_cache_header_init (plcrash_async_image_index_cache_header_t *header, plcrash_async_macho_t *image) {
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid == NULL)
+        return PLCRASH_ENOTSUP;
+
+    memset(header, 0, sizeof(*header));
+    header->magic = PLCRASH_IMAGE_INDEX_CACHE_MAGIC;
+    header->version = PLCRASH_IMAGE_INDEX_CACHE_VERSION;
+    memcpy(header->uuid, uuid->uuid, sizeof(header->uuid));
+    header->cpu_type = image->byteorder->swap32(image->header.cputype);
+    header->cpu_subtype = image->byteorder->swap32(image->header.cpusubtype);
+    header->symbol_entry_size = sizeof(plcrash_async_macho_symbol_index_entry_t);
+    header->objc_method_entry_size = sizeof(plcrash_async_objc_method_index_entry_t);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Format the path of @a image's cache file within @a directory into @a path.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if @a image has no LC_UUID, or PLCRASH_ENOMEM if the
+ * path exceeds @a path_size.
+ */
+static plcrash_error_t plcrash_image_index_cache_path (plcrash_async_macho_t *image, const char *directory, char *path, size_t path_size) {
+    plcrash_async_image_index_cache_header_t header;
+    plcrash_error_t err;
+
+    if ((err = plcrash_image_index_cache_header_init(&header, image)) != PLCRASH_ESUCCESS)
+        return err;
+
+    int len = snprintf(path, path_size, "%s/%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x-%" PRIx32 ".%s",
+                       directory,
+                       header.uuid[0], header.uuid[1], header.uuid[2], header.uuid[3], header.uuid[4], header.uuid[5],
+                       header.uuid[6], header.uuid[7], header.uuid[8], header.uuid[9], header.uuid[10], header.uuid[11],
+                       header.uuid[12], header.uuid[13], header.uuid[14], header.uuid[15],
+                       (uint32_t) header.cpu_type, PLCRASH_IMAGE_INDEX_CACHE_EXTENSION);
+    if (len < 0 || (size_t) len >= path_size)
+        return PLCRASH_ENOMEM;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Read exactly @a len bytes at @a offset from @a fd.
+ */
+static bool plcrash_image_index_cache_pread (int fd, void *buf, size_t len, off_t offset) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t ret = pread(fd, p, len, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        p += ret;
+        offset += ret;
+        len -= (size_t) ret;
+    }
+
+    return true;
+}
+
+/**
+ * Load @a image's symbol and ObjC method indexes from the index cache in @a directory, publishing any index that
+ * has not already been built.
+ *
+ * The cache file is validated against @a image's UUID and CPU type, the current file version, and the entry
+ * layout of the current process; the entry counts are validated against the file's size. The entries themselves
+ * are read directly into storage allocated from the image's allocator, without parsing.
+ *
+ * @param image The image for which indexes should be loaded.
+ * @param directory The cache directory.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the cache was loaded, PLCRASH_ENOTFOUND if no cache file exists, PLCRASH_EINVAL
+ * if the cache file is stale or invalid, PLCRASH_ENOTSUP if @a image has no LC_UUID, or another error on failure. On
+ * failure, @a image is left unmodified.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with itself or with the index builders
+ * for the same @a image. It may be called concurrently with crash-time lookups; each index is only published once it
+ * has been fully populated.
+ */
+plcrash_error_t plcrash_nasync_image_index_cache_load (plcrash_async_macho_t *image, const char *directory) {
+    plcrash_async_image_index_cache_header_t expected;
+    plcrash_async_image_index_cache_header_t header;
+    plcrash_async_macho_symbol_index_entry_t *symbols = NULL;
+    plcrash_async_objc_method_index_entry_t *methods = NULL;
+    char path[PATH_MAX];
+    plcrash_error_t err;
+    struct stat sb;
+    int fd;
+
+    if ((err = plcrash_image_index_cache_header_init(&expected, image)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_image_index_cache_path(image, directory, path, sizeof(path))) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return (errno == ENOENT) ? PLCRASH_ENOTFOUND : PLCRASH_OUTPUT_ERR;
+
+    /* Validate the header */
+    if (fstat(fd, &sb) != 0 || !plcrash_image_index_cache_pread(fd, &header, sizeof(header), 0)) {
+        err = PLCRASH_EINVAL;
+        goto cleanup;
+    }
+
+    if (header.magic != expected.magic || header.version != expected.version ||
+        memcmp(header.uuid, expected.uuid, sizeof(header.uuid)) != 0 ||
+        header.cpu_type != expected.cpu_type || header.cpu_subtype != expected.cpu_subtype ||
+        header.symbol_entry_size != expected.symbol_entry_size ||
+        header.objc_method_entry_size != expected.objc_method_entry_size)
+    {
+        PLCF_DEBUG("Ignoring stale index cache for %s", image->name);
+        err = PLCRASH_EINVAL;
+        goto cleanup;
+    }
+
+    uint64_t symbols_size = (uint64_t) header.symbol_count * sizeof(symbols[0]);
+    uint64_t methods_size = (uint64_t) header.objc_method_count * sizeof(methods[0]);
+    if ((uint64_t) sb.st_size != sizeof(header) + symbols_size + methods_size) {
+        PLCF_DEBUG("Ignoring truncated index cache for %s", image->name);
+        err = PLCRASH_EINVAL;
+        goto cleanup;
+    }
+
+    /* Read the entries */
+    if (header.symbol_count > 0 && image->symbol_index == NULL) {
+        if ((err = plcrash_async_allocator_alloc(image->_allocator, (void **) &symbols, (size_t) symbols_size)) != PLCRASH_ESUCCESS)
+            goto cleanup;
+
+        if (!plcrash_image_index_cache_pread(fd, symbols, (size_t) symbols_size, sizeof(header))) {
+            err = PLCRASH_EINVAL;
+            goto cleanup;
+        }
+    }
+
+    if (header.objc_method_count > 0 && image->objc_method_index == NULL) {
+        if ((err = plcrash_async_allocator_alloc(image->_allocator, (void **) &methods, (size_t) methods_size)) != PLCRASH_ESUCCESS)
+            goto cleanup;
+
+        if (!plcrash_image_index_cache_pread(fd, methods, (size_t) methods_size, sizeof(header) + symbols_size)) {
+            err = PLCRASH_EINVAL;
+            goto cleanup;
+        }
+
+        /* Apply the image's slide */
+        for (uint32_t i = 0; i < header.objc_method_count; i++) {
+            methods[i].imp += image->vmaddr_slide;
+            methods[i].class_name += image->vmaddr_slide;
+            methods[i].method_name += image->vmaddr_slide;
+        }
+    }
+
+    /* Publish the indexes; each count must be visible before its index pointer */
+    if (symbols != NULL) {
+        image->symbol_index_count = header.symbol_count;
+        OSMemoryBarrier();
+        image->symbol_index = symbols;
+        symbols = NULL;
+    }
+
+    if (methods != NULL) {
+        image->objc_method_index_count = header.objc_method_count;
+        OSMemoryBarrier();
+        image->objc_method_index = methods;
+        methods = NULL;
+    }
+
+    // fall through to cleanup
+    err = PLCRASH_ESUCCESS;
+
+cleanup:
+    if (symbols != NULL)
+        plcrash_async_allocator_dealloc(image->_allocator, symbols);
+    if (methods != NULL)
+        plcrash_async_allocator_dealloc(image->_allocator, methods);
+    close(fd);
+    return err;
+}
+
+/**
+ * @internal
+ *
+ * Write exactly @a len bytes from @a buf to @a fd.
+ */
+static bool plcrash_image_index_cache_write (int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t ret = write(fd, p, len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        p += ret;
+        len -= (size_t) ret;
+    }
+
+    return true;
+}
+
+/**
+ * Write @a image's current symbol and ObjC method indexes to the index cache in @a directory, replacing any existing
+ * cache file for the image. The file is written to a temporary path and then atomically renamed into place; a
+ * concurrent reader will observe either the previous file or the complete new file.
+ *
+ * An image for which no index has been built is stored with no entries, allowing later launches to skip the build.
+ *
+ * @param image The image for which indexes should be stored.
+ * @param directory The cache directory, which must already exist.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if @a image has no LC_UUID, or another error on failure.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with the index builders for the
+ * same @a image.
+ */
+plcrash_error_t plcrash_nasync_image_index_cache_store (plcrash_async_macho_t *image, const char *directory) {
+    plcrash_async_image_index_cache_header_t header;
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX];
+    plcrash_error_t err;
+    int fd;
+
+    if ((err = plcrash_image_index_cache_header_init(&header, image)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_image_index_cache_path(image, directory, path, sizeof(path))) != PLCRASH_ESUCCESS)
+        return err;
+
+    int len = snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int) getpid());
+    if (len < 0 || (size_t) len >= sizeof(tmp_path))
+        return PLCRASH_ENOMEM;
+
+    const plcrash_async_macho_symbol_index_entry_t *symbols = image->symbol_index;
+    const plcrash_async_objc_method_index_entry_t *methods = image->objc_method_index;
+    if (symbols != NULL)
+        header.symbol_count = image->symbol_index_count;
+    if (methods != NULL)
+        header.objc_method_count = image->objc_method_index_count;
+
+    if ((fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0) {
+        PLCF_DEBUG("Could not create index cache file %s: %s", tmp_path, strerror(errno));
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    bool ok = plcrash_image_index_cache_write(fd, &header, sizeof(header));
+    if (ok && header.symbol_count > 0)
+        ok = plcrash_image_index_cache_write(fd, symbols, sizeof(symbols[0]) * header.symbol_count);
+
+    /* ObjC method addresses are stored unslid */
+    for (uint32_t i = 0; ok && i < header.objc_method_count;) {
+        plcrash_async_objc_method_index_entry_t batch[INDEX_CACHE_WRITE_BATCH];
+        uint32_t count = 0;
+
+        for (; count < INDEX_CACHE_WRITE_BATCH && i < header.objc_method_count; count++, i++) {
+            batch[count] = methods[i];
+            batch[count].imp -= image->vmaddr_slide;
+            batch[count].class_name -= image->vmaddr_slide;
+            batch[count].method_name -= image->vmaddr_slide;
+        }
+
+        ok = plcrash_image_index_cache_write(fd, batch, sizeof(batch[0]) * count);
+    }
+
+    if (close(fd) != 0)
+        ok = false;
+
+    if (!ok || rename(tmp_path, path) != 0) {
+        PLCF_DEBUG("Could not write index cache file %s: %s", path, strerror(errno));
+        unlink(tmp_path);
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H
+#define PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @{
+ */
+
+/** The magic value identifying an image index cache file ('plix'). */
+#define PLCRASH_IMAGE_INDEX_CACHE_MAGIC 0x706c6978
+
+/** The current image index cache file version. Files of any other version are ignored, and rebuilt. */
+#define PLCRASH_IMAGE_INDEX_CACHE_VERSION 1
+
+/** The file extension used for image index cache files. */
+#define PLCRASH_IMAGE_INDEX_CACHE_EXTENSION "plindex"
+
+/**
+ * @internal
+ *
+ * The header of an image index cache file.
+ *
+ * The header is directly followed by symbol_count plcrash_async_macho_symbol_index_entry_t entries, and then by
+ * objc_method_count plcrash_async_objc_method_index_entry_t entries, in the native layout and byte order of the
+ * writing process. The header's size is a multiple of 8 bytes, and the file may thus be read or mapped directly,
+ * without parsing. ObjC method entry addresses are stored unslid.
+ */
+typedef struct plcrash_async_image_index_cache_header {
+    /** PLCRASH_IMAGE_INDEX_CACHE_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_IMAGE_INDEX_CACHE_VERSION. */
+    uint32_t version;
+
+    /** The LC_UUID of the indexed image. */
+    uint8_t uuid[16];
+
+    /** The CPU type of the indexed image. */
+    cpu_type_t cpu_type;
+
+    /** The CPU subtype of the indexed image. */
+    cpu_subtype_t cpu_subtype;
+
+    /** sizeof(plcrash_async_macho_symbol_index_entry_t) in the writing process. */
+    uint32_t symbol_entry_size;
+
+    /** sizeof(plcrash_async_objc_method_index_entry_t) in the writing process. */
+    uint32_t objc_method_entry_size;
+
+    /** The number of symbol index entries. */
+    uint32_t symbol_count;
+
+    /** The number of ObjC method index entries. */
+    uint32_t objc_method_count;
+} plcrash_async_image_index_cache_header_t;
+
+plcrash_error_t plcrash_nasync_image_index_cache_load (plcrash_async_macho_t *image, const char *directory);
+plcrash_error_t plcrash_nasync_image_index_cache_store (plcrash_async_macho_t *image, const char *directory);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import <dlfcn.h>
+#import <objc/runtime.h>
+
+#import "PLCrashAsyncImageIndexCache.h"
+#import "PLCrashAsyncObjCSection.h"
+
+@interface PLCrashAsyncImageIndexCacheTests : SenTestCase {
+    /** Allocator used by our images. */
+    plcrash_async_allocator_t *_allocator;
+
+    /** Temporary cache directory. */
+    NSString *_cacheDir;
+
+    /** The image containing our class. */
+    plcrash_async_macho_t _image;
+}
+@end
+
+@implementation PLCrashAsyncImageIndexCacheTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+
+    _cacheDir = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: _cacheDir withIntermediateDirectories: YES attributes: nil error: NULL], @"Could not create cache directory");
+
+    Dl_info info;
+    STAssertTrue(dladdr((void *) class_getMethodImplementation([self class], _cmd), &info) > 0, @"Could not fetch dyld info");
+    STAssertEquals(plcrash_async_macho_init(&_image, _allocator, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS, @"Failed to initialize image");
+}
+
+- (void) tearDown {
+    plcrash_async_macho_free(&_image);
+    plcrash_async_allocator_free(_allocator);
+
+    [[NSFileManager defaultManager] removeItemAtPath: _cacheDir error: NULL];
+    [_cacheDir release];
+}
+
+/** Return the path of the single cache file in our cache directory. */
+- (NSString *) cacheFilePath {
+    NSArray *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath: _cacheDir error: NULL];
+    STAssertEquals([files count], (NSUInteger) 1, @"Expected a single cache file");
+    return [_cacheDir stringByAppendingPathComponent: [files lastObject]];
+}
+
+/**
+ * Verify that cached indexes are loaded identically to the indexes from which they were stored.
+ */
+- (void) testStoreAndLoad {
+    const char *dir = [_cacheDir fileSystemRepresentation];
+
+    STAssertEquals(plcrash_nasync_image_index_cache_load(&_image, dir), PLCRASH_ENOTFOUND, @"Loaded a nonexistent cache");
+
+    STAssertEquals(plcrash_nasync_macho_build_symbol_index(&_image), PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    STAssertEquals(plcrash_nasync_objc_build_method_index(&_image), PLCRASH_ESUCCESS, @"Failed to build method index");
+    STAssertNotNULL(_image.symbol_index, @"No symbol index was built");
+    STAssertNotNULL(_image.objc_method_index, @"No method index was built");
+
+    STAssertEquals(plcrash_nasync_image_index_cache_store(&_image, dir), PLCRASH_ESUCCESS, @"Failed to store cache");
+
+    /* Load into a fresh image */
+    plcrash_async_macho_t image;
+    STAssertEquals(plcrash_async_macho_init(&image, _allocator, mach_task_self(), _image.name, _image.header_addr), PLCRASH_ESUCCESS, @"Failed to initialize image");
+    STAssertEquals(plcrash_nasync_image_index_cache_load(&image, dir), PLCRASH_ESUCCESS, @"Failed to load cache");
+
+    STAssertEquals(image.symbol_index_count, _image.symbol_index_count, @"Incorrect symbol count");
+    STAssertTrue(memcmp(image.symbol_index, _image.symbol_index, sizeof(image.symbol_index[0]) * image.symbol_index_count) == 0, @"Symbol index differs");
+
+    STAssertEquals(image.objc_method_index_count, _image.objc_method_index_count, @"Incorrect method count");
+    for (uint32_t i = 0; i < image.objc_method_index_count; i++) {
+        STAssertEquals(image.objc_method_index[i].imp, _image.objc_method_index[i].imp, @"Incorrect IMP");
+        STAssertEquals(image.objc_method_index[i].class_name, _image.objc_method_index[i].class_name, @"Incorrect class name");
+        STAssertEquals(image.objc_method_index[i].method_name, _image.objc_method_index[i].method_name, @"Incorrect method name");
+    }
+
+    plcrash_async_macho_free(&image);
+}
+
+/**
+ * Verify that stale and truncated cache files are rejected.
+ */
+- (void) testRejectInvalid {
+    const char *dir = [_cacheDir fileSystemRepresentation];
+
+    STAssertEquals(plcrash_nasync_macho_build_symbol_index(&_image), PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    STAssertEquals(plcrash_nasync_image_index_cache_store(&_image, dir), PLCRASH_ESUCCESS, @"Failed to store cache");
+
+    NSString *path = [self cacheFilePath];
+    NSMutableData *data = [NSMutableData dataWithContentsOfFile: path];
+
+    /* Truncated */
+    plcrash_async_macho_t image;
+    [[data subdataWithRange: NSMakeRange(0, [data length] - 1)] writeToFile: path atomically: YES];
+    STAssertEquals(plcrash_async_macho_init(&image, _allocator, mach_task_self(), _image.name, _image.header_addr), PLCRASH_ESUCCESS, @"Failed to initialize image");
+    STAssertEquals(plcrash_nasync_image_index_cache_load(&image, dir), PLCRASH_EINVAL, @"Loaded a truncated cache");
+    STAssertNULL(image.symbol_index, @"Index published from a truncated cache");
+
+    /* Stale version */
+    plcrash_async_image_index_cache_header_t *header = [data mutableBytes];
+    header->version++;
+    [data writeToFile: path atomically: YES];
+    STAssertEquals(plcrash_nasync_image_index_cache_load(&image, dir), PLCRASH_EINVAL, @"Loaded a stale cache");
+    STAssertNULL(image.symbol_index, @"Index published from a stale cache");
+
+    plcrash_async_macho_free(&image);
+}
+
+@end
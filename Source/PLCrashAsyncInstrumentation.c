@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncInstrumentation.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_instrumentation Report Writer Instrumentation
+ *
+ * Implements optional, async-safe recording of the time spent in each phase of writing a report, along with counts
+ * of the expensive operations performed.
+ * @{
+ */
+
+/** The instrumentation installed via plcrash_async_instrumentation_set_current(), or NULL. */
+static plcrash_async_instrumentation_t * volatile current_instrumentation = NULL;
+
+/**
+ * Initialize @a instr, zeroing all timings and counters. This function is async-safe.
+ *
+ * @param instr The instrumentation to initialize.
+ */
+void plcrash_async_instrumentation_init (plcrash_async_instrumentation_t *instr) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_PHASE_COUNT; i++)
+        instr->phase_time[i] = 0;
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_COUNTER_COUNT; i++)
+        instr->counters[i] = 0;
+}
+
+/**
+ * Return the cumulative time recorded for @a phase, in nanoseconds. This function is async-safe.
+ *
+ * @param instr The instrumentation to query.
+ * @param phase The phase to query.
+ */
+uint64_t plcrash_async_instrumentation_phase_ns (const plcrash_async_instrumentation_t *instr, plcrash_async_phase_t phase) {
+    mach_timebase_info_data_t timebase;
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.denom == 0)
+        return 0;
+
+    return ((uint64_t) instr->phase_time[phase] * timebase.numer) / timebase.denom;
+}
+
+/**
+ * Install @a instr as the current instrumentation, or uninstall the current instrumentation if NULL. While installed,
+ * instrumented phases and counters are recorded to @a instr from all threads.
+ *
+ * @param instr The instrumentation to install, or NULL.
+ */
+void plcrash_async_instrumentation_set_current (plcrash_async_instrumentation_t *instr) {
+    OSMemoryBarrier();
+    current_instrumentation = instr;
+    OSMemoryBarrier();
+}
+
+/**
+ * Return the instrumentation installed via plcrash_async_instrumentation_set_current(), or NULL if none.
+ */
+plcrash_async_instrumentation_t *plcrash_async_instrumentation_current (void) {
+    return current_instrumentation;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_INSTRUMENTATION_H
+#define PLCRASH_ASYNC_INSTRUMENTATION_H
+
+#include "PLCrashAsync.h"
+
+#include <libkern/OSAtomic.h>
+#include <mach/mach_time.h>
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_instrumentation
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Instrumented report writing phases.
+ */
+typedef enum {
+    /** Reading the image list. */
+    PLCRASH_ASYNC_PHASE_IMAGE_LIST = 0,
+
+    /** Fetching and suspending the task's threads. */
+    PLCRASH_ASYNC_PHASE_THREAD_SUSPEND,
+
+    /** Unwinding thread stacks; cumulative across all threads (and unwind workers). */
+    PLCRASH_ASYNC_PHASE_UNWIND,
+
+    /** Symbol lookups; cumulative across all frames (and unwind workers). */
+    PLCRASH_ASYNC_PHASE_SYMBOLICATION,
+
+    /** Writing the binary image records. */
+    PLCRASH_ASYNC_PHASE_BINARY_IMAGES,
+
+    /** Writing report data to the output file descriptor. */
+    PLCRASH_ASYNC_PHASE_FLUSH,
+
+    /** The number of defined phases. */
+    PLCRASH_ASYNC_PHASE_COUNT
+} plcrash_async_phase_t;
+
+/**
+ * @internal
+ *
+ * Instrumented event counters.
+ */
+typedef enum {
+    /** Memory objects mapped via plcrash_async_mobject_init(). */
+    PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS = 0,
+
+    /** Calls to plcrash_async_task_memcpy(). */
+    PLCRASH_ASYNC_COUNTER_TASK_MEMCPY,
+
+    /** Allocator pool growth via vm_allocate(). */
+    PLCRASH_ASYNC_COUNTER_ALLOCATOR_GROWS,
+
+    /** The number of defined counters. */
+    PLCRASH_ASYNC_COUNTER_COUNT
+} plcrash_async_counter_t;
+
+/**
+ * @internal
+ *
+ * Phase timings and event counts recorded while an instance is installed via
+ * plcrash_async_instrumentation_set_current().
+ */
+typedef struct plcrash_async_instrumentation {
+    /** Cumulative time spent in each plcrash_async_phase_t, in mach_absolute_time() units. */
+    volatile int64_t phase_time[PLCRASH_ASYNC_PHASE_COUNT];
+
+    /** Event counts, indexed by plcrash_async_counter_t. */
+    volatile int64_t counters[PLCRASH_ASYNC_COUNTER_COUNT];
+} plcrash_async_instrumentation_t;
+
+void plcrash_async_instrumentation_init (plcrash_async_instrumentation_t *instr);
+uint64_t plcrash_async_instrumentation_phase_ns (const plcrash_async_instrumentation_t *instr, plcrash_async_phase_t phase);
+
+void plcrash_async_instrumentation_set_current (plcrash_async_instrumentation_t *instr);
+plcrash_async_instrumentation_t *plcrash_async_instrumentation_current (void);
+
+/**
+ * Begin timing a phase. This function is async-safe.
+ *
+ * @return Returns the phase start time to be passed to plcrash_async_instrumentation_end(), or 0 if no instrumentation
+ * is installed.
+ */
+static inline uint64_t plcrash_async_instrumentation_begin (void) {
+    if (__builtin_expect(plcrash_async_instrumentation_current() == NULL, 1))
+        return 0;
+
+    return mach_absolute_time();
+}
+
+/**
+ * Finish timing @a phase, adding the time elapsed since @a start to the current instrumentation. This
+ * function is async-safe.
+ *
+ * @param phase The phase being timed.
+ * @param start The value returned by plcrash_async_instrumentation_begin().
+ */
+static inline void plcrash_async_instrumentation_end (plcrash_async_phase_t phase, uint64_t start) {
+    plcrash_async_instrumentation_t *instr;
+    if (start == 0 || (instr = plcrash_async_instrumentation_current()) == NULL)
+        return;
+
+    OSAtomicAdd64((int64_t) (mach_absolute_time() - start), &instr->phase_time[phase]);
+}
+
+/**
+ * Increment @a counter in the current instrumentation, if any. This function is async-safe.
+ *
+ * @param counter The counter to increment.
+ */
+static inline void plcrash_async_instrumentation_count (plcrash_async_counter_t counter) {
+    plcrash_async_instrumentation_t *instr = plcrash_async_instrumentation_current();
+    if (__builtin_expect(instr == NULL, 1))
+        return;
+
+    OSAtomicIncrement64(&instr->counters[counter]);
+}
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_INSTRUMENTATION_H */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncInstrumentation.h"
+
+@interface PLCrashAsyncInstrumentationTests : SenTestCase {}
+@end
+
+@implementation PLCrashAsyncInstrumentationTests
+
+- (void) tearDown {
+    plcrash_async_instrumentation_set_current(NULL);
+}
+
+/**
+ * Verify that events are only recorded while an instrumentation instance is installed.
+ */
+- (void) testCountOnlyWhenInstalled {
+    plcrash_async_instrumentation_t instr;
+    plcrash_async_instrumentation_init(&instr);
+
+    /* Not installed */
+    STAssertEquals(plcrash_async_instrumentation_begin(), (uint64_t) 0, @"Phase timing started without instrumentation");
+    plcrash_async_instrumentation_count(PLCRASH_ASYNC_COUNTER_TASK_MEMCPY);
+    STAssertEquals(instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY], (int64_t) 0, @"Counted without instrumentation");
+
+    /* Installed */
+    plcrash_async_instrumentation_set_current(&instr);
+    STAssertEquals(plcrash_async_instrumentation_current(), &instr, @"Instrumentation was not installed");
+
+    uint8_t src[16], dest[16];
+    memset(src, 0xAB, sizeof(src));
+    STAssertEquals(plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) src, 0, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertEquals(instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY], (int64_t) 1, @"Task memcpy was not counted");
+
+    /* Uninstalled */
+    plcrash_async_instrumentation_set_current(NULL);
+    plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) src, 0, dest, sizeof(dest));
+    STAssertEquals(instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY], (int64_t) 1, @"Counted after uninstall");
+}
+
+/**
+ * Verify that phase timings accumulate.
+ */
+- (void) testPhaseTiming {
+    plcrash_async_instrumentation_t instr;
+    plcrash_async_instrumentation_init(&instr);
+    plcrash_async_instrumentation_set_current(&instr);
+
+    for (int i = 0; i < 2; i++) {
+        uint64_t start = plcrash_async_instrumentation_begin();
+        STAssertNotEquals(start, (uint64_t) 0, @"Phase timing was not started");
+        usleep(1000);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_UNWIND, start);
+    }
+
+    STAssertTrue(plcrash_async_instrumentation_phase_ns(&instr, PLCRASH_ASYNC_PHASE_UNWIND) >= 2 * NSEC_PER_MSEC, @"Unwind time did not accumulate");
+    STAssertEquals(plcrash_async_instrumentation_phase_ns(&instr, PLCRASH_ASYNC_PHASE_FLUSH), (uint64_t) 0, @"Untimed phase recorded a time");
+}
+
+@end
@@ -48,6 +48,15 @@ PLCR_CPP_BEGIN_ASYNC_NS
  * write mutex is held for all updates; the implementation is not designed for efficiency in the face of contention
  * between readers and writers, and it's assumed that no contention should realistically occur.
  *
+ * Removed nodes are reclaimed using one of two reader protocols:
+ *
+ * - Epoch-based reclamation via begin_reading()/end_reading(). Each reader claims a private, cache line sized slot
+ *   and publishes the list epoch observed on entry; readers never write to a shared counter. Removed nodes are
+ *   stamped with the current epoch and retired, and are reclaimed by a later writer once no active slot holds an
+ *   epoch at or before the node's retirement. Writers never wait for readers.
+ * - The legacy set_reading() protocol, which maintains a shared reader count. Retired nodes are not reclaimed while
+ *   the count is non-zero.
+ *
  * @tparam V The list element type. 
  */
 template <typename V>
@@ -87,6 +96,7 @@ public:
             _value = value;
             _prev = NULL;
             _next = NULL;
+            _retire_epoch = 0;
         }
         
         /**
@@ -98,10 +108,14 @@ public:
             _value = value;
             _prev = NULL;
             _next = NULL;
+            _retire_epoch = 0;
         }
     
         /** The list entry value. */
         V _value;
+
+        /** The list epoch at which this node was removed from the list. Only valid for retired nodes. */
+        uint64_t _retire_epoch;
         
         /** The previous item in the list, or NULL */
         node *_prev;
@@ -110,6 +124,12 @@ public:
         node *_next;
     };
 
+    /** The number of epoch reader slots maintained by each list. */
+    static const int32_t reader_slot_count = 16;
+
+    /** A reader registration returned by begin_reading(). */
+    typedef int32_t read_token;
+
     async_list (void);
     ~async_list (void);
     
@@ -118,6 +138,8 @@ public:
     void nasync_remove_first_value (V value);
     void nasync_remove_node (node *deleted_node);
     void set_reading (bool enable);
+    read_token begin_reading (void);
+    void end_reading (read_token token);
     node *next (node *current);
     
     // Custom new/delete that do not rely on the stdlib
@@ -147,10 +169,28 @@ public:
     }
 
 private:
+    /**
+     * A cache line sized epoch reader slot.
+     */
+    struct reader_slot {
+        /** The list epoch observed by the slot's active reader, or 0 if the slot is unused. */
+        volatile int64_t epoch;
+
+        /** Padding to avoid sharing a cache line with any other slot. */
+        uint8_t _pad[64 - sizeof(int64_t)];
+    };
+
     void free_list (node *next);
+    void reclaim_retired (void);
 
     /** The lock used by writers. No lock is required for readers. */
     OSSpinLock _write_lock;
+
+    /** Epoch reader slots. */
+    reader_slot _slots[reader_slot_count];
+
+    /** The current list epoch. This is only modified by writers, and is never 0. */
+    volatile int64_t _epoch;
     
     /** The head of the list, or NULL if the list is empty. Must only be used to iterate or delete entries. */
     node *_head;
@@ -162,7 +202,10 @@ private:
      * reaches 0, all nodes in the free list will be deallocated. */
     int32_t _refcount;
     
-    /** The node free list. */
+    /** Nodes that have been removed from the list, but may still be referenced by a reader. */
+    node *_retired;
+
+    /** The node free list. Nodes on this list are unreachable by any reader, and may be re-used. */
     node *_free;
 };
     
@@ -171,8 +214,13 @@ template <typename V> async_list<V>::async_list (void) {
     _head = NULL;
     _tail = NULL;
     _free = NULL;
+    _retired = NULL;
     _refcount = 0;
+    _epoch = 1;
     _write_lock = OS_SPINLOCK_INIT;
+
+    for (int32_t i = 0; i < reader_slot_count; i++)
+        _slots[i].epoch = 0;
 }
     
 template <typename V> async_list<V>::~async_list (void) {
@@ -180,6 +228,9 @@ template <typename V> async_list<V>::~async_list (void) {
     if (_head != NULL)
         free_list(_head);
     
+    if (_retired != NULL)
+        free_list(_retired);
+
     if (_free != NULL)
         free_list(_free);
 }
@@ -194,6 +245,9 @@ template <typename V> async_list<V>::~async_list (void) {
 template <typename V> void async_list<V>::nasync_prepend (V value) {
     /* Lock the list from other writers. */
     OSSpinLockLock(&_write_lock); {
+        /* Make any retired nodes that are no longer referenced by readers available for re-use */
+        reclaim_retired();
+
         /* Construct the new entry, or recycle an existing one. */
         node *new_node;
         if (_free != NULL) {
@@ -255,6 +309,9 @@ template <typename V> void async_list<V>::nasync_append (V value) {
     
     /* Lock the list from other writers. */
     OSSpinLockLock(&_write_lock); {
+        /* Make any retired nodes that are no longer referenced by readers available for re-use */
+        reclaim_retired();
+
         /* Construct the new entry, or recycle an existing one. */
         node *new_node;
         if (_free != NULL) {
@@ -308,7 +365,7 @@ template <typename V> void async_list<V>::nasync_append (V value) {
  * @warning This method is not async safe.
  */
 template <typename V> void async_list<V>::nasync_remove_first_value (V value) {
-    set_reading(true);
+    read_token token = begin_reading();
     node *n = NULL;
     while ((n = next(n)) != NULL) {
         if (n->value() == value) {
@@ -316,7 +373,7 @@ template <typename V> void async_list<V>::nasync_remove_first_value (V value) {
             break;
         }
     }
-    set_reading(false);
+    end_reading(token);
 }
 
 /**
@@ -370,20 +427,67 @@ template <typename V> void async_list<V>::nasync_remove_node (node *deleted_node
             _tail = item->_prev;
         }
         
-        /* If a reader is active, place the node on the free list. The item is unreachable here when readers
-         * aren't active, so if we have a 0 refcount, we can safely delete the item, and be sure that no
-         * reader holds a reference to it. */
-        if (_refcount > 0) {
+        /* Retire the node, stamping it with the current epoch, and then advance the epoch; any reader that observes
+         * the new epoch entered after the node became unreachable, and can not hold a reference to it. The item's
+         * next pointer is preserved, as a reader positioned at the item may still advance through it. */
+        item->_retire_epoch = _epoch;
+        OSAtomicIncrement64Barrier(&_epoch);
+
+        /* Place the node on the retired list. This list is never accessed by readers, and the node's _prev pointer
+         * is used for linkage so that _next remains valid for readers. */
+        item->_prev = _retired;
+        _retired = item;
+
+        /* Reclaim the node immediately, if possible */
+        reclaim_retired();
+    } OSSpinLockUnlock(&_write_lock);
+}
+
+/**
+ * @internal
+ *
+ * Move all retired nodes that can no longer be referenced by any reader to the free list.
+ *
+ * @warning This method is not async-safe, and must only be called with the write lock held.
+ */
+template <typename V> void async_list<V>::reclaim_retired (void) {
+    if (_retired == NULL)
+        return;
+
+    /* Readers using the shared reference count provide no epoch; nothing may be reclaimed while they're active. The
+     * barrier pairs with the barrier issued by readers on entry. */
+    OSMemoryBarrier();
+    if (_refcount > 0)
+        return;
+
+    /* Find the oldest epoch observed by an active reader */
+    int64_t oldest = INT64_MAX;
+    for (int32_t i = 0; i < reader_slot_count; i++) {
+        int64_t epoch = _slots[i].epoch;
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+
+    /* Any node retired prior to the oldest active reader's entry is unreachable */
+    node **prevp = &_retired;
+    node *item = _retired;
+    while (item != NULL) {
+        node *retired_next = item->_prev;
+
+        if (item->_retire_epoch < oldest) {
+            *prevp = retired_next;
+
             item->_prev = NULL;
             item->_next = _free;
-            
             if (_free != NULL)
                 _free->_prev = item;
             _free = item;
         } else {
-            delete item;
+            prevp = &item->_prev;
         }
-    } OSSpinLockUnlock(&_write_lock);
+
+        item = retired_next;
+    }
 }
 
 /**
@@ -403,16 +507,60 @@ template <typename V> void async_list<V>::set_reading (bool enable) {
     }
 }
 
+/**
+ * Register as an epoch reader of the list. This method is async-safe and wait-free, and in the common case writes
+ * only to a reader slot private to the caller.
+ *
+ * This must be issued prior to attempting to iterate the list, and the returned token must be passed to end_reading()
+ * once reads have completed.
+ *
+ * @return Returns the reader registration to be supplied to end_reading(). If all reader slots are in use, the shared
+ * reader count used by set_reading() will be retained instead.
+ */
+template <typename V> typename async_list<V>::read_token async_list<V>::begin_reading (void) {
+    /* Spread readers across the slots by their stack address; concurrent readers on distinct threads will generally
+     * land on distinct slots. */
+    uintptr_t hint = (uintptr_t) __builtin_frame_address(0);
+    int32_t start = (int32_t) (((hint >> 12) ^ (hint >> 20)) % reader_slot_count);
+
+    /* Claim a free slot, publishing the epoch at entry. The CAS acts as a full barrier, ordering our publication
+     * before any subsequent reads of the list. */
+    int64_t epoch = _epoch;
+    for (int32_t i = 0; i < reader_slot_count; i++) {
+        int32_t idx = (start + i) % reader_slot_count;
+        if (_slots[idx].epoch == 0 && OSAtomicCompareAndSwap64Barrier(0, epoch, &_slots[idx].epoch))
+            return idx;
+    }
+
+    /* All slots are in use; fall back on the shared reader count */
+    set_reading(true);
+    return -1;
+}
+
+/**
+ * Release a reader registration acquired via begin_reading(). This method is async-safe and wait-free.
+ *
+ * @param token The token returned by begin_reading().
+ */
+template <typename V> void async_list<V>::end_reading (read_token token) {
+    if (token < 0) {
+        set_reading(false);
+        return;
+    }
+
+    /* Issue a barrier to ensure that all list reads complete prior to releasing the slot */
+    OSMemoryBarrier();
+    _slots[token].epoch = 0;
+}
+
 /**
  * Iterate over list nodes. This method is async-safe. If no additional nodes are available, will return NULL.
  *
- * The list must be marked for reading before iteration is performed.
+ * The list must be marked for reading, via begin_reading() or set_reading(), before iteration is performed.
  *
  * @param current The current list node, or NULL to start iteration.
  */
 template <typename V> typename async_list<V>::node *async_list<V>::next (node *current) {
-    PLCF_ASSERT(_refcount > 0);
-    
     if (current != NULL)
         return current->_next;
     
@@ -167,4 +167,64 @@ using namespace plcrash::async;
     _list.assert_list_valid();
 }
 
+/* Test that nodes removed while an epoch reader is active remain valid until the reader exits. */
+- (void) testEpochReading {
+    _list.nasync_append(0);
+    _list.nasync_append(1);
+    _list.nasync_append(2);
+
+    async_list<int>::read_token token = _list.begin_reading();
+    STAssertTrue(token >= 0, @"Expected an epoch reader slot");
+
+    /* Position the reader at the first item, and then remove it */
+    async_list<int>::node *item = _list.next(NULL);
+    STAssertNotNULL(item, @"Item should not be NULL");
+    _list.nasync_remove_first_value(0);
+
+    /* A new node must not re-use the retired node while the reader remains active */
+    _list.nasync_append(3);
+
+    /* The retired node must remain valid, and iteration must continue through it */
+    STAssertEquals(item->value(), 0, @"Retired node was modified while a reader was active");
+    item = _list.next(item);
+    STAssertNotNULL(item, @"Item should not be NULL");
+    STAssertEquals(item->value(), 1, @"Incorrect value");
+
+    _list.end_reading(token);
+    _list.assert_list_valid();
+
+    /* Once the reader exits, the list should reflect the removal */
+    token = _list.begin_reading();
+    item = _list.next(NULL);
+    STAssertEquals(item->value(), 1, @"Removed item is still reachable");
+    _list.end_reading(token);
+}
+
+/* Test exhaustion of the epoch reader slots; readers should fall back on the shared reader count. */
+- (void) testReaderSlotExhaustion {
+    async_list<int>::read_token tokens[async_list<int>::reader_slot_count];
+
+    for (int32_t i = 0; i < async_list<int>::reader_slot_count; i++) {
+        tokens[i] = _list.begin_reading();
+        STAssertTrue(tokens[i] >= 0, @"Expected an epoch reader slot");
+        for (int32_t j = 0; j < i; j++)
+            STAssertTrue(tokens[i] != tokens[j], @"Reader slot was issued twice");
+    }
+
+    async_list<int>::read_token fallback = _list.begin_reading();
+    STAssertTrue(fallback < 0, @"Expected a shared reader count fallback");
+
+    /* Removal must be deferred while the fallback reader is active */
+    _list.nasync_append(0);
+    async_list<int>::node *item = _list.next(NULL);
+    _list.nasync_remove_first_value(0);
+    STAssertEquals(item->value(), 0, @"Retired node was modified while a reader was active");
+
+    _list.end_reading(fallback);
+    for (int32_t i = 0; i < async_list<int>::reader_slot_count; i++)
+        _list.end_reading(tokens[i]);
+
+    _list.assert_list_valid();
+}
+
 @end
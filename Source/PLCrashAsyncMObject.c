@@ -27,10 +27,16 @@
  */
 
 #include "PLCrashAsyncMObject.h"
+#include "PLCrashAsyncRegionMap.h"
+#include "PLCrashAsyncMObjectPool.h"
+#include "PLCrashAsyncInstrumentation.h"
+#include "PLCrashAsyncVirtualTask.h"
 
 #include <stdint.h>
 #include <inttypes.h>
 
+#include <libkern/OSAtomic.h>
+
 /**
  * @internal
  * @ingroup plcrash_async
@@ -40,6 +46,178 @@
  * @{
  */
 
+/**
+ * @internal
+ *
+ * The maximum number of readable regions retained by the local region cache.
+ */
+#define PLCRASH_ASYNC_MOBJECT_REGION_CACHE_SIZE 64
+
+/**
+ * @internal
+ *
+ * A readable, contiguous region of the current task's address space.
+ */
+typedef struct plcrash_async_mobject_region {
+    /** The first address of the region. */
+    pl_vm_address_t start;
+
+    /** The address immediately following the region. */
+    pl_vm_address_t end;
+
+    /** The cache generation at which this region was validated. */
+    int32_t generation;
+} plcrash_async_mobject_region_t;
+
+/**
+ * @internal
+ *
+ * Cache of the current task's readable regions, as validated by plcrash_async_mobject_verify_local_range(). This is
+ * reset prior to writing each report via plcrash_async_mobject_region_cache_reset().
+ */
+static struct {
+    /** Lock guarding all cache state. The lock is only ever acquired via OSSpinLockTry(); if it is held -- including by a
+     * thread suspended by the crash handler -- the cache is simply bypassed. */
+    OSSpinLock lock;
+
+    /** The current cache generation. Entries recorded in a prior generation are ignored. This is modified atomically,
+     * and may be incremented without acquiring @a lock. */
+    volatile int32_t generation;
+
+    /** The number of valid entries in @a regions. */
+    uint32_t count;
+
+    /** The index of the next entry to be replaced once the cache is full. */
+    uint32_t next;
+
+    /** Cached regions. */
+    plcrash_async_mobject_region_t regions[PLCRASH_ASYNC_MOBJECT_REGION_CACHE_SIZE];
+} region_cache = { OS_SPINLOCK_INIT, 0, 0, 0 };
+
+/**
+ * Discard all cached regions of the current task's address space. This should be called prior to writing a report,
+ * as the task's mappings may have changed since the previous report was written.
+ *
+ * This function is async-safe, and does not acquire the cache lock; existing entries are invalidated by advancing the
+ * cache generation.
+ */
+void plcrash_async_mobject_region_cache_reset (void) {
+    OSAtomicIncrement32Barrier(&region_cache.generation);
+}
+
+/**
+ * @internal
+ *
+ * Look up the cached readable region containing @a address.
+ *
+ * @param address The address to look up.
+ * @param region_end On success, the address immediately following the cached region.
+ *
+ * @return Returns true if a cached region was found.
+ */
+static bool plcrash_async_mobject_region_cache_lookup (pl_vm_address_t address, pl_vm_address_t *region_end) {
+    bool found = false;
+
+    if (!OSSpinLockTry(&region_cache.lock))
+        return false;
+
+    int32_t generation = region_cache.generation;
+    for (uint32_t i = 0; i < region_cache.count; i++) {
+        if (region_cache.regions[i].generation != generation)
+            continue;
+
+        if (address >= region_cache.regions[i].start && address < region_cache.regions[i].end) {
+            *region_end = region_cache.regions[i].end;
+            found = true;
+            break;
+        }
+    }
+
+    OSSpinLockUnlock(&region_cache.lock);
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Record a readable region in the region cache. Once full, the cache's entries are replaced in FIFO order.
+ */
+static void plcrash_async_mobject_region_cache_insert (pl_vm_address_t start, pl_vm_address_t end) {
+    if (!OSSpinLockTry(&region_cache.lock))
+        return;
+
+    uint32_t index;
+    if (region_cache.count < PLCRASH_ASYNC_MOBJECT_REGION_CACHE_SIZE) {
+        index = region_cache.count++;
+    } else {
+        index = region_cache.next;
+        region_cache.next = (region_cache.next + 1) % PLCRASH_ASYNC_MOBJECT_REGION_CACHE_SIZE;
+    }
+
+    region_cache.regions[index].start = start;
+    region_cache.regions[index].end = end;
+    region_cache.regions[index].generation = region_cache.generation;
+
+    OSSpinLockUnlock(&region_cache.lock);
+}
+
+/**
+ * @internal
+ *
+ * Determine the length of the readable, contiguous range of the current task's address space starting at @a base_addr,
+ * up to a maximum of @a length bytes.
+ *
+ * Regions are validated via vm_region_recurse(), descending into submaps (such as the shared cache) to determine the
+ * protection of the actual mapping; validated regions are recorded in the region cache.
+ *
+ * @param base_addr The page-aligned base address of the range.
+ * @param length The page-aligned length of the range.
+ * @param verified_length On return, the number of readable bytes starting at @a base_addr. This may exceed @a length.
+ */
+static void plcrash_async_mobject_verify_local_range (pl_vm_address_t base_addr, pl_vm_size_t length, pl_vm_size_t *verified_length) {
+    pl_vm_address_t end_addr = base_addr + length;
+    pl_vm_address_t addr = base_addr;
+
+    while (addr < end_addr) {
+        /* Consult the cache */
+        pl_vm_address_t region_end;
+        if (plcrash_async_mobject_region_cache_lookup(addr, &region_end)) {
+            addr = region_end;
+            continue;
+        }
+
+        /* Probe the region containing addr, descending into any submaps */
+        pl_vm_address_t region_addr = addr;
+        pl_vm_size_t region_size = 0;
+        natural_t depth = 0;
+        vm_region_submap_info_data_64_t info;
+        kern_return_t kt;
+
+        while (true) {
+            mach_msg_type_number_t count = VM_REGION_SUBMAP_INFO_COUNT_64;
+            region_addr = addr;
+#ifdef PL_HAVE_MACH_VM
+            kt = mach_vm_region_recurse(mach_task_self(), &region_addr, &region_size, &depth, (vm_region_recurse_info_t) &info, &count);
+#else
+            kt = vm_region_recurse_64(mach_task_self(), &region_addr, &region_size, &depth, (vm_region_recurse_info_t) &info, &count);
+#endif
+            if (kt != KERN_SUCCESS || !info.is_submap)
+                break;
+
+            depth++;
+        }
+
+        /* vm_region_recurse() returns the next region if addr is unmapped */
+        if (kt != KERN_SUCCESS || region_addr > addr || !(info.protection & VM_PROT_READ))
+            break;
+
+        plcrash_async_mobject_region_cache_insert(region_addr, region_addr + region_size);
+        addr = region_addr + region_size;
+    }
+
+    *verified_length = addr - base_addr;
+}
+
 /**
  * Map pages starting at @a task_addr from @a task into the current process. The mapping
  * will be copy-on-write, and will be checked to ensure a minimum protection value of
@@ -239,10 +417,37 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
 }
 
 
+/**
+ * Map @a length bytes at @a task_addr from @a task into the current process, returning a new page-aligned mapping that
+ * must be deallocated by the caller. This is the mapping operation used by plcrash_async_mobject_init() for tasks
+ * other than the current task, and is intended for use by mapping pools.
+ *
+ * @param task The task from which the memory will be mapped.
+ * @param task_addr The task-relative address of the memory to be mapped. This is not required to fall on a page boundry.
+ * @param length The total size of the mapping to create.
+ * @param require_full If false, short mappings will be permitted. See plcrash_async_mobject_init().
+ * @param result On success, the page-aligned address at which the target pages have been mapped.
+ * @param result_length On success, the length of the mapping.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ */
+plcrash_error_t plcrash_async_mobject_remap_pages (mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, pl_vm_address_t *result, pl_vm_size_t *result_length) {
+    return plcrash_async_mobject_remap_pages_workaround(task, task_addr, length, require_full, result, result_length);
+}
+
 /**
  * Initialize a new memory object reference, mapping @a task_addr from @a task into the current process. The mapping
  * will be copy-on-write, and will be checked to ensure a minimum protection value of VM_PROT_READ.
  *
+ * If @a task is the current task, no mapping is performed; the memory is instead validated to have a minimum protection
+ * of VM_PROT_READ, and is referenced in place. The range is validated against the region map installed via
+ * plcrash_async_region_map_set_current() if any; otherwise, the validated regions are cached until the next call to
+ * plcrash_async_mobject_region_cache_reset(). The referenced memory must remain mapped for the lifetime of the memory
+ * object.
+ *
+ * For other tasks, if a mapping pool has been installed via plcrash_async_mobject_pool_set_current(), the memory is
+ * mapped via the pool, and may share an existing mapping.
+ *
  * @param mobj Memory object to be initialized.
  * @param task The task from which the memory will be mapped.
  * @param task_addr The task-relative address of the memory to be mapped. This is not required to fall on a page boundry.
@@ -256,12 +461,86 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
  * mapping will be performed.
  */
 plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full) {
+    return plcrash_async_mobject_init_pooled(mobj, plcrash_async_mobject_pool_current(), task, task_addr, length, require_full);
+}
+
+/**
+ * Initialize a new memory object reference, mapping @a task_addr from @a task into the current process via @a pool,
+ * rather than the current mapping pool installed via plcrash_async_mobject_pool_set_current().
+ *
+ * This allows a caller to share mappings between a known set of memory objects -- such as the headers of densely
+ * packed images -- without installing a process-wide pool.
+ *
+ * @param mobj Memory object to be initialized.
+ * @param pool The pool via which the memory will be mapped, or NULL to map the memory without a pool. The pool
+ * is not consulted for the current task, or for virtual tasks.
+ * @param task The task from which the memory will be mapped.
+ * @param task_addr The task-relative address of the memory to be mapped.
+ * @param length The total size of the mapping to create.
+ * @param require_full If false, short mappings will be permitted. See plcrash_async_mobject_init().
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned, and no
+ * mapping will be performed.
+ */
+plcrash_error_t plcrash_async_mobject_init_pooled (plcrash_async_mobject_t *mobj, plcrash_async_mobject_pool_t *pool, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full) {
+    plcrash_async_vtask_t *vtask = NULL;
     plcrash_error_t err;
 
-    /* Perform the page mapping */
-    err = plcrash_async_mobject_remap_pages_workaround(task, task_addr, length, require_full, &mobj->vm_address, &mobj->vm_length);
-    if (err != PLCRASH_ESUCCESS)
-        return err;
+    plcrash_async_instrumentation_count(PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS);
+
+    if (task == mach_task_self()) {
+        /* The memory is already mapped locally; validate that it is readable, and reference it in place */
+        pl_vm_address_t base_addr = mach_vm_trunc_page(task_addr);
+        pl_vm_size_t total_size = mach_vm_round_page(length + (task_addr - base_addr));
+        pl_vm_size_t verified_size;
+
+        /* Prefer the installed region map, if any, falling back on the kernel for partial mappings */
+        const plcrash_async_region_map_t *map = plcrash_async_region_map_current();
+        if (map != NULL && plcrash_async_region_map_verify(map, base_addr, total_size, VM_PROT_READ))
+            verified_size = total_size;
+        else if (map != NULL && require_full)
+            verified_size = 0;
+        else
+            plcrash_async_mobject_verify_local_range(base_addr, total_size, &verified_size);
+        if (verified_size == 0 || (require_full && verified_size < total_size)) {
+            PLCF_DEBUG("No readable pages found at 0x%" PRIx64, (uint64_t) task_addr);
+            return PLCRASH_ENOMEM;
+        }
+
+        mobj->vm_address = base_addr;
+        mobj->vm_length = verified_size < total_size ? verified_size : total_size;
+        mobj->remapped = false;
+        mobj->pool_ref = NULL;
+    } else if ((vtask = plcrash_async_vtask_lookup(task)) != NULL) {
+        /* Reference the virtual task's captured memory in place. The captured memory shares the target's page
+         * offsets, and so the page-relative computations below apply unmodified. */
+        pl_vm_address_t local;
+        pl_vm_size_t available;
+        if ((err = plcrash_async_vtask_map(vtask, task_addr, length, require_full, &local, &available)) != PLCRASH_ESUCCESS)
+            return err;
+
+        mobj->vm_address = mach_vm_trunc_page(local);
+        mobj->vm_length = (local - mobj->vm_address) + available;
+        mobj->remapped = false;
+        mobj->pool_ref = NULL;
+    } else if (pool != NULL) {
+        /* Borrow a (possibly existing) mapping from the pool */
+        plcrash_async_mobject_pool_ref_t *ref;
+        err = plcrash_async_mobject_pool_map(pool, task, task_addr, length, require_full, &ref, &mobj->vm_address, &mobj->vm_length);
+        if (err != PLCRASH_ESUCCESS)
+            return err;
+
+        mobj->remapped = false;
+        mobj->pool_ref = ref;
+    } else {
+        /* Perform the page mapping */
+        err = plcrash_async_mobject_remap_pages_workaround(task, task_addr, length, require_full, &mobj->vm_address, &mobj->vm_length);
+        if (err != PLCRASH_ESUCCESS)
+            return err;
+
+        mobj->remapped = true;
+        mobj->pool_ref = NULL;
+    }
 
     /* Determine the offset and length of the actual data */
     mobj->address = mobj->vm_address + (task_addr - mach_vm_trunc_page(task_addr));
@@ -283,6 +562,10 @@ plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_
     mobj->task = task;
     mach_port_mod_refs(mach_task_self(), mobj->task, MACH_PORT_RIGHT_SEND, 1);
 
+    /* Record the mapped bytes; memory served from a virtual task is already a recording */
+    if (vtask == NULL)
+        plcrash_async_vtask_record(task_addr, (const void *) (uintptr_t) mobj->address, mobj->length);
+
     return PLCRASH_ESUCCESS;
 }
 
@@ -412,7 +695,7 @@ plcrash_error_t plcrash_async_mobject_read_uint16 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap16(*input);
+    *result = plcrash_async_byteorder_swap16(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
@@ -436,7 +719,7 @@ plcrash_error_t plcrash_async_mobject_read_uint32 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap32(*input);
+    *result = plcrash_async_byteorder_swap32(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
@@ -459,7 +742,7 @@ plcrash_error_t plcrash_async_mobject_read_uint64 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap64(*input);
+    *result = plcrash_async_byteorder_swap64(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
@@ -470,15 +753,22 @@ plcrash_error_t plcrash_async_mobject_read_uint64 (plcrash_async_mobject_t *mobj
  */
 void plcrash_async_mobject_free (plcrash_async_mobject_t *mobj) {
     kern_return_t kt;
-    
+
+    /* Local memory is referenced in place, and is not ours to deallocate */
+    if (mobj->remapped) {
 #ifdef PL_HAVE_MACH_VM
-    kt = mach_vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
+        kt = mach_vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
 #else
-    kt = vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
+        kt = vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
 #endif
-    
-    if (kt != KERN_SUCCESS)
-        PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+
+        if (kt != KERN_SUCCESS)
+            PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+    }
+
+    /* Release our reference to a pooled mapping */
+    if (mobj->pool_ref != NULL)
+        plcrash_async_mobject_pool_ref_free(mobj->pool_ref);
 
     /* Decrement our task refcount */
     mach_port_mod_refs(mach_task_self(), mobj->task, MACH_PORT_RIGHT_SEND, -1);
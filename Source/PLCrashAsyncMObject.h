@@ -67,9 +67,18 @@ typedef struct plcrash_async_mobject {
     
     /** The actual mapping size. This may differ from the user-requested size, as the base address has been page-aligned */
     pl_vm_size_t vm_length;
+
+    /** If true, the pages at vm_address are a local remapping of the target's pages, and must be deallocated when the
+     * memory object is freed. If false, the memory of the current task is referenced in place. */
+    bool remapped;
+
+    /** If non-NULL, the pages at vm_address are borrowed from a pooled mapping (see plcrash_async_mobject_pool_map()),
+     * and this is the plcrash_async_mobject_pool_ref_t reference to be released when the memory object is freed. */
+    void *pool_ref;
 } plcrash_async_mobject_t;
 
 plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full);
+plcrash_error_t plcrash_async_mobject_remap_pages (mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full, pl_vm_address_t *result, pl_vm_size_t *result_length);
 
 pl_vm_address_t plcrash_async_mobject_base_address (plcrash_async_mobject_t *mobj);
 pl_vm_address_t plcrash_async_mobject_length (plcrash_async_mobject_t *mobj);
@@ -88,6 +97,8 @@ plcrash_error_t plcrash_async_mobject_read_uint64 (plcrash_async_mobject_t *mobj
                                                    pl_vm_address_t address, pl_vm_off_t offset, uint64_t *result);
 
 void plcrash_async_mobject_free (plcrash_async_mobject_t *mobj);
+
+void plcrash_async_mobject_region_cache_reset (void);
     
 #ifdef __cplusplus
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncMObjectPool.h"
+
+using namespace plcrash::async;
+
+/** The pool installed via plcrash_async_mobject_pool_set_current(), or NULL. */
+static MObjectPool * volatile current_pool = nullptr;
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * Construct a new, empty mapping pool. The pool must be freed via plcrash_async_mobject_pool_free().
+ *
+ * @param pool On success, the new pool.
+ * @param allocator The allocator to be used to allocate the pool and its mappings. This must outlive the pool and
+ * any mapping references returned by the pool.
+ */
+plcrash_error_t plcrash_async_mobject_pool_new (plcrash_async_mobject_pool_t **pool, plcrash_async_allocator_t *allocator) {
+    MObjectPool *result = new (allocator) MObjectPool(allocator);
+    if (result == nullptr)
+        return PLCRASH_ENOMEM;
+
+    *pool = result;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Equivalent to MObjectPool::map(). On success, a new reference to the mapping is returned in @a ref, which must be
+ * released via plcrash_async_mobject_pool_ref_free(); the page containing @a task_addr is mapped locally at
+ * @a vm_address, followed by @a vm_length - 1 bytes of the mapping.
+ */
+plcrash_error_t plcrash_async_mobject_pool_map (plcrash_async_mobject_pool_t *pool,
+                                                mach_port_t task,
+                                                pl_vm_address_t task_addr,
+                                                pl_vm_size_t length,
+                                                bool require_full,
+                                                plcrash_async_mobject_pool_ref_t **ref,
+                                                pl_vm_address_t *vm_address,
+                                                pl_vm_size_t *vm_length)
+{
+    AsyncAllocator *allocator = AsyncAllocator::allocator(pool);
+    plcrash_error_t err;
+
+    /* Allocate the reference prior to mapping, as it can not fail once we hold a mapping */
+    plcrash_async_mobject_pool_ref_t *result = new (allocator) shared_ptr<MObjectPool::Mapping>();
+    if (result == nullptr)
+        return PLCRASH_ENOMEM;
+
+    if ((err = pool->map(task, task_addr, length, require_full, result)) != PLCRASH_ESUCCESS) {
+        delete result;
+        return err;
+    }
+
+    pl_vm_size_t offset = mach_vm_trunc_page(task_addr) - (*result)->task_address();
+    *vm_address = (*result)->vm_address() + offset;
+    *vm_length = (*result)->vm_length() - offset;
+    *ref = result;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Release a mapping reference returned by plcrash_async_mobject_pool_map(). The mapping's pages will be deallocated
+ * once all references have been released and the mapping has been evicted from its pool.
+ */
+void plcrash_async_mobject_pool_ref_free (plcrash_async_mobject_pool_ref_t *ref) {
+    delete ref;
+}
+
+/**
+ * Free @a pool, releasing the pool's references to its mappings. If @a pool is the current pool, it must first be
+ * uninstalled via plcrash_async_mobject_pool_set_current().
+ */
+void plcrash_async_mobject_pool_free (plcrash_async_mobject_pool_t *pool) {
+    PLCF_ASSERT(current_pool != pool);
+    delete pool;
+}
+
+/**
+ * Install @a pool as the current mapping pool. While installed, plcrash_async_mobject_init() will map the memory of
+ * tasks other than the current task via @a pool.
+ *
+ * @param pool The pool to install, or NULL to uninstall the current pool.
+ */
+void plcrash_async_mobject_pool_set_current (plcrash_async_mobject_pool_t *pool) {
+    __sync_synchronize();
+    current_pool = pool;
+    __sync_synchronize();
+}
+
+/**
+ * Return the pool installed via plcrash_async_mobject_pool_set_current(), or NULL if none.
+ */
+plcrash_async_mobject_pool_t *plcrash_async_mobject_pool_current (void) {
+    return current_pool;
+}
+
+PLCR_C_END_DECLS
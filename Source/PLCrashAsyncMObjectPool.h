@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_MOBJECT_POOL_C_COMPAT_H
+#define PLCRASH_ASYNC_MOBJECT_POOL_C_COMPAT_H
+
+#include "PLCrashMacros.h"
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncAllocator.h"
+#include "PLCrashAsyncMObject.h"
+
+/*
+ * Provides a pure C interface to the C++ MObjectPool, for use by plcrash_async_mobject_t.
+ */
+
+#ifdef __cplusplus
+#include "MObjectPool.hpp"
+using plcrash_async_mobject_pool_t = plcrash::async::MObjectPool;
+using plcrash_async_mobject_pool_ref_t = plcrash::async::shared_ptr<plcrash::async::MObjectPool::Mapping>;
+#else
+typedef struct plcrash_async_mobject_pool plcrash_async_mobject_pool_t;
+typedef struct plcrash_async_mobject_pool_ref plcrash_async_mobject_pool_ref_t;
+#endif
+
+PLCR_C_BEGIN_DECLS
+
+plcrash_error_t plcrash_async_mobject_pool_new (plcrash_async_mobject_pool_t **pool, plcrash_async_allocator_t *allocator);
+plcrash_error_t plcrash_async_mobject_pool_map (plcrash_async_mobject_pool_t *pool,
+                                                mach_port_t task,
+                                                pl_vm_address_t task_addr,
+                                                pl_vm_size_t length,
+                                                bool require_full,
+                                                plcrash_async_mobject_pool_ref_t **ref,
+                                                pl_vm_address_t *vm_address,
+                                                pl_vm_size_t *vm_length);
+void plcrash_async_mobject_pool_ref_free (plcrash_async_mobject_pool_ref_t *ref);
+void plcrash_async_mobject_pool_free (plcrash_async_mobject_pool_t *pool);
+
+plcrash_error_t plcrash_async_mobject_init_pooled (plcrash_async_mobject_t *mobj, plcrash_async_mobject_pool_t *pool, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full);
+
+void plcrash_async_mobject_pool_set_current (plcrash_async_mobject_pool_t *pool);
+plcrash_async_mobject_pool_t *plcrash_async_mobject_pool_current (void);
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_MOBJECT_POOL_C_COMPAT_H */
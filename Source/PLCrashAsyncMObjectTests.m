@@ -62,6 +62,47 @@
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Verify that memory in the current task is referenced in place, rather than remapped.
+ */
+- (void) test_mapMobj_local {
+    size_t size = vm_page_size+1;
+    uint8_t template[size];
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t)template, size, true), @"Failed to initialize mapping");
+    STAssertEquals((pl_vm_address_t)template, mobj.address, @"Local memory was not referenced in place");
+    STAssertEquals((int64_t) 0, mobj.vm_slide, @"Incorrect slide value!");
+
+    plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Verify that validation of local memory stops at unreadable pages.
+ */
+- (void) test_mapMobj_local_unreadable {
+    vm_address_t pages = 0;
+    STAssertEquals(KERN_SUCCESS, vm_allocate(mach_task_self(), &pages, vm_page_size * 2, VM_FLAGS_ANYWHERE), @"Failed to allocate pages");
+    STAssertEquals(KERN_SUCCESS, vm_protect(mach_task_self(), pages + vm_page_size, vm_page_size, false, VM_PROT_NONE), @"Failed to protect page");
+
+    /* Discard any cached results from prior tests */
+    plcrash_async_mobject_region_cache_reset();
+
+    /* A full mapping must fail */
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_mobject_init(&mobj, mach_task_self(), pages, vm_page_size * 2, true), @"Mapped an unreadable page");
+
+    /* A short mapping should succeed, and stop at the unreadable page */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), pages, vm_page_size * 2, false), @"Failed to initialize short mapping");
+    STAssertEquals((pl_vm_size_t) vm_page_size, mobj.length, @"Incorrect length");
+    plcrash_async_mobject_free(&mobj);
+
+    /* A mapping of only the unreadable page must fail */
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_mobject_init(&mobj, mach_task_self(), pages + vm_page_size, vm_page_size, false), @"Mapped an unreadable page");
+
+    vm_deallocate(mach_task_self(), pages, vm_page_size * 2);
+}
+
 - (void) testBaseAddress {
     size_t size = vm_page_size+1;
     uint8_t template[size];
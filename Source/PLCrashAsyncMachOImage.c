@@ -27,6 +27,7 @@
  */
 
 #include "PLCrashAsyncMachOImage.h"
+#include "PLCrashAsyncMachOString.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +35,9 @@
 #include <assert.h>
 
 #include <mach-o/fat.h>
+#include <libkern/OSAtomic.h>
+#include <sys/mman.h>
+#include <errno.h>
 
 /**
  * @internal
@@ -45,50 +49,99 @@
  * @{
  */
 
+/** The number of symbol table entries decoded per plcrash_async_macho_symtab_reader_read_batch() call when scanning
+ * a symbol table. */
+#define PL_SYMTAB_BATCH_SIZE 32
+
+/** Return the number of entries to be decoded in the batch starting at @a base, of @a nsyms total entries. */
+#define PL_SYMTAB_BATCH_COUNT(nsyms, base) (((nsyms) - (base)) < PL_SYMTAB_BATCH_SIZE ? ((nsyms) - (base)) : PL_SYMTAB_BATCH_SIZE)
+
 /**
- * Initialize a new Mach-O binary image parser.
- *
- * @param image The image structure to be initialized.
- * @param allocator A borrowed reference to the allocator to be used for any allocations.
- * @param name The file name or path for the Mach-O image.
- * @param header The task-local address of the image's Mach-O header.
+ * @internal
  *
- * @return PLCRASH_ESUCCESS on success. PLCRASH_EINVAL will be returned in the Mach-O file can not be parsed,
- * PLCRASH_EINTERNAL if an error occurs reading from the target task, or PLCRASH_ENOMEM if memory allocation
- * fails.
+ * The well-known sections recorded in plcrash_async_macho_lc_table_t, indexed identically to its sections array.
+ */
+static const struct {
+    /** The segment name. */
+    const char *segname;
+
+    /** The section name. */
+    const char *sectname;
+} plcrash_async_macho_known_sections[PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT] = {
+    { SEG_TEXT,     "__unwind_info" },
+    { SEG_TEXT,     "__eh_frame" },
+    { SEG_DATA,     "__objc_const" },
+    { SEG_DATA,     "__objc_classlist" },
+    { SEG_DATA,     "__objc_catlist" },
+    { SEG_DATA,     "__objc_data" },
+    { "__OBJC",     "__module_info" },
+    { "__DWARF",    "__debug_frame" },
+};
+
+static void plcrash_async_macho_build_lc_table (plcrash_async_macho_t *image);
+static int plcrash_async_macho_known_section_index (const char *segname, const char *sectname);
+
+/**
+ * @internal
  *
- * @warning This method is not async safe.
+ * Initialize a new Mach-O binary image parser, copying the image's name from @a name if non-NULL, or otherwise
+ * recording @a name_addr for lazy retrieval by plcrash_async_macho_name().
  */
-plcrash_error_t plcrash_async_macho_init (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, const char *name, pl_vm_address_t header) {
+static plcrash_error_t plcrash_async_macho_init_common (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task,
+                                                        const char *name, pl_vm_address_t name_addr, pl_vm_address_t header,
+                                                        plcrash_async_mobject_pool_t *pool)
+{
     plcrash_error_t ret;
 
     /* Defaults checked in the  error cleanup handler */
     bool mobj_initialized = false;
     bool task_initialized = false;
     image->name = NULL;
+    image->symbol_index = NULL;
+    image->symbol_index_count = 0;
+    image->objc_method_index = NULL;
+    image->objc_method_index_count = 0;
+    image->encoded_record = NULL;
+    image->encoded_record_size = 0;
 
     /* Basic initialization */
     image->_allocator = allocator;
     image->task = task;
     image->header_addr = header;
+    image->name_addr = name_addr;
     
     /* Allocate memory and copy in the image name */
-    size_t name_len = strlen(name) + 1;
-    if ((ret = plcrash_async_allocator_alloc(allocator, (void **) &image->name, name_len)) != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Failed to allocate buffer for image name: %d", ret);
-        return PLCRASH_ENOMEM;
+    if (name != NULL) {
+        size_t name_len = strlen(name) + 1;
+        char *name_copy;
+        if ((ret = plcrash_async_allocator_alloc(allocator, (void **) &name_copy, name_len)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to allocate buffer for image name: %d", ret);
+            return PLCRASH_ENOMEM;
+        }
+        plcrash_async_memcpy(name_copy, name, name_len);
+        image->name = name_copy;
     }
-    plcrash_async_memcpy(image->name, name, name_len);
 
     /* Retain a mach port reference */
     mach_port_mod_refs(mach_task_self(), image->task, MACH_PORT_RIGHT_SEND, 1);
     task_initialized = true;
 
-    /* Read in the Mach-O header */
-    if ((ret = plcrash_async_task_memcpy(image->task, image->header_addr, 0, &image->header, sizeof(image->header))) != PLCRASH_ESUCCESS) {
+    /* Read in the Mach-O header, borrowing the pool's mapping of the header page (if any) rather than reading it
+     * from the task */
+    if (pool != NULL) {
+        plcrash_async_mobject_t header_mobj;
+        if ((ret = plcrash_async_mobject_init_pooled(&header_mobj, pool, image->task, image->header_addr, sizeof(image->header), true)) == PLCRASH_ESUCCESS) {
+            plcrash_async_memcpy(&image->header, (const void *) header_mobj.address, sizeof(image->header));
+            plcrash_async_mobject_free(&header_mobj);
+        }
+    } else {
+        ret = plcrash_async_task_memcpy(image->task, image->header_addr, 0, &image->header, sizeof(image->header));
+    }
+
+    if (ret != PLCRASH_ESUCCESS) {
         /* NOTE: The image struct must be fully initialized before returning here, as otherwise our _free() function
          * will crash */
-        PLCF_DEBUG("Failed to read Mach-O header from 0x%" PRIx64 " for image %s, ret=%d", (uint64_t) image->header_addr, name, ret);
+        PLCF_DEBUG("Failed to read Mach-O header from 0x%" PRIx64 " for image %s, ret=%d", (uint64_t) image->header_addr, image->name, ret);
         ret = PLCRASH_EINTERNAL;
         goto error;
     }
@@ -139,7 +192,10 @@ plcrash_error_t plcrash_async_macho_init (plcrash_async_macho_t *image, plcrash_
     pl_vm_size_t cmd_offset = image->header_addr + image->header_size;
     image->ncmds = image->byteorder->swap32(image->header.ncmds);
 
-    ret = plcrash_async_mobject_init(&image->load_cmds, image->task, cmd_offset, cmd_len, true);
+    if (pool != NULL)
+        ret = plcrash_async_mobject_init_pooled(&image->load_cmds, pool, image->task, cmd_offset, cmd_len, true);
+    else
+        ret = plcrash_async_mobject_init(&image->load_cmds, image->task, cmd_offset, cmd_len, true);
     if (ret != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Failed to map Mach-O load commands in image %s", image->name);
         goto error;
@@ -200,6 +256,14 @@ plcrash_error_t plcrash_async_macho_init (plcrash_async_macho_t *image, plcrash_
         image->vmaddr_slide = 0;
     }
 
+    /* Precompute our load command lookup table; this must be done after the slide has been computed. */
+    plcrash_async_macho_build_lc_table(image);
+
+    /* Record unwind data availability, allowing the frame walker to skip readers that can not succeed for this image */
+    image->has_compact_unwind = image->lc_table.sections[plcrash_async_macho_known_section_index(SEG_TEXT, "__unwind_info")].found;
+    image->has_dwarf_unwind = image->lc_table.sections[plcrash_async_macho_known_section_index(SEG_TEXT, "__eh_frame")].found ||
+        image->lc_table.sections[plcrash_async_macho_known_section_index("__DWARF", "__debug_frame")].found;
+
     return PLCRASH_ESUCCESS;
     
 error:
@@ -215,6 +279,262 @@ error:
     return ret;
 }
 
+/**
+ * Initialize a new Mach-O binary image parser.
+ *
+ * @param image The image structure to be initialized.
+ * @param allocator A borrowed reference to the allocator to be used for any allocations.
+ * @param task The task in which the image is loaded.
+ * @param name The file name or path for the Mach-O image. The name is copied.
+ * @param header The task-local address of the image's Mach-O header.
+ *
+ * @return PLCRASH_ESUCCESS on success. PLCRASH_EINVAL will be returned in the Mach-O file can not be parsed,
+ * PLCRASH_EINTERNAL if an error occurs reading from the target task, or PLCRASH_ENOMEM if memory allocation
+ * fails.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_async_macho_init (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, const char *name, pl_vm_address_t header) {
+    return plcrash_async_macho_init_common(image, allocator, task, name, 0, header, NULL);
+}
+
+/**
+ * Initialize a new Mach-O binary image parser, deferring the copy of the image's name until it is requested via
+ * plcrash_async_macho_name(). Most reports reference only a small subset of the loaded images; this avoids reading
+ * the path strings of the remainder.
+ *
+ * @param image The image structure to be initialized.
+ * @param allocator A borrowed reference to the allocator to be used for any allocations.
+ * @param task The task in which the image is loaded.
+ * @param name_addr The task-local address of the image's NUL-terminated file name or path, or 0 if unavailable.
+ * @param header The task-local address of the image's Mach-O header.
+ *
+ * @return PLCRASH_ESUCCESS on success. PLCRASH_EINVAL will be returned in the Mach-O file can not be parsed,
+ * PLCRASH_EINTERNAL if an error occurs reading from the target task, or PLCRASH_ENOMEM if memory allocation
+ * fails.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_async_macho_init_lazy_name (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, pl_vm_address_t name_addr, pl_vm_address_t header) {
+    return plcrash_async_macho_init_common(image, allocator, task, NULL, name_addr, header, NULL);
+}
+
+/**
+ * Initialize a new Mach-O binary image parser, equivalent to plcrash_async_macho_init_lazy_name(), mapping the image's
+ * header and load commands via @a pool. When initializing many images whose headers are densely packed -- such as
+ * those of the dyld shared cache -- the caller may populate @a pool with a small number of large mappings, allowing
+ * all of the images to share those mappings rather than mapping each image's load commands separately.
+ *
+ * @param image The image structure to be initialized.
+ * @param allocator A borrowed reference to the allocator to be used for any allocations.
+ * @param task The task in which the image is loaded.
+ * @param name_addr The task-local address of the image's NUL-terminated file name or path, or 0 if unavailable.
+ * @param header The task-local address of the image's Mach-O header.
+ * @param pool The pool via which the image's header and load commands will be mapped. The image retains a reference
+ * to the pooled mapping of its load commands, and the pool may be freed prior to the image.
+ *
+ * @return PLCRASH_ESUCCESS on success. PLCRASH_EINVAL will be returned in the Mach-O file can not be parsed,
+ * PLCRASH_EINTERNAL if an error occurs reading from the target task, or PLCRASH_ENOMEM if memory allocation
+ * fails.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_async_macho_init_pooled (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, pl_vm_address_t name_addr, pl_vm_address_t header, plcrash_async_mobject_pool_t *pool) {
+    return plcrash_async_macho_init_common(image, allocator, task, NULL, name_addr, header, pool);
+}
+
+/**
+ * Return a borrowed reference to @a image's file name or path, copying the name from the target task on first use.
+ * The copy is allocated from the image's backing allocator, and will be freed by plcrash_async_macho_free().
+ *
+ * @param image The image whose name should be returned.
+ *
+ * @return Returns the image name, or NULL if the name is unavailable or could not be read.
+ *
+ * @warning This method is async-safe, and may be called concurrently with itself.
+ */
+const char *plcrash_async_macho_name (plcrash_async_macho_t *image) {
+    plcrash_async_macho_string_t str;
+    const char *remote;
+    pl_vm_size_t length;
+    char *name;
+
+    /* Fast path; the name has already been copied */
+    if ((name = image->name) != NULL || image->name_addr == 0)
+        return name;
+
+    plcrash_async_macho_string_init(&str, image->task, image->name_addr);
+    if (plcrash_async_macho_string_get_length(&str, &length) != PLCRASH_ESUCCESS || plcrash_async_macho_string_get_pointer(&str, &remote) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read image name at address 0x%" PRIx64, (uint64_t) image->name_addr);
+        plcrash_async_macho_string_free(&str);
+        return NULL;
+    }
+
+    if (plcrash_async_allocator_alloc(image->_allocator, (void **) &name, length + 1) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate buffer for image name");
+        plcrash_async_macho_string_free(&str);
+        return NULL;
+    }
+
+    plcrash_async_memcpy(name, remote, length);
+    name[length] = '\0';
+    plcrash_async_macho_string_free(&str);
+
+    /* Publish the copy. If another caller published a copy first, ours may be discarded. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, name, (void * volatile *) &image->name))
+        plcrash_async_allocator_dealloc(image->_allocator, name);
+
+    return image->name;
+}
+
+/**
+ * @internal
+ *
+ * Populate @a image's lc_table in a single pass over its load commands. Lookups are recorded with the same
+ * first-match semantics as plcrash_async_macho_find_command(), plcrash_async_macho_find_segment_cmd() and
+ * plcrash_async_macho_map_section().
+ */
+static void plcrash_async_macho_build_lc_table (plcrash_async_macho_t *image) {
+    plcrash_async_macho_lc_table_t *table = &image->lc_table;
+    uint32_t segment_cmd = image->m64 ? LC_SEGMENT_64 : LC_SEGMENT;
+
+    /* Segment names for which the first matching segment has already been scanned for known sections */
+    bool scanned[PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT];
+
+    plcrash_async_memset(table, 0, sizeof(*table));
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT; i++)
+        scanned[i] = false;
+
+    struct load_command *cmd = NULL;
+    while ((cmd = plcrash_async_macho_next_command(image, cmd)) != NULL) {
+        uint32_t type = image->byteorder->swap32(cmd->cmd);
+
+        if (type == LC_SYMTAB && table->symtab_cmd == NULL) {
+            table->symtab_cmd = cmd;
+            continue;
+        } else if (type == LC_DYSYMTAB && table->dysymtab_cmd == NULL) {
+            table->dysymtab_cmd = cmd;
+            continue;
+        } else if (type == LC_UUID && table->uuid_cmd == NULL) {
+            table->uuid_cmd = cmd;
+            continue;
+        } else if (type != segment_cmd) {
+            continue;
+        }
+
+        /* Fetch the segment name and section table */
+        const char *segname;
+        pl_vm_address_t vmaddr;
+        uint32_t nsects;
+        uintptr_t cursor = (uintptr_t) cmd;
+        if (image->m64) {
+            struct segment_command_64 *seg_64 = (struct segment_command_64 *) cmd;
+            if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, (uintptr_t) seg_64, 0, sizeof(*seg_64)))
+                continue;
+
+            segname = seg_64->segname;
+            vmaddr = image->byteorder->swap64(seg_64->vmaddr) + image->vmaddr_slide;
+            nsects = image->byteorder->swap32(seg_64->nsects);
+            cursor += sizeof(*seg_64);
+        } else {
+            struct segment_command *seg_32 = (struct segment_command *) cmd;
+            if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, (uintptr_t) seg_32, 0, sizeof(*seg_32)))
+                continue;
+
+            segname = seg_32->segname;
+            vmaddr = image->byteorder->swap32(seg_32->vmaddr) + image->vmaddr_slide;
+            nsects = image->byteorder->swap32(seg_32->nsects);
+            cursor += sizeof(*seg_32);
+        }
+
+        if (table->text_segment == NULL && plcrash_async_strncmp(segname, SEG_TEXT, 16) == 0) {
+            table->text_segment = cmd;
+            table->eh_bases.has_text_base = true;
+            table->eh_bases.text_base = vmaddr;
+        } else if (table->data_segment == NULL && plcrash_async_strncmp(segname, SEG_DATA, 16) == 0) {
+            table->data_segment = cmd;
+            table->eh_bases.has_data_base = true;
+            table->eh_bases.data_base = vmaddr;
+        } else if (table->linkedit_segment == NULL && plcrash_async_strncmp(segname, SEG_LINKEDIT, 16) == 0) {
+            table->linkedit_segment = cmd;
+        }
+
+        /* Determine which known sections may be found within this segment; only the first segment of a given name
+         * is searched, matching plcrash_async_macho_map_section() */
+        bool wanted[PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT];
+        bool any_wanted = false;
+        for (size_t k = 0; k < PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT; k++) {
+            wanted[k] = !scanned[k] && plcrash_async_strncmp(segname, plcrash_async_macho_known_sections[k].segname, 16) == 0;
+            if (wanted[k]) {
+                scanned[k] = true;
+                any_wanted = true;
+            }
+        }
+
+        if (!any_wanted)
+            continue;
+
+        for (uint32_t i = 0; i < nsects; i++) {
+            const char *sectname;
+            pl_vm_address_t sectaddr;
+            pl_vm_size_t sectsize;
+
+            if (image->m64) {
+                struct section_64 *sect_64 = (struct section_64 *) cursor;
+                if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sizeof(*sect_64)))
+                    break;
+
+                sectname = sect_64->sectname;
+                sectaddr = image->byteorder->swap64(sect_64->addr) + image->vmaddr_slide;
+                sectsize = image->byteorder->swap64(sect_64->size);
+                cursor += sizeof(*sect_64);
+            } else {
+                struct section *sect_32 = (struct section *) cursor;
+                if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sizeof(*sect_32)))
+                    break;
+
+                sectname = sect_32->sectname;
+                sectaddr = image->byteorder->swap32(sect_32->addr) + image->vmaddr_slide;
+                sectsize = image->byteorder->swap32(sect_32->size);
+                cursor += sizeof(*sect_32);
+            }
+
+            for (size_t k = 0; k < PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT; k++) {
+                if (!wanted[k] || table->sections[k].found)
+                    continue;
+
+                if (plcrash_async_strncmp(sectname, plcrash_async_macho_known_sections[k].sectname, 16) != 0)
+                    continue;
+
+                table->sections[k].found = true;
+                table->sections[k].addr = sectaddr;
+                table->sections[k].size = sectsize;
+            }
+        }
+    }
+}
+
+/**
+ * @internal
+ *
+ * Look up the lc_table index for the well-known section (@a segname, @a sectname).
+ *
+ * @return Returns the index, or -1 if the section is not recorded in the table.
+ */
+static int plcrash_async_macho_known_section_index (const char *segname, const char *sectname) {
+    for (size_t k = 0; k < PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT; k++) {
+        if (plcrash_async_strncmp(segname, plcrash_async_macho_known_sections[k].segname, 16) != 0)
+            continue;
+
+        if (plcrash_async_strncmp(sectname, plcrash_async_macho_known_sections[k].sectname, 16) != 0)
+            continue;
+
+        return (int) k;
+    }
+
+    return -1;
+}
+
 /**
  * Return a borrowed reference to the byte order functions to use when parsing data from
  * @a image.
@@ -392,6 +712,18 @@ void *plcrash_async_macho_next_command_type (plcrash_async_macho_t *image, void
 void *plcrash_async_macho_find_command (plcrash_async_macho_t *image, uint32_t expectedCommand) {
     struct load_command *cmd = NULL;
 
+    /* Use the precomputed table where possible */
+    switch (expectedCommand) {
+        case LC_SYMTAB:
+            return image->lc_table.symtab_cmd;
+        case LC_DYSYMTAB:
+            return image->lc_table.dysymtab_cmd;
+        case LC_UUID:
+            return image->lc_table.uuid_cmd;
+        default:
+            break;
+    }
+
     /* Iterate commands until we either find a match, or reach the end */
     while ((cmd = plcrash_async_macho_next_command(image, cmd)) != NULL) {
         /* Read the load command type */
@@ -421,6 +753,14 @@ void *plcrash_async_macho_find_command (plcrash_async_macho_t *image, uint32_t e
 void *plcrash_async_macho_find_segment_cmd (plcrash_async_macho_t *image, const char *segname) {
     void *seg = NULL;
 
+    /* Use the precomputed table where possible */
+    if (plcrash_async_strncmp(segname, SEG_TEXT, 16) == 0)
+        return image->lc_table.text_segment;
+    else if (plcrash_async_strncmp(segname, SEG_DATA, 16) == 0)
+        return image->lc_table.data_segment;
+    else if (plcrash_async_strncmp(segname, SEG_LINKEDIT, 16) == 0)
+        return image->lc_table.linkedit_segment;
+
     while ((seg = plcrash_async_macho_next_command_type(image, seg, image->m64 ? LC_SEGMENT_64 : LC_SEGMENT)) != 0) {
 
         /* Read the load command */
@@ -504,6 +844,16 @@ plcrash_error_t plcrash_async_macho_map_segment (plcrash_async_macho_t *image, c
 plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *mobj) {
     struct segment_command *cmd_32;
     struct segment_command_64 *cmd_64;
+
+    /* Use the precomputed table where possible */
+    int known = plcrash_async_macho_known_section_index(segname, sectname);
+    if (known >= 0) {
+        plcrash_async_macho_known_section_t *sect = &image->lc_table.sections[known];
+        if (!sect->found)
+            return PLCRASH_ENOTFOUND;
+
+        return plcrash_async_mobject_init(mobj, image->task, sect->addr, sect->size, true);
+    }
     
     void *segment =  plcrash_async_macho_find_segment_cmd(image, segname);
     if (segment == NULL)
@@ -567,6 +917,141 @@ plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, c
     return PLCRASH_ENOTFOUND;
 }
 
+/**
+ * Initialize an empty section cache.
+ *
+ * @param cache The cache to initialize.
+ */
+void plcrash_async_macho_section_cache_init (plcrash_async_macho_section_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        cache->entries[i].image = NULL;
+        cache->entries[i].last_used = 0;
+    }
+    cache->use_count = 0;
+}
+
+/**
+ * Find and map a named section within a named segment of @a image, returning a borrowed reference to a mapping
+ * retained by @a cache. Repeated calls for the same image and section will return the same mapping, avoiding the
+ * cost of remapping the section for every lookup; this is intended for sections that are consulted once per stack
+ * frame, such as the unwind sections. Failed lookups are also cached.
+ *
+ * Once the cache is full, the least-recently-used mapping is released to make room for a new entry. A borrowed
+ * mapping thus remains valid across at least PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE - 1 further lookups.
+ *
+ * @param cache The cache to use, or NULL. If NULL, the section will be mapped into @a storage.
+ * @param image The image to search for @a segname.
+ * @param segname The name of the segment to search.
+ * @param sectname The name of the section to map.
+ * @param storage Storage for an uncached mapping, used if @a cache is NULL.
+ * @param mobj On success, will be set to a reference to the section's mapping. The reference must be returned via
+ * plcrash_async_macho_section_cache_unmap().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the section is not found, or an error result on failure.
+ *
+ * @warning This function is not thread-safe; a cache must not be accessed concurrently from multiple threads.
+ */
+plcrash_error_t plcrash_async_macho_section_cache_map (plcrash_async_macho_section_cache_t *cache,
+                                                       plcrash_async_macho_t *image,
+                                                       const char *segname,
+                                                       const char *sectname,
+                                                       plcrash_async_mobject_t *storage,
+                                                       plcrash_async_mobject_t **mobj)
+{
+    plcrash_async_macho_cached_section_t *entry;
+    plcrash_async_macho_cached_section_t *victim;
+
+    /* Without a cache, the caller owns the mapping */
+    if (cache == NULL) {
+        plcrash_error_t err = plcrash_async_macho_map_section(image, segname, sectname, storage);
+        if (err == PLCRASH_ESUCCESS)
+            *mobj = storage;
+
+        return err;
+    }
+
+    /* Check for an existing mapping, noting the least-recently-used entry in case of a miss */
+    victim = &cache->entries[0];
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        entry = &cache->entries[i];
+        if (entry->image == NULL) {
+            if (victim->image != NULL)
+                victim = entry;
+            continue;
+        }
+
+        if (victim->image != NULL && entry->last_used < victim->last_used)
+            victim = entry;
+
+        if (entry->image != image)
+            continue;
+
+        if (plcrash_async_strncmp(entry->segname, segname, sizeof(entry->segname)) != 0)
+            continue;
+
+        if (plcrash_async_strncmp(entry->sectname, sectname, sizeof(entry->sectname)) != 0)
+            continue;
+
+        entry->last_used = ++cache->use_count;
+        if (entry->result == PLCRASH_ESUCCESS)
+            *mobj = &entry->mobj;
+
+        return entry->result;
+    }
+
+    /* Release the least-recently-used entry, if any */
+    if (victim->image != NULL && victim->result == PLCRASH_ESUCCESS)
+        plcrash_async_mobject_free(&victim->mobj);
+
+    /* Populate the entry. The names are truncated to the Mach-O maximum of 16 bytes, matching the
+     * comparison performed by plcrash_async_macho_map_section(). */
+    entry = victim;
+    plcrash_async_memset(entry->segname, 0, sizeof(entry->segname));
+    plcrash_async_memset(entry->sectname, 0, sizeof(entry->sectname));
+    for (size_t i = 0; i < sizeof(entry->segname) && segname[i] != '\0'; i++)
+        entry->segname[i] = segname[i];
+    for (size_t i = 0; i < sizeof(entry->sectname) && sectname[i] != '\0'; i++)
+        entry->sectname[i] = sectname[i];
+
+    entry->image = image;
+    entry->result = plcrash_async_macho_map_section(image, segname, sectname, &entry->mobj);
+    entry->last_used = ++cache->use_count;
+
+    if (entry->result == PLCRASH_ESUCCESS)
+        *mobj = &entry->mobj;
+
+    return entry->result;
+}
+
+/**
+ * Return a mapping fetched via plcrash_async_macho_section_cache_map(). If the mapping is retained by @a cache, this
+ * is a no-op; otherwise, the uncached mapping is freed.
+ *
+ * @param cache The cache supplied to plcrash_async_macho_section_cache_map(), or NULL.
+ * @param mobj The mapping to return.
+ */
+void plcrash_async_macho_section_cache_unmap (plcrash_async_macho_section_cache_t *cache, plcrash_async_mobject_t *mobj) {
+    if (cache == NULL)
+        plcrash_async_mobject_free(mobj);
+}
+
+/**
+ * Release all mappings retained by @a cache. The cache is left empty, and may be reused.
+ *
+ * @param cache The cache to free.
+ */
+void plcrash_async_macho_section_cache_free (plcrash_async_macho_section_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        plcrash_async_macho_cached_section_t *entry = &cache->entries[i];
+        if (entry->image != NULL && entry->result == PLCRASH_ESUCCESS)
+            plcrash_async_mobject_free(&entry->mobj);
+
+        entry->image = NULL;
+        entry->last_used = 0;
+    }
+    cache->use_count = 0;
+}
+
 /**
  * @internal
  * Common wrapper of nlist/nlist_64. We verify that this union is valid for our purposes in pl_async_macho_find_symtab_symbol().
@@ -602,21 +1087,25 @@ plcrash_error_t plcrash_async_macho_find_symbol_by_name (plcrash_async_macho_t *
 
     /* Walk all symbol entries and return on the first name match */
     const char *sym = NULL;
-    plcrash_async_macho_symtab_entry_t entry;
-    for (uint32_t i = 0; i < reader.nsyms; i++) {
-        entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, i);
+    plcrash_async_macho_symtab_entry_t entries[PL_SYMTAB_BATCH_SIZE];
+    for (uint32_t base = 0; base < reader.nsyms; base += PL_SYMTAB_BATCH_SIZE) {
+        uint32_t count = PL_SYMTAB_BATCH_COUNT(reader.nsyms, base);
+        plcrash_async_macho_symtab_reader_read_batch(&reader, reader.symtab, base, count, entries);
 
-        /* Symbol must be within a section, and must not be a debugging entry. */
-        if ((entry.n_type & N_TYPE) != N_SECT || ((entry.n_type & N_STAB) != 0))
-            continue;
+        for (uint32_t i = 0; i < count; i++) {
+            plcrash_async_macho_symtab_entry_t *entry = &entries[i];
 
-        /* Check the name */
-        sym = plcrash_async_macho_symtab_reader_symbol_name(&reader, entry.n_strx);
-        if (sym != NULL && plcrash_async_strcmp(sym, symbol) == 0) {
-            plcrash_async_macho_symtab_reader_free(&reader);
+            /* Symbol must be within a section, and must not be a debugging entry. */
+            if ((entry->n_type & N_TYPE) != N_SECT || ((entry->n_type & N_STAB) != 0))
+                continue;
 
-            *pc = entry.normalized_value + image->vmaddr_slide;
-            return PLCRASH_ESUCCESS;
+            /* Check the name */
+            sym = plcrash_async_macho_symtab_reader_symbol_name(&reader, entry->n_strx);
+            if (sym != NULL && plcrash_async_strcmp(sym, symbol) == 0) {
+                *pc = entry->normalized_value + image->vmaddr_slide;
+                plcrash_async_macho_symtab_reader_free(&reader);
+                return PLCRASH_ESUCCESS;
+            }
         }
     }
 
@@ -625,7 +1114,53 @@ plcrash_error_t plcrash_async_macho_find_symbol_by_name (plcrash_async_macho_t *
 }
 
 /**
- * Initialize a new symbol table reader, mapping the LINKEDIT segment from @a image into the current process.
+ * @internal
+ *
+ * Compute the task-relative address of the @a length bytes at file offset @a fileoff within @a image's __LINKEDIT
+ * segment.
+ *
+ * @param image The image containing the __LINKEDIT segment.
+ * @param fileoff The file offset of the data.
+ * @param length The length of the data.
+ * @param addr On success, the task-relative address of the data.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the image has no __LINKEDIT segment, or
+ * PLCRASH_EINVAL if the range does not fall within the segment.
+ */
+static plcrash_error_t plcrash_async_macho_linkedit_address (plcrash_async_macho_t *image, uint64_t fileoff, uint64_t length, pl_vm_address_t *addr) {
+    void *segment = plcrash_async_macho_find_segment_cmd(image, SEG_LINKEDIT);
+    if (segment == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    pl_vm_address_t segaddr;
+    uint64_t segoff;
+    uint64_t segsize;
+    if (image->m64) {
+        struct segment_command_64 *cmd_64 = segment;
+        segaddr = image->byteorder->swap64(cmd_64->vmaddr) + image->vmaddr_slide;
+        segoff = image->byteorder->swap64(cmd_64->fileoff);
+        segsize = image->byteorder->swap64(cmd_64->filesize);
+    } else {
+        struct segment_command *cmd_32 = segment;
+        segaddr = image->byteorder->swap32(cmd_32->vmaddr) + image->vmaddr_slide;
+        segoff = image->byteorder->swap32(cmd_32->fileoff);
+        segsize = image->byteorder->swap32(cmd_32->filesize);
+    }
+
+    if (fileoff < segoff || fileoff - segoff > segsize || length > segsize - (fileoff - segoff))
+        return PLCRASH_EINVAL;
+
+    *addr = segaddr + (fileoff - segoff);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Initialize a new symbol table reader, mapping the symbol table from @a image's LINKEDIT segment into the current
+ * process.
+ *
+ * Only the symbol table itself is mapped by this function; string table pages are mapped on demand by
+ * plcrash_async_macho_symtab_reader_symbol_name(), allowing the cost of symbol lookup to scale with the number of
+ * names read, rather than the size of the image's LINKEDIT segment.
  *
  * @param reader The reader to be initialized.
  * @param image The image from which the symbol table will be mapped.
@@ -646,13 +1181,6 @@ plcrash_error_t plcrash_async_macho_symtab_reader_init (plcrash_async_macho_symt
         return PLCRASH_ENOTFOUND;
     }
     
-    /* Map in the __LINKEDIT segment, which includes the symbol and string tables */
-    plcrash_error_t err = plcrash_async_macho_map_segment(image, "__LINKEDIT", &reader->linkedit);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("plcrash_async_mobject_init() failure: %d in %s", err, image->name);
-        return PLCRASH_EINTERNAL;
-    }
-    
     /* Determine the string and symbol table sizes. */
     uint32_t nsyms = image->byteorder->swap32(symtab_cmd->nsyms);
     size_t nlist_struct_size = image->m64 ? sizeof(struct nlist_64) : sizeof(struct nlist);
@@ -660,30 +1188,45 @@ plcrash_error_t plcrash_async_macho_symtab_reader_init (plcrash_async_macho_symt
     
     size_t string_size = image->byteorder->swap32(symtab_cmd->strsize);
     
-    /* Fetch pointers to the symbol and string tables, and verify their size values */
-    void *nlist_table;
-    char *string_table;
-    
-    nlist_table = plcrash_async_mobject_remap_address(&reader->linkedit.mobj, reader->linkedit.mobj.task_address, (image->byteorder->swap32(symtab_cmd->symoff) - reader->linkedit.fileoff), nlist_table_size);
+    /* Locate the symbol and string tables within __LINKEDIT, and verify their size values */
+    pl_vm_address_t nlist_addr;
+    pl_vm_address_t string_addr;
+    plcrash_error_t err;
+
+    err = plcrash_async_macho_linkedit_address(image, image->byteorder->swap32(symtab_cmd->symoff), nlist_table_size, &nlist_addr);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("symoff %" PRIx32 " (size %" PRIx64 ") not found within __LINKEDIT in %s: %d", image->byteorder->swap32(symtab_cmd->symoff),
+                   (uint64_t) nlist_table_size, image->name, err);
+        return PLCRASH_EINTERNAL;
+    }
+
+    err = plcrash_async_macho_linkedit_address(image, image->byteorder->swap32(symtab_cmd->stroff), string_size, &string_addr);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("stroff %" PRIx32 " (size %" PRIx64 ") not found within __LINKEDIT in %s: %d", image->byteorder->swap32(symtab_cmd->stroff),
+                   (uint64_t) string_size, image->name, err);
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Map in the symbol table */
+    err = plcrash_async_mobject_init(&reader->symtab_mobj, image->task, nlist_addr, nlist_table_size, true);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("plcrash_async_mobject_init() failure: %d mapping __LINKEDIT.symoff in %s", err, image->name);
+        return PLCRASH_EINTERNAL;
+    }
+
+    void *nlist_table = plcrash_async_mobject_remap_address(&reader->symtab_mobj, nlist_addr, 0, nlist_table_size);
     if (nlist_table == NULL) {
         PLCF_DEBUG("plcrash_async_mobject_remap_address(mobj, %" PRIx64 ", %" PRIx64") returned NULL mapping __LINKEDIT.symoff in %s",
-                   (uint64_t) reader->linkedit.mobj.address + image->byteorder->swap32(symtab_cmd->symoff), (uint64_t) nlist_table_size, image->name);
-        retval = PLCRASH_EINTERNAL;
-        goto cleanup;
-    }
-    
-    string_table = plcrash_async_mobject_remap_address(&reader->linkedit.mobj, reader->linkedit.mobj.task_address, (image->byteorder->swap32(symtab_cmd->stroff) - reader->linkedit.fileoff), string_size);
-    if (string_table == NULL) {
-        PLCF_DEBUG("plcrash_async_mobject_remap_address(mobj, %" PRIx64 ", %" PRIx64") returned NULL mapping __LINKEDIT.stroff in %s",
-                   (uint64_t) reader->linkedit.mobj.address + image->byteorder->swap32(symtab_cmd->stroff), (uint64_t) string_size, image->name);
+                   (uint64_t) nlist_addr, (uint64_t) nlist_table_size, image->name);
         retval = PLCRASH_EINTERNAL;
         goto cleanup;
     }
 
     /* Initialize common elements. */
     reader->image = image;
-    reader->string_table = string_table;
+    reader->string_table_addr = string_addr;
     reader->string_table_size = string_size;
+    reader->string_window_mapped = false;
     reader->symtab = nlist_table;
     reader->nsyms = nsyms;
 
@@ -722,7 +1265,7 @@ plcrash_error_t plcrash_async_macho_symtab_reader_init (plcrash_async_macho_symt
     return PLCRASH_ESUCCESS;
     
 cleanup:
-    plcrash_async_macho_mapped_segment_free(&reader->linkedit);
+    plcrash_async_mobject_free(&reader->symtab_mobj);
     return retval;
 }
 
@@ -757,7 +1300,7 @@ plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcra
 #undef pl_m_sizeof
     }
 
-#define pl_sym_value(image, nl) (image->m64 ? image->byteorder->swap64((nl)->n64.n_value) : image->byteorder->swap32((nl)->n32.n_value))
+#define pl_sym_value(image, nl) (image->m64 ? plcrash_async_byteorder_swap64(image->byteorder, (nl)->n64.n_value) : plcrash_async_byteorder_swap32(image->byteorder, (nl)->n32.n_value))
 
     /* Perform 32-bit/64-bit dependent aliased pointer math. */
     pl_nlist_common *symbol;
@@ -768,10 +1311,10 @@ plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcra
     }
     
     plcrash_async_macho_symtab_entry_t entry = {
-        .n_strx = byteorder->swap32(symbol->n32.n_un.n_strx),
+        .n_strx = plcrash_async_byteorder_swap32(byteorder, symbol->n32.n_un.n_strx),
         .n_type = symbol->n32.n_type,
         .n_sect = symbol->n32.n_sect,
-        .n_desc = byteorder->swap16(symbol->n32.n_desc),
+        .n_desc = plcrash_async_byteorder_swap16(byteorder, symbol->n32.n_desc),
         .n_value = pl_sym_value(reader->image, symbol)
     };
     
@@ -789,31 +1332,143 @@ plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcra
 }
 
 /**
- * Given a string table offset for @a reader, returns the pointer to the validated NULL terminated string, or returns
- * NULL if the string does not fall within the reader's mapped string table.
+ * @internal
+ *
+ * Decode @a count nlist entries of type @a nlist_type from @a symtab, starting at @a index, using the given
+ * 16-bit, 32-bit, and n_value byte swap expressions.
+ */
+#define PL_DECODE_NLIST_BATCH(nlist_type, symtab, index, count, entries, swap16, swap32, swap_value) do { \
+    const struct nlist_type *nl = ((const struct nlist_type *) (symtab)) + (index); \
+    for (uint32_t i = 0; i < (count); i++) { \
+        plcrash_async_macho_symtab_entry_t *entry = &(entries)[i]; \
+        entry->n_strx = swap32(nl[i].n_un.n_strx); \
+        entry->n_type = nl[i].n_type; \
+        entry->n_sect = nl[i].n_sect; \
+        entry->n_desc = swap16(nl[i].n_desc); \
+        entry->n_value = swap_value(nl[i].n_value); \
+        entry->normalized_value = (entry->n_desc & N_ARM_THUMB_DEF) ? (entry->n_value|1) : entry->n_value; \
+    } \
+} while (0)
+
+/** @internal Identity swap used by PL_DECODE_NLIST_BATCH for host byte order symbol tables. */
+#define pl_nswap(v) (v)
+
+/**
+ * Decode @a count entries from @a symtab, starting at entry @a index, into @a entries. This is equivalent to calling
+ * plcrash_async_macho_symtab_reader_read() for each entry, but avoids its per-entry dispatch on the image's word size
+ * and byte order; symbol table scans should prefer this function.
+ *
+ * @param reader The reader from which @a symtab was fetched.
+ * @param symtab The symtab from which the entries will be read. Must be a pointer within reader->symtab.
+ * @param index The index of the first entry to read.
+ * @param count The number of entries to read. The caller is responsible for ensuring that all entries are within
+ * the bounds of @a symtab.
+ * @param entries The destination for the decoded entries. Must have room for at least @a count entries.
+ */
+void plcrash_async_macho_symtab_reader_read_batch (plcrash_async_macho_symtab_reader_t *reader, void *symtab, uint32_t index, uint32_t count, plcrash_async_macho_symtab_entry_t *entries) {
+    const plcrash_async_byteorder_t *byteorder = reader->image->byteorder;
+
+    /* The host byte order is by far the common case; specialize it to straight-line loads */
+    if (byteorder == &plcrash_async_byteorder_direct) {
+        if (reader->image->m64) {
+            PL_DECODE_NLIST_BATCH(nlist_64, symtab, index, count, entries, pl_nswap, pl_nswap, pl_nswap);
+        } else {
+            PL_DECODE_NLIST_BATCH(nlist, symtab, index, count, entries, pl_nswap, pl_nswap, pl_nswap);
+        }
+    } else {
+        if (reader->image->m64) {
+            PL_DECODE_NLIST_BATCH(nlist_64, symtab, index, count, entries, byteorder->swap16, byteorder->swap32, byteorder->swap64);
+        } else {
+            PL_DECODE_NLIST_BATCH(nlist, symtab, index, count, entries, byteorder->swap16, byteorder->swap32, byteorder->swap32);
+        }
+    }
+}
+
+#undef pl_nswap
+#undef PL_DECODE_NLIST_BATCH
+
+/**
+ * @internal
+ *
+ * Map the string table window of @a reader that begins at the page containing string table offset @a n_strx,
+ * replacing any existing window.
+ *
+ * @param reader The reader for which the window will be mapped.
+ * @param n_strx The string table offset to be mapped. Must be less than the string table size.
+ */
+static plcrash_error_t plcrash_async_macho_symtab_reader_map_strings (plcrash_async_macho_symtab_reader_t *reader, uint32_t n_strx) {
+    if (reader->string_window_mapped) {
+        plcrash_async_mobject_free(&reader->string_window);
+        reader->string_window_mapped = false;
+    }
+
+    /* Start the window at the page boundary preceding the string, bounded by the start of the string table */
+    pl_vm_address_t page = mach_vm_trunc_page(reader->string_table_addr + n_strx);
+    size_t offset = page > reader->string_table_addr ? (size_t) (page - reader->string_table_addr) : 0;
+    size_t length = reader->string_table_size - offset;
+    if (length > PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE)
+        length = PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE;
+
+    /* Permit short mappings; the window need only include the string being read */
+    plcrash_error_t err = plcrash_async_mobject_init(&reader->string_window, reader->image->task, reader->string_table_addr + offset, length, false);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("plcrash_async_mobject_init() failure: %d mapping __LINKEDIT.stroff+%zx in %s", err, offset, reader->image->name);
+        return err;
+    }
+
+    reader->string_window_offset = offset;
+    reader->string_window_length = (size_t) reader->string_window.length;
+    reader->string_window_mapped = true;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Given a string table offset for @a reader, returns the pointer to the validated NULL terminated string, or returns
+ * NULL if the string does not fall within the reader's string table.
+ *
+ * The string table is mapped on demand, in windows of at most PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE bytes; the
+ * returned pointer is only valid until the next call to this function, or until @a reader is freed.
  *
- * @param reader The reader containing a mapped string table.
+ * @param reader The reader containing a string table.
  * @param n_strx The index within the @a reader string table to a symbol name.
  */
 const char *plcrash_async_macho_symtab_reader_symbol_name (plcrash_async_macho_symtab_reader_t *reader, uint32_t n_strx) {
-    /* 
-     * It's possible, though unlikely, that the n_strx index value is invalid. To handle this,
-     * we walk the string until \0 is hit, verifying that it can be found in its entirety within
-     *
-     * TODO: Evaluate effeciency of per-byte calling of plcrash_async_mobject_verify_local_pointer(). We should
-     * probably validate whole pages at a time instead.
-     */
-    const char *sym_name = reader->string_table + n_strx;
-    const char *p = sym_name;
-    do {
-        if (!plcrash_async_mobject_verify_local_pointer(&reader->linkedit.mobj, (uintptr_t) p, 0, 1)) {
-            PLCF_DEBUG("End of mobject reached while walking string\n");
+    /* It's possible, though unlikely, that the n_strx index value is invalid. */
+    if (n_strx >= reader->string_table_size) {
+        PLCF_DEBUG("String table offset %" PRIx32 " exceeds the string table size\n", n_strx);
+        return NULL;
+    }
+
+    /* Map a new window if the string does not begin within the current window */
+    bool fresh = false;
+    if (!reader->string_window_mapped || n_strx < reader->string_window_offset || n_strx - reader->string_window_offset >= reader->string_window_length) {
+        if (plcrash_async_macho_symtab_reader_map_strings(reader, n_strx) != PLCRASH_ESUCCESS)
             return NULL;
+        fresh = true;
+    }
+
+    while (true) {
+        /* Verify that the string is terminated within the window */
+        const char *window = (const char *) reader->string_window.address;
+        size_t start = n_strx - reader->string_window_offset;
+        for (size_t i = start; i < reader->string_window_length; i++) {
+            if (window[i] == '\0')
+                return window + start;
         }
-        p++;
-    } while (*p != '\0');
 
-    return sym_name;
+        /* The string may extend beyond a window that was mapped for an earlier string; remap the window at the
+         * string's page. If the window was already mapped for this string, the string is unterminated (or longer than
+         * the window permits). */
+        if (fresh) {
+            PLCF_DEBUG("End of string table window reached while walking string\n");
+            return NULL;
+        }
+
+        if (plcrash_async_macho_symtab_reader_map_strings(reader, n_strx) != PLCRASH_ESUCCESS)
+            return NULL;
+        fresh = true;
+    }
 }
 
 /**
@@ -822,8 +1477,99 @@ const char *plcrash_async_macho_symtab_reader_symbol_name (plcrash_async_macho_s
  * @note Unlike most free() functions in this API, this function is async-safe.
  */
 void plcrash_async_macho_symtab_reader_free (plcrash_async_macho_symtab_reader_t *reader) {
-    plcrash_async_macho_mapped_segment_free(&reader->linkedit);
+    if (reader->string_window_mapped) {
+        plcrash_async_mobject_free(&reader->string_window);
+        reader->string_window_mapped = false;
+    }
+
+    plcrash_async_mobject_free(&reader->symtab_mobj);
+}
+
+#ifdef __clang__
+/** @internal A vector of four 64-bit lanes. */
+typedef uint64_t pl_nlist_u64x4 __attribute__((ext_vector_type(4)));
+
+/** @internal A vector of four 64-bit comparison mask lanes. */
+typedef int64_t pl_nlist_i64x4 __attribute__((ext_vector_type(4)));
+
+/**
+ * @internal
+ *
+ * Vectorized equivalent of the plcrash_async_macho_find_best_symbol() scan, for host byte order nlist_64 tables.
+ *
+ * The eligibility (N_SECT, non-STAB, n_value <= slide_pc) and improvement (n_value > best) tests are evaluated across
+ * four entries at a time; as the best value only increases, blocks containing a candidate are rare, and are resolved
+ * in scan order to preserve the scalar tie-breaking behavior.
+ *
+ * @param symtab The host byte order nlist_64 table to scan.
+ * @param nsyms The number of entries in @a symtab.
+ * @param slide_pc The PC to be matched.
+ * @param have_best If true, only entries with an n_value greater than @a best_value will be considered.
+ * @param best_value The current best match's n_value, if @a have_best is true.
+ * @param best_index On return, the index of the best match within @a symtab, if any.
+ *
+ * @return Returns true if a new best match was found.
+ */
+bool plcrash_async_macho_scan_nlist64_direct (const struct nlist_64 *symtab, uint32_t nsyms, pl_vm_address_t slide_pc,
+                                              bool have_best, uint64_t best_value, uint32_t *best_index)
+{
+    bool found = false;
+    uint32_t i = 0;
+
+    /* Until a candidate has been found, any eligible entry is an improvement */
+    pl_nlist_i64x4 any_improves = have_best ? (pl_nlist_i64x4) 0 : (pl_nlist_i64x4) -1;
+
+    const pl_nlist_u64x4 pc_vec = (pl_nlist_u64x4) slide_pc;
+    const pl_nlist_u64x4 type_mask = (pl_nlist_u64x4) (N_TYPE|N_STAB);
+    const pl_nlist_u64x4 type_sect = (pl_nlist_u64x4) N_SECT;
+
+    for (; i + 4 <= nsyms; i += 4) {
+        const struct nlist_64 *nl = &symtab[i];
+        pl_nlist_u64x4 values = { nl[0].n_value, nl[1].n_value, nl[2].n_value, nl[3].n_value };
+        pl_nlist_u64x4 types = { nl[0].n_type, nl[1].n_type, nl[2].n_type, nl[3].n_type };
+
+        pl_nlist_i64x4 candidates = ((types & type_mask) == type_sect) & (values <= pc_vec) & ((values > (pl_nlist_u64x4) best_value) | any_improves);
+        if ((candidates.x | candidates.y | candidates.z | candidates.w) == 0)
+            continue;
+
+        /* Resolve the block in scan order */
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint8_t type = nl[lane].n_type;
+            uint64_t value = nl[lane].n_value;
+
+            if ((type & N_TYPE) != N_SECT || (type & N_STAB) != 0 || value > slide_pc)
+                continue;
+
+            if (!have_best || best_value < value) {
+                best_value = value;
+                have_best = true;
+                *best_index = i + lane;
+                found = true;
+            }
+        }
+
+        any_improves = (pl_nlist_i64x4) 0;
+    }
+
+    /* Scan the remaining entries */
+    for (; i < nsyms; i++) {
+        uint8_t type = symtab[i].n_type;
+        uint64_t value = symtab[i].n_value;
+
+        if ((type & N_TYPE) != N_SECT || (type & N_STAB) != 0 || value > slide_pc)
+            continue;
+
+        if (!have_best || best_value < value) {
+            best_value = value;
+            have_best = true;
+            *best_index = i;
+            found = true;
+        }
+    }
+
+    return found;
 }
+#endif /* __clang__ */
 
 /*
  * Locate a symtab entry for @a slide_pc within @a symbtab. This is performed using best-guess heuristics, and may
@@ -848,32 +1594,341 @@ static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_rea
                                                   plcrash_async_macho_symtab_entry_t *prev_symbol,
                                                   bool *did_find_symbol)
 {
-    plcrash_async_macho_symtab_entry_t new_entry;
+    plcrash_async_macho_symtab_entry_t entries[PL_SYMTAB_BATCH_SIZE];
     
     /* Set did_find_symbol to false by default */
     if (prev_symbol == NULL)
         *did_find_symbol = false;
 
+#ifdef __clang__
+    /* Use the vectorized scan for (the common case of) host byte order 64-bit tables */
+    if (reader->image->m64 && reader->image->byteorder == &plcrash_async_byteorder_direct) {
+        uint32_t best_index;
+        bool have_best = *did_find_symbol;
+        uint64_t best_value = have_best ? prev_symbol->n_value : 0;
+
+        if (plcrash_async_macho_scan_nlist64_direct((const struct nlist_64 *) symtab, nsyms, slide_pc, have_best, best_value, &best_index)) {
+            *found_symbol = plcrash_async_macho_symtab_reader_read(reader, symtab, best_index);
+            *did_find_symbol = true;
+        }
+        return;
+    }
+#endif
+
     /* Walk the symbol table. We know that symbols[i] is valid, since we fetched a pointer+len based on the value using
      * plcrash_async_mobject_remap_address() above. */
-    for (uint32_t i = 0; i < nsyms; i++) {
-        new_entry = plcrash_async_macho_symtab_reader_read(reader, symtab, i);
-        
-        /* Symbol must be within a section, and must not be a debugging entry. */
-        if ((new_entry.n_type & N_TYPE) != N_SECT || ((new_entry.n_type & N_STAB) != 0))
-            continue;
+    for (uint32_t base = 0; base < nsyms; base += PL_SYMTAB_BATCH_SIZE) {
+        uint32_t count = PL_SYMTAB_BATCH_COUNT(nsyms, base);
+        plcrash_async_macho_symtab_reader_read_batch(reader, symtab, base, count, entries);
 
-        /* Search for the best match. We're looking for the closest symbol occuring before PC. */
-        if (new_entry.n_value <= slide_pc && (!*did_find_symbol || prev_symbol->n_value < new_entry.n_value)) {
-            *found_symbol = new_entry;
+        for (uint32_t i = 0; i < count; i++) {
+            plcrash_async_macho_symtab_entry_t *new_entry = &entries[i];
 
-            /* The newly found symbol is now the symbol to be matched against */
-            prev_symbol = found_symbol;
-            *did_find_symbol = true;
+            /* Symbol must be within a section, and must not be a debugging entry. */
+            if ((new_entry->n_type & N_TYPE) != N_SECT || ((new_entry->n_type & N_STAB) != 0))
+                continue;
+
+            /* Search for the best match. We're looking for the closest symbol occuring before PC. */
+            if (new_entry->n_value <= slide_pc && (!*did_find_symbol || prev_symbol->n_value < new_entry->n_value)) {
+                *found_symbol = *new_entry;
+
+                /* The newly found symbol is now the symbol to be matched against */
+                prev_symbol = found_symbol;
+                *did_find_symbol = true;
+            }
+        }
+    }
+}
+
+/**
+ * @internal
+ * qsort() comparison function for plcrash_async_macho_symbol_index_entry_t values. Entries are sorted by ascending
+ * address; entries sharing an address are sorted by descending scan order, placing the entry that a linear scan
+ * would have selected last within its run.
+ */
+static int plcrash_async_macho_symbol_index_compare (const void *a, const void *b) {
+    const plcrash_async_macho_symbol_index_entry_t *lhs = a;
+    const plcrash_async_macho_symbol_index_entry_t *rhs = b;
+
+    if (lhs->n_value < rhs->n_value)
+        return -1;
+    else if (lhs->n_value > rhs->n_value)
+        return 1;
+
+    if (lhs->scan_order > rhs->scan_order)
+        return -1;
+    else if (lhs->scan_order < rhs->scan_order)
+        return 1;
+
+    return 0;
+}
+
+/**
+ * @internal
+ * Walk the @a nsyms entries of @a symtab, counting all symbols that are eligible for address lookup, and if @a entries is
+ * non-NULL, appending them to @a entries.
+ *
+ * @param reader The symbol table reader from which @a symtab was fetched.
+ * @param symtab The symtab to walk. Must be a pointer within reader->symtab.
+ * @param nsyms The number of nlist entries available via @a symtab.
+ * @param entries If non-NULL, the destination for eligible entries. Must have room for at least @a nsyms entries
+ * following @a *count.
+ * @param count On input, the number of entries already recorded. On return, will be incremented by the number of
+ * eligible symbols found.
+ */
+static void plcrash_async_macho_symbol_index_collect (plcrash_async_macho_symtab_reader_t *reader,
+                                                      void *symtab, uint32_t nsyms,
+                                                      plcrash_async_macho_symbol_index_entry_t *entries,
+                                                      uint32_t *count)
+{
+    size_t nlist_size = reader->image->m64 ? sizeof(struct nlist_64) : sizeof(struct nlist);
+    uint32_t base_index = (uint32_t) (((uint8_t *) symtab - (uint8_t *) reader->symtab) / nlist_size);
+
+    plcrash_async_macho_symtab_entry_t batch[PL_SYMTAB_BATCH_SIZE];
+    for (uint32_t base = 0; base < nsyms; base += PL_SYMTAB_BATCH_SIZE) {
+        uint32_t batch_count = PL_SYMTAB_BATCH_COUNT(nsyms, base);
+        plcrash_async_macho_symtab_reader_read_batch(reader, symtab, base, batch_count, batch);
+
+        for (uint32_t i = 0; i < batch_count; i++) {
+            plcrash_async_macho_symtab_entry_t *entry = &batch[i];
+
+            /* Symbol must be within a section, and must not be a debugging entry. */
+            if ((entry->n_type & N_TYPE) != N_SECT || ((entry->n_type & N_STAB) != 0))
+                continue;
+
+            if (entries != NULL) {
+                entries[*count].n_value = entry->n_value;
+                entries[*count].symtab_index = base_index + base + i;
+                entries[*count].scan_order = *count;
+            }
+
+            (*count)++;
         }
     }
 }
 
+/**
+ * Build an address-sorted symbol index for @a image, allowing plcrash_async_macho_find_symbol_by_pc() to perform
+ * a binary search rather than a linear walk of the symbol table. The index is allocated from the image's backing
+ * allocator, and will be freed by plcrash_async_macho_free().
+ *
+ * If an index has already been built for @a image, this function has no effect. If the image contains no symbols
+ * eligible for lookup, no index will be built, and lookups will continue to use a linear scan.
+ *
+ * @param image The image for which a symbol index should be built.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or one of the plcrash_error_t error values on failure. On failure,
+ * lookups will continue to use a linear scan of the symbol table.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with itself for the same @a image. It
+ * may be called concurrently with crash-time lookups; the index is only published once it has been fully populated.
+ */
+plcrash_error_t plcrash_nasync_macho_build_symbol_index (plcrash_async_macho_t *image) {
+    plcrash_async_macho_symtab_reader_t reader;
+    plcrash_async_macho_symbol_index_entry_t *entries;
+    uint32_t count = 0;
+    uint32_t filled = 0;
+    plcrash_error_t retval;
+
+    if (image->symbol_index != NULL)
+        return PLCRASH_ESUCCESS;
+
+    /* Initialize a symbol table reader */
+    retval = plcrash_async_macho_symtab_reader_init(&reader, image);
+    if (retval != PLCRASH_ESUCCESS)
+        return retval;
+
+    /* Determine the tables to be indexed, in the same order as they're searched by plcrash_async_macho_find_symbol_by_pc() */
+    void *symtabs[2];
+    uint32_t nsyms[2];
+    size_t ntables;
+    if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+        symtabs[0] = reader.symtab_global;
+        nsyms[0] = reader.nsyms_global;
+        symtabs[1] = reader.symtab_local;
+        nsyms[1] = reader.nsyms_local;
+        ntables = 2;
+    } else {
+        symtabs[0] = reader.symtab;
+        nsyms[0] = reader.nsyms;
+        ntables = 1;
+    }
+
+    /* Count the eligible symbols */
+    for (size_t i = 0; i < ntables; i++)
+        plcrash_async_macho_symbol_index_collect(&reader, symtabs[i], nsyms[i], NULL, &count);
+
+    if (count == 0) {
+        retval = PLCRASH_ESUCCESS;
+        goto cleanup;
+    }
+
+    /* Populate and sort the index */
+    retval = plcrash_async_allocator_alloc(image->_allocator, (void **) &entries, sizeof(entries[0]) * count);
+    if (retval != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate a symbol index of %" PRIu32 " entries for %s", count, image->name);
+        goto cleanup;
+    }
+
+    for (size_t i = 0; i < ntables; i++)
+        plcrash_async_macho_symbol_index_collect(&reader, symtabs[i], nsyms[i], entries, &filled);
+    PLCF_ASSERT(filled == count);
+
+    qsort(entries, count, sizeof(entries[0]), plcrash_async_macho_symbol_index_compare);
+
+    /* Publish the index; the count must be visible before the index pointer */
+    image->symbol_index_count = count;
+    OSMemoryBarrier();
+    image->symbol_index = entries;
+
+    // fall through to cleanup
+    retval = PLCRASH_ESUCCESS;
+
+cleanup:
+    plcrash_async_macho_symtab_reader_free(&reader);
+    return retval;
+}
+
+/**
+ * Cache a pre-encoded copy of @a image's crash log binary image record, allowing report writers to emit the record
+ * with a single write rather than re-deriving the image's UUID, name, and code type for every report. The record is
+ * copied into storage allocated from the image's backing allocator, and will be freed by plcrash_async_macho_free().
+ *
+ * If a record has already been cached for @a image, this function has no effect.
+ *
+ * @param image The image for which the record should be cached.
+ * @param data The encoded record.
+ * @param size The size of @a data, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the record was cached, or if a record was already cached, or one of the
+ * plcrash_error_t error values on failure.
+ *
+ * @warning This method is async-safe, and may be called concurrently with itself and with crash-time report writing;
+ * the record is only published once it has been fully populated.
+ */
+plcrash_error_t plcrash_async_macho_set_encoded_record (plcrash_async_macho_t *image, const void *data, size_t size) {
+    plcrash_error_t err;
+    void *record;
+
+    if (image->encoded_record != NULL)
+        return PLCRASH_ESUCCESS;
+
+    if ((err = plcrash_async_allocator_alloc(image->_allocator, &record, size)) != PLCRASH_ESUCCESS)
+        return err;
+
+    plcrash_async_memcpy(record, data, size);
+
+    /* Publish the record; the size must be visible before the record pointer. If another writer published a record
+     * first, the records are identical, and ours may be discarded. */
+    image->encoded_record_size = size;
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, record, (void * volatile *) &image->encoded_record))
+        plcrash_async_allocator_dealloc(image->_allocator, record);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Advise the kernel that @a image's __LINKEDIT symbol and string tables will be needed, via
+ * madvise(MADV_WILLNEED), allowing their pages to be read in ahead of any crash-time symbol lookup. This is purely
+ * advisory; the pages may still be evicted before use.
+ *
+ * @param image The image to advise. The image must be resident within the current task.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if @a image does not reside within the current task,
+ * PLCRASH_ENOTFOUND if the image has no symbol table, PLCRASH_EINVALID_DATA if the symbol table does not lie within
+ * __LINKEDIT, or PLCRASH_EINTERNAL if madvise() fails.
+ *
+ * @warning This function is not async-safe, and is intended to be called from an idle background pass.
+ */
+plcrash_error_t plcrash_nasync_macho_advise_linkedit (plcrash_async_macho_t *image) {
+    struct symtab_command *symtab_cmd;
+    pl_vm_address_t linkedit_vmaddr;
+    uint64_t linkedit_fileoff;
+
+    /* madvise() only applies to our own address space */
+    if (image->task != mach_task_self())
+        return PLCRASH_ENOTSUP;
+
+    symtab_cmd = plcrash_async_macho_find_command(image, LC_SYMTAB);
+    void *linkedit_cmd = plcrash_async_macho_find_segment_cmd(image, SEG_LINKEDIT);
+    if (symtab_cmd == NULL || linkedit_cmd == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    if (image->m64) {
+        struct segment_command_64 *cmd_64 = linkedit_cmd;
+        linkedit_vmaddr = image->byteorder->swap64(cmd_64->vmaddr) + image->vmaddr_slide;
+        linkedit_fileoff = image->byteorder->swap64(cmd_64->fileoff);
+    } else {
+        struct segment_command *cmd_32 = linkedit_cmd;
+        linkedit_vmaddr = image->byteorder->swap32(cmd_32->vmaddr) + image->vmaddr_slide;
+        linkedit_fileoff = image->byteorder->swap32(cmd_32->fileoff);
+    }
+
+    /* The symbol and string tables are adjacent in __LINKEDIT; advise the range spanning both */
+    uint64_t symoff = image->byteorder->swap32(symtab_cmd->symoff);
+    uint64_t stroff = image->byteorder->swap32(symtab_cmd->stroff);
+    uint64_t strsize = image->byteorder->swap32(symtab_cmd->strsize);
+    uint64_t start_off = symoff < stroff ? symoff : stroff;
+    if (start_off < linkedit_fileoff)
+        return PLCRASH_EINVALID_DATA;
+
+    vm_address_t start = trunc_page(linkedit_vmaddr + (start_off - linkedit_fileoff));
+    vm_address_t end = round_page(linkedit_vmaddr + (stroff + strsize - linkedit_fileoff));
+
+    if (madvise((void *) start, end - start, MADV_WILLNEED) != 0) {
+        PLCF_DEBUG("madvise() of __LINKEDIT failed for %s: %d", plcrash_async_macho_name(image), errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ * Use @a image's symbol index to locate the closest symbol occuring at or before @a slide_pc. The result is identical
+ * to that produced by plcrash_async_macho_find_best_symbol().
+ *
+ * @param image The image to be searched. The image must have a non-NULL symbol_index.
+ * @param reader A symbol table reader initialized for @a image.
+ * @param slide_pc The PC value within the target process for which symbol information should be found. The VM slide
+ * address should have already been applied to this value.
+ * @param found_symbol On success, will be set to the discovered symbol value.
+ *
+ * @return Returns true if a symbol was found, false otherwise.
+ */
+static bool plcrash_async_macho_find_indexed_symbol (plcrash_async_macho_t *image,
+                                                     plcrash_async_macho_symtab_reader_t *reader,
+                                                     pl_vm_address_t slide_pc,
+                                                     plcrash_async_macho_symtab_entry_t *found_symbol)
+{
+    const plcrash_async_macho_symbol_index_entry_t *entries = image->symbol_index;
+    OSMemoryBarrier();
+
+    /* Find the first entry with an address greater than slide_pc; our match (if any) immediately precedes it. */
+    uint32_t low = 0;
+    uint32_t high = image->symbol_index_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (entries[mid].n_value <= slide_pc)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return false;
+
+    /* Sanity check the index against the mapped symbol table */
+    uint32_t symtab_index = entries[low - 1].symtab_index;
+    if (symtab_index >= reader->nsyms) {
+        PLCF_DEBUG("Symbol index entry %" PRIu32 " exceeds the symbol table size of %" PRIu32, symtab_index, reader->nsyms);
+        return false;
+    }
+
+    *found_symbol = plcrash_async_macho_symtab_reader_read(reader, reader->symtab, symtab_index);
+    return true;
+}
+
 /**
  * Attempt to locate a symbol address and name for @a pc within @a image. This is performed using best-guess heuristics, and may
  * be incorrect.
@@ -885,6 +1940,9 @@ static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_rea
  *
  * @return Returns PLCRASH_ESUCCESS if the symbol is found. If the symbol is not found, @a found_symbol will not be called.
  *
+ * @note If a symbol index has been built via plcrash_nasync_macho_build_symbol_index(), the lookup will be performed via a
+ * binary search of the index; otherwise, the symbol table will be scanned linearly.
+ *
  * @todo Migrate this API to use the new non-callback based plcrash_async_macho_symtab_reader support for symbol (and symbol name)
  * reading.
  */
@@ -897,6 +1955,27 @@ plcrash_error_t plcrash_async_macho_find_symbol_by_pc (plcrash_async_macho_t *im
     if (retval != PLCRASH_ESUCCESS)
         return retval;
 
+    retval = plcrash_async_macho_symtab_reader_find_symbol_by_pc(&reader, pc, symbol_cb, context);
+
+    plcrash_async_macho_symtab_reader_free(&reader);
+    return retval;
+}
+
+/**
+ * Attempt to locate a symbol address and name for @a pc using an already initialized symbol table @a reader. This
+ * behaves identically to plcrash_async_macho_find_symbol_by_pc(), but allows the caller to amortize the cost of mapping
+ * the image's symbol table across multiple lookups.
+ *
+ * @param reader The symbol table reader for the image to search for @a pc.
+ * @param pc The PC value within the target process for which symbol information should be found.
+ * @param symbol_cb A callback to be called if the symbol is found.
+ * @param context Context to be passed to @a found_symbol.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the symbol is found. If the symbol is not found, @a found_symbol will not be called.
+ */
+plcrash_error_t plcrash_async_macho_symtab_reader_find_symbol_by_pc (plcrash_async_macho_symtab_reader_t *reader, pl_vm_address_t pc, pl_async_macho_found_symbol_cb symbol_cb, void *context) {
+    plcrash_async_macho_t *image = reader->image;
+
     /* Compute the on-disk PC. */
     pl_vm_address_t slide_pc = pc - image->vmaddr_slide;
 
@@ -904,38 +1983,155 @@ plcrash_error_t plcrash_async_macho_find_symbol_by_pc (plcrash_async_macho_t *im
     plcrash_async_macho_symtab_entry_t found_symbol;
     bool did_find_symbol;
 
-    if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+    if (image->symbol_index != NULL) {
+        /* A pre-built index is available; perform a binary search */
+        did_find_symbol = plcrash_async_macho_find_indexed_symbol(image, reader, slide_pc, &found_symbol);
+    } else if (reader->symtab_global != NULL && reader->symtab_local != NULL) {
         /* dysymtab is available; use it to constrain our symbol search to the global and local sections of the symbol table. */
-        plcrash_async_macho_find_best_symbol(&reader, slide_pc, reader.symtab_global, reader.nsyms_global, &found_symbol, NULL, &did_find_symbol);
-        plcrash_async_macho_find_best_symbol(&reader, slide_pc, reader.symtab_local, reader.nsyms_local, &found_symbol, &found_symbol, &did_find_symbol);
+        plcrash_async_macho_find_best_symbol(reader, slide_pc, reader->symtab_global, reader->nsyms_global, &found_symbol, NULL, &did_find_symbol);
+        plcrash_async_macho_find_best_symbol(reader, slide_pc, reader->symtab_local, reader->nsyms_local, &found_symbol, &found_symbol, &did_find_symbol);
     } else {
         /* If dysymtab is not available, search all symbols */
-        plcrash_async_macho_find_best_symbol(&reader, slide_pc, reader.symtab, reader.nsyms, &found_symbol, NULL, &did_find_symbol);
+        plcrash_async_macho_find_best_symbol(reader, slide_pc, reader->symtab, reader->nsyms, &found_symbol, NULL, &did_find_symbol);
     }
 
     /* No symbol found. */
-    if (!did_find_symbol) {
-        retval = PLCRASH_ENOTFOUND;
-        goto cleanup;
-    }
+    if (!did_find_symbol)
+        return PLCRASH_ENOTFOUND;
 
     /* Symbol found! */
-    const char *sym_name = plcrash_async_macho_symtab_reader_symbol_name(&reader, found_symbol.n_strx);
+    const char *sym_name = plcrash_async_macho_symtab_reader_symbol_name(reader, found_symbol.n_strx);
     if (sym_name == NULL) {
         PLCF_DEBUG("Failed to read symbol name\n");
-        retval = PLCRASH_EINVAL;
-        goto cleanup;
+        return PLCRASH_EINVAL;
     }
 
     /* Inform our caller */
     symbol_cb(found_symbol.normalized_value + image->vmaddr_slide, sym_name, context);
+    return PLCRASH_ESUCCESS;
+}
 
-    // fall through to cleanup
-    retval = PLCRASH_ESUCCESS;
+/**
+ * @internal
+ * Merge the eligible symbols of @a symtab into the per-PC best matches of a batch lookup. Each symbol is recorded
+ * against the first PC at or above its address, and is only retained if it is strictly closer than the symbol
+ * already recorded for that PC; the matches are propagated to the following PCs by the caller.
+ *
+ * @param reader The symbol table reader from which @a symtab was fetched.
+ * @param pcs The PC values to be matched, sorted in ascending order.
+ * @param count The number of entries in @a pcs. Must be non-zero.
+ * @param symtab The symtab to walk.
+ * @param nsyms The number of nlist entries available via @a symtab.
+ * @param symbols The per-PC best matches.
+ * @param found The per-PC match flags.
+ */
+static void plcrash_async_macho_merge_symbols (plcrash_async_macho_symtab_reader_t *reader,
+                                               const pl_vm_address_t *pcs, uint32_t count,
+                                               pl_nlist_common *symtab, uint32_t nsyms,
+                                               plcrash_async_macho_symtab_entry_t *symbols,
+                                               bool *found)
+{
+    plcrash_async_macho_symtab_entry_t entries[PL_SYMTAB_BATCH_SIZE];
+    pl_vm_address_t slide = reader->image->vmaddr_slide;
+    pl_vm_address_t last_pc = pcs[count - 1] - slide;
 
-cleanup:
-    plcrash_async_macho_symtab_reader_free(&reader);
-    return retval;
+    for (uint32_t base = 0; base < nsyms; base += PL_SYMTAB_BATCH_SIZE) {
+        uint32_t batch_count = PL_SYMTAB_BATCH_COUNT(nsyms, base);
+        plcrash_async_macho_symtab_reader_read_batch(reader, symtab, base, batch_count, entries);
+
+        for (uint32_t i = 0; i < batch_count; i++) {
+            plcrash_async_macho_symtab_entry_t *entry = &entries[i];
+
+            /* Symbol must be within a section, must not be a debugging entry, and must precede at least one PC. */
+            if ((entry->n_type & N_TYPE) != N_SECT || ((entry->n_type & N_STAB) != 0) || entry->n_value > last_pc)
+                continue;
+
+            /* Find the first PC at or above the symbol */
+            uint32_t low = 0;
+            uint32_t high = count - 1;
+            while (low < high) {
+                uint32_t mid = low + (high - low) / 2;
+                if (pcs[mid] - slide < entry->n_value)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+
+            /* As in plcrash_async_macho_find_best_symbol(), the first of several equally close symbols is retained */
+            if (!found[low] || symbols[low].n_value < entry->n_value) {
+                symbols[low] = *entry;
+                found[low] = true;
+            }
+        }
+    }
+}
+
+/**
+ * Locate the symbols for all of @a pcs using a single pass over the symbol table of @a reader, rather than one pass per
+ * PC. The results are identical to those produced by calling plcrash_async_macho_symtab_reader_find_symbol_by_pc() for
+ * each PC.
+ *
+ * If a symbol index has been built via plcrash_nasync_macho_build_symbol_index(), each PC is instead resolved via a
+ * binary search of the index.
+ *
+ * @param reader The symbol table reader for the image to search.
+ * @param pcs The PC values within the target process for which symbol information should be found, sorted in
+ * ascending order. All PCs must fall within the reader's image.
+ * @param count The number of entries in @a pcs.
+ * @param symbols On return, the symbol found for each entry of @a pcs. Entries for which no symbol was found are left
+ * undefined. The symbol address and name may be fetched via the entry's normalized_value (to which the image's
+ * vmaddr_slide must be applied) and plcrash_async_macho_symtab_reader_symbol_name().
+ * @param found On return, set to true for each entry of @a pcs for which a symbol was found, or false otherwise.
+ *
+ * @return Returns PLCRASH_ESUCCESS if a symbol was found for any PC, or PLCRASH_ENOTFOUND otherwise.
+ *
+ * @warning This method is async-safe.
+ */
+plcrash_error_t plcrash_async_macho_symtab_reader_find_symbols_by_pc (plcrash_async_macho_symtab_reader_t *reader,
+                                                                      const pl_vm_address_t *pcs,
+                                                                      uint32_t count,
+                                                                      plcrash_async_macho_symtab_entry_t *symbols,
+                                                                      bool *found)
+{
+    plcrash_async_macho_t *image = reader->image;
+
+    if (count == 0)
+        return PLCRASH_ENOTFOUND;
+
+    for (uint32_t i = 0; i < count; i++)
+        found[i] = false;
+
+    if (image->symbol_index != NULL) {
+        /* A pre-built index is available; perform a binary search per PC */
+        bool any_found = false;
+        for (uint32_t i = 0; i < count; i++) {
+            found[i] = plcrash_async_macho_find_indexed_symbol(image, reader, pcs[i] - image->vmaddr_slide, &symbols[i]);
+            any_found |= found[i];
+        }
+
+        return any_found ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
+    }
+
+    /* Record each symbol against the first PC it precedes, searching the same tables -- in the same order -- as
+     * plcrash_async_macho_symtab_reader_find_symbol_by_pc() */
+    if (reader->symtab_global != NULL && reader->symtab_local != NULL) {
+        plcrash_async_macho_merge_symbols(reader, pcs, count, reader->symtab_global, reader->nsyms_global, symbols, found);
+        plcrash_async_macho_merge_symbols(reader, pcs, count, reader->symtab_local, reader->nsyms_local, symbols, found);
+    } else {
+        plcrash_async_macho_merge_symbols(reader, pcs, count, reader->symtab, reader->nsyms, symbols, found);
+    }
+
+    /* A symbol preceding a PC also precedes all following PCs; carry each match forward unless a closer symbol was
+     * recorded for the following PC. */
+    for (uint32_t i = 1; i < count; i++) {
+        if (found[i - 1] && (!found[i] || symbols[i - 1].n_value > symbols[i].n_value)) {
+            symbols[i] = symbols[i - 1];
+            found[i] = true;
+        }
+    }
+
+    /* If any PC matched, the final PC did as well */
+    return found[count - 1] ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
 }
 
 /**
@@ -955,6 +2151,15 @@ void plcrash_async_macho_mapped_segment_free (pl_async_macho_mapped_segment_t *s
 void plcrash_async_macho_free (plcrash_async_macho_t *image) {
     if (image->name != NULL)
         plcrash_async_allocator_dealloc(image->_allocator, image->name);
+
+    if (image->symbol_index != NULL)
+        plcrash_async_allocator_dealloc(image->_allocator, image->symbol_index);
+
+    if (image->objc_method_index != NULL)
+        plcrash_async_allocator_dealloc(image->_allocator, image->objc_method_index);
+
+    if (image->encoded_record != NULL)
+        plcrash_async_allocator_dealloc(image->_allocator, image->encoded_record);
     
     plcrash_async_mobject_free(&image->load_cmds);
 
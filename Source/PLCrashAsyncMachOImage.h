@@ -33,8 +33,10 @@
 #include <mach/mach.h>
 #include <mach-o/loader.h>
 #include <mach-o/nlist.h>
+#include <libkern/OSAtomic.h>
 
 #include "PLCrashAsyncMObject.h"
+#include "PLCrashAsyncMObjectPool.h"
 #include "PLCrashAsyncAllocator.h"
 
 #ifdef __cplusplus
@@ -47,26 +49,172 @@ extern "C" {
  * @{
  */
 
+/**
+ * @internal
+ *
+ * An entry in a Mach-O image's address-sorted symbol index.
+ */
+typedef struct plcrash_async_macho_symbol_index_entry {
+    /** The symbol's on-disk (unslid) n_value. */
+    pl_vm_address_t n_value;
+
+    /** The symbol's index within the image's symbol table. */
+    uint32_t symtab_index;
+
+    /** The order in which the symbol would be visited by a linear scan of the symbol table; used to resolve
+     * duplicate addresses identically to the linear scan. */
+    uint32_t scan_order;
+} plcrash_async_macho_symbol_index_entry_t;
+
+/**
+ * @internal
+ *
+ * An entry in a Mach-O image's IMP-sorted Objective-C method index. The index is populated by
+ * plcrash_nasync_objc_build_method_index(); refer to PLCrashAsyncObjCSection.h.
+ */
+typedef struct plcrash_async_objc_method_index_entry {
+    /** The method's IMP. */
+    pl_vm_address_t imp;
+
+    /** The target address of the method's NUL-terminated class name. */
+    pl_vm_address_t class_name;
+
+    /** The target address of the method's NUL-terminated selector name. */
+    pl_vm_address_t method_name;
+
+    /** The order in which the method would be visited by a full parse of the image's ObjC metadata; used to
+     * resolve duplicate IMPs identically to the parser. */
+    uint32_t scan_order;
+
+    /** If true, the method is a class (rather than an instance) method. */
+    bool is_class_method;
+} plcrash_async_objc_method_index_entry_t;
+
+/** The number of well-known sections recorded in a plcrash_async_macho_t's load command table. */
+#define PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT 8
+
+/**
+ * @internal
+ *
+ * The location of a well-known section, as recorded at image initialization time.
+ */
+typedef struct plcrash_async_macho_known_section {
+    /** If true, the section was found. */
+    bool found;
+
+    /** The in-memory (slid) address of the section. */
+    pl_vm_address_t addr;
+
+    /** The size of the section, in bytes. */
+    pl_vm_size_t size;
+} plcrash_async_macho_known_section_t;
+
+/**
+ * @internal
+ *
+ * GNU eh_frame pointer base addresses, as recorded at image initialization time. These are applied to
+ * DW_EH_PE_textrel and DW_EH_PE_datarel encoded pointers, and are invariant for the lifetime of the image.
+ */
+typedef struct plcrash_async_macho_eh_bases {
+    /** If true, text_base is valid. */
+    bool has_text_base;
+
+    /** The in-memory (slid) address of the image's first __TEXT segment. */
+    pl_vm_address_t text_base;
+
+    /** If true, data_base is valid. */
+    bool has_data_base;
+
+    /** The in-memory (slid) address of the image's first __DATA segment. */
+    pl_vm_address_t data_base;
+} plcrash_async_macho_eh_bases_t;
+
+/**
+ * @internal
+ *
+ * Load command data precomputed by plcrash_async_macho_init(), allowing the most frequently performed load command and
+ * section lookups to be answered without rescanning the image's load commands. All command pointers reference the
+ * image's mapped load_cmds, and are NULL if the command was not found.
+ */
+typedef struct plcrash_async_macho_lc_table {
+    /** The first LC_SYMTAB command. */
+    void *symtab_cmd;
+
+    /** The first LC_DYSYMTAB command. */
+    void *dysymtab_cmd;
+
+    /** The first LC_UUID command. */
+    void *uuid_cmd;
+
+    /** The first __TEXT LC_SEGMENT/LC_SEGMENT_64 command. */
+    void *text_segment;
+
+    /** The first __DATA LC_SEGMENT/LC_SEGMENT_64 command. */
+    void *data_segment;
+
+    /** The first __LINKEDIT LC_SEGMENT/LC_SEGMENT_64 command. */
+    void *linkedit_segment;
+
+    /** eh_frame pointer bases derived from text_segment and data_segment. */
+    plcrash_async_macho_eh_bases_t eh_bases;
+
+    /** Well-known section locations; see plcrash_async_macho_known_sections. */
+    plcrash_async_macho_known_section_t sections[PLCRASH_ASYNC_MACHO_KNOWN_SECTION_COUNT];
+} plcrash_async_macho_lc_table_t;
+
+/** The maximum size of the string table window mapped by a plcrash_async_macho_symtab_reader_t. */
+#define PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE (64 * 1024)
+
 /**
  * @internal
  *
  * A Mach-O image instance.
  */
 typedef struct plcrash_async_macho {
+    /*
+     * The fields consulted by address lookups, the frame walker and the symbolicator are grouped at the start of the
+     * structure, where they share a single cache line; the remaining state is only consulted once an image has been
+     * selected.
+     */
+
+    /** The binary image's header address. */
+    pl_vm_address_t header_addr;
+
+    /** Total size, in bytes, of the Mach-O image's __TEXT segment, as defined by the LC_SEGMENT/LC_SEGMENT_64 load command. */
+    pl_vm_size_t text_size;
+
+    /** The binary's dyld-reported reported vmaddr slide. */
+    pl_vm_off_t vmaddr_slide;
+
+    /** The Mach-O image's __TEXT segment, as defined by the LC_SEGMENT/LC_SEGMENT_64 load command. */
+    pl_vm_address_t text_vmaddr;
+
+    /** The byte order functions to use for this image */
+    const plcrash_async_byteorder_t *byteorder;
+
+    /** If true, the image is 64-bit Mach-O. If false, it is a 32-bit Mach-O image. */
+    bool m64;
+
+    /** If true, the image contains a __TEXT,__unwind_info compact unwind section. */
+    bool has_compact_unwind;
+
+    /** If true, the image contains a __TEXT,__eh_frame or __DWARF,__debug_frame DWARF unwind section. */
+    bool has_dwarf_unwind;
+
     /** A borrowed reference to our backing allocator instance. */
     plcrash_async_allocator_t *_allocator;
 
     /** The Mach task in which the Mach-O image can be found */
     mach_port_t task;
 
-    /** The binary image's header address. */
-    pl_vm_address_t header_addr;
-    
-    /** The binary's dyld-reported reported vmaddr slide. */
-    pl_vm_off_t vmaddr_slide;
+    /**
+     * The binary image's name/path, allocated from _allocator, or NULL if the name has not yet been copied from the
+     * target task. Use plcrash_async_macho_name() to fetch the name, copying it if necessary.
+     */
+    char * volatile name;
 
-    /** The binary image's name/path, allocated from _allocator. */
-    char *name;
+    /** The task-local address of the image's name/path, or 0 if the name was provided at initialization. */
+    pl_vm_address_t name_addr;
 
     /** The Mach-O header. For our purposes, the 32-bit and 64-bit headers are identical. Note that the header
      * values may require byte-swapping for the local process' use. */
@@ -82,19 +230,83 @@ typedef struct plcrash_async_macho {
     /** Mapped Mach-O load commands */
     plcrash_async_mobject_t load_cmds;
 
-    /** The Mach-O image's __TEXT segment, as defined by the LC_SEGMENT/LC_SEGMENT_64 load command. */
-    pl_vm_address_t text_vmaddr;
+    /** Precomputed load command lookup table. */
+    plcrash_async_macho_lc_table_t lc_table;
 
-    /** Total size, in bytes, of the Mach-O image's __TEXT segment, as defined by the LC_SEGMENT/LC_SEGMENT_64 load command. */
-    pl_vm_size_t text_size;
+    /**
+     * An optional address-sorted symbol index, allocated from _allocator, or NULL if no index has been built. The
+     * index may be published concurrently with crash-time lookups; symbol_index_count is always written prior to this
+     * pointer.
+     */
+    plcrash_async_macho_symbol_index_entry_t * volatile symbol_index;
 
-    /** If true, the image is 64-bit Mach-O. If false, it is a 32-bit Mach-O image. */
-    bool m64;
+    /** The number of entries in symbol_index. */
+    uint32_t symbol_index_count;
 
-    /** The byte order functions to use for this image */
-    const plcrash_async_byteorder_t *byteorder;
+    /**
+     * An optional IMP-sorted ObjC method index, allocated from _allocator, or NULL if no index has been built. The
+     * index may be published concurrently with crash-time lookups; objc_method_index_count is always written prior
+     * to this pointer.
+     */
+    plcrash_async_objc_method_index_entry_t * volatile objc_method_index;
+
+    /** The number of entries in objc_method_index. */
+    uint32_t objc_method_index_count;
+
+    /**
+     * An optional cached, pre-encoded copy of this image's crash log BinaryImage record, allocated from _allocator,
+     * or NULL if no record has been cached. The record may be published concurrently with crash-time report
+     * writing; encoded_record_size is always written prior to this pointer.
+     */
+    void * volatile encoded_record;
+
+    /** The size of encoded_record, in bytes. */
+    size_t encoded_record_size;
 } plcrash_async_macho_t;
 
+/** The number of section mappings retained by a plcrash_async_macho_section_cache_t. */
+#define PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE 32
+
+/**
+ * @internal
+ *
+ * A cached section mapping, as returned by plcrash_async_macho_section_cache_map().
+ */
+typedef struct plcrash_async_macho_cached_section {
+    /** The image containing the section, or NULL if this entry is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The segment name; not necessarily NUL-terminated if the name is 16 bytes long. */
+    char segname[16];
+
+    /** The section name; not necessarily NUL-terminated if the name is 16 bytes long. */
+    char sectname[16];
+
+    /** The result of the mapping attempt. Failures (such as PLCRASH_ENOTFOUND) are cached, too. */
+    plcrash_error_t result;
+
+    /** The mapped section. Only valid if result is PLCRASH_ESUCCESS. */
+    plcrash_async_mobject_t mobj;
+
+    /** The value of the cache's use counter at the time this entry was last used. */
+    uint64_t last_used;
+} plcrash_async_macho_cached_section_t;
+
+/**
+ * @internal
+ *
+ * A least-recently-used cache of section mappings, keyed by image and section name. The cache is owned by a single
+ * report writer (or unwind worker), and is not thread-safe; it must be emptied via
+ * plcrash_async_macho_section_cache_free() before the images it references are freed.
+ */
+typedef struct plcrash_async_macho_section_cache {
+    /** The cache entries. */
+    plcrash_async_macho_cached_section_t entries[PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE];
+
+    /** Monotonically increasing use counter, used to find the least-recently-used entry. */
+    uint64_t use_count;
+} plcrash_async_macho_section_cache_t;
+
 /**
  * @internal
  *
@@ -148,10 +360,10 @@ typedef struct plcrash_async_macho_symtab_reader {
     /** The image from which the symbol table has been mapped. */
     plcrash_async_macho_t *image;
 
-    /** The mapped LINKEDIT segment. */
-    pl_async_macho_mapped_segment_t linkedit;
+    /** The mapped symbol table. Only the symbol table's range of the LINKEDIT segment is mapped. */
+    plcrash_async_mobject_t symtab_mobj;
 
-    /** Pointer to the symtab table within the mapped linkedit segment. The validity of this pointer (and the length of
+    /** Pointer to the symtab table within symtab_mobj. The validity of this pointer (and the length of
      * data available) is gauranteed. */
     void *symtab;
     
@@ -172,12 +384,25 @@ typedef struct plcrash_async_macho_symtab_reader {
     /** Total number of elements in the local symtab. */
     uint32_t nsyms_local;
 
-    /** The mapped string table. The validity of this pointer (and the length of
-     * data available) is gauranteed. */
-    char *string_table;
+    /** The task-relative address of the string table. The string table is not mapped in its entirety; pages are
+     * mapped on demand via string_window as symbol names are read. */
+    pl_vm_address_t string_table_addr;
 
     /** The string table's size, in bytes. */
     size_t string_table_size;
+
+    /** A mapping of the string table range from which the most recent symbol name was read. Only valid if
+     * string_window_mapped is true. */
+    plcrash_async_mobject_t string_window;
+
+    /** The string table offset at which string_window begins. */
+    size_t string_window_offset;
+
+    /** The number of string table bytes available within string_window. */
+    size_t string_window_length;
+
+    /** If true, string_window has been initialized, and must be freed. */
+    bool string_window_mapped;
 } plcrash_async_macho_symtab_reader_t;
 
 /**
@@ -191,6 +416,10 @@ typedef struct plcrash_async_macho_symtab_reader {
 typedef void (*pl_async_macho_found_symbol_cb)(pl_vm_address_t address, const char *name, void *ctx);
 
 plcrash_error_t plcrash_async_macho_init (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, const char *name, pl_vm_address_t header);
+plcrash_error_t plcrash_async_macho_init_lazy_name (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, pl_vm_address_t name_addr, pl_vm_address_t header);
+plcrash_error_t plcrash_async_macho_init_pooled (plcrash_async_macho_t *image, plcrash_async_allocator_t *allocator, mach_port_t task, pl_vm_address_t name_addr, pl_vm_address_t header, plcrash_async_mobject_pool_t *pool);
+
+const char *plcrash_async_macho_name (plcrash_async_macho_t *image);
 
 const plcrash_async_byteorder_t *plcrash_async_macho_byteorder (plcrash_async_macho_t *image);
 const struct mach_header *plcrash_async_macho_header (plcrash_async_macho_t *image);
@@ -209,12 +438,30 @@ void *plcrash_async_macho_find_segment_cmd (plcrash_async_macho_t *image, const
 plcrash_error_t plcrash_async_macho_map_segment (plcrash_async_macho_t *image, const char *segname, pl_async_macho_mapped_segment_t *seg);
 plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *mobj);
 
+void plcrash_async_macho_section_cache_init (plcrash_async_macho_section_cache_t *cache);
+plcrash_error_t plcrash_async_macho_section_cache_map (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *storage, plcrash_async_mobject_t **mobj);
+void plcrash_async_macho_section_cache_unmap (plcrash_async_macho_section_cache_t *cache, plcrash_async_mobject_t *mobj);
+void plcrash_async_macho_section_cache_free (plcrash_async_macho_section_cache_t *cache);
+
 plcrash_error_t plcrash_async_macho_find_symbol_by_pc (plcrash_async_macho_t *image, pl_vm_address_t pc, pl_async_macho_found_symbol_cb symbol_cb, void *context);
 plcrash_error_t plcrash_async_macho_find_symbol_by_name (plcrash_async_macho_t *image, const char *symbol, pl_vm_address_t *pc);
 
+plcrash_error_t plcrash_nasync_macho_build_symbol_index (plcrash_async_macho_t *image);
+plcrash_error_t plcrash_nasync_macho_advise_linkedit (plcrash_async_macho_t *image);
+
+plcrash_error_t plcrash_async_macho_set_encoded_record (plcrash_async_macho_t *image, const void *data, size_t size);
+
 plcrash_error_t plcrash_async_macho_symtab_reader_init (plcrash_async_macho_symtab_reader_t *reader, plcrash_async_macho_t *image);
 plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcrash_async_macho_symtab_reader_t *reader, void *symtab, uint32_t index);
+void plcrash_async_macho_symtab_reader_read_batch (plcrash_async_macho_symtab_reader_t *reader, void *symtab, uint32_t index, uint32_t count, plcrash_async_macho_symtab_entry_t *entries);
+
+#ifdef __clang__
+bool plcrash_async_macho_scan_nlist64_direct (const struct nlist_64 *symtab, uint32_t nsyms, pl_vm_address_t slide_pc, bool have_best, uint64_t best_value, uint32_t *best_index);
+#endif
 const char *plcrash_async_macho_symtab_reader_symbol_name (plcrash_async_macho_symtab_reader_t *reader, uint32_t n_strx);
+plcrash_error_t plcrash_async_macho_symtab_reader_find_symbol_by_pc (plcrash_async_macho_symtab_reader_t *reader, pl_vm_address_t pc, pl_async_macho_found_symbol_cb symbol_cb, void *context);
+plcrash_error_t plcrash_async_macho_symtab_reader_find_symbols_by_pc (plcrash_async_macho_symtab_reader_t *reader, const pl_vm_address_t *pcs, uint32_t count,
+                                                                      plcrash_async_macho_symtab_entry_t *symbols, bool *found);
 void plcrash_async_macho_symtab_reader_free (plcrash_async_macho_symtab_reader_t *reader);
 
 void plcrash_async_macho_mapped_segment_free (pl_async_macho_mapped_segment_t *segment);
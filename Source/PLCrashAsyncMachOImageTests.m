@@ -213,6 +213,99 @@
     STAssertNULL(cmd, @"Should not have found the requested load command");
 }
 
+/**
+ * Verify that the precomputed load command table agrees with a linear scan of the image's load commands.
+ */
+- (void) testLoadCommandTable {
+    /* Commands */
+    uint32_t types[] = { LC_SYMTAB, LC_DYSYMTAB, LC_UUID };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        struct load_command *expected = plcrash_async_macho_next_command_type(&_image, NULL, types[i]);
+        STAssertEquals((void *) expected, plcrash_async_macho_find_command(&_image, types[i]), @"Table returned the wrong command for type %x", types[i]);
+    }
+
+    /* Segments */
+    uint32_t segment_type = _image.m64 ? LC_SEGMENT_64 : LC_SEGMENT;
+    const char *segnames[] = { "__TEXT", "__LINKEDIT" };
+    for (size_t i = 0; i < sizeof(segnames) / sizeof(segnames[0]); i++) {
+        struct load_command *expected = NULL;
+        while ((expected = plcrash_async_macho_next_command_type(&_image, expected, segment_type)) != NULL) {
+            const char *name = _image.m64 ? ((struct segment_command_64 *) expected)->segname : ((struct segment_command *) expected)->segname;
+            if (strncmp(name, segnames[i], 16) == 0)
+                break;
+        }
+
+        STAssertNotNULL(expected, @"Failed to find segment %s", segnames[i]);
+        STAssertEquals((void *) expected, plcrash_async_macho_find_segment_cmd(&_image, segnames[i]), @"Table returned the wrong segment for %s", segnames[i]);
+    }
+
+    /* eh_frame pointer bases */
+    struct load_command *seg = NULL;
+    bool found_text = false;
+    bool found_data = false;
+    while ((seg = plcrash_async_macho_next_command_type(&_image, seg, segment_type)) != NULL) {
+        const char *name = _image.m64 ? ((struct segment_command_64 *) seg)->segname : ((struct segment_command *) seg)->segname;
+        pl_vm_address_t vmaddr = (_image.m64 ? ((struct segment_command_64 *) seg)->vmaddr : ((struct segment_command *) seg)->vmaddr) + _image.vmaddr_slide;
+
+        if (!found_text && strncmp(name, "__TEXT", 16) == 0) {
+            found_text = true;
+            STAssertEquals(vmaddr, _image.lc_table.eh_bases.text_base, @"Incorrect text base");
+        } else if (!found_data && strncmp(name, "__DATA", 16) == 0) {
+            found_data = true;
+            STAssertEquals(vmaddr, _image.lc_table.eh_bases.data_base, @"Incorrect data base");
+            STAssertEquals((void *) seg, plcrash_async_macho_find_segment_cmd(&_image, "__DATA"), @"Table returned the wrong __DATA segment");
+        }
+    }
+    STAssertEquals(found_text, _image.lc_table.eh_bases.has_text_base, @"Incorrect text base availability");
+    STAssertEquals(found_data, _image.lc_table.eh_bases.has_data_base, @"Incorrect data base availability");
+
+    /* Sections; these may or may not be present, depending on the target architecture */
+    const char *sections[][2] = {
+        { "__TEXT", "__unwind_info" },
+        { "__TEXT", "__eh_frame" },
+        { "__DATA", "__objc_classlist" },
+        { "__OBJC", "__module_info" }
+    };
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++) {
+        plcrash_async_mobject_t mobj;
+        unsigned long sectsize = 0;
+        uint8_t *data = getsectiondata((void *)_image.header_addr, sections[i][0], sections[i][1], &sectsize);
+
+        plcrash_error_t err = plcrash_async_macho_map_section(&_image, sections[i][0], sections[i][1], &mobj);
+        if (data == NULL) {
+            STAssertEquals(PLCRASH_ENOTFOUND, err, @"Section (%s,%s) should not have been found", sections[i][0], sections[i][1]);
+            continue;
+        }
+
+        STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to map section (%s,%s)", sections[i][0], sections[i][1]);
+        STAssertEquals((pl_vm_address_t)data, (pl_vm_address_t) (mobj.address + mobj.vm_slide), @"Addresses do not match");
+        STAssertEquals((pl_vm_size_t)sectsize, mobj.length, @"Sizes do not match");
+        plcrash_async_mobject_free(&mobj);
+    }
+}
+
+/**
+ * Test initialization of an image via a mapping pool.
+ */
+- (void) testInitPooled {
+    plcrash_async_mobject_pool_t *pool;
+    plcrash_async_macho_t image;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_pool_new(&pool, _allocator), @"Failed to create pool");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_init_pooled(&image, _allocator, mach_task_self(), 0, _image.header_addr, pool), @"Failed to initialize image");
+
+    /* The image must remain valid once the pool has been freed */
+    plcrash_async_mobject_pool_free(pool);
+
+    STAssertEquals(image.ncmds, _image.ncmds, @"Incorrect load command count");
+    STAssertEquals(image.text_size, _image.text_size, @"Incorrect text segment size");
+    STAssertEquals(image.vmaddr_slide, _image.vmaddr_slide, @"Incorrect vmaddr_slide value");
+    STAssertTrue(memcmp(&image.header, &_image.header, sizeof(image.header)) == 0, @"Incorrect header");
+    STAssertEquals(image.lc_table.eh_bases.text_base, _image.lc_table.eh_bases.text_base, @"Incorrect text base");
+
+    plcrash_async_macho_free(&image);
+}
+
 /**
  * Test memory mapping of a Mach-O segment
  */
@@ -293,6 +386,77 @@
     STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_map_section(&_image, "__DATA", "__NO_SUCH_SECT", &mobj), @"Should have failed to map the section");
 }
 
+/**
+ * Test the recorded availability of unwind sections.
+ */
+- (void) testUnwindSectionAvailability {
+    unsigned long sectsize = 0;
+
+    bool has_compact = getsectiondata((void *)_image.header_addr, SEG_TEXT, "__unwind_info", &sectsize) != NULL;
+    STAssertEquals(has_compact, _image.has_compact_unwind, @"Incorrect compact unwind availability");
+
+    bool has_dwarf = getsectiondata((void *)_image.header_addr, SEG_TEXT, "__eh_frame", &sectsize) != NULL ||
+        getsectiondata((void *)_image.header_addr, "__DWARF", "__debug_frame", &sectsize) != NULL;
+    STAssertEquals(has_dwarf, _image.has_dwarf_unwind, @"Incorrect DWARF unwind availability");
+}
+
+
+/**
+ * Test cached memory mapping of a Mach-O section
+ */
+- (void) testMapSectionCached {
+    plcrash_async_macho_section_cache_t cache;
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *mobj;
+    plcrash_async_mobject_t *cached_mobj;
+
+    plcrash_async_macho_section_cache_init(&cache);
+
+    /* Try to map the section */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &mobj), @"Failed to map section");
+    STAssertTrue(mobj != &storage, @"Mapping was not retained by the cache");
+
+    /* Fetch the section directly for comparison */
+    unsigned long sectsize = 0;
+    uint8_t *data = getsectiondata((void *)_image.header_addr, "__DATA", "__const", &sectsize);
+    STAssertNotNULL(data, @"Could not fetch section data");
+
+    STAssertEquals((pl_vm_address_t)data, (pl_vm_address_t) (mobj->address + mobj->vm_slide), @"Addresses do not match");
+    STAssertEquals((pl_vm_size_t)sectsize, mobj->length, @"Sizes do not match");
+    plcrash_async_macho_section_cache_unmap(&cache, mobj);
+
+    /* A second request must return the cached mapping */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &cached_mobj), @"Failed to map section");
+    STAssertEquals(mobj, cached_mobj, @"Mapping was not cached");
+    plcrash_async_macho_section_cache_unmap(&cache, cached_mobj);
+
+    /* Test handling of a missing section; the failure should also be cached */
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__NO_SUCH_SECT", &storage, &mobj), @"Should have failed to map the section");
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__NO_SUCH_SECT", &storage, &mobj), @"Should have failed to map the section");
+    STAssertEquals(cache.use_count, (uint64_t) 4, @"Unexpected cache use count");
+
+    /* Fill the cache with further (missing) sections, touching the first mapping before each; the least-recently-used
+     * entries must be evicted in its place */
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        char sectname[16];
+        snprintf(sectname, sizeof(sectname), "__MISSING_%zu", i);
+
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &cached_mobj), @"Failed to map section");
+        STAssertEquals(mobj, cached_mobj, @"Most recently used mapping was evicted");
+        STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", sectname, &storage, &cached_mobj), @"Should have failed to map the section");
+    }
+
+    /* Without a cache, the mapping is returned in the caller's storage */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(NULL, &_image, "__DATA", "__const", &storage, &mobj), @"Failed to map section");
+    STAssertEquals(mobj, &storage, @"Uncached mapping was not returned in the supplied storage");
+    STAssertEquals((pl_vm_address_t)data, (pl_vm_address_t) (mobj->address + mobj->vm_slide), @"Addresses do not match");
+    plcrash_async_macho_section_cache_unmap(NULL, mobj);
+
+    /* Freeing the cache empties it */
+    plcrash_async_macho_section_cache_free(&cache);
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++)
+        STAssertNULL(cache.entries[i].image, @"Cache was not emptied");
+}
 
 /**
  * Test memory mapping of a missing Mach-O segment
@@ -326,7 +490,8 @@ static void testFindSymbol_cb (pl_vm_address_t address, const char *name, void *
     STAssertNotNULL(reader.symtab, @"Failed to map symtab");
     STAssertNotNULL(reader.symtab_global, @"Failed to map global symtab");
     STAssertNotNULL(reader.symtab_local, @"Failed to map global symtab");
-    STAssertNotNULL(reader.string_table, @"Failed to map string table");
+    STAssertTrue(reader.string_table_size > 0, @"Failed to find string table");
+    STAssertFalse(reader.string_window_mapped, @"The string table should be mapped on demand");
     
     /* Try iterating the tables. If we don't crash, we're doing well. */
     plcrash_async_macho_symtab_entry_t entry;
@@ -350,6 +515,75 @@ static void testFindSymbol_cb (pl_vm_address_t address, const char *name, void *
     plcrash_async_macho_symtab_reader_free(&reader);
 }
 
+/**
+ * Verify that batch reads decode the same entries as individual reads.
+ */
+- (void) testReadSymtabBatch {
+    plcrash_async_macho_symtab_reader_t reader;
+    plcrash_error_t ret = plcrash_async_macho_symtab_reader_init(&reader, &_image);
+    STAssertEquals(ret, PLCRASH_ESUCCESS, @"Failed to initializer reader");
+    STAssertTrue(reader.nsyms > 0, @"No symbols found");
+
+    plcrash_async_macho_symtab_entry_t batch[7];
+    for (uint32_t base = 0; base < reader.nsyms; base += 7) {
+        uint32_t count = MIN(7, reader.nsyms - base);
+        plcrash_async_macho_symtab_reader_read_batch(&reader, reader.symtab, base, count, batch);
+
+        for (uint32_t i = 0; i < count; i++) {
+            plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, base + i);
+            STAssertEquals(entry.n_strx, batch[i].n_strx, @"Incorrect n_strx");
+            STAssertEquals(entry.n_type, batch[i].n_type, @"Incorrect n_type");
+            STAssertEquals(entry.n_sect, batch[i].n_sect, @"Incorrect n_sect");
+            STAssertEquals(entry.n_desc, batch[i].n_desc, @"Incorrect n_desc");
+            STAssertEquals(entry.n_value, batch[i].n_value, @"Incorrect n_value");
+            STAssertEquals(entry.normalized_value, batch[i].normalized_value, @"Incorrect normalized_value");
+        }
+    }
+
+    plcrash_async_macho_symtab_reader_free(&reader);
+}
+
+/**
+ * Verify that symbol names read through the string table window are identical regardless of the order in which they
+ * are read, and that the window remains bounded.
+ */
+- (void) testReadSymbolNameWindow {
+    plcrash_async_macho_symtab_reader_t reader;
+    plcrash_error_t ret = plcrash_async_macho_symtab_reader_init(&reader, &_image);
+    STAssertEquals(ret, PLCRASH_ESUCCESS, @"Failed to initializer reader");
+
+    /* Record the names in table order */
+    char **names = calloc(reader.nsyms, sizeof(char *));
+    for (uint32_t i = 0; i < reader.nsyms; i++) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, i);
+        const char *sym = plcrash_async_macho_symtab_reader_symbol_name(&reader, entry.n_strx);
+        if (sym != NULL)
+            names[i] = strdup(sym);
+
+        STAssertTrue(reader.string_window_length <= PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE, @"Window exceeds the maximum size");
+    }
+
+    /* Re-read the names in reverse, forcing the window to be remapped */
+    for (uint32_t i = reader.nsyms; i > 0; i--) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, i - 1);
+        const char *sym = plcrash_async_macho_symtab_reader_symbol_name(&reader, entry.n_strx);
+        if (names[i - 1] == NULL) {
+            STAssertNULL(sym, @"Symbol name %u was not previously readable", i - 1);
+        } else {
+            STAssertNotNULL(sym, @"Symbol name %u read failed", i - 1);
+            if (sym != NULL)
+                STAssertEqualCStrings(sym, names[i - 1], @"Incorrect name for symbol %u", i - 1);
+        }
+        free(names[i - 1]);
+    }
+    free(names);
+
+    /* Offsets beyond the string table must be rejected */
+    STAssertNULL(plcrash_async_macho_symtab_reader_symbol_name(&reader, (uint32_t) reader.string_table_size), @"Out of range offset was accepted");
+
+    plcrash_async_macho_symtab_reader_free(&reader);
+}
+
 /**
  * Test symbol name reading.
  */
@@ -417,6 +651,291 @@ static void testFindSymbol_cb (pl_vm_address_t address, const char *name, void *
     STAssertEquals(dli.dli_saddr, (void *) ctx.addr, @"Returned incorrect symbol address with slide %" PRId64, (int64_t) _image.vmaddr_slide);
 }
 
+/**
+ * Test that symbol lookup via a pre-built symbol index returns results identical to the linear symbol table scan.
+ */
+- (void) testFindSymbolIndexed {
+    plcrash_error_t res = plcrash_nasync_macho_build_symbol_index(&_image);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    STAssertNotNULL(_image.symbol_index, @"No symbol index was built");
+    STAssertTrue(_image.symbol_index_count > 0, @"Symbol index is empty");
+
+    /* Rebuilding is a no-op */
+    plcrash_async_macho_symbol_index_entry_t *symbol_index = _image.symbol_index;
+    uint32_t symbol_index_count = _image.symbol_index_count;
+    STAssertEquals(plcrash_nasync_macho_build_symbol_index(&_image), PLCRASH_ESUCCESS, @"Failed to rebuild symbol index");
+    STAssertEquals(symbol_index, _image.symbol_index, @"Symbol index was replaced");
+
+    /* Verify the sort order */
+    for (uint32_t i = 1; i < symbol_index_count; i++)
+        STAssertTrue(symbol_index[i-1].n_value <= symbol_index[i].n_value, @"Symbol index is not sorted at %" PRIu32, i);
+
+    /* Compare indexed and linear lookups for every indexed address, as well as the addresses immediately surrounding them */
+    for (uint32_t i = 0; i < symbol_index_count; i++) {
+        for (int64_t delta = -1; delta <= 1; delta++) {
+            pl_vm_address_t pc = symbol_index[i].n_value + _image.vmaddr_slide + delta;
+            struct testFindSymbol_cb_ctx indexed = { 0, NULL };
+            struct testFindSymbol_cb_ctx linear = { 0, NULL };
+
+            plcrash_error_t indexed_res = plcrash_async_macho_find_symbol_by_pc(&_image, pc, testFindSymbol_cb, &indexed);
+
+            _image.symbol_index = NULL;
+            plcrash_error_t linear_res = plcrash_async_macho_find_symbol_by_pc(&_image, pc, testFindSymbol_cb, &linear);
+            _image.symbol_index = symbol_index;
+
+            STAssertEquals(indexed_res, linear_res, @"Indexed lookup result differs for 0x%" PRIx64, (uint64_t) pc);
+            if (indexed_res == PLCRASH_ESUCCESS && linear_res == PLCRASH_ESUCCESS) {
+                STAssertEquals(indexed.addr, linear.addr, @"Indexed lookup returned a different address for 0x%" PRIx64, (uint64_t) pc);
+                STAssertEqualCStrings(indexed.name, linear.name, @"Indexed lookup returned a different name for 0x%" PRIx64, (uint64_t) pc);
+            }
+
+            free(indexed.name);
+            free(linear.name);
+        }
+    }
+}
+
+/**
+ * Test that a batch symbol lookup returns results identical to individual lookups, both with and without a symbol index.
+ */
+- (void) testFindSymbolsBatch {
+    STAssertEquals(plcrash_nasync_macho_build_symbol_index(&_image), PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    plcrash_async_macho_symbol_index_entry_t *symbol_index = _image.symbol_index;
+    uint32_t symbol_index_count = _image.symbol_index_count;
+
+    /* Use the addresses surrounding a sample of the indexed symbols, in ascending order, including duplicates */
+    uint32_t stride = symbol_index_count / 64 + 1;
+    uint32_t count = 0;
+    pl_vm_address_t *pcs = malloc(sizeof(pl_vm_address_t) * (symbol_index_count / stride + 1) * 4);
+    for (uint32_t i = 0; i < symbol_index_count; i += stride) {
+        pl_vm_address_t pc = symbol_index[i].n_value + _image.vmaddr_slide;
+        pcs[count++] = pc - 1;
+        pcs[count++] = pc;
+        pcs[count++] = pc;
+        pcs[count++] = pc + 1;
+    }
+
+    plcrash_async_macho_symtab_entry_t *symbols = malloc(sizeof(plcrash_async_macho_symtab_entry_t) * count);
+    bool *found = malloc(sizeof(bool) * count);
+
+    plcrash_async_macho_symtab_reader_t reader;
+    STAssertEquals(plcrash_async_macho_symtab_reader_init(&reader, &_image), PLCRASH_ESUCCESS, @"Failed to initialize reader");
+
+    for (int indexed = 0; indexed <= 1; indexed++) {
+        _image.symbol_index = indexed ? symbol_index : NULL;
+
+        plcrash_error_t res = plcrash_async_macho_symtab_reader_find_symbols_by_pc(&reader, pcs, count, symbols, found);
+        STAssertEquals(res, PLCRASH_ESUCCESS, @"Batch lookup failed");
+
+        for (uint32_t i = 0; i < count; i++) {
+            struct testFindSymbol_cb_ctx single = { 0, NULL };
+            plcrash_error_t single_res = plcrash_async_macho_symtab_reader_find_symbol_by_pc(&reader, pcs[i], testFindSymbol_cb, &single);
+
+            STAssertEquals(found[i], (bool) (single_res == PLCRASH_ESUCCESS), @"Batch lookup result differs for 0x%" PRIx64, (uint64_t) pcs[i]);
+            if (found[i] && single_res == PLCRASH_ESUCCESS) {
+                STAssertEquals(symbols[i].normalized_value + _image.vmaddr_slide, single.addr, @"Batch lookup returned a different address for 0x%" PRIx64, (uint64_t) pcs[i]);
+                STAssertEqualCStrings(plcrash_async_macho_symtab_reader_symbol_name(&reader, symbols[i].n_strx), single.name,
+                                      @"Batch lookup returned a different name for 0x%" PRIx64, (uint64_t) pcs[i]);
+            }
+
+            free(single.name);
+        }
+    }
+
+    _image.symbol_index = symbol_index;
+    plcrash_async_macho_symtab_reader_free(&reader);
+
+    free(pcs);
+    free(symbols);
+    free(found);
+}
+
+#ifdef __clang__
+/*
+ * Scalar reference for plcrash_async_macho_scan_nlist64_direct(), equivalent to the plcrash_async_macho_find_best_symbol()
+ * symtab walk.
+ */
+static bool scan_nlist64_scalar (const struct nlist_64 *symtab, uint32_t nsyms, pl_vm_address_t slide_pc,
+                                 bool have_best, uint64_t best_value, uint32_t *best_index)
+{
+    bool found = false;
+    for (uint32_t i = 0; i < nsyms; i++) {
+        if ((symtab[i].n_type & N_TYPE) != N_SECT || (symtab[i].n_type & N_STAB) != 0)
+            continue;
+
+        if (symtab[i].n_value <= slide_pc && (!have_best || best_value < symtab[i].n_value)) {
+            best_value = symtab[i].n_value;
+            have_best = true;
+            *best_index = i;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/* Verify that the vectorized scan of @a symtab matches the scalar scan, returning the vectorized result */
+- (bool) checkScanNlist64: (const struct nlist_64 *) symtab count: (uint32_t) nsyms pc: (pl_vm_address_t) pc haveBest: (bool) have_best bestValue: (uint64_t) best_value bestIndex: (uint32_t *) best_index {
+    uint32_t expected_index = UINT32_MAX;
+    uint32_t actual_index = UINT32_MAX;
+
+    bool expected = scan_nlist64_scalar(symtab, nsyms, pc, have_best, best_value, &expected_index);
+    bool actual = plcrash_async_macho_scan_nlist64_direct(symtab, nsyms, pc, have_best, best_value, &actual_index);
+
+    STAssertEquals(actual, expected, @"Scan result differs for pc 0x%" PRIx64 " over %u entries", (uint64_t) pc, nsyms);
+    if (actual && expected)
+        STAssertEquals(actual_index, expected_index, @"Scan index differs for pc 0x%" PRIx64 " over %u entries", (uint64_t) pc, nsyms);
+
+    *best_index = actual_index;
+    return actual;
+}
+
+/**
+ * Test that the first of several equal-address entries is selected by the vectorized symtab scan, both within and
+ * across four-entry blocks.
+ */
+- (void) testScanNlist64Ties {
+    struct nlist_64 symtab[10];
+    memset(symtab, 0, sizeof(symtab));
+    for (uint32_t i = 0; i < 10; i++)
+        symtab[i].n_type = N_SECT;
+
+    /* 0x200 appears at indices 2, 3 (same block), 5 (next block) and 9 (the trailing entries) */
+    uint64_t values[10] = { 0x100, 0x180, 0x200, 0x200, 0x100, 0x200, 0x080, 0x1F0, 0x300, 0x200 };
+    for (uint32_t i = 0; i < 10; i++)
+        symtab[i].n_value = values[i];
+
+    uint32_t index;
+    STAssertTrue([self checkScanNlist64: symtab count: 10 pc: 0x250 haveBest: false bestValue: 0 bestIndex: &index], @"No symbol found");
+    STAssertEquals(index, (uint32_t) 2, @"The first equal-address entry was not selected");
+
+    /* Ties spanning a block and the trailing entries */
+    STAssertTrue([self checkScanNlist64: symtab + 5 count: 5 pc: 0x250 haveBest: false bestValue: 0 bestIndex: &index], @"No symbol found");
+    STAssertEquals(index, (uint32_t) 0, @"The first equal-address entry was not selected");
+}
+
+/**
+ * Test vectorized symtab scans of tables whose length is not a multiple of four, with the best entry in each position.
+ */
+- (void) testScanNlist64Remainder {
+    struct nlist_64 symtab[11];
+
+    for (uint32_t nsyms = 1; nsyms <= 11; nsyms++) {
+        for (uint32_t best = 0; best < nsyms; best++) {
+            memset(symtab, 0, sizeof(symtab));
+            for (uint32_t i = 0; i < nsyms; i++) {
+                symtab[i].n_type = N_SECT;
+                symtab[i].n_value = 0x1000 + i;
+            }
+            symtab[best].n_value = 0x2000;
+
+            uint32_t index;
+            STAssertTrue([self checkScanNlist64: symtab count: nsyms pc: 0x2000 haveBest: false bestValue: 0 bestIndex: &index], @"No symbol found");
+            STAssertEquals(index, best, @"Incorrect entry selected from %u entries", nsyms);
+        }
+    }
+}
+
+/**
+ * Test vectorized symtab scans that are seeded with a prior best match.
+ */
+- (void) testScanNlist64SeededBest {
+    struct nlist_64 symtab[9];
+    memset(symtab, 0, sizeof(symtab));
+    for (uint32_t i = 0; i < 9; i++) {
+        symtab[i].n_type = N_SECT;
+        symtab[i].n_value = 0x1000 + (i * 0x10);
+    }
+
+    /* Only entries above the seeded value are considered */
+    uint32_t index;
+    STAssertTrue([self checkScanNlist64: symtab count: 9 pc: 0x1035 haveBest: true bestValue: 0x1020 bestIndex: &index], @"No symbol found");
+    STAssertEquals(index, (uint32_t) 3, @"Incorrect entry selected");
+
+    /* An entry equal to the seeded value is not an improvement */
+    STAssertFalse([self checkScanNlist64: symtab count: 9 pc: 0x1035 haveBest: true bestValue: 0x1030 bestIndex: &index], @"Entry equal to the seeded best was selected");
+
+    /* A seeded value above every candidate leaves no match */
+    STAssertFalse([self checkScanNlist64: symtab count: 9 pc: 0x2000 haveBest: true bestValue: 0x1900 bestIndex: &index], @"Entry below the seeded best was selected");
+
+    /* A seeded zero value is distinct from no seeded value */
+    symtab[0].n_value = 0;
+    STAssertFalse([self checkScanNlist64: symtab count: 1 pc: 0x10 haveBest: true bestValue: 0 bestIndex: &index], @"Entry equal to the seeded best was selected");
+    STAssertTrue([self checkScanNlist64: symtab count: 1 pc: 0x10 haveBest: false bestValue: 0 bestIndex: &index], @"No symbol found");
+}
+
+/**
+ * Test that debugging (N_STAB) and non-N_SECT entries are skipped by the vectorized symtab scan.
+ */
+- (void) testScanNlist64SkipsIneligible {
+    struct nlist_64 symtab[10];
+    memset(symtab, 0, sizeof(symtab));
+
+    /* Every ineligible entry is closer to the PC than the single eligible entry */
+    uint8_t types[10] = { N_SECT|N_EXT, N_FUN, N_STAB|N_SECT, N_ABS, N_UNDF, N_INDR, N_PBUD, N_ABS|N_EXT, N_STSYM, N_STAB|N_SECT|N_EXT };
+    for (uint32_t i = 0; i < 10; i++) {
+        symtab[i].n_type = types[i];
+        symtab[i].n_value = 0x1000 + i;
+    }
+
+    uint32_t index;
+    STAssertTrue([self checkScanNlist64: symtab count: 10 pc: 0x2000 haveBest: false bestValue: 0 bestIndex: &index], @"No symbol found");
+    STAssertEquals(index, (uint32_t) 0, @"An ineligible entry was selected");
+
+    /* With no eligible entries, nothing is found */
+    symtab[0].n_type = N_ABS;
+    STAssertFalse([self checkScanNlist64: symtab count: 10 pc: 0x2000 haveBest: false bestValue: 0 bestIndex: &index], @"An ineligible entry was selected");
+}
+
+/**
+ * Test that the vectorized symtab scan matches the scalar scan over randomly generated tables.
+ */
+- (void) testScanNlist64Random {
+    const uint8_t types[] = { N_SECT, N_SECT|N_EXT, N_SECT|N_PEXT, N_ABS, N_UNDF, N_FUN, N_STAB|N_SECT };
+    struct nlist_64 symtab[37];
+
+    srandom(42);
+    for (uint32_t iteration = 0; iteration < 1000; iteration++) {
+        uint32_t nsyms = (uint32_t) (random() % 38);
+        memset(symtab, 0, sizeof(symtab));
+
+        /* Draw the values from a small range to produce frequent ties */
+        for (uint32_t i = 0; i < nsyms; i++) {
+            symtab[i].n_type = types[random() % (sizeof(types) / sizeof(types[0]))];
+            symtab[i].n_value = 0x1000 + (random() % 64);
+        }
+
+        pl_vm_address_t pc = 0x1000 + (random() % 72);
+        bool have_best = (random() % 2) == 0;
+        uint64_t best_value = have_best ? 0x1000 + (random() % 64) : 0;
+
+        uint32_t index;
+        [self checkScanNlist64: symtab count: nsyms pc: pc haveBest: have_best bestValue: best_value bestIndex: &index];
+    }
+}
+#endif /* __clang__ */
+
+/**
+ * Test caching of a pre-encoded binary image record.
+ */
+- (void) testSetEncodedRecord {
+    const uint8_t record[] = { 0x08, 0x2A, 0x10, 0x01 };
+    const uint8_t other[] = { 0x08, 0x2B };
+
+    STAssertNULL(_image.encoded_record, @"A record should not be cached by default");
+
+    STAssertEquals(plcrash_async_macho_set_encoded_record(&_image, record, sizeof(record)), PLCRASH_ESUCCESS, @"Failed to cache record");
+    STAssertNotNULL(_image.encoded_record, @"No record was cached");
+    STAssertEquals(_image.encoded_record_size, sizeof(record), @"Incorrect record size");
+    STAssertTrue(memcmp(_image.encoded_record, record, sizeof(record)) == 0, @"Incorrect record data");
+
+    /* Once cached, the record must not be replaced */
+    void *cached = _image.encoded_record;
+    STAssertEquals(plcrash_async_macho_set_encoded_record(&_image, other, sizeof(other)), PLCRASH_ESUCCESS, @"Failed to cache record");
+    STAssertEquals(cached, _image.encoded_record, @"Record was replaced");
+    STAssertEquals(_image.encoded_record_size, sizeof(record), @"Record size was replaced");
+}
+
 /**
  * Test lookup of symbols by name.
  */
@@ -49,10 +49,92 @@ plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *s
     
     string->address = address;
     string->mobjIsInitialized = false;
+    string->sharedMobj = NULL;
+    string->sharedIsResolved = false;
+    string->ownsTaskRef = true;
     
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Initialize a string object from a NUL-terminated C string that is expected to reside within @a mobj, such as a
+ * mapping of an image's __objc_methname section. The string's contents will be read directly from @a mobj, rather
+ * than from a mapping created for the string alone. If the string is not found within @a mobj, it will be mapped as
+ * per plcrash_async_macho_string_init().
+ *
+ * The string borrows the task reference held by @a mobj; no additional reference is acquired.
+ *
+ * @param string A pointer to the string object to initialize.
+ * @param mobj The memory object expected to contain the string. This must remain valid for the lifetime of @a string.
+ * @param address The address of the string.
+ * @return An error code.
+ */
+plcrash_error_t plcrash_async_macho_string_init_mapped (plcrash_async_macho_string_t *string, plcrash_async_mobject_t *mobj, pl_vm_address_t address) {
+    string->task = mobj->task;
+    string->address = address;
+    string->mobjIsInitialized = false;
+    string->sharedMobj = mobj;
+    string->sharedIsResolved = false;
+    string->ownsTaskRef = false;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Initialize a string object from a NUL-terminated C string of a previously determined @a length, residing within
+ * @a mobj. If the string's terminating NUL is not found at @a length within @a mobj -- for example, if @a length was
+ * cached from a string at the same address in an image that has since been unloaded -- the length is ignored, and the
+ * string is initialized as per plcrash_async_macho_string_init_mapped().
+ *
+ * @param string A pointer to the string object to initialize.
+ * @param mobj The memory object containing the string. This must remain valid for the lifetime of @a string.
+ * @param address The address of the string.
+ * @param length The string's length, in bytes, not counting the terminating NUL.
+ * @return An error code.
+ */
+plcrash_error_t plcrash_async_macho_string_init_resolved (plcrash_async_macho_string_t *string, plcrash_async_mobject_t *mobj, pl_vm_address_t address, pl_vm_size_t length) {
+    plcrash_error_t err = plcrash_async_macho_string_init_mapped(string, mobj, address);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    const char *p = plcrash_async_mobject_remap_address(mobj, address, 0, length + 1);
+    if (p != NULL && p[length] == '\0') {
+        string->length = length;
+        string->sharedIsResolved = true;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Attempt to locate the string's contents within its shared memory object.
+ *
+ * @param string The string object.
+ * @return Returns PLCRASH_ESUCCESS if the string was found, or PLCRASH_ENOTFOUND if the string does not reside (or is
+ * not terminated) within the shared memory object.
+ */
+static plcrash_error_t plcrash_async_macho_string_read_shared (plcrash_async_macho_string_t *string) {
+    plcrash_async_mobject_t *mobj = string->sharedMobj;
+
+    if (string->address < mobj->task_address || string->address - mobj->task_address >= mobj->length)
+        return PLCRASH_ENOTFOUND;
+
+    pl_vm_size_t avail = mobj->length - (string->address - mobj->task_address);
+    const char *p = plcrash_async_mobject_remap_address(mobj, string->address, 0, avail);
+    if (p == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    for (pl_vm_size_t i = 0; i < avail; i++) {
+        if (p[i] == '\0') {
+            string->length = i;
+            string->sharedIsResolved = true;
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    return PLCRASH_ENOTFOUND;
+}
+
 /**
  * Lazily read the string contents, initializing the memory object if necessary.
  *
@@ -60,7 +142,11 @@ plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *s
  * @return An error code.
  */
 static plcrash_error_t plcrash_async_macho_string_read (plcrash_async_macho_string_t *string) {
-    if (string->mobjIsInitialized)
+    if (string->mobjIsInitialized || string->sharedIsResolved)
+        return PLCRASH_ESUCCESS;
+
+    /* Prefer the shared mapping, if any */
+    if (string->sharedMobj != NULL && plcrash_async_macho_string_read_shared(string) == PLCRASH_ESUCCESS)
         return PLCRASH_ESUCCESS;
     
     pl_vm_address_t cursor = string->address;
@@ -124,7 +210,11 @@ plcrash_error_t plcrash_async_macho_string_get_length (plcrash_async_macho_strin
  */
 plcrash_error_t plcrash_async_macho_string_get_pointer (plcrash_async_macho_string_t *string, const char **outPointer) {
     plcrash_error_t err = plcrash_async_macho_string_read(string);
-    if (err == PLCRASH_ESUCCESS) {
+    if (err == PLCRASH_ESUCCESS && string->sharedIsResolved) {
+        *outPointer = plcrash_async_mobject_remap_address(string->sharedMobj, string->address, 0, string->length);
+        if (*outPointer == NULL)
+            err = PLCRASH_EACCESS;
+    } else if (err == PLCRASH_ESUCCESS) {
         *outPointer = plcrash_async_mobject_remap_address(&string->mobj, string->mobj.task_address, 0, string->mobj.length);
         if (*outPointer == NULL)
             err = PLCRASH_EACCESS;
@@ -132,6 +222,24 @@ plcrash_error_t plcrash_async_macho_string_get_pointer (plcrash_async_macho_stri
     return err;
 }
 
+/**
+ * Fetch the length of the string if it has already been determined -- either by a previous call to
+ * plcrash_async_macho_string_get_length() or plcrash_async_macho_string_get_pointer(), or via
+ * plcrash_async_macho_string_init_resolved() -- and the string's contents were found within its shared memory object.
+ * The string will not be read.
+ *
+ * @param string The string object.
+ * @param outLength On successful return, contains the length of the string in bytes, excluding the terminating NUL.
+ * @return Returns true if the string's length was available, false otherwise.
+ */
+bool plcrash_async_macho_string_get_resolved_length (plcrash_async_macho_string_t *string, pl_vm_size_t *outLength) {
+    if (!string->sharedIsResolved)
+        return false;
+
+    *outLength = string->length;
+    return true;
+}
+
 /**
  * Free a string.
  *
@@ -142,7 +250,8 @@ void plcrash_async_macho_string_free (plcrash_async_macho_string_t *string) {
         plcrash_async_mobject_free(&string->mobj);
     
     /* Free the task reference */
-    mach_port_mod_refs(mach_task_self(), string->task, MACH_PORT_RIGHT_SEND, -1);
+    if (string->ownsTaskRef)
+        mach_port_mod_refs(mach_task_self(), string->task, MACH_PORT_RIGHT_SEND, -1);
 }
 
 /**
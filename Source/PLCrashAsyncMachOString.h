@@ -56,12 +56,25 @@ typedef struct plcrash_async_macho_string {
     /** Whether the memory object is initialized. */
     bool mobjIsInitialized;
 
+    /** A borrowed memory object expected to contain the string, or NULL. See plcrash_async_macho_string_init_mapped(). */
+    plcrash_async_mobject_t *sharedMobj;
+
+    /** Whether the string's contents were found within sharedMobj. */
+    bool sharedIsResolved;
+
+    /** Whether a reference to task is held by the string object. */
+    bool ownsTaskRef;
+
     /** The string's length, in bytes, not counting the terminating NUL. */
     pl_vm_size_t length;
 } plcrash_async_macho_string_t;
 
 
 plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *string, task_t task, pl_vm_address_t address);
+plcrash_error_t plcrash_async_macho_string_init_mapped (plcrash_async_macho_string_t *string, plcrash_async_mobject_t *mobj, pl_vm_address_t address);
+plcrash_error_t plcrash_async_macho_string_init_resolved (plcrash_async_macho_string_t *string, plcrash_async_mobject_t *mobj, pl_vm_address_t address, pl_vm_size_t length);
+
+bool plcrash_async_macho_string_get_resolved_length (plcrash_async_macho_string_t *string, pl_vm_size_t *outLength);
 
 plcrash_error_t plcrash_async_macho_string_get_length (plcrash_async_macho_string_t *string, pl_vm_size_t *outLength);
 
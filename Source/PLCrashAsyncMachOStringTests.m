@@ -35,6 +35,7 @@
 
 #import "PLCrashAsyncMachOImage.h"
 #import "PLCrashAsyncMachOString.h"
+#import "PLCrashAsyncMObject.h"
 
 @interface PLCrashAsyncMachOStringTests : SenTestCase {
     /** The image containing our class. */
@@ -108,4 +109,45 @@
     STAssertEquals(strncmp(str, ptr, len), 0, @"String contents do not match");
 }
 
+/**
+ * Test reading strings from a shared memory object, including strings initialized with a (possibly stale) length.
+ */
+- (void) testMappedStringReading {
+    const char strings[] = "first\0second\0third";
+    plcrash_async_mobject_t mobj;
+    plcrash_error_t err;
+
+    err = plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) strings, sizeof(strings), true);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to map strings");
+
+    /* Read a string from the shared mapping */
+    plcrash_async_macho_string_t strObj;
+    pl_vm_size_t len;
+    const char *ptr;
+
+    STAssertEquals(plcrash_async_macho_string_init_mapped(&strObj, &mobj, (pl_vm_address_t) &strings[6]), PLCRASH_ESUCCESS, @"Failed to initialize string");
+    STAssertFalse(plcrash_async_macho_string_get_resolved_length(&strObj, &len), @"The string should not be read until required");
+    STAssertEquals(plcrash_async_macho_string_get_pointer(&strObj, &ptr), PLCRASH_ESUCCESS, @"Error getting string pointer");
+    STAssertTrue(plcrash_async_macho_string_get_resolved_length(&strObj, &len), @"The string should be resolved within the mapping");
+    STAssertEquals(len, (pl_vm_size_t) strlen("second"), @"Incorrect length");
+    STAssertEquals(strncmp(ptr, "second", len), 0, @"String contents do not match");
+    STAssertEquals((pl_vm_address_t) ptr, (pl_vm_address_t) plcrash_async_mobject_remap_address(&mobj, (pl_vm_address_t) &strings[6], 0, len), @"The string should be read from the shared mapping");
+    plcrash_async_macho_string_free(&strObj);
+
+    /* A correct length is used without scanning */
+    STAssertEquals(plcrash_async_macho_string_init_resolved(&strObj, &mobj, (pl_vm_address_t) strings, 5), PLCRASH_ESUCCESS, @"Failed to initialize string");
+    STAssertTrue(plcrash_async_macho_string_get_resolved_length(&strObj, &len), @"The provided length should be used");
+    STAssertEquals(len, (pl_vm_size_t) 5, @"Incorrect length");
+    plcrash_async_macho_string_free(&strObj);
+
+    /* A stale length is discarded */
+    STAssertEquals(plcrash_async_macho_string_init_resolved(&strObj, &mobj, (pl_vm_address_t) strings, 3), PLCRASH_ESUCCESS, @"Failed to initialize string");
+    STAssertFalse(plcrash_async_macho_string_get_resolved_length(&strObj, &len), @"A stale length should be discarded");
+    STAssertEquals(plcrash_async_macho_string_get_length(&strObj, &len), PLCRASH_ESUCCESS, @"Error getting string length");
+    STAssertEquals(len, (pl_vm_size_t) 5, @"Incorrect length");
+    plcrash_async_macho_string_free(&strObj);
+
+    plcrash_async_mobject_free(&mobj);
+}
+
 @end
@@ -31,6 +31,7 @@
 
 #include "PLCrashAsyncMachOImage.h"
 #include "PLCrashAsyncMachOString.h"
+#include "PLCrashAsyncCacheBudget.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,27 +51,49 @@ extern "C" {
 
 extern const uint64_t PLCRASH_ASYNC_OBJC_ISA_NONPTR_CLASS_MASK;
 
+/** The minimum size of a plcrash_async_objc_cache_t's class cache, in entries. Must be a power of two. */
+#define PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE 1024
+
+/** The default maximum size of a plcrash_async_objc_cache_t's class cache, in entries. Must be a power of two. */
+#define PLCRASH_ASYNC_OBJC_CLASS_CACHE_DEFAULT_MAX_SIZE (1 << 17)
+
+/** The number of sets in a plcrash_async_objc_cache_t's section mapping cache. Must be a power of two. */
+#define PLCRASH_ASYNC_OBJC_CACHE_SETS 4
+
+/** The number of image entries per set in a plcrash_async_objc_cache_t's section mapping cache. */
+#define PLCRASH_ASYNC_OBJC_CACHE_WAYS 2
+
+/** The number of entries in a plcrash_async_objc_cache_t's class name cache. Must be a power of two. */
+#define PLCRASH_ASYNC_OBJC_CLASS_NAME_CACHE_SIZE 256
+
 /**
  * @internal
  *
- * Caches Objective-C data across API calls.
- *
- * This is used to speed up ObjC parsing.
+ * The range of IMPs found within a method list. If no methods have been recorded, min is greater than max.
+ */
+typedef struct plcrash_async_objc_imp_bounds {
+    /** The lowest IMP in the method list. */
+    pl_vm_address_t min;
+
+    /** The highest IMP in the method list. */
+    pl_vm_address_t max;
+} plcrash_async_objc_imp_bounds_t;
+
+/**
+ * @internal
  *
- * @warning It is invalid to reuse this context for multiple Mach tasks.
- * @warning Any plcrash_async_macho_t pointers passed in must be valid across all
- * calls using this context.
+ * The ObjC section mappings for a single Mach-O image.
  */
-typedef struct plcrash_async_objc_cache {
-    /**
-     * Whether any ObjC info has ever been successfully obtained. If it has, then
-     * ObjC1 info can be skipped.
-     */
-    bool gotObjC2Info;
-    
-    /** The last MachO image seen. The image for which the memory objects below are valid. */
-    plcrash_async_macho_t *lastImage;
-    
+typedef struct plcrash_async_objc_image_sections {
+    /** The MachO image for which the memory objects below are valid, or NULL if this entry is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The result of mapping the image's sections. Only PLCRASH_ESUCCESS and PLCRASH_ENOTFOUND results are cached. */
+    plcrash_error_t mapResult;
+
+    /** The value of the owning cache's use counter as of the last lookup of this entry; used for LRU eviction. */
+    uint32_t lastUsed;
+
     /** Whether the objcConst object is initialized. */
     bool objcConstMobjInitialized;
     
@@ -94,19 +117,90 @@ typedef struct plcrash_async_objc_cache {
     
     /** A memory object for the __objc_data section. */
     plcrash_async_mobject_t objcDataMobj;
+
+    /** Whether the class name memory object is initialized. */
+    bool classNameMobjInitialized;
+
+    /** A memory object for the __objc_classname section, from which class name strings are read. */
+    plcrash_async_mobject_t classNameMobj;
+
+    /** Whether the method name memory object is initialized. */
+    bool methNameMobjInitialized;
+
+    /** A memory object for the __objc_methname section, from which method name strings are read. */
+    plcrash_async_mobject_t methNameMobj;
+} plcrash_async_objc_image_sections_t;
+
+/**
+ * @internal
+ *
+ * Caches Objective-C data across API calls.
+ *
+ * This is used to speed up ObjC parsing. Section mappings are cached for up to
+ * PLCRASH_ASYNC_OBJC_CACHE_SETS * PLCRASH_ASYNC_OBJC_CACHE_WAYS images at once, allowing
+ * stacks that alternate between a small number of images to avoid remapping on every frame.
+ *
+ * Class and method name strings are read from each image's mapped __objc_classname and __objc_methname sections,
+ * rather than mapped individually, and the lengths of recently resolved class names are cached by address.
+ *
+ * @warning It is invalid to reuse this context for multiple Mach tasks.
+ * @warning Any plcrash_async_macho_t pointers passed in must be valid across all
+ * calls using this context.
+ */
+typedef struct plcrash_async_objc_cache {
+    /**
+     * Whether any ObjC info has ever been successfully obtained. If it has, then
+     * ObjC1 info can be skipped.
+     */
+    bool gotObjC2Info;
     
-    /** The size of the class cache, in entries. */
+    /** The set-associative section mapping cache, indexed by image header address. */
+    plcrash_async_objc_image_sections_t sections[PLCRASH_ASYNC_OBJC_CACHE_SETS][PLCRASH_ASYNC_OBJC_CACHE_WAYS];
+
+    /** Monotonically increasing counter used to order section cache entries by last use. */
+    uint32_t useCounter;
+
+    /** The section mappings for the image most recently passed to the ObjC parser, or NULL. */
+    plcrash_async_objc_image_sections_t *current;
+    
+    /** The size of the class cache, in entries. This is always zero or a power of two. */
     size_t classCacheSize;
+
+    /** The number of occupied class cache entries. */
+    size_t classCacheCount;
+
+    /** The maximum size to which the class cache may grow, in entries. Always a power of two. */
+    size_t classCacheMaxSize;
     
     /** Array of class cache keys. These are class data pointers. */
     pl_vm_address_t *classCacheKeys;
     
     /** Array of class cache values. These are pointers to class_ro data. */
     pl_vm_address_t *classCacheValues;
+
+    /** Array of class cache IMP bounds, recorded once each class's base method list has been parsed. Classes whose
+     * bounds cannot contain a better match for a lookup are skipped by later lookups. */
+    plcrash_async_objc_imp_bounds_t *classCacheBounds;
+
+    /** The budget charged for the class cache, or NULL. See plcrash_async_objc_cache_set_budget(). */
+    plcrash_async_cache_budget_t *budget;
+
+    /** The class cache's registration with budget, or PLCRASH_ASYNC_CACHE_ID_INVALID. */
+    plcrash_async_cache_id_t budgetID;
+
+    /** Direct-mapped class name cache keys. These are the addresses of resolved class name strings, or 0. */
+    pl_vm_address_t classNameCacheKeys[PLCRASH_ASYNC_OBJC_CLASS_NAME_CACHE_SIZE];
+
+    /** Direct-mapped class name cache values. These are the lengths of the class name strings. */
+    uint32_t classNameCacheLengths[PLCRASH_ASYNC_OBJC_CLASS_NAME_CACHE_SIZE];
 } plcrash_async_objc_cache_t;
 
 plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *context);
 void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *context);
+void plcrash_async_objc_cache_set_max_class_capacity (plcrash_async_objc_cache_t *context, size_t capacity);
+plcrash_error_t plcrash_async_objc_cache_set_budget (plcrash_async_objc_cache_t *context, plcrash_async_cache_budget_t *budget);
+void plcrash_nasync_objc_cache_reserve_classes (plcrash_async_objc_cache_t *context, size_t count);
+plcrash_error_t plcrash_nasync_objc_cache_prefault (plcrash_async_objc_cache_t *context, bool wire);
     
 bool plcrash_async_objc_supports_nonptr_isa (cpu_type_t type);
 
@@ -122,6 +216,11 @@ bool plcrash_async_objc_supports_nonptr_isa (cpu_type_t type);
 typedef void (*plcrash_async_objc_found_method_cb)(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx);
 
 plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx);
+plcrash_error_t plcrash_async_objc_find_methods (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, const pl_vm_address_t *imps, uint32_t count,
+                                                 plcrash_async_objc_method_index_entry_t *methods, bool *found);
+plcrash_error_t plcrash_async_objc_report_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, const plcrash_async_objc_method_index_entry_t *method, plcrash_async_objc_found_method_cb callback, void *ctx);
+
+plcrash_error_t plcrash_nasync_objc_build_method_index (plcrash_async_macho_t *image);
     
 /**
  * @}
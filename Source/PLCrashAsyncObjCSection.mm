@@ -30,6 +30,8 @@
 #include "PLCrashCompatConstants.h"
 
 #include <Foundation/Foundation.h>
+#include <sys/mman.h>
+#include <errno.h>
 
 /**
  * @internal
@@ -68,6 +70,9 @@ static const char * const kClassListSectionName = "__objc_classlist";
 static const char * const kCategoryListSectionName = "__objc_catlist";
 static const char * const kObjCConstSectionName = "__objc_const";
 static const char * const kObjCDataSectionName = "__objc_data";
+static const char * const kTextSegmentName = "__TEXT";
+static const char * const kObjCClassNameSectionName = "__objc_classname";
+static const char * const kObjCMethNameSectionName = "__objc_methname";
 
 static uint32_t CLS_NO_METHOD_ARRAY = 0x4000;
 static uint32_t END_OF_METHODS_LIST = -1;
@@ -237,9 +242,23 @@ struct pl_objc2_list_header {
     uint32_t count;
 };
 
+/**
+ * @internal
+ *
+ * A callback used to prune the methods visited by the ObjC parser. Before visiting the methods of a class whose IMP
+ * bounds have been recorded by an earlier parse, the parser invokes this callback with those bounds; if the callback
+ * returns false, the class's methods are skipped.
+ *
+ * @param min The lowest IMP in the class's method list.
+ * @param max The highest IMP in the class's method list.
+ * @param ctx The context pointer specified by the original caller.
+ * @return Returns true if any method within the bounds may be of interest to the caller, false otherwise.
+ */
+typedef bool (*pl_async_objc_imp_range_cb)(pl_vm_address_t min, pl_vm_address_t max, void *ctx);
+
 
 /**
- * Get the index into the context's cache for the given key. Must only be called
+ * Get the initial probe index into the context's cache for the given key. Must only be called
  * if the cache size has been set.
  *
  * @param context The context.
@@ -247,18 +266,21 @@ struct pl_objc2_list_header {
  * @return The index.
  */
 static size_t cache_index (plcrash_async_objc_cache_t *context, pl_vm_address_t key) {
-    return (key >> 2) % context->classCacheSize;
+    /* Class data pointers are aligned; discard the low bits, and mix the remainder so that sequentially
+     * allocated classes do not cluster in adjacent buckets. */
+    uint64_t hash = (uint64_t) (key >> 3) * 0x9E3779B97F4A7C15ULL;
+    return (size_t) (hash >> 32) & (context->classCacheSize - 1);
 }
 
 /**
- * Get the context's cache's total memory allocation size, including both keys and values.
+ * Get the total memory allocation size required for a cache of @a size entries, including keys, values, and IMP bounds.
  *
  * @param context The context.
- * @return The total number of bytes allocated for the cache.
+ * @param size The number of entries.
+ * @return The total number of bytes required for the cache.
  */
-static size_t cache_allocation_size (plcrash_async_objc_cache_t *context) {
-    size_t size = context->classCacheSize;
-    return size * sizeof(*context->classCacheKeys) + size * sizeof(*context->classCacheValues);
+static size_t cache_allocation_size (plcrash_async_objc_cache_t *context, size_t size) {
+    return size * sizeof(*context->classCacheKeys) + size * sizeof(*context->classCacheValues) + size * sizeof(*context->classCacheBounds);
 }
 
 /**
@@ -266,145 +288,392 @@ static size_t cache_allocation_size (plcrash_async_objc_cache_t *context) {
  *
  * @param context The context.
  * @param key The key to look up.
+ * @param[out] bounds On return, set to the entry's IMP bounds, or NULL if no entry was found. The pointer is
+ * invalidated by any subsequent modification of the cache.
  * @return The value stored in the cache for that key, or 0 if none was found.
  */
-static pl_vm_address_t cache_lookup (plcrash_async_objc_cache_t *context, pl_vm_address_t key) {
-    if (context->classCacheSize > 0) {
-        size_t index = cache_index(context, key);
+static pl_vm_address_t cache_lookup (plcrash_async_objc_cache_t *context, pl_vm_address_t key, plcrash_async_objc_imp_bounds_t **bounds) {
+    *bounds = NULL;
+    if (context->classCacheSize == 0)
+        return 0;
+
+    /* Linear probe until we find the key or an empty bucket. The table is never permitted to fill, so
+     * an empty bucket is guaranteed to terminate the search. */
+    size_t mask = context->classCacheSize - 1;
+    for (size_t index = cache_index(context, key); ; index = (index + 1) & mask) {
         if (context->classCacheKeys[index] == key) {
+            *bounds = &context->classCacheBounds[index];
             return context->classCacheValues[index];
         }
+
+        if (context->classCacheKeys[index] == 0)
+            return 0;
     }
-    return 0;
 }
 
 /**
- * Store a key/value pair in the cache. The cache is not guaranteed storage so storing may
- * silently fail, and the association can be evicted at any time. It's a CACHE.
+ * Insert a key/value pair into the cache's current table, without growing it. The table must contain
+ * at least one empty bucket. The entry's IMP bounds are reset.
  *
  * @param context The context.
  * @param key The key to store.
  * @param value The value to store.
+ * @return The entry's IMP bounds. The pointer is invalidated by any subsequent modification of the cache.
  */
-static void cache_set (plcrash_async_objc_cache_t *context, pl_vm_address_t key, pl_vm_address_t value) {
-    /* If nothing has used the cache yet, allocate the memory. */
-    if (context->classCacheKeys == NULL) {
-        size_t size = 1024;
-        context->classCacheSize = size;
-        
-        size_t allocationSize = cache_allocation_size(context);
-        
-        vm_address_t addr;
-        kern_return_t err = vm_allocate(mach_task_self_, &addr, allocationSize, VM_FLAGS_ANYWHERE);
-        /* If it fails, just bail out. We don't need the cache for correct operation. */
-        if (err != KERN_SUCCESS) {
-            PLCF_DEBUG("vm_allocate failed with error %x, the class cache could not be initialized and ObjC parsing will be substantially slower", err);
-            context->classCacheSize = 0;
-            return;
+static plcrash_async_objc_imp_bounds_t *cache_insert (plcrash_async_objc_cache_t *context, pl_vm_address_t key, pl_vm_address_t value) {
+    size_t mask = context->classCacheSize - 1;
+    for (size_t index = cache_index(context, key); ; index = (index + 1) & mask) {
+        if (context->classCacheKeys[index] == 0) {
+            context->classCacheKeys[index] = key;
+            context->classCacheCount++;
+        } else if (context->classCacheKeys[index] != key) {
+            continue;
         }
-        
-        context->classCacheKeys = (pl_vm_address_t *)addr;
-        context->classCacheValues = (pl_vm_address_t *)(context->classCacheKeys + size);
-    }
-    
-    /* Treat the cache as a simple hash table with no chaining whatsoever. If the bucket is already
-     * occupied, then don't do anything. The existing entry wins. */
-    size_t index = cache_index(context, key);
-    if (context->classCacheKeys[index] == 0) {
-        context->classCacheKeys[index] = key;
+
         context->classCacheValues[index] = value;
+        context->classCacheBounds[index].min = PL_VM_ADDRESS_MAX;
+        context->classCacheBounds[index].max = 0;
+        return &context->classCacheBounds[index];
+    }
+}
+
+/**
+ * Ensure that the cache has room for at least @a count entries while remaining at or below a 50%
+ * load factor, growing (and rehashing) the table if necessary. Growth is bounded by classCacheMaxSize.
+ *
+ * @param context The context.
+ * @param count The number of entries for which room should be made.
+ */
+static void cache_reserve (plcrash_async_objc_cache_t *context, size_t count) {
+    /* Compute the required size */
+    size_t size = context->classCacheSize > 0 ? context->classCacheSize : PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE;
+    while (size < count * 2 && size < context->classCacheMaxSize)
+        size <<= 1;
+
+    if (size > context->classCacheMaxSize)
+        size = context->classCacheMaxSize;
+
+    if (size <= context->classCacheSize)
+        return;
+
+    /* Charge the budget for the new table; the old table's charge is released once it has been replaced. */
+    if (plcrash_async_cache_budget_charge(context->budget, context->budgetID, cache_allocation_size(context, size)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("The class cache could not be resized to %zu entries within the cache memory budget", size);
+        return;
+    }
+
+    /* Allocate the new table. vm_allocate() guarantees zero-filled pages, and 0 is our empty key. */
+    vm_address_t addr;
+    kern_return_t err = vm_allocate(mach_task_self_, &addr, cache_allocation_size(context, size), VM_FLAGS_ANYWHERE);
+
+    /* If it fails, just bail out. We don't need the cache for correct operation. */
+    if (err != KERN_SUCCESS) {
+        PLCF_DEBUG("vm_allocate failed with error %x, the class cache could not be resized and ObjC parsing will be substantially slower", err);
+        plcrash_async_cache_budget_release(context->budget, context->budgetID, cache_allocation_size(context, size));
+        return;
+    }
+
+    pl_vm_address_t *oldKeys = context->classCacheKeys;
+    pl_vm_address_t *oldValues = context->classCacheValues;
+    plcrash_async_objc_imp_bounds_t *oldBounds = context->classCacheBounds;
+    size_t oldSize = context->classCacheSize;
+
+    context->classCacheSize = size;
+    context->classCacheCount = 0;
+    context->classCacheKeys = (pl_vm_address_t *)addr;
+    context->classCacheValues = (pl_vm_address_t *)(context->classCacheKeys + size);
+    context->classCacheBounds = (plcrash_async_objc_imp_bounds_t *)(context->classCacheValues + size);
+
+    /* Rehash the existing entries */
+    if (oldKeys == NULL)
+        return;
+
+    for (size_t i = 0; i < oldSize; i++) {
+        if (oldKeys[i] != 0)
+            *cache_insert(context, oldKeys[i], oldValues[i]) = oldBounds[i];
     }
+
+    vm_deallocate(mach_task_self(), (vm_address_t) oldKeys, cache_allocation_size(context, oldSize));
+    plcrash_async_cache_budget_release(context->budget, context->budgetID, cache_allocation_size(context, oldSize));
 }
 
 /**
- * Free any initialized memory objects in an ObjC context object.
+ * Deallocate the cache's class table, releasing its budget charge. The table will be reallocated by the next
+ * cache_set().
  *
  * @param context The context.
  */
-static void free_mapped_sections (plcrash_async_objc_cache_t *context) {
-    if (context->objcConstMobjInitialized) {
-        plcrash_async_mobject_free(&context->objcConstMobj);
-        context->objcConstMobjInitialized = false;
+static void cache_discard (plcrash_async_objc_cache_t *context) {
+    if (context->classCacheKeys == NULL)
+        return;
+
+    vm_deallocate(mach_task_self(), (vm_address_t) context->classCacheKeys, cache_allocation_size(context, context->classCacheSize));
+    plcrash_async_cache_budget_release(context->budget, context->budgetID, cache_allocation_size(context, context->classCacheSize));
+
+    context->classCacheSize = 0;
+    context->classCacheCount = 0;
+    context->classCacheKeys = NULL;
+    context->classCacheValues = NULL;
+    context->classCacheBounds = NULL;
+}
+
+/**
+ * Store a key/value pair in the cache. The cache is not guaranteed storage so storing may
+ * silently fail once the cache has reached its maximum size. It's a CACHE.
+ *
+ * @param context The context.
+ * @param key The key to store.
+ * @param value The value to store.
+ * @return The entry's IMP bounds, or NULL if the entry was not stored. The pointer is invalidated by any subsequent
+ * modification of the cache.
+ */
+static plcrash_async_objc_imp_bounds_t *cache_set (plcrash_async_objc_cache_t *context, pl_vm_address_t key, pl_vm_address_t value) {
+    /* Grow the cache if required to remain at or below a 50% load factor */
+    if ((context->classCacheCount + 1) * 2 > context->classCacheSize)
+        cache_reserve(context, context->classCacheCount + 1);
+
+    if (context->classCacheSize == 0)
+        return NULL;
+
+    /* If we're at our maximum size, stop inserting at a 75% load factor; probe sequences would otherwise
+     * degrade, and we must always leave an empty bucket to terminate lookups. */
+    if ((context->classCacheCount + 1) * 4 > context->classCacheSize * 3)
+        return NULL;
+
+    return cache_insert(context, key, value);
+}
+
+/**
+ * Free any initialized memory objects in a section cache entry, and mark the entry as unused.
+ *
+ * @param entry The cache entry.
+ */
+static void free_mapped_sections (plcrash_async_objc_image_sections_t *entry) {
+    if (entry->objcConstMobjInitialized) {
+        plcrash_async_mobject_free(&entry->objcConstMobj);
+        entry->objcConstMobjInitialized = false;
+    }
+    if (entry->classMobjInitialized) {
+        plcrash_async_mobject_free(&entry->classMobj);
+        entry->classMobjInitialized = false;
+    }
+    if (entry->catMobjInitialized) {
+        plcrash_async_mobject_free(&entry->catMobj);
+        entry->catMobjInitialized = false;
     }
-    if (context->classMobjInitialized) {
-        plcrash_async_mobject_free(&context->classMobj);
-        context->classMobjInitialized = false;
+    if (entry->objcDataMobjInitialized) {
+        plcrash_async_mobject_free(&entry->objcDataMobj);
+        entry->objcDataMobjInitialized = false;
     }
-    if (context->catMobjInitialized) {
-        plcrash_async_mobject_free(&context->catMobj);
-        context->catMobjInitialized = false;
+    if (entry->classNameMobjInitialized) {
+        plcrash_async_mobject_free(&entry->classNameMobj);
+        entry->classNameMobjInitialized = false;
     }
-    if (context->objcDataMobjInitialized) {
-        plcrash_async_mobject_free(&context->objcDataMobj);
-        context->objcDataMobjInitialized = false;
+    if (entry->methNameMobjInitialized) {
+        plcrash_async_mobject_free(&entry->methNameMobj);
+        entry->methNameMobjInitialized = false;
     }
+
+    entry->image = NULL;
 }
 
 /**
- * Set up the memory objects in an ObjC context object for the given image. This will
- * map the memory objects in the context to the appropriate sections in the image.
+ * Map the ObjC sections of @a image into the given cache entry.
  *
  * @param image The MachO image to map.
- * @param context The context.
+ * @param entry The cache entry to populate. Must not hold any mappings.
  * @return An error code.
  */
-static plcrash_error_t map_sections (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *context) {
-    if (image == context->lastImage)
-        return PLCRASH_ESUCCESS;
-    
-    /* Clean up the info from the previous image. Free the memory objects and reset the
-     * image pointer. The image pointer is reset so that it's not stale in case we return
-     * early due to an error. */
-    free_mapped_sections(context);
-    context->lastImage = NULL;
-    
+static plcrash_error_t map_sections_entry (plcrash_async_macho_t *image, plcrash_async_objc_image_sections_t *entry) {
     plcrash_error_t err;
     
     /* Map in the __objc_const section, which is where all the read-only class data lives. */
-    err = plcrash_async_macho_map_section(image, kDataSegmentName, kObjCConstSectionName, &context->objcConstMobj);
+    err = plcrash_async_macho_map_section(image, kDataSegmentName, kObjCConstSectionName, &entry->objcConstMobj);
     if (err != PLCRASH_ESUCCESS) {
         if (err != PLCRASH_ENOTFOUND)
-            PLCF_DEBUG("pl_async_macho_map_section(%p, %s, %s, %p) failure %d", image, kDataSegmentName, kObjCConstSectionName, &context->objcConstMobj, err);
-        goto cleanup;
+            PLCF_DEBUG("pl_async_macho_map_section(%p, %s, %s, %p) failure %d", image, kDataSegmentName, kObjCConstSectionName, &entry->objcConstMobj, err);
+        return err;
     }
-    context->objcConstMobjInitialized = true;
+    entry->objcConstMobjInitialized = true;
     
     /* Map in the class list section.  */
-    err = plcrash_async_macho_map_section(image, kDataSegmentName, kClassListSectionName, &context->classMobj);
+    err = plcrash_async_macho_map_section(image, kDataSegmentName, kClassListSectionName, &entry->classMobj);
     if (err != PLCRASH_ESUCCESS) {
         if (err != PLCRASH_ENOTFOUND)
-            PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kClassListSectionName, &context->classMobj, err);
-        goto cleanup;
+            PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kClassListSectionName, &entry->classMobj, err);
+        return err;
     }
-    context->classMobjInitialized = true;
+    entry->classMobjInitialized = true;
     
     /* Map in the category list section.  */
-    err = plcrash_async_macho_map_section(image, kDataSegmentName, kCategoryListSectionName, &context->catMobj);
+    err = plcrash_async_macho_map_section(image, kDataSegmentName, kCategoryListSectionName, &entry->catMobj);
     if (err != PLCRASH_ESUCCESS) {
         if (err != PLCRASH_ENOTFOUND)
-            PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kCategoryListSectionName, &context->catMobj, err);
-        goto cleanup;
+            PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kCategoryListSectionName, &entry->catMobj, err);
+        return err;
     }
-    context->catMobjInitialized = true;
+    entry->catMobjInitialized = true;
     
     /* Map in the __objc_data section, which is where the actual classes live. */
-    err = plcrash_async_macho_map_section(image, kDataSegmentName, kObjCDataSectionName, &context->objcDataMobj);
+    err = plcrash_async_macho_map_section(image, kDataSegmentName, kObjCDataSectionName, &entry->objcDataMobj);
     if (err != PLCRASH_ESUCCESS) {
         /* If the class list was found, the data section must also be found */
-        PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kObjCDataSectionName, &context->objcDataMobj, err);
-        goto cleanup;
+        PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kDataSegmentName, kObjCDataSectionName, &entry->objcDataMobj, err);
+        return err;
     }
-    context->objcDataMobjInitialized = true;
-    
-    /* Only after all mappings succeed do we set the image. If any failed, the image won't be set,
-     * and any mappings that DO succeed will be cleaned up on the next call (or when freeing the
-     * context. */
-    context->lastImage = image;
-    
-cleanup:
+    entry->objcDataMobjInitialized = true;
+
+    /* Map in the class and method name sections. These are optional; names outside of these sections (including
+     * selectors uniqued into another image) are mapped individually. */
+    err = plcrash_async_macho_map_section(image, kTextSegmentName, kObjCClassNameSectionName, &entry->classNameMobj);
+    if (err == PLCRASH_ESUCCESS)
+        entry->classNameMobjInitialized = true;
+    else if (err != PLCRASH_ENOTFOUND)
+        PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kTextSegmentName, kObjCClassNameSectionName, &entry->classNameMobj, err);
+
+    err = plcrash_async_macho_map_section(image, kTextSegmentName, kObjCMethNameSectionName, &entry->methNameMobj);
+    if (err == PLCRASH_ESUCCESS)
+        entry->methNameMobjInitialized = true;
+    else if (err != PLCRASH_ENOTFOUND)
+        PLCF_DEBUG("pl_async_macho_map_section(%s, %s, %s, %p) failure %d", image->name, kTextSegmentName, kObjCMethNameSectionName, &entry->methNameMobj, err);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Set up the memory objects in an ObjC context object for the given image. This will
+ * map the image's sections into a section cache entry (or find an existing entry) and
+ * set it as the context's current entry.
+ *
+ * @param image The MachO image to map.
+ * @param context The context.
+ * @return An error code.
+ */
+static plcrash_error_t map_sections (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *context) {
+    /* Fast path; the same image as the previous call */
+    if (context->current != NULL && context->current->image == image)
+        return context->current->mapResult;
+
+    /* Reset the current entry so that it's not stale in case we return early due to an error. */
+    context->current = NULL;
+
+    /* Images are page-aligned; discard the low bits before selecting a set. */
+    size_t set = (size_t) (image->header_addr >> 12) & (PLCRASH_ASYNC_OBJC_CACHE_SETS - 1);
+    plcrash_async_objc_image_sections_t *ways = context->sections[set];
+    uint32_t now = ++context->useCounter;
+
+    /* Look for an existing entry, tracking the least recently used entry as a replacement candidate */
+    plcrash_async_objc_image_sections_t *victim = &ways[0];
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_CACHE_WAYS; i++) {
+        plcrash_async_objc_image_sections_t *entry = &ways[i];
+        if (entry->image == image) {
+            entry->lastUsed = now;
+            context->current = entry;
+            return entry->mapResult;
+        }
+
+        if (victim->image == NULL)
+            continue;
+
+        if (entry->image == NULL || entry->lastUsed < victim->lastUsed)
+            victim = entry;
+    }
+
+    /* Evict the victim and map the new image's sections in its place */
+    free_mapped_sections(victim);
+
+    plcrash_error_t err = map_sections_entry(image, victim);
+    if (err != PLCRASH_ESUCCESS) {
+        /* Don't hold partial mappings; any failure leaves the entry without mapped sections */
+        free_mapped_sections(victim);
+
+        /* Only cache the absence of ObjC data; other errors will be retried on the next call */
+        if (err != PLCRASH_ENOTFOUND)
+            return err;
+    }
+
+    /* Only after all mappings succeed (or are definitively absent) do we set the image. */
+    victim->image = image;
+    victim->mapResult = err;
+    victim->lastUsed = now;
+    context->current = victim;
+
     return err;
 }
 
+/**
+ * Initialize a method name string, reading the name from the current image's mapped __objc_methname section if
+ * possible.
+ *
+ * @param image The image containing the method.
+ * @param context The context. The current section entry must be that of @a image.
+ * @param address The address of the method name.
+ * @param[out] method_name The string to initialize. The caller is responsible for freeing the string via
+ * plcrash_async_macho_string_free().
+ * @return An error code.
+ */
+static plcrash_error_t method_name_init (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *context, pl_vm_address_t address, plcrash_async_macho_string_t *method_name) {
+    plcrash_async_objc_image_sections_t *entry = context->current;
+    if (entry != NULL && entry->methNameMobjInitialized)
+        return plcrash_async_macho_string_init_mapped(method_name, &entry->methNameMobj, address);
+
+    return plcrash_async_macho_string_init(method_name, image->task, address);
+}
+
+/**
+ * Get the class name cache index for the given class name address.
+ *
+ * @param address The class name address.
+ * @return The index.
+ */
+static size_t class_name_cache_index (pl_vm_address_t address) {
+    /* Class names are packed without alignment; mix all bits of the address. */
+    uint64_t hash = (uint64_t) address * 0x9E3779B97F4A7C15ULL;
+    return (size_t) (hash >> 32) & (PLCRASH_ASYNC_OBJC_CLASS_NAME_CACHE_SIZE - 1);
+}
+
+/**
+ * Initialize a class name string, reading the name from the current image's mapped __objc_classname section if
+ * possible. If the name's length was cached by class_name_free(), the string is initialized with the cached length,
+ * and its contents need not be scanned.
+ *
+ * @param image The image containing the class.
+ * @param context The context. The current section entry must be that of @a image.
+ * @param address The address of the class name.
+ * @param[out] class_name The string to initialize. The caller is responsible for freeing the string via
+ * class_name_free().
+ * @return An error code.
+ */
+static plcrash_error_t class_name_init (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *context, pl_vm_address_t address, plcrash_async_macho_string_t *class_name) {
+    plcrash_async_objc_image_sections_t *entry = context->current;
+    if (entry == NULL || !entry->classNameMobjInitialized)
+        return plcrash_async_macho_string_init(class_name, image->task, address);
+
+    size_t idx = class_name_cache_index(address);
+    if (context->classNameCacheKeys[idx] == address)
+        return plcrash_async_macho_string_init_resolved(class_name, &entry->classNameMobj, address, context->classNameCacheLengths[idx]);
+
+    return plcrash_async_macho_string_init_mapped(class_name, &entry->classNameMobj, address);
+}
+
+/**
+ * Free a class name string initialized via class_name_init(), recording its length in the class name cache if the
+ * name was resolved from the current image's mapped __objc_classname section.
+ *
+ * @param context The context.
+ * @param class_name The string to free.
+ */
+static void class_name_free (plcrash_async_objc_cache_t *context, plcrash_async_macho_string_t *class_name) {
+    pl_vm_size_t length;
+    if (plcrash_async_macho_string_get_resolved_length(class_name, &length) && length <= UINT32_MAX) {
+        size_t idx = class_name_cache_index(class_name->address);
+        context->classNameCacheKeys[idx] = class_name->address;
+        context->classNameCacheLengths[idx] = (uint32_t) length;
+    }
+
+    plcrash_async_macho_string_free(class_name);
+}
+
 static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, struct pl_objc1_class *cls, bool isMetaClass, plcrash_async_objc_found_method_cb callback, void *ctx) {
     plcrash_error_t err;
     
@@ -632,6 +901,7 @@ cleanup:
  * @param method_list_addr The address of the method list data.
  * @param callback The callback to be invoked for each method found.
  * @param ctx A context pointer to pass to the callback.
+ * @param[out] bounds If non-NULL, on success, will be set to the range of IMPs found within the method list.
  * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error on failure.
  */
 static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_macho_t *image,
@@ -640,13 +910,16 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
                                                               bool is_meta_class,
                                                               pl_vm_address_t method_list_addr,
                                                               plcrash_async_objc_found_method_cb callback,
-                                                              void *ctx)
+                                                              void *ctx,
+                                                              plcrash_async_objc_imp_bounds_t *bounds)
 {
+    plcrash_async_objc_imp_bounds_t found = { PL_VM_ADDRESS_MAX, 0 };
+
     PLCF_ASSERT(method_list_addr != 0);
     
     /* Read the method list header. */
     struct pl_objc2_list_header *header;
-    header = (struct pl_objc2_list_header *) plcrash_async_mobject_remap_address(&objc_cache->objcConstMobj, method_list_addr, 0, sizeof(*header));
+    header = (struct pl_objc2_list_header *) plcrash_async_mobject_remap_address(&objc_cache->current->objcConstMobj, method_list_addr, 0, sizeof(*header));
     if (header == NULL) {
         PLCF_DEBUG("plcrash_async_mobject_remap_address in objCConstMobj failed to map methods pointer 0x%llx", (long long) method_list_addr);
         return PLCRASH_EINVALID_DATA;
@@ -660,7 +933,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
     pl_vm_address_t method_list_start = method_list_addr + sizeof(*header);
     pl_vm_size_t method_list_length = (pl_vm_size_t)entsize * count;
     
-    const char *cursor = (const char *) plcrash_async_mobject_remap_address(&objc_cache->objcConstMobj, method_list_start, 0, method_list_length);
+    const char *cursor = (const char *) plcrash_async_mobject_remap_address(&objc_cache->current->objcConstMobj, method_list_start, 0, method_list_length);
     if (cursor == NULL) {
         PLCF_DEBUG("plcrash_async_mobject_remap_address at 0x%llx length %llu returned NULL", (long long)method_list_start, (unsigned long long)method_list_length);
         return PLCRASH_EINVALID_DATA;
@@ -682,8 +955,8 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
         
         /* Read the method name. */
         plcrash_async_macho_string_t method_name;
-        if ((err = plcrash_async_macho_string_init(&method_name, image->task, methodNamePtr)) != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)methodNamePtr, err);
+        if ((err = method_name_init(image, objc_cache, methodNamePtr, &method_name)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("method_name_init at 0x%llx error %d", (long long)methodNamePtr, err);
             return err;
         }
     
@@ -695,6 +968,11 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
         /* Call the callback. */
         callback(is_meta_class, class_name, &method_name, imp, ctx);
 
+        if (imp < found.min)
+            found.min = imp;
+        if (imp > found.max)
+            found.max = imp;
+
         /* Clean up the method name. */
         plcrash_async_macho_string_free(&method_name);
         
@@ -702,6 +980,9 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
         cursor += entsize;
     }
 
+    if (bounds != NULL)
+        *bounds = found;
+
     return PLCRASH_ESUCCESS;
 }
 
@@ -712,9 +993,11 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
  * @param objc_cache The Objective-C cache object.
  * @param cls A pointer to the class structure to be parsed
  * @param[out] class_name On success, will be initialized with the class name. It is the caller's responsibility to free
- * the returned value via plcrash_async_macho_string_free(). If the function returns an error, no class_name value
+ * the returned value via class_name_free(). If the function returns an error, no class_name value
  * will be provided and the caller is not responsible for freeing any associated resources.
  * @param[out] cls_data_ro A buffer to which the class_ro data will be written. Must be at least sizeof(class_ro_t).
+ * @param[out] bounds If non-NULL, on success, will be set to the class's IMP bounds within the class cache, or NULL if
+ * the class could not be cached. The pointer is invalidated by any subsequent modification of the class cache.
  *
  * @tparam class_t The class type, one of pl_objc2_class_32 or pl_objc2_class_64.
  * @tparam class_ro_t The read-only class type, one of pl_objc2_class_data_ro_32 or pl_objc2_class_data_ro_64.
@@ -724,7 +1007,10 @@ static plcrash_error_t pl_async_objc_parse_objc2_method_list (plcrash_async_mach
  * the input format is invalid (including failed pointer dereferencing), or another appropriate error.
  */
 template<typename class_t, typename class_ro_t, typename class_rw_t>
-static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objc_cache, class_t *cls, plcrash_async_macho_string_t *class_name, class_ro_t *cls_data_ro) {
+static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objc_cache, class_t *cls, plcrash_async_macho_string_t *class_name, class_ro_t *cls_data_ro,
+                                                        plcrash_async_objc_imp_bounds_t **bounds)
+{
+    plcrash_async_objc_imp_bounds_t *cached_bounds;
     plcrash_error_t err;
     
     /* Grab the class's data_rw pointer. This needs masking because it also
@@ -733,7 +1019,14 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
     data_ptr &= ~(pl_vm_address_t)3;
 
     /* Grab the data RO pointer from the cache. If unavailable, we'll fetch the data and populate the class. */
-    pl_vm_address_t cached_data_ro_addr = cache_lookup(objc_cache, data_ptr);
+    pl_vm_address_t cached_data_ro_addr = cache_lookup(objc_cache, data_ptr, &cached_bounds);
+
+    /* If another cache requires our memory, release the class table; it will be repopulated as classes are parsed. */
+    if (plcrash_async_cache_budget_record(objc_cache->budget, objc_cache->budgetID, cached_data_ro_addr != 0)) {
+        cache_discard(objc_cache);
+        cached_bounds = NULL;
+    }
+
     if (cached_data_ro_addr == 0) {
         class_rw_t cls_data_rw;
         
@@ -763,7 +1056,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
                 return PLCRASH_EINVALID_DATA;
             }
         } else {
-            void *ptr = plcrash_async_mobject_remap_address(&objc_cache->objcConstMobj, cached_data_ro_addr, 0, sizeof(*cls_data_ro));
+            void *ptr = plcrash_async_mobject_remap_address(&objc_cache->current->objcConstMobj, cached_data_ro_addr, 0, sizeof(*cls_data_ro));
             if (ptr == NULL) {
                 PLCF_DEBUG("plcrash_async_mobject_remap_address at 0x%llx returned NULL", (long long)cached_data_ro_addr);
                 return PLCRASH_EINVALID_DATA;
@@ -773,13 +1066,13 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
         }
         
         /* Add a new cache entry. */
-        cache_set(objc_cache, data_ptr, cached_data_ro_addr);
+        cached_bounds = cache_set(objc_cache, data_ptr, cached_data_ro_addr);
     } else {
         void *ptr;
         
         /* We know that the address is valid (it wouldn't be in the cache otherwise). We try the cheaper memory mapping first,
          * and then fall back to a memory copy. */
-        if ((ptr = plcrash_async_mobject_remap_address(&objc_cache->objcConstMobj, cached_data_ro_addr, 0, sizeof(*cls_data_ro))) != NULL) {
+        if ((ptr = plcrash_async_mobject_remap_address(&objc_cache->current->objcConstMobj, cached_data_ro_addr, 0, sizeof(*cls_data_ro))) != NULL) {
             plcrash_async_memcpy(cls_data_ro, ptr, sizeof(*cls_data_ro));
         } else if (plcrash_async_task_memcpy(image->task, cached_data_ro_addr, 0, cls_data_ro, sizeof(*cls_data_ro)) == PLCRASH_ESUCCESS) {
             /* Do nothing -- success! */
@@ -791,12 +1084,15 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
     
     /* Fetch the pointer to the class name, and make the string. */
     pl_vm_address_t class_name_ptr = image->byteorder->swap(cls_data_ro->name);
-    err = plcrash_async_macho_string_init(class_name, image->task, class_name_ptr);
+    err = class_name_init(image, objc_cache, class_name_ptr, class_name);
     if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)class_name_ptr, err);
+        PLCF_DEBUG("class_name_init at 0x%llx error %d", (long long)class_name_ptr, err);
         return PLCRASH_EINVALID_DATA;
     }
 
+    if (bounds != NULL)
+        *bounds = cached_bounds;
+
     return err;
 }
 
@@ -808,6 +1104,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
  * @param cls A pointer to the class structure to be parsed
  * @param is_meta_class true if this is a metaclass.
  * @param callback The callback to invoke for each method found.
+ * @param filter If non-NULL, a callback used to skip classes whose recorded IMP bounds are of no interest.
  * @param ctx A context pointer to pass to the callback.
  *
  * @tparam class_t The class type, one of pl_objc2_class_32 or pl_objc2_class_64.
@@ -817,26 +1114,34 @@ static plcrash_error_t pl_async_objc_parse_objc2_class (plcrash_async_macho_t *i
  * @return An error code.
  */
 template<typename class_t, typename class_ro_t, typename class_rw_t>
-static plcrash_error_t pl_async_objc_parse_objc2_class_methods (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objc_cache, class_t *cls, bool is_meta_class, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static plcrash_error_t pl_async_objc_parse_objc2_class_methods (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objc_cache, class_t *cls, bool is_meta_class,
+                                                                plcrash_async_objc_found_method_cb callback, pl_async_objc_imp_range_cb filter, void *ctx)
+{
     plcrash_async_macho_string_t class_name;
+    plcrash_async_objc_imp_bounds_t *bounds;
     class_ro_t cls_data_ro;
     plcrash_error_t err;
     
     /* Parse the class */
-    if ((err = pl_async_objc_parse_objc2_class<class_t, class_ro_t, class_rw_t>(image, objc_cache, cls, &class_name, &cls_data_ro)) != PLCRASH_ESUCCESS)
+    if ((err = pl_async_objc_parse_objc2_class<class_t, class_ro_t, class_rw_t>(image, objc_cache, cls, &class_name, &cls_data_ro, &bounds)) != PLCRASH_ESUCCESS)
         return err;
 
     /* Fetch and parse the method list. */
     pl_vm_address_t methods_ptr = image->byteorder->swap(cls_data_ro.baseMethods);
-    if (methods_ptr != 0) {
-        err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, is_meta_class, methods_ptr, callback, ctx);
+    if (methods_ptr != 0 && filter != NULL && bounds != NULL && bounds->min <= bounds->max && !filter(bounds->min, bounds->max, ctx)) {
+        /* None of the class's methods can be of interest */
+        err = PLCRASH_ESUCCESS;
+    } else if (methods_ptr != 0) {
+        /* Record the method list's bounds for use by later parses. The class cache is not modified while the method
+         * list is parsed, and the bounds pointer remains valid. */
+        err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, is_meta_class, methods_ptr, callback, ctx, bounds);
     } else {
         /* The base method list will be NULL if no methods are defined for the class/metaclass; in that case, we simply skip the class. */
         err = PLCRASH_ESUCCESS;
     }
 
     /* Clean up */
-    plcrash_async_macho_string_free(&class_name);
+    class_name_free(objc_cache, &class_name);
     return err;
 }
 
@@ -866,7 +1171,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_category_methods (plcrash_async
     /* Grab the class reference and parse the class. We try to simply remap the pointer, but if that fails, we perform a more
      * expensive read. */
     pl_vm_address_t ptr = image->byteorder->swap(category->cls);
-    class_t *classPtr = (class_t *) plcrash_async_mobject_remap_address(&objc_cache->objcDataMobj, ptr, 0, sizeof(*classPtr));
+    class_t *classPtr = (class_t *) plcrash_async_mobject_remap_address(&objc_cache->current->objcDataMobj, ptr, 0, sizeof(*classPtr));
     class_t class_data;
 
     if (classPtr == NULL) {
@@ -878,19 +1183,19 @@ static plcrash_error_t pl_async_objc_parse_objc2_category_methods (plcrash_async
         classPtr = &class_data;
     }
     
-    if ((err = pl_async_objc_parse_objc2_class<class_t, class_ro_t, class_rw_t>(image, objc_cache, classPtr, &class_name, &cls_data_ro)) != PLCRASH_ESUCCESS)
+    if ((err = pl_async_objc_parse_objc2_class<class_t, class_ro_t, class_rw_t>(image, objc_cache, classPtr, &class_name, &cls_data_ro, NULL)) != PLCRASH_ESUCCESS)
         return err;
     
     /* Fetch and parse the instance and class method lists. The method list will be NULL if no methods are defined for the category; in that case, we simply skip the category. */
     pl_vm_address_t methods_ptr = image->byteorder->swap(category->instanceMethods);
     if (methods_ptr != 0) {
-        if ((err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, false, methods_ptr, callback, ctx)) != PLCRASH_ESUCCESS)
+        if ((err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, false, methods_ptr, callback, ctx, NULL)) != PLCRASH_ESUCCESS)
             goto cleanup;
     }
     
     methods_ptr = image->byteorder->swap(category->classMethods);
     if (methods_ptr != 0) {
-        if ((err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, true, methods_ptr, callback, ctx)) != PLCRASH_ESUCCESS)
+        if ((err = pl_async_objc_parse_objc2_method_list(image, objc_cache, &class_name, true, methods_ptr, callback, ctx, NULL)) != PLCRASH_ESUCCESS)
             goto cleanup;
     }
     
@@ -898,7 +1203,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_category_methods (plcrash_async
 
 cleanup:
     /* Clean up */
-    plcrash_async_macho_string_free(&class_name);
+    class_name_free(objc_cache, &class_name);
     return err;
 }
 
@@ -908,6 +1213,7 @@ cleanup:
  * @param image The Mach-O image to parse.
  * @param objcContext An ObjC context object.
  * @param callback The callback to invoke for each method found.
+ * @param filter If non-NULL, a callback used to skip classes whose recorded IMP bounds are of no interest.
  * @param ctx A context pointer to pass to the callback.
  * @return PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no ObjC2 data exists in the image, and another error code if a different error occurred.
  *
@@ -918,7 +1224,7 @@ cleanup:
  * @tparam machine_ptr_t The target's pointer type (eg, uint64_t).
  */
 template<typename class_t, typename class_ro_t, typename class_rw_t, typename category_t, typename machine_ptr_t>
-static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, plcrash_async_objc_found_method_cb callback, pl_async_objc_imp_range_cb filter, void *ctx) {
     plcrash_error_t err;
     
     /* Map memory objects. */
@@ -930,29 +1236,33 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
         return err;
     }
     
+    /* Pre-size the class cache from this image's class count; entries for additional images will grow the
+     * cache as they're inserted. */
+    cache_reserve(objcContext, objcContext->current->classMobj.length / sizeof(machine_ptr_t));
+
     /* Get a pointer out of the mapped class list. */
-    machine_ptr_t *classPtrs = (machine_ptr_t *) plcrash_async_mobject_remap_address(&objcContext->classMobj, objcContext->classMobj.task_address, 0, objcContext->classMobj.length);
+    machine_ptr_t *classPtrs = (machine_ptr_t *) plcrash_async_mobject_remap_address(&objcContext->current->classMobj, objcContext->current->classMobj.task_address, 0, objcContext->current->classMobj.length);
     if (classPtrs == NULL) {
-        PLCF_DEBUG("plcrash_async_mobject_remap_address in objcConstMobj for pointer %llx returned NULL", (long long)objcContext->classMobj.address);
+        PLCF_DEBUG("plcrash_async_mobject_remap_address in objcConstMobj for pointer %llx returned NULL", (long long)objcContext->current->classMobj.address);
         return PLCRASH_EINVALID_DATA;
     }
     
     /* Figure out how many classes are in the class list based on its length and
      * the size of a pointer in the image. */
-    unsigned classCount = objcContext->classMobj.length / sizeof(machine_ptr_t);
+    unsigned classCount = objcContext->current->classMobj.length / sizeof(machine_ptr_t);
     
     /* Iterate over all classes. */
     for(unsigned i = 0; i < classCount; i++) {
         /* Read the class structure */
         pl_vm_address_t ptr = classPtrs[i];
-        class_t *classPtr = (class_t *) plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, ptr, 0, sizeof(*classPtr));
+        class_t *classPtr = (class_t *) plcrash_async_mobject_remap_address(&objcContext->current->objcDataMobj, ptr, 0, sizeof(*classPtr));
         if (classPtr == NULL) {
             PLCF_DEBUG("plcrash_async_mobject_remap_address in objcDataMobj for pointer %llx returned NULL", (long long)ptr);
             return PLCRASH_EINVALID_DATA;
         }
         
         /* Parse the class. */
-        err = pl_async_objc_parse_objc2_class_methods<class_t, class_ro_t, class_rw_t>(image, objcContext, classPtr, false, callback, ctx);
+        err = pl_async_objc_parse_objc2_class_methods<class_t, class_ro_t, class_rw_t>(image, objcContext, classPtr, false, callback, filter, ctx);
         if (err != PLCRASH_ESUCCESS) {
             /* Skip unrealized classes; they'll never appear in a live backtrace. */
             if (err == PLCRASH_ENOTFOUND)
@@ -964,14 +1274,14 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
         
         /* Read an architecture-appropriate class structure for the metaclass. */
         pl_vm_address_t isa = TAGGED_ISA(image, image->byteorder->swap(classPtr->isa));
-        class_t *metaclass = (class_t *) plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, isa, 0, sizeof(*metaclass));
+        class_t *metaclass = (class_t *) plcrash_async_mobject_remap_address(&objcContext->current->objcDataMobj, isa, 0, sizeof(*metaclass));
         if (metaclass == NULL) {
             PLCF_DEBUG("plcrash_async_mobject_remap_address in objcDataMobj for pointer %llx returned NULL", (long long)isa);
             return PLCRASH_EINVALID_DATA;
         }
 
         /* Parse the metaclass. */
-        err = pl_async_objc_parse_objc2_class_methods<class_t, class_ro_t, class_rw_t>(image, objcContext, metaclass, true, callback, ctx);
+        err = pl_async_objc_parse_objc2_class_methods<class_t, class_ro_t, class_rw_t>(image, objcContext, metaclass, true, callback, filter, ctx);
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("pl_async_objc_parse_objc2_class error %d while parsing metaclass", err);
             return err;
@@ -979,14 +1289,14 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
     }
     
     /* Get a pointer out of the mapped category list. */
-    machine_ptr_t *catPtrs = (machine_ptr_t *) plcrash_async_mobject_remap_address(&objcContext->catMobj, objcContext->catMobj.task_address, 0, objcContext->catMobj.length);
+    machine_ptr_t *catPtrs = (machine_ptr_t *) plcrash_async_mobject_remap_address(&objcContext->current->catMobj, objcContext->current->catMobj.task_address, 0, objcContext->current->catMobj.length);
     if (catPtrs == NULL) {
-        PLCF_DEBUG("plcrash_async_mobject_remap_address in catMobj for pointer %llx returned NULL", (long long)objcContext->catMobj.address);
+        PLCF_DEBUG("plcrash_async_mobject_remap_address in catMobj for pointer %llx returned NULL", (long long)objcContext->current->catMobj.address);
         return PLCRASH_EINVALID_DATA;
     }
     
     /* Figure out how many categories are in the category list based on its length and the size of a pointer in the image. */
-    unsigned catCount = objcContext->catMobj.length / sizeof(*catPtrs);
+    unsigned catCount = objcContext->current->catMobj.length / sizeof(*catPtrs);
     
     /* Iterate over all classes. */
     for(unsigned i = 0; i < catCount; i++) {
@@ -995,7 +1305,7 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
         
         /* Read the category structure. */
         category_t *category;
-        category = (category_t *) plcrash_async_mobject_remap_address(&objcContext->objcConstMobj, ptr, 0, sizeof(*category));
+        category = (category_t *) plcrash_async_mobject_remap_address(&objcContext->current->objcConstMobj, ptr, 0, sizeof(*category));
         if (category == NULL) {
             PLCF_DEBUG("plcrash_async_mobject_remap_address in objcDataMobj for pointer %llx returned NULL", (long long)ptr);
             return PLCRASH_EINVALID_DATA;
@@ -1057,14 +1367,32 @@ bool plcrash_async_objc_supports_nonptr_isa (cpu_type_t type) {
  */
 plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *cache) {
     cache->gotObjC2Info = false;
-    cache->lastImage = NULL;
-    cache->objcConstMobjInitialized = false;
-    cache->classMobjInitialized = false;
-    cache->catMobjInitialized = false;
-    cache->objcDataMobjInitialized = false;
+    cache->useCounter = 0;
+    cache->current = NULL;
+    for (size_t set = 0; set < PLCRASH_ASYNC_OBJC_CACHE_SETS; set++) {
+        for (size_t way = 0; way < PLCRASH_ASYNC_OBJC_CACHE_WAYS; way++) {
+            plcrash_async_objc_image_sections_t *entry = &cache->sections[set][way];
+            entry->image = NULL;
+            entry->mapResult = PLCRASH_ENOTFOUND;
+            entry->lastUsed = 0;
+            entry->objcConstMobjInitialized = false;
+            entry->classMobjInitialized = false;
+            entry->catMobjInitialized = false;
+            entry->objcDataMobjInitialized = false;
+            entry->classNameMobjInitialized = false;
+            entry->methNameMobjInitialized = false;
+        }
+    }
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_CLASS_NAME_CACHE_SIZE; i++)
+        cache->classNameCacheKeys[i] = 0;
     cache->classCacheSize = 0;
+    cache->classCacheCount = 0;
+    cache->classCacheMaxSize = PLCRASH_ASYNC_OBJC_CLASS_CACHE_DEFAULT_MAX_SIZE;
     cache->classCacheKeys = NULL;
     cache->classCacheValues = NULL;
+    cache->classCacheBounds = NULL;
+    cache->budget = NULL;
+    cache->budgetID = PLCRASH_ASYNC_CACHE_ID_INVALID;
     return PLCRASH_ESUCCESS;
 }
 
@@ -1074,10 +1402,121 @@ plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *cache
  * @param cache A pointer to the cache object to free.
  */
 void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *cache) {
-    free_mapped_sections(cache);
+    for (size_t set = 0; set < PLCRASH_ASYNC_OBJC_CACHE_SETS; set++) {
+        for (size_t way = 0; way < PLCRASH_ASYNC_OBJC_CACHE_WAYS; way++)
+            free_mapped_sections(&cache->sections[set][way]);
+    }
+    cache->current = NULL;
+
+    cache_discard(cache);
+
+    if (cache->budget != NULL)
+        plcrash_async_cache_budget_unregister(cache->budget, cache->budgetID);
+}
+
+/**
+ * Set the maximum number of entries to which @a cache's class cache may grow. The class cache is sized from
+ * the __objc_classlist counts of the images parsed, and will not grow beyond this limit. If the cache has already
+ * grown beyond @a capacity, the existing table will be retained, but will not grow further.
+ *
+ * @param cache The cache to configure.
+ * @param capacity The maximum number of entries. This will be rounded down to a power of two, and will not be
+ * set lower than PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE.
+ */
+void plcrash_async_objc_cache_set_max_class_capacity (plcrash_async_objc_cache_t *cache, size_t capacity) {
+    size_t size = PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE;
+    while (size <= capacity / 2)
+        size <<= 1;
+
+    cache->classCacheMaxSize = size;
+}
+
+/**
+ * Charge the memory retained by @a cache's class cache to @a budget. The class cache is registered as an evictable
+ * cache, capped at the size of a table of the cache's maximum class capacity; if the budget's limit is reached, the
+ * class table may be released and later repopulated.
+ *
+ * @param cache The cache to configure. Any plcrash_async_objc_cache_set_max_class_capacity() call must precede this
+ * call, as the cache's cap is fixed at registration.
+ * @param budget The budget to charge. The budget must outlive @a cache.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be registered with
+ * @a budget. If the existing class table cannot be charged to @a budget, it is released.
+ *
+ * @warning This function is not async-safe, and may only be called once per cache, prior to the cache being used
+ * from a crash handler.
+ */
+plcrash_error_t plcrash_async_objc_cache_set_budget (plcrash_async_objc_cache_t *cache, plcrash_async_cache_budget_t *budget) {
+    PLCF_ASSERT(cache->budget == NULL);
+
+    plcrash_error_t err = plcrash_async_cache_budget_register(budget, "objc_class_cache", cache_allocation_size(cache, cache->classCacheMaxSize), true, &cache->budgetID);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    cache->budget = budget;
+
+    /* Account for any table already allocated */
+    if (cache->classCacheKeys != NULL && plcrash_async_cache_budget_charge(budget, cache->budgetID, cache_allocation_size(cache, cache->classCacheSize)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("The existing class cache exceeds the cache memory budget, and will be released");
+
+        /* Nothing was charged, so the table must be released without releasing a charge */
+        vm_deallocate(mach_task_self(), (vm_address_t) cache->classCacheKeys, cache_allocation_size(cache, cache->classCacheSize));
+        cache->classCacheSize = 0;
+        cache->classCacheCount = 0;
+        cache->classCacheKeys = NULL;
+        cache->classCacheValues = NULL;
+        cache->classCacheBounds = NULL;
+    }
 
-    if (cache->classCacheKeys != NULL)
-        vm_deallocate(mach_task_self(), (vm_address_t)cache->classCacheKeys, cache_allocation_size(cache));
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Pre-size @a cache's class cache to hold at least @a count entries (bounded by the cache's maximum class capacity),
+ * avoiding the need to grow the table from within a crash handler.
+ *
+ * @param cache The cache to configure.
+ * @param count The number of entries for which room should be made.
+ *
+ * @warning This function is not async-safe, and must be called prior to the cache being used from a crash handler.
+ */
+void plcrash_nasync_objc_cache_reserve_classes (plcrash_async_objc_cache_t *cache, size_t count) {
+    cache_reserve(cache, count);
+}
+
+/**
+ * Fault in, and optionally wire, the pages backing @a cache's class cache, avoiding first-touch page faults when the
+ * cache is first used from a crash handler. This should be called after the cache has been sized via
+ * plcrash_nasync_objc_cache_reserve_classes(); if the cache is subsequently grown, the new table will not be
+ * prefaulted.
+ *
+ * @param cache The cache to prefault.
+ * @param wire If true, the class cache pages will also be wired via mlock(). The wiring is released when the table
+ * is deallocated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if wiring was requested and mlock() failed.
+ *
+ * @warning This function is not async-safe, and must be called prior to the cache being used from a crash handler.
+ */
+plcrash_error_t plcrash_nasync_objc_cache_prefault (plcrash_async_objc_cache_t *cache, bool wire) {
+    if (cache->classCacheKeys == NULL)
+        return PLCRASH_ESUCCESS;
+
+    vm_address_t start = (vm_address_t) cache->classCacheKeys;
+    vm_size_t size = round_page(cache_allocation_size(cache, cache->classCacheSize));
+
+    /* The table is zero-filled by vm_allocate(); a read-write of the existing value leaves any cached entries intact. */
+    for (vm_address_t page = start; page < start + size; page += PAGE_SIZE) {
+        volatile uint8_t *p = (volatile uint8_t *) page;
+        *p = *p;
+    }
+
+    if (wire && mlock((void *) start, size) != 0) {
+        PLCF_DEBUG("mlock() of the class cache failed: %d", errno);
+        return PLCRASH_ENOMEM;
+    }
+
+    return PLCRASH_ESUCCESS;
 }
 
 /**
@@ -1090,10 +1529,12 @@ void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *cache) {
  * @param image The image to read class data from.
  * @param cache An ObjC context object.
  * @param callback The callback to invoke for each method.
- * @param ctx The context pointer to pass to the callback.
+ * @param filter If non-NULL, a callback used to skip ObjC2 classes whose IMP bounds -- as recorded by an earlier parse
+ * using @a cache -- are of no interest. Classes for which no bounds have been recorded are always visited.
+ * @param ctx The context pointer to pass to the callbacks.
  * @return An error code.
  */
-static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, plcrash_async_objc_found_method_cb callback, pl_async_objc_imp_range_cb filter, void *ctx) {
     plcrash_error_t err;
     
     if (cache == NULL)
@@ -1110,9 +1551,9 @@ static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, p
     /* If there wasn't any, try ObjC2 data. */
     if (err == PLCRASH_ENOTFOUND) {
         if (image->m64)
-            err = pl_async_objc_parse_from_data_section<pl_objc2_class_64, pl_objc2_class_data_ro_64, pl_objc2_class_data_rw_64, pl_objc2_category_64, uint64_t>(image, cache, callback, ctx);
+            err = pl_async_objc_parse_from_data_section<pl_objc2_class_64, pl_objc2_class_data_ro_64, pl_objc2_class_data_rw_64, pl_objc2_category_64, uint64_t>(image, cache, callback, filter, ctx);
         else
-            err = pl_async_objc_parse_from_data_section<pl_objc2_class_32, pl_objc2_class_data_ro_32, pl_objc2_class_data_rw_32, pl_objc2_category_32, uint32_t>(image, cache, callback, ctx);
+            err = pl_async_objc_parse_from_data_section<pl_objc2_class_32, pl_objc2_class_data_ro_32, pl_objc2_class_data_rw_32, pl_objc2_category_32, uint32_t>(image, cache, callback, filter, ctx);
 
         if (err == PLCRASH_ESUCCESS) {
             /* ObjC2 info successfully obtained, note that so we can stop trying ObjC1 next time around. */
@@ -1123,6 +1564,240 @@ static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, p
     return err;
 }
 
+/**
+ * @internal
+ * Context for pl_async_objc_method_index_collect_callback.
+ */
+struct pl_async_objc_method_index_collect_context {
+    /** If non-NULL, the destination for collected entries. Must have room for all methods in the image. */
+    plcrash_async_objc_method_index_entry_t *entries;
+
+    /** The number of entries available in entries, or 0 if entries is NULL. */
+    uint32_t capacity;
+
+    /** The number of methods visited. */
+    uint32_t count;
+};
+
+/**
+ * @internal
+ * Callback used to count, and optionally record, all methods visited by the ObjC parser.
+ */
+static void pl_async_objc_method_index_collect_callback (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+    struct pl_async_objc_method_index_collect_context *ctxStruct = (struct pl_async_objc_method_index_collect_context *) ctx;
+
+    if (ctxStruct->entries != NULL) {
+        /* The image may not change between passes, but we refuse to overrun the buffer regardless */
+        if (ctxStruct->count >= ctxStruct->capacity)
+            return;
+
+        plcrash_async_objc_method_index_entry_t *entry = &ctxStruct->entries[ctxStruct->count];
+        entry->imp = imp;
+        entry->class_name = className->address;
+        entry->method_name = methodName->address;
+        entry->scan_order = ctxStruct->count;
+        entry->is_class_method = isClassMethod;
+    }
+
+    ctxStruct->count++;
+}
+
+/**
+ * @internal
+ * qsort() comparison function for plcrash_async_objc_method_index_entry_t values. Entries are sorted by ascending
+ * IMP; entries sharing an IMP are sorted by descending scan order, placing the entry that the parser would have
+ * reported last within its run.
+ */
+static int pl_async_objc_method_index_compare (const void *a, const void *b) {
+    const plcrash_async_objc_method_index_entry_t *lhs = (const plcrash_async_objc_method_index_entry_t *) a;
+    const plcrash_async_objc_method_index_entry_t *rhs = (const plcrash_async_objc_method_index_entry_t *) b;
+
+    if (lhs->imp < rhs->imp)
+        return -1;
+    else if (lhs->imp > rhs->imp)
+        return 1;
+
+    if (lhs->scan_order > rhs->scan_order)
+        return -1;
+    else if (lhs->scan_order < rhs->scan_order)
+        return 1;
+
+    return 0;
+}
+
+/**
+ * Build an IMP-sorted Objective-C method index for @a image, allowing plcrash_async_objc_find_method() to perform
+ * a binary search rather than parsing all class and category metadata in the image. The index is allocated from the
+ * image's backing allocator, and will be freed by plcrash_async_macho_free().
+ *
+ * If an index has already been built for @a image, this function has no effect. If the image contains no ObjC
+ * methods, no index will be built, and lookups will continue to parse the image's ObjC metadata.
+ *
+ * @param image The image for which a method index should be built.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or one of the plcrash_error_t error values on failure. On failure,
+ * lookups will continue to parse the image's ObjC metadata.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with itself for the same @a image. It
+ * may be called concurrently with crash-time lookups; the index is only published once it has been fully populated.
+ */
+plcrash_error_t plcrash_nasync_objc_build_method_index (plcrash_async_macho_t *image) {
+    plcrash_async_objc_cache_t cache;
+    plcrash_async_objc_method_index_entry_t *entries;
+    struct pl_async_objc_method_index_collect_context collectCtx = { NULL, 0, 0 };
+    plcrash_error_t err;
+
+    if (image->objc_method_index != NULL)
+        return PLCRASH_ESUCCESS;
+
+    if ((err = plcrash_async_objc_cache_init(&cache)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Count the methods */
+    err = plcrash_async_objc_parse(image, &cache, pl_async_objc_method_index_collect_callback, NULL, &collectCtx);
+    if (err != PLCRASH_ESUCCESS) {
+        /* An image without ObjC data simply has nothing to index */
+        if (err == PLCRASH_ENOTFOUND)
+            err = PLCRASH_ESUCCESS;
+        goto cleanup;
+    }
+
+    if (collectCtx.count == 0)
+        goto cleanup;
+
+    /* Populate and sort the index */
+    err = plcrash_async_allocator_alloc(image->_allocator, (void **) &entries, sizeof(entries[0]) * collectCtx.count);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to allocate an ObjC method index of %u entries for %s", (unsigned int) collectCtx.count, image->name);
+        goto cleanup;
+    }
+
+    collectCtx.entries = entries;
+    collectCtx.capacity = collectCtx.count;
+    collectCtx.count = 0;
+
+    err = plcrash_async_objc_parse(image, &cache, pl_async_objc_method_index_collect_callback, NULL, &collectCtx);
+    if (err != PLCRASH_ESUCCESS || collectCtx.count != collectCtx.capacity) {
+        PLCF_DEBUG("ObjC method index population for %s failed: %d", image->name, err);
+        plcrash_async_allocator_dealloc(image->_allocator, entries);
+        if (err == PLCRASH_ESUCCESS)
+            err = PLCRASH_EINTERNAL;
+        goto cleanup;
+    }
+
+    qsort(entries, collectCtx.count, sizeof(entries[0]), pl_async_objc_method_index_compare);
+
+    /* Publish the index; the count must be visible before the index pointer */
+    image->objc_method_index_count = collectCtx.count;
+    OSMemoryBarrier();
+    image->objc_method_index = entries;
+
+    // fall through to cleanup
+    err = PLCRASH_ESUCCESS;
+
+cleanup:
+    plcrash_async_objc_cache_free(&cache);
+    return err;
+}
+
+/**
+ * @internal
+ * Use @a image's method index to locate the method that best matches @a imp. The result is identical to that
+ * produced by parsing the image's ObjC metadata.
+ *
+ * @param image The image to search.
+ * @param cache An ObjC context object, or NULL. See plcrash_async_objc_report_method().
+ * @param entries The image's method index.
+ * @param imp The address to search for.
+ * @return Returns the best matching index entry, or NULL if no method matches @a imp.
+ */
+static const plcrash_async_objc_method_index_entry_t *pl_async_objc_search_method_index (plcrash_async_macho_t *image, const plcrash_async_objc_method_index_entry_t *entries, pl_vm_address_t imp) {
+    /* Find the first entry with an IMP greater than imp; our match (if any) immediately precedes it. */
+    uint32_t low = 0;
+    uint32_t high = image->objc_method_index_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (entries[mid].imp <= imp)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    /* The parser never reports a zero IMP as a match */
+    if (low == 0 || entries[low - 1].imp == 0)
+        return NULL;
+
+    return &entries[low - 1];
+}
+
+/**
+ * Report a method located via plcrash_async_objc_find_methods() (or a method index entry) to @a callback, fetching
+ * the method's class and selector names from @a image's task.
+ *
+ * @param image The image containing @a method.
+ * @param cache An ObjC context object, or NULL. If non-NULL, the names are read from @a image's mapped name sections,
+ * and resolved class names are cached.
+ * @param method The method to report.
+ * @param callback The callback to invoke with the method.
+ * @param ctx The context pointer to pass to the callback.
+ * @return An error code.
+ */
+plcrash_error_t plcrash_async_objc_report_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, const plcrash_async_objc_method_index_entry_t *method, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    plcrash_async_macho_string_t className;
+    plcrash_async_macho_string_t methodName;
+    plcrash_error_t err;
+
+    /* Read the names from the image's mapped name sections, if available; otherwise, each name is mapped individually. */
+    if (cache != NULL && map_sections(image, cache) == PLCRASH_ESUCCESS) {
+        class_name_init(image, cache, method->class_name, &className);
+        method_name_init(image, cache, method->method_name, &methodName);
+
+        if (callback != NULL)
+            callback(method->is_class_method, &className, &methodName, method->imp, ctx);
+
+        plcrash_async_macho_string_free(&methodName);
+        class_name_free(cache, &className);
+        return PLCRASH_ESUCCESS;
+    }
+
+    if ((err = plcrash_async_macho_string_init(&className, image->task, method->class_name)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long) method->class_name, err);
+        return err;
+    }
+
+    if ((err = plcrash_async_macho_string_init(&methodName, image->task, method->method_name)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long) method->method_name, err);
+        plcrash_async_macho_string_free(&className);
+        return err;
+    }
+
+    if (callback != NULL)
+        callback(method->is_class_method, &className, &methodName, method->imp, ctx);
+
+    plcrash_async_macho_string_free(&methodName);
+    plcrash_async_macho_string_free(&className);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ * Use @a image's method index to locate the method that best matches @a imp, and report it to @a callback.
+ *
+ * @param image The image to search.
+ * @param entries The image's method index.
+ * @param imp The address to search for.
+ * @param callback The callback to invoke when the best match is found.
+ * @param ctx The context pointer to pass to the callback.
+ * @return An error code.
+ */
+static plcrash_error_t pl_async_objc_find_indexed_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, const plcrash_async_objc_method_index_entry_t *entries, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    const plcrash_async_objc_method_index_entry_t *entry = pl_async_objc_search_method_index(image, entries, imp);
+    if (entry == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    return plcrash_async_objc_report_method(image, cache, entry, callback, ctx);
+}
+
 struct pl_async_objc_find_method_search_context {
     pl_vm_address_t searchIMP;
     pl_vm_address_t bestIMP;
@@ -1149,6 +1824,16 @@ static void pl_async_objc_find_method_search_callback (bool isClassMethod, plcra
     }
 }
 
+/**
+ * Filter used to skip classes that cannot contain a better match than the current bestIMP of a
+ * pl_async_objc_find_method_search_context.
+ */
+static bool pl_async_objc_find_method_search_filter (pl_vm_address_t min, pl_vm_address_t max, void *ctx) {
+    struct pl_async_objc_find_method_search_context *ctxStruct = (struct pl_async_objc_find_method_search_context *) ctx;
+
+    return min <= ctxStruct->searchIMP && max >= ctxStruct->bestIMP;
+}
+
 /**
  * Callback used to find the method that precisely matches a search target.
  * The context pointer is a pointer to pl_async_objc_find_method_call_context.
@@ -1165,9 +1850,22 @@ static void pl_async_objc_find_method_call_callback (bool isClassMethod, plcrash
     }
 }
 
+/**
+ * Filter used to skip classes that cannot contain the searchIMP of a pl_async_objc_find_method_call_context, or all
+ * classes once the match has been reported.
+ */
+static bool pl_async_objc_find_method_call_filter (pl_vm_address_t min, pl_vm_address_t max, void *ctx) {
+    struct pl_async_objc_find_method_call_context *ctxStruct = (struct pl_async_objc_find_method_call_context *) ctx;
+
+    return ctxStruct->outerCallback != NULL && min <= ctxStruct->searchIMP && ctxStruct->searchIMP <= max;
+}
+
 /**
  * Search for the method that best matches the given code address.
  *
+ * If a method index has been built for @a image via plcrash_nasync_objc_build_method_index(), the index will be
+ * searched; otherwise, the image's ObjC metadata will be parsed.
+ *
  * @param image The image to search.
  * @param objcContext A pointer to an ObjC context object. Must not be NULL, and must (obviously) be initialized.
  * @param imp The address to search for.
@@ -1176,11 +1874,18 @@ static void pl_async_objc_find_method_call_callback (bool isClassMethod, plcrash
  * @return An error code.
  */
 plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    /* Prefer the method index, if one has been published */
+    const plcrash_async_objc_method_index_entry_t *index = image->objc_method_index;
+    if (index != NULL) {
+        OSMemoryBarrier();
+        return pl_async_objc_find_indexed_method(image, objcContext, index, imp, callback, ctx);
+    }
+
     struct pl_async_objc_find_method_search_context searchCtx = {
         .searchIMP = imp
     };
 
-    plcrash_error_t err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_search_callback, &searchCtx);
+    plcrash_error_t err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_search_callback, pl_async_objc_find_method_search_filter, &searchCtx);
     if (err != PLCRASH_ESUCCESS) {
         /* Don't log an error if ObjC data was simply not found */
         if (err != PLCRASH_ENOTFOUND)
@@ -1197,6 +1902,174 @@ plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, pl
         .outerCallbackCtx = ctx
     };
     
-    return plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_call_callback, &callCtx);
+    return plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_call_callback, pl_async_objc_find_method_call_filter, &callCtx);
+}
+
+/**
+ * @internal
+ * Context for pl_async_objc_find_methods_callback.
+ */
+struct pl_async_objc_find_methods_context {
+    /** The IMPs to be matched, sorted in ascending order. */
+    const pl_vm_address_t *imps;
+
+    /** The number of entries in imps. Must be non-zero. */
+    uint32_t count;
+
+    /** The per-IMP best matches. */
+    plcrash_async_objc_method_index_entry_t *methods;
+
+    /** The per-IMP match flags. */
+    bool *found;
+
+    /** The number of methods visited. */
+    uint32_t scan_order;
+};
+
+/**
+ * @internal
+ * Callback used to merge each method visited by the ObjC parser into the per-IMP best matches of a batch lookup.
+ * Each method is recorded against the first IMP at or above its address, and is only retained if it is strictly
+ * closer than the method already recorded for that IMP; the matches are propagated to the following IMPs once the
+ * parse has completed.
+ */
+static void pl_async_objc_find_methods_callback (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+    struct pl_async_objc_find_methods_context *ctxStruct = (struct pl_async_objc_find_methods_context *) ctx;
+    uint32_t scan_order = ctxStruct->scan_order++;
+
+    /* The parser never reports a zero IMP as a match */
+    if (imp == 0 || imp > ctxStruct->imps[ctxStruct->count - 1])
+        return;
+
+    /* Find the first IMP at or above the method */
+    uint32_t low = 0;
+    uint32_t high = ctxStruct->count - 1;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (ctxStruct->imps[mid] < imp)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    /* As in plcrash_async_objc_find_method(), the first of several methods sharing an IMP is retained */
+    plcrash_async_objc_method_index_entry_t *method = &ctxStruct->methods[low];
+    if (ctxStruct->found[low] && method->imp >= imp)
+        return;
+
+    method->imp = imp;
+    method->class_name = className->address;
+    method->method_name = methodName->address;
+    method->scan_order = scan_order;
+    method->is_class_method = isClassMethod;
+    ctxStruct->found[low] = true;
 }
 
+/**
+ * @internal
+ * Filter used to skip classes that cannot improve upon any of the per-IMP best matches of a batch lookup. A class's
+ * methods may only be recorded against the IMPs at or above its lowest method, up to the first IMP at or above its
+ * highest method; the class is skipped if, for each of these, the current match is already at least as close as the
+ * closest method the class could contain.
+ */
+static bool pl_async_objc_find_methods_filter (pl_vm_address_t min, pl_vm_address_t max, void *ctx) {
+    struct pl_async_objc_find_methods_context *ctxStruct = (struct pl_async_objc_find_methods_context *) ctx;
+
+    if (min > ctxStruct->imps[ctxStruct->count - 1])
+        return false;
+
+    /* Find the first IMP at or above the lowest method */
+    uint32_t low = 0;
+    uint32_t high = ctxStruct->count - 1;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (ctxStruct->imps[mid] < min)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    for (uint32_t i = low; i < ctxStruct->count; i++) {
+        pl_vm_address_t closest = max < ctxStruct->imps[i] ? max : ctxStruct->imps[i];
+        if (!ctxStruct->found[i] || ctxStruct->methods[i].imp < closest)
+            return true;
+
+        /* Methods above this IMP are recorded against later IMPs */
+        if (ctxStruct->imps[i] >= max)
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * Search for the methods that best match each of the given code addresses, using a single traversal of the image's
+ * class and category method lists, rather than one traversal per address. The results are identical to those produced
+ * by calling plcrash_async_objc_find_method() for each address.
+ *
+ * If a method index has been built for @a image via plcrash_nasync_objc_build_method_index(), the index will be
+ * searched for each address instead.
+ *
+ * @param image The image to search.
+ * @param objcContext A pointer to an ObjC context object. Must not be NULL, and must (obviously) be initialized.
+ * @param imps The addresses to search for, sorted in ascending order.
+ * @param count The number of entries in @a imps.
+ * @param methods On return, the best matching method for each entry of @a imps. Entries for which no method was found
+ * are left undefined. The class and selector names may be fetched via plcrash_async_objc_report_method().
+ * @param found On return, set to true for each entry of @a imps for which a method was found, or false otherwise.
+ * @return Returns PLCRASH_ESUCCESS if a method was found for any address, PLCRASH_ENOTFOUND if no method was found, or
+ * another error if the image's ObjC metadata could not be parsed.
+ */
+plcrash_error_t plcrash_async_objc_find_methods (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, const pl_vm_address_t *imps, uint32_t count, plcrash_async_objc_method_index_entry_t *methods, bool *found) {
+    for (uint32_t i = 0; i < count; i++)
+        found[i] = false;
+
+    if (count == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* Prefer the method index, if one has been published */
+    const plcrash_async_objc_method_index_entry_t *index = image->objc_method_index;
+    if (index != NULL) {
+        OSMemoryBarrier();
+
+        bool anyFound = false;
+        for (uint32_t i = 0; i < count; i++) {
+            const plcrash_async_objc_method_index_entry_t *entry = pl_async_objc_search_method_index(image, index, imps[i]);
+            if (entry != NULL) {
+                methods[i] = *entry;
+                found[i] = true;
+                anyFound = true;
+            }
+        }
+
+        return anyFound ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
+    }
+
+    struct pl_async_objc_find_methods_context findCtx = {
+        .imps = imps,
+        .count = count,
+        .methods = methods,
+        .found = found,
+        .scan_order = 0
+    };
+
+    plcrash_error_t err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_methods_callback, pl_async_objc_find_methods_filter, &findCtx);
+    if (err != PLCRASH_ESUCCESS) {
+        /* Don't log an error if ObjC data was simply not found */
+        if (err != PLCRASH_ENOTFOUND)
+            PLCF_DEBUG("pl_async_objc_parse(%p, %u IMPs) failure %d", image, (unsigned int) count, err);
+        return err;
+    }
+
+    /* A method preceding an IMP also precedes all following IMPs; carry each match forward unless a closer method was
+     * recorded for the following IMP. */
+    for (uint32_t i = 1; i < count; i++) {
+        if (found[i - 1] && (!found[i] || methods[i - 1].imp > methods[i].imp)) {
+            methods[i] = methods[i - 1];
+            found[i] = true;
+        }
+    }
+
+    /* If any IMP matched, the final IMP did as well */
+    return found[count - 1] ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
+}
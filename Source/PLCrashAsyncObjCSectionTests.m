@@ -269,6 +269,320 @@ static void ParseCallbackTrampoline(bool isClassMethod, plcrash_async_macho_stri
     plcrash_async_objc_cache_free(&objCContext);
 }
 
+/**
+ * Verify that lookups against a prebuilt method index produce results identical to parsing.
+ */
+- (void) testMethodIndex {
+    plcrash_async_objc_cache_t objCContext;
+    plcrash_error_t err = plcrash_async_objc_cache_init(&objCContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+
+    PLCrashAsyncObjCSectionTestsSimpleClass *obj = [[[PLCrashAsyncObjCSectionTestsSimpleClass alloc] init] autorelease];
+    pl_vm_address_t pcs[] = {
+        [obj addressInSimpleClass],
+        [self addressInCategory],
+        [[self class] addressInClassMethod],
+        [[[NSThread callStackReturnAddresses] objectAtIndex: 0] unsignedLongLongValue]
+    };
+    size_t pc_count = sizeof(pcs) / sizeof(pcs[0]);
+
+    NSMutableArray *parsed = [NSMutableArray array];
+    NSMutableArray *indexed = [NSMutableArray array];
+    __block NSMutableArray *results = parsed;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            STAssertNULL(_image.objc_method_index, @"Index should not have been built yet");
+            STAssertEquals(plcrash_nasync_objc_build_method_index(&_image), PLCRASH_ESUCCESS, @"Failed to build method index");
+            STAssertNotNULL(_image.objc_method_index, @"No index was built");
+            STAssertTrue(_image.objc_method_index_count > 0, @"Empty index");
+            results = indexed;
+        }
+
+        for (size_t i = 0; i < pc_count; i++) {
+            err = plcrash_async_objc_find_method(&_image, &objCContext, pcs[i], ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+                pl_vm_size_t classNameLength;
+                const char *classNamePtr;
+                pl_vm_size_t methodNameLength;
+                const char *methodNamePtr;
+
+                STAssertEquals(plcrash_async_macho_string_get_length(className, &classNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+                STAssertEquals(plcrash_async_macho_string_get_pointer(className, &classNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+                STAssertEquals(plcrash_async_macho_string_get_length(methodName, &methodNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+                STAssertEquals(plcrash_async_macho_string_get_pointer(methodName, &methodNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+
+                [results addObject: [NSString stringWithFormat: @"%c[%.*s %.*s] %llx", isClassMethod ? '+' : '-',
+                                     (int) classNameLength, classNamePtr, (int) methodNameLength, methodNamePtr, (unsigned long long) imp]];
+            });
+            STAssertEquals(err, PLCRASH_ESUCCESS, @"Method lookup failed");
+        }
+    }
+
+    STAssertEquals([parsed count], (NSUInteger) pc_count, @"Method find callback not called for every lookup");
+    STAssertEqualObjects(parsed, indexed, @"Indexed lookups do not match parsed lookups");
+
+    /* An address preceding all methods must not match */
+    err = plcrash_async_objc_find_method(&_image, &objCContext, _image.objc_method_index[0].imp - 1, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+        STFail(@"Unexpected match");
+    });
+    STAssertEquals(err, PLCRASH_ENOTFOUND, @"Lookup should have failed");
+
+    plcrash_async_objc_cache_free(&objCContext);
+}
+
+/**
+ * Verify that a batch lookup, using a single parse of the image's ObjC metadata, matches individual lookups, both with
+ * and without a method index.
+ */
+- (void) testFindMethods {
+    plcrash_async_objc_cache_t objCContext;
+    plcrash_error_t err = plcrash_async_objc_cache_init(&objCContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+
+    PLCrashAsyncObjCSectionTestsSimpleClass *obj = [[[PLCrashAsyncObjCSectionTestsSimpleClass alloc] init] autorelease];
+    pl_vm_address_t pcs[] = {
+        [obj addressInSimpleClass],
+        [obj addressInSimpleClass],
+        [self addressInCategory],
+        [[self class] addressInClassMethod],
+        [[[NSThread callStackReturnAddresses] objectAtIndex: 0] unsignedLongLongValue]
+    };
+    uint32_t pc_count = sizeof(pcs) / sizeof(pcs[0]);
+
+    /* The batch API requires sorted addresses */
+    for (uint32_t i = 1; i < pc_count; i++) {
+        for (uint32_t j = i; j > 0 && pcs[j - 1] > pcs[j]; j--) {
+            pl_vm_address_t tmp = pcs[j];
+            pcs[j] = pcs[j - 1];
+            pcs[j - 1] = tmp;
+        }
+    }
+
+    __block NSMutableArray *results = nil;
+    void (^describe)(bool, plcrash_async_macho_string_t *, plcrash_async_macho_string_t *, pl_vm_address_t) = ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp) {
+        pl_vm_size_t classNameLength;
+        const char *classNamePtr;
+        pl_vm_size_t methodNameLength;
+        const char *methodNamePtr;
+
+        STAssertEquals(plcrash_async_macho_string_get_length(className, &classNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+        STAssertEquals(plcrash_async_macho_string_get_pointer(className, &classNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+        STAssertEquals(plcrash_async_macho_string_get_length(methodName, &methodNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+        STAssertEquals(plcrash_async_macho_string_get_pointer(methodName, &methodNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+
+        [results addObject: [NSString stringWithFormat: @"%c[%.*s %.*s] %llx", isClassMethod ? '+' : '-',
+                             (int) classNameLength, classNamePtr, (int) methodNameLength, methodNamePtr, (unsigned long long) imp]];
+    };
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1)
+            STAssertEquals(plcrash_nasync_objc_build_method_index(&_image), PLCRASH_ESUCCESS, @"Failed to build method index");
+
+        NSMutableArray *single = [NSMutableArray array];
+        NSMutableArray *batch = [NSMutableArray array];
+
+        results = single;
+        for (uint32_t i = 0; i < pc_count; i++) {
+            err = plcrash_async_objc_find_method(&_image, &objCContext, pcs[i], ParseCallbackTrampoline, describe);
+            STAssertEquals(err, PLCRASH_ESUCCESS, @"Method lookup failed");
+        }
+
+        plcrash_async_objc_method_index_entry_t methods[sizeof(pcs) / sizeof(pcs[0])];
+        bool found[sizeof(pcs) / sizeof(pcs[0])];
+
+        results = batch;
+        err = plcrash_async_objc_find_methods(&_image, &objCContext, pcs, pc_count, methods, found);
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"Batch method lookup failed");
+        for (uint32_t i = 0; i < pc_count; i++) {
+            STAssertTrue(found[i], @"No method found for 0x%llx", (unsigned long long) pcs[i]);
+            if (found[i])
+                STAssertEquals(plcrash_async_objc_report_method(&_image, &objCContext, &methods[i], ParseCallbackTrampoline, describe), PLCRASH_ESUCCESS, @"Failed to report method");
+        }
+
+        STAssertEqualObjects(batch, single, @"Batch lookups do not match individual lookups (pass %d)", pass);
+    }
+
+    plcrash_async_objc_cache_free(&objCContext);
+}
+
+/**
+ * Verify that lookups using a warm cache, which skip classes via their recorded IMP bounds, match lookups performed
+ * with a cold cache.
+ */
+- (void) testClassBoundsPruning {
+    plcrash_async_objc_cache_t warmContext;
+    plcrash_error_t err = plcrash_async_objc_cache_init(&warmContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+
+    PLCrashAsyncObjCSectionTestsSimpleClass *obj = [[[PLCrashAsyncObjCSectionTestsSimpleClass alloc] init] autorelease];
+    pl_vm_address_t pcs[] = {
+        [obj addressInSimpleClass],
+        [self addressInCategory],
+        [[self class] addressInClassMethod],
+        [[[NSThread callStackReturnAddresses] objectAtIndex: 0] unsignedLongLongValue]
+    };
+    uint32_t pc_count = sizeof(pcs) / sizeof(pcs[0]);
+
+    __block NSMutableArray *results = nil;
+    void (^describe)(bool, plcrash_async_macho_string_t *, plcrash_async_macho_string_t *, pl_vm_address_t) = ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp) {
+        pl_vm_size_t classNameLength;
+        const char *classNamePtr;
+        pl_vm_size_t methodNameLength;
+        const char *methodNamePtr;
+
+        STAssertEquals(plcrash_async_macho_string_get_length(className, &classNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+        STAssertEquals(plcrash_async_macho_string_get_pointer(className, &classNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+        STAssertEquals(plcrash_async_macho_string_get_length(methodName, &methodNameLength), PLCRASH_ESUCCESS, @"Failed to get length");
+        STAssertEquals(plcrash_async_macho_string_get_pointer(methodName, &methodNamePtr), PLCRASH_ESUCCESS, @"Failed to get pointer");
+
+        [results addObject: [NSString stringWithFormat: @"%c[%.*s %.*s] %llx", isClassMethod ? '+' : '-',
+                             (int) classNameLength, classNamePtr, (int) methodNameLength, methodNamePtr, (unsigned long long) imp]];
+    };
+
+    /* Look up each address with a cold cache */
+    NSMutableArray *cold = [NSMutableArray array];
+    results = cold;
+    for (uint32_t i = 0; i < pc_count; i++) {
+        plcrash_async_objc_cache_t coldContext;
+        STAssertEquals(plcrash_async_objc_cache_init(&coldContext), PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+        STAssertEquals(plcrash_async_objc_find_method(&_image, &coldContext, pcs[i], ParseCallbackTrampoline, describe), PLCRASH_ESUCCESS, @"Method lookup failed");
+        plcrash_async_objc_cache_free(&coldContext);
+    }
+
+    /* Warm the cache, recording the classes' IMP bounds */
+    results = [NSMutableArray array];
+    for (uint32_t i = 0; i < pc_count; i++)
+        plcrash_async_objc_find_method(&_image, &warmContext, pcs[i], ParseCallbackTrampoline, describe);
+
+    size_t recorded = 0;
+    for (size_t i = 0; i < warmContext.classCacheSize; i++) {
+        if (warmContext.classCacheKeys[i] != 0 && warmContext.classCacheBounds[i].min <= warmContext.classCacheBounds[i].max)
+            recorded++;
+    }
+    STAssertTrue(recorded > 0, @"No class IMP bounds were recorded");
+
+    /* Repeat the lookups with the warm cache */
+    NSMutableArray *warm = [NSMutableArray array];
+    results = warm;
+    for (uint32_t i = 0; i < pc_count; i++)
+        STAssertEquals(plcrash_async_objc_find_method(&_image, &warmContext, pcs[i], ParseCallbackTrampoline, describe), PLCRASH_ESUCCESS, @"Method lookup failed");
+
+    STAssertEqualObjects(warm, cold, @"Pruned lookups do not match unpruned lookups");
+
+    plcrash_async_objc_cache_free(&warmContext);
+}
+
+/**
+ * Verify sizing of the open-addressed class cache.
+ */
+- (void) testClassCacheSizing {
+    plcrash_async_objc_cache_t objCContext;
+    plcrash_error_t err = plcrash_async_objc_cache_init(&objCContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+    STAssertEquals(objCContext.classCacheMaxSize, (size_t) PLCRASH_ASYNC_OBJC_CLASS_CACHE_DEFAULT_MAX_SIZE, @"Incorrect default maximum");
+
+    /* Capacity limits are rounded down to a power of two, and clamped to the minimum */
+    plcrash_async_objc_cache_set_max_class_capacity(&objCContext, 5000);
+    STAssertEquals(objCContext.classCacheMaxSize, (size_t) 4096, @"Capacity should be rounded down to a power of two");
+
+    plcrash_async_objc_cache_set_max_class_capacity(&objCContext, 1);
+    STAssertEquals(objCContext.classCacheMaxSize, (size_t) PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE, @"Capacity should be clamped to the minimum");
+
+    plcrash_async_objc_cache_set_max_class_capacity(&objCContext, PLCRASH_ASYNC_OBJC_CLASS_CACHE_DEFAULT_MAX_SIZE);
+
+    /* Perform a lookup, populating the cache; repeat it to exercise cache hits */
+    PLCrashAsyncObjCSectionTestsSimpleClass *obj = [[[PLCrashAsyncObjCSectionTestsSimpleClass alloc] init] autorelease];
+    pl_vm_address_t pc = [obj addressInSimpleClass];
+    for (int i = 0; i < 2; i++) {
+        __block BOOL didCall = NO;
+        err = plcrash_async_objc_find_method(&_image, &objCContext, pc, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+            didCall = YES;
+        });
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+        STAssertTrue(didCall, @"Method find callback never got called");
+    }
+
+    /* The table must be a power of two, sized from the class list, and never full */
+    size_t size = objCContext.classCacheSize;
+    STAssertTrue(size >= PLCRASH_ASYNC_OBJC_CLASS_CACHE_MIN_SIZE, @"Cache was not sized");
+    STAssertEquals(size & (size - 1), (size_t) 0, @"Cache size is not a power of two");
+    STAssertTrue(objCContext.classCacheCount * 4 <= size * 3, @"Cache exceeds its maximum load factor");
+
+    size_t occupied = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (objCContext.classCacheKeys[i] != 0)
+            occupied++;
+    }
+    STAssertEquals(occupied, objCContext.classCacheCount, @"Incorrect occupied entry count");
+
+    plcrash_async_objc_cache_free(&objCContext);
+}
+
+/**
+ * Look up the section cache entry for @a image, if any.
+ */
+static plcrash_async_objc_image_sections_t *FindCacheEntry (plcrash_async_objc_cache_t *cache, plcrash_async_macho_t *image) {
+    for (size_t set = 0; set < PLCRASH_ASYNC_OBJC_CACHE_SETS; set++) {
+        for (size_t way = 0; way < PLCRASH_ASYNC_OBJC_CACHE_WAYS; way++) {
+            if (cache->sections[set][way].image == image)
+                return &cache->sections[set][way];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Verify that section mappings for multiple images are retained across alternating lookups.
+ */
+- (void) testMultiImageCache {
+    plcrash_async_objc_cache_t objCContext;
+    plcrash_error_t err = plcrash_async_objc_cache_init(&objCContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_objc_context_init failed");
+
+    /* Set up a second image, using Foundation's NSString implementation */
+    Dl_info info;
+    IMP foundationIMP = class_getMethodImplementation([NSString class], @selector(stringByAppendingString:));
+    STAssertTrue(dladdr((void *) foundationIMP, &info) > 0, @"Could not fetch dyld info for %p", foundationIMP);
+
+    plcrash_async_macho_t foundationImage;
+    err = plcrash_async_macho_init(&foundationImage, _allocator, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize image");
+
+    PLCrashAsyncObjCSectionTestsSimpleClass *obj = [[[PLCrashAsyncObjCSectionTestsSimpleClass alloc] init] autorelease];
+    pl_vm_address_t localPC = [obj addressInSimpleClass];
+
+    /* Alternate between the two images; both should remain resident in the cache */
+    __block NSUInteger localCalls = 0;
+    __block NSUInteger foundationCalls = 0;
+    for (int i = 0; i < 4; i++) {
+        err = plcrash_async_objc_find_method(&_image, &objCContext, localPC, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+            localCalls++;
+        });
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+
+        err = plcrash_async_objc_find_method(&foundationImage, &objCContext, (pl_vm_address_t) foundationIMP, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+            foundationCalls++;
+            STAssertEquals(imp, (pl_vm_address_t) foundationIMP, @"Method IMPs don't match");
+        });
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+    }
+
+    STAssertEquals(localCalls, (NSUInteger) 4, @"Method find callback not called for every lookup");
+    STAssertEquals(foundationCalls, (NSUInteger) 4, @"Method find callback not called for every lookup");
+
+    plcrash_async_objc_image_sections_t *localEntry = FindCacheEntry(&objCContext, &_image);
+    plcrash_async_objc_image_sections_t *foundationEntry = FindCacheEntry(&objCContext, &foundationImage);
+    STAssertNotNULL(localEntry, @"Local image sections were evicted");
+    STAssertNotNULL(foundationEntry, @"Foundation image sections were evicted");
+    STAssertTrue(localEntry != foundationEntry, @"Images should not share a cache entry");
+    STAssertEquals(localEntry->mapResult, PLCRASH_ESUCCESS, @"Incorrect cached map result");
+    STAssertEquals(foundationEntry->mapResult, PLCRASH_ESUCCESS, @"Incorrect cached map result");
+
+    plcrash_async_objc_cache_free(&objCContext);
+    plcrash_async_macho_free(&foundationImage);
+}
+
 @end
 
 @implementation PLCrashAsyncObjCSectionTests (Category)
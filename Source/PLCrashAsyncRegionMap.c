@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncRegionMap.h"
+
+#include <inttypes.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_region_map VM Region Map
+ *
+ * Implements an async-safe snapshot of a task's VM regions, allowing address ranges to be validated via a binary
+ * search rather than a kernel trap.
+ * @{
+ */
+
+/** The initial number of region entries allocated by plcrash_async_region_map_init(). */
+#define PLCRASH_ASYNC_REGION_MAP_INITIAL_CAPACITY 256
+
+/** The region map installed via plcrash_async_region_map_set_current(), or NULL. */
+static const plcrash_async_region_map_t * volatile current_map = NULL;
+
+/**
+ * @internal
+ *
+ * Append a region to @a map, coalescing it with the preceding region if the two are contiguous and share the
+ * same protection.
+ */
+static plcrash_error_t plcrash_async_region_map_append (plcrash_async_region_map_t *map, pl_vm_address_t start, pl_vm_address_t end, vm_prot_t protection) {
+    /* Coalesce with the preceding entry */
+    if (map->count > 0) {
+        plcrash_async_region_t *last = &map->regions[map->count - 1];
+        if (last->end == start && last->protection == protection) {
+            last->end = end;
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    /* Grow the array if necessary */
+    if (map->count == map->capacity) {
+        size_t capacity = map->capacity * 2;
+        void *buf;
+        plcrash_error_t err;
+
+        if ((err = plcrash_async_allocator_alloc(map->allocator, &buf, sizeof(map->regions[0]) * capacity)) != PLCRASH_ESUCCESS)
+            return err;
+
+        plcrash_async_memcpy(buf, map->regions, sizeof(map->regions[0]) * map->count);
+        plcrash_async_allocator_dealloc(map->allocator, map->regions);
+
+        map->regions = buf;
+        map->capacity = capacity;
+    }
+
+    map->regions[map->count].start = start;
+    map->regions[map->count].end = end;
+    map->regions[map->count].protection = protection;
+    map->count++;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Snapshot the VM regions of @a task. Submaps (such as the dyld shared cache) are descended, and the protection
+ * of the nested mappings recorded.
+ *
+ * The snapshot is only valid for as long as the task's mappings remain unchanged; generally, this means that it
+ * should only be used while all other threads in the task are suspended.
+ *
+ * @param map The map to initialize.
+ * @param allocator The allocator from which the map's backing storage will be allocated.
+ * @param task The task to be described.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the backing storage could not be allocated. If the
+ * task's regions can not be read, an empty map will be returned.
+ */
+plcrash_error_t plcrash_async_region_map_init (plcrash_async_region_map_t *map, plcrash_async_allocator_t *allocator, mach_port_t task) {
+    plcrash_error_t err;
+    void *buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(map->regions[0]) * PLCRASH_ASYNC_REGION_MAP_INITIAL_CAPACITY)) != PLCRASH_ESUCCESS)
+        return err;
+
+    map->allocator = allocator;
+    map->task = task;
+    map->regions = buf;
+    map->count = 0;
+    map->capacity = PLCRASH_ASYNC_REGION_MAP_INITIAL_CAPACITY;
+
+    pl_vm_address_t addr = 0x0;
+    natural_t depth = 0;
+    while (true) {
+        vm_region_submap_info_data_64_t info;
+        mach_msg_type_number_t count = VM_REGION_SUBMAP_INFO_COUNT_64;
+        pl_vm_address_t region_addr = addr;
+        pl_vm_size_t region_size = 0;
+        kern_return_t kt;
+
+#ifdef PL_HAVE_MACH_VM
+        kt = mach_vm_region_recurse(task, &region_addr, &region_size, &depth, (vm_region_recurse_info_t) &info, &count);
+#else
+        kt = vm_region_recurse_64(task, &region_addr, &region_size, &depth, (vm_region_recurse_info_t) &info, &count);
+#endif
+        /* KERN_INVALID_ADDRESS is returned once we've passed the last region */
+        if (kt != KERN_SUCCESS)
+            break;
+
+        /* Descend into the submap, and query the same address again */
+        if (info.is_submap) {
+            depth++;
+            continue;
+        }
+
+        /* Regions are returned in ascending order; anything else would indicate a concurrent modification of the
+         * map, and we simply stop there */
+        if (region_addr < addr || region_addr + region_size <= region_addr)
+            break;
+
+        if ((err = plcrash_async_region_map_append(map, region_addr, region_addr + region_size, info.protection)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not grow the region map, truncating at 0x%" PRIx64, (uint64_t) region_addr);
+            break;
+        }
+
+        addr = region_addr + region_size;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Verify that the range of @a length bytes at @a address is fully mapped within the map's regions, with at least
+ * the given @a protection.
+ *
+ * @param map The region map to search.
+ * @param address The first address of the range.
+ * @param length The length of the range.
+ * @param protection The minimum required protection, eg, VM_PROT_READ.
+ *
+ * @return Returns true if the full range is mapped with the required protection, false otherwise.
+ */
+bool plcrash_async_region_map_verify (const plcrash_async_region_map_t *map, pl_vm_address_t address, pl_vm_size_t length, vm_prot_t protection) {
+    /* Check for overflow */
+    pl_vm_address_t end = address + length;
+    if (end < address)
+        return false;
+
+    /* Binary search for the first region ending after address */
+    size_t lower = 0;
+    size_t upper = map->count;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (map->regions[mid].end <= address)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    /* Walk the (contiguous) regions covering the range */
+    pl_vm_address_t next = address;
+    for (size_t i = lower; i < map->count; i++) {
+        const plcrash_async_region_t *region = &map->regions[i];
+        if (region->start > next || (region->protection & protection) != protection)
+            return false;
+
+        if (region->end >= end)
+            return true;
+
+        next = region->end;
+    }
+
+    return false;
+}
+
+/**
+ * Free all resources associated with @a map. If @a map is the current region map, it must first be uninstalled via
+ * plcrash_async_region_map_set_current().
+ */
+void plcrash_async_region_map_free (plcrash_async_region_map_t *map) {
+    PLCF_ASSERT(current_map != map);
+    plcrash_async_allocator_dealloc(map->allocator, map->regions);
+}
+
+/**
+ * Install @a map as the current task's region map. While installed, reads of the current task's memory via
+ * plcrash_async_task_memcpy() and plcrash_async_mobject_init() are validated against @a map, rather than by the kernel.
+ *
+ * The caller is responsible for ensuring that @a map accurately describes the current task for as long as it is
+ * installed.
+ *
+ * @param map The map to install, or NULL to uninstall the current map. The map must describe mach_task_self().
+ */
+void plcrash_async_region_map_set_current (const plcrash_async_region_map_t *map) {
+    PLCF_ASSERT(map == NULL || map->task == mach_task_self());
+
+    OSMemoryBarrier();
+    current_map = map;
+    OSMemoryBarrier();
+}
+
+/**
+ * Return the region map installed via plcrash_async_region_map_set_current(), or NULL if none.
+ */
+const plcrash_async_region_map_t *plcrash_async_region_map_current (void) {
+    return current_map;
+}
+
+/**
+ * @}
+ */
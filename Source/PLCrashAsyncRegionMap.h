@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_REGION_MAP_H
+#define PLCRASH_ASYNC_REGION_MAP_H
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncAllocator.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_region_map
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A contiguous range of a task's address space sharing a single protection.
+ */
+typedef struct plcrash_async_region {
+    /** The first address of the region. */
+    pl_vm_address_t start;
+
+    /** The address immediately following the region. */
+    pl_vm_address_t end;
+
+    /** The region's current protection. */
+    vm_prot_t protection;
+} plcrash_async_region_t;
+
+/**
+ * @internal
+ *
+ * A snapshot of a task's VM regions, sorted by address. Adjacent regions sharing the same protection are
+ * coalesced.
+ */
+typedef struct plcrash_async_region_map {
+    /** The allocator backing @a regions. */
+    plcrash_async_allocator_t *allocator;
+
+    /** The task described by this map. */
+    mach_port_t task;
+
+    /** The sorted, non-overlapping regions. */
+    plcrash_async_region_t *regions;
+
+    /** The number of entries in @a regions. */
+    size_t count;
+
+    /** The number of entries allocated at @a regions. */
+    size_t capacity;
+} plcrash_async_region_map_t;
+
+plcrash_error_t plcrash_async_region_map_init (plcrash_async_region_map_t *map, plcrash_async_allocator_t *allocator, mach_port_t task);
+bool plcrash_async_region_map_verify (const plcrash_async_region_map_t *map, pl_vm_address_t address, pl_vm_size_t length, vm_prot_t protection);
+void plcrash_async_region_map_free (plcrash_async_region_map_t *map);
+
+void plcrash_async_region_map_set_current (const plcrash_async_region_map_t *map);
+const plcrash_async_region_map_t *plcrash_async_region_map_current (void);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_REGION_MAP_H */
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncRegionMap.h"
+
+@interface PLCrashAsyncRegionMapTests : SenTestCase {
+    /** Allocator used by our region maps. */
+    plcrash_async_allocator_t *_allocator;
+
+    /** Two pages, the second of which is unreadable. */
+    vm_address_t _pages;
+}
+@end
+
+@implementation PLCrashAsyncRegionMapTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+
+    _pages = 0x0;
+    STAssertEquals(KERN_SUCCESS, vm_allocate(mach_task_self(), &_pages, vm_page_size * 2, VM_FLAGS_ANYWHERE), @"Failed to allocate pages");
+    STAssertEquals(KERN_SUCCESS, vm_protect(mach_task_self(), _pages + vm_page_size, vm_page_size, false, VM_PROT_NONE), @"Failed to protect page");
+}
+
+- (void) tearDown {
+    vm_deallocate(mach_task_self(), _pages, vm_page_size * 2);
+    plcrash_async_allocator_free(_allocator);
+}
+
+/**
+ * Verify that the map's regions are sorted, non-overlapping, and coalesced.
+ */
+- (void) testRegionsSorted {
+    plcrash_async_region_map_t map;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_region_map_init(&map, _allocator, mach_task_self()), @"Failed to initialize map");
+    STAssertTrue(map.count > 0, @"No regions found");
+
+    for (size_t i = 0; i < map.count; i++) {
+        STAssertTrue(map.regions[i].start < map.regions[i].end, @"Empty region");
+
+        if (i > 0) {
+            STAssertTrue(map.regions[i-1].end <= map.regions[i].start, @"Regions are unsorted or overlapping");
+            if (map.regions[i-1].end == map.regions[i].start)
+                STAssertTrue(map.regions[i-1].protection != map.regions[i].protection, @"Adjacent regions were not coalesced");
+        }
+    }
+
+    plcrash_async_region_map_free(&map);
+}
+
+/**
+ * Test range validation.
+ */
+- (void) testVerify {
+    uint8_t stack_bytes[16];
+
+    plcrash_async_region_map_t map;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_region_map_init(&map, _allocator, mach_task_self()), @"Failed to initialize map");
+
+    /* Readable ranges */
+    STAssertTrue(plcrash_async_region_map_verify(&map, (pl_vm_address_t) stack_bytes, sizeof(stack_bytes), VM_PROT_READ), @"Stack is not readable");
+    STAssertTrue(plcrash_async_region_map_verify(&map, (pl_vm_address_t) _pages, vm_page_size, VM_PROT_READ|VM_PROT_WRITE), @"Page is not writable");
+
+    /* Ranges including the unreadable page */
+    STAssertFalse(plcrash_async_region_map_verify(&map, (pl_vm_address_t) _pages, vm_page_size * 2, VM_PROT_READ), @"Unreadable page verified as readable");
+    STAssertFalse(plcrash_async_region_map_verify(&map, (pl_vm_address_t) _pages + vm_page_size, 1, VM_PROT_READ), @"Unreadable page verified as readable");
+    STAssertTrue(plcrash_async_region_map_verify(&map, (pl_vm_address_t) _pages + vm_page_size, vm_page_size, VM_PROT_NONE), @"Unreadable page is not mapped");
+
+    /* Unmapped and overflowing ranges */
+    STAssertFalse(plcrash_async_region_map_verify(&map, 0x0, 1, VM_PROT_NONE), @"NULL page verified as mapped");
+    STAssertFalse(plcrash_async_region_map_verify(&map, (pl_vm_address_t) _pages, (pl_vm_size_t) -1, VM_PROT_NONE), @"Overflowing range verified as mapped");
+
+    plcrash_async_region_map_free(&map);
+}
+
+/**
+ * Verify that plcrash_async_task_memcpy() validates reads against the installed region map.
+ */
+- (void) testCurrentMap {
+    uint8_t src[] = { 0xC, 0xA, 0xF, 0xE };
+    uint8_t dest[sizeof(src)];
+
+    plcrash_async_region_map_t map;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_region_map_init(&map, _allocator, mach_task_self()), @"Failed to initialize map");
+
+    plcrash_async_region_map_set_current(&map); {
+        STAssertTrue(plcrash_async_region_map_current() == &map, @"Map was not installed");
+
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) src, 0, dest, sizeof(dest)), @"Failed to read valid memory");
+        STAssertTrue(memcmp(src, dest, sizeof(src)) == 0, @"Incorrect data");
+
+        STAssertEquals(PLCRASH_EACCESS, plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) _pages + vm_page_size, 0, dest, sizeof(dest)), @"Read unreadable memory");
+        STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_task_memcpy(mach_task_self(), 0x0, 0, dest, sizeof(dest)), @"Read unmapped memory");
+    } plcrash_async_region_map_set_current(NULL);
+
+    STAssertNULL(plcrash_async_region_map_current(), @"Map was not uninstalled");
+    plcrash_async_region_map_free(&map);
+}
+
+@end
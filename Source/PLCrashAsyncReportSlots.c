@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncReportSlots.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_report_slots Shared Report Slots
+ *
+ * Implements a file of fixed-size crash report slots that may be shared by any number of processes -- such as an
+ * application and its extensions, via an App Group container. The file is created and sized once; each process
+ * maps it at launch, and a crashing process claims a free slot via compare-and-swap on the slot's descriptor. The
+ * slot descriptors are stored together at the start of the file, so that all pending reports may be located by
+ * scanning a single page.
+ * @{
+ */
+
+/** The maximum number of slots supported in a single file. */
+#define REPORT_SLOTS_MAX_COUNT 1024
+
+/** The maximum total size of a slot file, in bytes. */
+#define REPORT_SLOTS_MAX_SIZE (UINT64_C(1) << 30)
+
+/**
+ * @internal
+ *
+ * Return the descriptor of slot @a index in the file described by @a header.
+ */
+static inline plcrash_async_report_slot_t *report_slot (const plcrash_async_report_slots_header_t *header, uint32_t index) {
+    return ((plcrash_async_report_slot_t *) (header + 1)) + index;
+}
+
+/**
+ * @internal
+ *
+ * Return the combined plcrash_async_report_slot_t::owner value for @a state and @a pid.
+ */
+static inline int64_t report_slot_owner (int32_t state, int32_t pid) {
+    plcrash_async_report_slot_t desc;
+    desc.state = state;
+    desc.pid = pid;
+    return desc.owner;
+}
+
+/**
+ * @internal
+ *
+ * Return the report data of slot @a index in the file described by @a header.
+ */
+static inline uint8_t *report_slot_data (const plcrash_async_report_slots_header_t *header, uint32_t index) {
+    return (uint8_t *) header + header->data_offset + ((size_t) index * header->slot_size);
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a header describes a valid slot file of at least @a file_size bytes.
+ */
+static bool report_slots_header_valid (const plcrash_async_report_slots_header_t *header, off_t file_size) {
+    if (header->magic != PLCRASH_ASYNC_REPORT_SLOTS_MAGIC || header->version != PLCRASH_ASYNC_REPORT_SLOTS_VERSION)
+        return false;
+
+    if (header->slot_count == 0 || header->slot_count > REPORT_SLOTS_MAX_COUNT)
+        return false;
+
+    if (header->slot_size == 0 || (header->slot_size % PAGE_SIZE) != 0 || (header->data_offset % PAGE_SIZE) != 0)
+        return false;
+
+    if (header->data_offset < sizeof(*header) + (header->slot_count * sizeof(plcrash_async_report_slot_t)))
+        return false;
+
+    uint64_t size = header->data_offset + ((uint64_t) header->slot_count * header->slot_size);
+    if (size > REPORT_SLOTS_MAX_SIZE || (uint64_t) file_size < size)
+        return false;
+
+    return true;
+}
+
+/**
+ * Open the slot file at @a path, creating it with @a slot_count slots of @a slot_size bytes each if it does not
+ * exist or is not a valid slot file, and map it into memory.
+ *
+ * The file may be opened concurrently by any number of processes; creation is serialized via an advisory lock. If a
+ * valid file already exists, its slot count and size are used as-is, and @a slot_count and @a slot_size are ignored.
+ * Reports pending in an existing file are preserved.
+ *
+ * @param slots The slots to initialize.
+ * @param path The path of the slot file.
+ * @param slot_count The number of slots to create.
+ * @param slot_size The size of each slot, in bytes; this will be rounded up to a multiple of the page size.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a slot_count or @a slot_size is out of range, or
+ * PLCRASH_ENOMEM if the file could not be created or mapped.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_report_slots_open (plcrash_async_report_slots_t *slots, const char *path, uint32_t slot_count, uint32_t slot_size) {
+    if (slot_count == 0 || slot_count > REPORT_SLOTS_MAX_COUNT)
+        return PLCRASH_EINVAL;
+
+    if (slot_size == 0 || slot_size > REPORT_SLOTS_MAX_SIZE - PAGE_SIZE)
+        return PLCRASH_EINVAL;
+
+    slot_size = (slot_size + PAGE_SIZE - 1) & ~((uint32_t) PAGE_SIZE - 1);
+
+    uint64_t data_offset = sizeof(plcrash_async_report_slots_header_t) + ((uint64_t) slot_count * sizeof(plcrash_async_report_slot_t));
+    data_offset = (data_offset + PAGE_SIZE - 1) & ~((uint64_t) PAGE_SIZE - 1);
+    if (data_offset + ((uint64_t) slot_count * slot_size) > REPORT_SLOTS_MAX_SIZE)
+        return PLCRASH_EINVAL;
+
+    int fd = open(path, O_RDWR|O_CREAT, 0644);
+    if (fd < 0) {
+        PLCF_DEBUG("Could not open the report slot file: %s", strerror(errno));
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Serialize validation and creation against other processes opening the same file */
+    if (flock(fd, LOCK_EX) != 0) {
+        PLCF_DEBUG("Could not lock the report slot file: %s", strerror(errno));
+        close(fd);
+        return PLCRASH_ENOMEM;
+    }
+
+    plcrash_async_report_slots_header_t header;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header) || !report_slots_header_valid(&header, sb.st_size)) {
+        /* Create a new file, discarding any prior contents. The zero-filled descriptors are all free. */
+        header.magic = PLCRASH_ASYNC_REPORT_SLOTS_MAGIC;
+        header.version = PLCRASH_ASYNC_REPORT_SLOTS_VERSION;
+        header.slot_count = slot_count;
+        header.slot_size = slot_size;
+        header.data_offset = data_offset;
+        header.reserved = 0;
+
+        off_t size = (off_t) (data_offset + ((uint64_t) slot_count * slot_size));
+
+        /* Reserve the slots' storage now, rather than allocating blocks from the crash handler. This is non-fatal. */
+        plcrash_async_file_preallocate(fd, size);
+
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            PLCF_DEBUG("Could not create the report slot file: %s", strerror(errno));
+            flock(fd, LOCK_UN);
+            close(fd);
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    size_t size = (size_t) (header.data_offset + ((uint64_t) header.slot_count * header.slot_size));
+    void *addr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    flock(fd, LOCK_UN);
+
+    if (addr == MAP_FAILED) {
+        PLCF_DEBUG("Could not map the report slot file: %s", strerror(errno));
+        close(fd);
+        return PLCRASH_ENOMEM;
+    }
+
+    slots->header = addr;
+    slots->size = size;
+    slots->fd = fd;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Claim a free slot in @a slots for the calling process. The claimed slot must later be passed to either
+ * plcrash_async_report_slots_commit() or plcrash_async_report_slots_release().
+ *
+ * This function is async-safe and lock-free, and may be called concurrently from any number of processes.
+ *
+ * @param slots The report slots.
+ * @param[out] index On success, the index of the claimed slot.
+ * @param[out] data On success, the claimed slot's report data, within the shared mapping.
+ * @param[out] size On success, the size of @a data, in bytes.
+ *
+ * @return Returns true if a slot was claimed, or false if all slots are in use.
+ */
+bool plcrash_async_report_slots_claim (plcrash_async_report_slots_t *slots, uint32_t *index, void **data, size_t *size) {
+    plcrash_async_report_slots_header_t *header = slots->header;
+
+    for (uint32_t i = 0; i < header->slot_count; i++) {
+        plcrash_async_report_slot_t *slot = report_slot(header, i);
+        plcrash_async_report_slot_t observed;
+
+        /* The slot's state and owner are claimed together, ensuring that a claimed slot always names a process that
+         * can be checked for termination; see plcrash_nasync_report_slots_enumerate() */
+        observed.owner = slot->owner;
+        if (observed.state != PLCRASH_ASYNC_REPORT_SLOT_FREE)
+            continue;
+
+        if (!OSAtomicCompareAndSwap64Barrier(observed.owner, report_slot_owner(PLCRASH_ASYNC_REPORT_SLOT_WRITING, getpid()), &slot->owner))
+            continue;
+
+        struct timeval tv;
+        if (gettimeofday(&tv, NULL) == 0) {
+            slot->timestamp = ((uint64_t) tv.tv_sec * 1000000) + (uint64_t) tv.tv_usec;
+        } else {
+            slot->timestamp = 0;
+        }
+        slot->length = 0;
+        slot->reserved = 0;
+
+        *index = i;
+        *data = report_slot_data(header, i);
+        *size = header->slot_size;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Mark the claimed slot @a index as holding a complete report of @a length bytes. This function is async-safe.
+ *
+ * @param slots The report slots.
+ * @param index A slot claimed via plcrash_async_report_slots_claim().
+ * @param length The length of the report written to the slot, in bytes.
+ * @param sync If true, the slot's report data and descriptor are written back to stable storage via msync().
+ */
+void plcrash_async_report_slots_commit (plcrash_async_report_slots_t *slots, uint32_t index, size_t length, bool sync) {
+    plcrash_async_report_slots_header_t *header = slots->header;
+    plcrash_async_report_slot_t *slot = report_slot(header, index);
+
+    if (length > header->slot_size)
+        length = header->slot_size;
+
+    /* The report and its length must be visible before the slot is published */
+    slot->length = length;
+    OSMemoryBarrier();
+    slot->owner = report_slot_owner(PLCRASH_ASYNC_REPORT_SLOT_COMPLETE, slot->pid);
+
+    if (sync) {
+        if (length > 0 && msync(report_slot_data(header, index), length, MS_SYNC) != 0)
+            PLCF_DEBUG("Error syncing report slot %" PRIu32 ": %s", index, strerror(errno));
+
+        if (msync(header, (size_t) header->data_offset, MS_SYNC) != 0)
+            PLCF_DEBUG("Error syncing report slot descriptors: %s", strerror(errno));
+    }
+}
+
+/**
+ * Return the slot @a index to the free list, discarding any report it holds. This function is async-safe.
+ *
+ * @param slots The report slots.
+ * @param index A claimed or complete slot.
+ */
+void plcrash_async_report_slots_release (plcrash_async_report_slots_t *slots, uint32_t index) {
+    plcrash_async_report_slot_t *slot = report_slot(slots->header, index);
+
+    /* The owner is cleared along with the state, so that a later claimant is never mistaken for the prior owner */
+    slot->length = 0;
+    OSMemoryBarrier();
+    slot->owner = report_slot_owner(PLCRASH_ASYNC_REPORT_SLOT_FREE, 0);
+}
+
+/**
+ * Enumerate the complete reports in @a slots, in slot order. Only the slot descriptors are scanned; report data is
+ * only touched for complete slots.
+ *
+ * Slots claimed by a process that no longer exists -- whose owner terminated before its report was committed -- are
+ * released. Slots claimed by a running process are skipped.
+ *
+ * Reports are not removed by enumeration; @a callback may release the slot it was passed once the report has been
+ * copied.
+ *
+ * @param slots The report slots.
+ * @param callback The callback to be called for each complete report.
+ * @param context A context value to be passed to @a callback.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_report_slots_enumerate (plcrash_async_report_slots_t *slots, plcrash_async_report_slots_enumerate_fn callback, void *context) {
+    plcrash_async_report_slots_header_t *header = slots->header;
+
+    for (uint32_t i = 0; i < header->slot_count; i++) {
+        plcrash_async_report_slot_t *slot = report_slot(header, i);
+        plcrash_async_report_slot_t observed;
+        observed.owner = slot->owner;
+
+        switch (observed.state) {
+            case PLCRASH_ASYNC_REPORT_SLOT_WRITING: {
+                /* The claim publishes the state and owning pid together, so the owner is always valid here */
+                pid_t pid = observed.pid;
+                if (kill(pid, 0) != 0 && errno == ESRCH) {
+                    PLCF_DEBUG("Releasing report slot %" PRIu32 " abandoned by process %d", i, (int) pid);
+                    plcrash_async_report_slots_release(slots, i);
+                }
+                break;
+            }
+
+            case PLCRASH_ASYNC_REPORT_SLOT_COMPLETE: {
+                OSMemoryBarrier();
+                size_t length = (size_t) slot->length;
+                if (length > header->slot_size)
+                    length = header->slot_size;
+
+                callback(i, observed.pid, slot->timestamp, report_slot_data(header, i), length, context);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Unmap @a slots and close its backing file. The file and any pending reports are left in place.
+ *
+ * @param slots The report slots.
+ *
+ * @warning This function is not async-safe, and no other thread may be using the slots.
+ */
+void plcrash_nasync_report_slots_close (plcrash_async_report_slots_t *slots) {
+    munmap(slots->header, slots->size);
+    close(slots->fd);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_ASYNC_REPORT_SLOTS_H
+#define PLCRASH_ASYNC_REPORT_SLOTS_H
+
+#include <sys/types.h>
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_slots
+ * @{
+ */
+
+/** Report slot file magic ('PLRS'). */
+#define PLCRASH_ASYNC_REPORT_SLOTS_MAGIC 0x504C5253
+
+/** Report slot file format version. */
+#define PLCRASH_ASYNC_REPORT_SLOTS_VERSION 1
+
+/**
+ * @internal
+ *
+ * The state of a single report slot.
+ */
+typedef enum {
+    /** The slot is unused, and may be claimed by any process. */
+    PLCRASH_ASYNC_REPORT_SLOT_FREE = 0,
+
+    /** The slot has been claimed, and a report is being written by the owning process. */
+    PLCRASH_ASYNC_REPORT_SLOT_WRITING = 1,
+
+    /** The slot holds a complete report that has not yet been collected. */
+    PLCRASH_ASYNC_REPORT_SLOT_COMPLETE = 2,
+} plcrash_async_report_slot_state_t;
+
+/**
+ * @internal
+ *
+ * The report slot file header. The file is laid out as this header, followed by @a slot_count slot descriptors;
+ * the slots' report data begins at the page-aligned @a data_offset, with each slot occupying @a slot_size bytes.
+ * All values are in host byte order.
+ */
+typedef struct plcrash_async_report_slots_header {
+    /** PLCRASH_ASYNC_REPORT_SLOTS_MAGIC */
+    uint32_t magic;
+
+    /** PLCRASH_ASYNC_REPORT_SLOTS_VERSION */
+    uint32_t version;
+
+    /** The number of slots in the file. */
+    uint32_t slot_count;
+
+    /** The size of each slot's report data, in bytes; always a multiple of the page size. */
+    uint32_t slot_size;
+
+    /** The file offset of the first slot's report data; always a multiple of the page size. */
+    uint64_t data_offset;
+
+    /** Reserved; must be 0. */
+    uint64_t reserved;
+} plcrash_async_report_slots_header_t;
+
+/**
+ * @internal
+ *
+ * A single report slot descriptor. Descriptors are stored contiguously following the file header, allowing all slots
+ * to be inspected without reading any report data.
+ */
+typedef struct plcrash_async_report_slot {
+    union {
+        struct {
+            /** The slot's plcrash_async_report_slot_state_t. */
+            volatile int32_t state;
+
+            /** The process that claimed the slot. Only valid if the slot is not free. */
+            volatile int32_t pid;
+        };
+
+        /** The combined @a state and @a pid, updated as a single word. Transitions from PLCRASH_ASYNC_REPORT_SLOT_FREE
+         * are only performed via compare-and-swap of this value, publishing the claimant's pid along with the claim. */
+        volatile int64_t owner;
+    };
+
+    /** The length of the slot's report, in bytes. Only valid if the slot is complete. */
+    uint64_t length;
+
+    /** The time at which the slot was claimed, in microseconds since the epoch. */
+    uint64_t timestamp;
+
+    /** Reserved; must be 0. */
+    uint64_t reserved;
+} plcrash_async_report_slot_t;
+
+/**
+ * @internal
+ *
+ * A file of fixed-size, preallocated crash report slots, mapped by every process sharing the file. A crashing
+ * process claims a free slot via a single compare-and-swap, and writes its report directly into the slot's mapped
+ * pages; no files are created at crash time.
+ */
+typedef struct plcrash_async_report_slots {
+    /** The mapped slot file. */
+    plcrash_async_report_slots_header_t *header;
+
+    /** The size of the mapping, in bytes. */
+    size_t size;
+
+    /** The backing file descriptor. */
+    int fd;
+} plcrash_async_report_slots_t;
+
+/**
+ * @internal
+ *
+ * A report slot enumeration callback.
+ *
+ * @param index The slot index.
+ * @param pid The process that wrote the report.
+ * @param timestamp The time at which the crashed process claimed the slot, in microseconds since the epoch.
+ * @param data The report data.
+ * @param length The length of @a data, in bytes.
+ * @param context The context value supplied to plcrash_nasync_report_slots_enumerate().
+ */
+typedef void (*plcrash_async_report_slots_enumerate_fn)(uint32_t index, pid_t pid, uint64_t timestamp, const void *data, size_t length, void *context);
+
+plcrash_error_t plcrash_nasync_report_slots_open (plcrash_async_report_slots_t *slots, const char *path, uint32_t slot_count, uint32_t slot_size);
+
+bool plcrash_async_report_slots_claim (plcrash_async_report_slots_t *slots, uint32_t *index, void **data, size_t *size);
+void plcrash_async_report_slots_commit (plcrash_async_report_slots_t *slots, uint32_t index, size_t length, bool sync);
+void plcrash_async_report_slots_release (plcrash_async_report_slots_t *slots, uint32_t index);
+
+void plcrash_nasync_report_slots_enumerate (plcrash_async_report_slots_t *slots, plcrash_async_report_slots_enumerate_fn callback, void *context);
+
+void plcrash_nasync_report_slots_close (plcrash_async_report_slots_t *slots);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_REPORT_SLOTS_H */
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncReportSlots.h"
+
+@interface PLCrashAsyncReportSlotsTests : SenTestCase {
+@private
+    /** Path to the slot file */
+    NSString *_path;
+
+    /** Enumerated reports, keyed by slot index */
+    NSMutableDictionary *_reports;
+}
+@end
+
+static void collect_report (uint32_t index, pid_t pid, uint64_t timestamp, const void *data, size_t length, void *context) {
+    NSMutableDictionary *reports = context;
+    [reports setObject: [NSData dataWithBytes: data length: length] forKey: [NSNumber numberWithUnsignedInt: index]];
+}
+
+@implementation PLCrashAsyncReportSlotsTests
+
+- (void) setUp {
+    _path = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    _reports = [[NSMutableDictionary alloc] init];
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _path error: NULL];
+    [_path release];
+    [_reports release];
+}
+
+/**
+ * Claim a slot in @a slots, write @a report to it, and commit it.
+ */
+- (uint32_t) commitReport: (NSData *) report toSlots: (plcrash_async_report_slots_t *) slots {
+    uint32_t index;
+    void *data;
+    size_t size;
+
+    STAssertTrue(plcrash_async_report_slots_claim(slots, &index, &data, &size), @"Failed to claim a slot");
+    STAssertTrue(size >= [report length], @"Slot is too small");
+
+    memcpy(data, [report bytes], [report length]);
+    plcrash_async_report_slots_commit(slots, index, [report length], false);
+
+    return index;
+}
+
+- (void) testClaimAndCommit {
+    plcrash_async_report_slots_t slots;
+    STAssertEquals(plcrash_nasync_report_slots_open(&slots, [_path fileSystemRepresentation], 2, 1000), PLCRASH_ESUCCESS, @"Failed to open slots");
+    STAssertEquals(slots.header->slot_count, (uint32_t) 2, @"Incorrect slot count");
+    STAssertEquals(slots.header->slot_size, (uint32_t) PAGE_SIZE, @"Slot size was not rounded to the page size");
+
+    NSData *first = [@"first report" dataUsingEncoding: NSUTF8StringEncoding];
+    NSData *second = [@"second report" dataUsingEncoding: NSUTF8StringEncoding];
+    uint32_t firstIndex = [self commitReport: first toSlots: &slots];
+    uint32_t secondIndex = [self commitReport: second toSlots: &slots];
+    STAssertTrue(firstIndex != secondIndex, @"The same slot was claimed twice");
+
+    /* All slots are in use */
+    uint32_t index;
+    void *data;
+    size_t size;
+    STAssertFalse(plcrash_async_report_slots_claim(&slots, &index, &data, &size), @"Claimed a slot from a full file");
+
+    plcrash_nasync_report_slots_enumerate(&slots, collect_report, _reports);
+    STAssertEquals([_reports count], (NSUInteger) 2, @"Incorrect report count");
+    STAssertEqualObjects([_reports objectForKey: [NSNumber numberWithUnsignedInt: firstIndex]], first, @"Incorrect report data");
+    STAssertEqualObjects([_reports objectForKey: [NSNumber numberWithUnsignedInt: secondIndex]], second, @"Incorrect report data");
+
+    /* Released slots may be claimed again */
+    plcrash_async_report_slots_release(&slots, firstIndex);
+    STAssertTrue(plcrash_async_report_slots_claim(&slots, &index, &data, &size), @"Failed to claim a released slot");
+    STAssertEquals(index, firstIndex, @"Incorrect slot claimed");
+
+    plcrash_nasync_report_slots_close(&slots);
+}
+
+/**
+ * Verify that reports written via one mapping are visible to another, and survive reopening the file.
+ */
+- (void) testSharedMapping {
+    plcrash_async_report_slots_t writer;
+    plcrash_async_report_slots_t reader;
+    STAssertEquals(plcrash_nasync_report_slots_open(&writer, [_path fileSystemRepresentation], 4, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to open slots");
+
+    /* The existing geometry is used, regardless of the requested geometry */
+    STAssertEquals(plcrash_nasync_report_slots_open(&reader, [_path fileSystemRepresentation], 8, PAGE_SIZE * 2), PLCRASH_ESUCCESS, @"Failed to open slots");
+    STAssertEquals(reader.header->slot_count, (uint32_t) 4, @"Existing slot count was not used");
+    STAssertEquals(reader.header->slot_size, (uint32_t) PAGE_SIZE, @"Existing slot size was not used");
+
+    NSData *report = [@"shared report" dataUsingEncoding: NSUTF8StringEncoding];
+    uint32_t index = [self commitReport: report toSlots: &writer];
+    plcrash_nasync_report_slots_close(&writer);
+
+    plcrash_nasync_report_slots_enumerate(&reader, collect_report, _reports);
+    STAssertEqualObjects([_reports objectForKey: [NSNumber numberWithUnsignedInt: index]], report, @"Report was not visible to the reader");
+    plcrash_nasync_report_slots_close(&reader);
+
+    /* Reopen the file */
+    [_reports removeAllObjects];
+    STAssertEquals(plcrash_nasync_report_slots_open(&reader, [_path fileSystemRepresentation], 4, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to reopen slots");
+    plcrash_nasync_report_slots_enumerate(&reader, collect_report, _reports);
+    STAssertEqualObjects([_reports objectForKey: [NSNumber numberWithUnsignedInt: index]], report, @"Report did not survive reopening the file");
+    plcrash_nasync_report_slots_close(&reader);
+}
+
+/**
+ * Verify that enumeration skips slots still being written by a live process.
+ */
+- (void) testSkipsSlotsBeingWritten {
+    plcrash_async_report_slots_t slots;
+    STAssertEquals(plcrash_nasync_report_slots_open(&slots, [_path fileSystemRepresentation], 2, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to open slots");
+
+    uint32_t index;
+    void *data;
+    size_t size;
+    STAssertTrue(plcrash_async_report_slots_claim(&slots, &index, &data, &size), @"Failed to claim a slot");
+
+    plcrash_nasync_report_slots_enumerate(&slots, collect_report, _reports);
+    STAssertEquals([_reports count], (NSUInteger) 0, @"Enumerated a slot that was being written");
+
+    /* The slot must not have been reclaimed while its owner is alive */
+    uint32_t other;
+    STAssertTrue(plcrash_async_report_slots_claim(&slots, &other, &data, &size), @"Failed to claim a slot");
+    STAssertTrue(other != index, @"A slot in use by a live process was reclaimed");
+
+    plcrash_nasync_report_slots_close(&slots);
+}
+
+/**
+ * Verify that a claim publishes the claimant's pid, and that a claimed slot without an owner is reclaimed.
+ */
+- (void) testReclaimsUnownedSlots {
+    plcrash_async_report_slots_t slots;
+    STAssertEquals(plcrash_nasync_report_slots_open(&slots, [_path fileSystemRepresentation], 1, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to open slots");
+
+    uint32_t index;
+    void *data;
+    size_t size;
+    STAssertTrue(plcrash_async_report_slots_claim(&slots, &index, &data, &size), @"Failed to claim a slot");
+
+    plcrash_async_report_slot_t *slot = ((plcrash_async_report_slot_t *) (slots.header + 1)) + index;
+    STAssertEquals(slot->state, (int32_t) PLCRASH_ASYNC_REPORT_SLOT_WRITING, @"Slot was not marked as being written");
+    STAssertEquals(slot->pid, (int32_t) getpid(), @"Claim did not publish the owner");
+
+    /* Simulate a claim interrupted before its owner was recorded */
+    slot->pid = 0;
+    plcrash_nasync_report_slots_enumerate(&slots, collect_report, _reports);
+    STAssertEquals(slot->state, (int32_t) PLCRASH_ASYNC_REPORT_SLOT_FREE, @"Unowned slot was not reclaimed");
+
+    plcrash_nasync_report_slots_close(&slots);
+}
+
+- (void) testInvalidGeometry {
+    plcrash_async_report_slots_t slots;
+    STAssertEquals(plcrash_nasync_report_slots_open(&slots, [_path fileSystemRepresentation], 0, PAGE_SIZE), PLCRASH_EINVAL, @"Accepted a zero slot count");
+    STAssertEquals(plcrash_nasync_report_slots_open(&slots, [_path fileSystemRepresentation], 4, 0), PLCRASH_EINVAL, @"Accepted a zero slot size");
+}
+
+@end
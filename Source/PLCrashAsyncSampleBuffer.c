@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncSampleBuffer.h"
+
+#include <stdlib.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_sample_buffer Stack Sample Ring Buffer
+ *
+ * Implements a lock-free, single-producer/single-consumer ring of fixed-size stack samples. Samples are written in
+ * place by the producer (generally, a sampling thread that has suspended its target) and copied out by the consumer
+ * at export time.
+ * @{
+ */
+
+/**
+ * Initialize @a buffer with room for at least @a capacity samples of up to @a max_frames frames each.
+ *
+ * @param buffer The buffer to initialize.
+ * @param capacity The minimum number of samples to be buffered; this will be rounded up to a power of two.
+ * @param max_frames The maximum number of frames to be recorded per sample.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a capacity or @a max_frames is 0 or too large, or
+ * PLCRASH_ENOMEM if the backing storage could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_sample_buffer_init (plcrash_async_sample_buffer_t *buffer, uint32_t capacity, uint32_t max_frames) {
+    if (capacity == 0 || capacity > (UINT32_C(1) << 31) || max_frames == 0)
+        return PLCRASH_EINVAL;
+
+    /* Round up to a power of two, allowing the free-running head/tail counters to wrap */
+    uint32_t slot_count = 1;
+    while (slot_count < capacity)
+        slot_count <<= 1;
+
+    size_t slot_size = sizeof(plcrash_async_sample_t) + (sizeof(uint64_t) * max_frames);
+    if (slot_size / sizeof(uint64_t) < max_frames || SIZE_MAX / slot_count < slot_size)
+        return PLCRASH_EINVAL;
+
+    buffer->slots = malloc(slot_size * slot_count);
+    if (buffer->slots == NULL)
+        return PLCRASH_ENOMEM;
+
+    buffer->slot_count = slot_count;
+    buffer->max_frames = max_frames;
+    buffer->slot_size = slot_size;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->dropped = 0;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return the slot for the free-running sample counter @a index.
+ */
+static inline plcrash_async_sample_t *sample_slot (plcrash_async_sample_buffer_t *buffer, uint32_t index) {
+    return (plcrash_async_sample_t *) (buffer->slots + ((size_t) (index & (buffer->slot_count - 1)) * buffer->slot_size));
+}
+
+/**
+ * Reserve the next free sample slot. The returned sample may be populated in place, and is published to the consumer
+ * via plcrash_async_sample_buffer_commit(); if it is not committed, the slot is reused by the next reservation.
+ *
+ * This function is async-safe, but must only be called from the producer.
+ *
+ * @param buffer The sample buffer.
+ *
+ * @return Returns the reserved sample, or NULL if the buffer is full. In the latter case, the buffer's dropped sample
+ * count is incremented.
+ */
+plcrash_async_sample_t *plcrash_async_sample_buffer_reserve (plcrash_async_sample_buffer_t *buffer) {
+    uint32_t head = buffer->head;
+
+    /* The barrier orders our read of the tail before any writes to the slot it released */
+    uint32_t tail = buffer->tail;
+    OSMemoryBarrier();
+
+    if (head - tail >= buffer->slot_count) {
+        OSAtomicIncrement32(&buffer->dropped);
+        return NULL;
+    }
+
+    return sample_slot(buffer, head);
+}
+
+/**
+ * Publish the sample most recently returned by plcrash_async_sample_buffer_reserve() to the consumer.
+ *
+ * This function is async-safe, but must only be called from the producer.
+ *
+ * @param buffer The sample buffer.
+ */
+void plcrash_async_sample_buffer_commit (plcrash_async_sample_buffer_t *buffer) {
+    /* Ensure the sample's contents are visible before the new head */
+    OSMemoryBarrier();
+    buffer->head = buffer->head + 1;
+}
+
+/**
+ * Return the oldest committed sample, or NULL if no samples are available. The sample remains valid until
+ * plcrash_async_sample_buffer_consume() is called.
+ *
+ * This function is async-safe, but must only be called from the consumer.
+ *
+ * @param buffer The sample buffer.
+ */
+const plcrash_async_sample_t *plcrash_async_sample_buffer_peek (plcrash_async_sample_buffer_t *buffer) {
+    uint32_t tail = buffer->tail;
+    uint32_t head = buffer->head;
+
+    /* The barrier orders our read of the head before our reads of the sample it published */
+    OSMemoryBarrier();
+
+    if (head == tail)
+        return NULL;
+
+    return sample_slot(buffer, tail);
+}
+
+/**
+ * Release the sample returned by plcrash_async_sample_buffer_peek(), making its slot available to the producer.
+ *
+ * This function is async-safe, but must only be called from the consumer.
+ *
+ * @param buffer The sample buffer.
+ */
+void plcrash_async_sample_buffer_consume (plcrash_async_sample_buffer_t *buffer) {
+    /* Ensure that our reads of the sample complete before the slot is released */
+    OSMemoryBarrier();
+    buffer->tail = buffer->tail + 1;
+}
+
+/**
+ * Return the number of samples that have been dropped because the buffer was full. This function is async-safe.
+ *
+ * @param buffer The sample buffer.
+ */
+uint32_t plcrash_async_sample_buffer_dropped (plcrash_async_sample_buffer_t *buffer) {
+    return (uint32_t) buffer->dropped;
+}
+
+/**
+ * Free all resources associated with @a buffer.
+ *
+ * @param buffer The sample buffer.
+ *
+ * @warning This function is not async-safe, and neither the producer nor the consumer may be using the buffer.
+ */
+void plcrash_nasync_sample_buffer_free (plcrash_async_sample_buffer_t *buffer) {
+    free(buffer->slots);
+    buffer->slots = NULL;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_SAMPLE_BUFFER_H
+#define PLCRASH_ASYNC_SAMPLE_BUFFER_H
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_sample_buffer
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A single stack sample.
+ */
+typedef struct plcrash_async_sample {
+    /** The time at which the sample was captured, in mach_absolute_time() units. */
+    uint64_t timestamp;
+
+    /** The number of valid entries in @a pcs. */
+    uint32_t frame_count;
+
+    /** The sampled frames' instruction pointers, beginning with the innermost frame. The array is sized to the
+     * buffer's max_frames. */
+    uint64_t pcs[];
+} plcrash_async_sample_t;
+
+/**
+ * @internal
+ *
+ * A fixed-capacity, single-producer/single-consumer ring of stack samples. The producer and consumer may run
+ * concurrently without locking; the producer never blocks, and samples produced while the ring is full are
+ * dropped and counted.
+ */
+typedef struct plcrash_async_sample_buffer {
+    /** Backing storage for @a slot_count samples of @a slot_size bytes each. */
+    uint8_t *slots;
+
+    /** The number of sample slots; always a power of two. */
+    uint32_t slot_count;
+
+    /** The maximum number of frames recorded per sample. */
+    uint32_t max_frames;
+
+    /** The size of a single slot, in bytes. */
+    size_t slot_size;
+
+    /** The number of samples committed by the producer. Only written by the producer. */
+    volatile uint32_t head;
+
+    /** The number of samples consumed by the consumer. Only written by the consumer. */
+    volatile uint32_t tail;
+
+    /** The number of samples dropped because the ring was full. */
+    volatile int32_t dropped;
+} plcrash_async_sample_buffer_t;
+
+plcrash_error_t plcrash_nasync_sample_buffer_init (plcrash_async_sample_buffer_t *buffer, uint32_t capacity, uint32_t max_frames);
+
+plcrash_async_sample_t *plcrash_async_sample_buffer_reserve (plcrash_async_sample_buffer_t *buffer);
+void plcrash_async_sample_buffer_commit (plcrash_async_sample_buffer_t *buffer);
+
+const plcrash_async_sample_t *plcrash_async_sample_buffer_peek (plcrash_async_sample_buffer_t *buffer);
+void plcrash_async_sample_buffer_consume (plcrash_async_sample_buffer_t *buffer);
+
+uint32_t plcrash_async_sample_buffer_dropped (plcrash_async_sample_buffer_t *buffer);
+
+void plcrash_nasync_sample_buffer_free (plcrash_async_sample_buffer_t *buffer);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_SAMPLE_BUFFER_H */
@@ -0,0 +1,504 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncSharedCache.h"
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <mach-o/nlist.h>
+#include <mach-o/dyld_images.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @defgroup plcrash_async_shared_cache dyld Shared Cache Local Symbols
+ *
+ * Implements lookup of the local symbols stripped from dyld shared cache images.
+ * @{
+ */
+
+/**
+ * @internal
+ * The leading fields of the dyld_cache_header structure; later fields are located by offset, as their presence
+ * depends on the cache format version (as indicated by mappingOffset, which directly follows the header).
+ */
+struct pl_dyld_cache_header {
+    char magic[16];
+    uint32_t mappingOffset;
+    uint32_t mappingCount;
+    uint32_t imagesOffset;
+    uint32_t imagesCount;
+    uint64_t dyldBaseAddress;
+    uint64_t codeSignatureOffset;
+    uint64_t codeSignatureSize;
+    uint64_t slideInfoOffset;
+    uint64_t slideInfoSize;
+    uint64_t localSymbolsOffset;
+    uint64_t localSymbolsSize;
+    uint8_t uuid[16];
+};
+
+/** The offset of the symbolFileUUID field within dyld_cache_header. Caches with a header extending through this
+ * field use 64-bit local symbol entries, and may store their local symbols in a separate .symbols file. */
+#define PL_DYLD_CACHE_HEADER_SYMBOL_FILE_UUID_OFFSET 400
+
+/** The required prefix of the dyld_cache_header magic value. */
+#define PL_DYLD_CACHE_MAGIC_PREFIX "dyld_v1"
+
+/**
+ * @internal
+ * The dyld_cache_local_symbols_info structure found at the start of the local symbols region. All offsets are
+ * relative to the start of the region.
+ */
+struct pl_dyld_cache_local_symbols_info {
+    uint32_t nlistOffset;
+    uint32_t nlistCount;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+    uint32_t entriesOffset;
+    uint32_t entriesCount;
+};
+
+/** @internal dyld_cache_local_symbols_entry, as used by older caches. */
+struct pl_dyld_cache_local_symbols_entry {
+    uint32_t dylibOffset;
+    uint32_t nlistStartIndex;
+    uint32_t nlistCount;
+};
+
+/** @internal dyld_cache_local_symbols_entry_64, as used by caches with a symbolFileUUID header field. */
+struct pl_dyld_cache_local_symbols_entry_64 {
+    uint64_t dylibOffset;
+    uint32_t nlistStartIndex;
+    uint32_t nlistCount;
+};
+
+/** Directories that may contain the shared cache, in search order. */
+static const char * const pl_dyld_cache_directories[] = {
+    "/System/Library/Caches/com.apple.dyld",
+    "/private/preboot/Cryptexes/OS/System/Library/Caches/com.apple.dyld",
+    "/System/Volumes/Preboot/Cryptexes/OS/System/Library/dyld",
+    "/System/Library/dyld",
+    "/private/var/db/dyld"
+};
+
+/**
+ * @internal
+ *
+ * Open @a path, and verify that its cache header's UUID matches @a uuid.
+ *
+ * @param path The path to open.
+ * @param uuid The expected cache UUID.
+ * @param header On success, will be populated with the file's cache header.
+ *
+ * @return Returns an open file descriptor on success, or -1 on failure.
+ */
+static int plcrash_nasync_shared_cache_open (const char *path, const uint8_t uuid[16], struct pl_dyld_cache_header *header) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    if (pread(fd, header, sizeof(*header), 0) != sizeof(*header) || memcmp(header->uuid, uuid, sizeof(header->uuid)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Locate the current process' dyld shared cache and the file containing its local symbols, populating @a info.
+ * The caller is responsible for freeing @a info via plcrash_nasync_shared_cache_info_free().
+ *
+ * @param info The info structure to populate.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the process does not use a shared cache or its
+ * local symbols are not available, or one of the other plcrash_error_t error values on failure. On failure, @a info
+ * is initialized such that plcrash_async_shared_cache_find_symbol() will return PLCRASH_ENOTFOUND, and may still be
+ * safely passed to plcrash_nasync_shared_cache_info_free().
+ *
+ * @warning This method is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_shared_cache_info_init (plcrash_async_shared_cache_info_t *info) {
+    struct pl_dyld_cache_header header;
+    plcrash_error_t err;
+
+    info->fd = -1;
+    info->base_address = 0;
+    info->slide = 0;
+    info->local_symbols_offset = 0;
+    info->local_symbols_size = 0;
+    info->entries_64 = false;
+
+    /* Fetch the shared cache's address and slide from dyld */
+    struct task_dyld_info dyld_info;
+    mach_msg_type_number_t count = TASK_DYLD_INFO_COUNT;
+    kern_return_t kr = task_info(mach_task_self(), TASK_DYLD_INFO, (task_info_t) &dyld_info, &count);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to fetch TASK_DYLD_INFO: %d", kr);
+        return PLCRASH_EINTERNAL;
+    }
+
+    const struct dyld_all_image_infos *all_infos = (const struct dyld_all_image_infos *) (uintptr_t) dyld_info.all_image_info_addr;
+    if (all_infos->version < 15) {
+        PLCF_DEBUG("dyld_all_image_infos version %" PRIu32 " does not provide the shared cache base address", all_infos->version);
+        return PLCRASH_ENOTSUP;
+    }
+
+    if (all_infos->sharedCacheBaseAddress == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* Read and validate the in-memory cache header */
+    pl_vm_address_t base = (pl_vm_address_t) all_infos->sharedCacheBaseAddress;
+    if ((err = plcrash_async_task_memcpy(mach_task_self(), base, 0, &header, sizeof(header))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the shared cache header at 0x%" PRIx64 ": %d", (uint64_t) base, err);
+        return err;
+    }
+
+    if (strncmp(header.magic, PL_DYLD_CACHE_MAGIC_PREFIX, strlen(PL_DYLD_CACHE_MAGIC_PREFIX)) != 0) {
+        PLCF_DEBUG("Unrecognized shared cache magic");
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    uint8_t symbol_file_uuid[16];
+    bool has_symbol_file_uuid = false;
+    if (header.mappingOffset >= PL_DYLD_CACHE_HEADER_SYMBOL_FILE_UUID_OFFSET + sizeof(symbol_file_uuid)) {
+        err = plcrash_async_task_memcpy(mach_task_self(), base, PL_DYLD_CACHE_HEADER_SYMBOL_FILE_UUID_OFFSET, symbol_file_uuid, sizeof(symbol_file_uuid));
+        has_symbol_file_uuid = (err == PLCRASH_ESUCCESS);
+    }
+
+    /* The architecture name is the space-padded remainder of the magic value */
+    char arch[sizeof(header.magic) + 1];
+    const char *p = header.magic + strlen(PL_DYLD_CACHE_MAGIC_PREFIX);
+    while (p < header.magic + sizeof(header.magic) && *p == ' ')
+        p++;
+    size_t arch_len = strnlen(p, (size_t) (header.magic + sizeof(header.magic) - p));
+    memcpy(arch, p, arch_len);
+    arch[arch_len] = '\0';
+
+    /* Search for the on-disk cache matching our in-memory cache */
+    for (size_t i = 0; i < sizeof(pl_dyld_cache_directories) / sizeof(pl_dyld_cache_directories[0]); i++) {
+        struct pl_dyld_cache_header file_header;
+        char path[PATH_MAX];
+
+        snprintf(path, sizeof(path), "%s/dyld_shared_cache_%s", pl_dyld_cache_directories[i], arch);
+        int fd = plcrash_nasync_shared_cache_open(path, header.uuid, &file_header);
+        if (fd < 0)
+            continue;
+
+        /* Older caches include the local symbols directly */
+        if (file_header.localSymbolsSize != 0) {
+            info->fd = fd;
+            info->local_symbols_offset = file_header.localSymbolsOffset;
+            info->local_symbols_size = file_header.localSymbolsSize;
+            info->entries_64 = (file_header.mappingOffset >= PL_DYLD_CACHE_HEADER_SYMBOL_FILE_UUID_OFFSET);
+            break;
+        }
+        close(fd);
+
+        /* Newer caches move the local symbols to a separate file, identified by symbolFileUUID */
+        if (!has_symbol_file_uuid)
+            break;
+
+        strlcat(path, ".symbols", sizeof(path));
+        if ((fd = plcrash_nasync_shared_cache_open(path, symbol_file_uuid, &file_header)) < 0)
+            break;
+
+        if (file_header.localSymbolsSize == 0) {
+            close(fd);
+            break;
+        }
+
+        info->fd = fd;
+        info->local_symbols_offset = file_header.localSymbolsOffset;
+        info->local_symbols_size = file_header.localSymbolsSize;
+        info->entries_64 = (file_header.mappingOffset >= PL_DYLD_CACHE_HEADER_SYMBOL_FILE_UUID_OFFSET);
+        break;
+    }
+
+    if (info->fd < 0) {
+        PLCF_DEBUG("Could not locate local symbols for the %s shared cache", arch);
+        return PLCRASH_ENOTFOUND;
+    }
+
+    info->base_address = base;
+    info->slide = (pl_vm_off_t) all_infos->sharedCacheSlide;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free all resources associated with @a info.
+ *
+ * @param info The info structure to free.
+ *
+ * @warning This method is not async-safe.
+ */
+void plcrash_nasync_shared_cache_info_free (plcrash_async_shared_cache_info_t *info) {
+    if (info->fd >= 0) {
+        close(info->fd);
+        info->fd = -1;
+    }
+}
+
+/**
+ * Initialize a lazily mapped local symbols view. No mapping is performed until the first lookup.
+ *
+ * @param symbols The symbols instance to initialize.
+ * @param info The shared cache info from which symbols will be read, or NULL if none is available. This must remain
+ * valid for the lifetime of @a symbols.
+ */
+void plcrash_async_shared_cache_symbols_init (plcrash_async_shared_cache_symbols_t *symbols, const plcrash_async_shared_cache_info_t *info) {
+    symbols->info = info;
+    symbols->attempted = false;
+    symbols->mapped_addr = NULL;
+    symbols->mapped_length = 0;
+    symbols->nlists = NULL;
+    symbols->nlist_count = 0;
+    symbols->strings = NULL;
+    symbols->strings_size = 0;
+    symbols->entries = NULL;
+    symbols->entries_count = 0;
+}
+
+/**
+ * @internal
+ *
+ * Return true if the range [@a offset, @a offset + @a length) falls within a region of @a size bytes.
+ */
+static bool plcrash_async_shared_cache_range_valid (uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+/**
+ * @internal
+ *
+ * Map the local symbols region, if not already attempted.
+ *
+ * @note While mmap() is not included in the POSIX list of async-signal-safe functions, it is a direct system call on
+ * Darwin, and does not acquire any user-space locks.
+ */
+static plcrash_error_t plcrash_async_shared_cache_symbols_map (plcrash_async_shared_cache_symbols_t *symbols) {
+    const plcrash_async_shared_cache_info_t *info = symbols->info;
+
+    if (symbols->attempted)
+        return symbols->mapped_addr != NULL ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
+    symbols->attempted = true;
+
+    if (info == NULL || info->fd < 0 || info->local_symbols_size < sizeof(struct pl_dyld_cache_local_symbols_info))
+        return PLCRASH_ENOTFOUND;
+
+    /* Map the region */
+    uint64_t aligned_offset = info->local_symbols_offset & ~((uint64_t) PAGE_SIZE - 1);
+    uint64_t delta = info->local_symbols_offset - aligned_offset;
+    uint64_t length = info->local_symbols_size + delta;
+    if (length > SIZE_MAX)
+        return PLCRASH_ENOMEM;
+
+    void *addr = mmap(NULL, (size_t) length, PROT_READ, MAP_PRIVATE, info->fd, (off_t) aligned_offset);
+    if (addr == MAP_FAILED) {
+        PLCF_DEBUG("Failed to map %" PRIu64 " bytes of shared cache local symbols", length);
+        return PLCRASH_EINTERNAL;
+    }
+
+    symbols->mapped_addr = addr;
+    symbols->mapped_length = (size_t) length;
+
+    /* Validate and record the symbol tables */
+    const uint8_t *base = (const uint8_t *) addr + delta;
+    const struct pl_dyld_cache_local_symbols_info *lsi = (const struct pl_dyld_cache_local_symbols_info *) base;
+    uint64_t size = info->local_symbols_size;
+
+    size_t nlist_size = sizeof(void *) == 8 ? sizeof(struct nlist_64) : sizeof(struct nlist);
+    size_t entry_size = info->entries_64 ? sizeof(struct pl_dyld_cache_local_symbols_entry_64) : sizeof(struct pl_dyld_cache_local_symbols_entry);
+
+    if (!plcrash_async_shared_cache_range_valid(lsi->nlistOffset, (uint64_t) lsi->nlistCount * nlist_size, size) ||
+        !plcrash_async_shared_cache_range_valid(lsi->stringsOffset, lsi->stringsSize, size) ||
+        !plcrash_async_shared_cache_range_valid(lsi->entriesOffset, (uint64_t) lsi->entriesCount * entry_size, size))
+    {
+        PLCF_DEBUG("Shared cache local symbols info references data outside of the local symbols region");
+        munmap(symbols->mapped_addr, symbols->mapped_length);
+        symbols->mapped_addr = NULL;
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    symbols->nlists = base + lsi->nlistOffset;
+    symbols->nlist_count = lsi->nlistCount;
+    symbols->strings = (const char *) base + lsi->stringsOffset;
+    symbols->strings_size = lsi->stringsSize;
+    symbols->entries = base + lsi->entriesOffset;
+    symbols->entries_count = lsi->entriesCount;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Find the local symbol entry range for the dylib at @a dylib_offset.
+ */
+static bool plcrash_async_shared_cache_find_entry (plcrash_async_shared_cache_symbols_t *symbols, uint64_t dylib_offset, uint32_t *start, uint32_t *count) {
+    for (uint32_t i = 0; i < symbols->entries_count; i++) {
+        uint64_t offset;
+        if (symbols->info->entries_64) {
+            const struct pl_dyld_cache_local_symbols_entry_64 *e = (const struct pl_dyld_cache_local_symbols_entry_64 *) symbols->entries + i;
+            offset = e->dylibOffset;
+            *start = e->nlistStartIndex;
+            *count = e->nlistCount;
+        } else {
+            const struct pl_dyld_cache_local_symbols_entry *e = (const struct pl_dyld_cache_local_symbols_entry *) symbols->entries + i;
+            offset = e->dylibOffset;
+            *start = e->nlistStartIndex;
+            *count = e->nlistCount;
+        }
+
+        if (offset == dylib_offset)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Attempt to locate the best-matching local symbol for @a pc within @a image, using the shared cache's local
+ * symbols. This uses the same best-guess heuristics as plcrash_async_macho_find_symbol_by_pc().
+ *
+ * @param symbols The local symbols view.
+ * @param image The Mach-O image containing @a pc. Only images within the shared cache will be matched.
+ * @param pc The PC value within the target process for which symbol information should be found.
+ * @param symbol_cb A callback to be called if the symbol is found.
+ * @param context Context to be passed to @a symbol_cb.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the symbol is found. If the symbol is not found, @a symbol_cb will not be called,
+ * and PLCRASH_ENOTFOUND (or another plcrash_error_t error value) will be returned.
+ */
+plcrash_error_t plcrash_async_shared_cache_find_symbol (plcrash_async_shared_cache_symbols_t *symbols,
+                                                        plcrash_async_macho_t *image,
+                                                        pl_vm_address_t pc,
+                                                        pl_async_macho_found_symbol_cb symbol_cb,
+                                                        void *context)
+{
+    plcrash_error_t err;
+
+    if ((err = plcrash_async_shared_cache_symbols_map(symbols)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* The local symbols are only valid for the current process' images */
+    if (image->task != mach_task_self() || image->header_addr < symbols->info->base_address)
+        return PLCRASH_ENOTFOUND;
+
+    /* Our nlist parsing assumes the host's native layout */
+    if (image->m64 != (sizeof(void *) == 8))
+        return PLCRASH_ENOTFOUND;
+
+    uint32_t start, count;
+    if (!plcrash_async_shared_cache_find_entry(symbols, image->header_addr - symbols->info->base_address, &start, &count))
+        return PLCRASH_ENOTFOUND;
+
+    if (start > symbols->nlist_count || count > symbols->nlist_count - start) {
+        PLCF_DEBUG("Shared cache local symbol entry for %s exceeds the nlist table", image->name);
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    /* Compute the on-disk PC, and find the closest preceding symbol */
+    pl_vm_address_t slide_pc = pc - image->vmaddr_slide;
+    bool found = false;
+    pl_vm_address_t best_value = 0;
+    uint32_t best_strx = 0;
+    uint16_t best_desc = 0;
+
+    for (uint32_t i = start; i < start + count; i++) {
+        uint32_t n_strx;
+        uint8_t n_type;
+        uint16_t n_desc;
+        pl_vm_address_t n_value;
+
+        if (sizeof(void *) == 8) {
+            const struct nlist_64 *nl = (const struct nlist_64 *) symbols->nlists + i;
+            n_strx = nl->n_un.n_strx;
+            n_type = nl->n_type;
+            n_desc = nl->n_desc;
+            n_value = nl->n_value;
+        } else {
+            const struct nlist *nl = (const struct nlist *) symbols->nlists + i;
+            n_strx = nl->n_un.n_strx;
+            n_type = nl->n_type;
+            n_desc = (uint16_t) nl->n_desc;
+            n_value = nl->n_value;
+        }
+
+        /* Symbol must be within a section, and must not be a debugging entry. */
+        if ((n_type & N_TYPE) != N_SECT || ((n_type & N_STAB) != 0))
+            continue;
+
+        if (n_value > slide_pc || (found && n_value < best_value))
+            continue;
+
+        found = true;
+        best_value = n_value;
+        best_strx = n_strx;
+        best_desc = n_desc;
+    }
+
+    if (!found)
+        return PLCRASH_ENOTFOUND;
+
+    /* Verify that the name is NUL-terminated within the string table */
+    if (best_strx >= symbols->strings_size || memchr(symbols->strings + best_strx, '\0', symbols->strings_size - best_strx) == NULL) {
+        PLCF_DEBUG("Shared cache local symbol name offset %" PRIu32 " is outside of the string table", best_strx);
+        return PLCRASH_EINVALID_DATA;
+    }
+
+    /* We have to set the low-order bit ourselves for ARM THUMB functions. */
+    if (best_desc & N_ARM_THUMB_DEF)
+        best_value |= 1;
+
+    symbol_cb(best_value + image->vmaddr_slide, symbols->strings + best_strx, context);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Unmap any local symbols mapped by @a symbols.
+ *
+ * @param symbols The symbols instance to free.
+ */
+void plcrash_async_shared_cache_symbols_free (plcrash_async_shared_cache_symbols_t *symbols) {
+    if (symbols->mapped_addr != NULL) {
+        munmap(symbols->mapped_addr, symbols->mapped_length);
+        symbols->mapped_addr = NULL;
+    }
+}
+
+/**
+ * @}
+ */
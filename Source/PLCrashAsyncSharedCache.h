@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_SHARED_CACHE_H
+#define PLCRASH_ASYNC_SHARED_CACHE_H
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Location of the current process' dyld shared cache, and of the file containing the cache's local symbols.
+ *
+ * System libraries within the dyld shared cache have their local symbols stripped from their in-memory
+ * __LINKEDIT segments; the stripped symbols are instead recorded in a local symbols region of the shared cache
+ * file (or, on more recent releases, in a separate .symbols file) that is not mapped into the process.
+ *
+ * This structure is populated (non-async-safely) via plcrash_nasync_shared_cache_info_init(), prior to any crash,
+ * and then used at crash time to map the local symbols via plcrash_async_shared_cache_symbols_t.
+ */
+typedef struct plcrash_async_shared_cache_info {
+    /** A read-only file descriptor for the file containing the cache's local symbols, or -1. */
+    int fd;
+
+    /** The in-memory (slid) base address of the shared cache. */
+    pl_vm_address_t base_address;
+
+    /** The shared cache's vmaddr slide. */
+    pl_vm_off_t slide;
+
+    /** The file offset of the local symbols region within @a fd. */
+    uint64_t local_symbols_offset;
+
+    /** The size, in bytes, of the local symbols region. */
+    uint64_t local_symbols_size;
+
+    /** If true, the local symbols region uses 64-bit dylib offsets in its entry table. */
+    bool entries_64;
+} plcrash_async_shared_cache_info_t;
+
+/**
+ * @internal
+ *
+ * A lazily mapped view of a shared cache's local symbols. The local symbols are mapped on first use, and remain
+ * mapped until plcrash_async_shared_cache_symbols_free() is called; this is intended to be scoped to a single report.
+ */
+typedef struct plcrash_async_shared_cache_symbols {
+    /** The backing shared cache info, or NULL if none is available. Borrowed reference. */
+    const plcrash_async_shared_cache_info_t *info;
+
+    /** If true, a mapping has been attempted; @a mapped_addr is valid only if the attempt succeeded. */
+    bool attempted;
+
+    /** The page-aligned mapping of the local symbols region, or NULL if not mapped. */
+    void *mapped_addr;
+
+    /** The length of the mapping at @a mapped_addr. */
+    size_t mapped_length;
+
+    /** The nlist (or nlist_64) entries. */
+    const void *nlists;
+
+    /** The number of entries in @a nlists. */
+    uint32_t nlist_count;
+
+    /** The string table. */
+    const char *strings;
+
+    /** The size of the string table, in bytes. */
+    uint32_t strings_size;
+
+    /** The per-dylib entry table. */
+    const void *entries;
+
+    /** The number of entries in @a entries. */
+    uint32_t entries_count;
+} plcrash_async_shared_cache_symbols_t;
+
+plcrash_error_t plcrash_nasync_shared_cache_info_init (plcrash_async_shared_cache_info_t *info);
+void plcrash_nasync_shared_cache_info_free (plcrash_async_shared_cache_info_t *info);
+
+void plcrash_async_shared_cache_symbols_init (plcrash_async_shared_cache_symbols_t *symbols, const plcrash_async_shared_cache_info_t *info);
+plcrash_error_t plcrash_async_shared_cache_find_symbol (plcrash_async_shared_cache_symbols_t *symbols,
+                                                        plcrash_async_macho_t *image,
+                                                        pl_vm_address_t pc,
+                                                        pl_async_macho_found_symbol_cb symbol_cb,
+                                                        void *context);
+void plcrash_async_shared_cache_symbols_free (plcrash_async_shared_cache_symbols_t *symbols);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_SHARED_CACHE_H */
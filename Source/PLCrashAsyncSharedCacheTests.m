@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import <dlfcn.h>
+#import <string.h>
+
+#import "PLCrashAsyncSharedCache.h"
+
+@interface PLCrashAsyncSharedCacheTests : SenTestCase {
+    /** Allocator used by our images. */
+    plcrash_async_allocator_t *_allocator;
+}
+@end
+
+@implementation PLCrashAsyncSharedCacheTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+}
+
+- (void) tearDown {
+    plcrash_async_allocator_free(_allocator);
+}
+
+static void FoundSymbolCallback (pl_vm_address_t address, const char *name, void *ctx) {
+    pl_vm_address_t *result = ctx;
+    *result = address;
+}
+
+/**
+ * Verify that lookups without shared cache info fail cleanly.
+ */
+- (void) testNoInfo {
+    plcrash_async_shared_cache_symbols_t symbols;
+    plcrash_async_macho_t image;
+    Dl_info info;
+
+    STAssertTrue(dladdr((void *) strlen, &info) > 0, @"Could not fetch dyld info for strlen");
+    STAssertEquals(plcrash_async_macho_init(&image, _allocator, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS, @"Failed to initialize image");
+
+    plcrash_async_shared_cache_symbols_init(&symbols, NULL);
+
+    pl_vm_address_t found = 0;
+    STAssertEquals(plcrash_async_shared_cache_find_symbol(&symbols, &image, (pl_vm_address_t) strlen, FoundSymbolCallback, &found), PLCRASH_ENOTFOUND, @"Lookup should fail without shared cache info");
+    STAssertEquals(found, (pl_vm_address_t) 0, @"Callback should not have been called");
+
+    plcrash_async_shared_cache_symbols_free(&symbols);
+    plcrash_async_macho_free(&image);
+}
+
+/**
+ * Verify local symbol lookup within a shared cache image. The shared cache's local symbols are not available on all
+ * hosts; if they can't be located, the lookup portion of this test is skipped.
+ */
+- (void) testFindSymbol {
+    plcrash_async_shared_cache_info_t cacheInfo;
+    plcrash_error_t err = plcrash_nasync_shared_cache_info_init(&cacheInfo);
+    if (err != PLCRASH_ESUCCESS) {
+        STAssertTrue(err == PLCRASH_ENOTFOUND || err == PLCRASH_ENOTSUP, @"Unexpected error locating the shared cache: %d", err);
+        plcrash_nasync_shared_cache_info_free(&cacheInfo);
+        return;
+    }
+
+    STAssertTrue(cacheInfo.fd >= 0, @"No local symbols file descriptor");
+    STAssertNotEquals(cacheInfo.base_address, (pl_vm_address_t) 0, @"No shared cache base address");
+
+    /* libsystem is always within the shared cache */
+    Dl_info info;
+    STAssertTrue(dladdr((void *) strlen, &info) > 0, @"Could not fetch dyld info for strlen");
+
+    plcrash_async_macho_t image;
+    STAssertEquals(plcrash_async_macho_init(&image, _allocator, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS, @"Failed to initialize image");
+
+    plcrash_async_shared_cache_symbols_t symbols;
+    plcrash_async_shared_cache_symbols_init(&symbols, &cacheInfo);
+
+    /* The best local symbol must precede the PC, and fall within the image's text segment */
+    pl_vm_address_t pc = (pl_vm_address_t) strlen + 1;
+    pl_vm_address_t found = 0;
+    err = plcrash_async_shared_cache_find_symbol(&symbols, &image, pc, FoundSymbolCallback, &found);
+    if (err == PLCRASH_ESUCCESS) {
+        STAssertTrue(found <= pc, @"Symbol address follows the PC");
+        STAssertTrue(plcrash_async_macho_contains_address(&image, found), @"Symbol address is outside the image");
+    } else {
+        STAssertEquals(err, PLCRASH_ENOTFOUND, @"Unexpected lookup error");
+    }
+
+    /* The mapping must be retained across lookups */
+    void *mapped = symbols.mapped_addr;
+    plcrash_async_shared_cache_find_symbol(&symbols, &image, pc, FoundSymbolCallback, &found);
+    STAssertEquals(symbols.mapped_addr, mapped, @"Local symbols were remapped");
+
+    plcrash_async_shared_cache_symbols_free(&symbols);
+    STAssertNULL(symbols.mapped_addr, @"Local symbols were not unmapped");
+
+    plcrash_async_macho_free(&image);
+    plcrash_nasync_shared_cache_info_free(&cacheInfo);
+}
+
+@end
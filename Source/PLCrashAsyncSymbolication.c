@@ -29,6 +29,7 @@
 #include "PLCrashAsyncSymbolication.h"
 
 #include <inttypes.h>
+#include <string.h>
 
 /**
  * @internal
@@ -39,6 +40,10 @@
 /* Maximum symbol name size */
 #define SYMBOL_NAME_BUFLEN 256
 
+/* Maximum number of PCs resolved per symbol table pass by plcrash_async_find_symbols(); bounds the stack usage of
+ * the per-PC match arrays. */
+#define SYMBOL_BATCH_SIZE 32
+
 struct symbol_lookup_ctx {
     /** Buffer to which the symbol name should be written. */
     char buffer[SYMBOL_NAME_BUFLEN];
@@ -60,16 +65,294 @@ static void objc_symbol_callback (bool isClassMethod, plcrash_async_macho_string
  * @return An error code.
  */
 plcrash_error_t plcrash_async_symbol_cache_init (plcrash_async_symbol_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++) {
+        cache->readers[i].image = NULL;
+        cache->readers[i].last_used = 0;
+        cache->readers[i].charged = 0;
+        cache->readers[i].over_budget = false;
+    }
+    cache->reader_use_count = 0;
+    cache->budget = NULL;
+    cache->budget_id = PLCRASH_ASYNC_CACHE_ID_INVALID;
+    cache->pc_cache = NULL;
+    cache->pc_cache_failed = false;
+
+    plcrash_async_shared_cache_symbols_init(&cache->shared_cache_symbols, NULL);
+    plcrash_async_macho_section_cache_init(&cache->section_cache);
+
     return plcrash_async_objc_cache_init(&cache->objc_cache);
 }
 
+/**
+ * Set the shared cache info to be used by PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE lookups. The shared cache's local
+ * symbols will be mapped on first use, and unmapped by plcrash_async_symbol_cache_free().
+ *
+ * @param cache The cache to configure. No shared cache lookups may have been performed using this cache.
+ * @param info The shared cache info, or NULL. This must remain valid for the lifetime of @a cache.
+ */
+void plcrash_async_symbol_cache_set_shared_cache (plcrash_async_symbol_cache_t *cache, const plcrash_async_shared_cache_info_t *info) {
+    plcrash_async_shared_cache_symbols_free(&cache->shared_cache_symbols);
+    plcrash_async_shared_cache_symbols_init(&cache->shared_cache_symbols, info);
+}
+
+/**
+ * Pre-size @a cache's lookup tables prior to use from a crash handler, allowing symbol lookups to proceed without
+ * allocating.
+ *
+ * @param cache The cache to configure.
+ * @param class_count The number of Objective-C classes for which room should be reserved in the cache's class cache.
+ *
+ * @warning This function is not async-safe, and must be called prior to the cache being used from a crash handler.
+ */
+void plcrash_nasync_symbol_cache_reserve (plcrash_async_symbol_cache_t *cache, size_t class_count) {
+    plcrash_nasync_objc_cache_reserve_classes(&cache->objc_cache, class_count);
+}
+
+/**
+ * Charge the memory retained by @a cache -- its symbol table readers' LINKEDIT mappings and its Objective-C class
+ * cache -- to @a budget. Both are registered as evictable caches; if the budget's limit is reached, cached readers
+ * and class table entries may be released, and later recreated on demand.
+ *
+ * @param cache The cache to configure. No lookups may have been performed using this cache.
+ * @param budget The budget to charge. The budget must outlive @a cache.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be registered with @a budget.
+ *
+ * @warning This function is not async-safe, and may only be called once per cache.
+ */
+plcrash_error_t plcrash_async_symbol_cache_set_budget (plcrash_async_symbol_cache_t *cache, plcrash_async_cache_budget_t *budget) {
+    plcrash_error_t err;
+
+    PLCF_ASSERT(cache->budget == NULL);
+
+    if ((err = plcrash_async_cache_budget_register(budget, "symbol_readers", 0, true, &cache->budget_id)) != PLCRASH_ESUCCESS)
+        return err;
+
+    cache->budget = budget;
+    return plcrash_async_objc_cache_set_budget(&cache->objc_cache, budget);
+}
+
+/**
+ * @internal
+ *
+ * Free @a entry's reader, if any, releasing its budget charge.
+ */
+static void plcrash_async_symbol_cache_release_reader (plcrash_async_symbol_cache_t *cache, plcrash_async_symbol_cache_reader_t *entry) {
+    if (entry->image == NULL)
+        return;
+
+    plcrash_async_macho_symtab_reader_free(&entry->reader);
+    plcrash_async_cache_budget_release(cache->budget, cache->budget_id, entry->charged);
+
+    entry->image = NULL;
+    entry->charged = 0;
+    entry->over_budget = false;
+}
+
 /**
  * Free a symbol-finding context object.
  *
  * @param cache A pointer to the cache object to free.
  */
 void plcrash_async_symbol_cache_free (plcrash_async_symbol_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++)
+        plcrash_async_symbol_cache_release_reader(cache, &cache->readers[i]);
+
+    plcrash_async_shared_cache_symbols_free(&cache->shared_cache_symbols);
+    plcrash_async_macho_section_cache_free(&cache->section_cache);
     plcrash_async_objc_cache_free(&cache->objc_cache);
+
+    if (cache->pc_cache != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) cache->pc_cache, sizeof(*cache->pc_cache));
+
+    if (cache->budget != NULL)
+        plcrash_async_cache_budget_unregister(cache->budget, cache->budget_id);
+}
+
+/**
+ * @internal
+ *
+ * Fetch a symbol table reader for @a image from @a cache, initializing a new reader -- and evicting the least
+ * recently used reader, if necessary -- if @a image is not already cached.
+ *
+ * @param cache The cache from which the reader should be fetched.
+ * @param image The image for which a reader should be returned.
+ * @param reader On success, will be set to a reader owned by @a cache. The reader remains valid until the next call
+ * to this function or plcrash_async_symbol_cache_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or one of the plcrash_error_t error values if the reader could not
+ * be initialized.
+ */
+static plcrash_error_t plcrash_async_symbol_cache_get_reader (plcrash_async_symbol_cache_t *cache,
+                                                              plcrash_async_macho_t *image,
+                                                              plcrash_async_macho_symtab_reader_t **reader)
+{
+    plcrash_async_symbol_cache_reader_t *entry = NULL;
+    plcrash_async_symbol_cache_reader_t *hit = NULL;
+    plcrash_error_t err;
+
+    cache->reader_use_count++;
+
+    /* Look for an existing reader */
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++) {
+        if (cache->readers[i].image == image) {
+            hit = &cache->readers[i];
+            break;
+        }
+    }
+
+    /* Release the readers that the budget has asked us to give up: all other readers if another cache requires our
+     * memory, and any reader retained beyond the budget by a previous lookup. */
+    bool evict = plcrash_async_cache_budget_record(cache->budget, cache->budget_id, hit != NULL);
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++) {
+        plcrash_async_symbol_cache_reader_t *candidate = &cache->readers[i];
+        if (candidate != hit && (evict || candidate->over_budget))
+            plcrash_async_symbol_cache_release_reader(cache, candidate);
+    }
+
+    if (hit != NULL) {
+        hit->last_used = cache->reader_use_count;
+        *reader = &hit->reader;
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Select an entry, preferring unused entries, followed by the least recently used entry */
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++) {
+        plcrash_async_symbol_cache_reader_t *candidate = &cache->readers[i];
+        if (entry == NULL || (entry->image != NULL && (candidate->image == NULL || candidate->last_used < entry->last_used)))
+            entry = candidate;
+    }
+
+    /* Evict the selected entry */
+    plcrash_async_symbol_cache_release_reader(cache, entry);
+
+    /* Initialize a new reader */
+    if ((err = plcrash_async_macho_symtab_reader_init(&entry->reader, image)) != PLCRASH_ESUCCESS)
+        return err;
+
+    entry->image = image;
+    entry->last_used = cache->reader_use_count;
+    *reader = &entry->reader;
+
+    /* Only a local remapping of the symbol table retains memory; a reference to our own task's pages does not. The
+     * reader's string table window is charged at its maximum size, as it is remapped on demand. If the mapping can't be
+     * charged, the reader is still returned for this lookup, but will not be retained. */
+    plcrash_async_mobject_t *mobj = &entry->reader.symtab_mobj;
+    if (mobj->remapped) {
+        size_t charge = mobj->vm_length + PLCRASH_ASYNC_MACHO_STRING_WINDOW_SIZE;
+        if (plcrash_async_cache_budget_charge(cache->budget, cache->budget_id, charge) == PLCRASH_ESUCCESS)
+            entry->charged = charge;
+        else
+            entry->over_budget = true;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return @a cache's PC cache entry for @a pc, or NULL if the PC cache is unavailable. The entry may hold the result
+ * of a different PC or strategy.
+ */
+static plcrash_async_symbol_pc_cache_entry_t *plcrash_async_symbol_pc_cache_entry (plcrash_async_symbol_cache_t *cache, pl_vm_address_t pc) {
+    if (cache->pc_cache == NULL)
+        return NULL;
+
+    /* Fibonacci hashing; instruction addresses share their low bits, and are discarded */
+    uint64_t hash = ((uint64_t) pc >> 2) * 0x9E3779B97F4A7C15ULL;
+    return &cache->pc_cache->entries[hash >> (64 - __builtin_ctz(PLCRASH_ASYNC_SYMBOL_PC_CACHE_SIZE))];
+}
+
+/**
+ * @internal
+ *
+ * Look up the cached result for @a pc and @a strategy in @a cache.
+ *
+ * @param cache The symbol cache.
+ * @param strategy The lookup strategy.
+ * @param pc The PC to look up.
+ * @param[out] result On success, the cached lookup result.
+ * @param[out] address On success, the cached symbol address. Only valid if @a result is PLCRASH_ESUCCESS.
+ * @param[out] name On success, a borrowed reference to the cached symbol name, valid until the next lookup using
+ * @a cache. Only valid if @a result is PLCRASH_ESUCCESS.
+ *
+ * @return Returns true if a cached result was found.
+ */
+static bool plcrash_async_symbol_pc_cache_lookup (plcrash_async_symbol_cache_t *cache, plcrash_async_symbol_strategy_t strategy, pl_vm_address_t pc,
+                                                  plcrash_error_t *result, pl_vm_address_t *address, const char **name)
+{
+    plcrash_async_symbol_pc_cache_entry_t *entry = plcrash_async_symbol_pc_cache_entry(cache, pc);
+    if (entry == NULL || entry->pc != pc || pc == 0x0 || entry->strategy != strategy)
+        return false;
+
+    *result = entry->result;
+    if (entry->result == PLCRASH_ESUCCESS) {
+        *address = entry->symbol_address;
+        *name = cache->pc_cache->names + entry->name_offset;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Record the lookup result for @a pc and @a strategy in @a cache, allocating the PC cache if necessary.
+ *
+ * @param cache The symbol cache.
+ * @param strategy The lookup strategy.
+ * @param pc The PC that was looked up.
+ * @param result The lookup result.
+ * @param address The symbol address. Ignored unless @a result is PLCRASH_ESUCCESS.
+ * @param name The symbol name, which will be copied. Ignored unless @a result is PLCRASH_ESUCCESS.
+ */
+static void plcrash_async_symbol_pc_cache_insert (plcrash_async_symbol_cache_t *cache, plcrash_async_symbol_strategy_t strategy, pl_vm_address_t pc,
+                                                  plcrash_error_t result, pl_vm_address_t address, const char *name)
+{
+    if (pc == 0x0)
+        return;
+
+    /* Allocate the cache on first use. vm_allocate() guarantees zero-filled pages, and a zero PC marks an unused entry. */
+    if (cache->pc_cache == NULL) {
+        if (cache->pc_cache_failed)
+            return;
+
+        vm_address_t addr = 0x0;
+        kern_return_t kr = vm_allocate(mach_task_self(), &addr, sizeof(*cache->pc_cache), VM_FLAGS_ANYWHERE);
+        if (kr != KERN_SUCCESS) {
+            PLCF_DEBUG("vm_allocate failed with error %x, symbol lookups will not be cached", kr);
+            cache->pc_cache_failed = true;
+            return;
+        }
+
+        cache->pc_cache = (plcrash_async_symbol_pc_cache_t *) addr;
+    }
+
+    plcrash_async_symbol_pc_cache_t *pc_cache = cache->pc_cache;
+    plcrash_async_symbol_pc_cache_entry_t *entry = plcrash_async_symbol_pc_cache_entry(cache, pc);
+
+    if (result == PLCRASH_ESUCCESS) {
+        size_t length = strlen(name) + 1;
+
+        /* If the name storage is exhausted, start over */
+        if (length > sizeof(pc_cache->names) - pc_cache->names_used) {
+            plcrash_async_memset(pc_cache->entries, 0, sizeof(pc_cache->entries));
+            pc_cache->names_used = 0;
+
+            if (length > sizeof(pc_cache->names))
+                return;
+        }
+
+        plcrash_async_memcpy(pc_cache->names + pc_cache->names_used, name, length);
+        entry->name_offset = pc_cache->names_used;
+        entry->symbol_address = address;
+        pc_cache->names_used += (uint32_t) length;
+    }
+
+    entry->pc = pc;
+    entry->strategy = strategy;
+    entry->result = result;
 }
 
 /**
@@ -95,21 +378,49 @@ plcrash_error_t plcrash_async_find_symbol (plcrash_async_macho_t *image,
     struct symbol_lookup_ctx lookup_ctx;
     plcrash_error_t machoErr = PLCRASH_ENOTFOUND;
     plcrash_error_t objcErr = PLCRASH_ENOTFOUND;
+    plcrash_error_t cacheErr = PLCRASH_ENOTFOUND;
+    plcrash_error_t embeddedErr = PLCRASH_ENOTFOUND;
+
+    /* Return the cached result for a previously resolved PC */
+    {
+        plcrash_error_t cached;
+        pl_vm_address_t address;
+        const char *name;
+        if (plcrash_async_symbol_pc_cache_lookup(cache, strategy, pc, &cached, &address, &name)) {
+            if (cached == PLCRASH_ESUCCESS)
+                callback(address, name, ctx);
+            return cached;
+        }
+    }
 
     lookup_ctx.symbol_address = 0x0;
     lookup_ctx.found = false;
 
     /* Perform lookups; our callbacks will only update the lookup_ctx if they find a better match than the
      * previously run callbacks */
-    if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE)
-        machoErr = plcrash_async_macho_find_symbol_by_pc(image, pc, macho_symbol_callback, &lookup_ctx);
+    if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE) {
+        plcrash_async_macho_symtab_reader_t *reader;
+        if ((machoErr = plcrash_async_symbol_cache_get_reader(cache, image, &reader)) == PLCRASH_ESUCCESS)
+            machoErr = plcrash_async_macho_symtab_reader_find_symbol_by_pc(reader, pc, macho_symbol_callback, &lookup_ctx);
+    }
+
+    /* Local symbols stripped from shared cache images; the callback will only prefer these over the symbol table
+     * result if they're closer to the PC */
+    if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE)
+        cacheErr = plcrash_async_shared_cache_find_symbol(&cache->shared_cache_symbols, image, pc, macho_symbol_callback, &lookup_ctx);
     
+    /* Build-time symbols embedded in stripped images */
+    if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_EMBEDDED)
+        embeddedErr = plcrash_async_embedded_symbols_find_symbol(&cache->section_cache, image, pc, macho_symbol_callback, &lookup_ctx);
+
     if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC)
         objcErr = plcrash_async_objc_find_method(image, &cache->objc_cache, pc, objc_symbol_callback, &lookup_ctx);
 
-    if (machoErr != PLCRASH_ESUCCESS && objcErr != PLCRASH_ESUCCESS) {
+    if (machoErr != PLCRASH_ESUCCESS && objcErr != PLCRASH_ESUCCESS && cacheErr != PLCRASH_ESUCCESS && embeddedErr != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Could not find symbol for PC %" PRIx64 " image %p", (uint64_t) pc, image);
-        PLCF_DEBUG("pl_async_macho_find_symbol error %d, pl_async_objc_find_method error %d", machoErr, objcErr);
+        PLCF_DEBUG("pl_async_macho_find_symbol error %d, pl_async_objc_find_method error %d, shared cache error %d, embedded symbols error %d",
+                   machoErr, objcErr, cacheErr, embeddedErr);
+        plcrash_async_symbol_pc_cache_insert(cache, strategy, pc, machoErr, 0x0, NULL);
         return machoErr;
     }
 
@@ -120,10 +431,135 @@ plcrash_error_t plcrash_async_find_symbol (plcrash_async_macho_t *image,
         return PLCRASH_EINTERNAL;
     }
 
+    plcrash_async_symbol_pc_cache_insert(cache, strategy, pc, PLCRASH_ESUCCESS, lookup_ctx.symbol_address, lookup_ctx.buffer);
     callback(lookup_ctx.symbol_address, lookup_ctx.buffer, ctx);
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Find the best-guess matching symbol names for all of @a pcs within @a image. The results are identical to those of
+ * calling plcrash_async_find_symbol() for each PC, but the image's symbol table is scanned once per batch of PCs,
+ * rather than once per PC; the PCs are sorted, and merge-joined against the symbol table entries -- and the image's
+ * Objective-C methods -- in a single pass.
+ *
+ * @param image The Mach-O image to search for the symbols. All @a pcs must fall within @a image.
+ * @param strategy The look-up strategy to be used to find the symbols.
+ * @param cache The task-specific cache to use for lookups.
+ * @param pcs The program counter (instruction pointer) addresses for which symbols will be searched, in any order.
+ * @param count The number of entries in @a pcs.
+ * @param callback The callback to be issued for each PC for which a matching symbol is found, with the PC's index
+ * within @a pcs. PCs for which no symbol is found are not reported.
+ * @param ctx The context to be provided to @a callback.
+ *
+ * @return Returns PLCRASH_ESUCCESS if a symbol was found for any PC, or PLCRASH_ENOTFOUND otherwise.
+ *
+ * @warning This method is async-safe.
+ */
+plcrash_error_t plcrash_async_find_symbols (plcrash_async_macho_t *image,
+                                            plcrash_async_symbol_strategy_t strategy,
+                                            plcrash_async_symbol_cache_t *cache,
+                                            const pl_vm_address_t *pcs,
+                                            size_t count,
+                                            plcrash_async_found_symbols_cb callback,
+                                            void *ctx)
+{
+    bool any_found = false;
+
+    for (size_t base = 0; base < count; base += SYMBOL_BATCH_SIZE) {
+        uint32_t batch_count = (uint32_t) (count - base < SYMBOL_BATCH_SIZE ? count - base : SYMBOL_BATCH_SIZE);
+        uint32_t order[SYMBOL_BATCH_SIZE];
+        pl_vm_address_t sorted_pcs[SYMBOL_BATCH_SIZE];
+        plcrash_async_macho_symtab_entry_t symbols[SYMBOL_BATCH_SIZE];
+        bool found[SYMBOL_BATCH_SIZE];
+        plcrash_async_objc_method_index_entry_t methods[SYMBOL_BATCH_SIZE];
+        bool found_methods[SYMBOL_BATCH_SIZE];
+        plcrash_async_macho_symtab_reader_t *reader = NULL;
+
+        /* Sort the batch's uncached PCs by PC, reporting the cached PCs directly; the batch is small, and an insertion
+         * sort suffices */
+        uint32_t sorted_count = 0;
+        for (uint32_t i = 0; i < batch_count; i++) {
+            pl_vm_address_t pc = pcs[base + i];
+
+            plcrash_error_t cached;
+            pl_vm_address_t address;
+            const char *name;
+            if (plcrash_async_symbol_pc_cache_lookup(cache, strategy, pc, &cached, &address, &name)) {
+                if (cached == PLCRASH_ESUCCESS) {
+                    callback(base + i, address, name, ctx);
+                    any_found = true;
+                }
+                continue;
+            }
+
+            uint32_t j = sorted_count;
+            for (; j > 0 && sorted_pcs[j - 1] > pc; j--) {
+                sorted_pcs[j] = sorted_pcs[j - 1];
+                order[j] = order[j - 1];
+            }
+
+            sorted_pcs[j] = pc;
+            order[j] = i;
+            found[sorted_count] = false;
+            found_methods[sorted_count] = false;
+            sorted_count++;
+        }
+
+        if (sorted_count == 0)
+            continue;
+        batch_count = sorted_count;
+
+        /* Resolve the whole batch against the symbol table in a single pass */
+        if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE) {
+            if (plcrash_async_symbol_cache_get_reader(cache, image, &reader) == PLCRASH_ESUCCESS)
+                plcrash_async_macho_symtab_reader_find_symbols_by_pc(reader, sorted_pcs, batch_count, symbols, found);
+        }
+
+        /* Likewise, resolve the whole batch against a single traversal of the image's ObjC metadata */
+        if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC)
+            plcrash_async_objc_find_methods(image, &cache->objc_cache, sorted_pcs, batch_count, methods, found_methods);
+
+        /* Combine the results, applying the remaining strategies to each PC and preferring the closest match, as in
+         * plcrash_async_find_symbol() */
+        for (uint32_t i = 0; i < batch_count; i++) {
+            struct symbol_lookup_ctx lookup_ctx;
+            pl_vm_address_t pc = sorted_pcs[i];
+
+            lookup_ctx.symbol_address = 0x0;
+            lookup_ctx.found = false;
+
+            if (found[i]) {
+                const char *sym_name = plcrash_async_macho_symtab_reader_symbol_name(reader, symbols[i].n_strx);
+                if (sym_name != NULL)
+                    macho_symbol_callback(symbols[i].normalized_value + image->vmaddr_slide, sym_name, &lookup_ctx);
+                else
+                    PLCF_DEBUG("Failed to read symbol name\n");
+            }
+
+            if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE)
+                plcrash_async_shared_cache_find_symbol(&cache->shared_cache_symbols, image, pc, macho_symbol_callback, &lookup_ctx);
+
+            if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_EMBEDDED)
+                plcrash_async_embedded_symbols_find_symbol(&cache->section_cache, image, pc, macho_symbol_callback, &lookup_ctx);
+
+            if (found_methods[i])
+                plcrash_async_objc_report_method(image, &cache->objc_cache, &methods[i], objc_symbol_callback, &lookup_ctx);
+
+            if (!lookup_ctx.found) {
+                PLCF_DEBUG("Could not find symbol for PC %" PRIx64 " image %p", (uint64_t) pc, image);
+                plcrash_async_symbol_pc_cache_insert(cache, strategy, pc, PLCRASH_ENOTFOUND, 0x0, NULL);
+                continue;
+            }
+
+            plcrash_async_symbol_pc_cache_insert(cache, strategy, pc, PLCRASH_ESUCCESS, lookup_ctx.symbol_address, lookup_ctx.buffer);
+            callback(base + order[i], lookup_ctx.symbol_address, lookup_ctx.buffer, ctx);
+            any_found = true;
+        }
+    }
+
+    return any_found ? PLCRASH_ESUCCESS : PLCRASH_ENOTFOUND;
+}
+
 /**
  * Append a character to the given @a str, enforcing byte @a limit.
  *
@@ -43,6 +43,8 @@ extern "C" {
 
 #include "PLCrashAsyncMachOImage.h"
 #include "PLCrashAsyncObjCSection.h"
+#include "PLCrashAsyncSharedCache.h"
+#include "PLCrashAsyncEmbeddedSymbols.h"
     
 /**
  * @internal
@@ -71,13 +73,103 @@ typedef enum {
      * it may return incorrect data should the runtime be changed incompatibly.
      */
     PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC = 1 << 1,
+
+    /**
+     * Use the dyld shared cache's local symbols to find symbol names for system libraries, whose local
+     * symbols are stripped from their in-memory symbol tables. This requires that shared cache info be
+     * provided via plcrash_async_symbol_cache_set_shared_cache().
+     */
+    PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE = 1 << 2,
+
+    /**
+     * Use the symbol table embedded at build time in an image's __PLCRASH,__syms section, as generated by
+     * the plcrashutil embed-symbols command. This recovers the names of local symbols removed from stripped
+     * binaries.
+     */
+    PLCRASH_ASYNC_SYMBOL_STRATEGY_EMBEDDED = 1 << 3,
     
     /**
      * Enable all available symbolication strategies.
      */
-    PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL = (PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE|PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC)
+    PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL = (PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE|PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC|PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE|
+                                         PLCRASH_ASYNC_SYMBOL_STRATEGY_EMBEDDED)
 } plcrash_async_symbol_strategy_t;
 
+/** The maximum number of symbol table readers retained by a plcrash_async_symbol_cache_t. */
+#define PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT 4
+
+/**
+ * @internal
+ *
+ * A cached symbol table reader.
+ */
+typedef struct plcrash_async_symbol_cache_reader {
+    /** The image for which @a reader was initialized, or NULL if this entry is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The symbol table reader. Only valid if @a image is non-NULL. */
+    plcrash_async_macho_symtab_reader_t reader;
+
+    /** The value of the cache's use counter at the time this entry was last used. */
+    uint64_t last_used;
+
+    /** The number of bytes charged to the cache's budget for this reader's symbol and string table mappings. */
+    size_t charged;
+
+    /** If true, the reader's mapping could not be charged to the cache's budget, and the reader will be released on
+     * the next lookup. */
+    bool over_budget;
+} plcrash_async_symbol_cache_reader_t;
+
+/** The number of entries in a plcrash_async_symbol_cache_t's PC cache. Must be a power of two. */
+#define PLCRASH_ASYNC_SYMBOL_PC_CACHE_SIZE 512
+
+/** The number of bytes of symbol name storage in a plcrash_async_symbol_cache_t's PC cache. */
+#define PLCRASH_ASYNC_SYMBOL_PC_CACHE_NAMES_SIZE (32 * 1024)
+
+/**
+ * @internal
+ *
+ * A cached symbol lookup result.
+ */
+typedef struct plcrash_async_symbol_pc_cache_entry {
+    /** The PC for which the symbol was looked up, or 0 if this entry is unused. */
+    pl_vm_address_t pc;
+
+    /** The strategy with which the symbol was looked up. */
+    plcrash_async_symbol_strategy_t strategy;
+
+    /** The result of the lookup. Lookups that found no symbol are cached, too. */
+    plcrash_error_t result;
+
+    /** The symbol's start address. Only valid if result is PLCRASH_ESUCCESS. */
+    pl_vm_address_t symbol_address;
+
+    /** The offset of the symbol's NUL-terminated name within the PC cache's name storage. Only valid if result is
+     * PLCRASH_ESUCCESS. */
+    uint32_t name_offset;
+} plcrash_async_symbol_pc_cache_entry_t;
+
+/**
+ * @internal
+ *
+ * A direct-mapped cache of symbol lookup results, keyed by PC. The same return addresses recur across threads and
+ * in the uncaught exception's backtrace; a repeated PC is resolved by a single probe.
+ *
+ * Names are appended to a fixed-size buffer; once the buffer is exhausted, the cache is emptied, and refilled from
+ * subsequent lookups.
+ */
+typedef struct plcrash_async_symbol_pc_cache {
+    /** The cache entries. */
+    plcrash_async_symbol_pc_cache_entry_t entries[PLCRASH_ASYNC_SYMBOL_PC_CACHE_SIZE];
+
+    /** The number of bytes of names in use. */
+    uint32_t names_used;
+
+    /** Symbol name storage. */
+    char names[PLCRASH_ASYNC_SYMBOL_PC_CACHE_NAMES_SIZE];
+} plcrash_async_symbol_pc_cache_t;
+
 /**
  * @internal
  *
@@ -90,9 +182,38 @@ typedef enum {
 typedef struct plcrash_async_symbol_cache {
     /** Objective-C look-up cache. */
     plcrash_async_objc_cache_t objc_cache;
+
+    /** Least-recently-used cache of open symbol table readers, avoiding a remap of the symbol table
+     * for consecutive lookups within the same image. */
+    plcrash_async_symbol_cache_reader_t readers[PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT];
+
+    /** Monotonically increasing use counter, used to find the least-recently-used reader. */
+    uint64_t reader_use_count;
+
+    /** Lazily mapped shared cache local symbols. */
+    plcrash_async_shared_cache_symbols_t shared_cache_symbols;
+
+    /** Section mappings used by embedded symbol lookups and, via plframe_cursor_set_section_cache(), by the frame
+     * readers. Emptied at the end of each report. */
+    plcrash_async_macho_section_cache_t section_cache;
+
+    /** The budget charged for the symbol table readers, or NULL. See plcrash_async_symbol_cache_set_budget(). */
+    plcrash_async_cache_budget_t *budget;
+
+    /** The symbol table readers' registration with budget, or PLCRASH_ASYNC_CACHE_ID_INVALID. */
+    plcrash_async_cache_id_t budget_id;
+
+    /** Lookup results by PC, allocated via vm_allocate() on first use, or NULL. */
+    plcrash_async_symbol_pc_cache_t *pc_cache;
+
+    /** If true, pc_cache could not be allocated, and the allocation will not be retried. */
+    bool pc_cache_failed;
 } plcrash_async_symbol_cache_t;
 
 plcrash_error_t plcrash_async_symbol_cache_init (plcrash_async_symbol_cache_t *cache);
+void plcrash_async_symbol_cache_set_shared_cache (plcrash_async_symbol_cache_t *cache, const plcrash_async_shared_cache_info_t *info);
+void plcrash_nasync_symbol_cache_reserve (plcrash_async_symbol_cache_t *cache, size_t class_count);
+plcrash_error_t plcrash_async_symbol_cache_set_budget (plcrash_async_symbol_cache_t *cache, plcrash_async_cache_budget_t *budget);
 void plcrash_async_symbol_cache_free (plcrash_async_symbol_cache_t *cache);
 
 
@@ -112,6 +233,25 @@ plcrash_error_t plcrash_async_find_symbol(plcrash_async_macho_t *image,
                                           pl_vm_address_t pc,
                                           plcrash_async_found_symbol_cb callback,
                                           void *ctx);
+
+/**
+ * Prototype of a callback function used to execute user code with a symbol fetched by a batch lookup.
+ *
+ * @param index The index of the PC for which the symbol was found.
+ * @param address The symbol address.
+ * @param name The symbol name. The callback is responsible for copying this value, as its backing storage is not guaranteed to exist
+ * after the callback returns.
+ * @param ctx The API client's supplied context value.
+ */
+typedef void (*plcrash_async_found_symbols_cb)(size_t index, pl_vm_address_t address, const char *name, void *ctx);
+
+plcrash_error_t plcrash_async_find_symbols(plcrash_async_macho_t *image,
+                                           plcrash_async_symbol_strategy_t strategy,
+                                           plcrash_async_symbol_cache_t *cache,
+                                           const pl_vm_address_t *pcs,
+                                           size_t count,
+                                           plcrash_async_found_symbols_cb callback,
+                                           void *ctx);
     
 #ifdef __cplusplus
 }
@@ -127,6 +127,149 @@ void PLCrashAsyncLocalSymbolicationTestsDummyFunction(void) {}
     plcrash_async_symbol_cache_free(&findContext);
 }
 
+/* testFindSymbols callback handling */
+
+struct testFindSymbols_cb_ctx {
+    pl_vm_address_t addrs[2];
+    char *names[2];
+};
+
+static void testFindSymbols_cb (size_t index, pl_vm_address_t address, const char *name, void *ctx) {
+    struct testFindSymbols_cb_ctx *cb_ctx = ctx;
+    cb_ctx->addrs[index] = address;
+    cb_ctx->names[index] = strdup(name);
+}
+
+/**
+ * Verify that a batch lookup reports each PC's symbol against the PC's index, regardless of the PCs' order.
+ */
+- (void) testFindSymbols {
+    struct testFindSymbols_cb_ctx ctx = {};
+    plcrash_error_t err;
+
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize the symbol cache");
+
+    /* Supply the PCs in descending order */
+    pl_vm_address_t localPC = [[[NSThread callStackReturnAddresses] objectAtIndex: 0] longLongValue];
+    pl_vm_address_t dummyPC = (pl_vm_address_t) PLCrashAsyncLocalSymbolicationTestsDummyFunction;
+    pl_vm_address_t pcs[2] = { localPC > dummyPC ? localPC : dummyPC, localPC > dummyPC ? dummyPC : localPC };
+
+    err = plcrash_async_find_symbols(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs, 2, testFindSymbols_cb, &ctx);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbols");
+
+    for (size_t i = 0; i < 2; i++) {
+        struct testFindSymbol_cb_ctx single = {};
+        err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs[i], testFindSymbol_cb, &single);
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+
+        STAssertEquals(ctx.addrs[i], single.addr, @"Batch lookup returned a different address");
+        STAssertEqualCStrings(ctx.names[i], single.name, @"Batch lookup returned a different name");
+
+        free(single.name);
+        free(ctx.names[i]);
+    }
+
+    plcrash_async_symbol_cache_free(&findContext);
+}
+
+/**
+ * Verify that repeated lookups of a PC are served from the PC cache, and that cached results are not shared
+ * between strategies.
+ */
+- (void) testPCCache {
+    struct testFindSymbol_cb_ctx first = {};
+    struct testFindSymbol_cb_ctx second = {};
+    struct testFindSymbol_cb_ctx symtab = {};
+    plcrash_error_t err;
+
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize the symbol cache");
+    STAssertNULL(findContext.pc_cache, @"The PC cache should be allocated on first use");
+
+    pl_vm_address_t localPC = [[[NSThread callStackReturnAddresses] objectAtIndex: 0] longLongValue];
+    err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, localPC, testFindSymbol_cb, &first);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+    STAssertNotNULL(findContext.pc_cache, @"The PC cache was not allocated");
+
+    err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, localPC, testFindSymbol_cb, &second);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find cached symbol");
+    STAssertEquals(first.addr, second.addr, @"Cached lookup returned a different address");
+    STAssertEqualCStrings(first.name, second.name, @"Cached lookup returned a different name");
+
+    /* A symbol table lookup must not return the cached Objective-C method name */
+    err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, &findContext, localPC, testFindSymbol_cb, &symtab);
+    if (err == PLCRASH_ESUCCESS)
+        STAssertFalse(strcmp(first.name, symtab.name) == 0, @"Symbol table lookup returned the cached ObjC result");
+
+    /* A batch lookup must report cached and uncached PCs alike */
+    struct testFindSymbols_cb_ctx batch = {};
+    pl_vm_address_t pcs[2] = { localPC, (pl_vm_address_t) PLCrashAsyncLocalSymbolicationTestsDummyFunction };
+    err = plcrash_async_find_symbols(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs, 2, testFindSymbols_cb, &batch);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbols");
+    STAssertEqualCStrings(batch.names[0], first.name, @"Batch lookup returned a different name for a cached PC");
+    STAssertEqualCStrings(batch.names[1], "_PLCrashAsyncLocalSymbolicationTestsDummyFunction", @"Batch lookup returned the wrong name");
+
+    free(first.name);
+    free(second.name);
+    free(symtab.name);
+    free(batch.names[0]);
+    free(batch.names[1]);
+
+    plcrash_async_symbol_cache_free(&findContext);
+}
+
+/**
+ * Verify that symbol table readers are cached across lookups, and that the least recently used reader is evicted.
+ */
+- (void) testReaderCache {
+    struct testFindSymbol_cb_ctx ctx = {};
+    plcrash_error_t err;
+
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize symbol cache");
+
+    /* Create distinct image instances, one more than the reader cache can hold */
+    plcrash_async_macho_t images[PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT + 1];
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT + 1; i++) {
+        err = plcrash_async_macho_init(&images[i], _allocator, mach_task_self(), _image.name, _image.header_addr);
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize image");
+    }
+
+    /* Fill the cache; repeated lookups in the same image must reuse the cached reader */
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT; i++) {
+        for (int j = 0; j < 2; j++) {
+            err = plcrash_async_find_symbol(&images[i], PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, &findContext, (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction, testFindSymbol_cb, &ctx);
+            STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+            STAssertEqualCStrings(ctx.name, "_PLCrashAsyncLocalSymbolicationTestsDummyFunction", @"Got wrong symbol name");
+            free(ctx.name);
+        }
+
+        STAssertEquals(findContext.readers[i].image, &images[i], @"Reader was not cached");
+    }
+
+    /* Touch the first image, making the second the least recently used, and then force an eviction */
+    err = plcrash_async_find_symbol(&images[0], PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, &findContext, (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction, testFindSymbol_cb, &ctx);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+    free(ctx.name);
+
+    err = plcrash_async_find_symbol(&images[PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT], PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, &findContext, (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction, testFindSymbol_cb, &ctx);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+    STAssertEqualCStrings(ctx.name, "_PLCrashAsyncLocalSymbolicationTestsDummyFunction", @"Got wrong symbol name");
+    free(ctx.name);
+
+    STAssertEquals(findContext.readers[0].image, &images[0], @"Recently used reader was evicted");
+    STAssertEquals(findContext.readers[1].image, &images[PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT], @"Least recently used reader was not evicted");
+
+    plcrash_async_symbol_cache_free(&findContext);
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_SYMBOL_CACHE_READER_COUNT + 1; i++)
+        plcrash_async_macho_free(&images[i]);
+}
+
 - (void) testStrategyFlags {
     struct testFindSymbol_cb_ctx ctx = {};
     plcrash_error_t err;
@@ -28,9 +28,11 @@
 
 #import "SenTestCompat.h"
 #import "PLCrashAsync.h"
+#import "PLCrashAsyncCompressor.h"
 
 #import <fcntl.h>
 #import <sys/stat.h>
+#import <sys/mman.h>
 
 @interface PLCrashAsyncTests : SenTestCase {
 @private
@@ -159,6 +161,79 @@
     STAssertEquals(plcrash_async_strncmp("aaaaaaaaaa", "aaaaaaaaab", 9), 0, @"String prefixes should be equal");
 }
 
+/**
+ * Compare the word-at-a-time string primitives against libc across all relative alignments, and with strings ending
+ * and differing at every position within a word.
+ */
+- (void) testStringWordBoundaries {
+    char b1[64];
+    char b2[64];
+
+    for (size_t o1 = 0; o1 < sizeof(uintptr_t); o1++) {
+        for (size_t o2 = 0; o2 < sizeof(uintptr_t); o2++) {
+            for (size_t len = 0; len < 3 * sizeof(uintptr_t); len++) {
+                /* Fill the bytes following the terminator, which must not affect the result */
+                memset(b1, 'x', sizeof(b1));
+                memset(b2, 'y', sizeof(b2));
+                memset(b1 + o1, 'a', len);
+                memset(b2 + o2, 'a', len);
+                b1[o1 + len] = '\0';
+                b2[o2 + len] = '\0';
+
+                STAssertEquals(plcrash_async_strcmp(b1 + o1, b2 + o2), 0, @"Strings should be equal (%zu, %zu, %zu)", o1, o2, len);
+                STAssertEquals(plcrash_async_strncmp(b1 + o1, b2 + o2, len + 8), 0, @"Strings should be equal (%zu, %zu, %zu)", o1, o2, len);
+
+                if (len == 0)
+                    continue;
+
+                /* Differ at the final character */
+                b2[o2 + len - 1] = 'b';
+                STAssertTrue(plcrash_async_strcmp(b1 + o1, b2 + o2) < 0, @"Strings compared incorrectly (%zu, %zu, %zu)", o1, o2, len);
+                STAssertTrue(plcrash_async_strncmp(b1 + o1, b2 + o2, len) < 0, @"Strings compared incorrectly (%zu, %zu, %zu)", o1, o2, len);
+                STAssertEquals(plcrash_async_strncmp(b1 + o1, b2 + o2, len - 1), 0, @"Prefixes should be equal (%zu, %zu, %zu)", o1, o2, len);
+
+                /* A prefix of a longer string */
+                b2[o2 + len - 1] = 'a';
+                b2[o2 + len] = 'a';
+                b2[o2 + len + 1] = '\0';
+                STAssertTrue(plcrash_async_strcmp(b1 + o1, b2 + o2) < 0, @"Strings compared incorrectly (%zu, %zu, %zu)", o1, o2, len);
+                STAssertTrue(plcrash_async_strcmp(b2 + o2, b1 + o1) > 0, @"Strings compared incorrectly (%zu, %zu, %zu)", o1, o2, len);
+            }
+        }
+    }
+
+    STAssertEquals(plcrash_async_strncmp("a", "b", 0), 0, @"Zero-length comparison should be equal");
+}
+
+/**
+ * Verify memcpy() and memset() across all relative alignments and lengths spanning multiple words.
+ */
+- (void) testMemoryWordBoundaries {
+    uint8_t src[128];
+    uint8_t dest[128];
+    uint8_t expected[128];
+
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t) (i * 7 + 1);
+
+    for (size_t so = 0; so < sizeof(uintptr_t); so++) {
+        for (size_t doff = 0; doff < sizeof(uintptr_t); doff++) {
+            for (size_t len = 0; len < 96; len++) {
+                memset(dest, 0xB, sizeof(dest));
+                memcpy(expected, dest, sizeof(expected));
+                memcpy(expected + doff, src + so, len);
+
+                plcrash_async_memcpy(dest + doff, src + so, len);
+                STAssertTrue(memcmp(dest, expected, sizeof(dest)) == 0, @"Incorrect copy (%zu, %zu, %zu)", so, doff, len);
+
+                memset(expected + doff, 0xC5, len);
+                plcrash_async_memset(dest + doff, 0xC5, len);
+                STAssertTrue(memcmp(dest, expected, sizeof(dest)) == 0, @"Incorrect fill (%zu, %zu)", doff, len);
+            }
+        }
+    }
+}
+
 - (void) testMemcpy {
     size_t size = 1024;
     uint8_t template[size];
@@ -244,7 +319,7 @@
     unsigned char data[100];
     size_t nread = 0;
     
-    STAssertTrue(sizeof(data) * write_iterations > sizeof(file.buffer), @"Test is invalid if our buffer is not larger");
+    STAssertTrue(sizeof(data) * write_iterations > PLCRASH_ASYNC_FILE_INLINE_BUFFER_SIZE, @"Test is invalid if our buffer is not larger");
 
     /* Initialize the file instance */
     plcrash_async_file_init(&file, _testFd, 0);
@@ -274,4 +349,237 @@
     [input close];
 }
 
+- (void) testBufferedWriteCustomBuffer {
+    plcrash_async_file_t file;
+    int write_iterations = 8;
+    unsigned char data[100];
+    unsigned char buffer[sizeof(data) * 8];
+    size_t nread = 0;
+    struct stat fs;
+
+    /* Initialize the file instance with a buffer large enough to hold all test data */
+    plcrash_async_file_init_buffer(&file, _testFd, 0, buffer, sizeof(buffer));
+    STAssertEquals(file.bufsize, sizeof(buffer), @"Caller-provided buffer was not used");
+
+    /* Create test data */
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    /* Write out the test data; none of it should reach the file prior to flush */
+    for (int i = 0; i < write_iterations; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+
+    STAssertEquals(0, fstat(_testFd, &fs), @"fstat() failed");
+    STAssertEquals((off_t) 0, fs.st_size, @"Data was written prior to flush");
+
+    /* Flush pending data and close the file */
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+
+    /* Validate the test file */
+    NSInputStream *input = [NSInputStream inputStreamWithFileAtPath: _outputFile];
+    [input open];
+    STAssertEquals((NSStreamStatus)NSStreamStatusOpen, [input streamStatus], @"Could not open input stream %@: %@", _outputFile, [input streamError]);
+
+    for (int i = 0; i < write_iterations; i++)
+        nread += [self checkTestData: data bytes: sizeof(data) inputStream: input];
+
+    STAssertEquals(nread, sizeof(data) * write_iterations, @"Fewer than expected bytes were written (%zu < %zu)", nread, sizeof(data) * write_iterations);
+
+    [input close];
+}
+
+- (void) testMappedWrite {
+    plcrash_async_file_t file;
+    const size_t mapping_size = PAGE_SIZE;
+    unsigned char data[100];
+    const unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+    struct stat fs;
+
+    /* Size and map the test file */
+    STAssertEquals(0, ftruncate(_testFd, mapping_size), @"ftruncate() failed");
+    void *mapping = mmap(NULL, mapping_size, PROT_READ|PROT_WRITE, MAP_SHARED, _testFd, 0);
+    STAssertTrue(mapping != MAP_FAILED, @"mmap() failed: %s", strerror(errno));
+    if (mapping == MAP_FAILED)
+        return;
+
+    plcrash_async_file_init_mapped(&file, _testFd, mapping, mapping_size);
+    STAssertTrue(plcrash_async_file_seekable(&file), @"Mapped file should support positional writes");
+
+    /* Write out the test data */
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to mapping");
+    STAssertTrue(memcmp(mapping, data, sizeof(data)) == 0, @"Data was not written to the mapping");
+
+    /* Writes beyond the mapping must fail */
+    STAssertFalse(plcrash_async_file_write(&file, mapping, mapping_size), @"Write past the mapping succeeded");
+
+    /* Positional writes must patch the mapping */
+    STAssertTrue(plcrash_async_file_pwrite(&file, 10, patch, sizeof(patch)), @"Failed to patch mapped data");
+    memcpy(data + 10, patch, sizeof(patch));
+
+    /* Close the file (which will trim it to the written length) */
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+    munmap(mapping, mapping_size);
+
+    STAssertEquals(0, stat([_outputFile UTF8String], &fs), @"stat() failed");
+    STAssertEquals((off_t) sizeof(data), fs.st_size, @"File was not trimmed to the written length");
+
+    /* Validate the test file */
+    NSInputStream *input = [NSInputStream inputStreamWithFileAtPath: _outputFile];
+    [input open];
+    STAssertEquals([self checkTestData: data bytes: sizeof(data) inputStream: input], sizeof(data), @"Fewer than expected bytes were written");
+    [input close];
+}
+
+/* Verify that a preallocated, fully synced mapped file is written and trimmed as usual */
+- (void) testMappedWriteSync {
+    plcrash_async_file_t file;
+    const size_t mapping_size = PAGE_SIZE;
+    unsigned char data[100];
+    struct stat fs;
+
+    /* Preallocation may be unsupported by the test volume's file system; it must not modify the file's length */
+    plcrash_async_file_preallocate(_testFd, mapping_size);
+    STAssertEquals(0, fstat(_testFd, &fs), @"fstat() failed");
+    STAssertEquals((off_t) 0, fs.st_size, @"Preallocation modified the file length");
+
+    STAssertEquals(0, ftruncate(_testFd, mapping_size), @"ftruncate() failed");
+    void *mapping = mmap(NULL, mapping_size, PROT_READ|PROT_WRITE, MAP_SHARED, _testFd, 0);
+    STAssertTrue(mapping != MAP_FAILED, @"mmap() failed: %s", strerror(errno));
+    if (mapping == MAP_FAILED)
+        return;
+
+    plcrash_async_file_init_mapped(&file, _testFd, mapping, mapping_size);
+    plcrash_async_file_set_sync(&file, PLCRASH_ASYNC_FILE_SYNC_FULLFSYNC);
+
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to mapping");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+    munmap(mapping, mapping_size);
+
+    STAssertEquals(0, stat([_outputFile UTF8String], &fs), @"stat() failed");
+    STAssertEquals((off_t) sizeof(data), fs.st_size, @"File was not trimmed to the written length");
+
+    NSInputStream *input = [NSInputStream inputStreamWithFileAtPath: _outputFile];
+    [input open];
+    STAssertEquals([self checkTestData: data bytes: sizeof(data) inputStream: input], sizeof(data), @"Fewer than expected bytes were written");
+    [input close];
+}
+
+- (void) testMemoryWrite {
+    plcrash_async_file_t file;
+    unsigned char buffer[256];
+    unsigned char data[100];
+
+    plcrash_async_file_init_memory(&file, buffer, sizeof(buffer));
+
+    /* Write out the test data */
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to buffer");
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to buffer");
+    STAssertFalse(plcrash_async_file_write(&file, data, sizeof(data)), @"Write past the buffer succeeded");
+    STAssertEquals(plcrash_async_file_position(&file), (off_t) sizeof(data) * 2, @"Incorrect position");
+
+    STAssertTrue(memcmp(buffer, data, sizeof(data)) == 0, @"Data was not written to the buffer");
+    STAssertTrue(memcmp(buffer + sizeof(data), data, sizeof(data)) == 0, @"Data was not written to the buffer");
+
+    /* Flush and close must succeed without a backing file descriptor */
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+}
+
+- (void) testPositionalWrite {
+    plcrash_async_file_t file;
+    unsigned char data[PLCRASH_ASYNC_FILE_INLINE_BUFFER_SIZE * 2];
+    const unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+
+    /* Initialize the file instance */
+    plcrash_async_file_init(&file, _testFd, 0);
+    STAssertTrue(plcrash_async_file_seekable(&file), @"Regular file should be seekable");
+
+    /* Write out the test data */
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = i & 0xFF;
+
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+    STAssertTrue(plcrash_async_file_write(&file, data, 16), @"Failed to write to output buffer");
+    STAssertEquals(plcrash_async_file_position(&file), (off_t) sizeof(data) + 16, @"Incorrect position");
+
+    /* Writes beyond the current position must fail */
+    STAssertFalse(plcrash_async_file_pwrite(&file, sizeof(data) + 14, patch, sizeof(patch)), @"Write past current position succeeded");
+
+    /* Patch both flushed and buffered data, including a write that straddles the two */
+    STAssertTrue(plcrash_async_file_pwrite(&file, 0, patch, sizeof(patch)), @"Failed to patch flushed data");
+    STAssertTrue(plcrash_async_file_pwrite(&file, sizeof(data) - 2, patch, sizeof(patch)), @"Failed to patch straddling data");
+    STAssertTrue(plcrash_async_file_pwrite(&file, sizeof(data) + 12, patch, sizeof(patch)), @"Failed to patch buffered data");
+
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+
+    /* Validate the test file */
+    memcpy(data, patch, sizeof(patch));
+    memcpy(data + sizeof(data) - 2, patch, 2);
+
+    NSData *written = [NSData dataWithContentsOfFile: _outputFile];
+    STAssertEquals([written length], sizeof(data) + 16, @"Incorrect file size");
+    if ([written length] != sizeof(data) + 16)
+        return;
+
+    const unsigned char *bytes = [written bytes];
+    STAssertTrue(memcmp(bytes, data, sizeof(data)) == 0, @"Flushed data was not correctly patched");
+    STAssertTrue(memcmp(bytes + sizeof(data), patch + 2, 2) == 0, @"Straddling data was not correctly patched");
+    STAssertTrue(memcmp(bytes + sizeof(data) + 12, patch, sizeof(patch)) == 0, @"Buffered data was not correctly patched");
+}
+
+- (void) testCompressedWrite {
+    plcrash_async_allocator_t *allocator;
+    plcrash_async_compressor_t *compressor;
+    plcrash_async_file_t file;
+    NSMutableData *data = [NSMutableData data];
+
+    STAssertEquals(plcrash_async_allocator_create(&allocator, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(plcrash_nasync_compressor_new(&compressor, allocator), PLCRASH_ESUCCESS, @"Failed to create compressor");
+
+    /* Generate test data spanning multiple compression blocks */
+    for (uint32_t i = 0; [data length] < PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE * 2 + 17; i++) {
+        const char *line = "Thread 0 Crashed:\n";
+        [data appendBytes: line length: strlen(line)];
+        [data appendBytes: &i length: sizeof(i)];
+    }
+
+    plcrash_async_file_init(&file, _testFd, 0);
+    plcrash_async_file_set_compressor(&file, compressor);
+    STAssertFalse(plcrash_async_file_seekable(&file), @"Compressed output must not be seekable");
+
+    /* Write in uneven chunks, to exercise block boundaries */
+    const uint8_t *bytes = [data bytes];
+    for (size_t off = 0; off < [data length]; off += 1000)
+        STAssertTrue(plcrash_async_file_write(&file, bytes + off, MIN((size_t) 1000, [data length] - off)), @"Failed to write");
+
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+
+    /* Validate the result */
+    NSData *written = [NSData dataWithContentsOfFile: _outputFile];
+    size_t decoded_len;
+    STAssertTrue(plcrash_async_compressed_is_compressed([written bytes], [written length]), @"Output is not compressed");
+    STAssertTrue([written length] < [data length], @"Output was not compressed");
+    STAssertEquals(plcrash_async_compressed_decoded_length([written bytes], [written length], &decoded_len), PLCRASH_ESUCCESS, @"Failed to decode output");
+    STAssertEquals(decoded_len, (size_t) [data length], @"Incorrect decoded length");
+
+    NSMutableData *decoded = [NSMutableData dataWithLength: decoded_len];
+    STAssertEquals(plcrash_async_compressed_decode([written bytes], [written length], [decoded mutableBytes], decoded_len, &decoded_len), PLCRASH_ESUCCESS, @"Failed to decode output");
+    STAssertEqualObjects(decoded, data, @"Decoded data does not match");
+
+    plcrash_nasync_compressor_free(compressor);
+    plcrash_async_allocator_free(allocator);
+}
+
 @end
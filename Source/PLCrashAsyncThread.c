@@ -255,6 +255,78 @@ void plcrash_async_thread_state_copy (plcrash_async_thread_state_t *dest, const
     plcrash_async_memcpy(dest, source, sizeof(*dest));
 }
 
+/**
+ * @internal
+ *
+ * Return the CPU type of @a thread_state, as accepted by plcrash_async_thread_state_init().
+ */
+static cpu_type_t plcrash_async_thread_state_cpu_type (const plcrash_async_thread_state_t *thread_state) {
+#if PLCRASH_ASYNC_THREAD_X86_SUPPORT
+    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32)
+        return CPU_TYPE_X86;
+    return CPU_TYPE_X86_64;
+#elif PLCRASH_ASYNC_THREAD_ARM_SUPPORT
+    if (thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE32)
+        return CPU_TYPE_ARM;
+    return CPU_TYPE_ARM64;
+#else
+#error Add support for this platform
+#endif
+}
+
+/**
+ * Return the size, in bytes, of a plcrash_async_thread_snapshot_t holding @a thread_state. The size is a multiple of
+ * the snapshot's alignment, and snapshots of states of the same CPU type may be packed in an array of this stride.
+ *
+ * @param thread_state The thread state to be snapshotted.
+ */
+size_t plcrash_async_thread_snapshot_size (const plcrash_async_thread_state_t *thread_state) {
+    size_t align = __alignof__(plcrash_async_thread_snapshot_t);
+    size_t size = sizeof(plcrash_async_thread_snapshot_t) + sizeof(plcrash_greg_t) * plcrash_async_thread_state_get_reg_count(thread_state);
+
+    return (size + align - 1) & ~(align - 1);
+}
+
+/**
+ * Initialize @a snapshot with the valid registers of @a thread_state.
+ *
+ * @param snapshot The snapshot to be initialized. Must be at least plcrash_async_thread_snapshot_size() bytes.
+ * @param thread_state The thread state to be snapshotted.
+ */
+void plcrash_async_thread_snapshot_init (plcrash_async_thread_snapshot_t *snapshot, const plcrash_async_thread_state_t *thread_state) {
+    snapshot->cpu_type = plcrash_async_thread_state_cpu_type(thread_state);
+    snapshot->reg_count = (uint32_t) plcrash_async_thread_state_get_reg_count(thread_state);
+    snapshot->valid_regs = thread_state->valid_regs;
+
+    for (plcrash_regnum_t i = 0; i < snapshot->reg_count; i++) {
+        if (plcrash_async_thread_state_has_reg(thread_state, i))
+            snapshot->regs[i] = plcrash_async_thread_state_get_reg(thread_state, i);
+    }
+}
+
+/**
+ * Restore the full thread state held by @a snapshot.
+ *
+ * @param snapshot The snapshot to be restored.
+ * @param thread_state The thread state to be initialized. Only the registers recorded in @a snapshot will be marked
+ * as available.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOTSUP if the snapshot's CPU type is not supported.
+ */
+plcrash_error_t plcrash_async_thread_snapshot_restore (const plcrash_async_thread_snapshot_t *snapshot, plcrash_async_thread_state_t *thread_state) {
+    plcrash_error_t err;
+
+    if ((err = plcrash_async_thread_state_init(thread_state, snapshot->cpu_type)) != PLCRASH_ESUCCESS)
+        return err;
+
+    for (plcrash_regnum_t i = 0; i < snapshot->reg_count; i++) {
+        if ((snapshot->valid_regs & (1ULL<<i)) != 0)
+            plcrash_async_thread_state_set_reg(thread_state, i, snapshot->regs[i]);
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Return true if @a regnum is set in @a thread_state, false otherwise.
  *
@@ -182,6 +182,31 @@ typedef enum {
 /** Platform word type */
 typedef plcrash_pdef_greg_t plcrash_greg_t;
 
+/**
+ * @internal
+ *
+ * A compact thread state snapshot, holding only the state's valid register set and a dense array of its general
+ * purpose register values, indexed by plcrash_regnum_t. Snapshots are variable-length; the size of a snapshot of
+ * a given thread state is returned by plcrash_async_thread_snapshot_size().
+ *
+ * Snapshots are intended for bulk capture of many threads' states, where the unused portions of
+ * plcrash_async_thread_state_t's architecture union would otherwise be retained for every thread. A snapshot must be
+ * restored to a plcrash_async_thread_state_t via plcrash_async_thread_snapshot_restore() prior to unwinding.
+ */
+typedef struct plcrash_async_thread_snapshot {
+    /** The thread state's CPU type, as accepted by plcrash_async_thread_state_init(). */
+    cpu_type_t cpu_type;
+
+    /** The number of entries in @a regs. */
+    uint32_t reg_count;
+
+    /** The set of available registers. */
+    uint64_t valid_regs;
+
+    /** Register values, indexed by plcrash_regnum_t. Values of registers not in @a valid_regs are undefined. */
+    plcrash_greg_t regs[];
+} plcrash_async_thread_snapshot_t;
+
 plcrash_error_t plcrash_async_thread_state_init (plcrash_async_thread_state_t *thread_state, cpu_type_t cpu_type);
 void plcrash_async_thread_state_mcontext_init (plcrash_async_thread_state_t *thread_state, pl_mcontext_t *mctx);
 plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_thread_state_t *thread_state, thread_t thread);
@@ -207,6 +232,10 @@ plcrash_error_t plcrash_async_thread_state_current (plcrash_async_thread_state_c
 
 void plcrash_async_thread_state_copy (plcrash_async_thread_state_t *dest, const plcrash_async_thread_state_t *src);
 
+size_t plcrash_async_thread_snapshot_size (const plcrash_async_thread_state_t *thread_state);
+void plcrash_async_thread_snapshot_init (plcrash_async_thread_snapshot_t *snapshot, const plcrash_async_thread_state_t *thread_state);
+plcrash_error_t plcrash_async_thread_snapshot_restore (const plcrash_async_thread_snapshot_t *snapshot, plcrash_async_thread_state_t *thread_state);
+
 plcrash_async_thread_stack_direction_t plcrash_async_thread_state_get_stack_direction (const plcrash_async_thread_state_t *thread_state);
 size_t plcrash_async_thread_state_get_greg_size (const plcrash_async_thread_state_t *thread_state);
 
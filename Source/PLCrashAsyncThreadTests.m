@@ -478,4 +478,42 @@ static plcrash_error_t write_current_thread_callback (plcrash_async_thread_state
     thread_resume(thr);
 }
 
+/**
+ * Test snapshotting and restoring a thread state.
+ */
+- (void) testThreadSnapshot {
+    plcrash_async_thread_state_t thr_state;
+    plcrash_async_thread_state_t restored;
+    thread_t thr;
+
+    thr = pthread_mach_thread_np(_thr_args.thread);
+    thread_suspend(thr);
+
+    STAssertEquals(plcrash_async_thread_state_mach_thread_init(&thr_state, thr), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    thread_resume(thr);
+
+    /* Drop the volatile registers, which must remain unavailable once restored */
+    plcrash_async_thread_state_clear_volatile_regs(&thr_state);
+
+    size_t size = plcrash_async_thread_snapshot_size(&thr_state);
+    STAssertTrue(size >= sizeof(plcrash_async_thread_snapshot_t) + sizeof(plcrash_greg_t) * plcrash_async_thread_state_get_reg_count(&thr_state), @"Snapshot size too small");
+
+    plcrash_async_thread_snapshot_t *snapshot = malloc(size);
+    plcrash_async_thread_snapshot_init(snapshot, &thr_state);
+    STAssertEquals(plcrash_async_thread_snapshot_restore(snapshot, &restored), PLCRASH_ESUCCESS, @"Failed to restore thread state");
+    free(snapshot);
+
+    STAssertEquals(restored.valid_regs, thr_state.valid_regs, @"Incorrect valid register set");
+    STAssertEquals(plcrash_async_thread_state_get_greg_size(&restored), plcrash_async_thread_state_get_greg_size(&thr_state), @"Incorrect register size");
+    STAssertEquals(plcrash_async_thread_state_get_reg_count(&restored), plcrash_async_thread_state_get_reg_count(&thr_state), @"Incorrect register count");
+
+    for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&thr_state); i++) {
+        if (!plcrash_async_thread_state_has_reg(&thr_state, i))
+            continue;
+
+        STAssertEquals(plcrash_async_thread_state_get_reg(&restored, i), plcrash_async_thread_state_get_reg(&thr_state, i), @"Incorrect value for %s",
+                       plcrash_async_thread_state_get_reg_name(&thr_state, i));
+    }
+}
+
 @end
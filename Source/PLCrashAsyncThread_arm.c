@@ -30,21 +30,34 @@
 #include "PLCrashAsync.h"
 
 #include <signal.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <assert.h>
 
 #if defined(__arm__) || defined(__arm64__)
 
-#define RETGEN(name, type, ts) {\
-    return (ts->arm_state. type . __ ## name); \
-}
+/** Register table entry, describing the location of a register within plcrash_async_thread_state_t. */
+struct register_table_entry {
+    /** Offset of the register's value within plcrash_async_thread_state_t. */
+    uint16_t offset;
+
+    /** Size of the register's value, in bytes, or 0 if the register is not defined. */
+    uint8_t size;
+
+    /** Register name. */
+    const char *name;
+};
 
-#define SETGEN(name, type, ts, regnum, value) {\
-    ts->valid_regs |= 1ULL<<regnum; \
-    (ts->arm_state. type . __ ## name) = value; \
-    break; \
+/** Define a register table entry for @a field of plcrash_async_thread_state_t, named @a regname. */
+#define REGENTRY(field, regname) { \
+    offsetof(plcrash_async_thread_state_t, field), \
+    sizeof(((plcrash_async_thread_state_t *) NULL)->field), \
+    regname \
 }
 
+/** Return the bit corresponding to @a regnum in plcrash_async_thread_state_t::valid_regs. */
+#define REGBIT(regnum) (1ULL << (regnum))
+
 /* Mapping of DWARF register numbers to PLCrashReporter register numbers. */
 struct dwarf_register_table {
     /** Standard register number. */
@@ -58,31 +71,30 @@ struct dwarf_register_table {
 /*
  * ARM GP registers defined as callee-preserved, as per Apple's iOS ARM Function Call Guide
  */
-static const plcrash_regnum_t arm_nonvolatile_registers[] = {
-    PLCRASH_ARM_R4,
-    PLCRASH_ARM_R5,
-    PLCRASH_ARM_R6,
-    PLCRASH_ARM_R7,
-    PLCRASH_ARM_R8,
-    PLCRASH_ARM_R10,
-    PLCRASH_ARM_R11,
-};
+static const uint64_t arm_nonvolatile_registers =
+    REGBIT(PLCRASH_ARM_R4) |
+    REGBIT(PLCRASH_ARM_R5) |
+    REGBIT(PLCRASH_ARM_R6) |
+    REGBIT(PLCRASH_ARM_R7) |
+    REGBIT(PLCRASH_ARM_R8) |
+    REGBIT(PLCRASH_ARM_R10) |
+    REGBIT(PLCRASH_ARM_R11);
 
 /*
  * ARM GP registers defined as callee-preserved, as per ARM's Procedure Call Standard for the
  * ARM 64-bit Architecture (AArch64), 22nd May 2013.
  */
-static const plcrash_regnum_t arm64_nonvolatile_registers[] = {
-    PLCRASH_ARM64_X19,
-    PLCRASH_ARM64_X20,
-    PLCRASH_ARM64_X21,
-    PLCRASH_ARM64_X22,
-    PLCRASH_ARM64_X23,
-    PLCRASH_ARM64_X24,
-    PLCRASH_ARM64_X25,
-    PLCRASH_ARM64_X26,
-    PLCRASH_ARM64_X27,
-    PLCRASH_ARM64_X28,
+static const uint64_t arm64_nonvolatile_registers =
+    REGBIT(PLCRASH_ARM64_X19) |
+    REGBIT(PLCRASH_ARM64_X20) |
+    REGBIT(PLCRASH_ARM64_X21) |
+    REGBIT(PLCRASH_ARM64_X22) |
+    REGBIT(PLCRASH_ARM64_X23) |
+    REGBIT(PLCRASH_ARM64_X24) |
+    REGBIT(PLCRASH_ARM64_X25) |
+    REGBIT(PLCRASH_ARM64_X26) |
+    REGBIT(PLCRASH_ARM64_X27) |
+    REGBIT(PLCRASH_ARM64_X28) |
 
 #ifdef __APPLE__
     // AAPCS 64 Section 5.2.3 allows an implementation to define the minimum
@@ -92,11 +104,10 @@ static const plcrash_regnum_t arm64_nonvolatile_registers[] = {
     // The frame pointer register (x29) must always address a valid frame record, although some functions—such
     // as leaf functions or tail calls—may elect not to create an entry in this list. As a result, stack traces will
     // always be meaningful, even without debug information.
-    PLCRASH_ARM64_FP,
+    REGBIT(PLCRASH_ARM64_FP);
 #else
 #error Define OS frame pointer behavior as per AAPCS64 Section 5.2.3
 #endif
-};
 
 /**
  * DWARF register mappings as defined in ARM's "DWARF for the ARM Architecture", ARM IHI 0040B,
@@ -176,348 +187,116 @@ static const struct dwarf_register_table arm64_dwarf_table [] = {
     { PLCRASH_ARM64_SP,  31 },
 };
 
+/**
+ * ARM register table, indexed by plcrash_arm_regnum_t.
+ */
+static const struct register_table_entry arm_register_table[PLCRASH_ARM_LAST_REG+1] = {
+    [PLCRASH_ARM_R0]   = REGENTRY(arm_state.thread.ts_32.__r[0], "r0"),
+    [PLCRASH_ARM_R1]   = REGENTRY(arm_state.thread.ts_32.__r[1], "r1"),
+    [PLCRASH_ARM_R2]   = REGENTRY(arm_state.thread.ts_32.__r[2], "r2"),
+    [PLCRASH_ARM_R3]   = REGENTRY(arm_state.thread.ts_32.__r[3], "r3"),
+    [PLCRASH_ARM_R4]   = REGENTRY(arm_state.thread.ts_32.__r[4], "r4"),
+    [PLCRASH_ARM_R5]   = REGENTRY(arm_state.thread.ts_32.__r[5], "r5"),
+    [PLCRASH_ARM_R6]   = REGENTRY(arm_state.thread.ts_32.__r[6], "r6"),
+    [PLCRASH_ARM_R7]   = REGENTRY(arm_state.thread.ts_32.__r[7], "r7"),
+    [PLCRASH_ARM_R8]   = REGENTRY(arm_state.thread.ts_32.__r[8], "r8"),
+    [PLCRASH_ARM_R9]   = REGENTRY(arm_state.thread.ts_32.__r[9], "r9"),
+    [PLCRASH_ARM_R10]  = REGENTRY(arm_state.thread.ts_32.__r[10], "r10"),
+    [PLCRASH_ARM_R11]  = REGENTRY(arm_state.thread.ts_32.__r[11], "r11"),
+    [PLCRASH_ARM_R12]  = REGENTRY(arm_state.thread.ts_32.__r[12], "r12"),
+    [PLCRASH_ARM_SP]   = REGENTRY(arm_state.thread.ts_32.__sp, "sp"),
+    [PLCRASH_ARM_LR]   = REGENTRY(arm_state.thread.ts_32.__lr, "lr"),
+    [PLCRASH_ARM_PC]   = REGENTRY(arm_state.thread.ts_32.__pc, "pc"),
+    [PLCRASH_ARM_CPSR] = REGENTRY(arm_state.thread.ts_32.__cpsr, "cpsr"),
+};
+
+/**
+ * ARM64 register table, indexed by plcrash_arm64_regnum_t.
+ */
+static const struct register_table_entry arm64_register_table[PLCRASH_ARM64_LAST_REG+1] = {
+    [PLCRASH_ARM64_X0]   = REGENTRY(arm_state.thread.ts_64.__x[0], "x0"),
+    [PLCRASH_ARM64_X1]   = REGENTRY(arm_state.thread.ts_64.__x[1], "x1"),
+    [PLCRASH_ARM64_X2]   = REGENTRY(arm_state.thread.ts_64.__x[2], "x2"),
+    [PLCRASH_ARM64_X3]   = REGENTRY(arm_state.thread.ts_64.__x[3], "x3"),
+    [PLCRASH_ARM64_X4]   = REGENTRY(arm_state.thread.ts_64.__x[4], "x4"),
+    [PLCRASH_ARM64_X5]   = REGENTRY(arm_state.thread.ts_64.__x[5], "x5"),
+    [PLCRASH_ARM64_X6]   = REGENTRY(arm_state.thread.ts_64.__x[6], "x6"),
+    [PLCRASH_ARM64_X7]   = REGENTRY(arm_state.thread.ts_64.__x[7], "x7"),
+    [PLCRASH_ARM64_X8]   = REGENTRY(arm_state.thread.ts_64.__x[8], "x8"),
+    [PLCRASH_ARM64_X9]   = REGENTRY(arm_state.thread.ts_64.__x[9], "x9"),
+    [PLCRASH_ARM64_X10]  = REGENTRY(arm_state.thread.ts_64.__x[10], "x10"),
+    [PLCRASH_ARM64_X11]  = REGENTRY(arm_state.thread.ts_64.__x[11], "x11"),
+    [PLCRASH_ARM64_X12]  = REGENTRY(arm_state.thread.ts_64.__x[12], "x12"),
+    [PLCRASH_ARM64_X13]  = REGENTRY(arm_state.thread.ts_64.__x[13], "x13"),
+    [PLCRASH_ARM64_X14]  = REGENTRY(arm_state.thread.ts_64.__x[14], "x14"),
+    [PLCRASH_ARM64_X15]  = REGENTRY(arm_state.thread.ts_64.__x[15], "x15"),
+    [PLCRASH_ARM64_X16]  = REGENTRY(arm_state.thread.ts_64.__x[16], "x16"),
+    [PLCRASH_ARM64_X17]  = REGENTRY(arm_state.thread.ts_64.__x[17], "x17"),
+    [PLCRASH_ARM64_X18]  = REGENTRY(arm_state.thread.ts_64.__x[18], "x18"),
+    [PLCRASH_ARM64_X19]  = REGENTRY(arm_state.thread.ts_64.__x[19], "x19"),
+    [PLCRASH_ARM64_X20]  = REGENTRY(arm_state.thread.ts_64.__x[20], "x20"),
+    [PLCRASH_ARM64_X21]  = REGENTRY(arm_state.thread.ts_64.__x[21], "x21"),
+    [PLCRASH_ARM64_X22]  = REGENTRY(arm_state.thread.ts_64.__x[22], "x22"),
+    [PLCRASH_ARM64_X23]  = REGENTRY(arm_state.thread.ts_64.__x[23], "x23"),
+    [PLCRASH_ARM64_X24]  = REGENTRY(arm_state.thread.ts_64.__x[24], "x24"),
+    [PLCRASH_ARM64_X25]  = REGENTRY(arm_state.thread.ts_64.__x[25], "x25"),
+    [PLCRASH_ARM64_X26]  = REGENTRY(arm_state.thread.ts_64.__x[26], "x26"),
+    [PLCRASH_ARM64_X27]  = REGENTRY(arm_state.thread.ts_64.__x[27], "x27"),
+    [PLCRASH_ARM64_X28]  = REGENTRY(arm_state.thread.ts_64.__x[28], "x28"),
+    [PLCRASH_ARM64_FP]   = REGENTRY(arm_state.thread.ts_64.__fp, "fp"),
+    [PLCRASH_ARM64_SP]   = REGENTRY(arm_state.thread.ts_64.__sp, "sp"),
+    [PLCRASH_ARM64_LR]   = REGENTRY(arm_state.thread.ts_64.__lr, "lr"),
+    [PLCRASH_ARM64_PC]   = REGENTRY(arm_state.thread.ts_64.__pc, "pc"),
+    [PLCRASH_ARM64_CPSR] = REGENTRY(arm_state.thread.ts_64.__cpsr, "cpsr"),
+};
 
+/**
+ * @internal
+ *
+ * Return the register table entry for @a regnum in @a thread_state's register table. Unsupported registers are an
+ * implementation error, and will trap.
+ */
+static inline const struct register_table_entry *register_table_lookup (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    const struct register_table_entry *entry;
 
-// PLCrashAsyncThread API
-plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *ts, plcrash_regnum_t regnum) {
-    if (ts->arm_state.thread.ash.flavor == ARM_THREAD_STATE32) {
-        switch (regnum) {
-            case PLCRASH_ARM_R0:
-                RETGEN(r[0], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R1:
-                RETGEN(r[1], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R2:
-                RETGEN(r[2], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R3:
-                RETGEN(r[3], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R4:
-                RETGEN(r[4], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R5:
-                RETGEN(r[5], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R6:
-                RETGEN(r[6], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R7:
-                RETGEN(r[7], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R8:
-                RETGEN(r[8], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R9:
-                RETGEN(r[9], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R10:
-                RETGEN(r[10], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R11:
-                RETGEN(r[11], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_R12:
-                RETGEN(r[12], thread.ts_32, ts);
-                
-            case PLCRASH_ARM_SP:
-                RETGEN(sp, thread.ts_32, ts);
-                
-            case PLCRASH_ARM_LR:
-                RETGEN(lr, thread.ts_32, ts);
-                
-            case PLCRASH_ARM_PC:
-                RETGEN(pc, thread.ts_32, ts);
-                
-            case PLCRASH_ARM_CPSR:
-                RETGEN(cpsr, thread.ts_32, ts);
-                
-            default:
-                __builtin_trap();
-        }
+    if (thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE32) {
+        if (regnum > PLCRASH_ARM_LAST_REG)
+            __builtin_trap();
+        entry = &arm_register_table[regnum];
     } else {
-        switch (regnum) {
-            case PLCRASH_ARM64_X0:
-                RETGEN(x[0], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X1:
-                RETGEN(x[1], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X2:
-                RETGEN(x[2], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X3:
-                RETGEN(x[3], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X4:
-                RETGEN(x[4], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X5:
-                RETGEN(x[5], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X6:
-                RETGEN(x[6], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X7:
-                RETGEN(x[7], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X8:
-                RETGEN(x[8], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X9:
-                RETGEN(x[9], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X10:
-                RETGEN(x[10], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X11:
-                RETGEN(x[11], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X12:
-                RETGEN(x[12], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X13:
-                RETGEN(x[13], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X14:
-                RETGEN(x[14], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X15:
-                RETGEN(x[15], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X16:
-                RETGEN(x[16], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X17:
-                RETGEN(x[17], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X18:
-                RETGEN(x[18], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X19:
-                RETGEN(x[19], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X20:
-                RETGEN(x[20], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X21:
-                RETGEN(x[21], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X22:
-                RETGEN(x[22], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X23:
-                RETGEN(x[23], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X24:
-                RETGEN(x[24], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X25:
-                RETGEN(x[25], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X26:
-                RETGEN(x[26], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X27:
-                RETGEN(x[27], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_X28:
-                RETGEN(x[28], thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_FP:
-                RETGEN(fp, thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_SP:
-                RETGEN(sp, thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_LR:
-                RETGEN(lr, thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_PC:
-                RETGEN(pc, thread.ts_64, ts);
-                
-            case PLCRASH_ARM64_CPSR:
-                RETGEN(cpsr, thread.ts_64, ts);
-                
-            default:
-                __builtin_trap();
-        }
+        if (regnum > PLCRASH_ARM64_LAST_REG)
+            __builtin_trap();
+        entry = &arm64_register_table[regnum];
     }
-    
-    /* Should not be reachable */
-    return 0;
+
+    if (entry->size == 0)
+        __builtin_trap();
+
+    return entry;
+}
+
+// PLCrashAsyncThread API
+plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *ts, plcrash_regnum_t regnum) {
+    const struct register_table_entry *entry = register_table_lookup(ts, regnum);
+    const uint8_t *value = (const uint8_t *) ts + entry->offset;
+
+    if (entry->size == sizeof(uint32_t))
+        return *(const uint32_t *) value;
+    else
+        return *(const uint64_t *) value;
 }
 
 // PLCrashAsyncThread API
 void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-
-    if (ts->arm_state.thread.ash.flavor == ARM_THREAD_STATE32) {
-        switch (regnum) {
-            case PLCRASH_ARM_R0:
-                SETGEN(r[0], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R1:
-                SETGEN(r[1], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R2:
-                SETGEN(r[2], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R3:
-                SETGEN(r[3], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R4:
-                SETGEN(r[4], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R5:
-                SETGEN(r[5], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R6:
-                SETGEN(r[6], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R7:
-                SETGEN(r[7], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R8:
-                SETGEN(r[8], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R9:
-                SETGEN(r[9], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R10:
-                SETGEN(r[10], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R11:
-                SETGEN(r[11], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_R12:
-                SETGEN(r[12], thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_SP:
-                SETGEN(sp, thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_LR:
-                SETGEN(lr, thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_PC:
-                SETGEN(pc, thread.ts_32, ts, regnum, reg);
-                
-            case PLCRASH_ARM_CPSR:
-                SETGEN(cpsr, thread.ts_32, ts, regnum, reg);
-                
-            default:
-                // Unsupported register
-                __builtin_trap();
-        }
-    } else {
-        switch (regnum) {
-            case PLCRASH_ARM64_X0:
-                SETGEN(x[0], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X1:
-                SETGEN(x[1], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X2:
-                SETGEN(x[2], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X3:
-                SETGEN(x[3], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X4:
-                SETGEN(x[4], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X5:
-                SETGEN(x[5], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X6:
-                SETGEN(x[6], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X7:
-                SETGEN(x[7], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X8:
-                SETGEN(x[8], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X9:
-                SETGEN(x[9], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X10:
-                SETGEN(x[10], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X11:
-                SETGEN(x[11], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X12:
-                SETGEN(x[12], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X13:
-                SETGEN(x[13], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X14:
-                SETGEN(x[14], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X15:
-                SETGEN(x[15], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X16:
-                SETGEN(x[16], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X17:
-                SETGEN(x[17], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X18:
-                SETGEN(x[18], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X19:
-                SETGEN(x[19], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X20:
-                SETGEN(x[20], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X21:
-                SETGEN(x[21], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X22:
-                SETGEN(x[22], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X23:
-                SETGEN(x[23], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X24:
-                SETGEN(x[24], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X25:
-                SETGEN(x[25], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X26:
-                SETGEN(x[26], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X27:
-                SETGEN(x[27], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_X28:
-                SETGEN(x[28], thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_FP:
-                SETGEN(fp, thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_SP:
-                SETGEN(sp, thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_LR:
-                SETGEN(lr, thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_PC:
-                SETGEN(pc, thread.ts_64, ts, regnum, reg);
-                
-            case PLCRASH_ARM64_CPSR:
-                SETGEN(cpsr, thread.ts_64, ts, regnum, reg);
-                
-            default:
-                __builtin_trap();
-        }
-    }
+    const struct register_table_entry *entry = register_table_lookup(thread_state, regnum);
+    uint8_t *value = (uint8_t *) thread_state + entry->offset;
+
+    if (entry->size == sizeof(uint32_t))
+        *(uint32_t *) value = (uint32_t) reg;
+    else
+        *(uint64_t *) value = reg;
+
+    thread_state->valid_regs |= REGBIT(regnum);
 }
 
 // PLCrashAsyncThread API
@@ -532,153 +311,20 @@ size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_stat
 
 // PLCrashAsyncThread API
 char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    const struct register_table_entry *table;
+    size_t table_count;
+
     if (thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE32) {
-        switch ((plcrash_arm_regnum_t) regnum) {
-            case PLCRASH_ARM_R0:
-                return "r0";
-            case PLCRASH_ARM_R1:
-                return "r1";
-            case PLCRASH_ARM_R2:
-                return "r2";
-            case PLCRASH_ARM_R3:
-                return "r3";
-            case PLCRASH_ARM_R4:
-                return "r4";
-            case PLCRASH_ARM_R5:
-                return "r5";
-            case PLCRASH_ARM_R6:
-                return "r6";
-            case PLCRASH_ARM_R7:
-                return "r7";
-            case PLCRASH_ARM_R8:
-                return "r8";
-            case PLCRASH_ARM_R9:
-                return "r9";
-            case PLCRASH_ARM_R10:
-                return "r10";
-            case PLCRASH_ARM_R11:
-                return "r11";
-            case PLCRASH_ARM_R12:
-                return "r12";
-                
-            case PLCRASH_ARM_SP:
-                return "sp";
-                
-            case PLCRASH_ARM_LR:
-                return "lr";
-                
-            case PLCRASH_ARM_PC:
-                return "pc";
-                
-            case PLCRASH_ARM_CPSR:
-                return "cpsr";
-        }
+        table = arm_register_table;
+        table_count = sizeof(arm_register_table) / sizeof(arm_register_table[0]);
     } else {
-        switch ((plcrash_arm64_regnum_t) regnum) {
-            case PLCRASH_ARM64_X0:
-                return "x0";
-                
-            case PLCRASH_ARM64_X1:
-                return "x1";
-                
-            case PLCRASH_ARM64_X2:
-                return "x2";
-                
-            case PLCRASH_ARM64_X3:
-                return "x3";
-                
-            case PLCRASH_ARM64_X4:
-                return "x4";
-                
-            case PLCRASH_ARM64_X5:
-                return "x5";
-                
-            case PLCRASH_ARM64_X6:
-                return "x6";
-                
-            case PLCRASH_ARM64_X7:
-                return "x7";
-                
-            case PLCRASH_ARM64_X8:
-                return "x8";
-                
-            case PLCRASH_ARM64_X9:
-                return "x9";
-                
-            case PLCRASH_ARM64_X10:
-                return "x10";
-                
-            case PLCRASH_ARM64_X11:
-                return "x11";
-                
-            case PLCRASH_ARM64_X12:
-                return "x12";
-                
-            case PLCRASH_ARM64_X13:
-                return "x13";
-                
-            case PLCRASH_ARM64_X14:
-                return "x14";
-                
-            case PLCRASH_ARM64_X15:
-                return "x15";
-                
-            case PLCRASH_ARM64_X16:
-                return "x16";
-                
-            case PLCRASH_ARM64_X17:
-                return "x17";
-                
-            case PLCRASH_ARM64_X18:
-                return "x18";
-                
-            case PLCRASH_ARM64_X19:
-                return "x19";
-                
-            case PLCRASH_ARM64_X20:
-                return "x20";
-                
-            case PLCRASH_ARM64_X21:
-                return "x21";
-                
-            case PLCRASH_ARM64_X22:
-                return "x22";
-                
-            case PLCRASH_ARM64_X23:
-                return "x23";
-                
-            case PLCRASH_ARM64_X24:
-                return "x24";
-                
-            case PLCRASH_ARM64_X25:
-                return "x25";
-                
-            case PLCRASH_ARM64_X26:
-                return "x26";
-                
-            case PLCRASH_ARM64_X27:
-                return "x27";
-                
-            case PLCRASH_ARM64_X28:
-                return "x28";
-                
-            case PLCRASH_ARM64_FP:
-                return "fp";
-                
-            case PLCRASH_ARM64_SP:
-                return "sp";
-                
-            case PLCRASH_ARM64_LR:
-                return "lr";
-                
-            case PLCRASH_ARM64_PC:
-                return "pc";
-                
-            case PLCRASH_ARM64_CPSR:
-                return "cpsr";
-        }
+        table = arm64_register_table;
+        table_count = sizeof(arm64_register_table) / sizeof(arm64_register_table[0]);
     }
-    
+
+    if (regnum < table_count && table[regnum].name != NULL)
+        return table[regnum].name;
+
     /* Unsupported register is an implementation error (checked in unit tests) */
     PLCF_DEBUG("Missing register name for register id: %d", regnum);
     abort();
@@ -686,35 +332,10 @@ char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_
 
 // PLCrashAsyncThread API
 void plcrash_async_thread_state_clear_volatile_regs (plcrash_async_thread_state_t *thread_state) {
-    const plcrash_regnum_t *table;
-    size_t table_count = 0;
-    
     if (thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE32) {
-        table = arm_nonvolatile_registers;
-        table_count = sizeof(arm_nonvolatile_registers) / sizeof(arm_nonvolatile_registers[0]);
+        thread_state->valid_regs &= arm_nonvolatile_registers;
     } else {
-        table = arm64_nonvolatile_registers;
-        table_count = sizeof(arm64_nonvolatile_registers) / sizeof(arm64_nonvolatile_registers[0]);
-    }
-    
-    size_t reg_count = plcrash_async_thread_state_get_reg_count(thread_state);
-    for (size_t reg = 0; reg < reg_count; reg++) {
-        /* Skip unset registers */
-        if (!plcrash_async_thread_state_has_reg(thread_state, reg))
-            continue;
-        
-        /* Check for the register in the preservation table */
-        bool preserved = false;
-        for (size_t i = 0; i < table_count; i++) {
-            if (table[i] == reg) {
-                preserved = true;
-                break;
-            }
-        }
-        
-        /* If not preserved, clear */
-        if (!preserved)
-            plcrash_async_thread_state_clear_reg(thread_state, reg);
+        thread_state->valid_regs &= arm64_nonvolatile_registers;
     }
 }
 
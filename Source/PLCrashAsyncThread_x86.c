@@ -30,20 +30,33 @@
 #include "PLCrashAsync.h"
 
 #include <signal.h>
+#include <stddef.h>
 #include <assert.h>
 #include <stdlib.h>
 
-#define RETGEN(name, type, ts) {\
-    return (ts->x86_state. type . __ ## name); \
-}
+#if defined(__i386__) || defined(__x86_64__)
+
+/** Register table entry, describing the location of a register within plcrash_async_thread_state_t. */
+struct register_table_entry {
+    /** Offset of the register's value within plcrash_async_thread_state_t. */
+    uint16_t offset;
+
+    /** Size of the register's value, in bytes, or 0 if the register is not defined. */
+    uint8_t size;
 
-#define SETGEN(name, type, ts, regnum, value) {\
-    ts->valid_regs |= 1ULL<<regnum; \
-    (ts->x86_state. type . __ ## name) = value; \
-    break; \
+    /** Register name. */
+    const char *name;
+};
+
+/** Define a register table entry for @a field of plcrash_async_thread_state_t, named @a regname. */
+#define REGENTRY(field, regname) { \
+    offsetof(plcrash_async_thread_state_t, field), \
+    sizeof(((plcrash_async_thread_state_t *) NULL)->field), \
+    regname \
 }
 
-#if defined(__i386__) || defined(__x86_64__)
+/** Return the bit corresponding to @a regnum in plcrash_async_thread_state_t::valid_regs. */
+#define REGBIT(regnum) (1ULL << (regnum))
 
 /* Mapping of DWARF register numbers to PLCrashReporter register numbers. */
 struct dwarf_register_table {
@@ -59,27 +72,25 @@ struct dwarf_register_table {
  * i386 GP registers defined as callee-preserved, as per Apple's Mac OS X IA-32
  * Function Call Guide
  */
-static const plcrash_regnum_t x86_32_nonvolatile_registers[] = {
-    PLCRASH_X86_EBX,
-    PLCRASH_X86_EBP,
-    PLCRASH_X86_ESI,
-    PLCRASH_X86_EDI,
-    PLCRASH_X86_ESP
-};
+static const uint64_t x86_32_nonvolatile_registers =
+    REGBIT(PLCRASH_X86_EBX) |
+    REGBIT(PLCRASH_X86_EBP) |
+    REGBIT(PLCRASH_X86_ESI) |
+    REGBIT(PLCRASH_X86_EDI) |
+    REGBIT(PLCRASH_X86_ESP);
 
 /*
  * x86-64 GP registers defined as callee-preserved, as per System V Application Binary Interface,
  * AMD64 Architecture Processor Supplement - Draft Version 0.99.6
  */
-static const plcrash_regnum_t x86_64_nonvolatile_registers[] = {
-    PLCRASH_X86_64_RBX,
-    PLCRASH_X86_64_RSP,
-    PLCRASH_X86_64_RBP,
-    PLCRASH_X86_64_R12,
-    PLCRASH_X86_64_R13,
-    PLCRASH_X86_64_R14,
-    PLCRASH_X86_64_R15
-};
+static const uint64_t x86_64_nonvolatile_registers =
+    REGBIT(PLCRASH_X86_64_RBX) |
+    REGBIT(PLCRASH_X86_64_RSP) |
+    REGBIT(PLCRASH_X86_64_RBP) |
+    REGBIT(PLCRASH_X86_64_R12) |
+    REGBIT(PLCRASH_X86_64_R13) |
+    REGBIT(PLCRASH_X86_64_R14) |
+    REGBIT(PLCRASH_X86_64_R15);
 
 /*
  * i386 GCC eh_frame register mappings as defined by GCC and LLVM/clang. These mappings
@@ -140,43 +151,134 @@ static const struct dwarf_register_table x86_64_dwarf_table [] = {
     { PLCRASH_X86_64_GS, 55 }
 };
 
-static plcrash_greg_t plcrash_async_thread_state_get_reg_32 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
-static plcrash_greg_t plcrash_async_thread_state_get_reg_64 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
+/**
+ * i386 register table, indexed by plcrash_x86_regnum_t.
+ */
+static const struct register_table_entry x86_32_register_table[PLCRASH_X86_LAST_REG+1] = {
+    [PLCRASH_X86_EAX]    = REGENTRY(x86_state.thread.uts.ts32.__eax, "eax"),
+    [PLCRASH_X86_EDX]    = REGENTRY(x86_state.thread.uts.ts32.__edx, "edx"),
+    [PLCRASH_X86_ECX]    = REGENTRY(x86_state.thread.uts.ts32.__ecx, "ecx"),
+    [PLCRASH_X86_EBX]    = REGENTRY(x86_state.thread.uts.ts32.__ebx, "ebx"),
+    [PLCRASH_X86_EBP]    = REGENTRY(x86_state.thread.uts.ts32.__ebp, "ebp"),
+    [PLCRASH_X86_ESI]    = REGENTRY(x86_state.thread.uts.ts32.__esi, "esi"),
+    [PLCRASH_X86_EDI]    = REGENTRY(x86_state.thread.uts.ts32.__edi, "edi"),
+    [PLCRASH_X86_ESP]    = REGENTRY(x86_state.thread.uts.ts32.__esp, "esp"),
+    [PLCRASH_X86_EIP]    = REGENTRY(x86_state.thread.uts.ts32.__eip, "eip"),
+    [PLCRASH_X86_EFLAGS] = REGENTRY(x86_state.thread.uts.ts32.__eflags, "eflags"),
+    [PLCRASH_X86_TRAPNO] = REGENTRY(x86_state.exception.ues.es32.__trapno, "trapno"),
+    [PLCRASH_X86_CS]     = REGENTRY(x86_state.thread.uts.ts32.__cs, "cs"),
+    [PLCRASH_X86_DS]     = REGENTRY(x86_state.thread.uts.ts32.__ds, "ds"),
+    [PLCRASH_X86_ES]     = REGENTRY(x86_state.thread.uts.ts32.__es, "es"),
+    [PLCRASH_X86_FS]     = REGENTRY(x86_state.thread.uts.ts32.__fs, "fs"),
+    [PLCRASH_X86_GS]     = REGENTRY(x86_state.thread.uts.ts32.__gs, "gs"),
+};
+
+/**
+ * x86-64 register table, indexed by plcrash_x86_64_regnum_t.
+ */
+static const struct register_table_entry x86_64_register_table[PLCRASH_X86_64_LAST_REG+1] = {
+    [PLCRASH_X86_64_RAX]    = REGENTRY(x86_state.thread.uts.ts64.__rax, "rax"),
+    [PLCRASH_X86_64_RBX]    = REGENTRY(x86_state.thread.uts.ts64.__rbx, "rbx"),
+    [PLCRASH_X86_64_RCX]    = REGENTRY(x86_state.thread.uts.ts64.__rcx, "rcx"),
+    [PLCRASH_X86_64_RDX]    = REGENTRY(x86_state.thread.uts.ts64.__rdx, "rdx"),
+    [PLCRASH_X86_64_RDI]    = REGENTRY(x86_state.thread.uts.ts64.__rdi, "rdi"),
+    [PLCRASH_X86_64_RSI]    = REGENTRY(x86_state.thread.uts.ts64.__rsi, "rsi"),
+    [PLCRASH_X86_64_RBP]    = REGENTRY(x86_state.thread.uts.ts64.__rbp, "rbp"),
+    [PLCRASH_X86_64_RSP]    = REGENTRY(x86_state.thread.uts.ts64.__rsp, "rsp"),
+    [PLCRASH_X86_64_R8]     = REGENTRY(x86_state.thread.uts.ts64.__r8, "r8"),
+    [PLCRASH_X86_64_R9]     = REGENTRY(x86_state.thread.uts.ts64.__r9, "r9"),
+    [PLCRASH_X86_64_R10]    = REGENTRY(x86_state.thread.uts.ts64.__r10, "r10"),
+    [PLCRASH_X86_64_R11]    = REGENTRY(x86_state.thread.uts.ts64.__r11, "r11"),
+    [PLCRASH_X86_64_R12]    = REGENTRY(x86_state.thread.uts.ts64.__r12, "r12"),
+    [PLCRASH_X86_64_R13]    = REGENTRY(x86_state.thread.uts.ts64.__r13, "r13"),
+    [PLCRASH_X86_64_R14]    = REGENTRY(x86_state.thread.uts.ts64.__r14, "r14"),
+    [PLCRASH_X86_64_R15]    = REGENTRY(x86_state.thread.uts.ts64.__r15, "r15"),
+    [PLCRASH_X86_64_RIP]    = REGENTRY(x86_state.thread.uts.ts64.__rip, "rip"),
+    [PLCRASH_X86_64_RFLAGS] = REGENTRY(x86_state.thread.uts.ts64.__rflags, "rflags"),
+    [PLCRASH_X86_64_CS]     = REGENTRY(x86_state.thread.uts.ts64.__cs, "cs"),
+    [PLCRASH_X86_64_FS]     = REGENTRY(x86_state.thread.uts.ts64.__fs, "fs"),
+    [PLCRASH_X86_64_GS]     = REGENTRY(x86_state.thread.uts.ts64.__gs, "gs"),
+};
+
+/**
+ * @internal
+ *
+ * Return the register table entry for @a regnum in @a thread_state's register table. Unsupported registers are an
+ * implementation error, and will trap.
+ */
+static inline const struct register_table_entry *register_table_lookup (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    const struct register_table_entry *entry;
 
-static void plcrash_async_thread_state_set_reg_32 (plcrash_async_thread_state_t *cursor, plcrash_regnum_t regnum, plcrash_greg_t reg);
-static void plcrash_async_thread_state_set_reg_64 (plcrash_async_thread_state_t *cursor, plcrash_regnum_t regnum, plcrash_greg_t reg);
+    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
+        if (regnum > PLCRASH_X86_LAST_REG)
+            __builtin_trap();
+        entry = &x86_32_register_table[regnum];
+    } else {
+        if (regnum > PLCRASH_X86_64_LAST_REG)
+            __builtin_trap();
+        entry = &x86_64_register_table[regnum];
+    }
 
-static const char *plcrash_async_thread_state_get_regname_32 (plcrash_regnum_t regnum);
-static const char *plcrash_async_thread_state_get_regname_64 (plcrash_regnum_t regnum);
+    if (entry->size == 0)
+        __builtin_trap();
 
-plcrash_regnum_t plcrash_async_thread_state_map_dwarf_reg_32 (uint64_t dwarf_reg, plcrash_regnum_t *regnum);
-plcrash_regnum_t plcrash_async_thread_state_map_dwarf_reg_64 (uint64_t dwarf_reg, plcrash_regnum_t *regnum);
+    return entry;
+}
 
 // PLCrashAsyncThread API
 plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_get_reg_32(thread_state, regnum);
-    } else {
-        return plcrash_async_thread_state_get_reg_64(thread_state, regnum);
+    const struct register_table_entry *entry = register_table_lookup(thread_state, regnum);
+    const uint8_t *value = (const uint8_t *) thread_state + entry->offset;
+
+    switch (entry->size) {
+        case sizeof(uint16_t):
+            return *(const uint16_t *) value;
+        case sizeof(uint32_t):
+            return *(const uint32_t *) value;
+        default:
+            return *(const uint64_t *) value;
     }
 }
 
 // PLCrashAsyncThread API
 void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_set_reg_32(thread_state, regnum, reg);
-    } else {
-        return plcrash_async_thread_state_set_reg_64(thread_state, regnum, reg);
+    const struct register_table_entry *entry = register_table_lookup(thread_state, regnum);
+    uint8_t *value = (uint8_t *) thread_state + entry->offset;
+
+    switch (entry->size) {
+        case sizeof(uint16_t):
+            *(uint16_t *) value = (uint16_t) reg;
+            break;
+        case sizeof(uint32_t):
+            *(uint32_t *) value = (uint32_t) reg;
+            break;
+        default:
+            *(uint64_t *) value = reg;
+            break;
     }
+
+    thread_state->valid_regs |= REGBIT(regnum);
 }
 
 // PLCrashAsyncThread API
 char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    const struct register_table_entry *table;
+    size_t table_count;
+
     if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_get_regname_32(regnum);
+        table = x86_32_register_table;
+        table_count = sizeof(x86_32_register_table) / sizeof(x86_32_register_table[0]);
     } else {
-        return plcrash_async_thread_state_get_regname_64(regnum);
+        table = x86_64_register_table;
+        table_count = sizeof(x86_64_register_table) / sizeof(x86_64_register_table[0]);
     }
+
+    if (regnum < table_count && table[regnum].name != NULL)
+        return table[regnum].name;
+
+    /* Unsupported register is an implementation error (checked in unit tests) */
+    PLCF_DEBUG("Missing register name for register id: %d", regnum);
+    abort();
 }
 
 // PLCrashAsyncThread API
@@ -191,35 +293,10 @@ size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_stat
 
 // PLCrashAsyncThread API
 void plcrash_async_thread_state_clear_volatile_regs (plcrash_async_thread_state_t *thread_state) {
-    const plcrash_regnum_t *table;
-    size_t table_count = 0;
-    
     if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        table = x86_32_nonvolatile_registers;
-        table_count = sizeof(x86_32_nonvolatile_registers) / sizeof(x86_32_nonvolatile_registers[0]);
+        thread_state->valid_regs &= x86_32_nonvolatile_registers;
     } else {
-        table = x86_64_nonvolatile_registers;
-        table_count = sizeof(x86_64_nonvolatile_registers) / sizeof(x86_64_nonvolatile_registers[0]);
-    }
-    
-    size_t reg_count = plcrash_async_thread_state_get_reg_count(thread_state);
-    for (size_t reg = 0; reg < reg_count; reg++) {
-        /* Skip unset registers */
-        if (!plcrash_async_thread_state_has_reg(thread_state, reg))
-            continue;
-        
-        /* Check for the register in the preservation table */
-        bool preserved = false;
-        for (size_t i = 0; i < table_count; i++) {
-            if (table[i] == reg) {
-                preserved = true;
-                break;
-            }
-        }
-
-        /* If not preserved, clear */
-        if (!preserved)
-            plcrash_async_thread_state_clear_reg(thread_state, reg);
+        thread_state->valid_regs &= x86_64_nonvolatile_registers;
     }
 }
 
@@ -271,434 +348,4 @@ bool plcrash_async_thread_state_map_reg_to_dwarf (plcrash_async_thread_state_t *
     return false;
 }
 
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_get_reg()
- */
-static plcrash_greg_t plcrash_async_thread_state_get_reg_32 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    const plcrash_async_thread_state_t *ts = thread_state;
-
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            RETGEN(eax, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EDX:
-            RETGEN(edx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ECX:
-            RETGEN(ecx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EBX:
-            RETGEN(ebx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EBP:
-            RETGEN(ebp, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ESI:
-            RETGEN(esi, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EDI:
-            RETGEN(edi, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ESP:
-            RETGEN(esp, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EIP:
-            RETGEN(eip, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EFLAGS:
-            RETGEN(eflags, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_TRAPNO:
-            RETGEN(trapno, exception.ues.es32, ts);
-            
-        case PLCRASH_X86_CS:
-            RETGEN(cs, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_DS:
-            RETGEN(ds, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ES:
-            RETGEN(es, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_FS:
-            RETGEN(fs, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_GS:
-            RETGEN(gs, thread.uts.ts32, ts);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-    
-    /* Shouldn't be reachable */
-    return 0;
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_get_reg()
- */
-static plcrash_greg_t plcrash_async_thread_state_get_reg_64 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    const plcrash_async_thread_state_t *ts = thread_state;
-
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            RETGEN(rax, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RBX:
-            RETGEN(rbx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RCX:
-            RETGEN(rcx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RDX:
-            RETGEN(rdx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RDI:
-            RETGEN(rdi, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RSI:
-            RETGEN(rsi, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RBP:
-            RETGEN(rbp, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RSP:
-            RETGEN(rsp, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R8:
-            RETGEN(r8, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R9:
-            RETGEN(r9, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R10:
-            RETGEN(r10, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R11:
-            RETGEN(r11, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R12:
-            RETGEN(r12, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R13:
-            RETGEN(r13, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R14:
-            RETGEN(r14, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R15:
-            RETGEN(r15, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RIP:
-            RETGEN(rip, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RFLAGS:
-            RETGEN(rflags, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_CS:
-            RETGEN(cs, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_FS:
-            RETGEN(fs, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_GS:
-            RETGEN(gs, thread.uts.ts64, ts);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-
-    /* Should not be reachable */
-    return 0;
-}
-
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_set_reg()
- */
-static void plcrash_async_thread_state_set_reg_32 (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-    
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            SETGEN(eax, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EDX:
-            SETGEN(edx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ECX:
-            SETGEN(ecx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EBX:
-            SETGEN(ebx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EBP:
-            SETGEN(ebp, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ESI:
-            SETGEN(esi, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EDI:
-            SETGEN(edi, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ESP:
-            SETGEN(esp, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EIP:
-            SETGEN(eip, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EFLAGS:
-            SETGEN(eflags, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_TRAPNO:
-            SETGEN(trapno, exception.ues.es32, ts, regnum, reg);
-            
-        case PLCRASH_X86_CS:
-            SETGEN(cs, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_DS:
-            SETGEN(ds, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ES:
-            SETGEN(es, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_FS:
-            SETGEN(fs, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_GS:
-            SETGEN(gs, thread.uts.ts32, ts, regnum, reg);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_set_reg()
- */
-static void plcrash_async_thread_state_set_reg_64 (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-    
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            SETGEN(rax, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RBX:
-            SETGEN(rbx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RCX:
-            SETGEN(rcx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RDX:
-            SETGEN(rdx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RDI:
-            SETGEN(rdi, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RSI:
-            SETGEN(rsi, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RBP:
-            SETGEN(rbp, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RSP:
-            SETGEN(rsp, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R8:
-            SETGEN(r8, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R9:
-            SETGEN(r9, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R10:
-            SETGEN(r10, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R11:
-            SETGEN(r11, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R12:
-            SETGEN(r12, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R13:
-            SETGEN(r13, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R14:
-            SETGEN(r14, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R15:
-            SETGEN(r15, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RIP:
-            SETGEN(rip, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RFLAGS:
-            SETGEN(rflags, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_CS:
-            SETGEN(cs, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_FS:
-            SETGEN(fs, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_GS:
-            SETGEN(gs, thread.uts.ts64, ts, regnum, reg);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }    
-}
-
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_get_regname()
- */
-static char const *plcrash_async_thread_state_get_regname_32 (plcrash_regnum_t regnum) {
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            return "eax";
-            
-        case PLCRASH_X86_EDX:
-            return "edx";
-            
-        case PLCRASH_X86_ECX:
-            return "ecx";
-            
-        case PLCRASH_X86_EBX:
-            return "ebx";
-            
-        case PLCRASH_X86_EBP:
-            return "ebp";
-            
-        case PLCRASH_X86_ESI:
-            return "esi";
-            
-        case PLCRASH_X86_EDI:
-            return "edi";
-            
-        case PLCRASH_X86_ESP:
-            return "esp";
-            
-        case PLCRASH_X86_EIP:
-            return "eip";
-            
-        case PLCRASH_X86_EFLAGS:
-            return "eflags";
-            
-        case PLCRASH_X86_TRAPNO:
-            return "trapno";
-            
-        case PLCRASH_X86_CS:
-            return "cs";
-            
-        case PLCRASH_X86_DS:
-            return "ds";
-            
-        case PLCRASH_X86_ES:
-            return "es";
-            
-        case PLCRASH_X86_FS:
-            return "fs";
-            
-        case PLCRASH_X86_GS:
-            return "gs";
-            
-        default:
-            // Unsupported register
-            break;
-    }
-    
-    /* Unsupported register is an implementation error (checked in unit tests) */
-    PLCF_DEBUG("Missing register name for register id: %d", regnum);
-    abort();
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_get_regname()
- */
-static const char *plcrash_async_thread_state_get_regname_64 (plcrash_regnum_t regnum) {
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            return "rax";
-            
-        case PLCRASH_X86_64_RBX:
-            return "rbx";
-            
-        case PLCRASH_X86_64_RCX:
-            return "rcx";
-            
-        case PLCRASH_X86_64_RDX:
-            return "rdx";
-            
-        case PLCRASH_X86_64_RDI:
-            return "rdi";
-            
-        case PLCRASH_X86_64_RSI:
-            return "rsi";
-            
-        case PLCRASH_X86_64_RBP:
-            return "rbp";
-            
-        case PLCRASH_X86_64_RSP:
-            return "rsp";
-            
-        case PLCRASH_X86_64_R8:
-            return "r8";
-            
-        case PLCRASH_X86_64_R9:
-            return "r9";
-            
-        case PLCRASH_X86_64_R10:
-            return "r10";
-            
-        case PLCRASH_X86_64_R11:
-            return "r11";
-            
-        case PLCRASH_X86_64_R12:
-            return "r12";
-            
-        case PLCRASH_X86_64_R13:
-            return "r13";
-            
-        case PLCRASH_X86_64_R14:
-            return "r14";
-            
-        case PLCRASH_X86_64_R15:
-            return "r15";
-            
-        case PLCRASH_X86_64_RIP:
-            return "rip";
-            
-        case PLCRASH_X86_64_RFLAGS:
-            return "rflags";
-            
-        case PLCRASH_X86_64_CS:
-            return "cs";
-            
-        case PLCRASH_X86_64_FS:
-            return "fs";
-            
-        case PLCRASH_X86_64_GS:
-            return "gs";
-            
-        default:
-            // Unsupported register
-            break;
-    }
-    
-    /* Unsupported register is an implementation error (checked in unit tests) */
-    PLCF_DEBUG("Missing register name for register id: %d", regnum);
-    abort();
-}
-
 #endif /* defined(__i386__) || defined(__x86_64__) */
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_VECTOR_H
+#define PLCRASH_ASYNC_VECTOR_H 1
+
+#include "PLCrashAsync.h"
+#include "PLCrashMacros.h"
+#include "AsyncAllocator.hpp"
+
+#include "async_stl.hpp"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * @{
+ */
+
+PLCR_CPP_BEGIN_ASYNC_NS
+
+/**
+ * @internal
+ *
+ * An async-safe, append-only vector with inline small storage.
+ *
+ * The first @a N elements are stored inline; once the inline storage is exhausted, the elements are moved to
+ * contiguous storage allocated from the vector's AsyncAllocator, doubling the capacity on each growth. As
+ * AsyncAllocator is itself async-safe, all operations -- including growth -- are async-safe.
+ *
+ * Elements are moved (via atl::move), rather than copied, when the storage is grown.
+ *
+ * The vector performs no internal synchronization; concurrent access must be externally synchronized.
+ *
+ * @tparam T The element type.
+ * @tparam N The number of elements to be stored inline.
+ */
+template <typename T, size_t N = 8>
+class async_vector {
+    static_assert(N > 0, "The inline capacity must be non-zero");
+
+public:
+    /**
+     * Construct an empty vector.
+     *
+     * @param allocator The allocator from which storage will be allocated if the inline storage is exhausted, or
+     * NULL if the vector should be limited to its inline storage. The allocator must outlive the vector.
+     */
+    async_vector (AsyncAllocator *allocator = NULL) : _allocator(allocator), _elements((T *) _inline), _count(0), _capacity(N) {}
+
+    ~async_vector () {
+        clear();
+        if (_elements != (T *) _inline)
+            _allocator->dealloc(_elements);
+    }
+
+    /* Copy/move are not supported. */
+    async_vector (const async_vector &) = delete;
+    async_vector (async_vector &&) = delete;
+
+    async_vector &operator= (const async_vector &) = delete;
+    async_vector &operator= (async_vector &&) = delete;
+
+    /**
+     * Append a copy of @a value.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or an error if additional storage was required and could not be
+     * allocated.
+     */
+    plcrash_error_t append (const T &value) {
+        return emplace(value);
+    }
+
+    /**
+     * Append @a value, moving it into the vector.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or an error if additional storage was required and could not be
+     * allocated.
+     */
+    plcrash_error_t append (T &&value) {
+        return emplace(atl::move(value));
+    }
+
+    /**
+     * Append a new element, constructed in place from @a args.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, or an error if additional storage was required and could not be
+     * allocated.
+     */
+    template <typename... Args> plcrash_error_t emplace (Args&&... args) {
+        if (_count == _capacity) {
+            plcrash_error_t err = reserve(_capacity * 2);
+            if (err != PLCRASH_ESUCCESS)
+                return err;
+        }
+
+        ::new (placement_new_tag_t(), (vm_address_t) &_elements[_count]) T(atl::forward<Args>(args)...);
+        _count++;
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    /**
+     * Ensure that the vector has capacity for at least @a capacity elements.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOMEM if no allocator was provided, or an error if the
+     * storage could not be allocated. On failure, the vector is left unmodified.
+     */
+    plcrash_error_t reserve (size_t capacity) {
+        if (capacity <= _capacity)
+            return PLCRASH_ESUCCESS;
+
+        if (_allocator == NULL)
+            return PLCRASH_ENOMEM;
+
+        T *elements;
+        plcrash_error_t err = _allocator->alloc((void **) &elements, sizeof(T) * capacity);
+        if (err != PLCRASH_ESUCCESS)
+            return err;
+
+        /* Move our existing elements to the new storage */
+        for (size_t i = 0; i < _count; i++) {
+            ::new (placement_new_tag_t(), (vm_address_t) &elements[i]) T(atl::move(_elements[i]));
+            _elements[i].~T();
+        }
+
+        if (_elements != (T *) _inline)
+            _allocator->dealloc(_elements);
+
+        _elements = elements;
+        _capacity = capacity;
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    /**
+     * Remove the last element. The vector must not be empty.
+     */
+    void remove_last () {
+        PLCF_ASSERT(_count > 0);
+        _count--;
+        _elements[_count].~T();
+    }
+
+    /**
+     * Destroy all elements. Any allocated storage is retained for reuse.
+     */
+    void clear () {
+        for (size_t i = 0; i < _count; i++)
+            _elements[i].~T();
+        _count = 0;
+    }
+
+    /** Return the number of elements in the vector. */
+    size_t count () const { return _count; }
+
+    /** Return the number of elements that may be appended without allocating additional storage. */
+    size_t capacity () const { return _capacity; }
+
+    /** Return a borrowed reference to the element at @a index. The index must be less than count(). */
+    T &operator[] (size_t index) {
+        PLCF_ASSERT(index < _count);
+        return _elements[index];
+    }
+
+    /** Return a borrowed reference to the element at @a index. The index must be less than count(). */
+    const T &operator[] (size_t index) const {
+        PLCF_ASSERT(index < _count);
+        return _elements[index];
+    }
+
+    /**
+     * Return a pointer to the first element. The pointer is invalidated by any subsequent append, as the
+     * elements may be moved to new storage.
+     */
+    T *begin () { return _elements; }
+
+    /** Return a pointer immediately following the last element. */
+    T *end () { return _elements + _count; }
+
+    /** @copydoc begin */
+    const T *begin () const { return _elements; }
+
+    /** @copydoc end */
+    const T *end () const { return _elements + _count; }
+
+private:
+    /** The allocator from which _elements will be allocated once _inline is exhausted, or NULL. */
+    AsyncAllocator *_allocator;
+
+    /** Inline element storage. */
+    alignas(T) uint8_t _inline[sizeof(T) * N];
+
+    /** The current element storage; either _inline, or storage allocated from _allocator. */
+    T *_elements;
+
+    /** The number of constructed elements in _elements. */
+    size_t _count;
+
+    /** The number of elements for which _elements has capacity. */
+    size_t _capacity;
+};
+
+PLCR_CPP_END_ASYNC_NS
+
+/**
+ * @}
+ */
+
+#endif /* PLCRASH_ASYNC_VECTOR_H */
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncVector.hpp"
+
+using namespace plcrash::async;
+
+/**
+ * Element type that tracks the number of live instances and moves.
+ */
+struct tracked_value {
+    static int live;
+    static int moves;
+
+    int value;
+
+    tracked_value (int v) : value(v) { live++; }
+    tracked_value (const tracked_value &other) : value(other.value) { live++; }
+    tracked_value (tracked_value &&other) : value(other.value) { live++; moves++; }
+    ~tracked_value () { live--; }
+};
+
+int tracked_value::live = 0;
+int tracked_value::moves = 0;
+
+@interface PLCrashAsyncVectorTests : SenTestCase {
+    AsyncAllocator *_allocator;
+}
+@end
+
+/**
+ * Tests for the async_vector implementation.
+ */
+@implementation PLCrashAsyncVectorTests
+
+- (void) setUp {
+    STAssertEquals(AsyncAllocator::Create(&_allocator, PAGE_SIZE), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    tracked_value::live = 0;
+    tracked_value::moves = 0;
+}
+
+- (void) tearDown {
+    delete _allocator;
+}
+
+- (void) testInlineStorage {
+    async_vector<int, 4> vector;
+
+    for (int i = 0; i < 4; i++)
+        STAssertEquals(vector.append(i), PLCRASH_ESUCCESS, @"Append failed");
+
+    /* Without an allocator, the vector is limited to its inline storage */
+    STAssertEquals(vector.append(4), PLCRASH_ENOMEM, @"Append beyond the inline capacity should fail");
+    STAssertEquals(vector.count(), (size_t) 4, @"Incorrect count");
+
+    int expected = 0;
+    for (int *i = vector.begin(); i != vector.end(); i++)
+        STAssertEquals(*i, expected++, @"Incorrect value");
+}
+
+- (void) testSpill {
+    async_vector<int, 4> vector(_allocator);
+
+    for (int i = 0; i < 1000; i++)
+        STAssertEquals(vector.append(i), PLCRASH_ESUCCESS, @"Append failed");
+
+    STAssertEquals(vector.count(), (size_t) 1000, @"Incorrect count");
+    STAssertTrue(vector.capacity() >= 1000, @"Storage should have grown");
+
+    for (int i = 0; i < 1000; i++)
+        STAssertEquals(vector[i], i, @"Incorrect value");
+
+    /* Cleared storage is retained for reuse */
+    size_t capacity = vector.capacity();
+    vector.clear();
+    STAssertEquals(vector.count(), (size_t) 0, @"Vector should be empty");
+    STAssertEquals(vector.capacity(), capacity, @"Storage should be retained");
+}
+
+- (void) testElementLifetime {
+    {
+        async_vector<tracked_value, 2> vector(_allocator);
+
+        for (int i = 0; i < 10; i++)
+            STAssertEquals(vector.emplace(i), PLCRASH_ESUCCESS, @"Emplace failed");
+        STAssertEquals(tracked_value::live, 10, @"Incorrect number of live elements");
+
+        /* Growth must move, rather than copy, the existing elements */
+        STAssertTrue(tracked_value::moves > 0, @"Elements should have been moved on growth");
+
+        vector.remove_last();
+        STAssertEquals(tracked_value::live, 9, @"Removed element was not destroyed");
+        STAssertEquals(vector[8].value, 8, @"Incorrect value");
+    }
+
+    STAssertEquals(tracked_value::live, 0, @"Elements were not destroyed with the vector");
+}
+
+@end
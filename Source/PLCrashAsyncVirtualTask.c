@@ -0,0 +1,713 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashAsyncVirtualTask.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_vtask Virtual Tasks
+ *
+ * Implements tasks backed by captured memory, allowing the task-based memory readers -- and the frame readers built
+ * upon them -- to operate on memory captured from another process, eg, when re-unwinding a crash report offline.
+ *
+ * A virtual task is registered upon initialization. Both plcrash_async_task_memcpy() and plcrash_async_mobject_init()
+ * consult the registered virtual tasks before falling back on the kernel; when no virtual tasks are registered, the
+ * only additional cost is a single pointer comparison.
+ *
+ * The contents of a virtual task are supplied by a plcrash_async_vtask_source_t; captured regions and memory-mapped
+ * files are supported directly. As the C++ readers (including the DWARF and compact unwind readers, and the
+ * DynamicLoader) access target memory exclusively via memory objects, they operate on any source without
+ * modification.
+ * @{
+ */
+
+/** The initial number of region entries allocated by plcrash_nasync_vtask_add_region(). */
+#define PLCRASH_ASYNC_VTASK_INITIAL_CAPACITY 16
+
+/** The registered virtual tasks, or NULL. */
+static plcrash_async_vtask_t * volatile vtask_list = NULL;
+
+/** Lock guarding modification and traversal of vtask_list. */
+static OSSpinLock vtask_lock = OS_SPINLOCK_INIT;
+
+static plcrash_error_t vtask_region_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len);
+static plcrash_error_t vtask_region_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                         pl_vm_address_t *local, pl_vm_size_t *available);
+
+/** The captured region source; the context is the owning virtual task. */
+static const plcrash_async_vtask_source_t vtask_region_source = {
+    .copy = vtask_region_copy,
+    .map = vtask_region_map,
+    .free = NULL
+};
+
+static plcrash_error_t vtask_file_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len);
+static plcrash_error_t vtask_file_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                       pl_vm_address_t *local, pl_vm_size_t *available);
+static void vtask_file_free (void *ctx);
+
+/** The memory-mapped file source; the context is a vtask_file_t. */
+static const plcrash_async_vtask_source_t vtask_file_source = {
+    .copy = vtask_file_copy,
+    .map = vtask_file_map,
+    .free = vtask_file_free
+};
+
+/** Recording file magic ('plrc'). */
+#define PLCRASH_VTASK_RECORDING_MAGIC 0x706c7263
+
+/** Recording file format version. */
+#define PLCRASH_VTASK_RECORDING_VERSION 1
+
+/** Recording file header. */
+typedef struct vtask_recording_header {
+    /** PLCRASH_VTASK_RECORDING_MAGIC */
+    uint32_t magic;
+
+    /** PLCRASH_VTASK_RECORDING_VERSION */
+    uint32_t version;
+} vtask_recording_header_t;
+
+/** Recording entry header; immediately followed by @a length bytes of recorded memory. */
+typedef struct vtask_recording_entry {
+    /** The task-relative address of the recorded memory. */
+    uint64_t address;
+
+    /** The number of bytes recorded. */
+    uint64_t length;
+} vtask_recording_entry_t;
+
+/** The recorder installed via plcrash_async_vtask_recorder_set_current(), or NULL. */
+static plcrash_async_vtask_recorder_t * volatile current_recorder = NULL;
+
+/** Memory-mapped file source state. */
+typedef struct vtask_file {
+    /** The task-relative address at which the file's contents appear. */
+    pl_vm_address_t address;
+
+    /** The local file mapping. */
+    void *mapping;
+
+    /** The size of the file, in bytes. */
+    pl_vm_size_t size;
+} vtask_file_t;
+
+/**
+ * Initialize and register a new virtual task backed by @a source.
+ *
+ * @param vtask The virtual task to be initialized.
+ * @param source The memory source. The source must remain valid for the lifetime of @a vtask.
+ * @param ctx The context to be passed to @a source. If the source provides a free function, ownership of @a ctx is
+ * transferred to @a vtask on success.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if a task port name could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_vtask_init_source (plcrash_async_vtask_t *vtask, const plcrash_async_vtask_source_t *source, void *ctx) {
+    kern_return_t kt;
+
+    /* Allocate a port name to identify the task. A send right is held so that the name may be reference counted by
+     * memory objects, exactly as a real task port would be. */
+    if ((kt = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &vtask->port)) != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to allocate virtual task port: %d", kt);
+        return PLCRASH_ENOMEM;
+    }
+
+    if ((kt = mach_port_insert_right(mach_task_self(), vtask->port, vtask->port, MACH_MSG_TYPE_MAKE_SEND)) != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to insert virtual task send right: %d", kt);
+        mach_port_mod_refs(mach_task_self(), vtask->port, MACH_PORT_RIGHT_RECEIVE, -1);
+        return PLCRASH_ENOMEM;
+    }
+
+    vtask->source = source;
+    vtask->source_ctx = ctx;
+    vtask->regions = NULL;
+    vtask->count = 0;
+    vtask->capacity = 0;
+
+    /* Register the task */
+    OSSpinLockLock(&vtask_lock); {
+        vtask->next = vtask_list;
+        vtask_list = vtask;
+    } OSSpinLockUnlock(&vtask_lock);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Initialize and register a new, empty virtual task, to be populated via plcrash_nasync_vtask_add_region().
+ *
+ * @param vtask The virtual task to be initialized.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if a task port name could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_vtask_init (plcrash_async_vtask_t *vtask) {
+    return plcrash_nasync_vtask_init_source(vtask, &vtask_region_source, vtask);
+}
+
+/**
+ * Initialize and register a new virtual task backed by a read-only mapping of the file at @a path, with the file's
+ * contents appearing at the task-relative @a address. No copy of the file is made.
+ *
+ * @param vtask The virtual task to be initialized.
+ * @param path The path of the file to be mapped.
+ * @param address The task-relative address of the file's first byte. Must be page-aligned.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a address is not page-aligned or the file is empty,
+ * PLCRASH_EINTERNAL if the file could not be mapped, or PLCRASH_ENOMEM if a task port name could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_vtask_init_file (plcrash_async_vtask_t *vtask, const char *path, pl_vm_address_t address) {
+    plcrash_error_t err;
+    struct stat sb;
+    int fd;
+
+    if (address != mach_vm_trunc_page(address))
+        return PLCRASH_EINVAL;
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        PLCF_DEBUG("Failed to open %s: %d", path, errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    if (fstat(fd, &sb) != 0 || sb.st_size <= 0 || address + (pl_vm_size_t) sb.st_size < address) {
+        close(fd);
+        return PLCRASH_EINVAL;
+    }
+
+    void *mapping = mmap(NULL, (size_t) sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        PLCF_DEBUG("Failed to map %s: %d", path, errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    vtask_file_t *file = malloc(sizeof(*file));
+    if (file == NULL) {
+        munmap(mapping, (size_t) sb.st_size);
+        return PLCRASH_ENOMEM;
+    }
+
+    file->address = address;
+    file->mapping = mapping;
+    file->size = (pl_vm_size_t) sb.st_size;
+
+    if ((err = plcrash_nasync_vtask_init_source(vtask, &vtask_file_source, file)) != PLCRASH_ESUCCESS)
+        vtask_file_free(file);
+
+    return err;
+}
+
+/* A parsed recording entry, used by plcrash_nasync_vtask_init_recording() */
+typedef struct vtask_recording_record {
+    pl_vm_address_t address;
+    pl_vm_size_t length;
+    const uint8_t *data;
+} vtask_recording_record_t;
+
+/* Order recording records by address */
+static int vtask_recording_record_compare (const void *a, const void *b) {
+    const vtask_recording_record_t *lhs = a;
+    const vtask_recording_record_t *rhs = b;
+
+    if (lhs->address < rhs->address)
+        return -1;
+    else if (lhs->address > rhs->address)
+        return 1;
+    return 0;
+}
+
+/**
+ * Initialize and register a new virtual task populated with the memory recorded by a plcrash_async_vtask_recorder_t.
+ * Overlapping and adjacent records are coalesced into a single captured region.
+ *
+ * @param vtask The virtual task to be initialized.
+ * @param path The path of the recording.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the recording is malformed, PLCRASH_EINTERNAL if the
+ * recording could not be read, or PLCRASH_ENOMEM if an allocation failed.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_vtask_init_recording (plcrash_async_vtask_t *vtask, const char *path) {
+    vtask_recording_record_t *records = NULL;
+    size_t record_count = 0;
+    size_t record_capacity = 0;
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+    struct stat sb;
+    int fd;
+
+    /* Map the recording */
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        PLCF_DEBUG("Failed to open %s: %d", path, errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    if (fstat(fd, &sb) != 0 || (size_t) sb.st_size < sizeof(vtask_recording_header_t)) {
+        close(fd);
+        return PLCRASH_EINVAL;
+    }
+
+    size_t size = (size_t) sb.st_size;
+    const uint8_t *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        PLCF_DEBUG("Failed to map %s: %d", path, errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    vtask_recording_header_t header;
+    memcpy(&header, mapping, sizeof(header));
+    if (header.magic != PLCRASH_VTASK_RECORDING_MAGIC || header.version != PLCRASH_VTASK_RECORDING_VERSION) {
+        munmap((void *) mapping, size);
+        return PLCRASH_EINVAL;
+    }
+
+    /* Parse the records. A truncated final record -- eg, if the recording process was terminated mid-write -- is
+     * ignored. */
+    size_t offset = sizeof(header);
+    while (size - offset >= sizeof(vtask_recording_entry_t)) {
+        vtask_recording_entry_t entry;
+        memcpy(&entry, mapping + offset, sizeof(entry));
+        offset += sizeof(entry);
+
+        if (entry.length > size - offset)
+            break;
+
+        if (entry.length > 0 && entry.address + entry.length > entry.address) {
+            if (record_count == record_capacity) {
+                size_t capacity = record_capacity == 0 ? PLCRASH_ASYNC_VTASK_INITIAL_CAPACITY : record_capacity * 2;
+                vtask_recording_record_t *grown = realloc(records, sizeof(records[0]) * capacity);
+                if (grown == NULL) {
+                    err = PLCRASH_ENOMEM;
+                    goto cleanup;
+                }
+
+                records = grown;
+                record_capacity = capacity;
+            }
+
+            records[record_count].address = (pl_vm_address_t) entry.address;
+            records[record_count].length = (pl_vm_size_t) entry.length;
+            records[record_count].data = mapping + offset;
+            record_count++;
+        }
+
+        offset += (size_t) entry.length;
+    }
+
+    if ((err = plcrash_nasync_vtask_init(vtask)) != PLCRASH_ESUCCESS)
+        goto cleanup;
+
+    /* Coalesce the records into non-overlapping regions. The recorded memory is expected to be unchanged across
+     * records; where records overlap, the later record (in address order) takes precedence. */
+    qsort(records, record_count, sizeof(records[0]), vtask_recording_record_compare);
+
+    for (size_t first = 0; first < record_count;) {
+        pl_vm_address_t start = records[first].address;
+        pl_vm_address_t end = start + records[first].length;
+        size_t last = first + 1;
+
+        while (last < record_count && records[last].address <= end) {
+            if (records[last].address + records[last].length > end)
+                end = records[last].address + records[last].length;
+            last++;
+        }
+
+        uint8_t *buffer = malloc((size_t) (end - start));
+        if (buffer == NULL) {
+            err = PLCRASH_ENOMEM;
+            break;
+        }
+
+        for (size_t i = first; i < last; i++)
+            memcpy(buffer + (records[i].address - start), records[i].data, (size_t) records[i].length);
+
+        err = plcrash_nasync_vtask_add_region(vtask, start, buffer, end - start, end - start);
+        free(buffer);
+        if (err != PLCRASH_ESUCCESS)
+            break;
+
+        first = last;
+    }
+
+    if (err != PLCRASH_ESUCCESS)
+        plcrash_nasync_vtask_free(vtask);
+
+cleanup:
+    free(records);
+    munmap((void *) mapping, size);
+    return err;
+}
+
+/**
+ * Initialize @a recorder, writing the recording header to @a fd.
+ *
+ * @param recorder The recorder to be initialized.
+ * @param fd An open file descriptor to which the recording will be written. The descriptor is borrowed, and must
+ * remain open for the lifetime of @a recorder.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if the header could not be written.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_vtask_recorder_init (plcrash_async_vtask_recorder_t *recorder, int fd) {
+    vtask_recording_header_t header = {
+        .magic = PLCRASH_VTASK_RECORDING_MAGIC,
+        .version = PLCRASH_VTASK_RECORDING_VERSION
+    };
+
+    recorder->fd = fd;
+    recorder->lock = OS_SPINLOCK_INIT;
+    recorder->records = 0;
+    recorder->bytes = 0;
+    recorder->failed = false;
+
+    if (plcrash_async_writen(fd, &header, sizeof(header)) < 0) {
+        PLCF_DEBUG("Failed to write recording header: %d", errno);
+        return PLCRASH_EINTERNAL;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Install @a recorder as the current recorder, or uninstall the current recorder if NULL. While installed, memory
+ * read from all tasks other than virtual tasks is recorded to @a recorder from all threads.
+ *
+ * @param recorder The recorder to install, or NULL.
+ */
+void plcrash_async_vtask_recorder_set_current (plcrash_async_vtask_recorder_t *recorder) {
+    OSMemoryBarrier();
+    current_recorder = recorder;
+    OSMemoryBarrier();
+}
+
+/**
+ * Return the recorder installed via plcrash_async_vtask_recorder_set_current(), or NULL if none.
+ */
+plcrash_async_vtask_recorder_t *plcrash_async_vtask_recorder_current (void) {
+    return current_recorder;
+}
+
+/**
+ * Append a record of @a length bytes at the task-relative @a address, with the local copy at @a data, to
+ * @a recorder. This function is async-safe.
+ */
+void plcrash_async_vtask_recorder_write (plcrash_async_vtask_recorder_t *recorder, pl_vm_address_t address, const void *data, pl_vm_size_t length) {
+    vtask_recording_entry_t entry = {
+        .address = address,
+        .length = length
+    };
+
+    if (recorder->failed || length == 0)
+        return;
+
+    /* The entry and its data must be written contiguously */
+    OSSpinLockLock(&recorder->lock); {
+        if (plcrash_async_writen(recorder->fd, &entry, sizeof(entry)) < 0 || plcrash_async_writen(recorder->fd, data, (size_t) length) < 0) {
+            recorder->failed = true;
+        } else {
+            recorder->records++;
+            recorder->bytes += length;
+        }
+    } OSSpinLockUnlock(&recorder->lock);
+}
+
+/**
+ * Add a captured region to @a vtask. The region's contents are copied.
+ *
+ * @param vtask The virtual task.
+ * @param address The task-relative address of the first captured byte.
+ * @param data The captured bytes.
+ * @param length The number of bytes available at @a data.
+ * @param size The size of the region. Must be greater than or equal to @a length; the bytes following @a length are
+ * zero-filled, eg, as for a segment's zero-fill memory.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the region would overlap an existing region or
+ * overflow the address space, or PLCRASH_ENOMEM if the region could not be allocated.
+ *
+ * @warning This function is not async-safe, and must not be called while the task is being read. It may only be used
+ * with virtual tasks initialized via plcrash_nasync_vtask_init().
+ */
+plcrash_error_t plcrash_nasync_vtask_add_region (plcrash_async_vtask_t *vtask, pl_vm_address_t address, const void *data, pl_vm_size_t length, pl_vm_size_t size) {
+    PLCF_ASSERT(length <= size);
+    PLCF_ASSERT(vtask->source == &vtask_region_source);
+
+    if (size == 0 || address + size < address)
+        return PLCRASH_EINVAL;
+
+    /* Find the insertion point, rejecting any overlap with the neighbouring regions */
+    size_t idx = 0;
+    while (idx < vtask->count && vtask->regions[idx].address < address)
+        idx++;
+
+    if (idx > 0 && vtask->regions[idx - 1].address + vtask->regions[idx - 1].size > address)
+        return PLCRASH_EINVAL;
+
+    if (idx < vtask->count && address + size > vtask->regions[idx].address)
+        return PLCRASH_EINVAL;
+
+    /* Grow the region array if necessary */
+    if (vtask->count == vtask->capacity) {
+        size_t capacity = vtask->capacity == 0 ? PLCRASH_ASYNC_VTASK_INITIAL_CAPACITY : vtask->capacity * 2;
+        plcrash_async_vtask_region_t *regions = realloc(vtask->regions, sizeof(regions[0]) * capacity);
+        if (regions == NULL)
+            return PLCRASH_ENOMEM;
+
+        vtask->regions = regions;
+        vtask->capacity = capacity;
+    }
+
+    /* Copy the data, preserving its page offset */
+    pl_vm_size_t page_offset = address - mach_vm_trunc_page(address);
+    vm_address_t local = 0;
+    vm_size_t local_size = mach_vm_round_page(page_offset + size);
+    kern_return_t kt = vm_allocate(mach_task_self(), &local, local_size, VM_FLAGS_ANYWHERE);
+    if (kt != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to allocate virtual task region: %d", kt);
+        return PLCRASH_ENOMEM;
+    }
+
+    plcrash_async_memcpy((void *) (local + page_offset), data, length);
+
+    /* Insert the region */
+    memmove(&vtask->regions[idx + 1], &vtask->regions[idx], sizeof(vtask->regions[0]) * (vtask->count - idx));
+    vtask->regions[idx].address = address;
+    vtask->regions[idx].size = size;
+    vtask->regions[idx].local = local;
+    vtask->regions[idx].local_size = local_size;
+    vtask->count++;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the task port name identifying @a vtask. The name may be supplied to any API accepting a target task for
+ * the lifetime of @a vtask.
+ */
+task_t plcrash_async_vtask_port (plcrash_async_vtask_t *vtask) {
+    return vtask->port;
+}
+
+/**
+ * Deregister @a vtask and free all associated resources. The task must not be in use.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_vtask_free (plcrash_async_vtask_t *vtask) {
+    /* Deregister the task */
+    OSSpinLockLock(&vtask_lock); {
+        plcrash_async_vtask_t * volatile *prev = &vtask_list;
+        while (*prev != NULL && *prev != vtask)
+            prev = &(*prev)->next;
+
+        if (*prev != NULL)
+            *prev = vtask->next;
+    } OSSpinLockUnlock(&vtask_lock);
+
+    for (size_t i = 0; i < vtask->count; i++)
+        vm_deallocate(mach_task_self(), vtask->regions[i].local, vtask->regions[i].local_size);
+    free(vtask->regions);
+
+    if (vtask->source->free != NULL)
+        vtask->source->free(vtask->source_ctx);
+
+    mach_port_deallocate(mach_task_self(), vtask->port);
+    mach_port_mod_refs(mach_task_self(), vtask->port, MACH_PORT_RIGHT_RECEIVE, -1);
+}
+
+/**
+ * Return the registered virtual task identified by @a task, or NULL if @a task is not a virtual task.
+ *
+ * @warning This function is async-safe, but the returned virtual task must not be freed while it is in use.
+ */
+plcrash_async_vtask_t *plcrash_async_vtask_lookup (task_t task) {
+    plcrash_async_vtask_t *result = NULL;
+
+    /* Fast path; virtual tasks are never registered by the crash reporter itself */
+    if (vtask_list == NULL)
+        return NULL;
+
+    OSSpinLockLock(&vtask_lock); {
+        for (plcrash_async_vtask_t *vtask = vtask_list; vtask != NULL; vtask = vtask->next) {
+            if (vtask->port == task) {
+                result = vtask;
+                break;
+            }
+        }
+    } OSSpinLockUnlock(&vtask_lock);
+
+    return result;
+}
+
+/**
+ * Copy @a len bytes from @a vtask at @a address to @a dest.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOTFOUND if the range is not available from the task's
+ * memory source.
+ */
+plcrash_error_t plcrash_async_vtask_memcpy (plcrash_async_vtask_t *vtask, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    return vtask->source->copy(vtask->source_ctx, address, dest, len);
+}
+
+/**
+ * Return the local address of the byte at @a address, and the number of contiguous bytes available from it, up to
+ * @a length. The returned memory remains valid for the lifetime of @a vtask.
+ *
+ * @param vtask The virtual task.
+ * @param address The task-relative address.
+ * @param length The number of bytes requested.
+ * @param require_full If true, fail unless all @a length bytes are available.
+ * @param[out] local On success, the local address of @a address. This address shares the page offset of @a address.
+ * @param[out] available On success, the number of bytes available at @a local; at most @a length.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if @a address is not available, or if @a require_full
+ * was set and fewer than @a length bytes are available.
+ */
+plcrash_error_t plcrash_async_vtask_map (plcrash_async_vtask_t *vtask, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                         pl_vm_address_t *local, pl_vm_size_t *available)
+{
+    return vtask->source->map(vtask->source_ctx, address, length, require_full, local, available);
+}
+
+/**
+ * @internal
+ *
+ * Return the region of @a vtask containing @a address, or NULL if none.
+ */
+static plcrash_async_vtask_region_t *vtask_find_region (plcrash_async_vtask_t *vtask, pl_vm_address_t address) {
+    /* Binary search for the first region ending after address */
+    size_t lower = 0;
+    size_t upper = vtask->count;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (vtask->regions[mid].address + vtask->regions[mid].size <= address)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    if (lower == vtask->count || vtask->regions[lower].address > address)
+        return NULL;
+
+    return &vtask->regions[lower];
+}
+
+/* Captured region source copy function. Ranges may not span multiple regions. */
+static plcrash_error_t vtask_region_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    plcrash_async_vtask_region_t *region = vtask_find_region(ctx, address);
+    if (region == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    pl_vm_size_t offset = address - region->address;
+    if (len > region->size - offset)
+        return PLCRASH_ENOTFOUND;
+
+    pl_vm_address_t src = region->local + (region->address - mach_vm_trunc_page(region->address)) + offset;
+    plcrash_async_memcpy(dest, (const void *) (uintptr_t) src, len);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* Captured region source map function. */
+static plcrash_error_t vtask_region_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                         pl_vm_address_t *local, pl_vm_size_t *available)
+{
+    plcrash_async_vtask_region_t *region = vtask_find_region(ctx, address);
+    if (region == NULL)
+        return PLCRASH_ENOMEM;
+
+    pl_vm_size_t offset = address - region->address;
+    pl_vm_size_t remaining = region->size - offset;
+    if (require_full && remaining < length)
+        return PLCRASH_ENOMEM;
+
+    *local = region->local + (region->address - mach_vm_trunc_page(region->address)) + offset;
+    *available = remaining < length ? remaining : length;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* Memory-mapped file source copy function. */
+static plcrash_error_t vtask_file_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    vtask_file_t *file = ctx;
+
+    if (address < file->address || address - file->address > file->size || len > file->size - (address - file->address))
+        return PLCRASH_ENOTFOUND;
+
+    plcrash_async_memcpy(dest, (const uint8_t *) file->mapping + (address - file->address), len);
+    return PLCRASH_ESUCCESS;
+}
+
+/* Memory-mapped file source map function. As the file's task address is page-aligned, the mapping preserves the page
+ * offset of every address. */
+static plcrash_error_t vtask_file_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                       pl_vm_address_t *local, pl_vm_size_t *available)
+{
+    vtask_file_t *file = ctx;
+
+    if (address < file->address || address - file->address >= file->size)
+        return PLCRASH_ENOMEM;
+
+    pl_vm_size_t remaining = file->size - (address - file->address);
+    if (require_full && remaining < length)
+        return PLCRASH_ENOMEM;
+
+    *local = (pl_vm_address_t) (uintptr_t) file->mapping + (address - file->address);
+    *available = remaining < length ? remaining : length;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* Memory-mapped file source free function. */
+static void vtask_file_free (void *ctx) {
+    vtask_file_t *file = ctx;
+
+    munmap(file->mapping, (size_t) file->size);
+    free(file);
+}
+
+/**
+ * @}
+ */
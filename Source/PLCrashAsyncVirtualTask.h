@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_ASYNC_VIRTUAL_TASK_H
+#define PLCRASH_ASYNC_VIRTUAL_TASK_H
+
+#include "PLCrashAsync.h"
+
+#include <libkern/OSAtomic.h>
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vtask
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A captured range of a virtual task's memory.
+ */
+typedef struct plcrash_async_vtask_region {
+    /** The task-relative address of the first byte of the region. */
+    pl_vm_address_t address;
+
+    /** The size of the region, in bytes. */
+    pl_vm_size_t size;
+
+    /** The page-aligned local allocation backing the region. The region's first byte is stored at the same page offset
+     * as @a address, allowing memory objects mapped from the region to preserve the target's page alignment. */
+    pl_vm_address_t local;
+
+    /** The size of the @a local allocation. */
+    pl_vm_size_t local_size;
+} plcrash_async_vtask_region_t;
+
+/**
+ * @internal
+ *
+ * A virtual task memory source, supplying the contents of a virtual task.
+ *
+ * The captured region source is used by plcrash_nasync_vtask_init(), and a memory-mapped file source by
+ * plcrash_nasync_vtask_init_file(); custom sources -- eg, a record/replay log -- may be supplied to
+ * plcrash_nasync_vtask_init_source(). A source's read functions must be async-safe if the virtual task is to be read
+ * from an async-safe context.
+ */
+typedef struct plcrash_async_vtask_source {
+    /**
+     * Copy @a len bytes at the task-relative @a address to @a dest. Returns PLCRASH_ESUCCESS on success, or
+     * PLCRASH_ENOTFOUND if the range is not available.
+     */
+    plcrash_error_t (*copy) (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len);
+
+    /**
+     * Return the local address of the byte at the task-relative @a address, as per plcrash_async_vtask_map(). The
+     * local address must share the page offset of @a address. Returns PLCRASH_ENOMEM if the range is not available.
+     */
+    plcrash_error_t (*map) (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                            pl_vm_address_t *local, pl_vm_size_t *available);
+
+    /** Free @a ctx when the virtual task is freed. May be NULL. */
+    void (*free) (void *ctx);
+} plcrash_async_vtask_source_t;
+
+/**
+ * @internal
+ *
+ * A virtual task, backed by previously captured memory rather than a live process. A virtual task is identified by a
+ * task port name allocated for the purpose, which may be supplied to any API accepting a target task; reads from the
+ * task are served from the captured regions.
+ */
+typedef struct plcrash_async_vtask {
+    /** The task port name identifying this virtual task. */
+    mach_port_t port;
+
+    /** The memory source backing this virtual task. */
+    const plcrash_async_vtask_source_t *source;
+
+    /** The context passed to @a source. */
+    void *source_ctx;
+
+    /** The captured regions, sorted by address. Regions do not overlap. Only used by the captured region source. */
+    plcrash_async_vtask_region_t *regions;
+
+    /** The number of entries in @a regions. */
+    size_t count;
+
+    /** The number of entries allocated at @a regions. */
+    size_t capacity;
+
+    /** The next registered virtual task, or NULL. */
+    struct plcrash_async_vtask *next;
+} plcrash_async_vtask_t;
+
+/**
+ * @internal
+ *
+ * Records all task memory read via plcrash_async_task_memcpy() and plcrash_async_mobject_init() while installed via
+ * plcrash_async_vtask_recorder_set_current(). A recording may be replayed via plcrash_nasync_vtask_init_recording(),
+ * allowing the code that performed the reads -- eg, plcrash_log_writer_write() -- to be re-run deterministically
+ * against the recorded memory.
+ */
+typedef struct plcrash_async_vtask_recorder {
+    /** The file descriptor to which records are written. */
+    int fd;
+
+    /** Serializes record writes from concurrent readers (eg, unwind workers). */
+    OSSpinLock lock;
+
+    /** The number of records written. */
+    volatile int64_t records;
+
+    /** The total number of memory bytes recorded. */
+    volatile int64_t bytes;
+
+    /** True if a write to @a fd has failed; no further records will be written. */
+    volatile bool failed;
+} plcrash_async_vtask_recorder_t;
+
+plcrash_error_t plcrash_nasync_vtask_recorder_init (plcrash_async_vtask_recorder_t *recorder, int fd);
+void plcrash_async_vtask_recorder_set_current (plcrash_async_vtask_recorder_t *recorder);
+plcrash_async_vtask_recorder_t *plcrash_async_vtask_recorder_current (void);
+void plcrash_async_vtask_recorder_write (plcrash_async_vtask_recorder_t *recorder, pl_vm_address_t address, const void *data, pl_vm_size_t length);
+
+/**
+ * Record @a length bytes at the task-relative @a address, read into local memory at @a data, if a recorder is
+ * installed. Reads served from virtual tasks should not be recorded. This function is async-safe.
+ */
+static inline void plcrash_async_vtask_record (pl_vm_address_t address, const void *data, pl_vm_size_t length) {
+    plcrash_async_vtask_recorder_t *recorder = plcrash_async_vtask_recorder_current();
+    if (__builtin_expect(recorder == NULL, 1))
+        return;
+
+    plcrash_async_vtask_recorder_write(recorder, address, data, length);
+}
+
+plcrash_error_t plcrash_nasync_vtask_init (plcrash_async_vtask_t *vtask);
+plcrash_error_t plcrash_nasync_vtask_init_recording (plcrash_async_vtask_t *vtask, const char *path);
+plcrash_error_t plcrash_nasync_vtask_init_file (plcrash_async_vtask_t *vtask, const char *path, pl_vm_address_t address);
+plcrash_error_t plcrash_nasync_vtask_init_source (plcrash_async_vtask_t *vtask, const plcrash_async_vtask_source_t *source, void *ctx);
+plcrash_error_t plcrash_nasync_vtask_add_region (plcrash_async_vtask_t *vtask, pl_vm_address_t address, const void *data, pl_vm_size_t length, pl_vm_size_t size);
+task_t plcrash_async_vtask_port (plcrash_async_vtask_t *vtask);
+void plcrash_nasync_vtask_free (plcrash_async_vtask_t *vtask);
+
+plcrash_async_vtask_t *plcrash_async_vtask_lookup (task_t task);
+plcrash_error_t plcrash_async_vtask_memcpy (plcrash_async_vtask_t *vtask, pl_vm_address_t address, void *dest, pl_vm_size_t len);
+plcrash_error_t plcrash_async_vtask_map (plcrash_async_vtask_t *vtask, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                         pl_vm_address_t *local, pl_vm_size_t *available);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_ASYNC_VIRTUAL_TASK_H */
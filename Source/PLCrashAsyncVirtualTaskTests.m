@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashAsyncVirtualTask.h"
+#import "PLCrashAsyncMObject.h"
+
+#import <fcntl.h>
+
+/* Custom source that serves a fixed byte for every address, counting the number of reads */
+struct constant_source {
+    uint8_t value;
+    uint8_t page[PAGE_SIZE * 2];
+    size_t reads;
+};
+
+static plcrash_error_t constant_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    struct constant_source *src = ctx;
+    src->reads++;
+    memset(dest, src->value, len);
+    return PLCRASH_ESUCCESS;
+}
+
+static plcrash_error_t constant_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                     pl_vm_address_t *local, pl_vm_size_t *available)
+{
+    struct constant_source *src = ctx;
+    pl_vm_address_t page = mach_vm_round_page((pl_vm_address_t) src->page);
+    pl_vm_size_t offset = address & PAGE_MASK;
+
+    src->reads++;
+    if (require_full && length > PAGE_SIZE - offset)
+        return PLCRASH_ENOMEM;
+
+    memset((void *) page, src->value, PAGE_SIZE);
+    *local = page + offset;
+    *available = MIN(length, PAGE_SIZE - offset);
+    return PLCRASH_ESUCCESS;
+}
+
+static const plcrash_async_vtask_source_t constant_source_ops = {
+    .copy = constant_copy,
+    .map = constant_map,
+    .free = NULL
+};
+
+@interface PLCrashAsyncVirtualTaskTests : SenTestCase {
+@private
+    plcrash_async_vtask_t _vtask;
+}
+/**
+ * Verify that reads from a file-backed virtual task are served from the file.
+ */
+- (void) testFileSource {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSMutableData *contents = [NSMutableData dataWithLength: PAGE_SIZE + 16];
+    memset_pattern4([contents mutableBytes], (const uint8_t[]){ 0xC, 0xA, 0xF, 0xE }, [contents length]);
+    STAssertTrue([contents writeToFile: path atomically: NO], @"Failed to write test file");
+
+    const pl_vm_address_t base = 0x20000000;
+    plcrash_async_vtask_t vtask;
+
+    STAssertEquals(plcrash_nasync_vtask_init_file(&vtask, [path fileSystemRepresentation], base + 1), PLCRASH_EINVAL, @"Unaligned address should be rejected");
+    STAssertEquals(plcrash_nasync_vtask_init_file(&vtask, [path fileSystemRepresentation], base), PLCRASH_ESUCCESS, @"Failed to initialize virtual task");
+
+    uint8_t dest[16];
+    task_t task = plcrash_async_vtask_port(&vtask);
+    STAssertEquals(plcrash_async_task_memcpy(task, base, PAGE_SIZE, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertTrue(memcmp(dest, (const uint8_t *) [contents bytes] + PAGE_SIZE, sizeof(dest)) == 0, @"Incorrect data");
+    STAssertNotEquals(plcrash_async_task_memcpy(task, base, PAGE_SIZE + 1, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read beyond the file should fail");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, task, base + 8, PAGE_SIZE, true), PLCRASH_ESUCCESS, @"Failed to initialize mapping");
+    STAssertTrue(memcmp((void *) mobj.address, (const uint8_t *) [contents bytes] + 8, PAGE_SIZE) == 0, @"Mapping appears to be incorrect");
+    plcrash_async_mobject_free(&mobj);
+
+    plcrash_nasync_vtask_free(&vtask);
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+/**
+ * Verify that reads are dispatched to a custom memory source.
+ */
+- (void) testCustomSource {
+    struct constant_source src = { .value = 0x5A, .reads = 0 };
+    plcrash_async_vtask_t vtask;
+    uint8_t dest[4];
+
+    STAssertEquals(plcrash_nasync_vtask_init_source(&vtask, &constant_source_ops, &src), PLCRASH_ESUCCESS, @"Failed to initialize virtual task");
+
+    STAssertEquals(plcrash_async_task_memcpy(plcrash_async_vtask_port(&vtask), 0x1234, 0, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertEquals(dest[3], (uint8_t) 0x5A, @"Incorrect data");
+    STAssertEquals(src.reads, (size_t) 1, @"Read was not dispatched to the source");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, plcrash_async_vtask_port(&vtask), 0x1234, 16, true), PLCRASH_ESUCCESS, @"Failed to initialize mapping");
+    STAssertEquals(*(uint8_t *) mobj.address, (uint8_t) 0x5A, @"Incorrect mapped data");
+    STAssertEquals(src.reads, (size_t) 2, @"Mapping was not dispatched to the source");
+    plcrash_async_mobject_free(&mobj);
+
+    plcrash_nasync_vtask_free(&vtask);
+}
+
+@end
+
+/**
+ * Tests for the virtual task implementation.
+ */
+@implementation PLCrashAsyncVirtualTaskTests
+
+/* An arbitrary target address that is not page aligned */
+#define TARGET_ADDR ((pl_vm_address_t) 0x10000010)
+
+- (void) setUp {
+    STAssertEquals(plcrash_nasync_vtask_init(&_vtask), PLCRASH_ESUCCESS, @"Failed to initialize virtual task");
+}
+
+- (void) tearDown {
+    plcrash_nasync_vtask_free(&_vtask);
+}
+
+/**
+ * Verify that reads are served from the captured regions, and zero-filled beyond the captured bytes.
+ */
+- (void) testMemcpy {
+    const uint8_t data[] = { 0xC, 0xA, 0xF, 0xE };
+    uint8_t dest[8];
+    task_t task = plcrash_async_vtask_port(&_vtask);
+
+    STAssertEquals(plcrash_nasync_vtask_add_region(&_vtask, TARGET_ADDR, data, sizeof(data), sizeof(dest)), PLCRASH_ESUCCESS, @"Failed to add region");
+    STAssertEquals(plcrash_async_vtask_lookup(task), &_vtask, @"Virtual task was not registered");
+    STAssertNULL(plcrash_async_vtask_lookup(mach_task_self()), @"The current task should not resolve to a virtual task");
+
+    memset(dest, 0xFF, sizeof(dest));
+    STAssertEquals(plcrash_async_task_memcpy(task, TARGET_ADDR, 0, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertTrue(memcmp(dest, data, sizeof(data)) == 0, @"Incorrect data");
+    STAssertEquals(dest[4], (uint8_t) 0, @"Bytes beyond the captured data should be zero-filled");
+
+    /* Reads outside of (or spanning beyond) the region must fail */
+    STAssertNotEquals(plcrash_async_task_memcpy(task, TARGET_ADDR, 4, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read beyond the region should fail");
+    STAssertNotEquals(plcrash_async_task_memcpy(task, TARGET_ADDR - 1, 0, dest, 1), PLCRASH_ESUCCESS, @"Read before the region should fail");
+}
+
+/**
+ * Verify that memory objects may be initialized from a virtual task, preserving the target's page offset.
+ */
+- (void) testMObject {
+    size_t size = vm_page_size + 1;
+    uint8_t *data = malloc(size);
+    memset_pattern4(data, (const uint8_t[]){ 0xC, 0xA, 0xF, 0xE }, size);
+
+    STAssertEquals(plcrash_nasync_vtask_add_region(&_vtask, TARGET_ADDR, data, size, size), PLCRASH_ESUCCESS, @"Failed to add region");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, plcrash_async_vtask_port(&_vtask), TARGET_ADDR, size, true), PLCRASH_ESUCCESS, @"Failed to initialize mapping");
+    STAssertTrue(memcmp((void *) mobj.address, data, size) == 0, @"Mapping appears to be incorrect");
+    STAssertEquals(TARGET_ADDR, (pl_vm_address_t) (mobj.address + mobj.vm_slide), @"Incorrect slide value");
+    STAssertEquals((pl_vm_address_t) (mobj.address & vm_page_mask), (pl_vm_address_t) (TARGET_ADDR & vm_page_mask), @"Page offset was not preserved");
+
+    plcrash_async_mobject_free(&mobj);
+    free(data);
+}
+
+/**
+ * Verify that overlapping regions are rejected.
+ */
+- (void) testOverlap {
+    const uint8_t data[16] = { 0 };
+
+    STAssertEquals(plcrash_nasync_vtask_add_region(&_vtask, TARGET_ADDR, data, sizeof(data), sizeof(data)), PLCRASH_ESUCCESS, @"Failed to add region");
+    STAssertEquals(plcrash_nasync_vtask_add_region(&_vtask, TARGET_ADDR + 8, data, sizeof(data), sizeof(data)), PLCRASH_EINVAL, @"Overlapping region was accepted");
+    STAssertEquals(plcrash_nasync_vtask_add_region(&_vtask, TARGET_ADDR + 16, data, sizeof(data), sizeof(data)), PLCRASH_ESUCCESS, @"Adjacent region was rejected");
+}
+
+/**
+ * Verify that reads from a file-backed virtual task are served from the file.
+ */
+- (void) testFileSource {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSMutableData *contents = [NSMutableData dataWithLength: PAGE_SIZE + 16];
+    memset_pattern4([contents mutableBytes], (const uint8_t[]){ 0xC, 0xA, 0xF, 0xE }, [contents length]);
+    STAssertTrue([contents writeToFile: path atomically: NO], @"Failed to write test file");
+
+    const pl_vm_address_t base = 0x20000000;
+    plcrash_async_vtask_t vtask;
+
+    STAssertEquals(plcrash_nasync_vtask_init_file(&vtask, [path fileSystemRepresentation], base + 1), PLCRASH_EINVAL, @"Unaligned address should be rejected");
+    STAssertEquals(plcrash_nasync_vtask_init_file(&vtask, [path fileSystemRepresentation], base), PLCRASH_ESUCCESS, @"Failed to initialize virtual task");
+
+    uint8_t dest[16];
+    task_t task = plcrash_async_vtask_port(&vtask);
+    STAssertEquals(plcrash_async_task_memcpy(task, base, PAGE_SIZE, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertTrue(memcmp(dest, (const uint8_t *) [contents bytes] + PAGE_SIZE, sizeof(dest)) == 0, @"Incorrect data");
+    STAssertNotEquals(plcrash_async_task_memcpy(task, base, PAGE_SIZE + 1, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read beyond the file should fail");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, task, base + 8, PAGE_SIZE, true), PLCRASH_ESUCCESS, @"Failed to initialize mapping");
+    STAssertTrue(memcmp((void *) mobj.address, (const uint8_t *) [contents bytes] + 8, PAGE_SIZE) == 0, @"Mapping appears to be incorrect");
+    plcrash_async_mobject_free(&mobj);
+
+    plcrash_nasync_vtask_free(&vtask);
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+/**
+ * Verify that reads are dispatched to a custom memory source.
+ */
+- (void) testCustomSource {
+    struct constant_source src = { .value = 0x5A, .reads = 0 };
+    plcrash_async_vtask_t vtask;
+    uint8_t dest[4];
+
+    STAssertEquals(plcrash_nasync_vtask_init_source(&vtask, &constant_source_ops, &src), PLCRASH_ESUCCESS, @"Failed to initialize virtual task");
+
+    STAssertEquals(plcrash_async_task_memcpy(plcrash_async_vtask_port(&vtask), 0x1234, 0, dest, sizeof(dest)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertEquals(dest[3], (uint8_t) 0x5A, @"Incorrect data");
+    STAssertEquals(src.reads, (size_t) 1, @"Read was not dispatched to the source");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_mobject_init(&mobj, plcrash_async_vtask_port(&vtask), 0x1234, 16, true), PLCRASH_ESUCCESS, @"Failed to initialize mapping");
+    STAssertEquals(*(uint8_t *) mobj.address, (uint8_t) 0x5A, @"Incorrect mapped data");
+    STAssertEquals(src.reads, (size_t) 2, @"Mapping was not dispatched to the source");
+    plcrash_async_mobject_free(&mobj);
+
+    plcrash_nasync_vtask_free(&vtask);
+}
+
+/**
+ * Verify that recorded reads are replayed, with overlapping records coalesced into a single region.
+ */
+- (void) testRecordReplay {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    int fd = open([path fileSystemRepresentation], O_RDWR|O_CREAT|O_TRUNC, 0644);
+    STAssertTrue(fd >= 0, @"Failed to open recording file");
+
+    uint8_t source[64];
+    uint8_t dest[64];
+    for (size_t i = 0; i < sizeof(source); i++)
+        source[i] = (uint8_t) i;
+
+    /* Record two overlapping reads, and one disjoint read */
+    plcrash_async_vtask_recorder_t recorder;
+    STAssertEquals(plcrash_nasync_vtask_recorder_init(&recorder, fd), PLCRASH_ESUCCESS, @"Failed to initialize recorder");
+    plcrash_async_vtask_recorder_set_current(&recorder);
+    STAssertEquals(plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) source, 0, dest, 32), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertEquals(plcrash_async_task_memcpy(mach_task_self(), (pl_vm_address_t) source, 16, dest, 32), PLCRASH_ESUCCESS, @"Read failed");
+    plcrash_async_vtask_recorder_set_current(NULL);
+    close(fd);
+
+    STAssertEquals(recorder.records, (int64_t) 2, @"Incorrect record count");
+
+    /* Replay a read spanning both records */
+    plcrash_async_vtask_t vtask;
+    STAssertEquals(plcrash_nasync_vtask_init_recording(&vtask, [path fileSystemRepresentation]), PLCRASH_ESUCCESS, @"Failed to load recording");
+    STAssertEquals(vtask.count, (size_t) 1, @"Overlapping records were not coalesced");
+
+    memset(dest, 0, sizeof(dest));
+    STAssertEquals(plcrash_async_task_memcpy(plcrash_async_vtask_port(&vtask), (pl_vm_address_t) source, 8, dest, 40), PLCRASH_ESUCCESS, @"Replayed read failed");
+    STAssertTrue(memcmp(dest, source + 8, 40) == 0, @"Incorrect replayed data");
+    STAssertNotEquals(plcrash_async_task_memcpy(plcrash_async_vtask_port(&vtask), (pl_vm_address_t) source, 48, dest, 1), PLCRASH_ESUCCESS, @"Unrecorded memory should not be readable");
+
+    plcrash_nasync_vtask_free(&vtask);
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+@end
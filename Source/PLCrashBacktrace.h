@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/** Opaque backtrace state, shared by PLCrashBacktrace and the thread snapshot functions. */
+typedef struct plcrash_backtrace_state plcrash_backtrace_state_t;
+
+/** The image index of a snapshot frame that does not fall within any loaded image. */
+#define PLCRASH_BACKTRACE_NO_IMAGE SIZE_MAX
+
+/** The maximum number of registers recorded per snapshot thread. */
+#define PLCRASH_BACKTRACE_MAX_REGISTERS 64
+
+/**
+ * A single stack frame of a thread snapshot.
+ */
+typedef struct plcrash_backtrace_frame {
+    /** The frame's instruction pointer. */
+    uint64_t pc;
+
+    /** The frame's stack pointer. */
+    uint64_t sp;
+
+    /** The index of the image containing @a pc within the snapshot's image list, or PLCRASH_BACKTRACE_NO_IMAGE. */
+    size_t image_index;
+} plcrash_backtrace_frame_t;
+
+/**
+ * A single thread of a thread snapshot.
+ */
+typedef struct plcrash_backtrace_thread {
+    /** The thread's system-wide unique identifier, as returned by pthread_threadid_np(). */
+    uint64_t thread_id;
+
+    /** The number of entries in @a registers. Register names are returned by plcrash_backtrace_register_name(). */
+    uint32_t register_count;
+
+    /** The thread's register values, indexed by register number. Unavailable registers are zero. */
+    uint64_t registers[PLCRASH_BACKTRACE_MAX_REGISTERS];
+
+    /** The thread's frames, beginning with the innermost frame. Points into the caller's frame buffer. */
+    plcrash_backtrace_frame_t *frames;
+
+    /** The number of entries in @a frames. */
+    size_t frame_count;
+} plcrash_backtrace_thread_t;
+
+plcrash_backtrace_state_t *plcrash_backtrace_state_new (void);
+void plcrash_backtrace_state_free (plcrash_backtrace_state_t *state);
+
+bool plcrash_backtrace_snapshot_threads (plcrash_backtrace_state_t *state,
+                                         plcrash_backtrace_thread_t *threads, size_t max_threads,
+                                         plcrash_backtrace_frame_t *frames, size_t max_frames,
+                                         size_t max_thread_frames,
+                                         size_t *thread_count);
+
+const char *plcrash_backtrace_register_name (plcrash_backtrace_state_t *state, uint32_t regnum);
+bool plcrash_backtrace_image_info (plcrash_backtrace_state_t *state, size_t image_index, uint64_t *base_address, const char **path);
+bool plcrash_backtrace_symbolicate_frame (plcrash_backtrace_state_t *state, const plcrash_backtrace_frame_t *frame,
+                                          char *name, size_t name_size, uint64_t *symbol_address);
+
+@interface PLCrashBacktrace : NSObject {
+@private
+    /** Image list and unwind caches shared by all captures. */
+    plcrash_backtrace_state_t *_state;
+}
+
+- (NSUInteger) captureInstructionPointers: (uint64_t *) instructionPointers maximumCount: (NSUInteger) maximumCount;
+- (NSArray *) instructionPointersWithMaximumCount: (NSUInteger) maximumCount;
+
+@end
@@ -0,0 +1,716 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashBacktrace.h"
+
+#import "PLCrashAsyncThread.h"
+#import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashAsyncMObject.h"
+#import "PLCrashAsyncSymbolication.h"
+#import "PLCrashFrameWalker.h"
+#import "PLCrashFrameCompactUnwind.h"
+#import "PLCrashFrameDWARFUnwind.h"
+#import "PLCrashFeatureConfig.h"
+
+#import <pthread.h>
+
+/**
+ * @internal
+ *
+ * The number of frames unwound per plframe_cursor_walk() call.
+ */
+#define PLCRASH_BACKTRACE_WALK_BATCH 16
+
+/**
+ * @internal
+ *
+ * The number of frames belonging to PLCrashBacktrace itself at the top of each captured stack: the capture function,
+ * and the public method that called it.
+ */
+#define PLCRASH_BACKTRACE_INTERNAL_FRAMES 2
+
+/**
+ * @internal
+ *
+ * Backtrace state. All fields are guarded by @a lock.
+ */
+struct plcrash_backtrace_state {
+    /** Lock serializing captures; the image list and unwind caches may only be used by one capture at a time. */
+    pthread_mutex_t lock;
+
+    /** Backing allocator for the image list and unwind caches. */
+    plcrash_async_allocator_t *allocator;
+
+    /** The current process' dynamic loader, with the image monitor enabled if available. */
+    plcrash_async_dynloader_t *loader;
+
+    /** The cached image list, or NULL if not yet read. */
+    plcrash_async_image_list_t *image_list;
+
+    /** If true, @a image_list was read at image list generation @a generation, and may be reused until the generation
+     * changes. Without the image monitor, generations are unavailable, and the image list is read on every capture. */
+    bool has_generation;
+
+    /** The image list generation of @a image_list. Only valid if @a has_generation is true. */
+    uint32_t generation;
+
+    /** The image unload count at which the unwind caches were populated. */
+    uint32_t unload_count;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /** The DWARF unwind cache, or NULL if unavailable. */
+    plframe_dwarf_cache_t *dwarf_cache;
+
+    /** The compact unwind cache, or NULL if unavailable. */
+    plframe_compact_unwind_cache_t *compact_unwind_cache;
+#endif
+
+    /** Unwind section mappings for the images of @a image_list; emptied whenever the image list is released. */
+    plcrash_async_macho_section_cache_t section_cache;
+
+    /** If true, @a symbol_cache has been initialized. The cache is populated by plcrash_backtrace_symbolicate_frame(),
+     * and is discarded along with the unwind caches. */
+    bool has_symbol_cache;
+
+    /** The symbol lookup cache. Only valid if @a has_symbol_cache is true. */
+    plcrash_async_symbol_cache_t symbol_cache;
+
+    /** If true, @a register_state holds the register state of a thread captured by the most recent snapshot. */
+    bool has_register_state;
+
+    /** A thread state from the most recent snapshot, used to resolve register names. */
+    plcrash_async_thread_state_t register_state;
+};
+
+/**
+ * @internal
+ *
+ * Capture context passed through plcrash_async_thread_state_current().
+ */
+typedef struct plcrash_backtrace_capture_ctx {
+    /** The backtrace state. */
+    plcrash_backtrace_state_t *state;
+
+    /** The destination for captured instruction pointers. */
+    uint64_t *pcs;
+
+    /** The capacity of @a pcs. */
+    size_t max;
+
+    /** The number of outermost frames remaining to be skipped. */
+    size_t skip;
+
+    /** The number of instruction pointers written to @a pcs. */
+    size_t count;
+} plcrash_backtrace_capture_ctx_t;
+
+/**
+ * @internal
+ *
+ * Discard the unwind and symbol caches held by @a state.
+ */
+static void plcrash_backtrace_free_caches (plcrash_backtrace_state_t *state) {
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (state->dwarf_cache != NULL) {
+        plframe_dwarf_cache_free(state->dwarf_cache, state->allocator);
+        state->dwarf_cache = NULL;
+    }
+
+    if (state->compact_unwind_cache != NULL) {
+        plframe_compact_unwind_cache_free(state->compact_unwind_cache, state->allocator);
+        state->compact_unwind_cache = NULL;
+    }
+#endif
+
+    plcrash_async_macho_section_cache_free(&state->section_cache);
+
+    if (state->has_symbol_cache) {
+        plcrash_async_symbol_cache_free(&state->symbol_cache);
+        state->has_symbol_cache = false;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Bring @a state's image list and unwind caches up to date with the process' currently loaded images. In the common
+ * case -- no images loaded or unloaded since the previous capture -- this performs no allocation.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if no image list is available.
+ */
+static plcrash_error_t plcrash_backtrace_refresh (plcrash_backtrace_state_t *state) {
+    uint32_t unload_count = 0;
+    uint32_t generation;
+    plcrash_error_t err;
+
+    /* The unwind caches are keyed by address, and must be discarded if an image has been unloaded since they were
+     * populated. Without the image monitor, unloads can not be detected, and the caches are not retained. */
+    bool monitored = plcrash_async_dynloader_image_unload_count(state->loader, &unload_count);
+    if (!monitored || unload_count != state->unload_count) {
+        plcrash_backtrace_free_caches(state);
+        plcrash_async_mobject_region_cache_reset();
+        state->unload_count = unload_count;
+    }
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (state->dwarf_cache == NULL && plframe_dwarf_cache_new(&state->dwarf_cache, state->allocator) != PLCRASH_ESUCCESS)
+        state->dwarf_cache = NULL;
+
+    if (state->compact_unwind_cache == NULL && plframe_compact_unwind_cache_new(&state->compact_unwind_cache, state->allocator) != PLCRASH_ESUCCESS)
+        state->compact_unwind_cache = NULL;
+#endif
+
+    /* Reuse the image list if no images have been loaded or unloaded since it was read. The generation is fetched
+     * prior to reading the list, so that a concurrent change is detected by the next capture. */
+    bool has_generation = plcrash_async_dynloader_image_generation(state->loader, &generation);
+    if (state->image_list != NULL && has_generation && state->has_generation && generation == state->generation)
+        return PLCRASH_ESUCCESS;
+
+    if (state->image_list != NULL) {
+        plcrash_async_macho_section_cache_free(&state->section_cache);
+        plcrash_async_image_list_free(state->image_list);
+        state->image_list = NULL;
+    }
+
+    if ((err = plcrash_async_dynloader_read_image_list(state->loader, state->allocator, &state->image_list)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Fetching image list failed: %d", err);
+        state->image_list = NULL;
+        state->has_generation = false;
+        return err;
+    }
+
+    state->has_generation = has_generation;
+    state->generation = generation;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Initialize @a cursor from @a thread_state, using @a state's image list and unwind caches. On failure, @a cursor
+ * must still be freed via plframe_cursor_free().
+ */
+static plframe_error_t plcrash_backtrace_cursor_init (plcrash_backtrace_state_t *state, plframe_cursor_t *cursor, plcrash_async_thread_state_t *thread_state) {
+    plframe_error_t ferr;
+
+    if ((ferr = plframe_cursor_init(cursor, mach_task_self(), thread_state, state->image_list)) != PLFRAME_ESUCCESS) {
+        PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
+        return ferr;
+    }
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (state->dwarf_cache != NULL)
+        plframe_cursor_set_dwarf_cache(cursor, state->dwarf_cache);
+
+    if (state->compact_unwind_cache != NULL)
+        plframe_cursor_set_compact_unwind_cache(cursor, state->compact_unwind_cache);
+#endif
+
+    plframe_cursor_set_section_cache(cursor, &state->section_cache);
+
+    return PLFRAME_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Walk the calling thread's stack from @a thread_state, recording instruction pointers to the capture context.
+ */
+static plcrash_error_t plcrash_backtrace_walk (plcrash_async_thread_state_t *thread_state, void *context) {
+    plcrash_backtrace_capture_ctx_t *ctx = context;
+    plframe_walk_frame_t frames[PLCRASH_BACKTRACE_WALK_BATCH];
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+
+    if (plcrash_backtrace_cursor_init(ctx->state, &cursor, thread_state) != PLFRAME_ESUCCESS) {
+        plframe_cursor_free(&cursor);
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Unwind no more frames than are required to fill the caller's buffer */
+    while (ctx->count < ctx->max) {
+        size_t remaining = ctx->skip + (ctx->max - ctx->count);
+        size_t count;
+
+        ferr = plframe_cursor_walk(&cursor, frames, remaining < PLCRASH_BACKTRACE_WALK_BATCH ? remaining : PLCRASH_BACKTRACE_WALK_BATCH, &count);
+        for (size_t i = 0; i < count; i++) {
+            if (ctx->skip > 0) {
+                ctx->skip--;
+                continue;
+            }
+
+            ctx->pcs[ctx->count++] = frames[i].pc;
+        }
+
+        if (ferr != PLFRAME_ESUCCESS)
+            break;
+    }
+
+    plframe_cursor_free(&cursor);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Capture the calling thread's instruction pointers, omitting this function and its caller.
+ *
+ * This must not be inlined; the number of omitted frames assumes that this function, and the PLCrashBacktrace method
+ * that called it, each have their own frame.
+ *
+ * @return Returns the number of instruction pointers written to @a pcs.
+ */
+static __attribute__((noinline)) size_t plcrash_backtrace_capture (plcrash_backtrace_state_t *state, uint64_t *pcs, size_t max) {
+    plcrash_backtrace_capture_ctx_t ctx = {
+        .state = state,
+        .pcs = pcs,
+        .max = max,
+        .skip = PLCRASH_BACKTRACE_INTERNAL_FRAMES,
+        .count = 0
+    };
+
+    if (max == 0)
+        return 0;
+
+    pthread_mutex_lock(&state->lock);
+    if (plcrash_backtrace_refresh(state) == PLCRASH_ESUCCESS)
+        plcrash_async_thread_state_current(plcrash_backtrace_walk, &ctx);
+    pthread_mutex_unlock(&state->lock);
+
+    return ctx.count;
+}
+
+
+/**
+ * @internal
+ *
+ * Context passed to plcrash_backtrace_symbol_cb().
+ */
+typedef struct plcrash_backtrace_symbol_ctx {
+    /** The destination for the symbol name. */
+    char *name;
+
+    /** The size of @a name, in bytes. */
+    size_t name_size;
+
+    /** The symbol's start address. */
+    uint64_t address;
+
+    /** True if a symbol was found. */
+    bool found;
+} plcrash_backtrace_symbol_ctx_t;
+
+/**
+ * @internal
+ *
+ * plcrash_async_find_symbol() callback, copying the symbol to a plcrash_backtrace_symbol_ctx_t.
+ */
+static void plcrash_backtrace_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    plcrash_backtrace_symbol_ctx_t *sctx = ctx;
+
+    if (sctx->name != NULL && sctx->name_size > 0)
+        strlcpy(sctx->name, name, sctx->name_size);
+
+    sctx->address = address;
+    sctx->found = true;
+}
+
+/**
+ * @internal
+ *
+ * Record the identifier, registers, and up to @a max_frames frames of the suspended @a thread to @a record.
+ */
+static void plcrash_backtrace_snapshot_thread (plcrash_backtrace_state_t *state, thread_t thread, plcrash_backtrace_thread_t *record,
+                                               plcrash_backtrace_frame_t *frames, size_t max_frames)
+{
+    thread_identifier_info_data_t ident;
+    mach_msg_type_number_t ident_count = THREAD_IDENTIFIER_INFO_COUNT;
+    plframe_walk_frame_t batch[PLCRASH_BACKTRACE_WALK_BATCH];
+    plcrash_async_thread_state_t thread_state;
+    plframe_cursor_t cursor;
+
+    record->thread_id = 0;
+    record->register_count = 0;
+    record->frames = frames;
+    record->frame_count = 0;
+
+    if (thread_info(thread, THREAD_IDENTIFIER_INFO, (thread_info_t) &ident, &ident_count) == KERN_SUCCESS)
+        record->thread_id = ident.thread_id;
+
+    if (plcrash_async_thread_state_mach_thread_init(&thread_state, thread) != PLCRASH_ESUCCESS)
+        return;
+
+    /* Record the thread's registers */
+    size_t reg_count = plcrash_async_thread_state_get_reg_count(&thread_state);
+    if (reg_count > PLCRASH_BACKTRACE_MAX_REGISTERS)
+        reg_count = PLCRASH_BACKTRACE_MAX_REGISTERS;
+
+    for (plcrash_regnum_t i = 0; i < reg_count; i++) {
+        if (plcrash_async_thread_state_has_reg(&thread_state, i))
+            record->registers[i] = plcrash_async_thread_state_get_reg(&thread_state, i);
+        else
+            record->registers[i] = 0;
+    }
+    record->register_count = (uint32_t) reg_count;
+
+    if (!state->has_register_state) {
+        plcrash_async_thread_state_copy(&state->register_state, &thread_state);
+        state->has_register_state = true;
+    }
+
+    /* Walk the thread's frames directly into the caller's buffer */
+    if (plcrash_backtrace_cursor_init(state, &cursor, &thread_state) == PLFRAME_ESUCCESS) {
+        while (record->frame_count < max_frames) {
+            size_t remaining = max_frames - record->frame_count;
+            size_t count;
+
+            plframe_error_t ferr = plframe_cursor_walk(&cursor, batch, remaining < PLCRASH_BACKTRACE_WALK_BATCH ? remaining : PLCRASH_BACKTRACE_WALK_BATCH, &count);
+            for (size_t i = 0; i < count; i++) {
+                plcrash_backtrace_frame_t *frame = &frames[record->frame_count++];
+                frame->pc = batch[i].pc;
+                frame->sp = batch[i].sp;
+                frame->image_index = batch[i].image_index == PLFRAME_WALK_NO_IMAGE ? PLCRASH_BACKTRACE_NO_IMAGE : batch[i].image_index;
+            }
+
+            if (ferr != PLFRAME_ESUCCESS)
+                break;
+        }
+    }
+
+    plframe_cursor_free(&cursor);
+}
+
+/**
+ * Allocate a new backtrace state, for use with plcrash_backtrace_snapshot_threads().
+ *
+ * The state retains the process' image list and unwind caches across snapshots, refreshing them only when images are
+ * loaded or unloaded. A single state may be shared across threads; snapshots and symbol lookups are serialized.
+ *
+ * @return Returns the new state, or NULL if the process' image list could not be accessed. The state must be freed
+ * via plcrash_backtrace_state_free().
+ */
+plcrash_backtrace_state_t *plcrash_backtrace_state_new (void) {
+    plcrash_backtrace_state_t *state;
+    plcrash_error_t err;
+
+    if ((state = calloc(1, sizeof(*state))) == NULL)
+        return NULL;
+    pthread_mutex_init(&state->lock, NULL);
+    plcrash_async_macho_section_cache_init(&state->section_cache);
+
+    if ((err = plcrash_async_allocator_create(&state->allocator, PAGE_SIZE)) != PLCRASH_ESUCCESS) {
+        plcrash_backtrace_state_free(state);
+        return NULL;
+    }
+
+    if ((err = plcrash_nasync_dynloader_new(&state->loader, state->allocator, mach_task_self())) != PLCRASH_ESUCCESS) {
+        plcrash_backtrace_state_free(state);
+        return NULL;
+    }
+
+    /* The image monitor provides the generation and unload counts that allow the image list and unwind caches to be
+     * retained across captures. Failure is non-fatal, but every capture must then re-read the image list. */
+    if ((err = plcrash_nasync_dynloader_enable_image_monitor(state->loader)) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not enable the backtrace image monitor: %d", err);
+
+    return state;
+}
+
+/**
+ * Free a backtrace state allocated via plcrash_backtrace_state_new().
+ *
+ * @param state The state to free, or NULL.
+ */
+void plcrash_backtrace_state_free (plcrash_backtrace_state_t *state) {
+    if (state == NULL)
+        return;
+
+    plcrash_backtrace_free_caches(state);
+
+    if (state->image_list != NULL)
+        plcrash_async_image_list_free(state->image_list);
+
+    if (state->loader != NULL)
+        plcrash_async_dynloader_free(state->loader);
+
+    if (state->allocator != NULL)
+        plcrash_async_allocator_free(state->allocator);
+
+    pthread_mutex_destroy(&state->lock);
+    free(state);
+}
+
+/**
+ * Snapshot the stacks of all threads in the current process other than the calling thread, writing plain thread
+ * records to caller-provided storage. No report is encoded, no files are written, and no Objective-C objects are
+ * allocated; symbol lookup is deferred to plcrash_backtrace_symbolicate_frame().
+ *
+ * All threads are suspended for the duration of the walk. The image list and unwind caches are refreshed prior to
+ * suspension, and no locks are acquired and no heap memory is allocated while threads are suspended.
+ *
+ * The image indices of the returned frames, and the results of plcrash_backtrace_image_info(),
+ * plcrash_backtrace_register_name(), and plcrash_backtrace_symbolicate_frame(), are only valid until the next snapshot
+ * is taken with @a state.
+ *
+ * @param state The backtrace state.
+ * @param threads The destination for the thread records.
+ * @param max_threads The capacity of @a threads. Threads beyond this count are omitted.
+ * @param frames The frame storage shared by all thread records; each record's frames are written contiguously.
+ * @param max_frames The capacity of @a frames. Once exhausted, the remaining threads are recorded without frames.
+ * @param max_thread_frames The maximum number of frames recorded per thread.
+ * @param thread_count On return, the number of records written to @a threads.
+ *
+ * @return Returns true on success, or false if the image list or thread list could not be read.
+ */
+bool plcrash_backtrace_snapshot_threads (plcrash_backtrace_state_t *state,
+                                         plcrash_backtrace_thread_t *threads, size_t max_threads,
+                                         plcrash_backtrace_frame_t *frames, size_t max_frames,
+                                         size_t max_thread_frames,
+                                         size_t *thread_count)
+{
+    thread_t self = pl_mach_thread_self();
+    thread_act_array_t task_thread_list;
+    mach_msg_type_number_t task_thread_count;
+    size_t frame_offset = 0;
+    size_t count = 0;
+
+    *thread_count = 0;
+
+    pthread_mutex_lock(&state->lock);
+    if (plcrash_backtrace_refresh(state) != PLCRASH_ESUCCESS) {
+        pthread_mutex_unlock(&state->lock);
+        return false;
+    }
+
+    if (task_threads(mach_task_self(), &task_thread_list, &task_thread_count) != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetching thread list failed");
+        pthread_mutex_unlock(&state->lock);
+        return false;
+    }
+
+    /* Suspend all threads other than our own, and walk their stacks */
+    for (mach_msg_type_number_t i = 0; i < task_thread_count; i++) {
+        if (task_thread_list[i] != self)
+            thread_suspend(task_thread_list[i]);
+    }
+
+    for (mach_msg_type_number_t i = 0; i < task_thread_count && count < max_threads; i++) {
+        if (task_thread_list[i] == self)
+            continue;
+
+        size_t available = max_frames - frame_offset;
+        if (available > max_thread_frames)
+            available = max_thread_frames;
+
+        plcrash_backtrace_thread_t *record = &threads[count++];
+        plcrash_backtrace_snapshot_thread(state, task_thread_list[i], record, frames + frame_offset, available);
+        frame_offset += record->frame_count;
+    }
+
+    for (mach_msg_type_number_t i = 0; i < task_thread_count; i++) {
+        if (task_thread_list[i] != self)
+            thread_resume(task_thread_list[i]);
+
+        mach_port_deallocate(mach_task_self(), task_thread_list[i]);
+    }
+
+    vm_deallocate(mach_task_self(), (vm_address_t) task_thread_list, sizeof(thread_t) * task_thread_count);
+    pthread_mutex_unlock(&state->lock);
+
+    *thread_count = count;
+    return true;
+}
+
+/**
+ * Return the name of register @a regnum, as recorded by plcrash_backtrace_snapshot_threads(), or NULL if @a regnum is
+ * not a valid register number or no thread has been recorded with @a state.
+ *
+ * @param state The backtrace state.
+ * @param regnum The register number; an index into plcrash_backtrace_thread_t::registers.
+ */
+const char *plcrash_backtrace_register_name (plcrash_backtrace_state_t *state, uint32_t regnum) {
+    const char *name = NULL;
+
+    pthread_mutex_lock(&state->lock);
+    if (state->has_register_state && regnum < plcrash_async_thread_state_get_reg_count(&state->register_state))
+        name = plcrash_async_thread_state_get_reg_name(&state->register_state, regnum);
+    pthread_mutex_unlock(&state->lock);
+
+    return name;
+}
+
+/**
+ * Fetch the base address and path of the image at @a image_index within the image list of the most recent snapshot.
+ *
+ * @param state The backtrace state.
+ * @param image_index An image index, as recorded in plcrash_backtrace_frame_t::image_index.
+ * @param base_address On success, the image's header address. May be NULL.
+ * @param path On success, a borrowed reference to the image's path, valid until the next snapshot. May be NULL.
+ *
+ * @return Returns true on success, or false if @a image_index is not a valid image index.
+ */
+bool plcrash_backtrace_image_info (plcrash_backtrace_state_t *state, size_t image_index, uint64_t *base_address, const char **path) {
+    bool found = false;
+
+    pthread_mutex_lock(&state->lock);
+    if (state->image_list != NULL && image_index < plcrash_async_image_list_count(state->image_list)) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(state->image_list, image_index);
+
+        if (base_address != NULL)
+            *base_address = image->header_addr;
+
+        if (path != NULL)
+            *path = plcrash_async_macho_name(image);
+
+        found = true;
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    return found;
+}
+
+/**
+ * Look up the symbol containing @a frame's instruction pointer, using the image recorded by the most recent snapshot.
+ * Lookups are cached by @a state across snapshots, until an image is unloaded.
+ *
+ * @param state The backtrace state.
+ * @param frame A frame recorded by the most recent plcrash_backtrace_snapshot_threads() call.
+ * @param name The destination for the NUL-terminated symbol name, truncated to @a name_size. May be NULL.
+ * @param name_size The size of @a name, in bytes.
+ * @param symbol_address On success, the symbol's start address. May be NULL.
+ *
+ * @return Returns true if a symbol was found, false otherwise.
+ */
+bool plcrash_backtrace_symbolicate_frame (plcrash_backtrace_state_t *state, const plcrash_backtrace_frame_t *frame,
+                                          char *name, size_t name_size, uint64_t *symbol_address)
+{
+    plcrash_backtrace_symbol_ctx_t ctx = {
+        .name = name,
+        .name_size = name_size,
+        .address = 0,
+        .found = false
+    };
+
+    if (frame->image_index == PLCRASH_BACKTRACE_NO_IMAGE)
+        return false;
+
+    pthread_mutex_lock(&state->lock);
+    if (state->image_list != NULL && frame->image_index < plcrash_async_image_list_count(state->image_list)) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(state->image_list, frame->image_index);
+
+        if (!state->has_symbol_cache && plcrash_async_symbol_cache_init(&state->symbol_cache) == PLCRASH_ESUCCESS)
+            state->has_symbol_cache = true;
+
+        plcrash_async_find_symbol(image, PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE | PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC,
+                                  state->has_symbol_cache ? &state->symbol_cache : NULL, frame->pc, plcrash_backtrace_symbol_cb, &ctx);
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    if (ctx.found && symbol_address != NULL)
+        *symbol_address = ctx.address;
+
+    return ctx.found;
+}
+
+
+/**
+ * Captures backtraces of the calling thread at runtime.
+ *
+ * Backtraces are unwound with the same compact unwind, DWARF, and frame pointer readers used to write crash reports,
+ * and are as precise as the frames of a crash report. Unlike PLCrashReporter::generateLiveReport, no threads are
+ * suspended and no report is written: the calling thread's own register state is used, and only instruction pointers
+ * are returned. The image list and decoded unwind entries are retained across captures, and are only refreshed when
+ * images are loaded or unloaded; in the steady state, a capture requires a few microseconds.
+ *
+ * A single instance may be shared across threads; captures are serialized.
+ *
+ * The stacks of the process' other threads may be captured as plain C records via plcrash_backtrace_snapshot_threads(),
+ * which shares the same image list and unwind caches.
+ */
+@implementation PLCrashBacktrace
+
+/**
+ * Initialize a new backtrace instance.
+ *
+ * @return Returns the initialized instance, or nil if the process' image list could not be accessed.
+ */
+- (id) init {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    if ((_state = plcrash_backtrace_state_new()) == NULL) {
+        [self release];
+        return nil;
+    }
+
+    return self;
+}
+
+- (void) dealloc {
+    plcrash_backtrace_state_free(_state);
+    [super dealloc];
+}
+
+/**
+ * Capture the calling thread's backtrace.
+ *
+ * No Objective-C objects are allocated; memory is only allocated when the process' images have changed since the
+ * previous capture.
+ *
+ * @param instructionPointers The destination for the captured instruction pointers, beginning with the caller of this
+ * method.
+ * @param maximumCount The capacity of @a instructionPointers. Outer frames beyond this count are not unwound.
+ *
+ * @return Returns the number of instruction pointers written to @a instructionPointers.
+ */
+- (NSUInteger) captureInstructionPointers: (uint64_t *) instructionPointers maximumCount: (NSUInteger) maximumCount {
+    return plcrash_backtrace_capture(_state, instructionPointers, maximumCount);
+}
+
+/**
+ * Capture the calling thread's backtrace.
+ *
+ * @param maximumCount The maximum number of instruction pointers to be captured.
+ *
+ * @return Returns an array of instruction pointers (NSNumber), beginning with the caller of this method.
+ */
+- (NSArray *) instructionPointersWithMaximumCount: (NSUInteger) maximumCount {
+    uint64_t *pcs = malloc(sizeof(uint64_t) * maximumCount);
+    if (pcs == NULL)
+        return [NSArray array];
+
+    size_t count = plcrash_backtrace_capture(_state, pcs, maximumCount);
+
+    NSMutableArray *ips = [NSMutableArray arrayWithCapacity: count];
+    for (size_t i = 0; i < count; i++)
+        [ips addObject: [NSNumber numberWithUnsignedLongLong: pcs[i]]];
+
+    free(pcs);
+    return ips;
+}
+
+@end
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashBacktrace.h"
+#import "PLCrashTestThread.h"
+
+#import <dlfcn.h>
+#import <mach/mach_time.h>
+#import <objc/runtime.h>
+
+/** Number of captures performed by the capture benchmark. */
+#define BENCH_CAPTURES 10000
+
+@interface PLCrashBacktraceTests : SenTestCase {}
+@end
+
+@implementation PLCrashBacktraceTests
+
+/**
+ * Verify that the captured backtrace begins with the caller, and that the maximum count is respected.
+ */
+- (void) testCapture {
+    PLCrashBacktrace *backtrace = [[[PLCrashBacktrace alloc] init] autorelease];
+    STAssertNotNil(backtrace, @"Failed to create backtrace instance");
+
+    uint64_t pcs[64];
+    NSUInteger count = [backtrace captureInstructionPointers: pcs maximumCount: 64];
+    STAssertTrue(count > 1, @"Failed to capture a backtrace");
+
+    /* The first frame must fall within this method */
+    Dl_info info;
+    IMP imp = method_getImplementation(class_getInstanceMethod([self class], _cmd));
+    STAssertTrue(dladdr((const void *) (uintptr_t) pcs[0], &info) != 0, @"Could not resolve the first frame");
+    STAssertEquals((uintptr_t) info.dli_saddr, (uintptr_t) imp, @"The first frame is not the caller");
+
+    /* A truncated capture must match the prefix of the full capture */
+    uint64_t truncated[2];
+    STAssertEquals([backtrace captureInstructionPointers: truncated maximumCount: 2], (NSUInteger) 2, @"Incorrect truncated count");
+    STAssertEquals(truncated[1], pcs[1], @"Truncated capture does not match");
+
+    STAssertEquals([backtrace captureInstructionPointers: truncated maximumCount: 0], (NSUInteger) 0, @"Captured frames into an empty buffer");
+
+    NSArray *ips = [backtrace instructionPointersWithMaximumCount: 64];
+    STAssertEquals([ips count], count, @"Array capture returned a different frame count");
+    STAssertEquals([[ips objectAtIndex: 1] unsignedLongLongValue], pcs[1], @"Array capture does not match");
+}
+
+/**
+ * Verify that a thread snapshot records the calling process' other threads, and that frames may be symbolicated after
+ * the threads have been resumed.
+ */
+- (void) testSnapshotThreads {
+    plcrash_backtrace_state_t *state = plcrash_backtrace_state_new();
+    STAssertNotNULL(state, @"Failed to create backtrace state");
+
+    plcrash_test_thread_t thr;
+    plcrash_test_thread_spawn_depth(&thr, 4);
+
+    uint64_t thread_id;
+    STAssertEquals(pthread_threadid_np(thr.thread, &thread_id), 0, @"Failed to fetch thread identifier");
+
+    uint64_t self_id;
+    pthread_threadid_np(pthread_self(), &self_id);
+
+    plcrash_backtrace_thread_t threads[64];
+    plcrash_backtrace_frame_t frames[1024];
+    size_t count;
+    STAssertTrue(plcrash_backtrace_snapshot_threads(state, threads, 64, frames, 1024, 32, &count), @"Snapshot failed");
+
+    plcrash_backtrace_thread_t *found = NULL;
+    for (size_t i = 0; i < count; i++) {
+        STAssertNotEquals(threads[i].thread_id, self_id, @"The calling thread should not be recorded");
+        STAssertTrue(threads[i].frame_count <= 32, @"The per-thread frame limit was not respected");
+
+        if (threads[i].thread_id == thread_id)
+            found = &threads[i];
+    }
+    plcrash_test_thread_stop(&thr);
+
+    STAssertNotNULL(found, @"The test thread was not recorded");
+    if (found != NULL) {
+        STAssertTrue(found->frame_count > 4, @"Failed to walk the test thread");
+        STAssertTrue(found->register_count > 0, @"No registers recorded");
+        STAssertEquals(found->registers[0], found->frames[0].pc, @"The first frame must match the instruction pointer");
+        STAssertNotNULL(plcrash_backtrace_register_name(state, 0), @"Missing register name");
+
+        /* Symbolicate the innermost frame within an image */
+        for (size_t i = 0; i < found->frame_count; i++) {
+            if (found->frames[i].image_index == PLCRASH_BACKTRACE_NO_IMAGE)
+                continue;
+
+            uint64_t base;
+            STAssertTrue(plcrash_backtrace_image_info(state, found->frames[i].image_index, &base, NULL), @"Failed to fetch image info");
+            STAssertTrue(found->frames[i].pc >= base, @"Frame lies before its image");
+
+            char name[256];
+            uint64_t address;
+            if (plcrash_backtrace_symbolicate_frame(state, &found->frames[i], name, sizeof(name), &address)) {
+                STAssertTrue(address <= found->frames[i].pc, @"Symbol lies after its frame");
+                STAssertTrue(strlen(name) > 0, @"Empty symbol name");
+            }
+            break;
+        }
+    }
+
+    /* Frames are not recorded beyond the shared frame storage */
+    STAssertTrue(plcrash_backtrace_snapshot_threads(state, threads, 64, frames, 0, 32, &count), @"Snapshot failed");
+    for (size_t i = 0; i < count; i++)
+        STAssertEquals(threads[i].frame_count, (size_t) 0, @"Frames recorded without storage");
+
+    plcrash_backtrace_state_free(state);
+}
+
+/**
+ * Measure steady-state capture latency. Results are reported via NSLog().
+ */
+- (void) testBenchmarkCapture {
+    PLCrashBacktrace *backtrace = [[[PLCrashBacktrace alloc] init] autorelease];
+    mach_timebase_info_data_t timebase;
+    uint64_t pcs[64];
+
+    mach_timebase_info(&timebase);
+
+    /* Populate the image list and unwind caches */
+    STAssertTrue([backtrace captureInstructionPointers: pcs maximumCount: 64] > 0, @"Failed to capture a backtrace");
+
+    uint64_t start = mach_absolute_time();
+    for (size_t i = 0; i < BENCH_CAPTURES; i++)
+        [backtrace captureInstructionPointers: pcs maximumCount: 64];
+    uint64_t ns = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+
+    NSLog(@"PLCrashBacktrace: %llu ns/capture", (unsigned long long) (ns / BENCH_CAPTURES));
+}
+
+@end
@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import <dlfcn.h>
+#import <objc/runtime.h>
+#import <objc/message.h>
+#import <mach/mach_time.h>
+#import <fcntl.h>
+
+#import "PLCrashLogWriter.h"
+#import "PLCrashFrameWalker.h"
+#import "PLCrashFrameCompactUnwind.h"
+#import "PLCrashFrameDWARFUnwind.h"
+#import "PLCrashFrameStackUnwind.h"
+#import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashAsyncSymbolication.h"
+#import "PLCrashAsyncObjCSection.h"
+#import "PLCrashAsyncInstrumentation.h"
+#import "PLCrashAsyncVirtualTask.h"
+#import "PLCrashTestThread.h"
+
+#import "unwind_test_harness.h"
+
+/** The number of synthetic frames pushed by our deep stack test thread. */
+#define BENCHMARK_STACK_DEPTH 256
+
+/** The number of times each benchmark is repeated. */
+#define BENCHMARK_ITERATIONS 10
+
+/**
+ * Results of a single benchmark run.
+ */
+typedef struct benchmark_result {
+    /** Total elapsed time, in nanoseconds. */
+    uint64_t elapsed_ns;
+
+    /** Number of operations -- frames, lookups, or reports -- performed. */
+    uint64_t operations;
+
+    /** Number of Mach VM calls (task memory reads and memory object mappings) issued. */
+    uint64_t vm_calls;
+} benchmark_result_t;
+
+/**
+ * Microbenchmarks for the crash-time unwinding and symbolication paths.
+ *
+ * These tests report ns/operation and VM calls/operation via NSLog(), and verify only that the benchmarked
+ * operations succeeded; they are intended to make regressions in the hot paths visible when comparing test runs,
+ * rather than to enforce absolute limits.
+ */
+@interface PLCrashBenchmarkTests : SenTestCase {
+@private
+    /** A test thread with a synthetic deep stack. */
+    plcrash_test_thread_t _deep_thread;
+
+    /** The allocator used by our _image_list */
+    plcrash_async_allocator_t *_allocator;
+
+    /** The task's image list. */
+    plcrash_async_image_list_t *_image_list;
+
+    /** Active instrumentation, used to count VM calls. */
+    plcrash_async_instrumentation_t _instr;
+
+    /** Start time of the current measurement. */
+    uint64_t _start;
+}
+@end
+
+@implementation PLCrashBenchmarkTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_async_allocator_create(&_allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(plcrash_nasync_image_list_new(&_image_list, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create image list");
+
+    plcrash_test_thread_spawn_depth(&_deep_thread, BENCHMARK_STACK_DEPTH);
+}
+
+- (void) tearDown {
+    plcrash_async_instrumentation_set_current(NULL);
+    plcrash_test_thread_stop(&_deep_thread);
+    plcrash_async_image_list_free(_image_list);
+
+    /* Clean up our allocator (must be done *after* deallocating the _image_list allocated from this allocator) */
+    plcrash_async_allocator_free(_allocator);
+}
+
+/* Begin a measurement */
+- (void) startMeasuring {
+    plcrash_async_instrumentation_init(&_instr);
+    plcrash_async_instrumentation_set_current(&_instr);
+    _start = mach_absolute_time();
+}
+
+/* End a measurement, adding the results to @a result */
+- (void) stopMeasuring: (benchmark_result_t *) result operations: (uint64_t) operations {
+    uint64_t elapsed = mach_absolute_time() - _start;
+    plcrash_async_instrumentation_set_current(NULL);
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    result->elapsed_ns += (elapsed * timebase.numer) / timebase.denom;
+    result->operations += operations;
+    result->vm_calls += (uint64_t) (_instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY] + _instr.counters[PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS]);
+}
+
+/* Log the results of a benchmark */
+- (void) logResult: (const benchmark_result_t *) result name: (NSString *) name unit: (NSString *) unit {
+    STAssertTrue(result->operations > 0, @"%@: no operations were performed", name);
+    if (result->operations == 0)
+        return;
+
+    NSLog(@"%@: %llu ns/%@, %.2f VM calls/%@ (%llu %@s)", name,
+          (unsigned long long) (result->elapsed_ns / result->operations), unit,
+          (double) result->vm_calls / (double) result->operations, unit,
+          (unsigned long long) result->operations, unit);
+}
+
+/*
+ * Unwind @a thread using @a readers, returning the number of frames walked.
+ */
+- (uint64_t) unwindThread: (thread_t) thread readers: (plframe_cursor_frame_reader_t **) readers count: (size_t) count {
+    plframe_cursor_t cursor;
+    uint64_t frames = 0;
+
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), thread, _image_list), @"Failed to initialize cursor");
+    while (plframe_cursor_next_with_readers(&cursor, readers, count) == PLFRAME_ESUCCESS)
+        frames++;
+    plframe_cursor_free(&cursor);
+
+    return frames;
+}
+
+/*
+ * Benchmark plframe_cursor_next() using @a readers against the deep stack thread.
+ */
+- (void) benchmarkUnwindWithReaders: (plframe_cursor_frame_reader_t **) readers count: (size_t) count name: (NSString *) name {
+    thread_t thread = pthread_mach_thread_np(_deep_thread.thread);
+    benchmark_result_t result = {};
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        [self startMeasuring];
+        uint64_t frames = [self unwindThread: thread readers: readers count: count];
+        [self stopMeasuring: &result operations: frames];
+
+        STAssertTrue(frames >= BENCHMARK_STACK_DEPTH, @"%@: only %llu frames were walked", name, (unsigned long long) frames);
+    }
+
+    [self logResult: &result name: name unit: @"frame"];
+}
+
+/**
+ * Benchmark plframe_cursor_next() with each of the frame readers. The compact unwind and DWARF readers are backed
+ * by the frame pointer reader, as the thread's entry frames may not provide compact unwind or DWARF data.
+ */
+- (void) testUnwindBenchmark {
+    plframe_cursor_frame_reader_t *frame_ptr_readers[] = { plframe_cursor_read_frame_ptr };
+    [self benchmarkUnwindWithReaders: frame_ptr_readers count: 1 name: @"unwind (frame pointer)"];
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plframe_cursor_frame_reader_t *compact_readers[] = { plframe_cursor_read_compact_unwind, plframe_cursor_read_frame_ptr };
+    [self benchmarkUnwindWithReaders: compact_readers count: 2 name: @"unwind (compact unwind)"];
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plframe_cursor_frame_reader_t *dwarf_readers[] = { plframe_cursor_read_dwarf_unwind, plframe_cursor_read_frame_ptr };
+    [self benchmarkUnwindWithReaders: dwarf_readers count: 2 name: @"unwind (DWARF)"];
+#endif
+}
+
+/* Log a single unwind regression test case's results */
+static void benchmark_unwind_harness_result (const unwind_benchmark_result_t *result, void *ctx) {
+    NSUInteger *cases = ctx;
+    (*cases)++;
+
+    if (result->frames == 0)
+        return;
+
+    NSLog(@"unwind harness (%s, %s readers): %llu ns/frame, %.2f reads/frame, %.2f mappings/frame (%llu frames)",
+          result->test_list, result->readers,
+          (unsigned long long) (result->elapsed_ns / result->frames),
+          (double) result->task_memcpy_calls / (double) result->frames,
+          (double) result->mobject_maps / (double) result->frames,
+          (unsigned long long) result->frames);
+}
+
+/**
+ * Benchmark each of the libunwind regression test cases -- frame, frameless, large frameless, and unusual
+ * functions -- through the compact unwind, DWARF, and frame pointer readers.
+ */
+- (void) testUnwindHarnessBenchmark {
+    NSUInteger cases = 0;
+    STAssertTrue(unwind_test_benchmark(BENCHMARK_ITERATIONS * 10, benchmark_unwind_harness_result, &cases), @"Regression tests failed");
+    STAssertTrue(cases > 0, @"No test cases were run");
+}
+
+/* Symbol lookup callback; records that a symbol was found */
+static void benchmark_found_symbol (pl_vm_address_t address, const char *name, void *ctx) {
+    uint64_t *found = ctx;
+    (*found)++;
+}
+
+/*
+ * Populate @a pcs with the PCs of the deep stack thread's frames, followed by a set of system framework
+ * functions and Objective-C methods. Returns the number of PCs written.
+ */
+- (size_t) symbolicationTargets: (pl_vm_address_t *) pcs count: (size_t) max {
+    size_t count = 0;
+
+    /* System framework entry points */
+    pl_vm_address_t system_pcs[] = {
+        (pl_vm_address_t) &pthread_mutex_lock,
+        (pl_vm_address_t) &objc_msgSend,
+        (pl_vm_address_t) &CFRunLoopRun,
+        (pl_vm_address_t) &NSLog,
+        (pl_vm_address_t) class_getMethodImplementation([NSObject class], @selector(description)),
+        (pl_vm_address_t) class_getMethodImplementation([NSString class], @selector(length)),
+        (pl_vm_address_t) class_getMethodImplementation([NSArray class], @selector(count)),
+    };
+    for (size_t i = 0; i < sizeof(system_pcs) / sizeof(system_pcs[0]) && count < max; i++)
+        pcs[count++] = system_pcs[i];
+
+    /* Stack frames */
+    plframe_cursor_t cursor;
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(_deep_thread.thread), _image_list), @"Failed to initialize cursor");
+    while (count < max && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+        plcrash_greg_t pc;
+        if (plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc) == PLFRAME_ESUCCESS)
+            pcs[count++] = (pl_vm_address_t) pc;
+    }
+    plframe_cursor_free(&cursor);
+
+    return count;
+}
+
+/*
+ * Benchmark plcrash_async_find_symbol() with @a strategy.
+ */
+- (void) benchmarkSymbolicationWithStrategy: (plcrash_async_symbol_strategy_t) strategy name: (NSString *) name {
+    pl_vm_address_t pcs[BENCHMARK_STACK_DEPTH * 2];
+    size_t pc_count = [self symbolicationTargets: pcs count: sizeof(pcs) / sizeof(pcs[0])];
+    benchmark_result_t result = {};
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        plcrash_async_symbol_cache_t cache;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_symbol_cache_init(&cache), @"Failed to initialize symbol cache");
+
+        uint64_t found = 0;
+        [self startMeasuring];
+        for (size_t j = 0; j < pc_count; j++) {
+            plcrash_async_macho_t *image = plcrash_async_image_containing_address(_image_list, pcs[j]);
+            if (image == NULL)
+                continue;
+
+            plcrash_async_find_symbol(image, strategy, &cache, pcs[j], benchmark_found_symbol, &found);
+        }
+        [self stopMeasuring: &result operations: pc_count];
+
+        plcrash_async_symbol_cache_free(&cache);
+        STAssertTrue(found > 0, @"%@: no symbols were found", name);
+    }
+
+    [self logResult: &result name: name unit: @"lookup"];
+}
+
+/**
+ * Benchmark plcrash_async_find_symbol() with each symbolication strategy. The symbol cache is reset on each
+ * iteration, matching its use within the crash handler.
+ */
+- (void) testSymbolicationBenchmark {
+    [self benchmarkSymbolicationWithStrategy: PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE name: @"find_symbol (symbol table)"];
+    [self benchmarkSymbolicationWithStrategy: PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC name: @"find_symbol (objc)"];
+    [self benchmarkSymbolicationWithStrategy: PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL name: @"find_symbol (all)"];
+}
+
+/* Objective-C method lookup callback; records that a method was found */
+static void benchmark_found_method (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+    uint64_t *found = ctx;
+    (*found)++;
+}
+
+/**
+ * Benchmark plcrash_async_objc_find_method() against methods implemented by the system frameworks and by this
+ * test class.
+ */
+- (void) testObjCFindMethodBenchmark {
+    pl_vm_address_t imps[] = {
+        (pl_vm_address_t) class_getMethodImplementation([NSObject class], @selector(description)),
+        (pl_vm_address_t) class_getMethodImplementation([NSString class], @selector(length)),
+        (pl_vm_address_t) class_getMethodImplementation([NSArray class], @selector(count)),
+        (pl_vm_address_t) class_getMethodImplementation([NSDictionary class], @selector(objectForKey:)),
+        (pl_vm_address_t) class_getMethodImplementation([self class], _cmd),
+    };
+    const size_t imp_count = sizeof(imps) / sizeof(imps[0]);
+    benchmark_result_t result = {};
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        plcrash_async_objc_cache_t cache;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_objc_cache_init(&cache), @"Failed to initialize ObjC cache");
+
+        uint64_t found = 0;
+        [self startMeasuring];
+        for (size_t j = 0; j < imp_count; j++) {
+            plcrash_async_macho_t *image = plcrash_async_image_containing_address(_image_list, imps[j]);
+            if (image == NULL)
+                continue;
+
+            plcrash_async_objc_find_method(image, &cache, imps[j], benchmark_found_method, &found);
+        }
+        [self stopMeasuring: &result operations: imp_count];
+
+        plcrash_async_objc_cache_free(&cache);
+        STAssertTrue(found > 0, @"No methods were found");
+    }
+
+    [self logResult: &result name: @"objc_find_method" unit: @"lookup"];
+}
+
+/* The byte-at-a-time strncmp() previously used by plcrash_async_strncmp(); used as a benchmark baseline */
+static int benchmark_bytewise_strncmp (const char *s1, const char *s2, size_t n) {
+    for (; n > 0; s1++, s2++, n--) {
+        if (*s1 != *s2 || *s1 == '\0')
+            return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
+    }
+    return 0;
+}
+
+/* The byte-at-a-time memcpy() previously used by plcrash_async_memcpy(); used as a benchmark baseline */
+static void *benchmark_bytewise_memcpy (void *dest, const void *source, size_t n) {
+    const volatile uint8_t *s = (const volatile uint8_t *) source;
+    volatile uint8_t *d = (volatile uint8_t *) dest;
+
+    for (size_t count = 0; count < n; count++)
+        *d++ = *s++;
+
+    return (void *) source;
+}
+
+/**
+ * Benchmark the async-safe string and memory primitives against byte-at-a-time loops, using segment name matching
+ * (16 byte names, as in plcrash_async_macho_find_segment_cmd()) and thread state sized copies.
+ */
+- (void) testStringPrimitivesBenchmark {
+    const size_t lookups = 100000;
+    static const char *segnames[] = { "__PAGEZERO", "__TEXT", "__DATA_CONST", "__DATA", "__OBJC", "__LINKEDIT" };
+    const size_t segcount = sizeof(segnames) / sizeof(segnames[0]);
+    char names[sizeof(segnames) / sizeof(segnames[0])][16] __attribute__((aligned(16)));
+    benchmark_result_t async_cmp = {};
+    benchmark_result_t byte_cmp = {};
+    benchmark_result_t async_copy = {};
+    benchmark_result_t byte_copy = {};
+    uint8_t src[1024] __attribute__((aligned(16)));
+    uint8_t dest[1024] __attribute__((aligned(16)));
+    volatile size_t matches = 0;
+
+    for (size_t i = 0; i < segcount; i++)
+        strncpy(names[i], segnames[i], sizeof(names[i]));
+    memset(src, 0xA5, sizeof(src));
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        /* Match the last segment name against all segments, as is done when searching for __LINKEDIT */
+        [self startMeasuring];
+        for (size_t j = 0; j < lookups; j++) {
+            for (size_t k = 0; k < segcount; k++) {
+                if (plcrash_async_strncmp(names[k], names[segcount - 1], sizeof(names[k])) == 0)
+                    matches++;
+            }
+        }
+        [self stopMeasuring: &async_cmp operations: lookups];
+
+        [self startMeasuring];
+        for (size_t j = 0; j < lookups; j++) {
+            for (size_t k = 0; k < segcount; k++) {
+                if (benchmark_bytewise_strncmp(names[k], names[segcount - 1], sizeof(names[k])) == 0)
+                    matches++;
+            }
+        }
+        [self stopMeasuring: &byte_cmp operations: lookups];
+
+        [self startMeasuring];
+        for (size_t j = 0; j < lookups; j++)
+            plcrash_async_memcpy(dest, src, sizeof(dest));
+        [self stopMeasuring: &async_copy operations: lookups];
+
+        [self startMeasuring];
+        for (size_t j = 0; j < lookups; j++)
+            benchmark_bytewise_memcpy(dest, src, sizeof(dest));
+        [self stopMeasuring: &byte_copy operations: lookups];
+    }
+
+    STAssertEquals((size_t) matches, (size_t) (2 * lookups * BENCHMARK_ITERATIONS), @"Incorrect match count");
+
+    [self logResult: &async_cmp name: @"async_strncmp (segment search)" unit: @"search"];
+    [self logResult: &byte_cmp name: @"bytewise strncmp (segment search)" unit: @"search"];
+    [self logResult: &async_copy name: @"async_memcpy (1 KB)" unit: @"copy"];
+    [self logResult: &byte_copy name: @"bytewise memcpy (1 KB)" unit: @"copy"];
+}
+
+/**
+ * Benchmark plcrash_log_writer_write() end to end, writing to an in-memory file.
+ */
+- (void) testWriteReportBenchmark {
+    const size_t bufferSize = 4 * 1024 * 1024;
+    plcrash_async_dynloader_t *loader;
+    benchmark_result_t result = {};
+
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    void *buffer = malloc(bufferSize);
+    STAssertNotNULL(buffer, @"Failed to allocate output buffer");
+
+    thread_t thread = pthread_mach_thread_np(_deep_thread.thread);
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    bsd_info.address = (void *) 0x42;
+    bsd_info.code = SEGV_MAPERR;
+    bsd_info.signo = SIGSEGV;
+    info.mach_info = NULL;
+    info.bsd_info = &bsd_info;
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        plcrash_log_writer_t writer;
+        plcrash_async_file_t file;
+        plcrash_async_thread_state_t thread_state;
+
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+        plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+        plcrash_async_file_init_memory(&file, buffer, bufferSize);
+
+        [self startMeasuring];
+        plcrash_error_t err = plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state);
+        plcrash_async_file_flush(&file);
+        [self stopMeasuring: &result operations: 1];
+
+        STAssertEquals(PLCRASH_ESUCCESS, err, @"Crash log failed");
+
+        plcrash_log_writer_close(&writer);
+        plcrash_log_writer_free(&writer);
+        plcrash_async_file_close(&file);
+    }
+
+    [self logResult: &result name: @"log_writer_write" unit: @"report"];
+
+    free(buffer);
+    plcrash_async_dynloader_free(loader);
+}
+
+/*
+ * Build an image list over @a task from @a headers, and unwind from @a thread_state, returning the number of frames
+ * walked.
+ */
+- (uint64_t) unwindTask: (task_t) task state: (plcrash_async_thread_state_t *) thread_state headers: (const pl_vm_address_t *) headers names: (const char **) names count: (size_t) count {
+    plcrash_async_image_list_t *image_list;
+    plframe_cursor_t cursor;
+    uint64_t frames = 0;
+
+    STAssertEquals(plcrash_nasync_image_list_new_with_headers(&image_list, _allocator, task, headers, names, count), PLCRASH_ESUCCESS, @"Failed to create image list");
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_init(&cursor, task, thread_state, image_list), @"Failed to initialize cursor");
+    while (plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS)
+        frames++;
+    plframe_cursor_free(&cursor);
+    plcrash_async_image_list_free(image_list);
+
+    return frames;
+}
+
+/**
+ * Record the memory read while loading the image list and unwinding the deep stack thread, and then benchmark a
+ * deterministic replay of the same work against the recording. The replay must walk exactly the recorded frames.
+ */
+- (void) testRecordReplayBenchmark {
+    thread_t thread = pthread_mach_thread_np(_deep_thread.thread);
+    size_t count = plcrash_async_image_list_count(_image_list);
+    pl_vm_address_t *headers = malloc(sizeof(headers[0]) * count);
+    const char **names = malloc(sizeof(names[0]) * count);
+    plcrash_async_thread_state_t thread_state;
+    benchmark_result_t result = {};
+
+    for (size_t i = 0; i < count; i++) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(_image_list, i);
+        headers[i] = image->header_addr;
+        names[i] = plcrash_async_macho_name(image);
+    }
+
+    STAssertEquals(plcrash_async_thread_state_mach_thread_init(&thread_state, thread), PLCRASH_ESUCCESS, @"Failed to fetch thread state");
+
+    /* Record */
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    int fd = open([path fileSystemRepresentation], O_RDWR|O_CREAT|O_TRUNC, 0644);
+    STAssertTrue(fd >= 0, @"Failed to open recording file");
+
+    plcrash_async_vtask_recorder_t recorder;
+    STAssertEquals(plcrash_nasync_vtask_recorder_init(&recorder, fd), PLCRASH_ESUCCESS, @"Failed to initialize recorder");
+    plcrash_async_vtask_recorder_set_current(&recorder);
+    uint64_t recorded_frames = [self unwindTask: mach_task_self() state: &thread_state headers: headers names: names count: count];
+    plcrash_async_vtask_recorder_set_current(NULL);
+    close(fd);
+
+    STAssertFalse(recorder.failed, @"Failed to write recording");
+    STAssertTrue(recorded_frames >= BENCHMARK_STACK_DEPTH, @"Only %llu frames were walked", (unsigned long long) recorded_frames);
+
+    /* Replay */
+    plcrash_async_vtask_t vtask;
+    STAssertEquals(plcrash_nasync_vtask_init_recording(&vtask, [path fileSystemRepresentation]), PLCRASH_ESUCCESS, @"Failed to load recording");
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        [self startMeasuring];
+        uint64_t frames = [self unwindTask: plcrash_async_vtask_port(&vtask) state: &thread_state headers: headers names: names count: count];
+        [self stopMeasuring: &result operations: frames];
+
+        STAssertEquals(frames, recorded_frames, @"Replay diverged from the recording");
+    }
+
+    NSLog(@"recording: %lld records, %lld bytes", (long long) recorder.records, (long long) recorder.bytes);
+    [self logResult: &result name: @"replayed image list + unwind" unit: @"frame"];
+
+    plcrash_nasync_vtask_free(&vtask);
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+    free(headers);
+    free(names);
+}
+
+@end
@@ -30,9 +30,217 @@
 #include "PLCrashFeatureConfig.h"
 
 #include <inttypes.h>
+#include <libkern/OSAtomic.h>
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
+/** The number of entries in a plframe_compact_unwind_cache_t. */
+#define PLFRAME_COMPACT_UNWIND_CACHE_SIZE 64
+
+/**
+ * @internal
+ *
+ * A single plframe_compact_unwind_cache_t entry.
+ */
+typedef struct plframe_compact_unwind_cache_entry {
+    /** The header address of the image containing the function. Zero if this entry is unused. */
+    pl_vm_address_t header_addr;
+
+    /** The image-relative start of the PC range to which @a entry applies. */
+    pl_vm_address_t function_base;
+
+    /** The image-relative (exclusive) end of the PC range to which @a entry applies. */
+    pl_vm_address_t function_end;
+
+    /** The raw CFE encoding, retained for error reporting. */
+    uint32_t encoding;
+
+    /** The decoded CFE entry. */
+    plcrash_async_cfe_entry_t entry;
+} plframe_compact_unwind_cache_entry_t;
+
+/**
+ * @internal
+ *
+ * A cache of decoded compact unwind entries. Entries are keyed by PC range, and as such, the table is searched
+ * linearly; the table is small enough that this remains considerably cheaper than searching the __unwind_info
+ * index and second-level pages, and re-decoding the entry. Entries are replaced in round-robin order.
+ */
+struct plframe_compact_unwind_cache {
+    /** Lock guarding all cache state. */
+    OSSpinLock lock;
+
+    /** The index of the next entry to be replaced. */
+    uint32_t next;
+
+    /** The number of lookups satisfied by the cache. */
+    uint32_t hits;
+
+    /** The number of lookups not satisfied by the cache. */
+    uint32_t misses;
+
+    /** Cache entries. */
+    plframe_compact_unwind_cache_entry_t entries[PLFRAME_COMPACT_UNWIND_CACHE_SIZE];
+
+    /** The budget charged for the cache, or NULL. See plframe_compact_unwind_cache_set_budget(). */
+    plcrash_async_cache_budget_t *budget;
+
+    /** The cache's registration with @a budget, or PLCRASH_ASYNC_CACHE_ID_INVALID. */
+    plcrash_async_cache_id_t budget_id;
+};
+
+/**
+ * Allocate a new, empty compact unwind cache from @a allocator.
+ *
+ * @param result On success, will be set to the new cache. The cache must be released via
+ * plframe_compact_unwind_cache_free().
+ * @param allocator The allocator from which the cache will be allocated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+plcrash_error_t plframe_compact_unwind_cache_new (plframe_compact_unwind_cache_t **result, plcrash_async_allocator_t *allocator) {
+    plframe_compact_unwind_cache_t *cache;
+    plcrash_error_t err;
+    void *buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(*cache))) != PLCRASH_ESUCCESS)
+        return err;
+    cache = buf;
+
+    cache->lock = OS_SPINLOCK_INIT;
+    cache->next = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    for (size_t i = 0; i < PLFRAME_COMPACT_UNWIND_CACHE_SIZE; i++)
+        cache->entries[i].header_addr = 0x0;
+    cache->budget = NULL;
+    cache->budget_id = PLCRASH_ASYNC_CACHE_ID_INVALID;
+
+    *result = cache;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Charge the memory retained by @a cache to @a budget. As with plframe_dwarf_cache_set_budget(), the cache is
+ * registered as non-evictable; if the budget cannot accommodate it, the caller should free the cache and unwind
+ * without it.
+ *
+ * @param cache The cache to configure.
+ * @param budget The budget to charge. The budget must outlive @a cache.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be registered with or charged
+ * to @a budget.
+ */
+plcrash_error_t plframe_compact_unwind_cache_set_budget (plframe_compact_unwind_cache_t *cache, plcrash_async_cache_budget_t *budget) {
+    plcrash_error_t err;
+
+    PLCF_ASSERT(cache->budget == NULL);
+
+    if ((err = plcrash_async_cache_budget_register(budget, "compact_unwind", sizeof(*cache), false, &cache->budget_id)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_async_cache_budget_charge(budget, cache->budget_id, sizeof(*cache))) != PLCRASH_ESUCCESS) {
+        plcrash_async_cache_budget_unregister(budget, cache->budget_id);
+        cache->budget_id = PLCRASH_ASYNC_CACHE_ID_INVALID;
+        return err;
+    }
+
+    cache->budget = budget;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Fetch the number of lookups that were and were not satisfied by @a cache.
+ *
+ * @param cache The cache to query.
+ * @param hits On return, will be set to the number of lookups satisfied by the cache.
+ * @param misses On return, will be set to the number of lookups not satisfied by the cache.
+ */
+void plframe_compact_unwind_cache_stats (plframe_compact_unwind_cache_t *cache, uint32_t *hits, uint32_t *misses) {
+    OSSpinLockLock(&cache->lock); {
+        *hits = cache->hits;
+        *misses = cache->misses;
+    } OSSpinLockUnlock(&cache->lock);
+}
+
+/**
+ * Free @a cache.
+ *
+ * @param cache The cache to free.
+ * @param allocator The allocator used to allocate @a cache.
+ */
+void plframe_compact_unwind_cache_free (plframe_compact_unwind_cache_t *cache, plcrash_async_allocator_t *allocator) {
+    if (cache->budget != NULL)
+        plcrash_async_cache_budget_unregister(cache->budget, cache->budget_id);
+
+    plcrash_async_allocator_dealloc(allocator, cache);
+}
+
+/**
+ * @internal
+ *
+ * Look up the decoded entry for the image-relative @a pc within @a image.
+ *
+ * @param cache The cache to search.
+ * @param image The image containing @a pc.
+ * @param pc The image-relative PC to look up.
+ * @param function_base On success, will be set to the image-relative start of the function.
+ * @param encoding On success, will be set to the raw CFE encoding.
+ * @param entry On success, will be populated with the decoded entry. The entry must be freed via
+ * plcrash_async_cfe_entry_free().
+ *
+ * @return Returns true if an entry was found, or false otherwise.
+ */
+static bool plframe_compact_unwind_cache_lookup (plframe_compact_unwind_cache_t *cache, plcrash_async_macho_t *image,
+                                                 pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding,
+                                                 plcrash_async_cfe_entry_t *entry)
+{
+    bool found = false;
+
+    OSSpinLockLock(&cache->lock); {
+        for (size_t i = 0; i < PLFRAME_COMPACT_UNWIND_CACHE_SIZE; i++) {
+            plframe_compact_unwind_cache_entry_t *cached = &cache->entries[i];
+            if (cached->header_addr != image->header_addr || pc < cached->function_base || pc >= cached->function_end)
+                continue;
+
+            *function_base = cached->function_base;
+            *encoding = cached->encoding;
+            plcrash_async_memcpy(entry, &cached->entry, sizeof(*entry));
+            found = true;
+            break;
+        }
+
+        if (found)
+            cache->hits++;
+        else
+            cache->misses++;
+    } OSSpinLockUnlock(&cache->lock);
+
+    plcrash_async_cache_budget_record(cache->budget, cache->budget_id, found);
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Record the decoded @a entry for the image-relative range [@a function_base, @a function_end) within @a image.
+ */
+static void plframe_compact_unwind_cache_insert (plframe_compact_unwind_cache_t *cache, plcrash_async_macho_t *image,
+                                                 pl_vm_address_t function_base, pl_vm_address_t function_end,
+                                                 uint32_t encoding, const plcrash_async_cfe_entry_t *entry)
+{
+    OSSpinLockLock(&cache->lock); {
+        plframe_compact_unwind_cache_entry_t *cached = &cache->entries[cache->next];
+        cache->next = (cache->next + 1) % PLFRAME_COMPACT_UNWIND_CACHE_SIZE;
+
+        cached->header_addr = image->header_addr;
+        cached->function_base = function_base;
+        cached->function_end = function_end;
+        cached->encoding = encoding;
+        plcrash_async_memcpy(&cached->entry, entry, sizeof(*entry));
+    } OSSpinLockUnlock(&cache->lock);
+}
+
 /**
  * Attempt to fetch next frame using compact frame unwinding data from @a image_list.
  *
@@ -60,48 +268,62 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
     }
     plcrash_greg_t pc = plcrash_async_thread_state_get_reg(&current_frame->thread_state, PLCRASH_REG_IP);
     
-    /* Find the corresponding image */
-    plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, pc);
+    /* Find the corresponding image, preferring the image already resolved by the frame cursor */
+    plcrash_async_macho_t *image = current_frame->image;
+    if (image == NULL)
+        image = plcrash_async_image_containing_address(image_list, pc);
     if (image == NULL) {
         PLCF_DEBUG("Could not find a loaded image for the current frame pc: 0x%" PRIx64, (uint64_t) pc);
         return PLFRAME_ENOTSUP;
     }
     
-    /* Map the unwind section */
-    plcrash_async_mobject_t unwind_mobj;
-    err = plcrash_async_macho_map_section(image, SEG_TEXT, "__unwind_info", &unwind_mobj);
-    if (err != PLCRASH_ESUCCESS) {
-        if (err != PLCRASH_ENOTFOUND)
-            PLCF_DEBUG("Could not map the compact unwind info section for image %s: %d", image->name, err);
-        return PLFRAME_ENOTSUP;
-    }
-
-    /* Initialize the CFE reader. */
-    cpu_type_t cputype = image->byteorder->swap32(image->header.cputype);
-    plcrash_async_cfe_reader_t reader;
-
-    err = plcrash_async_cfe_reader_init(&reader, &unwind_mobj, cputype);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Could not parse the compact unwind info section for image '%s': %d", image->name, err);
-        return PLFRAME_EINVAL;
-    }
-
-    /* Find the encoding entry (if any) and free the reader */
+    /* Consult the cache, if any. The entry is stored as decoded, and can be used directly. */
     pl_vm_address_t function_base;
     uint32_t encoding;
-    err = plcrash_async_cfe_reader_find_pc(&reader, pc - image->header_addr, &function_base, &encoding);
-    plcrash_async_cfe_reader_free(&reader);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Did not find CFE entry for PC 0x%" PRIx64 ": %d", (uint64_t) pc, err);
-        return PLFRAME_ENOTSUP;
-    }
-    
-    /* Decode the entry */
     plcrash_async_cfe_entry_t entry;
-    err = plcrash_async_cfe_entry_init(&entry, cputype, encoding);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Could not decode CFE encoding 0x%" PRIx32 " for PC 0x%" PRIx64 ": %d", encoding, (uint64_t) pc, err);
-        return PLFRAME_ENOTSUP;
+    plframe_compact_unwind_cache_t *cache = current_frame->compact_unwind_cache;
+
+    if (cache == NULL || !plframe_compact_unwind_cache_lookup(cache, image, pc - image->header_addr, &function_base, &encoding, &entry)) {
+        /* Fetch the unwind section; if the walk has a section cache, the mapping is shared across all of its frames */
+        plcrash_async_mobject_t unwind_storage;
+        plcrash_async_mobject_t *unwind_mobj;
+        err = plcrash_async_macho_section_cache_map(current_frame->section_cache, image, SEG_TEXT, "__unwind_info", &unwind_storage, &unwind_mobj);
+        if (err != PLCRASH_ESUCCESS) {
+            if (err != PLCRASH_ENOTFOUND)
+                PLCF_DEBUG("Could not map the compact unwind info section for image %s: %d", image->name, err);
+            return PLFRAME_ENOTSUP;
+        }
+
+        /* Initialize the CFE reader. */
+        cpu_type_t cputype = image->byteorder->swap32(image->header.cputype);
+        plcrash_async_cfe_reader_t reader;
+
+        err = plcrash_async_cfe_reader_init(&reader, unwind_mobj, cputype);
+        if (err != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not parse the compact unwind info section for image '%s': %d", image->name, err);
+            plcrash_async_macho_section_cache_unmap(current_frame->section_cache, unwind_mobj);
+            return PLFRAME_EINVAL;
+        }
+
+        /* Find the encoding entry (if any) and free the reader */
+        pl_vm_address_t function_end;
+        err = plcrash_async_cfe_reader_find_pc_range(&reader, pc - image->header_addr, &function_base, &function_end, &encoding);
+        plcrash_async_cfe_reader_free(&reader);
+        plcrash_async_macho_section_cache_unmap(current_frame->section_cache, unwind_mobj);
+        if (err != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Did not find CFE entry for PC 0x%" PRIx64 ": %d", (uint64_t) pc, err);
+            return PLFRAME_ENOTSUP;
+        }
+
+        /* Decode the entry */
+        err = plcrash_async_cfe_entry_init(&entry, cputype, encoding);
+        if (err != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not decode CFE encoding 0x%" PRIx32 " for PC 0x%" PRIx64 ": %d", encoding, (uint64_t) pc, err);
+            return PLFRAME_ENOTSUP;
+        }
+
+        if (cache != NULL)
+            plframe_compact_unwind_cache_insert(cache, image, function_base, function_end, encoding, &entry);
     }
 
     /* Skip entries for which no unwind information is unavailable */
@@ -30,6 +30,8 @@
 #include "PLCrashFeatureConfig.h"
 #include "PLCrashFrameWalker.h"
 #include "PLCrashAsyncCompactUnwindEncoding.h"
+#include "PLCrashAsyncAllocator.h"
+#include "PLCrashAsyncCacheBudget.h"
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
@@ -37,6 +39,20 @@
 extern "C" {
 #endif
 
+/**
+ * @internal
+ *
+ * A cache of decoded compact unwind entries, keyed by image and function range. A cache may be shared across all
+ * cursors used to walk a task's threads; all access is serialized internally. See
+ * plframe_cursor_set_compact_unwind_cache().
+ */
+typedef struct plframe_compact_unwind_cache plframe_compact_unwind_cache_t;
+
+plcrash_error_t plframe_compact_unwind_cache_new (plframe_compact_unwind_cache_t **result, plcrash_async_allocator_t *allocator);
+plcrash_error_t plframe_compact_unwind_cache_set_budget (plframe_compact_unwind_cache_t *cache, plcrash_async_cache_budget_t *budget);
+void plframe_compact_unwind_cache_stats (plframe_compact_unwind_cache_t *cache, uint32_t *hits, uint32_t *misses);
+void plframe_compact_unwind_cache_free (plframe_compact_unwind_cache_t *cache, plcrash_async_allocator_t *allocator);
+
 plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
                                                     plcrash_async_image_list_t *image_list,
                                                     const plframe_stackframe_t *current_frame,
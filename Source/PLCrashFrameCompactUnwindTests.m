@@ -28,6 +28,7 @@
 #import "SenTestCompat.h"
 #import "PLCrashFrameCompactUnwind.h"
 #import "PLCrashFeatureConfig.h"
+#import "PLCrashTestThread.h"
 
 #if PLCRASH_FEATURE_UNWIND_COMPACT
 
@@ -74,7 +75,7 @@
 }
 
 - (void) testMissingImage {
-    plframe_stackframe_t frame;
+    plframe_stackframe_t frame = {};
     plframe_stackframe_t next;
     plframe_error_t err;
     
@@ -85,6 +86,64 @@
     STAssertEquals(err, PLFRAME_ENOTSUP, @"Unexpected result for a frame missing a valid image");
 }
 
+/**
+ * Verify that a shared compact unwind cache (and a section cache) is consulted, and produces the same frames as an
+ * uncached walk.
+ */
+- (void) testCachedUnwind {
+    plcrash_test_thread_t thr;
+    plframe_compact_unwind_cache_t *cache;
+    plcrash_async_macho_section_cache_t section_cache;
+    plcrash_greg_t expected[64];
+    size_t expected_count = 0;
+
+    STAssertEquals(plframe_compact_unwind_cache_new(&cache, _allocator), PLCRASH_ESUCCESS, @"Failed to allocate cache");
+    plcrash_async_macho_section_cache_init(&section_cache);
+    plcrash_test_thread_spawn(&thr);
+    thread_t thread = pthread_mach_thread_np(thr.thread);
+
+    for (int pass = 0; pass < 3; pass++) {
+        plframe_cursor_t cursor;
+        size_t count = 0;
+
+        STAssertEquals(plframe_cursor_thread_init(&cursor, mach_task_self(), thread, _image_list), PLFRAME_ESUCCESS, @"Failed to initialize cursor");
+        if (pass > 0) {
+            plframe_cursor_set_compact_unwind_cache(&cursor, cache);
+            plframe_cursor_set_section_cache(&cursor, &section_cache);
+        }
+
+        while (count < sizeof(expected) / sizeof(expected[0]) && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+            plcrash_greg_t pc;
+            STAssertEquals(plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc), PLFRAME_ESUCCESS, @"Failed to fetch PC");
+
+            if (pass == 0)
+                expected[count] = pc;
+            else
+                STAssertEquals(pc, expected[count], @"Cached walk returned a different PC for frame %zu on pass %d", count, pass);
+            count++;
+        }
+        plframe_cursor_free(&cursor);
+
+        if (pass == 0)
+            expected_count = count;
+        else
+            STAssertEquals(count, expected_count, @"Cached walk returned a different frame count on pass %d", pass);
+    }
+
+    /* The second walk must have been served (at least in part) from the entries populated by the first */
+    uint32_t hits, misses;
+    plframe_compact_unwind_cache_stats(cache, &hits, &misses);
+    STAssertTrue(misses > 0, @"Cache was never populated");
+    STAssertTrue(hits > 0, @"Cache was never consulted");
+
+    /* The section cache must have been populated by the misses */
+    STAssertTrue(section_cache.use_count > 0, @"Section cache was never consulted");
+
+    plcrash_test_thread_stop(&thr);
+    plcrash_async_macho_section_cache_free(&section_cache);
+    plframe_compact_unwind_cache_free(cache, _allocator);
+}
+
 @end
 
 #endif /* PLCRASH_FEATURE_UNWIND_COMPACT */
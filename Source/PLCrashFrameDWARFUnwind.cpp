@@ -28,9 +28,11 @@
 #include "PLCrashFrameDWARFUnwind.h"
 
 #include "PLCrashAsyncMachOImage.h"
+#include "PLCrashAsyncCompactUnwindEncoding.h"
 
 #include "PLCrashAsyncDwarfEncoding.hpp"
 #include "PLCrashAsyncDwarfCFAState.hpp"
+#include "PLCrashAsyncDwarfExpression.hpp"
 
 #include "PLCrashFeatureConfig.h"
 
@@ -42,6 +44,535 @@
 
 using namespace plcrash::async;
 
+/** The number of entries in a plframe_dwarf_cache_t. Must be a power of two. */
+#define PLFRAME_DWARF_CACHE_SIZE 16
+
+/**
+ * @internal
+ *
+ * A single plframe_dwarf_cache_t entry.
+ */
+typedef struct plframe_dwarf_cache_entry {
+    /** If true, this entry is populated. */
+    bool valid;
+
+    /** The header address of the image containing @a pc. */
+    pl_vm_address_t header_addr;
+
+    /** The PC for which @a cfa_state was evaluated. */
+    uint64_t pc;
+
+    /** The CIE used to evaluate @a cfa_state. Only the parsed values are required by apply_state(), and as such, the
+     * copy does not reference the image's DWARF section mapping. */
+    plcrash_async_dwarf_cie_info_t cie_info;
+
+    /** Storage for the evaluated dwarf_cfa_state; sized for (and aligned to) the larger 64-bit state. */
+    uint64_t cfa_state[(sizeof(dwarf_cfa_state<uint64_t, int64_t>) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} plframe_dwarf_cache_entry_t;
+
+/** The number of CIE entries in a plframe_dwarf_cache_t. Must be a power of two. */
+#define PLFRAME_DWARF_CIE_CACHE_SIZE 8
+
+/**
+ * @internal
+ *
+ * A parsed CIE, cached by plframe_dwarf_cache_t.
+ */
+typedef struct plframe_dwarf_cie_cache_entry {
+    /** If true, this entry is populated. */
+    bool valid;
+
+    /** The task-relative base address of the DWARF section containing the CIE. */
+    pl_vm_address_t section_addr;
+
+    /** The section-relative offset of the CIE. */
+    uint64_t cie_offset;
+
+    /** The parsed CIE. As with plframe_dwarf_cache_entry_t, the copy does not reference the section mapping. */
+    plcrash_async_dwarf_cie_info_t cie_info;
+
+    /** If true, @a initial_state holds the result of evaluating the CIE's initial instructions. This is only recorded
+     * if the initial instructions do not modify the CFA location, in which case the result is the same for all FDEs
+     * referencing the CIE. */
+    bool has_initial_state;
+
+    /** Storage for the evaluated initial instructions' dwarf_cfa_state; see plframe_dwarf_cache_entry_t. */
+    uint64_t initial_state[(sizeof(dwarf_cfa_state<uint64_t, int64_t>) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} plframe_dwarf_cie_cache_entry_t;
+
+/** The number of FDEs for which CFA program checkpoints are retained by a plframe_dwarf_cache_t. Must be a power of two. */
+#define PLFRAME_DWARF_CHECKPOINT_FDE_COUNT 4
+
+/** The maximum number of CFA program checkpoints retained for a single FDE. */
+#define PLFRAME_DWARF_CHECKPOINT_COUNT 4
+
+/** FDE programs shorter than this length, in bytes, are always evaluated in full; replaying a short program costs less
+ * than recording and restoring a checkpoint. */
+#define PLFRAME_DWARF_CHECKPOINT_MIN_LENGTH 256
+
+/**
+ * @internal
+ *
+ * CFA program checkpoints for a single FDE, cached by plframe_dwarf_cache_t. Long FDE programs -- such as those of
+ * large functions with many DW_CFA_advance_loc rows -- would otherwise be replayed from their first opcode for every
+ * PC looked up within the function.
+ */
+typedef struct plframe_dwarf_checkpoint_entry {
+    /** If true, this entry is populated. */
+    bool valid;
+
+    /** The task-relative base address of the DWARF section containing the FDE. */
+    pl_vm_address_t section_addr;
+
+    /** The section-relative offset of the FDE. */
+    uint64_t fde_offset;
+
+    /** The number of populated @a checkpoints. */
+    size_t count;
+
+    /** The recorded checkpoints, in program order; see dwarf_cfa_checkpoint. */
+    struct {
+        /** The checkpoint's position within the FDE program. */
+        uint64_t position;
+
+        /** The checkpoint's CFA location. */
+        uint64_t location;
+
+        /** The greatest CFA location reached prior to the checkpoint. */
+        uint64_t max_location;
+
+        /** Storage for the checkpoint's dwarf_cfa_state; see plframe_dwarf_cache_entry_t. */
+        uint64_t state[(sizeof(dwarf_cfa_state<uint64_t, int64_t>) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    } checkpoints[PLFRAME_DWARF_CHECKPOINT_COUNT];
+} plframe_dwarf_checkpoint_entry_t;
+
+/**
+ * @internal
+ *
+ * A direct-mapped cache of evaluated DWARF CFA rows. Locating an FDE, parsing its CIE, and evaluating the CFA programs
+ * is considerably more expensive than applying the resulting rules; the same return addresses (eg, within the thread
+ * entry and run loop machinery) tend to recur across a task's threads, allowing the evaluated rows to be reused.
+ */
+struct plframe_dwarf_cache {
+    /** Lock guarding all cache state. */
+    OSSpinLock lock;
+
+    /** Cache entries, indexed by plframe_dwarf_cache_index(). */
+    plframe_dwarf_cache_entry_t entries[PLFRAME_DWARF_CACHE_SIZE];
+
+    /** Parsed CIEs, indexed by plframe_dwarf_cie_cache_index(). Most FDEs within a section share a small number of
+     * CIEs; rows that miss in @a entries can still skip CIE parsing and initial instruction evaluation. */
+    plframe_dwarf_cie_cache_entry_t cies[PLFRAME_DWARF_CIE_CACHE_SIZE];
+
+    /** CFA program checkpoints, indexed by plframe_dwarf_checkpoint_index(). Rows that miss in @a entries may resume
+     * evaluation of their FDE's program from the nearest preceding checkpoint. */
+    plframe_dwarf_checkpoint_entry_t checkpoints[PLFRAME_DWARF_CHECKPOINT_FDE_COUNT];
+
+    /** Decoded CFA and register rule expressions. This cache is internally locked. */
+    dwarf_expression_cache expressions;
+
+    /** The budget charged for the cache, or NULL. See plframe_dwarf_cache_set_budget(). */
+    plcrash_async_cache_budget_t *budget;
+
+    /** The cache's registration with @a budget, or PLCRASH_ASYNC_CACHE_ID_INVALID. */
+    plcrash_async_cache_id_t budget_id;
+};
+
+PLCR_ASSERT_STATIC(DWARF_CACHE_STATE_SIZE, sizeof(dwarf_cfa_state<uint32_t, int32_t>) <= sizeof(((plframe_dwarf_cache_entry_t *) NULL)->cfa_state));
+
+/**
+ * Allocate a new, empty DWARF unwind cache from @a allocator.
+ *
+ * @param result On success, will be set to the new cache. The cache must be released via plframe_dwarf_cache_free().
+ * @param allocator The allocator from which the cache will be allocated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+plcrash_error_t plframe_dwarf_cache_new (plframe_dwarf_cache_t **result, plcrash_async_allocator_t *allocator) {
+    plframe_dwarf_cache_t *cache;
+    plcrash_error_t err;
+    void *buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(*cache))) != PLCRASH_ESUCCESS)
+        return err;
+    cache = (plframe_dwarf_cache_t *) buf;
+
+    cache->lock = OS_SPINLOCK_INIT;
+    for (size_t i = 0; i < PLFRAME_DWARF_CACHE_SIZE; i++)
+        cache->entries[i].valid = false;
+    for (size_t i = 0; i < PLFRAME_DWARF_CIE_CACHE_SIZE; i++)
+        cache->cies[i].valid = false;
+    for (size_t i = 0; i < PLFRAME_DWARF_CHECKPOINT_FDE_COUNT; i++)
+        cache->checkpoints[i].valid = false;
+    cache->expressions.init();
+    cache->budget = NULL;
+    cache->budget_id = PLCRASH_ASYNC_CACHE_ID_INVALID;
+
+    *result = cache;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Charge the memory retained by @a cache to @a budget. The cache's storage is fixed in size and allocated up front,
+ * and as such, the cache is registered as non-evictable; if the budget cannot accommodate it, the caller should free
+ * the cache and unwind without it.
+ *
+ * @param cache The cache to configure.
+ * @param budget The budget to charge. The budget must outlive @a cache.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be registered with or charged
+ * to @a budget.
+ */
+plcrash_error_t plframe_dwarf_cache_set_budget (plframe_dwarf_cache_t *cache, plcrash_async_cache_budget_t *budget) {
+    plcrash_error_t err;
+
+    PLCF_ASSERT(cache->budget == NULL);
+
+    if ((err = plcrash_async_cache_budget_register(budget, "dwarf_unwind", sizeof(*cache), false, &cache->budget_id)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_async_cache_budget_charge(budget, cache->budget_id, sizeof(*cache))) != PLCRASH_ESUCCESS) {
+        plcrash_async_cache_budget_unregister(budget, cache->budget_id);
+        cache->budget_id = PLCRASH_ASYNC_CACHE_ID_INVALID;
+        return err;
+    }
+
+    cache->budget = budget;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free @a cache.
+ *
+ * @param cache The cache to free.
+ * @param allocator The allocator used to allocate @a cache.
+ */
+void plframe_dwarf_cache_free (plframe_dwarf_cache_t *cache, plcrash_async_allocator_t *allocator) {
+    if (cache->budget != NULL)
+        plcrash_async_cache_budget_unregister(cache->budget, cache->budget_id);
+
+    plcrash_async_allocator_dealloc(allocator, cache);
+}
+
+/**
+ * @internal
+ *
+ * Return the cache entry index for @a pc.
+ */
+static inline size_t plframe_dwarf_cache_index (uint64_t pc) {
+    return (size_t) ((pc ^ (pc >> 8)) & (PLFRAME_DWARF_CACHE_SIZE - 1));
+}
+
+/**
+ * @internal
+ *
+ * Look up the evaluated CFA state for @a pc within @a image.
+ *
+ * @param cache The cache to search.
+ * @param image The image containing @a pc.
+ * @param pc The PC to look up.
+ * @param cie_info On success, will be populated with the CIE used to evaluate @a cfa_state.
+ * @param cfa_state On success, will be populated with the cached CFA state.
+ *
+ * @return Returns true if an entry was found, or false otherwise.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static bool plframe_dwarf_cache_lookup (plframe_dwarf_cache_t *cache,
+                                        plcrash_async_macho_t *image,
+                                        machine_ptr pc,
+                                        plcrash_async_dwarf_cie_info_t *cie_info,
+                                        dwarf_cfa_state<machine_ptr, machine_ptr_s> *cfa_state)
+{
+    plframe_dwarf_cache_entry_t *entry = &cache->entries[plframe_dwarf_cache_index(pc)];
+    bool found = false;
+
+    OSSpinLockLock(&cache->lock); {
+        if (entry->valid && entry->header_addr == image->header_addr && entry->pc == pc) {
+            plcrash_async_memcpy(cie_info, &entry->cie_info, sizeof(*cie_info));
+            plcrash_async_memcpy(cfa_state, entry->cfa_state, sizeof(*cfa_state));
+            found = true;
+        }
+    } OSSpinLockUnlock(&cache->lock);
+
+    plcrash_async_cache_budget_record(cache->budget, cache->budget_id, found);
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Record the evaluated CFA state for @a pc within @a image, replacing any existing entry in the same slot.
+ *
+ * @param cache The cache to be updated.
+ * @param image The image containing @a pc.
+ * @param pc The PC for which @a cfa_state was evaluated.
+ * @param cie_info The CIE used to evaluate @a cfa_state.
+ * @param cfa_state The evaluated CFA state.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static void plframe_dwarf_cache_insert (plframe_dwarf_cache_t *cache,
+                                        plcrash_async_macho_t *image,
+                                        machine_ptr pc,
+                                        const plcrash_async_dwarf_cie_info_t *cie_info,
+                                        const dwarf_cfa_state<machine_ptr, machine_ptr_s> *cfa_state)
+{
+    plframe_dwarf_cache_entry_t *entry = &cache->entries[plframe_dwarf_cache_index(pc)];
+
+    OSSpinLockLock(&cache->lock); {
+        entry->valid = true;
+        entry->header_addr = image->header_addr;
+        entry->pc = pc;
+        plcrash_async_memcpy(&entry->cie_info, cie_info, sizeof(*cie_info));
+        plcrash_async_memcpy(entry->cfa_state, cfa_state, sizeof(*cfa_state));
+    } OSSpinLockUnlock(&cache->lock);
+}
+
+/**
+ * @internal
+ *
+ * Return the CIE cache entry index for the CIE at @a cie_offset within the section at @a section_addr.
+ */
+static inline size_t plframe_dwarf_cie_cache_index (pl_vm_address_t section_addr, uint64_t cie_offset) {
+    return (size_t) (((section_addr >> 12) ^ cie_offset ^ (cie_offset >> 6)) & (PLFRAME_DWARF_CIE_CACHE_SIZE - 1));
+}
+
+/**
+ * @internal
+ *
+ * Look up the parsed CIE at @a cie_offset within @a section.
+ *
+ * @param cache The cache to search.
+ * @param section The DWARF section containing the CIE.
+ * @param cie_offset The section-relative offset of the CIE.
+ * @param cie_info On success, will be populated with the parsed CIE.
+ * @param initial_state On success, if the CIE's evaluated initial instructions were cached, will be populated with the
+ * evaluated state.
+ * @param has_initial_state On success, will be set to true if @a initial_state was populated.
+ *
+ * @return Returns true if an entry was found, or false otherwise.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static bool plframe_dwarf_cie_cache_lookup (plframe_dwarf_cache_t *cache,
+                                            plcrash_async_mobject_t *section,
+                                            uint64_t cie_offset,
+                                            plcrash_async_dwarf_cie_info_t *cie_info,
+                                            dwarf_cfa_state<machine_ptr, machine_ptr_s> *initial_state,
+                                            bool *has_initial_state)
+{
+    pl_vm_address_t section_addr = plcrash_async_mobject_base_address(section);
+    plframe_dwarf_cie_cache_entry_t *entry = &cache->cies[plframe_dwarf_cie_cache_index(section_addr, cie_offset)];
+    bool found = false;
+
+    OSSpinLockLock(&cache->lock); {
+        if (entry->valid && entry->section_addr == section_addr && entry->cie_offset == cie_offset) {
+            plcrash_async_memcpy(cie_info, &entry->cie_info, sizeof(*cie_info));
+            if ((*has_initial_state = entry->has_initial_state))
+                plcrash_async_memcpy(initial_state, entry->initial_state, sizeof(*initial_state));
+            found = true;
+        }
+    } OSSpinLockUnlock(&cache->lock);
+
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Record the parsed CIE at @a cie_offset within @a section, replacing any existing entry in the same slot.
+ *
+ * @param cache The cache to be updated.
+ * @param section The DWARF section containing the CIE.
+ * @param cie_offset The section-relative offset of the CIE.
+ * @param cie_info The parsed CIE.
+ * @param initial_state The result of evaluating the CIE's initial instructions, or NULL if the result depends on the
+ * FDE (or the evaluation failed).
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static void plframe_dwarf_cie_cache_insert (plframe_dwarf_cache_t *cache,
+                                            plcrash_async_mobject_t *section,
+                                            uint64_t cie_offset,
+                                            const plcrash_async_dwarf_cie_info_t *cie_info,
+                                            const dwarf_cfa_state<machine_ptr, machine_ptr_s> *initial_state)
+{
+    pl_vm_address_t section_addr = plcrash_async_mobject_base_address(section);
+    plframe_dwarf_cie_cache_entry_t *entry = &cache->cies[plframe_dwarf_cie_cache_index(section_addr, cie_offset)];
+
+    OSSpinLockLock(&cache->lock); {
+        entry->valid = true;
+        entry->section_addr = section_addr;
+        entry->cie_offset = cie_offset;
+        plcrash_async_memcpy(&entry->cie_info, cie_info, sizeof(*cie_info));
+
+        entry->has_initial_state = (initial_state != NULL);
+        if (initial_state != NULL)
+            plcrash_async_memcpy(entry->initial_state, initial_state, sizeof(*initial_state));
+    } OSSpinLockUnlock(&cache->lock);
+}
+
+/**
+ * @internal
+ *
+ * Return the checkpoint entry index for the FDE at @a fde_offset within the section at @a section_addr.
+ */
+static inline size_t plframe_dwarf_checkpoint_index (pl_vm_address_t section_addr, uint64_t fde_offset) {
+    return (size_t) (((section_addr >> 12) ^ fde_offset ^ (fde_offset >> 7)) & (PLFRAME_DWARF_CHECKPOINT_FDE_COUNT - 1));
+}
+
+/**
+ * @internal
+ *
+ * Look up the latest recorded checkpoint from which evaluation of the FDE program at @a fde_offset may be resumed for
+ * @a pc.
+ *
+ * @param cache The cache to search.
+ * @param section The DWARF section containing the FDE.
+ * @param fde_offset The section-relative offset of the FDE.
+ * @param pc The PC for which the program will be evaluated.
+ * @param checkpoint On success, will be populated with the checkpoint.
+ *
+ * @return Returns true if a checkpoint was found, or false otherwise.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static bool plframe_dwarf_checkpoint_lookup (plframe_dwarf_cache_t *cache,
+                                             plcrash_async_mobject_t *section,
+                                             uint64_t fde_offset,
+                                             machine_ptr pc,
+                                             dwarf_cfa_checkpoint<machine_ptr, machine_ptr_s> *checkpoint)
+{
+    pl_vm_address_t section_addr = plcrash_async_mobject_base_address(section);
+    plframe_dwarf_checkpoint_entry_t *entry = &cache->checkpoints[plframe_dwarf_checkpoint_index(section_addr, fde_offset)];
+    bool found = false;
+
+    OSSpinLockLock(&cache->lock); {
+        if (entry->valid && entry->section_addr == section_addr && entry->fde_offset == fde_offset) {
+            /* max_location is non-decreasing in program order; the last reachable checkpoint is the nearest */
+            for (size_t i = entry->count; i > 0 && !found; i--) {
+                if (entry->checkpoints[i - 1].max_location > pc)
+                    continue;
+
+                checkpoint->position = (pl_vm_size_t) entry->checkpoints[i - 1].position;
+                checkpoint->location = (machine_ptr) entry->checkpoints[i - 1].location;
+                checkpoint->max_location = (machine_ptr) entry->checkpoints[i - 1].max_location;
+                plcrash_async_memcpy(&checkpoint->state, entry->checkpoints[i - 1].state, sizeof(checkpoint->state));
+                found = true;
+            }
+        }
+    } OSSpinLockUnlock(&cache->lock);
+
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Checkpoint recording context passed to plframe_dwarf_checkpoint_record().
+ */
+typedef struct plframe_dwarf_checkpoint_context {
+    /** The cache to be updated. */
+    plframe_dwarf_cache_t *cache;
+
+    /** The task-relative base address of the DWARF section containing the FDE. */
+    pl_vm_address_t section_addr;
+
+    /** The section-relative offset of the FDE. */
+    uint64_t fde_offset;
+} plframe_dwarf_checkpoint_context_t;
+
+/**
+ * @internal
+ *
+ * dwarf_cfa_checkpoint_recorder callback; records a checkpoint for the FDE described by @a context, replacing any
+ * checkpoints recorded for a different FDE in the same slot.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static void plframe_dwarf_checkpoint_record (void *context,
+                                             pl_vm_size_t position,
+                                             machine_ptr location,
+                                             machine_ptr max_location,
+                                             const dwarf_cfa_state<machine_ptr, machine_ptr_s> *state)
+{
+    plframe_dwarf_checkpoint_context_t *ctx = (plframe_dwarf_checkpoint_context_t *) context;
+    plframe_dwarf_checkpoint_entry_t *entry = &ctx->cache->checkpoints[plframe_dwarf_checkpoint_index(ctx->section_addr, ctx->fde_offset)];
+
+    OSSpinLockLock(&ctx->cache->lock); {
+        if (!entry->valid || entry->section_addr != ctx->section_addr || entry->fde_offset != ctx->fde_offset) {
+            entry->valid = true;
+            entry->section_addr = ctx->section_addr;
+            entry->fde_offset = ctx->fde_offset;
+            entry->count = 0;
+        }
+
+        /* Checkpoints are kept in program order; an evaluation resumed from an earlier checkpoint will re-report
+         * positions that have already been recorded. */
+        if (entry->count < PLFRAME_DWARF_CHECKPOINT_COUNT && (entry->count == 0 || entry->checkpoints[entry->count - 1].position < position)) {
+            entry->checkpoints[entry->count].position = position;
+            entry->checkpoints[entry->count].location = location;
+            entry->checkpoints[entry->count].max_location = max_location;
+            plcrash_async_memcpy(entry->checkpoints[entry->count].state, state, sizeof(*state));
+            entry->count++;
+        }
+    } OSSpinLockUnlock(&ctx->cache->lock);
+}
+
+/**
+ * @internal
+ *
+ * Fetch the __eh_frame FDE offset hint for @a pc from @a image's compact unwind data, if available. The compact unwind
+ * encoding provides a section-relative FDE offset (UNWIND_*_MODE_DWARF) for functions whose unwind rules can not be
+ * expressed using the compact encoding, allowing the FDE to be located without a linear scan of __eh_frame.
+ *
+ * @param section_cache The section cache to be used to map the compact unwind section, or NULL.
+ * @param image The Mach-O image containing @a pc.
+ * @param pc The PC value for which an FDE offset should be returned.
+ * @param fde_offset On success, will be set to the section-relative offset of the FDE.
+ *
+ * @return Returns true if an FDE offset was found, or false if no hint is available.
+ */
+static bool plframe_cursor_find_dwarf_fde_hint (plcrash_async_macho_section_cache_t *section_cache, plcrash_async_macho_t *image, pl_vm_address_t pc, pl_vm_off_t *fde_offset) {
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plcrash_async_mobject_t unwind_storage;
+    plcrash_async_mobject_t *unwind_mobj;
+    plcrash_async_cfe_reader_t reader;
+    plcrash_async_cfe_entry_t entry;
+    pl_vm_address_t function_base;
+    uint32_t encoding;
+    plcrash_error_t err;
+    bool found = false;
+
+    /* Fetch the (possibly cached) unwind section mapping */
+    if (plcrash_async_macho_section_cache_map(section_cache, image, SEG_TEXT, "__unwind_info", &unwind_storage, &unwind_mobj) != PLCRASH_ESUCCESS)
+        return false;
+
+    /* Find the encoding entry (if any) */
+    cpu_type_t cputype = image->byteorder->swap32(image->header.cputype);
+    if ((err = plcrash_async_cfe_reader_init(&reader, unwind_mobj, cputype)) != PLCRASH_ESUCCESS) {
+        plcrash_async_macho_section_cache_unmap(section_cache, unwind_mobj);
+        return false;
+    }
+
+    err = plcrash_async_cfe_reader_find_pc(&reader, pc - image->header_addr, &function_base, &encoding);
+    plcrash_async_cfe_reader_free(&reader);
+    plcrash_async_macho_section_cache_unmap(section_cache, unwind_mobj);
+
+    if (err != PLCRASH_ESUCCESS)
+        return false;
+
+    /* Decode the entry, and extract the FDE offset */
+    if (plcrash_async_cfe_entry_init(&entry, cputype, encoding) != PLCRASH_ESUCCESS)
+        return false;
+
+    if (plcrash_async_cfe_entry_type(&entry) == PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF) {
+        *fde_offset = plcrash_async_cfe_entry_stack_offset(&entry);
+        found = true;
+    }
+
+    plcrash_async_cfe_entry_free(&entry);
+    return found;
+#else
+    return false;
+#endif /* PLCRASH_FEATURE_UNWIND_COMPACT */
+}
+
 /**
  * @internal
  *
@@ -69,9 +600,9 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
 {
     gnu_ehptr_reader<machine_ptr> ptr_state(image->byteorder);
 
-    /* Mapped DWARF sections; only one of eh_frame/debug_frame will be mapped */
-    plcrash_async_mobject_t eh_frame;
-    plcrash_async_mobject_t debug_frame;
+    /* The DWARF section mapping, as returned by plcrash_async_macho_section_cache_map(); only one of
+     * eh_frame/debug_frame will be used */
+    plcrash_async_mobject_t dwarf_storage;
     plcrash_async_mobject_t *dwarf_section = NULL;
     bool is_debug_frame = false;
     
@@ -83,28 +614,36 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     
     plcrash_async_dwarf_cie_info_t cie_info;
     bool did_init_cie = false;
+    bool cached_initial_state = false;
     
     /* CFA evaluation stack */
     plcrash::async::dwarf_cfa_state<machine_ptr, machine_ptr_s> cfa_state;
+
+    /* Borrowed reference to the report's decoded expression cache, if any */
+    plcrash::async::dwarf_expression_cache *expr_cache;
     
     plframe_error_t result;
     plcrash_error_t err;
-        
+
+    /* If the CFA state for this PC has already been evaluated, skip directly to applying it. The cached CIE copy
+     * does not require freeing. */
+    if (current_frame->dwarf_cache != NULL && plframe_dwarf_cache_lookup(current_frame->dwarf_cache, image, pc, &cie_info, &cfa_state))
+        goto apply;
+
     /*
      * Map the eh_frame or debug_frame DWARF sections. Apple doesn't seem to use debug_frame at all;
      * as such, we prefer eh_frame, but allow falling back on debug_frame.
      */
     {
-        err = plcrash_async_macho_map_section(image, "__TEXT", "__eh_frame", &eh_frame);
-        if (err == PLCRASH_ESUCCESS) {
-            dwarf_section = &eh_frame;
-        }
-        
-        if (dwarf_section == NULL) {
-            err = plcrash_async_macho_map_section(image, "__DWARF", "__debug_frame", &debug_frame);
+        err = plcrash_async_macho_section_cache_map(current_frame->section_cache, image, "__TEXT", "__eh_frame", &dwarf_storage, &dwarf_section);
+        if (err != PLCRASH_ESUCCESS) {
+            dwarf_section = NULL;
+
+            err = plcrash_async_macho_section_cache_map(current_frame->section_cache, image, "__DWARF", "__debug_frame", &dwarf_storage, &dwarf_section);
             if (err == PLCRASH_ESUCCESS) {
-                dwarf_section = &debug_frame;
                 is_debug_frame = true;
+            } else {
+                dwarf_section = NULL;
             }
         }
         
@@ -123,9 +662,20 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
         goto cleanup;
     }
     
-    /* Find the FDE (if any) */
+    /* Find the FDE (if any). If the compact unwind data supplies an __eh_frame offset for this PC, the FDE can be
+     * fetched directly; otherwise (or if the hint is stale), fall back on a scan of the full section. */
     {
-        err = reader.find_fde(0x0 /* offset hint */, pc, &fde_info);
+        pl_vm_off_t fde_hint = 0x0;
+        if (!is_debug_frame && plframe_cursor_find_dwarf_fde_hint(current_frame->section_cache, image, pc, &fde_hint) && fde_hint != 0x0) {
+            err = reader.find_fde(fde_hint, pc, &fde_info);
+            if (err != PLCRASH_ESUCCESS)
+                PLCF_DEBUG("Compact unwind FDE offset hint 0x%" PRIx64 " did not match PC 0x%" PRIx64 ": %d", (uint64_t) fde_hint, (uint64_t) pc, err);
+        } else {
+            err = PLCRASH_ENOTFOUND;
+        }
+
+        if (err != PLCRASH_ESUCCESS)
+            err = reader.find_fde(0x0 /* offset hint */, pc, &fde_info);
         
         if (err != PLCRASH_ESUCCESS) {
             result = PLFRAME_ENOTSUP;
@@ -134,13 +684,25 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
         did_init_fde = true;
     }
     
-    /* Initialize pointer state */
+    /* Initialize pointer state. The segment bases are invariant for the image, and were recorded alongside its load
+     * command table at initialization time; no load commands need be consulted here. */
     {
-        // TODO - configure the pointer state */
+        const plcrash_async_macho_eh_bases_t *bases = &image->lc_table.eh_bases;
+        pl_vm_address_t section_addr = plcrash_async_mobject_base_address(dwarf_section);
+
+        ptr_state.set_frame_section_base((machine_ptr) section_addr, (machine_ptr) section_addr);
+        ptr_state.set_func_base((machine_ptr) fde_info.pc_start);
+
+        if (bases->has_text_base)
+            ptr_state.set_text_base((machine_ptr) bases->text_base);
+
+        if (bases->has_data_base)
+            ptr_state.set_data_base((machine_ptr) bases->data_base);
     }
     
-    /* Parse CIE info */
-    {
+    /* Parse CIE info, unless the parsed CIE (and possibly its evaluated initial instructions) is already cached. The
+     * cached CIE copy does not require freeing. */
+    if (current_frame->dwarf_cache == NULL || !plframe_dwarf_cie_cache_lookup(current_frame->dwarf_cache, dwarf_section, fde_info.cie_offset, &cie_info, &cfa_state, &cached_initial_state)) {
         err = plcrash_async_dwarf_cie_info_init(&cie_info, dwarf_section, image->byteorder, &ptr_state, plcrash_async_mobject_base_address(dwarf_section) + fde_info.cie_offset);
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("Failed to parse CIE at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.cie_offset, err);
@@ -159,24 +721,59 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
         PLCF_ASSERT(fde_info.pc_start < std::numeric_limits<machine_ptr>::max());
 
         /* Initial instructions */
-        err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), cie_info.initial_instructions_offset, cie_info.initial_instructions_length);
-        if (err != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("Failed to evaluate CFA at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.instructions_offset, err);
-            result = PLFRAME_ENOTSUP;
-            goto cleanup;
+        if (!cached_initial_state) {
+            bool location_dependent;
+            err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), cie_info.initial_instructions_offset, cie_info.initial_instructions_length, &location_dependent);
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to evaluate CFA at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.instructions_offset, err);
+                result = PLFRAME_ENOTSUP;
+                goto cleanup;
+            }
+
+            /* Cache the newly parsed CIE, along with the evaluated initial instructions if they're shareable by all
+             * of the CIE's FDEs */
+            if (current_frame->dwarf_cache != NULL && did_init_cie)
+                plframe_dwarf_cie_cache_insert(current_frame->dwarf_cache, dwarf_section, fde_info.cie_offset, &cie_info, location_dependent ? NULL : &cfa_state);
         }
         
-        /*  FDE instructions */
-        err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), fde_info.instructions_offset, fde_info.instructions_length);
+        /* FDE instructions. Long programs resume from the nearest checkpoint recorded by an earlier lookup within the
+         * same function, recording further checkpoints as evaluation proceeds. */
+        dwarf_cfa_checkpoint<machine_ptr, machine_ptr_s> checkpoint;
+        const dwarf_cfa_checkpoint<machine_ptr, machine_ptr_s> *resume = NULL;
+
+        plframe_dwarf_checkpoint_context_t checkpoint_ctx;
+        dwarf_cfa_checkpoint_recorder<machine_ptr, machine_ptr_s> checkpoint_recorder;
+        const dwarf_cfa_checkpoint_recorder<machine_ptr, machine_ptr_s> *recorder = NULL;
+
+        if (current_frame->dwarf_cache != NULL && fde_info.instructions_length >= PLFRAME_DWARF_CHECKPOINT_MIN_LENGTH) {
+            if (plframe_dwarf_checkpoint_lookup(current_frame->dwarf_cache, dwarf_section, fde_info.fde_offset, pc, &checkpoint))
+                resume = &checkpoint;
+
+            checkpoint_ctx.cache = current_frame->dwarf_cache;
+            checkpoint_ctx.section_addr = plcrash_async_mobject_base_address(dwarf_section);
+            checkpoint_ctx.fde_offset = fde_info.fde_offset;
+
+            checkpoint_recorder.interval = fde_info.instructions_length / (PLFRAME_DWARF_CHECKPOINT_COUNT + 1);
+            checkpoint_recorder.record = plframe_dwarf_checkpoint_record<machine_ptr, machine_ptr_s>;
+            checkpoint_recorder.context = &checkpoint_ctx;
+            recorder = &checkpoint_recorder;
+        }
+
+        err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), fde_info.instructions_offset, fde_info.instructions_length, NULL, resume, recorder);
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("Failed to evaluate CFA at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.instructions_offset, err);
             result = PLFRAME_ENOTSUP;
             goto cleanup;
         }
     }
-    
+
+    if (current_frame->dwarf_cache != NULL)
+        plframe_dwarf_cache_insert(current_frame->dwarf_cache, image, pc, &cie_info, &cfa_state);
+
+apply:
     /* Apply the frame delta -- this may fail. */
-    if ((err = cfa_state.apply_state(task, &cie_info, &current_frame->thread_state, image->byteorder, &next_frame->thread_state)) == PLCRASH_ESUCCESS) {
+    expr_cache = (current_frame->dwarf_cache != NULL) ? &current_frame->dwarf_cache->expressions : NULL;
+    if ((err = cfa_state.apply_state(task, &cie_info, &current_frame->thread_state, image->byteorder, &next_frame->thread_state, expr_cache)) == PLCRASH_ESUCCESS) {
         result = PLFRAME_ESUCCESS;
     } else {
         PLCF_DEBUG("Failed to apply CFA state for PC 0x%" PRIx64 ": %d", (uint64_t) pc, err);
@@ -186,14 +783,14 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     // Fall-through
     
 cleanup:
-    if (dwarf_section != NULL)
-        plcrash_async_mobject_free(dwarf_section);
-    
     if (did_init_cie)
         plcrash_async_dwarf_cie_info_free(&cie_info);
     
     if (did_init_fde)
         plcrash_async_dwarf_fde_info_free(&fde_info);
+
+    if (dwarf_section != NULL)
+        plcrash_async_macho_section_cache_unmap(current_frame->section_cache, dwarf_section);
     
     return result;
 }
@@ -225,8 +822,10 @@ plframe_error_t plframe_cursor_read_dwarf_unwind (task_t task,
     plcrash_greg_t pc = plcrash_async_thread_state_get_reg(&current_frame->thread_state, PLCRASH_REG_IP);
 
     
-    /* Find the corresponding image */
-    plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, pc);
+    /* Find the corresponding image, preferring the image already resolved by the frame cursor */
+    plcrash_async_macho_t *image = current_frame->image;
+    if (image == NULL)
+        image = plcrash_async_image_containing_address(image_list, pc);
     if (image == NULL) {
         PLCF_DEBUG("Could not find a loaded image for the current frame pc: 0x%" PRIx64, (uint64_t) pc);
         return PLFRAME_ENOTSUP;
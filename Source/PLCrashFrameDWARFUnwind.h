@@ -29,6 +29,8 @@
 
 #include "PLCrashFeatureConfig.h"
 #include "PLCrashFrameWalker.h"
+#include "PLCrashAsyncAllocator.h"
+#include "PLCrashAsyncCacheBudget.h"
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
@@ -36,6 +38,17 @@
 extern "C" {
 #endif
 
+/**
+ * @internal
+ *
+ * A cache of evaluated DWARF unwind rules, keyed by image and PC. A cache may be shared across all cursors used to
+ * walk a task's threads; all access is serialized internally. See plframe_cursor_set_dwarf_cache().
+ */
+typedef struct plframe_dwarf_cache plframe_dwarf_cache_t;
+
+plcrash_error_t plframe_dwarf_cache_new (plframe_dwarf_cache_t **result, plcrash_async_allocator_t *allocator);
+plcrash_error_t plframe_dwarf_cache_set_budget (plframe_dwarf_cache_t *cache, plcrash_async_cache_budget_t *budget);
+void plframe_dwarf_cache_free (plframe_dwarf_cache_t *cache, plcrash_async_allocator_t *allocator);
 
 plframe_error_t plframe_cursor_read_dwarf_unwind (task_t task,
                                                   plcrash_async_image_list_t *image_list,
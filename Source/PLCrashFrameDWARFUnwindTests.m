@@ -28,6 +28,7 @@
 #import "SenTestCompat.h"
 #import "PLCrashFrameDWARFUnwind.h"
 #import "PLCrashFeatureConfig.h"
+#import "PLCrashTestThread.h"
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
@@ -48,6 +49,28 @@
 
 @end
 
+/**
+ * Walk @a thread's stack, recording each frame's PC in @a pcs.
+ *
+ * @return Returns the number of frames recorded.
+ */
+static size_t walk_thread (thread_t thread, plcrash_async_image_list_t *image_list, plframe_dwarf_cache_t *cache, plcrash_greg_t *pcs, size_t max) {
+    plframe_cursor_t cursor;
+    size_t count = 0;
+
+    if (plframe_cursor_thread_init(&cursor, mach_task_self(), thread, image_list) == PLFRAME_ESUCCESS) {
+        plframe_cursor_set_dwarf_cache(&cursor, cache);
+        while (count < max && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+            if (plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pcs[count]) != PLFRAME_ESUCCESS)
+                break;
+            count++;
+        }
+    }
+
+    plframe_cursor_free(&cursor);
+    return count;
+}
+
 @implementation PLCrashFrameDWARFUnwindTests
 
 - (void) setUp {
@@ -76,7 +99,7 @@
 }
 
 - (void) testMissingImage {
-    plframe_stackframe_t frame;
+    plframe_stackframe_t frame = {};
     plframe_stackframe_t next;
     plframe_error_t err;
     
@@ -87,6 +110,35 @@
     STAssertEquals(err, PLFRAME_ENOTSUP, @"Unexpected result for a frame missing a valid image");
 }
 
+/**
+ * Verify that walking a stack via an (initially empty, and then populated) DWARF cache produces the same frames as
+ * an uncached walk.
+ */
+- (void) testCachedUnwind {
+    plcrash_test_thread_t thr;
+    plframe_dwarf_cache_t *cache;
+    plcrash_greg_t expected[64];
+    plcrash_greg_t actual[64];
+
+    STAssertEquals(plframe_dwarf_cache_new(&cache, _allocator), PLCRASH_ESUCCESS, @"Failed to allocate cache");
+    plcrash_test_thread_spawn(&thr);
+
+    thread_t thread = pthread_mach_thread_np(thr.thread);
+    size_t expected_count = walk_thread(thread, _image_list, NULL, expected, sizeof(expected) / sizeof(expected[0]));
+    STAssertTrue(expected_count > 0, @"Failed to walk test thread");
+
+    for (int pass = 0; pass < 2; pass++) {
+        size_t actual_count = walk_thread(thread, _image_list, cache, actual, sizeof(actual) / sizeof(actual[0]));
+        STAssertEquals(actual_count, expected_count, @"Cached walk returned a different frame count on pass %d", pass);
+
+        for (size_t i = 0; i < actual_count && i < expected_count; i++)
+            STAssertEquals(actual[i], expected[i], @"Cached walk returned a different PC for frame %zu on pass %d", i, pass);
+    }
+
+    plcrash_test_thread_stop(&thr);
+    plframe_dwarf_cache_free(cache, _allocator);
+}
+
 @end
 
 #endif /* PLCRASH_FEATURE_UNWIND_DWARF */
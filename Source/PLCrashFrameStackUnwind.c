@@ -28,6 +28,19 @@
 
 #include "PLCrashFrameStackUnwind.h"
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncRegionMap.h"
+
+/**
+ * @internal
+ * The number of stack words read and classified at once by plframe_cursor_read_stack_scan().
+ */
+#define STACK_SCAN_BATCH_WORDS 32
+
+/**
+ * @internal
+ * The maximum number of stack words examined by plframe_cursor_read_stack_scan() when searching for a single frame.
+ */
+#define STACK_SCAN_MAX_WORDS 1024
 
 /**
  * Fetch the next frame, assuming a valid frame pointer in @a cursor's current frame.
@@ -93,7 +106,10 @@ plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
     plcrash_greg_t new_pc;
     plcrash_error_t err;
     
-    err = plcrash_async_task_memcpy(task, (pl_vm_address_t) fp, 0, dest, len);
+    if (current_frame->stack_window != NULL)
+        err = plframe_stack_window_read(current_frame->stack_window, task, (pl_vm_address_t) fp, 0, dest, len);
+    else
+        err = plcrash_async_task_memcpy(task, (pl_vm_address_t) fp, 0, dest, len);
     if (err != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Failed to read frame: %d", err);
         return PLFRAME_EBADFRAME;
@@ -116,3 +132,209 @@ plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
 
     return PLFRAME_ESUCCESS;
 }
+
+#ifdef PLCRASH_ASYNC_THREAD_X86_SUPPORT
+/**
+ * @internal
+ *
+ * Determine whether the @a len bytes ending at @a code end with an x86 indirect call instruction (FF /2) of exactly
+ * @a len bytes, ignoring any prefixes. The supported encodings are those produced by compilers for calls through a
+ * register or a memory operand: ModRM, optionally followed by a SIB byte, and a displacement.
+ */
+static bool plframe_stack_scan_x86_indirect_call (const uint8_t *code, size_t len) {
+    if (len < 2 || code[0] != 0xFF)
+        return false;
+
+    uint8_t modrm = code[1];
+    uint8_t mod = modrm >> 6;
+    uint8_t rm = modrm & 0x7;
+
+    /* ModRM.reg must be 2 (CALL) */
+    if (((modrm >> 3) & 0x7) != 2)
+        return false;
+
+    size_t expected = 2;
+    if (mod != 3 && rm == 4)
+        expected++; /* SIB */
+
+    if (mod == 1)
+        expected += 1;
+    else if (mod == 2 || (mod == 0 && rm == 5))
+        expected += 4;
+
+    return expected == len;
+}
+#endif
+
+/**
+ * @internal
+ *
+ * Determine whether @a address immediately follows a call instruction within an executable mapping, and is thus a
+ * plausible return address.
+ *
+ * If the current task's region map has been installed via plcrash_async_region_map_set_current(), it is used to
+ * verify that the call site is executable. On 32-bit ARM, where ARM and Thumb call encodings can not be distinguished
+ * without the caller's instruction set state, the call instruction is not verified.
+ *
+ * @param task The task containing @a address.
+ * @param thread_state The thread state of the frame being scanned.
+ * @param address The candidate return address.
+ */
+static bool plframe_stack_scan_follows_call (task_t task, const plcrash_async_thread_state_t *thread_state, pl_vm_address_t address) {
+    const plcrash_async_region_map_t *map;
+    if (address == 0)
+        return false;
+
+    if (task == mach_task_self() && (map = plcrash_async_region_map_current()) != NULL) {
+        if (!plcrash_async_region_map_verify(map, address - 1, 1, VM_PROT_READ|VM_PROT_EXECUTE))
+            return false;
+    }
+
+#if defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
+    if (plcrash_async_thread_state_get_greg_size(thread_state) == sizeof(uint64_t)) {
+        uint32_t insn;
+
+        if (address < sizeof(insn) || (address & 0x3) != 0)
+            return false;
+
+        if (plcrash_async_task_memcpy(task, address, -((pl_vm_off_t) sizeof(insn)), &insn, sizeof(insn)) != PLCRASH_ESUCCESS)
+            return false;
+
+        /* BL <label> */
+        if ((insn & 0xFC000000) == 0x94000000)
+            return true;
+
+        /* BLR <Xn> */
+        if ((insn & 0xFFFFFC1F) == 0xD63F0000)
+            return true;
+
+        /* BLRAA, BLRAAZ, BLRAB, BLRABZ */
+        if ((insn & 0xFEFFF800) == 0xD63F0800)
+            return true;
+
+        return false;
+    }
+
+    return true;
+#elif defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT)
+    /* The longest supported call encoding is 7 bytes: FF /2 with SIB and a 32-bit displacement */
+    uint8_t code[7];
+    if (address < sizeof(code))
+        return false;
+
+    if (plcrash_async_task_memcpy(task, address, -((pl_vm_off_t) sizeof(code)), code, sizeof(code)) != PLCRASH_ESUCCESS)
+        return false;
+
+    /* CALL rel32 */
+    if (code[sizeof(code) - 5] == 0xE8)
+        return true;
+
+    /* CALL r/m */
+    for (size_t len = 2; len <= sizeof(code); len++) {
+        if (plframe_stack_scan_x86_indirect_call(&code[sizeof(code) - len], len))
+            return true;
+    }
+
+    return false;
+#else
+    return true;
+#endif
+}
+
+/**
+ * Fetch the next frame by scanning the stack for the first word that references an image's TEXT segment immediately
+ * following a call instruction, treating that word as the caller's return address.
+ *
+ * This is a heuristic of last resort, for use when no other reader is able to unwind the current frame; stale
+ * return addresses and function pointers stored on the stack are indistinguishable from genuine return addresses,
+ * and may produce spurious frames.
+ *
+ * The scan begins at the current frame's stack pointer or, if unavailable, immediately above the previous frame's
+ * frame record. Stack words are read in batches, and each batch is classified via
+ * plcrash_async_image_list_classify_addresses(); at most STACK_SCAN_MAX_WORDS words will be examined.
+ *
+ * This reader is not used by plframe_cursor_next(); it must be explicitly provided to
+ * plframe_cursor_next_with_readers(), following any other readers.
+ *
+ * @param task The task containing the target frame stack.
+ * @param image_list The list of images loaded in the target @a task.
+ * @param current_frame The current stack frame.
+ * @param previous_frame The previous stack frame, or NULL if this is the first frame.
+ * @param next_frame The new frame to be initialized.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ */
+plframe_error_t plframe_cursor_read_stack_scan (task_t task,
+                                                plcrash_async_image_list_t *image_list,
+                                                const plframe_stackframe_t *current_frame,
+                                                const plframe_stackframe_t *previous_frame,
+                                                plframe_stackframe_t *next_frame)
+{
+    size_t word_size = plcrash_async_thread_state_get_greg_size(&current_frame->thread_state);
+    union {
+        uint64_t greg64[STACK_SCAN_BATCH_WORDS];
+        uint32_t greg32[STACK_SCAN_BATCH_WORDS];
+    } words;
+    pl_vm_address_t candidates[STACK_SCAN_BATCH_WORDS];
+    bool matches[STACK_SCAN_BATCH_WORDS];
+    pl_vm_address_t address;
+
+    if (image_list == NULL)
+        return PLFRAME_ENOTSUP;
+
+    /* Scanning assumes that callers' frames lie at higher addresses */
+    if (plcrash_async_thread_state_get_stack_direction(&current_frame->thread_state) != PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN)
+        return PLFRAME_ENOTSUP;
+
+    /* Determine the scan's starting address */
+    if (plcrash_async_thread_state_has_reg(&current_frame->thread_state, PLCRASH_REG_SP)) {
+        address = plcrash_async_thread_state_get_reg(&current_frame->thread_state, PLCRASH_REG_SP);
+    } else if (previous_frame != NULL && plcrash_async_thread_state_has_reg(&previous_frame->thread_state, PLCRASH_REG_FP)) {
+        /* The current frame's stack begins immediately after the frame record (saved FP and return address) from
+         * which it was read */
+        address = plcrash_async_thread_state_get_reg(&previous_frame->thread_state, PLCRASH_REG_FP) + (word_size * 2);
+    } else {
+        PLCF_DEBUG("Neither the stack pointer nor a frame record are available, can't scan the stack.");
+        return PLFRAME_EBADFRAME;
+    }
+
+    for (size_t scanned = 0; scanned < STACK_SCAN_MAX_WORDS; scanned += STACK_SCAN_BATCH_WORDS) {
+        pl_vm_size_t len = STACK_SCAN_BATCH_WORDS * word_size;
+        plcrash_error_t err;
+
+        if (current_frame->stack_window != NULL)
+            err = plframe_stack_window_read(current_frame->stack_window, task, address, 0, &words, len);
+        else
+            err = plcrash_async_task_memcpy(task, address, 0, &words, len);
+
+        if (err != PLCRASH_ESUCCESS) {
+            /* The end of the stack has been reached */
+            PLCF_DEBUG("Stack scan terminated at unreadable address 0x%" PRIx64 ": %d", (uint64_t) address, err);
+            return PLFRAME_ENOFRAME;
+        }
+
+        for (size_t i = 0; i < STACK_SCAN_BATCH_WORDS; i++)
+            candidates[i] = (word_size == sizeof(uint64_t)) ? (pl_vm_address_t) words.greg64[i] : words.greg32[i];
+
+        if (plcrash_async_image_list_classify_addresses(image_list, candidates, STACK_SCAN_BATCH_WORDS, matches) > 0) {
+            for (size_t i = 0; i < STACK_SCAN_BATCH_WORDS; i++) {
+                if (!matches[i] || !plframe_stack_scan_follows_call(task, &current_frame->thread_state, candidates[i]))
+                    continue;
+
+                /* Initialize the new frame; the caller's stack begins immediately above its return address */
+                *next_frame = *current_frame;
+
+                plcrash_async_thread_state_clear_all_regs(&next_frame->thread_state);
+                plcrash_async_thread_state_set_reg(&next_frame->thread_state, PLCRASH_REG_IP, candidates[i]);
+                plcrash_async_thread_state_set_reg(&next_frame->thread_state, PLCRASH_REG_SP, address + ((i + 1) * word_size));
+
+                return PLFRAME_ESUCCESS;
+            }
+        }
+
+        address += len;
+    }
+
+    PLCF_DEBUG("No return address found within %d stack words", STACK_SCAN_MAX_WORDS);
+    return PLFRAME_ENOFRAME;
+}
@@ -40,6 +40,12 @@ plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
                                                const plframe_stackframe_t *current_frame,
                                                const plframe_stackframe_t *previous_frame,
                                                plframe_stackframe_t *next_frame);
+
+plframe_error_t plframe_cursor_read_stack_scan (task_t task,
+                                                plcrash_async_image_list_t *image_list,
+                                                const plframe_stackframe_t *current_frame,
+                                                const plframe_stackframe_t *previous_frame,
+                                                plframe_stackframe_t *next_frame);
     
 #ifdef __cplusplus
 }
@@ -35,6 +35,14 @@ struct stack_frame {
     uintptr_t pc;
 } __attribute__((packed));
 
+/**
+ * Return the address to which this function will return; this is a genuine return address, immediately following
+ * a call instruction.
+ */
+static uintptr_t __attribute__((noinline)) stack_scan_return_address (void) {
+    return (uintptr_t) __builtin_return_address(0);
+}
+
 /**
  * @internal
  *
@@ -165,4 +173,127 @@ struct stack_frame {
     STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, _image_list, &frame, &prev_frame, &new_frame), PLFRAME_EBADFRAME, @"Expected to hit end of frames");
 }
 
+/**
+ * Verify that frames are read through the cursor's stack window, and that reads outside the window fall back
+ * to direct task reads.
+ */
+- (void) testStackWindow {
+    /* Set up test stack */
+    struct stack_frame frames[] = {
+        { .fp = &frames[1], .pc = 0x1 },
+        { .fp = 0x0,        .pc = 0x2 },
+    };
+
+    /* Configure thread state */
+    plcrash_async_thread_state_t state;
+    plcrash_async_thread_state_mach_thread_init(&state, pl_mach_thread_self());
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_FP, frames[0].fp);
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_IP, frames[0].pc);
+
+    plframe_cursor_t cursor;
+    plframe_cursor_init(&cursor, mach_task_self(), &state, _image_list);
+    STAssertEquals(cursor.frame.stack_window, &cursor.stack_window, @"Cursor frame should reference the cursor's stack window");
+    STAssertFalse(cursor.stack_window.initialized, @"Stack window should be mapped lazily");
+
+    /* Read the next frame; this should map the window */
+    plframe_stackframe_t new_frame;
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, _image_list, &cursor.frame, NULL, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&new_frame.thread_state, PLCRASH_REG_IP), (plcrash_greg_t) frames[1].pc, @"Incorrect IP");
+    STAssertTrue(cursor.stack_window.initialized, @"Stack window was not initialized");
+    STAssertTrue(cursor.stack_window.mapped, @"Stack window was not mapped");
+    STAssertEquals(plcrash_async_mobject_base_address(&cursor.stack_window.mobj), (pl_vm_address_t) &frames[0], @"Window should start at the first frame read");
+
+    /* Reads below the window must fall back to a direct copy */
+    uint32_t below = 0xCAFEF00D;
+    uint32_t result = 0;
+    if ((pl_vm_address_t) &below < (pl_vm_address_t) &frames[0]) {
+        STAssertEquals(plframe_stack_window_read(&cursor.stack_window, mach_task_self(), (pl_vm_address_t) &below, 0, &result, sizeof(result)), PLCRASH_ESUCCESS, @"Failed to read outside of window");
+        STAssertEquals(result, below, @"Incorrect value read outside of window");
+    }
+
+    plframe_cursor_free(&cursor);
+    STAssertFalse(cursor.stack_window.mapped, @"Stack window was not freed");
+}
+
+/**
+ * Verify that frames are read from a stack snapshot, if provided.
+ */
+- (void) testStackSnapshot {
+    /* Set up test stack */
+    struct stack_frame frames[] = {
+        { .fp = &frames[1], .pc = 0x1 },
+        { .fp = 0x0,        .pc = 0x2 },
+    };
+
+    /* Snapshot the stack, and then modify the original */
+    struct stack_frame snapshot[sizeof(frames) / sizeof(frames[0])];
+    memcpy(snapshot, frames, sizeof(snapshot));
+    frames[1].pc = 0x3;
+
+    /* Configure thread state */
+    plcrash_async_thread_state_t state;
+    plcrash_async_thread_state_mach_thread_init(&state, pl_mach_thread_self());
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_FP, frames[0].fp);
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_IP, frames[0].pc);
+
+    plframe_cursor_t cursor;
+    plframe_cursor_init(&cursor, mach_task_self(), &state, _image_list);
+    plframe_cursor_set_stack_snapshot(&cursor, (pl_vm_address_t) &frames[0], snapshot, sizeof(snapshot));
+
+    /* The snapshot's values should be returned */
+    plframe_stackframe_t new_frame;
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, _image_list, &cursor.frame, NULL, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&new_frame.thread_state, PLCRASH_REG_IP), (plcrash_greg_t) 0x2, @"IP was not read from the snapshot");
+    STAssertFalse(cursor.stack_window.mapped, @"Stack should not be mapped when a snapshot is available");
+
+    /* Reads outside of the snapshot fall back to the task */
+    uint32_t value = 0xCAFEF00D;
+    uint32_t result = 0;
+    STAssertEquals(plframe_stack_window_read(&cursor.stack_window, mach_task_self(), (pl_vm_address_t) &value, 0, &result, sizeof(result)), PLCRASH_ESUCCESS, @"Failed to read outside of snapshot");
+    STAssertEquals(result, value, @"Incorrect value read outside of snapshot");
+
+    plframe_cursor_free(&cursor);
+}
+
+/**
+ * Verify that stack scanning recovers the first word referencing an image's TEXT segment, immediately following a
+ * call instruction, as the return address.
+ */
+- (void) testStackScan {
+    /* Set up a test stack containing two return addresses, interleaved with non-code values */
+    uintptr_t stack[64];
+    memset(stack, 0, sizeof(stack));
+    stack[1] = 0x42;
+    stack[2] = (uintptr_t) &stack[8];
+    stack[5] = stack_scan_return_address();
+    stack[40] = (uintptr_t) __builtin_return_address(0);
+
+    /* Configure thread state */
+    plcrash_async_thread_state_t state;
+    plcrash_async_thread_state_mach_thread_init(&state, pl_mach_thread_self());
+    plcrash_async_thread_state_clear_all_regs(&state);
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_SP, (plcrash_greg_t) &stack[0]);
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_IP, 0x1);
+
+    plframe_cursor_t cursor;
+    plframe_cursor_init(&cursor, mach_task_self(), &state, _image_list);
+
+    /* The first return address is treated as the caller's return address */
+    plframe_stackframe_t new_frame;
+    STAssertEquals(plframe_cursor_read_stack_scan(cursor.task, _image_list, &cursor.frame, NULL, &new_frame), PLFRAME_ESUCCESS, @"Failed to scan for the next frame");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&new_frame.thread_state, PLCRASH_REG_IP), (plcrash_greg_t) stack[5], @"Incorrect IP");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&new_frame.thread_state, PLCRASH_REG_SP), (plcrash_greg_t) &stack[6], @"Incorrect SP");
+    STAssertFalse(plcrash_async_thread_state_has_reg(&new_frame.thread_state, PLCRASH_REG_FP), @"FP should not be recovered");
+
+    /* Scanning continues from the recovered frame */
+    plframe_stackframe_t caller_frame;
+    STAssertEquals(plframe_cursor_read_stack_scan(cursor.task, _image_list, &new_frame, &cursor.frame, &caller_frame), PLFRAME_ESUCCESS, @"Failed to scan for the next frame");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&caller_frame.thread_state, PLCRASH_REG_IP), (plcrash_greg_t) stack[40], @"Incorrect IP");
+
+    /* An image list is required */
+    STAssertEquals(plframe_cursor_read_stack_scan(cursor.task, NULL, &cursor.frame, NULL, &new_frame), PLFRAME_ENOTSUP, @"Scanning without an image list should fail");
+
+    plframe_cursor_free(&cursor);
+}
+
 @end
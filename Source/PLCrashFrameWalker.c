@@ -67,6 +67,22 @@ const char *plframe_strerror (plframe_error_t error) {
 
 #pragma mark Frame Walking
 
+/** The frame readers used by plframe_cursor_next() and plframe_cursor_walk(), in order of preference. */
+static plframe_cursor_frame_reader_t *plframe_cursor_default_readers[] = {
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plframe_cursor_read_compact_unwind,
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plframe_cursor_read_dwarf_unwind,
+#endif
+
+    plframe_cursor_read_frame_ptr
+};
+
+/** The number of entries in plframe_cursor_default_readers. */
+#define PLFRAME_DEFAULT_READER_COUNT (sizeof(plframe_cursor_default_readers) / sizeof(plframe_cursor_default_readers[0]))
+
 /**
  * @internal
  * Shared initializer. Assumes that the initial frame has all registers available.
@@ -79,6 +95,14 @@ static void plframe_cursor_internal_init (plframe_cursor_t *cursor, task_t task,
     cursor->depth = 0;
     cursor->task = task;
     cursor->image_list = image_list;
+    plframe_stack_window_init(&cursor->stack_window);
+    cursor->frame.stack_window = &cursor->stack_window;
+    cursor->frame.dwarf_cache = NULL;
+    cursor->frame.compact_unwind_cache = NULL;
+    cursor->frame.section_cache = NULL;
+    cursor->frame.image = NULL;
+    cursor->image_index_valid = false;
+    cursor->image_index = 0;
     mach_port_mod_refs(mach_task_self(), cursor->task, MACH_PORT_RIGHT_SEND, 1);    
 }
 
@@ -125,17 +149,89 @@ plframe_error_t plframe_cursor_thread_init (plframe_cursor_t *cursor, task_t tas
 }
 
 /**
- * Fetch the next frame using the provided frame readers.
+ * @internal
+ *
+ * Determine whether @a reader is known to be unable to unwind a frame within @a image, as the image does not
+ * contain the unwind data required by the reader.
+ *
+ * @param reader The frame reader.
+ * @param image The image containing the frame's IP, or NULL if no image contains the IP.
+ * @param[out] ferr If true is returned, will be set to the error that @a reader would return for the frame.
+ *
+ * @return Returns true if @a reader may be skipped, or false if it must be executed.
+ */
+static bool plframe_cursor_reader_unavailable (plframe_cursor_frame_reader_t *reader, plcrash_async_macho_t *image, plframe_error_t *ferr) {
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    if (reader == plframe_cursor_read_compact_unwind && (image == NULL || !image->has_compact_unwind)) {
+        *ferr = PLFRAME_ENOTSUP;
+        return true;
+    }
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (reader == plframe_cursor_read_dwarf_unwind) {
+        if (image == NULL) {
+            *ferr = PLFRAME_ENOTSUP;
+            return true;
+        } else if (!image->has_dwarf_unwind) {
+            *ferr = PLFRAME_ENOFRAME;
+            return true;
+        }
+    }
+#endif
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Find the image containing @a address. The image that contained the previously resolved address is checked first;
+ * as consecutive frames are frequently found within the same image, this avoids most image list searches.
+ *
+ * @param cursor The frame cursor.
+ * @param address The address to look up.
+ * @param[out] index If an image is found, will be set to the image's index within the cursor's image list.
+ *
+ * @return Returns the image containing @a address, or NULL if not found.
+ */
+static plcrash_async_macho_t *plframe_cursor_resolve_image (plframe_cursor_t *cursor, pl_vm_address_t address, size_t *index) {
+    plcrash_async_macho_t *image;
+
+    /* The image list may have been modified since the last lookup */
+    if (cursor->image_index_valid && cursor->image_index < plcrash_async_image_list_count(cursor->image_list)) {
+        image = plcrash_async_image_list_get_image(cursor->image_list, cursor->image_index);
+        if (image != NULL && plcrash_async_macho_contains_address(image, address)) {
+            *index = cursor->image_index;
+            return image;
+        }
+    }
+
+    if (!plcrash_async_image_list_index_containing_address(cursor->image_list, address, index))
+        return NULL;
+
+    cursor->image_index = *index;
+    cursor->image_index_valid = true;
+    return plcrash_async_image_list_get_image(cursor->image_list, *index);
+}
+
+/**
+ * @internal
+ *
+ * Fetch the next frame using the provided frame readers. This implements plframe_cursor_next_with_readers(),
+ * additionally returning the reader that produced the frame.
  *
  * @param cursor A cursor instance initialized with plframe_cursor_init();
- * @param readers Frame readers to be used to fetch the next frame. Each reader will be executed in the provided order until a valid frame is read.
+ * @param readers Frame readers to be used to fetch the next frame.
  * @param reader_count The number of readers provided in @a readers.
- * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ * @param[out] used_reader On success, will be set to the reader that read the new frame, or NULL if the new frame is
+ * the thread's initial frame.
  */
-plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count) {
+static plframe_error_t plframe_cursor_step (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count, plframe_cursor_frame_reader_t **used_reader) {
     /* The first frame is already available via existing thread state. */
     if (cursor->depth == 0) {
         cursor->depth++;
+        *used_reader = NULL;
         return PLFRAME_ESUCCESS;
     }
     
@@ -148,16 +244,39 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
     plframe_stackframe_t frame;
     plframe_error_t ferr = PLFRAME_EINVAL; // default return value if reader_count is 0.
     
+    /* Look up the current frame's image once, allowing readers that require unavailable unwind data to be skipped, and
+     * providing the image to the readers that do execute. */
+    plcrash_async_macho_t *image = NULL;
+    bool image_resolved = false;
+    if (cursor->image_list != NULL && plcrash_async_thread_state_has_reg(&cursor->frame.thread_state, PLCRASH_REG_IP)) {
+        size_t index;
+        image = plframe_cursor_resolve_image(cursor, plcrash_async_thread_state_get_reg(&cursor->frame.thread_state, PLCRASH_REG_IP), &index);
+        image_resolved = true;
+    }
+    cursor->frame.image = image;
+
     for (size_t i = 0; i < reader_count; i++) {
+        if (image_resolved && plframe_cursor_reader_unavailable(readers[i], image, &ferr))
+            continue;
+
         ferr = readers[i](cursor->task, cursor->image_list, &cursor->frame, prev_frame, &frame);
-        if (ferr == PLFRAME_ESUCCESS)
+        if (ferr == PLFRAME_ESUCCESS) {
+            *used_reader = readers[i];
             break;
+        }
     }
     
     if (ferr != PLFRAME_ESUCCESS) {
         return ferr;
     }
 
+    /* Readers are not required to propagate the stack window or unwind caches */
+    frame.stack_window = &cursor->stack_window;
+    frame.dwarf_cache = cursor->frame.dwarf_cache;
+    frame.compact_unwind_cache = cursor->frame.compact_unwind_cache;
+    frame.section_cache = cursor->frame.section_cache;
+    frame.image = NULL;
+
     /* Check for completion */
     if (!plcrash_async_thread_state_has_reg(&frame.thread_state, PLCRASH_REG_IP)) {
         PLCF_DEBUG("Missing expected IP value in successfully read frame");
@@ -177,6 +296,22 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
     return PLFRAME_ESUCCESS;
 }
 
+/**
+ * Fetch the next frame using the provided frame readers.
+ *
+ * Readers that are known to be unable to unwind the current frame -- such as the compact unwind reader, for an image
+ * that does not contain an __unwind_info section -- are skipped without being executed.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ * @param readers Frame readers to be used to fetch the next frame. Each reader will be executed in the provided order until a valid frame is read.
+ * @param reader_count The number of readers provided in @a readers.
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ */
+plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count) {
+    plframe_cursor_frame_reader_t *reader;
+    return plframe_cursor_step(cursor, readers, reader_count, &reader);
+}
+
 /**
  * Fetch the next frame.
  *
@@ -184,20 +319,53 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
  * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
  */
 plframe_error_t plframe_cursor_next (plframe_cursor_t *cursor) {
-    plframe_cursor_frame_reader_t *readers[] = {
+    return plframe_cursor_next_with_readers(cursor, plframe_cursor_default_readers, PLFRAME_DEFAULT_READER_COUNT);
+}
 
-#if PLCRASH_FEATURE_UNWIND_COMPACT
-        plframe_cursor_read_compact_unwind,
-#endif
+/**
+ * Unwind up to @a max frames from @a cursor in a single call, using the same frame readers as plframe_cursor_next().
+ *
+ * The image containing each frame's IP is carried forward from frame to frame, and is shared with the frame readers;
+ * a run of frames within a single image requires a single image list search. The cursor is left positioned on the
+ * last frame written to @a frames, and may be used to continue the walk.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init().
+ * @param frames The destination for the unwound frames. Must have room for at least @a max frames.
+ * @param max The maximum number of frames to unwind.
+ * @param[out] count On return, will be set to the number of frames written to @a frames.
+ *
+ * @return Returns PLFRAME_ESUCCESS if @a max frames were unwound, PLFRAME_ENOFRAME if the walk terminated before @a max
+ * frames were unwound, or a standard plframe_error_t code if an error occurs. In all cases, the frames unwound prior to
+ * termination are written to @a frames.
+ */
+plframe_error_t plframe_cursor_walk (plframe_cursor_t *cursor, plframe_walk_frame_t *frames, size_t max, size_t *count) {
+    plframe_error_t ferr = PLFRAME_ESUCCESS;
+    size_t n;
 
-#if PLCRASH_FEATURE_UNWIND_DWARF
-        plframe_cursor_read_dwarf_unwind,
-#endif
+    for (n = 0; n < max; n++) {
+        plframe_walk_frame_t *out = &frames[n];
+
+        ferr = plframe_cursor_step(cursor, plframe_cursor_default_readers, PLFRAME_DEFAULT_READER_COUNT, &out->reader);
+        if (ferr != PLFRAME_ESUCCESS)
+            break;
+
+        plcrash_async_thread_state_t *ts = &cursor->frame.thread_state;
+        out->pc = plcrash_async_thread_state_has_reg(ts, PLCRASH_REG_IP) ? plcrash_async_thread_state_get_reg(ts, PLCRASH_REG_IP) : 0;
+        out->fp = plcrash_async_thread_state_has_reg(ts, PLCRASH_REG_FP) ? plcrash_async_thread_state_get_reg(ts, PLCRASH_REG_FP) : 0;
+        out->sp = plcrash_async_thread_state_has_reg(ts, PLCRASH_REG_SP) ? plcrash_async_thread_state_get_reg(ts, PLCRASH_REG_SP) : 0;
 
-        plframe_cursor_read_frame_ptr
-    };
+        /* Resolving the image here primes the cursor's image context; the next step's lookup for this same IP
+         * will be satisfied without a search. */
+        out->image_index = PLFRAME_WALK_NO_IMAGE;
+        if (cursor->image_list != NULL && out->pc != 0) {
+            size_t index;
+            if (plframe_cursor_resolve_image(cursor, out->pc, &index) != NULL)
+                out->image_index = index;
+        }
+    }
 
-    return plframe_cursor_next_with_readers(cursor, readers, sizeof(readers)/sizeof(readers[0]));
+    *count = n;
+    return ferr;
 }
 
 
@@ -245,4 +413,163 @@ size_t plframe_cursor_get_regcount (plframe_cursor_t *cursor) {
 void plframe_cursor_free(plframe_cursor_t *cursor) {
     if (cursor->task != MACH_PORT_NULL)
         mach_port_mod_refs(mach_task_self(), cursor->task, MACH_PORT_RIGHT_SEND, -1);
+
+    plframe_stack_window_free(&cursor->stack_window);
+}
+
+/**
+ * Configure @a cursor to read stack data from a previously captured copy of the target thread's stack. This
+ * allows a thread to be unwound after it has been resumed, provided that the copy covers the thread's frames.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init().
+ * @param address The task-relative address at which @a data was copied; generally, the thread's stack pointer.
+ * @param data The copied stack data. This is a borrowed reference, and must remain valid for the lifetime of @a cursor.
+ * @param length The number of bytes available at @a data.
+ *
+ * @note Only the frame pointer reader reads stack data via the cursor; the compact unwind and DWARF readers continue
+ * to read saved registers directly from the target task.
+ */
+void plframe_cursor_set_stack_snapshot (plframe_cursor_t *cursor, pl_vm_address_t address, const void *data, pl_vm_size_t length) {
+    plframe_stack_window_free(&cursor->stack_window);
+    plframe_stack_window_init_snapshot(&cursor->stack_window, address, data, length);
+}
+
+/**
+ * Configure @a cursor to consult and populate @a cache when unwinding frames via DWARF eh_frame/debug_frame data. A
+ * single cache may be shared by all cursors used to walk the threads of a task, allowing the evaluated unwind rules
+ * for a return address to be reused across threads.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init().
+ * @param cache The cache to be used, or NULL to disable caching. This is a borrowed reference, and must remain valid
+ * for the lifetime of @a cursor.
+ */
+void plframe_cursor_set_dwarf_cache (plframe_cursor_t *cursor, struct plframe_dwarf_cache *cache) {
+    cursor->frame.dwarf_cache = cache;
+}
+
+/**
+ * Configure @a cursor to consult and populate @a cache when unwinding frames via compact unwind data. As with
+ * plframe_cursor_set_dwarf_cache(), a single cache may be shared by all cursors used to walk the threads of a task.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init().
+ * @param cache The cache to be used, or NULL to disable caching. This is a borrowed reference, and must remain valid
+ * for the lifetime of @a cursor.
+ */
+void plframe_cursor_set_compact_unwind_cache (plframe_cursor_t *cursor, struct plframe_compact_unwind_cache *cache) {
+    cursor->frame.compact_unwind_cache = cache;
+}
+
+/**
+ * Configure @a cursor to map the unwind sections of the task's images via @a cache, allowing each image's sections
+ * to be mapped once, rather than once per frame. Unlike the DWARF and compact unwind caches, a section cache is not
+ * thread-safe, and may only be shared by cursors used from a single thread.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init().
+ * @param cache The cache to be used, or NULL to map sections on each use. This is a borrowed reference, and must
+ * remain valid for the lifetime of @a cursor.
+ */
+void plframe_cursor_set_section_cache (plframe_cursor_t *cursor, plcrash_async_macho_section_cache_t *cache) {
+    cursor->frame.section_cache = cache;
+}
+
+#pragma mark Stack Window
+
+/**
+ * Initialize a new, unmapped stack window.
+ *
+ * @param window The window to be initialized.
+ */
+void plframe_stack_window_init (plframe_stack_window_t *window) {
+    window->initialized = false;
+    window->mapped = false;
+    window->snapshot = NULL;
+    window->snapshot_address = 0;
+    window->snapshot_length = 0;
+}
+
+/**
+ * Initialize a stack window backed by a previously captured copy of the target stack. No mapping will be
+ * performed; reads outside of the copied range will fall back to plcrash_async_task_memcpy().
+ *
+ * @param window The window to be initialized.
+ * @param address The task-relative address at which @a data was copied.
+ * @param data The copied stack data. This is a borrowed reference, and must remain valid for the lifetime of @a window.
+ * @param length The number of bytes available at @a data.
+ */
+void plframe_stack_window_init_snapshot (plframe_stack_window_t *window, pl_vm_address_t address, const void *data, pl_vm_size_t length) {
+    plframe_stack_window_init(window);
+
+    window->initialized = true;
+    window->snapshot = data;
+    window->snapshot_address = address;
+    window->snapshot_length = length;
+}
+
+/**
+ * Read @a len bytes at @a address + @a offset from @a task. If the data is not available within @a window,
+ * it will be fetched via plcrash_async_task_memcpy().
+ *
+ * On the first call, @a window will attempt to map up to PLFRAME_STACK_WINDOW_SIZE bytes of the target stack,
+ * starting at the requested address. Stacks grow downwards on all supported architectures, and as such, the caller's
+ * frames will be found above any initially read address.
+ *
+ * @param window The stack window to read from.
+ * @param task The task containing the target stack.
+ * @param address The base address to be read.
+ * @param offset The offset from @a address at which data will be read.
+ * @param dest The destination address to which copied data will be written.
+ * @param len The number of bytes to be read.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or the error returned by plcrash_async_task_memcpy() if the data
+ * is not readable.
+ */
+plcrash_error_t plframe_stack_window_read (plframe_stack_window_t *window, task_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len) {
+    if (!window->initialized) {
+        pl_vm_address_t base;
+        window->initialized = true;
+
+        /* Map the window; short mappings are permitted, and will be terminated at the first unmapped page. */
+        if (plcrash_async_address_apply_offset(address, offset, &base) &&
+            plcrash_async_mobject_init(&window->mobj, task, base, PLFRAME_STACK_WINDOW_SIZE, false) == PLCRASH_ESUCCESS)
+        {
+            window->mapped = true;
+        }
+    }
+
+    /* Try the snapshot */
+    if (window->snapshot != NULL) {
+        pl_vm_address_t target;
+        if (plcrash_async_address_apply_offset(address, offset, &target) &&
+            target >= window->snapshot_address &&
+            len <= window->snapshot_length &&
+            target - window->snapshot_address <= window->snapshot_length - len)
+        {
+            plcrash_async_memcpy(dest, (const uint8_t *) window->snapshot + (target - window->snapshot_address), len);
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    /* Try the window */
+    if (window->mapped && plcrash_async_mobject_task(&window->mobj) == task) {
+        void *src = plcrash_async_mobject_remap_address(&window->mobj, address, offset, len);
+        if (src != NULL) {
+            plcrash_async_memcpy(dest, src, len);
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    /* Fall back on a direct read */
+    return plcrash_async_task_memcpy(task, address, offset, dest, len);
+}
+
+/**
+ * Free all resources associated with @a window.
+ *
+ * @param window The window to be freed.
+ */
+void plframe_stack_window_free (plframe_stack_window_t *window) {
+    if (window->mapped)
+        plcrash_async_mobject_free(&window->mobj);
+
+    plframe_stack_window_init(window);
 }
@@ -40,6 +40,7 @@
 
 #include "PLCrashAsyncThread.h"
 #include "PLCrashAsyncDynamicLoader.h"
+#include "PLCrashAsyncMObject.h"
 
 /* Configure supported targets based on the host build architecture. There's currently
  * no deployed architecture on which simultaneous support for different processor families
@@ -111,6 +112,42 @@ typedef enum  {
     PLFRAME_EBADREG
 } plframe_error_t;
 
+/**
+ * @internal
+ *
+ * The maximum number of bytes of the target thread's stack that will be mapped by a plframe_stack_window_t.
+ */
+#define PLFRAME_STACK_WINDOW_SIZE (512 * 1024)
+
+/**
+ * @internal
+ *
+ * A lazily mapped window over a thread's stack. The window is mapped on first access, starting at the
+ * first address read and extending towards the top of the stack, and serves all subsequent reads that
+ * fall within its range without issuing additional kernel calls. Reads outside of the window fall
+ * back to plcrash_async_task_memcpy().
+ */
+typedef struct plframe_stack_window {
+    /** If true, a mapping has been attempted. */
+    bool initialized;
+
+    /** If true, the mapping succeeded and @a mobj is valid. */
+    bool mapped;
+
+    /** The stack mapping. Only valid if @a mapped is true. */
+    plcrash_async_mobject_t mobj;
+
+    /** A previously captured copy of the target stack, or NULL. If non-NULL, reads are served from the copy rather than
+     * from a mapping. This is a borrowed reference. */
+    const void *snapshot;
+
+    /** The task-relative address at which @a snapshot was captured. */
+    pl_vm_address_t snapshot_address;
+
+    /** The number of bytes available via @a snapshot. */
+    pl_vm_size_t snapshot_length;
+} plframe_stack_window_t;
+
 /**
  * @internal
  *
@@ -119,6 +156,26 @@ typedef enum  {
 typedef struct plframe_stackframe {
     /** Thread state */
     plcrash_async_thread_state_t thread_state;
+
+    /** The stack window to be used when reading frame data, or NULL. This is a borrowed reference owned
+     * by the frame cursor. */
+    plframe_stack_window_t *stack_window;
+
+    /** The DWARF unwind cache to be consulted when reading frame data, or NULL. This is a borrowed reference; see
+     * plframe_cursor_set_dwarf_cache(). */
+    struct plframe_dwarf_cache *dwarf_cache;
+
+    /** The compact unwind cache to be consulted when reading frame data, or NULL. This is a borrowed reference; see
+     * plframe_cursor_set_compact_unwind_cache(). */
+    struct plframe_compact_unwind_cache *compact_unwind_cache;
+
+    /** The section cache to be used when mapping unwind sections, or NULL. This is a borrowed reference; see
+     * plframe_cursor_set_section_cache(). */
+    plcrash_async_macho_section_cache_t *section_cache;
+
+    /** The image containing the frame's IP, as resolved by the frame cursor, or NULL if no image was resolved. Frame
+     * readers may use this in place of looking up the image. This is a borrowed reference owned by the image list. */
+    plcrash_async_macho_t *image;
 } plframe_stackframe_t;
 
 /**
@@ -141,6 +198,16 @@ typedef struct plframe_cursor {
 
     /** The current stack frame data */
     plframe_stackframe_t frame;
+
+    /** The window over the target thread's stack. */
+    plframe_stack_window_t stack_window;
+
+    /** If true, @a image_index is the image list index of the image containing the most recently resolved IP.
+     * Consecutive frames within the same image are resolved against this image without searching the image list. */
+    bool image_index_valid;
+
+    /** The image list index of the most recently resolved image. Only valid if @a image_index_valid is true. */
+    size_t image_index;
 } plframe_cursor_t;
 
 /**
@@ -160,6 +227,29 @@ typedef plframe_error_t plframe_cursor_frame_reader_t (task_t task,
                                                        const plframe_stackframe_t *previous_frame,
                                                        plframe_stackframe_t *next_frame);
 
+/** The plframe_walk_frame_t image index of a frame whose IP is not within any image in the cursor's image list. */
+#define PLFRAME_WALK_NO_IMAGE SIZE_MAX
+
+/**
+ * A frame unwound by plframe_cursor_walk().
+ */
+typedef struct plframe_walk_frame {
+    /** The frame's instruction pointer. */
+    plcrash_greg_t pc;
+
+    /** The frame's frame pointer, or 0 if unavailable. */
+    plcrash_greg_t fp;
+
+    /** The frame's stack pointer, or 0 if unavailable. */
+    plcrash_greg_t sp;
+
+    /** The index of the image containing @a pc within the cursor's image list, or PLFRAME_WALK_NO_IMAGE. */
+    size_t image_index;
+
+    /** The reader that unwound this frame from its callee, or NULL for the thread's initial frame. */
+    plframe_cursor_frame_reader_t *reader;
+} plframe_walk_frame_t;
+
 const char *plframe_strerror (plframe_error_t error);
 
 plframe_error_t plframe_cursor_init (plframe_cursor_t *cursor, task_t task, plcrash_async_thread_state_t *thread_state, plcrash_async_image_list_t *image_list);
@@ -171,9 +261,20 @@ plframe_error_t plframe_cursor_get_reg (plframe_cursor_t *cursor, plcrash_regnum
 
 plframe_error_t plframe_cursor_next (plframe_cursor_t *cursor);
 plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count);
+plframe_error_t plframe_cursor_walk (plframe_cursor_t *cursor, plframe_walk_frame_t *frames, size_t max, size_t *count);
 
 void plframe_cursor_free(plframe_cursor_t *cursor);
 
+void plframe_cursor_set_stack_snapshot (plframe_cursor_t *cursor, pl_vm_address_t address, const void *data, pl_vm_size_t length);
+void plframe_cursor_set_dwarf_cache (plframe_cursor_t *cursor, struct plframe_dwarf_cache *cache);
+void plframe_cursor_set_compact_unwind_cache (plframe_cursor_t *cursor, struct plframe_compact_unwind_cache *cache);
+void plframe_cursor_set_section_cache (plframe_cursor_t *cursor, plcrash_async_macho_section_cache_t *cache);
+
+void plframe_stack_window_init (plframe_stack_window_t *window);
+void plframe_stack_window_init_snapshot (plframe_stack_window_t *window, pl_vm_address_t address, const void *data, pl_vm_size_t length);
+plcrash_error_t plframe_stack_window_read (plframe_stack_window_t *window, task_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len);
+void plframe_stack_window_free (plframe_stack_window_t *window);
+
 /**
  * @} plcrash_framewalker
  */
@@ -31,6 +31,8 @@
 #import "SenTestCompat.h"
 
 #import "PLCrashFrameWalker.h"
+#import "PLCrashFrameCompactUnwind.h"
+#import "PLCrashFrameDWARFUnwind.h"
 #import "PLCrashTestThread.h"
 
 #import "unwind_test_harness.h"
@@ -139,6 +141,96 @@ static plframe_error_t esuccess_reader (task_t task,
     
 }
 
+/**
+ * Test that readers skipped due to unavailable unwind data report the same result as the readers themselves.
+ */
+- (void) testSkipUnavailableReaders {
+    plframe_cursor_t cursor;
+    plcrash_async_thread_state_t ts;
+
+    /* Initialize a cursor with an IP that falls outside of any loaded image */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_thread_state_mach_thread_init(&ts, pthread_mach_thread_np(_thr_args.thread)), @"Failed to fetch thread state");
+    plcrash_async_thread_state_set_reg(&ts, PLCRASH_REG_IP, PAGE_SIZE * 2);
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_init(&cursor, mach_task_self(), &ts, _image_list), @"Initialization failed");
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next(&cursor), @"Failed to fetch first frame");
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plframe_cursor_frame_reader_t *compact_readers[] = { plframe_cursor_read_compact_unwind };
+    STAssertEquals(PLFRAME_ENOTSUP, plframe_cursor_next_with_readers(&cursor, compact_readers, 1), @"Did not return expected error code");
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plframe_cursor_frame_reader_t *dwarf_readers[] = { plframe_cursor_read_dwarf_unwind };
+    STAssertEquals(PLFRAME_ENOTSUP, plframe_cursor_next_with_readers(&cursor, dwarf_readers, 1), @"Did not return expected error code");
+#endif
+
+    /* Later readers must still be executed */
+    plframe_cursor_frame_reader_t *readers[] = {
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+        plframe_cursor_read_compact_unwind,
+#endif
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        plframe_cursor_read_dwarf_unwind,
+#endif
+        esuccess_reader
+    };
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next_with_readers(&cursor, readers, sizeof(readers) / sizeof(readers[0])), @"Did not fall through to the final reader");
+
+    plframe_cursor_free(&cursor);
+}
+
+/**
+ * Verify that plframe_cursor_walk() produces the same frames as repeated calls to plframe_cursor_next().
+ */
+- (void) testWalk {
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    plframe_cursor_t cursor;
+    plcrash_greg_t expected_pc[64];
+    plcrash_greg_t expected_sp[64];
+    size_t expected_count = 0;
+
+    /* Walk the thread one frame at a time */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), thread, _image_list), @"Initialization failed");
+    while (expected_count < 64 && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+        STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &expected_pc[expected_count]), @"Failed to fetch IP");
+        STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_get_reg(&cursor, PLCRASH_REG_SP, &expected_sp[expected_count]), @"Failed to fetch SP");
+        expected_count++;
+    }
+    plframe_cursor_free(&cursor);
+    STAssertTrue(expected_count > 1, @"Failed to walk the test thread");
+
+    /* Walk the thread in batches smaller than the total frame count, verifying that the cursor resumes correctly */
+    plframe_walk_frame_t frames[64];
+    size_t total = 0;
+    plframe_error_t ferr;
+
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), thread, _image_list), @"Initialization failed");
+    do {
+        size_t count;
+        ferr = plframe_cursor_walk(&cursor, frames + total, MIN((size_t) 3, 64 - total), &count);
+        total += count;
+    } while (ferr == PLFRAME_ESUCCESS && total < 64);
+    plframe_cursor_free(&cursor);
+
+    STAssertEquals(total, expected_count, @"Walk returned an incorrect frame count");
+    for (size_t i = 0; i < total && i < expected_count; i++) {
+        STAssertEquals(frames[i].pc, expected_pc[i], @"Incorrect PC for frame %zu", i);
+        STAssertEquals(frames[i].sp, expected_sp[i], @"Incorrect SP for frame %zu", i);
+
+        if (i == 0)
+            STAssertNULL(frames[i].reader, @"The initial frame should not have a reader");
+        else
+            STAssertNotNULL(frames[i].reader, @"Missing reader for frame %zu", i);
+
+        /* Verify the image index against a direct image list lookup */
+        size_t index;
+        if (plcrash_async_image_list_index_containing_address(_image_list, frames[i].pc, &index))
+            STAssertEquals(frames[i].image_index, index, @"Incorrect image index for frame %zu", i);
+        else
+            STAssertEquals(frames[i].image_index, (size_t) PLFRAME_WALK_NO_IMAGE, @"Expected no image for frame %zu", i);
+    }
+}
+
 /*
  * Perform stack walking regression tests.
  */
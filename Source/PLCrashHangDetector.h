@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+@class PLCrashReporter;
+
+@interface PLCrashHangReport : NSObject {
+@private
+    /** The hang's sequence number. All reports captured during a single hang share the same number. */
+    NSUInteger _hangNumber;
+
+    /** The time at which the main run loop last made progress, in mach_absolute_time() units. */
+    uint64_t _hangStartTimestamp;
+
+    /** The time at which the report was captured, in mach_absolute_time() units. */
+    uint64_t _machTimestamp;
+
+    /** The live report data. */
+    NSData *_reportData;
+}
+
+- (id) initWithHangNumber: (NSUInteger) hangNumber
+       hangStartTimestamp: (uint64_t) hangStartTimestamp
+            machTimestamp: (uint64_t) machTimestamp
+               reportData: (NSData *) reportData;
+
+/**
+ * The hang's sequence number. All reports captured during a single hang share the same number, allowing repeated
+ * captures of the same hang to be grouped.
+ */
+@property(nonatomic, readonly) NSUInteger hangNumber;
+
+/**
+ * The time at which the main run loop last made progress prior to the hang, in mach_absolute_time() units.
+ */
+@property(nonatomic, readonly) uint64_t hangStartTimestamp;
+
+/**
+ * The time at which the report was captured, in mach_absolute_time() units.
+ */
+@property(nonatomic, readonly) uint64_t machTimestamp;
+
+/**
+ * The live crash report, including only the main thread. The report may be decoded via PLCrashReport.
+ */
+@property(nonatomic, readonly) NSData *reportData;
+
+@end
+
+
+/** @internal Opaque hang detector state. */
+typedef struct plcrash_hang_detector_state plcrash_hang_detector_state_t;
+
+@interface PLCrashHangDetector : NSObject {
+@private
+    /** Detector state shared with the run loop observer and the watcher thread. */
+    plcrash_hang_detector_state_t *_state;
+
+    /** The main run loop observer, or NULL if not running. */
+    CFRunLoopObserverRef _observer;
+
+    /** YES if the watcher thread is running. */
+    BOOL _running;
+}
+
+- (id) initWithCrashReporter: (PLCrashReporter *) reporter
+                   threshold: (NSTimeInterval) threshold
+             captureInterval: (NSTimeInterval) captureInterval
+      maximumCapturesPerHang: (NSUInteger) maximumCapturesPerHang;
+
+- (BOOL) startAndReturnError: (NSError **) outError;
+- (void) stop;
+
+- (NSArray *) drainHangReports;
+
+@end
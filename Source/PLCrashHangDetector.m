@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashHangDetector.h"
+#import "PLCrashReporter.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsync.h"
+
+#import <pthread.h>
+#import <libkern/OSAtomic.h>
+#import <mach/mach_time.h>
+
+/**
+ * @internal
+ *
+ * Detector state shared between a PLCrashHangDetector instance, its main run loop observer, and its watcher thread.
+ */
+struct plcrash_hang_detector_state {
+    /** The reporter used to capture hang reports. */
+    PLCrashReporter *reporter;
+
+    /** The main thread. A send right is held for the lifetime of the state. */
+    thread_t main_thread;
+
+    /** The time at which the main run loop last made progress, in mach_absolute_time() units, or 0 if the run loop is
+     * waiting for events. This is the only value written by the main thread. */
+    volatile uint64_t heartbeat;
+
+    /** The duration for which the run loop must fail to make progress to be considered hung, in mach_absolute_time()
+     * units. */
+    uint64_t threshold;
+
+    /** The minimum interval between repeated captures of a single hang, in mach_absolute_time() units. */
+    uint64_t capture_interval;
+
+    /** The interval at which the watcher thread checks the heartbeat, in mach_absolute_time() units. */
+    uint64_t poll_interval;
+
+    /** The maximum number of reports captured for a single hang. */
+    NSUInteger max_captures;
+
+    /** Lock guarding @a reports. */
+    pthread_mutex_t lock;
+
+    /** Captured, undrained PLCrashHangReport instances. */
+    NSMutableArray *reports;
+
+    /** The watcher thread. */
+    pthread_t pthread;
+
+    /** Set to false to request that the watcher thread exit. */
+    volatile bool running;
+};
+
+/**
+ * @internal
+ *
+ * Main run loop observer callback. Records the run loop's progress with a single store; the heartbeat is cleared while
+ * the run loop waits for events, as an idle run loop is not hung.
+ */
+static void plcrash_hang_detector_observer (CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info) {
+    plcrash_hang_detector_state_t *state = info;
+    state->heartbeat = (activity == kCFRunLoopBeforeWaiting) ? 0 : mach_absolute_time();
+}
+
+/**
+ * @internal
+ *
+ * Capture a live report of the hung main thread. Only the main thread is suspended and walked; the report's
+ * configured stack snapshot allows the main thread to be resumed before its stack is unwound.
+ */
+static void plcrash_hang_detector_capture (plcrash_hang_detector_state_t *state, NSUInteger hang_number, uint64_t hang_start) {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSError *error = nil;
+
+    NSData *data = [state->reporter generateLiveReportWithThread: state->main_thread threadFilter: ^BOOL (thread_t thread) {
+        return NO;
+    } error: &error];
+
+    if (data != nil) {
+        PLCrashHangReport *report = [[PLCrashHangReport alloc] initWithHangNumber: hang_number
+                                                               hangStartTimestamp: hang_start
+                                                                    machTimestamp: mach_absolute_time()
+                                                                       reportData: data];
+        pthread_mutex_lock(&state->lock);
+        [state->reports addObject: report];
+        pthread_mutex_unlock(&state->lock);
+
+        [report release];
+    } else {
+        NSLog(@"Failed to capture hang report: %@", error);
+    }
+
+    [pool drain];
+}
+
+/**
+ * @internal
+ *
+ * Watcher thread entry point.
+ */
+static void *plcrash_hang_detector_thread (void *arg) {
+    plcrash_hang_detector_state_t *state = arg;
+    NSUInteger hang_count = 0;
+    NSUInteger captures = 0;
+    uint64_t hang_start = 0;
+    uint64_t last_capture = 0;
+
+    while (state->running) {
+        mach_wait_until(mach_absolute_time() + state->poll_interval);
+
+        uint64_t heartbeat = state->heartbeat;
+        uint64_t now = mach_absolute_time();
+
+        /* Waiting for events, or making progress */
+        if (heartbeat == 0 || heartbeat > now || now - heartbeat < state->threshold)
+            continue;
+
+        if (heartbeat != hang_start) {
+            /* A new hang; capture immediately */
+            hang_start = heartbeat;
+            hang_count++;
+            captures = 0;
+        } else if (captures >= state->max_captures || now - last_capture < state->capture_interval) {
+            /* The hang persists; capture periodically, up to the per-hang limit */
+            continue;
+        }
+
+        plcrash_hang_detector_capture(state, hang_count, hang_start);
+        last_capture = mach_absolute_time();
+        captures++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Configure @a attr to create the watcher thread at the user-interactive QoS class, ensuring that the watcher is
+ * scheduled promptly while the main thread is hung.
+ */
+static void plcrash_hang_detector_set_high_qos (pthread_attr_t *attr) {
+#if defined(__has_include) && __has_include(<pthread/qos.h>)
+    if (&pthread_attr_set_qos_class_np != NULL) {
+        if (pthread_attr_set_qos_class_np(attr, QOS_CLASS_USER_INTERACTIVE, 0) != 0)
+            PLCF_DEBUG("Failed to set hang detector QoS class");
+        return;
+    }
+#endif
+
+    struct sched_param param;
+    pthread_attr_getschedparam(attr, &param);
+    param.sched_priority = sched_get_priority_max(SCHED_OTHER);
+    if (pthread_attr_setschedparam(attr, &param) != 0)
+        PLCF_DEBUG("Failed to set hang detector thread priority");
+}
+
+
+/**
+ * A live report of the main thread, captured while the main thread was hung.
+ */
+@implementation PLCrashHangReport
+
+/**
+ * Initialize with the provided report data.
+ *
+ * @param hangNumber The hang's sequence number.
+ * @param hangStartTimestamp The time at which the main run loop last made progress, in mach_absolute_time() units.
+ * @param machTimestamp The time at which the report was captured, in mach_absolute_time() units.
+ * @param reportData The live report data.
+ */
+- (id) initWithHangNumber: (NSUInteger) hangNumber
+       hangStartTimestamp: (uint64_t) hangStartTimestamp
+            machTimestamp: (uint64_t) machTimestamp
+               reportData: (NSData *) reportData
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _hangNumber = hangNumber;
+    _hangStartTimestamp = hangStartTimestamp;
+    _machTimestamp = machTimestamp;
+    _reportData = [reportData retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_reportData release];
+    [super dealloc];
+}
+
+@synthesize hangNumber = _hangNumber;
+@synthesize hangStartTimestamp = _hangStartTimestamp;
+@synthesize machTimestamp = _machTimestamp;
+@synthesize reportData = _reportData;
+
+@end
+
+
+/**
+ * A main thread hang detector.
+ *
+ * PLCrashHangDetector observes the main run loop, recording a heartbeat timestamp on each run loop activity; this
+ * single store is the only cost imposed on the main thread while it is responsive. A dedicated high-priority watcher
+ * thread polls the heartbeat, and once the run loop has failed to make progress for longer than the configured
+ * threshold, captures a live report of the main thread via PLCrashReporter::generateLiveReportWithThread:threadFilter:error:.
+ * The report includes only the main thread, and no other threads are suspended.
+ *
+ * While a hang persists, further reports are captured at the configured capture interval, allowing the hang to be
+ * attributed to the code that was executing over its duration.
+ */
+@implementation PLCrashHangDetector
+
+/**
+ * Initialize a new hang detector.
+ *
+ * @param reporter The reporter used to capture hang reports. The reporter is retained by the detector.
+ * @param threshold The duration for which the main run loop must fail to make progress to be considered hung, in
+ * seconds.
+ * @param captureInterval The interval between repeated captures of a single hang, in seconds.
+ * @param maximumCapturesPerHang The maximum number of reports to be captured for a single hang.
+ *
+ * @return Returns the initialized detector, or nil if the detector state could not be allocated.
+ */
+- (id) initWithCrashReporter: (PLCrashReporter *) reporter
+                   threshold: (NSTimeInterval) threshold
+             captureInterval: (NSTimeInterval) captureInterval
+      maximumCapturesPerHang: (NSUInteger) maximumCapturesPerHang
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _state = calloc(1, sizeof(*_state));
+    if (_state == NULL) {
+        [self release];
+        return nil;
+    }
+
+    /* Convert the intervals to mach_absolute_time() units */
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    _state->threshold = (uint64_t) ((threshold * NSEC_PER_SEC) * timebase.denom / timebase.numer);
+    _state->capture_interval = (uint64_t) ((captureInterval * NSEC_PER_SEC) * timebase.denom / timebase.numer);
+    _state->poll_interval = MIN(_state->threshold, _state->capture_interval) / 2;
+    _state->max_captures = maximumCapturesPerHang;
+
+    _state->reporter = [reporter retain];
+    _state->reports = [[NSMutableArray alloc] init];
+    pthread_mutex_init(&_state->lock, NULL);
+
+    /* Hold our own send right to the main thread */
+    _state->main_thread = pthread_mach_thread_np(pthread_main_thread_np());
+    mach_port_mod_refs(mach_task_self(), _state->main_thread, MACH_PORT_RIGHT_SEND, 1);
+
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+
+    if (_state != NULL) {
+        mach_port_mod_refs(mach_task_self(), _state->main_thread, MACH_PORT_RIGHT_SEND, -1);
+        pthread_mutex_destroy(&_state->lock);
+        [_state->reports release];
+        [_state->reporter release];
+        free(_state);
+    }
+
+    [super dealloc];
+}
+
+/**
+ * Start observing the main run loop.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the detector could not be started. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the detector could not be started.
+ */
+- (BOOL) startAndReturnError: (NSError **) outError {
+    if (_running) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The hang detector is already running", nil);
+        return NO;
+    }
+
+    _state->heartbeat = 0;
+    _state->running = true;
+    OSMemoryBarrier();
+
+    /* Start the watcher thread */
+    pthread_attr_t attr;
+    int ret;
+    if ((ret = pthread_attr_init(&attr)) != 0) {
+        _state->running = false;
+        plcrash_populate_posix_error(outError, ret, @"Could not initialize the hang detector thread attributes");
+        return NO;
+    }
+
+    plcrash_hang_detector_set_high_qos(&attr);
+    ret = pthread_create(&_state->pthread, &attr, plcrash_hang_detector_thread, _state);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        _state->running = false;
+        plcrash_populate_posix_error(outError, ret, @"Could not create the hang detector thread");
+        return NO;
+    }
+
+    /* Observe the main run loop */
+    CFRunLoopObserverContext context = { .version = 0, .info = _state };
+    CFRunLoopActivity activities = kCFRunLoopBeforeSources | kCFRunLoopBeforeWaiting | kCFRunLoopAfterWaiting;
+    _observer = CFRunLoopObserverCreate(kCFAllocatorDefault, activities, true, 0, plcrash_hang_detector_observer, &context);
+    CFRunLoopAddObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+
+    _running = YES;
+    return YES;
+}
+
+/**
+ * Stop observing the main run loop, waiting for any in-progress capture to complete. Reports captured prior to
+ * stopping remain available via PLCrashHangDetector::drainHangReports.
+ */
+- (void) stop {
+    if (!_running)
+        return;
+
+    CFRunLoopObserverInvalidate(_observer);
+    CFRelease(_observer);
+    _observer = NULL;
+
+    _state->running = false;
+    OSMemoryBarrier();
+    pthread_join(_state->pthread, NULL);
+
+    _running = NO;
+}
+
+/**
+ * Remove and return all captured hang reports, oldest first.
+ *
+ * This method may be called while the detector is running.
+ *
+ * @return Returns an array of PLCrashHangReport instances.
+ */
+- (NSArray *) drainHangReports {
+    pthread_mutex_lock(&_state->lock);
+    NSArray *reports = [[_state->reports copy] autorelease];
+    [_state->reports removeAllObjects];
+    pthread_mutex_unlock(&_state->lock);
+
+    return reports;
+}
+
+@end
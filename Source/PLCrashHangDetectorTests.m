@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashHangDetector.h"
+#import "PLCrashReporter.h"
+#import "PLCrashReport.h"
+
+@interface PLCrashHangDetectorTests : SenTestCase {}
+@end
+
+@implementation PLCrashHangDetectorTests
+
+/**
+ * Block the main run loop for longer than the hang threshold, and verify that the hang was captured repeatedly with
+ * reports that include only the main thread.
+ */
+- (void) testDetectHang {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    PLCrashHangDetector *detector = [[[PLCrashHangDetector alloc] initWithCrashReporter: reporter
+                                                                               threshold: 0.05
+                                                                         captureInterval: 0.05
+                                                                  maximumCapturesPerHang: 3] autorelease];
+    NSError *error;
+    STAssertTrue([detector startAndReturnError: &error], @"Failed to start the detector: %@", error);
+
+    /* Spin the run loop to record a heartbeat, and then hang */
+    [[NSRunLoop currentRunLoop] runUntilDate: [NSDate dateWithTimeIntervalSinceNow: 0.05]];
+    [NSThread sleepForTimeInterval: 0.5];
+
+    [detector stop];
+
+    NSArray *reports = [detector drainHangReports];
+    STAssertTrue([reports count] >= 2, @"The hang was not captured repeatedly");
+    STAssertTrue([reports count] <= 3, @"The per-hang capture limit was exceeded");
+
+    for (PLCrashHangReport *hang in reports) {
+        STAssertEquals(hang.hangNumber, (NSUInteger) 1, @"A single hang was reported as several");
+        STAssertTrue(hang.machTimestamp > hang.hangStartTimestamp, @"Report captured before the hang started");
+
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: hang.reportData error: &error] autorelease];
+        STAssertNotNil(report, @"Could not parse hang report: %@", error);
+        STAssertEquals([report.threads count], (NSUInteger) 1, @"The report should include only the main thread");
+    }
+
+    STAssertEquals([[detector drainHangReports] count], (NSUInteger) 0, @"Reports were not drained");
+}
+
+/**
+ * Verify that an idle run loop is not reported as hung.
+ */
+- (void) testIdleRunLoop {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    PLCrashHangDetector *detector = [[[PLCrashHangDetector alloc] initWithCrashReporter: reporter
+                                                                               threshold: 0.05
+                                                                         captureInterval: 0.05
+                                                                  maximumCapturesPerHang: 3] autorelease];
+    NSError *error;
+    STAssertTrue([detector startAndReturnError: &error], @"Failed to start the detector: %@", error);
+
+    [[NSRunLoop currentRunLoop] runUntilDate: [NSDate dateWithTimeIntervalSinceNow: 0.3]];
+    [detector stop];
+
+    STAssertEquals([[detector drainHangReports] count], (NSUInteger) 0, @"An idle run loop was reported as hung");
+}
+
+@end
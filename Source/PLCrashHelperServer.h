@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+#import "PLCrashFeatureConfig.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+
+@class PLCrashMachExceptionServer;
+
+/** @internal Opaque helper server state. */
+typedef struct plcrash_helper_server_context plcrash_helper_server_context_t;
+
+@interface PLCrashHelperServer : NSObject {
+@private
+    /** The backing Mach exception server. */
+    PLCrashMachExceptionServer *_server;
+
+    /** State shared with the exception server's callback. */
+    plcrash_helper_server_context_t *_context;
+}
+
++ (BOOL) registerServerPort: (mach_port_t) serverPort forTask: (task_t) task error: (NSError **) outError;
+
+- (instancetype) initWithReportPath: (NSString *) reportPath
+              applicationIdentifier: (NSString *) applicationIdentifier
+                         appVersion: (NSString *) applicationVersion
+                              error: (NSError **) outError;
+
+- (mach_port_t) copySendRightAndReturnError: (NSError **) outError;
+
+@end
+
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
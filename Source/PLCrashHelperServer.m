@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashHelperServer.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+
+#import "PLCrashMachExceptionServer.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashHostInfo.h"
+
+#import "PLCrashAsyncMachExceptionInfo.h"
+#import "PLCrashLogWriter.h"
+
+/**
+ * @internal
+ *
+ * The size of the buffer into which each report is written. As the report is written from a healthy address space,
+ * this may be considerably larger than the in-process report limit.
+ */
+#define HELPER_MAX_REPORT_BYTES (4 * 1024 * 1024)
+
+/**
+ * @internal
+ *
+ * State shared between a PLCrashHelperServer instance and its exception server's callback.
+ */
+struct plcrash_helper_server_context {
+    /** The path at which reports will be written. */
+    NSString *reportPath;
+
+    /** The target application's identifier. */
+    NSString *applicationIdentifier;
+
+    /** The target application's version. */
+    NSString *applicationVersion;
+};
+
+/**
+ * @internal
+ *
+ * Write a crash report for @a task to @a ctx's report path. The task must be suspended.
+ *
+ * @return Returns YES on success, or NO if the report could not be written, in which case @a outError will be
+ * populated.
+ */
+static BOOL plcrash_helper_write_report (plcrash_helper_server_context_t *ctx, task_t task, thread_t thread, exception_type_t exception_type,
+                                         mach_exception_data_t code, mach_msg_type_number_t code_count, NSError **outError)
+{
+    plcrash_async_allocator_t *allocator = NULL;
+    plcrash_async_dynloader_t *loader = NULL;
+    plcrash_log_writer_t writer;
+    bool writer_initialized = false;
+    plcrash_async_file_t file;
+    void *buffer = NULL;
+    plcrash_error_t err;
+    BOOL result = NO;
+    pid_t pid;
+
+    /* Set up the signal info */
+    plcrash_log_signal_info_t signal_info;
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    plcrash_log_mach_signal_info_t mach_signal_info;
+
+    siginfo_t si;
+    if (!plcrash_async_mach_exception_get_siginfo(exception_type, code, code_count, CPU_TYPE_ANY, &si)) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not map the Mach exception to a POSIX signal", nil);
+        return NO;
+    }
+
+    bsd_signal_info.signo = si.si_signo;
+    bsd_signal_info.code = si.si_code;
+    bsd_signal_info.address = si.si_addr;
+    signal_info.bsd_info = &bsd_signal_info;
+
+    mach_signal_info.type = exception_type;
+    mach_signal_info.code = code;
+    mach_signal_info.code_count = code_count;
+    signal_info.mach_info = &mach_signal_info;
+
+    /* Set up the target's dynamic loader and our writer */
+    kern_return_t kr = pid_for_task(task, &pid);
+    if (kr != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, kr, @"Could not determine the crashed task's process ID");
+        return NO;
+    }
+
+    if ((err = plcrash_async_allocator_create(&allocator, PAGE_SIZE)) != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the report allocator", nil);
+        goto cleanup;
+    }
+
+    if ((err = plcrash_nasync_dynloader_new(&loader, allocator, task)) != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCRashReporterErrorNotFound, @"Failed to fetch the dyld image info for the crashed task", nil);
+        goto cleanup;
+    }
+
+    if ((err = plcrash_log_writer_init(&writer, ctx->applicationIdentifier, ctx->applicationVersion, nil, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false)) != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the log writer", nil);
+        goto cleanup;
+    }
+    writer_initialized = true;
+
+    if ((err = plcrash_log_writer_set_target_process(&writer, pid)) != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorNotFound, @"Failed to fetch the crashed task's process info", nil);
+        goto cleanup;
+    }
+
+    /* We're free to use as many threads as the host supports */
+    plcrash_log_writer_set_unwind_workers(&writer, MIN(writer.machine_info.logical_processor_count, PLCRASH_WRITER_MAX_UNWIND_WORKERS));
+    plcrash_log_writer_set_symbol_interning(&writer, true);
+
+    /* Write the report */
+    if ((buffer = malloc(HELPER_MAX_REPORT_BYTES)) == NULL) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the crash report buffer", nil);
+        goto cleanup;
+    }
+
+    plcrash_async_file_init_memory(&file, buffer, HELPER_MAX_REPORT_BYTES);
+    err = plcrash_log_writer_write_task(&writer, task, thread, loader, &file, &signal_info, NULL);
+    plcrash_log_writer_close(&writer);
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the crash report", nil);
+        goto cleanup;
+    }
+
+    NSData *data = [NSData dataWithBytesNoCopy: buffer length: (NSUInteger) plcrash_async_file_position(&file) freeWhenDone: NO];
+    result = [data writeToFile: ctx->reportPath options: NSDataWritingAtomic error: outError];
+
+cleanup:
+    free(buffer);
+
+    if (writer_initialized)
+        plcrash_log_writer_free(&writer);
+
+    if (loader != NULL)
+        plcrash_async_dynloader_free(loader);
+
+    if (allocator != NULL)
+        plcrash_async_allocator_free(allocator);
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Exception server callback. Suspends the crashed task and writes its report.
+ */
+static kern_return_t helper_exception_callback (task_t task, thread_t thread, exception_type_t exception_type, mach_exception_data_t code, mach_msg_type_number_t code_count, void *context) {
+    plcrash_helper_server_context_t *ctx = context;
+    kern_return_t kr;
+
+    /* The crashed thread is held until we reply; hold the remainder of the task for the duration of the report */
+    if ((kr = task_suspend(task)) != KERN_SUCCESS) {
+        NSLog(@"Failed to suspend the crashed task: %d", kr);
+        return KERN_FAILURE;
+    }
+
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSError *error;
+    if (!plcrash_helper_write_report(ctx, task, thread, exception_type, code, code_count, &error))
+        NSLog(@"Failed to write crash report: %@", error);
+    [pool release];
+
+    task_resume(task);
+
+    /* Let the exception continue on to the host's handlers, terminating the crashed process */
+    return KERN_FAILURE;
+}
+
+/**
+ * Writes crash reports on behalf of other processes.
+ *
+ * PLCrashHelperServer runs in a helper process, and receives the Mach exceptions of the processes that have
+ * registered its server port via PLCrashHelperServer::registerServerPort:forTask:error:. On receipt of an exception,
+ * the crashed task is suspended, and its report is written from the helper's healthy address space; the crashed
+ * process itself does no work at all.
+ *
+ * A send right to the server's port may be provided to the crashed process via any Mach IPC mechanism, such as
+ * an XPC connection or a launchd-registered Mach service.
+ *
+ * @warning Uncaught Objective-C exception details are not available to the helper, and are not recorded.
+ */
+@implementation PLCrashHelperServer
+
+/**
+ * Register @a serverPort as the exception port of @a task, for all exception types that indicate a crash.
+ *
+ * This is called from the process to be monitored, and performs no other configuration; in particular, no signal
+ * handlers are installed. As EXC_CRASH is delivered to the helper rather than to the crashed process, SIGABRT
+ * terminations are also reported via Mach exceptions.
+ *
+ * @param serverPort A send right to a PLCrashHelperServer's server port, as returned by
+ * PLCrashHelperServer::copySendRightAndReturnError:.
+ * @param task The task to be monitored; generally, mach_task_self().
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the port could not be registered. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the port could not be registered.
+ */
++ (BOOL) registerServerPort: (mach_port_t) serverPort forTask: (task_t) task error: (NSError **) outError {
+    /* See -[PLCrashReporter enableMachExceptionServerWithPreviousPortSet:callback:context:error:] for the rationale
+     * behind the omission of EXC_RESOURCE. */
+    exception_mask_t exc_mask = EXC_MASK_BAD_ACCESS |
+                                EXC_MASK_BAD_INSTRUCTION |
+                                EXC_MASK_ARITHMETIC |
+                                EXC_MASK_SOFTWARE |
+                                EXC_MASK_BREAKPOINT |
+                                EXC_MASK_CRASH;
+
+#ifdef EXC_MASK_GUARD
+    PLCrashHostInfo *hinfo = [PLCrashHostInfo currentHostInfo];
+    if (hinfo != nil && hinfo.darwinVersion.major >= 13)
+        exc_mask |= EXC_MASK_GUARD;
+#endif
+
+    NSError *osError;
+    PLCrashMachExceptionPort *port = [PLCrashMachExceptionServer exceptionPortForServerPort: serverPort mask: exc_mask];
+    if (![port registerForTask: task previousPortSet: NULL error: &osError]) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to set the target task's mach exception ports.", osError);
+        return NO;
+    }
+
+    return YES;
+}
+
+/**
+ * Initialize a new helper server, and start its exception server thread.
+ *
+ * @param reportPath The path at which crash reports will be written. The report may then be loaded via
+ * PLCrashReport::initWithData:error:.
+ * @param applicationIdentifier The monitored application's identifier.
+ * @param applicationVersion The monitored application's version.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the server could not be started. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the initialized server, or nil on failure.
+ */
+- (instancetype) initWithReportPath: (NSString *) reportPath
+              applicationIdentifier: (NSString *) applicationIdentifier
+                         appVersion: (NSString *) applicationVersion
+                              error: (NSError **) outError
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _context = calloc(1, sizeof(*_context));
+    if (_context == NULL) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the helper server state", nil);
+        [self release];
+        return nil;
+    }
+
+    _context->reportPath = [reportPath copy];
+    _context->applicationIdentifier = [applicationIdentifier copy];
+    _context->applicationVersion = [applicationVersion copy];
+
+    NSError *osError;
+    _server = [[PLCrashMachExceptionServer alloc] initWithCallBack: &helper_exception_callback context: _context error: &osError];
+    if (_server == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to instantiate the Mach exception server.", osError);
+        [self release];
+        return nil;
+    }
+
+    return self;
+}
+
+- (void) dealloc {
+    /* Stops the server thread; the context must outlive it */
+    [_server release];
+
+    if (_context != NULL) {
+        [_context->reportPath release];
+        [_context->applicationIdentifier release];
+        [_context->applicationVersion release];
+        free(_context);
+    }
+
+    [super dealloc];
+}
+
+/**
+ * Return a new send right to the server's port, to be provided to the process to be monitored. The caller is
+ * responsible for deallocating the send right.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object in the NSMachErrorDomain indicating why the send right could not be created. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns a send right on success, or MACH_PORT_NULL on failure.
+ */
+- (mach_port_t) copySendRightAndReturnError: (NSError **) outError {
+    return [_server copySendRightForServerAndReturningError: outError];
+}
+
+@end
+
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
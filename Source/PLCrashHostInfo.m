@@ -49,9 +49,19 @@
 /**
  * Return the current process info of the calling process. If an error occurs
  * fetching the host info, nil will be returned.
+ *
+ * The host info can not change for the lifetime of the process; it is fetched once, and the same
+ * immutable instance is returned from all subsequent calls.
  */
 + (instancetype) currentHostInfo {
-    return [[[self alloc] init] autorelease];
+    static PLCrashHostInfo *sharedInfo = nil;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        sharedInfo = [[PLCrashHostInfo alloc] init];
+    });
+
+    return [[sharedInfo retain] autorelease];
 }
 
 /*
@@ -42,6 +42,8 @@ extern "C" {
 #import "PLCrashAsyncSymbolication.h"
 #import "PLCrashAsyncAllocator.h"
 #import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashAsyncBreadcrumbs.h"
+#import "PLCrashAsyncDebugLog.h"
 
 #include <uuid/uuid.h>
 
@@ -56,18 +58,265 @@ extern "C" {
  * @{
  */
 
+/**
+ * @internal
+ *
+ * The maximum number of unwind worker threads that may be configured via plcrash_log_writer_set_unwind_workers().
+ */
+#define PLCRASH_WRITER_MAX_UNWIND_WORKERS 8
+
+/**
+ * @internal
+ *
+ * The size, in bytes, of the exception name buffer reserved by plcrash_log_writer_reserve_exception(), including the
+ * trailing NUL. Longer names are truncated.
+ */
+#define PLCRASH_WRITER_EXCEPTION_NAME_BYTES 256
+
+/**
+ * @internal
+ *
+ * The size, in bytes, of the exception reason buffer reserved by plcrash_log_writer_reserve_exception(), including the
+ * trailing NUL. Longer reasons are truncated.
+ */
+#define PLCRASH_WRITER_EXCEPTION_REASON_BYTES 4096
+
+/**
+ * @internal
+ *
+ * The maximum number of idle syscall stubs that may be resolved for a single report. See
+ * plcrash_log_writer_set_idle_thread_frames().
+ */
+#define PLCRASH_WRITER_MAX_IDLE_STUBS 8
+
+/**
+ * @internal
+ *
+ * The default initial size, in bytes, of the writer's scratch arena. See plcrash_log_writer_set_allocator_size().
+ */
+#define PLCRASH_WRITER_DEFAULT_ARENA_BYTES (64 * 1024)
+
 /**
  * @internal
  *
  * Crash log writer context.
  */
 typedef struct plcrash_log_writer {
-    /** The allocator to be used at crash time. */
+    /** The scratch arena to be used at crash time. This is reset at the end of every plcrash_log_writer_write(). */
     plcrash_async_allocator_t *allocator;
 
     /** The strategy to use for symbolication */
     plcrash_async_symbol_strategy_t symbol_strategy;
 
+    /** Shared cache info used for PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE lookups, or NULL. Borrowed reference; see
+     * plcrash_log_writer_set_shared_cache_info(). */
+    const plcrash_async_shared_cache_info_t *shared_cache_info;
+
+    /** The number of worker threads to be used to unwind thread stacks, or 0 if stacks should be unwound serially. See
+     * plcrash_log_writer_set_unwind_workers(). */
+    uint32_t unwind_worker_count;
+
+    /** If true, thread stacks are unwound, symbolicated and written by concurrent pipeline stages. See
+     * plcrash_log_writer_set_pipelined(). */
+    bool pipelined;
+
+    /** If true, the writer will not suspend, and will not be suspended by, other concurrent writers. See
+     * plcrash_log_writer_set_concurrent(). */
+    bool concurrent;
+
+    /** The number of bytes of each thread's stack to be copied prior to resuming the target's threads, or 0 if threads
+     * should remain suspended until the report has been written. See plcrash_log_writer_set_stack_snapshot_size(). */
+    size_t stack_snapshot_size;
+
+    /** If true, symbol names will be uniqued via the report's symbol string table. See
+     * plcrash_log_writer_set_symbol_interning(). */
+    bool intern_symbols;
+
+    /** The maximum number of frames to be written for a single thread. See plcrash_log_writer_set_frame_limits(). */
+    uint32_t max_thread_frames;
+
+    /** The maximum number of frames to be written across all threads, or 0 if unlimited. See
+     * plcrash_log_writer_set_frame_limits(). */
+    uint32_t max_report_frames;
+
+    /** The number of frames to be retained from the bottom of a truncated thread's stack, or 0 if a truncated stack
+     * should simply end at the thread's frame limit. See plcrash_log_writer_set_frame_limits(). */
+    uint32_t tail_frames;
+
+    /** The time budget for writing a report, in mach_absolute_time() units, or 0 if unlimited. See
+     * plcrash_log_writer_set_time_budget(). */
+    uint64_t time_budget;
+
+    /** If true, full binary image records are only written for images referenced by the report's frames and
+     * registers. See plcrash_log_writer_set_compact_images(). */
+    bool compact_images;
+
+    /** If true, frames that can not be unwound by any other frame reader are recovered by scanning the stack for a
+     * return address. See plcrash_log_writer_set_stack_scan(). */
+    bool stack_scan;
+
+    /** If true, crashed thread register values are annotated with the symbols they reference. See
+     * plcrash_log_writer_set_register_annotation(). */
+    bool annotate_registers;
+
+    /** If true, thread registers are written as a compact register_state message rather than as named RegisterValue
+     * messages. See plcrash_log_writer_set_register_state(). */
+    bool register_state;
+
+    /** If true, the stacks of non-crashed threads identical to that of a previously written thread are replaced by a
+     * reference to that thread. See plcrash_log_writer_set_collapse_stacks(). */
+    bool collapse_stacks;
+
+    /** If true, thread frames are written as packed PC and symbol arrays rather than as StackFrame messages. See
+     * plcrash_log_writer_set_packed_frames(). */
+    bool packed_frames;
+
+    /** If true, reports are written in the version 2 format. See plcrash_log_writer_set_v2_format(). */
+    bool v2_format;
+
+    /** The maximum number of frames to be written for a thread parked in a known idle syscall stub, or 0 if idle
+     * threads are written as any other thread. See plcrash_log_writer_set_idle_thread_frames(). */
+    uint32_t idle_thread_frames;
+
+    /** If true, cheaper options are selected for any report whose estimated size exceeds the output limit. See
+     * plcrash_log_writer_set_size_policy(). */
+    bool size_policy;
+
+    /** If non-NULL, only these threads (and the crashed thread) are suspended and written, and only the images
+     * referenced by the report are written. See plcrash_log_writer_set_thread_filter(). */
+    const thread_t *thread_filter;
+
+    /** The number of entries in @a thread_filter. */
+    uint32_t thread_filter_count;
+
+    /** If true, a crash loop message is written to the report. See plcrash_log_writer_set_crash_loop(). */
+    bool has_crash_loop;
+
+    /** The number of consecutive launch crashes, including the crash being reported. Only valid if
+     * @a has_crash_loop is true. */
+    uint32_t crash_loop_count;
+
+    /** The crashed thread's stack hash. Only valid if @a has_crash_loop is true. */
+    uint64_t crash_loop_hash;
+
+    /** If true, the report is reduced to the crashed thread and the images it references, as if by an empty
+     * @a thread_filter. Only valid if @a has_crash_loop is true. */
+    bool crash_loop_reduced;
+
+    /** If true, binary images are not written to the report; instead, the report references a separately written
+     * image list, provided that the process' image list generation still matches @a shared_image_generation. See
+     * plcrash_log_writer_set_shared_image_list(). */
+    bool share_image_list;
+
+    /** The session identifier of the shared image list. Only valid if @a share_image_list is true. */
+    uint8_t shared_image_session[16];
+
+    /** The generation of the shared image list. Only valid if @a share_image_list is true. */
+    uint32_t shared_image_generation;
+
+    /** If true, the report currently being written references the shared image list, and no binary images are to be
+     * written. Only valid within plcrash_log_writer_write(). */
+    bool image_list_shared;
+
+    /** If true, phase timings and counters are recorded and written to the report's writer_stats message. See
+     * plcrash_log_writer_set_instrumentation(). */
+    bool instrument;
+
+    /** If true, each thread's scheduling and CPU usage is written to the report's thread_metadata message. See
+     * plcrash_log_writer_set_thread_metadata(). */
+    bool thread_metadata;
+
+    /** The maximum number of bytes of the crashed thread's stack to be captured. See
+     * plcrash_log_writer_set_memory_capture(). */
+    size_t memory_stack_bytes;
+
+    /** The number of bytes surrounding each of the crashed thread's register values to be captured. */
+    size_t memory_register_bytes;
+
+    /** The maximum total number of bytes of memory to be captured, or 0 if memory capture is disabled. */
+    size_t memory_budget;
+
+    /** The breadcrumb ring to be copied into each report, or NULL. See plcrash_log_writer_set_breadcrumbs(). */
+    plcrash_async_breadcrumbs_t * volatile breadcrumbs;
+
+    /** Threads that crashed concurrently with the crashed thread, or NULL. See
+     * plcrash_log_writer_set_secondary_crashes(). */
+    struct plcrash_log_secondary_crashes *secondary_crashes;
+
+    /** Caller-registered memory to be written to each report, or NULL. See plcrash_log_writer_set_attachments(). */
+    struct plcrash_log_attachments *attachments;
+
+    /** The log to which debug output is buffered while a report is written, or NULL. See
+     * plcrash_log_writer_set_debug_log(). */
+    plcrash_async_debug_log_t *debug_log;
+
+    /** If true, the buffered debug output is written to the report's debug_log field. */
+    bool embed_debug_log;
+
+    /** A pre-initialized, pre-sized symbol cache to be used by the next report written. Only valid if
+     * @a has_standby_cache is true. See plcrash_log_writer_prepare_standby(). */
+    plcrash_async_symbol_cache_t standby_cache;
+
+    /** If true, @a standby_cache has been initialized and not yet consumed by plcrash_log_writer_write(). */
+    bool has_standby_cache;
+
+    /** If true, @a standby_cache is retained across reports, rather than being consumed by the next report written.
+     * See plcrash_log_writer_set_retain_standby(). */
+    bool retain_standby_cache;
+
+    /** The memory budget shared by the crash-path caches. A zero-filled budget imposes no limit. See
+     * plcrash_log_writer_set_cache_budget(). */
+    plcrash_async_cache_budget_t cache_budget;
+
+    /** The number of entries in the Objective-C class cache used by the most recently written report, or 0 if no
+     * report has been written. See plcrash_log_writer_get_memory_usage(). */
+    size_t last_objc_class_count;
+
+    /** If true, only the frame pointer reader is used to unwind the thread currently being written. Only valid within
+     * plcrash_log_writer_write(). */
+    bool frame_pointer_only;
+
+    /** Per-image PLCRASH_WRITER_IMAGE_* flags for the report currently being written, indexed by the image's position
+     * within the report's image list, or NULL if all images are to be written in full. Only valid within
+     * plcrash_log_writer_write(). */
+    uint8_t *image_flags;
+
+    /** The symbol string table for the report currently being written, or NULL. Only valid within
+     * plcrash_log_writer_write(). */
+    struct plcrash_writer_symbol_table *symbol_table;
+
+    /** The unique thread stacks written to the report currently being written, or NULL if identical stacks are not
+     * being collapsed. Only valid within plcrash_log_writer_write(). */
+    struct plcrash_writer_stack_table *stack_table;
+
+    /** The dispatch queue labels read for the report currently being written, or NULL. Only valid within
+     * plcrash_log_writer_write(). */
+    struct plcrash_writer_queue_table *queue_table;
+
+    /** The start addresses of the idle syscall stubs resolved for the report currently being written. Only valid within
+     * plcrash_log_writer_write(). */
+    pl_vm_address_t idle_stubs[PLCRASH_WRITER_MAX_IDLE_STUBS];
+
+    /** The number of entries in @a idle_stubs. */
+    uint32_t idle_stub_count;
+
+    /** The DWARF unwind cache shared by all thread cursors for the report currently being written, or NULL. Only
+     * valid within plcrash_log_writer_write(). */
+    struct plframe_dwarf_cache *dwarf_cache;
+
+    /** The compact unwind cache shared by all thread cursors for the report currently being written, or NULL. Only
+     * valid within plcrash_log_writer_write(). */
+    struct plframe_compact_unwind_cache *compact_unwind_cache;
+
+    /** The task for which the report currently being written is generated. Only valid within
+     * plcrash_log_writer_write_task(). */
+    task_t task;
+
+    /** The writing thread's port, as returned by pl_mach_thread_self() once per report; fetching the port requires a
+     * kernel trap, and it is compared against every thread in the report. Only valid within
+     * plcrash_log_writer_write_task(). */
+    thread_t self_thread;
+
     /** Report data */
     struct {
         /** If true, the report should be marked as a 'generated' user-requested report, rather than as a true crash
@@ -78,6 +327,10 @@ typedef struct plcrash_log_writer {
         uuid_t uuid_bytes;
     } report_info;
 
+    /** If true, the system_info, machine_info and process_info fields below have been populated via
+     * plcrash_log_writer_populate_host_info(), and may be read by the crash handler. */
+    volatile bool host_info_ready;
+
     /** System data */
     struct {
         /** The host OS version. */
@@ -141,6 +394,21 @@ typedef struct plcrash_log_writer {
         bool native;
     } process_info;
 
+    /** Report sections that do not change once the host information has been published, pre-encoded by
+     * plcrash_log_writer_populate_host_info(). */
+    struct {
+        /** The encoded sections, or NULL if not yet encoded. The first system_info_size bytes contain the SystemInfo
+         * message fields preceding its timestamp; the remainder contains the complete MachineInfo, AppInfo and
+         * ProcessInfo messages. */
+        uint8_t *data;
+
+        /** The number of bytes of SystemInfo fields at the start of data. */
+        size_t system_info_size;
+
+        /** The total size of data, in bytes. */
+        size_t size;
+    } static_sections;
+
     /** Uncaught exception (if any) */
     struct {
         /** Flag specifying wether an uncaught exception is available. */
@@ -152,12 +420,31 @@ typedef struct plcrash_log_writer {
         /** Exception reason (may be null) */
         char *reason;
 
-        /** The original exception call stack (may be null) */
-        void **callstack;
+        /** The original exception call stack's return addresses (may be null) */
+        uint64_t *callstack;
         
         /** Call stack frame count, or 0 if the call stack is unavailable */
         size_t callstack_count;
+
+        /** If true, the above values are stored in @a exception_reserve, and must not be freed. */
+        bool reserved;
     } uncaught_exception;
+
+    /** Storage reserved for the uncaught exception via plcrash_log_writer_reserve_exception(). All values are NULL if
+     * no storage has been reserved. */
+    struct {
+        /** Exception name buffer of PLCRASH_WRITER_EXCEPTION_NAME_BYTES bytes. */
+        char *name;
+
+        /** Exception reason buffer of PLCRASH_WRITER_EXCEPTION_REASON_BYTES bytes. */
+        char *reason;
+
+        /** Return address array of @a callstack_capacity entries. */
+        uint64_t *callstack;
+
+        /** The number of entries available in @a callstack. */
+        size_t callstack_capacity;
+    } exception_reserve;
 } plcrash_log_writer_t;
 
 /**
@@ -215,6 +502,107 @@ typedef struct plcrash_log_signal_info {
     plcrash_log_mach_signal_info_t *mach_info;
 } plcrash_log_signal_info_t;
 
+/**
+ * @internal
+ *
+ * The maximum number of secondary crashes recorded by a plcrash_log_secondary_crashes_t.
+ */
+#define PLCRASH_LOG_MAX_SECONDARY_CRASHES 16
+
+/**
+ * @internal
+ *
+ * A thread that crashed while another thread's crash report was being written.
+ */
+typedef struct plcrash_log_secondary_crash {
+    /** The crashed thread, or MACH_PORT_NULL if the entry has not yet been published. */
+    volatile thread_t thread;
+
+    /** The thread's signal information. */
+    plcrash_log_bsd_signal_info_t bsd_info;
+
+    /** The thread's state at the time of the crash. */
+    plcrash_async_thread_state_t thread_state;
+} plcrash_log_secondary_crash_t;
+
+/**
+ * @internal
+ *
+ * A fixed-size, lock-free table of secondary crashes, to which crashing threads may add themselves while a report is
+ * being written. Must be zero-initialized.
+ */
+typedef struct plcrash_log_secondary_crashes {
+    /** The number of entries claimed. May exceed PLCRASH_LOG_MAX_SECONDARY_CRASHES, in which case the excess crashes
+     * were not recorded. */
+    volatile int32_t claimed;
+
+    /** The entries. Only the first @a claimed entries are in use, of which only those with a non-NULL thread have
+     * been published. */
+    plcrash_log_secondary_crash_t entries[PLCRASH_LOG_MAX_SECONDARY_CRASHES];
+} plcrash_log_secondary_crashes_t;
+
+/**
+ * @internal
+ *
+ * The maximum number of attachments recorded by a plcrash_log_attachments_t.
+ */
+#define PLCRASH_LOG_MAX_ATTACHMENTS 8
+
+/**
+ * @internal
+ *
+ * The maximum length of an attachment name, including the terminating NUL.
+ */
+#define PLCRASH_LOG_ATTACHMENT_NAME_MAX 64
+
+/**
+ * @internal
+ *
+ * A caller-registered range of memory to be written to each report.
+ */
+typedef struct plcrash_log_attachment {
+    /** Non-zero if the entry has been published. */
+    volatile uint32_t active;
+
+    /** The NUL-terminated attachment name. */
+    char name[PLCRASH_LOG_ATTACHMENT_NAME_MAX];
+
+    /** The address of the attachment's data. */
+    pl_vm_address_t address;
+
+    /** The length of the attachment's data, in bytes. */
+    uint32_t length;
+} plcrash_log_attachment_t;
+
+/**
+ * @internal
+ *
+ * A fixed-size table of attachments. The attached memory is not copied when registered; it is read at the time a
+ * report is written, and so reflects its contents at the time of the crash.
+ *
+ * Modifications must be externally synchronized; a writer may concurrently read the table without synchronization.
+ * Must be zero-initialized.
+ */
+typedef struct plcrash_log_attachments {
+    /** The entries. Only those with a non-zero @a active flag have been published. */
+    plcrash_log_attachment_t entries[PLCRASH_LOG_MAX_ATTACHMENTS];
+} plcrash_log_attachments_t;
+
+/**
+ * @internal
+ *
+ * The maximum number of frames recorded for a single thread by plcrash_log_writer_write_trace_sample().
+ */
+#define PLCRASH_LOG_TRACE_MAX_FRAMES 128
+
+/**
+ * @internal
+ *
+ * Live trace state, retaining each thread's most recently sampled stack and the unwind caches shared across
+ * samples. See plcrash_log_trace_new().
+ */
+typedef struct plcrash_log_trace plcrash_log_trace_t;
+
 
 plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
                                          NSString *app_identifier,
@@ -222,7 +610,52 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
                                          NSString *app_marketing_version,
                                          plcrash_async_symbol_strategy_t symbol_strategy,
                                          BOOL user_requested);
+plcrash_error_t plcrash_log_writer_init_deferred (plcrash_log_writer_t *writer,
+                                                  NSString *app_identifier,
+                                                  NSString *app_version,
+                                                  NSString *app_marketing_version,
+                                                  plcrash_async_symbol_strategy_t symbol_strategy,
+                                                  BOOL user_requested);
+plcrash_error_t plcrash_log_writer_populate_host_info (plcrash_log_writer_t *writer);
+plcrash_error_t plcrash_log_writer_set_target_process (plcrash_log_writer_t *writer, pid_t pid);
+void plcrash_log_writer_reset (plcrash_log_writer_t *writer);
 void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception);
+plcrash_error_t plcrash_log_writer_reserve_exception (plcrash_log_writer_t *writer, size_t frame_capacity);
+void plcrash_log_writer_set_unwind_workers (plcrash_log_writer_t *writer, uint32_t worker_count);
+void plcrash_log_writer_set_pipelined (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_concurrent (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_stack_snapshot_size (plcrash_log_writer_t *writer, size_t size);
+void plcrash_log_writer_set_symbol_interning (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_frame_limits (plcrash_log_writer_t *writer, uint32_t thread_frames, uint32_t report_frames, uint32_t tail_frames);
+void plcrash_log_writer_set_time_budget (plcrash_log_writer_t *writer, uint64_t budget_ns);
+void plcrash_log_writer_set_compact_images (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_stack_scan (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_register_annotation (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_register_state (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_v2_format (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_collapse_stacks (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_packed_frames (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_idle_thread_frames (plcrash_log_writer_t *writer, uint32_t frames);
+void plcrash_log_writer_set_size_policy (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_thread_filter (plcrash_log_writer_t *writer, const thread_t *threads, uint32_t count);
+void plcrash_log_writer_set_crash_loop (plcrash_log_writer_t *writer, uint32_t launch_crash_count, uint64_t stack_hash, bool reduced);
+void plcrash_log_writer_set_shared_image_list (plcrash_log_writer_t *writer, const uint8_t session_id[16], uint32_t generation);
+void plcrash_log_writer_set_memory_capture (plcrash_log_writer_t *writer, size_t stack_bytes, size_t register_bytes, size_t budget);
+plcrash_error_t plcrash_log_writer_set_allocator_size (plcrash_log_writer_t *writer, size_t size);
+plcrash_error_t plcrash_log_writer_set_allocator_reserve (plcrash_log_writer_t *writer, size_t count);
+void plcrash_log_writer_get_memory_usage (plcrash_log_writer_t *writer, size_t *arena_bytes, size_t *objc_class_count);
+plcrash_error_t plcrash_log_writer_refill_allocator_reserve (plcrash_log_writer_t *writer);
+void plcrash_log_writer_set_shared_cache_info (plcrash_log_writer_t *writer, const plcrash_async_shared_cache_info_t *info);
+void plcrash_log_writer_set_instrumentation (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_thread_metadata (plcrash_log_writer_t *writer, bool enabled);
+void plcrash_log_writer_set_breadcrumbs (plcrash_log_writer_t *writer, plcrash_async_breadcrumbs_t *breadcrumbs);
+void plcrash_log_writer_set_secondary_crashes (plcrash_log_writer_t *writer, plcrash_log_secondary_crashes_t *crashes);
+void plcrash_log_writer_set_attachments (plcrash_log_writer_t *writer, plcrash_log_attachments_t *attachments);
+void plcrash_log_writer_set_debug_log (plcrash_log_writer_t *writer, plcrash_async_debug_log_t *log, bool embed);
+plcrash_error_t plcrash_log_writer_prepare_standby (plcrash_log_writer_t *writer, size_t class_capacity);
+void plcrash_log_writer_set_retain_standby (plcrash_log_writer_t *writer, bool retain);
+void plcrash_log_writer_set_cache_budget (plcrash_log_writer_t *writer, size_t limit);
+plcrash_error_t plcrash_log_writer_prefault (plcrash_log_writer_t *writer, bool wire);
 
 plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           thread_t crashed_thread,
@@ -231,6 +664,44 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           plcrash_log_signal_info_t *siginfo,
                                           plcrash_async_thread_state_t *current_state);
 
+plcrash_error_t plcrash_log_writer_write_task (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t crashed_thread,
+                                               plcrash_async_dynloader_t *dynamic_loader,
+                                               plcrash_async_file_t *file,
+                                               plcrash_log_signal_info_t *siginfo,
+                                               plcrash_async_thread_state_t *current_state);
+
+plcrash_error_t plcrash_log_writer_stack_hash (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t thread,
+                                               plcrash_async_dynloader_t *dynamic_loader,
+                                               plcrash_async_thread_state_t *current_state,
+                                               uint64_t *hash);
+
+plcrash_error_t plcrash_log_writer_write_image_list (plcrash_async_dynloader_t *dynamic_loader,
+                                                    plcrash_async_allocator_t *allocator,
+                                                    const uint8_t session_id[16],
+                                                    plcrash_async_file_t *file,
+                                                    uint32_t *generation);
+
+bool plcrash_log_secondary_crashes_add (plcrash_log_secondary_crashes_t *crashes,
+                                        thread_t thread,
+                                        const plcrash_log_bsd_signal_info_t *bsd_info,
+                                        const plcrash_async_thread_state_t *thread_state);
+
+bool plcrash_log_attachments_add (plcrash_log_attachments_t *attachments, const char *name, pl_vm_address_t address, uint32_t length);
+bool plcrash_log_attachments_remove (plcrash_log_attachments_t *attachments, const char *name);
+
+plcrash_error_t plcrash_log_trace_new (plcrash_log_trace_t **trace, uint32_t max_threads);
+void plcrash_log_trace_reset (plcrash_log_trace_t *trace);
+void plcrash_log_trace_free (plcrash_log_trace_t *trace);
+
+plcrash_error_t plcrash_log_writer_write_trace_sample (plcrash_log_writer_t *writer,
+                                                      plcrash_log_trace_t *trace,
+                                                      plcrash_async_dynloader_t *dynamic_loader,
+                                                      plcrash_async_file_t *file);
+
 plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer);
 void plcrash_log_writer_free (plcrash_log_writer_t *writer);
 
@@ -37,29 +37,206 @@
 #import <sys/time.h>
 
 #import <mach-o/dyld.h>
+#import <mach/mach_time.h>
 
 #import <libkern/OSAtomic.h>
 
 #import "PLCrashReport.h"
 #import "PLCrashLogWriter.h"
 #import "PLCrashLogWriterEncoding.h"
+#import "PLCrashCompatConstants.h"
 #import "PLCrashAsyncSignalInfo.h"
 #import "PLCrashAsyncSymbolication.h"
+#import "PLCrashAsyncRegionMap.h"
+#import "PLCrashAsyncInstrumentation.h"
+#import "PLCrashFrameStackUnwind.h"
+#import "PLCrashFrameDWARFUnwind.h"
+#import "PLCrashFrameCompactUnwind.h"
 
 #import "PLCrashSysctl.h"
 #import "PLCrashProcessInfo.h"
 
 #if TARGET_OS_IPHONE
 #import <UIKit/UIKit.h> // For UIDevice
+#else
+#import <libproc.h> // For proc_pidpath()
 #endif
 
+/**
+ * @internal
+ *
+ * The leading fields of libdispatch's dispatch_queue_offsets_s, which libdispatch exports to allow crash reporters and
+ * debuggers to read a queue's label without calling into libdispatch.
+ */
+struct plcrash_dispatch_queue_offsets {
+    /** The structure version. */
+    uint16_t dqo_version;
+
+    /** The offset of the label pointer within a queue. */
+    uint16_t dqo_label;
+
+    /** The size of the label pointer. */
+    uint16_t dqo_label_size;
+};
+
+/** @internal The offsets exported by libdispatch, or NULL if unavailable. */
+extern const struct plcrash_dispatch_queue_offsets plcrash_dispatch_queue_offsets __asm__("_dispatch_queue_offsets") __attribute__((weak_import));
+
 /**
  * @internal
  * Maximum number of frames that will be written to the crash report for a single thread. Used as a safety measure
- * to avoid overrunning our output limit when writing a crash report triggered by frame recursion.
+ * to avoid overrunning our output limit when writing a crash report triggered by frame recursion. This is also the
+ * default per-thread limit; see plcrash_log_writer_set_frame_limits().
  */
 #define MAX_THREAD_FRAMES 512 // matches Apple's crash reporting on Snow Leopard
 
+/**
+ * @internal
+ * Maximum number of frames that may be retained from the bottom of a truncated thread's stack. See
+ * plcrash_log_writer_set_frame_limits().
+ */
+#define MAX_THREAD_TAIL_FRAMES 64
+
+/**
+ * @internal
+ * Maximum number of frames that will be walked for a single thread when frames beyond the thread's frame limit are
+ * still of interest; this bounds the time spent walking the stack of a thread that has overflowed its stack through
+ * unbounded recursion.
+ */
+#define MAX_THREAD_WALK_FRAMES (64 * 1024)
+
+/**
+ * @internal
+ * Maximum number of frames in a repeated sequence of frames that will be detected and collapsed.
+ */
+#define MAX_FRAME_REPEAT_LENGTH 16
+
+/**
+ * @internal
+ * Maximum number of collapsed frame sequences that will be recorded for a single thread. Once exhausted, any further
+ * repeated sequences are written in full.
+ */
+#define MAX_THREAD_FRAME_REPEATS 16
+
+/**
+ * @internal
+ * Maximum number of bytes of symbol name data that will be memoized for a single thread when sizing a thread message.
+ * Symbols that do not fit will be looked up again when the thread message is written.
+ */
+#define MAX_MEMOIZED_SYMBOL_BYTES (32 * 1024)
+
+/**
+ * @internal
+ * Maximum number of bytes of symbol name data that will be memoized for a single thread when thread stacks are
+ * unwound in parallel. As every thread's memo must be retained until all threads have been written, this is
+ * considerably smaller than MAX_MEMOIZED_SYMBOL_BYTES.
+ */
+#define MAX_PARALLEL_MEMOIZED_SYMBOL_BYTES (4 * 1024)
+
+/**
+ * @internal
+ * Estimated encoded sizes used by the report size policy (see plcrash_log_writer_set_size_policy()). These err on the
+ * side of overestimating, so that a report estimated to fit is unlikely to be truncated.
+ */
+#define SIZE_ESTIMATE_FIXED_BYTES 4096 // exception, statistics, symbol string table overhead
+#define SIZE_ESTIMATE_THREAD_BYTES 384 // thread message, including a full register set
+#define SIZE_ESTIMATE_THREAD_FRAMES 48 // typical stack depth
+#define SIZE_ESTIMATE_FRAME_BYTES 72 // StackFrame message with an inline symbol name
+#define SIZE_ESTIMATE_INTERNED_FRAME_BYTES 24 // StackFrame message referencing the symbol string table
+#define SIZE_ESTIMATE_PACKED_FRAME_BYTES 12 // packed PC and symbol reference
+#define SIZE_ESTIMATE_IMAGE_BYTES 192 // full binary image record that has not yet been encoded
+#define SIZE_ESTIMATE_COMPACT_IMAGE_BYTES 32 // compact binary image record
+#define SIZE_ESTIMATE_REFERENCED_IMAGES 32 // images referenced by a typical report's frames and registers
+#define SIZE_ESTIMATE_IDLE_PERCENT 75 // proportion of non-crashed threads parked in an idle syscall stub
+#define SIZE_ESTIMATE_COLLAPSED_PERCENT 50 // proportion of non-crashed threads sharing a previously written stack
+
+/**
+ * @internal
+ * The maximum number of frames written for an idle thread when selected by the report size policy.
+ */
+#define SIZE_POLICY_IDLE_THREAD_FRAMES 4
+
+/**
+ * @internal
+ * Initial size of each unwind worker's allocator.
+ */
+#define UNWIND_WORKER_ALLOCATOR_SIZE (256 * 1024)
+
+/**
+ * @internal
+ * Number of unwound threads that may be queued between two pipeline stages. Once full, the producing stage blocks
+ * until the consuming stage catches up. See plcrash_log_writer_set_pipelined().
+ */
+#define PIPELINE_DEPTH 8
+
+/**
+ * @internal
+ * Maximum number of threads that may be registered as writing concurrent live reports. See
+ * plcrash_log_writer_set_concurrent().
+ */
+#define MAX_CONCURRENT_WRITER_THREADS 64
+
+/**
+ * @internal
+ * Maximum number of unique symbol names that will be recorded in a report's symbol string table. Names that do not fit
+ * will be written inline.
+ */
+#define MAX_SYMBOL_TABLE_STRINGS 2048
+
+/**
+ * @internal
+ * Maximum number of bytes of symbol name data that will be recorded in a report's symbol string table.
+ */
+#define MAX_SYMBOL_TABLE_BYTES (64 * 1024)
+
+/**
+ * @internal
+ * Maximum number of memory regions captured from the crashed thread: its stack, and the memory surrounding each of
+ * its register values.
+ */
+#define MAX_MEMORY_REGIONS 64
+
+/**
+ * @internal
+ * Maximum number of unique thread stacks recorded when collapsing identical stacks. Threads with stacks that do not
+ * fit are simply written in full.
+ */
+#define MAX_UNIQUE_THREAD_STACKS 64
+
+/**
+ * @internal
+ * Maximum number of dispatch queue labels cached per report. Threads servicing queues beyond this limit still have
+ * their labels read, but each such read is not cached.
+ */
+#define MAX_CACHED_QUEUE_LABELS 64
+
+/**
+ * @internal
+ * Maximum length of a dispatch queue label, including the terminating NUL. Longer labels are truncated.
+ */
+#define MAX_QUEUE_LABEL_LENGTH 128
+
+/**
+ * @internal
+ * Maximum distance, in bytes, of a parked thread's PC from the start of its idle syscall stub. The stubs consist of a
+ * handful of instructions; a PC beyond this distance belongs to another function.
+ */
+#define MAX_IDLE_STUB_OFFSET 32
+
+/**
+ * @internal
+ * Number of bytes beyond the crashed thread's stack pointer included in its captured stack, covering any red zone
+ * in use by the thread's leaf function.
+ */
+#define STACK_RED_ZONE_BYTES 128
+
+/**
+ * @internal
+ * Maximum size, in bytes, of a binary image record that will be encoded into the image's cached record. Records for
+ * images with longer paths are written directly on every report.
+ */
+#define MAX_CACHED_BINARY_IMAGE_RECORD (1024 + 128)
+
 /**
  * @internal
  * Protobuf Field IDs, as defined in crashreport.proto
@@ -105,6 +282,9 @@ enum {
     /** CrashReport.symbol.end_address */
     PLCRASH_PROTO_SYMBOL_END_ADDRESS = 3,
 
+    /** CrashReport.symbol.name_index */
+    PLCRASH_PROTO_SYMBOL_NAME_INDEX = 4,
+
 
     /** CrashReport.threads */
     PLCRASH_PROTO_THREADS_ID = 3,
@@ -137,6 +317,52 @@ enum {
     PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID = 2,
 
 
+    /** CrashReport.thread.frame_repeats */
+    PLCRASH_PROTO_THREAD_FRAME_REPEATS_ID = 5,
+
+    /** CrashReport.thread.frame_repeat.frame_index */
+    PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_INDEX_ID = 1,
+
+    /** CrashReport.thread.frame_repeat.frame_count */
+    PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_COUNT_ID = 2,
+
+    /** CrashReport.thread.frame_repeat.repeat_count */
+    PLCRASH_PROTO_THREAD_FRAME_REPEAT_REPEAT_COUNT_ID = 3,
+
+    /** CrashReport.thread.omitted_frame_count */
+    PLCRASH_PROTO_THREAD_OMITTED_FRAME_COUNT_ID = 6,
+
+    /** CrashReport.thread.omitted_frame_index */
+    PLCRASH_PROTO_THREAD_OMITTED_FRAME_INDEX_ID = 7,
+
+    /** CrashReport.thread.register_state */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_ID = 8,
+
+    /** CrashReport.thread.register_state.cpu_type */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_CPU_TYPE_ID = 1,
+
+    /** CrashReport.thread.register_state.values */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_VALUES_ID = 2,
+
+    /** CrashReport.thread.register_state.symbols */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_SYMBOLS_ID = 3,
+
+    /** CrashReport.thread.duplicate_of_thread */
+    PLCRASH_PROTO_THREAD_DUPLICATE_OF_THREAD_ID = 9,
+
+    /** CrashReport.thread.secondary_crash */
+    PLCRASH_PROTO_THREAD_SECONDARY_CRASH_ID = 10,
+
+    /** CrashReport.thread.dispatch_queue_label */
+    PLCRASH_PROTO_THREAD_DISPATCH_QUEUE_LABEL_ID = 11,
+
+    /** CrashReport.thread.frame_pcs */
+    PLCRASH_PROTO_THREAD_FRAME_PCS_ID = 12,
+
+    /** CrashReport.thread.frame_symbols */
+    PLCRASH_PROTO_THREAD_FRAME_SYMBOLS_ID = 13,
+
+
     /** CrashReport.images */
     PLCRASH_PROTO_BINARY_IMAGES_ID = 4,
 
@@ -155,6 +381,16 @@ enum {
     /** CrashReport.BinaryImage.code_type */
     PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID = 5,
 
+
+    /** CrashReport.compact_binary_images */
+    PLCRASH_PROTO_COMPACT_BINARY_IMAGES_ID = 11,
+
+    /** CrashReport.CompactBinaryImage.base_address */
+    PLCRASH_PROTO_COMPACT_BINARY_IMAGE_ADDR_ID = 1,
+
+    /** CrashReport.CompactBinaryImage.uuid */
+    PLCRASH_PROTO_COMPACT_BINARY_IMAGE_UUID_ID = 2,
+
     
     /** CrashReport.exception */
     PLCRASH_PROTO_EXCEPTION_ID = 5,
@@ -251,11 +487,233 @@ enum {
 
     /** CrashReport.report_info.uuid */
     PLCRASH_PROTO_REPORT_INFO_UUID_ID = 2,
+
+
+    /** CrashReport.symbol_strings */
+    PLCRASH_PROTO_SYMBOL_STRINGS_ID = 10,
+
+    /** CrashReport.symbol_strings.strings */
+    PLCRASH_PROTO_SYMBOL_STRINGS_STRINGS_ID = 1,
+
+
+    /** CrashReport.writer_stats */
+    PLCRASH_PROTO_WRITER_STATS_ID = 12,
+
+    /** CrashReport.writer_stats.image_list_ns */
+    PLCRASH_PROTO_WRITER_STATS_IMAGE_LIST_NS_ID = 1,
+
+    /** CrashReport.writer_stats.thread_suspend_ns */
+    PLCRASH_PROTO_WRITER_STATS_THREAD_SUSPEND_NS_ID = 2,
+
+    /** CrashReport.writer_stats.unwind_ns */
+    PLCRASH_PROTO_WRITER_STATS_UNWIND_NS_ID = 3,
+
+    /** CrashReport.writer_stats.symbolication_ns */
+    PLCRASH_PROTO_WRITER_STATS_SYMBOLICATION_NS_ID = 4,
+
+    /** CrashReport.writer_stats.binary_images_ns */
+    PLCRASH_PROTO_WRITER_STATS_BINARY_IMAGES_NS_ID = 5,
+
+    /** CrashReport.writer_stats.flush_ns */
+    PLCRASH_PROTO_WRITER_STATS_FLUSH_NS_ID = 6,
+
+    /** CrashReport.writer_stats.mobject_maps */
+    PLCRASH_PROTO_WRITER_STATS_MOBJECT_MAPS_ID = 7,
+
+    /** CrashReport.writer_stats.task_memcpy_calls */
+    PLCRASH_PROTO_WRITER_STATS_TASK_MEMCPY_CALLS_ID = 8,
+
+    /** CrashReport.writer_stats.allocator_grows */
+    PLCRASH_PROTO_WRITER_STATS_ALLOCATOR_GROWS_ID = 9,
+
+    /** CrashReport.writer_stats.total_ns */
+    PLCRASH_PROTO_WRITER_STATS_TOTAL_NS_ID = 10,
+
+
+    /** CrashReport.breadcrumbs */
+    PLCRASH_PROTO_BREADCRUMBS_ID = 13,
+
+
+    /** CrashReport.memory_regions */
+    PLCRASH_PROTO_MEMORY_REGIONS_ID = 14,
+
+    /** CrashReport.memory_regions.address */
+    PLCRASH_PROTO_MEMORY_REGION_ADDRESS_ID = 1,
+
+    /** CrashReport.memory_regions.data */
+    PLCRASH_PROTO_MEMORY_REGION_DATA_ID = 2,
+
+
+    /** CrashReport.shared_image_list */
+    PLCRASH_PROTO_SHARED_IMAGE_LIST_ID = 15,
+
+    /** CrashReport.shared_image_list.session_id */
+    PLCRASH_PROTO_SHARED_IMAGE_LIST_SESSION_ID_ID = 1,
+
+    /** CrashReport.shared_image_list.generation */
+    PLCRASH_PROTO_SHARED_IMAGE_LIST_GENERATION_ID = 2,
+
+
+    /** CrashReport.crash_loop */
+    PLCRASH_PROTO_CRASH_LOOP_ID = 16,
+
+    /** CrashReport.crash_loop.launch_crash_count */
+    PLCRASH_PROTO_CRASH_LOOP_LAUNCH_CRASH_COUNT_ID = 1,
+
+    /** CrashReport.crash_loop.stack_hash */
+    PLCRASH_PROTO_CRASH_LOOP_STACK_HASH_ID = 2,
+
+    /** CrashReport.crash_loop.reduced */
+    PLCRASH_PROTO_CRASH_LOOP_REDUCED_ID = 3,
+
+
+    /** CrashReport.debug_log */
+    PLCRASH_PROTO_DEBUG_LOG_ID = 17,
+
+
+    /** CrashReport.thread_metadata */
+    PLCRASH_PROTO_THREAD_METADATA_ID = 19,
+
+    /** CrashReport.thread_metadata.fields_per_record */
+    PLCRASH_PROTO_THREAD_METADATA_FIELDS_PER_RECORD_ID = 1,
+
+    /** CrashReport.thread_metadata.records */
+    PLCRASH_PROTO_THREAD_METADATA_RECORDS_ID = 2,
+
+
+    /** CrashReport.attachments */
+    PLCRASH_PROTO_ATTACHMENTS_ID = 18,
+
+    /** CrashReport.attachments.name */
+    PLCRASH_PROTO_ATTACHMENT_NAME_ID = 1,
+
+    /** CrashReport.attachments.data */
+    PLCRASH_PROTO_ATTACHMENT_DATA_ID = 2,
+
+
+    /** ImageList.session_id */
+    PLCRASH_PROTO_IMAGE_LIST_SESSION_ID_ID = 1,
+
+    /** ImageList.generation */
+    PLCRASH_PROTO_IMAGE_LIST_GENERATION_ID = 2,
+
+    /** ImageList.images */
+    PLCRASH_PROTO_IMAGE_LIST_IMAGES_ID = 3,
+
+
+    /** Trace.header */
+    PLCRASH_PROTO_TRACE_HEADER_ID = 1,
+
+    /** Trace.header.system_info */
+    PLCRASH_PROTO_TRACE_HEADER_SYSTEM_INFO_ID = 1,
+
+    /** Trace.header.machine_info */
+    PLCRASH_PROTO_TRACE_HEADER_MACHINE_INFO_ID = 2,
+
+    /** Trace.header.application_info */
+    PLCRASH_PROTO_TRACE_HEADER_APP_INFO_ID = 3,
+
+    /** Trace.header.process_info */
+    PLCRASH_PROTO_TRACE_HEADER_PROCESS_INFO_ID = 4,
+
+    /** Trace.header.timebase_numer */
+    PLCRASH_PROTO_TRACE_HEADER_TIMEBASE_NUMER_ID = 5,
+
+    /** Trace.header.timebase_denom */
+    PLCRASH_PROTO_TRACE_HEADER_TIMEBASE_DENOM_ID = 6,
+
+    /** Trace.samples */
+    PLCRASH_PROTO_TRACE_SAMPLES_ID = 2,
+
+    /** Trace.samples.timestamp */
+    PLCRASH_PROTO_TRACE_SAMPLE_TIMESTAMP_ID = 1,
+
+    /** Trace.samples.threads */
+    PLCRASH_PROTO_TRACE_SAMPLE_THREADS_ID = 2,
+
+    /** Trace.samples.ended_threads */
+    PLCRASH_PROTO_TRACE_SAMPLE_ENDED_THREADS_ID = 3,
+
+    /** Trace.samples.image_list */
+    PLCRASH_PROTO_TRACE_SAMPLE_IMAGE_LIST_ID = 4,
+
+    /** Trace.samples.untracked_thread_count */
+    PLCRASH_PROTO_TRACE_SAMPLE_UNTRACKED_THREAD_COUNT_ID = 5,
+
+    /** Trace.samples.threads.thread_id */
+    PLCRASH_PROTO_TRACE_THREAD_DELTA_THREAD_ID_ID = 1,
+
+    /** Trace.samples.threads.retained_frames */
+    PLCRASH_PROTO_TRACE_THREAD_DELTA_RETAINED_FRAMES_ID = 2,
+
+    /** Trace.samples.threads.frames */
+    PLCRASH_PROTO_TRACE_THREAD_DELTA_FRAMES_ID = 3,
+
+
+    /** CrashReportV2.report_info */
+    PLCRASH_PROTO_V2_REPORT_INFO_ID = 1,
+
+    /** CrashReportV2.system_info */
+    PLCRASH_PROTO_V2_SYSTEM_INFO_ID = 2,
+
+    /** CrashReportV2.machine_info */
+    PLCRASH_PROTO_V2_MACHINE_INFO_ID = 3,
+
+    /** CrashReportV2.application_info */
+    PLCRASH_PROTO_V2_APP_INFO_ID = 4,
+
+    /** CrashReportV2.process_info */
+    PLCRASH_PROTO_V2_PROCESS_INFO_ID = 5,
+
+    /** CrashReportV2.signal */
+    PLCRASH_PROTO_V2_SIGNAL_ID = 6,
+
+    /** CrashReportV2.exception */
+    PLCRASH_PROTO_V2_EXCEPTION_ID = 7,
+
+    /** CrashReportV2.threads */
+    PLCRASH_PROTO_V2_THREADS_ID = 8,
+
+    /** CrashReportV2.binary_images */
+    PLCRASH_PROTO_V2_BINARY_IMAGES_ID = 9,
+
+    /** CrashReportV2.strings */
+    PLCRASH_PROTO_V2_STRINGS_ID = 10,
+
+    /** CrashReportV2.threads.thread_number */
+    PLCRASH_PROTO_V2_THREAD_THREAD_NUMBER_ID = 1,
+
+    /** CrashReportV2.threads.crashed */
+    PLCRASH_PROTO_V2_THREAD_CRASHED_ID = 2,
+
+    /** CrashReportV2.threads.registers */
+    PLCRASH_PROTO_V2_THREAD_REGISTERS_ID = 3,
+
+    /** CrashReportV2.threads.frame_pcs */
+    PLCRASH_PROTO_V2_THREAD_FRAME_PCS_ID = 4,
+
+    /** CrashReportV2.threads.frame_symbols */
+    PLCRASH_PROTO_V2_THREAD_FRAME_SYMBOLS_ID = 5,
 };
 
+/**
+ * @internal
+ *
+ * Generate a new report UUID for @a writer. CFUUID is used in favor of NSUUID as to maintain compatibility
+ * with (Mac OS X 10.7|iOS 5) and earlier.
+ */
+static void plcrash_writer_generate_uuid (plcrash_log_writer_t *writer) {
+    CFUUIDRef uuid = CFUUIDCreate(NULL);
+    CFUUIDBytes bytes = CFUUIDGetUUIDBytes(uuid);
+    PLCF_ASSERT(sizeof(bytes) == sizeof(writer->report_info.uuid_bytes));
+    memcpy(writer->report_info.uuid_bytes, &bytes, sizeof(writer->report_info.uuid_bytes));
+    CFRelease(uuid);
+}
+
 /**
  * Initialize a new crash log writer instance and issue a memory barrier upon completion. This fetches all necessary
- * environment information.
+ * environment information; it is equivalent to calling plcrash_log_writer_init_deferred(), followed by
+ * plcrash_log_writer_populate_host_info().
  *
  * @param writer Writer instance to be initialized.
  * @param app_identifier Unique per-application identifier. On Mac OS X, this is likely the CFBundleIdentifier.
@@ -276,6 +734,43 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
                                          NSString *app_marketing_version,
                                          plcrash_async_symbol_strategy_t symbol_strategy,
                                          BOOL user_requested)
+{
+    plcrash_error_t err;
+
+    if ((err = plcrash_log_writer_init_deferred(writer, app_identifier, app_version, app_marketing_version, symbol_strategy, user_requested)) != PLCRASH_ESUCCESS)
+        return err;
+
+    return plcrash_log_writer_populate_host_info(writer);
+}
+
+/**
+ * Initialize a new crash log writer instance without fetching the host and process information, and issue a memory
+ * barrier upon completion. Only the writer's allocator, configuration, report UUID, and application information are
+ * initialized; the writer may be used immediately, and plcrash_log_writer_populate_host_info() may then be called
+ * from any thread to fetch the remaining information.
+ *
+ * Reports written prior to the host information being published record only the information that can be cheaply
+ * determined from within the crash handler.
+ *
+ * @param writer Writer instance to be initialized.
+ * @param app_identifier Unique per-application identifier. On Mac OS X, this is likely the CFBundleIdentifier.
+ * @param app_version Application version string.
+ * @param app_marketing_version Application marketing version string (may be nil).
+ * @param symbol_strategy The strategy to use for local symbolication.
+ * @param user_requested If true, the written report will be marked as a 'generated' non-crash report, rather than as
+ * a true crash report created upon an actual crash.
+ *
+ * @note If this function fails, plcrash_log_writer_free() should be called
+ * to free any partially allocated data.
+ *
+ * @warning This function is not guaranteed to be async-safe, and must be called prior to enabling the crash handler.
+ */
+plcrash_error_t plcrash_log_writer_init_deferred (plcrash_log_writer_t *writer,
+                                                  NSString *app_identifier,
+                                                  NSString *app_version,
+                                                  NSString *app_marketing_version,
+                                                  plcrash_async_symbol_strategy_t symbol_strategy,
+                                                  BOOL user_requested)
 {
     /* Default to 0 */
     memset(writer, 0, sizeof(*writer));
@@ -285,9 +780,14 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
      * if we need it to, and physical pages should not actually be allocated until we use the RAM.
      *
      * Debug log messages will be emitted if heap growth is necessary during runtime execution, in which case we
-     * should update this sizing.
+     * should update this sizing. Callers that have observed the arena's use by previous reports may instead size it
+     * via plcrash_log_writer_set_allocator_size().
+     *
+     * All allocations made from this allocator are scratch data that only live for the duration of
+     * plcrash_log_writer_write(); we use an arena, allowing that data to be released in a single reset rather than
+     * through individual deallocations.
      */
-    plcrash_error_t err = plcrash_async_allocator_create(&writer->allocator, 64 * 1024 /* 64KB intial sizing */);
+    plcrash_error_t err = plcrash_async_arena_create(&writer->allocator, PLCRASH_WRITER_DEFAULT_ARENA_BYTES);
     if (err != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Could not initialize our crash-time allocator: %d", err);
         return err;
@@ -296,19 +796,14 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
 
     /* Initialize configuration */
     writer->symbol_strategy = symbol_strategy;
+    writer->shared_cache_info = NULL;
+    writer->max_thread_frames = MAX_THREAD_FRAMES;
 
     /* Default to false */
     writer->report_info.user_requested = user_requested;
 
-    /* Generate a UUID for this incident; CFUUID is used in favor of NSUUID as to maintain compatibility
-     * with (Mac OS X 10.7|iOS 5) and earlier. */
-    {
-        CFUUIDRef uuid = CFUUIDCreate(NULL);
-        CFUUIDBytes bytes = CFUUIDGetUUIDBytes(uuid);
-        PLCF_ASSERT(sizeof(bytes) == sizeof(writer->report_info.uuid_bytes));
-        memcpy(writer->report_info.uuid_bytes, &bytes, sizeof(writer->report_info.uuid_bytes));
-        CFRelease(uuid);
-    }
+    /* Generate a UUID for this incident */
+    plcrash_writer_generate_uuid(writer);
 
     /* Fetch the application information */
     {
@@ -318,49 +813,129 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
             writer->application_info.app_marketing_version = strdup([app_marketing_version UTF8String]);
         }
     }
-    
-    /* Fetch the process information */
-    {
-        /* Current process */
-        PLCrashProcessInfo *pinfo = [PLCrashProcessInfo currentProcessInfo];
-        if (pinfo == nil) {
-            /* Should only occur if the process is no longer valid */
-            PLCF_DEBUG("Could not retreive process info for target");
-            return PLCRASH_EINVAL;
-        }
 
-        {
-            /* Retrieve PID */
-            writer->process_info.process_id = pinfo.processID;
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
 
-            /* Retrieve name and start time. */
-            if (pinfo.processName != nil) {
-                writer->process_info.process_name = strdup([pinfo.processName UTF8String]);
-            }
-            writer->process_info.start_time = pinfo.startTime.tv_sec;
+    return PLCRASH_ESUCCESS;
+}
 
-            /* Retrieve path */
-            char *process_path = NULL;
-            uint32_t process_path_len = 0;
+/**
+ * @internal
+ *
+ * An immutable snapshot of the host, machine and process information recorded by a writer. A single snapshot is
+ * shared by all writers in the process; see plcrash_host_info_snapshot_acquire().
+ */
+typedef struct plcrash_host_info_snapshot {
+    /** The process ID for which the snapshot was fetched. */
+    pid_t process_id;
 
-            _NSGetExecutablePath(NULL, &process_path_len);
-            if (process_path_len > 0) {
-                process_path = malloc(process_path_len);
-                _NSGetExecutablePath(process_path, &process_path_len);
-                writer->process_info.process_path = process_path;
-            }
-        }
+    /** Process name (may be NULL) */
+    char *process_name;
 
-        /* Parent process */
-        {
-            /* Retrieve PID */
-            writer->process_info.parent_process_id = pinfo.parentProcessID;
+    /** Process path (may be NULL) */
+    char *process_path;
 
-            /* Retrieve name. This will fail on iOS 9+, where EPERM is returned due to new sandbox constraints. */
+    /** Process start time */
+    time_t start_time;
+
+    /** The parent process ID for which the snapshot was fetched. */
+    pid_t parent_process_id;
+
+    /** Parent process name (may be NULL) */
+    char *parent_process_name;
+
+    /** If false, the process is being run under process emulation (such as Rosetta). */
+    bool native;
+
+    /** The host model (may be NULL). */
+    char *model;
+
+    /** The host CPU type. */
+    uint64_t cpu_type;
+
+    /** The host CPU subtype. */
+    uint64_t cpu_subtype;
+
+    /** The total number of physical cores */
+    uint32_t processor_count;
+
+    /** The total number of logical cores */
+    uint32_t logical_processor_count;
+
+    /** The host OS version (may be NULL). */
+    char *os_version;
+
+    /** The host OS build number (may be NULL). */
+    char *os_build;
+} plcrash_host_info_snapshot_t;
+
+/**
+ * @internal
+ *
+ * Free all resources associated with @a snapshot.
+ */
+static void plcrash_host_info_snapshot_free (plcrash_host_info_snapshot_t *snapshot) {
+    free(snapshot->process_name);
+    free(snapshot->process_path);
+    free(snapshot->parent_process_name);
+    free(snapshot->model);
+    free(snapshot->os_version);
+    free(snapshot->os_build);
+    free(snapshot);
+}
+
+/**
+ * @internal
+ *
+ * Fetch the host, machine and process information into @a snapshot. On failure, any partially fetched strings must
+ * be freed by the caller.
+ */
+static plcrash_error_t plcrash_host_info_snapshot_fetch (plcrash_host_info_snapshot_t *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    /* Fetch the process information */
+    {
+        /* Current process */
+        PLCrashProcessInfo *pinfo = [PLCrashProcessInfo currentProcessInfo];
+        if (pinfo == nil) {
+            /* Should only occur if the process is no longer valid */
+            PLCF_DEBUG("Could not retreive process info for target");
+            return PLCRASH_EINVAL;
+        }
+
+        {
+            /* Retrieve PID */
+            snapshot->process_id = pinfo.processID;
+
+            /* Retrieve name and start time. */
+            if (pinfo.processName != nil) {
+                snapshot->process_name = strdup([pinfo.processName UTF8String]);
+            }
+            snapshot->start_time = pinfo.startTime.tv_sec;
+
+            /* Retrieve path */
+            char *process_path = NULL;
+            uint32_t process_path_len = 0;
+
+            _NSGetExecutablePath(NULL, &process_path_len);
+            if (process_path_len > 0) {
+                process_path = malloc(process_path_len);
+                _NSGetExecutablePath(process_path, &process_path_len);
+                snapshot->process_path = process_path;
+            }
+        }
+
+        /* Parent process */
+        {
+            /* Retrieve PID */
+            snapshot->parent_process_id = pinfo.parentProcessID;
+
+            /* Retrieve name. This will fail on iOS 9+, where EPERM is returned due to new sandbox constraints. */
             PLCrashProcessInfo *parentInfo = [[[PLCrashProcessInfo alloc] initWithProcessID: pinfo.parentProcessID] autorelease];
             if (parentInfo != nil) {
                 if (parentInfo.processName != nil) {
-                    writer->process_info.parent_process_name = strdup([parentInfo.processName UTF8String]);
+                    snapshot->parent_process_name = strdup([parentInfo.processName UTF8String]);
                 }
             } else {
                 PLCF_DEBUG("Could not retreive parent process name: %s", strerror(errno));
@@ -374,12 +949,12 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
         /* Model */
 #if TARGET_OS_IPHONE
         /* On iOS, we want hw.machine (e.g. hw.machine = iPad2,1; hw.model = K93AP) */
-        writer->machine_info.model = plcrash_sysctl_string("hw.machine");
+        snapshot->model = plcrash_sysctl_string("hw.machine");
 #else
         /* On Mac OS X, we want hw.model (e.g. hw.machine = x86_64; hw.model = Macmini5,3) */
-        writer->machine_info.model = plcrash_sysctl_string("hw.model");
+        snapshot->model = plcrash_sysctl_string("hw.model");
 #endif
-        if (writer->machine_info.model == NULL) {
+        if (snapshot->model == NULL) {
             PLCF_DEBUG("Could not retrive hw.model: %s", strerror(errno));
         }
         
@@ -389,26 +964,26 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
 
             /* Fetch the CPU types */
             if (plcrash_sysctl_int("hw.cputype", &retval)) {
-                writer->machine_info.cpu_type = retval;
+                snapshot->cpu_type = retval;
             } else {
                 PLCF_DEBUG("Could not retrive hw.cputype: %s", strerror(errno));
             }
             
             if (plcrash_sysctl_int("hw.cpusubtype", &retval)) {
-                writer->machine_info.cpu_subtype = retval;
+                snapshot->cpu_subtype = retval;
             } else {
                 PLCF_DEBUG("Could not retrive hw.cpusubtype: %s", strerror(errno));
             }
 
             /* Processor count */
             if (plcrash_sysctl_int("hw.physicalcpu_max", &retval)) {
-                writer->machine_info.processor_count = retval;
+                snapshot->processor_count = retval;
             } else {
                 PLCF_DEBUG("Could not retrive hw.physicalcpu_max: %s", strerror(errno));
             }
 
             if (plcrash_sysctl_int("hw.logicalcpu_max", &retval)) {
-                writer->machine_info.logical_processor_count = retval;
+                snapshot->logical_processor_count = retval;
             } else {
                 PLCF_DEBUG("Could not retrive hw.logicalcpu_max: %s", strerror(errno));
             }
@@ -425,26 +1000,26 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
 
             if (plcrash_sysctl_int("sysctl.proc_native", &retval)) {
                 if (retval == 0) {
-                    writer->process_info.native = false;
+                    snapshot->native = false;
                 } else {
-                    writer->process_info.native = true;
+                    snapshot->native = true;
                 }
             } else {
                 /* If the sysctl is not available, the process can be assumed to be native. */
-                writer->process_info.native = true;
+                snapshot->native = true;
             }
         }
     }
 
     /* Fetch the OS information */    
-    writer->system_info.build = plcrash_sysctl_string("kern.osversion");
-    if (writer->system_info.build == NULL) {
+    snapshot->os_build = plcrash_sysctl_string("kern.osversion");
+    if (snapshot->os_build == NULL) {
         PLCF_DEBUG("Could not retrive kern.osversion: %s", strerror(errno));
     }
 
 #if TARGET_OS_IPHONE
     /* iPhone OS */
-    writer->system_info.version = strdup([[[UIDevice currentDevice] systemVersion] UTF8String]);
+    snapshot->os_version = strdup([[[UIDevice currentDevice] systemVersion] UTF8String]);
 #elif TARGET_OS_MAC
     /* Mac OS X */
     {
@@ -466,703 +1041,7218 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
         }
 
         /* Compose the string */
-        asprintf(&writer->system_info.version, "%" PRId32 ".%" PRId32 ".%" PRId32, (int32_t)major, (int32_t)minor, (int32_t)bugfix);
+        asprintf(&snapshot->os_version, "%" PRId32 ".%" PRId32 ".%" PRId32, (int32_t)major, (int32_t)minor, (int32_t)bugfix);
     }
 #else
 #error Unsupported Platform
 #endif
 
-    /* Ensure that any signal handler has a consistent view of the above initialization. */
-    OSMemoryBarrier();
-
     return PLCRASH_ESUCCESS;
 }
 
+/** @internal The shared snapshot, or NULL if not yet fetched. Guarded by shared_host_info_lock. */
+static plcrash_host_info_snapshot_t *shared_host_info = NULL;
+
+/** @internal Lock guarding shared_host_info. */
+static pthread_mutex_t shared_host_info_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
- * Set the uncaught exception for this writer. Once set, this exception will be used to
- * provide exception data for the crash log output.
+ * @internal
  *
- * @warning This function is not async safe, and must be called outside of a signal handler.
+ * Copy the shared host information snapshot into @a writer, fetching the snapshot if it has not yet been fetched.
+ *
+ * The host information only changes when the process forks, or is re-parented after its parent exits; in either case
+ * getpid() or getppid() will no longer match the snapshot, and it is replaced.
  */
-void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception) {
-    assert(writer->uncaught_exception.has_exception == false);
+static plcrash_error_t plcrash_host_info_snapshot_copy (plcrash_log_writer_t *writer) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
 
-    /* Save the exception data */
-    writer->uncaught_exception.has_exception = true;
-    writer->uncaught_exception.name = strdup([[exception name] UTF8String]);
-    writer->uncaught_exception.reason = strdup([[exception reason] UTF8String]);
+    pthread_mutex_lock(&shared_host_info_lock); {
+        plcrash_host_info_snapshot_t *snapshot = shared_host_info;
+
+        if (snapshot == NULL || snapshot->process_id != getpid() || snapshot->parent_process_id != getppid()) {
+            snapshot = malloc(sizeof(*snapshot));
+            if (snapshot == NULL) {
+                pthread_mutex_unlock(&shared_host_info_lock);
+                return PLCRASH_ENOMEM;
+            }
 
-    /* Save the call stack, if available */
-    NSArray *callStackArray = [exception callStackReturnAddresses];
-    if (callStackArray != nil && [callStackArray count] > 0) {
-        size_t count = [callStackArray count];
-        writer->uncaught_exception.callstack_count = count;
-        writer->uncaught_exception.callstack = malloc(sizeof(void *) * count);
+            if ((err = plcrash_host_info_snapshot_fetch(snapshot)) != PLCRASH_ESUCCESS) {
+                plcrash_host_info_snapshot_free(snapshot);
+                pthread_mutex_unlock(&shared_host_info_lock);
+                return err;
+            }
 
-        size_t i = 0;
-        for (NSNumber *num in callStackArray) {
-            assert(i < count);
-            writer->uncaught_exception.callstack[i] = (void *)(uintptr_t)[num unsignedLongLongValue];
-            i++;
+            if (shared_host_info != NULL)
+                plcrash_host_info_snapshot_free(shared_host_info);
+            shared_host_info = snapshot;
         }
-    }
 
-    /* Ensure that any signal handler has a consistent view of the above initialization. */
-    OSMemoryBarrier();
+        /* The writer owns (and will free) its copies of the snapshot's strings */
+        writer->process_info.process_id = snapshot->process_id;
+        writer->process_info.process_name = snapshot->process_name != NULL ? strdup(snapshot->process_name) : NULL;
+        writer->process_info.process_path = snapshot->process_path != NULL ? strdup(snapshot->process_path) : NULL;
+        writer->process_info.start_time = snapshot->start_time;
+        writer->process_info.parent_process_id = snapshot->parent_process_id;
+        writer->process_info.parent_process_name = snapshot->parent_process_name != NULL ? strdup(snapshot->parent_process_name) : NULL;
+        writer->process_info.native = snapshot->native;
+
+        writer->machine_info.model = snapshot->model != NULL ? strdup(snapshot->model) : NULL;
+        writer->machine_info.cpu_type = snapshot->cpu_type;
+        writer->machine_info.cpu_subtype = snapshot->cpu_subtype;
+        writer->machine_info.processor_count = snapshot->processor_count;
+        writer->machine_info.logical_processor_count = snapshot->logical_processor_count;
+
+        writer->system_info.version = snapshot->os_version != NULL ? strdup(snapshot->os_version) : NULL;
+        writer->system_info.build = snapshot->os_build != NULL ? strdup(snapshot->os_build) : NULL;
+    } pthread_mutex_unlock(&shared_host_info_lock);
+
+    return err;
 }
 
+static plcrash_error_t plcrash_writer_encode_static_sections (plcrash_log_writer_t *writer);
+
 /**
- * Close the plcrash_writer_t output.
+ * Fetch the host, machine and process information for a writer initialized via plcrash_log_writer_init_deferred(),
+ * and publish it to the crash handler. The information is published atomically; a report written concurrently will
+ * either include all of it, or none of it.
  *
- * @param writer Writer instance to be closed.
+ * The information is fetched once per process, and shared by all writers (including those used to generate live
+ * reports).
+ *
+ * @param writer Writer instance to be populated.
+ *
+ * @warning This function is not async-safe, and may only be called once for a given writer. It may be called from
+ * any thread, including after the writer has been registered with a crash handler.
  */
-plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer) {
+plcrash_error_t plcrash_log_writer_populate_host_info (plcrash_log_writer_t *writer) {
+    plcrash_error_t err;
+
+    if ((err = plcrash_host_info_snapshot_copy(writer)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_writer_encode_static_sections(writer)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Publish the above to any signal handler; the barrier ensures that the information is visible before the flag. */
+    OSMemoryBarrier();
+    writer->host_info_ready = true;
+
     return PLCRASH_ESUCCESS;
 }
 
 /**
- * Free any crash log writer resources.
+ * Replace the process information recorded by @a writer with that of the process identified by @a pid. This is used
+ * when writing a report for another task via plcrash_log_writer_write_task(); the host and machine information
+ * recorded by plcrash_log_writer_populate_host_info() is shared with the target.
  *
- * @warning This method is not async safe.
+ * @param writer A writer for which plcrash_log_writer_populate_host_info() has been called.
+ * @param pid The target process.
+ *
+ * @warning This function is not async-safe, and must not be called while a report is being written.
  */
-void plcrash_log_writer_free (plcrash_log_writer_t *writer) {
-    /* Free the app info */
-    if (writer->application_info.app_identifier != NULL)
-        free(writer->application_info.app_identifier);
-    if (writer->application_info.app_version != NULL)
-        free(writer->application_info.app_version);
-    if (writer->application_info.app_marketing_version != NULL)
-        free(writer->application_info.app_marketing_version);
+plcrash_error_t plcrash_log_writer_set_target_process (plcrash_log_writer_t *writer, pid_t pid) {
+    PLCrashProcessInfo *pinfo = [[[PLCrashProcessInfo alloc] initWithProcessID: pid] autorelease];
+    if (pinfo == nil) {
+        PLCF_DEBUG("Could not retreive process info for pid %d: %s", (int) pid, strerror(errno));
+        return PLCRASH_EINVAL;
+    }
 
-    /* Free the process info */
-    if (writer->process_info.process_name != NULL) 
-        free(writer->process_info.process_name);
-    if (writer->process_info.process_path != NULL) 
-        free(writer->process_info.process_path);
-    if (writer->process_info.parent_process_name != NULL) 
-        free(writer->process_info.parent_process_name);
-    
-    /* Free the system info */
-    if (writer->system_info.version != NULL)
-        free(writer->system_info.version);
-    
-    if (writer->system_info.build != NULL)
-        free(writer->system_info.build);
-    
-    /* Free the machine info */
-    if (writer->machine_info.model != NULL)
-        free(writer->machine_info.model);
+    free(writer->process_info.process_name);
+    free(writer->process_info.process_path);
+    free(writer->process_info.parent_process_name);
+
+    writer->process_info.process_id = pinfo.processID;
+    writer->process_info.process_name = pinfo.processName != nil ? strdup([pinfo.processName UTF8String]) : NULL;
+    writer->process_info.start_time = pinfo.startTime.tv_sec;
+    writer->process_info.parent_process_id = pinfo.parentProcessID;
+    writer->process_info.parent_process_name = NULL;
+    writer->process_info.process_path = NULL;
+
+#if !TARGET_OS_IPHONE
+    char path[PROC_PIDPATHINFO_MAXSIZE];
+    if (proc_pidpath(pid, path, sizeof(path)) > 0)
+        writer->process_info.process_path = strdup(path);
+#endif
 
-    /* Free the exception data */
-    if (writer->uncaught_exception.has_exception) {
-        if (writer->uncaught_exception.name != NULL)
-            free(writer->uncaught_exception.name);
+    PLCrashProcessInfo *parentInfo = [[[PLCrashProcessInfo alloc] initWithProcessID: pinfo.parentProcessID] autorelease];
+    if (parentInfo != nil && parentInfo.processName != nil)
+        writer->process_info.parent_process_name = strdup([parentInfo.processName UTF8String]);
 
-        if (writer->uncaught_exception.reason != NULL)
-            free(writer->uncaught_exception.reason);
-        
-        if (writer->uncaught_exception.callstack != NULL)
-            free(writer->uncaught_exception.callstack);
-    }
+    /* The pre-encoded process info must reflect the new target */
+    return plcrash_writer_encode_static_sections(writer);
 }
 
 /**
  * @internal
  *
- * Write the system info message.
+ * Copy as much of @a str as will fit, as UTF-8, into @a buffer of @a size bytes, NUL-terminating the result. This uses
+ * only CoreFoundation, and does not send any Objective-C messages.
  *
- * @param file Output file
- * @param timestamp Timestamp to use (seconds since epoch). Must be same across calls, as varint encoding.
+ * @return Returns @a buffer, or NULL if @a str is nil.
  */
-static size_t plcrash_writer_write_system_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer, int64_t timestamp) {
-    size_t rv = 0;
-    uint32_t enumval;
-
-    /* OS */
-    enumval = PLCrashReportHostOperatingSystem;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
-
-    /* OS Version */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.version);
-    
-    /* OS Build */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_BUILD_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.build);
-
-    /* Machine type */
-    enumval = PLCrashReportHostArchitecture;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ARCHITECTURE_TYPE_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+static char *plcrash_writer_copy_exception_string (char *buffer, size_t size, CFStringRef str) {
+    if (str == NULL)
+        return NULL;
 
-    /* Timestamp */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp);
+    CFIndex used = 0;
+    CFStringGetBytes(str, CFRangeMake(0, CFStringGetLength(str)), kCFStringEncodingUTF8, 0, false, (UInt8 *) buffer, (CFIndex) size - 1, &used);
+    buffer[used] = '\0';
 
-    return rv;
+    return buffer;
 }
 
 /**
  * @internal
  *
- * Write the processor info message.
+ * Copy up to @a capacity return addresses from @a callstack (an array of NSNumbers) into @a addresses. The values are
+ * fetched in batches via CoreFoundation, without sending a message per element.
  *
- * @param file Output file
- * @param cpu_type The Mach CPU type.
- * @param cpu_subtype The Mach CPU subtype
+ * @return Returns the number of addresses copied.
  */
-static size_t plcrash_writer_write_processor_info (plcrash_async_file_t *file, uint64_t cpu_type, uint64_t cpu_subtype) {
-    size_t rv = 0;
-    uint32_t enumval;
-    
-    /* Encoding */
-    enumval = PLCrashReportProcessorTypeEncodingMach;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_ENCODING_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+static size_t plcrash_writer_copy_exception_callstack (uint64_t *addresses, size_t capacity, CFArrayRef callstack) {
+    if (callstack == NULL)
+        return 0;
+
+    size_t count = (size_t) CFArrayGetCount(callstack);
+    if (count > capacity)
+        count = capacity;
+
+    for (size_t i = 0; i < count;) {
+        const void *batch[64];
+        size_t batch_count = count - i;
+        if (batch_count > sizeof(batch) / sizeof(batch[0]))
+            batch_count = sizeof(batch) / sizeof(batch[0]);
+
+        CFArrayGetValues(callstack, CFRangeMake((CFIndex) i, (CFIndex) batch_count), batch);
+        for (size_t j = 0; j < batch_count; j++) {
+            int64_t value = 0;
+            CFNumberGetValue((CFNumberRef) batch[j], kCFNumberSInt64Type, &value);
+            addresses[i + j] = (uint64_t) value;
+        }
 
-    /* Type */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_type);
+        i += batch_count;
+    }
 
-    /* Subtype */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_SUBTYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_subtype);
-    
-    return rv;
+    return count;
 }
 
 /**
- * @internal
+ * Set the uncaught exception for this writer. Once set, this exception will be used to
+ * provide exception data for the crash log output.
  *
- * Write the machine info message.
+ * If storage has been reserved via plcrash_log_writer_reserve_exception(), the exception's name, reason, and return
+ * addresses are copied into the reserved storage, without allocating; otherwise, they are copied into newly allocated
+ * storage.
  *
- * @param file Output file
+ * @warning This function is not async safe, and must be called outside of a signal handler.
  */
-static size_t plcrash_writer_write_machine_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
-    size_t rv = 0;
-    
-    /* Model */
-    if (writer->machine_info.model != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_MODEL_ID, PLPROTOBUF_C_TYPE_STRING, writer->machine_info.model);
-
-    /* Processor */
-    {
-        uint32_t size;
+void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception) {
+    assert(writer->uncaught_exception.has_exception == false);
 
-        /* Determine size */
-        size = plcrash_writer_write_processor_info(NULL, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+    CFStringRef name = (CFStringRef) [exception name];
+    CFStringRef reason = (CFStringRef) [exception reason];
+    CFArrayRef callstack = (CFArrayRef) [exception callStackReturnAddresses];
 
-        /* Write message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        rv += plcrash_writer_write_processor_info(file, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+    /* Save the exception data */
+    writer->uncaught_exception.has_exception = true;
+    if (writer->exception_reserve.callstack != NULL) {
+        writer->uncaught_exception.reserved = true;
+        writer->uncaught_exception.name = plcrash_writer_copy_exception_string(writer->exception_reserve.name, PLCRASH_WRITER_EXCEPTION_NAME_BYTES, name);
+        writer->uncaught_exception.reason = plcrash_writer_copy_exception_string(writer->exception_reserve.reason, PLCRASH_WRITER_EXCEPTION_REASON_BYTES, reason);
+        writer->uncaught_exception.callstack = writer->exception_reserve.callstack;
+        writer->uncaught_exception.callstack_count = plcrash_writer_copy_exception_callstack(writer->exception_reserve.callstack, writer->exception_reserve.callstack_capacity, callstack);
+    } else {
+        writer->uncaught_exception.name = strdup([[exception name] UTF8String]);
+        writer->uncaught_exception.reason = strdup([[exception reason] UTF8String]);
+
+        /* Save the call stack, if available */
+        if (callstack != NULL && CFArrayGetCount(callstack) > 0) {
+            size_t count = (size_t) CFArrayGetCount(callstack);
+            writer->uncaught_exception.callstack = malloc(sizeof(uint64_t) * count);
+            writer->uncaught_exception.callstack_count = plcrash_writer_copy_exception_callstack(writer->uncaught_exception.callstack, count, callstack);
+        }
     }
 
-    /* Physical Processor Count */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.processor_count);
-    
-    /* Logical Processor Count */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_LOGICAL_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.logical_processor_count);
-    
-    return rv;
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
 }
 
 /**
- * @internal
+ * Reserve storage for an uncaught exception's name, reason, and up to @a frame_capacity return addresses, allowing
+ * plcrash_log_writer_set_exception() to capture the exception without allocating. Frames beyond @a frame_capacity
+ * are discarded when the exception is captured.
  *
- * Write the app info message.
+ * @param writer The writer instance to configure.
+ * @param frame_capacity The maximum number of return addresses to be captured. This should generally match the writer's
+ * maximum thread frame count, beyond which exception frames are not written.
  *
- * @param file Output file
- * @param app_identifier Application identifier
- * @param app_version Application version
- * @param app_marketing_version Application marketing version
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the storage could not be allocated.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
  */
-static size_t plcrash_writer_write_app_info (plcrash_async_file_t *file, const char *app_identifier, const char *app_version, const char *app_marketing_version) {
-    size_t rv = 0;
+plcrash_error_t plcrash_log_writer_reserve_exception (plcrash_log_writer_t *writer, size_t frame_capacity) {
+    assert(writer->exception_reserve.callstack == NULL);
+
+    if (frame_capacity == 0)
+        frame_capacity = 1;
+
+    char *name = malloc(PLCRASH_WRITER_EXCEPTION_NAME_BYTES);
+    char *reason = malloc(PLCRASH_WRITER_EXCEPTION_REASON_BYTES);
+    uint64_t *callstack = calloc(frame_capacity, sizeof(uint64_t));
+    if (name == NULL || reason == NULL || callstack == NULL) {
+        free(name);
+        free(reason);
+        free(callstack);
+        return PLCRASH_ENOMEM;
+    }
 
-    /* App identifier */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_IDENTIFIER_ID, PLPROTOBUF_C_TYPE_STRING, app_identifier);
-    
-    /* App version */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_version);
-    
-    /* App marketing version */
-    if (app_marketing_version != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_MARKETING_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_marketing_version);
-    
-    return rv;
+    writer->exception_reserve.name = name;
+    writer->exception_reserve.reason = reason;
+    writer->exception_reserve.callstack_capacity = frame_capacity;
+
+    /* The callstack pointer indicates that the reservation is available; publish it last */
+    OSMemoryBarrier();
+    writer->exception_reserve.callstack = callstack;
+
+    return PLCRASH_ESUCCESS;
 }
 
 /**
- * @internal
+ * Configure the number of worker threads to be used to unwind and symbolicate thread stacks. If @a worker_count is
+ * greater than 1, plcrash_log_writer_write() will spread unwinding across a pool of @a worker_count threads, each with
+ * its own symbol cache and allocator, and will then serialize the results in thread order. This reduces the time
+ * spent with all threads suspended when writing a live report for a process with many threads.
  *
- * Write the process info message.
+ * @param writer The writer instance to configure.
+ * @param worker_count The number of worker threads to use, or 0 to unwind all stacks serially on the writing thread. Values
+ * larger than PLCRASH_WRITER_MAX_UNWIND_WORKERS will be clamped.
  *
- * @param file Output file
- * @param process_name Process name, or NULL if unavailable.
- * @param process_id Process ID
- * @param process_path Process path, or NULL if unavailable.
- * @param parent_process_name Parent process name, or NULL if unavailable.
- * @param parent_process_id Parent process ID
- * @param native If false, process is running under emulation.
- * @param start_time The start time of the process.
+ * @warning Worker threads are created via pthread_create(), which is not async-safe. This must only be enabled for live
+ * reports, and never for a writer used from a crash handler.
  */
-static size_t plcrash_writer_write_process_info (plcrash_async_file_t *file, const char *process_name,
-                                                 const pid_t process_id, const char *process_path, 
-                                                 const char *parent_process_name, const pid_t parent_process_id,
-                                                 bool native, time_t start_time)
-{
-    size_t rv = 0;
-    uint64_t tval;
+void plcrash_log_writer_set_unwind_workers (plcrash_log_writer_t *writer, uint32_t worker_count) {
+    if (worker_count > PLCRASH_WRITER_MAX_UNWIND_WORKERS)
+        worker_count = PLCRASH_WRITER_MAX_UNWIND_WORKERS;
 
-    /*
-     * In the current crash reporter serialization format, pid values are serialized as unsigned 32-bit integers. This
-     * conforms with the actual implementation of pid_t on both 32-bit and 64-bit Darwin systems. To conform with
-     * SuSV3, however, the values should be encoded as signed integers; the actual width of the type being implementation
-     * defined.
-     *
-     * To maintain compatibility with existing report readers the values remain encoded as unsigned 32-bit integers,
-     * but should be updated to int64 values in future major revision of the data format.
-     */
-    uint32_t pidval;
-
-    /* Process name */
-    if (process_name != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, process_name);
+    writer->unwind_worker_count = worker_count;
+}
 
-    /* Process ID */
-    pidval = process_id;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+/**
+ * Configure whether thread stacks are written by a pipeline of concurrent stages. If enabled,
+ * plcrash_log_writer_write() will start two worker threads: the first unwinds each thread's stack in thread order,
+ * handing each unwound stack to the second, which symbolicates the stack's frames and sizes the thread's message. The
+ * writing thread encodes each thread message as soon as it has been symbolicated, rather than waiting for all threads
+ * to be unwound, overlapping unwinding, symbolication and encoding.
+ *
+ * If enabled, this takes precedence over any worker count configured via plcrash_log_writer_set_unwind_workers().
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, thread stacks will be written by a pipeline of concurrent stages.
+ *
+ * @warning Pipeline stages are created via pthread_create(), which is not async-safe. This must only be enabled for
+ * live reports, and never for a writer used from a crash handler.
+ */
+void plcrash_log_writer_set_pipelined (plcrash_log_writer_t *writer, bool enabled) {
+    writer->pipelined = enabled;
+}
 
-    /* Process path */
-    if (process_path != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_PATH_ID, PLPROTOBUF_C_TYPE_STRING, process_path);
-    
-    /* Parent process name */
-    if (parent_process_name != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, parent_process_name);
-    
+/**
+ * Configure whether reports may be written concurrently with reports written by other writers. If enabled, the writing
+ * thread (along with any unwind workers) is registered for the duration of each report, and threads registered by
+ * other concurrently enabled writers are neither suspended nor included in the report. This prevents concurrent
+ * writers from suspending one another mid-report.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, the writer will not suspend, and will not be suspended by, other concurrent writers.
+ *
+ * @note Up to MAX_CONCURRENT_WRITER_THREADS threads may be registered at once; threads that can not be registered may
+ * be suspended by other writers, as if concurrent writing were disabled.
+ */
+void plcrash_log_writer_set_concurrent (plcrash_log_writer_t *writer, bool enabled) {
+    writer->concurrent = enabled;
+}
 
-    /* Parent process ID */
-    pidval = parent_process_id;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+/**
+ * Configure the number of bytes of each thread's stack to be copied when writing a report. If @a size is non-zero,
+ * plcrash_log_writer_write() will capture each thread's register state and copy up to @a size bytes of its stack
+ * (starting at the stack pointer), and will then resume all threads prior to unwinding their stacks and writing the
+ * report. This reduces the period during which the target's threads are suspended from the full duration of the
+ * report's generation to the time required to capture the snapshots.
+ *
+ * As the threads are no longer suspended when their stacks are walked, only frame pointer based unwinding is
+ * performed against the copied stacks; the compact unwind and DWARF readers restore saved registers from the live
+ * task, and are not used. This is disabled by default.
+ *
+ * @param writer The writer instance to configure.
+ * @param size The maximum number of bytes to copy from each thread's stack, or 0 to keep all threads suspended
+ * until the report has been written.
+ *
+ * @warning This must only be enabled for live reports, and never for a writer used from a crash handler.
+ */
+void plcrash_log_writer_set_stack_snapshot_size (plcrash_log_writer_t *writer, size_t size) {
+    writer->stack_snapshot_size = size;
+}
 
-    /* Native process. */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_NATIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &native);
-    
-    /* Start time */
-    tval = start_time;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_START_TIME_ID, PLPROTOBUF_C_TYPE_UINT64, &tval);
+/**
+ * Configure whether symbol names are uniqued within the written report. If enabled, each unique symbol name is written
+ * once to the report's symbol string table, and stack frames refer to the name by index. This considerably reduces
+ * the size of reports in which the same symbols appear across many threads.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, symbol names will be uniqued.
+ *
+ * @note Reports written with symbol interning enabled require a decoder that supports the symbol string table;
+ * earlier releases of PLCrashReport will reject these reports.
+ */
+void plcrash_log_writer_set_symbol_interning (plcrash_log_writer_t *writer, bool enabled) {
+    writer->intern_symbols = enabled;
+}
 
-    return rv;
+/**
+ * Configure the number of stack frames written to the report.
+ *
+ * By default, up to 512 frames are written for each thread, and a thread's stack is simply cut off at that limit. If
+ * @a tail_frames is non-zero, a truncated thread's stack is instead written as its first @a thread_frames - @a tail_frames
+ * frames, followed by the last @a tail_frames frames at the bottom of the stack, and the number of frames omitted between
+ * the two is recorded in the thread message. In this mode, runs of frames that repeat consecutively -- such as those
+ * produced by unbounded recursion -- are also collapsed into their first occurrence and a repeat count, and do not count
+ * against the thread's frame limit.
+ *
+ * @param writer The writer instance to configure.
+ * @param thread_frames The maximum number of frames to be written for a single thread, or 0 to use the default. Values
+ * larger than the default are clamped to the default.
+ * @param report_frames The maximum number of frames to be written across all threads, or 0 for no limit. Once exhausted,
+ * the remaining threads are written without frames.
+ * @param tail_frames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to disable
+ * tail retention and the collapsing of repeated frames. This is clamped to 64 frames, and to half of @a thread_frames.
+ *
+ * @note Readers that predate support for truncated and collapsed stacks will present the written frames as a complete
+ * backtrace.
+ */
+void plcrash_log_writer_set_frame_limits (plcrash_log_writer_t *writer, uint32_t thread_frames, uint32_t report_frames, uint32_t tail_frames) {
+    if (thread_frames == 0 || thread_frames > MAX_THREAD_FRAMES)
+        thread_frames = MAX_THREAD_FRAMES;
+
+    if (tail_frames > thread_frames / 2)
+        tail_frames = thread_frames / 2;
+
+    if (tail_frames > MAX_THREAD_TAIL_FRAMES)
+        tail_frames = MAX_THREAD_TAIL_FRAMES;
+
+    writer->max_thread_frames = thread_frames;
+    writer->max_report_frames = report_frames;
+    writer->tail_frames = tail_frames;
 }
 
 /**
- * @internal
+ * Configure a wall-clock time budget for writing a report. If @a budget_ns is non-zero, plcrash_log_writer_write()
+ * writes the crashed thread first, followed by the binary images and exception information, and then writes the
+ * remaining threads in order. As the budget is used up, the remaining threads are written using progressively
+ * cheaper strategies:
  *
- * Write a single register.
+ * - Within the first half of the budget, threads are unwound and symbolicated as usual.
+ * - Within the third quarter, symbolication is disabled.
+ * - Within the final quarter, only frame pointer unwinding is used.
+ * - Once the budget is exhausted, the remaining threads are written without frames.
  *
- * @param file Output file
- * @param regname The register to write's name.
- * @param regval The register to write's value.
+ * This is intended for environments in which the process will be terminated by a watchdog should the crash handler
+ * not complete within a fixed period. The crashed thread is always written in full.
+ *
+ * @param writer The writer instance to configure.
+ * @param budget_ns The time budget, in nanoseconds, or 0 to disable the budget.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
  */
-static size_t plcrash_writer_write_thread_register (plcrash_async_file_t *file, const char *regname, plcrash_greg_t regval) {
-    uint64_t uint64val;
-    size_t rv = 0;
+void plcrash_log_writer_set_time_budget (plcrash_log_writer_t *writer, uint64_t budget_ns) {
+    mach_timebase_info_data_t timebase;
 
-    /* Write the name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_NAME_ID, PLPROTOBUF_C_TYPE_STRING, regname);
+    /* Convert to absolute time units; if the timebase is unavailable, assume nanoseconds */
+    if (budget_ns == 0 || mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.numer == 0) {
+        writer->time_budget = budget_ns;
+        return;
+    }
 
-    /* Write the value */
-    uint64val = regval;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID, PLPROTOBUF_C_TYPE_UINT64, &uint64val);
-    
-    return rv;
+    writer->time_budget = (budget_ns / timebase.numer) * timebase.denom + ((budget_ns % timebase.numer) * timebase.denom) / timebase.numer;
+
+    /* A budget shorter than a single tick must not be mistaken for no budget at all */
+    if (writer->time_budget == 0)
+        writer->time_budget = 1;
 }
 
 /**
- * @internal
+ * Enable or disable compact binary image records. If enabled, full binary image records -- including the image's
+ * name, size, and code type -- are only written for images containing a written frame's PC or a written register
+ * value. All other images are written as compact records containing only their base address and UUID.
  *
- * Write all thread backtrace register messages
+ * @param writer The writer instance to configure.
+ * @param enabled If true, unreferenced images will be written as compact records.
  *
- * @param file Output file
- * @param task The task from which @a uap was derived. All memory accesses will be mapped from this task.
- * @param cursor The cursor from which to acquire frame registers.
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
  */
-static size_t plcrash_writer_write_thread_registers (plcrash_async_file_t *file, task_t task, plframe_cursor_t *cursor) {
-    plframe_error_t frame_err;
-    uint32_t regCount = plframe_cursor_get_regcount(cursor);
-    size_t rv = 0;
-    
-    /* Write out register messages */
-    for (int i = 0; i < regCount; i++) {
-        plcrash_greg_t regVal;
-        const char *regname;
-        uint32_t msgsize;
+void plcrash_log_writer_set_compact_images (plcrash_log_writer_t *writer, bool enabled) {
+    writer->compact_images = enabled;
+}
 
-        /* Fetch the register value */
-        if ((frame_err = plframe_cursor_get_reg(cursor, i, &regVal)) != PLFRAME_ESUCCESS) {
-            // Should never happen
-            PLCF_DEBUG("Could not fetch register %i value: %s", i, plframe_strerror(frame_err));
-            regVal = 0;
-        }
+/**
+ * Enable or disable heuristic stack scanning. If enabled, a frame that can not be unwound by the compact unwind,
+ * DWARF, or frame pointer readers -- such as a frameless leaf function, or a frame with a corrupt frame pointer -- is
+ * recovered via plframe_cursor_read_stack_scan(), rather than terminating the thread's backtrace.
+ *
+ * Stack scanning may produce spurious frames from stale return addresses left on the stack.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, unwinding failures will fall back on stack scanning.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_stack_scan (plcrash_log_writer_t *writer, bool enabled) {
+    writer->stack_scan = enabled;
+}
+
+/**
+ * Enable or disable register symbol annotation. If enabled, each register value written for a crashed thread is
+ * annotated with the symbol it references, via the register state's symbols field, sparing decoders an offline
+ * symbolication pass over the register values.
+ *
+ * Annotation is restricted to lookups that require no scanning: the containing image is found via the image list's
+ * address index, and the symbol via the image's sorted symbol index (see plcrash_nasync_macho_build_symbol_index()).
+ * Values within images for which no symbol index has been built are not annotated. Annotation also requires symbol
+ * interning (see plcrash_log_writer_set_symbol_interning()), and the symbol table symbolication strategy.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, register values will be annotated with their symbols.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_register_annotation (plcrash_log_writer_t *writer, bool enabled) {
+    writer->annotate_registers = enabled;
+}
 
-        /* Fetch the register name */
-        regname = plframe_cursor_get_regname(cursor, i);
+/**
+ * Enable or disable the compact register state encoding. If enabled, each thread's registers are written as a single
+ * register_state message holding the Mach CPU type and the register values as a packed varint sequence, rather than as
+ * a named RegisterValue message per register. This omits the register names and per-register message framing.
+ *
+ * Earlier PLCrashReporter releases only decode the named registers, and will find no registers in reports written
+ * with the compact register state. Register annotation (see plcrash_log_writer_set_register_annotation()) is only written
+ * with the compact register state.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, registers will be written as a compact register state.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_register_state (plcrash_log_writer_t *writer, bool enabled) {
+    writer->register_state = enabled;
+}
 
-        /* Get the register message size */
-        msgsize = plcrash_writer_write_thread_register(NULL, regname, regVal);
-        
-        /* Write the header and message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTERS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
-        rv += plcrash_writer_write_thread_register(file, regname, regVal);
+/**
+ * Enable or disable the version 2 report format (#PLCRASH_REPORT_FILE_VERSION_V2), described by the CrashReportV2
+ * message of crash_report.proto. Version 2 reports carry each thread's registers in a per-architecture message and
+ * its frames as packed PC and symbol arrays, with all symbol names uniqued via a single string table, and are written
+ * in a single pass.
+ *
+ * Only the report, host, process, signal and exception information, the threads and the binary images are written;
+ * all other writer options are ignored. Earlier PLCrashReporter releases can not decode version 2 reports; existing
+ * reports may be converted via PLCrashReport::v2DataWithReportData:error:.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, reports will be written in the version 2 format.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_v2_format (plcrash_log_writer_t *writer, bool enabled) {
+    writer->v2_format = enabled;
+}
+
+/**
+ * Enable or disable the collapsing of identical thread stacks. If enabled, the frames of each non-crashed thread are
+ * hashed once the thread's stack has been walked; a thread whose stack matches that of a previously written thread is
+ * written without its frames, referencing the earlier thread via the thread message's duplicate_of_thread field.
+ *
+ * Reports containing many idle threads parked in the same system calls are substantially smaller, and are written and
+ * decoded in less time. The crashed thread is always written in full.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, identical thread stacks will be collapsed.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_collapse_stacks (plcrash_log_writer_t *writer, bool enabled) {
+    writer->collapse_stacks = enabled;
+}
+
+/**
+ * Enable or disable packed frame encoding. If enabled, each thread's frames are written as a packed array of PCs and a
+ * packed array of symbol references into the report's symbol string table, via the thread message's frame_pcs and
+ * frame_symbols fields, rather than as a StackFrame message per frame. This omits the per-frame field tags and length
+ * prefixes, and allows decoders to read a thread's PCs as a single contiguous array.
+ *
+ * Packed frames require symbol interning (see plcrash_log_writer_set_symbol_interning()); a thread's frames are
+ * written as StackFrame messages if symbol interning is disabled, or if any of the thread's symbol names could not be
+ * added to the report's symbol string table.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, frames will be written in packed form where possible.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_packed_frames (plcrash_log_writer_t *writer, bool enabled) {
+    writer->packed_frames = enabled;
+}
+
+/**
+ * Configure shallow unwinding of idle threads. If enabled, the top PC of each non-crashed thread is checked against a
+ * small set of libsystem_kernel syscall stubs in which idle threads park -- such as mach_msg_trap and
+ * __workq_kernreturn -- prior to the thread being unwound. A parked thread is unwound using only the frame pointer
+ * reader, and at most @a frames frames are written.
+ *
+ * Processes with many idle threads spend the majority of the crash handler's unwinding time on stacks of little
+ * diagnostic value; this bounds that time.
+ *
+ * @param writer The writer instance to configure.
+ * @param frames The maximum number of frames to be written for an idle thread, or 0 to write idle threads in full.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_idle_thread_frames (plcrash_log_writer_t *writer, uint32_t frames) {
+    writer->idle_thread_frames = frames;
+}
+
+/**
+ * Enable or disable the report size policy. If enabled, the encoded size of each report is estimated from the number
+ * of threads, the configured frame limits and the image list once the thread list has been read. Should the estimate
+ * exceed the output file's remaining limit, cheaper options are enabled in turn until the report is estimated to fit:
+ *
+ * - Packed frames (if symbol interning is enabled).
+ * - Collapsing of identical thread stacks.
+ * - Compact records for unreferenced binary images.
+ * - Shallow unwinding of idle threads.
+ *
+ * None of these options affect the crashed thread, which is always written in full. The configured options are
+ * restored once the report has been written. Without a size policy, a report exceeding the limit is truncated.
+ *
+ * If the report is compressed, the limit applies to the compressed output, and the uncompressed estimate is
+ * conservative.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, cheaper options will be selected for reports estimated to exceed the output limit.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_size_policy (plcrash_log_writer_t *writer, bool enabled) {
+    writer->size_policy = enabled;
+}
+
+/**
+ * Restrict the report to the given threads. Only the listed threads, and the crashed thread, are suspended, walked,
+ * and written; all other threads are omitted from the report, and the binary images not referenced by the written
+ * threads, registers, or exception are omitted. This bounds the cost of a report that is only concerned with a few
+ * threads -- such as a main thread hang snapshot -- independently of the total number of threads in the process.
+ *
+ * @param writer The writer instance to configure.
+ * @param threads The threads to be written, or NULL to write all threads. The array is borrowed, and must remain
+ * valid until the filter is cleared.
+ * @param count The number of entries in @a threads.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_thread_filter (plcrash_log_writer_t *writer, const thread_t *threads, uint32_t count) {
+    writer->thread_filter = threads;
+    writer->thread_filter_count = threads != NULL ? count : 0;
+}
+
+/**
+ * Record crash loop state in the next report written. If @a reduced is true, the report is also restricted to the
+ * crashed thread, and to the images referenced by the crashed thread and exception, as if by an empty thread filter
+ * (see plcrash_log_writer_set_thread_filter()).
+ *
+ * @param writer The writer instance to configure.
+ * @param launch_crash_count The number of consecutive launches that have ended in a crash, including this crash.
+ * @param stack_hash The crashed thread's stack hash, as returned by plcrash_log_writer_stack_hash(), or 0.
+ * @param reduced If true, a reduced report is written.
+ *
+ * @warning This function is async-safe, and may be called from a crash handler prior to writing the report.
+ */
+void plcrash_log_writer_set_crash_loop (plcrash_log_writer_t *writer, uint32_t launch_crash_count, uint64_t stack_hash, bool reduced) {
+    writer->has_crash_loop = true;
+    writer->crash_loop_count = launch_crash_count;
+    writer->crash_loop_hash = stack_hash;
+    writer->crash_loop_reduced = reduced;
+}
+
+/**
+ * Configure the writer to reference a shared image list, rather than writing the binary images to each report.
+ *
+ * The image list must have been written via plcrash_log_writer_write_image_list(), which provides the @a generation
+ * of the written list. When a report is written, the process' current image list generation is compared against
+ * @a generation; if they match, the report references the shared list by its session identifier and generation, and
+ * no binary images are written. Otherwise, the images are written to the report as usual.
+ *
+ * @param writer The writer instance to configure.
+ * @param session_id The 16-byte session identifier with which the image list was written, or NULL to disable the
+ * use of a shared image list.
+ * @param generation The image list generation returned by plcrash_log_writer_write_image_list().
+ *
+ * @warning This function is not async-safe, and must not be called while the writer is in use.
+ */
+void plcrash_log_writer_set_shared_image_list (plcrash_log_writer_t *writer, const uint8_t session_id[16], uint32_t generation) {
+    if (session_id == NULL) {
+        writer->share_image_list = false;
+        return;
     }
-    
-    return rv;
+
+    memcpy(writer->shared_image_session, session_id, sizeof(writer->shared_image_session));
+    writer->shared_image_generation = generation;
+    writer->share_image_list = true;
 }
 
 /**
- * @internal
+ * Configure capture of the crashed thread's memory. If enabled, the crashed thread's stack, beginning at its stack
+ * pointer, and the memory surrounding each of its register values that references readable memory, are copied into
+ * the report. The memory is copied directly from the target task to the report output, and is compressed along with
+ * the remainder of the report if compression is enabled.
  *
- * Write a symbol
+ * The stack is captured first; the remaining budget is then allocated to register windows in register order.
  *
- * @param file Output file
- * @param name The symbol name
- * @param start_address The symbol start address
+ * @param writer The writer instance to configure.
+ * @param stack_bytes The maximum number of bytes of the crashed thread's stack to capture.
+ * @param register_bytes The number of bytes surrounding each register value to capture.
+ * @param budget The maximum total number of bytes of memory to capture, or 0 to disable memory capture.
+ *
+ * @warning This function is not async-safe, and must be called prior to the writer being used from a crash handler.
  */
-static size_t plcrash_writer_write_symbol (plcrash_async_file_t *file, const char *name, uint64_t start_address) {
-    size_t rv = 0;
-    
-    /* name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_NAME, PLPROTOBUF_C_TYPE_STRING, name);
-    
-    /* start_address */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_START_ADDRESS, PLPROTOBUF_C_TYPE_UINT64, &start_address);
-    
-    return rv;
+void plcrash_log_writer_set_memory_capture (plcrash_log_writer_t *writer, size_t stack_bytes, size_t register_bytes, size_t budget) {
+    writer->memory_stack_bytes = stack_bytes;
+    writer->memory_register_bytes = register_bytes;
+    writer->memory_budget = budget;
 }
 
 /**
- * @internal
- * Symbol lookup callback context
+ * Pre-allocate @a count spare page regions for the writer's crash-time allocator. If the allocator's initial pool is
+ * exhausted while writing a report, these regions will be consumed in preference to calling vm_allocate() from
+ * the crash handler.
+ *
+ * @param writer The writer instance to configure.
+ * @param count The number of reserve regions to maintain. Values larger than AsyncAllocator::max_reserve will be clamped.
+ *
+ * @warning This method is not async-safe, and must be called prior to the crash.
  */
-struct pl_symbol_cb_ctx {
-    /** File to use for writing out a symbol entry. May be NULL. */
-    plcrash_async_file_t *file;
+plcrash_error_t plcrash_log_writer_set_allocator_reserve (plcrash_log_writer_t *writer, size_t count) {
+    return plcrash_async_allocator_reserve(writer->allocator, count);
+}
+
+/**
+ * Replace the writer's scratch arena with an arena of @a size bytes, such as one sized from the high-water mark
+ * reported by plcrash_log_writer_get_memory_usage() for previous reports. On failure, the existing arena is retained.
+ *
+ * @param writer The writer instance to configure.
+ * @param size The initial size of the arena, in bytes.
+ *
+ * @warning This method is not async-safe, and must be called immediately after the writer is initialized, prior to
+ * any other configuration that may allocate from the writer's arena.
+ */
+plcrash_error_t plcrash_log_writer_set_allocator_size (plcrash_log_writer_t *writer, size_t size) {
+    plcrash_async_allocator_t *allocator;
+    plcrash_error_t err;
+
+    if ((err = plcrash_async_arena_create(&allocator, size)) != PLCRASH_ESUCCESS)
+        return err;
+
+    plcrash_async_allocator_free(writer->allocator);
+    writer->allocator = allocator;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Fetch the crash-time memory used by the writer's reports: the largest number of bytes allocated from the writer's
+ * scratch arena by any report, and the number of Objective-C classes cached by the most recently written report.
+ * These may be persisted and used to size the arena and standby class cache of future writers; see
+ * plcrash_log_writer_set_allocator_size() and plcrash_log_writer_prepare_standby().
+ *
+ * @param writer The writer instance.
+ * @param arena_bytes On return, the arena's high-water mark, in bytes.
+ * @param objc_class_count On return, the number of Objective-C class cache entries.
+ *
+ * @warning This method is async-safe, but must not be called concurrently with plcrash_log_writer_write().
+ */
+void plcrash_log_writer_get_memory_usage (plcrash_log_writer_t *writer, size_t *arena_bytes, size_t *objc_class_count) {
+    *arena_bytes = plcrash_async_allocator_high_water(writer->allocator);
+    *objc_class_count = writer->last_objc_class_count;
+}
+
+/**
+ * Restore the reserve configured via plcrash_log_writer_set_allocator_reserve() after any regions have been consumed
+ * by a previously written report.
+ *
+ * @param writer The writer instance to refill.
+ *
+ * @warning This method is not async-safe, and must not be called from a crash handler.
+ */
+plcrash_error_t plcrash_log_writer_refill_allocator_reserve (plcrash_log_writer_t *writer) {
+    return plcrash_async_allocator_refill_reserve(writer->allocator);
+}
+
+/**
+ * Set the shared cache info to be used to symbolicate frames within dyld shared cache images when the
+ * PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE strategy is enabled. The cache's local symbols are mapped only if
+ * required, and are unmapped once each report has been written.
+ *
+ * @param writer The writer instance to configure.
+ * @param info The shared cache info, or NULL to disable shared cache lookups. This must remain valid for the lifetime
+ * of @a writer.
+ *
+ * @warning This method is not async-safe, and must be called prior to the crash.
+ */
+void plcrash_log_writer_set_shared_cache_info (plcrash_log_writer_t *writer, const plcrash_async_shared_cache_info_t *info) {
+    writer->shared_cache_info = info;
+}
+
+/**
+ * Enable or disable recording of the time spent in each phase of writing a report, along with counts of memory object
+ * mappings, task memory reads, and allocator growth. If enabled, the results are written to the report's writer_stats
+ * message.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, each report will be instrumented.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ * Only one instrumented report may be written at a time.
+ */
+void plcrash_log_writer_set_instrumentation (plcrash_log_writer_t *writer, bool enabled) {
+    writer->instrument = enabled;
+}
+
+/**
+ * Set the breadcrumb ring to be copied into each report. The ring's raw contents are written to the report's
+ * breadcrumbs field, and are decoded when the report is read.
+ *
+ * @param writer The writer instance to configure.
+ * @param breadcrumbs The breadcrumb ring, or NULL to disable breadcrumbs. This must remain valid for the lifetime
+ * of @a writer.
+ *
+ * @warning This method is not async-safe. It may be called after the writer has been registered with a crash
+ * handler; the ring is published to the handler only once fully initialized.
+ */
+void plcrash_log_writer_set_breadcrumbs (plcrash_log_writer_t *writer, plcrash_async_breadcrumbs_t *breadcrumbs) {
+    OSMemoryBarrier();
+    writer->breadcrumbs = breadcrumbs;
+}
+
+/**
+ * Set the table of secondary crashes consulted when writing each report. A thread found in the table is written with
+ * its recorded signal information, and its stack is walked from the state at which it crashed.
+ *
+ * @param writer The writer instance to configure.
+ * @param crashes The secondary crash table, or NULL. This must remain valid for the lifetime of @a writer.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_secondary_crashes (plcrash_log_writer_t *writer, plcrash_log_secondary_crashes_t *crashes) {
+    writer->secondary_crashes = crashes;
+}
+
+/**
+ * Record a crash of @a thread in @a crashes. The entry is claimed with a single atomic increment, and published once
+ * fully populated; a writer concurrently reading @a crashes will either observe the complete entry, or none at all.
+ *
+ * @param crashes The table to which the crash will be added.
+ * @param thread The crashed thread.
+ * @param bsd_info The thread's signal information.
+ * @param thread_state The thread's state at the time of the crash.
+ *
+ * @return Returns false if the table is full, in which case the crash was not recorded.
+ *
+ * @warning This method is async-safe, and may be called concurrently from multiple threads.
+ */
+bool plcrash_log_secondary_crashes_add (plcrash_log_secondary_crashes_t *crashes,
+                                        thread_t thread,
+                                        const plcrash_log_bsd_signal_info_t *bsd_info,
+                                        const plcrash_async_thread_state_t *thread_state)
+{
+    int32_t idx = OSAtomicIncrement32Barrier(&crashes->claimed) - 1;
+    if (idx >= PLCRASH_LOG_MAX_SECONDARY_CRASHES)
+        return false;
+
+    plcrash_log_secondary_crash_t *entry = &crashes->entries[idx];
+    entry->bsd_info = *bsd_info;
+    plcrash_async_thread_state_copy(&entry->thread_state, thread_state);
+
+    /* Publish the entry */
+    OSMemoryBarrier();
+    entry->thread = thread;
+
+    return true;
+}
+
+/**
+ * Enable or disable recording of each thread's scheduling state and CPU usage. If enabled, the threads' metadata is
+ * gathered with a single thread_info() call per thread, immediately after the threads are suspended, and is written to
+ * the report's thread_metadata message.
+ *
+ * @param writer The writer instance to configure.
+ * @param enabled If true, thread metadata will be written to each report.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_thread_metadata (plcrash_log_writer_t *writer, bool enabled) {
+    writer->thread_metadata = enabled;
+}
+
+/**
+ * Configure the table of attachments to be written to each report.
+ *
+ * @param writer The writer instance to configure.
+ * @param attachments The attachments table, or NULL to disable attachments. This must remain valid for the lifetime
+ * of @a writer.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_attachments (plcrash_log_writer_t *writer, plcrash_log_attachments_t *attachments) {
+    writer->attachments = attachments;
+}
+
+/**
+ * Register @a length bytes at @a address as an attachment named @a name, replacing any existing attachment of the same
+ * name. The memory is not copied; it must remain readable until the attachment is removed, and its contents at the
+ * time of a crash will be written to the report.
+ *
+ * The entry is unpublished while it is modified; a writer concurrently reading @a attachments will either observe the
+ * complete entry, or none at all.
+ *
+ * @param attachments The table to which the attachment will be added.
+ * @param name The attachment name. Must be shorter than PLCRASH_LOG_ATTACHMENT_NAME_MAX.
+ * @param address The address of the attachment's data.
+ * @param length The length of the attachment's data, in bytes.
+ *
+ * @return Returns false if @a name is too long, or if the table is full.
+ *
+ * @warning This method is not async-safe, and must be externally synchronized with other modifications of
+ * @a attachments.
+ */
+bool plcrash_log_attachments_add (plcrash_log_attachments_t *attachments, const char *name, pl_vm_address_t address, uint32_t length) {
+    plcrash_log_attachment_t *entry = NULL;
+
+    if (strlen(name) >= PLCRASH_LOG_ATTACHMENT_NAME_MAX)
+        return false;
+
+    /* Prefer an existing entry of the same name, falling back on the first free entry */
+    for (size_t i = 0; i < PLCRASH_LOG_MAX_ATTACHMENTS; i++) {
+        plcrash_log_attachment_t *candidate = &attachments->entries[i];
+        if (candidate->active && strcmp(candidate->name, name) == 0) {
+            entry = candidate;
+            break;
+        }
+
+        if (!candidate->active && entry == NULL)
+            entry = candidate;
+    }
+
+    if (entry == NULL)
+        return false;
+
+    /* Unpublish the entry while it is populated */
+    entry->active = 0;
+    OSMemoryBarrier();
+
+    strlcpy(entry->name, name, sizeof(entry->name));
+    entry->address = address;
+    entry->length = length;
+
+    /* Publish the entry */
+    OSMemoryBarrier();
+    entry->active = 1;
+
+    return true;
+}
+
+/**
+ * Remove the attachment named @a name. Once this function returns, a report written by a writer concurrently reading
+ * @a attachments may still include the attachment; its memory must not be deallocated until any such report has been
+ * written.
+ *
+ * @param attachments The table from which the attachment will be removed.
+ * @param name The attachment name.
+ *
+ * @return Returns false if no attachment named @a name was found.
+ *
+ * @warning This method is not async-safe, and must be externally synchronized with other modifications of
+ * @a attachments.
+ */
+bool plcrash_log_attachments_remove (plcrash_log_attachments_t *attachments, const char *name) {
+    for (size_t i = 0; i < PLCRASH_LOG_MAX_ATTACHMENTS; i++) {
+        plcrash_log_attachment_t *entry = &attachments->entries[i];
+        if (entry->active && strcmp(entry->name, name) == 0) {
+            entry->active = 0;
+            OSMemoryBarrier();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Buffer debug output to @a log while writing a report, rather than writing each message to stderr as it is
+ * emitted. The buffered output is written to stderr once the report has been written and, if @a embed is true,
+ * to the report's debug_log field.
+ *
+ * Debug output is only emitted by non-release builds; in release builds, the log will remain empty.
+ *
+ * @param writer The writer instance to configure.
+ * @param log The log to which debug output should be buffered, or NULL to write debug output directly to stderr.
+ * This must remain valid for the lifetime of @a writer.
+ * @param embed If true, the buffered output is also written to each report.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ * Only one writer may buffer to a log at a time.
+ */
+void plcrash_log_writer_set_debug_log (plcrash_log_writer_t *writer, plcrash_async_debug_log_t *log, bool embed) {
+    writer->debug_log = log;
+    writer->embed_debug_log = embed;
+}
+
+/**
+ * Place the writer in a "hot standby" state, initializing and pre-sizing the symbol cache to be used by the next call
+ * to plcrash_log_writer_write(). This moves the cache's setup (including the allocation of its Objective-C class
+ * table) out of the crash handler; once consumed by a report, the cache is released and the writer reverts to
+ * initializing a cache at crash time.
+ *
+ * @param writer The writer instance to configure.
+ * @param class_capacity The number of Objective-C classes for which room should be reserved in the cache.
+ *
+ * @warning This method is not async-safe, and must be called prior to the crash. Any shared cache info must be
+ * configured via plcrash_log_writer_set_shared_cache_info() prior to calling this method.
+ */
+plcrash_error_t plcrash_log_writer_prepare_standby (plcrash_log_writer_t *writer, size_t class_capacity) {
+    plcrash_error_t err;
+
+    if (writer->has_standby_cache) {
+        plcrash_async_symbol_cache_free(&writer->standby_cache);
+        writer->has_standby_cache = false;
+    }
+
+    if ((err = plcrash_async_symbol_cache_init(&writer->standby_cache)) != PLCRASH_ESUCCESS)
+        return err;
+
+    plcrash_async_symbol_cache_set_shared_cache(&writer->standby_cache, writer->shared_cache_info);
+    if ((err = plcrash_async_symbol_cache_set_budget(&writer->standby_cache, &writer->cache_budget)) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not register the standby cache with the cache budget, proceeding without it: %d", err);
+    plcrash_nasync_symbol_cache_reserve(&writer->standby_cache, class_capacity);
+
+    /* The writer may already be registered with a crash handler; ensure the cache is visible before the flag. */
+    OSMemoryBarrier();
+    writer->has_standby_cache = true;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Fault in, and optionally wire, the memory the writer will touch at crash time: the writer's scratch arena and,
+ * if prepared via plcrash_log_writer_prepare_standby(), the standby cache's Objective-C class table. This avoids
+ * first-touch page faults -- which are slow, and may fail outright under memory pressure -- from within the crash
+ * handler.
+ *
+ * @param writer The writer instance to prefault.
+ * @param wire If true, the pages will also be wired via mlock().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success. If wiring fails, all regions are still prefaulted, and the first
+ * error is returned.
+ *
+ * @warning This method is not async-safe, and must be called prior to the crash. It should be called after
+ * plcrash_log_writer_prepare_standby(), as the standby cache is otherwise not prefaulted.
+ */
+plcrash_error_t plcrash_log_writer_prefault (plcrash_log_writer_t *writer, bool wire) {
+    plcrash_error_t result = plcrash_nasync_allocator_prefault(writer->allocator, wire);
+    plcrash_error_t err;
+
+    if (writer->has_standby_cache) {
+        err = plcrash_nasync_objc_cache_prefault(&writer->standby_cache.objc_cache, wire);
+        if (err != PLCRASH_ESUCCESS && result == PLCRASH_ESUCCESS)
+            result = err;
+    }
+
+    return result;
+}
+
+/**
+ * Retain the writer's standby symbol cache across reports. By default, the cache prepared via
+ * plcrash_log_writer_prepare_standby() is consumed by the next report written; if @a retain is true, the cache is
+ * instead returned to standby once the report has been written, allowing writers that are reused for multiple live
+ * reports to avoid re-initializing their Objective-C class cache.
+ *
+ * The cache retains references to images and classes from previous reports; it must be re-prepared via
+ * plcrash_log_writer_prepare_standby() if any image has since been unloaded.
+ *
+ * @param writer The writer instance to configure.
+ * @param retain If true, the standby cache will be retained across reports.
+ *
+ * @warning This method is not async-safe, and must be called prior to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_retain_standby (plcrash_log_writer_t *writer, bool retain) {
+    writer->retain_standby_cache = retain;
+}
+
+/**
+ * Bound the total memory retained by the caches used while writing a report -- the symbol caches' Objective-C class
+ * tables and symbol table mappings, and the DWARF and compact unwind caches -- to @a limit bytes. Once the limit is
+ * reached, the least recently used evictable cache is asked to release its memory, and caches that cannot be charged
+ * proceed without caching, as they would on an allocation failure.
+ *
+ * @param writer The writer instance to configure.
+ * @param limit The maximum number of bytes to be retained across all caches, or 0 if unlimited.
+ *
+ * @warning This method is not async-safe, and must be called prior to plcrash_log_writer_prepare_standby() and prior
+ * to the writer being used from a crash handler.
+ */
+void plcrash_log_writer_set_cache_budget (plcrash_log_writer_t *writer, size_t limit) {
+    PLCF_ASSERT(!writer->has_standby_cache);
+    plcrash_async_cache_budget_init(&writer->cache_budget, limit);
+}
+
+/**
+ * Prepare a previously used writer to write a new report, generating a new report UUID and discarding any
+ * exception set via plcrash_log_writer_set_exception(). All other configuration is preserved.
+ *
+ * @param writer The writer instance to reset.
+ *
+ * @warning This method is not async-safe, and must not be called while the writer is registered with a crash handler.
+ */
+void plcrash_log_writer_reset (plcrash_log_writer_t *writer) {
+    plcrash_writer_generate_uuid(writer);
+    plcrash_writer_free_exception(writer);
+}
+
+/**
+ * Close the plcrash_writer_t output.
+ *
+ * @param writer Writer instance to be closed.
+ */
+plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer) {
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Free any exception data set via plcrash_log_writer_set_exception().
+ */
+static void plcrash_writer_free_exception (plcrash_log_writer_t *writer) {
+    if (writer->uncaught_exception.has_exception && !writer->uncaught_exception.reserved) {
+        if (writer->uncaught_exception.name != NULL)
+            free(writer->uncaught_exception.name);
+
+        if (writer->uncaught_exception.reason != NULL)
+            free(writer->uncaught_exception.reason);
+        
+        if (writer->uncaught_exception.callstack != NULL)
+            free(writer->uncaught_exception.callstack);
+    }
+
+    memset(&writer->uncaught_exception, 0, sizeof(writer->uncaught_exception));
+}
+
+/**
+ * Free any crash log writer resources.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_log_writer_free (plcrash_log_writer_t *writer) {
+    /* Free the app info */
+    if (writer->application_info.app_identifier != NULL)
+        free(writer->application_info.app_identifier);
+    if (writer->application_info.app_version != NULL)
+        free(writer->application_info.app_version);
+    if (writer->application_info.app_marketing_version != NULL)
+        free(writer->application_info.app_marketing_version);
+
+    /* Free the process info */
+    if (writer->process_info.process_name != NULL) 
+        free(writer->process_info.process_name);
+    if (writer->process_info.process_path != NULL) 
+        free(writer->process_info.process_path);
+    if (writer->process_info.parent_process_name != NULL) 
+        free(writer->process_info.parent_process_name);
+    
+    /* Free the system info */
+    if (writer->system_info.version != NULL)
+        free(writer->system_info.version);
+    
+    if (writer->system_info.build != NULL)
+        free(writer->system_info.build);
+    
+    /* Free the machine info */
+    if (writer->machine_info.model != NULL)
+        free(writer->machine_info.model);
+
+    /* Free the pre-encoded sections */
+    if (writer->static_sections.data != NULL)
+        free(writer->static_sections.data);
+
+    /* Free the exception data */
+    plcrash_writer_free_exception(writer);
+
+    /* Free any reserved exception storage */
+    if (writer->exception_reserve.callstack != NULL) {
+        free(writer->exception_reserve.name);
+        free(writer->exception_reserve.reason);
+        free(writer->exception_reserve.callstack);
+        memset(&writer->exception_reserve, 0, sizeof(writer->exception_reserve));
+    }
+
+    /* Free the standby symbol cache, if it was never consumed */
+    if (writer->has_standby_cache) {
+        plcrash_async_symbol_cache_free(&writer->standby_cache);
+        writer->has_standby_cache = false;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write the system info message fields preceding the timestamp. These do not change once the host information has
+ * been published.
+ *
+ * @param file Output file
+ * @param host_info_ready If false, the writer's host information has not been published, and the OS version and
+ * build are recorded as empty strings.
+ */
+static size_t plcrash_writer_write_system_info_fields (plcrash_async_file_t *file, plcrash_log_writer_t *writer, bool host_info_ready) {
+    size_t rv = 0;
+    uint32_t enumval;
+    const char *version = "";
+    const char *build = "";
+
+    if (host_info_ready) {
+        version = writer->system_info.version;
+        if (writer->system_info.build != NULL)
+            build = writer->system_info.build;
+    }
+
+    /* OS */
+    enumval = PLCrashReportHostOperatingSystem;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    /* OS Version */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, version);
+    
+    /* OS Build */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_BUILD_ID, PLPROTOBUF_C_TYPE_STRING, build);
+
+    /* Machine type */
+    enumval = PLCrashReportHostArchitecture;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ARCHITECTURE_TYPE_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the system info message.
+ *
+ * @param file Output file
+ * @param host_info_ready If false, the writer's host information has not been published, and the OS version and
+ * build are recorded as empty strings.
+ * @param timestamp Timestamp to use (seconds since epoch). Must be same across calls, as varint encoding.
+ */
+static size_t plcrash_writer_write_system_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer, bool host_info_ready, int64_t timestamp) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_write_system_info_fields(file, writer, host_info_ready);
+
+    /* Timestamp */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the processor info message.
+ *
+ * @param file Output file
+ * @param cpu_type The Mach CPU type.
+ * @param cpu_subtype The Mach CPU subtype
+ */
+static size_t plcrash_writer_write_processor_info (plcrash_async_file_t *file, uint64_t cpu_type, uint64_t cpu_subtype) {
+    size_t rv = 0;
+    uint32_t enumval;
+    
+    /* Encoding */
+    enumval = PLCrashReportProcessorTypeEncodingMach;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_ENCODING_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    /* Type */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_type);
+
+    /* Subtype */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_SUBTYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_subtype);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Return the size of the processor info message written by plcrash_writer_write_processor_info().
+ *
+ * @param cpu_type The Mach CPU type.
+ * @param cpu_subtype The Mach CPU subtype
+ */
+static inline size_t plcrash_writer_processor_info_size (uint64_t cpu_type, uint64_t cpu_subtype) {
+    return plcrash_writer_varint_field_size(PLCRASH_PROTO_PROCESSOR_ENCODING_ID, PLCrashReportProcessorTypeEncodingMach) +
+           plcrash_writer_varint_field_size(PLCRASH_PROTO_PROCESSOR_TYPE_ID, cpu_type) +
+           plcrash_writer_varint_field_size(PLCRASH_PROTO_PROCESSOR_SUBTYPE_ID, cpu_subtype);
+}
+
+/**
+ * @internal
+ *
+ * Write the machine info message.
+ *
+ * @param file Output file
+ * @param host_info_ready If false, the writer's host information has not been published, and the model is omitted
+ * while the processor type and counts are recorded as zero.
+ */
+static size_t plcrash_writer_write_machine_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer, bool host_info_ready) {
+    size_t rv = 0;
+    const char *model = NULL;
+    uint64_t cpu_type = 0;
+    uint64_t cpu_subtype = 0;
+    uint32_t processor_count = 0;
+    uint32_t logical_processor_count = 0;
+
+    if (host_info_ready) {
+        model = writer->machine_info.model;
+        cpu_type = writer->machine_info.cpu_type;
+        cpu_subtype = writer->machine_info.cpu_subtype;
+        processor_count = writer->machine_info.processor_count;
+        logical_processor_count = writer->machine_info.logical_processor_count;
+    }
+
+    /* Model */
+    if (model != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_MODEL_ID, PLPROTOBUF_C_TYPE_STRING, model);
+
+    /* Processor */
+    {
+        uint32_t size;
+
+        /* Determine size */
+        size = (uint32_t) plcrash_writer_processor_info_size(cpu_type, cpu_subtype);
+
+        /* Write message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_processor_info(file, cpu_type, cpu_subtype);
+    }
+
+    /* Physical Processor Count */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &processor_count);
+    
+    /* Logical Processor Count */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_LOGICAL_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &logical_processor_count);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the app info message.
+ *
+ * @param file Output file
+ * @param app_identifier Application identifier
+ * @param app_version Application version
+ * @param app_marketing_version Application marketing version
+ */
+static size_t plcrash_writer_write_app_info (plcrash_async_file_t *file, const char *app_identifier, const char *app_version, const char *app_marketing_version) {
+    size_t rv = 0;
+
+    /* App identifier */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_IDENTIFIER_ID, PLPROTOBUF_C_TYPE_STRING, app_identifier);
+    
+    /* App version */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_version);
+    
+    /* App marketing version */
+    if (app_marketing_version != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_MARKETING_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_marketing_version);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the process info message.
+ *
+ * @param file Output file
+ * @param process_name Process name, or NULL if unavailable.
+ * @param process_id Process ID
+ * @param process_path Process path, or NULL if unavailable.
+ * @param parent_process_name Parent process name, or NULL if unavailable.
+ * @param parent_process_id Parent process ID
+ * @param native If false, process is running under emulation.
+ * @param start_time The start time of the process.
+ */
+static size_t plcrash_writer_write_process_info (plcrash_async_file_t *file, const char *process_name,
+                                                 const pid_t process_id, const char *process_path, 
+                                                 const char *parent_process_name, const pid_t parent_process_id,
+                                                 bool native, time_t start_time)
+{
+    size_t rv = 0;
+    uint64_t tval;
+
+    /*
+     * In the current crash reporter serialization format, pid values are serialized as unsigned 32-bit integers. This
+     * conforms with the actual implementation of pid_t on both 32-bit and 64-bit Darwin systems. To conform with
+     * SuSV3, however, the values should be encoded as signed integers; the actual width of the type being implementation
+     * defined.
+     *
+     * To maintain compatibility with existing report readers the values remain encoded as unsigned 32-bit integers,
+     * but should be updated to int64 values in future major revision of the data format.
+     */
+    uint32_t pidval;
+
+    /* Process name */
+    if (process_name != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, process_name);
+
+    /* Process ID */
+    pidval = process_id;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+
+    /* Process path */
+    if (process_path != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_PATH_ID, PLPROTOBUF_C_TYPE_STRING, process_path);
+    
+    /* Parent process name */
+    if (parent_process_name != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, parent_process_name);
+    
+
+    /* Parent process ID */
+    pidval = parent_process_id;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+
+    /* Native process. */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_NATIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &native);
+    
+    /* Start time */
+    tval = start_time;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_START_TIME_ID, PLPROTOBUF_C_TYPE_UINT64, &tval);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the complete MachineInfo, AppInfo and ProcessInfo messages, using the writer's published host information.
+ *
+ * @param file Output file
+ * @param writer Writer containing the host and process information.
+ */
+static size_t plcrash_writer_write_static_messages (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+    size_t rv = 0;
+    uint32_t size;
+
+    /* Machine info */
+    size = plcrash_writer_write_machine_info(NULL, writer, true);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_machine_info(file, writer, true);
+
+    /* App info */
+    size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+
+    /* Process info */
+    size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id,
+                                             writer->process_info.process_path, writer->process_info.parent_process_name,
+                                             writer->process_info.parent_process_id, writer->process_info.native,
+                                             writer->process_info.start_time);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id,
+                                            writer->process_info.process_path, writer->process_info.parent_process_name,
+                                            writer->process_info.parent_process_id, writer->process_info.native,
+                                            writer->process_info.start_time);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Encode the report sections that do not change once the host information has been published into
+ * @a writer's static_sections buffer, replacing any previously encoded sections.
+ *
+ * @param writer Writer containing the host and process information.
+ *
+ * @warning This function is not async-safe, and must not be called while a report is being written.
+ */
+static plcrash_error_t plcrash_writer_encode_static_sections (plcrash_log_writer_t *writer) {
+    plcrash_async_file_t file;
+
+    size_t system_info_size = plcrash_writer_write_system_info_fields(NULL, writer, true);
+    size_t size = system_info_size + plcrash_writer_write_static_messages(NULL, writer);
+
+    uint8_t *data = malloc(size);
+    if (data == NULL)
+        return PLCRASH_ENOMEM;
+
+    plcrash_async_file_init_memory(&file, data, size);
+    plcrash_writer_write_system_info_fields(&file, writer, true);
+    plcrash_writer_write_static_messages(&file, writer);
+    plcrash_async_file_close(&file);
+
+    if (writer->static_sections.data != NULL)
+        free(writer->static_sections.data);
+
+    writer->static_sections.data = data;
+    writer->static_sections.system_info_size = system_info_size;
+    writer->static_sections.size = size;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Write the pre-encoded static report sections; only the SystemInfo timestamp, and the SystemInfo length that
+ * depends on it, are encoded at write time.
+ *
+ * @param file Output file
+ * @param writer Writer with pre-encoded static sections.
+ * @param timestamp Timestamp to use (seconds since epoch). Must be same across calls, as varint encoding.
+ */
+static size_t plcrash_writer_write_static_sections (plcrash_async_file_t *file, plcrash_log_writer_t *writer, int64_t timestamp) {
+    const uint8_t *data = writer->static_sections.data;
+    size_t system_info_size = writer->static_sections.system_info_size;
+    size_t rv = 0;
+
+    /* System info */
+    uint32_t size = (uint32_t) (system_info_size + plcrash_writer_pack(NULL, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp));
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    if (file != NULL)
+        plcrash_async_file_write(file, data, system_info_size);
+    rv += system_info_size;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp);
+
+    /* Machine, app and process info */
+    if (file != NULL)
+        plcrash_async_file_write(file, data + system_info_size, writer->static_sections.size - system_info_size);
+    rv += writer->static_sections.size - system_info_size;
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Flags recorded for each image in plcrash_log_writer_t::image_flags.
+ */
+enum {
+    /** The image contains the PC of a written frame, or a written register value. */
+    PLCRASH_WRITER_IMAGE_REFERENCED = 1 << 0,
+
+    /** The image's record has been written. */
+    PLCRASH_WRITER_IMAGE_WRITTEN = 1 << 1
+};
+
+/**
+ * @internal
+ *
+ * Mark the image containing @a address, if any, as referenced by the report.
+ *
+ * Images are only marked when @a file is non-NULL; sizing passes, which may be performed concurrently by the unwind
+ * workers, must be followed by a writing pass that will mark the same images.
+ *
+ * @param file Output file.
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param address The referenced address.
+ */
+static void plcrash_writer_mark_image (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, uint64_t address) {
+    size_t index;
+
+    if (file == NULL || writer->image_flags == NULL)
+        return;
+
+    if (plcrash_async_image_list_index_containing_address(image_list, (pl_vm_address_t) address, &index))
+        writer->image_flags[index] |= PLCRASH_WRITER_IMAGE_REFERENCED;
+}
+
+/**
+ * @internal
+ *
+ * The Mach CPU type that identifies the register order of the host's thread state; see the CrashReport.Thread.RegisterState
+ * documentation in crash_report.proto. PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID is the corresponding architecture field
+ * of CrashReportV2.RegisterState.
+ */
+#if defined(__arm64__)
+#define PLCRASH_WRITER_REGISTER_CPU_TYPE CPU_TYPE_ARM64
+#define PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID 4
+#elif defined(__arm__)
+#define PLCRASH_WRITER_REGISTER_CPU_TYPE CPU_TYPE_ARM
+#define PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID 3
+#elif defined(__x86_64__)
+#define PLCRASH_WRITER_REGISTER_CPU_TYPE CPU_TYPE_X86_64
+#define PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID 2
+#elif defined(__i386__)
+#define PLCRASH_WRITER_REGISTER_CPU_TYPE CPU_TYPE_X86
+#define PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID 1
+#else
+#error Unsupported Platform
+#endif
+
+/**
+ * @internal
+ *
+ * The maximum number of registers that may be written for a single thread; this bounds the size of the encoding buffer
+ * used by plcrash_writer_write_thread_registers().
+ */
+#define PLCRASH_WRITER_MAX_REGISTERS 64
+
+static bool plcrash_writer_symbol_table_intern (struct plcrash_writer_symbol_table *table, const char *name, uint32_t *index);
+
+/**
+ * @internal
+ * Register symbol lookup callback context
+ */
+struct pl_register_symbol_cb_ctx {
+    /** The writer context. */
+    plcrash_log_writer_t *writer;
+
+    /** The found symbol's start address. */
+    pl_vm_address_t address;
+
+    /** The string table index of the found symbol's name. */
+    uint32_t name_index;
+
+    /** True if the symbol's name was interned. */
+    bool found;
+};
+
+/**
+ * @internal
+ * pl_async_macho_found_symbol_cb callback that interns the found symbol's name.
+ */
+static void plcrash_writer_register_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    struct pl_register_symbol_cb_ctx *cb_ctx = ctx;
+
+    cb_ctx->address = address;
+    cb_ctx->found = plcrash_writer_symbol_table_intern(cb_ctx->writer->symbol_table, name, &cb_ctx->name_index);
+}
+
+/**
+ * @internal
+ *
+ * Encode the symbol annotation of a single register value into @a encoded, as the varint pair described by the
+ * CrashReport.Thread.RegisterState.symbols documentation. See plcrash_log_writer_set_register_annotation().
+ *
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param value The register value.
+ * @param encoded The buffer to which the annotation will be written. Must have room for two varints.
+ * @param found On return, set to true if a symbol was found.
+ *
+ * @return Returns the number of bytes written to @a encoded.
+ */
+static size_t plcrash_writer_encode_register_symbol (plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, uint64_t value,
+                                                     uint8_t *encoded, bool *found)
+{
+    size_t len = 0;
+    *found = false;
+
+    /* Both lookups are binary searches; images without a symbol index are skipped rather than scanned */
+    plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) value);
+    if (image != NULL && image->symbol_index != NULL) {
+        struct pl_register_symbol_cb_ctx ctx;
+        ctx.writer = writer;
+        ctx.found = false;
+
+        uint64_t start = plcrash_async_instrumentation_begin();
+        plcrash_async_macho_find_symbol_by_pc(image, (pl_vm_address_t) value, plcrash_writer_register_symbol_cb, &ctx);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_SYMBOLICATION, start);
+
+        if (ctx.found && ctx.address <= value) {
+            len += plcrash_writer_encode_varint(ctx.name_index + 1, encoded);
+            len += plcrash_writer_encode_varint(value - ctx.address, encoded + len);
+            *found = true;
+            return len;
+        }
+    }
+
+    encoded[len++] = 0;
+    encoded[len++] = 0;
+    return len;
+}
+
+/**
+ * @internal
+ *
+ * Write a single register.
+ *
+ * @param file Output file
+ * @param regname The register to write's name.
+ * @param regval The register to write's value.
+ */
+static size_t plcrash_writer_write_thread_register (plcrash_async_file_t *file, const char *regname, plcrash_greg_t regval) {
+    uint64_t uint64val;
+    size_t rv = 0;
+
+    /* Write the name */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_NAME_ID, PLPROTOBUF_C_TYPE_STRING, regname);
+
+    /* Write the value */
+    uint64val = regval;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID, PLPROTOBUF_C_TYPE_UINT64, &uint64val);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the thread's registers.
+ *
+ * By default, a named RegisterValue message is written per register. If the compact register state is enabled (see
+ * plcrash_log_writer_set_register_state()), the values are instead written as a single packed varint sequence in the
+ * host architecture's register order, with the register names implied by the CPU type. If register annotation is
+ * also enabled, the values are followed by their packed symbol annotations.
+ *
+ * @param file Output file
+ * @param writer The writer context.
+ * @param task The task from which @a uap was derived. All memory accesses will be mapped from this task.
+ * @param cursor The cursor from which to acquire frame registers.
+ * @param image_list The Mach-O image list; images containing a register value are marked as referenced.
+ */
+static size_t plcrash_writer_write_thread_registers (plcrash_async_file_t *file, plcrash_log_writer_t *writer, task_t task, plframe_cursor_t *cursor,
+                                                     plcrash_async_image_list_t *image_list)
+{
+    uint8_t encoded[PLCRASH_WRITER_MAX_REGISTERS * PLCRASH_WRITER_MAX_VARINT_BYTES];
+    uint8_t encoded_symbols[PLCRASH_WRITER_MAX_REGISTERS * PLCRASH_WRITER_MAX_VARINT_BYTES * 2];
+    PLProtobufCBinaryData values = { 0, encoded };
+    PLProtobufCBinaryData symbols = { 0, encoded_symbols };
+    bool has_symbols = false;
+    bool annotate = writer->annotate_registers && writer->symbol_table != NULL &&
+                    (writer->symbol_strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE) != 0;
+    uint64_t cpu_type = PLCRASH_WRITER_REGISTER_CPU_TYPE;
+    plframe_error_t frame_err;
+    uint32_t regCount = plframe_cursor_get_regcount(cursor);
+    uint32_t msgsize;
+    size_t rv = 0;
+
+    /* Write out register messages */
+    if (!writer->register_state) {
+        for (uint32_t i = 0; i < regCount; i++) {
+            plcrash_greg_t regVal;
+            const char *regname;
+
+            /* Fetch the register value */
+            if ((frame_err = plframe_cursor_get_reg(cursor, i, &regVal)) != PLFRAME_ESUCCESS) {
+                // Should never happen
+                PLCF_DEBUG("Could not fetch register %i value: %s", i, plframe_strerror(frame_err));
+                regVal = 0;
+            }
+
+            /* Fetch the register name */
+            regname = plframe_cursor_get_regname(cursor, i);
+            plcrash_writer_mark_image(file, writer, image_list, regVal);
+
+            /* Get the register message size */
+            msgsize = (uint32_t) plcrash_writer_write_thread_register(NULL, regname, regVal);
+
+            /* Write the header and message */
+            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTERS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+            rv += plcrash_writer_write_thread_register(file, regname, regVal);
+        }
+
+        return rv;
+    }
+
+    if (regCount > PLCRASH_WRITER_MAX_REGISTERS) {
+        // Should never happen
+        PLCF_DEBUG("Register count %u exceeds the supported maximum of %u", regCount, PLCRASH_WRITER_MAX_REGISTERS);
+        regCount = PLCRASH_WRITER_MAX_REGISTERS;
+    }
+
+    /* Encode the register values */
+    for (uint32_t i = 0; i < regCount; i++) {
+        plcrash_greg_t regVal;
+
+        /* Fetch the register value */
+        if ((frame_err = plframe_cursor_get_reg(cursor, i, &regVal)) != PLFRAME_ESUCCESS) {
+            // Should never happen
+            PLCF_DEBUG("Could not fetch register %i value: %s", i, plframe_strerror(frame_err));
+            regVal = 0;
+        }
+
+        plcrash_writer_mark_image(file, writer, image_list, regVal);
+        values.len += plcrash_writer_encode_varint(regVal, encoded + values.len);
+
+        /* Annotate the value with its symbol. Interned names retain their index, so the sizing and writing passes
+         * produce identical annotations. */
+        if (annotate) {
+            bool found;
+            symbols.len += plcrash_writer_encode_register_symbol(writer, image_list, regVal, encoded_symbols + symbols.len, &found);
+            has_symbols |= found;
+        }
+    }
+
+    /* Determine the message size */
+    msgsize = (uint32_t) (plcrash_writer_varint_field_size(PLCRASH_PROTO_THREAD_REGISTER_STATE_CPU_TYPE_ID, cpu_type) +
+                          plcrash_writer_delimited_field_size(PLCRASH_PROTO_THREAD_REGISTER_STATE_VALUES_ID, values.len));
+    if (has_symbols)
+        msgsize += (uint32_t) plcrash_writer_delimited_field_size(PLCRASH_PROTO_THREAD_REGISTER_STATE_SYMBOLS_ID, symbols.len);
+
+    /* Write the header and message */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_CPU_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_type);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_VALUES_ID, PLPROTOBUF_C_TYPE_BYTES, &values);
+    if (has_symbols)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_SYMBOLS_ID, PLPROTOBUF_C_TYPE_BYTES, &symbols);
+
+    return rv;
+}
+
+#pragma mark Symbol String Table
+
+/**
+ * @internal
+ *
+ * A table of uniqued symbol names, written to the report as the symbol_strings message. Entries are never removed, and
+ * so a name's index remains stable across the sizing and writing of a message.
+ *
+ * The table is shared by the unwind workers and the writing thread; all access is serialized via @a lock.
+ */
+typedef struct plcrash_writer_symbol_table {
+    /** Lock guarding all table state. */
+    OSSpinLock lock;
+
+    /** Open-addressed hash table of entry indices, offset by one; empty slots are 0. */
+    uint32_t *slots;
+
+    /** The number of slots. This is a power of two, and at least twice MAX_SYMBOL_TABLE_STRINGS. */
+    uint32_t slot_count;
+
+    /** The offset of each entry's name within @a names, in index order. Has capacity for MAX_SYMBOL_TABLE_STRINGS entries. */
+    uint32_t *offsets;
+
+    /** The number of entries. */
+    uint32_t count;
+
+    /** NUL-terminated symbol names. Has a capacity of MAX_SYMBOL_TABLE_BYTES. */
+    char *names;
+
+    /** Number of bytes used in @a names. */
+    size_t names_length;
+} plcrash_writer_symbol_table_t;
+
+/**
+ * @internal
+ *
+ * Allocate a new, empty symbol string table from @a allocator.
+ *
+ * @param result On success, will be set to the new table. The table must be released via plcrash_writer_symbol_table_free().
+ * @param allocator The allocator from which the table will be allocated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+static plcrash_error_t plcrash_writer_symbol_table_new (plcrash_writer_symbol_table_t **result, plcrash_async_allocator_t *allocator) {
+    plcrash_writer_symbol_table_t *table;
+    plcrash_error_t err;
+    void *buf;
+
+    uint32_t slot_count = 1;
+    while (slot_count < MAX_SYMBOL_TABLE_STRINGS * 2)
+        slot_count <<= 1;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(*table))) != PLCRASH_ESUCCESS)
+        return err;
+    table = buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(uint32_t) * slot_count)) != PLCRASH_ESUCCESS)
+        goto cleanup_table;
+    table->slots = buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, sizeof(uint32_t) * MAX_SYMBOL_TABLE_STRINGS)) != PLCRASH_ESUCCESS)
+        goto cleanup_slots;
+    table->offsets = buf;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &buf, MAX_SYMBOL_TABLE_BYTES)) != PLCRASH_ESUCCESS)
+        goto cleanup_offsets;
+    table->names = buf;
+
+    plcrash_async_memset(table->slots, 0, sizeof(uint32_t) * slot_count);
+    table->lock = OS_SPINLOCK_INIT;
+    table->slot_count = slot_count;
+    table->count = 0;
+    table->names_length = 0;
+
+    *result = table;
+    return PLCRASH_ESUCCESS;
+
+cleanup_offsets:
+    plcrash_async_allocator_dealloc(allocator, table->offsets);
+
+cleanup_slots:
+    plcrash_async_allocator_dealloc(allocator, table->slots);
+
+cleanup_table:
+    plcrash_async_allocator_dealloc(allocator, table);
+    return err;
+}
+
+/**
+ * @internal
+ *
+ * Free @a table.
+ *
+ * @param table The table to free.
+ * @param allocator The allocator used to allocate @a table.
+ */
+static void plcrash_writer_symbol_table_free (plcrash_writer_symbol_table_t *table, plcrash_async_allocator_t *allocator) {
+    plcrash_async_allocator_dealloc(allocator, table->names);
+    plcrash_async_allocator_dealloc(allocator, table->offsets);
+    plcrash_async_allocator_dealloc(allocator, table->slots);
+    plcrash_async_allocator_dealloc(allocator, table);
+}
+
+/**
+ * @internal
+ *
+ * Look up @a name in @a table, adding it if not already present.
+ *
+ * @param table The symbol string table.
+ * @param name The symbol name.
+ * @param index On success, will be set to the name's index within @a table.
+ *
+ * @return Returns true on success, or false if @a name is not present and @a table is full; in that case, the name
+ * must be written inline.
+ */
+static bool plcrash_writer_symbol_table_intern (plcrash_writer_symbol_table_t *table, const char *name, uint32_t *index) {
+    size_t len = 0;
+    uint32_t hash = 2166136261U;
+    bool found = false;
+
+    /* FNV-1a */
+    for (const char *p = name; *p != '\0'; p++, len++) {
+        hash ^= (uint8_t) *p;
+        hash *= 16777619U;
+    }
+
+    OSSpinLockLock(&table->lock); {
+        uint32_t mask = table->slot_count - 1;
+        uint32_t slot = hash & mask;
+
+        /* The table is never more than half full, and so an empty slot will always be found */
+        while (table->slots[slot] != 0) {
+            uint32_t candidate = table->slots[slot] - 1;
+            if (plcrash_async_strcmp(table->names + table->offsets[candidate], name) == 0) {
+                *index = candidate;
+                found = true;
+                break;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        /* Insert the name, if there's room */
+        if (!found && table->count < MAX_SYMBOL_TABLE_STRINGS && len + 1 <= MAX_SYMBOL_TABLE_BYTES - table->names_length) {
+            plcrash_async_memcpy(table->names + table->names_length, name, len + 1);
+            table->offsets[table->count] = (uint32_t) table->names_length;
+            table->names_length += len + 1;
+
+            *index = table->count;
+            table->slots[slot] = ++table->count;
+            found = true;
+        }
+    } OSSpinLockUnlock(&table->lock);
+
+    return found;
+}
+
+/**
+ * @internal
+ *
+ * Write the symbol string table message.
+ *
+ * @param file Output file
+ * @param table The symbol string table.
+ */
+static size_t plcrash_writer_write_symbol_strings (plcrash_async_file_t *file, plcrash_writer_symbol_table_t *table) {
+    size_t rv = 0;
+
+    for (uint32_t i = 0; i < table->count; i++)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_STRINGS_STRINGS_ID, PLPROTOBUF_C_TYPE_STRING, table->names + table->offsets[i]);
+
+    return rv;
+}
+
+#pragma mark Backtraces
+
+/**
+ * @internal
+ *
+ * Write a symbol.
+ *
+ * @param file Output file
+ * @param name The symbol name, or NULL if the name is to be written as an index into the report's symbol string table.
+ * @param name_index The index of the symbol's name within the symbol string table. Ignored if @a name is non-NULL.
+ * @param start_address The symbol start address
+ */
+static size_t plcrash_writer_write_symbol (plcrash_async_file_t *file, const char *name, uint32_t name_index, uint64_t start_address) {
+    size_t rv = 0;
+
+    /* name */
+    if (name == NULL) {
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_NAME_INDEX, PLPROTOBUF_C_TYPE_UINT32, &name_index);
+    } else {
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_NAME, PLPROTOBUF_C_TYPE_STRING, name);
+    }
+
+    /* start_address */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_START_ADDRESS, PLPROTOBUF_C_TYPE_UINT64, &start_address);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Return the size of the symbol message written by plcrash_writer_write_symbol().
+ *
+ * @param name The symbol name, or NULL if the name is to be written as an index into the report's symbol string table.
+ * @param name_index The index of the symbol's name within the symbol string table. Ignored if @a name is non-NULL.
+ * @param start_address The symbol start address
+ */
+static inline size_t plcrash_writer_symbol_size (const char *name, uint32_t name_index, uint64_t start_address) {
+    size_t rv;
+
+    if (name == NULL) {
+        rv = plcrash_writer_varint_field_size(PLCRASH_PROTO_SYMBOL_NAME_INDEX, name_index);
+    } else {
+        rv = plcrash_writer_delimited_field_size(PLCRASH_PROTO_SYMBOL_NAME, strlen(name));
+    }
+
+    return rv + plcrash_writer_varint_field_size(PLCRASH_PROTO_SYMBOL_START_ADDRESS, start_address);
+}
+
+/**
+ * @internal
+ *
+ * Write a frame's symbol field, including the field header. If the writer's symbol string table is available, the
+ * name will be written as an index into the table.
+ *
+ * @param file Output file, or NULL to determine the field size.
+ * @param writer The writer context.
+ * @param name The symbol name
+ * @param start_address The symbol start address
+ */
+static size_t plcrash_writer_write_frame_symbol (plcrash_async_file_t *file, plcrash_log_writer_t *writer, const char *name, uint64_t start_address) {
+    size_t rv = 0;
+    uint32_t name_index = 0;
+    uint32_t msgsize;
+
+    /* Look up the name's index once; both the size and the message depend on it */
+    if (writer->symbol_table != NULL && plcrash_writer_symbol_table_intern(writer->symbol_table, name, &name_index))
+        name = NULL;
+
+    /* Determine the size */
+    msgsize = (uint32_t) plcrash_writer_symbol_size(name, name_index, start_address);
+    if (file == NULL)
+        return plcrash_writer_delimited_field_size(PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID, msgsize);
+
+    /* Write the header and message */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    rv += plcrash_writer_write_symbol(file, name, name_index, start_address);
+
+    return rv;
+}
+
+/**
+ * @internal
+ * Symbol lookup callback context
+ */
+struct pl_symbol_cb_ctx {
+    /** File to use for writing out a symbol entry. May be NULL. */
+    plcrash_async_file_t *file;
+
+    /** The writer context. */
+    plcrash_log_writer_t *writer;
+
+    /** Total size of the symbol field (including the field header), to be written by the callback function upon
+     * writing an entry. */
+    size_t fieldsize;
+};
+
+/**
+ * @internal
+ *
+ * pl_async_macho_found_symbol_cb callback implementation. Writes the symbol field (header and message) to the file
+ * available via @a ctx, which must be a valid pl_symbol_cb_ctx structure.
+ *
+ * The symbol message's size is trivially computed from the symbol found, allowing the header and message to be
+ * written from a single symbol lookup.
+ */
+static void plcrash_writer_write_thread_frame_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    struct pl_symbol_cb_ctx *cb_ctx = ctx;
+    cb_ctx->fieldsize = plcrash_writer_write_frame_symbol(cb_ctx->file, cb_ctx->writer, name, address);
+}
+
+/**
+ * @internal
+ *
+ * Returns true if messages containing backtraces should be written to @a file in a single pass, reserving a
+ * fixed-width length prefix via plcrash_writer_pack_deferred_length() and backpatching the actual length
+ * once the message has been written.
+ *
+ * Otherwise, the message must be sized by a first pass with a NULL file, followed by a second pass that actually
+ * writes the data. Since sizing a backtrace requires walking the thread's stack and symbolicating every frame,
+ * the single-pass approach should be preferred where supported.
+ *
+ * @param file Output file. If NULL, this function will return false.
+ */
+static bool plcrash_writer_use_single_pass (plcrash_async_file_t *file) {
+    return file != NULL && plcrash_async_file_seekable(file);
+}
+
+/**
+ * @internal
+ *
+ * Write a thread backtrace frame
+ *
+ * @param file Output file
+ * @param pcval The frame PC value.
+ */
+static size_t plcrash_writer_write_thread_frame (plcrash_async_file_t *file, plcrash_log_writer_t *writer, uint64_t pcval, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_PC_ID, PLPROTOBUF_C_TYPE_UINT64, &pcval);
+    plcrash_writer_mark_image(file, writer, image_list, pcval);
+    
+    plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pcval);
+    if (image != NULL && writer->symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
+        struct pl_symbol_cb_ctx ctx;
+        plcrash_error_t ret;
+        
+        /* Write the symbol field. If the symbol can not be found, our callback will not be called. If the symbol is found,
+         * our callback writes the symbol field and PLCRASH_ESUCCESS is returned. */
+        ctx.file = file;
+        ctx.writer = writer;
+        ctx.fieldsize = 0x0;
+
+        uint64_t start = plcrash_async_instrumentation_begin();
+        ret = plcrash_async_find_symbol(image, writer->symbol_strategy, findContext, (pl_vm_address_t) pcval, plcrash_writer_write_thread_frame_symbol_cb, &ctx);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_SYMBOLICATION, start);
+        if (ret == PLCRASH_ESUCCESS)
+            rv += ctx.fieldsize;
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ * Symbol name offset values with special meaning in plcrash_writer_memo_frame_t.
+ */
+enum {
+    /** No symbol was found for the frame. */
+    PLCRASH_WRITER_MEMO_SYMBOL_NONE = UINT32_MAX,
+
+    /** A symbol was found, but there was insufficient space to memoize its name; the symbol must be looked up again
+     * when the frame is written. */
+    PLCRASH_WRITER_MEMO_SYMBOL_UNCACHED = UINT32_MAX - 1,
+
+    /** The frame has been recorded, but its symbol has not yet been resolved. See plcrash_writer_frame_memo_resolve(). */
+    PLCRASH_WRITER_MEMO_SYMBOL_PENDING = UINT32_MAX - 2
+};
+
+/**
+ * @internal
+ *
+ * A backtrace frame memoized while sizing a thread message.
+ */
+typedef struct plcrash_writer_memo_frame {
+    /** The frame's PC value. */
+    uint64_t pc;
+
+    /** The symbol's start address. Only valid if @a symbol_name_offset refers to a memoized name. */
+    uint64_t symbol_address;
+
+    /** The offset of the symbol's name within the memo's name buffer, or one of PLCRASH_WRITER_MEMO_SYMBOL_NONE or
+     * PLCRASH_WRITER_MEMO_SYMBOL_UNCACHED. */
+    uint32_t symbol_name_offset;
+
+    /** The index of the symbol's name within the report's symbol string table. Only valid if the memo's frames are to
+     * be written in packed form, and @a symbol_name_offset refers to a memoized name. */
+    uint32_t symbol_name_index;
+} plcrash_writer_memo_frame_t;
+
+/**
+ * @internal
+ *
+ * A run of consecutively repeated frames, collapsed into its first occurrence.
+ */
+typedef struct plcrash_writer_frame_repeat {
+    /** The index of the run's first frame within the thread's written frames. */
+    uint32_t frame_index;
+
+    /** The number of frames in the run. */
+    uint32_t frame_count;
+
+    /** The number of omitted repetitions of the run. */
+    uint32_t repeat_count;
+} plcrash_writer_frame_repeat_t;
+
+/**
+ * @internal
+ *
+ * Records the results of walking and symbolicating a single thread's stack while sizing the thread's message,
+ * allowing the message to be written without unwinding or symbolicating the thread a second time.
+ */
+typedef struct plcrash_writer_frame_memo {
+    /** If true, a thread's stack has been recorded and may be replayed. */
+    bool valid;
+
+    /** If true, the thread's registers were written prior to the first frame. */
+    bool has_registers;
+
+    /** The recorded frames. Has capacity for MAX_THREAD_FRAMES entries. */
+    plcrash_writer_memo_frame_t *frames;
+
+    /** The number of recorded frames. */
+    uint32_t frame_count;
+
+    /** NUL-terminated symbol names, referenced by offset from plcrash_writer_memo_frame_t. */
+    char *names;
+
+    /** Number of bytes used in @a names. */
+    size_t names_length;
+
+    /** Total capacity of @a names, in bytes. */
+    size_t names_capacity;
+
+    /** The collapsed frame runs recorded for the thread. */
+    plcrash_writer_frame_repeat_t repeats[MAX_THREAD_FRAME_REPEATS];
+
+    /** The number of entries in @a repeats. */
+    uint32_t repeat_count;
+
+    /** The number of frames omitted from the thread's truncated stack, or 0. */
+    uint32_t omitted_frame_count;
+
+    /** The index at which frames were omitted. Only valid if @a omitted_frame_count is non-zero. */
+    uint32_t omitted_frame_index;
+
+    /** If true, the recorded frames are left unresolved and unsized when recorded, and must be completed via
+     * plcrash_writer_frame_memo_resolve() and plcrash_writer_frame_memo_size(). */
+    bool resolve_deferred;
+
+    /** If true, the recorded frames are written in packed form. Determined by plcrash_writer_frame_memo_size(). */
+    bool packed;
+} plcrash_writer_frame_memo_t;
+
+/**
+ * @internal
+ *
+ * Allocate the frame and name buffers for @a memo from @a allocator.
+ *
+ * @param memo The memo to initialize.
+ * @param allocator The allocator from which buffers will be allocated.
+ * @param names_capacity The number of bytes of symbol name data that may be memoized.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+static plcrash_error_t plcrash_writer_frame_memo_init (plcrash_writer_frame_memo_t *memo, plcrash_async_allocator_t *allocator, size_t names_capacity) {
+    plcrash_error_t err;
+    void *frames;
+    void *names;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &frames, sizeof(plcrash_writer_memo_frame_t) * MAX_THREAD_FRAMES)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = plcrash_async_allocator_alloc(allocator, &names, names_capacity)) != PLCRASH_ESUCCESS) {
+        plcrash_async_allocator_dealloc(allocator, frames);
+        return err;
+    }
+
+    memo->valid = false;
+    memo->has_registers = false;
+    memo->frames = frames;
+    memo->frame_count = 0;
+    memo->names = names;
+    memo->names_length = 0;
+    memo->names_capacity = names_capacity;
+    memo->repeat_count = 0;
+    memo->omitted_frame_count = 0;
+    memo->omitted_frame_index = 0;
+    memo->resolve_deferred = false;
+    memo->packed = false;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Free all buffers associated with @a memo.
+ *
+ * @param memo The memo to free.
+ * @param allocator The allocator used to initialize @a memo.
+ */
+static void plcrash_writer_frame_memo_free (plcrash_writer_frame_memo_t *memo, plcrash_async_allocator_t *allocator) {
+    plcrash_async_allocator_dealloc(allocator, memo->frames);
+    plcrash_async_allocator_dealloc(allocator, memo->names);
+}
+
+/**
+ * @internal
+ *
+ * Compute a hash of the stack recorded in @a memo, covering the frame PCs and the thread's collapsed frame runs and
+ * omitted frames. Symbol information is not included; identical PCs always resolve to the same symbol.
+ *
+ * @param memo A memo containing a recorded stack.
+ */
+static uint64_t plcrash_writer_frame_memo_hash (const plcrash_writer_frame_memo_t *memo) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    /* FNV-1a, applied per value rather than per byte */
+#define PL_MEMO_HASH(_value) do { \
+    hash ^= (uint64_t) (_value); \
+    hash *= 1099511628211ULL; \
+} while (0)
+
+    PL_MEMO_HASH(memo->frame_count);
+    for (uint32_t i = 0; i < memo->frame_count; i++)
+        PL_MEMO_HASH(memo->frames[i].pc);
+
+    PL_MEMO_HASH(memo->repeat_count);
+    for (uint32_t i = 0; i < memo->repeat_count; i++) {
+        PL_MEMO_HASH(memo->repeats[i].frame_index);
+        PL_MEMO_HASH(memo->repeats[i].frame_count);
+        PL_MEMO_HASH(memo->repeats[i].repeat_count);
+    }
+
+    PL_MEMO_HASH(memo->omitted_frame_count);
+    PL_MEMO_HASH(memo->omitted_frame_index);
+
+#undef PL_MEMO_HASH
+
+    return hash;
+}
+
+/**
+ * @internal
+ *
+ * A unique thread stack written in full to the report.
+ */
+typedef struct plcrash_writer_unique_stack {
+    /** The stack's plcrash_writer_frame_memo_hash() value. */
+    uint64_t hash;
+
+    /** The number of frames in the stack. */
+    uint32_t frame_count;
+
+    /** The number of the thread for which the stack was written. */
+    uint32_t thread_number;
+} plcrash_writer_unique_stack_t;
+
+/**
+ * @internal
+ *
+ * The unique thread stacks written to a report, used to collapse identical stacks. See
+ * plcrash_log_writer_set_collapse_stacks().
+ */
+typedef struct plcrash_writer_stack_table {
+    /** The unique stacks, in the order written. */
+    plcrash_writer_unique_stack_t stacks[MAX_UNIQUE_THREAD_STACKS];
+
+    /** The number of entries in @a stacks. */
+    uint32_t count;
+} plcrash_writer_stack_table_t;
+
+/**
+ * @internal
+ *
+ * Look up the stack recorded in @a memo in @a table. If no identical stack has been written, the stack is added to
+ * @a table, if there's room, as the stack of @a thread_number.
+ *
+ * @param table The stack table.
+ * @param memo A memo containing the recorded stack of @a thread_number.
+ * @param thread_number The number of the thread being written.
+ * @param duplicate_of If an identical stack was found, will be set to the number of the thread for which it was written.
+ *
+ * @return Returns true if an identical stack was found, in which case the thread's stack need not be written.
+ */
+static bool plcrash_writer_stack_table_find (plcrash_writer_stack_table_t *table, const plcrash_writer_frame_memo_t *memo,
+                                             uint32_t thread_number, uint32_t *duplicate_of)
+{
+    uint64_t hash = plcrash_writer_frame_memo_hash(memo);
+
+    /* The table is small, and only consulted once per thread; a linear scan suffices */
+    for (uint32_t i = 0; i < table->count; i++) {
+        if (table->stacks[i].hash == hash && table->stacks[i].frame_count == memo->frame_count) {
+            *duplicate_of = table->stacks[i].thread_number;
+            return true;
+        }
+    }
+
+    if (table->count < MAX_UNIQUE_THREAD_STACKS) {
+        table->stacks[table->count].hash = hash;
+        table->stacks[table->count].frame_count = memo->frame_count;
+        table->stacks[table->count].thread_number = thread_number;
+        table->count++;
+    }
+
+    return false;
+}
+
+/** The maximum number of a memo's frames resolved by a single batch symbol lookup. */
+#define MEMO_SYMBOL_BATCH_SIZE 64
+
+/**
+ * @internal
+ * Symbol memoization callback context
+ */
+struct pl_memo_symbol_cb_ctx {
+    /** The memo in which the symbol names will be recorded. */
+    plcrash_writer_frame_memo_t *memo;
+
+    /** The indices, within the memo's frames, of the frames being resolved. */
+    const uint32_t *frame_indices;
+};
+
+/**
+ * @internal
+ *
+ * plcrash_async_found_symbols_cb callback implementation. Records the result in the memo available via @a ctx, which
+ * must be a valid pl_memo_symbol_cb_ctx structure.
+ */
+static void plcrash_writer_memo_symbol_cb (size_t index, pl_vm_address_t address, const char *name, void *ctx) {
+    struct pl_memo_symbol_cb_ctx *cb_ctx = ctx;
+    plcrash_writer_frame_memo_t *memo = cb_ctx->memo;
+    plcrash_writer_memo_frame_t *frame = &memo->frames[cb_ctx->frame_indices[index]];
+    size_t len = strlen(name) + 1;
+
+    /* If there's no room for the name, the symbol will have to be looked up again when the frame is written */
+    if (len > memo->names_capacity - memo->names_length) {
+        frame->symbol_name_offset = PLCRASH_WRITER_MEMO_SYMBOL_UNCACHED;
+        return;
+    }
+
+    plcrash_async_memcpy(memo->names + memo->names_length, name, len);
+    frame->symbol_name_offset = (uint32_t) memo->names_length;
+    frame->symbol_address = address;
+    memo->names_length += len;
+}
+
+/**
+ * @internal
+ *
+ * Resolve and record the symbols for all of the pending frames in @a memo. The frames are grouped by image, and the
+ * frames of each image are resolved via a single batch lookup, scanning the image's symbol table once rather than
+ * once per frame.
+ *
+ * @param memo The memo in which the symbols will be recorded.
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ */
+static void plcrash_writer_frame_memo_resolve (plcrash_writer_frame_memo_t *memo, plcrash_log_writer_t *writer,
+                                               plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext)
+{
+    for (uint32_t i = 0; i < memo->frame_count; i++) {
+        if (memo->frames[i].symbol_name_offset != PLCRASH_WRITER_MEMO_SYMBOL_PENDING)
+            continue;
+
+        /* If the symbol can not be found, our callback will not be called, and the frame will be left as-is */
+        memo->frames[i].symbol_name_offset = PLCRASH_WRITER_MEMO_SYMBOL_NONE;
+
+        plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) memo->frames[i].pc);
+        if (image == NULL || writer->symbol_strategy == PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE)
+            continue;
+
+        /* Gather this and the following pending frames within the same image */
+        uint32_t frame_indices[MEMO_SYMBOL_BATCH_SIZE];
+        pl_vm_address_t pcs[MEMO_SYMBOL_BATCH_SIZE];
+        size_t count = 0;
+
+        frame_indices[count] = i;
+        pcs[count++] = (pl_vm_address_t) memo->frames[i].pc;
+
+        for (uint32_t j = i + 1; j < memo->frame_count && count < MEMO_SYMBOL_BATCH_SIZE; j++) {
+            plcrash_writer_memo_frame_t *frame = &memo->frames[j];
+            if (frame->symbol_name_offset != PLCRASH_WRITER_MEMO_SYMBOL_PENDING || !plcrash_async_macho_contains_address(image, (pl_vm_address_t) frame->pc))
+                continue;
+
+            frame->symbol_name_offset = PLCRASH_WRITER_MEMO_SYMBOL_NONE;
+            frame_indices[count] = j;
+            pcs[count++] = (pl_vm_address_t) frame->pc;
+        }
+
+        struct pl_memo_symbol_cb_ctx ctx;
+        ctx.memo = memo;
+        ctx.frame_indices = frame_indices;
+
+        uint64_t start = plcrash_async_instrumentation_begin();
+        plcrash_async_find_symbols(image, writer->symbol_strategy, findContext, pcs, count, plcrash_writer_memo_symbol_cb, &ctx);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_SYMBOLICATION, start);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write a memoized thread backtrace frame
+ *
+ * @param file Output file
+ * @param writer The writer context.
+ * @param memo The memo containing @a frame.
+ * @param frame The memoized frame.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ */
+static size_t plcrash_writer_write_memo_frame (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_writer_frame_memo_t *memo,
+                                               plcrash_writer_memo_frame_t *frame, plcrash_async_image_list_t *image_list,
+                                               plcrash_async_symbol_cache_t *findContext)
+{
+    size_t rv = 0;
+
+    /* If the symbol could not be memoized, fall back on a full lookup */
+    if (frame->symbol_name_offset == PLCRASH_WRITER_MEMO_SYMBOL_UNCACHED)
+        return plcrash_writer_write_thread_frame(file, writer, frame->pc, image_list, findContext);
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_PC_ID, PLPROTOBUF_C_TYPE_UINT64, &frame->pc);
+    plcrash_writer_mark_image(file, writer, image_list, frame->pc);
+
+    if (frame->symbol_name_offset != PLCRASH_WRITER_MEMO_SYMBOL_NONE)
+        rv += plcrash_writer_write_frame_symbol(file, writer, memo->names + frame->symbol_name_offset, frame->symbol_address);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Determine whether @a memo's resolved frames may be written in packed form, recording the string table index of each
+ * frame's symbol name. See plcrash_log_writer_set_packed_frames().
+ *
+ * @param memo The memo to be written. All frames must have been resolved via plcrash_writer_frame_memo_resolve().
+ * @param writer The writer context.
+ */
+static bool plcrash_writer_frame_memo_packable (plcrash_writer_frame_memo_t *memo, plcrash_log_writer_t *writer) {
+    if (!writer->packed_frames)
+        return false;
+
+    for (uint32_t i = 0; i < memo->frame_count; i++) {
+        plcrash_writer_memo_frame_t *frame = &memo->frames[i];
+        if (frame->symbol_name_offset == PLCRASH_WRITER_MEMO_SYMBOL_NONE)
+            continue;
+
+        /* Symbols that were not memoized, or whose names can't be added to the string table, must be written inline */
+        if (frame->symbol_name_offset == PLCRASH_WRITER_MEMO_SYMBOL_UNCACHED || writer->symbol_table == NULL)
+            return false;
+
+        if (!plcrash_writer_symbol_table_intern(writer->symbol_table, memo->names + frame->symbol_name_offset, &frame->symbol_name_index))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Write all of @a memo's frames in packed form, as the thread message's frame_pcs and frame_symbols fields. The frames
+ * must have been found packable by plcrash_writer_frame_memo_packable().
+ *
+ * Each array is written as a length-delimited field; the field header is followed directly by the array's varints,
+ * which are encoded into the output file's buffer rather than a scratch copy of the array.
+ *
+ * @param file Output file, or NULL to determine the size.
+ * @param writer The writer context.
+ * @param memo The memo to be written.
+ * @param image_list The Mach-O image list.
+ */
+static size_t plcrash_writer_write_packed_frames (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_writer_frame_memo_t *memo,
+                                                  plcrash_async_image_list_t *image_list)
+{
+    uint8_t encoded[PLCRASH_WRITER_MAX_VARINT_BYTES * 2];
+    uint32_t pcs_length = 0;
+    uint32_t symbols_length = 0;
+    bool has_symbols = false;
+    size_t rv = 0;
+
+    /* Determine the length of each array */
+    for (uint32_t i = 0; i < memo->frame_count; i++) {
+        plcrash_writer_memo_frame_t *frame = &memo->frames[i];
+
+        pcs_length += plcrash_writer_varint_size(frame->pc);
+        if (frame->symbol_name_offset == PLCRASH_WRITER_MEMO_SYMBOL_NONE) {
+            symbols_length += 2;
+        } else {
+            symbols_length += plcrash_writer_varint_size(frame->symbol_name_index + 1);
+            symbols_length += plcrash_writer_varint_size(frame->pc - frame->symbol_address);
+            has_symbols = true;
+        }
+    }
+
+    /* frame_pcs */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_PCS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &pcs_length);
+    rv += pcs_length;
+
+    if (file != NULL) {
+        for (uint32_t i = 0; i < memo->frame_count; i++) {
+            plcrash_writer_mark_image(file, writer, image_list, memo->frames[i].pc);
+            plcrash_async_file_write(file, encoded, plcrash_writer_encode_varint(memo->frames[i].pc, encoded));
+        }
+    }
+
+    /* frame_symbols; omitted entirely if no frame has a symbol */
+    if (!has_symbols)
+        return rv;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_SYMBOLS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &symbols_length);
+    rv += symbols_length;
+
+    if (file != NULL) {
+        for (uint32_t i = 0; i < memo->frame_count; i++) {
+            plcrash_writer_memo_frame_t *frame = &memo->frames[i];
+            size_t len = 0;
+
+            if (frame->symbol_name_offset == PLCRASH_WRITER_MEMO_SYMBOL_NONE) {
+                encoded[len++] = 0;
+                encoded[len++] = 0;
+            } else {
+                len += plcrash_writer_encode_varint(frame->symbol_name_index + 1, encoded);
+                len += plcrash_writer_encode_varint(frame->pc - frame->symbol_address, encoded + len);
+            }
+
+            plcrash_async_file_write(file, encoded, len);
+        }
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Return the encoded size of all of @a memo's resolved frames, including each frame's field header. This also
+ * determines whether the frames will be written in packed form.
+ *
+ * @param memo The memo to be sized. All frames must have been resolved via plcrash_writer_frame_memo_resolve().
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ */
+static size_t plcrash_writer_frame_memo_size (plcrash_writer_frame_memo_t *memo, plcrash_log_writer_t *writer,
+                                              plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext)
+{
+    size_t rv = 0;
+
+    /* Prefer the packed encoding, if enabled and supported by the thread's symbols */
+    memo->packed = plcrash_writer_frame_memo_packable(memo, writer);
+    if (memo->packed)
+        return plcrash_writer_write_packed_frames(NULL, writer, memo, image_list);
+
+    for (uint32_t i = 0; i < memo->frame_count; i++) {
+        uint32_t frame_size = (uint32_t) plcrash_writer_write_memo_frame(NULL, writer, memo, &memo->frames[i], image_list, findContext);
+        rv += plcrash_writer_pack(NULL, PLCRASH_PROTO_THREAD_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+        rv += frame_size;
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * A copy of the top of a thread's stack, captured while the thread was suspended.
+ */
+typedef struct plcrash_writer_stack_snapshot {
+    /** The task-relative address at which the copy begins; this is the thread's stack pointer. */
+    pl_vm_address_t address;
+
+    /** The number of bytes copied. */
+    pl_vm_size_t length;
+
+    /** The copied stack data. */
+    void *data;
+} plcrash_writer_stack_snapshot_t;
+
+/**
+ * @internal
+ *
+ * Fetch the next frame from @a cursor.
+ *
+ * @param cursor The frame cursor.
+ * @param frame_ptr_only If true, only the frame pointer reader will be used. This is required if @a cursor has been
+ * configured to read from a stack snapshot, in which case the target thread may no longer be suspended: the compact
+ * unwind and DWARF readers restore saved registers directly from the target's live stack, whereas the frame pointer
+ * reader reads through the cursor's copy of the stack.
+ * @param stack_scan If true and the frame can not be unwound by any of these readers, plframe_cursor_read_stack_scan()
+ * will be used to recover the caller's frame heuristically. The scan reads through the cursor's stack window, and is
+ * safe to use with a stack snapshot.
+ */
+static plframe_error_t plcrash_writer_cursor_next (plframe_cursor_t *cursor, bool frame_ptr_only, bool stack_scan) {
+    plframe_error_t ferr;
+    uint64_t start = plcrash_async_instrumentation_begin();
+
+    if (!frame_ptr_only) {
+        ferr = plframe_cursor_next(cursor);
+    } else {
+        plframe_cursor_frame_reader_t *readers[] = {
+            plframe_cursor_read_frame_ptr
+        };
+        ferr = plframe_cursor_next_with_readers(cursor, readers, sizeof(readers)/sizeof(readers[0]));
+    }
+
+    /* If the frame could not be unwound -- rather than the stack having been exhausted -- fall back on scanning the
+     * stack for a return address */
+    if (stack_scan && ferr != PLFRAME_ESUCCESS && ferr != PLFRAME_ENOFRAME) {
+        plframe_cursor_frame_reader_t *readers[] = {
+            plframe_cursor_read_stack_scan
+        };
+        ferr = plframe_cursor_next_with_readers(cursor, readers, sizeof(readers)/sizeof(readers[0]));
+    }
+
+    plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_UNWIND, start);
+    return ferr;
+}
+
+/**
+ * @internal
+ *
+ * Frame output state for a single thread message. As the thread's stack is walked, each frame is passed to
+ * plcrash_writer_thread_frames_push(), which writes the frame (or records it in the thread's memo) while enforcing the
+ * thread's frame limit, collapsing runs of repeated frames, and retaining the frames at the bottom of a truncated stack.
+ */
+typedef struct plcrash_writer_thread_frames {
+    /** Output file, or NULL if the thread message is being sized. */
+    plcrash_async_file_t *file;
+
+    /** The writer context. */
+    plcrash_log_writer_t *writer;
+
+    /** If non-NULL, frames are recorded in this memo rather than written. */
+    plcrash_writer_frame_memo_t *memo;
+
+    /** The Mach-O image list. */
+    plcrash_async_image_list_t *image_list;
+
+    /** Symbol lookup cache. */
+    plcrash_async_symbol_cache_t *findContext;
+
+    /** The number of bytes written. */
+    size_t size;
+
+    /** The number of frames written. */
+    uint32_t frame_count;
+
+    /** The number of frames that may be written prior to frames being retained in @a tail. */
+    uint32_t head_limit;
+
+    /** The number of frames to be retained in @a tail, or 0 if no frames should be accepted past @a head_limit. If 0,
+     * repeated runs of frames will also not be collapsed. */
+    uint32_t tail_limit;
+
+    /** The PCs of the most recently written frames, indexed by frame number modulo MAX_FRAME_REPEAT_LENGTH. */
+    uint64_t history[MAX_FRAME_REPEAT_LENGTH];
+
+    /** The length of the run currently being matched against the most recently written frames, or 0. */
+    uint32_t run_length;
+
+    /** The number of frames of the run's current repetition that have been matched. */
+    uint32_t run_position;
+
+    /** The number of complete repetitions of the run that have been matched. */
+    uint32_t run_repeats;
+
+    /** The collapsed runs. */
+    plcrash_writer_frame_repeat_t repeats[MAX_THREAD_FRAME_REPEATS];
+
+    /** The number of entries in @a repeats. */
+    uint32_t repeat_count;
+
+    /** Ring buffer of the PCs of the frames past @a head_limit. */
+    uint64_t tail[MAX_THREAD_TAIL_FRAMES];
+
+    /** The total number of frames past @a head_limit. */
+    uint32_t tail_count;
+} plcrash_writer_thread_frames_t;
+
+/**
+ * @internal
+ *
+ * Initialize @a frames for writing a thread's stack.
+ *
+ * @param frames The state to initialize.
+ * @param file Output file, or NULL if the thread message is being sized.
+ * @param writer The writer context.
+ * @param memo If non-NULL, the memo in which frames will be recorded.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param frame_limit The maximum number of frames to be written.
+ */
+static void plcrash_writer_thread_frames_init (plcrash_writer_thread_frames_t *frames, plcrash_async_file_t *file, plcrash_log_writer_t *writer,
+                                               plcrash_writer_frame_memo_t *memo, plcrash_async_image_list_t *image_list,
+                                               plcrash_async_symbol_cache_t *findContext, uint32_t frame_limit)
+{
+    frames->file = file;
+    frames->writer = writer;
+    frames->memo = memo;
+    frames->image_list = image_list;
+    frames->findContext = findContext;
+    frames->size = 0;
+    frames->frame_count = 0;
+
+    /* Tail retention is only worthwhile if at least as many frames remain for the head of the stack */
+    frames->tail_limit = writer->tail_frames;
+    if (frames->tail_limit > frame_limit / 2)
+        frames->tail_limit = frame_limit / 2;
+    frames->head_limit = frame_limit - frames->tail_limit;
+
+    frames->run_length = 0;
+    frames->run_position = 0;
+    frames->run_repeats = 0;
+    frames->repeat_count = 0;
+    frames->tail_count = 0;
+}
+
+/**
+ * @internal
+ *
+ * Write (or record) a single frame, without applying the thread's frame limits.
+ *
+ * @param frames The thread's frame output state.
+ * @param pc The frame's PC.
+ */
+static void plcrash_writer_thread_frames_write (plcrash_writer_thread_frames_t *frames, uint64_t pc) {
+    plcrash_async_file_t *file = frames->file;
+    plcrash_log_writer_t *writer = frames->writer;
+    uint32_t frame_size;
+
+    if (frames->memo != NULL) {
+        /* Record the frame; the symbols of all recorded frames are resolved, and the frames sized, once the stack has
+         * been walked. See plcrash_writer_thread_frames_finish(). */
+        plcrash_writer_frame_memo_t *memo = frames->memo;
+        memo->frames[memo->frame_count].pc = pc;
+        memo->frames[memo->frame_count].symbol_name_offset = PLCRASH_WRITER_MEMO_SYMBOL_PENDING;
+        memo->frame_count++;
+    } else if (plcrash_writer_use_single_pass(file)) {
+        off_t position;
+
+        /* Write the message, backpatching the size */
+        frames->size += plcrash_writer_pack_deferred_length(file, PLCRASH_PROTO_THREAD_FRAMES_ID, &position);
+        frame_size = plcrash_writer_write_thread_frame(file, writer, pc, frames->image_list, frames->findContext);
+        plcrash_writer_pack_fixup_length(file, position, frame_size);
+        frames->size += frame_size;
+    } else {
+        /* Determine the size */
+        frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, frames->image_list, frames->findContext);
+
+        frames->size += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+        frames->size += plcrash_writer_write_thread_frame(file, writer, pc, frames->image_list, frames->findContext);
+    }
+
+    frames->history[frames->frame_count % MAX_FRAME_REPEAT_LENGTH] = pc;
+    frames->frame_count++;
+}
+
+/**
+ * @internal
+ *
+ * Write (or retain) a single frame, applying the thread's frame limits.
+ *
+ * @param frames The thread's frame output state.
+ * @param pc The frame's PC.
+ *
+ * @return Returns false if the frame limit has been reached, and no further frames will be accepted.
+ */
+static bool plcrash_writer_thread_frames_append (plcrash_writer_thread_frames_t *frames, uint64_t pc) {
+    if (frames->frame_count < frames->head_limit) {
+        plcrash_writer_thread_frames_write(frames, pc);
+        return true;
+    }
+
+    if (frames->tail_limit == 0)
+        return false;
+
+    frames->tail[frames->tail_count % frames->tail_limit] = pc;
+    frames->tail_count++;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Terminate the run currently being matched (if any), recording it as a collapsed run if at least one complete
+ * repetition was matched. Any frames of a partially matched repetition are then written.
+ *
+ * @param frames The thread's frame output state.
+ */
+static void plcrash_writer_thread_frames_end_run (plcrash_writer_thread_frames_t *frames) {
+    uint64_t pending[MAX_FRAME_REPEAT_LENGTH];
+    uint32_t length = frames->run_length;
+    uint32_t position = frames->run_position;
+
+    if (length == 0)
+        return;
+
+    if (frames->run_repeats > 0) {
+        plcrash_writer_frame_repeat_t *repeat = &frames->repeats[frames->repeat_count++];
+        repeat->frame_index = frames->frame_count - length;
+        repeat->frame_count = length;
+        repeat->repeat_count = frames->run_repeats;
+    }
+
+    /* The partially matched frames are a prefix of the run; fetch them before the history is overwritten */
+    for (uint32_t i = 0; i < position; i++)
+        pending[i] = frames->history[(frames->frame_count - length + i) % MAX_FRAME_REPEAT_LENGTH];
+
+    frames->run_length = 0;
+    frames->run_position = 0;
+    frames->run_repeats = 0;
+
+    for (uint32_t i = 0; i < position; i++)
+        plcrash_writer_thread_frames_append(frames, pending[i]);
+}
+
+/**
+ * @internal
+ *
+ * Handle the next frame of the thread's stack.
+ *
+ * @param frames The thread's frame output state.
+ * @param pc The frame's PC.
+ *
+ * @return Returns false if the frame limit has been reached, and no further frames will be accepted.
+ */
+static bool plcrash_writer_thread_frames_push (plcrash_writer_thread_frames_t *frames, uint64_t pc) {
+    /* Repeated runs are only collapsed when retaining the tail of the stack; otherwise, the written frames must
+     * remain readable as a complete backtrace. */
+    if (frames->tail_limit == 0 || frames->frame_count >= frames->head_limit)
+        return plcrash_writer_thread_frames_append(frames, pc);
+
+    /* Continue matching the current run */
+    if (frames->run_length > 0) {
+        uint32_t expected = frames->frame_count - frames->run_length + frames->run_position;
+        if (frames->history[expected % MAX_FRAME_REPEAT_LENGTH] == pc) {
+            if (++frames->run_position == frames->run_length) {
+                frames->run_position = 0;
+                frames->run_repeats++;
+            }
+            return true;
+        }
+
+        plcrash_writer_thread_frames_end_run(frames);
+        if (frames->frame_count >= frames->head_limit)
+            return plcrash_writer_thread_frames_append(frames, pc);
+    }
+
+    /* Look for the shortest run of recently written frames that this frame may be repeating */
+    if (frames->repeat_count < MAX_THREAD_FRAME_REPEATS) {
+        for (uint32_t length = 1; length <= MAX_FRAME_REPEAT_LENGTH && length <= frames->frame_count; length++) {
+            if (frames->history[(frames->frame_count - length) % MAX_FRAME_REPEAT_LENGTH] != pc)
+                continue;
+
+            frames->run_length = length;
+            frames->run_position = 1;
+            frames->run_repeats = 0;
+            if (frames->run_position == length) {
+                frames->run_position = 0;
+                frames->run_repeats = 1;
+            }
+            return true;
+        }
+    }
+
+    plcrash_writer_thread_frames_write(frames, pc);
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Write the thread message's summary of collapsed and omitted frames.
+ *
+ * @param file Output file
+ * @param repeats The collapsed runs.
+ * @param repeat_count The number of entries in @a repeats.
+ * @param omitted_frame_count The number of omitted frames, or 0.
+ * @param omitted_frame_index The index at which frames were omitted.
+ */
+static size_t plcrash_writer_write_thread_truncation (plcrash_async_file_t *file, plcrash_writer_frame_repeat_t *repeats, uint32_t repeat_count,
+                                                      uint32_t omitted_frame_count, uint32_t omitted_frame_index)
+{
+    size_t rv = 0;
+
+    for (uint32_t i = 0; i < repeat_count; i++) {
+        uint32_t size;
+
+        /* Determine the size */
+        size = (uint32_t) (plcrash_writer_varint_field_size(PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_INDEX_ID, repeats[i].frame_index) +
+                           plcrash_writer_varint_field_size(PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_COUNT_ID, repeats[i].frame_count) +
+                           plcrash_writer_varint_field_size(PLCRASH_PROTO_THREAD_FRAME_REPEAT_REPEAT_COUNT_ID, repeats[i].repeat_count));
+
+        /* Write the message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_REPEATS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_INDEX_ID, PLPROTOBUF_C_TYPE_UINT32, &repeats[i].frame_index);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_REPEAT_FRAME_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &repeats[i].frame_count);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_REPEAT_REPEAT_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &repeats[i].repeat_count);
+    }
+
+    if (omitted_frame_count > 0) {
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_OMITTED_FRAME_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &omitted_frame_count);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_OMITTED_FRAME_INDEX_ID, PLPROTOBUF_C_TYPE_UINT32, &omitted_frame_index);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Complete the thread's stack, writing the frames retained from the bottom of a truncated stack, followed by the
+ * summary of collapsed and omitted frames. If frames are being recorded, the recorded frames are symbolicated and
+ * sized, and the summary is recorded in the memo.
+ *
+ * @param frames The thread's frame output state.
+ */
+static void plcrash_writer_thread_frames_finish (plcrash_writer_thread_frames_t *frames) {
+    uint32_t omitted_frame_count = 0;
+    uint32_t omitted_frame_index = 0;
+
+    plcrash_writer_thread_frames_end_run(frames);
+
+    /* Write the retained tail, oldest first */
+    if (frames->tail_count > 0) {
+        uint32_t kept = frames->tail_count < frames->tail_limit ? frames->tail_count : frames->tail_limit;
+        uint32_t start = frames->tail_count - kept;
+
+        omitted_frame_count = start;
+        omitted_frame_index = frames->frame_count;
+
+        for (uint32_t i = 0; i < kept; i++)
+            plcrash_writer_thread_frames_write(frames, frames->tail[(start + i) % frames->tail_limit]);
+    }
+
+    if (frames->memo != NULL) {
+        plcrash_writer_frame_memo_t *memo = frames->memo;
+
+        /* Resolve the recorded frames' symbols in per-image batches, and size the frames */
+        if (!memo->resolve_deferred) {
+            plcrash_writer_frame_memo_resolve(memo, frames->writer, frames->image_list, frames->findContext);
+            frames->size += plcrash_writer_frame_memo_size(memo, frames->writer, frames->image_list, frames->findContext);
+        }
+
+        plcrash_async_memcpy(memo->repeats, frames->repeats, sizeof(frames->repeats[0]) * frames->repeat_count);
+        memo->repeat_count = frames->repeat_count;
+        memo->omitted_frame_count = omitted_frame_count;
+        memo->omitted_frame_index = omitted_frame_index;
+    }
+
+    frames->size += plcrash_writer_write_thread_truncation(frames->memo != NULL ? NULL : frames->file, frames->repeats, frames->repeat_count,
+                                                           omitted_frame_count, omitted_frame_index);
+}
+
+static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_log_signal_info_t *siginfo);
+
+/**
+ * @internal
+ *
+ * Return the writer's published secondary crash entry for @a thread, or NULL if @a thread is not a secondary crasher.
+ */
+static const plcrash_log_secondary_crash_t *plcrash_writer_secondary_crash (plcrash_log_writer_t *writer, thread_t thread) {
+    plcrash_log_secondary_crashes_t *crashes = writer->secondary_crashes;
+    if (crashes == NULL || thread == MACH_PORT_NULL)
+        return NULL;
+
+    int32_t count = crashes->claimed;
+    if (count > PLCRASH_LOG_MAX_SECONDARY_CRASHES)
+        count = PLCRASH_LOG_MAX_SECONDARY_CRASHES;
+
+    OSMemoryBarrier();
+    for (int32_t i = 0; i < count; i++) {
+        if (crashes->entries[i].thread == thread)
+            return &crashes->entries[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Write a thread message
+ *
+ * @param file Output file
+ * @param task The task in which @a thread is executing.
+ * @param thread Thread for which we'll output data.
+ * @param thread_number The thread's index number.
+ * @param thread_ctx Thread state to use for stack walking. If NULL, the thread state will be fetched from @a thread. If
+ * @a thread is the currently executing thread, <em>must</em> be non-NULL.
+ * @param stack_snapshot If non-NULL, a copy of @a thread's stack captured along with @a thread_ctx. The stack will be
+ * walked using the copy, in which case @a thread need not be suspended.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param crashed If true, mark this as a crashed thread.
+ * @param memo If non-NULL, the frame memo to be used. If @a file is NULL, the thread's frames will be recorded in @a memo
+ * as the stack is walked. If @a file is non-NULL and @a memo contains a recorded stack, the recorded frames will be
+ * written without walking the thread's stack.
+ * @param frame_limit The maximum number of frames to be written. Ignored when replaying a recorded stack.
+ * @param frames_written If non-NULL, will be set to the number of frames written.
+ */
+static size_t plcrash_writer_write_thread (plcrash_async_file_t *file,
+                                           plcrash_log_writer_t *writer,
+                                           task_t task,
+                                           thread_t thread,
+                                           uint32_t thread_number,
+                                           plcrash_async_thread_state_t *thread_ctx,
+                                           plcrash_writer_stack_snapshot_t *stack_snapshot,
+                                           plcrash_async_image_list_t *image_list,
+                                           plcrash_async_symbol_cache_t *findContext,
+                                           bool crashed,
+                                           plcrash_writer_frame_memo_t *memo,
+                                           uint32_t frame_limit,
+                                           uint32_t *frames_written)
+{
+    size_t rv = 0;
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+
+    /* Determine whether we're recording or replaying a memoized stack */
+    bool replay = (memo != NULL && file != NULL && memo->valid);
+    bool record = (memo != NULL && file == NULL);
+    if (memo != NULL) {
+        memo->valid = false;
+        memo->has_registers = false;
+        if (record) {
+            memo->frame_count = 0;
+            memo->names_length = 0;
+            memo->repeat_count = 0;
+            memo->omitted_frame_count = 0;
+            memo->omitted_frame_index = 0;
+            memo->packed = false;
+        }
+    }
+
+    if (frames_written != NULL)
+        *frames_written = 0;
+
+    /* A context must be supplied when walking the current thread */
+    PLCF_ASSERT(task != mach_task_self() || thread_ctx != NULL || thread != writer->self_thread);
+
+    /* Secondary crashers are written with their signal and registers */
+    const plcrash_log_secondary_crash_t *secondary = plcrash_writer_secondary_crash(writer, thread);
+
+    /* Write the required elements first; fatal errors may occur below, in which case we need to have
+     * written out required elements before returning. */
+    {
+        /* Write the thread ID */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
+
+        /* Note crashed status */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+
+        /* Note secondary crash status */
+        if (secondary != NULL) {
+            plcrash_log_bsd_signal_info_t bsd_info = secondary->bsd_info;
+            plcrash_log_signal_info_t siginfo = { .bsd_info = &bsd_info, .mach_info = NULL };
+            uint32_t size = (uint32_t) plcrash_writer_write_signal(NULL, &siginfo);
+
+            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_SECONDARY_CRASH_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            rv += plcrash_writer_write_signal(file, &siginfo);
+        }
+    }
+
+
+    /* Write out the stack frames. */
+    {
+        /* Set up the frame cursor. */
+        {            
+            /* Use the provided context if available, otherwise initialize a new thread context
+             * from the target thread's state. */
+            plcrash_async_thread_state_t cursor_thr_state;
+            if (thread_ctx) {
+                cursor_thr_state = *thread_ctx;
+            } else {
+                plcrash_async_thread_state_mach_thread_init(&cursor_thr_state, thread);
+            }
+
+            /* Initialize the cursor */
+            ferr = plframe_cursor_init(&cursor, task, &cursor_thr_state, image_list);
+            if (ferr != PLFRAME_ESUCCESS) {
+                PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
+                if (record)
+                    memo->valid = true;
+                return rv;
+            }
+
+            /* Read the stack from the snapshot, if any */
+            if (stack_snapshot != NULL)
+                plframe_cursor_set_stack_snapshot(&cursor, stack_snapshot->address, stack_snapshot->data, stack_snapshot->length);
+
+            /* Share evaluated DWARF unwind rules and decoded compact unwind entries across the report's threads */
+            if (writer->dwarf_cache != NULL)
+                plframe_cursor_set_dwarf_cache(&cursor, writer->dwarf_cache);
+
+            if (writer->compact_unwind_cache != NULL)
+                plframe_cursor_set_compact_unwind_cache(&cursor, writer->compact_unwind_cache);
+
+            /* Map each image's unwind sections once per report. The section cache is owned by the symbol-finding
+             * context, of which each unwind worker has its own. */
+            plframe_cursor_set_section_cache(&cursor, &findContext->section_cache);
+        }
+
+        /* Replay a previously recorded stack. The initialized (but unstepped) cursor is only used to write the
+         * registers of the first frame. */
+        if (replay) {
+            if (memo->has_registers)
+                rv += plcrash_writer_write_thread_registers(file, writer, task, &cursor, image_list);
+
+            if (memo->packed) {
+                rv += plcrash_writer_write_packed_frames(file, writer, memo, image_list);
+            } else {
+                for (uint32_t i = 0; i < memo->frame_count; i++) {
+                    uint32_t frame_size;
+
+                    /* Determine the size */
+                    frame_size = plcrash_writer_write_memo_frame(NULL, writer, memo, &memo->frames[i], image_list, findContext);
+
+                    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+                    rv += plcrash_writer_write_memo_frame(file, writer, memo, &memo->frames[i], image_list, findContext);
+                }
+            }
+            rv += plcrash_writer_write_thread_truncation(file, memo->repeats, memo->repeat_count, memo->omitted_frame_count, memo->omitted_frame_index);
+
+            if (frames_written != NULL)
+                *frames_written = memo->frame_count;
+
+            plframe_cursor_free(&cursor);
+            return rv;
+        }
+
+        /* Walk the stack, limiting the total number of frames that are output. */
+        plcrash_writer_thread_frames_t frames;
+        plcrash_writer_thread_frames_init(&frames, file, writer, record ? memo : NULL, image_list, findContext, frame_limit);
+
+        uint32_t walked = 0;
+        while (walked < MAX_THREAD_WALK_FRAMES && (ferr = plcrash_writer_cursor_next(&cursor, stack_snapshot != NULL || writer->frame_pointer_only, writer->stack_scan)) == PLFRAME_ESUCCESS) {
+            /* On the first frame, dump registers for the crashed thread, and any secondary crashers */
+            if (walked == 0 && (crashed || secondary != NULL)) {
+                rv += plcrash_writer_write_thread_registers(file, writer, task, &cursor, image_list);
+                if (record)
+                    memo->has_registers = true;
+            }
+            walked++;
+
+            /* Fetch the PC value */
+            plcrash_greg_t pc = 0;
+            if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
+                PLCF_DEBUG("Could not retrieve frame PC register: %s", plframe_strerror(ferr));
+                break;
+            }
+
+            /* Stop once no further frames will be written */
+            if (!plcrash_writer_thread_frames_push(&frames, pc))
+                break;
+        }
+
+        plcrash_writer_thread_frames_finish(&frames);
+        rv += frames.size;
+
+        if (frames_written != NULL)
+            *frames_written = frames.frame_count;
+
+        /* Did we reach the end successfully? */
+        if (ferr != PLFRAME_ENOFRAME) {
+            /* This is non-fatal, and in some circumstances -could- be caused by reaching the end of the stack if the
+             * final frame pointer is not NULL. */
+            PLCF_DEBUG("Terminated stack walking early: %s", plframe_strerror(ferr));
+        }
+    }
+
+    if (record)
+        memo->valid = true;
+
+    plframe_cursor_free(&cursor);
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a thread message for a thread whose stack is identical to that of a previously written thread.
+ *
+ * @param file Output file
+ * @param thread_number The thread's index number.
+ * @param crashed If true, mark this as a crashed thread.
+ * @param duplicate_of The number of the previously written thread with an identical stack.
+ */
+static size_t plcrash_writer_write_duplicate_thread (plcrash_async_file_t *file, uint32_t thread_number, bool crashed, uint32_t duplicate_of) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_DUPLICATE_OF_THREAD_ID, PLPROTOBUF_C_TYPE_UINT32, &duplicate_of);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * A cached dispatch queue label.
+ */
+typedef struct plcrash_writer_queue_label {
+    /** The queue's address within the target task. */
+    pl_vm_address_t queue;
+
+    /** The queue's NUL-terminated label, or an empty string if the queue has no label or it could not be read. */
+    char label[MAX_QUEUE_LABEL_LENGTH];
+} plcrash_writer_queue_label_t;
+
+/**
+ * @internal
+ *
+ * The dispatch queue labels read while writing a report, keyed by queue address. Many threads typically service the
+ * same few queues; each queue's label is read from the target only once.
+ */
+typedef struct plcrash_writer_queue_table {
+    /** The cached labels. */
+    plcrash_writer_queue_label_t labels[MAX_CACHED_QUEUE_LABELS];
+
+    /** The number of entries in @a labels. */
+    uint32_t count;
+
+    /** Storage for a label read once the cache is full. */
+    plcrash_writer_queue_label_t overflow;
+} plcrash_writer_queue_table_t;
+
+/**
+ * @internal
+ *
+ * Read the NUL-terminated string at @a address in @a task into @a buffer, truncating it to fit. The string is read a page
+ * at a time, such that a string ending near the end of a mapping may be read in full.
+ *
+ * @return Returns true if a (possibly truncated) string was read.
+ */
+static bool plcrash_writer_read_string (task_t task, pl_vm_address_t address, char *buffer, size_t size) {
+    size_t length = 0;
+
+    while (length < size - 1) {
+        size_t chunk = PAGE_SIZE - ((address + length) % PAGE_SIZE);
+        if (chunk > size - 1 - length)
+            chunk = size - 1 - length;
+
+        if (plcrash_async_task_memcpy(task, address, length, buffer + length, chunk) != PLCRASH_ESUCCESS)
+            break;
+
+        for (size_t i = 0; i < chunk; i++) {
+            if (buffer[length + i] == '\0')
+                return true;
+        }
+
+        length += chunk;
+    }
+
+    buffer[length] = '\0';
+    return length > 0;
+}
+
+/**
+ * @internal
+ *
+ * Return the label of the dispatch queue that @a thread is currently servicing, or NULL if the thread is not servicing a
+ * queue, the queue has no label, or the label can not be read. Labels are cached in the report's queue table; the
+ * returned string remains valid until the next call.
+ *
+ * @param writer The writer context.
+ * @param task The task containing @a thread.
+ * @param thread The thread.
+ */
+static const char *plcrash_writer_queue_label (plcrash_log_writer_t *writer, task_t task, thread_t thread) {
+    plcrash_writer_queue_table_t *table = writer->queue_table;
+    if (table == NULL || &plcrash_dispatch_queue_offsets == NULL || plcrash_dispatch_queue_offsets.dqo_label == 0)
+        return NULL;
+
+    /* Fetch the address of the thread's current queue pointer */
+    thread_identifier_info_data_t ident;
+    mach_msg_type_number_t ident_count = THREAD_IDENTIFIER_INFO_COUNT;
+    if (thread_info(thread, THREAD_IDENTIFIER_INFO, (thread_info_t) &ident, &ident_count) != KERN_SUCCESS || ident.dispatch_qaddr == 0)
+        return NULL;
+
+    uintptr_t queue;
+    if (plcrash_async_task_memcpy(task, (pl_vm_address_t) ident.dispatch_qaddr, 0, &queue, sizeof(queue)) != PLCRASH_ESUCCESS || queue == 0)
+        return NULL;
+
+    /* Use the cached label, if any */
+    for (uint32_t i = 0; i < table->count; i++) {
+        if (table->labels[i].queue == queue)
+            return table->labels[i].label[0] != '\0' ? table->labels[i].label : NULL;
+    }
+
+    plcrash_writer_queue_label_t *entry = &table->overflow;
+    if (table->count < MAX_CACHED_QUEUE_LABELS)
+        entry = &table->labels[table->count++];
+
+    entry->queue = queue;
+    entry->label[0] = '\0';
+
+    /* Read the label; failures are cached as an empty label */
+    uintptr_t label;
+    if (plcrash_async_task_memcpy(task, (pl_vm_address_t) queue, plcrash_dispatch_queue_offsets.dqo_label, &label, sizeof(label)) != PLCRASH_ESUCCESS || label == 0)
+        return NULL;
+
+    if (!plcrash_writer_read_string(task, (pl_vm_address_t) label, entry->label, sizeof(entry->label)))
+        return NULL;
+
+    return entry->label;
+}
+
+/**
+ * @internal
+ *
+ * Write a thread's dispatch queue label field. This is written following the remainder of the thread message, allowing
+ * thread messages sized by the unwind workers to be extended by the label's size.
+ *
+ * @param file Output file, or NULL to determine the field size.
+ * @param label The queue label, or NULL.
+ */
+static size_t plcrash_writer_write_queue_label (plcrash_async_file_t *file, const char *label) {
+    if (label == NULL)
+        return 0;
+
+    return plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_DISPATCH_QUEUE_LABEL_ID, PLPROTOBUF_C_TYPE_STRING, label);
+}
+
+#pragma mark Parallel Unwinding
+
+/**
+ * @internal
+ *
+ * The target's thread states, captured once while the threads are suspended. All subsequent passes over a thread --
+ * sizing and writing its message, snapshotting its stack, and capturing its memory -- use the captured state, rather
+ * than fetching the state from the thread again.
+ *
+ * The states are held as packed plcrash_async_thread_snapshot_t records, rather than as full thread states.
+ */
+typedef struct plcrash_writer_captured_states {
+    /** One snapshot per thread, indexed as the target's threads, or NULL if no states were captured. A snapshot with
+     * no valid registers was not captured. */
+    uint8_t *snapshots;
+
+    /** The size of each snapshot, in bytes. */
+    size_t stride;
+} plcrash_writer_captured_states_t;
+
+/**
+ * @internal
+ *
+ * Return the captured state of the thread at @a index, or NULL if the thread's state was not captured.
+ *
+ * @param states The captured states, or NULL.
+ * @param index The thread's index within the target's threads.
+ */
+static const plcrash_async_thread_snapshot_t *plcrash_writer_captured_state (const plcrash_writer_captured_states_t *states, mach_msg_type_number_t index) {
+    if (states == NULL || states->snapshots == NULL)
+        return NULL;
+
+    const plcrash_async_thread_snapshot_t *snapshot = (const plcrash_async_thread_snapshot_t *) (states->snapshots + states->stride * index);
+    if (snapshot->valid_regs == 0)
+        return NULL;
+
+    return snapshot;
+}
+
+/**
+ * @internal
+ *
+ * A thread to be written to the report, along with its memoized stack if the thread was unwound by an unwind worker.
+ */
+typedef struct plcrash_writer_thread_job {
+    /** The target thread. */
+    thread_t thread;
+
+    /** The thread's index number. */
+    uint32_t thread_number;
+
+    /** Thread state to use for stack walking, or NULL. See plcrash_writer_write_thread(). */
+    plcrash_async_thread_state_t *thread_ctx;
+
+    /** If true, this is the crashed thread. */
+    bool crashed;
+
+    /** If true, this thread crashed concurrently with the crashed thread. See plcrash_log_writer_set_secondary_crashes(). */
+    bool secondary;
+
+    /** The thread's state as captured prior to the thread being resumed. Only valid if @a thread_ctx references it. */
+    plcrash_async_thread_state_t snapshot_state;
+
+    /** A copy of the thread's stack captured prior to the thread being resumed, or NULL. */
+    plcrash_writer_stack_snapshot_t *stack_snapshot;
+
+    /** Backing storage for @a stack_snapshot. */
+    plcrash_writer_stack_snapshot_t stack_snapshot_storage;
+
+    /** If true, the thread's stack has been recorded in @a memo, and the thread message's size is available via @a size. */
+    bool recorded;
+
+    /** The thread message's size. Only valid if @a recorded is true. */
+    uint32_t size;
+
+    /** The thread's recorded stack. Only valid if @a recorded is true. */
+    plcrash_writer_frame_memo_t memo;
+} plcrash_writer_thread_job_t;
+
+/**
+ * @internal
+ * Sentinel pushed to a plcrash_writer_job_ring_t once all jobs have been pushed.
+ */
+#define PLCRASH_WRITER_JOB_RING_END UINT32_MAX
+
+/**
+ * @internal
+ *
+ * A bounded, single-producer/single-consumer queue of job indices, used to hand jobs between the stages of a
+ * pipelined unwind pool.
+ */
+typedef struct plcrash_writer_job_ring {
+    /** Lock guarding all ring state. */
+    pthread_mutex_t lock;
+
+    /** Signaled when a job index is pushed or popped. */
+    pthread_cond_t cond;
+
+    /** The queued job indices. */
+    uint32_t slots[PIPELINE_DEPTH];
+
+    /** The total number of job indices popped from the ring. */
+    uint32_t head;
+
+    /** The total number of job indices pushed to the ring. */
+    uint32_t tail;
+} plcrash_writer_job_ring_t;
+
+/**
+ * @internal
+ *
+ * Initialize an empty @a ring. The ring must be destroyed via plcrash_writer_job_ring_destroy().
+ */
+static void plcrash_writer_job_ring_init (plcrash_writer_job_ring_t *ring) {
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * @internal
+ *
+ * Destroy @a ring.
+ */
+static void plcrash_writer_job_ring_destroy (plcrash_writer_job_ring_t *ring) {
+    pthread_cond_destroy(&ring->cond);
+    pthread_mutex_destroy(&ring->lock);
+}
+
+/**
+ * @internal
+ *
+ * Push @a job_index to @a ring, blocking while the ring is full.
+ *
+ * @param ring The ring to push to.
+ * @param job_index The job index, or PLCRASH_WRITER_JOB_RING_END.
+ */
+static void plcrash_writer_job_ring_push (plcrash_writer_job_ring_t *ring, uint32_t job_index) {
+    pthread_mutex_lock(&ring->lock); {
+        while (ring->tail - ring->head == PIPELINE_DEPTH)
+            pthread_cond_wait(&ring->cond, &ring->lock);
+
+        ring->slots[ring->tail % PIPELINE_DEPTH] = job_index;
+        ring->tail++;
+        pthread_cond_broadcast(&ring->cond);
+    } pthread_mutex_unlock(&ring->lock);
+}
+
+/**
+ * @internal
+ *
+ * Pop the next job index from @a ring, blocking while the ring is empty.
+ *
+ * @param ring The ring to pop from.
+ *
+ * @return Returns the job index, or PLCRASH_WRITER_JOB_RING_END.
+ */
+static uint32_t plcrash_writer_job_ring_pop (plcrash_writer_job_ring_t *ring) {
+    uint32_t job_index;
+
+    pthread_mutex_lock(&ring->lock); {
+        while (ring->tail == ring->head)
+            pthread_cond_wait(&ring->cond, &ring->lock);
+
+        job_index = ring->slots[ring->head % PIPELINE_DEPTH];
+        ring->head++;
+        pthread_cond_broadcast(&ring->cond);
+    } pthread_mutex_unlock(&ring->lock);
+
+    return job_index;
+}
+
+typedef struct plcrash_writer_unwind_pool plcrash_writer_unwind_pool_t;
+
+/**
+ * @internal
+ *
+ * An unwind worker thread.
+ */
+typedef struct plcrash_writer_unwind_worker {
+    /** The pool to which this worker belongs. */
+    plcrash_writer_unwind_pool_t *pool;
+
+    /** The worker's pthread. */
+    pthread_t pthread;
+
+    /** The worker's mach thread. */
+    thread_t mach_thread;
+
+    /** The allocator from which this worker's frame memos are allocated. */
+    plcrash_async_allocator_t *allocator;
+
+    /** The worker's symbol lookup cache. */
+    plcrash_async_symbol_cache_t cache;
+} plcrash_writer_unwind_worker_t;
+
+/**
+ * @internal
+ *
+ * A pool of worker threads used to unwind and symbolicate thread stacks in parallel.
+ *
+ * If pipelined, the pool instead consists of exactly two workers: an unwind stage, which unwinds the dispatched jobs
+ * in order, and a symbolication stage, which symbolicates and sizes each job once unwound. Completed jobs are consumed
+ * by the writing thread via plcrash_writer_unwind_pool_await(), allowing each thread to be written as soon as its stack
+ * is available.
+ *
+ * The workers must be started prior to suspending the target threads, as pthread_create() may otherwise block on
+ * a lock held by a suspended thread. Once started, the workers block until jobs are dispatched via
+ * plcrash_writer_unwind_pool_dispatch().
+ */
+struct plcrash_writer_unwind_pool {
+    /** Lock guarding @a ready. */
+    pthread_mutex_t lock;
+
+    /** Signaled when @a ready is set. */
+    pthread_cond_t cond;
+
+    /** Set once @a jobs has been dispatched. */
+    bool ready;
+
+    /** The writer context. */
+    plcrash_log_writer_t *writer;
+
+    /** The Mach-O image list. */
+    plcrash_async_image_list_t *image_list;
+
+    /** The dispatched jobs. */
+    plcrash_writer_thread_job_t *jobs;
+
+    /** The number of dispatched jobs. */
+    uint32_t job_count;
+
+    /** The index of the next unclaimed job. */
+    volatile int32_t next_job;
+
+    /** The started workers. */
+    plcrash_writer_unwind_worker_t workers[PLCRASH_WRITER_MAX_UNWIND_WORKERS];
+
+    /** The number of started workers. */
+    uint32_t worker_count;
+
+    /** If true, the workers are the stages of a pipeline, and the fields below are used. */
+    bool pipelined;
+
+    /** Jobs unwound by the unwind stage, pending symbolication. */
+    plcrash_writer_job_ring_t unwound;
+
+    /** Jobs symbolicated by the symbolication stage, pending receipt by the writing thread. */
+    plcrash_writer_job_ring_t symbolicated;
+
+    /** The number of completed jobs received by the writing thread. Jobs complete in order. */
+    uint32_t received;
+
+    /** Set once the writing thread has received the end of the pipeline's output, and the workers have been joined. */
+    bool finished;
+};
+
+/**
+ * @internal
+ *
+ * Unwind worker entry point. Waits for jobs to be dispatched, and then records the stacks of unclaimed jobs until
+ * all jobs have been claimed.
+ *
+ * @param arg The worker's plcrash_writer_unwind_worker_t.
+ */
+static void *plcrash_writer_unwind_worker_main (void *arg) {
+    plcrash_writer_unwind_worker_t *worker = arg;
+    plcrash_writer_unwind_pool_t *pool = worker->pool;
+    int32_t idx;
+
+    /* Wait for dispatch */
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->ready)
+        pthread_cond_wait(&pool->cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    while ((idx = OSAtomicIncrement32Barrier(&pool->next_job) - 1) < (int32_t) pool->job_count) {
+        plcrash_writer_thread_job_t *job = &pool->jobs[idx];
+        plcrash_error_t err;
+
+        /* If no memo can be allocated, the thread will be unwound serially when written */
+        if ((err = plcrash_writer_frame_memo_init(&job->memo, worker->allocator, MAX_PARALLEL_MEMOIZED_SYMBOL_BYTES)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not allocate frame memo for thread %" PRIu32 ": %d", job->thread_number, err);
+            continue;
+        }
+
+        job->size = (uint32_t) plcrash_writer_write_thread(NULL, pool->writer, pool->writer->task, job->thread, job->thread_number,
+                                                           job->thread_ctx, job->stack_snapshot, pool->image_list, &worker->cache, job->crashed, &job->memo,
+                                                           pool->writer->max_thread_frames, NULL);
+        job->recorded = job->memo.valid;
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Pipeline unwind stage entry point. Waits for jobs to be dispatched, and then records the stacks of all jobs in
+ * order, deferring symbolication of the recorded frames to the symbolication stage.
+ *
+ * @param arg The worker's plcrash_writer_unwind_worker_t.
+ */
+static void *plcrash_writer_unwind_stage_main (void *arg) {
+    plcrash_writer_unwind_worker_t *worker = arg;
+    plcrash_writer_unwind_pool_t *pool = worker->pool;
+
+    /* Wait for dispatch */
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->ready)
+        pthread_cond_wait(&pool->cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (uint32_t idx = 0; idx < pool->job_count; idx++) {
+        plcrash_writer_thread_job_t *job = &pool->jobs[idx];
+        plcrash_error_t err;
+
+        /* If no memo can be allocated, the thread will be unwound serially when written */
+        if ((err = plcrash_writer_frame_memo_init(&job->memo, worker->allocator, MAX_PARALLEL_MEMOIZED_SYMBOL_BYTES)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not allocate frame memo for thread %" PRIu32 ": %d", job->thread_number, err);
+            job->memo.valid = false;
+        } else {
+            job->memo.resolve_deferred = true;
+            job->size = (uint32_t) plcrash_writer_write_thread(NULL, pool->writer, pool->writer->task, job->thread, job->thread_number,
+                                                               job->thread_ctx, job->stack_snapshot, pool->image_list, &worker->cache, job->crashed,
+                                                               &job->memo, pool->writer->max_thread_frames, NULL);
+        }
+
+        plcrash_writer_job_ring_push(&pool->unwound, idx);
+    }
+
+    plcrash_writer_job_ring_push(&pool->unwound, PLCRASH_WRITER_JOB_RING_END);
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Pipeline symbolication stage entry point. Symbolicates and sizes the frames of each job received from the unwind
+ * stage, and then hands the job to the writing thread.
+ *
+ * @param arg The worker's plcrash_writer_unwind_worker_t.
+ */
+static void *plcrash_writer_symbolication_stage_main (void *arg) {
+    plcrash_writer_unwind_worker_t *worker = arg;
+    plcrash_writer_unwind_pool_t *pool = worker->pool;
+    uint32_t idx;
+
+    while ((idx = plcrash_writer_job_ring_pop(&pool->unwound)) != PLCRASH_WRITER_JOB_RING_END) {
+        plcrash_writer_thread_job_t *job = &pool->jobs[idx];
+
+        if (job->memo.valid) {
+            plcrash_writer_frame_memo_resolve(&job->memo, pool->writer, pool->image_list, &worker->cache);
+            job->size += (uint32_t) plcrash_writer_frame_memo_size(&job->memo, pool->writer, pool->image_list, &worker->cache);
+            job->memo.resolve_deferred = false;
+        }
+        job->recorded = job->memo.valid;
+
+        plcrash_writer_job_ring_push(&pool->symbolicated, idx);
+    }
+
+    plcrash_writer_job_ring_push(&pool->symbolicated, PLCRASH_WRITER_JOB_RING_END);
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Allocate a new unwind pool from @a writer's allocator, and start up to @a worker_count workers.
+ *
+ * @param result On success, will be set to the new pool. The pool must be released via plcrash_writer_unwind_pool_free().
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list. This is a borrowed reference, and must remain valid for the lifetime of the pool.
+ * @param worker_count The number of workers to start. Ignored if @a pipelined is true.
+ * @param pipelined If true, start the two stages of a pipelined pool.
+ *
+ * @return Returns PLCRASH_ESUCCESS if at least one worker (or, if pipelined, both stages) was started, or an error code
+ * on failure.
+ *
+ * @warning This function is not async-safe.
+ */
+static plcrash_error_t plcrash_writer_unwind_pool_new (plcrash_writer_unwind_pool_t **result, plcrash_log_writer_t *writer,
+                                                       plcrash_async_image_list_t *image_list, uint32_t worker_count, bool pipelined)
+{
+    plcrash_writer_unwind_pool_t *pool;
+    plcrash_error_t err;
+    void *buf;
+
+    if ((err = plcrash_async_allocator_alloc(writer->allocator, &buf, sizeof(*pool))) != PLCRASH_ESUCCESS)
+        return err;
+
+    pool = buf;
+    pool->ready = false;
+    pool->writer = writer;
+    pool->image_list = image_list;
+    pool->jobs = NULL;
+    pool->job_count = 0;
+    pool->next_job = 0;
+    pool->worker_count = 0;
+    pool->pipelined = pipelined;
+    pool->received = 0;
+    pool->finished = !pipelined;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    if (pipelined) {
+        plcrash_writer_job_ring_init(&pool->unwound);
+        plcrash_writer_job_ring_init(&pool->symbolicated);
+        worker_count = 2;
+    }
+
+    /* Start the workers; if a worker can't be started, we proceed with those already running */
+    for (uint32_t i = 0; i < worker_count && i < PLCRASH_WRITER_MAX_UNWIND_WORKERS; i++) {
+        plcrash_writer_unwind_worker_t *worker = &pool->workers[pool->worker_count];
+        worker->pool = pool;
+
+        if ((err = plcrash_async_magazine_allocator_create(&worker->allocator, UNWIND_WORKER_ALLOCATOR_SIZE)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not create unwind worker allocator: %d", err);
+            break;
+        }
+
+        if ((err = plcrash_async_symbol_cache_init(&worker->cache)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not initialize unwind worker symbol cache: %d", err);
+            plcrash_async_allocator_free(worker->allocator);
+            break;
+        }
+        plcrash_async_symbol_cache_set_shared_cache(&worker->cache, writer->shared_cache_info);
+        plcrash_async_symbol_cache_set_budget(&worker->cache, &writer->cache_budget);
+
+        void *(*entry)(void *) = plcrash_writer_unwind_worker_main;
+        if (pipelined)
+            entry = (i == 0) ? plcrash_writer_unwind_stage_main : plcrash_writer_symbolication_stage_main;
+
+        if (pthread_create(&worker->pthread, NULL, entry, worker) != 0) {
+            PLCF_DEBUG("Could not start unwind worker: %s", strerror(errno));
+            plcrash_async_symbol_cache_free(&worker->cache);
+            plcrash_async_allocator_free(worker->allocator);
+            break;
+        }
+
+        worker->mach_thread = pthread_mach_thread_np(worker->pthread);
+        pool->worker_count++;
+    }
+
+    /* A pipeline requires both stages; if only the unwind stage was started, shut it down with an empty job list */
+    if (pipelined && pool->worker_count == 1) {
+        pthread_mutex_lock(&pool->lock); {
+            pool->ready = true;
+            pthread_cond_broadcast(&pool->cond);
+        } pthread_mutex_unlock(&pool->lock);
+
+        pthread_join(pool->workers[0].pthread, NULL);
+        plcrash_async_symbol_cache_free(&pool->workers[0].cache);
+        plcrash_async_allocator_free(pool->workers[0].allocator);
+        pool->worker_count = 0;
+    }
+
+    if (pool->worker_count == 0) {
+        if (pipelined) {
+            plcrash_writer_job_ring_destroy(&pool->unwound);
+            plcrash_writer_job_ring_destroy(&pool->symbolicated);
+        }
+        pthread_cond_destroy(&pool->cond);
+        pthread_mutex_destroy(&pool->lock);
+        plcrash_async_allocator_dealloc(writer->allocator, pool);
+        return PLCRASH_EINTERNAL;
+    }
+
+    *result = pool;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a thread is one of @a pool's workers.
+ *
+ * @param pool The unwind pool, or NULL.
+ * @param thread The thread to check.
+ */
+static bool plcrash_writer_unwind_pool_contains_thread (plcrash_writer_unwind_pool_t *pool, thread_t thread) {
+    if (pool == NULL)
+        return false;
+
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        if (pool->workers[i].mach_thread == thread)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Dispatch @a jobs to @a pool's workers. This must be called exactly once; to shut down the pool without
+ * performing any work, a @a job_count of 0 may be provided.
+ *
+ * @param pool The unwind pool.
+ * @param jobs The jobs to be executed. The array must remain valid until plcrash_writer_unwind_pool_join() returns.
+ * @param job_count The number of jobs in @a jobs.
+ */
+static void plcrash_writer_unwind_pool_dispatch (plcrash_writer_unwind_pool_t *pool, plcrash_writer_thread_job_t *jobs, uint32_t job_count) {
+    pthread_mutex_lock(&pool->lock); {
+        pool->jobs = jobs;
+        pool->job_count = job_count;
+        pool->ready = true;
+        pthread_cond_broadcast(&pool->cond);
+    } pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @internal
+ *
+ * Wait for all of @a pool's workers to complete the dispatched jobs and exit.
+ *
+ * @param pool The unwind pool, to which jobs have been dispatched via plcrash_writer_unwind_pool_dispatch().
+ */
+static void plcrash_writer_unwind_pool_join (plcrash_writer_unwind_pool_t *pool) {
+    for (uint32_t i = 0; i < pool->worker_count; i++)
+        pthread_join(pool->workers[i].pthread, NULL);
+}
+
+/**
+ * @internal
+ *
+ * Wait for a pipelined @a pool to complete the job at @a job_index. Jobs complete in order; on return, all jobs up to
+ * and including @a job_index have been completed. If @a pool is not pipelined, or has been finished via
+ * plcrash_writer_unwind_pool_finish(), all jobs have already been completed, and this is a no-op. This is also a no-op
+ * if no jobs have been dispatched.
+ *
+ * @param pool The unwind pool, to which jobs have been dispatched via plcrash_writer_unwind_pool_dispatch(), or NULL.
+ * @param job_index The index of the job to wait for.
+ */
+static void plcrash_writer_unwind_pool_await (plcrash_writer_unwind_pool_t *pool, uint32_t job_index) {
+    /* Prior to dispatch, the workers are idle and the pool has nothing to wait for */
+    if (pool == NULL || pool->finished || !pool->ready)
+        return;
+
+    while (pool->received <= job_index) {
+        if (plcrash_writer_job_ring_pop(&pool->symbolicated) == PLCRASH_WRITER_JOB_RING_END) {
+            plcrash_writer_unwind_pool_join(pool);
+            pool->finished = true;
+            return;
+        }
+        pool->received++;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Wait for a pipelined @a pool to complete all dispatched jobs, and join its workers. Once finished, the workers no
+ * longer access the writer, and the writer's configuration may be safely modified. If @a pool is not pipelined, this
+ * is a no-op.
+ *
+ * @param pool The unwind pool, to which jobs have been dispatched via plcrash_writer_unwind_pool_dispatch(), or NULL.
+ */
+static void plcrash_writer_unwind_pool_finish (plcrash_writer_unwind_pool_t *pool) {
+    plcrash_writer_unwind_pool_await(pool, UINT32_MAX);
+}
+
+/**
+ * @internal
+ *
+ * Free @a pool, including all frame memos allocated by its workers.
+ *
+ * @param pool The unwind pool to free. The pool must have been joined via plcrash_writer_unwind_pool_join() or, if
+ * pipelined, finished via plcrash_writer_unwind_pool_finish().
+ */
+static void plcrash_writer_unwind_pool_free (plcrash_writer_unwind_pool_t *pool) {
+    plcrash_log_writer_t *writer = pool->writer;
+
+    for (uint32_t i = 0; i < pool->worker_count; i++) {
+        plcrash_async_symbol_cache_free(&pool->workers[i].cache);
+        plcrash_async_allocator_free(pool->workers[i].allocator);
+    }
+
+    if (pool->pipelined) {
+        plcrash_writer_job_ring_destroy(&pool->unwound);
+        plcrash_writer_job_ring_destroy(&pool->symbolicated);
+    }
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    plcrash_async_allocator_dealloc(writer->allocator, pool);
+}
+
+/**
+ * @internal
+ * Threads currently writing a report via a writer configured with plcrash_log_writer_set_concurrent(), along with
+ * their unwind workers. Unused slots are MACH_PORT_NULL.
+ */
+static volatile thread_t concurrent_writer_threads[MAX_CONCURRENT_WRITER_THREADS];
+
+/**
+ * @internal
+ *
+ * Register or unregister @a thread as a concurrent writer thread.
+ *
+ * @param thread The thread to register or unregister.
+ * @param registered If true, register @a thread; otherwise, unregister it.
+ */
+static void plcrash_writer_concurrent_set_registered (thread_t thread, bool registered) {
+    thread_t from = registered ? MACH_PORT_NULL : thread;
+    thread_t to = registered ? thread : MACH_PORT_NULL;
+
+    for (uint32_t i = 0; i < MAX_CONCURRENT_WRITER_THREADS; i++) {
+        if (OSAtomicCompareAndSwap32Barrier((int32_t) from, (int32_t) to, (volatile int32_t *) &concurrent_writer_threads[i]))
+            return;
+    }
+
+    if (registered)
+        PLCF_DEBUG("Concurrent writer registry is full; thread %u may be suspended by other writers", (unsigned int) thread);
+}
+
+/**
+ * @internal
+ *
+ * Register or unregister the current thread and @a pool's workers as concurrent writer threads.
+ *
+ * @param self The current thread.
+ * @param pool The unwind pool, or NULL.
+ * @param registered If true, register the threads; otherwise, unregister them.
+ */
+static void plcrash_writer_concurrent_set_threads_registered (thread_t self, plcrash_writer_unwind_pool_t *pool, bool registered) {
+    plcrash_writer_concurrent_set_registered(self, registered);
+
+    for (uint32_t i = 0; pool != NULL && i < pool->worker_count; i++)
+        plcrash_writer_concurrent_set_registered(pool->workers[i].mach_thread, registered);
+}
+
+/**
+ * @internal
+ *
+ * Remove the threads registered by concurrent writers from @a threads, releasing their port references. The
+ * registry is consulted once per thread, and the result applies to the remainder of the report.
+ *
+ * @param threads The thread array, as returned by task_threads().
+ * @param thread_count The number of entries in @a threads.
+ * @param keep A thread that will not be removed, even if registered, or MACH_PORT_NULL.
+ * @param self The current thread, which is never removed.
+ *
+ * @return Returns the number of threads remaining in @a threads.
+ */
+static mach_msg_type_number_t plcrash_writer_omit_concurrent_threads (thread_act_array_t threads, mach_msg_type_number_t thread_count, thread_t keep, thread_t self) {
+    mach_msg_type_number_t selected = 0;
+
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        bool omit = false;
+        if (threads[i] != keep && threads[i] != self) {
+            for (uint32_t j = 0; j < MAX_CONCURRENT_WRITER_THREADS && !omit; j++)
+                omit = (concurrent_writer_threads[j] == threads[i]);
+        }
+
+        if (omit) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        } else {
+            threads[selected++] = threads[i];
+        }
+    }
+
+    return selected;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a thread will be written to the report, and assigned a thread number. Thread numbers are assigned
+ * sequentially to the written threads, in the order of the target's threads.
+ *
+ * @param writer The writer.
+ * @param thread The target thread.
+ * @param current_state The current thread's state, or NULL. See plcrash_log_writer_write().
+ * @param pool The unwind pool, or NULL.
+ */
+static bool plcrash_writer_thread_is_written (plcrash_log_writer_t *writer, thread_t thread, plcrash_async_thread_state_t *current_state, plcrash_writer_unwind_pool_t *pool) {
+    /* Our unwind workers are not part of the target's state */
+    if (plcrash_writer_unwind_pool_contains_thread(pool, thread))
+        return false;
+
+    /* Can't log a report for the current thread without a valid context. */
+    if (writer->self_thread == thread && current_state == NULL)
+        return false;
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Initialize @a job for @a thread.
+ *
+ * @param job The job to initialize.
+ * @param writer The writer.
+ * @param thread The target thread.
+ * @param thread_number The thread's index number.
+ * @param crashed_thread The crashed thread.
+ * @param current_state The current thread's state, or NULL. See plcrash_log_writer_write().
+ * @param captured_state The thread's captured state, or NULL. If provided, the state will be restored to the job and
+ * used in place of fetching the thread's state.
+ * @param pool The unwind pool, or NULL.
+ *
+ * @return Returns false if @a thread should not be written to the report.
+ */
+static bool plcrash_writer_thread_job_init (plcrash_writer_thread_job_t *job, plcrash_log_writer_t *writer, thread_t thread, uint32_t thread_number, thread_t crashed_thread,
+                                            plcrash_async_thread_state_t *current_state, const plcrash_async_thread_snapshot_t *captured_state,
+                                            plcrash_writer_unwind_pool_t *pool)
+{
+    job->thread = thread;
+    job->thread_number = thread_number;
+    job->thread_ctx = NULL;
+    job->crashed = false;
+    job->secondary = false;
+    job->stack_snapshot = NULL;
+    job->recorded = false;
+    job->size = 0;
+
+    const plcrash_log_secondary_crash_t *secondary;
+
+    if (!plcrash_writer_thread_is_written(writer, thread, current_state, pool))
+        return false;
+
+    /* If executing on the target thread, we need to a valid context to walk */
+    if (writer->self_thread == thread) {
+        job->thread_ctx = current_state;
+    } else if ((secondary = plcrash_writer_secondary_crash(writer, thread)) != NULL) {
+        /* Walk a secondary crasher from the state at which it crashed, rather than from its signal handler */
+        plcrash_async_thread_state_copy(&job->snapshot_state, &secondary->thread_state);
+        job->thread_ctx = &job->snapshot_state;
+        job->secondary = true;
+    } else if (captured_state != NULL && plcrash_async_thread_snapshot_restore(captured_state, &job->snapshot_state) == PLCRASH_ESUCCESS) {
+        job->thread_ctx = &job->snapshot_state;
+    }
+
+    /* Check if this is the crashed thread */
+    if (crashed_thread == thread)
+        job->crashed = true;
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * The number of varint fields in each thread metadata record: thread_number, user_time_ns, system_time_ns, cpu_usage,
+ * policy, run_state, flags, sleep_time, current_priority, base_priority, max_priority.
+ */
+#define PLCRASH_WRITER_THREAD_METADATA_FIELDS 11
+
+/**
+ * @internal
+ *
+ * The threads' scheduling state and CPU usage, gathered while the threads are suspended and held in its encoded form.
+ * See plcrash_log_writer_set_thread_metadata().
+ */
+typedef struct plcrash_writer_thread_metadata {
+    /** The packed records, or NULL if no metadata was gathered. */
+    uint8_t *records;
+
+    /** The number of bytes in @a records. */
+    size_t size;
+} plcrash_writer_thread_metadata_t;
+
+/**
+ * @internal
+ *
+ * Gather the scheduling state and CPU usage of the target's threads, encoding a record for each thread to be written.
+ * THREAD_EXTENDED_INFO is preferred, as it provides the threads' CPU times in nanoseconds along with their priorities;
+ * if unavailable, THREAD_BASIC_INFO is used.
+ *
+ * @param metadata The metadata to be populated.
+ * @param writer The writer context.
+ * @param threads The target's threads.
+ * @param thread_count The number of entries in @a threads.
+ * @param current_state The current thread's state, or NULL. See plcrash_log_writer_write().
+ * @param pool The unwind pool, or NULL.
+ */
+static void plcrash_writer_thread_metadata_capture (plcrash_writer_thread_metadata_t *metadata, plcrash_log_writer_t *writer,
+                                                    thread_act_array_t threads, mach_msg_type_number_t thread_count,
+                                                    plcrash_async_thread_state_t *current_state, plcrash_writer_unwind_pool_t *pool)
+{
+    void *buf;
+
+    metadata->records = NULL;
+    metadata->size = 0;
+
+    if (thread_count == 0)
+        return;
+
+    if (plcrash_async_allocator_alloc(writer->allocator, &buf, (size_t) thread_count * PLCRASH_WRITER_THREAD_METADATA_FIELDS * PLCRASH_WRITER_MAX_VARINT_BYTES) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate thread metadata storage, thread metadata will not be written");
+        return;
+    }
+    metadata->records = buf;
+
+    uint32_t thread_number = 0;
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        uint64_t fields[PLCRASH_WRITER_THREAD_METADATA_FIELDS];
+        thread_extended_info_data_t extended;
+        mach_msg_type_number_t count = THREAD_EXTENDED_INFO_COUNT;
+
+        if (!plcrash_writer_thread_is_written(writer, threads[i], current_state, pool))
+            continue;
+
+        fields[0] = thread_number++;
+        if (thread_info(threads[i], THREAD_EXTENDED_INFO, (thread_info_t) &extended, &count) == KERN_SUCCESS) {
+            fields[1] = extended.pth_user_time;
+            fields[2] = extended.pth_system_time;
+            fields[3] = (uint32_t) extended.pth_cpu_usage;
+            fields[4] = (uint32_t) extended.pth_policy;
+            fields[5] = (uint32_t) extended.pth_run_state;
+            fields[6] = (uint32_t) extended.pth_flags;
+            fields[7] = (uint32_t) extended.pth_sleep_time;
+            fields[8] = (uint32_t) extended.pth_curpri;
+            fields[9] = (uint32_t) extended.pth_priority;
+            fields[10] = (uint32_t) extended.pth_maxpriority;
+        } else {
+            thread_basic_info_data_t basic;
+            count = THREAD_BASIC_INFO_COUNT;
+            if (thread_info(threads[i], THREAD_BASIC_INFO, (thread_info_t) &basic, &count) != KERN_SUCCESS)
+                continue;
+
+            fields[1] = (uint64_t) basic.user_time.seconds * NSEC_PER_SEC + (uint64_t) basic.user_time.microseconds * NSEC_PER_USEC;
+            fields[2] = (uint64_t) basic.system_time.seconds * NSEC_PER_SEC + (uint64_t) basic.system_time.microseconds * NSEC_PER_USEC;
+            fields[3] = (uint32_t) basic.cpu_usage;
+            fields[4] = (uint32_t) basic.policy;
+            fields[5] = (uint32_t) basic.run_state;
+            fields[6] = (uint32_t) basic.flags;
+            fields[7] = (uint32_t) basic.sleep_time;
+            fields[8] = 0;
+            fields[9] = 0;
+            fields[10] = 0;
+        }
+
+        for (size_t f = 0; f < PLCRASH_WRITER_THREAD_METADATA_FIELDS; f++)
+            metadata->size += plcrash_writer_encode_varint(fields[f], metadata->records + metadata->size);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write the thread metadata message.
+ *
+ * @param file Output file, or NULL to determine the message size.
+ * @param metadata The gathered thread metadata.
+ */
+static size_t plcrash_writer_write_thread_metadata (plcrash_async_file_t *file, const plcrash_writer_thread_metadata_t *metadata) {
+    uint32_t fields = PLCRASH_WRITER_THREAD_METADATA_FIELDS;
+    PLProtobufCBinaryData records = { .len = metadata->size, .data = metadata->records };
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_METADATA_FIELDS_PER_RECORD_ID, PLPROTOBUF_C_TYPE_UINT32, &fields);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_METADATA_RECORDS_ID, PLPROTOBUF_C_TYPE_BYTES, &records);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Capture the state of @a job's thread, and copy up to @a capacity bytes of the thread's stack into @a buffer. On
+ * return, @a job may be written after its thread has been resumed.
+ *
+ * @param job The job to snapshot. The job's thread must be suspended.
+ * @param task The task in which the job's thread is executing.
+ * @param buffer The buffer into which the thread's stack will be copied.
+ * @param capacity The size of @a buffer.
+ *
+ * @return Returns true if the thread's state was captured. If false, the thread's state will be fetched from the
+ * (possibly running) thread when the thread is written.
+ */
+static bool plcrash_writer_thread_job_snapshot (plcrash_writer_thread_job_t *job, task_t task, void *buffer, pl_vm_size_t capacity) {
+    plcrash_error_t err;
+
+    /* The current thread's state was provided by our caller, and the current thread will not be resumed. */
+    if (job->thread_ctx != NULL && job->thread_ctx != &job->snapshot_state)
+        return false;
+
+    /* Fetch the thread's state if it was not captured when the thread was suspended */
+    if (job->thread_ctx == NULL) {
+        if ((err = plcrash_async_thread_state_mach_thread_init(&job->snapshot_state, job->thread)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to capture state for thread %" PRIu32 ": %d", job->thread_number, err);
+            return false;
+        }
+        job->thread_ctx = &job->snapshot_state;
+    }
+
+    if (!plcrash_async_thread_state_has_reg(&job->snapshot_state, PLCRASH_REG_SP))
+        return true;
+
+    /* Copy the stack; if the full range can't be read -- as will occur if the stack is smaller than our buffer -- we fall
+     * back on copying page-by-page until the first unreadable page is found. */
+    pl_vm_address_t sp = (pl_vm_address_t) plcrash_async_thread_state_get_reg(&job->snapshot_state, PLCRASH_REG_SP);
+    pl_vm_size_t copied = 0;
+
+    if (plcrash_async_task_memcpy(task, sp, 0, buffer, capacity) == PLCRASH_ESUCCESS) {
+        copied = capacity;
+    } else {
+        while (copied < capacity) {
+            pl_vm_size_t chunk = PAGE_SIZE - ((sp + copied) & (PAGE_SIZE - 1));
+            if (chunk > capacity - copied)
+                chunk = capacity - copied;
+
+            if (plcrash_async_task_memcpy(task, sp, copied, (uint8_t *) buffer + copied, chunk) != PLCRASH_ESUCCESS)
+                break;
+
+            copied += chunk;
+        }
+    }
+
+    if (copied > 0) {
+        job->stack_snapshot_storage.address = sp;
+        job->stack_snapshot_storage.length = copied;
+        job->stack_snapshot_storage.data = buffer;
+        job->stack_snapshot = &job->stack_snapshot_storage;
+    }
+
+    return true;
+}
+
+
+/**
+ * @internal
+ *
+ * Encode a binary image frame
+ *
+ * @param file Output file
+ * @param image Mach-O image.
+ */
+static size_t plcrash_writer_encode_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image) {
+    size_t rv = 0;
+
+    /* Fetch the CPU types. Note that the wire format represents these as 64-bit unsigned integers.
+     * We explicitly cast to an equivalently sized unsigned type to prevent improper sign extension. */
+    uint64_t cpu_type = (uint32_t) image->byteorder->swap32(image->header.cputype);
+    uint64_t cpu_subtype = (uint32_t) image->byteorder->swap32(image->header.cpusubtype);
+
+    /* Text segment size */
+    uint64_t mach_size = image->text_size;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_SIZE_ID, PLPROTOBUF_C_TYPE_UINT64, &mach_size);
+    
+    /* Base address */
+    {
+        uintptr_t base_addr;
+        uint64_t u64;
+
+        base_addr = (uintptr_t) image->header_addr;
+        u64 = base_addr;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_ADDR_ID, PLPROTOBUF_C_TYPE_UINT64, &u64);
+    }
+
+    /* Name */
+    const char *name = plcrash_async_macho_name(image);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_NAME_ID, PLPROTOBUF_C_TYPE_STRING, name != NULL ? name : "");
+
+    /* UUID */
+    struct uuid_command *uuid;
+    uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid != NULL) {
+        PLProtobufCBinaryData binary;
+    
+        /* Write the 128-bit UUID */
+        binary.len = sizeof(uuid->uuid);
+        binary.data = uuid->uuid;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    }
+    
+    /* Get the processor message size */
+    uint32_t msgsize = (uint32_t) plcrash_writer_processor_info_size(cpu_type, cpu_subtype);
+
+    /* Write the header and message */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    rv += plcrash_writer_write_processor_info(file, cpu_type, cpu_subtype);
+
+    return rv;
+}
+
+
+/**
+ * @internal
+ *
+ * Write a binary image frame. The encoded frame is cached on @a image on first use, and subsequent sizing and
+ * writing passes -- including those of later reports -- emit the cached frame directly.
+ *
+ * @param file Output file
+ * @param image Mach-O image.
+ */
+static size_t plcrash_writer_write_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image) {
+    const void *record = image->encoded_record;
+    OSMemoryBarrier();
+
+    if (record == NULL) {
+        uint8_t buffer[MAX_CACHED_BINARY_IMAGE_RECORD];
+        plcrash_async_file_t memfile;
+
+        /* Images with unusually long paths are not cached */
+        size_t size = plcrash_writer_encode_binary_image(NULL, image);
+        if (size > sizeof(buffer))
+            return plcrash_writer_encode_binary_image(file, image);
+
+        plcrash_async_file_init_memory(&memfile, buffer, sizeof(buffer));
+        plcrash_writer_encode_binary_image(&memfile, image);
+        PLCF_ASSERT((size_t) plcrash_async_file_position(&memfile) == size);
+        plcrash_async_file_close(&memfile);
+
+        /* On failure, the frame is simply re-encoded by the next report */
+        plcrash_error_t err = plcrash_async_macho_set_encoded_record(image, buffer, size);
+        if (err != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to cache the binary image record for %s: %d", image->name, err);
+            if (file != NULL)
+                plcrash_async_file_write(file, buffer, size);
+            return size;
+        }
+
+        record = image->encoded_record;
+        OSMemoryBarrier();
+    }
+
+    if (file != NULL)
+        plcrash_async_file_write(file, record, image->encoded_record_size);
+
+    return image->encoded_record_size;
+}
+
+
+/**
+ * @internal
+ *
+ * Write a compact binary image message, containing only the image's base address and UUID.
+ *
+ * @param file Output file
+ * @param image Mach-O image.
+ */
+static size_t plcrash_writer_write_compact_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image) {
+    size_t rv = 0;
+
+    /* Base address */
+    uint64_t base_addr = (uintptr_t) image->header_addr;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_COMPACT_BINARY_IMAGE_ADDR_ID, PLPROTOBUF_C_TYPE_UINT64, &base_addr);
+
+    /* UUID */
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid != NULL) {
+        PLProtobufCBinaryData binary;
+
+        binary.len = sizeof(uuid->uuid);
+        binary.data = uuid->uuid;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_COMPACT_BINARY_IMAGE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a shared image list reference message.
+ *
+ * @param file Output file
+ * @param session_id The image list's 16-byte session identifier.
+ * @param generation The image list generation.
+ */
+static size_t plcrash_writer_write_shared_image_list (plcrash_async_file_t *file, const uint8_t *session_id, uint32_t generation) {
+    size_t rv = 0;
+    PLProtobufCBinaryData binary;
+
+    binary.len = 16;
+    binary.data = (void *) session_id;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_IMAGE_LIST_SESSION_ID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_IMAGE_LIST_GENERATION_ID, PLPROTOBUF_C_TYPE_UINT32, &generation);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the crash loop message.
+ *
+ * @param file Output file
+ * @param writer The writer containing the crash loop state.
+ */
+static size_t plcrash_writer_write_crash_loop (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_CRASH_LOOP_LAUNCH_CRASH_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->crash_loop_count);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_CRASH_LOOP_STACK_HASH_ID, PLPROTOBUF_C_TYPE_UINT64, &writer->crash_loop_hash);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_CRASH_LOOP_REDUCED_ID, PLPROTOBUF_C_TYPE_BOOL, &writer->crash_loop_reduced);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the binary image records that have not yet been written.
+ *
+ * A full record is written for each image that has been referenced by a written frame or register value; once
+ * @a final is set, the remaining images are written, as compact records if compact image records are enabled. If the
+ * referenced images are not being tracked, every image is written in full by the first call.
+ *
+ * @param file Output file
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param final If true, no further frames or registers will be written, and all remaining images must be written.
+ */
+static void plcrash_writer_write_binary_images (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, bool final) {
+    /* The report's images are provided by the shared image list */
+    if (writer->image_list_shared)
+        return;
+
+    /* Reports restricted to a subset of threads omit unreferenced images entirely, provided that at least one image
+     * has been written; a report must include at least one image to be decoded. */
+    bool omit_unreferenced = false;
+    bool filtered = writer->thread_filter != NULL || (writer->has_crash_loop && writer->crash_loop_reduced);
+    if (final && filtered && writer->image_flags != NULL) {
+        for (size_t i = 0; i < plcrash_async_image_list_count(image_list) && !omit_unreferenced; i++)
+            omit_unreferenced = (writer->image_flags[i] & PLCRASH_WRITER_IMAGE_WRITTEN) != 0;
+    }
+
+    for (size_t i = 0; i < plcrash_async_image_list_count(image_list); i++) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
+        uint32_t size;
+
+        if (writer->image_flags != NULL) {
+            uint8_t flags = writer->image_flags[i];
+            if (flags & PLCRASH_WRITER_IMAGE_WRITTEN)
+                continue;
+
+            /* Unreferenced images are deferred until all references are known */
+            if (!(flags & PLCRASH_WRITER_IMAGE_REFERENCED)) {
+                if (!final || omit_unreferenced)
+                    continue;
+
+                if (writer->compact_images) {
+                    size = plcrash_writer_write_compact_binary_image(NULL, image);
+                    plcrash_writer_pack(file, PLCRASH_PROTO_COMPACT_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+                    plcrash_writer_write_compact_binary_image(file, image);
+                    writer->image_flags[i] |= PLCRASH_WRITER_IMAGE_WRITTEN;
+                    continue;
+                }
+            }
+
+            writer->image_flags[i] |= PLCRASH_WRITER_IMAGE_WRITTEN;
+        } else if (final) {
+            /* All images were written by the first call */
+            return;
+        }
+
+        /* Calculate the message size */
+        size = plcrash_writer_write_binary_image(NULL, image);
+        plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_binary_image(file, image);
+    }
+}
+
+
+/**
+ * @internal
+ *
+ * Write the crash Exception message
+ *
+ * @param file Output file
+ * @param writer Writer containing exception data
+ */
+static size_t plcrash_writer_write_exception (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
+    size_t rv = 0;
+
+    /* Write the name and reason */
+    assert(writer->uncaught_exception.has_exception);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_NAME_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.name);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_REASON_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.reason);
+    
+    /* Write the stack frames, if any */
+    uint32_t frame_count = 0;
+    for (size_t i = 0; i < writer->uncaught_exception.callstack_count && frame_count < writer->max_thread_frames; i++) {
+        uint64_t pc = writer->uncaught_exception.callstack[i];
+        uint32_t frame_size;
+
+        if (plcrash_writer_use_single_pass(file)) {
+            off_t position;
+
+            /* Write the message, backpatching the size */
+            rv += plcrash_writer_pack_deferred_length(file, PLCRASH_PROTO_EXCEPTION_FRAMES_ID, &position);
+            frame_size = plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
+            plcrash_writer_pack_fixup_length(file, position, frame_size);
+            rv += frame_size;
+        } else {
+            /* Determine the size */
+            frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, image_list, findContext);
+
+            rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+            rv += plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
+        }
+        frame_count++;
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the crash signal's mach exception info.
+ *
+ * @param file Output file
+ * @param siginfo The signal information
+ */
+static size_t plcrash_writer_write_mach_signal (plcrash_async_file_t *file, plcrash_log_mach_signal_info_t *siginfo) {
+    size_t rv = 0;
+
+    /* Type */
+    uint64_t type = siginfo->type;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &type);
+    
+    /* Code(s) */
+    for (mach_msg_type_number_t i = 0; i < siginfo->code_count; i++) {
+        uint64_t code = siginfo->code[i];
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_CODES_ID, PLPROTOBUF_C_TYPE_UINT64, &code);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the crash signal message
+ *
+ * @param file Output file
+ * @param siginfo The signal information
+ */
+static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_log_signal_info_t *siginfo) {
+    size_t rv = 0;
+    
+    /* BSD signal info is always required in the current report format; this restriction will be lifted
+     * once we switch to the 2.0 format. */
+    PLCF_ASSERT(siginfo->bsd_info != NULL);
+    
+    /* Fetch the signal name */
+    char name_buf[10];
+    const char *name;
+    if ((name = plcrash_async_signal_signame(siginfo->bsd_info->signo)) == NULL) {
+        PLCF_DEBUG("Warning -- unhandled signal number (signo=%d). This is a bug.", siginfo->bsd_info->signo);
+        snprintf(name_buf, sizeof(name_buf), "#%d", siginfo->bsd_info->signo);
+        name = name_buf;
+    }
+
+    /* Fetch the signal code string */
+    char code_buf[10];
+    const char *code;
+    if ((code = plcrash_async_signal_sigcode(siginfo->bsd_info->signo, siginfo->bsd_info->code)) == NULL) {
+        PLCF_DEBUG("Warning -- unhandled signal sicode (signo=%d, code=%d). This is a bug.", siginfo->bsd_info->signo, siginfo->bsd_info->code);
+        snprintf(code_buf, sizeof(code_buf), "#%d", siginfo->bsd_info->code);
+        code = code_buf;
+    }
+    
+    /* Address value */
+    uint64_t addr = (uintptr_t) siginfo->bsd_info->address;
+
+    /* Write it out */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_NAME_ID, PLPROTOBUF_C_TYPE_STRING, name);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_CODE_ID, PLPROTOBUF_C_TYPE_STRING, code);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &addr);
+    
+    /* Mach exception info */
+    if (siginfo->mach_info != NULL) {
+        uint32_t size;
+        
+        /* Determine size */
+        size = plcrash_writer_write_mach_signal(NULL, siginfo->mach_info);
+        
+        /* Write message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_mach_signal(file, siginfo->mach_info);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * A range of the crashed thread's memory to be captured.
+ */
+typedef struct plcrash_writer_memory_range {
+    /** The first address of the range. */
+    pl_vm_address_t start;
+
+    /** The address immediately following the range. */
+    pl_vm_address_t end;
+} plcrash_writer_memory_range_t;
+
+/**
+ * @internal
+ *
+ * Return true if the page containing @a address in @a task is readable.
+ */
+static bool plcrash_writer_memory_readable (task_t task, pl_vm_address_t address) {
+    uint8_t byte;
+    return plcrash_async_task_memcpy(task, address, 0, &byte, sizeof(byte)) == PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Clip @a range to the contiguous readable pages surrounding @a anchor, which must lie within @a range.
+ *
+ * @return Returns false if @a anchor is not readable.
+ */
+static bool plcrash_writer_memory_clip (task_t task, pl_vm_address_t anchor, plcrash_writer_memory_range_t *range) {
+    pl_vm_address_t page = anchor & ~((pl_vm_address_t) PAGE_SIZE - 1);
+
+    if (!plcrash_writer_memory_readable(task, page))
+        return false;
+
+    pl_vm_address_t low = page;
+    while (low > range->start && plcrash_writer_memory_readable(task, low - PAGE_SIZE))
+        low -= PAGE_SIZE;
+
+    pl_vm_address_t high = page + PAGE_SIZE;
+    while (high < range->end && plcrash_writer_memory_readable(task, high))
+        high += PAGE_SIZE;
+
+    if (range->start < low)
+        range->start = low;
+
+    if (range->end > high)
+        range->end = high;
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Determine the ranges of the crashed thread's memory to be captured, within the writer's memory budget.
+ *
+ * @param writer The writer context.
+ * @param task The task containing the crashed thread.
+ * @param thread_state The crashed thread's state.
+ * @param ranges On return, the ranges to be captured, in capture order. Must have room for MAX_MEMORY_REGIONS.
+ *
+ * @return Returns the number of ranges written to @a ranges.
+ */
+static size_t plcrash_writer_memory_ranges (plcrash_log_writer_t *writer, task_t task, const plcrash_async_thread_state_t *thread_state,
+                                            plcrash_writer_memory_range_t *ranges)
+{
+    size_t budget = writer->memory_budget;
+    size_t count = 0;
+
+    /* The stack, beginning just beyond the stack pointer, to include any red zone */
+    size_t stack_bytes = MIN(writer->memory_stack_bytes, budget);
+    if (stack_bytes > 0) {
+        pl_vm_address_t sp = plcrash_async_thread_state_get_reg(thread_state, PLCRASH_REG_SP);
+        plcrash_writer_memory_range_t range;
+
+        if (plcrash_async_thread_state_get_stack_direction(thread_state) == PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN) {
+            range.start = sp - MIN(sp, STACK_RED_ZONE_BYTES);
+            range.end = range.start + stack_bytes;
+            if (range.end < range.start)
+                range.end = PL_VM_ADDRESS_MAX;
+        } else {
+            range.end = sp + STACK_RED_ZONE_BYTES;
+            if (range.end < sp)
+                range.end = PL_VM_ADDRESS_MAX;
+            range.start = range.end - MIN(range.end, stack_bytes);
+        }
+
+        if (plcrash_writer_memory_clip(task, sp, &range) && range.end > range.start) {
+            ranges[count++] = range;
+            budget -= range.end - range.start;
+        }
+    }
+
+    /* The memory surrounding each register value */
+    size_t reg_count = plcrash_async_thread_state_get_reg_count(thread_state);
+    for (size_t i = 0; i < reg_count && count < MAX_MEMORY_REGIONS && budget > 0 && writer->memory_register_bytes > 0; i++) {
+        pl_vm_address_t value = plcrash_async_thread_state_get_reg(thread_state, (plcrash_regnum_t) i);
+        bool covered = false;
+
+        /* Skip values that can not be pointers */
+        if (value < PAGE_SIZE)
+            continue;
+
+        for (size_t j = 0; j < count; j++) {
+            if (value >= ranges[j].start && value < ranges[j].end) {
+                covered = true;
+                break;
+            }
+        }
+
+        if (covered)
+            continue;
+
+        size_t window = MIN(writer->memory_register_bytes, budget);
+        plcrash_writer_memory_range_t range;
+        range.start = value - MIN(value, window / 2);
+        range.end = range.start + window;
+        if (range.end < range.start)
+            range.end = PL_VM_ADDRESS_MAX;
+
+        /* Trim the window so that regions do not overlap. As the value does not lie within any captured range, each
+         * overlapping range lies entirely on one side of the value. */
+        for (size_t j = 0; j < count; j++) {
+            if (ranges[j].end <= value && ranges[j].end > range.start)
+                range.start = ranges[j].end;
+            else if (ranges[j].start > value && ranges[j].start < range.end)
+                range.end = ranges[j].start;
+        }
+
+        if (!plcrash_writer_memory_clip(task, value, &range) || range.end <= range.start)
+            continue;
+
+        ranges[count++] = range;
+        budget -= range.end - range.start;
+    }
+
+    return count;
+}
+
+/**
+ * @internal
+ *
+ * Write a memory region message. The region's data is copied directly from @a task to the output; any bytes that can
+ * no longer be read are zero-filled.
+ *
+ * @param file Output file, or NULL to determine the message size.
+ * @param task The task from which the memory will be read.
+ * @param range The range to be written.
+ */
+static size_t plcrash_writer_write_memory_region (plcrash_async_file_t *file, task_t task, const plcrash_writer_memory_range_t *range) {
+    uint64_t address = range->start;
+    uint32_t length = (uint32_t) (range->end - range->start);
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGION_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &address);
+
+    /* Bytes fields share the message encoding of a length-prefixed field; write the prefix, followed by the data */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGION_DATA_ID, PLPROTOBUF_C_TYPE_MESSAGE, &length);
+    if (file != NULL)
+        plcrash_async_file_write_task(file, task, range->start, length);
+    rv += length;
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the crashed thread's memory regions, as configured via plcrash_log_writer_set_memory_capture().
+ *
+ * @param file Output file.
+ * @param writer Writer context.
+ * @param task The task containing the crashed thread.
+ * @param crashed_thread The crashed thread.
+ * @param current_state The current thread's state, or NULL. See plcrash_log_writer_write().
+ * @param captured_state The crashed thread's captured state, or NULL.
+ */
+static void plcrash_writer_write_memory_regions (plcrash_async_file_t *file, plcrash_log_writer_t *writer, task_t task, thread_t crashed_thread,
+                                                 plcrash_async_thread_state_t *current_state,
+                                                 const plcrash_async_thread_snapshot_t *captured_state)
+{
+    plcrash_writer_memory_range_t ranges[MAX_MEMORY_REGIONS];
+    plcrash_async_thread_state_t thread_state;
+
+    if (crashed_thread == MACH_PORT_NULL)
+        return;
+
+    /* Fetch the crashed thread's state */
+    if (crashed_thread == writer->self_thread && current_state != NULL) {
+        thread_state = *current_state;
+    } else if (captured_state != NULL && plcrash_async_thread_snapshot_restore(captured_state, &thread_state) == PLCRASH_ESUCCESS) {
+        /* Restored from the captured state */
+    } else if (plcrash_async_thread_state_mach_thread_init(&thread_state, crashed_thread) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not fetch the crashed thread's state, memory will not be captured");
+        return;
+    }
+
+    size_t count = plcrash_writer_memory_ranges(writer, task, &thread_state, ranges);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t size = (uint32_t) plcrash_writer_write_memory_region(NULL, task, &ranges[i]);
+        plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGIONS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_memory_region(file, task, &ranges[i]);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write an attachment message. The attachment's data is copied directly from @a task to the output; any bytes that can
+ * no longer be read are zero-filled.
+ *
+ * @param file Output file, or NULL to determine the message size.
+ * @param task The task from which the attachment will be read.
+ * @param attachment The attachment to be written.
+ */
+static size_t plcrash_writer_write_attachment (plcrash_async_file_t *file, task_t task, const plcrash_log_attachment_t *attachment) {
+    uint32_t length = attachment->length;
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_ATTACHMENT_NAME_ID, PLPROTOBUF_C_TYPE_STRING, attachment->name);
+
+    /* As with memory regions, write the length prefix followed by the data */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_ATTACHMENT_DATA_ID, PLPROTOBUF_C_TYPE_MESSAGE, &length);
+    if (file != NULL)
+        plcrash_async_file_write_task(file, task, attachment->address, length);
+    rv += length;
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write all published attachments. See plcrash_log_writer_set_attachments().
+ *
+ * @param file Output file.
+ * @param task The task from which the attachments will be read.
+ * @param attachments The attachments table.
+ */
+static void plcrash_writer_write_attachments (plcrash_async_file_t *file, task_t task, plcrash_log_attachments_t *attachments) {
+    for (size_t i = 0; i < PLCRASH_LOG_MAX_ATTACHMENTS; i++) {
+        plcrash_log_attachment_t *entry = &attachments->entries[i];
+        plcrash_log_attachment_t attachment;
+
+        if (!entry->active)
+            continue;
+
+        /* Snapshot the entry, ensuring that the sized and written messages agree even if the entry is concurrently
+         * replaced; discard the snapshot if the entry was unpublished while it was copied. */
+        OSMemoryBarrier();
+        plcrash_async_memcpy(&attachment, entry, sizeof(attachment));
+        attachment.name[sizeof(attachment.name) - 1] = '\0';
+        OSMemoryBarrier();
+        if (!entry->active)
+            continue;
+
+        uint32_t size = (uint32_t) plcrash_writer_write_attachment(NULL, task, &attachment);
+        plcrash_writer_pack(file, PLCRASH_PROTO_ATTACHMENTS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_attachment(file, task, &attachment);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write the report info message
+ *
+ * @param file Output file
+ * @param writer Writer containing report data
+ */
+static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+    size_t rv = 0;
+
+    /* Note crashed status */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_USER_REQUESTED_ID, PLPROTOBUF_C_TYPE_BOOL, &writer->report_info.user_requested);
+    
+    /* Write the 128-bit UUID */
+    PLProtobufCBinaryData uuid_bin;
+    
+    uuid_bin.len = sizeof(writer->report_info.uuid_bytes);
+    uuid_bin.data = &writer->report_info.uuid_bytes;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &uuid_bin);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * A snapshot of the writer's instrumentation. The values must not change between the sizing and writing passes
+ * of the writer_stats message, and are captured prior to either.
+ */
+typedef struct plcrash_writer_stats {
+    /** Per-phase timings, in nanoseconds, indexed by plcrash_async_phase_t. */
+    uint64_t phase_ns[PLCRASH_ASYNC_PHASE_COUNT];
+
+    /** Event counts, indexed by plcrash_async_counter_t. */
+    uint64_t counters[PLCRASH_ASYNC_COUNTER_COUNT];
+
+    /** The total time elapsed prior to writing the stats message, in nanoseconds. */
+    uint64_t total_ns;
+} plcrash_writer_stats_t;
+
+/**
+ * @internal
+ *
+ * Snapshot @a instr into @a stats.
+ *
+ * @param stats The snapshot to populate.
+ * @param instr The instrumentation recorded for the report.
+ * @param start_time The mach_absolute_time() at which writing of the report began.
+ */
+static void plcrash_writer_stats_snapshot (plcrash_writer_stats_t *stats, const plcrash_async_instrumentation_t *instr, uint64_t start_time) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_PHASE_COUNT; i++)
+        stats->phase_ns[i] = plcrash_async_instrumentation_phase_ns(instr, (plcrash_async_phase_t) i);
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_COUNTER_COUNT; i++)
+        stats->counters[i] = (uint64_t) instr->counters[i];
+
+    stats->total_ns = 0;
+    mach_timebase_info_data_t timebase;
+    if (mach_timebase_info(&timebase) == KERN_SUCCESS && timebase.denom != 0)
+        stats->total_ns = ((mach_absolute_time() - start_time) * timebase.numer) / timebase.denom;
+}
+
+/**
+ * @internal
+ *
+ * Write the writer stats message.
+ *
+ * @param file Output file
+ * @param stats The instrumentation snapshot to be written.
+ */
+static size_t plcrash_writer_write_writer_stats (plcrash_async_file_t *file, const plcrash_writer_stats_t *stats) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_IMAGE_LIST_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_IMAGE_LIST]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_THREAD_SUSPEND_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_THREAD_SUSPEND]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_UNWIND_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_UNWIND]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_SYMBOLICATION_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_SYMBOLICATION]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_BINARY_IMAGES_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_BINARY_IMAGES]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_FLUSH_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->phase_ns[PLCRASH_ASYNC_PHASE_FLUSH]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_MOBJECT_MAPS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->counters[PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_TASK_MEMCPY_CALLS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_ALLOCATOR_GROWS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->counters[PLCRASH_ASYNC_COUNTER_ALLOCATOR_GROWS]);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_TOTAL_NS_ID, PLPROTOBUF_C_TYPE_UINT64, &stats->total_ns);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Uninstall the writer's debug log, if any, and flush its buffered output to stderr with a single write. If @a file
+ * is non-NULL and embedding is enabled, the output is also written to the report's debug_log field.
+ *
+ * @param writer The writer.
+ * @param file The report output file, or NULL if the report is not being completed.
+ */
+static void plcrash_writer_finish_debug_log (plcrash_log_writer_t *writer, plcrash_async_file_t *file) {
+    plcrash_async_debug_log_t *log = writer->debug_log;
+    if (log == NULL)
+        return;
+
+    /* Uninstall the log; any further output is written directly to stderr */
+    plcrash_async_debug_log_set_current(NULL);
+
+    size_t dropped = plcrash_async_debug_log_dropped(log);
+    if (dropped > 0)
+        PLCF_DEBUG("%zu bytes of buffered debug output were dropped", dropped);
+
+    size_t length;
+    const char *output = plcrash_async_debug_log_linearize(log, &length);
+    if (length > 0) {
+        plcrash_async_writen(STDERR_FILENO, output, length);
+
+        if (file != NULL && writer->embed_debug_log) {
+            PLProtobufCBinaryData data;
+            data.data = (void *) output;
+            data.len = length;
+            plcrash_writer_pack(file, PLCRASH_PROTO_DEBUG_LOG_ID, PLPROTOBUF_C_TYPE_BYTES, &data);
+        }
+    }
+
+    plcrash_async_debug_log_reset(log);
+}
+
+/**
+ * @internal
+ *
+ * The unwinding strategies applied to threads written under a time budget, from the most to the least expensive. See
+ * plcrash_log_writer_set_time_budget().
+ */
+typedef enum {
+    /** Unwind using all available frame readers, and symbolicate all frames. */
+    PLCRASH_WRITER_THREAD_TIER_FULL = 0,
+
+    /** Unwind using all available frame readers, without symbolication. */
+    PLCRASH_WRITER_THREAD_TIER_UNSYMBOLICATED,
+
+    /** Unwind using only the frame pointer reader, without symbolication. */
+    PLCRASH_WRITER_THREAD_TIER_FRAME_POINTER,
+
+    /** Write the thread without any frames. */
+    PLCRASH_WRITER_THREAD_TIER_NO_FRAMES
+} plcrash_writer_thread_tier_t;
+
+/**
+ * @internal
+ *
+ * The threads to be written by plcrash_writer_write_threads().
+ */
+typedef enum {
+    /** Write all threads. */
+    PLCRASH_WRITER_THREADS_ALL = 0,
+
+    /** Write only the crashed thread. */
+    PLCRASH_WRITER_THREADS_CRASHED,
+
+    /** Write all but the crashed thread. */
+    PLCRASH_WRITER_THREADS_NOT_CRASHED
+} plcrash_writer_thread_filter_t;
+
+/**
+ * @internal
+ *
+ * The libsystem_kernel syscall stubs in which idle threads park, as they appear in the image's symbol table.
+ */
+static const char * const plcrash_writer_idle_stub_names[] = {
+    "_mach_msg_trap",
+    "_mach_msg2_trap",
+    "___workq_kernreturn",
+    "___semwait_signal",
+    "___psynch_cvwait"
+};
+
+/**
+ * @internal
+ *
+ * Resolve the addresses of the idle syscall stubs within @a image_list's libsystem_kernel image, populating
+ * @a writer's idle_stubs. Stubs that can not be found are skipped.
+ *
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ */
+static void plcrash_writer_resolve_idle_stubs (plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list) {
+    static const char suffix[] = "/libsystem_kernel.dylib";
+    size_t suffix_len = sizeof(suffix) - 1;
+
+    writer->idle_stub_count = 0;
+
+    for (size_t i = 0; i < plcrash_async_image_list_count(image_list); i++) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
+        const char *name = plcrash_async_macho_name(image);
+        if (name == NULL)
+            continue;
+
+        size_t name_len = 0;
+        while (name[name_len] != '\0')
+            name_len++;
+
+        if (name_len < suffix_len || plcrash_async_strcmp(name + name_len - suffix_len, suffix) != 0)
+            continue;
+
+        for (size_t n = 0; n < sizeof(plcrash_writer_idle_stub_names) / sizeof(plcrash_writer_idle_stub_names[0]); n++) {
+            pl_vm_address_t addr;
+            if (writer->idle_stub_count == PLCRASH_WRITER_MAX_IDLE_STUBS)
+                break;
+
+            if (plcrash_async_macho_find_symbol_by_name(image, plcrash_writer_idle_stub_names[n], &addr) == PLCRASH_ESUCCESS)
+                writer->idle_stubs[writer->idle_stub_count++] = addr;
+        }
+
+        break;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Determine whether @a job's thread is parked within one of the idle syscall stubs resolved via
+ * plcrash_writer_resolve_idle_stubs().
+ *
+ * @param writer The writer context.
+ * @param job The thread job.
+ */
+static bool plcrash_writer_thread_is_idle (plcrash_log_writer_t *writer, plcrash_writer_thread_job_t *job) {
+    plcrash_async_thread_state_t state;
+    plcrash_async_thread_state_t *ctx = job->thread_ctx;
+
+    if (writer->idle_stub_count == 0)
+        return false;
+
+    /* Fetch the thread's state, if not already captured */
+    if (ctx == NULL) {
+        if (plcrash_async_thread_state_mach_thread_init(&state, job->thread) != PLCRASH_ESUCCESS)
+            return false;
+        ctx = &state;
+    }
+
+    pl_vm_address_t pc = (pl_vm_address_t) plcrash_async_thread_state_get_reg(ctx, PLCRASH_REG_IP);
+    for (uint32_t i = 0; i < writer->idle_stub_count; i++) {
+        if (pc >= writer->idle_stubs[i] && pc - writer->idle_stubs[i] < MAX_IDLE_STUB_OFFSET)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Determine the unwinding strategy to be used for the next non-crashed thread, given the time elapsed since the writer
+ * began writing the report.
+ *
+ * @param writer The writer context.
+ * @param start_time The mach_absolute_time() at which the report was started.
+ */
+static plcrash_writer_thread_tier_t plcrash_writer_thread_tier (plcrash_log_writer_t *writer, uint64_t start_time) {
+    if (writer->time_budget == 0)
+        return PLCRASH_WRITER_THREAD_TIER_FULL;
+
+    uint64_t elapsed = mach_absolute_time() - start_time;
+    if (elapsed < writer->time_budget / 2)
+        return PLCRASH_WRITER_THREAD_TIER_FULL;
+    else if (elapsed < (writer->time_budget / 4) * 3)
+        return PLCRASH_WRITER_THREAD_TIER_UNSYMBOLICATED;
+    else if (elapsed < writer->time_budget)
+        return PLCRASH_WRITER_THREAD_TIER_FRAME_POINTER;
+
+    return PLCRASH_WRITER_THREAD_TIER_NO_FRAMES;
+}
+
+/**
+ * @internal
+ *
+ * Write the thread messages for all threads matching @a filter.
+ *
+ * @param file Output file
+ * @param writer The writer context.
+ * @param threads The target's threads.
+ * @param thread_count The number of entries in @a threads.
+ * @param crashed_thread The crashed thread.
+ * @param current_state The current thread's state, or NULL. See plcrash_log_writer_write().
+ * @param captured_states The threads' captured states, or NULL.
+ * @param pool The unwind pool, or NULL.
+ * @param jobs The thread jobs recorded by the unwind workers or holding the stack snapshots, or NULL.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param memo The frame memo to be used when sizing thread messages, or NULL.
+ * @param filter The threads to be written.
+ * @param start_time The mach_absolute_time() at which the report was started.
+ * @param report_frames The number of frames written for previous threads; will be updated with the number of frames
+ * written.
+ */
+static void plcrash_writer_write_threads (plcrash_async_file_t *file,
+                                          plcrash_log_writer_t *writer,
+                                          thread_act_array_t threads,
+                                          mach_msg_type_number_t thread_count,
+                                          thread_t crashed_thread,
+                                          plcrash_async_thread_state_t *current_state,
+                                          const plcrash_writer_captured_states_t *captured_states,
+                                          plcrash_writer_unwind_pool_t *pool,
+                                          plcrash_writer_thread_job_t *jobs,
+                                          plcrash_async_image_list_t *image_list,
+                                          plcrash_async_symbol_cache_t *findContext,
+                                          plcrash_writer_frame_memo_t *memo,
+                                          plcrash_writer_thread_filter_t filter,
+                                          uint64_t start_time,
+                                          uint32_t *report_frames)
+{
+    uint32_t thread_number = 0;
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        plcrash_writer_thread_job_t local_job;
+        plcrash_writer_thread_job_t *job = &local_job;
+        uint32_t frames_written = 0;
+        uint32_t size;
+
+        if (!plcrash_writer_thread_job_init(&local_job, writer, threads[i], thread_number, crashed_thread, current_state,
+                                            plcrash_writer_captured_state(captured_states, i), pool))
+            continue;
+
+        /* Use the unwind workers' results, if any. The jobs were initialized in the same order. */
+        if (jobs != NULL) {
+            job = &jobs[thread_number];
+            plcrash_writer_unwind_pool_await(pool, thread_number);
+        }
+
+        /* Thread numbers are assigned to all threads, whether or not they're written here */
+        thread_number++;
+        if ((filter == PLCRASH_WRITER_THREADS_CRASHED && !job->crashed) || (filter == PLCRASH_WRITER_THREADS_NOT_CRASHED && job->crashed))
+            continue;
+
+        /* Apply the report's frame budget to this thread */
+        uint32_t frame_limit = writer->max_thread_frames;
+        if (writer->max_report_frames > 0) {
+            uint32_t remaining = writer->max_report_frames - *report_frames;
+            if (frame_limit > remaining)
+                frame_limit = remaining;
+        }
+
+        /* The crashed thread and any secondary crashers are always written in full; the remaining threads are written
+         * using progressively cheaper strategies as the report's time budget is used up. */
+        plcrash_writer_thread_tier_t tier = PLCRASH_WRITER_THREAD_TIER_FULL;
+        if (!job->crashed && !job->secondary)
+            tier = plcrash_writer_thread_tier(writer, start_time);
+
+        if (tier == PLCRASH_WRITER_THREAD_TIER_NO_FRAMES)
+            frame_limit = 0;
+
+        /* Idle threads parked in a syscall stub are given a shallow frame pointer unwind. A stack already recorded by
+         * the unwind workers is simply used as-is. */
+        bool idle = false;
+        if (!job->crashed && !job->secondary && !job->recorded && writer->idle_thread_frames > 0 && plcrash_writer_thread_is_idle(writer, job)) {
+            idle = true;
+            if (frame_limit > writer->idle_thread_frames)
+                frame_limit = writer->idle_thread_frames;
+        }
+
+        /* The unwind workers record each thread with the full per-thread limit; if the recorded stack exceeds the
+         * remaining budget, the thread must be walked again. */
+        if (job->recorded && job->memo.frame_count > frame_limit)
+            job->recorded = false;
+
+        /* Apply the thread's strategy; both are restored below. The writer's configuration is shared with any pipeline
+         * workers, which must first be finished. */
+        plcrash_async_symbol_strategy_t symbol_strategy = writer->symbol_strategy;
+        bool degraded = (idle || tier != PLCRASH_WRITER_THREAD_TIER_FULL);
+        if (degraded) {
+            plcrash_writer_unwind_pool_finish(pool);
+
+            if (tier >= PLCRASH_WRITER_THREAD_TIER_UNSYMBOLICATED)
+                writer->symbol_strategy = PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE;
+            writer->frame_pointer_only = (idle || tier >= PLCRASH_WRITER_THREAD_TIER_FRAME_POINTER);
+        }
+
+        /* If collapsing identical stacks, the thread's stack must be recorded before its message is written */
+        plcrash_writer_frame_memo_t *recorded = NULL;
+        if (writer->stack_table != NULL && !job->crashed && !job->secondary) {
+            if (job->recorded) {
+                recorded = &job->memo;
+            } else if (memo != NULL) {
+                size = plcrash_writer_write_thread(NULL, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, memo, frame_limit, NULL);
+                recorded = memo;
+            }
+        }
+
+        /* The thread's queue label is appended to its message */
+        const char *queue_label = plcrash_writer_queue_label(writer, writer->task, job->thread);
+        uint32_t label_size = (uint32_t) plcrash_writer_write_queue_label(NULL, queue_label);
+
+        uint32_t duplicate_of;
+        if (recorded != NULL && recorded->valid && recorded->frame_count > 0 &&
+            plcrash_writer_stack_table_find(writer->stack_table, recorded, job->thread_number, &duplicate_of))
+        {
+            /* Write message, referencing the identical stack of a previously written thread */
+            size = plcrash_writer_write_duplicate_thread(NULL, job->thread_number, job->crashed, duplicate_of) + label_size;
+            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_duplicate_thread(file, job->thread_number, job->crashed, duplicate_of);
+        } else if (job->recorded) {
+            /* Write message, replaying the frames memoized by the unwind worker */
+            size = job->size + label_size;
+            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_thread(file, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, &job->memo, frame_limit, &frames_written);
+        } else if (recorded != NULL) {
+            /* Write message, replaying the frames memoized above */
+            size += label_size;
+            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_thread(file, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, memo, frame_limit, &frames_written);
+        } else if (plcrash_writer_use_single_pass(file) && (memo == NULL || !writer->packed_frames)) {
+            off_t position;
+
+            /* Write the message, backpatching the size; this avoids walking the thread's stack twice. */
+            plcrash_writer_pack_deferred_length(file, PLCRASH_PROTO_THREADS_ID, &position);
+            size = plcrash_writer_write_thread(file, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, NULL, frame_limit, &frames_written);
+            size += plcrash_writer_write_queue_label(file, queue_label);
+            plcrash_writer_pack_fixup_length(file, position, size);
+
+            /* The label has been written */
+            queue_label = NULL;
+        } else {
+            /* Determine the size, recording the thread's frames in our memo (if any) */
+            size = plcrash_writer_write_thread(NULL, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, memo, frame_limit, NULL) + label_size;
+
+            /* Write message, replaying the memoized frames */
+            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_thread(file, writer, writer->task, job->thread, job->thread_number, job->thread_ctx, job->stack_snapshot, image_list, findContext, job->crashed, memo, frame_limit, &frames_written);
+        }
+
+        plcrash_writer_write_queue_label(file, queue_label);
+
+        if (degraded) {
+            writer->symbol_strategy = symbol_strategy;
+            writer->frame_pointer_only = false;
+        }
+
+        *report_frames += frames_written;
+    }
+}
+
+/**
+ * @internal
+ *
+ * The writer options that may be changed by the report size policy.
+ */
+typedef struct plcrash_writer_size_options {
+    /** The configured packed_frames value. */
+    bool packed_frames;
+
+    /** The configured collapse_stacks value. */
+    bool collapse_stacks;
+
+    /** The configured compact_images value. */
+    bool compact_images;
+
+    /** The configured idle_thread_frames value. */
+    uint32_t idle_thread_frames;
+} plcrash_writer_size_options_t;
+
+/**
+ * @internal
+ *
+ * Estimate the encoded size of the remainder of a report, given @a writer's current options.
+ *
+ * @param writer The writer context.
+ * @param image_list The Mach-O image list.
+ * @param thread_count The number of threads to be written, including the crashed thread.
+ */
+static uint64_t plcrash_writer_estimate_size (plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, uint32_t thread_count) {
+    uint64_t size = SIZE_ESTIMATE_FIXED_BYTES + (uint64_t) thread_count * SIZE_ESTIMATE_THREAD_BYTES;
+
+    /* Frames. The crashed thread is always written in full. */
+    uint64_t depth = MIN(writer->max_thread_frames, SIZE_ESTIMATE_THREAD_FRAMES);
+    uint64_t frames = depth;
+    if (thread_count > 1) {
+        uint64_t others = thread_count - 1;
+        if (writer->collapse_stacks)
+            others -= others * SIZE_ESTIMATE_COLLAPSED_PERCENT / 100;
+
+        if (writer->idle_thread_frames > 0) {
+            uint64_t idle = others * SIZE_ESTIMATE_IDLE_PERCENT / 100;
+            frames += idle * MIN(depth, writer->idle_thread_frames) + (others - idle) * depth;
+        } else {
+            frames += others * depth;
+        }
+    }
+
+    if (writer->max_report_frames > 0 && frames > writer->max_report_frames)
+        frames = MAX(writer->max_report_frames, depth);
+
+    uint64_t frame_bytes = SIZE_ESTIMATE_FRAME_BYTES;
+    if (writer->symbol_table != NULL)
+        frame_bytes = writer->packed_frames ? SIZE_ESTIMATE_PACKED_FRAME_BYTES : SIZE_ESTIMATE_INTERNED_FRAME_BYTES;
+    size += frames * frame_bytes;
+
+    /* Binary images; the records of images already encoded by an earlier report are sized exactly */
+    if (!writer->image_list_shared) {
+        size_t count = plcrash_async_image_list_count(image_list);
+        uint64_t image_bytes = 0;
+        for (size_t i = 0; i < count; i++) {
+            plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
+            image_bytes += (image->encoded_record != NULL) ? image->encoded_record_size : SIZE_ESTIMATE_IMAGE_BYTES;
+        }
+
+        if (writer->compact_images && count > SIZE_ESTIMATE_REFERENCED_IMAGES && writer->image_flags != NULL) {
+            size += (image_bytes / count) * SIZE_ESTIMATE_REFERENCED_IMAGES;
+            size += (uint64_t) (count - SIZE_ESTIMATE_REFERENCED_IMAGES) * SIZE_ESTIMATE_COMPACT_IMAGE_BYTES;
+        } else {
+            size += image_bytes;
+        }
+    }
+
+    return size;
+}
+
+/**
+ * @internal
+ *
+ * Apply the report size policy (see plcrash_log_writer_set_size_policy()), enabling cheaper options until the
+ * remainder of the report is estimated to fit within @a file's output limit.
+ *
+ * @param writer The writer context.
+ * @param file The output file.
+ * @param image_list The Mach-O image list.
+ * @param thread_count The number of threads to be written, including the crashed thread.
+ * @param[out] configured On return, the writer's configured options, to be restored once the report has been written.
+ *
+ * @return Returns true if any option was changed.
+ */
+static bool plcrash_writer_apply_size_policy (plcrash_log_writer_t *writer, plcrash_async_file_t *file, plcrash_async_image_list_t *image_list,
+                                              uint32_t thread_count, plcrash_writer_size_options_t *configured)
+{
+    configured->packed_frames = writer->packed_frames;
+    configured->collapse_stacks = writer->collapse_stacks;
+    configured->compact_images = writer->compact_images;
+    configured->idle_thread_frames = writer->idle_thread_frames;
+
+    /* Without a limit, the report is never truncated */
+    if (file->limit_bytes == 0)
+        return false;
+
+    uint64_t available = (file->total_bytes < file->limit_bytes) ? (uint64_t) (file->limit_bytes - file->total_bytes) : 0;
+    uint64_t estimate = plcrash_writer_estimate_size(writer, image_list, thread_count);
+    if (estimate <= available)
+        return false;
+
+    PLCF_DEBUG("Estimated report size of %llu bytes exceeds the %llu bytes available, selecting cheaper options", (unsigned long long) estimate, (unsigned long long) available);
+
+    /* Each option is enabled in turn, in order of the least information lost */
+    for (int step = 0; step < 4 && estimate > available; step++) {
+        switch (step) {
+            case 0:
+                if (writer->symbol_table != NULL)
+                    writer->packed_frames = true;
+                break;
+            case 1:
+                writer->collapse_stacks = true;
+                break;
+            case 2:
+                writer->compact_images = true;
+                break;
+            case 3:
+                if (writer->idle_thread_frames == 0 || writer->idle_thread_frames > SIZE_POLICY_IDLE_THREAD_FRAMES)
+                    writer->idle_thread_frames = SIZE_POLICY_IDLE_THREAD_FRAMES;
+                break;
+        }
+
+        estimate = plcrash_writer_estimate_size(writer, image_list, thread_count);
+    }
+
+    if (estimate > available)
+        PLCF_DEBUG("Estimated report size of %llu bytes still exceeds the limit, the report may be truncated", (unsigned long long) estimate);
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Restore the writer options saved by plcrash_writer_apply_size_policy().
+ */
+static void plcrash_writer_restore_size_options (plcrash_log_writer_t *writer, const plcrash_writer_size_options_t *configured) {
+    writer->packed_frames = configured->packed_frames;
+    writer->collapse_stacks = configured->collapse_stacks;
+    writer->compact_images = configured->compact_images;
+    writer->idle_thread_frames = configured->idle_thread_frames;
+}
+
+#pragma mark Version 2 Reports
+
+/**
+ * @internal
+ *
+ * Write the CrashReportV2.RegisterState message for @a thread_state. The architecture message's field numbers follow
+ * the thread state's register order.
+ *
+ * @param file Output file
+ * @param thread_state The thread state.
+ */
+static size_t plcrash_writer_write_v2_registers (plcrash_async_file_t *file, const plcrash_async_thread_state_t *thread_state) {
+    size_t count = plcrash_async_thread_state_get_reg_count(thread_state);
+    uint32_t msgsize = 0;
+    size_t rv = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = 0;
+        if (plcrash_async_thread_state_has_reg(thread_state, (plcrash_regnum_t) i))
+            value = plcrash_async_thread_state_get_reg(thread_state, (plcrash_regnum_t) i);
+        msgsize += (uint32_t) plcrash_writer_pack(NULL, (uint32_t) i + 1, PLPROTOBUF_C_TYPE_UINT64, &value);
+    }
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_REGISTER_STATE_ARCH_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = 0;
+        if (plcrash_async_thread_state_has_reg(thread_state, (plcrash_regnum_t) i))
+            value = plcrash_async_thread_state_get_reg(thread_state, (plcrash_regnum_t) i);
+        rv += plcrash_writer_pack(file, (uint32_t) i + 1, PLPROTOBUF_C_TYPE_UINT64, &value);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Walk and symbolicate the stack of @a thread_state, encoding each frame's PC into @a pcs and its symbol into
+ * @a symbols, as described by the CrashReportV2.Thread documentation. Symbol names are interned in the writer's
+ * symbol string table. If no frame has a symbol, @a symbols is left empty.
+ *
+ * @param writer The writer context.
+ * @param task The task containing the thread.
+ * @param thread_state The thread's state.
+ * @param image_list The image list used to unwind and symbolicate the frames.
+ * @param findContext Symbol lookup cache.
+ * @param pcs The frame PC buffer; must have room for max_thread_frames varints.
+ * @param symbols The frame symbol buffer; must have room for max_thread_frames pairs of varints.
+ */
+static void plcrash_writer_encode_v2_frames (plcrash_log_writer_t *writer, task_t task, plcrash_async_thread_state_t *thread_state,
+                                             plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext,
+                                             PLProtobufCBinaryData *pcs, PLProtobufCBinaryData *symbols)
+{
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+    uint32_t count = 0;
+    bool has_symbols = false;
+
+    pcs->len = 0;
+    symbols->len = 0;
+
+    if ((ferr = plframe_cursor_init(&cursor, task, thread_state, image_list)) != PLFRAME_ESUCCESS) {
+        PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
+        return;
+    }
+
+    plframe_cursor_set_section_cache(&cursor, &findContext->section_cache);
+
+    while (count < writer->max_thread_frames && plcrash_writer_cursor_next(&cursor, false, writer->stack_scan) == PLFRAME_ESUCCESS) {
+        plcrash_greg_t pc = 0;
+        if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
+            PLCF_DEBUG("Could not retrieve frame PC register: %s", plframe_strerror(ferr));
+            break;
+        }
+
+        pcs->len += plcrash_writer_encode_varint(pc, pcs->data + pcs->len);
+        count++;
+
+        /* Symbolicate the frame, interning the symbol's name */
+        struct pl_register_symbol_cb_ctx ctx;
+        ctx.writer = writer;
+        ctx.found = false;
+
+        plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pc);
+        if (image != NULL && writer->symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE)
+            plcrash_async_find_symbol(image, writer->symbol_strategy, findContext, (pl_vm_address_t) pc, plcrash_writer_register_symbol_cb, &ctx);
+
+        if (ctx.found && ctx.address <= pc) {
+            symbols->len += plcrash_writer_encode_varint(ctx.name_index + 1, symbols->data + symbols->len);
+            symbols->len += plcrash_writer_encode_varint(pc - ctx.address, symbols->data + symbols->len);
+            has_symbols = true;
+        } else {
+            symbols->data[symbols->len++] = 0;
+            symbols->data[symbols->len++] = 0;
+        }
+    }
+
+    plframe_cursor_free(&cursor);
+
+    if (!has_symbols)
+        symbols->len = 0;
+}
+
+/**
+ * @internal
+ *
+ * Write a CrashReportV2.Thread message. The thread's frames must have been encoded via plcrash_writer_encode_v2_frames().
+ *
+ * @param file Output file
+ * @param thread_number The thread's number.
+ * @param crashed True if this is the crashed thread.
+ * @param thread_state The thread's state, or NULL if the registers are unavailable.
+ * @param pcs The encoded frame PCs.
+ * @param symbols The encoded frame symbols.
+ */
+static size_t plcrash_writer_write_v2_thread (plcrash_async_file_t *file, uint32_t thread_number, bool crashed,
+                                              const plcrash_async_thread_state_t *thread_state,
+                                              PLProtobufCBinaryData *pcs, PLProtobufCBinaryData *symbols)
+{
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+
+    if (thread_state != NULL) {
+        uint32_t size = (uint32_t) plcrash_writer_write_v2_registers(NULL, thread_state);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREAD_REGISTERS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_v2_registers(file, thread_state);
+    }
+
+    if (pcs->len > 0)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREAD_FRAME_PCS_ID, PLPROTOBUF_C_TYPE_BYTES, pcs);
+
+    if (symbols->len > 0)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREAD_FRAME_SYMBOLS_ID, PLPROTOBUF_C_TYPE_BYTES, symbols);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a version 2 crash report for @a task; see plcrash_log_writer_set_v2_format(). The arguments are those of
+ * plcrash_log_writer_write_task().
+ *
+ * Each message is written exactly once: a thread's stack is walked and symbolicated into the writer's scratch buffers,
+ * from which the thread message is sized and written, and the symbol string table is written last. All other threads
+ * remain suspended until every thread has been written, and the crashed thread is written first.
+ */
+static plcrash_error_t plcrash_writer_write_task_v2 (plcrash_log_writer_t *writer,
+                                                     task_t task,
+                                                     thread_t crashed_thread,
+                                                     plcrash_async_dynloader_t *dynamic_loader,
+                                                     plcrash_async_file_t *file,
+                                                     plcrash_log_signal_info_t *siginfo,
+                                                     plcrash_async_thread_state_t *current_state)
+{
+    thread_act_array_t threads;
+    mach_msg_type_number_t thread_count;
+    PLProtobufCBinaryData pcs;
+    PLProtobufCBinaryData symbols;
+    plcrash_error_t err;
+    void *buf;
+
+    /* Get a list of all images, falling back on an empty image list */
+    plcrash_async_image_list_t *image_list;
+    if ((err = plcrash_async_dynloader_read_image_list(dynamic_loader, writer->allocator, &image_list)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Fetching image list failed, proceeding with an empty image list: %d", err);
+        if ((image_list = plcrash_async_image_list_new_empty(writer->allocator)) == NULL) {
+            PLCF_DEBUG("Allocation of our empty image list failed unexpectedly");
+            plcrash_async_allocator_reset(writer->allocator);
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    /* The string table and frame buffers are required; without them, no frames could be written */
+    if ((err = plcrash_writer_symbol_table_new(&writer->symbol_table, writer->allocator)) != PLCRASH_ESUCCESS) {
+        writer->symbol_table = NULL;
+        goto cleanup_image_list;
+    }
+
+    if ((err = plcrash_async_allocator_alloc(writer->allocator, &buf, writer->max_thread_frames * PLCRASH_WRITER_MAX_VARINT_BYTES * 3)) != PLCRASH_ESUCCESS)
+        goto cleanup_image_list;
+    pcs.data = buf;
+    symbols.data = pcs.data + writer->max_thread_frames * PLCRASH_WRITER_MAX_VARINT_BYTES;
+
+    /* Set up a symbol-finding context, borrowing the writer's standby cache if available */
+    plcrash_async_symbol_cache_t localFindContext;
+    plcrash_async_symbol_cache_t *findContext = &localFindContext;
+    if (writer->has_standby_cache) {
+        findContext = &writer->standby_cache;
+    } else if ((err = plcrash_async_symbol_cache_init(findContext)) == PLCRASH_ESUCCESS) {
+        plcrash_async_symbol_cache_set_shared_cache(findContext, writer->shared_cache_info);
+    } else {
+        goto cleanup_image_list;
+    }
+
+    /* Write the file header */
+    {
+        uint8_t version = PLCRASH_REPORT_FILE_VERSION_V2;
+
+        plcrash_async_file_write(file, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
+        plcrash_async_file_write(file, &version, sizeof(version));
+    }
+
+    /* The host information flag is read once, so that the sizing and writing passes agree */
+    bool host_info_ready = writer->host_info_ready;
+    OSMemoryBarrier();
+
+    time_t timestamp;
+    if (time(&timestamp) == (time_t)-1) {
+        PLCF_DEBUG("Failed to fetch timestamp: %s", strerror(errno));
+        timestamp = 0;
+    }
+
+    /* Report, host, process and signal info */
+    {
+        uint32_t size;
+
+        size = plcrash_writer_write_report_info(NULL, writer);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_REPORT_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_report_info(file, writer);
+
+        size = plcrash_writer_write_system_info(NULL, writer, host_info_ready, timestamp);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_system_info(file, writer, host_info_ready, timestamp);
+
+        size = plcrash_writer_write_machine_info(NULL, writer, host_info_ready);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_machine_info(file, writer, host_info_ready);
+
+        size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+
+        /* Process info; only written once the host information is available */
+        if (host_info_ready) {
+            size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id,
+                                                     writer->process_info.process_path, writer->process_info.parent_process_name,
+                                                     writer->process_info.parent_process_id, writer->process_info.native,
+                                                     writer->process_info.start_time);
+            plcrash_writer_pack(file, PLCRASH_PROTO_V2_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id,
+                                              writer->process_info.process_path, writer->process_info.parent_process_name,
+                                              writer->process_info.parent_process_id, writer->process_info.native,
+                                              writer->process_info.start_time);
+        }
+
+        size = plcrash_writer_write_signal(NULL, siginfo);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_SIGNAL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_signal(file, siginfo);
+    }
+
+    plcrash_async_file_flush(file);
+
+    /* Fetch the thread list, and suspend all threads other than our own */
+    if (task_threads(task, &threads, &thread_count) != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetching thread list failed");
+        thread_count = 0;
+        threads = NULL;
+    }
+
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] != writer->self_thread)
+            thread_suspend(threads[i]);
+    }
+
+    /* Write the crashed thread, followed by all other threads */
+    for (int pass = 0; pass < 2; pass++) {
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            plcrash_async_thread_state_t thread_state;
+            bool crashed = (threads[i] == crashed_thread);
+            uint32_t size;
+
+            if (crashed != (pass == 0))
+                continue;
+
+            /* The current thread's stack may only be walked from its provided state */
+            if (threads[i] == writer->self_thread) {
+                if (current_state == NULL)
+                    continue;
+                thread_state = *current_state;
+            } else if ((err = plcrash_async_thread_state_mach_thread_init(&thread_state, threads[i])) != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to fetch state for thread %u: %d", (unsigned int) i, err);
+                continue;
+            }
+
+            plcrash_writer_encode_v2_frames(writer, task, &thread_state, image_list, findContext, &pcs, &symbols);
+
+            size = (uint32_t) plcrash_writer_write_v2_thread(NULL, i, crashed, &thread_state, &pcs, &symbols);
+            plcrash_writer_pack(file, PLCRASH_PROTO_V2_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_v2_thread(file, i, crashed, &thread_state, &pcs, &symbols);
+        }
+
+        plcrash_async_file_flush(file);
+    }
+
+    /* The exception's frames are symbolicated into the same string table */
+    if (writer->uncaught_exception.has_exception) {
+        uint32_t size = (uint32_t) plcrash_writer_write_exception(NULL, writer, image_list, findContext);
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_exception(file, writer, image_list, findContext);
+    }
+
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] != writer->self_thread)
+            thread_resume(threads[i]);
+
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    }
+
+    if (threads != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) threads, sizeof(thread_t) * thread_count);
+
+    /* Binary images */
+    for (size_t i = 0; i < plcrash_async_image_list_count(image_list); i++) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
+        uint32_t size = (uint32_t) plcrash_writer_write_binary_image(NULL, image);
+
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_binary_image(file, image);
+    }
+
+    /* The string table; this must be written last, once all symbols referenced by the report have been interned */
+    for (uint32_t i = 0; i < writer->symbol_table->count; i++)
+        plcrash_writer_pack(file, PLCRASH_PROTO_V2_STRINGS_ID, PLPROTOBUF_C_TYPE_STRING, writer->symbol_table->names + writer->symbol_table->offsets[i]);
+
+    /* The section cache references this report's image list, and must be emptied before it is freed */
+    if (findContext == &localFindContext)
+        plcrash_async_symbol_cache_free(findContext);
+    else
+        plcrash_async_macho_section_cache_free(&findContext->section_cache);
+
+    err = PLCRASH_ESUCCESS;
+
+cleanup_image_list:
+    writer->symbol_table = NULL;
+    plcrash_async_image_list_free(image_list);
+    plcrash_async_allocator_reset(writer->allocator);
+    return err;
+}
+
+/**
+ * Write the crash report. All other running threads are suspended while the crash report is generated.
+ *
+ * @param writer The writer context.
+ * @param crashed_thread The crashed thread. 
+ * @param dynamic_loader A borrowed reference to the target's dynamic loader.
+ * @param file The output file.
+ * @param siginfo Signal information.
+ * @param current_state If non-NULL, the given thread state will be used when walking the current thread. The state must remain
+ * valid until this function returns. Generally, this state will be generated by a signal handler, or via a
+ * context-generating trampoline such as plcrash_log_writer_write_curthread(). If NULL, a thread dump for the current
+ * thread will not be written. If @a crashed_thread is the current thread (as returned by mach_thread_self()), this
+ * value <em>must</em> be provided.
+ *
+ * @note If @a file supports positional writes (see plcrash_async_file_seekable()), thread and exception messages will
+ * be written in a single pass, with their length prefixes backpatched once written. Otherwise, each message is first
+ * sized and then written, requiring that every thread's stack be walked and symbolicated twice.
+ *
+ * @note The crashed thread, and the images it references, are written and flushed to @a file before the remaining
+ * threads are suspended.
+ *
+ * @note If a stack snapshot size has been configured via plcrash_log_writer_set_stack_snapshot_size(), all other threads
+ * are only suspended while their state and stacks are captured.
+ *
+ * @note If symbol interning has been enabled via plcrash_log_writer_set_symbol_interning(), the symbol string table
+ * is written as the report's final message.
+ *
+ * @note If a time budget has been configured via plcrash_log_writer_set_time_budget(), the crashed thread is written
+ * prior to the binary images and exception, and all other threads are written last.
+ *
+ * @note The report's required messages -- the system, application and signal information -- are written and flushed
+ * before any thread is written, and each subsequent top-level message group is flushed once written. A report that is
+ * truncated by the termination of the handler may be decoded by PLCrashReport, which discards any incomplete trailing
+ * message.
+ */
+plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
+                                          thread_t crashed_thread,
+                                          plcrash_async_dynloader_t *dynamic_loader,
+                                          plcrash_async_file_t *file,
+                                          plcrash_log_signal_info_t *siginfo,
+                                          plcrash_async_thread_state_t *current_state)
+{
+    return plcrash_log_writer_write_task(writer, mach_task_self(), crashed_thread, dynamic_loader, file, siginfo, current_state);
+}
+
+/**
+ * Write a crash report for @a task. This behaves identically to plcrash_log_writer_write(), but may be used to write
+ * a report for another task -- such as a crashed process whose exception was delivered to a helper process -- from a
+ * healthy address space.
+ *
+ * When writing a report for another task, @a dynamic_loader must have been created for @a task, and the writer's
+ * process information should be replaced via plcrash_log_writer_set_target_process().
+ *
+ * @param writer The writer context.
+ * @param task The target task. The task's threads are suspended while the report is generated.
+ * @param crashed_thread The crashed thread, in @a task.
+ * @param dynamic_loader A borrowed reference to the target's dynamic loader.
+ * @param file The output file.
+ * @param siginfo Signal information.
+ * @param current_state The current thread's state, or NULL. Ignored if @a task is not the current task. See
+ * plcrash_log_writer_write().
+ */
+plcrash_error_t plcrash_log_writer_write_task (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t crashed_thread,
+                                               plcrash_async_dynloader_t *dynamic_loader,
+                                               plcrash_async_file_t *file,
+                                               plcrash_log_signal_info_t *siginfo,
+                                               plcrash_async_thread_state_t *current_state)
+{
+    thread_act_array_t threads;
+    mach_msg_type_number_t thread_count;
+    plcrash_error_t err;
+
+    /* Version 2 reports are written by a separate path; none of the options below apply to them */
+    if (writer->v2_format) {
+        writer->image_flags = NULL;
+        writer->self_thread = pl_mach_thread_self();
+        PLCF_ASSERT(writer->self_thread != crashed_thread || current_state != NULL);
+
+        if (task != mach_task_self())
+            current_state = NULL;
+        writer->task = task;
+
+        plcrash_async_mobject_region_cache_reset();
+        return plcrash_writer_write_task_v2(writer, task, crashed_thread, dynamic_loader, file, siginfo, current_state);
+    }
+
+    /* Note the start time; the time budget (if any) is measured from here */
+    uint64_t start_time = mach_absolute_time();
+
+    /* Local memory mappings may have changed since the last report was written; discard any cached regions */
+    plcrash_async_mobject_region_cache_reset();
+
+    /* If enabled, record phase timings and counters for the report's writer_stats message */
+    plcrash_async_instrumentation_t instrumentation;
+    if (writer->instrument) {
+        plcrash_async_instrumentation_init(&instrumentation);
+        plcrash_async_instrumentation_set_current(&instrumentation);
+    }
+
+    /* If configured, buffer debug output until the report has been written */
+    if (writer->debug_log != NULL)
+        plcrash_async_debug_log_set_current(writer->debug_log);
+
+    /* Fetch the current thread's port once; it is compared against each of the target's threads throughout the report */
+    writer->self_thread = pl_mach_thread_self();
+
+    /* A context must be supplied if the current thread is marked as the crashed thread; otherwise,
+     * the thread's stack can not be safely walked. */
+    PLCF_ASSERT(writer->self_thread != crashed_thread || current_state != NULL);
+
+    /* The current thread's state is only meaningful when writing a report for our own task */
+    if (task != mach_task_self())
+        current_state = NULL;
+    writer->task = task;
+    
+    /* Get a list of all images. If this fails (and it shouldn't), we log the error and instead operate on an empty
+     * image list. This will greatly reduce the utility of the report, but it's better than producing no report
+     * at all. */
+    plcrash_async_image_list_t *image_list;
+    uint64_t phase_start = plcrash_async_instrumentation_begin();
+    err = plcrash_async_dynloader_read_image_list(dynamic_loader, writer->allocator, &image_list);
+    plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_IMAGE_LIST, phase_start);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Fetching image list failed, proceeding with an empty image list: %d", err);
+        
+        
+        /* Allocate an empty image list; outside of a compile-time configuration error, this should never fail. If it does
+         * fail, our environment is messed up enough that terminating without writing a report is likely justified */
+        if ((image_list = plcrash_async_image_list_new_empty(writer->allocator)) == NULL) {
+            PLCF_DEBUG("Allocation of our empty image list failed unexpectedly");
+            if (writer->instrument)
+                plcrash_async_instrumentation_set_current(NULL);
+            plcrash_writer_finish_debug_log(writer, NULL);
+            plcrash_async_allocator_reset(writer->allocator);
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    /* If a shared image list has been written, and no image has since been loaded or unloaded, the report references
+     * the shared list in place of writing its binary images. The generation is checked after the image list is read,
+     * ensuring that the list used to symbolicate the report matches the shared list. */
+    writer->image_list_shared = false;
+    if (writer->share_image_list) {
+        uint32_t generation;
+        if (plcrash_async_dynloader_image_generation(dynamic_loader, &generation) && generation == writer->shared_image_generation)
+            writer->image_list_shared = true;
+    }
+
+    /* If symbol interning is enabled, set up the report's symbol string table. This must be done prior to starting any
+     * unwind workers. If allocation fails, symbol names are simply written inline. */
+    writer->symbol_table = NULL;
+    if (writer->intern_symbols) {
+        if ((err = plcrash_writer_symbol_table_new(&writer->symbol_table, writer->allocator)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not allocate symbol string table, symbol names will be written inline: %d", err);
+            writer->symbol_table = NULL;
+        }
+    }
+
+    /* Set up the DWARF and compact unwind caches; this too must be done prior to starting any unwind workers. If
+     * allocation fails, each frame's unwind data is simply looked up from scratch. */
+    writer->dwarf_cache = NULL;
+    writer->compact_unwind_cache = NULL;
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if ((err = plframe_dwarf_cache_new(&writer->dwarf_cache, writer->allocator)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate DWARF unwind cache, proceeding without caching: %d", err);
+        writer->dwarf_cache = NULL;
+    } else if ((err = plframe_dwarf_cache_set_budget(writer->dwarf_cache, &writer->cache_budget)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("DWARF unwind cache exceeds the cache budget, proceeding without caching: %d", err);
+        plframe_dwarf_cache_free(writer->dwarf_cache, writer->allocator);
+        writer->dwarf_cache = NULL;
+    }
+
+    if ((err = plframe_compact_unwind_cache_new(&writer->compact_unwind_cache, writer->allocator)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate compact unwind cache, proceeding without caching: %d", err);
+        writer->compact_unwind_cache = NULL;
+    } else if ((err = plframe_compact_unwind_cache_set_budget(writer->compact_unwind_cache, &writer->cache_budget)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Compact unwind cache exceeds the cache budget, proceeding without caching: %d", err);
+        plframe_compact_unwind_cache_free(writer->compact_unwind_cache, writer->allocator);
+        writer->compact_unwind_cache = NULL;
+    }
+#endif
+
+    /* Set up a symbol-finding context, using the writer's pre-initialized standby cache if available. This is done prior
+     * to starting any unwind workers or suspending any threads, allowing a failure to be handled without tearing either
+     * down. */
+    plcrash_async_symbol_cache_t localFindContext;
+    plcrash_async_symbol_cache_t *findContext;
+    if (writer->has_standby_cache) {
+        findContext = &writer->standby_cache;
+        writer->has_standby_cache = false;
+        err = PLCRASH_ESUCCESS;
+    } else {
+        findContext = &localFindContext;
+        err = plcrash_async_symbol_cache_init(findContext);
+        if (err == PLCRASH_ESUCCESS) {
+            plcrash_async_symbol_cache_set_shared_cache(findContext, writer->shared_cache_info);
+            plcrash_async_symbol_cache_set_budget(findContext, &writer->cache_budget);
+        }
+    }
+
+    /* Abort if it failed, although that should never actually happen, ever. */
+    if (err != PLCRASH_ESUCCESS) {
+        if (writer->symbol_table != NULL) {
+            plcrash_writer_symbol_table_free(writer->symbol_table, writer->allocator);
+            writer->symbol_table = NULL;
+        }
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        if (writer->dwarf_cache != NULL) {
+            plframe_dwarf_cache_free(writer->dwarf_cache, writer->allocator);
+            writer->dwarf_cache = NULL;
+        }
+        if (writer->compact_unwind_cache != NULL) {
+            plframe_compact_unwind_cache_free(writer->compact_unwind_cache, writer->allocator);
+            writer->compact_unwind_cache = NULL;
+        }
+#endif
+        if (writer->instrument)
+            plcrash_async_instrumentation_set_current(NULL);
+        plcrash_writer_finish_debug_log(writer, NULL);
+
+        /* Release the image list's read reference on the image monitor, and then all scratch allocations */
+        plcrash_async_image_list_free(image_list);
+        plcrash_async_allocator_reset(writer->allocator);
+        return err;
+    }
+
+    /* If pipelined or parallel unwinding is enabled, start our unwind workers. This must be done prior to suspending the
+     * target's threads. If the workers can't be started, we simply fall back on unwinding all stacks on this thread. */
+    plcrash_writer_unwind_pool_t *pool = NULL;
+    if (writer->pipelined || writer->unwind_worker_count > 1) {
+        if ((err = plcrash_writer_unwind_pool_new(&pool, writer, image_list, writer->unwind_worker_count, writer->pipelined)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not start unwind workers, stacks will be unwound serially: %d", err);
+            pool = NULL;
+        }
+    }
+
+    /* If thread messages must be sized prior to being written, identical stacks are to be collapsed, or frames are to be
+     * packed, set up a frame memo; this allows us to avoid walking and symbolicating each thread's stack twice. If
+     * allocation fails, we simply fall back on walking the stacks twice, stacks are not collapsed, and frames are written
+     * unpacked. */
+    plcrash_writer_frame_memo_t frame_memo;
+    plcrash_writer_frame_memo_t *memo = NULL;
+    if (!plcrash_writer_use_single_pass(file) || writer->collapse_stacks || writer->packed_frames) {
+        if ((err = plcrash_writer_frame_memo_init(&frame_memo, writer->allocator, MAX_MEMOIZED_SYMBOL_BYTES)) == PLCRASH_ESUCCESS) {
+            memo = &frame_memo;
+        } else {
+            PLCF_DEBUG("Could not allocate frame memo, stacks will be walked twice: %d", err);
+        }
+    }
+
+    /* If enabled, record the unique stacks written, allowing identical stacks to be collapsed */
+    writer->stack_table = NULL;
+    if (writer->collapse_stacks) {
+        void *buf;
+        if ((err = plcrash_async_allocator_alloc(writer->allocator, &buf, sizeof(plcrash_writer_stack_table_t))) == PLCRASH_ESUCCESS) {
+            writer->stack_table = buf;
+            writer->stack_table->count = 0;
+        } else {
+            PLCF_DEBUG("Could not allocate stack table, identical stacks will not be collapsed: %d", err);
+        }
+    }
+
+    /* Cache the dispatch queue labels read for each thread. If allocation fails, queue labels are not written. */
+    writer->queue_table = NULL;
+    {
+        void *buf;
+        if ((err = plcrash_async_allocator_alloc(writer->allocator, &buf, sizeof(plcrash_writer_queue_table_t))) == PLCRASH_ESUCCESS) {
+            writer->queue_table = buf;
+            writer->queue_table->count = 0;
+        } else {
+            PLCF_DEBUG("Could not allocate queue label table, queue labels will not be written: %d", err);
+        }
+    }
+
+    /* If idle threads are to be unwound shallowly, resolve the syscall stubs in which they park */
+    writer->idle_stub_count = 0;
+    if (writer->idle_thread_frames > 0)
+        plcrash_writer_resolve_idle_stubs(writer, image_list);
+
+    /* Track the images referenced by the report, allowing the referenced images to be written ahead of the remaining
+     * images. If allocation fails, all images are simply written in full by the first pass. */
+    writer->image_flags = NULL;
+    if (plcrash_async_image_list_count(image_list) > 0) {
+        void *buf;
+        size_t count = plcrash_async_image_list_count(image_list);
+        if ((err = plcrash_async_allocator_alloc(writer->allocator, &buf, count)) == PLCRASH_ESUCCESS) {
+            plcrash_async_memset(buf, 0, count);
+            writer->image_flags = buf;
+        } else {
+            PLCF_DEBUG("Could not allocate image flags, all images will be written in full: %d", err);
+        }
+    }
+
+    /* Write the file header */
+    {
+        uint8_t version = PLCRASH_REPORT_FILE_VERSION;
+
+        /* Write the magic string (with no trailing NULL) and the version number */
+        plcrash_async_file_write(file, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
+        plcrash_async_file_write(file, &version, sizeof(version));
+    }
+
+    /* Report Info */
+    {
+        uint32_t size;
+        
+        /* Determine size */
+        size = plcrash_writer_write_report_info(NULL, writer);
+        
+        /* Write message */
+        plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_report_info(file, writer);
+    }
+
+    /* Shared image list reference */
+    if (writer->image_list_shared) {
+        uint32_t size;
+
+        /* Determine size */
+        size = plcrash_writer_write_shared_image_list(NULL, writer->shared_image_session, writer->shared_image_generation);
+
+        /* Write message */
+        plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_IMAGE_LIST_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_shared_image_list(file, writer->shared_image_session, writer->shared_image_generation);
+    }
+
+    /* Crash loop state */
+    if (writer->has_crash_loop) {
+        uint32_t size;
+
+        /* Determine size */
+        size = plcrash_writer_write_crash_loop(NULL, writer);
+
+        /* Write message */
+        plcrash_writer_pack(file, PLCRASH_PROTO_CRASH_LOOP_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_crash_loop(file, writer);
+    }
+
+    /* Breadcrumbs. These are written early, and with a single copy of the ring, so that they are available even
+     * should the remainder of the report fail to be written. */
+    plcrash_async_breadcrumbs_t *breadcrumbs = writer->breadcrumbs;
+    if (breadcrumbs != NULL) {
+        PLProtobufCBinaryData ring;
+        size_t ring_length;
+
+        ring.data = (void *) plcrash_async_breadcrumbs_snapshot(breadcrumbs, &ring_length);
+        ring.len = ring_length;
+        plcrash_writer_pack(file, PLCRASH_PROTO_BREADCRUMBS_ID, PLPROTOBUF_C_TYPE_BYTES, &ring);
+    }
+
+    /* The host information may not yet have been published by plcrash_log_writer_populate_host_info(); if not, only
+     * what can be determined from within the crash handler is written. The flag is read once, so that the sizing and
+     * writing passes below agree. */
+    bool host_info_ready = writer->host_info_ready;
+    OSMemoryBarrier();
+
+    /* Must stay the same across both calls, so get the timestamp here */
+    time_t timestamp;
+    if (time(&timestamp) == (time_t)-1) {
+        PLCF_DEBUG("Failed to fetch timestamp: %s", strerror(errno));
+        timestamp = 0;
+    }
+
+    if (host_info_ready && writer->static_sections.data != NULL) {
+        /* System, machine, app and process info, pre-encoded when the host information was published */
+        plcrash_writer_write_static_sections(file, writer, timestamp);
+    } else {
+        /* System Info */
+        {
+            uint32_t size;
+
+            /* Determine size */
+            size = plcrash_writer_write_system_info(NULL, writer, host_info_ready, timestamp);
+        
+            /* Write message */
+            plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_system_info(file, writer, host_info_ready, timestamp);
+        }
+    
+        /* Machine Info */
+        {
+            uint32_t size;
+
+            /* Determine size */
+            size = plcrash_writer_write_machine_info(NULL, writer, host_info_ready);
+
+            /* Write message */
+            plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_machine_info(file, writer, host_info_ready);
+        }
+
+        /* App info */
+        {
+            uint32_t size;
+
+            /* Determine size */
+            size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+        
+            /* Write message */
+            plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+        }
+    
+        /* Process info */
+        {
+            uint32_t size;
+            const char *process_name = NULL;
+            const char *process_path = NULL;
+            const char *parent_process_name = NULL;
+            pid_t process_id = getpid();
+            pid_t parent_process_id = getppid();
+            bool native = true;
+            time_t start_time = 0;
+
+            /* Without the host information, only the process ID of another task can be determined */
+            if (task != mach_task_self()) {
+                if (pid_for_task(task, &process_id) != KERN_SUCCESS)
+                    process_id = 0;
+                parent_process_id = 0;
+            }
+
+            if (host_info_ready) {
+                process_name = writer->process_info.process_name;
+                process_path = writer->process_info.process_path;
+                parent_process_name = writer->process_info.parent_process_name;
+                process_id = writer->process_info.process_id;
+                parent_process_id = writer->process_info.parent_process_id;
+                native = writer->process_info.native;
+                start_time = writer->process_info.start_time;
+            }
+
+            /* Determine size */
+            size = plcrash_writer_write_process_info(NULL, process_name, process_id, process_path, parent_process_name,
+                                                     parent_process_id, native, start_time);
+
+            /* Write message */
+            plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_process_info(file, process_name, process_id, process_path, parent_process_name,
+                                              parent_process_id, native, start_time);
+        }
+    }
+
+    /* Signal */
+    {
+        uint32_t size;
+        
+        /* Calculate the message size */
+        size = plcrash_writer_write_signal(NULL, siginfo);
+        plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_signal(file, siginfo);
+    }
+
+    /* Each of the report's required messages has now been written; flush them, allowing a report that is truncated
+     * by the termination of the handler to be decoded. The remaining top-level messages are flushed as each is
+     * completed. */
+    plcrash_async_file_flush(file);
+
+    /* If writing concurrently with other writers, register our threads prior to fetching the thread list; a concurrent
+     * writer will not suspend a thread once registered. */
+    if (writer->concurrent)
+        plcrash_writer_concurrent_set_threads_registered(writer->self_thread, pool, true);
+
+    /* Get a list of all threads */
+    if (task_threads(task, &threads, &thread_count) != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetching thread list failed");
+        thread_count = 0;
+    }
+
+    /* Release the threads of any concurrent writers (including our own unwind workers); they will be neither suspended
+     * nor written. The allocated size of the thread array is retained for its deallocation. */
+    mach_msg_type_number_t thread_array_count = thread_count;
+    if (writer->concurrent)
+        thread_count = plcrash_writer_omit_concurrent_threads(threads, thread_count, crashed_thread, writer->self_thread);
+
+    /* If a thread filter is set (or a reduced crash loop report is being written), release all but the selected
+     * threads and the crashed thread; the remainder of the report operates only on the retained threads. */
+    if (writer->thread_filter != NULL || (writer->has_crash_loop && writer->crash_loop_reduced)) {
+        mach_msg_type_number_t selected = 0;
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            bool keep = (threads[i] == crashed_thread);
+            for (uint32_t j = 0; j < writer->thread_filter_count && !keep; j++)
+                keep = (threads[i] == writer->thread_filter[j]);
+
+            if (keep) {
+                threads[selected++] = threads[i];
+            } else {
+                mach_port_deallocate(mach_task_self(), threads[i]);
+            }
+        }
+        thread_count = selected;
+    }
+
+    /* If enabled, select cheaper options should the report be estimated to exceed the output limit. Any state required
+     * by the selected options that was not set up above is set up here; should that fail, the option simply has no
+     * effect. */
+    plcrash_writer_size_options_t configured_options;
+    bool downgraded = false;
+    if (writer->size_policy && plcrash_writer_apply_size_policy(writer, file, image_list, thread_count, &configured_options)) {
+        downgraded = true;
+
+        if (memo == NULL && (writer->collapse_stacks || writer->packed_frames)) {
+            if (plcrash_writer_frame_memo_init(&frame_memo, writer->allocator, MAX_MEMOIZED_SYMBOL_BYTES) == PLCRASH_ESUCCESS)
+                memo = &frame_memo;
+        }
+
+        if (writer->collapse_stacks && writer->stack_table == NULL) {
+            void *buf;
+            if (plcrash_async_allocator_alloc(writer->allocator, &buf, sizeof(plcrash_writer_stack_table_t)) == PLCRASH_ESUCCESS) {
+                writer->stack_table = buf;
+                writer->stack_table->count = 0;
+            }
+        }
+
+        if (writer->idle_thread_frames > 0 && writer->idle_stub_count == 0)
+            plcrash_writer_resolve_idle_stubs(writer, image_list);
+    }
+
+    /* Write the crashed thread, along with the images it references, before suspending any other threads; this is the
+     * report's most important data, and will already be on disk should the handler be terminated while the remainder
+     * of the report is written. If the crashed thread is not the current thread, it alone is suspended while it is
+     * written; the remaining threads are suspended below. */
+    bool crashed_early = false;
+    uint32_t report_frames = 0;
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] == crashed_thread && crashed_thread != MACH_PORT_NULL)
+            crashed_early = true;
+    }
+
+    if (crashed_early) {
+        if (crashed_thread != writer->self_thread)
+            thread_suspend(crashed_thread);
+
+        plcrash_writer_write_threads(file, writer, threads, thread_count, crashed_thread, current_state, NULL, pool, NULL, image_list, findContext, memo,
+                                     PLCRASH_WRITER_THREADS_CRASHED, start_time, &report_frames);
+
+        phase_start = plcrash_async_instrumentation_begin();
+        plcrash_writer_write_binary_images(file, writer, image_list, false);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_BINARY_IMAGES, phase_start);
+
+        plcrash_async_file_flush(file);
+    }
+
+    /* Suspend all but the current thread (and our unwind workers); if written above, the crashed thread has already
+     * been suspended. */
+    phase_start = plcrash_async_instrumentation_begin();
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (crashed_early && threads[i] == crashed_thread)
+            continue;
+
+        if (threads[i] != writer->self_thread && !plcrash_writer_unwind_pool_contains_thread(pool, threads[i]))
+            thread_suspend(threads[i]);
+    }
+
+    /* Capture each suspended thread's state once; all subsequent passes over the threads use the captured state. The
+     * snapshot storage is sized from the first captured state; if allocation fails, each thread's state is instead
+     * fetched as the thread is written. */
+    plcrash_writer_captured_states_t captured_states = { .snapshots = NULL, .stride = 0 };
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        plcrash_async_thread_state_t state;
+
+        if (threads[i] == writer->self_thread || plcrash_writer_unwind_pool_contains_thread(pool, threads[i]))
+            continue;
+
+        if ((err = plcrash_async_thread_state_mach_thread_init(&state, threads[i])) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to capture state for thread %u: %d", (unsigned int) i, err);
+            continue;
+        }
+
+        if (captured_states.snapshots == NULL) {
+            void *buf;
+            size_t stride = plcrash_async_thread_snapshot_size(&state);
+            if (plcrash_async_allocator_alloc(writer->allocator, &buf, stride * thread_count) != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Could not allocate thread state storage, thread states will be fetched as required");
+                break;
+            }
+
+            captured_states.snapshots = buf;
+            captured_states.stride = stride;
+            for (mach_msg_type_number_t j = 0; j < thread_count; j++)
+                ((plcrash_async_thread_snapshot_t *) (captured_states.snapshots + stride * j))->valid_regs = 0;
+        }
+
+        plcrash_async_thread_snapshot_init((plcrash_async_thread_snapshot_t *) (captured_states.snapshots + captured_states.stride * i), &state);
+    }
+
+    /* Gather the threads' scheduling state and CPU usage in the same pass, while the threads are suspended */
+    plcrash_writer_thread_metadata_t thread_metadata = { .records = NULL, .size = 0 };
+    if (writer->thread_metadata)
+        plcrash_writer_thread_metadata_capture(&thread_metadata, writer, threads, thread_count, current_state, pool);
+    plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_THREAD_SUSPEND, phase_start);
+
+    /* With the target's threads suspended, its mappings are stable; snapshot the VM regions, allowing reads of the
+     * task's memory to be validated without a kernel trap. The map is only installed while the threads remain
+     * suspended. */
+    plcrash_async_region_map_t region_map;
+    bool have_region_map = false;
+    if ((err = plcrash_async_region_map_init(&region_map, writer->allocator, task)) == PLCRASH_ESUCCESS) {
+        plcrash_async_region_map_set_current(&region_map);
+        have_region_map = true;
+    } else {
+        PLCF_DEBUG("Could not snapshot the task's VM regions, proceeding without a region map: %d", err);
+    }
+
+    /* Set up the per-thread jobs required by the unwind workers and stack snapshots. */
+    plcrash_writer_thread_job_t *jobs = NULL;
+    uint32_t job_count = 0;
+    if ((pool != NULL || writer->stack_snapshot_size > 0) && thread_count > 0) {
+        void *buf;
+        if (plcrash_async_allocator_alloc(writer->allocator, &buf, sizeof(*jobs) * thread_count) == PLCRASH_ESUCCESS) {
+            jobs = buf;
+            for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+                if (plcrash_writer_thread_job_init(&jobs[job_count], writer, threads[i], job_count, crashed_thread, current_state,
+                                                   plcrash_writer_captured_state(&captured_states, i), pool))
+                    job_count++;
+            }
+        } else {
+            PLCF_DEBUG("Could not allocate thread jobs, stacks will be unwound serially while suspended");
+        }
+    }
+
+    /* Snapshot the threads' state and stacks, and then resume them; the remainder of the report is written
+     * using the snapshots. */
+    bool threads_resumed = false;
+    vm_address_t snapshot_buffer = 0x0;
+    vm_size_t snapshot_buffer_size = 0;
+    if (jobs != NULL && job_count > 0 && writer->stack_snapshot_size > 0) {
+        vm_size_t stack_size = round_page(writer->stack_snapshot_size);
+        snapshot_buffer_size = stack_size * job_count;
+
+        if (vm_allocate(mach_task_self(), &snapshot_buffer, snapshot_buffer_size, VM_FLAGS_ANYWHERE) == KERN_SUCCESS) {
+            for (uint32_t i = 0; i < job_count; i++)
+                plcrash_writer_thread_job_snapshot(&jobs[i], task, (void *) (snapshot_buffer + (stack_size * i)), stack_size);
+
+            /* Once resumed, the threads may modify the task's mappings */
+            if (have_region_map)
+                plcrash_async_region_map_set_current(NULL);
+
+            for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+                if (threads[i] != writer->self_thread && !plcrash_writer_unwind_pool_contains_thread(pool, threads[i]))
+                    thread_resume(threads[i]);
+            }
+            threads_resumed = true;
+        } else {
+            PLCF_DEBUG("Could not allocate stack snapshot buffer, threads will remain suspended");
+            snapshot_buffer = 0x0;
+            snapshot_buffer_size = 0;
+        }
+    }
+
+    /* Hand the threads off to the unwind workers, and wait for them to finish. A pipelined pool's jobs are instead
+     * received as each thread is written. */
+    if (pool != NULL) {
+        plcrash_writer_unwind_pool_dispatch(pool, jobs, job_count);
+        if (!pool->pipelined)
+            plcrash_writer_unwind_pool_join(pool);
+    }
+
+    /* Threads. If the crashed thread was not written above and the report is written under a time budget, the crashed
+     * thread is written first, followed by the binary images and exception; the remaining threads are written last,
+     * as the remaining budget allows. */
+    bool crashed_first = crashed_early || (writer->time_budget > 0);
+    if (!crashed_early) {
+        plcrash_writer_write_threads(file, writer, threads, thread_count, crashed_thread, current_state, &captured_states, pool, jobs, image_list, findContext, memo,
+                                     crashed_first ? PLCRASH_WRITER_THREADS_CRASHED : PLCRASH_WRITER_THREADS_ALL, start_time, &report_frames);
+
+        /* Binary Images. The full records of the images referenced by the threads written thus far are written here;
+         * the exception and any remaining threads may reference further images, which are written once all threads
+         * have been written. */
+        phase_start = plcrash_async_instrumentation_begin();
+        plcrash_writer_write_binary_images(file, writer, image_list, false);
+        plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_BINARY_IMAGES, phase_start);
+
+        plcrash_async_file_flush(file);
+    }
+
+    /* Exception */
+    if (writer->uncaught_exception.has_exception) {
+        uint32_t size;
+
+        if (plcrash_writer_use_single_pass(file)) {
+            off_t position;
+
+            /* Write the message, backpatching the size */
+            plcrash_writer_pack_deferred_length(file, PLCRASH_PROTO_EXCEPTION_ID, &position);
+            size = plcrash_writer_write_exception(file, writer, image_list, findContext);
+            plcrash_writer_pack_fixup_length(file, position, size);
+        } else {
+            /* Calculate the message size */
+            size = plcrash_writer_write_exception(NULL, writer, image_list, findContext);
+            plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_exception(file, writer, image_list, findContext);
+        }
+
+        plcrash_async_file_flush(file);
+    }
+
+    /* Crashed thread memory. The target's threads have not been resumed unless stack snapshots are enabled. */
+    if (writer->memory_budget > 0) {
+        const plcrash_async_thread_snapshot_t *crashed_state = NULL;
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            if (threads[i] == crashed_thread)
+                crashed_state = plcrash_writer_captured_state(&captured_states, i);
+        }
+
+        plcrash_writer_write_memory_regions(file, writer, task, crashed_thread, current_state, crashed_state);
+        plcrash_async_file_flush(file);
+    }
+
+    /* The remaining threads */
+    if (crashed_first) {
+        plcrash_writer_write_threads(file, writer, threads, thread_count, crashed_thread, current_state, &captured_states, pool, jobs, image_list, findContext, memo,
+                                     PLCRASH_WRITER_THREADS_NOT_CRASHED, start_time, &report_frames);
+        plcrash_async_file_flush(file);
+    }
+
+    /* Thread metadata */
+    if (thread_metadata.records != NULL) {
+        uint32_t size = (uint32_t) plcrash_writer_write_thread_metadata(NULL, &thread_metadata);
+        plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_METADATA_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_thread_metadata(file, &thread_metadata);
+    }
+
+    /* All threads have been written; wait for any pipeline workers to exit prior to releasing the state they share with
+     * the writer */
+    plcrash_writer_unwind_pool_finish(pool);
+
+    /* The remaining binary images */
+    phase_start = plcrash_async_instrumentation_begin();
+    plcrash_writer_write_binary_images(file, writer, image_list, true);
+    plcrash_async_instrumentation_end(PLCRASH_ASYNC_PHASE_BINARY_IMAGES, phase_start);
+    writer->image_flags = NULL;
+    writer->image_list_shared = false;
+
+    /* Attachments. These may be large, and are written after all other crash state so that a truncated report retains
+     * the crash itself. */
+    if (writer->attachments != NULL) {
+        plcrash_writer_write_attachments(file, task, writer->attachments);
+        plcrash_async_file_flush(file);
+    }
+
+    /* Symbol strings. This must be written last, once all symbols referenced by the report have been interned. */
+    if (writer->symbol_table != NULL) {
+        if (writer->symbol_table->count > 0) {
+            uint32_t size;
+
+            /* Calculate the message size */
+            size = plcrash_writer_write_symbol_strings(NULL, writer->symbol_table);
+            plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_STRINGS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_symbol_strings(file, writer->symbol_table);
+        }
+
+        plcrash_writer_symbol_table_free(writer->symbol_table, writer->allocator);
+        writer->symbol_table = NULL;
+    }
+
+    /* Writer stats. This is written after all other messages, to account for as much of the report as possible; the
+     * flush of any remaining buffered output by the caller is not included. */
+    if (writer->instrument) {
+        plcrash_writer_stats_t stats;
+        uint32_t size;
+
+        plcrash_writer_stats_snapshot(&stats, &instrumentation, start_time);
+
+        /* Calculate the message size */
+        size = plcrash_writer_write_writer_stats(NULL, &stats);
+        plcrash_writer_pack(file, PLCRASH_PROTO_WRITER_STATS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_writer_stats(file, &stats);
+
+        plcrash_async_instrumentation_set_current(NULL);
+    }
+
+    /* Buffered debug output. This is flushed last, capturing any output emitted while writing the report itself. */
+    plcrash_writer_finish_debug_log(writer, file);
+
+    /* Record the class cache's use, allowing future standby caches to be sized accordingly */
+    writer->last_objc_class_count = findContext->objc_cache.classCacheCount;
+
+    /* Return a retained standby cache to standby; otherwise, the cache is consumed by this report. The section
+     * mappings reference this report's image list, and are never retained. */
+    if (findContext == &writer->standby_cache && writer->retain_standby_cache) {
+        plcrash_async_macho_section_cache_free(&findContext->section_cache);
+        writer->has_standby_cache = true;
+    } else {
+        plcrash_async_symbol_cache_free(findContext);
+    }
+
+    if (memo != NULL)
+        plcrash_writer_frame_memo_free(memo, writer->allocator);
+
+    if (writer->stack_table != NULL) {
+        plcrash_async_allocator_dealloc(writer->allocator, writer->stack_table);
+        writer->stack_table = NULL;
+    }
+
+    if (writer->queue_table != NULL) {
+        plcrash_async_allocator_dealloc(writer->allocator, writer->queue_table);
+        writer->queue_table = NULL;
+    }
+
+    /* Clean up the unwind jobs; the memos allocated by the unwind workers are released along with the pool */
+    if (jobs != NULL)
+        plcrash_async_allocator_dealloc(writer->allocator, jobs);
+
+    if (captured_states.snapshots != NULL)
+        plcrash_async_allocator_dealloc(writer->allocator, captured_states.snapshots);
+
+    if (thread_metadata.records != NULL)
+        plcrash_async_allocator_dealloc(writer->allocator, thread_metadata.records);
+
+    if (snapshot_buffer != 0x0)
+        vm_deallocate(mach_task_self(), snapshot_buffer, snapshot_buffer_size);
+
+    /* Uninstall the region map prior to resuming the threads */
+    if (have_region_map) {
+        plcrash_async_region_map_set_current(NULL);
+        plcrash_async_region_map_free(&region_map);
+    }
+
+    /* Clean up the thread array */
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (!threads_resumed && threads[i] != writer->self_thread && !plcrash_writer_unwind_pool_contains_thread(pool, threads[i]))
+            thread_resume(threads[i]);
+
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    }
+
+    vm_deallocate(mach_task_self(), (vm_address_t)threads, sizeof(thread_t) * thread_array_count);
+
+    if (writer->concurrent)
+        plcrash_writer_concurrent_set_threads_registered(writer->self_thread, pool, false);
+
+    if (pool != NULL)
+        plcrash_writer_unwind_pool_free(pool);
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* Release the unwind caches; this must be done once the unwind workers have been released */
+    if (writer->dwarf_cache != NULL) {
+        plframe_dwarf_cache_free(writer->dwarf_cache, writer->allocator);
+        writer->dwarf_cache = NULL;
+    }
 
-    /** Size of the symbol entry, to be written by the callback function upon writing an entry. */
-    uint32_t msgsize;
-};
+    if (writer->compact_unwind_cache != NULL) {
+        plframe_compact_unwind_cache_free(writer->compact_unwind_cache, writer->allocator);
+        writer->compact_unwind_cache = NULL;
+    }
+#endif
+
+    /* Release the image list; this also releases any read reference held on the dynamic loader's image monitor */
+    plcrash_async_image_list_free(image_list);
+
+    /* Restore any options changed by the size policy */
+    if (downgraded)
+        plcrash_writer_restore_size_options(writer, &configured_options);
+
+    /* Release all remaining scratch allocations */
+    plcrash_async_allocator_reset(writer->allocator);
+
+    return PLCRASH_ESUCCESS;
+}
 
 /**
  * @internal
  *
- * pl_async_macho_found_symbol_cb callback implementation. Writes the result to the file available via @a ctx,
- * which must be a valid pl_symbol_cb_ctx structure.
+ * The maximum number of frames included in the hash computed by plcrash_log_writer_stack_hash().
  */
-static void plcrash_writer_write_thread_frame_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
-    struct pl_symbol_cb_ctx *cb_ctx = ctx;
-    cb_ctx->msgsize = plcrash_writer_write_symbol(cb_ctx->file, name, address);
-}
+#define MAX_STACK_HASH_FRAMES 32
 
 /**
- * @internal
+ * Compute a hash of @a thread's stack that is stable across launches of the same binaries. Each of the innermost
+ * frames is hashed by its offset from the base address of its containing image, along with the image's path; frames
+ * outside of any known image contribute only their position. Crashes that share a hash will, in all likelihood, share
+ * a cause.
  *
- * Write a thread backtrace frame
+ * @param writer The writer instance, providing the scratch allocator.
+ * @param task The task containing @a thread.
+ * @param thread The thread whose stack is to be hashed.
+ * @param dynamic_loader The task's dynamic loader.
+ * @param current_state The current thread's state, required if @a thread is the current thread; otherwise ignored, and
+ * may be NULL.
+ * @param[out] hash On success, the stack hash.
  *
- * @param file Output file
- * @param pcval The frame PC value.
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the image list could not be read or the thread's state
+ * could not be fetched.
+ *
+ * @warning This function is async-safe.
  */
-static size_t plcrash_writer_write_thread_frame (plcrash_async_file_t *file, plcrash_log_writer_t *writer, uint64_t pcval, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
-    size_t rv = 0;
+plcrash_error_t plcrash_log_writer_stack_hash (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t thread,
+                                               plcrash_async_dynloader_t *dynamic_loader,
+                                               plcrash_async_thread_state_t *current_state,
+                                               uint64_t *hash)
+{
+    plcrash_async_image_list_t *image_list;
+    plcrash_async_thread_state_t thread_state;
+    plframe_cursor_t cursor;
+    plcrash_error_t err;
 
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_PC_ID, PLPROTOBUF_C_TYPE_UINT64, &pcval);
-    
-    plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pcval);
-    if (image != NULL && writer->symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
-        struct pl_symbol_cb_ctx ctx;
-        plcrash_error_t ret;
-        
-        /* Get the symbol message size. If the symbol can not be found, our callback will not be called. If the symbol is found,
-         * our callback is called and PLCRASH_ESUCCESS is returned. */
-        ctx.file = NULL;
-        ctx.msgsize = 0x0;
-        ret = plcrash_async_find_symbol(image, writer->symbol_strategy, findContext, (pl_vm_address_t) pcval, plcrash_writer_write_thread_frame_symbol_cb, &ctx);
-        if (ret == PLCRASH_ESUCCESS) {
-            /* Write the header and message */
-            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &ctx.msgsize);
+    if ((err = plcrash_async_dynloader_read_image_list(dynamic_loader, writer->allocator, &image_list)) != PLCRASH_ESUCCESS)
+        return err;
 
-            ctx.file = file;
-            ret = plcrash_async_find_symbol(image, writer->symbol_strategy, findContext, (pl_vm_address_t) pcval, plcrash_writer_write_thread_frame_symbol_cb, &ctx);
-            if (ret == PLCRASH_ESUCCESS) {
-                rv += ctx.msgsize;
-            } else {
-                /* This should not happen, but it would be very confusing if it did and nothing was logged. */
-                PLCF_DEBUG("Fetching the symbol unexpectedly failed during the second call");
+    if (task == mach_task_self() && thread == pl_mach_thread_self()) {
+        PLCF_ASSERT(current_state != NULL);
+        thread_state = *current_state;
+    } else if ((err = plcrash_async_thread_state_mach_thread_init(&thread_state, thread)) != PLCRASH_ESUCCESS) {
+        plcrash_async_image_list_free(image_list);
+        return err;
+    }
+
+    if (plframe_cursor_init(&cursor, task, &thread_state, image_list) != PLFRAME_ESUCCESS) {
+        plcrash_async_image_list_free(image_list);
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* FNV-1a, applied per byte of each image path and per value of each frame offset. Scanned frames are excluded, as
+     * stale return addresses found on the stack vary from crash to crash. */
+    uint64_t result = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < MAX_STACK_HASH_FRAMES && plcrash_writer_cursor_next(&cursor, writer->frame_pointer_only, false) == PLFRAME_ESUCCESS; i++) {
+        plcrash_greg_t pc = 0;
+        if (plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc) != PLFRAME_ESUCCESS)
+            break;
+
+        uint64_t offset = 0;
+        plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pc);
+        if (image != NULL) {
+            for (const char *c = plcrash_async_macho_name(image); c != NULL && *c != '\0'; c++) {
+                result ^= (uint8_t) *c;
+                result *= 1099511628211ULL;
             }
+            offset = pc - image->header_addr;
         }
+
+        result ^= offset;
+        result *= 1099511628211ULL;
     }
 
-    return rv;
+    plframe_cursor_free(&cursor);
+    plcrash_async_image_list_free(image_list);
+
+    *hash = result;
+    return PLCRASH_ESUCCESS;
 }
 
 /**
  * @internal
  *
- * Write a thread message
+ * The maximum number of attempts made by plcrash_log_writer_write_image_list() to read an image list that is not
+ * modified while being read.
+ */
+#define MAX_IMAGE_LIST_READ_ATTEMPTS 4
+
+/**
+ * Write a shared image list file, containing all images currently loaded in the process, to @a file. Reports written
+ * by a writer configured via plcrash_log_writer_set_shared_image_list() reference the written list in place of
+ * writing their own binary images, for as long as no image is loaded or unloaded.
  *
- * @param file Output file
- * @param task The task in which @a thread is executing.
- * @param thread Thread for which we'll output data.
- * @param thread_number The thread's index number.
- * @param thread_ctx Thread state to use for stack walking. If NULL, the thread state will be fetched from @a thread. If
- * @a thread is the currently executing thread, <em>must</em> be non-NULL.
- * @param image_list The Mach-O image list.
- * @param findContext Symbol lookup cache.
- * @param crashed If true, mark this as a crashed thread.
+ * @param dynamic_loader The process' dynamic loader. The loader's image list monitor must be enabled via
+ * plcrash_nasync_dynloader_enable_image_monitor(); the monitor provides the image list generation.
+ * @param allocator The allocator from which the image list will be allocated.
+ * @param session_id A 16-byte identifier for the current process instance, written to the image list.
+ * @param file The output file.
+ * @param[out] generation On success, the generation of the written image list.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the image list monitor is not enabled, or another
+ * error if the image list could not be read.
+ *
+ * @warning This function is not async-safe.
  */
-static size_t plcrash_writer_write_thread (plcrash_async_file_t *file,
-                                           plcrash_log_writer_t *writer,
-                                           task_t task,
-                                           thread_t thread,
-                                           uint32_t thread_number,
-                                           plcrash_async_thread_state_t *thread_ctx,
-                                           plcrash_async_image_list_t *image_list,
-                                           plcrash_async_symbol_cache_t *findContext,
-                                           bool crashed)
+plcrash_error_t plcrash_log_writer_write_image_list (plcrash_async_dynloader_t *dynamic_loader,
+                                                    plcrash_async_allocator_t *allocator,
+                                                    const uint8_t session_id[16],
+                                                    plcrash_async_file_t *file,
+                                                    uint32_t *generation)
 {
-    size_t rv = 0;
-    plframe_cursor_t cursor;
-    plframe_error_t ferr;
+    plcrash_async_image_list_t *image_list = NULL;
+    uint32_t start_generation;
+    uint32_t end_generation;
+    plcrash_error_t err;
 
-    /* A context must be supplied when walking the current thread */
-    PLCF_ASSERT(task != mach_task_self() || thread_ctx != NULL || thread != pl_mach_thread_self());
+    /* Read an image list whose generation is known; if an image is loaded or unloaded while the list is read, the list
+     * may not match either generation, and is read again. */
+    for (int attempt = 0; attempt < MAX_IMAGE_LIST_READ_ATTEMPTS; attempt++) {
+        if (!plcrash_async_dynloader_image_generation(dynamic_loader, &start_generation))
+            return PLCRASH_ENOTSUP;
 
-    /* Write the required elements first; fatal errors may occur below, in which case we need to have
-     * written out required elements before returning. */
-    {
-        /* Write the thread ID */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
+        if ((err = plcrash_async_dynloader_read_image_list(dynamic_loader, allocator, &image_list)) != PLCRASH_ESUCCESS)
+            return err;
 
-        /* Note crashed status */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+        plcrash_async_dynloader_image_generation(dynamic_loader, &end_generation);
+        if (start_generation == end_generation)
+            break;
+
+        plcrash_async_image_list_free(image_list);
+        image_list = NULL;
     }
 
+    if (image_list == NULL) {
+        PLCF_DEBUG("The image list was modified while being read on each of %d attempts", MAX_IMAGE_LIST_READ_ATTEMPTS);
+        return PLCRASH_EINTERNAL;
+    }
 
-    /* Write out the stack frames. */
+    /* Write the file header */
     {
-        /* Set up the frame cursor. */
-        {            
-            /* Use the provided context if available, otherwise initialize a new thread context
-             * from the target thread's state. */
-            plcrash_async_thread_state_t cursor_thr_state;
-            if (thread_ctx) {
-                cursor_thr_state = *thread_ctx;
-            } else {
-                plcrash_async_thread_state_mach_thread_init(&cursor_thr_state, thread);
-            }
-
-            /* Initialize the cursor */
-            ferr = plframe_cursor_init(&cursor, task, &cursor_thr_state, image_list);
-            if (ferr != PLFRAME_ESUCCESS) {
-                PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
-                return rv;
-            }
-        }
+        uint8_t version = PLCRASH_IMAGE_LIST_FILE_VERSION;
 
-        /* Walk the stack, limiting the total number of frames that are output. */
-        uint32_t frame_count = 0;
-        while ((ferr = plframe_cursor_next(&cursor)) == PLFRAME_ESUCCESS && frame_count < MAX_THREAD_FRAMES) {
-            uint32_t frame_size;
-            
-            /* On the first frame, dump registers for the crashed thread */
-            if (frame_count == 0 && crashed) {
-                rv += plcrash_writer_write_thread_registers(file, task, &cursor);
-            }
+        /* Write the magic string (with no trailing NULL) and the version number */
+        plcrash_async_file_write(file, PLCRASH_IMAGE_LIST_FILE_MAGIC, strlen(PLCRASH_IMAGE_LIST_FILE_MAGIC));
+        plcrash_async_file_write(file, &version, sizeof(version));
+    }
 
-            /* Fetch the PC value */
-            plcrash_greg_t pc = 0;
-            if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
-                PLCF_DEBUG("Could not retrieve frame PC register: %s", plframe_strerror(ferr));
-                break;
-            }
+    /* Session identifier and generation */
+    PLProtobufCBinaryData binary;
+    binary.len = 16;
+    binary.data = (void *) session_id;
+    plcrash_writer_pack(file, PLCRASH_PROTO_IMAGE_LIST_SESSION_ID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    plcrash_writer_pack(file, PLCRASH_PROTO_IMAGE_LIST_GENERATION_ID, PLPROTOBUF_C_TYPE_UINT32, &end_generation);
 
-            /* Determine the size */
-            frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, image_list, findContext);
-            
-            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
-            rv += plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
-            frame_count++;
-        }
+    /* Images */
+    for (size_t i = 0; i < plcrash_async_image_list_count(image_list); i++) {
+        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
+        uint32_t size;
 
-        /* Did we reach the end successfully? */
-        if (ferr != PLFRAME_ENOFRAME) {
-            /* This is non-fatal, and in some circumstances -could- be caused by reaching the end of the stack if the
-             * final frame pointer is not NULL. */
-            PLCF_DEBUG("Terminated stack walking early: %s", plframe_strerror(ferr));
-        }
+        /* Calculate the message size */
+        size = plcrash_writer_write_binary_image(NULL, image);
+        plcrash_writer_pack(file, PLCRASH_PROTO_IMAGE_LIST_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_binary_image(file, image);
     }
 
-    plframe_cursor_free(&cursor);
-    return rv;
+    plcrash_async_image_list_free(image_list);
+
+    *generation = end_generation;
+    return PLCRASH_ESUCCESS;
 }
 
 
 /**
  * @internal
  *
- * Write a binary image frame
+ * A thread tracked by plcrash_log_trace_t.
+ */
+typedef struct plcrash_log_trace_thread {
+    /** If true, this entry is tracking a thread. */
+    bool used;
+
+    /** If true, the thread was found by the current sample. */
+    bool seen;
+
+    /** If true, the thread is new or its stack has changed, and it must be written by the current sample. */
+    bool changed;
+
+    /** The thread's system-wide unique identifier. */
+    uint64_t thread_id;
+
+    /** The number of outermost frames of the thread's previous stack that are retained by its current stack. */
+    uint32_t retained_frames;
+
+    /** The number of valid entries in @a pcs. */
+    uint32_t frame_count;
+
+    /** The thread's most recently sampled stack, ordered from the innermost frame outwards. */
+    uint64_t pcs[PLCRASH_LOG_TRACE_MAX_FRAMES];
+} plcrash_log_trace_thread_t;
+
+/**
+ * @internal
  *
- * @param file Output file
- * @param image Mach-O image.
+ * Live trace state.
  */
-static size_t plcrash_writer_write_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image) {
-    size_t rv = 0;
+struct plcrash_log_trace {
+    /** The allocator backing the unwind caches. */
+    plcrash_async_allocator_t *allocator;
 
-    /* Fetch the CPU types. Note that the wire format represents these as 64-bit unsigned integers.
-     * We explicitly cast to an equivalently sized unsigned type to prevent improper sign extension. */
-    uint64_t cpu_type = (uint32_t) image->byteorder->swap32(image->header.cputype);
-    uint64_t cpu_subtype = (uint32_t) image->byteorder->swap32(image->header.cpusubtype);
+    /** DWARF unwind cache shared across samples, or NULL. */
+    plframe_dwarf_cache_t *dwarf_cache;
 
-    /* Text segment size */
-    uint64_t mach_size = image->text_size;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_SIZE_ID, PLPROTOBUF_C_TYPE_UINT64, &mach_size);
-    
-    /* Base address */
-    {
-        uintptr_t base_addr;
-        uint64_t u64;
+    /** Compact unwind cache shared across samples, or NULL. */
+    plframe_compact_unwind_cache_t *compact_unwind_cache;
 
-        base_addr = (uintptr_t) image->header_addr;
-        u64 = base_addr;
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_ADDR_ID, PLPROTOBUF_C_TYPE_UINT64, &u64);
-    }
+    /** The loader's image unload count at the time the unwind caches were allocated. */
+    uint32_t unload_count;
 
-    /* Name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_NAME_ID, PLPROTOBUF_C_TYPE_STRING, image->name);
+    /** If true, the trace header has been written. */
+    bool started;
 
-    /* UUID */
-    struct uuid_command *uuid;
-    uuid = plcrash_async_macho_find_command(image, LC_UUID);
-    if (uuid != NULL) {
-        PLProtobufCBinaryData binary;
-    
-        /* Write the 128-bit UUID */
-        binary.len = sizeof(uuid->uuid);
-        binary.data = uuid->uuid;
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    /** If true, a previous sample has referenced the shared image list with @a image_list_generation. */
+    bool has_image_list;
+
+    /** The generation of the most recently referenced shared image list. */
+    uint32_t image_list_generation;
+
+    /** Tracked threads. */
+    plcrash_log_trace_thread_t *threads;
+
+    /** The number of entries in @a threads. */
+    uint32_t max_threads;
+
+    /** Scratch storage for the stack currently being walked. */
+    uint64_t scratch[PLCRASH_LOG_TRACE_MAX_FRAMES];
+};
+
+/**
+ * Allocate a new live trace. The trace records each sampled thread's stack, allowing subsequent samples written via
+ * plcrash_log_writer_write_trace_sample() to include only those threads whose stacks have changed, and only the
+ * changed frames of those stacks.
+ *
+ * @param trace On success, will be set to the new trace. The trace must be released via plcrash_log_trace_free().
+ * @param max_threads The maximum number of threads to be tracked. Any additional threads are counted, but are not
+ * written to the trace.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_log_trace_new (plcrash_log_trace_t **trace, uint32_t max_threads) {
+    plcrash_log_trace_t *result;
+    plcrash_error_t err;
+
+    if ((result = calloc(1, sizeof(*result))) == NULL)
+        return PLCRASH_ENOMEM;
+
+    if (max_threads > 0 && (result->threads = calloc(max_threads, sizeof(plcrash_log_trace_thread_t))) == NULL) {
+        free(result);
+        return PLCRASH_ENOMEM;
     }
-    
-    /* Get the processor message size */
-    uint32_t msgsize = plcrash_writer_write_processor_info(NULL, cpu_type, cpu_subtype);
+    result->max_threads = max_threads;
 
-    /* Write the header and message */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
-    rv += plcrash_writer_write_processor_info(file, cpu_type, cpu_subtype);
+    if ((err = plcrash_async_allocator_create(&result->allocator, PAGE_SIZE)) != PLCRASH_ESUCCESS) {
+        free(result->threads);
+        free(result);
+        return err;
+    }
 
-    return rv;
+    *trace = result;
+    return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Reset @a trace, such that the next sample written via plcrash_log_writer_write_trace_sample() starts a new trace
+ * stream, including the trace header and the complete stacks of all threads. The unwind caches are retained.
+ *
+ * @param trace The trace to reset.
+ */
+void plcrash_log_trace_reset (plcrash_log_trace_t *trace) {
+    for (uint32_t i = 0; i < trace->max_threads; i++)
+        trace->threads[i].used = false;
+
+    trace->started = false;
+    trace->has_image_list = false;
+}
 
 /**
  * @internal
  *
- * Write the crash Exception message
+ * Release the unwind caches held by @a trace, if any.
+ */
+static void plcrash_log_trace_free_caches (plcrash_log_trace_t *trace) {
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (trace->dwarf_cache != NULL) {
+        plframe_dwarf_cache_free(trace->dwarf_cache, trace->allocator);
+        trace->dwarf_cache = NULL;
+    }
+
+    if (trace->compact_unwind_cache != NULL) {
+        plframe_compact_unwind_cache_free(trace->compact_unwind_cache, trace->allocator);
+        trace->compact_unwind_cache = NULL;
+    }
+#endif
+}
+
+/**
+ * Free all resources associated with @a trace.
  *
- * @param file Output file
- * @param writer Writer containing exception data
+ * @param trace The trace to free.
  */
-static size_t plcrash_writer_write_exception (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
-    size_t rv = 0;
+void plcrash_log_trace_free (plcrash_log_trace_t *trace) {
+    plcrash_log_trace_free_caches(trace);
+    plcrash_async_allocator_free(trace->allocator);
+    free(trace->threads);
+    free(trace);
+}
 
-    /* Write the name and reason */
-    assert(writer->uncaught_exception.has_exception);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_NAME_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.name);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_REASON_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.reason);
-    
-    /* Write the stack frames, if any */
-    uint32_t frame_count = 0;
-    for (size_t i = 0; i < writer->uncaught_exception.callstack_count && frame_count < MAX_THREAD_FRAMES; i++) {
-        uint64_t pc = (uint64_t)(uintptr_t) writer->uncaught_exception.callstack[i];
-        
-        /* Determine the size */
-        uint32_t frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, image_list, findContext);
-        
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
-        rv += plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
-        frame_count++;
+/**
+ * @internal
+ *
+ * Return the entry tracking @a thread_id, allocating a new entry if the thread is not yet tracked; @a created is set
+ * to true if a new entry was allocated. Returns NULL if the thread is not tracked, and all entries are in use.
+ */
+static plcrash_log_trace_thread_t *plcrash_log_trace_thread (plcrash_log_trace_t *trace, uint64_t thread_id, bool *created) {
+    plcrash_log_trace_thread_t *unused = NULL;
+
+    *created = false;
+
+    for (uint32_t i = 0; i < trace->max_threads; i++) {
+        plcrash_log_trace_thread_t *entry = &trace->threads[i];
+        if (!entry->used) {
+            if (unused == NULL)
+                unused = entry;
+            continue;
+        }
+
+        if (entry->thread_id == thread_id)
+            return entry;
+    }
+
+    if (unused != NULL) {
+        unused->used = true;
+        unused->thread_id = thread_id;
+        unused->frame_count = 0;
+        *created = true;
+    }
+
+    return unused;
+}
+
+/**
+ * @internal
+ *
+ * Walk the stack of the suspended @a thread, writing up to @a max_frames PC values to @a pcs, and returning the number
+ * of PC values written.
+ */
+static uint32_t plcrash_writer_trace_walk (plcrash_log_writer_t *writer, plcrash_log_trace_t *trace, task_t task, thread_t thread,
+                                          plcrash_async_image_list_t *image_list, plcrash_async_macho_section_cache_t *section_cache,
+                                          uint64_t *pcs, uint32_t max_frames)
+{
+    plcrash_async_thread_state_t thread_state;
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+    uint32_t count = 0;
+
+    if (plcrash_async_thread_state_mach_thread_init(&thread_state, thread) != PLCRASH_ESUCCESS)
+        return 0;
+
+    if ((ferr = plframe_cursor_init(&cursor, task, &thread_state, image_list)) != PLFRAME_ESUCCESS) {
+        PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
+        return 0;
+    }
+
+    if (trace->dwarf_cache != NULL)
+        plframe_cursor_set_dwarf_cache(&cursor, trace->dwarf_cache);
+
+    if (trace->compact_unwind_cache != NULL)
+        plframe_cursor_set_compact_unwind_cache(&cursor, trace->compact_unwind_cache);
+
+    plframe_cursor_set_section_cache(&cursor, section_cache);
+
+    while (count < max_frames && plcrash_writer_cursor_next(&cursor, writer->frame_pointer_only, writer->stack_scan) == PLFRAME_ESUCCESS) {
+        plcrash_greg_t pc = 0;
+        if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
+            PLCF_DEBUG("Could not retrieve frame PC register: %s", plframe_strerror(ferr));
+            break;
+        }
+
+        pcs[count++] = pc;
     }
 
-    return rv;
+    plframe_cursor_free(&cursor);
+    return count;
 }
 
 /**
  * @internal
  *
- * Write the crash signal's mach exception info.
+ * Write the trace header message.
  *
  * @param file Output file
- * @param siginfo The signal information
+ * @param writer Writer containing the host and process information.
+ * @param host_info_ready If true, the host information published by plcrash_log_writer_populate_host_info() is
+ * written.
+ * @param timestamp Timestamp to use for the system info.
  */
-static size_t plcrash_writer_write_mach_signal (plcrash_async_file_t *file, plcrash_log_mach_signal_info_t *siginfo) {
+static size_t plcrash_writer_write_trace_header (plcrash_async_file_t *file, plcrash_log_writer_t *writer, bool host_info_ready, int64_t timestamp) {
+    mach_timebase_info_data_t timebase;
     size_t rv = 0;
+    uint32_t size;
 
-    /* Type */
-    uint64_t type = siginfo->type;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &type);
-    
-    /* Code(s) */
-    for (mach_msg_type_number_t i = 0; i < siginfo->code_count; i++) {
-        uint64_t code = siginfo->code[i];
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_CODES_ID, PLPROTOBUF_C_TYPE_UINT64, &code);
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS) {
+        timebase.numer = 1;
+        timebase.denom = 1;
+    }
+
+    /* System info */
+    size = plcrash_writer_write_system_info(NULL, writer, host_info_ready, timestamp);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_system_info(file, writer, host_info_ready, timestamp);
+
+    /* Machine info */
+    size = plcrash_writer_write_machine_info(NULL, writer, host_info_ready);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_machine_info(file, writer, host_info_ready);
+
+    /* App info */
+    size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    rv += plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+
+    /* Process info; only written once the host information is available */
+    if (host_info_ready) {
+        size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id,
+                                                 writer->process_info.process_path, writer->process_info.parent_process_name,
+                                                 writer->process_info.parent_process_id, writer->process_info.native,
+                                                 writer->process_info.start_time);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id,
+                                                writer->process_info.process_path, writer->process_info.parent_process_name,
+                                                writer->process_info.parent_process_id, writer->process_info.native,
+                                                writer->process_info.start_time);
     }
 
+    /* Timebase */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_TIMEBASE_NUMER_ID, PLPROTOBUF_C_TYPE_UINT32, &timebase.numer);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_TIMEBASE_DENOM_ID, PLPROTOBUF_C_TYPE_UINT32, &timebase.denom);
+
     return rv;
 }
 
 /**
  * @internal
  *
- * Write the crash signal message
+ * Write a trace thread delta message for @a entry, containing the frames that differ from the thread's previous stack.
  *
  * @param file Output file
- * @param siginfo The signal information
+ * @param writer Writer instance.
+ * @param entry The thread to write.
+ * @param image_list The image list used to symbolicate the frames.
+ * @param findContext Symbol lookup cache.
  */
-static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_log_signal_info_t *siginfo) {
+static size_t plcrash_writer_write_trace_thread (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_log_trace_thread_t *entry,
+                                                 plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext)
+{
     size_t rv = 0;
-    
-    /* BSD signal info is always required in the current report format; this restriction will be lifted
-     * once we switch to the 2.0 format. */
-    PLCF_ASSERT(siginfo->bsd_info != NULL);
-    
-    /* Fetch the signal name */
-    char name_buf[10];
-    const char *name;
-    if ((name = plcrash_async_signal_signame(siginfo->bsd_info->signo)) == NULL) {
-        PLCF_DEBUG("Warning -- unhandled signal number (signo=%d). This is a bug.", siginfo->bsd_info->signo);
-        snprintf(name_buf, sizeof(name_buf), "#%d", siginfo->bsd_info->signo);
-        name = name_buf;
-    }
 
-    /* Fetch the signal code string */
-    char code_buf[10];
-    const char *code;
-    if ((code = plcrash_async_signal_sigcode(siginfo->bsd_info->signo, siginfo->bsd_info->code)) == NULL) {
-        PLCF_DEBUG("Warning -- unhandled signal sicode (signo=%d, code=%d). This is a bug.", siginfo->bsd_info->signo, siginfo->bsd_info->code);
-        snprintf(code_buf, sizeof(code_buf), "#%d", siginfo->bsd_info->code);
-        code = code_buf;
-    }
-    
-    /* Address value */
-    uint64_t addr = (uintptr_t) siginfo->bsd_info->address;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_THREAD_DELTA_THREAD_ID_ID, PLPROTOBUF_C_TYPE_UINT64, &entry->thread_id);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_THREAD_DELTA_RETAINED_FRAMES_ID, PLPROTOBUF_C_TYPE_UINT32, &entry->retained_frames);
 
-    /* Write it out */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_NAME_ID, PLPROTOBUF_C_TYPE_STRING, name);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_CODE_ID, PLPROTOBUF_C_TYPE_STRING, code);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &addr);
-    
-    /* Mach exception info */
-    if (siginfo->mach_info != NULL) {
-        uint32_t size;
-        
-        /* Determine size */
-        size = plcrash_writer_write_mach_signal(NULL, siginfo->mach_info);
-        
-        /* Write message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        rv += plcrash_writer_write_mach_signal(file, siginfo->mach_info);
+    for (uint32_t i = 0; i < entry->frame_count - entry->retained_frames; i++) {
+        uint32_t frame_size;
+
+        /* Determine the size */
+        frame_size = plcrash_writer_write_thread_frame(NULL, writer, entry->pcs[i], image_list, findContext);
+
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_THREAD_DELTA_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+        rv += plcrash_writer_write_thread_frame(file, writer, entry->pcs[i], image_list, findContext);
     }
 
     return rv;
@@ -1171,249 +8261,284 @@ static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_l
 /**
  * @internal
  *
- * Write the report info message
+ * Write a trace sample message, containing all changed and ended threads of @a trace.
  *
  * @param file Output file
- * @param writer Writer containing report data
+ * @param writer Writer instance.
+ * @param trace The trace state.
+ * @param image_list The image list used to symbolicate the frames.
+ * @param findContext Symbol lookup cache.
+ * @param timestamp The sample's mach_absolute_time() timestamp.
+ * @param reference_image_list If true, a reference to the writer's shared image list is written.
+ * @param untracked_count The number of threads that could not be tracked.
  */
-static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+static size_t plcrash_writer_write_trace_sample (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_log_trace_t *trace,
+                                                 plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext,
+                                                 uint64_t timestamp, bool reference_image_list, uint32_t untracked_count)
+{
     size_t rv = 0;
 
-    /* Note crashed status */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_USER_REQUESTED_ID, PLPROTOBUF_C_TYPE_BOOL, &writer->report_info.user_requested);
-    
-    /* Write the 128-bit UUID */
-    PLProtobufCBinaryData uuid_bin;
-    
-    uuid_bin.len = sizeof(writer->report_info.uuid_bytes);
-    uuid_bin.data = &writer->report_info.uuid_bytes;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &uuid_bin);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLE_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_UINT64, &timestamp);
+
+    for (uint32_t i = 0; i < trace->max_threads; i++) {
+        plcrash_log_trace_thread_t *entry = &trace->threads[i];
+        if (!entry->used)
+            continue;
+
+        /* Threads that were not found by this sample have ended */
+        if (!entry->seen) {
+            rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLE_ENDED_THREADS_ID, PLPROTOBUF_C_TYPE_UINT64, &entry->thread_id);
+            continue;
+        }
+
+        if (!entry->changed)
+            continue;
+
+        uint32_t size = plcrash_writer_write_trace_thread(NULL, writer, entry, image_list, findContext);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLE_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_trace_thread(file, writer, entry, image_list, findContext);
+    }
+
+    if (reference_image_list) {
+        uint32_t size = plcrash_writer_write_shared_image_list(NULL, writer->shared_image_session, writer->shared_image_generation);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLE_IMAGE_LIST_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_shared_image_list(file, writer->shared_image_session, writer->shared_image_generation);
+    }
+
+    if (untracked_count > 0)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLE_UNTRACKED_THREAD_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &untracked_count);
 
     return rv;
 }
 
 /**
- * Write the crash report. All other running threads are suspended while the crash report is generated.
+ * Sample the stacks of all threads in the current process, other than the calling thread, and append the sample to
+ * the trace stream in @a file. The first sample written after plcrash_log_trace_new() or plcrash_log_trace_reset()
+ * is preceded by the trace file header and trace header, and includes the complete stacks of all threads; each
+ * subsequent sample includes only those threads that are new or whose stacks have changed, and for each such thread,
+ * only the innermost frames that differ from the thread's previous stack. Threads that have exited are listed by
+ * identifier.
  *
- * @param writer The writer context.
- * @param crashed_thread The crashed thread. 
- * @param dynamic_loader A borrowed reference to the target's dynamic loader.
+ * Threads are suspended only while their stacks are walked; symbolication is performed once all threads have been
+ * resumed. The writer's standby symbol cache is used if available, and is not consumed. The unwind caches are held by
+ * @a trace, and are retained across samples until an image is unloaded.
+ *
+ * If the writer has been configured via plcrash_log_writer_set_shared_image_list(), the first sample written while
+ * each shared image list generation is current references that image list; otherwise, no images are written, and
+ * frames must be symbolicated from the written symbol names.
+ *
+ * @param writer The writer providing the report configuration and host information.
+ * @param trace The trace state.
+ * @param dynamic_loader The process' dynamic loader.
  * @param file The output file.
- * @param siginfo Signal information.
- * @param current_state If non-NULL, the given thread state will be used when walking the current thread. The state must remain
- * valid until this function returns. Generally, this state will be generated by a signal handler, or via a
- * context-generating trampoline such as plcrash_log_writer_write_curthread(). If NULL, a thread dump for the current
- * thread will not be written. If @a crashed_thread is the current thread (as returned by mach_thread_self()), this
- * value <em>must</em> be provided.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the process' threads could not be enumerated.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently for the same @a writer or @a trace.
  */
-plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
-                                          thread_t crashed_thread,
-                                          plcrash_async_dynloader_t *dynamic_loader,
-                                          plcrash_async_file_t *file,
-                                          plcrash_log_signal_info_t *siginfo,
-                                          plcrash_async_thread_state_t *current_state)
+plcrash_error_t plcrash_log_writer_write_trace_sample (plcrash_log_writer_t *writer,
+                                                      plcrash_log_trace_t *trace,
+                                                      plcrash_async_dynloader_t *dynamic_loader,
+                                                      plcrash_async_file_t *file)
 {
+    task_t task = mach_task_self();
+    thread_t self = pl_mach_thread_self();
     thread_act_array_t threads;
     mach_msg_type_number_t thread_count;
     plcrash_error_t err;
 
-    /* A context must be supplied if the current thread is marked as the crashed thread; otherwise,
-     * the thread's stack can not be safely walked. */
-    PLCF_ASSERT(pl_mach_thread_self() != crashed_thread || current_state != NULL);
-    
-    /* Get a list of all images. If this fails (and it shouldn't), we log the error and instead operate on an empty
-     * image list. This will greatly reduce the utility of the report, but it's better than producing no report
-     * at all. */
+    /* Local memory mappings may have changed since the last sample was written; discard any cached regions */
+    plcrash_async_mobject_region_cache_reset();
+    writer->task = task;
+    writer->self_thread = self;
+
+    /* Get a list of all images, falling back on an empty image list */
     plcrash_async_image_list_t *image_list;
     if ((err = plcrash_async_dynloader_read_image_list(dynamic_loader, writer->allocator, &image_list)) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Fetching image list failed, proceeding with an empty image list: %d", err);
-        
-        
-        /* Allocate an empty image list; outside of a compile-time configuration error, this should never fail. If it does
-         * fail, our environment is messed up enough that terminating without writing a report is likely justified */
         if ((image_list = plcrash_async_image_list_new_empty(writer->allocator)) == NULL) {
             PLCF_DEBUG("Allocation of our empty image list failed unexpectedly");
             return PLCRASH_ENOMEM;
         }
     }
 
-    /* Get a list of all threads */
-    if (task_threads(mach_task_self(), &threads, &thread_count) != KERN_SUCCESS) {
-        PLCF_DEBUG("Fetching thread list failed");
-        thread_count = 0;
-    }
-    
-    /* Suspend all but the current thread. */
-    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
-        if (threads[i] != pl_mach_thread_self())
-            thread_suspend(threads[i]);
+    /* The unwind caches are keyed by address, and must be discarded if an image has been unloaded since they were
+     * populated. Without the image monitor, unloads can not be detected, and the caches are not retained. */
+    uint32_t unload_count = 0;
+    bool monitored = plcrash_async_dynloader_image_unload_count(dynamic_loader, &unload_count);
+    if (!monitored || unload_count != trace->unload_count) {
+        plcrash_log_trace_free_caches(trace);
+        trace->unload_count = unload_count;
     }
 
-    /* Set up a symbol-finding context. */
-    plcrash_async_symbol_cache_t findContext;
-    err = plcrash_async_symbol_cache_init(&findContext);
-    /* Abort if it failed, although that should never actually happen, ever. */
-    if (err != PLCRASH_ESUCCESS)
-        return err;
-
-    /* Write the file header */
-    {
-        uint8_t version = PLCRASH_REPORT_FILE_VERSION;
-
-        /* Write the magic string (with no trailing NULL) and the version number */
-        plcrash_async_file_write(file, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
-        plcrash_async_file_write(file, &version, sizeof(version));
-    }
-    
-    
-    /* Report Info */
-    {
-        uint32_t size;
-        
-        /* Determine size */
-        size = plcrash_writer_write_report_info(NULL, writer);
-        
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_report_info(file, writer);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (trace->dwarf_cache == NULL && (err = plframe_dwarf_cache_new(&trace->dwarf_cache, trace->allocator)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate DWARF unwind cache, proceeding without caching: %d", err);
+        trace->dwarf_cache = NULL;
     }
 
-    /* System Info */
-    {
-        time_t timestamp;
-        uint32_t size;
-
-        /* Must stay the same across both calls, so get the timestamp here */
-        if (time(&timestamp) == (time_t)-1) {
-            PLCF_DEBUG("Failed to fetch timestamp: %s", strerror(errno));
-            timestamp = 0;
-        }
+    if (trace->compact_unwind_cache == NULL && (err = plframe_compact_unwind_cache_new(&trace->compact_unwind_cache, trace->allocator)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate compact unwind cache, proceeding without caching: %d", err);
+        trace->compact_unwind_cache = NULL;
+    }
+#endif
 
-        /* Determine size */
-        size = plcrash_writer_write_system_info(NULL, writer, timestamp);
-        
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_system_info(file, writer, timestamp);
+    /* Set up a symbol-finding context, borrowing the writer's standby cache if available */
+    plcrash_async_symbol_cache_t localFindContext;
+    plcrash_async_symbol_cache_t *findContext = &localFindContext;
+    if (writer->has_standby_cache) {
+        findContext = &writer->standby_cache;
+    } else if ((err = plcrash_async_symbol_cache_init(findContext)) == PLCRASH_ESUCCESS) {
+        plcrash_async_symbol_cache_set_shared_cache(findContext, writer->shared_cache_info);
+    } else {
+        plcrash_async_image_list_free(image_list);
+        plcrash_async_allocator_reset(writer->allocator);
+        return err;
     }
-    
-    /* Machine Info */
-    {
-        uint32_t size;
 
-        /* Determine size */
-        size = plcrash_writer_write_machine_info(NULL, writer);
+    /* Register as a concurrent writer, if enabled. See plcrash_log_writer_set_concurrent(). */
+    if (writer->concurrent)
+        plcrash_writer_concurrent_set_registered(self, true);
 
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_machine_info(file, writer);
+    /* Fetch the thread list */
+    if (task_threads(task, &threads, &thread_count) != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetching thread list failed");
+        thread_count = 0;
+        threads = NULL;
     }
 
-    /* App info */
-    {
-        uint32_t size;
+    /* Release the threads of any concurrent writers; they will be neither suspended nor sampled. The allocated size of
+     * the thread array is retained for its deallocation. */
+    mach_msg_type_number_t thread_array_count = thread_count;
+    if (writer->concurrent)
+        thread_count = plcrash_writer_omit_concurrent_threads(threads, thread_count, MACH_PORT_NULL, self);
 
-        /* Determine size */
-        size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
-        
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version, writer->application_info.app_marketing_version);
+    /* Suspend all threads other than our own, and walk their stacks */
+    uint64_t timestamp = mach_absolute_time();
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] != self)
+            thread_suspend(threads[i]);
     }
-    
-    /* Process info */
-    {
-        uint32_t size;
-        
-        /* Determine size */
-        size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id, 
-                                                 writer->process_info.process_path, writer->process_info.parent_process_name,
-                                                 writer->process_info.parent_process_id, writer->process_info.native,
-                                                 writer->process_info.start_time);
-        
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id, 
-                                          writer->process_info.process_path, writer->process_info.parent_process_name, 
-                                          writer->process_info.parent_process_id, writer->process_info.native,
-                                          writer->process_info.start_time);
+
+    for (uint32_t i = 0; i < trace->max_threads; i++) {
+        trace->threads[i].seen = false;
+        trace->threads[i].changed = false;
     }
-    
-    /* Threads */
-    uint32_t thread_number = 0;
+
+    uint32_t max_frames = writer->max_thread_frames < PLCRASH_LOG_TRACE_MAX_FRAMES ? writer->max_thread_frames : PLCRASH_LOG_TRACE_MAX_FRAMES;
+    uint32_t untracked_count = 0;
     for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
-        thread_t thread = threads[i];
-        plcrash_async_thread_state_t *thr_ctx = NULL;
-        bool crashed = false;
-        uint32_t size;
+        thread_identifier_info_data_t ident;
+        mach_msg_type_number_t ident_count = THREAD_IDENTIFIER_INFO_COUNT;
+        plcrash_log_trace_thread_t *entry;
+        bool created;
 
-        /* If executing on the target thread, we need to a valid context to walk */
-        if (pl_mach_thread_self() == thread) {
-            /* Can't log a report for the current thread without a valid context. */
-            if (current_state == NULL)
-                continue;
-        
-            thr_ctx = current_state;
+        if (threads[i] == self)
+            continue;
+
+        if (thread_info(threads[i], THREAD_IDENTIFIER_INFO, (thread_info_t) &ident, &ident_count) != KERN_SUCCESS ||
+            (entry = plcrash_log_trace_thread(trace, ident.thread_id, &created)) == NULL)
+        {
+            untracked_count++;
+            continue;
         }
-        
-        /* Check if this is the crashed thread */
-        if (crashed_thread == thread) {
-            crashed = true;
+
+        uint32_t count = plcrash_writer_trace_walk(writer, trace, task, threads[i], image_list, &findContext->section_cache, trace->scratch, max_frames);
+        entry->seen = true;
+
+        /* Find the number of outermost frames shared with the previous stack */
+        uint32_t retained = 0;
+        while (retained < count && retained < entry->frame_count &&
+               trace->scratch[count - 1 - retained] == entry->pcs[entry->frame_count - 1 - retained])
+        {
+            retained++;
         }
 
-        /* Determine the size */
-        size = plcrash_writer_write_thread(NULL, writer, mach_task_self(), thread, thread_number, thr_ctx, image_list, &findContext, crashed);
+        /* Unchanged stacks are omitted; new threads are always written */
+        if (!created && retained == count && retained == entry->frame_count)
+            continue;
 
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_thread(file, writer, mach_task_self(), thread, thread_number, thr_ctx, image_list, &findContext, crashed);
+        entry->changed = true;
+        entry->retained_frames = retained;
+        entry->frame_count = count;
+        plcrash_async_memcpy(entry->pcs, trace->scratch, sizeof(entry->pcs[0]) * count);
+    }
 
-        thread_number++;
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] != self)
+            thread_resume(threads[i]);
+
+        mach_port_deallocate(mach_task_self(), threads[i]);
     }
 
-    /* Binary Images */
-    for (size_t i = 0; i < plcrash_async_image_list_count(image_list); i++) {
-        plcrash_async_macho_t *image = plcrash_async_image_list_get_image(image_list, i);
-        uint32_t size;
+    if (threads != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) threads, sizeof(thread_t) * thread_array_count);
 
-        /* Calculate the message size */
-        size = plcrash_writer_write_binary_image(NULL, image);
-        plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_binary_image(file, image);
+    if (writer->concurrent)
+        plcrash_writer_concurrent_set_registered(self, false);
+
+    /* Reference the shared image list once per generation, provided it still matches the image list read above */
+    bool reference_image_list = false;
+    if (writer->share_image_list) {
+        uint32_t generation;
+        if (plcrash_async_dynloader_image_generation(dynamic_loader, &generation) && generation == writer->shared_image_generation &&
+            (!trace->has_image_list || trace->image_list_generation != generation))
+        {
+            reference_image_list = true;
+            trace->has_image_list = true;
+            trace->image_list_generation = generation;
+        }
     }
 
-    /* Exception */
-    if (writer->uncaught_exception.has_exception) {
+    /* Write the file and trace headers at the start of the stream */
+    if (!trace->started) {
+        uint8_t version = PLCRASH_TRACE_FILE_VERSION;
+        time_t wallclock;
         uint32_t size;
 
-        /* Calculate the message size */
-        size = plcrash_writer_write_exception(NULL, writer, image_list, &findContext);
-        plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_exception(file, writer, image_list, &findContext);
+        plcrash_async_file_write(file, PLCRASH_TRACE_FILE_MAGIC, strlen(PLCRASH_TRACE_FILE_MAGIC));
+        plcrash_async_file_write(file, &version, sizeof(version));
+
+        /* The host information flag is read once, so that the sizing and writing passes agree */
+        bool host_info_ready = writer->host_info_ready;
+        OSMemoryBarrier();
+
+        if (time(&wallclock) == (time_t)-1) {
+            PLCF_DEBUG("Failed to fetch timestamp: %s", strerror(errno));
+            wallclock = 0;
+        }
+
+        size = plcrash_writer_write_trace_header(NULL, writer, host_info_ready, wallclock);
+        plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_HEADER_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_trace_header(file, writer, host_info_ready, wallclock);
+
+        trace->started = true;
     }
-    
-    /* Signal */
+
+    /* Write the sample */
     {
         uint32_t size;
-        
-        /* Calculate the message size */
-        size = plcrash_writer_write_signal(NULL, siginfo);
-        plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_signal(file, siginfo);
+
+        size = plcrash_writer_write_trace_sample(NULL, writer, trace, image_list, findContext, timestamp, reference_image_list, untracked_count);
+        plcrash_writer_pack(file, PLCRASH_PROTO_TRACE_SAMPLES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_trace_sample(file, writer, trace, image_list, findContext, timestamp, reference_image_list, untracked_count);
     }
-    
-    plcrash_async_symbol_cache_free(&findContext);
-    
-    /* Clean up the thread array */
-    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
-        if (threads[i] != pl_mach_thread_self())
-            thread_resume(threads[i]);
 
-        mach_port_deallocate(mach_task_self(), threads[i]);
+    /* Stop tracking ended threads */
+    for (uint32_t i = 0; i < trace->max_threads; i++) {
+        if (trace->threads[i].used && !trace->threads[i].seen)
+            trace->threads[i].used = false;
     }
 
-    vm_deallocate(mach_task_self(), (vm_address_t)threads, sizeof(thread_t) * thread_count);
-    
+    /* The section cache references the sample's image list, and must be emptied before it is freed */
+    if (findContext == &localFindContext)
+        plcrash_async_symbol_cache_free(findContext);
+    else
+        plcrash_async_macho_section_cache_free(&findContext->section_cache);
+
+    plcrash_async_image_list_free(image_list);
+    plcrash_async_allocator_reset(writer->allocator);
+
     return PLCRASH_ESUCCESS;
 }
 
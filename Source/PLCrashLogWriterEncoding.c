@@ -56,33 +56,32 @@ zigzag64 (int64_t v)
     else
         return v * 2;
 }
+/* Writes every byte of the varint with its continuation bit set, then clears the continuation bit of the final byte;
+ * the only branch is the jump on the precomputed length. */
 static inline size_t
-uint32_pack (uint32_t value, uint8_t *out)
+varint_pack (uint64_t value, uint8_t *out)
 {
-    unsigned rv = 0;
-    if (value >= 0x80)
+    size_t len = plcrash_writer_varint_size (value);
+    switch (len)
     {
-        out[rv++] = value | 0x80;
-        value >>= 7;
-        if (value >= 0x80)
-        {
-            out[rv++] = value | 0x80;
-            value >>= 7;
-            if (value >= 0x80)
-            {
-                out[rv++] = value | 0x80;
-                value >>= 7;
-                if (value >= 0x80)
-                {
-                    out[rv++] = value | 0x80;
-                    value >>= 7;
-                }
-            }
-        }
+        case 10: out[9] = (uint8_t)((value >> 63) | 0x80);
+        case 9:  out[8] = (uint8_t)((value >> 56) | 0x80);
+        case 8:  out[7] = (uint8_t)((value >> 49) | 0x80);
+        case 7:  out[6] = (uint8_t)((value >> 42) | 0x80);
+        case 6:  out[5] = (uint8_t)((value >> 35) | 0x80);
+        case 5:  out[4] = (uint8_t)((value >> 28) | 0x80);
+        case 4:  out[3] = (uint8_t)((value >> 21) | 0x80);
+        case 3:  out[2] = (uint8_t)((value >> 14) | 0x80);
+        case 2:  out[1] = (uint8_t)((value >> 7) | 0x80);
+        default: out[0] = (uint8_t)(value | 0x80);
     }
-    /* assert: value<128 */
-    out[rv++] = value;
-    return rv;
+    out[len - 1] &= 0x7F;
+    return len;
+}
+static inline size_t
+uint32_pack (uint32_t value, uint8_t *out)
+{
+    return varint_pack (value, out);
 }
 static inline size_t
 int32_pack (int32_t value, uint8_t *out)
@@ -105,36 +104,10 @@ static inline size_t sint32_pack (int32_t value, uint8_t *out)
 {
     return uint32_pack (zigzag32 (value), out);
 }
-static size_t
+static inline size_t
 uint64_pack (uint64_t value, uint8_t *out)
 {
-    uint32_t hi = value>>32;
-    uint32_t lo = value;
-    unsigned rv;
-    if (hi == 0)
-        return uint32_pack ((uint32_t)lo, out);
-    out[0] = (lo) | 0x80;
-    out[1] = (lo>>7) | 0x80;
-    out[2] = (lo>>14) | 0x80;
-    out[3] = (lo>>21) | 0x80;
-    if (hi < 8)
-    {
-        out[4] = (hi<<4) | (lo>>28);
-        return 5;
-    }
-    else
-    {
-        out[4] = ((hi&7)<<4) | (lo>>28) | 0x80;
-        hi >>= 3;
-    }
-    rv = 5;
-    while (hi >= 128)
-    {
-        out[rv++] = hi | 0x80;
-        hi >>= 7;
-    }
-    out[rv++] = hi;
-    return rv;
+    return varint_pack (value, out);
 }
 static inline size_t sint64_pack (int64_t value, uint8_t *out)
 {
@@ -169,12 +142,85 @@ static inline size_t boolean_pack (bool value, uint8_t *out)
 }
 
 /* wire-type will be added in required_field_pack() */
-static size_t tag_pack (uint32_t id, uint8_t *out)
+static inline size_t tag_pack (uint32_t id, uint8_t *out)
 {
-    if (id < (1<<(32-3)))
-        return uint32_pack (id<<3, out);
-    else
-        return uint64_pack (((uint64_t)id) << 3, out);
+    /* All crash_report.proto field numbers fit in a single tag byte */
+    if (id < PLCRASH_WRITER_SINGLE_BYTE_TAG_LIMIT) {
+        out[0] = (uint8_t)(id << 3);
+        return 1;
+    }
+
+    return uint64_pack (((uint64_t)id) << 3, out);
+}
+
+/* === get_packed_size() === */
+
+/**
+ * Return the number of bytes required to encode a field, without encoding it.
+ *
+ * plcrash_writer_pack() defers to this function when called with a NULL file, so that the sizing pass over a
+ * message does not encode each value into a scratch buffer only to discard it.
+ *
+ * @param field_id The field identifier.
+ * @param field_type The field type.
+ * @param value The field value, as would be passed to plcrash_writer_pack().
+ */
+size_t plcrash_writer_pack_size (uint32_t field_id, PLProtobufCType field_type, const void *value) {
+    size_t rv = plcrash_writer_tag_size (field_id);
+    switch (field_type)
+    {
+        case PLPROTOBUF_C_TYPE_SINT32:
+            return rv + plcrash_writer_varint_size (zigzag32 (*(const int32_t *) value));
+        case PLPROTOBUF_C_TYPE_INT32:
+            /* Negative values are sign-extended to 64 bits */
+            if (*(const int32_t *) value < 0)
+                return rv + MAX_UINT64_ENCODED_SIZE;
+            return rv + plcrash_writer_varint_size (*(const uint32_t *) value);
+        case PLPROTOBUF_C_TYPE_UINT32:
+        case PLPROTOBUF_C_TYPE_ENUM:
+        case PLPROTOBUF_C_TYPE_MESSAGE:
+            return rv + plcrash_writer_varint_size (*(const uint32_t *) value);
+        case PLPROTOBUF_C_TYPE_SINT64:
+            return rv + plcrash_writer_varint_size (zigzag64 (*(const int64_t *) value));
+        case PLPROTOBUF_C_TYPE_INT64:
+        case PLPROTOBUF_C_TYPE_UINT64:
+            return rv + plcrash_writer_varint_size (*(const uint64_t *) value);
+        case PLPROTOBUF_C_TYPE_SFIXED32:
+        case PLPROTOBUF_C_TYPE_FIXED32:
+        case PLPROTOBUF_C_TYPE_FLOAT:
+            return rv + 4;
+        case PLPROTOBUF_C_TYPE_SFIXED64:
+        case PLPROTOBUF_C_TYPE_FIXED64:
+        case PLPROTOBUF_C_TYPE_DOUBLE:
+            return rv + 8;
+        case PLPROTOBUF_C_TYPE_BOOL:
+            return rv + 1;
+        case PLPROTOBUF_C_TYPE_STRING:
+        {
+            size_t sublen = strlen (value);
+            return rv + plcrash_writer_varint_size (sublen) + sublen;
+        }
+        case PLPROTOBUF_C_TYPE_BYTES:
+        {
+            size_t sublen = ((const PLProtobufCBinaryData *) value)->len;
+            return rv + plcrash_writer_varint_size (sublen) + sublen;
+        }
+        default:
+            PLCF_DEBUG("Unhandled field type %d", field_type);
+            abort();
+    }
+}
+
+/**
+ * Encode @a value as a varint, as used in packed repeated fields.
+ *
+ * @param value The value to encode.
+ * @param out The output buffer; this must have room for at least PLCRASH_WRITER_MAX_VARINT_BYTES.
+ *
+ * @return Returns the number of bytes written to @a out.
+ */
+size_t plcrash_writer_encode_varint (uint64_t value, uint8_t *out) {
+    return uint64_pack(value, out);
 }
 
 /* === pack_to_buffer() === */
@@ -182,62 +228,58 @@ static size_t tag_pack (uint32_t id, uint8_t *out)
 size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLProtobufCType field_type, const void *value) {
     size_t rv;
     uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
+
+    if (file == NULL)
+        return plcrash_writer_pack_size (field_id, field_type, value);
+
     rv = tag_pack (field_id, scratch);
     switch (field_type)
     {
         case PLPROTOBUF_C_TYPE_SINT32:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += sint32_pack (*(const int32_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_INT32:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += int32_pack (*(const uint32_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_UINT32:
         case PLPROTOBUF_C_TYPE_ENUM:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += uint32_pack (*(const uint32_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_SINT64:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += sint64_pack (*(const int64_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_INT64:
         case PLPROTOBUF_C_TYPE_UINT64:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += uint64_pack (*(const uint64_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_SFIXED32:
         case PLPROTOBUF_C_TYPE_FIXED32:
         case PLPROTOBUF_C_TYPE_FLOAT:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_32BIT;
             rv += fixed32_pack (*(const uint32_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_SFIXED64:
         case PLPROTOBUF_C_TYPE_FIXED64:
         case PLPROTOBUF_C_TYPE_DOUBLE:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_64BIT;
             rv += fixed64_pack (*(const uint64_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         case PLPROTOBUF_C_TYPE_BOOL:
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_VARINT;
             rv += boolean_pack (*(const bool *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
             
         case PLPROTOBUF_C_TYPE_STRING:
@@ -245,10 +287,8 @@ size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLPro
             size_t sublen = strlen (value);
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
             rv += uint32_pack (sublen, scratch + rv);
-            if (file != NULL) {
-                plcrash_async_file_write(file, scratch, rv);
-                plcrash_async_file_write(file, value, sublen);
-            }
+            plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, value, sublen);
             rv += sublen;
             break;
         }
@@ -259,10 +299,8 @@ size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLPro
             size_t sublen = bd->len;
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
             rv += uint32_pack (sublen, scratch + rv);
-            if (file != NULL) {
-                plcrash_async_file_write(file, scratch, rv);
-                plcrash_async_file_write(file, bd->data, sublen);
-            }
+            plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, bd->data, sublen);
             rv += sublen;
             break;
         }
@@ -272,8 +310,7 @@ size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLPro
         {
             scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
             rv += uint32_pack (*(const uint32_t *) value, scratch + rv);
-            if (file != NULL)
-                plcrash_async_file_write(file, scratch, rv);
+            plcrash_async_file_write(file, scratch, rv);
             break;
         }
         default:
@@ -282,3 +319,61 @@ size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLPro
     }
     return rv;
 }
+
+/* === deferred length prefixes === */
+static inline void padded_uint32_pack (uint32_t value, uint8_t out[PLCRASH_WRITER_DEFERRED_LENGTH_SIZE])
+{
+    out[0] = (value & 0x7F) | 0x80;
+    out[1] = ((value >> 7) & 0x7F) | 0x80;
+    out[2] = ((value >> 14) & 0x7F) | 0x80;
+    out[3] = ((value >> 21) & 0x7F) | 0x80;
+    out[4] = (value >> 28) & 0x7F;
+}
+
+/**
+ * Write a length-prefixed message header for @a field_id, reserving a fixed-width length prefix that may be
+ * filled in via plcrash_writer_pack_fixup_length() once the message has been written.
+ *
+ * This allows a message to be written in a single pass, rather than computing its size with a NULL @a file
+ * and then writing it out a second time.
+ *
+ * @param file Output file; may be NULL, in which case only the encoded size is returned.
+ * @param field_id The message's field identifier.
+ * @param position On return, the file position of the reserved length prefix, or -1 if @a file is NULL.
+ *
+ * @return Returns the number of bytes written (or that would have been written) for the message header.
+ */
+size_t plcrash_writer_pack_deferred_length (plcrash_async_file_t *file, uint32_t field_id, off_t *position) {
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE + PLCRASH_WRITER_DEFERRED_LENGTH_SIZE];
+    size_t rv;
+
+    rv = tag_pack (field_id, scratch);
+    scratch[0] |= PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED;
+
+    padded_uint32_pack(0, scratch + rv);
+
+    if (file != NULL) {
+        *position = plcrash_async_file_position(file) + rv;
+        plcrash_async_file_write(file, scratch, rv + PLCRASH_WRITER_DEFERRED_LENGTH_SIZE);
+    } else {
+        *position = -1;
+    }
+
+    return rv + PLCRASH_WRITER_DEFERRED_LENGTH_SIZE;
+}
+
+/**
+ * Fill in a length prefix previously reserved via plcrash_writer_pack_deferred_length().
+ *
+ * @param file Output file. Must support positional writes; see plcrash_async_file_seekable().
+ * @param position The position returned by plcrash_writer_pack_deferred_length().
+ * @param length The message's length.
+ *
+ * @return Returns true on success, or false if the length prefix could not be written.
+ */
+bool plcrash_writer_pack_fixup_length (plcrash_async_file_t *file, off_t position, uint32_t length) {
+    uint8_t scratch[PLCRASH_WRITER_DEFERRED_LENGTH_SIZE];
+
+    padded_uint32_pack(length, scratch);
+    return plcrash_async_file_pwrite(file, position, scratch, sizeof(scratch));
+}
@@ -49,7 +49,67 @@ typedef struct PLProtobufCBinaryData {
     void *data;
 } PLProtobufCBinaryData;
 
+/**
+ * The number of bytes used to encode a deferred length prefix written via plcrash_writer_pack_deferred_length(). The
+ * length is encoded as a zero-padded varint, which is large enough to represent any 32-bit length value.
+ */
+#define PLCRASH_WRITER_DEFERRED_LENGTH_SIZE 5
+
+/**
+ * Field identifiers below this value are encoded as a single tag byte. All fields defined by crash_report.proto
+ * fall within this range.
+ */
+#define PLCRASH_WRITER_SINGLE_BYTE_TAG_LIMIT 16
+
+/**
+ * Return the number of bytes required to encode @a value as a varint.
+ *
+ * The length is derived from the index of the value's highest set bit, rather than by shifting out 7 bits at a time.
+ * A value of 0 is encoded in a single byte.
+ */
+static inline size_t plcrash_writer_varint_size (uint64_t value) {
+    return ((63 - __builtin_clzll(value | 1)) * 9 + 73) / 64;
+}
+
+/** The maximum number of bytes required to encode a 64-bit varint. */
+#define PLCRASH_WRITER_MAX_VARINT_BYTES 10
+
+/**
+ * Return the number of bytes required to encode the tag of @a field_id. This is a compile-time constant for the
+ * constant field identifiers used by the log writer.
+ */
+static inline size_t plcrash_writer_tag_size (uint32_t field_id) {
+    if (field_id < PLCRASH_WRITER_SINGLE_BYTE_TAG_LIMIT)
+        return 1;
+    return plcrash_writer_varint_size(((uint64_t) field_id) << 3);
+}
+
+/**
+ * Return the number of bytes required to encode a varint field (uint32, uint64, enum, or bool) with identifier
+ * @a field_id and value @a value, including the field's tag.
+ *
+ * This is equivalent to calling plcrash_writer_pack_size() with the field's type, but is computed inline from the
+ * value's bit length; sizing a message with a fixed set of varint fields reduces to a handful of arithmetic operations.
+ */
+static inline size_t plcrash_writer_varint_field_size (uint32_t field_id, uint64_t value) {
+    return plcrash_writer_tag_size(field_id) + plcrash_writer_varint_size(value);
+}
+
+/**
+ * Return the number of bytes required to encode a length-delimited field (string, bytes, or message) with identifier
+ * @a field_id and a @a length byte payload, including the field's tag and length prefix.
+ */
+static inline size_t plcrash_writer_delimited_field_size (uint32_t field_id, size_t length) {
+    return plcrash_writer_tag_size(field_id) + plcrash_writer_varint_size(length) + length;
+}
+
 size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLProtobufCType field_type, const void *value);
+size_t plcrash_writer_pack_size (uint32_t field_id, PLProtobufCType field_type, const void *value);
+
+size_t plcrash_writer_encode_varint (uint64_t value, uint8_t *out);
+
+size_t plcrash_writer_pack_deferred_length (plcrash_async_file_t *file, uint32_t field_id, off_t *position);
+bool plcrash_writer_pack_fixup_length (plcrash_async_file_t *file, off_t position, uint32_t length);
     
 #ifdef __cplusplus
 }
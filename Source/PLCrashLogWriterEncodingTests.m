@@ -153,4 +153,105 @@ TEST_PACK(EncoderTest__Enum, enum_, enum, ENCODER_TEST__ENUM__Value2, 14, PLPROT
     STAssertTrue(strcmp(et->string, str) == 0, @"Did not encode correct value");
 }
 
+/* Verify that the size-only path agrees with the number of bytes actually written */
+- (void) testPackSize {
+    uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, (uint64_t) UINT32_MAX + 1, UINT64_MAX };
+    int32_t negative = -1;
+    const char *str = "cafe";
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint32_t value32 = (uint32_t) values[i];
+        size_t written = plcrash_writer_pack(&_file, 6, PLPROTOBUF_C_TYPE_UINT64, &values[i]);
+        STAssertEquals(plcrash_writer_pack(NULL, 6, PLPROTOBUF_C_TYPE_UINT64, &values[i]), written, @"Incorrect uint64 size for %llu", values[i]);
+
+        written = plcrash_writer_pack(&_file, 2, PLPROTOBUF_C_TYPE_UINT32, &value32);
+        STAssertEquals(plcrash_writer_pack(NULL, 2, PLPROTOBUF_C_TYPE_UINT32, &value32), written, @"Incorrect uint32 size for %u", value32);
+    }
+
+    size_t written = plcrash_writer_pack(&_file, 1, PLPROTOBUF_C_TYPE_INT32, &negative);
+    STAssertEquals(plcrash_writer_pack(NULL, 1, PLPROTOBUF_C_TYPE_INT32, &negative), written, @"Incorrect negative int32 size");
+
+    written = plcrash_writer_pack(&_file, 16, PLPROTOBUF_C_TYPE_STRING, str);
+    STAssertEquals(plcrash_writer_pack(NULL, 16, PLPROTOBUF_C_TYPE_STRING, str), written, @"Incorrect string size");
+
+    /* Tags outside the single byte range */
+    written = plcrash_writer_pack(&_file, 2048, PLPROTOBUF_C_TYPE_UINT32, &negative);
+    STAssertEquals(plcrash_writer_pack(NULL, 2048, PLPROTOBUF_C_TYPE_UINT32, &negative), written, @"Incorrect multi-byte tag size");
+    STAssertEquals(plcrash_writer_tag_size(2048), (size_t) 3, @"Incorrect tag size");
+}
+
+/* Verify that the inline field size helpers agree with plcrash_writer_pack() */
+- (void) testFieldSize {
+    uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, (uint64_t) UINT32_MAX + 1, UINT64_MAX };
+    uint32_t field_ids[] = { 1, 15, 16, 2048 };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        for (size_t j = 0; j < sizeof(field_ids) / sizeof(field_ids[0]); j++) {
+            uint32_t length = (uint32_t) (values[i] & 0xFFFF);
+
+            STAssertEquals(plcrash_writer_varint_field_size(field_ids[j], values[i]), plcrash_writer_pack(NULL, field_ids[j], PLPROTOBUF_C_TYPE_UINT64, &values[i]),
+                           @"Incorrect varint field size for %llu", values[i]);
+            STAssertEquals(plcrash_writer_delimited_field_size(field_ids[j], length), plcrash_writer_pack(NULL, field_ids[j], PLPROTOBUF_C_TYPE_MESSAGE, &length) + length,
+                           @"Incorrect delimited field size for %u", length);
+        }
+    }
+}
+
+/* Verify that a deferred length can be backpatched while the length prefix is still buffered */
+- (void) testPackDeferredLength {
+    const char *str = "cafe";
+    off_t position;
+
+    STAssertTrue(plcrash_async_file_seekable(&_file), @"Test file should support positional writes");
+
+    size_t hdrlen = plcrash_writer_pack_deferred_length(&_file, 16, &position);
+    STAssertEquals(hdrlen, (size_t) 1 + PLCRASH_WRITER_DEFERRED_LENGTH_SIZE, @"Incorrect header size");
+    STAssertEquals(position, (off_t) 1, @"Incorrect length prefix position");
+
+    STAssertTrue(plcrash_async_file_write(&_file, str, strlen(str)), @"Failed to write string data");
+    STAssertTrue(plcrash_writer_pack_fixup_length(&_file, position, strlen(str)), @"Failed to backpatch length");
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertNotNil(data, @"Failed to load encoded data");
+    if (data == nil)
+        return;
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertNotNULL(et->string, @"Did not encode correct type");
+    STAssertTrue(strcmp(et->string, str) == 0, @"Did not encode correct value");
+}
+
+/* Verify that a deferred length can be backpatched after the length prefix has been flushed to disk */
+- (void) testPackDeferredLengthFlushed {
+    uint8_t bytes[PLCRASH_ASYNC_FILE_INLINE_BUFFER_SIZE * 4];
+    off_t position;
+
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = i & 0xFF;
+
+    plcrash_writer_pack_deferred_length(&_file, 15, &position);
+    STAssertTrue(plcrash_async_file_write(&_file, bytes, sizeof(bytes)), @"Failed to write byte data");
+    STAssertTrue(plcrash_writer_pack_fixup_length(&_file, position, sizeof(bytes)), @"Failed to backpatch length");
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertNotNil(data, @"Failed to load encoded data");
+    if (data == nil)
+        return;
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertTrue(et->has_bytes, @"Did not encode correct type");
+    STAssertEquals(et->bytes.len, sizeof(bytes), @"Encoded incorrect size");
+    STAssertTrue((memcmp(et->bytes.data, bytes, sizeof(bytes)) == 0), @"Did not encode correct value");
+}
+
 @end
@@ -31,6 +31,7 @@
 #import "PLCrashLogWriter.h"
 #import "PLCrashFrameWalker.h"
 #import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashAsyncInstrumentation.h"
 #import "PLCrashReport.h"
 
 #import "PLCrashProcessInfo.h"
@@ -40,15 +41,72 @@
 #import <sys/mman.h>
 #import <fcntl.h>
 #import <dlfcn.h>
+#import <objc/runtime.h>
+#import <mach/mach_time.h>
 
 #import <mach-o/loader.h>
 #import <mach-o/dyld.h>
+#import <mach-o/getsect.h>
 
 #import "crash_report.pb-c.h"
 #import "PLCrashTestThread.h"
 
 #import "PLCrashSysctl.h"
 
+/** The recursion depth of the frame limit test thread. */
+#define RECURSION_TEST_DEPTH 256
+
+/**
+ * State for a test thread that blocks at the bottom of a deep recursion.
+ */
+struct recursion_test_thread {
+    /** The running thread. */
+    pthread_t thread;
+
+    /** Lock guarding @a ready and @a stop. */
+    pthread_mutex_t lock;
+
+    /** Signaled when @a ready or @a stop is set. */
+    pthread_cond_t cond;
+
+    /** Set once the thread has reached the bottom of the recursion. */
+    bool ready;
+
+    /** Set when the thread should return. */
+    bool stop;
+};
+
+static int __attribute__((noinline)) recursion_test_recurse (struct recursion_test_thread *args, int depth) {
+    if (depth == 0) {
+        pthread_mutex_lock(&args->lock);
+        args->ready = true;
+        pthread_cond_broadcast(&args->cond);
+        while (!args->stop)
+            pthread_cond_wait(&args->cond, &args->lock);
+        pthread_mutex_unlock(&args->lock);
+        return 0;
+    }
+
+    /* The volatile store prevents the recursion from being converted into a loop */
+    volatile int result = recursion_test_recurse(args, depth - 1);
+    return result + 1;
+}
+
+static void *recursion_test_main (void *arg) {
+    recursion_test_recurse(arg, RECURSION_TEST_DEPTH);
+    return NULL;
+}
+
+/* Return the suspend count of @a thread, or -1 if it could not be fetched */
+static integer_t thread_suspend_count (thread_t thread) {
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(thread, THREAD_BASIC_INFO, (thread_info_t) &info, &count) != KERN_SUCCESS)
+        return -1;
+
+    return info.suspend_count;
+}
+
 @interface PLCrashLogWriterTests : SenTestCase {
 @private
     /* Path to crash log */
@@ -208,8 +266,10 @@
     for (int i = 0; i < crashReport->n_threads; i++) {
         Plcrash__CrashReport__Thread *thread = threads[i];
 
-        /* Check that the threads are provided in order */
-        if (i > 0) {
+        /* Check that the crashed thread is provided first, followed by the remaining threads in order */
+        if (thread->crashed) {
+            STAssertEquals(i, 0, @"The crashed thread was not encoded first");
+        } else if (i > 0 && !threads[i - 1]->crashed) {
             STAssertTrue(lastThreadNumber < thread->thread_number, @"Threads were encoded out of order (%d vs %d)", i, thread->thread_number);
         }
         lastThreadNumber = thread->thread_number;
@@ -221,6 +281,7 @@
         if (thread->crashed) {
             foundCrashed = YES;
             STAssertNotEquals((size_t)0, thread->n_registers, @"No registers available on crashed thread");
+            STAssertNULL(thread->register_state, @"Compact register state was written by default");
         }
         
         for (int j = 0; j < thread->n_frames; j++) {
@@ -300,6 +361,120 @@
     return crashReport;
 }
 
+/**
+ * Decode the report written to the log path via PLCrashReport.
+ */
+- (PLCrashReport *) loadCrashReport {
+    NSError *error = nil;
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode crash report: %@", error);
+
+    return report;
+}
+
+/**
+ * Write a report of a faux SIGSEGV on @a thread to the log path, returning YES on success.
+ *
+ * The writer is closed, but not freed, allowing the caller to inspect the writer's state; the caller is responsible
+ * for freeing the writer.
+ *
+ * @param writer An initialized writer.
+ * @param thread The thread to be reported as crashed.
+ * @param loader The dynamic loader reference to use, or NULL to use a new reference.
+ */
+- (BOOL) writeReportFileWithWriter: (plcrash_log_writer_t *) writer thread: (thread_t) thread loader: (plcrash_async_dynloader_t *) loader {
+    plcrash_async_dynloader_t *owned_loader = NULL;
+    plcrash_async_thread_state_t thread_state;
+    plcrash_async_file_t file;
+
+    /* Initialize the dynamic loader reference */
+    if (loader == NULL) {
+        STAssertEquals(plcrash_nasync_dynloader_new(&owned_loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+        loader = owned_loader;
+    }
+
+    /* Initialze faux crash data */
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = (void *) 0x42;
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+
+        /* Steal the thread's stack for iteration */
+        plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+    }
+
+    /* Write the crash report, replacing any report left by an earlier write */
+    unlink([_logPath fileSystemRepresentation]);
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    STAssertTrue(fd >= 0, @"Could not open the report file: %s", strerror(errno));
+    if (fd < 0) {
+        if (owned_loader != NULL)
+            plcrash_async_dynloader_free(owned_loader);
+        plcrash_log_writer_close(writer);
+        return NO;
+    }
+    plcrash_async_file_init(&file, fd, 0);
+
+    plcrash_error_t err = plcrash_log_writer_write(writer, thread, loader, &file, &info, &thread_state);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Crash log failed");
+    plcrash_log_writer_close(writer);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    if (owned_loader != NULL)
+        plcrash_async_dynloader_free(owned_loader);
+
+    return err == PLCRASH_ESUCCESS;
+}
+
+/**
+ * Write a report of a faux SIGSEGV on @a thread to the log path, returning the decoded report, or NULL on failure.
+ *
+ * The writer is closed, but not freed, allowing the caller to inspect the writer's state; the caller is responsible
+ * for freeing both the writer and the returned report.
+ *
+ * @param writer An initialized writer.
+ * @param thread The thread to be reported as crashed.
+ * @param loader The dynamic loader reference to use, or NULL to use a new reference.
+ */
+- (Plcrash__CrashReport *) writeReportWithWriter: (plcrash_log_writer_t *) writer thread: (thread_t) thread loader: (plcrash_async_dynloader_t *) loader {
+    if (![self writeReportFileWithWriter: writer thread: thread loader: loader])
+        return NULL;
+
+    return [self loadReport];
+}
+
+/**
+ * Write a report of a faux SIGSEGV on the test thread to the log path, returning the decoded report, or NULL on failure.
+ * The caller is responsible for freeing both the writer and the returned report.
+ *
+ * @param writer An initialized writer.
+ */
+- (Plcrash__CrashReport *) writeReportWithWriter: (plcrash_log_writer_t *) writer {
+    return [self writeReportWithWriter: writer thread: pthread_mach_thread_np(_thr_args.thread) loader: NULL];
+}
+
+/**
+ * Write a report of a faux SIGSEGV on the test thread to the log path, returning the report as decoded by
+ * PLCrashReport. The caller is responsible for freeing the writer.
+ *
+ * @param writer An initialized writer.
+ */
+- (PLCrashReport *) writeCrashReportWithWriter: (plcrash_log_writer_t *) writer {
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: writer];
+    if (crashReport == NULL)
+        return nil;
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+    return [self loadCrashReport];
+}
+
 
 - (void) testWriteReport {
     plframe_cursor_t cursor;
@@ -447,4 +622,1802 @@
     protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
 }
 
+/* Verify report output to a non-seekable file descriptor, which requires that messages be sized prior to being written. */
+- (void) testWriteReportNonSeekable {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader;
+    plcrash_async_thread_state_t thread_state;
+    thread_t thread;
+    int fds[2];
+
+    /* Initialize the dynamic loader reference */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    /* Initialze faux crash data */
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = (void *) 0x42;
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+
+        /* Steal the test thread's stack for iteration */
+        thread = pthread_mach_thread_np(_thr_args.thread);
+        plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+    }
+
+    /* Set up the output pipe, and drain it in the background */
+    STAssertEquals(pipe(fds), 0, @"Failed to create pipe: %s", strerror(errno));
+    NSMutableData *output = [NSMutableData data];
+    int read_fd = fds[0];
+    dispatch_semaphore_t drained = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        uint8_t buf[4096];
+        ssize_t nread;
+        while ((nread = read(read_fd, buf, sizeof(buf))) > 0 || (nread < 0 && errno == EINTR)) {
+            if (nread > 0)
+                [output appendBytes: buf length: nread];
+        }
+        dispatch_semaphore_signal(drained);
+    });
+
+    plcrash_async_file_init(&file, fds[1], 0);
+    STAssertFalse(plcrash_async_file_seekable(&file), @"Pipe should not be seekable");
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state), @"Crash log failed");
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+
+    /* Close the write end, and wait for the reader to complete */
+    STAssertTrue(plcrash_async_file_close(&file), @"Failed to close output");
+    dispatch_semaphore_wait(drained, DISPATCH_TIME_FOREVER);
+    dispatch_release(drained);
+    close(fds[0]);
+
+    STAssertTrue([output writeToFile: _logPath atomically: NO], @"Failed to save report data");
+
+    /* Load and validate the written report */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Failed to load report");
+    if (crashReport == NULL)
+        return;
+
+    [self checkSystemInfo: crashReport];
+    [self checkAppInfo: crashReport];
+    [self checkProcessInfo: crashReport];
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test that the crashed thread is written first, and that every other thread is written exactly once.
+ */
+- (void) testWriteReportCrashedThreadFirst {
+    plcrash_test_thread_t others[2];
+    plcrash_log_writer_t writer;
+
+    /* Spawn threads that follow the crashed test thread in the task's thread list */
+    for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++)
+        plcrash_test_thread_spawn(&others[i]);
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++)
+        plcrash_test_thread_stop(&others[i]);
+
+    if (crashReport == NULL)
+        return;
+
+    /* The crashed thread is encoded first */
+    STAssertTrue(crashReport->n_threads > 0, @"No threads were written");
+    STAssertTrue(crashReport->threads[0]->crashed, @"The crashed thread was not encoded first");
+
+    /* Every thread index, including the crashed thread's, is encoded exactly once; as the indices are dense, this
+     * also verifies that no thread was omitted */
+    NSMutableIndexSet *numbers = [NSMutableIndexSet indexSet];
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thread = crashReport->threads[i];
+
+        STAssertFalse([numbers containsIndex: thread->thread_number], @"Thread %u was written more than once", thread->thread_number);
+        STAssertTrue(thread->thread_number < crashReport->n_threads, @"Thread number %u was skipped", thread->thread_number);
+        [numbers addIndex: thread->thread_number];
+
+        if (i > 0)
+            STAssertFalse(thread->crashed, @"More than one crashed thread was written");
+    }
+    STAssertTrue(crashReport->threads[0]->thread_number > 0, @"The crashed test thread should not be the task's first thread");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* The decoded report lists every thread once, in thread order */
+    PLCrashReport *report = [self loadCrashReport];
+    NSUInteger thread_count = [numbers count];
+    STAssertEquals([report.threads count], thread_count, @"Incorrect decoded thread count");
+    for (NSUInteger i = 0; i < [report.threads count]; i++)
+        STAssertEquals([[report.threads objectAtIndex: i] threadNumber], (NSInteger) i, @"Decoded threads are out of order");
+}
+
+/**
+ * Test that a writer used from one thread, and then from another, treats the thread writing each report as the current
+ * thread: the writing thread is never suspended, and every other thread, including the thread that wrote the previous
+ * report, is suspended for the write and resumed afterwards.
+ */
+- (void) testWriteReportFromAnotherThread {
+    thread_t runner = pthread_mach_thread_np(pthread_self());
+    thread_t target = pthread_mach_thread_np(_thr_args.thread);
+    plcrash_log_writer_t writer;
+    plcrash_log_writer_t *writerRef = &writer;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+
+    /* Write a report from this thread */
+    STAssertTrue([self writeReportFileWithWriter: &writer thread: target loader: NULL], @"Failed to write the first report");
+    STAssertEquals(thread_suspend_count(runner), 0, @"The writing thread was left suspended");
+    STAssertEquals(thread_suspend_count(target), 0, @"The crashed thread was left suspended");
+
+    /* Write a second report with the same writer from a different thread; if the first report's thread were still
+     * treated as current, the writing thread would suspend itself and never complete */
+    __block BOOL written = NO;
+    __block integer_t writerSuspendCount = -1;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        written = [self writeReportFileWithWriter: writerRef thread: target loader: NULL];
+        writerSuspendCount = thread_suspend_count(pthread_mach_thread_np(pthread_self()));
+        dispatch_semaphore_signal(done);
+    });
+    STAssertEquals(dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)), 0L, @"The report write did not complete");
+    dispatch_release(done);
+    plcrash_log_writer_free(&writer);
+
+    STAssertTrue(written, @"Failed to write the second report");
+    STAssertEquals(writerSuspendCount, 0, @"The writing thread was left suspended");
+    STAssertEquals(thread_suspend_count(runner), 0, @"The previous report's thread was left suspended");
+    STAssertEquals(thread_suspend_count(target), 0, @"The crashed thread was left suspended");
+
+    /* The second report is complete */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Failed to load report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_threads > 0 && crashReport->threads[0]->crashed, @"The crashed thread was not written");
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test that the registers and backtrace written for a suspended crashed thread match the thread's state, as captured
+ * prior to writing the report.
+ */
+- (void) testWriteReportSuspendedThreadState {
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    plcrash_async_thread_state_t state;
+    plcrash_log_writer_t writer;
+
+    /* Suspend the thread, and capture its state */
+    STAssertEquals(thread_suspend(thread), KERN_SUCCESS, @"Failed to suspend thread");
+    STAssertEquals(plcrash_async_thread_state_mach_thread_init(&state, thread), PLCRASH_ESUCCESS, @"Failed to capture thread state");
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer thread: thread loader: NULL];
+    plcrash_log_writer_free(&writer);
+
+    /* Unwind the captured state */
+    plcrash_async_image_list_t *image_list;
+    NSMutableArray *expectedPCs = [NSMutableArray array];
+    STAssertEquals(plcrash_nasync_image_list_new(&image_list, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create image list");
+
+    plframe_cursor_t cursor;
+    STAssertEquals(plframe_cursor_init(&cursor, mach_task_self(), &state, image_list), PLFRAME_ESUCCESS, @"Failed to initialize cursor");
+    while ([expectedPCs count] < 512 && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+        plcrash_greg_t pc;
+        STAssertEquals(plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc), PLFRAME_ESUCCESS, @"Failed to fetch PC");
+        [expectedPCs addObject: [NSNumber numberWithUnsignedLongLong: pc]];
+    }
+    plframe_cursor_free(&cursor);
+    plcrash_async_image_list_free(image_list);
+
+    STAssertEquals(thread_resume(thread), KERN_SUCCESS, @"Failed to resume thread");
+
+    if (crashReport == NULL)
+        return;
+
+    Plcrash__CrashReport__Thread *crashed = NULL;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        if (crashReport->threads[i]->crashed)
+            crashed = crashReport->threads[i];
+    }
+    STAssertNotNULL(crashed, @"No crashed thread was written");
+    if (crashed == NULL) {
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+        return;
+    }
+
+    /* The registers must match the captured state */
+    STAssertEquals(crashed->n_registers, plcrash_async_thread_state_get_reg_count(&state), @"Incorrect register count");
+    for (size_t i = 0; i < crashed->n_registers && i < plcrash_async_thread_state_get_reg_count(&state); i++) {
+        Plcrash__CrashReport__Thread__RegisterValue *reg = crashed->registers[i];
+        STAssertEqualCStrings(reg->name, plcrash_async_thread_state_get_reg_name(&state, (plcrash_regnum_t) i), @"Incorrect name for register %zu", i);
+        STAssertEquals(reg->value, (uint64_t) plcrash_async_thread_state_get_reg(&state, (plcrash_regnum_t) i), @"Incorrect value for register %s", reg->name);
+    }
+
+    /* The backtrace must match the captured state's unwind */
+    STAssertEquals(crashed->n_frames, (size_t) [expectedPCs count], @"Incorrect frame count");
+    for (size_t i = 0; i < crashed->n_frames && i < [expectedPCs count]; i++)
+        STAssertEquals(crashed->frames[i]->pc, [[expectedPCs objectAtIndex: i] unsignedLongLongValue], @"Incorrect PC for frame %zu", i);
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test that the crashed thread's registers are written with the names, order and count defined prior to the adoption
+ * of table-driven register access. Only the host architecture's registers may be written.
+ */
+- (void) testWriteReportRegisterOrder {
+#if defined(__x86_64__)
+    NSArray *expected = [NSArray arrayWithObjects: @"rip", @"rbp", @"rsp", @"rax", @"rbx", @"rcx", @"rdx", @"rdi", @"rsi",
+                         @"r8", @"r9", @"r10", @"r11", @"r12", @"r13", @"r14", @"r15", @"rflags", @"cs", @"fs", @"gs", nil];
+#elif defined(__arm64__)
+    NSArray *expected = [NSArray arrayWithObjects: @"pc", @"fp", @"sp",
+                         @"x0", @"x1", @"x2", @"x3", @"x4", @"x5", @"x6", @"x7", @"x8", @"x9", @"x10", @"x11", @"x12", @"x13", @"x14",
+                         @"x15", @"x16", @"x17", @"x18", @"x19", @"x20", @"x21", @"x22", @"x23", @"x24", @"x25", @"x26", @"x27", @"x28",
+                         @"lr", @"cpsr", nil];
+#else
+    NSArray *expected = nil;
+#endif
+    plcrash_log_writer_t writer;
+
+    if (expected == nil)
+        return;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    NSArray *registers = report.crashedThread.registers;
+    STAssertEquals([registers count], [expected count], @"Incorrect register count");
+    for (NSUInteger i = 0; i < [registers count] && i < [expected count]; i++) {
+        PLCrashReportRegisterInfo *reg = [registers objectAtIndex: i];
+        STAssertEqualStrings(reg.registerName, [expected objectAtIndex: i], @"Incorrect register at index %lu", (unsigned long) i);
+    }
+}
+
+/**
+ * Test writing a report with thread stacks unwound by a pool of unwind workers.
+ */
+- (void) testWriteReportParallelUnwind {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_unwind_workers(&writer, 4);
+    STAssertEquals(writer.unwind_worker_count, (uint32_t) 4, @"Worker count not set");
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkSystemInfo: crashReport];
+    [self checkAppInfo: crashReport];
+    [self checkProcessInfo: crashReport];
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report with thread stacks unwound and symbolicated by a pipeline of worker stages.
+ */
+- (void) testWriteReportPipelined {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_pipelined(&writer, true);
+    STAssertTrue(writer.pipelined, @"Pipelining not enabled");
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkSystemInfo: crashReport];
+    [self checkAppInfo: crashReport];
+    [self checkProcessInfo: crashReport];
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report with threads resumed once their stacks have been copied.
+ */
+- (void) testWriteReportStackSnapshot {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_stack_snapshot_size(&writer, 64 * 1024);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkSystemInfo: crashReport];
+    [self checkAppInfo: crashReport];
+    [self checkProcessInfo: crashReport];
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report with identical thread stacks collapsed.
+ */
+- (void) testWriteReportCollapseStacks {
+    plcrash_log_writer_t writer;
+    plcrash_test_thread_t idle[2];
+
+    /* Spawn two threads parked at identical stacks */
+    for (size_t i = 0; i < sizeof(idle) / sizeof(idle[0]); i++)
+        plcrash_test_thread_spawn_depth(&idle[i], 3);
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_collapse_stacks(&writer, true);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    for (size_t i = 0; i < sizeof(idle) / sizeof(idle[0]); i++)
+        plcrash_test_thread_stop(&idle[i]);
+
+    if (crashReport == NULL)
+        return;
+
+    /* Each duplicate must reference a preceding, non-crashed thread written in full */
+    size_t duplicates = 0;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        if (!thr->has_duplicate_of_thread)
+            continue;
+
+        duplicates++;
+        STAssertFalse(thr->crashed, @"The crashed thread should never be collapsed");
+        STAssertEquals(thr->n_frames, (size_t) 0, @"Frames were written for a duplicate thread");
+
+        BOOL found = NO;
+        for (size_t j = 0; j < i; j++) {
+            Plcrash__CrashReport__Thread *source = crashReport->threads[j];
+            if (source->thread_number != thr->duplicate_of_thread)
+                continue;
+
+            found = YES;
+            STAssertFalse(source->has_duplicate_of_thread, @"A duplicate must reference a thread written in full");
+            STAssertTrue(source->n_frames > 0, @"The referenced thread has no frames");
+        }
+        STAssertTrue(found, @"The referenced thread does not precede its duplicate");
+    }
+    STAssertTrue(duplicates >= 1, @"The identical stacks were not collapsed");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that the duplicates are provided the referenced thread's frames by PLCrashReport */
+    PLCrashReport *report = [self loadCrashReport];
+    for (PLCrashReportThreadInfo *threadInfo in report.threads)
+        STAssertTrue(threadInfo.frameCount > 0, @"Thread %ld has no frames", (long) threadInfo.threadNumber);
+}
+
+/**
+ * Test writing a report that includes a thread recorded as a secondary crash.
+ */
+- (void) testWriteReportSecondaryCrash {
+    plcrash_log_writer_t writer;
+    plcrash_test_thread_t secondary;
+
+    /* Record a second test thread as having crashed */
+    plcrash_log_secondary_crashes_t crashes;
+    memset(&crashes, 0, sizeof(crashes));
+    plcrash_test_thread_spawn(&secondary);
+    {
+        thread_t secondary_thread = pthread_mach_thread_np(secondary.thread);
+        plcrash_async_thread_state_t secondary_state;
+        plcrash_log_bsd_signal_info_t secondary_info = { .signo = SIGBUS, .code = BUS_ADRALN, .address = (void *) 0x43 };
+
+        plcrash_async_thread_state_mach_thread_init(&secondary_state, secondary_thread);
+        STAssertTrue(plcrash_log_secondary_crashes_add(&crashes, secondary_thread, &secondary_info, &secondary_state), @"Failed to add crash");
+    }
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_secondary_crashes(&writer, &crashes);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    plcrash_test_thread_stop(&secondary);
+
+    if (crashReport == NULL)
+        return;
+
+    size_t found = 0;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        if (thr->secondary_crash == NULL)
+            continue;
+
+        found++;
+        STAssertFalse(thr->crashed, @"A secondary crash should not be marked as the crashed thread");
+        STAssertEqualCStrings(thr->secondary_crash->name, "SIGBUS", @"Incorrect signal name");
+        STAssertEqualCStrings(thr->secondary_crash->code, "BUS_ADRALN", @"Incorrect signal code");
+        STAssertEquals(thr->secondary_crash->address, (uint64_t) 0x43, @"Incorrect signal address");
+        STAssertNotEquals((size_t) 0, thr->n_registers, @"Missing secondary crash registers");
+        STAssertTrue(thr->n_frames > 0, @"Missing secondary crash frames");
+    }
+    STAssertEquals(found, (size_t) 1, @"Incorrect number of secondary crashes");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that PLCrashReport vends the secondary crash */
+    PLCrashReport *report = [self loadCrashReport];
+
+    NSUInteger reported = 0;
+    for (PLCrashReportThreadInfo *threadInfo in report.threads) {
+        if (threadInfo.secondaryCrashSignalInfo == nil)
+            continue;
+
+        reported++;
+        STAssertEqualStrings(threadInfo.secondaryCrashSignalInfo.name, @"SIGBUS", @"Incorrect signal name");
+    }
+    STAssertEquals(reported, (NSUInteger) 1, @"Incorrect number of secondary crashes");
+}
+
+/**
+ * Test writing a report with idle threads unwound shallowly.
+ */
+- (void) testWriteReportIdleThreadFrames {
+    plcrash_log_writer_t writer;
+    plcrash_test_thread_t idle;
+
+    /* Spawn a deep thread parked in pthread_cond_wait() */
+    plcrash_test_thread_spawn_depth(&idle, 32);
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_idle_thread_frames(&writer, 4);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    STAssertTrue(writer.idle_stub_count > 0, @"No idle syscall stubs were resolved");
+    plcrash_log_writer_free(&writer);
+
+    plcrash_test_thread_stop(&idle);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+
+    /* The deep test thread must have been truncated; the crashed thread, also parked, must not */
+    BOOL foundIdle = NO;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+
+        BOOL isTestThread = NO;
+        for (size_t j = 0; j < thr->n_frames; j++) {
+            Plcrash__CrashReport__Symbol *sym = thr->frames[j]->symbol;
+            if (sym != NULL && sym->name != NULL && strstr(sym->name, "test_thread_wait") != NULL)
+                isTestThread = YES;
+        }
+
+        if (!isTestThread)
+            continue;
+
+        if (thr->crashed) {
+            STAssertTrue(thr->n_frames > 4, @"The crashed thread should not be truncated");
+        } else {
+            foundIdle = YES;
+            STAssertTrue(thr->n_frames <= 4, @"The idle thread was not truncated");
+        }
+    }
+    STAssertTrue(foundIdle, @"The idle test thread was not found");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report that references a separately written shared image list, and resolving the report's images
+ * from that list.
+ */
+- (void) testWriteReportSharedImageList {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader;
+    uint32_t generation;
+    uint8_t session[16];
+    NSError *error;
+
+    memset(session, 0xAB, sizeof(session));
+
+    /* Initialize the dynamic loader reference; the image monitor provides the image list generation */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+    STAssertEquals(plcrash_nasync_dynloader_enable_image_monitor(loader), PLCRASH_ESUCCESS, @"Failed to enable the image monitor");
+
+    /* Write the image list, along with a list written under another session */
+    NSString *listPath = [_logPath stringByAppendingPathExtension: @"plimages"];
+    NSString *otherListPath = [_logPath stringByAppendingPathExtension: @"other"];
+    uint8_t otherSession[16];
+    uint32_t otherGeneration;
+    memset(otherSession, 0xCD, sizeof(otherSession));
+
+    int fd = open([listPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+    STAssertEquals(plcrash_log_writer_write_image_list(loader, _allocator, session, &file, &generation), PLCRASH_ESUCCESS, @"Failed to write image list");
+    plcrash_async_file_close(&file);
+
+    fd = open([otherListPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+    STAssertEquals(plcrash_log_writer_write_image_list(loader, _allocator, otherSession, &file, &otherGeneration), PLCRASH_ESUCCESS, @"Failed to write image list");
+    plcrash_async_file_close(&file);
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_shared_image_list(&writer, session, generation);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer thread: pthread_mach_thread_np(_thr_args.thread) loader: loader];
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+
+    if (crashReport == NULL)
+        return;
+
+    /* The report must reference the image list, in place of its own images */
+    STAssertNotNULL(crashReport->shared_image_list, @"No shared image list reference was written");
+    STAssertEquals(crashReport->n_binary_images, (size_t) 0, @"Binary images were written to the report");
+    STAssertEquals(crashReport->n_compact_binary_images, (size_t) 0, @"Compact binary images were written to the report");
+    if (crashReport->shared_image_list != NULL)
+        STAssertEquals(crashReport->shared_image_list->generation, generation, @"Incorrect generation");
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Resolve the report's images, in both decoding modes */
+    NSData *listData = [NSData dataWithContentsOfFile: listPath];
+    NSData *otherListData = [NSData dataWithContentsOfFile: otherListPath];
+    STAssertNotNil(listData, @"Failed to read image list");
+    STAssertNotNil(otherListData, @"Failed to read image list");
+
+    for (int lazy = 0; lazy < 2; lazy++) {
+        PLCrashReportDecodingOptions options = lazy ? PLCrashReportDecodingOptionLazy : 0;
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: _logPath options: options error: &error] autorelease];
+        STAssertNotNil(report, @"Could not decode report: %@", error);
+
+        STAssertTrue(report.hasSharedImageList, @"The report should reference a shared image list");
+        STAssertNotNil(report.sharedImageListFileName, @"No image list file name");
+        STAssertTrue([report resolveSharedImageListWithData: listData error: &error], @"Could not resolve image list: %@", error);
+        STAssertTrue([report.images count] > 0, @"No images were resolved");
+
+        STAssertNotNil([report imageForAddress: (uint64_t) (uintptr_t) &plcrash_log_writer_write_image_list], @"The resolved images do not include our own image");
+
+        /* An image list written by another session must be rejected */
+        STAssertFalse([report resolveSharedImageListWithData: otherListData error: NULL], @"A mismatched image list was accepted");
+    }
+
+    unlink([listPath UTF8String]);
+    unlink([otherListPath UTF8String]);
+}
+
+/**
+ * Test writing a report restricted to a subset of threads; only the selected threads and the images they reference
+ * may be written.
+ */
+- (void) testWriteReportThreadFilter {
+    plcrash_log_writer_t writer;
+    plcrash_test_thread_t other;
+
+    /* Select a second thread; all remaining threads must be omitted */
+    plcrash_test_thread_spawn(&other);
+    thread_t selected = pthread_mach_thread_np(other.thread);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_thread_filter(&writer, &selected, 1);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    plcrash_test_thread_stop(&other);
+
+    if (crashReport == NULL)
+        return;
+
+    /* Only the crashed and selected threads may be written */
+    STAssertEquals(crashReport->n_threads, (size_t) 2, @"Unselected threads were written");
+
+    /* Only referenced images may be written */
+    STAssertTrue(crashReport->n_binary_images > 0, @"No images were written");
+    STAssertTrue(crashReport->n_binary_images < _dyld_image_count(), @"Unreferenced images were written");
+    STAssertEquals(crashReport->n_compact_binary_images, (size_t) 0, @"Unreferenced images were written");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a reduced crash loop report.
+ */
+- (void) testWriteReportCrashLoop {
+    plcrash_log_writer_t writer;
+    plcrash_async_dynloader_t *loader;
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    uint64_t hash, rehash;
+
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+
+    /* The hash of the (blocked) test thread must be stable */
+    STAssertEquals(plcrash_log_writer_stack_hash(&writer, mach_task_self(), thread, loader, NULL, &hash), PLCRASH_ESUCCESS, @"Failed to hash stack");
+    STAssertEquals(plcrash_log_writer_stack_hash(&writer, mach_task_self(), thread, loader, NULL, &rehash), PLCRASH_ESUCCESS, @"Failed to hash stack");
+    STAssertEquals(hash, rehash, @"Stack hash is not stable");
+    STAssertTrue(hash != 0, @"Stack hash is zero");
+
+    plcrash_log_writer_set_crash_loop(&writer, 3, hash, true);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer thread: thread loader: loader];
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+
+    if (crashReport == NULL)
+        return;
+
+    STAssertNotNULL(crashReport->crash_loop, @"No crash loop record was written");
+    if (crashReport->crash_loop != NULL) {
+        STAssertEquals(crashReport->crash_loop->launch_crash_count, (uint32_t) 3, @"Incorrect launch crash count");
+        STAssertEquals(crashReport->crash_loop->stack_hash, hash, @"Incorrect stack hash");
+        STAssertTrue(crashReport->crash_loop->reduced, @"Report was not marked as reduced");
+    }
+
+    /* Only the crashed thread and its referenced images may be written */
+    STAssertEquals(crashReport->n_threads, (size_t) 1, @"Non-crashed threads were written");
+    STAssertTrue(crashReport->n_binary_images < _dyld_image_count(), @"Unreferenced images were written");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a live trace. Unchanged stacks must be omitted from subsequent samples, and exited threads listed.
+ */
+- (void) testWriteTraceSamples {
+    plcrash_log_writer_t writer;
+    plcrash_log_trace_t *trace;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader;
+    plcrash_test_thread_t idle;
+
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    STAssertEquals(plcrash_log_trace_new(&trace, 256), PLCRASH_ESUCCESS, @"Failed to create trace");
+
+    /* Park an additional thread, allowing its exit to be observed */
+    thread_identifier_info_data_t ident;
+    mach_msg_type_number_t ident_count = THREAD_IDENTIFIER_INFO_COUNT;
+    plcrash_test_thread_spawn(&idle);
+    STAssertEquals(thread_info(pthread_mach_thread_np(idle.thread), THREAD_IDENTIFIER_INFO, (thread_info_t) &ident, &ident_count), KERN_SUCCESS, @"Failed to fetch thread identifier");
+
+    /* Write two samples while the thread is parked, and a third once it has exited */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(plcrash_log_writer_write_trace_sample(&writer, trace, loader, &file), PLCRASH_ESUCCESS, @"Sample failed");
+    STAssertEquals(plcrash_log_writer_write_trace_sample(&writer, trace, loader, &file), PLCRASH_ESUCCESS, @"Sample failed");
+    plcrash_test_thread_stop(&idle);
+    STAssertEquals(plcrash_log_writer_write_trace_sample(&writer, trace, loader, &file), PLCRASH_ESUCCESS, @"Sample failed");
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    plcrash_log_trace_free(trace);
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+
+    /* Decode the trace */
+    NSData *data = [NSData dataWithContentsOfFile: _logPath];
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    STAssertTrue([data length] > sizeof(struct PLCrashReportFileHeader), @"File is too small for magic + version + data");
+    STAssertTrue(memcmp(header->magic, PLCRASH_TRACE_FILE_MAGIC, strlen(PLCRASH_TRACE_FILE_MAGIC)) == 0, @"Incorrect file magic");
+    STAssertEquals(header->version, (uint8_t) PLCRASH_TRACE_FILE_VERSION, @"Incorrect file version");
+
+    Plcrash__Trace *decoded = plcrash__trace__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    STAssertNotNULL(decoded, @"Could not decode trace");
+    if (decoded == NULL)
+        return;
+
+    STAssertNotNULL(decoded->header, @"No trace header was written");
+    STAssertEquals(decoded->n_samples, (size_t) 3, @"Incorrect sample count");
+    if (decoded->n_samples == 3) {
+        /* The first sample must include the complete stacks of all threads */
+        Plcrash__Trace__Sample *first = decoded->samples[0];
+        BOOL found = NO;
+        for (size_t i = 0; i < first->n_threads; i++) {
+            STAssertEquals(first->threads[i]->retained_frames, (uint32_t) 0, @"Frames retained by the first sample");
+            if (first->threads[i]->thread_id == ident.thread_id) {
+                found = YES;
+                STAssertTrue(first->threads[i]->n_frames > 0, @"No frames were written for the parked thread");
+            }
+        }
+        STAssertTrue(found, @"The parked thread was not written to the first sample");
+
+        /* The parked thread's stack is unchanged, and must be omitted */
+        Plcrash__Trace__Sample *second = decoded->samples[1];
+        for (size_t i = 0; i < second->n_threads; i++)
+            STAssertTrue(second->threads[i]->thread_id != ident.thread_id, @"An unchanged stack was written");
+        STAssertEquals(second->n_ended_threads, (size_t) 0, @"Threads were incorrectly marked as ended");
+
+        /* The exited thread must be listed */
+        Plcrash__Trace__Sample *third = decoded->samples[2];
+        found = NO;
+        for (size_t i = 0; i < third->n_ended_threads; i++) {
+            if (third->ended_threads[i] == ident.thread_id)
+                found = YES;
+        }
+        STAssertTrue(found, @"The exited thread was not listed");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) decoded, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report with symbol names uniqued via the symbol string table.
+ */
+- (void) testWriteReportSymbolInterning {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report; the symbol table is shared by the unwind workers, so enable those too */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_symbol_interning(&writer, true);
+    plcrash_log_writer_set_unwind_workers(&writer, 4);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    STAssertNULL(writer.symbol_table, @"Symbol table was not released");
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+
+    /* Verify that the string table's entries are unique */
+    STAssertNotNULL(crashReport->symbol_strings, @"No symbol string table was written");
+    if (crashReport->symbol_strings == NULL) {
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+        return;
+    }
+
+    Plcrash__CrashReport__StringTable *strings = crashReport->symbol_strings;
+    STAssertTrue(strings->n_strings > 0, @"Empty symbol string table was written");
+    for (size_t i = 0; i < strings->n_strings; i++) {
+        for (size_t j = i + 1; j < strings->n_strings; j++)
+            STAssertTrue(strcmp(strings->strings[i], strings->strings[j]) != 0, @"Duplicate symbol name %s", strings->strings[i]);
+    }
+
+    /* Verify that all symbols reference the table */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        for (size_t j = 0; j < thr->n_frames; j++) {
+            Plcrash__CrashReport__Symbol *symbol = thr->frames[j]->symbol;
+            if (symbol == NULL)
+                continue;
+
+            STAssertTrue(symbol->has_name_index, @"Symbol name was written inline");
+            STAssertNULL(symbol->name, @"Symbol name was written inline");
+            STAssertTrue(symbol->name_index < strings->n_strings, @"Invalid symbol name index");
+        }
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that the report is readable by PLCrashReport, and that the names are resolved */
+    PLCrashReport *report = [self loadCrashReport];
+
+    for (PLCrashReportThreadInfo *thr in report.threads) {
+        for (PLCrashReportStackFrameInfo *frame in thr.stackFrames) {
+            if (frame.symbolInfo != nil)
+                STAssertNotNil(frame.symbolInfo.symbolName, @"Symbol name was not resolved");
+        }
+    }
+}
+
+/**
+ * Test writing a report with packed thread frames.
+ */
+- (void) testWriteReportPackedFrames {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report; packed frames reference the symbol string table, and the unwind workers size the packed
+     * frames of the threads they record */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_symbol_interning(&writer, true);
+    plcrash_log_writer_set_packed_frames(&writer, true);
+    plcrash_log_writer_set_unwind_workers(&writer, 4);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    STAssertNotNULL(crashReport->symbol_strings, @"No symbol string table was written");
+
+    /* Gather the raw PCs of the crashed thread */
+    NSMutableArray *crashedPCs = [NSMutableArray array];
+    BOOL foundSymbols = NO;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        if (thr->has_duplicate_of_thread)
+            continue;
+
+        STAssertTrue(thr->has_frame_pcs, @"Frames of thread %u were not packed", thr->thread_number);
+        STAssertEquals(thr->n_frames, (size_t) 0, @"StackFrame messages were written along with packed frames");
+
+        if (thr->has_frame_symbols && thr->frame_symbols.len > 0)
+            foundSymbols = YES;
+
+        if (!thr->crashed)
+            continue;
+
+        /* Each PC is a single varint */
+        uint64_t value = 0;
+        unsigned int shift = 0;
+        for (size_t j = 0; j < thr->frame_pcs.len; j++) {
+            value |= (uint64_t) (thr->frame_pcs.data[j] & 0x7F) << shift;
+            shift += 7;
+            if ((thr->frame_pcs.data[j] & 0x80) == 0) {
+                [crashedPCs addObject: [NSNumber numberWithUnsignedLongLong: value]];
+                value = 0;
+                shift = 0;
+            }
+        }
+    }
+    STAssertTrue(foundSymbols, @"No packed frame symbols were written");
+    STAssertTrue([crashedPCs count] > 0, @"No packed frames were written for the crashed thread");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that the report is readable by PLCrashReport, and that the frames and symbols are resolved */
+    PLCrashReport *report = [self loadCrashReport];
+
+    PLCrashReportThreadInfo *crashed = nil;
+    for (PLCrashReportThreadInfo *thr in report.threads) {
+        if (thr.crashed)
+            crashed = thr;
+
+        for (PLCrashReportStackFrameInfo *frame in thr.stackFrames) {
+            if (frame.symbolInfo == nil)
+                continue;
+
+            STAssertNotNil(frame.symbolInfo.symbolName, @"Symbol name was not resolved");
+            STAssertTrue(frame.symbolInfo.startAddress <= frame.instructionPointer, @"Symbol start address follows the frame's PC");
+        }
+    }
+
+    STAssertNotNil(crashed, @"No crashed thread was decoded");
+    STAssertEquals([crashed.stackFrames count], [crashedPCs count], @"Incorrect decoded frame count");
+    for (NSUInteger i = 0; i < [crashed.stackFrames count] && i < [crashedPCs count]; i++) {
+        PLCrashReportStackFrameInfo *frame = [crashed.stackFrames objectAtIndex: i];
+        STAssertEquals(frame.instructionPointer, [[crashedPCs objectAtIndex: i] unsignedLongLongValue], @"Incorrect PC for frame %lu", (unsigned long) i);
+    }
+}
+
+/**
+ * Test writing a version 2 report.
+ */
+- (void) testWriteReportV2 {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_v2_format(&writer, true);
+
+    BOOL written = [self writeReportFileWithWriter: &writer thread: pthread_mach_thread_np(_thr_args.thread) loader: NULL];
+    plcrash_log_writer_free(&writer);
+    if (!written)
+        return;
+
+    /* Verify the file header */
+    NSData *data = [NSData dataWithContentsOfFile: _logPath];
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    STAssertTrue([data length] > sizeof(struct PLCrashReportFileHeader), @"File is too small for magic + version + data");
+    STAssertEquals(header->version, (uint8_t) PLCRASH_REPORT_FILE_VERSION_V2, @"File version is not the version 2 format");
+
+    Plcrash__CrashReportV2 *v2 = plcrash__crash_report_v2__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    STAssertNotNULL(v2, @"Could not decode version 2 report");
+    if (v2 == NULL)
+        return;
+
+    /* The crashed thread is written first, with the registers of the host architecture */
+    STAssertTrue(v2->n_threads > 0, @"No threads were written");
+    STAssertTrue(v2->threads[0]->crashed, @"The crashed thread was not written first");
+    STAssertNotNULL(v2->threads[0]->registers, @"No registers were written for the crashed thread");
+#if defined(__arm64__)
+    STAssertNotNULL(v2->threads[0]->registers->arm64, @"No arm64 registers were written");
+#elif defined(__arm__)
+    STAssertNotNULL(v2->threads[0]->registers->arm, @"No arm registers were written");
+#elif defined(__x86_64__)
+    STAssertNotNULL(v2->threads[0]->registers->x86_64, @"No x86-64 registers were written");
+#elif defined(__i386__)
+    STAssertNotNULL(v2->threads[0]->registers->x86_32, @"No x86-32 registers were written");
+#endif
+    STAssertTrue(v2->threads[0]->has_frame_pcs && v2->threads[0]->frame_pcs.len > 0, @"No frames were written for the crashed thread");
+    for (size_t i = 1; i < v2->n_threads; i++)
+        STAssertFalse(v2->threads[i]->crashed, @"More than one crashed thread was written");
+
+    STAssertTrue(v2->n_binary_images > 0, @"No binary images were written");
+    STAssertTrue(v2->n_strings > 0, @"No symbol strings were written");
+    size_t imageCount = v2->n_binary_images;
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) v2, &protobuf_c_system_allocator);
+
+    /* Verify that the report is readable by PLCrashReport */
+    PLCrashReport *report = [self loadCrashReport];
+    PLCrashReportThreadInfo *crashed = report.crashedThread;
+    STAssertNotNil(crashed, @"No crashed thread was decoded");
+    STAssertTrue([crashed.registers count] > 0, @"No registers were decoded");
+    STAssertTrue([crashed.stackFrames count] > 0, @"No frames were decoded");
+    STAssertEquals([report.images count], (NSUInteger) imageCount, @"Incorrect image count");
+
+    for (PLCrashReportStackFrameInfo *frame in crashed.stackFrames) {
+        if (frame.symbolInfo == nil)
+            continue;
+
+        STAssertNotNil(frame.symbolInfo.symbolName, @"Symbol name was not resolved");
+        STAssertTrue(frame.symbolInfo.startAddress <= frame.instructionPointer, @"Symbol start address follows the frame's PC");
+    }
+}
+
+/**
+ * Test writing a report with annotated crashed thread registers.
+ */
+- (void) testWriteReportRegisterAnnotation {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_symbol_interning(&writer, true);
+    plcrash_log_writer_set_register_annotation(&writer, true);
+    plcrash_log_writer_set_register_state(&writer, true);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    /* Validate the raw register state; if present, the annotations must provide a varint pair per register value */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread__RegisterState *state = crashReport->threads[i]->register_state;
+        STAssertEquals((size_t) 0, crashReport->threads[i]->n_registers, @"Named registers were written with the compact register state");
+        if (crashReport->threads[i]->crashed)
+            STAssertNotNULL(state, @"The crashed thread's register state was not written");
+
+        if (state == NULL || !state->has_symbols)
+            continue;
+
+        size_t values = 0;
+        size_t annotations = 0;
+        for (size_t j = 0; j < state->values.len; j++) {
+            if ((state->values.data[j] & 0x80) == 0)
+                values++;
+        }
+        for (size_t j = 0; j < state->symbols.len; j++) {
+            if ((state->symbols.data[j] & 0x80) == 0)
+                annotations++;
+        }
+
+        STAssertEquals(annotations, values * 2, @"Incorrect register annotation count");
+        STAssertNotNULL(crashReport->symbol_strings, @"Register annotations were written without a symbol string table");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that the report is readable by PLCrashReport, and that any annotated symbols contain their register values */
+    PLCrashReport *report = [self loadCrashReport];
+
+    for (PLCrashReportThreadInfo *thr in report.threads) {
+        STAssertEquals([thr.registers count], thr.registerCount, @"Incorrect register count");
+
+        for (NSUInteger i = 0; i < thr.registerCount; i++) {
+            PLCrashReportRegisterInfo *reg = [thr.registers objectAtIndex: i];
+            STAssertEqualObjects(reg.symbolInfo.symbolName, [thr registerSymbolNameAtIndex: i], @"Incorrect symbol name for register %@", reg.registerName);
+            if (reg.symbolInfo == nil)
+                continue;
+
+            STAssertNotNil(reg.symbolInfo.symbolName, @"Symbol name was not resolved");
+            STAssertTrue(reg.symbolInfo.startAddress <= reg.registerValue, @"Symbol start address follows the register value");
+        }
+    }
+}
+
+/**
+ * Test writing a report with a truncated and collapsed stack.
+ */
+- (void) testWriteReportFrameLimits {
+    plcrash_log_writer_t writer;
+    struct recursion_test_thread recursion;
+
+    /* Start a thread with a deeply recursive stack */
+    recursion.ready = false;
+    recursion.stop = false;
+    pthread_mutex_init(&recursion.lock, NULL);
+    pthread_cond_init(&recursion.cond, NULL);
+    STAssertEquals(pthread_create(&recursion.thread, NULL, recursion_test_main, &recursion), 0, @"Failed to start recursion thread");
+
+    pthread_mutex_lock(&recursion.lock);
+    while (!recursion.ready)
+        pthread_cond_wait(&recursion.cond, &recursion.lock);
+    pthread_mutex_unlock(&recursion.lock);
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_frame_limits(&writer, 32, 0, 8);
+    STAssertEquals(writer.max_thread_frames, (uint32_t) 32, @"Thread frame limit not set");
+    STAssertEquals(writer.tail_frames, (uint32_t) 8, @"Tail frame count not set");
+
+    /* Steal the recursion thread's stack for iteration */
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer thread: pthread_mach_thread_np(recursion.thread) loader: NULL];
+    plcrash_log_writer_free(&writer);
+
+    /* Stop the recursion thread */
+    pthread_mutex_lock(&recursion.lock);
+    recursion.stop = true;
+    pthread_cond_broadcast(&recursion.cond);
+    pthread_mutex_unlock(&recursion.lock);
+    pthread_join(recursion.thread, NULL);
+    pthread_cond_destroy(&recursion.cond);
+    pthread_mutex_destroy(&recursion.lock);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+
+    /* The recursion must have been collapsed, and all threads must respect the frame limit */
+    BOOL foundRecursion = NO;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        STAssertTrue(thr->n_frames <= 32, @"Thread frame limit exceeded: %zu", thr->n_frames);
+
+        for (size_t j = 0; j < thr->n_frame_repeats; j++) {
+            Plcrash__CrashReport__Thread__FrameRepeat *repeat = thr->frame_repeats[j];
+            STAssertTrue(repeat->frame_index + repeat->frame_count <= thr->n_frames, @"Repeated run references missing frames");
+
+            if (thr->crashed && repeat->frame_count == 1 && repeat->repeat_count >= RECURSION_TEST_DEPTH - 1)
+                foundRecursion = YES;
+        }
+    }
+    STAssertTrue(foundRecursion, @"The recursion was not collapsed");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that the collapsed runs are readable by PLCrashReport */
+    PLCrashReport *report = [self loadCrashReport];
+    STAssertTrue([report.crashedThread.frameRepeats count] > 0, @"Repeated runs were not decoded");
+}
+
+/**
+ * Test writing a report with a frame budget shared across all threads.
+ */
+- (void) testWriteReportFrameBudget {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report; the budget is also applied to stacks recorded by the unwind workers */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_frame_limits(&writer, 4, 6, 0);
+    plcrash_log_writer_set_unwind_workers(&writer, 4);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    /* The threads must still be written, even once the budget has been exhausted */
+    STAssertTrue(crashReport->n_threads > 1, @"Threads were not written");
+
+    size_t total = 0;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        STAssertTrue(crashReport->threads[i]->n_frames <= 4, @"Thread frame limit exceeded");
+        total += crashReport->threads[i]->n_frames;
+    }
+    STAssertTrue(total <= 6, @"Report frame budget exceeded: %zu", total);
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report under an exhausted time budget.
+ */
+- (void) testWriteReportTimeBudget {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report; the budget will be exhausted by the time the non-crashed threads are written */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_time_budget(&writer, 1);
+    STAssertTrue(writer.time_budget > 0, @"Time budget not set");
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    STAssertFalse(writer.frame_pointer_only, @"Frame pointer unwinding was not reset");
+    STAssertEquals(writer.symbol_strategy, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, @"Symbol strategy was not restored");
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkBinaryImages: crashReport];
+
+    /* The crashed thread must be written first, in full; the remaining threads without frames */
+    STAssertTrue(crashReport->n_threads > 1, @"Threads were not written");
+    STAssertTrue(crashReport->threads[0]->crashed, @"The crashed thread was not written first");
+    STAssertNotEquals((size_t) 0, crashReport->threads[0]->n_frames, @"The crashed thread's frames were not written");
+    STAssertNotEquals((size_t) 0, crashReport->threads[0]->n_registers, @"The crashed thread's registers were not written");
+
+    for (size_t i = 1; i < crashReport->n_threads; i++) {
+        STAssertFalse(crashReport->threads[i]->crashed, @"Multiple crashed threads were written");
+        STAssertEquals((size_t) 0, crashReport->threads[i]->n_frames, @"Frames were written after the time budget was exhausted");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that PLCrashReport restores the threads' order */
+    PLCrashReport *report = [self loadCrashReport];
+
+    NSInteger lastThreadNumber = -1;
+    for (PLCrashReportThreadInfo *thr in report.threads) {
+        STAssertTrue(thr.threadNumber > lastThreadNumber, @"Threads were not ordered by thread number");
+        lastThreadNumber = thr.threadNumber;
+    }
+}
+
+/**
+ * Write a single report to a memory buffer, returning the elapsed time in nanoseconds, or 0 on failure.
+ */
+- (uint64_t) crashHandlerLatencyWithStandby: (BOOL) standby loader: (plcrash_async_dynloader_t *) loader buffer: (void *) buffer size: (size_t) size {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_thread_state_t thread_state;
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    bsd_info.address = (void *) 0x42;
+    bsd_info.code = SEGV_MAPERR;
+    bsd_info.signo = SIGSEGV;
+    info.mach_info = NULL;
+    info.bsd_info = &bsd_info;
+    plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+
+    /* Perform all pre-crash setup prior to starting the clock */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    if (standby) {
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_prepare_standby(&writer, (size_t) objc_getClassList(NULL, 0)), @"Failed to prepare standby state");
+        STAssertTrue(writer.has_standby_cache, @"Standby cache was not initialized");
+    }
+    plcrash_async_file_init_memory(&file, buffer, size);
+
+    /* Time the crash handler's work */
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    uint64_t start = mach_absolute_time();
+    plcrash_error_t err = plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state);
+    plcrash_async_file_flush(&file);
+    uint64_t elapsed = ((mach_absolute_time() - start) * timebase.numer) / timebase.denom;
+
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Crash log failed");
+    STAssertFalse(writer.has_standby_cache, @"Standby cache was not consumed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_async_file_close(&file);
+
+    return err == PLCRASH_ESUCCESS ? elapsed : 0;
+}
+
+/**
+ * Benchmark the time required to write a report from the crash handler, both with and without the writer's hot
+ * standby state.
+ */
+- (void) testCrashHandlerLatency {
+    const size_t bufferSize = 4 * 1024 * 1024;
+    const int iterations = 5;
+    plcrash_async_dynloader_t *loader;
+
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    void *buffer = malloc(bufferSize);
+    STAssertNotNULL(buffer, @"Failed to allocate output buffer");
+
+    uint64_t coldTotal = 0;
+    uint64_t standbyTotal = 0;
+    for (int i = 0; i < iterations; i++) {
+        coldTotal += [self crashHandlerLatencyWithStandby: NO loader: loader buffer: buffer size: bufferSize];
+        standbyTotal += [self crashHandlerLatencyWithStandby: YES loader: loader buffer: buffer size: bufferSize];
+    }
+
+    NSLog(@"crashHandlerLatency: cold %llu us, standby %llu us (mean of %d reports)",
+          (unsigned long long) (coldTotal / iterations / NSEC_PER_USEC), (unsigned long long) (standbyTotal / iterations / NSEC_PER_USEC), iterations);
+
+    STAssertTrue(coldTotal > 0, @"Cold reports were not written");
+    STAssertTrue(standbyTotal > 0, @"Standby reports were not written");
+
+    free(buffer);
+    plcrash_async_dynloader_free(loader);
+}
+
+/**
+ * Test writing a report with compact records for unreferenced images.
+ */
+- (void) testWriteReportCompactImages {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_compact_images(&writer, true);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    STAssertNULL(writer.image_flags, @"Image flags were not reset");
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    [self checkBinaryImages: crashReport];
+    STAssertTrue(crashReport->n_compact_binary_images > 0, @"No compact image records were written");
+
+    /* Every image must be written exactly once */
+    NSMutableSet *fullImages = [NSMutableSet set];
+    for (size_t i = 0; i < crashReport->n_binary_images; i++)
+        [fullImages addObject: [NSNumber numberWithUnsignedLongLong: crashReport->binary_images[i]->base_address]];
+    STAssertEquals([fullImages count], (NSUInteger) crashReport->n_binary_images, @"Duplicate full image records");
+
+    for (size_t i = 0; i < crashReport->n_compact_binary_images; i++) {
+        Plcrash__CrashReport__CompactBinaryImage *image = crashReport->compact_binary_images[i];
+        STAssertFalse([fullImages containsObject: [NSNumber numberWithUnsignedLongLong: image->base_address]], @"Image written in both forms");
+        STAssertEquals(image->uuid.len, (size_t) 16, @"Compact image is missing its UUID");
+    }
+
+    /* All images containing a frame's PC, or a register value, must be written in full */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        NSMutableArray *addresses = [NSMutableArray array];
+
+        for (size_t j = 0; j < thr->n_frames; j++)
+            [addresses addObject: [NSNumber numberWithUnsignedLongLong: thr->frames[j]->pc]];
+
+        for (size_t j = 0; j < thr->n_registers; j++)
+            [addresses addObject: [NSNumber numberWithUnsignedLongLong: thr->registers[j]->value]];
+
+        for (NSNumber *address in addresses) {
+            Dl_info dlinfo;
+            if (dladdr((void *) (uintptr_t) [address unsignedLongLongValue], &dlinfo) == 0 || dlinfo.dli_fbase == NULL)
+                continue;
+
+            if ([fullImages containsObject: [NSNumber numberWithUnsignedLongLong: (uintptr_t) dlinfo.dli_fbase]])
+                continue;
+
+            /* dladdr() also matches addresses within an image's data segments, which are not considered references */
+            unsigned long textSize = 0;
+#ifdef __LP64__
+            getsegmentdata((const struct mach_header_64 *) dlinfo.dli_fbase, SEG_TEXT, &textSize);
+#else
+            getsegmentdata((const struct mach_header *) dlinfo.dli_fbase, SEG_TEXT, &textSize);
+#endif
+            uint64_t addr = [address unsignedLongLongValue];
+            BOOL inText = (addr >= (uintptr_t) dlinfo.dli_fbase && addr < (uintptr_t) dlinfo.dli_fbase + textSize);
+            STAssertFalse(inText, @"Referenced image %s was written as a compact record", dlinfo.dli_fname);
+        }
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Verify that PLCrashReport decodes the compact records */
+    PLCrashReport *report = [self loadCrashReport];
+    STAssertTrue([report.compactImages count] > 0, @"Compact images were not decoded");
+
+    for (PLCrashReportBinaryImageInfo *image in report.compactImages) {
+        STAssertNil(image.imageName, @"Compact image has a name");
+        STAssertTrue(image.hasImageUUID, @"Compact image is missing its UUID");
+    }
+}
+
+/**
+ * Test that a report estimated to exceed the output limit is written with cheaper options, preserving the crashed
+ * thread, and that the writer's configured options are restored.
+ */
+- (void) testWriteReportSizePolicy {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader;
+    plcrash_async_thread_state_t thread_state;
+    thread_t thread;
+
+    /* Initialze faux crash data */
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = (void *) 0x42;
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+
+        /* Steal the test thread's stack for iteration */
+        thread = pthread_mach_thread_np(_thr_args.thread);
+        plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+    }
+
+    /* Write an unlimited report, determining the report's full size */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_size_policy(&writer, true);
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state), @"Crash log failed");
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+    plcrash_async_dynloader_free(loader);
+
+    uint64_t fullSize = [[[NSFileManager defaultManager] attributesOfItemAtPath: _logPath error: NULL] fileSize];
+    unlink([_logPath fileSystemRepresentation]);
+
+    /* Write the report again, limited to half of its full size; the image records dominate the report, and the
+     * compact records selected by the size policy are considerably smaller */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+    fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, (off_t) (fullSize / 2));
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state), @"Crash log failed");
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+    plcrash_async_dynloader_free(loader);
+
+    STAssertFalse(writer.compact_images, @"Compact images were not restored");
+    STAssertFalse(writer.collapse_stacks, @"Stack collapsing was not restored");
+    STAssertEquals(writer.idle_thread_frames, (uint32_t) 0, @"Idle thread frames were not restored");
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+
+    /* Load and validate the written report */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Failed to load report");
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+    STAssertTrue(crashReport->n_compact_binary_images > 0, @"The size policy did not select compact image records");
+
+    BOOL foundCrashed = NO;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        if (crashReport->threads[i]->crashed) {
+            foundCrashed = YES;
+            STAssertTrue(crashReport->threads[i]->n_frames > 0 || crashReport->threads[i]->frame_pcs.len > 0, @"The crashed thread was written without frames");
+        }
+    }
+    STAssertTrue(foundCrashed, @"The crashed thread was not written");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test that writers share a single host information snapshot, while owning their own copies of its strings.
+ */
+- (void) testSharedHostInfo {
+    plcrash_log_writer_t first;
+    plcrash_log_writer_t second;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&first, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&second, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+
+    STAssertEquals(first.process_info.process_id, getpid(), @"Incorrect process ID");
+    STAssertEquals(first.process_info.parent_process_id, getppid(), @"Incorrect parent process ID");
+    STAssertEquals(first.process_info.start_time, second.process_info.start_time, @"Start times differ");
+    STAssertEquals(first.machine_info.cpu_type, second.machine_info.cpu_type, @"CPU types differ");
+    STAssertEquals(first.machine_info.logical_processor_count, second.machine_info.logical_processor_count, @"Processor counts differ");
+    STAssertEqualCStrings(first.system_info.version, second.system_info.version, @"OS versions differ");
+
+    STAssertNotNULL(first.process_info.process_name, @"Process name was not fetched");
+    STAssertEqualCStrings(first.process_info.process_name, second.process_info.process_name, @"Process names differ");
+    STAssertTrue(first.process_info.process_name != second.process_info.process_name, @"Writers must own their strings");
+
+    plcrash_log_writer_free(&first);
+    plcrash_log_writer_free(&second);
+}
+
+/**
+ * Test writing a report with a deferred writer, both before and after its host information has been populated.
+ */
+- (void) testWriteReportDeferredHostInfo {
+    plcrash_log_writer_t writer;
+    plcrash_async_dynloader_t *loader;
+    plcrash_async_thread_state_t thread_state;
+    thread_t thread;
+
+    /* Initialize the dynamic loader reference */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    /* Initialze faux crash data */
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = (void *) 0x42;
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+
+        /* Steal the test thread's stack for iteration */
+        thread = pthread_mach_thread_np(_thr_args.thread);
+        plcrash_async_thread_state_mach_thread_init(&thread_state, thread);
+    }
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init_deferred(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    STAssertFalse(writer.host_info_ready, @"Host info should not be available");
+    STAssertNULL(writer.static_sections.data, @"Static sections should not be encoded without the host info");
+
+    for (int populated = 0; populated <= 1; populated++) {
+        plcrash_async_file_t file;
+
+        if (populated) {
+            STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_populate_host_info(&writer), @"Failed to populate host info");
+            STAssertTrue(writer.host_info_ready, @"Host info should be available");
+            STAssertNotNULL(writer.static_sections.data, @"Static sections were not encoded");
+            unlink([_logPath fileSystemRepresentation]);
+        }
+
+        /* Write the crash report */
+        int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+        plcrash_async_file_init(&file, fd, 0);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, loader, &file, &info, &thread_state), @"Crash log failed");
+        plcrash_log_writer_close(&writer);
+        plcrash_async_file_flush(&file);
+        plcrash_async_file_close(&file);
+
+        /* Load and validate the written report */
+        Plcrash__CrashReport *crashReport = [self loadReport];
+        STAssertNotNULL(crashReport, @"Failed to load report");
+        if (crashReport == NULL)
+            break;
+
+        STAssertEquals((pid_t) crashReport->process_info->process_id, getpid(), @"Incorrect process ID");
+        STAssertEquals((pid_t) crashReport->process_info->parent_process_id, getppid(), @"Incorrect parent process ID");
+        STAssertEqualCStrings(crashReport->application_info->identifier, "test.id", @"Incorrect app ID written");
+        STAssertEqualCStrings(crashReport->application_info->marketing_version, "2.0", @"Incorrect marketing version written");
+        STAssertTrue(crashReport->system_info->timestamp > 0, @"Timestamp was not written");
+
+        if (populated) {
+            STAssertTrue(strlen(crashReport->system_info->os_version) > 0, @"OS version was not written");
+            STAssertTrue(crashReport->machine_info->logical_processor_count > 0, @"Processor count was not written");
+            STAssertNotNULL(crashReport->process_info->process_name, @"Process name was not written");
+        } else {
+            STAssertEqualCStrings(crashReport->system_info->os_version, "", @"OS version should be unknown");
+            STAssertEquals(crashReport->machine_info->logical_processor_count, (uint32_t) 0, @"Processor count should be unknown");
+            STAssertNULL(crashReport->process_info->process_name, @"Process name should be unknown");
+        }
+
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+    }
+
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+}
+
+/**
+ * Verify that the breadcrumb ring is copied into the report, and may be decoded.
+ */
+- (void) testWriteReportBreadcrumbs {
+    plcrash_log_writer_t writer;
+    plcrash_async_breadcrumbs_t ring;
+
+    /* Record a few breadcrumbs */
+    STAssertEquals(plcrash_nasync_breadcrumbs_init(&ring, NULL, 4, 64), PLCRASH_ESUCCESS, @"Failed to create breadcrumb ring");
+    plcrash_async_breadcrumbs_append(&ring, "first", strlen("first"));
+    plcrash_async_breadcrumbs_append(&ring, "second", strlen("second"));
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_breadcrumbs(&writer, &ring);
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    NSArray *breadcrumbs = report.breadcrumbs;
+    STAssertEquals([breadcrumbs count], (NSUInteger) 2, @"Incorrect breadcrumb count");
+    if ([breadcrumbs count] == 2) {
+        STAssertEqualStrings([[breadcrumbs objectAtIndex: 0] message], @"first", @"Incorrect breadcrumb");
+        STAssertEqualStrings([[breadcrumbs objectAtIndex: 1] message], @"second", @"Incorrect breadcrumb");
+        STAssertTrue(fabs([[[breadcrumbs objectAtIndex: 0] timestamp] timeIntervalSinceNow]) < 60, @"Incorrect breadcrumb timestamp");
+    }
+
+    plcrash_nasync_breadcrumbs_free(&ring);
+}
+
+/**
+ * Verify that the crashed thread's stack is captured, within the configured budget, when memory capture is enabled.
+ */
+- (void) testWriteReportMemoryCapture {
+    plcrash_log_writer_t writer;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_memory_capture(&writer, 1024, 64, 2048);
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    NSArray *regions = report.memoryRegions;
+    STAssertTrue([regions count] > 0, @"No memory regions were captured");
+
+    NSUInteger total = 0;
+    for (PLCrashReportMemoryRegionInfo *region in regions)
+        total += [region.data length];
+    STAssertTrue(total <= 2048, @"Captured memory exceeds the budget");
+
+    /* The stack is captured first, and must include the (blocked) test thread's stack pointer */
+    if ([regions count] > 0) {
+        plcrash_async_thread_state_t thread_state;
+        plcrash_async_thread_state_mach_thread_init(&thread_state, pthread_mach_thread_np(_thr_args.thread));
+
+        PLCrashReportMemoryRegionInfo *stack = [regions objectAtIndex: 0];
+        uint64_t sp = plcrash_async_thread_state_get_reg(&thread_state, PLCRASH_REG_SP);
+        STAssertTrue(sp >= stack.address && sp < stack.address + [stack.data length], @"Stack region does not include the stack pointer");
+    }
+}
+
+/**
+ * Test writing the dispatch queue labels of threads servicing a queue. Both threads servicing the concurrent queue
+ * share a single cached label.
+ */
+- (void) testWriteReportDispatchQueueLabels {
+    plcrash_log_writer_t writer;
+
+    /* Park two blocks on a labeled concurrent queue */
+    dispatch_queue_t queue = dispatch_queue_create("coop.plausible.crashreporter.test-queue", DISPATCH_QUEUE_CONCURRENT);
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t finish = dispatch_semaphore_create(0);
+    for (int i = 0; i < 2; i++) {
+        dispatch_async(queue, ^{
+            dispatch_semaphore_signal(started);
+            dispatch_semaphore_wait(finish, DISPATCH_TIME_FOREVER);
+        });
+    }
+
+    for (int i = 0; i < 2; i++)
+        dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    /* Release the queue */
+    for (int i = 0; i < 2; i++)
+        dispatch_semaphore_signal(finish);
+    dispatch_barrier_sync(queue, ^{});
+    dispatch_release(queue);
+    dispatch_release(started);
+    dispatch_release(finish);
+
+    NSUInteger labeled = 0;
+    for (PLCrashReportThreadInfo *threadInfo in report.threads) {
+        if ([threadInfo.dispatchQueueLabel isEqualToString: @"coop.plausible.crashreporter.test-queue"])
+            labeled++;
+    }
+    STAssertEquals(labeled, (NSUInteger) 2, @"Both queue threads should be labeled");
+}
+
+/**
+ * Test writing per-thread scheduling state and CPU usage.
+ */
+- (void) testWriteReportThreadMetadata {
+    plcrash_log_writer_t writer;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_thread_metadata(&writer, true);
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    /* A record should be written for every thread, in thread order */
+    STAssertEquals([report.threadMetadata count], [report.threads count], @"Incorrect thread metadata count");
+    for (NSUInteger i = 0; i < [report.threadMetadata count] && i < [report.threads count]; i++) {
+        PLCrashReportThreadMetadataInfo *metadata = [report.threadMetadata objectAtIndex: i];
+        PLCrashReportThreadInfo *threadInfo = [report.threads objectAtIndex: i];
+        STAssertEquals(metadata.threadNumber, threadInfo.threadNumber, @"Incorrect thread number");
+        STAssertEquals(metadata.totalTime, metadata.userTime + metadata.systemTime, @"Incorrect total time");
+    }
+
+    /* This thread has necessarily consumed CPU time */
+    NSUInteger running = 0;
+    for (PLCrashReportThreadMetadataInfo *metadata in report.threadMetadata) {
+        if (metadata.totalTime > 0)
+            running++;
+    }
+    STAssertTrue(running > 0, @"No thread reported any CPU time");
+}
+
+/**
+ * Test writing registered attachments, including an attachment large enough to bypass the file buffer.
+ */
+- (void) testWriteReportAttachments {
+    plcrash_log_writer_t writer;
+    plcrash_log_attachments_t attachments;
+
+    /* Register the attachments */
+    size_t large_size = 64 * 1024 + 17;
+    uint8_t *large = malloc(large_size);
+    char small[] = "initial";
+
+    memset(&attachments, 0, sizeof(attachments));
+    STAssertTrue(plcrash_log_attachments_add(&attachments, "small", (pl_vm_address_t) small, sizeof(small)), @"Failed to add attachment");
+    STAssertTrue(plcrash_log_attachments_add(&attachments, "large", (pl_vm_address_t) large, (uint32_t) large_size), @"Failed to add attachment");
+    STAssertTrue(plcrash_log_attachments_add(&attachments, "removed", (pl_vm_address_t) small, sizeof(small)), @"Failed to add attachment");
+    STAssertTrue(plcrash_log_attachments_remove(&attachments, "removed"), @"Failed to remove attachment");
+    STAssertFalse(plcrash_log_attachments_remove(&attachments, "removed"), @"Removing a missing attachment should fail");
+
+    char long_name[PLCRASH_LOG_ATTACHMENT_NAME_MAX + 1];
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    STAssertFalse(plcrash_log_attachments_add(&attachments, long_name, (pl_vm_address_t) small, sizeof(small)), @"An overlong name should be rejected");
+
+    /* The attachments are read at the time the report is written, not when registered */
+    for (size_t i = 0; i < large_size; i++)
+        large[i] = (uint8_t) (i * 7);
+    strlcpy(small, "crashed", sizeof(small));
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    plcrash_log_writer_set_attachments(&writer, &attachments);
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    NSDictionary *reportAttachments = report.attachments;
+    STAssertEquals([reportAttachments count], (NSUInteger) 2, @"Incorrect attachment count");
+    STAssertEqualObjects([reportAttachments objectForKey: @"small"], [NSData dataWithBytes: "crashed" length: sizeof(small)], @"Incorrect small attachment");
+    STAssertEqualObjects([reportAttachments objectForKey: @"large"], [NSData dataWithBytes: large length: large_size], @"Incorrect large attachment");
+    STAssertNil([reportAttachments objectForKey: @"removed"], @"Removed attachment was written");
+
+    free(large);
+}
+
+/**
+ * Test writing an uncaught exception captured into reserved storage.
+ */
+- (void) testWriteReportReservedException {
+    plcrash_log_writer_t writer;
+
+    /* Reserve room for fewer frames than the exception provides */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_reserve_exception(&writer, 2), @"Failed to reserve exception storage");
+
+    NSException *e = nil;
+    @try {
+        [NSException raise: @"TestException" format: @"%@", [@"" stringByPaddingToLength: PLCRASH_WRITER_EXCEPTION_REASON_BYTES * 2 withString: @"r" startingAtIndex: 0]];
+    }
+    @catch (NSException *exception) {
+        e = exception;
+    }
+    STAssertTrue([[e callStackReturnAddresses] count] > 2, @"Test requires more than two exception frames");
+    plcrash_log_writer_set_exception(&writer, e);
+
+    /* Write the crash report */
+    PLCrashReport *report = [self writeCrashReportWithWriter: &writer];
+    plcrash_log_writer_free(&writer);
+
+    PLCrashReportExceptionInfo *exceptionInfo = report.exceptionInfo;
+    STAssertNotNil(exceptionInfo, @"Missing exception info");
+    STAssertEqualStrings(exceptionInfo.exceptionName, @"TestException", @"Incorrect exception name");
+    STAssertEquals([exceptionInfo.exceptionReason length], (NSUInteger) PLCRASH_WRITER_EXCEPTION_REASON_BYTES - 1, @"Exception reason was not truncated");
+
+    STAssertEquals([exceptionInfo.stackFrames count], (NSUInteger) 2, @"Exception frames were not limited to the reserved capacity");
+    for (NSUInteger i = 0; i < [exceptionInfo.stackFrames count]; i++) {
+        PLCrashReportStackFrameInfo *frame = [exceptionInfo.stackFrames objectAtIndex: i];
+        STAssertEquals(frame.instructionPointer, [[[e callStackReturnAddresses] objectAtIndex: i] unsignedLongLongValue], @"Incorrect exception frame");
+    }
+}
+
+/**
+ * Test writing a report via plcrash_log_writer_write_task(), as is done when writing a report on behalf of another
+ * process.
+ */
+- (void) testWriteReportTargetProcess {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader;
+    thread_t thread;
+
+    /* Initialize the dynamic loader reference */
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create loader reference");
+
+    /* Initialze faux crash data */
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = (void *) 0x42;
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+
+        thread = pthread_mach_thread_np(_thr_args.thread);
+    }
+
+    /* Record our parent's process information in place of our own */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_target_process(&writer, getppid()), @"Failed to set the target process");
+
+    /* Write the crash report */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write_task(&writer, mach_task_self(), thread, loader, &file, &info, NULL), @"Crash log failed");
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Validate the written report */
+    NSError *error;
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode crash report: %@", error);
+
+    STAssertEquals(report.processInfo.processID, (NSUInteger) getppid(), @"Target process ID was not recorded");
+    STAssertNotNil(report.crashedThread, @"Crashed thread was not written");
+    STAssertTrue([report.crashedThread.stackFrames count] > 0, @"Crashed thread has no frames");
+
+    plcrash_async_dynloader_free(loader);
+}
+
+/**
+ * Test writing a report with writer instrumentation enabled.
+ */
+- (void) testWriteReportWriterStats {
+    plcrash_log_writer_t writer;
+
+    /* Write the crash report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"2.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    plcrash_log_writer_set_instrumentation(&writer, true);
+
+    Plcrash__CrashReport *crashReport = [self writeReportWithWriter: &writer];
+    STAssertNULL(plcrash_async_instrumentation_current(), @"Instrumentation was not uninstalled");
+    plcrash_log_writer_free(&writer);
+
+    if (crashReport == NULL)
+        return;
+
+    Plcrash__CrashReport__WriterStats *stats = crashReport->writer_stats;
+    STAssertNotNULL(stats, @"No writer stats were written");
+    if (stats != NULL) {
+        STAssertTrue(stats->has_total_ns && stats->total_ns > 0, @"Total time was not recorded");
+        STAssertTrue(stats->has_unwind_ns && stats->unwind_ns > 0, @"Unwind time was not recorded");
+        STAssertTrue(stats->has_task_memcpy_calls && stats->task_memcpy_calls > 0, @"Task memory reads were not counted");
+        STAssertTrue(stats->has_mobject_maps && stats->mobject_maps > 0, @"Memory object mappings were not counted");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
 @end
@@ -79,6 +79,23 @@ typedef kern_return_t (*PLCrashMachExceptionHandlerCallback) (task_t task,
                                                               mach_msg_type_number_t code_count,
                                                               void *context);
 
+/**
+ * @internal
+ * Scheduling policies that may be applied to the exception server's receive threads.
+ */
+typedef enum {
+    /** Use the default scheduling of newly created threads. */
+    PLCRASH_EXCEPTION_SERVER_SCHED_DEFAULT = 0,
+
+    /** Run at the user-interactive QoS class, or at the maximum priority of the default policy where QoS classes are
+     * unavailable. */
+    PLCRASH_EXCEPTION_SERVER_SCHED_HIGH_QOS = 1,
+
+    /** Run under THREAD_TIME_CONSTRAINT_POLICY, scheduling the receive threads ahead of all other non-realtime threads.
+     * The kernel will demote a thread that exceeds its computation budget to the default policy. */
+    PLCRASH_EXCEPTION_SERVER_SCHED_TIME_CONSTRAINT = 2
+} plcrash_exception_server_sched_t;
+
 kern_return_t PLCrashMachExceptionForward (task_t task,
                                            thread_t thread,
                                            exception_type_t exception_type,
@@ -98,14 +115,35 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
                 context: (void *) context
                   error: (NSError **) outError;
 
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+               contexts: (void **) contexts
+            threadCount: (NSUInteger) threadCount
+                  error: (NSError **) outError;
+
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+               contexts: (void **) contexts
+            threadCount: (NSUInteger) threadCount
+             scheduling: (plcrash_exception_server_sched_t) scheduling
+         wiredStackSize: (size_t) wiredStackSize
+                  error: (NSError **) outError;
+
++ (PLCrashMachExceptionPort *) exceptionPortForServerPort: (mach_port_t) serverPort mask: (exception_mask_t) mask;
+
 - (mach_port_t) copySendRightForServerAndReturningError: (NSError **) outError;
 
 - (PLCrashMachExceptionPort *) exceptionPortWithMask: (exception_mask_t) mask error: (NSError **) outError;
 
+- (void) setForwardPortSet: (plcrash_mach_exception_port_set_t *) portSet;
+
 /** The Mach thread on which the exception server is running. This may be used to register
  * a thread-specific exception handler for the server itself. */
 @property(nonatomic, readonly) thread_t serverThread;
 
+/** The number of receive threads servicing the server's exception port. */
+@property(nonatomic, readonly) NSUInteger serverThreadCount;
+
+- (thread_t) serverThreadAtIndex: (NSUInteger) index;
+
 @end
 
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
@@ -88,15 +88,24 @@
 #import "PLCrashAsync.h"
 
 #import <pthread.h>
+#import <sys/mman.h>
 #import <libkern/OSAtomic.h>
 
 #import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <mach/thread_policy.h>
 #import <mach/exc.h>
 
 /* The msgh_id to use for thread termination messages. This value most not conflict with the MACH_NOTIFY_NO_SENDERS msgh_id, which
  * is the only other value currently sent on the server notify port */
 #define PLCRASH_TERMINATE_MSGH_ID 0xDEADBEEF
 
+/* Maximum computation time, in nanoseconds, requested for receive threads under THREAD_TIME_CONSTRAINT_POLICY. */
+#define PLCRASH_TIME_CONSTRAINT_COMPUTATION_NS 5000000ULL
+
+/* Maximum latency, in nanoseconds, requested for receive threads under THREAD_TIME_CONSTRAINT_POLICY. */
+#define PLCRASH_TIME_CONSTRAINT_LATENCY_NS 10000000ULL
+
 #if PLCRASH_TERMINATE_MSGH_ID == MACH_NOTIFY_NO_SENDERS
 #error The allocated message identifiers conflict.
 #endif
@@ -116,6 +125,10 @@ typedef __Reply__exception_raise_t PLReply_exception_raise_t;
 #  define PLCRASH_DEFAULT_BEHAVIOR EXCEPTION_DEFAULT
 #endif
 
+/* The size of each receive thread's pre-allocated receive buffer; sufficient for the largest exception request message,
+ * including a full thread state and the maximum receive trailer. */
+#define PLCRASH_EXCEPTION_REQUEST_SIZE round_page(sizeof(PLRequest_exception_raise_t) + (THREAD_STATE_MAX * sizeof(natural_t)) + sizeof(mach_msg_max_trailer_t))
+
 /**
  * @internal
  * Map an exception type to its corresponding mask value.
@@ -152,14 +165,62 @@ static exception_mask_t exception_to_mask (exception_type_t exception) {
 #endif
 }
 
+/**
+ * @internal
+ *
+ * Per-thread state for a single receive thread of the exception server.
+ */
+struct plcrash_exception_server_thread {
+    /** The backing server context. */
+    struct plcrash_exception_server_context *server;
+
+    /** The receive thread's mach thread, or MACH_PORT_NULL if the thread has not been started. */
+    thread_t thread;
+
+    /** The receive thread's pthread. Only valid if the thread has been started, and the server's threads are joinable. */
+    pthread_t pthread;
+
+    /** The callback context to be supplied for exceptions received on this thread. */
+    void *callback_context;
+
+    /** Pre-allocated, page-aligned receive buffer of PLCRASH_EXCEPTION_REQUEST_SIZE bytes. */
+    PLRequest_exception_raise_t *request_buffer;
+
+    /** Receive right on which replies to forwarded exception messages are received. */
+    mach_port_t reply_port;
+};
+
 /**
  * @internal
  *
  * Exception handler context.
  */
 struct plcrash_exception_server_context {
-    /** The server's mach thread. */
-    thread_t server_thread;
+    /** The server's receive threads. */
+    struct plcrash_exception_server_thread *threads;
+
+    /** The number of entries in @a threads. */
+    uint32_t thread_count;
+
+    /** The number of receive threads that have been successfully started. */
+    uint32_t started_count;
+
+    /** Pre-allocated receive thread stacks, or 0 if the threads use default pthread stacks. If non-zero, the receive
+     * threads are joinable, and the stacks may only be deallocated once all threads have been joined. */
+    vm_address_t stacks;
+
+    /** The total size of the @a stacks allocation. */
+    vm_size_t stacks_size;
+
+    /** The distance between each thread's stack allocation, including its guard page. */
+    vm_size_t stack_stride;
+
+    /** The receive threads' pre-allocated receive buffers, of PLCRASH_EXCEPTION_REQUEST_SIZE bytes each, or 0. */
+    vm_address_t request_buffers;
+
+    /** The exception ports to which exceptions will be forwarded prior to issuing the callback, or NULL. Must be
+     * updated with a memory barrier, as it will be read without locking. */
+    plcrash_mach_exception_port_set_t * volatile forward_ports;
 
     /** Registered exception port. */
     mach_port_t server_port;
@@ -173,9 +234,6 @@ struct plcrash_exception_server_context {
     /** User callback. */
     PLCrashMachExceptionHandlerCallback callback;
 
-    /** User callback context. */
-    void *callback_context;
-
     /** Lock used to signal waiting initialization thread. */
     pthread_mutex_t lock;
     
@@ -191,11 +249,100 @@ struct plcrash_exception_server_context {
      */
     uint32_t server_should_stop;
 
-    /** Intended to be observed by the waiting initialization thread. Informs
-     * the waiting thread that shutdown has completed . */
-    bool server_stop_done;
+    /** Intended to be observed by the waiting initialization thread. The number of receive threads
+     * that have completed shutdown; once equal to started_count, shutdown has completed. */
+    uint32_t server_stopped_count;
 };
 
+/**
+ * @internal
+ *
+ * Allocate a stack of at least @a stack_size bytes for each of @a ctx's receive threads, each preceded by an
+ * inaccessible guard page, and fault in and wire the stack pages. Wiring failures are logged, but otherwise ignored.
+ *
+ * On success, the allocation is saved in @a ctx, and must be deallocated once all receive threads have exited.
+ */
+static kern_return_t exception_server_allocate_stacks (struct plcrash_exception_server_context *ctx, size_t stack_size) {
+    vm_size_t stride = round_page(MAX(stack_size, (size_t) PTHREAD_STACK_MIN)) + PAGE_SIZE;
+    vm_size_t size = stride * ctx->thread_count;
+    vm_address_t stacks = 0;
+    kern_return_t kr;
+
+    kr = vm_allocate(mach_task_self(), &stacks, size, VM_FLAGS_ANYWHERE);
+    if (kr != KERN_SUCCESS)
+        return kr;
+
+    for (uint32_t i = 0; i < ctx->thread_count; i++) {
+        vm_address_t guard = stacks + (stride * i);
+
+        kr = vm_protect(mach_task_self(), guard, PAGE_SIZE, false, VM_PROT_NONE);
+        if (kr != KERN_SUCCESS) {
+            vm_deallocate(mach_task_self(), stacks, size);
+            return kr;
+        }
+
+        /* Touch every stack page, so that the first use of the stack at crash time will not fault */
+        for (vm_address_t page = guard + PAGE_SIZE; page < guard + stride; page += PAGE_SIZE)
+            *((volatile uint8_t *) page) = 0;
+
+        if (mlock((void *) (guard + PAGE_SIZE), stride - PAGE_SIZE) != 0)
+            PLCF_DEBUG("Failed to wire exception server thread stack: %d", errno);
+    }
+
+    ctx->stacks = stacks;
+    ctx->stacks_size = size;
+    ctx->stack_stride = stride;
+
+    return KERN_SUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Configure @a attr to create threads at the user-interactive QoS class. On releases that predate QoS classes, the
+ * threads will instead be created with the maximum priority permitted by the default scheduling policy.
+ */
+static void exception_server_set_high_qos (pthread_attr_t *attr) {
+#if defined(__has_include) && __has_include(<pthread/qos.h>)
+    if (&pthread_attr_set_qos_class_np != NULL) {
+        if (pthread_attr_set_qos_class_np(attr, QOS_CLASS_USER_INTERACTIVE, 0) != 0)
+            PLCF_DEBUG("Failed to set exception server QoS class");
+        return;
+    }
+#endif
+
+    struct sched_param param;
+    pthread_attr_getschedparam(attr, &param);
+    param.sched_priority = sched_get_priority_max(SCHED_OTHER);
+    if (pthread_attr_setschedparam(attr, &param) != 0)
+        PLCF_DEBUG("Failed to set exception server thread priority");
+}
+
+/**
+ * @internal
+ *
+ * Move @a thread to THREAD_TIME_CONSTRAINT_POLICY. The receive threads spend nearly all of their time blocked in
+ * mach_msg(), and so are declared as aperiodic; on receipt of a message, a thread will be scheduled within the
+ * constraint, ahead of any non-realtime threads saturating the CPU.
+ */
+static void exception_server_set_time_constraint (thread_t thread) {
+    mach_timebase_info_data_t timebase;
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.numer == 0) {
+        PLCF_DEBUG("Failed to fetch the mach timebase");
+        return;
+    }
+
+    thread_time_constraint_policy_data_t policy;
+    policy.period = 0;
+    policy.computation = (uint32_t) (PLCRASH_TIME_CONSTRAINT_COMPUTATION_NS * timebase.denom / timebase.numer);
+    policy.constraint = (uint32_t) (PLCRASH_TIME_CONSTRAINT_LATENCY_NS * timebase.denom / timebase.numer);
+    policy.preemptible = TRUE;
+
+    kern_return_t kr = thread_policy_set(thread, THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t) &policy, THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+    if (kr != KERN_SUCCESS)
+        PLCF_DEBUG("Failed to set exception server time constraint policy: 0x%x", kr);
+}
+
 /***
  * @internal
  *
@@ -230,8 +377,8 @@ struct plcrash_exception_server_context {
  * (at a minimum) that the crash report itself crashed, even if no additional crash data can be
  * recorded.
  *
- * This may be done by targeting the Mach exception server's thread with a thread-specific
- * crash handler. All callbacks will be issued on this thread, and it may be reliably targeted
+ * This may be done by targeting the Mach exception server's threads with a thread-specific
+ * crash handler. All callbacks will be issued on these threads, and they may be reliably targeted
  * to observe any crashes that occur within those callbacks.
  *
  * An example implementation might do the following:
@@ -243,11 +390,20 @@ struct plcrash_exception_server_context {
  *       a great deal if binary parsing.
  *     - Disable reporting on any threads other than the crashed thread. This will avoid
  *       any bugs that may have occured in the stack unwinding code for existing threads.
+ *
+ * @par Receive Threads
+ *
+ * By default, a single receive thread handles all exception messages serially; a slow callback (eg, one that
+ * forwards the exception via PLCrashMachExceptionForward()) will delay handling of exceptions raised concurrently
+ * on other threads. A server may instead be initialized with a fixed pool of pre-spawned receive threads, all
+ * listening on the server's port set, with each thread issuing callbacks with its own context. This allows each
+ * thread to be paired with its own pre-allocated state (eg, a report writer), avoiding any need to synchronize
+ * between concurrently executing callbacks.
  */
 @implementation PLCrashMachExceptionServer
 
 /**
- * Initialize a new Mach exception server.
+ * Initialize a new Mach exception server with a single receive thread.
  *
  * @param callback Callback called upon receipt of an exception. The callback will execute
  * on the exception server's thread, distinctly from the crashed thread.
@@ -260,11 +416,72 @@ struct plcrash_exception_server_context {
 - (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
                 context: (void *) context
                   error: (NSError **) outError
+{
+    return [self initWithCallBack: callback contexts: &context threadCount: 1 error: outError];
+}
+
+/**
+ * Initialize a new Mach exception server with a fixed pool of @a threadCount receive threads. Exception messages
+ * will be handled concurrently by the first available receive thread.
+ *
+ * @param callback Callback called upon receipt of an exception. The callback will execute
+ * on one of the exception server's threads, distinctly from the crashed thread. The callback may be called
+ * concurrently from multiple receive threads.
+ * @param contexts An array of @a threadCount contexts; the context at index @a i will be passed to all callbacks
+ * issued from the receive thread at index @a i, and may be used to provide per-thread pre-allocated state. Entries
+ * may be NULL.
+ * @param threadCount The number of receive threads to be spawned. Must be greater than zero.
+ * @param outError A pointer to an NSError object variable. If an error occurs initializing the exception server,
+ * this pointer will contain an error object in the NSMachErrorDomain or NSPOSIXErrorDomain indicating why the
+ * exception handler could not be registered. If no error occurs, this parameter will be left unmodified.
+ * You may specify NULL for this parameter, and no error information will be provided.
+ */
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+               contexts: (void **) contexts
+            threadCount: (NSUInteger) threadCount
+                  error: (NSError **) outError
+{
+    return [self initWithCallBack: callback
+                         contexts: contexts
+                      threadCount: threadCount
+                       scheduling: PLCRASH_EXCEPTION_SERVER_SCHED_DEFAULT
+                   wiredStackSize: 0
+                            error: outError];
+}
+
+/**
+ * Initialize a new Mach exception server with a fixed pool of @a threadCount receive threads, using the given
+ * scheduling policy and stack configuration.
+ *
+ * @param callback Callback called upon receipt of an exception. See
+ * initWithCallBack:contexts:threadCount:error:.
+ * @param contexts An array of @a threadCount per-thread contexts. See initWithCallBack:contexts:threadCount:error:.
+ * @param threadCount The number of receive threads to be spawned. Must be greater than zero.
+ * @param scheduling The scheduling policy to be applied to the receive threads. Failure to apply the policy is
+ * not treated as an error; the threads will instead run with the default scheduling.
+ * @param wiredStackSize If non-zero, each receive thread will be run on a pre-allocated stack of at least this size,
+ * preceded by a guard page. The stacks are faulted in and wired via mlock() prior to spawning the threads, ensuring
+ * that handling an exception will not incur page faults on the receive thread's stack. Wiring is subject to the
+ * process' wired memory limit; failure to wire the stacks is not treated as an error. If zero, the default pthread
+ * stack will be used.
+ * @param outError A pointer to an NSError object variable. If an error occurs initializing the exception server,
+ * this pointer will contain an error object in the NSMachErrorDomain or NSPOSIXErrorDomain indicating why the
+ * exception handler could not be registered. If no error occurs, this parameter will be left unmodified.
+ * You may specify NULL for this parameter, and no error information will be provided.
+ */
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+               contexts: (void **) contexts
+            threadCount: (NSUInteger) threadCount
+             scheduling: (plcrash_exception_server_sched_t) scheduling
+         wiredStackSize: (size_t) wiredStackSize
+                  error: (NSError **) outError
 {
     pthread_attr_t attr;
     pthread_t thr;
     kern_return_t kr;
 
+    NSParameterAssert(threadCount > 0 && threadCount <= UINT32_MAX);
+
     if ((self = [super init]) == nil)
         return nil;
 
@@ -274,13 +491,31 @@ struct plcrash_exception_server_context {
     _serverContext->server_port = MACH_PORT_NULL;
     _serverContext->notify_port = MACH_PORT_NULL;
     _serverContext->port_set = MACH_PORT_NULL;
-    _serverContext->server_thread = MACH_PORT_NULL;
     _serverContext->callback = callback;
-    _serverContext->callback_context = context;
+
+    _serverContext->threads = (struct plcrash_exception_server_thread *) calloc(threadCount, sizeof(_serverContext->threads[0]));
+    if (_serverContext->threads == NULL) {
+        plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate exception server thread state");
+
+        free(_serverContext);
+        _serverContext = NULL;
+
+        [self release];
+        return nil;
+    }
+
+    _serverContext->thread_count = (uint32_t) threadCount;
+    for (NSUInteger i = 0; i < threadCount; i++) {
+        _serverContext->threads[i].server = _serverContext;
+        _serverContext->threads[i].thread = MACH_PORT_NULL;
+        _serverContext->threads[i].callback_context = contexts[i];
+        _serverContext->threads[i].reply_port = MACH_PORT_NULL;
+    }
     
     if (pthread_mutex_init(&_serverContext->lock, NULL) != 0) {
         plcrash_populate_posix_error(outError, errno, @"Mutex initialization failed");
         
+        free(_serverContext->threads);
         free(_serverContext);
         _serverContext = NULL;
         
@@ -292,6 +527,7 @@ struct plcrash_exception_server_context {
         plcrash_populate_posix_error(outError, errno, @"Condition initialization failed");
 
         pthread_mutex_destroy(&_serverContext->lock);
+        free(_serverContext->threads);
         free(_serverContext);
         _serverContext = NULL;
         
@@ -367,7 +603,48 @@ struct plcrash_exception_server_context {
         return nil;
     }
 
-    /* Spawn the server thread. */
+    /* Allocate the receive threads' message buffers and reply ports, ensuring that receiving and forwarding an
+     * exception message will not require allocation */
+    kr = vm_allocate(mach_task_self(), &_serverContext->request_buffers, PLCRASH_EXCEPTION_REQUEST_SIZE * threadCount, VM_FLAGS_ANYWHERE);
+    if (kr != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, kr, @"Failed to allocate exception server receive buffers");
+
+        _serverContext->request_buffers = 0;
+        [self release];
+        return nil;
+    }
+
+    for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
+        vm_address_t buffer = _serverContext->request_buffers + (PLCRASH_EXCEPTION_REQUEST_SIZE * i);
+
+        /* Touch every page, so that the first receive will not fault */
+        for (vm_address_t page = buffer; page < buffer + PLCRASH_EXCEPTION_REQUEST_SIZE; page += PAGE_SIZE)
+            *((volatile uint8_t *) page) = 0;
+
+        _serverContext->threads[i].request_buffer = (PLRequest_exception_raise_t *) buffer;
+
+        kr = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &_serverContext->threads[i].reply_port);
+        if (kr != KERN_SUCCESS) {
+            plcrash_populate_mach_error(outError, kr, @"Failed to allocate exception server's reply port");
+
+            _serverContext->threads[i].reply_port = MACH_PORT_NULL;
+            [self release];
+            return nil;
+        }
+    }
+
+    /* Allocate the receive thread stacks */
+    if (wiredStackSize > 0) {
+        kr = exception_server_allocate_stacks(_serverContext, wiredStackSize);
+        if (kr != KERN_SUCCESS) {
+            plcrash_populate_mach_error(outError, kr, @"Failed to allocate exception server thread stacks");
+
+            [self release];
+            return nil;
+        }
+    }
+
+    /* Spawn the server threads. */
     {
         if (pthread_attr_init(&attr) != 0) {
             plcrash_populate_posix_error(outError, errno, @"Failed to initialize pthread_attr");
@@ -376,45 +653,109 @@ struct plcrash_exception_server_context {
             return nil;
         }
         
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-        // TODO - A custom stack should be specified, using high/low guard pages to help prevent overwriting the stack
-        // by crashing code.
-        // pthread_attr_setstack(&attr, sp, stacksize);
+        /* Threads running on our own stacks must be joined before the stacks may be deallocated */
+        if (_serverContext->stacks != 0) {
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+        } else {
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        }
+
+        if (scheduling == PLCRASH_EXCEPTION_SERVER_SCHED_HIGH_QOS)
+            exception_server_set_high_qos(&attr);
         
-        if (pthread_create(&thr, &attr, &exception_server_thread, _serverContext) != 0) {
-            plcrash_populate_posix_error(outError, errno, @"Failed to create exception server thread");
-            pthread_attr_destroy(&attr);
-            
-            [self release];
-            return nil;
+        for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
+            if (_serverContext->stacks != 0) {
+                /* The guard page sits below the stack, which grows down towards it */
+                vm_address_t stack = _serverContext->stacks + (_serverContext->stack_stride * i) + PAGE_SIZE;
+                pthread_attr_setstack(&attr, (void *) stack, _serverContext->stack_stride - PAGE_SIZE);
+            }
+
+            if (pthread_create(&thr, &attr, &exception_server_thread, &_serverContext->threads[i]) != 0) {
+                plcrash_populate_posix_error(outError, errno, @"Failed to create exception server thread");
+                pthread_attr_destroy(&attr);
+
+                /* Any threads that were started will be stopped on release */
+                [self release];
+                return nil;
+            }
+
+            /* Save the thread reference */
+            pthread_mutex_lock(&_serverContext->lock); {
+                _serverContext->threads[i].thread = pthread_mach_thread_np(thr);
+                _serverContext->threads[i].pthread = thr;
+                _serverContext->started_count++;
+            } pthread_mutex_unlock(&_serverContext->lock);
+
+            if (scheduling == PLCRASH_EXCEPTION_SERVER_SCHED_TIME_CONSTRAINT)
+                exception_server_set_time_constraint(_serverContext->threads[i].thread);
         }
         
         pthread_attr_destroy(&attr);
-        
-        /* Save the thread reference */
-        _serverContext->server_thread = pthread_mach_thread_np(thr);
     }
     
     return self;
 }
 
 /**
- * Return the Mach thread on which the exception server is running.
+ * Return the Mach thread on which the exception server is running. If the server has multiple receive threads,
+ * the first receive thread is returned.
  *
  * @warning The behavior of this method is undefined if the receiver
  * has not been registered as a mach exception server, or has been deregistered.
  */
 - (thread_t) serverThread {
+    return [self serverThreadAtIndex: 0];
+}
+
+/**
+ * Return the number of receive threads servicing the receiver's exception port.
+ */
+- (NSUInteger) serverThreadCount {
     NSAssert(_serverContext != NULL, @"No handler registered!");
+    return _serverContext->thread_count;
+}
+
+/**
+ * Return the Mach thread of the receive thread at @a index.
+ *
+ * @param index The index of the receive thread; must be less than PLCrashMachExceptionServer::serverThreadCount.
+ *
+ * @warning The behavior of this method is undefined if the receiver
+ * has not been registered as a mach exception server, or has been deregistered.
+ */
+- (thread_t) serverThreadAtIndex: (NSUInteger) index {
+    NSAssert(_serverContext != NULL, @"No handler registered!");
+    NSParameterAssert(index < _serverContext->thread_count);
 
     thread_t result;
     pthread_mutex_lock(&_serverContext->lock); {
-        result = _serverContext->server_thread;
+        result = _serverContext->threads[index].thread;
     } pthread_mutex_unlock(&_serverContext->lock);
     
     return result;
 }
 
+/**
+ * Set the exception ports to which exceptions will be forwarded prior to issuing the server's callback. If the first
+ * matching handler in @a portSet replies with KERN_SUCCESS, its reply is relayed to the kernel and the callback is not
+ * issued; otherwise, the callback is issued as normal.
+ *
+ * Where the matching handler was registered with the same behavior as this server, the received message is forwarded
+ * by rewriting its header in place, and the handler's reply is likewise relayed in place; no new messages are built.
+ * Handlers registered with any other behavior are forwarded via PLCrashMachExceptionForward().
+ *
+ * @param portSet The exception ports to which exceptions should be forwarded, or NULL to disable forwarding. The
+ * port set is not copied, may be updated by the caller at any time, and must remain valid for the lifetime of the
+ * receiver.
+ */
+- (void) setForwardPortSet: (plcrash_mach_exception_port_set_t *) portSet {
+    NSAssert(_serverContext != NULL, @"No handler registered!");
+
+    OSMemoryBarrier();
+    _serverContext->forward_ports = portSet;
+    OSMemoryBarrier();
+}
+
 /**
  * Create and return a new send right for the receiver's Mach exception server. The callee is responsible
  * for deallocating the send right via mach_port_deallocate or similar.
@@ -448,6 +789,22 @@ struct plcrash_exception_server_context {
     return result;
 }
 
+/**
+ * Create and return a new exception port instance for @a serverPort, defining the behavior and flavor required by the
+ * Mach exception server. This may be used to register a PLCrashMachExceptionServer running in another process, given
+ * only a send right to its server port.
+ *
+ * @param serverPort A send right to the Mach exception server's port. An additional reference to the send right
+ * is retained by the returned instance.
+ * @param mask The exception mask for which the port should be registered.
+ */
++ (PLCrashMachExceptionPort *) exceptionPortForServerPort: (mach_port_t) serverPort mask: (exception_mask_t) mask {
+    return [[[PLCrashMachExceptionPort alloc] initWithServerPort: serverPort
+                                                            mask: mask
+                                                        behavior: PLCRASH_DEFAULT_BEHAVIOR
+                                                          flavor: MACHINE_THREAD_STATE] autorelease];
+}
+
 /**
  * Create and return a new exception port instance for the receiver's Mach exception server. The returned instance
  * defines the behavior and flavor required by the Mach exception server, as well as providing a valid Mach
@@ -470,11 +827,7 @@ struct plcrash_exception_server_context {
         return nil;
 
     /* Create the port oject */
-    PLCrashMachExceptionPort *result;
-    result = [[[PLCrashMachExceptionPort alloc] initWithServerPort: port
-                                                              mask: mask
-                                                          behavior: PLCRASH_DEFAULT_BEHAVIOR
-                                                            flavor: MACHINE_THREAD_STATE] autorelease];
+    PLCrashMachExceptionPort *result = [PLCrashMachExceptionServer exceptionPortForServerPort: port mask: mask];
 
     /* Drop our send right */
     mach_port_deallocate(mach_task_self(), port);
@@ -483,6 +836,42 @@ struct plcrash_exception_server_context {
 }
 
 
+/**
+ * @internal
+ *
+ * Find the first handler in @a port_state registered for @a exception_type.
+ *
+ * @param port_state The set of exception handlers to search.
+ * @param exception_type Mach exception type.
+ * @param[out] port On success, the handler's port.
+ * @param[out] behavior On success, the handler's behavior.
+ * @param[out] flavor On success, the handler's thread state flavor.
+ *
+ * @return Returns true if a matching handler was found, false otherwise.
+ */
+static bool exception_server_find_handler (plcrash_mach_exception_port_set_t *port_state,
+                                           exception_type_t exception_type,
+                                           mach_port_t *port,
+                                           exception_behavior_t *behavior,
+                                           thread_state_flavor_t *flavor)
+{
+    exception_mask_t fwd_mask = exception_to_mask(exception_type);
+    for (mach_msg_type_number_t i = 0; i < port_state->count; i++) {
+        if (!MACH_PORT_VALID(port_state->ports[i]))
+            continue;
+        
+        if ((port_state->masks[i] & fwd_mask) == 0)
+            continue;
+        
+        *port = port_state->ports[i];
+        *behavior = port_state->behaviors[i];
+        *flavor = port_state->flavors[i];
+        return true;
+    }
+
+    return false;
+}
+
 /**
  * Send a Mach exception reply for the given @a request and return the result.
  *
@@ -553,24 +942,7 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
     mach_port_t port;
     
     /* Find a matching handler */
-    exception_mask_t fwd_mask = exception_to_mask(exception_type);
-    bool found = false;
-    for (mach_msg_type_number_t i = 0; i < port_state->count; i++) {
-        if (!MACH_PORT_VALID(port_state->ports[i]))
-            continue;
-        
-        if ((port_state->masks[i] & fwd_mask) == 0)
-            continue;
-        
-        found = true;
-        port = port_state->ports[i];
-        behavior = port_state->behaviors[i];
-        flavor = port_state->flavors[i];
-        break;
-    }
-    
-    /* No handler found */
-    if (!found) {
+    if (!exception_server_find_handler(port_state, exception_type, &port, &behavior, &flavor)) {
         return KERN_FAILURE;
     }
     
@@ -650,29 +1022,145 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
 }
 
 
+/**
+ * @internal
+ *
+ * Forward @a request to @a port by rewriting its header in place, receiving the reply on @a reply_port, and relay a
+ * successful reply to the original sender by likewise rewriting the reply's header in place. The handler registered
+ * on @a port must expect messages of the same format as @a request; ie, it must have been registered with
+ * PLCRASH_DEFAULT_BEHAVIOR.
+ *
+ * @param request The received exception request. The request's header is restored prior to returning, and may be
+ * used to reply to the original sender should forwarding fail.
+ * @param port The handler's port.
+ * @param reply_port A receive right on which the handler's reply will be received.
+ *
+ * @return Returns KERN_SUCCESS if the handler replied with KERN_SUCCESS, and the reply was relayed to the original
+ * sender. Otherwise, returns the handler's reply code, or an error if forwarding failed; in either case, no reply
+ * will have been sent to the original sender.
+ *
+ * @note This function may be called at crash-time.
+ */
+static kern_return_t exception_server_forward_in_place (PLRequest_exception_raise_t *request, mach_port_t port, mach_port_t reply_port) {
+    struct {
+        PLReply_exception_raise_t reply;
+        mach_msg_max_trailer_t trailer;
+    } reply;
+    mach_msg_header_t head = request->Head;
+    mach_msg_type_name_t thread_disposition = request->thread.disposition;
+    mach_msg_type_name_t task_disposition = request->task.disposition;
+    mach_msg_return_t mr;
+
+    /* Address the request to the handler. The thread and task rights are copied, leaving our own rights intact should
+     * the handler decline the exception. */
+    request->Head.msgh_bits = MACH_MSGH_BITS_COMPLEX | MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
+    request->Head.msgh_remote_port = port;
+    request->Head.msgh_local_port = reply_port;
+    request->Head.msgh_reserved = 0;
+    request->thread.disposition = MACH_MSG_TYPE_COPY_SEND;
+    request->task.disposition = MACH_MSG_TYPE_COPY_SEND;
+
+    /* Send the request and receive the reply in a single trap, receiving into our stack buffer so that the request
+     * remains intact */
+    mr = mach_msg_overwrite(&request->Head, MACH_SEND_MSG | MACH_RCV_MSG, request->Head.msgh_size, sizeof(reply), reply_port,
+                            MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL, &reply.reply.Head, sizeof(reply));
+
+    /* Restore the request */
+    request->Head = head;
+    request->thread.disposition = thread_disposition;
+    request->task.disposition = task_disposition;
+
+    if (mr != MACH_MSG_SUCCESS) {
+        PLCF_DEBUG("Failed to forward Mach exception message: 0x%x", mr);
+        return mr;
+    }
+
+    /* Anything other than a well-formed reply (eg, a send-once notification from a terminated handler) is a failure */
+    if (reply.reply.Head.msgh_id != head.msgh_id + 100 || reply.reply.Head.msgh_size < sizeof(reply.reply) ||
+        (reply.reply.Head.msgh_bits & MACH_MSGH_BITS_COMPLEX))
+    {
+        PLCF_DEBUG("Unexpected reply to forwarded Mach exception message: msgh_id=%d", reply.reply.Head.msgh_id);
+        mach_msg_destroy(&reply.reply.Head);
+        return KERN_FAILURE;
+    }
+
+    if (reply.reply.RetCode != KERN_SUCCESS)
+        return reply.reply.RetCode;
+
+    /* Relay the reply to the original sender */
+    reply.reply.Head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(head.msgh_bits), 0);
+    reply.reply.Head.msgh_remote_port = head.msgh_remote_port;
+    reply.reply.Head.msgh_local_port = MACH_PORT_NULL;
+    reply.reply.Head.msgh_reserved = 0;
+
+    return mach_msg(&reply.reply.Head, MACH_SEND_MSG, reply.reply.Head.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+}
+
+/**
+ * @internal
+ *
+ * Forward @a request to the first matching handler in @a port_state, replying to the original sender if the handler
+ * returns KERN_SUCCESS.
+ *
+ * @param request The received exception request.
+ * @param code64 The request's exception codes, as 64-bit values.
+ * @param port_state The set of exception handlers to which the request should be forwarded.
+ * @param reply_port A receive right on which replies to in-place forwarded messages will be received.
+ *
+ * @return Returns KERN_SUCCESS if the exception was handled, and a reply was sent to the original sender. Otherwise,
+ * no reply will have been sent.
+ *
+ * @note This function may be called at crash-time.
+ */
+static kern_return_t exception_server_forward (PLRequest_exception_raise_t *request,
+                                               mach_exception_data_t code64,
+                                               plcrash_mach_exception_port_set_t *port_state,
+                                               mach_port_t reply_port)
+{
+    exception_behavior_t behavior;
+    thread_state_flavor_t flavor;
+    mach_port_t port;
+    kern_return_t kr;
+
+    if (!exception_server_find_handler(port_state, request->exception, &port, &behavior, &flavor))
+        return KERN_FAILURE;
+
+    /* A handler expecting our own message format can be handed the received message as-is */
+    if (behavior == PLCRASH_DEFAULT_BEHAVIOR)
+        return exception_server_forward_in_place(request, port, reply_port);
+
+    kr = PLCrashMachExceptionForward(request->task.name, request->thread.name, request->exception, code64, request->codeCnt, port_state);
+    if (kr != KERN_SUCCESS)
+        return kr;
+
+    mach_msg_return_t mr = exception_server_reply(request, KERN_SUCCESS);
+    if (mr != MACH_MSG_SUCCESS) {
+        PLCF_DEBUG("Unexpected failure replying to Mach exception message: 0x%x", mr);
+        return mr;
+    }
+
+    return KERN_SUCCESS;
+}
+
 /**
  * Background exception server. Handles incoming exception messages and dispatches
- * them to the registered callback.
+ * them to the registered callback. One instance of this function runs on each of the server's
+ * receive threads, all receiving from the server's port set.
  *
  * This code must be written to be async-safe once a Mach exception message
  * has been returned, as the state of the process' threads is entirely unknown.
  */
 static void *exception_server_thread (void *arg) {
-    struct plcrash_exception_server_context *exc_context = (struct plcrash_exception_server_context *) arg;
-    PLRequest_exception_raise_t *request = NULL;
-    size_t request_size;
+    struct plcrash_exception_server_thread *thread_context = (struct plcrash_exception_server_thread *) arg;
+    struct plcrash_exception_server_context *exc_context = thread_context->server;
+    void *callback_context = thread_context->callback_context;
+    mach_port_t reply_port = thread_context->reply_port;
+    PLRequest_exception_raise_t *preallocated = thread_context->request_buffer;
+    PLRequest_exception_raise_t *request = preallocated;
+    size_t request_size = PLCRASH_EXCEPTION_REQUEST_SIZE;
     kern_return_t kr;
     mach_msg_return_t mr;
     
-    /* Initialize the received message with a default size */
-    request_size = round_page(sizeof(*request));
-    kr = vm_allocate(mach_task_self(), (vm_address_t *) &request, request_size, VM_FLAGS_ANYWHERE);
-    if (kr != KERN_SUCCESS) {
-        /* Shouldn't happen ... */
-        fprintf(stderr, "Unexpected error in vm_allocate(): %x\n", kr);
-        return NULL;
-    }
-    
     /* Wait for an exception message */
     while (true) {
         /* Initialize our request message */
@@ -688,11 +1176,14 @@ static void *exception_server_thread (void *arg) {
         
         /* Handle recoverable errors */
         if (mr != MACH_MSG_SUCCESS && mr == MACH_RCV_TOO_LARGE) {
-            /* Determine the new size (before dropping the buffer) */
-            request_size = round_page(request->Head.msgh_size);
-            
-            /* Drop the old receive buffer */
-            vm_deallocate(mach_task_self(), (vm_address_t) request, request_size);
+            /* Determine the new size (before dropping the buffer). The pre-allocated buffer is sized for any exception
+             * message, and this path should not be reached in practice. */
+            size_t new_size = round_page(request->Head.msgh_size + sizeof(mach_msg_max_trailer_t));
+
+            /* Drop the old receive buffer, unless it is our pre-allocated buffer */
+            if (request != preallocated)
+                vm_deallocate(mach_task_self(), (vm_address_t) request, request_size);
+            request_size = new_size;
             
             /* Re-allocate a larger receive buffer */
             kr = vm_allocate(mach_task_self(), (vm_address_t *) &request, request_size, VM_FLAGS_ANYWHERE);
@@ -732,14 +1223,16 @@ static void *exception_server_thread (void *arg) {
                      * spuriously with the process in an unknown state, in which case we must not call
                      * out to non-async-safe functions */
                     if (exc_context->server_should_stop) {
-                        /* Inform the requesting thread of completion */
+                        /* Inform the requesting thread of completion; one termination message is sent for
+                         * each receive thread, and each thread exits upon receipt of a single message. */
                         pthread_mutex_lock(&exc_context->lock); {
-                            exc_context->server_stop_done = true;
+                            exc_context->server_stopped_count++;
                             pthread_cond_signal(&exc_context->server_cond);
                         } pthread_mutex_unlock(&exc_context->lock);
                         
                         /* Ensure a quick death if we access exc_context after termination  */
                         exc_context = NULL;
+                        thread_context = NULL;
                         
                         /* Trigger cleanup */
                         break;
@@ -782,6 +1275,11 @@ static void *exception_server_thread (void *arg) {
             mach_exception_data_type_t *code64 = (mach_exception_data_type_t *) request->code;
 #endif
             
+            /* Let any other registered handler attempt to handle the exception */
+            plcrash_mach_exception_port_set_t *forward_ports = exc_context->forward_ports;
+            if (forward_ports != NULL && exception_server_forward(request, code64, forward_ports, reply_port) == KERN_SUCCESS)
+                continue;
+
             /* Call our handler. */
             kern_return_t exc_result;
             exc_result = exc_context->callback(request->task.name,
@@ -789,7 +1287,7 @@ static void *exception_server_thread (void *arg) {
                                                request->exception,
                                                code64,
                                                request->codeCnt,
-                                               exc_context->callback_context);
+                                               callback_context);
             
             /*
              * Reply to the message.
@@ -800,8 +1298,8 @@ static void *exception_server_thread (void *arg) {
         }
     }
     
-    /* Drop the receive buffer */
-    if (request != NULL)
+    /* Drop the receive buffer; the pre-allocated buffer is owned by the server */
+    if (request != preallocated)
         vm_deallocate(mach_task_self(), (vm_address_t) request, request_size);
     
     return NULL;
@@ -820,29 +1318,44 @@ static void *exception_server_thread (void *arg) {
     /* Mark the server for termination */
     OSAtomicCompareAndSwap32Barrier(0, 1, (int32_t *) &_serverContext->server_should_stop);
 
-    /* Wake up the waiting server */
-    mach_msg_header_t msg;
-    memset(&msg, 0, sizeof(msg));
-    msg.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
-    msg.msgh_local_port = MACH_PORT_NULL;
-    msg.msgh_remote_port = _serverContext->notify_port;
-    msg.msgh_size = sizeof(msg);
-    msg.msgh_id = PLCRASH_TERMINATE_MSGH_ID;
+    /* Wake up the waiting server threads; each thread will exit upon receipt of a single termination message. */
+    uint32_t started_count;
+    pthread_mutex_lock(&_serverContext->lock); {
+        started_count = _serverContext->started_count;
+    } pthread_mutex_unlock(&_serverContext->lock);
 
-    mr = mach_msg(&msg, MACH_SEND_MSG, msg.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+    for (uint32_t i = 0; i < started_count; i++) {
+        mach_msg_header_t msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
+        msg.msgh_local_port = MACH_PORT_NULL;
+        msg.msgh_remote_port = _serverContext->notify_port;
+        msg.msgh_size = sizeof(msg);
+        msg.msgh_id = PLCRASH_TERMINATE_MSGH_ID;
 
-    if (mr != MACH_MSG_SUCCESS) {
-        NSLog(@"Unexpected error sending termination message to background thread: %d", mr);
-        return;
+        mr = mach_msg(&msg, MACH_SEND_MSG, msg.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+
+        if (mr != MACH_MSG_SUCCESS) {
+            NSLog(@"Unexpected error sending termination message to background thread: %d", mr);
+            return;
+        }
     }
 
     /* Wait for completion */
     pthread_mutex_lock(&_serverContext->lock);
-    while (!_serverContext->server_stop_done) {
+    while (_serverContext->server_stopped_count < started_count) {
         pthread_cond_wait(&_serverContext->server_cond, &_serverContext->lock);
     }
     pthread_mutex_unlock(&_serverContext->lock);
 
+    /* The threads may still be running on our stacks after signaling completion; wait for them to exit */
+    if (_serverContext->stacks != 0) {
+        for (uint32_t i = 0; i < started_count; i++)
+            pthread_join(_serverContext->threads[i].pthread, NULL);
+
+        vm_deallocate(mach_task_self(), _serverContext->stacks, _serverContext->stacks_size);
+    }
+
     /* Server is now dead, can clean up all resources */
     if (_serverContext->server_port != MACH_PORT_NULL)
         mach_port_deallocate(mach_task_self(), _serverContext->server_port);
@@ -853,10 +1366,19 @@ static void *exception_server_thread (void *arg) {
     if (_serverContext->port_set != MACH_PORT_NULL)
         mach_port_deallocate(mach_task_self(), _serverContext->port_set);
 
+    for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
+        if (_serverContext->threads[i].reply_port != MACH_PORT_NULL)
+            mach_port_mod_refs(mach_task_self(), _serverContext->threads[i].reply_port, MACH_PORT_RIGHT_RECEIVE, -1);
+    }
+
+    if (_serverContext->request_buffers != 0)
+        vm_deallocate(mach_task_self(), _serverContext->request_buffers, PLCRASH_EXCEPTION_REQUEST_SIZE * _serverContext->thread_count);
+
     pthread_cond_destroy(&_serverContext->server_cond);
     pthread_mutex_destroy(&_serverContext->lock);
 
-    /* Once we've been signaled by the background thread, it will no longer access exc_context */
+    /* Once we've been signaled by the background threads, they will no longer access exc_context */
+    free(_serverContext->threads);
     free(_serverContext);
     
     [super dealloc];
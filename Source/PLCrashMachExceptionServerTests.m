@@ -167,6 +167,93 @@ static kern_return_t exception_callback (task_t task,
     STAssertEquals(crash_page[1], (uint8_t)0xFE, @"Crash callback did not run");
 }
 
+/**
+ * Test handling of exceptions by a server with multiple receive threads.
+ */
+- (void) testMultipleReceiveThreads {
+    NSError *error;
+    BOOL didRun[4] = { NO, NO, NO, NO };
+    void *contexts[4] = { &didRun[0], &didRun[1], &didRun[2], &didRun[3] };
+
+    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback
+                                                                                      contexts: contexts
+                                                                                   threadCount: 4
+                                                                                         error: &error] autorelease];
+    STAssertNotNil(server, @"Failed to initialize server: %@", error);
+    STAssertEquals([server serverThreadCount], (NSUInteger) 4, @"Incorrect thread count");
+    STAssertEquals([server serverThread], [server serverThreadAtIndex: 0], @"The server thread should be the first receive thread");
+
+    /* Verify that all receive threads are distinct */
+    for (NSUInteger i = 0; i < 4; i++) {
+        for (NSUInteger j = i + 1; j < 4; j++)
+            STAssertNotEquals([server serverThreadAtIndex: i], [server serverThreadAtIndex: j], @"Receive threads should be distinct");
+    }
+
+    PLCrashMachExceptionPort *port = [server exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+    STAssertNotNil(port, @"Failed to fetch server port: %@", error);
+
+    STAssertTrue([port registerForTask: mach_task_self()
+                       previousPortSet: NULL
+                                 error: &error], @"Failed to configure handler: %@", error);
+
+    mprotect(crash_page, sizeof(crash_page), 0);
+
+    /* If the test doesn't lock up here, it's working */
+    crash_page[0] = 0xCA;
+
+    STAssertEquals(crash_page[0], (uint8_t)0xCA, @"Page should have been set to test value");
+    STAssertEquals(crash_page[1], (uint8_t)0xFE, @"Crash callback did not run");
+
+    /* Exactly one receive thread should have handled the exception, with its own context */
+    NSUInteger runCount = 0;
+    for (NSUInteger i = 0; i < 4; i++) {
+        if (didRun[i])
+            runCount++;
+    }
+    STAssertEquals(runCount, (NSUInteger) 1, @"Exception should have been handled by exactly one receive thread");
+}
+
+/**
+ * Test handling of exceptions by receive threads running under the time constraint policy, on pre-allocated stacks.
+ */
+- (void) testTimeConstraintWiredStack {
+    NSError *error;
+    BOOL didRun[2] = { NO, NO };
+    void *contexts[2] = { &didRun[0], &didRun[1] };
+
+    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback
+                                                                                      contexts: contexts
+                                                                                   threadCount: 2
+                                                                                    scheduling: PLCRASH_EXCEPTION_SERVER_SCHED_TIME_CONSTRAINT
+                                                                                wiredStackSize: 64 * 1024
+                                                                                         error: &error] autorelease];
+    STAssertNotNil(server, @"Failed to initialize server: %@", error);
+
+    /* Verify that the policy was applied */
+    thread_time_constraint_policy_data_t policy;
+    mach_msg_type_number_t count = THREAD_TIME_CONSTRAINT_POLICY_COUNT;
+    boolean_t get_default = FALSE;
+    kern_return_t kr = thread_policy_get([server serverThread], THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t) &policy, &count, &get_default);
+    STAssertEquals(kr, KERN_SUCCESS, @"Failed to fetch the thread policy");
+    STAssertFalse(get_default, @"The time constraint policy was not applied");
+
+    PLCrashMachExceptionPort *port = [server exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+    STAssertNotNil(port, @"Failed to fetch server port: %@", error);
+
+    STAssertTrue([port registerForTask: mach_task_self()
+                       previousPortSet: NULL
+                                 error: &error], @"Failed to configure handler: %@", error);
+
+    mprotect(crash_page, sizeof(crash_page), 0);
+
+    /* If the test doesn't lock up here, it's working */
+    crash_page[0] = 0xCA;
+
+    STAssertEquals(crash_page[0], (uint8_t)0xCA, @"Page should have been set to test value");
+    STAssertEquals(crash_page[1], (uint8_t)0xFE, @"Crash callback did not run");
+    STAssertTrue(didRun[0] || didRun[1], @"Exception was not handled by a receive thread");
+}
+
 /**
  * Test inserting/removing the mach exception server from the handler chain.
  */
@@ -260,6 +347,51 @@ static kern_return_t exception_callback (task_t task,
 #endif
 }
 
+/**
+ * Test server-side forwarding of exceptions to a previously registered handler.
+ */
+- (void) testForwardPortSet {
+    NSError *error;
+    BOOL previousDidRun = NO;
+    BOOL didRun = NO;
+
+    /* Register the handler to which exceptions will be forwarded */
+    PLCrashMachExceptionServer *previous = [[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback
+                                                                                         context: &previousDidRun
+                                                                                           error: &error] autorelease];
+    STAssertNotNil(previous, @"Failed to initialize server: %@", error);
+
+    PLCrashMachExceptionPort *previousPort = [previous exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+    STAssertNotNil(previousPort, @"Failed to fetch server port: %@", error);
+    STAssertTrue([previousPort registerForTask: mach_task_self() previousPortSet: NULL error: &error], @"Failed to configure handler: %@", error);
+
+    /* Register our forwarding handler in its place */
+    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback
+                                                                                       context: &didRun
+                                                                                         error: &error] autorelease];
+    STAssertNotNil(server, @"Failed to initialize server: %@", error);
+
+    PLCrashMachExceptionPortSet *portSet;
+    PLCrashMachExceptionPort *port = [server exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+    STAssertNotNil(port, @"Failed to fetch server port: %@", error);
+    STAssertTrue([port registerForTask: mach_task_self() previousPortSet: &portSet error: &error], @"Failed to configure handler: %@", error);
+
+    plcrash_mach_exception_port_set_t forwardPorts = portSet.asyncSafeRepresentation;
+    [server setForwardPortSet: &forwardPorts];
+
+    mprotect(crash_page, sizeof(crash_page), 0);
+
+    /* If the test doesn't lock up here, it's working */
+    crash_page[0] = 0xCA;
+
+    STAssertEquals(crash_page[0], (uint8_t)0xCA, @"Page should have been set to test value");
+    STAssertEquals(crash_page[1], (uint8_t)0xFE, @"Crash callback did not run");
+    STAssertTrue(previousDidRun, @"The exception was not forwarded");
+    STAssertFalse(didRun, @"The callback should not be issued for a forwarded exception that was handled");
+
+    [server setForwardPortSet: NULL];
+}
+
 /**
  * Test basic copying of the send right.
  */
@@ -58,32 +58,57 @@
 #define PLCrashReport                       PLNS(PLCrashReport)
 #define PLCrashReportApplicationInfo        PLNS(PLCrashReportApplicationInfo)
 #define PLCrashReportBinaryImageInfo        PLNS(PLCrashReportBinaryImageInfo)
+#define PLCrashReportBreadcrumbInfo         PLNS(PLCrashReportBreadcrumbInfo)
 #define PLCrashReportExceptionInfo          PLNS(PLCrashReportExceptionInfo)
+#define PLCrashReportFrameRepeatInfo        PLNS(PLCrashReportFrameRepeatInfo)
 #define PLCrashReportMachExceptionInfo      PLNS(PLCrashReportMachExceptionInfo)
 #define PLCrashReportMachineInfo            PLNS(PLCrashReportMachineInfo)
+#define PLCrashReportMemoryRegionInfo       PLNS(PLCrashReportMemoryRegionInfo)
 #define PLCrashReportProcessInfo            PLNS(PLCrashReportProcessInfo)
 #define PLCrashReportProcessorInfo          PLNS(PLCrashReportProcessorInfo)
 #define PLCrashReportRegisterInfo           PLNS(PLCrashReportRegisterInfo)
 #define PLCrashReportSignalInfo             PLNS(PLCrashReportSignalInfo)
 #define PLCrashReportStackFrameInfo         PLNS(PLCrashReportStackFrameInfo)
 #define PLCrashReportSymbolInfo             PLNS(PLCrashReportSymbolInfo)
+#define PLCrashReportSymbolicator           PLNS(PLCrashReportSymbolicator)
 #define PLCrashReportSystemInfo             PLNS(PLCrashReportSystemInfo)
 #define PLCrashReportTextFormatter          PLNS(PLCrashReportTextFormatter)
+#define PLCrashReportTextWriter             PLNS(PLCrashReportTextWriter)
 #define PLCrashReportThreadInfo             PLNS(PLCrashReportThreadInfo)
+#define PLCrashReportThreadMetadataInfo     PLNS(PLCrashReportThreadMetadataInfo)
 #define PLCrashReporter                     PLNS(PLCrashReporter)
+#define PLCrashReporterQueuedReportEnumerator PLNS(PLCrashReporterQueuedReportEnumerator)
 #define PLCrashSignalHandler                PLNS(PLCrashSignalHandler)
+#define PLCrashSymbolDemangler              PLNS(PLCrashSymbolDemangler)
 #define PLCrashHostInfo                     PLNS(PLCrashHostInfo)
 #define PLCrashMachExceptionPort            PLNS(PLCrashMachExceptionPort)
 #define PLCrashMachExceptionPortSet         PLNS(PLCrashMachExceptionPortSet)
 #define PLCrashProcessInfo                  PLNS(PLCrashProcessInfo)
 #define PLCrashReporterConfig               PLNS(PLCrashReporterConfig)
+#define PLMutableCrashReporterConfig        PLNS(PLMutableCrashReporterConfig)
 #define PLCrashUncaughtExceptionHandler     PLNS(PLCrashUncaughtExceptionHandler)
 #define PLCrashReportFormatter              PLNS(PLCrashReportFormatter)
+#define PLCrashHelperServer                 PLNS(PLCrashHelperServer)
+#define PLCrashSampler                      PLNS(PLCrashSampler)
+#define PLCrashSamplerSample                PLNS(PLCrashSamplerSample)
+#define PLCrashBacktrace                    PLNS(PLCrashBacktrace)
+#define PLCrashHangDetector                 PLNS(PLCrashHangDetector)
+#define PLCrashHangReport                   PLNS(PLCrashHangReport)
+#define PLCrashReportBundle                 PLNS(PLCrashReportBundle)
+#define PLCrashReportLog                    PLNS(PLCrashReportLog)
+#define PLCrashReportLogEnumerator          PLNS(PLCrashReportLogEnumerator)
+#define PLCrashReportLogRecordData          PLNS(PLCrashReportLogRecordData)
 
 /* Public C functions */
 #define PLCrashMachExceptionForward         PLNS(PLCrashMachExceptionForward)
 #define PLCrashSignalHandlerForward         PLNS(PLCrashSignalHandlerForward)
 #define plcrash_signal_handler              PLNS(plcrash_signal_handler)
+#define plcrash_backtrace_image_info        PLNS(plcrash_backtrace_image_info)
+#define plcrash_backtrace_register_name     PLNS(plcrash_backtrace_register_name)
+#define plcrash_backtrace_snapshot_threads  PLNS(plcrash_backtrace_snapshot_threads)
+#define plcrash_backtrace_state_free        PLNS(plcrash_backtrace_state_free)
+#define plcrash_backtrace_state_new         PLNS(plcrash_backtrace_state_new)
+#define plcrash_backtrace_symbolicate_frame PLNS(plcrash_backtrace_symbolicate_frame)
 
 
 /* Public C global symbols */
@@ -138,7 +163,24 @@
 #define plcrash__crash_report__unpack PLNS(plcrash__crash_report__unpack)
 #define plcrash_async_address_apply_offset PLNS(plcrash_async_address_apply_offset)
 #define plcrash_async_allocator_alloc PLNS(plcrash_async_allocator_alloc)
+#define plcrash_async_allocator_high_water PLNS(plcrash_async_allocator_high_water)
 #define plcrash_async_allocator_new PLNS(plcrash_async_allocator_new)
+#define plcrash_async_allocator_refill_reserve PLNS(plcrash_async_allocator_refill_reserve)
+#define plcrash_nasync_allocator_prefault PLNS(plcrash_nasync_allocator_prefault)
+#define plcrash_async_allocator_reserve PLNS(plcrash_async_allocator_reserve)
+#define plcrash_async_allocator_reset PLNS(plcrash_async_allocator_reset)
+#define plcrash_async_arena_create PLNS(plcrash_async_arena_create)
+#define plcrash_async_breadcrumbs_append PLNS(plcrash_async_breadcrumbs_append)
+#define plcrash_async_breadcrumbs_enumerate PLNS(plcrash_async_breadcrumbs_enumerate)
+#define plcrash_async_breadcrumbs_snapshot PLNS(plcrash_async_breadcrumbs_snapshot)
+#define plcrash_async_cache_budget_charge PLNS(plcrash_async_cache_budget_charge)
+#define plcrash_async_cache_budget_init PLNS(plcrash_async_cache_budget_init)
+#define plcrash_async_cache_budget_record PLNS(plcrash_async_cache_budget_record)
+#define plcrash_async_cache_budget_register PLNS(plcrash_async_cache_budget_register)
+#define plcrash_async_cache_budget_release PLNS(plcrash_async_cache_budget_release)
+#define plcrash_async_cache_budget_stats PLNS(plcrash_async_cache_budget_stats)
+#define plcrash_async_cache_budget_unregister PLNS(plcrash_async_cache_budget_unregister)
+#define plcrash_async_cache_budget_used PLNS(plcrash_async_cache_budget_used)
 #define plcrash_async_byteorder_big_endian PLNS(plcrash_async_byteorder_big_endian)
 #define plcrash_async_byteorder_direct PLNS(plcrash_async_byteorder_direct)
 #define plcrash_async_byteorder_little_endian PLNS(plcrash_async_byteorder_little_endian)
@@ -153,18 +195,61 @@
 #define plcrash_async_cfe_entry_stack_offset PLNS(plcrash_async_cfe_entry_stack_offset)
 #define plcrash_async_cfe_entry_type PLNS(plcrash_async_cfe_entry_type)
 #define plcrash_async_cfe_reader_find_pc PLNS(plcrash_async_cfe_reader_find_pc)
+#define plcrash_async_cfe_reader_find_pc_range PLNS(plcrash_async_cfe_reader_find_pc_range)
 #define plcrash_async_cfe_reader_free PLNS(plcrash_async_cfe_reader_free)
 #define plcrash_async_cfe_reader_init PLNS(plcrash_async_cfe_reader_init)
 #define plcrash_async_cfe_register_decode PLNS(plcrash_async_cfe_register_decode)
 #define plcrash_async_cfe_register_encode PLNS(plcrash_async_cfe_register_encode)
+#define plcrash_async_checksum_trailer_verify PLNS(plcrash_async_checksum_trailer_verify)
+#define plcrash_async_crc32c PLNS(plcrash_async_crc32c)
+#define plcrash_async_crc32c_accelerated PLNS(plcrash_async_crc32c_accelerated)
+#define plcrash_async_compressed_decode PLNS(plcrash_async_compressed_decode)
+#define plcrash_async_compressed_decoded_length PLNS(plcrash_async_compressed_decoded_length)
+#define plcrash_async_compressed_is_compressed PLNS(plcrash_async_compressed_is_compressed)
+#define plcrash_async_compressor_append PLNS(plcrash_async_compressor_append)
+#define plcrash_async_compressor_append_task PLNS(plcrash_async_compressor_append_task)
+#define plcrash_async_compressor_encode_block PLNS(plcrash_async_compressor_encode_block)
+#define plcrash_async_compressor_full PLNS(plcrash_async_compressor_full)
+#define plcrash_async_compressor_pending PLNS(plcrash_async_compressor_pending)
+#define plcrash_async_compressor_reset PLNS(plcrash_async_compressor_reset)
+#define plcrash_async_debug_log_append PLNS(plcrash_async_debug_log_append)
+#define plcrash_async_debug_log_current PLNS(plcrash_async_debug_log_current)
+#define plcrash_async_debug_log_dropped PLNS(plcrash_async_debug_log_dropped)
+#define plcrash_async_debug_log_linearize PLNS(plcrash_async_debug_log_linearize)
+#define plcrash_async_debug_log_reset PLNS(plcrash_async_debug_log_reset)
+#define plcrash_async_debug_log_set_current PLNS(plcrash_async_debug_log_set_current)
+#define plcrash_async_debug_write PLNS(plcrash_async_debug_write)
+#define plcrash_async_dynloader_image_generation PLNS(plcrash_async_dynloader_image_generation)
+#define plcrash_async_dynloader_image_unload_count PLNS(plcrash_async_dynloader_image_unload_count)
+#define plcrash_async_embedded_symbols_find_symbol PLNS(plcrash_async_embedded_symbols_find_symbol)
 #define plcrash_async_file_close PLNS(plcrash_async_file_close)
 #define plcrash_async_file_flush PLNS(plcrash_async_file_flush)
 #define plcrash_async_file_init PLNS(plcrash_async_file_init)
+#define plcrash_async_file_init_buffer PLNS(plcrash_async_file_init_buffer)
+#define plcrash_async_file_init_mapped PLNS(plcrash_async_file_init_mapped)
+#define plcrash_async_file_init_memory PLNS(plcrash_async_file_init_memory)
+#define plcrash_async_file_position PLNS(plcrash_async_file_position)
+#define plcrash_async_file_pwrite PLNS(plcrash_async_file_pwrite)
+#define plcrash_async_file_seekable PLNS(plcrash_async_file_seekable)
+#define plcrash_async_file_set_checksum PLNS(plcrash_async_file_set_checksum)
+#define plcrash_async_file_set_compressor PLNS(plcrash_async_file_set_compressor)
+#define plcrash_async_file_set_sync PLNS(plcrash_async_file_set_sync)
+#define plcrash_async_file_preallocate PLNS(plcrash_async_file_preallocate)
 #define plcrash_async_file_write PLNS(plcrash_async_file_write)
+#define plcrash_async_file_write_task PLNS(plcrash_async_file_write_task)
 #define plcrash_async_find_symbol PLNS(plcrash_async_find_symbol)
+#define plcrash_async_find_symbols PLNS(plcrash_async_find_symbols)
 #define plcrash_async_image_containing_address PLNS(plcrash_async_image_containing_address)
+#define plcrash_async_image_list_classify_addresses PLNS(plcrash_async_image_list_classify_addresses)
+#define plcrash_async_image_list_index_containing_address PLNS(plcrash_async_image_list_index_containing_address)
 #define plcrash_async_image_list_next PLNS(plcrash_async_image_list_next)
 #define plcrash_async_image_list_set_reading PLNS(plcrash_async_image_list_set_reading)
+#define plcrash_async_instrumentation_current PLNS(plcrash_async_instrumentation_current)
+#define plcrash_async_instrumentation_init PLNS(plcrash_async_instrumentation_init)
+#define plcrash_async_instrumentation_phase_ns PLNS(plcrash_async_instrumentation_phase_ns)
+#define plcrash_async_instrumentation_set_current PLNS(plcrash_async_instrumentation_set_current)
+#define plcrash_async_lz_compress PLNS(plcrash_async_lz_compress)
+#define plcrash_async_lz_decompress PLNS(plcrash_async_lz_decompress)
 #define plcrash_async_mach_exception_get_siginfo PLNS(plcrash_async_mach_exception_get_siginfo)
 #define plcrash_async_macho_byteorder PLNS(plcrash_async_macho_byteorder)
 #define plcrash_async_macho_contains_address PLNS(plcrash_async_macho_contains_address)
@@ -179,34 +264,77 @@
 #define plcrash_async_macho_map_section PLNS(plcrash_async_macho_map_section)
 #define plcrash_async_macho_map_segment PLNS(plcrash_async_macho_map_segment)
 #define plcrash_async_macho_mapped_segment_free PLNS(plcrash_async_macho_mapped_segment_free)
+#define plcrash_async_macho_name PLNS(plcrash_async_macho_name)
 #define plcrash_async_macho_next_command PLNS(plcrash_async_macho_next_command)
 #define plcrash_async_macho_next_command_type PLNS(plcrash_async_macho_next_command_type)
+#define plcrash_async_macho_section_cache_free PLNS(plcrash_async_macho_section_cache_free)
+#define plcrash_async_macho_section_cache_init PLNS(plcrash_async_macho_section_cache_init)
+#define plcrash_async_macho_section_cache_map PLNS(plcrash_async_macho_section_cache_map)
+#define plcrash_async_macho_section_cache_unmap PLNS(plcrash_async_macho_section_cache_unmap)
+#define plcrash_async_macho_set_encoded_record PLNS(plcrash_async_macho_set_encoded_record)
 #define plcrash_async_macho_string_free PLNS(plcrash_async_macho_string_free)
 #define plcrash_async_macho_string_get_length PLNS(plcrash_async_macho_string_get_length)
 #define plcrash_async_macho_string_get_pointer PLNS(plcrash_async_macho_string_get_pointer)
+#define plcrash_async_macho_string_get_resolved_length PLNS(plcrash_async_macho_string_get_resolved_length)
 #define plcrash_async_macho_string_init PLNS(plcrash_async_macho_string_init)
+#define plcrash_async_macho_string_init_mapped PLNS(plcrash_async_macho_string_init_mapped)
+#define plcrash_async_macho_string_init_resolved PLNS(plcrash_async_macho_string_init_resolved)
+#define plcrash_async_macho_symtab_reader_find_symbol_by_pc PLNS(plcrash_async_macho_symtab_reader_find_symbol_by_pc)
+#define plcrash_async_macho_symtab_reader_find_symbols_by_pc PLNS(plcrash_async_macho_symtab_reader_find_symbols_by_pc)
+#define plcrash_async_macho_scan_nlist64_direct PLNS(plcrash_async_macho_scan_nlist64_direct)
 #define plcrash_async_macho_symtab_reader_free PLNS(plcrash_async_macho_symtab_reader_free)
 #define plcrash_async_macho_symtab_reader_init PLNS(plcrash_async_macho_symtab_reader_init)
 #define plcrash_async_macho_symtab_reader_read PLNS(plcrash_async_macho_symtab_reader_read)
+#define plcrash_async_macho_symtab_reader_read_batch PLNS(plcrash_async_macho_symtab_reader_read_batch)
 #define plcrash_async_macho_symtab_reader_symbol_name PLNS(plcrash_async_macho_symtab_reader_symbol_name)
+#define plcrash_async_magazine_allocator_create PLNS(plcrash_async_magazine_allocator_create)
 #define plcrash_async_memcpy PLNS(plcrash_async_memcpy)
 #define plcrash_async_memset PLNS(plcrash_async_memset)
 #define plcrash_async_mobject_base_address PLNS(plcrash_async_mobject_base_address)
 #define plcrash_async_mobject_free PLNS(plcrash_async_mobject_free)
 #define plcrash_async_mobject_init PLNS(plcrash_async_mobject_init)
+#define plcrash_async_mobject_init_pooled PLNS(plcrash_async_mobject_init_pooled)
 #define plcrash_async_mobject_length PLNS(plcrash_async_mobject_length)
+#define plcrash_async_mobject_pool_current PLNS(plcrash_async_mobject_pool_current)
+#define plcrash_async_mobject_pool_free PLNS(plcrash_async_mobject_pool_free)
+#define plcrash_async_mobject_pool_map PLNS(plcrash_async_mobject_pool_map)
+#define plcrash_async_mobject_pool_new PLNS(plcrash_async_mobject_pool_new)
+#define plcrash_async_mobject_pool_ref_free PLNS(plcrash_async_mobject_pool_ref_free)
+#define plcrash_async_mobject_pool_set_current PLNS(plcrash_async_mobject_pool_set_current)
 #define plcrash_async_mobject_read_uint16 PLNS(plcrash_async_mobject_read_uint16)
 #define plcrash_async_mobject_read_uint32 PLNS(plcrash_async_mobject_read_uint32)
 #define plcrash_async_mobject_read_uint64 PLNS(plcrash_async_mobject_read_uint64)
 #define plcrash_async_mobject_read_uint8 PLNS(plcrash_async_mobject_read_uint8)
+#define plcrash_async_mobject_region_cache_reset PLNS(plcrash_async_mobject_region_cache_reset)
 #define plcrash_async_mobject_remap_address PLNS(plcrash_async_mobject_remap_address)
+#define plcrash_async_mobject_remap_pages PLNS(plcrash_async_mobject_remap_pages)
 #define plcrash_async_mobject_task PLNS(plcrash_async_mobject_task)
 #define plcrash_async_mobject_verify_local_pointer PLNS(plcrash_async_mobject_verify_local_pointer)
 #define plcrash_async_objc_cache_free PLNS(plcrash_async_objc_cache_free)
 #define plcrash_async_objc_cache_init PLNS(plcrash_async_objc_cache_init)
+#define plcrash_async_objc_cache_set_budget PLNS(plcrash_async_objc_cache_set_budget)
+#define plcrash_async_objc_cache_set_max_class_capacity PLNS(plcrash_async_objc_cache_set_max_class_capacity)
 #define plcrash_async_objc_find_method PLNS(plcrash_async_objc_find_method)
+#define plcrash_async_objc_find_methods PLNS(plcrash_async_objc_find_methods)
+#define plcrash_async_objc_report_method PLNS(plcrash_async_objc_report_method)
 #define plcrash_async_objc_supports_nonptr_isa PLNS(plcrash_async_objc_supports_nonptr_isa)
 #define plcrash_async_read_addr PLNS(plcrash_async_read_addr)
+#define plcrash_async_region_map_current PLNS(plcrash_async_region_map_current)
+#define plcrash_async_region_map_free PLNS(plcrash_async_region_map_free)
+#define plcrash_async_region_map_init PLNS(plcrash_async_region_map_init)
+#define plcrash_async_region_map_set_current PLNS(plcrash_async_region_map_set_current)
+#define plcrash_async_region_map_verify PLNS(plcrash_async_region_map_verify)
+#define plcrash_async_report_slots_claim PLNS(plcrash_async_report_slots_claim)
+#define plcrash_async_report_slots_commit PLNS(plcrash_async_report_slots_commit)
+#define plcrash_async_report_slots_release PLNS(plcrash_async_report_slots_release)
+#define plcrash_async_sample_buffer_commit PLNS(plcrash_async_sample_buffer_commit)
+#define plcrash_async_sample_buffer_consume PLNS(plcrash_async_sample_buffer_consume)
+#define plcrash_async_sample_buffer_dropped PLNS(plcrash_async_sample_buffer_dropped)
+#define plcrash_async_sample_buffer_peek PLNS(plcrash_async_sample_buffer_peek)
+#define plcrash_async_sample_buffer_reserve PLNS(plcrash_async_sample_buffer_reserve)
+#define plcrash_async_shared_cache_find_symbol PLNS(plcrash_async_shared_cache_find_symbol)
+#define plcrash_async_shared_cache_symbols_free PLNS(plcrash_async_shared_cache_symbols_free)
+#define plcrash_async_shared_cache_symbols_init PLNS(plcrash_async_shared_cache_symbols_init)
 #define plcrash_async_signal_sigcode PLNS(plcrash_async_signal_sigcode)
 #define plcrash_async_signal_signame PLNS(plcrash_async_signal_signame)
 #define plcrash_async_strcmp PLNS(plcrash_async_strcmp)
@@ -214,11 +342,16 @@
 #define plcrash_async_strncmp PLNS(plcrash_async_strncmp)
 #define plcrash_async_symbol_cache_free PLNS(plcrash_async_symbol_cache_free)
 #define plcrash_async_symbol_cache_init PLNS(plcrash_async_symbol_cache_init)
+#define plcrash_async_symbol_cache_set_budget PLNS(plcrash_async_symbol_cache_set_budget)
+#define plcrash_async_symbol_cache_set_shared_cache PLNS(plcrash_async_symbol_cache_set_shared_cache)
 #define plcrash_async_task_memcpy PLNS(plcrash_async_task_memcpy)
 #define plcrash_async_task_read_uint16 PLNS(plcrash_async_task_read_uint16)
 #define plcrash_async_task_read_uint32 PLNS(plcrash_async_task_read_uint32)
 #define plcrash_async_task_read_uint64 PLNS(plcrash_async_task_read_uint64)
 #define plcrash_async_task_read_uint8 PLNS(plcrash_async_task_read_uint8)
+#define plcrash_async_thread_snapshot_init PLNS(plcrash_async_thread_snapshot_init)
+#define plcrash_async_thread_snapshot_restore PLNS(plcrash_async_thread_snapshot_restore)
+#define plcrash_async_thread_snapshot_size PLNS(plcrash_async_thread_snapshot_size)
 #define plcrash_async_thread_state_clear_all_regs PLNS(plcrash_async_thread_state_clear_all_regs)
 #define plcrash_async_thread_state_clear_reg PLNS(plcrash_async_thread_state_clear_reg)
 #define plcrash_async_thread_state_clear_volatile_regs PLNS(plcrash_async_thread_state_clear_volatile_regs)
@@ -237,26 +370,132 @@
 #define plcrash_async_thread_state_map_reg_to_dwarf PLNS(plcrash_async_thread_state_map_reg_to_dwarf)
 #define plcrash_async_thread_state_mcontext_init PLNS(plcrash_async_thread_state_mcontext_init)
 #define plcrash_async_thread_state_set_reg PLNS(plcrash_async_thread_state_set_reg)
+#define plcrash_async_vtask_lookup PLNS(plcrash_async_vtask_lookup)
+#define plcrash_async_vtask_map PLNS(plcrash_async_vtask_map)
+#define plcrash_async_vtask_memcpy PLNS(plcrash_async_vtask_memcpy)
+#define plcrash_async_vtask_port PLNS(plcrash_async_vtask_port)
+#define plcrash_async_vtask_recorder_current PLNS(plcrash_async_vtask_recorder_current)
+#define plcrash_async_vtask_recorder_set_current PLNS(plcrash_async_vtask_recorder_set_current)
+#define plcrash_async_vtask_recorder_write PLNS(plcrash_async_vtask_recorder_write)
 #define plcrash_async_writen PLNS(plcrash_async_writen)
+#define plcrash_log_attachments_add PLNS(plcrash_log_attachments_add)
+#define plcrash_log_attachments_remove PLNS(plcrash_log_attachments_remove)
+#define plcrash_log_secondary_crashes_add PLNS(plcrash_log_secondary_crashes_add)
+#define plcrash_log_trace_free PLNS(plcrash_log_trace_free)
+#define plcrash_log_trace_new PLNS(plcrash_log_trace_new)
+#define plcrash_log_trace_reset PLNS(plcrash_log_trace_reset)
 #define plcrash_log_writer_close PLNS(plcrash_log_writer_close)
 #define plcrash_log_writer_free PLNS(plcrash_log_writer_free)
+#define plcrash_log_writer_get_memory_usage PLNS(plcrash_log_writer_get_memory_usage)
 #define plcrash_log_writer_init PLNS(plcrash_log_writer_init)
+#define plcrash_log_writer_init_deferred PLNS(plcrash_log_writer_init_deferred)
+#define plcrash_log_writer_populate_host_info PLNS(plcrash_log_writer_populate_host_info)
+#define plcrash_log_writer_prefault PLNS(plcrash_log_writer_prefault)
+#define plcrash_log_writer_refill_allocator_reserve PLNS(plcrash_log_writer_refill_allocator_reserve)
+#define plcrash_log_writer_reset PLNS(plcrash_log_writer_reset)
+#define plcrash_log_writer_reserve_exception PLNS(plcrash_log_writer_reserve_exception)
+#define plcrash_log_writer_set_allocator_reserve PLNS(plcrash_log_writer_set_allocator_reserve)
+#define plcrash_log_writer_set_allocator_size PLNS(plcrash_log_writer_set_allocator_size)
+#define plcrash_log_writer_set_attachments PLNS(plcrash_log_writer_set_attachments)
+#define plcrash_log_writer_set_breadcrumbs PLNS(plcrash_log_writer_set_breadcrumbs)
+#define plcrash_log_writer_set_cache_budget PLNS(plcrash_log_writer_set_cache_budget)
+#define plcrash_log_writer_set_collapse_stacks PLNS(plcrash_log_writer_set_collapse_stacks)
+#define plcrash_log_writer_set_concurrent PLNS(plcrash_log_writer_set_concurrent)
+#define plcrash_log_writer_set_crash_loop PLNS(plcrash_log_writer_set_crash_loop)
+#define plcrash_log_writer_set_debug_log PLNS(plcrash_log_writer_set_debug_log)
 #define plcrash_log_writer_set_exception PLNS(plcrash_log_writer_set_exception)
+#define plcrash_log_writer_set_idle_thread_frames PLNS(plcrash_log_writer_set_idle_thread_frames)
+#define plcrash_log_writer_set_memory_capture PLNS(plcrash_log_writer_set_memory_capture)
+#define plcrash_log_writer_set_packed_frames PLNS(plcrash_log_writer_set_packed_frames)
+#define plcrash_log_writer_set_pipelined PLNS(plcrash_log_writer_set_pipelined)
+#define plcrash_log_writer_set_register_annotation PLNS(plcrash_log_writer_set_register_annotation)
+#define plcrash_log_writer_set_retain_standby PLNS(plcrash_log_writer_set_retain_standby)
+#define plcrash_log_writer_set_secondary_crashes PLNS(plcrash_log_writer_set_secondary_crashes)
+#define plcrash_log_writer_set_shared_cache_info PLNS(plcrash_log_writer_set_shared_cache_info)
+#define plcrash_log_writer_set_shared_image_list PLNS(plcrash_log_writer_set_shared_image_list)
+#define plcrash_log_writer_set_size_policy PLNS(plcrash_log_writer_set_size_policy)
+#define plcrash_log_writer_set_stack_scan PLNS(plcrash_log_writer_set_stack_scan)
+#define plcrash_log_writer_set_stack_snapshot_size PLNS(plcrash_log_writer_set_stack_snapshot_size)
+#define plcrash_log_writer_set_target_process PLNS(plcrash_log_writer_set_target_process)
+#define plcrash_log_writer_set_symbol_interning PLNS(plcrash_log_writer_set_symbol_interning)
+#define plcrash_log_writer_set_thread_filter PLNS(plcrash_log_writer_set_thread_filter)
+#define plcrash_log_writer_set_thread_metadata PLNS(plcrash_log_writer_set_thread_metadata)
+#define plcrash_log_writer_set_unwind_workers PLNS(plcrash_log_writer_set_unwind_workers)
+#define plcrash_log_writer_set_v2_format PLNS(plcrash_log_writer_set_v2_format)
+#define plcrash_log_writer_stack_hash PLNS(plcrash_log_writer_stack_hash)
 #define plcrash_log_writer_write PLNS(plcrash_log_writer_write)
+#define plcrash_log_writer_write_image_list PLNS(plcrash_log_writer_write_image_list)
+#define plcrash_log_writer_write_task PLNS(plcrash_log_writer_write_task)
+#define plcrash_log_writer_write_trace_sample PLNS(plcrash_log_writer_write_trace_sample)
+#define plcrash_nasync_breadcrumbs_free PLNS(plcrash_nasync_breadcrumbs_free)
+#define plcrash_nasync_breadcrumbs_init PLNS(plcrash_nasync_breadcrumbs_init)
+#define plcrash_nasync_compressor_free PLNS(plcrash_nasync_compressor_free)
+#define plcrash_nasync_compressor_new PLNS(plcrash_nasync_compressor_new)
+#define plcrash_nasync_debug_log_free PLNS(plcrash_nasync_debug_log_free)
+#define plcrash_nasync_debug_log_init PLNS(plcrash_nasync_debug_log_init)
+#define plcrash_nasync_dynloader_enable_objc_method_index PLNS(plcrash_nasync_dynloader_enable_objc_method_index)
+#define plcrash_nasync_dynloader_enable_index_cache PLNS(plcrash_nasync_dynloader_enable_index_cache)
 #define plcrash_nasync_image_list_append PLNS(plcrash_nasync_image_list_append)
 #define plcrash_nasync_image_list_free PLNS(plcrash_nasync_image_list_free)
 #define plcrash_nasync_image_list_init PLNS(plcrash_nasync_image_list_init)
+#define plcrash_nasync_image_list_new PLNS(plcrash_nasync_image_list_new)
+#define plcrash_nasync_image_list_new_with_headers PLNS(plcrash_nasync_image_list_new_with_headers)
 #define plcrash_nasync_image_list_remove PLNS(plcrash_nasync_image_list_remove)
 #define plcrash_async_macho_free PLNS(plcrash_async_macho_free)
 #define plcrash_async_macho_init PLNS(plcrash_async_macho_init)
+#define plcrash_async_macho_init_lazy_name PLNS(plcrash_async_macho_init_lazy_name)
+#define plcrash_async_macho_init_pooled PLNS(plcrash_async_macho_init_pooled)
+#define plcrash_nasync_macho_advise_linkedit PLNS(plcrash_nasync_macho_advise_linkedit)
+#define plcrash_nasync_macho_build_symbol_index PLNS(plcrash_nasync_macho_build_symbol_index)
+#define plcrash_nasync_objc_build_method_index PLNS(plcrash_nasync_objc_build_method_index)
+#define plcrash_nasync_vtask_add_region PLNS(plcrash_nasync_vtask_add_region)
+#define plcrash_nasync_vtask_free PLNS(plcrash_nasync_vtask_free)
+#define plcrash_nasync_vtask_init PLNS(plcrash_nasync_vtask_init)
+#define plcrash_nasync_vtask_init_file PLNS(plcrash_nasync_vtask_init_file)
+#define plcrash_nasync_vtask_init_recording PLNS(plcrash_nasync_vtask_init_recording)
+#define plcrash_nasync_vtask_init_source PLNS(plcrash_nasync_vtask_init_source)
+#define plcrash_nasync_vtask_recorder_init PLNS(plcrash_nasync_vtask_recorder_init)
+#define plcrash_nasync_image_index_cache_load PLNS(plcrash_nasync_image_index_cache_load)
+#define plcrash_nasync_image_index_cache_store PLNS(plcrash_nasync_image_index_cache_store)
+#define plcrash_nasync_objc_cache_prefault PLNS(plcrash_nasync_objc_cache_prefault)
+#define plcrash_nasync_objc_cache_reserve_classes PLNS(plcrash_nasync_objc_cache_reserve_classes)
+#define plcrash_nasync_report_slots_close PLNS(plcrash_nasync_report_slots_close)
+#define plcrash_nasync_report_slots_enumerate PLNS(plcrash_nasync_report_slots_enumerate)
+#define plcrash_nasync_report_slots_open PLNS(plcrash_nasync_report_slots_open)
+#define plcrash_nasync_sample_buffer_free PLNS(plcrash_nasync_sample_buffer_free)
+#define plcrash_nasync_sample_buffer_init PLNS(plcrash_nasync_sample_buffer_init)
+#define plcrash_nasync_scheduler_cancel PLNS(plcrash_nasync_scheduler_cancel)
+#define plcrash_nasync_scheduler_cancel_key PLNS(plcrash_nasync_scheduler_cancel_key)
+#define plcrash_nasync_scheduler_expedite PLNS(plcrash_nasync_scheduler_expedite)
+#define plcrash_nasync_scheduler_submit PLNS(plcrash_nasync_scheduler_submit)
+#define plcrash_nasync_scheduler_submit_block PLNS(plcrash_nasync_scheduler_submit_block)
+#define plcrash_nasync_scheduler_wait PLNS(plcrash_nasync_scheduler_wait)
+#define plcrash_nasync_scheduler_work_release PLNS(plcrash_nasync_scheduler_work_release)
+#define plcrash_nasync_shared_cache_info_free PLNS(plcrash_nasync_shared_cache_info_free)
+#define plcrash_nasync_shared_cache_info_init PLNS(plcrash_nasync_shared_cache_info_init)
+#define plcrash_nasync_symbol_cache_reserve PLNS(plcrash_nasync_symbol_cache_reserve)
 #define plcrash_populate_error PLNS(plcrash_populate_error)
 #define plcrash_populate_mach_error PLNS(plcrash_populate_mach_error)
 #define plcrash_populate_posix_error PLNS(plcrash_populate_posix_error)
+#define plcrash_queued_report_index_append PLNS(plcrash_queued_report_index_append)
+#define plcrash_queued_report_index_map PLNS(plcrash_queued_report_index_map)
+#define plcrash_queued_report_index_unmap PLNS(plcrash_queued_report_index_unmap)
+#define plcrash_queued_report_index_write PLNS(plcrash_queued_report_index_write)
+#define plcrash_queued_report_occurrence_append PLNS(plcrash_queued_report_occurrence_append)
+#define plcrash_queued_report_record_init PLNS(plcrash_queued_report_record_init)
 #define plcrash_sysctl_int PLNS(plcrash_sysctl_int)
 #define plcrash_sysctl_string PLNS(plcrash_sysctl_string)
 #define plcrash_sysctl_valid_utf8_bytes PLNS(plcrash_sysctl_valid_utf8_bytes)
 #define plcrash_sysctl_valid_utf8_bytes_max PLNS(plcrash_sysctl_valid_utf8_bytes_max)
+#define plcrash_writer_encode_varint PLNS(plcrash_writer_encode_varint)
 #define plcrash_writer_pack PLNS(plcrash_writer_pack)
+#define plcrash_writer_pack_size PLNS(plcrash_writer_pack_size)
+#define plcrash_writer_pack_deferred_length PLNS(plcrash_writer_pack_deferred_length)
+#define plcrash_writer_pack_fixup_length PLNS(plcrash_writer_pack_fixup_length)
+#define plframe_compact_unwind_cache_free PLNS(plframe_compact_unwind_cache_free)
+#define plframe_compact_unwind_cache_new PLNS(plframe_compact_unwind_cache_new)
+#define plframe_compact_unwind_cache_set_budget PLNS(plframe_compact_unwind_cache_set_budget)
+#define plframe_compact_unwind_cache_stats PLNS(plframe_compact_unwind_cache_stats)
 #define plframe_cursor_free PLNS(plframe_cursor_free)
 #define plframe_cursor_get_reg PLNS(plframe_cursor_get_reg)
 #define plframe_cursor_get_regcount PLNS(plframe_cursor_get_regcount)
@@ -267,7 +506,20 @@
 #define plframe_cursor_read_compact_unwind PLNS(plframe_cursor_read_compact_unwind)
 #define plframe_cursor_read_dwarf_unwind PLNS(plframe_cursor_read_dwarf_unwind)
 #define plframe_cursor_read_frame_ptr PLNS(plframe_cursor_read_frame_ptr)
+#define plframe_cursor_read_stack_scan PLNS(plframe_cursor_read_stack_scan)
+#define plframe_cursor_set_compact_unwind_cache PLNS(plframe_cursor_set_compact_unwind_cache)
+#define plframe_cursor_set_dwarf_cache PLNS(plframe_cursor_set_dwarf_cache)
+#define plframe_cursor_set_section_cache PLNS(plframe_cursor_set_section_cache)
+#define plframe_cursor_set_stack_snapshot PLNS(plframe_cursor_set_stack_snapshot)
 #define plframe_cursor_thread_init PLNS(plframe_cursor_thread_init)
+#define plframe_cursor_walk PLNS(plframe_cursor_walk)
+#define plframe_dwarf_cache_free PLNS(plframe_dwarf_cache_free)
+#define plframe_dwarf_cache_new PLNS(plframe_dwarf_cache_new)
+#define plframe_dwarf_cache_set_budget PLNS(plframe_dwarf_cache_set_budget)
+#define plframe_stack_window_free PLNS(plframe_stack_window_free)
+#define plframe_stack_window_init PLNS(plframe_stack_window_init)
+#define plframe_stack_window_init_snapshot PLNS(plframe_stack_window_init_snapshot)
+#define plframe_stack_window_read PLNS(plframe_stack_window_read)
 #define plframe_strerror PLNS(plframe_strerror)
 #define plframe_test_thread_spawn PLNS(plframe_test_thread_spawn)
 #define plframe_test_thread_stop PLNS(plframe_test_thread_stop)
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashQueuedReportIndex.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_queued_report_index Queued Report Index
+ *
+ * Maintains an index of the reports in the queued report directory, allowing the queue to be listed, prioritized,
+ * and purged from a single mapped file, without enumerating the directory or decoding the reports themselves.
+ *
+ * The index is an append-only log of fixed-size plcrash_queued_report_record_t records. Each record is appended via
+ * a single O_APPEND write(), and a torn append leaves at most a trailing partial record, which is ignored by readers
+ * and discarded by the next append.
+ *
+ * Crashes that duplicate a queued report are recorded in a separate log of plcrash_queued_report_occurrence_t records,
+ * maintained in the same manner.
+ * @{
+ */
+
+/**
+ * Initialize @a record.
+ *
+ * @param record The record to initialize.
+ * @param report_id The report's identifier.
+ * @param state The report's upload state.
+ * @param timestamp The time at which the report was queued, in milliseconds since 1970.
+ * @param size The size of the queued report file, in bytes.
+ * @param stack_hash A hash of the report's crashed thread stack, or 0 if unavailable.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if @a report_id exceeds
+ * PLCRASH_QUEUED_REPORT_ID_MAX.
+ */
+plcrash_error_t plcrash_queued_report_record_init (plcrash_queued_report_record_t *record,
+                                                   const char *report_id,
+                                                   plcrash_queued_report_state_t state,
+                                                   uint64_t timestamp,
+                                                   uint64_t size,
+                                                   uint64_t stack_hash)
+{
+    if (strlen(report_id) >= sizeof(record->report_id))
+        return PLCRASH_EINVAL;
+
+    memset(record, 0, sizeof(*record));
+    record->magic = PLCRASH_QUEUED_REPORT_INDEX_MAGIC;
+    record->version = PLCRASH_QUEUED_REPORT_INDEX_VERSION;
+    record->state = state;
+    strlcpy(record->report_id, report_id, sizeof(record->report_id));
+    record->timestamp = timestamp;
+    record->size = size;
+    record->stack_hash = stack_hash;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Write exactly @a len bytes of @a buf to @a fd.
+ */
+static bool plcrash_queued_report_index_write_all (int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t ret = write(fd, p, len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        p += ret;
+        len -= (size_t) ret;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Append the @a size byte @a record to the log of fixed-size records at @a path, creating the log if it does not
+ * exist. Any trailing partial record is first discarded.
+ */
+static plcrash_error_t plcrash_queued_report_log_append (const char *path, const void *record, size_t size) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+    struct stat sb;
+    int fd;
+
+    if ((fd = open(path, O_WRONLY|O_APPEND|O_CREAT, 0644)) < 0) {
+        PLCF_DEBUG("Could not open queued report log %s: %s", path, strerror(errno));
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    /* Discard any partial record left behind by a torn append, so that our record is correctly aligned */
+    if (fstat(fd, &sb) != 0) {
+        err = PLCRASH_OUTPUT_ERR;
+        goto cleanup;
+    }
+
+    if (sb.st_size % size != 0 && ftruncate(fd, sb.st_size - (sb.st_size % size)) != 0) {
+        err = PLCRASH_OUTPUT_ERR;
+        goto cleanup;
+    }
+
+    if (!plcrash_queued_report_index_write_all(fd, record, size)) {
+        PLCF_DEBUG("Could not append to queued report log %s: %s", path, strerror(errno));
+        err = PLCRASH_OUTPUT_ERR;
+    }
+
+cleanup:
+    close(fd);
+    return err;
+}
+
+/**
+ * Append @a record to the index at @a path, creating the index if it does not exist.
+ *
+ * @param path The index path.
+ * @param record The record to append.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_OUTPUT_ERR if the index could not be written.
+ *
+ * @warning This method is not async safe. Concurrent appends from within a single process must be externally
+ * synchronized.
+ */
+plcrash_error_t plcrash_queued_report_index_append (const char *path, const plcrash_queued_report_record_t *record) {
+    return plcrash_queued_report_log_append(path, record, sizeof(*record));
+}
+
+/**
+ * Append @a occurrence to the duplicate crash occurrence log at @a path, creating the log if it does not exist. The
+ * log's directory must already exist.
+ *
+ * @param path The occurrence log path.
+ * @param occurrence The occurrence to append. The magic and version fields are populated by this function.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_OUTPUT_ERR if the log could not be written.
+ *
+ * @warning This method is async-safe, as it may be called from a crash handler. Concurrent appends must be externally
+ * synchronized.
+ */
+plcrash_error_t plcrash_queued_report_occurrence_append (const char *path, const plcrash_queued_report_occurrence_t *occurrence) {
+    plcrash_queued_report_occurrence_t record = *occurrence;
+    record.magic = PLCRASH_QUEUED_REPORT_OCCURRENCE_MAGIC;
+    record.version = PLCRASH_QUEUED_REPORT_OCCURRENCE_VERSION;
+
+    return plcrash_queued_report_log_append(path, &record, sizeof(record));
+}
+
+/**
+ * Atomically replace the index at @a path with @a records. This may be used to compact an index, or to rebuild an
+ * index that is missing or invalid.
+ *
+ * @param path The index path.
+ * @param records The records to be written.
+ * @param count The number of records in @a records.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_OUTPUT_ERR if the index could not be written; on failure,
+ * the existing index is left unmodified.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_queued_report_index_write (const char *path, const plcrash_queued_report_record_t *records, size_t count) {
+    char tmp[PATH_MAX];
+    int fd;
+
+    int len = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if (len < 0 || (size_t) len >= sizeof(tmp))
+        return PLCRASH_OUTPUT_ERR;
+
+    if ((fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0) {
+        PLCF_DEBUG("Could not create queued report index %s: %s", tmp, strerror(errno));
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    bool written = (count == 0) || plcrash_queued_report_index_write_all(fd, records, sizeof(records[0]) * count);
+    if (close(fd) != 0)
+        written = false;
+
+    if (!written || rename(tmp, path) != 0) {
+        PLCF_DEBUG("Could not write queued report index %s: %s", path, strerror(errno));
+        unlink(tmp);
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Map the index at @a path. Any trailing partial record is ignored.
+ *
+ * @param index The index mapping to initialize. On success, the mapping must be released via
+ * plcrash_queued_report_index_unmap().
+ * @param path The index path.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no index exists, PLCRASH_EINVAL if the index
+ * contains an invalid record or a record of an unsupported version, or another error on failure. An index that is
+ * missing or invalid should be rebuilt from the queued report directory.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_queued_report_index_map (plcrash_queued_report_index_t *index, const char *path) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+    struct stat sb;
+    void *mapping;
+    int fd;
+
+    memset(index, 0, sizeof(*index));
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return (errno == ENOENT) ? PLCRASH_ENOTFOUND : PLCRASH_OUTPUT_ERR;
+
+    if (fstat(fd, &sb) != 0) {
+        err = PLCRASH_OUTPUT_ERR;
+        goto cleanup;
+    }
+
+    size_t count = (size_t) sb.st_size / sizeof(plcrash_queued_report_record_t);
+    if (count == 0)
+        goto cleanup;
+
+    size_t mapped_size = count * sizeof(plcrash_queued_report_record_t);
+    if ((mapping = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+        PLCF_DEBUG("Could not map queued report index %s: %s", path, strerror(errno));
+        err = PLCRASH_OUTPUT_ERR;
+        goto cleanup;
+    }
+
+    /* Validate the records */
+    const plcrash_queued_report_record_t *records = mapping;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].magic != PLCRASH_QUEUED_REPORT_INDEX_MAGIC || records[i].version != PLCRASH_QUEUED_REPORT_INDEX_VERSION ||
+            records[i].state > PLCRASH_QUEUED_REPORT_STATE_REMOVED ||
+            memchr(records[i].report_id, '\0', sizeof(records[i].report_id)) == NULL)
+        {
+            PLCF_DEBUG("Ignoring invalid queued report index %s", path);
+            munmap(mapping, mapped_size);
+            err = PLCRASH_EINVAL;
+            goto cleanup;
+        }
+    }
+
+    index->records = records;
+    index->count = count;
+    index->mapped_size = mapped_size;
+
+cleanup:
+    close(fd);
+    return err;
+}
+
+/**
+ * Release a mapping initialized via plcrash_queued_report_index_map().
+ *
+ * @param index The index mapping to release.
+ */
+void plcrash_queued_report_index_unmap (plcrash_queued_report_index_t *index) {
+    if (index->records != NULL)
+        munmap((void *) index->records, index->mapped_size);
+
+    memset(index, 0, sizeof(*index));
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_QUEUED_REPORT_INDEX_H
+#define PLCRASH_QUEUED_REPORT_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @{
+ */
+
+/** The magic value identifying a queued report index record ('plqi'). */
+#define PLCRASH_QUEUED_REPORT_INDEX_MAGIC 0x706c7169
+
+/** The current queued report index record version. An index containing records of any other version is rebuilt. */
+#define PLCRASH_QUEUED_REPORT_INDEX_VERSION 1
+
+/** The magic value identifying a duplicate crash occurrence record ('plqo'). */
+#define PLCRASH_QUEUED_REPORT_OCCURRENCE_MAGIC 0x706c716f
+
+/** The current duplicate crash occurrence record version. Records of any other version are ignored. */
+#define PLCRASH_QUEUED_REPORT_OCCURRENCE_VERSION 1
+
+/** The maximum length of a queued report identifier, including the trailing NUL. */
+#define PLCRASH_QUEUED_REPORT_ID_MAX 64
+
+/**
+ * @internal
+ *
+ * The upload state of a queued report.
+ */
+typedef enum {
+    /** The report has been queued, and has not yet been uploaded. */
+    PLCRASH_QUEUED_REPORT_STATE_PENDING = 0,
+
+    /** The report has been uploaded, but has not yet been removed from the queue. */
+    PLCRASH_QUEUED_REPORT_STATE_UPLOADED = 1,
+
+    /** The report has been removed from the queue. */
+    PLCRASH_QUEUED_REPORT_STATE_REMOVED = 2,
+} plcrash_queued_report_state_t;
+
+/**
+ * @internal
+ *
+ * A single queued report index record.
+ *
+ * The index is an append-only log of fixed-size records, in the native layout and byte order of the writing process;
+ * each record's size is a multiple of 8 bytes, and the file may thus be mapped and read directly, without parsing.
+ * A report's first record is appended when the report is queued, and later records for the same report_id supersede
+ * it; the last record for a given report_id describes the report's current state.
+ */
+typedef struct plcrash_queued_report_record {
+    /** PLCRASH_QUEUED_REPORT_INDEX_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_QUEUED_REPORT_INDEX_VERSION. */
+    uint16_t version;
+
+    /** The report's plcrash_queued_report_state_t. */
+    uint16_t state;
+
+    /** The report's NUL-terminated identifier; the file name of the queued report, without its extension. */
+    char report_id[PLCRASH_QUEUED_REPORT_ID_MAX];
+
+    /** The time at which the report was queued, in milliseconds since 1970. */
+    uint64_t timestamp;
+
+    /** The size of the queued report file, in bytes. */
+    uint64_t size;
+
+    /** A hash of the report's crashed thread stack, or 0 if unavailable. */
+    uint64_t stack_hash;
+} plcrash_queued_report_record_t;
+
+/**
+ * @internal
+ *
+ * A record of a crash for which no report was written, as its crashed thread stack hash matched that of a queued
+ * report. Occurrences are appended to a log of fixed-size records, with the same layout and torn append handling as
+ * the queued report index.
+ */
+typedef struct plcrash_queued_report_occurrence {
+    /** PLCRASH_QUEUED_REPORT_OCCURRENCE_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_QUEUED_REPORT_OCCURRENCE_VERSION. */
+    uint16_t version;
+
+    /** The crash's signal number, or 0 if unavailable. */
+    uint16_t signo;
+
+    /** The crash's stack hash, matching that of the duplicated queued report. */
+    uint64_t stack_hash;
+
+    /** The time of the crash, in milliseconds since 1970. */
+    uint64_t timestamp;
+
+    /** The crash's signal code, or 0 if unavailable. */
+    int64_t code;
+} plcrash_queued_report_occurrence_t;
+
+/**
+ * @internal
+ *
+ * A read-only mapping of a queued report index.
+ */
+typedef struct plcrash_queued_report_index {
+    /** The mapped records, or NULL if the index is empty. */
+    const plcrash_queued_report_record_t *records;
+
+    /** The number of complete records in @a records. */
+    size_t count;
+
+    /** The size of the mapping, in bytes. */
+    size_t mapped_size;
+} plcrash_queued_report_index_t;
+
+plcrash_error_t plcrash_queued_report_record_init (plcrash_queued_report_record_t *record,
+                                                   const char *report_id,
+                                                   plcrash_queued_report_state_t state,
+                                                   uint64_t timestamp,
+                                                   uint64_t size,
+                                                   uint64_t stack_hash);
+
+plcrash_error_t plcrash_queued_report_index_append (const char *path, const plcrash_queued_report_record_t *record);
+plcrash_error_t plcrash_queued_report_index_write (const char *path, const plcrash_queued_report_record_t *records, size_t count);
+
+plcrash_error_t plcrash_queued_report_occurrence_append (const char *path, const plcrash_queued_report_occurrence_t *occurrence);
+
+plcrash_error_t plcrash_queued_report_index_map (plcrash_queued_report_index_t *index, const char *path);
+void plcrash_queued_report_index_unmap (plcrash_queued_report_index_t *index);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_QUEUED_REPORT_INDEX_H */
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashQueuedReportIndex.h"
+
+#import <fcntl.h>
+
+@interface PLCrashQueuedReportIndexTests : SenTestCase {
+    /** Temporary index directory. */
+    NSString *_indexDir;
+
+    /** Index path. */
+    NSString *_indexPath;
+}
+@end
+
+@implementation PLCrashQueuedReportIndexTests
+
+- (void) setUp {
+    _indexDir = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: _indexDir withIntermediateDirectories: YES attributes: nil error: NULL], @"Could not create index directory");
+
+    _indexPath = [[_indexDir stringByAppendingPathComponent: @"queue_index"] retain];
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _indexDir error: NULL];
+    [_indexDir release];
+    [_indexPath release];
+}
+
+/**
+ * Verify that appended records are mapped in append order.
+ */
+- (void) testAppendAndMap {
+    const char *path = [_indexPath fileSystemRepresentation];
+    plcrash_queued_report_index_t index;
+    plcrash_queued_report_record_t record;
+
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ENOTFOUND, @"Mapping a missing index should fail");
+
+    for (uint64_t i = 0; i < 3; i++) {
+        NSString *reportID = [NSString stringWithFormat: @"report-%llu", (unsigned long long) i];
+        STAssertEquals(plcrash_queued_report_record_init(&record, [reportID UTF8String], PLCRASH_QUEUED_REPORT_STATE_PENDING, 1000 + i, 100 * i, 0xAB00 + i), PLCRASH_ESUCCESS, @"Failed to initialize record");
+        STAssertEquals(plcrash_queued_report_index_append(path, &record), PLCRASH_ESUCCESS, @"Failed to append record");
+    }
+
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ESUCCESS, @"Failed to map index");
+    STAssertEquals(index.count, (size_t) 3, @"Incorrect record count");
+    for (uint64_t i = 0; i < index.count; i++) {
+        NSString *reportID = [NSString stringWithFormat: @"report-%llu", (unsigned long long) i];
+        STAssertEqualCStrings(index.records[i].report_id, [reportID UTF8String], @"Incorrect report ID");
+        STAssertEquals(index.records[i].state, (uint16_t) PLCRASH_QUEUED_REPORT_STATE_PENDING, @"Incorrect state");
+        STAssertEquals(index.records[i].timestamp, 1000 + i, @"Incorrect timestamp");
+        STAssertEquals(index.records[i].size, 100 * i, @"Incorrect size");
+        STAssertEquals(index.records[i].stack_hash, 0xAB00 + i, @"Incorrect stack hash");
+    }
+    plcrash_queued_report_index_unmap(&index);
+    STAssertNULL(index.records, @"Unmapped index should be cleared");
+}
+
+/**
+ * Verify that a trailing partial record left by a torn append is ignored, and discarded by the next append.
+ */
+- (void) testTornAppend {
+    const char *path = [_indexPath fileSystemRepresentation];
+    plcrash_queued_report_index_t index;
+    plcrash_queued_report_record_t record;
+
+    STAssertEquals(plcrash_queued_report_record_init(&record, "first", PLCRASH_QUEUED_REPORT_STATE_PENDING, 1, 2, 3), PLCRASH_ESUCCESS, @"Failed to initialize record");
+    STAssertEquals(plcrash_queued_report_index_append(path, &record), PLCRASH_ESUCCESS, @"Failed to append record");
+
+    /* Simulate a torn append */
+    int fd = open(path, O_WRONLY|O_APPEND);
+    STAssertTrue(fd >= 0, @"Could not open index");
+    STAssertEquals(write(fd, &record, sizeof(record) / 2), (ssize_t) (sizeof(record) / 2), @"Could not write partial record");
+    close(fd);
+
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ESUCCESS, @"Failed to map index");
+    STAssertEquals(index.count, (size_t) 1, @"The partial record should be ignored");
+    plcrash_queued_report_index_unmap(&index);
+
+    STAssertEquals(plcrash_queued_report_record_init(&record, "second", PLCRASH_QUEUED_REPORT_STATE_UPLOADED, 4, 5, 6), PLCRASH_ESUCCESS, @"Failed to initialize record");
+    STAssertEquals(plcrash_queued_report_index_append(path, &record), PLCRASH_ESUCCESS, @"Failed to append record");
+
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ESUCCESS, @"Failed to map index");
+    STAssertEquals(index.count, (size_t) 2, @"Incorrect record count");
+    STAssertEqualCStrings(index.records[1].report_id, "second", @"The appended record was misaligned");
+    STAssertEquals(index.records[1].state, (uint16_t) PLCRASH_QUEUED_REPORT_STATE_UPLOADED, @"Incorrect state");
+    plcrash_queued_report_index_unmap(&index);
+}
+
+/**
+ * Verify that invalid records and overlong report identifiers are rejected.
+ */
+- (void) testInvalid {
+    const char *path = [_indexPath fileSystemRepresentation];
+    plcrash_queued_report_index_t index;
+    plcrash_queued_report_record_t record;
+
+    char longID[PLCRASH_QUEUED_REPORT_ID_MAX + 1];
+    memset(longID, 'a', sizeof(longID) - 1);
+    longID[sizeof(longID) - 1] = '\0';
+    STAssertEquals(plcrash_queued_report_record_init(&record, longID, PLCRASH_QUEUED_REPORT_STATE_PENDING, 0, 0, 0), PLCRASH_EINVAL, @"An overlong report ID should be rejected");
+
+    STAssertEquals(plcrash_queued_report_record_init(&record, "report", PLCRASH_QUEUED_REPORT_STATE_PENDING, 0, 0, 0), PLCRASH_ESUCCESS, @"Failed to initialize record");
+    record.version++;
+    STAssertEquals(plcrash_queued_report_index_append(path, &record), PLCRASH_ESUCCESS, @"Failed to append record");
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_EINVAL, @"An unsupported record version should be rejected");
+}
+
+/**
+ * Verify that rewriting an index replaces its contents.
+ */
+- (void) testWrite {
+    const char *path = [_indexPath fileSystemRepresentation];
+    plcrash_queued_report_index_t index;
+    plcrash_queued_report_record_t records[2];
+
+    STAssertEquals(plcrash_queued_report_record_init(&records[0], "a", PLCRASH_QUEUED_REPORT_STATE_PENDING, 1, 1, 1), PLCRASH_ESUCCESS, @"Failed to initialize record");
+    STAssertEquals(plcrash_queued_report_record_init(&records[1], "b", PLCRASH_QUEUED_REPORT_STATE_REMOVED, 2, 2, 2), PLCRASH_ESUCCESS, @"Failed to initialize record");
+    STAssertEquals(plcrash_queued_report_index_append(path, &records[0]), PLCRASH_ESUCCESS, @"Failed to append record");
+
+    STAssertEquals(plcrash_queued_report_index_write(path, records, 2), PLCRASH_ESUCCESS, @"Failed to write index");
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ESUCCESS, @"Failed to map index");
+    STAssertEquals(index.count, (size_t) 2, @"Incorrect record count");
+    STAssertEqualCStrings(index.records[1].report_id, "b", @"Incorrect report ID");
+    plcrash_queued_report_index_unmap(&index);
+
+    /* An empty index maps successfully, with no records */
+    STAssertEquals(plcrash_queued_report_index_write(path, NULL, 0), PLCRASH_ESUCCESS, @"Failed to write index");
+    STAssertEquals(plcrash_queued_report_index_map(&index, path), PLCRASH_ESUCCESS, @"Failed to map index");
+    STAssertEquals(index.count, (size_t) 0, @"Incorrect record count");
+    plcrash_queued_report_index_unmap(&index);
+}
+
+
+/**
+ * Verify that occurrence records are appended with their magic and version populated, and that a torn append is
+ * discarded by the next append.
+ */
+- (void) testOccurrenceAppend {
+    NSString *occurrencePath = [_indexDir stringByAppendingPathComponent: @"occurrences"];
+    const char *path = [occurrencePath fileSystemRepresentation];
+    plcrash_queued_report_occurrence_t occurrence;
+
+    memset(&occurrence, 0, sizeof(occurrence));
+    occurrence.stack_hash = 0xABCD;
+    occurrence.timestamp = 1000;
+    occurrence.signo = SIGSEGV;
+    occurrence.code = SEGV_MAPERR;
+    STAssertEquals(plcrash_queued_report_occurrence_append(path, &occurrence), PLCRASH_ESUCCESS, @"Failed to append occurrence");
+
+    /* Simulate a torn append */
+    int fd = open(path, O_WRONLY|O_APPEND);
+    STAssertTrue(fd >= 0, @"Could not open occurrence log");
+    STAssertEquals(write(fd, &occurrence, sizeof(occurrence) / 2), (ssize_t) (sizeof(occurrence) / 2), @"Could not write partial record");
+    close(fd);
+
+    occurrence.timestamp = 2000;
+    STAssertEquals(plcrash_queued_report_occurrence_append(path, &occurrence), PLCRASH_ESUCCESS, @"Failed to append occurrence");
+
+    NSData *data = [NSData dataWithContentsOfFile: occurrencePath];
+    STAssertEquals([data length], sizeof(occurrence) * 2, @"The partial record should have been discarded");
+
+    const plcrash_queued_report_occurrence_t *records = [data bytes];
+    for (size_t i = 0; i < 2; i++) {
+        STAssertEquals(records[i].magic, (uint32_t) PLCRASH_QUEUED_REPORT_OCCURRENCE_MAGIC, @"Incorrect magic");
+        STAssertEquals(records[i].version, (uint16_t) PLCRASH_QUEUED_REPORT_OCCURRENCE_VERSION, @"Incorrect version");
+        STAssertEquals(records[i].stack_hash, (uint64_t) 0xABCD, @"Incorrect stack hash");
+        STAssertEquals(records[i].signo, (uint16_t) SIGSEGV, @"Incorrect signal");
+        STAssertEquals(records[i].code, (int64_t) SEGV_MAPERR, @"Incorrect code");
+    }
+    STAssertEquals(records[1].timestamp, (uint64_t) 2000, @"The appended record was misaligned");
+}
+
+@end
@@ -30,7 +30,10 @@
 
 #import "PLCrashReportApplicationInfo.h"
 #import "PLCrashReportBinaryImageInfo.h"
+#import "PLCrashReportBreadcrumbInfo.h"
+#import "PLCrashReportMemoryRegionInfo.h"
 #import "PLCrashReportExceptionInfo.h"
+#import "PLCrashReportFrameRepeatInfo.h"
 #import "PLCrashReportMachineInfo.h"
 #import "PLCrashReportMachExceptionInfo.h"
 #import "PLCrashReportProcessInfo.h"
@@ -41,6 +44,7 @@
 #import "PLCrashReportSymbolInfo.h"
 #import "PLCrashReportSystemInfo.h"
 #import "PLCrashReportThreadInfo.h"
+#import "PLCrashReportThreadMetadataInfo.h"
 
 /** 
  * @ingroup constants
@@ -53,6 +57,34 @@
  * an entirely new crash log format. */
 #define PLCRASH_REPORT_FILE_VERSION 1
 
+/**
+ * @ingroup constants
+ * Version byte identifier of the opt-in version 2 crash log format; see the CrashReportV2 message of
+ * crash_report.proto. */
+#define PLCRASH_REPORT_FILE_VERSION_V2 2
+
+/**
+ * @ingroup constants
+ * Shared image list file magic identifier. Image list files share the crash log file header format, and are
+ * referenced by crash reports written with PLCrashReporterConfig::shouldShareLiveReportImageLists enabled. */
+#define PLCRASH_IMAGE_LIST_FILE_MAGIC "plimage"
+
+/**
+ * @ingroup constants
+ * Shared image list format version byte identifier. */
+#define PLCRASH_IMAGE_LIST_FILE_VERSION 1
+
+/**
+ * @ingroup constants
+ * Live trace file magic identifier. Trace files share the crash log file header format, and are produced by
+ * PLCrashReporter::generateLiveTraceSampleAndReturnError:. */
+#define PLCRASH_TRACE_FILE_MAGIC "pltrace"
+
+/**
+ * @ingroup constants
+ * Live trace format version byte identifier. */
+#define PLCRASH_TRACE_FILE_VERSION 1
+
 /**
  * @ingroup types
  * Crash log file header format.
@@ -74,6 +106,39 @@ struct PLCrashReportFileHeader {
 } __attribute__((packed));
 
 
+/**
+ * @ingroup enums
+ * Crash report decoding options.
+ */
+typedef NS_OPTIONS(NSUInteger, PLCrashReportDecodingOptions) {
+    /** Decode the entire report when the PLCrashReport instance is initialized. */
+    PLCrashReportDecodingOptionNone = 0,
+
+    /**
+     * Defer decoding of the report's thread and binary image records until the PLCrashReport::threads or
+     * PLCrashReport::images properties are first accessed.
+     *
+     * The deferred records are decoded directly from the provided report data, which will be retained (rather
+     * than copied) by the PLCrashReport instance; when used with memory-mapped data, report fields that are never
+     * accessed will never be paged in. This is intended for clients that only require a subset of the report, such
+     * as the exception and crashed thread.
+     *
+     * Malformed thread or image records will not be detected until first access; in that case, the corresponding
+     * property will return nil.
+     */
+    PLCrashReportDecodingOptionLazy = 1 << 0,
+
+    /**
+     * Build the report's PLCrashReportThreadInfo and PLCrashReportBinaryImageInfo instances concurrently via
+     * dispatch_apply(), once the report's records have been unpacked. The resulting threads and images are identical
+     * to -- and in the same order as -- those built serially.
+     *
+     * This is intended for bulk decoding of reports with many threads or binary images, such as server-side report
+     * processing. Has no effect if PLCrashReportDecodingOptionLazy is also set.
+     */
+    PLCrashReportDecodingOptionConcurrent = 1 << 1,
+};
+
 /**
  * @internal
  * Private decoder instance variables (used to hide the underlying protobuf parser).
@@ -109,17 +174,43 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
     /** Binary images (PLCrashReportBinaryImageInfo instances */
     NSArray *_images;
 
+    /** Compact binary image records (PLCrashReportBinaryImageInfo instances) */
+    NSArray *_compactImages;
+
     /** Exception information (may be nil) */
     PLCrashReportExceptionInfo *_exceptionInfo;
 
+    /** Breadcrumbs (PLCrashReportBreadcrumbInfo instances) */
+    NSArray *_breadcrumbs;
+
+    /** Captured memory regions (PLCrashReportMemoryRegionInfo instances) */
+    NSArray *_memoryRegions;
+
+    /** Buffered crash reporter debug output (may be nil) */
+    NSString *_debugLog;
+
+    /** Caller-registered attachments, keyed by name (NSString -> NSData) */
+    NSDictionary *_attachments;
+
+    /** Per-thread metadata (PLCrashReportThreadMetadataInfo instances) */
+    NSArray *_threadMetadata;
+
     /** Report UUID */
     CFUUIDRef _uuid;
 }
 
 - (id) initWithData: (NSData *) encodedData error: (NSError **) outError;
+- (id) initWithData: (NSData *) encodedData options: (PLCrashReportDecodingOptions) options error: (NSError **) outError;
+- (id) initWithContentsOfFile: (NSString *) path options: (PLCrashReportDecodingOptions) options error: (NSError **) outError;
 
 - (PLCrashReportBinaryImageInfo *) imageForAddress: (uint64_t) address;
 
++ (NSData *) compressedDataWithReportData: (NSData *) data error: (NSError **) outError;
++ (NSData *) v2DataWithReportData: (NSData *) data error: (NSError **) outError;
+
++ (NSString *) sharedImageListFileNameForSessionID: (NSData *) sessionID generation: (uint32_t) generation;
+- (BOOL) resolveSharedImageListWithData: (NSData *) data error: (NSError **) outError;
+
 /**
  * System information.
  */
@@ -170,15 +261,47 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
 @property(nonatomic, readonly) PLCrashReportMachExceptionInfo *machExceptionInfo;
 
 /**
- * Thread information. Returns a list of PLCrashReportThreadInfo instances.
+ * Thread information. Returns a list of PLCrashReportThreadInfo instances, ordered by thread number.
  */
 @property(nonatomic, readonly) NSArray *threads;
 
+/**
+ * The thread that crashed, or nil if no crashed thread is recorded in the report.
+ */
+@property(nonatomic, readonly) PLCrashReportThreadInfo *crashedThread;
+
 /**
  * Binary image information. Returns a list of PLCrashReportBinaryImageInfo instances.
  */
 @property(nonatomic, readonly) NSArray *images;
 
+/**
+ * Binary image information, sorted in ascending order by base address. Images sharing a base address retain their
+ * relative order from images. The sorted list is computed on first access and cached.
+ */
+@property(nonatomic, readonly) NSArray *sortedImages;
+
+/**
+ * YES if the report's binary images were written to a shared image list file, rather than to the report itself (see
+ * PLCrashReporterConfig::shouldShareLiveReportImageLists). The report's images are not available until the image list
+ * has been resolved via -resolveSharedImageListWithData:error:.
+ */
+@property(nonatomic, readonly) BOOL hasSharedImageList;
+
+/**
+ * The file name of the shared image list referenced by the report, or nil if the report does not reference a shared
+ * image list.
+ */
+@property(nonatomic, readonly) NSString *sharedImageListFileName;
+
+/**
+ * Binary images that were not referenced by the report's stack frames or register values, and were recorded by base
+ * address and UUID alone (see PLCrashReporterConfig::shouldCompactUnreferencedImages). Returns a list of
+ * PLCrashReportBinaryImageInfo instances with a nil name and code type, and a size of 0. If all images were recorded
+ * in full, this will be an empty array.
+ */
+@property(nonatomic, readonly) NSArray *compactImages;
+
 /**
  * YES if exception information is available.
  */
@@ -190,6 +313,68 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
  */
 @property(nonatomic, readonly) PLCrashReportExceptionInfo *exceptionInfo;
 
+/**
+ * The application breadcrumbs recorded prior to the crash, as PLCrashReportBreadcrumbInfo instances ordered from
+ * oldest to newest. Only the most recent breadcrumbs that fit within the reporter's breadcrumb ring are retained
+ * (see PLCrashReporterConfig::breadcrumbCapacity). If breadcrumbs were not enabled, this will be an empty array.
+ */
+@property(nonatomic, readonly) NSArray *breadcrumbs;
+
+/**
+ * The memory captured from the crashed thread, as PLCrashReportMemoryRegionInfo instances: the thread's stack,
+ * beginning at its stack pointer, followed by the memory surrounding any register values that referenced readable
+ * memory (see PLCrashReporterConfig::memoryCaptureBudget). If memory capture was not enabled, this will be an empty
+ * array.
+ */
+@property(nonatomic, readonly) NSArray *memoryRegions;
+
+/**
+ * The debug output emitted by the crash reporter while writing the report, if buffered debug output was enabled (see
+ * PLCrashReporterConfig::debugLogBufferSize), or nil. Debug output is not emitted by release builds of the crash
+ * reporter.
+ */
+@property(nonatomic, readonly) NSString *debugLog;
+
+/**
+ * The data attached to the report at the time of the crash, keyed by attachment name (see
+ * PLCrashReporter::registerAttachmentNamed:address:length:error:). If no attachments were registered, this will be an
+ * empty dictionary.
+ */
+@property(nonatomic, readonly) NSDictionary *attachments;
+
+/**
+ * The CPU usage and scheduling state of each of the report's threads, as PLCrashReportThreadMetadataInfo instances
+ * (see PLCrashReporterConfig::shouldRecordThreadMetadata). If thread metadata was not recorded, this will be an empty
+ * array.
+ */
+@property(nonatomic, readonly) NSArray *threadMetadata;
+
+/**
+ * The number of consecutive launches, including the reported launch, that terminated in a crash shortly after the
+ * crash reporter was enabled (see PLCrashReporterConfig::crashLoopThreshold). If the crash was not a launch crash, or
+ * crash loop detection was not enabled, this will be 0.
+ */
+@property(nonatomic, readonly) NSUInteger launchCrashCount;
+
+/**
+ * A hash of the crashed thread's stack, derived from the image names and image-relative addresses of its frames,
+ * and stable across launches. Only available for launch crashes; otherwise 0.
+ */
+@property(nonatomic, readonly) uint64_t stackHash;
+
+/**
+ * YES if the report was written while crash looping, and is limited to the crashed thread, its exception, and the
+ * binary images it references.
+ */
+@property(nonatomic, readonly) BOOL isReducedReport;
+
+/**
+ * YES if the report was truncated -- as occurs if the crash reporter is terminated while writing the report -- and
+ * its incomplete trailing record was discarded. A truncated report contains all of the records that were
+ * completely written; the crashed thread is written before any other thread.
+ */
+@property(nonatomic, readonly) BOOL truncated;
+
 /**
  * A client-generated 16-byte UUID. May be used to filter duplicate reports submitted or generated
  * by a single client. Only available in later (v1.2+) crash report format versions. If not available,
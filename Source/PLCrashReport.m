@@ -30,14 +30,344 @@
 #import "CrashReporter.h"
 
 #import "crash_report.pb-c.h"
+#import "PLCrashAsyncCompressor.h"
+#import "PLCrashAsyncChecksum.h"
+#import "PLCrashCompatConstants.h"
+
+/**
+ * @internal
+ * A chunk of arena memory.
+ */
+struct plcrash_report_arena_chunk {
+    /** The next (previously filled) chunk, or NULL. */
+    struct plcrash_report_arena_chunk *next;
+
+    /** The number of usable bytes following the (aligned) chunk header. */
+    size_t size;
+
+    /** The number of bytes allocated from this chunk. */
+    size_t used;
+};
+
+/**
+ * @internal
+ *
+ * A bump allocator used to back protobuf-c decoding. Rather than individually allocating each decoded submessage,
+ * repeated field array, and string, all allocations are carved sequentially from (typically) a single chunk sized
+ * from the encoded message length, and released at once via plcrash_report_arena_free().
+ */
+struct plcrash_report_arena {
+    /** The current chunk, from which allocations are made. */
+    struct plcrash_report_arena_chunk *chunks;
+
+    /** The protobuf-c allocator; allocator_data refers back to this arena. */
+    ProtobufCAllocator allocator;
+};
 
 struct _PLCrashReportDecoder {
     Plcrash__CrashReport *crashReport;
+
+    /** The arena backing crashReport. */
+    struct plcrash_report_arena *arena;
+
+    /** Symbol names from the report's symbol string table, in index order, or nil if the report has no string table. */
+    NSArray *symbolNames;
+
+    /**
+     * The report data from which deferred thread and image records are decoded, or nil if decoding is not
+     * deferred (see PLCrashReportDecodingOptionLazy). Released once all deferred records have been decoded.
+     */
+    NSData *lazyData;
+
+    /** NSRange values locating each deferred thread record within lazyData, or nil if thread records are not deferred. */
+    NSData *threadRanges;
+
+    /** NSRange values locating each deferred binary image record within lazyData, or nil if image records are not deferred. */
+    NSData *imageRanges;
+
+    /** The crashed thread, if decoded prior to the materialization of the full thread list. */
+    PLCrashReportThreadInfo *crashedThread;
+
+    /** Binary image address index, sorted by base address, or NULL if not yet built. */
+    struct plcrash_report_image_index_entry *imageIndex;
+
+    /** Number of entries in imageIndex. */
+    size_t imageIndexCount;
+
+    /** Binary images in imageIndex order, or nil if not yet built. */
+    NSArray *sortedImages;
+
+    /** YES if an incomplete trailing message was discarded from the report data. */
+    BOOL truncated;
 };
 
+/**
+ * @internal
+ * A binary image address index entry.
+ */
+struct plcrash_report_image_index_entry {
+    /** Image base address. */
+    uint64_t base;
+
+    /** Image end address (exclusive). */
+    uint64_t end;
+
+    /** The greatest end address of this and all preceding entries; bounds the search for overlapping images. */
+    uint64_t max_end;
+
+    /** The image's position in the images array; used to order images sharing a base address. */
+    NSUInteger position;
+
+    /** The image record. This is retained by the images array. */
+    PLCrashReportBinaryImageInfo *image;
+};
+
+/**
+ * @internal
+ * Top-level CrashReport field numbers, as defined in crash_report.proto.
+ */
+enum {
+    /** CrashReport.threads */
+    PLCRASH_REPORT_THREADS_ID = 3,
+
+    /** CrashReport.binary_images */
+    PLCRASH_REPORT_BINARY_IMAGES_ID = 4,
+};
+
+/**
+ * @internal
+ * Protobuf wire types.
+ */
+enum {
+    PLCRASH_REPORT_WIRETYPE_VARINT = 0,
+    PLCRASH_REPORT_WIRETYPE_64BIT = 1,
+    PLCRASH_REPORT_WIRETYPE_LENGTH_DELIMITED = 2,
+    PLCRASH_REPORT_WIRETYPE_32BIT = 5,
+};
+
+/** Round @a size up to the arena's 16 byte allocation alignment. */
+#define PLCRASH_REPORT_ARENA_ALIGN(size) (((size) + 15) & ~((size_t) 15))
+
+/* Allocate a new chunk with at least @a size usable bytes, and make it the arena's current chunk. */
+static bool plcrash_report_arena_add_chunk (struct plcrash_report_arena *arena, size_t size) {
+    const size_t header = PLCRASH_REPORT_ARENA_ALIGN(sizeof(struct plcrash_report_arena_chunk));
+    struct plcrash_report_arena_chunk *chunk = malloc(header + size);
+    if (chunk == NULL)
+        return false;
+
+    chunk->next = arena->chunks;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->chunks = chunk;
+    return true;
+}
+
+/* protobuf-c alloc callback */
+static void *plcrash_report_arena_alloc (void *allocator_data, size_t size) {
+    struct plcrash_report_arena *arena = allocator_data;
+    const size_t header = PLCRASH_REPORT_ARENA_ALIGN(sizeof(struct plcrash_report_arena_chunk));
+    struct plcrash_report_arena_chunk *chunk = arena->chunks;
+
+    size = PLCRASH_REPORT_ARENA_ALIGN(size);
+
+    /* Add a new chunk -- at least as large as the previous chunk -- if the current chunk is exhausted */
+    if (chunk->size - chunk->used < size) {
+        if (!plcrash_report_arena_add_chunk(arena, MAX(chunk->size, size)))
+            return NULL;
+        chunk = arena->chunks;
+    }
+
+    void *result = ((uint8_t *) chunk) + header + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+/* protobuf-c free callback; arena memory is only released via plcrash_report_arena_free() */
+static void plcrash_report_arena_dealloc (void *allocator_data, void *pointer) {}
+
+/**
+ * @internal
+ *
+ * Initialize @a arena, reserving an initial chunk sufficient to decode a message of @a message_len bytes without
+ * further allocation in the common case.
+ *
+ * @return Returns true on success, or false if the initial chunk could not be allocated.
+ */
+static bool plcrash_report_arena_init (struct plcrash_report_arena *arena, size_t message_len) {
+    arena->chunks = NULL;
+    arena->allocator.alloc = plcrash_report_arena_alloc;
+    arena->allocator.free = plcrash_report_arena_dealloc;
+    arena->allocator.tmp_alloc = plcrash_report_arena_alloc;
+    arena->allocator.max_alloca = protobuf_c_system_allocator.max_alloca;
+    arena->allocator.allocator_data = arena;
+
+    /* Decoded messages -- with their per-field presence flags, pointers, and array headers -- are typically
+     * several times larger than their encoded form. */
+    size_t size = 4096;
+    if (message_len < (SIZE_MAX - size) / 4)
+        size += message_len * 4;
+
+    return plcrash_report_arena_add_chunk(arena, PLCRASH_REPORT_ARENA_ALIGN(size));
+}
+
+/**
+ * @internal
+ *
+ * Release all memory allocated from @a arena.
+ */
+static void plcrash_report_arena_free (struct plcrash_report_arena *arena) {
+    struct plcrash_report_arena_chunk *next;
+    for (struct plcrash_report_arena_chunk *chunk = arena->chunks; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    arena->chunks = NULL;
+}
+
+/**
+ * @internal
+ *
+ * Allocate a zero-initialized message of type @a descriptor from @a allocator.
+ *
+ * @return Returns the message, or NULL if allocation fails.
+ */
+static void *crash_report_message_new (ProtobufCAllocator *allocator, const ProtobufCMessageDescriptor *descriptor) {
+    ProtobufCMessage *message = allocator->alloc(allocator->allocator_data, descriptor->sizeof_message);
+    if (message == NULL)
+        return NULL;
+
+    memset(message, 0, descriptor->sizeof_message);
+    message->descriptor = descriptor;
+    return message;
+}
+
+/**
+ * @internal
+ *
+ * Return the single architecture register message provided by @a state, or NULL if none (or more than one) is
+ * provided.
+ */
+static const ProtobufCMessage *crash_report_v2_register_message (const Plcrash__CrashReportV2__RegisterState *state) {
+    const ProtobufCMessage *candidates[] = {
+        (const ProtobufCMessage *) state->x86_32,
+        (const ProtobufCMessage *) state->x86_64,
+        (const ProtobufCMessage *) state->arm,
+        (const ProtobufCMessage *) state->arm64
+    };
+    const ProtobufCMessage *result = NULL;
+
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (candidates[i] == NULL)
+            continue;
+
+        if (result != NULL)
+            return NULL;
+        result = candidates[i];
+    }
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Adapt a decoded CrashReportV2 @a v2 thread into an equivalent CrashReport thread, allocated from @a allocator. The
+ * packed frames are referenced in place, and each architecture register field becomes a named register value.
+ *
+ * @return Returns the thread, or NULL if allocation fails or the register state is invalid.
+ */
+static Plcrash__CrashReport__Thread *crash_report_thread_from_v2 (Plcrash__CrashReportV2__Thread *v2, ProtobufCAllocator *allocator) {
+    Plcrash__CrashReport__Thread *thread = crash_report_message_new(allocator, &plcrash__crash_report__thread__descriptor);
+    if (thread == NULL)
+        return NULL;
+
+    thread->thread_number = v2->thread_number;
+    thread->crashed = v2->crashed;
+    thread->has_frame_pcs = v2->has_frame_pcs;
+    thread->frame_pcs = v2->frame_pcs;
+    thread->has_frame_symbols = v2->has_frame_symbols;
+    thread->frame_symbols = v2->frame_symbols;
+
+    if (v2->registers == NULL)
+        return thread;
+
+    const ProtobufCMessage *registers = crash_report_v2_register_message(v2->registers);
+    if (registers == NULL)
+        return NULL;
+
+    /* The descriptor's fields are sorted by field number, and so are visited in register order */
+    const ProtobufCMessageDescriptor *descriptor = registers->descriptor;
+    thread->registers = allocator->alloc(allocator->allocator_data, sizeof(thread->registers[0]) * descriptor->n_fields);
+    if (thread->registers == NULL)
+        return NULL;
+
+    for (unsigned i = 0; i < descriptor->n_fields; i++) {
+        const ProtobufCFieldDescriptor *field = &descriptor->fields[i];
+        Plcrash__CrashReport__Thread__RegisterValue *reg;
+
+        reg = crash_report_message_new(allocator, &plcrash__crash_report__thread__register_value__descriptor);
+        if (reg == NULL)
+            return NULL;
+
+        reg->name = (char *) field->name;
+        reg->value = *(const uint64_t *) ((const uint8_t *) registers + field->offset);
+        thread->registers[thread->n_registers++] = reg;
+    }
+
+    return thread;
+}
+
+/**
+ * @internal
+ *
+ * Adapt the decoded CrashReportV2 message @a v2 into an equivalent CrashReport message, allocated from @a allocator.
+ * All messages shared by the two formats are referenced in place; only the threads and string table are adapted.
+ *
+ * @return Returns the adapted report, or NULL if allocation fails or the report is invalid.
+ */
+static Plcrash__CrashReport *crash_report_from_v2 (Plcrash__CrashReportV2 *v2, ProtobufCAllocator *allocator) {
+    Plcrash__CrashReport *report = crash_report_message_new(allocator, &plcrash__crash_report__descriptor);
+    if (report == NULL)
+        return NULL;
+
+    report->report_info = v2->report_info;
+    report->system_info = v2->system_info;
+    report->machine_info = v2->machine_info;
+    report->application_info = v2->application_info;
+    report->process_info = v2->process_info;
+    report->signal = v2->signal;
+    report->exception = v2->exception;
+    report->n_binary_images = v2->n_binary_images;
+    report->binary_images = v2->binary_images;
+
+    if (v2->n_strings > 0) {
+        report->symbol_strings = crash_report_message_new(allocator, &plcrash__crash_report__string_table__descriptor);
+        if (report->symbol_strings == NULL)
+            return NULL;
+
+        report->symbol_strings->n_strings = v2->n_strings;
+        report->symbol_strings->strings = v2->strings;
+    }
+
+    if (v2->n_threads > 0) {
+        report->threads = allocator->alloc(allocator->allocator_data, sizeof(report->threads[0]) * v2->n_threads);
+        if (report->threads == NULL)
+            return NULL;
+
+        for (size_t i = 0; i < v2->n_threads; i++) {
+            if ((report->threads[i] = crash_report_thread_from_v2(v2->threads[i], allocator)) == NULL)
+                return NULL;
+        }
+        report->n_threads = v2->n_threads;
+    }
+
+    return report;
+}
+
 @interface PLCrashReport (PrivateMethods)
 
-- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data error: (NSError **) outError;
+- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data options: (PLCrashReportDecodingOptions) options error: (NSError **) outError;
+- (NSData *) decompressCrashData: (NSData *) data error: (NSError **) outError;
 - (PLCrashReportSystemInfo *) extractSystemInfo: (Plcrash__CrashReport__SystemInfo *) systemInfo
                                   processorInfo: (PLCrashReportProcessorInfo *) processorInfo
                                           error: (NSError **) outError;
@@ -46,8 +376,31 @@ struct _PLCrashReportDecoder {
 - (PLCrashReportMachineInfo *) extractMachineInfo: (Plcrash__CrashReport__MachineInfo *) machineInfo error: (NSError **) outError;
 - (PLCrashReportApplicationInfo *) extractApplicationInfo: (Plcrash__CrashReport__ApplicationInfo *) applicationInfo error: (NSError **) outError;
 - (PLCrashReportProcessInfo *) extractProcessInfo: (Plcrash__CrashReport__ProcessInfo *) processInfo error: (NSError **) outError;
+- (NSArray *) extractSymbolNames: (Plcrash__CrashReport__StringTable *) stringTable error: (NSError **) outError;
+- (PLCrashReportThreadInfo *) extractThread: (Plcrash__CrashReport__Thread *) thread error: (NSError **) outError;
+- (BOOL) extractPackedFrames: (Plcrash__CrashReport__Thread *) thread count: (size_t) frameCount pcs: (uint64_t *) pcs
+                 symbolNames: (NSString **) symbolNames starts: (uint64_t *) starts error: (NSError **) outError;
+- (BOOL) extractRegisterSymbols: (Plcrash__CrashReport__Thread__RegisterState *) state count: (size_t) registerCount values: (const uint64_t *) regValues
+                    symbolNames: (NSString **) symbolNames starts: (uint64_t *) starts error: (NSError **) outError;
+- (PLCrashReportThreadInfo *) extractThread: (Plcrash__CrashReport__Thread *) thread
+                               writtenThreads: (NSMutableDictionary *) writtenThreads
+                                        error: (NSError **) outError;
 - (NSArray *) extractThreadInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError;
+- (BOOL) extractThreads: (NSArray **) outThreads images: (NSArray **) outImages concurrentlyFromReport: (Plcrash__CrashReport *) crashReport
+                  error: (NSError **) outError;
+- (void) sortThreadInfo: (NSMutableArray *) threads;
+- (NSArray *) extractDeferredThreadInfo: (NSError **) outError;
+- (Plcrash__CrashReport__Thread *) unpackDeferredThread: (NSRange) range arena: (struct plcrash_report_arena *) arena error: (NSError **) outError;
+- (PLCrashReportThreadInfo *) extractDeferredCrashedThread: (NSError **) outError;
+- (PLCrashReportBinaryImageInfo *) extractImage: (Plcrash__CrashReport__BinaryImage *) image error: (NSError **) outError;
 - (NSArray *) extractImageInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError;
+- (NSArray *) extractCompactImageInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError;
+- (NSArray *) extractMemoryRegionInfo: (Plcrash__CrashReport *) crashReport;
+- (NSDictionary *) extractAttachments: (Plcrash__CrashReport *) crashReport;
+- (NSArray *) extractThreadMetadata: (Plcrash__CrashReport *) crashReport;
+- (NSArray *) extractDeferredImageInfo: (NSError **) outError;
+- (void) releaseDeferredData;
+- (struct plcrash_report_image_index_entry *) imageIndexForImages: (NSArray *) images count: (size_t *) outCount;
 - (PLCrashReportExceptionInfo *) extractExceptionInfo: (Plcrash__CrashReport__Exception *) exceptionInfo error: (NSError **) outError;
 - (PLCrashReportSignalInfo *) extractSignalInfo: (Plcrash__CrashReport__Signal *) signalInfo error: (NSError **) outError;
 - (PLCrashReportMachExceptionInfo *) extractMachExceptionInfo: (Plcrash__CrashReport__Signal__MachException *) machExceptionInfo error: (NSError **) outError;
@@ -56,10 +409,17 @@ struct _PLCrashReportDecoder {
 
 
 static void populate_nserror (NSError **error, PLCrashReporterError code, NSString *description);
+static int image_index_entry_compare (const void *a, const void *b);
+static const char * const *register_names_for_cpu_type (uint64_t cpu_type, size_t *count);
+static BOOL read_varint (const uint8_t **cursor, const uint8_t *end, uint64_t *result);
+static size_t complete_crash_report_length (const uint8_t *message, size_t length);
+static BOOL index_crash_report_message (NSData *data, const uint8_t *message, size_t length, NSMutableData *skeleton, NSMutableData *threadRanges, NSMutableData *imageRanges);
 
 /**
  * Provides decoding of crash logs generated by the PLCrashReporter framework.
  *
+ * The objects vended by a report own all of their data, and remain valid after the report itself is released.
+ *
  * @warning This API should be considered in-development and subject to change.
  */
 @implementation PLCrashReport
@@ -73,11 +433,26 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
  * indicating why the crash log could not be parsed. If no error occurs, this parameter
  * will be left unmodified. You may specify NULL for this parameter, and no error information
  * will be provided.
+ */
+- (id) initWithData: (NSData *) encodedData error: (NSError **) outError {
+    return [self initWithData: encodedData options: PLCrashReportDecodingOptionNone error: outError];
+}
+
+/**
+ * Initialize with the provided crash log data and decoding @a options. On error, nil will be returned, and
+ * an NSError instance will be provided via @a error, if non-NULL.
+ *
+ * @param encodedData Encoded plcrash crash log.
+ * @param options Decoding options.
+ * @param outError If an error occurs, this pointer will contain an NSError object
+ * indicating why the crash log could not be parsed. If no error occurs, this parameter
+ * will be left unmodified. You may specify NULL for this parameter, and no error information
+ * will be provided.
  *
  * @par Designated Initializer
  * This method is the designated initializer for the PLCrashReport class.
  */
-- (id) initWithData: (NSData *) encodedData error: (NSError **) outError {
+- (id) initWithData: (NSData *) encodedData options: (PLCrashReportDecodingOptions) options error: (NSError **) outError {
     if ((self = [super init]) == nil) {
         // This shouldn't happen, but we have to fufill our API contract
         populate_nserror(outError, PLCrashReporterErrorUnknown, @"Could not initialize superclass");
@@ -87,13 +462,29 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
 
     /* Allocate the struct and attempt to parse */
     _decoder = malloc(sizeof(_PLCrashReportDecoder));
-    _decoder->crashReport = [self decodeCrashData: encodedData error: outError];
+    _decoder->symbolNames = nil;
+    _decoder->lazyData = nil;
+    _decoder->threadRanges = nil;
+    _decoder->imageRanges = nil;
+    _decoder->crashedThread = nil;
+    _decoder->imageIndex = NULL;
+    _decoder->imageIndexCount = 0;
+    _decoder->sortedImages = nil;
+    _decoder->arena = NULL;
+    _decoder->truncated = NO;
+    _decoder->crashReport = [self decodeCrashData: encodedData options: options error: outError];
 
     /* Check if decoding failed. If so, outError has already been populated. */
     if (_decoder->crashReport == NULL) {
         goto error;
     }
 
+    /* Shared image list reference (optional) */
+    if (_decoder->crashReport->shared_image_list != NULL && _decoder->crashReport->shared_image_list->session_id.len != sizeof(uuid_t)) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Shared image list session identifier is not a standard 16 bytes");
+        goto error;
+    }
+
     /* Report info (optional) */
     _uuid = NULL;
     if (_decoder->crashReport->report_info != NULL) {
@@ -149,72 +540,727 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
             goto error;
     }
 
-    /* Thread info */
-    _threads = [[self extractThreadInfo: _decoder->crashReport error: outError] retain];
-    if (!_threads)
-        goto error;
+    /* Symbol string table (optional). This must be extracted prior to any stack frames. */
+    if (_decoder->crashReport->symbol_strings != NULL) {
+        _decoder->symbolNames = [[self extractSymbolNames: _decoder->crashReport->symbol_strings error: outError] retain];
+        if (!_decoder->symbolNames)
+            goto error;
+    }
+
+    if (_decoder->lazyData != nil) {
+        /* Thread and image records are decoded on first access; we only verify that they are present. */
+        if ([_decoder->threadRanges length] == 0) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report is missing thread state information",
+                                               @"Missing thread info in crash report"));
+            goto error;
+        }
+
+        if ([_decoder->imageRanges length] == 0 && _decoder->crashReport->n_compact_binary_images == 0 &&
+            _decoder->crashReport->shared_image_list == NULL)
+        {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report is missing binary image information",
+                                               @"Missing image info in crash report"));
+            goto error;
+        }
+    } else if (options & PLCrashReportDecodingOptionConcurrent) {
+        /* Thread and image info, built concurrently */
+        NSArray *threads;
+        NSArray *images;
+        if (![self extractThreads: &threads images: &images concurrentlyFromReport: _decoder->crashReport error: outError])
+            goto error;
+
+        _threads = [threads retain];
+        _images = [images retain];
+    } else {
+        /* Thread info */
+        _threads = [[self extractThreadInfo: _decoder->crashReport error: outError] retain];
+        if (!_threads)
+            goto error;
+
+        /* Image info */
+        _images = [[self extractImageInfo: _decoder->crashReport error: outError] retain];
+        if (!_images)
+            goto error;
+    }
+
+    /* Compact image info */
+    _compactImages = [[self extractCompactImageInfo: _decoder->crashReport error: outError] retain];
+    if (!_compactImages)
+        goto error;
+
+    /* Exception info, if it is available */
+    if (_decoder->crashReport->exception != NULL) {
+        _exceptionInfo = [[self extractExceptionInfo: _decoder->crashReport->exception error: outError] retain];
+        if (!_exceptionInfo)
+            goto error;
+    }
+
+    /* Breadcrumbs. An invalid ring is not fatal, as the breadcrumbs are supplementary to the report. */
+    if (_decoder->crashReport->has_breadcrumbs) {
+        NSData *ringData = [NSData dataWithBytesNoCopy: _decoder->crashReport->breadcrumbs.data
+                                                length: _decoder->crashReport->breadcrumbs.len
+                                          freeWhenDone: NO];
+        _breadcrumbs = [[PLCrashReportBreadcrumbInfo breadcrumbsWithRingData: ringData] retain];
+    }
+
+    if (_breadcrumbs == nil)
+        _breadcrumbs = [[NSArray alloc] init];
+
+    /* Captured memory regions */
+    _memoryRegions = [[self extractMemoryRegionInfo: _decoder->crashReport] retain];
+
+    /* Attachments */
+    _attachments = [[self extractAttachments: _decoder->crashReport] retain];
+
+    /* Thread metadata */
+    _threadMetadata = [[self extractThreadMetadata: _decoder->crashReport] retain];
+
+    /* Buffered debug output. The buffer may have been truncated mid-character, so the output is decoded leniently. */
+    if (_decoder->crashReport->has_debug_log) {
+        _debugLog = [[NSString alloc] initWithBytes: _decoder->crashReport->debug_log.data
+                                             length: _decoder->crashReport->debug_log.len
+                                           encoding: NSISOLatin1StringEncoding];
+    }
+
+    return self;
+
+error:
+    [self release];
+    return nil;
+}
+
+/**
+ * Initialize with the crash log at @a path. On error, nil will be returned, and an NSError instance will be
+ * provided via @a error, if non-NULL.
+ *
+ * The file is memory-mapped where safe to do so, and decoded directly from the mapping; when combined with
+ * PLCrashReportDecodingOptionLazy, only the accessed portions of the report will be paged in.
+ *
+ * @param path Path to an encoded plcrash crash log.
+ * @param options Decoding options.
+ * @param outError If an error occurs, this pointer will contain an NSError object
+ * indicating why the crash log could not be read or parsed. If no error occurs, this parameter
+ * will be left unmodified. You may specify NULL for this parameter, and no error information
+ * will be provided.
+ */
+- (id) initWithContentsOfFile: (NSString *) path options: (PLCrashReportDecodingOptions) options error: (NSError **) outError {
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: outError];
+    if (data == nil) {
+        [self release];
+        return nil;
+    }
+
+    return [self initWithData: data options: options error: outError];
+}
+
+- (void) dealloc {
+    /* Free the data objects */
+    [_systemInfo release];
+    [_machineInfo release];
+    [_applicationInfo release];
+    [_processInfo release];
+    [_signalInfo release];
+    [_machExceptionInfo release];
+    [_threads release];
+    [_images release];
+    [_compactImages release];
+    [_exceptionInfo release];
+    [_breadcrumbs release];
+    [_memoryRegions release];
+    [_attachments release];
+    [_threadMetadata release];
+    [_debugLog release];
+    
+    if (_uuid != NULL)
+        CFRelease(_uuid);
+
+    /* Free the decoder state */
+    if (_decoder != NULL) {
+        /* The decoded message is released along with its arena */
+        if (_decoder->arena != NULL) {
+            plcrash_report_arena_free(_decoder->arena);
+            free(_decoder->arena);
+        }
+
+        [_decoder->symbolNames release];
+        [_decoder->crashedThread release];
+        [self releaseDeferredData];
+
+        if (_decoder->imageIndex != NULL)
+            free(_decoder->imageIndex);
+        [_decoder->sortedImages release];
+
+        free(_decoder);
+        _decoder = NULL;
+    }
+
+    [super dealloc];
+}
+
+/**
+ * Return the binary image containing the given address, or nil if no binary image
+ * is found.
+ *
+ * @param address The address to search for.
+ */
+- (PLCrashReportBinaryImageInfo *) imageForAddress: (uint64_t) address {
+    struct plcrash_report_image_index_entry *index;
+    size_t count;
+
+    NSArray *images = self.images;
+    @synchronized (self) {
+        index = [self imageIndexForImages: images count: &count];
+        if (index == NULL)
+            return nil;
+    }
+
+    /* Find the first entry with a base address greater than the target address */
+    size_t lower = 0;
+    size_t upper = count;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (index[mid].base <= address)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    /* Images are not expected to overlap; should they, the nearest preceding image that contains the address wins. The
+     * running maximum end address terminates the scan as soon as no earlier image could contain the address. */
+    while (lower > 0 && address < index[lower - 1].max_end) {
+        lower--;
+        if (address < index[lower].end)
+            return index[lower].image;
+    }
+
+    /* Not found */
+    return nil;
+}
+
+// property getter. Decodes the thread list on first access if decoding was deferred.
+- (NSArray *) threads {
+    @synchronized (self) {
+        if (_threads == nil && _decoder->threadRanges != nil) {
+            _threads = [[self extractDeferredThreadInfo: NULL] retain];
+
+            /* Decoding is not retried on failure */
+            [_decoder->threadRanges release];
+            _decoder->threadRanges = nil;
+
+            if (_decoder->imageRanges == nil)
+                [self releaseDeferredData];
+        }
+
+        return _threads;
+    }
+}
+
+// property getter. Decodes only the crashed thread's record if decoding was deferred.
+- (PLCrashReportThreadInfo *) crashedThread {
+    @synchronized (self) {
+        if (_threads == nil && _decoder->threadRanges != nil) {
+            if (_decoder->crashedThread == nil)
+                _decoder->crashedThread = [[self extractDeferredCrashedThread: NULL] retain];
+
+            return _decoder->crashedThread;
+        }
+    }
+
+    for (PLCrashReportThreadInfo *threadInfo in self.threads) {
+        if (threadInfo.crashed)
+            return threadInfo;
+    }
+
+    return nil;
+}
+
+// property getter. Decodes the image list on first access if decoding was deferred.
+- (NSArray *) images {
+    @synchronized (self) {
+        if (_images == nil && _decoder->imageRanges != nil) {
+            _images = [[self extractDeferredImageInfo: NULL] retain];
+
+            /* Decoding is not retried on failure */
+            [_decoder->imageRanges release];
+            _decoder->imageRanges = nil;
+
+            if (_decoder->threadRanges == nil)
+                [self releaseDeferredData];
+        }
+
+        return _images;
+    }
+}
+
+// property getter. Built from the address index on first access.
+- (NSArray *) sortedImages {
+    NSArray *images = self.images;
+    @synchronized (self) {
+        if (_decoder->sortedImages == nil) {
+            size_t count;
+            struct plcrash_report_image_index_entry *index = [self imageIndexForImages: images count: &count];
+            if (index == NULL && [images count] > 0)
+                return nil;
+
+            NSMutableArray *sorted = [NSMutableArray arrayWithCapacity: count];
+            for (size_t i = 0; i < count; i++)
+                [sorted addObject: index[i].image];
+
+            _decoder->sortedImages = [sorted copy];
+        }
+
+        return [[_decoder->sortedImages retain] autorelease];
+    }
+}
+
+/**
+ * Compress the encoded crash report @a data with the streaming compressor used by PLCrashReporterConfig::shouldCompressReports.
+ * The compressed report may be decoded directly by PLCrashReport::initWithData:error:. If @a data is already
+ * compressed, it is returned unmodified.
+ *
+ * @param data The encoded crash report data.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be compressed. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the compressed report data, or nil on error.
+ */
++ (NSData *) compressedDataWithReportData: (NSData *) data error: (NSError **) outError {
+    if (plcrash_async_compressed_is_compressed([data bytes], [data length]))
+        return data;
+
+    /* Compress into a memory buffer sized for the worst case, in which every block is stored uncompressed */
+    size_t blocks = [data length] / PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE + 1;
+    size_t capacity = sizeof(plcrash_async_compressed_header_t) + (blocks + 1) * sizeof(plcrash_async_compressed_block_t) +
+                      blocks * PLCRASH_ASYNC_LZ_COMPRESS_BOUND(PLCRASH_ASYNC_COMPRESSED_BLOCK_SIZE);
+
+    NSMutableData *output = [NSMutableData dataWithLength: capacity];
+    plcrash_async_allocator_t *allocator = NULL;
+    plcrash_async_compressor_t *compressor = NULL;
+    plcrash_async_file_t file;
+    NSData *result = nil;
+
+    if (plcrash_async_allocator_create(&allocator, PAGE_SIZE) != PLCRASH_ESUCCESS ||
+        plcrash_nasync_compressor_new(&compressor, allocator) != PLCRASH_ESUCCESS)
+    {
+        populate_nserror(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the crash report compressor");
+        goto cleanup;
+    }
+
+    plcrash_async_file_init_memory(&file, [output mutableBytes], capacity);
+    plcrash_async_file_set_compressor(&file, compressor);
+    if (!plcrash_async_file_write(&file, [data bytes], [data length]) || !plcrash_async_file_flush(&file) || !plcrash_async_file_close(&file)) {
+        populate_nserror(outError, PLCrashReporterErrorUnknown, @"Failed to compress the crash report");
+        goto cleanup;
+    }
+
+    [output setLength: (NSUInteger) plcrash_async_file_position(&file)];
+    result = output;
+
+cleanup:
+    if (compressor != NULL)
+        plcrash_nasync_compressor_free(compressor);
+    if (allocator != NULL)
+        plcrash_async_allocator_free(allocator);
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Append @a value to @a data as a varint.
+ */
+static void append_varint (NSMutableData *data, uint64_t value) {
+    uint8_t encoded[10];
+    size_t len = 0;
+
+    do {
+        encoded[len] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            encoded[len] |= 0x80;
+        len++;
+    } while (value != 0);
+
+    [data appendBytes: encoded length: len];
+}
+
+/**
+ * @internal
+ *
+ * Return the index of @a name within the version 2 string table @a strings, appending it if not already present.
+ */
+static NSUInteger v2_string_index (NSMutableArray *strings, NSMutableDictionary *indices, NSString *name) {
+    NSNumber *index = [indices objectForKey: name];
+    if (index != nil)
+        return [index unsignedIntegerValue];
+
+    [strings addObject: name];
+    [indices setObject: [NSNumber numberWithUnsignedInteger: [strings count] - 1] forKey: name];
+    return [strings count] - 1;
+}
+
+/**
+ * @internal
+ *
+ * Encode @a registers as a version 2 register state, allocated from @a allocator. The architecture is selected as
+ * the first whose register message defines every named register.
+ *
+ * @return Returns the register state, or NULL if no architecture matches or allocation fails.
+ */
+static Plcrash__CrashReportV2__RegisterState *v2_register_state (NSArray *registers, ProtobufCAllocator *allocator) {
+    const ProtobufCMessageDescriptor *descriptors[] = {
+        &plcrash__crash_report_v2__register_state__intel32__descriptor,
+        &plcrash__crash_report_v2__register_state__intel64__descriptor,
+        &plcrash__crash_report_v2__register_state__arm32__descriptor,
+        &plcrash__crash_report_v2__register_state__arm64__descriptor
+    };
+
+    for (size_t i = 0; i < sizeof(descriptors) / sizeof(descriptors[0]); i++) {
+        BOOL matches = YES;
+        for (PLCrashReportRegisterInfo *reg in registers) {
+            if (protobuf_c_message_descriptor_get_field_by_name(descriptors[i], [reg.registerName UTF8String]) == NULL) {
+                matches = NO;
+                break;
+            }
+        }
+
+        if (!matches)
+            continue;
+
+        Plcrash__CrashReportV2__RegisterState *state = crash_report_message_new(allocator, &plcrash__crash_report_v2__register_state__descriptor);
+        uint8_t *message = crash_report_message_new(allocator, descriptors[i]);
+        if (state == NULL || message == NULL)
+            return NULL;
+
+        for (PLCrashReportRegisterInfo *reg in registers) {
+            const ProtobufCFieldDescriptor *field = protobuf_c_message_descriptor_get_field_by_name(descriptors[i], [reg.registerName UTF8String]);
+            *(uint64_t *) (message + field->offset) = reg.registerValue;
+        }
+
+        switch (i) {
+            case 0:
+                state->x86_32 = (Plcrash__CrashReportV2__RegisterState__Intel32 *) message;
+                break;
+            case 1:
+                state->x86_64 = (Plcrash__CrashReportV2__RegisterState__Intel64 *) message;
+                break;
+            case 2:
+                state->arm = (Plcrash__CrashReportV2__RegisterState__Arm32 *) message;
+                break;
+            case 3:
+                state->arm64 = (Plcrash__CrashReportV2__RegisterState__Arm64 *) message;
+                break;
+        }
+
+        return state;
+    }
+
+    return NULL;
+}
+
+/**
+ * Convert the encoded crash report @a data to the opt-in version 2 report format (#PLCRASH_REPORT_FILE_VERSION_V2).
+ * The converted report may be decoded directly by PLCrashReport::initWithData:error:, and is not compressed.
+ *
+ * Only the messages defined by the version 2 format are converted. Compact binary image records and shared image list
+ * references have no version 2 equivalent; the binary images of a report written with either are incomplete.
+ *
+ * @param data The encoded crash report data.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be converted. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the version 2 report data, or nil on error.
+ */
++ (NSData *) v2DataWithReportData: (NSData *) data error: (NSError **) outError {
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: outError] autorelease];
+    if (report == nil)
+        return nil;
+
+    Plcrash__CrashReport *v1 = report->_decoder->crashReport;
+    NSArray *threads = report.threads;
+    NSMutableArray *strings = [NSMutableArray array];
+    NSMutableDictionary *indices = [NSMutableDictionary dictionary];
+    NSMutableArray *buffers = [NSMutableArray array];
+    struct plcrash_report_arena arena;
+    NSMutableData *result = nil;
+
+    if (!plcrash_report_arena_init(&arena, [data length])) {
+        populate_nserror(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the crash report converter");
+        return nil;
+    }
+
+    /* The exception's symbols may reference the version 1 string table by index; it is carried over unchanged */
+    if (v1->symbol_strings != NULL) {
+        for (size_t i = 0; i < v1->symbol_strings->n_strings; i++)
+            v2_string_index(strings, indices, [NSString stringWithUTF8String: v1->symbol_strings->strings[i]]);
+    }
+
+    Plcrash__CrashReportV2 *v2 = crash_report_message_new(&arena.allocator, &plcrash__crash_report_v2__descriptor);
+    Plcrash__CrashReportV2__Thread **v2threads = arena.allocator.alloc(arena.allocator.allocator_data, sizeof(v2threads[0]) * ([threads count] + 1));
+    if (v2 == NULL || v2threads == NULL)
+        goto enomem;
+
+    v2->report_info = v1->report_info;
+    v2->system_info = v1->system_info;
+    v2->machine_info = v1->machine_info;
+    v2->application_info = v1->application_info;
+    v2->process_info = v1->process_info;
+    v2->signal = v1->signal;
+    v2->exception = v1->exception;
+    v2->n_binary_images = v1->n_binary_images;
+    v2->binary_images = v1->binary_images;
+    v2->threads = v2threads;
+
+    /* Threads, with the crashed thread first */
+    NSMutableArray *ordered = [NSMutableArray arrayWithArray: threads];
+    for (PLCrashReportThreadInfo *thread in threads) {
+        if (thread.crashed) {
+            [ordered removeObjectIdenticalTo: thread];
+            [ordered insertObject: thread atIndex: 0];
+            break;
+        }
+    }
+
+    for (PLCrashReportThreadInfo *thread in ordered) {
+        Plcrash__CrashReportV2__Thread *v2thread = crash_report_message_new(&arena.allocator, &plcrash__crash_report_v2__thread__descriptor);
+        if (v2thread == NULL)
+            goto enomem;
+
+        v2thread->thread_number = (uint32_t) thread.threadNumber;
+        v2thread->crashed = thread.crashed;
+
+        if ([thread.registers count] > 0 && (v2thread->registers = v2_register_state(thread.registers, &arena.allocator)) == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Thread registers have no version 2 equivalent");
+            goto cleanup;
+        }
+
+        NSMutableData *pcs = [NSMutableData data];
+        NSMutableData *symbols = [NSMutableData data];
+        BOOL has_symbols = NO;
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+            append_varint(pcs, frame.instructionPointer);
+
+            PLCrashReportSymbolInfo *symbol = frame.symbolInfo;
+            if (symbol != nil && symbol.startAddress <= frame.instructionPointer) {
+                append_varint(symbols, v2_string_index(strings, indices, symbol.symbolName) + 1);
+                append_varint(symbols, frame.instructionPointer - symbol.startAddress);
+                has_symbols = YES;
+            } else {
+                append_varint(symbols, 0);
+                append_varint(symbols, 0);
+            }
+        }
+
+        if ([pcs length] > 0) {
+            v2thread->has_frame_pcs = 1;
+            v2thread->frame_pcs.len = [pcs length];
+            v2thread->frame_pcs.data = [pcs mutableBytes];
+            [buffers addObject: pcs];
+        }
+
+        if (has_symbols) {
+            v2thread->has_frame_symbols = 1;
+            v2thread->frame_symbols.len = [symbols length];
+            v2thread->frame_symbols.data = [symbols mutableBytes];
+            [buffers addObject: symbols];
+        }
+
+        v2->threads[v2->n_threads++] = v2thread;
+    }
+
+    /* The string table */
+    if ([strings count] > 0) {
+        if ((v2->strings = arena.allocator.alloc(arena.allocator.allocator_data, sizeof(v2->strings[0]) * [strings count])) == NULL)
+            goto enomem;
+
+        for (NSString *string in strings)
+            v2->strings[v2->n_strings++] = (char *) [string UTF8String];
+    }
+
+    /* Encode the file header and report */
+    {
+        uint8_t version = PLCRASH_REPORT_FILE_VERSION_V2;
+        size_t size = protobuf_c_message_get_packed_size((ProtobufCMessage *) v2);
+
+        result = [NSMutableData dataWithCapacity: sizeof(struct PLCrashReportFileHeader) + size];
+        [result appendBytes: PLCRASH_REPORT_FILE_MAGIC length: strlen(PLCRASH_REPORT_FILE_MAGIC)];
+        [result appendBytes: &version length: sizeof(version)];
+        [result setLength: sizeof(struct PLCrashReportFileHeader) + size];
+        protobuf_c_message_pack((ProtobufCMessage *) v2, (uint8_t *) [result mutableBytes] + sizeof(struct PLCrashReportFileHeader));
+    }
+    goto cleanup;
+
+enomem:
+    populate_nserror(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the converted crash report");
+
+cleanup:
+    plcrash_report_arena_free(&arena);
+    return result;
+}
+
+/**
+ * Return the file name under which the shared image list with the given session identifier and generation is
+ * stored. Image lists written by PLCrashReporter are stored under this name; the name is stable, allowing image lists
+ * to be located by other tools.
+ *
+ * @param sessionID The 16-byte session identifier of the image list.
+ * @param generation The image list generation.
+ */
++ (NSString *) sharedImageListFileNameForSessionID: (NSData *) sessionID generation: (uint32_t) generation {
+    CFUUIDBytes bytes;
+    NSParameterAssert([sessionID length] == sizeof(bytes));
+    memcpy(&bytes, [sessionID bytes], sizeof(bytes));
+
+    CFUUIDRef uuid = CFUUIDCreateFromUUIDBytes(NULL, bytes);
+    NSString *uuidString = [(NSString *) CFUUIDCreateString(NULL, uuid) autorelease];
+    CFRelease(uuid);
+
+    return [NSString stringWithFormat: @"%@-%u.plimages", uuidString, (unsigned int) generation];
+}
+
+// property getter. Returns YES if the report's images are provided by a shared image list.
+- (BOOL) hasSharedImageList {
+    return _decoder->crashReport->shared_image_list != NULL;
+}
+
+// property getter. Returns the file name of the referenced shared image list, if any.
+- (NSString *) sharedImageListFileName {
+    Plcrash__CrashReport__SharedImageList *ref = _decoder->crashReport->shared_image_list;
+    if (ref == NULL)
+        return nil;
+
+    NSData *sessionID = [NSData dataWithBytes: ref->session_id.data length: ref->session_id.len];
+    return [PLCrashReport sharedImageListFileNameForSessionID: sessionID generation: ref->generation];
+}
+
+// property getter. Returns the number of consecutive launch crashes, if any.
+- (NSUInteger) launchCrashCount {
+    if (_decoder->crashReport->crash_loop == NULL)
+        return 0;
+
+    return _decoder->crashReport->crash_loop->launch_crash_count;
+}
+
+// property getter. Returns the crashed thread's stack hash, if any.
+- (uint64_t) stackHash {
+    if (_decoder->crashReport->crash_loop == NULL)
+        return 0;
+
+    return _decoder->crashReport->crash_loop->stack_hash;
+}
+
+// property getter. Returns YES if the report was reduced while crash looping.
+- (BOOL) isReducedReport {
+    if (_decoder->crashReport->crash_loop == NULL)
+        return NO;
+
+    return _decoder->crashReport->crash_loop->reduced;
+}
+
+/**
+ * Resolve the report's binary images from the shared image list referenced by the report. Once resolved, the
+ * image list's images are provided via images and imageForAddress:.
+ *
+ * @param data The contents of the image list file named by sharedImageListFileName.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the image list could not be resolved. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the report does not reference a shared image list, or @a data is not a
+ * valid image list for the session and generation referenced by the report.
+ */
+- (BOOL) resolveSharedImageListWithData: (NSData *) data error: (NSError **) outError {
+    Plcrash__CrashReport__SharedImageList *ref = _decoder->crashReport->shared_image_list;
+    const struct PLCrashReportFileHeader *header = [data bytes];
+
+    if (ref == NULL) {
+        populate_nserror(outError, PLCRashReporterErrorNotFound, @"The crash report does not reference a shared image list");
+        return NO;
+    }
+
+    /* Validate the header */
+    if ([data length] <= sizeof(struct PLCrashReportFileHeader) ||
+        memcmp(header->magic, PLCRASH_IMAGE_LIST_FILE_MAGIC, strlen(PLCRASH_IMAGE_LIST_FILE_MAGIC)) != 0)
+    {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode invalid image list header",
+                                                                                             @"Image list decoding error message"));
+        return NO;
+    }
+
+    if (header->version != PLCRASH_IMAGE_LIST_FILE_VERSION) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, [NSString stringWithFormat: NSLocalizedString(@"Could not decode unsupported image list version: %d",
+                                                                                                                         @"Image list decoding error message"), header->version]);
+        return NO;
+    }
 
-    /* Image info */
-    _images = [[self extractImageInfo: _decoder->crashReport error: outError] retain];
-    if (!_images)
-        goto error;
+    /* Decode the image list */
+    size_t message_len = [data length] - sizeof(struct PLCrashReportFileHeader);
+    struct plcrash_report_arena arena;
+    if (!plcrash_report_arena_init(&arena, message_len)) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not allocate memory to decode the image list",
+                                                                                             @"Image list decoding error message"));
+        return NO;
+    }
 
-    /* Exception info, if it is available */
-    if (_decoder->crashReport->exception != NULL) {
-        _exceptionInfo = [[self extractExceptionInfo: _decoder->crashReport->exception error: outError] retain];
-        if (!_exceptionInfo)
-            goto error;
+    Plcrash__ImageList *imageList = plcrash__image_list__unpack(&arena.allocator, message_len, header->data);
+    if (imageList == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"An unknown error occured decoding the image list",
+                                                                                             @"Image list decoding error message"));
+        plcrash_report_arena_free(&arena);
+        return NO;
     }
 
-    return self;
+    /* Verify that this is the image list referenced by the report */
+    if (imageList->session_id.len != ref->session_id.len || memcmp(imageList->session_id.data, ref->session_id.data, ref->session_id.len) != 0 ||
+        imageList->generation != ref->generation)
+    {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"The image list does not match the crash report's shared image list",
+                                                                                             @"Image list decoding error message"));
+        plcrash_report_arena_free(&arena);
+        return NO;
+    }
 
-error:
-    [self release];
-    return nil;
-}
+    NSMutableArray *images = [NSMutableArray arrayWithCapacity: imageList->n_images];
+    for (size_t i = 0; i < imageList->n_images; i++) {
+        PLCrashReportBinaryImageInfo *imageInfo = [self extractImage: imageList->images[i] error: outError];
+        if (imageInfo == nil) {
+            plcrash_report_arena_free(&arena);
+            return NO;
+        }
 
-- (void) dealloc {
-    /* Free the data objects */
-    [_systemInfo release];
-    [_machineInfo release];
-    [_applicationInfo release];
-    [_processInfo release];
-    [_signalInfo release];
-    [_machExceptionInfo release];
-    [_threads release];
-    [_images release];
-    [_exceptionInfo release];
-    
-    if (_uuid != NULL)
-        CFRelease(_uuid);
+        [images addObject: imageInfo];
+    }
+    plcrash_report_arena_free(&arena);
 
-    /* Free the decoder state */
-    if (_decoder != NULL) {
-        if (_decoder->crashReport != NULL) {
-            protobuf_c_message_free_unpacked((ProtobufCMessage *) _decoder->crashReport, &protobuf_c_system_allocator);
+    /* Replace the (empty) image list, and discard any address index built from it */
+    @synchronized (self) {
+        [_images release];
+        _images = [images retain];
+
+        if (_decoder->imageIndex != NULL) {
+            free(_decoder->imageIndex);
+            _decoder->imageIndex = NULL;
+            _decoder->imageIndexCount = 0;
         }
 
-        free(_decoder);
-        _decoder = NULL;
-    }
+        [_decoder->sortedImages release];
+        _decoder->sortedImages = nil;
 
-    [super dealloc];
-}
+        if (_decoder->imageRanges != nil) {
+            [_decoder->imageRanges release];
+            _decoder->imageRanges = nil;
 
-/**
- * Return the binary image containing the given address, or nil if no binary image
- * is found.
- *
- * @param address The address to search for.
- */
-- (PLCrashReportBinaryImageInfo *) imageForAddress: (uint64_t) address {
-    for (PLCrashReportBinaryImageInfo *imageInfo in self.images) {
-        if (imageInfo.imageBaseAddress <= address && address < (imageInfo.imageBaseAddress + imageInfo.imageSize))
-            return imageInfo;
+            if (_decoder->threadRanges == nil)
+                [self releaseDeferredData];
+        }
     }
 
-    /* Not found */
-    return nil;
+    return YES;
 }
 
 // property getter. Returns YES if machine information is available.
@@ -225,6 +1271,10 @@ error:
 }
 
 // property getter. Returns YES if process information is available.
+- (BOOL) truncated {
+    return _decoder->truncated;
+}
+
 - (BOOL) hasProcessInfo {
     if (_processInfo != nil)
         return YES;
@@ -244,9 +1294,13 @@ error:
 @synthesize processInfo = _processInfo;
 @synthesize signalInfo = _signalInfo;
 @synthesize machExceptionInfo = _machExceptionInfo;
-@synthesize threads = _threads;
-@synthesize images = _images;
 @synthesize exceptionInfo = _exceptionInfo;
+@synthesize compactImages = _compactImages;
+@synthesize breadcrumbs = _breadcrumbs;
+@synthesize memoryRegions = _memoryRegions;
+@synthesize debugLog = _debugLog;
+@synthesize attachments = _attachments;
+@synthesize threadMetadata = _threadMetadata;
 @synthesize uuidRef = _uuid;
 
 @end
@@ -259,14 +1313,111 @@ error:
 @implementation PLCrashReport (PrivateMethods)
 
 /**
- * Decode the crash log message.
+ * Return the binary image address index for @a images, building it on first use. The caller must hold the
+ * receiver's lock.
+ *
+ * @param images The receiver's current images.
+ * @param outCount On return, the number of index entries.
+ *
+ * @return Returns the index, or NULL if @a images is empty or the index could not be allocated.
+ */
+- (struct plcrash_report_image_index_entry *) imageIndexForImages: (NSArray *) images count: (size_t *) outCount {
+    if (_decoder->imageIndex == NULL && [images count] > 0) {
+        struct plcrash_report_image_index_entry *index = malloc(sizeof(*index) * [images count]);
+        if (index == NULL) {
+            *outCount = 0;
+            return NULL;
+        }
+
+        size_t count = 0;
+        for (PLCrashReportBinaryImageInfo *imageInfo in images) {
+            index[count].base = imageInfo.imageBaseAddress;
+            index[count].end = imageInfo.imageBaseAddress + imageInfo.imageSize;
+            index[count].position = count;
+            index[count].image = imageInfo;
+            count++;
+        }
+
+        qsort(index, count, sizeof(*index), image_index_entry_compare);
+        for (size_t i = 0; i < count; i++)
+            index[i].max_end = (i == 0) ? index[i].end : MAX(index[i].end, index[i - 1].max_end);
+
+        _decoder->imageIndex = index;
+        _decoder->imageIndexCount = count;
+    }
+
+    *outCount = _decoder->imageIndexCount;
+    return _decoder->imageIndex;
+}
+
+/**
+ * Decompress a compressed crash log, returning the uncompressed report data. Returns nil on error.
+ */
+- (NSData *) decompressCrashData: (NSData *) data error: (NSError **) outError {
+    plcrash_error_t err;
+    size_t length;
+
+    if ((err = plcrash_async_compressed_decoded_length([data bytes], [data length], &length)) != PLCRASH_ESUCCESS) {
+        if (err == PLCRASH_ENOTSUP) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode unsupported compressed crash log version",
+                                                                                                 @"Crash log decoding error message"));
+        } else {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode truncated or corrupt compressed crash log",
+                                                                                                 @"Crash log decoding error message"));
+        }
+        return nil;
+    }
+
+    NSMutableData *decoded = [NSMutableData dataWithLength: length];
+    if ((err = plcrash_async_compressed_decode([data bytes], [data length], [decoded mutableBytes], length, &length)) != PLCRASH_ESUCCESS) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode truncated or corrupt compressed crash log",
+                                                                                             @"Crash log decoding error message"));
+        return nil;
+    }
+
+    return decoded;
+}
+
+/**
+ * Decode the crash log message. Checksummed crash logs are verified, and compressed crash logs are transparently
+ * decompressed.
+ *
+ * If PLCrashReportDecodingOptionLazy is set in @a options, the thread and binary image records are not decoded;
+ * their locations are instead recorded in the decoder state, and the returned message will contain no threads or
+ * binary images.
  *
- * @warning MEMORY WARNING. The caller is responsible for deallocating th ePlcrash__CrashReport instance
- * returned by this method via protobuf_c_message_free_unpacked().
+ * Version 2 reports are adapted to an equivalent CrashReport message via crash_report_from_v2(), and are never
+ * decoded lazily.
+ *
+ * The returned message is allocated from an arena recorded in the decoder state, and is released along with
+ * the decoder.
  */
-- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data error: (NSError **) outError {
+- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data options: (PLCrashReportDecodingOptions) options error: (NSError **) outError {
     const struct PLCrashReportFileHeader *header;
     const void *bytes;
+    size_t content_length;
+
+    /* Verify and strip the checksum trailer, if any. This is done in a single pass over the stored bytes, prior to
+     * decompressing or decoding any of the report. */
+    switch (plcrash_async_checksum_trailer_verify([data bytes], [data length], &content_length)) {
+        case PLCRASH_ESUCCESS:
+            data = [data subdataWithRange: NSMakeRange(0, content_length)];
+            break;
+
+        case PLCRASH_ENOTFOUND:
+            break;
+
+        default:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode corrupt crash log (checksum mismatch)",
+                                                                                                 @"Crash log decoding error message"));
+            return NULL;
+    }
+
+    /* Decompress the report, if necessary */
+    if (plcrash_async_compressed_is_compressed([data bytes], [data length])) {
+        if ((data = [self decompressCrashData: data error: outError]) == nil)
+            return NULL;
+    }
 
     bytes = [data bytes];
     header = bytes;
@@ -286,13 +1437,65 @@ error:
     }
 
     /* Check the version */
-    if(header->version != PLCRASH_REPORT_FILE_VERSION) {
+    if(header->version != PLCRASH_REPORT_FILE_VERSION && header->version != PLCRASH_REPORT_FILE_VERSION_V2) {
         populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, [NSString stringWithFormat: NSLocalizedString(@"Could not decode unsupported crash report version: %d", 
                                                                                                                          @"Crash log decoding message"), header->version]);
         return NULL;
     }
 
-    Plcrash__CrashReport *crashReport = plcrash__crash_report__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    const uint8_t *message = header->data;
+    size_t message_len = [data length] - sizeof(struct PLCrashReportFileHeader);
+
+    /* If the writer was interrupted, the report will end with an incomplete message; discard it, and decode the complete
+     * messages that precede it. */
+    size_t complete_len = complete_crash_report_length(message, message_len);
+    if (complete_len != message_len) {
+        _decoder->truncated = YES;
+        message_len = complete_len;
+    }
+
+    /* If decoding of the thread and image records is deferred, split them out of the message, indexing them by their
+     * location within the report data. The remainder of the message is decoded immediately. Version 2 reports are
+     * always decoded in full. */
+    if ((options & PLCrashReportDecodingOptionLazy) && header->version == PLCRASH_REPORT_FILE_VERSION) {
+        NSMutableData *skeleton = [NSMutableData data];
+        NSMutableData *threadRanges = [NSMutableData data];
+        NSMutableData *imageRanges = [NSMutableData data];
+
+        if (!index_crash_report_message(data, message, message_len, skeleton, threadRanges, imageRanges)) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode truncated or corrupt crash log",
+                                                                                                 @"Crash log decoding error message"));
+            return NULL;
+        }
+
+        /* The ranges reference the (possibly decompressed) data, which must be kept alive; this is a simple
+         * retain for immutable data. */
+        _decoder->lazyData = [data copy];
+        _decoder->threadRanges = [threadRanges retain];
+        _decoder->imageRanges = [imageRanges retain];
+
+        message = [skeleton bytes];
+        message_len = [skeleton length];
+    }
+
+    /* Decode the message into a single arena, rather than individually allocating each submessage */
+    _decoder->arena = malloc(sizeof(*_decoder->arena));
+    if (_decoder->arena == NULL || !plcrash_report_arena_init(_decoder->arena, message_len)) {
+        free(_decoder->arena);
+        _decoder->arena = NULL;
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                             @"Crash log decoding error message"));
+        return NULL;
+    }
+
+    Plcrash__CrashReport *crashReport;
+    if (header->version == PLCRASH_REPORT_FILE_VERSION_V2) {
+        Plcrash__CrashReportV2 *report = plcrash__crash_report_v2__unpack(&_decoder->arena->allocator, message_len, message);
+        crashReport = report != NULL ? crash_report_from_v2(report, &_decoder->arena->allocator) : NULL;
+    } else {
+        crashReport = plcrash__crash_report__unpack(&_decoder->arena->allocator, message_len, message);
+    }
+
     if (crashReport == NULL) {
         populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"An unknown error occured decoding the crash report", 
                                                                                              @"Crash log decoding error message"));
@@ -559,80 +1762,468 @@ error:
 }
 
 /**
- * Extract symbol information from the crash log. Returns nil on error, or a PLCrashReportSymbolInfo
- * instance on success.
+ * Extract a symbol's name from the crash log, either from the symbol string table or inline. Returns nil on error.
+ */
+- (NSString *) extractSymbolName: (Plcrash__CrashReport__Symbol *) symbol error: (NSError **) outError {
+    NSString *name;
+    if (symbol->has_name_index) {
+        if (symbol->name_index >= [_decoder->symbolNames count]) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report symbol references an invalid symbol string table entry",
+                                               @"Invalid symbol name index in crash report"));
+            return nil;
+        }
+        name = [_decoder->symbolNames objectAtIndex: symbol->name_index];
+    } else if (symbol->name != NULL) {
+        name = [NSString stringWithUTF8String: symbol->name];
+    } else {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report is missing symbol name",
+                                           @"Missing symbol name in crash report"));
+        return nil;
+    }
+
+    return name;
+}
+
+/**
+ * Extract symbol information from the crash log. Returns nil on error, or a PLCrashReportSymbolInfo
+ * instance on success.
+ */
+- (PLCrashReportSymbolInfo *) extractSymbolInfo: (Plcrash__CrashReport__Symbol *) symbol error: (NSError **) outError {
+    if (symbol == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report is missing symbol information",
+                                           @"Missing symbol info in crash report"));
+        return nil;
+    }
+    
+    NSString *name = [self extractSymbolName: symbol error: outError];
+    if (name == nil)
+        return nil;
+
+    return [[[PLCrashReportSymbolInfo alloc] initWithSymbolName: name
+                                                   startAddress: symbol->start_address
+                                                     endAddress: symbol->has_end_address ? symbol->end_address : 0] autorelease];
+}
+
+/**
+ * Extract the symbol string table from the crash log. Returns nil on error, or an array of NSString instances, in
+ * index order, on success.
+ */
+- (NSArray *) extractSymbolNames: (Plcrash__CrashReport__StringTable *) stringTable error: (NSError **) outError {
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity: stringTable->n_strings];
+    for (size_t i = 0; i < stringTable->n_strings; i++) {
+        NSString *name = [NSString stringWithUTF8String: stringTable->strings[i]];
+        if (name == nil) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report symbol string table contains an invalid string",
+                                               @"Invalid symbol string in crash report"));
+            return nil;
+        }
+
+        [names addObject: name];
+    }
+
+    return names;
+}
+
+/**
+ * Extract stack frame information from the crash log. Returns nil on error, or a PLCrashReportStackFrameInfo
+ * instance on success.
+ */
+- (PLCrashReportStackFrameInfo *) extractStackFrameInfo: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame error: (NSError **) outError {
+    /* There should be at least one thread */
+    if (stackFrame == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report is missing stack frame information",
+                                           @"Missing stack frame info in crash report"));
+        return nil;
+    }
+    
+    PLCrashReportSymbolInfo *symbolInfo = nil;
+    if (stackFrame->symbol != NULL) {
+        if ((symbolInfo = [self extractSymbolInfo: stackFrame->symbol error: outError]) == NULL)
+            return NULL;
+    }
+
+    return [[[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: stackFrame->pc
+                                                                 symbolInfo: symbolInfo] autorelease];
+}
+
+/**
+ * Extract thread information from the crash log. Returns nil on error, or an array of PLCrashLogThreadInfo
+ * instances on success.
+ */
+- (NSArray *) extractThreadInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError {
+    /* There should be at least one thread */
+    if (crashReport->n_threads == 0) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report is missing thread state information",
+                                           @"Missing thread info in crash report"));
+        return nil;
+    }
+
+    /* Handle all threads */
+    NSMutableArray *threadResult = [NSMutableArray arrayWithCapacity: crashReport->n_threads];
+    NSMutableDictionary *writtenThreads = [NSMutableDictionary dictionary];
+    for (size_t thr_idx = 0; thr_idx < crashReport->n_threads; thr_idx++) {
+        PLCrashReportThreadInfo *threadInfo = [self extractThread: crashReport->threads[thr_idx] writtenThreads: writtenThreads error: outError];
+        if (threadInfo == nil)
+            return nil;
+
+        [threadResult addObject: threadInfo];
+    }
+
+    /* Reports written under a time budget place the crashed thread first */
+    [self sortThreadInfo: threadResult];
+    return threadResult;
+}
+
+/**
+ * Extract thread and binary image information from the crash log, building the per-thread and per-image instances
+ * concurrently. On success, returns YES, and sets @a outThreads and @a outImages to the same arrays that would be
+ * returned by extractThreadInfo:error: and extractImageInfo:error:. Returns NO on error.
+ *
+ * Threads written as a duplicate of another thread's stack reference the previously extracted thread, and are resolved
+ * serially, in report order, once all other threads have been built.
+ */
+- (BOOL) extractThreads: (NSArray **) outThreads images: (NSArray **) outImages concurrentlyFromReport: (Plcrash__CrashReport *) crashReport
+                  error: (NSError **) outError
+{
+    size_t thread_count = crashReport->n_threads;
+    size_t image_count = crashReport->n_binary_images;
+
+    /* Reports without threads are invalid, and reports without full image records require no image instances; in
+     * either case, there's nothing to be gained from concurrency, and the serial path provides the validation. */
+    if (thread_count == 0 || image_count == 0) {
+        if ((*outThreads = [self extractThreadInfo: crashReport error: outError]) == nil)
+            return NO;
+
+        return (*outImages = [self extractImageInfo: crashReport error: outError]) != nil;
+    }
+
+    /* Build all threads and images; each iteration owns its result and error slots */
+    size_t count = thread_count + image_count;
+    id *results = calloc(count, sizeof(id));
+    NSError **errors = calloc(count, sizeof(NSError *));
+
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSError *error = nil;
+        id result = nil;
+
+        if (i >= thread_count) {
+            result = [self extractImage: crashReport->binary_images[i - thread_count] error: &error];
+        } else if (!crashReport->threads[i]->has_duplicate_of_thread) {
+            result = [self extractThread: crashReport->threads[i] error: &error];
+        }
+
+        results[i] = [result retain];
+        errors[i] = [error retain];
+        [pool drain];
+    });
+
+    /* Assemble the results in order, resolving duplicate threads against the threads that precede them */
+    NSMutableArray *threads = [NSMutableArray arrayWithCapacity: thread_count];
+    NSMutableArray *images = [NSMutableArray arrayWithCapacity: image_count];
+    NSMutableDictionary *writtenThreads = [NSMutableDictionary dictionary];
+    BOOL success = YES;
+
+    for (size_t i = 0; i < count; i++) {
+        id result = results[i];
+
+        if (i < thread_count && crashReport->threads[i]->has_duplicate_of_thread) {
+            result = [self extractThread: crashReport->threads[i] writtenThreads: writtenThreads error: outError];
+            if (result == nil)
+                success = NO;
+        } else if (result == nil) {
+            if (outError != NULL && errors[i] != nil)
+                *outError = [[errors[i] retain] autorelease];
+            success = NO;
+        } else if (i < thread_count) {
+            [writtenThreads setObject: result forKey: [NSNumber numberWithUnsignedInt: crashReport->threads[i]->thread_number]];
+        }
+
+        if (!success)
+            break;
+
+        if (i < thread_count)
+            [threads addObject: result];
+        else
+            [images addObject: result];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        [results[i] release];
+        [errors[i] release];
+    }
+    free(results);
+    free(errors);
+
+    if (!success)
+        return NO;
+
+    /* Reports written under a time budget place the crashed thread first */
+    [self sortThreadInfo: threads];
+
+    *outThreads = threads;
+    *outImages = images;
+    return YES;
+}
+
+/**
+ * Sort @a threads by thread number. Writers may record the crashed thread ahead of the report's other threads.
+ */
+- (void) sortThreadInfo: (NSMutableArray *) threads {
+    [threads sortUsingComparator: ^NSComparisonResult(PLCrashReportThreadInfo *a, PLCrashReportThreadInfo *b) {
+        if (a.threadNumber < b.threadNumber)
+            return NSOrderedAscending;
+        else if (a.threadNumber > b.threadNumber)
+            return NSOrderedDescending;
+        return NSOrderedSame;
+    }];
+}
+
+/**
+ * Extract a single thread record from the crash log, resolving the stack of a thread written as a duplicate of a
+ * previously written thread's stack. Returns nil on error, or a PLCrashReportThreadInfo instance on success.
+ *
+ * @param thread The thread record.
+ * @param writtenThreads The threads previously extracted with their stacks written in full, keyed by thread number.
+ * If @a thread's stack was written in full, it will be added.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the thread could not be extracted. If no error occurs, this parameter will be left unmodified.
+ */
+- (PLCrashReportThreadInfo *) extractThread: (Plcrash__CrashReport__Thread *) thread
+                               writtenThreads: (NSMutableDictionary *) writtenThreads
+                                        error: (NSError **) outError
+{
+    if (thread->has_duplicate_of_thread) {
+        /* The referenced thread always precedes its duplicates, and must have been written in full */
+        PLCrashReportThreadInfo *source = [writtenThreads objectForKey: [NSNumber numberWithUnsignedInt: thread->duplicate_of_thread]];
+        if (source == nil) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Thread references an unknown duplicate thread");
+            return nil;
+        }
+
+        NSString *queueLabel = nil;
+        if (thread->dispatch_queue_label != NULL)
+            queueLabel = [NSString stringWithUTF8String: thread->dispatch_queue_label];
+
+        return [[[PLCrashReportThreadInfo alloc] initWithThreadNumber: thread->thread_number
+                                                               crashed: thread->crashed
+                                                    dispatchQueueLabel: queueLabel
+                                                    stackOfThreadInfo: source] autorelease];
+    }
+
+    PLCrashReportThreadInfo *threadInfo = [self extractThread: thread error: outError];
+    if (threadInfo != nil)
+        [writtenThreads setObject: threadInfo forKey: [NSNumber numberWithUnsignedInt: thread->thread_number]];
+
+    return threadInfo;
+}
+
+/**
+ * Decode @a thread's packed frame_pcs and frame_symbols arrays into @a pcs, @a symbolNames and @a starts, each of
+ * which must have room for @a frameCount entries. Returns NO on error.
+ */
+- (BOOL) extractPackedFrames: (Plcrash__CrashReport__Thread *) thread count: (size_t) frameCount pcs: (uint64_t *) pcs
+                 symbolNames: (NSString **) symbolNames starts: (uint64_t *) starts error: (NSError **) outError
+{
+    const uint8_t *cursor = thread->frame_pcs.data;
+    const uint8_t *end = cursor + thread->frame_pcs.len;
+
+    for (size_t frame_idx = 0; frame_idx < frameCount; frame_idx++) {
+        if (!read_varint(&cursor, end, &pcs[frame_idx])) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid value in packed frame PCs");
+            return NO;
+        }
+    }
+
+    /* A trailing truncated varint is not counted by our caller */
+    if (cursor != end) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Truncated value in packed frame PCs");
+        return NO;
+    }
+
+    /* Symbols are optional; if provided, there must be a name index and offset for every frame */
+    if (!thread->has_frame_symbols || thread->frame_symbols.len == 0)
+        return YES;
+
+    cursor = thread->frame_symbols.data;
+    end = cursor + thread->frame_symbols.len;
+
+    for (size_t frame_idx = 0; frame_idx < frameCount; frame_idx++) {
+        uint64_t name_index;
+        uint64_t offset;
+
+        if (!read_varint(&cursor, end, &name_index) || !read_varint(&cursor, end, &offset)) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid value in packed frame symbols");
+            return NO;
+        }
+
+        /* A zero index denotes a frame without a symbol */
+        if (name_index == 0)
+            continue;
+
+        if (name_index > [_decoder->symbolNames count]) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid symbol name index in packed frame symbols");
+            return NO;
+        }
+
+        symbolNames[frame_idx] = [_decoder->symbolNames objectAtIndex: (NSUInteger) (name_index - 1)];
+        starts[frame_idx] = pcs[frame_idx] - offset;
+    }
+
+    return YES;
+}
+
+/**
+ * Decode @a state's packed register symbol annotations into @a symbolNames and @a starts, each of which must have
+ * room for @a registerCount entries. Registers without an annotation are left unmodified. Returns NO on error.
  */
-- (PLCrashReportSymbolInfo *) extractSymbolInfo: (Plcrash__CrashReport__Symbol *) symbol error: (NSError **) outError {
-    if (symbol == NULL) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
-                         NSLocalizedString(@"Crash report is missing symbol information",
-                                           @"Missing symbol info in crash report"));
-        return nil;
+- (BOOL) extractRegisterSymbols: (Plcrash__CrashReport__Thread__RegisterState *) state count: (size_t) registerCount values: (const uint64_t *) regValues
+                    symbolNames: (NSString **) symbolNames starts: (uint64_t *) starts error: (NSError **) outError
+{
+    /* Symbols are optional; if provided, there must be a name index and offset for every register */
+    if (!state->has_symbols || state->symbols.len == 0)
+        return YES;
+
+    const uint8_t *cursor = state->symbols.data;
+    const uint8_t *end = cursor + state->symbols.len;
+
+    for (size_t reg_idx = 0; reg_idx < registerCount; reg_idx++) {
+        uint64_t name_index;
+        uint64_t offset;
+
+        if (!read_varint(&cursor, end, &name_index) || !read_varint(&cursor, end, &offset)) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid value in register symbols");
+            return NO;
+        }
+
+        /* A zero index denotes a register without a symbol */
+        if (name_index == 0)
+            continue;
+
+        if (name_index > [_decoder->symbolNames count]) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid symbol name index in register symbols");
+            return NO;
+        }
+
+        symbolNames[reg_idx] = [_decoder->symbolNames objectAtIndex: (NSUInteger) (name_index - 1)];
+        starts[reg_idx] = regValues[reg_idx] - offset;
     }
-    
-    NSString *name = [NSString stringWithUTF8String: symbol->name];
-    return [[[PLCrashReportSymbolInfo alloc] initWithSymbolName: name
-                                                   startAddress: symbol->start_address
-                                                     endAddress: symbol->has_end_address ? symbol->end_address : 0] autorelease];
+
+    return YES;
 }
 
 /**
- * Extract stack frame information from the crash log. Returns nil on error, or a PLCrashReportStackFrameInfo
+ * Extract a single thread record from the crash log. Returns nil on error, or a PLCrashReportThreadInfo
  * instance on success.
  */
-- (PLCrashReportStackFrameInfo *) extractStackFrameInfo: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame error: (NSError **) outError {
-    /* There should be at least one thread */
-    if (stackFrame == NULL) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
-                         NSLocalizedString(@"Crash report is missing stack frame information",
-                                           @"Missing stack frame info in crash report"));
-        return nil;
-    }
-    
-    PLCrashReportSymbolInfo *symbolInfo = nil;
-    if (stackFrame->symbol != NULL) {
-        if ((symbolInfo = [self extractSymbolInfo: stackFrame->symbol error: outError]) == NULL)
-            return NULL;
-    }
+- (PLCrashReportThreadInfo *) extractThread: (Plcrash__CrashReport__Thread *) thread error: (NSError **) outError {
+    /* Determine the register count; the compact register state provides a varint per register, with names implied by
+     * the CPU type. */
+    size_t register_count = thread->n_registers;
+    const char * const *stateNames = NULL;
+    if (thread->register_state != NULL) {
+        size_t name_count;
+        if ((stateNames = register_names_for_cpu_type(thread->register_state->cpu_type, &name_count)) == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Unknown CPU type in thread register state");
+            return nil;
+        }
 
-    return [[[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: stackFrame->pc
-                                                                 symbolInfo: symbolInfo] autorelease];
-}
+        /* Each varint is terminated by a byte with the continuation bit cleared */
+        register_count = 0;
+        for (size_t i = 0; i < thread->register_state->values.len; i++) {
+            if ((thread->register_state->values.data[i] & 0x80) == 0)
+                register_count++;
+        }
 
-/**
- * Extract thread information from the crash log. Returns nil on error, or an array of PLCrashLogThreadInfo
- * instances on success.
- */
-- (NSArray *) extractThreadInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError {
-    /* There should be at least one thread */
-    if (crashReport->n_threads == 0) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
-                         NSLocalizedString(@"Crash report is missing thread state information",
-                                           @"Missing thread info in crash report"));
-        return nil;
+        if (register_count > name_count) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Too many values in thread register state");
+            return nil;
+        }
     }
 
-    /* Handle all threads */
-    NSMutableArray *threadResult = [NSMutableArray arrayWithCapacity: crashReport->n_threads];
-    for (size_t thr_idx = 0; thr_idx < crashReport->n_threads; thr_idx++) {
-        Plcrash__CrashReport__Thread *thread = crashReport->threads[thr_idx];
-        
-        /* Fetch stack frames for this thread */
-        NSMutableArray *frames = [NSMutableArray arrayWithCapacity: thread->n_frames];
+    /* Determine the frame count; packed frames provide a varint per frame PC */
+    size_t frame_count = thread->n_frames;
+    if (thread->has_frame_pcs) {
+        frame_count = 0;
+        for (size_t i = 0; i < thread->frame_pcs.len; i++) {
+            if ((thread->frame_pcs.data[i] & 0x80) == 0)
+                frame_count++;
+        }
+    }
+
+    /* Fetch stack frames and registers for this thread into flat arrays; PLCrashReportThreadInfo only creates
+     * per-frame and per-register instances if they're requested. */
+    size_t value_count = frame_count * 3 + register_count * 2;
+    size_t name_count = frame_count + register_count * 2;
+    NSMutableData *values = [NSMutableData dataWithLength: sizeof(uint64_t) * value_count];
+    NSMutableData *names = [NSMutableData dataWithLength: sizeof(NSString *) * name_count];
+
+    uint64_t *pcs = [values mutableBytes];
+    uint64_t *starts = pcs + frame_count;
+    uint64_t *ends = starts + frame_count;
+    uint64_t *regValues = ends + frame_count;
+    uint64_t *regSymbolStarts = regValues + register_count;
+    NSString **symbolNames = [names mutableBytes];
+    NSString **regNames = symbolNames + frame_count;
+    NSString **regSymbolNames = regNames + register_count;
+
+    if (thread->has_frame_pcs) {
+        if (![self extractPackedFrames: thread count: frame_count pcs: pcs symbolNames: symbolNames starts: starts error: outError])
+            return nil;
+    } else {
         for (size_t frame_idx = 0; frame_idx < thread->n_frames; frame_idx++) {
             Plcrash__CrashReport__Thread__StackFrame *frame = thread->frames[frame_idx];
-            PLCrashReportStackFrameInfo *frameInfo = [self extractStackFrameInfo: frame error: outError];
-            if (frameInfo == nil)
+            if (frame == NULL) {
+                populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                                 NSLocalizedString(@"Crash report is missing stack frame information",
+                                                   @"Missing stack frame info in crash report"));
                 return nil;
+            }
 
-            [frames addObject: frameInfo];
+            pcs[frame_idx] = frame->pc;
+            if (frame->symbol != NULL) {
+                if ((symbolNames[frame_idx] = [self extractSymbolName: frame->symbol error: outError]) == nil)
+                    return nil;
+
+                starts[frame_idx] = frame->symbol->start_address;
+                ends[frame_idx] = frame->symbol->has_end_address ? frame->symbol->end_address : 0;
+            }
+        }
+    }
+
+    if (stateNames != NULL) {
+        const uint8_t *cursor = thread->register_state->values.data;
+        const uint8_t *end = cursor + thread->register_state->values.len;
+
+        for (size_t reg_idx = 0; reg_idx < register_count; reg_idx++) {
+            if (!read_varint(&cursor, end, &regValues[reg_idx])) {
+                populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid value in thread register state");
+                return nil;
+            }
+
+            regNames[reg_idx] = [NSString stringWithUTF8String: stateNames[reg_idx]];
+        }
+
+        /* A trailing truncated varint is not counted above */
+        if (cursor != end) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Truncated value in thread register state");
+            return nil;
         }
 
-        /* Fetch registers for this thread */
-        NSMutableArray *registers = [NSMutableArray arrayWithCapacity: thread->n_registers];
+        if (![self extractRegisterSymbols: thread->register_state count: register_count values: regValues
+                              symbolNames: regSymbolNames starts: regSymbolStarts error: outError])
+        {
+            return nil;
+        }
+    } else {
         for (size_t reg_idx = 0; reg_idx < thread->n_registers; reg_idx++) {
             Plcrash__CrashReport__Thread__RegisterValue *reg = thread->registers[reg_idx];
-            PLCrashReportRegisterInfo *regInfo;
 
             /* Handle missing register name (should not occur!) */
             if (reg->name == NULL) {
@@ -640,29 +2231,150 @@ error:
                 return nil;
             }
 
-            regInfo = [[[PLCrashReportRegisterInfo alloc] initWithRegisterName: [NSString stringWithUTF8String: reg->name]
-                                                              registerValue: reg->value] autorelease];
-            [registers addObject: regInfo];
+            regNames[reg_idx] = [NSString stringWithUTF8String: reg->name];
+            regValues[reg_idx] = reg->value;
+        }
+    }
+
+    /* Fetch the collapsed frame runs for this thread */
+    NSMutableArray *repeats = [NSMutableArray arrayWithCapacity: thread->n_frame_repeats];
+    for (size_t repeat_idx = 0; repeat_idx < thread->n_frame_repeats; repeat_idx++) {
+        Plcrash__CrashReport__Thread__FrameRepeat *repeat = thread->frame_repeats[repeat_idx];
+
+        /* The run must reference frames within this thread */
+        if (repeat->frame_count == 0 || repeat->frame_index > frame_count || repeat->frame_count > frame_count - repeat->frame_index) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid frame range in repeated frame run");
+            return nil;
+        }
+
+        [repeats addObject: [[[PLCrashReportFrameRepeatInfo alloc] initWithFrameIndex: repeat->frame_index
+                                                                           frameCount: repeat->frame_count
+                                                                          repeatCount: repeat->repeat_count] autorelease]];
+    }
+
+    /* Fetch the secondary crash signal info, if any */
+    PLCrashReportSignalInfo *secondaryCrash = nil;
+    if (thread->secondary_crash != NULL && (secondaryCrash = [self extractSignalInfo: thread->secondary_crash error: outError]) == nil)
+        return nil;
+
+    /* Fetch the dispatch queue label, if any */
+    NSString *queueLabel = nil;
+    if (thread->dispatch_queue_label != NULL)
+        queueLabel = [NSString stringWithUTF8String: thread->dispatch_queue_label];
+
+    /* Create the thread info instance */
+    return [[[PLCrashReportThreadInfo alloc] initWithThreadNumber: thread->thread_number
+                                                       frameCount: frame_count
+                                              instructionPointers: pcs
+                                                      symbolNames: symbolNames
+                                             symbolStartAddresses: starts
+                                               symbolEndAddresses: ends
+                                                          crashed: thread->crashed
+                                                    registerCount: register_count
+                                                    registerNames: regNames
+                                                   registerValues: regValues
+                                                     frameRepeats: repeats
+                                                omittedFrameCount: thread->has_omitted_frame_count ? thread->omitted_frame_count : 0
+                                                omittedFrameIndex: thread->has_omitted_frame_index ? thread->omitted_frame_index : 0
+                                         secondaryCrashSignalInfo: secondaryCrash
+                                               dispatchQueueLabel: queueLabel
+                                              registerSymbolNames: regSymbolNames
+                                     registerSymbolStartAddresses: regSymbolStarts] autorelease];
+}
+
+/**
+ * Decode the thread record at @a range within the deferred report data. Returns NULL on error.
+ *
+ * @warning MEMORY WARNING. The returned instance is allocated from @a arena, and is released along with it.
+ */
+- (Plcrash__CrashReport__Thread *) unpackDeferredThread: (NSRange) range arena: (struct plcrash_report_arena *) arena error: (NSError **) outError {
+    const uint8_t *bytes = [_decoder->lazyData bytes];
+    Plcrash__CrashReport__Thread *thread;
+
+    thread = (Plcrash__CrashReport__Thread *) protobuf_c_message_unpack(&plcrash__crash_report__thread__descriptor, &arena->allocator, range.length, bytes + range.location);
+    if (thread == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"An unknown error occured decoding the crash report thread state",
+                                                                                             @"Crash log decoding error message"));
+    }
+
+    return thread;
+}
+
+/**
+ * Decode all deferred thread records. Returns nil on error, or an array of PLCrashLogThreadInfo
+ * instances on success.
+ */
+- (NSArray *) extractDeferredThreadInfo: (NSError **) outError {
+    const NSRange *ranges = [_decoder->threadRanges bytes];
+    size_t count = [_decoder->threadRanges length] / sizeof(NSRange);
+
+    NSMutableArray *threadResult = [NSMutableArray arrayWithCapacity: count];
+    NSMutableDictionary *writtenThreads = [NSMutableDictionary dictionary];
+    for (size_t i = 0; i < count; i++) {
+        struct plcrash_report_arena arena;
+        if (!plcrash_report_arena_init(&arena, ranges[i].length)) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                                 @"Crash log decoding error message"));
+            return nil;
         }
 
-        /* Create the thread info instance */
-        PLCrashReportThreadInfo *threadInfo = [[[PLCrashReportThreadInfo alloc] initWithThreadNumber: thread->thread_number
-                                                                                   stackFrames: frames 
-                                                                                       crashed: thread->crashed 
-                                                                                     registers: registers] autorelease];
+        Plcrash__CrashReport__Thread *thread = [self unpackDeferredThread: ranges[i] arena: &arena error: outError];
+        PLCrashReportThreadInfo *threadInfo = nil;
+        if (thread != NULL)
+            threadInfo = [self extractThread: thread writtenThreads: writtenThreads error: outError];
+
+        plcrash_report_arena_free(&arena);
+        if (threadInfo == nil)
+            return nil;
+
         [threadResult addObject: threadInfo];
     }
-    
+
+    [self sortThreadInfo: threadResult];
     return threadResult;
 }
 
+/**
+ * Decode only the crashed thread's deferred record. Returns nil on error, or if no crashed thread is found.
+ */
+- (PLCrashReportThreadInfo *) extractDeferredCrashedThread: (NSError **) outError {
+    const NSRange *ranges = [_decoder->threadRanges bytes];
+    size_t count = [_decoder->threadRanges length] / sizeof(NSRange);
+
+    for (size_t i = 0; i < count; i++) {
+        struct plcrash_report_arena arena;
+        if (!plcrash_report_arena_init(&arena, ranges[i].length)) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                                 @"Crash log decoding error message"));
+            return nil;
+        }
+
+        Plcrash__CrashReport__Thread *thread = [self unpackDeferredThread: ranges[i] arena: &arena error: outError];
+        if (thread == NULL) {
+            plcrash_report_arena_free(&arena);
+            return nil;
+        }
+
+        PLCrashReportThreadInfo *threadInfo = nil;
+        BOOL crashed = thread->crashed;
+        if (crashed)
+            threadInfo = [self extractThread: thread error: outError];
+
+        plcrash_report_arena_free(&arena);
+        if (crashed)
+            return threadInfo;
+    }
+
+    return nil;
+}
+
 
 /**
  * Extract binary image information from the crash log. Returns nil on error.
  */
 - (NSArray *) extractImageInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError {
-    /* There should be at least one image */
-    if (crashReport->n_binary_images == 0) {
+    /* There should be at least one image, unless the images are provided by a shared image list */
+    if (crashReport->n_binary_images == 0 && crashReport->n_compact_binary_images == 0 && crashReport->shared_image_list == NULL) {
         populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
                          NSLocalizedString(@"Crash report is missing binary image information",
                                            @"Missing image info in crash report"));
@@ -672,44 +2384,230 @@ error:
     /* Handle all records */
     NSMutableArray *images = [NSMutableArray arrayWithCapacity: crashReport->n_binary_images];
     for (size_t i = 0; i < crashReport->n_binary_images; i++) {
-        Plcrash__CrashReport__BinaryImage *image = crashReport->binary_images[i];
-        PLCrashReportBinaryImageInfo *imageInfo;
-
-        /* Validate */
-        if (image->name == NULL) {
-            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Missing image name in image record");
+        PLCrashReportBinaryImageInfo *imageInfo = [self extractImage: crashReport->binary_images[i] error: outError];
+        if (imageInfo == nil)
             return nil;
-        }
 
-        /* Extract UUID value */
+        [images addObject: imageInfo];
+    }
+
+    return images;
+}
+
+/**
+ * Extract compact binary image information from the crash log. Returns nil on error.
+ */
+- (NSArray *) extractCompactImageInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError {
+    NSMutableArray *images = [NSMutableArray arrayWithCapacity: crashReport->n_compact_binary_images];
+    for (size_t i = 0; i < crashReport->n_compact_binary_images; i++) {
+        Plcrash__CrashReport__CompactBinaryImage *image = crashReport->compact_binary_images[i];
+
         NSData *uuid = nil;
-        if (image->uuid.len == 0) {
-            /* No UUID */
-            uuid = nil;
-        } else {
+        if (image->uuid.len != 0)
             uuid = [NSData dataWithBytes: image->uuid.data length: image->uuid.len];
+
+        PLCrashReportBinaryImageInfo *imageInfo = [[[PLCrashReportBinaryImageInfo alloc] initWithCodeType: nil
+                                                                                               baseAddress: image->base_address
+                                                                                                      size: 0
+                                                                                                      name: nil
+                                                                                                      uuid: uuid] autorelease];
+        [images addObject: imageInfo];
+    }
+
+    return images;
+}
+
+/**
+ * Extract the captured memory regions from the crash log.
+ */
+- (NSArray *) extractMemoryRegionInfo: (Plcrash__CrashReport *) crashReport {
+    NSMutableArray *regions = [NSMutableArray arrayWithCapacity: crashReport->n_memory_regions];
+    for (size_t i = 0; i < crashReport->n_memory_regions; i++) {
+        Plcrash__CrashReport__MemoryRegion *region = crashReport->memory_regions[i];
+
+        /* The decoded message is released along with its arena; copy the region's contents */
+        NSData *data = [NSData dataWithBytes: region->data.data length: region->data.len];
+        PLCrashReportMemoryRegionInfo *info = [[[PLCrashReportMemoryRegionInfo alloc] initWithAddress: region->address
+                                                                                                 data: data] autorelease];
+        [regions addObject: info];
+    }
+
+    return regions;
+}
+
+/**
+ * Extract the attachments from the crash log.
+ */
+- (NSDictionary *) extractAttachments: (Plcrash__CrashReport *) crashReport {
+    NSMutableDictionary *attachments = [NSMutableDictionary dictionaryWithCapacity: crashReport->n_attachments];
+    for (size_t i = 0; i < crashReport->n_attachments; i++) {
+        Plcrash__CrashReport__Attachment *attachment = crashReport->attachments[i];
+        if (attachment->name == NULL)
+            continue;
+
+        NSString *name = [NSString stringWithUTF8String: attachment->name];
+        if (name == nil)
+            continue;
+
+        /* The decoded message is released along with its arena; copy the attachment's contents */
+        [attachments setObject: [NSData dataWithBytes: attachment->data.data length: attachment->data.len] forKey: name];
+    }
+
+    return attachments;
+}
+
+/**
+ * Extract the per-thread metadata from the crash log. Any truncated trailing record is discarded.
+ */
+- (NSArray *) extractThreadMetadata: (Plcrash__CrashReport *) crashReport {
+    /* The fields understood by this decoder; any additional trailing fields in each record are skipped. */
+    enum {
+        FIELD_THREAD_NUMBER = 0,
+        FIELD_USER_TIME,
+        FIELD_SYSTEM_TIME,
+        FIELD_CPU_USAGE,
+        FIELD_POLICY,
+        FIELD_RUN_STATE,
+        FIELD_FLAGS,
+        FIELD_SLEEP_TIME,
+        FIELD_CURRENT_PRIORITY,
+        FIELD_BASE_PRIORITY,
+        FIELD_MAX_PRIORITY,
+        FIELD_COUNT
+    };
+
+    Plcrash__CrashReport__ThreadMetadata *metadata = crashReport->thread_metadata;
+    if (metadata == NULL || metadata->fields_per_record == 0)
+        return [NSArray array];
+
+    NSMutableArray *result = [NSMutableArray array];
+    const uint8_t *cursor = metadata->records.data;
+    const uint8_t *end = cursor + metadata->records.len;
+
+    while (cursor < end) {
+        uint64_t fields[FIELD_COUNT] = { 0 };
+        for (uint32_t i = 0; i < metadata->fields_per_record; i++) {
+            uint64_t value;
+            if (!read_varint(&cursor, end, &value))
+                return result;
+
+            if (i < FIELD_COUNT)
+                fields[i] = value;
         }
-        assert(image->uuid.len == 0 || uuid != nil);
-        
-        /* Extract code type (if available). */
-        PLCrashReportProcessorInfo *codeType = nil;
-        if (image->code_type != NULL) {
-            if ((codeType = [self extractProcessorInfo: image->code_type error: outError]) == nil)
-                return nil;
+
+        /* Signed values are written as their 32-bit two's complement representation */
+        PLCrashReportThreadMetadataInfo *info;
+        info = [[[PLCrashReportThreadMetadataInfo alloc] initWithThreadNumber: (NSInteger) fields[FIELD_THREAD_NUMBER]
+                                                                     userTime: fields[FIELD_USER_TIME]
+                                                                   systemTime: fields[FIELD_SYSTEM_TIME]
+                                                                     cpuUsage: (uint32_t) fields[FIELD_CPU_USAGE]
+                                                             schedulingPolicy: (int32_t) fields[FIELD_POLICY]
+                                                                     runState: (int32_t) fields[FIELD_RUN_STATE]
+                                                                        flags: (uint32_t) fields[FIELD_FLAGS]
+                                                                    sleepTime: (uint32_t) fields[FIELD_SLEEP_TIME]
+                                                              currentPriority: (int32_t) fields[FIELD_CURRENT_PRIORITY]
+                                                                 basePriority: (int32_t) fields[FIELD_BASE_PRIORITY]
+                                                                  maxPriority: (int32_t) fields[FIELD_MAX_PRIORITY]] autorelease];
+        [result addObject: info];
+    }
+
+    return result;
+}
+
+/**
+ * Extract a single binary image record from the crash log. Returns nil on error.
+ */
+- (PLCrashReportBinaryImageInfo *) extractImage: (Plcrash__CrashReport__BinaryImage *) image error: (NSError **) outError {
+    /* Validate */
+    if (image->name == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Missing image name in image record");
+        return nil;
+    }
+
+    /* Extract UUID value */
+    NSData *uuid = nil;
+    if (image->uuid.len == 0) {
+        /* No UUID */
+        uuid = nil;
+    } else {
+        uuid = [NSData dataWithBytes: image->uuid.data length: image->uuid.len];
+    }
+    assert(image->uuid.len == 0 || uuid != nil);
+
+    /* Extract code type (if available). */
+    PLCrashReportProcessorInfo *codeType = nil;
+    if (image->code_type != NULL) {
+        if ((codeType = [self extractProcessorInfo: image->code_type error: outError]) == nil)
+            return nil;
+    }
+
+    return [[[PLCrashReportBinaryImageInfo alloc] initWithCodeType: codeType
+                                                       baseAddress: image->base_address
+                                                              size: image->size
+                                                              name: [NSString stringWithUTF8String: image->name]
+                                                              uuid: uuid] autorelease];
+}
+
+/**
+ * Decode all deferred binary image records. Returns nil on error.
+ */
+- (NSArray *) extractDeferredImageInfo: (NSError **) outError {
+    const uint8_t *bytes = [_decoder->lazyData bytes];
+    const NSRange *ranges = [_decoder->imageRanges bytes];
+    size_t count = [_decoder->imageRanges length] / sizeof(NSRange);
+
+    /* All image records are decoded into a single arena, sized for the largest record and reset between records */
+    size_t max_len = 0;
+    for (size_t i = 0; i < count; i++)
+        max_len = MAX(max_len, ranges[i].length);
+
+    struct plcrash_report_arena arena;
+    if (!plcrash_report_arena_init(&arena, max_len)) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                             @"Crash log decoding error message"));
+        return nil;
+    }
+
+    NSMutableArray *images = [NSMutableArray arrayWithCapacity: count];
+    for (size_t i = 0; i < count; i++) {
+        Plcrash__CrashReport__BinaryImage *image;
+
+        arena.chunks->used = 0;
+        image = (Plcrash__CrashReport__BinaryImage *) protobuf_c_message_unpack(&plcrash__crash_report__binary_image__descriptor, &arena.allocator, ranges[i].length, bytes + ranges[i].location);
+        if (image == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"An unknown error occured decoding the crash report binary images",
+                                                                                                 @"Crash log decoding error message"));
+            plcrash_report_arena_free(&arena);
+            return nil;
         }
 
+        PLCrashReportBinaryImageInfo *imageInfo = [self extractImage: image error: outError];
+        if (imageInfo == nil) {
+            plcrash_report_arena_free(&arena);
+            return nil;
+        }
 
-        imageInfo = [[[PLCrashReportBinaryImageInfo alloc] initWithCodeType: codeType
-                                                                baseAddress: image->base_address
-                                                                       size: image->size
-                                                                       name: [NSString stringWithUTF8String: image->name]
-                                                                       uuid: uuid] autorelease];
         [images addObject: imageInfo];
     }
 
+    plcrash_report_arena_free(&arena);
     return images;
 }
 
+/**
+ * Release any deferred decoding state.
+ */
+- (void) releaseDeferredData {
+    [_decoder->threadRanges release];
+    _decoder->threadRanges = nil;
+
+    [_decoder->imageRanges release];
+    _decoder->imageRanges = nil;
+
+    [_decoder->lazyData release];
+    _decoder->lazyData = nil;
+}
+
 /**
  * Extract  exception information from the crash log. Returns nil on error.
  */
@@ -862,3 +2760,227 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
     
     *error = [NSError errorWithDomain: PLCrashReporterErrorDomain code: code userInfo: userInfo];
 }
+
+/**
+ * @internal
+ *
+ * Read a base 128 varint from @a cursor, advancing the cursor. Returns NO if the varint is truncated or overlong.
+ */
+static BOOL read_varint (const uint8_t **cursor, const uint8_t *end, uint64_t *result) {
+    uint64_t value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (*cursor >= end)
+            return NO;
+
+        uint8_t byte = *(*cursor)++;
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+/** @internal x86-32 register names, in CrashReport.Thread.RegisterState order. */
+static const char * const register_names_x86_32[] = {
+    "eip", "ebp", "esp", "eax", "edx", "ecx", "ebx", "esi", "edi", "eflags", "trapno", "cs", "ds", "es", "fs", "gs"
+};
+
+/** @internal x86-64 register names, in CrashReport.Thread.RegisterState order. */
+static const char * const register_names_x86_64[] = {
+    "rip", "rbp", "rsp", "rax", "rbx", "rcx", "rdx", "rdi", "rsi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+    "rflags", "cs", "fs", "gs"
+};
+
+/** @internal ARM register names, in CrashReport.Thread.RegisterState order. */
+static const char * const register_names_arm[] = {
+    "pc", "r7", "sp", "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r11", "r12", "lr", "cpsr"
+};
+
+/** @internal ARM64 register names, in CrashReport.Thread.RegisterState order. */
+static const char * const register_names_arm64[] = {
+    "pc", "fp", "sp", "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14",
+    "x15", "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23", "x24", "x25", "x26", "x27", "x28", "lr", "cpsr"
+};
+
+/**
+ * @internal
+ *
+ * Return the ordered register names implied by a compact register state's @a cpu_type, or NULL if the CPU type is
+ * unknown. The number of names is returned via @a count.
+ */
+static const char * const *register_names_for_cpu_type (uint64_t cpu_type, size_t *count) {
+#define PL_REGISTER_NAMES(names) *count = sizeof(names) / sizeof(names[0]); return names;
+    switch (cpu_type) {
+        case CPU_TYPE_X86:
+            PL_REGISTER_NAMES(register_names_x86_32);
+        case CPU_TYPE_X86_64:
+            PL_REGISTER_NAMES(register_names_x86_64);
+        case CPU_TYPE_ARM:
+            PL_REGISTER_NAMES(register_names_arm);
+        case CPU_TYPE_ARM64:
+            PL_REGISTER_NAMES(register_names_arm64);
+        default:
+            return NULL;
+    }
+#undef PL_REGISTER_NAMES
+}
+
+/**
+ * @internal
+ *
+ * Return the length of the longest prefix of the encoded CrashReport @a message that consists solely of complete
+ * top-level fields. Each top-level field is independently decodable; a report whose writer was interrupted will
+ * end with a single incomplete field, which this prefix excludes.
+ *
+ * @param message The encoded CrashReport message.
+ * @param length The length of @a message.
+ */
+static size_t complete_crash_report_length (const uint8_t *message, size_t length) {
+    const uint8_t *cursor = message;
+    const uint8_t *end = message + length;
+    const uint8_t *complete = message;
+
+    while (cursor < end) {
+        uint64_t key;
+        uint64_t value;
+
+        if (!read_varint(&cursor, end, &key))
+            return complete - message;
+
+        switch (key & 0x7) {
+            case PLCRASH_REPORT_WIRETYPE_VARINT:
+                if (!read_varint(&cursor, end, &value))
+                    return complete - message;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_64BIT:
+                if (end - cursor < 8)
+                    return complete - message;
+                cursor += 8;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_32BIT:
+                if (end - cursor < 4)
+                    return complete - message;
+                cursor += 4;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_LENGTH_DELIMITED:
+                if (!read_varint(&cursor, end, &value) || value > (uint64_t) (end - cursor))
+                    return complete - message;
+                cursor += value;
+                break;
+
+            default:
+                /* Not a truncation; leave the malformed field to be rejected by the decoder */
+                return length;
+        }
+
+        complete = cursor;
+    }
+
+    return complete - message;
+}
+
+/**
+ * @internal
+ *
+ * Walk the top-level fields of an encoded CrashReport @a message, recording the location of each thread and binary
+ * image record within @a data, and appending all other fields to @a skeleton. The skeleton may then be decoded as
+ * a CrashReport message that contains no threads or binary images.
+ *
+ * @param data The report data containing @a message. Recorded ranges are relative to the start of this data.
+ * @param message The encoded CrashReport message.
+ * @param length The length of @a message.
+ * @param skeleton The buffer to which all non-deferred fields will be appended.
+ * @param threadRanges The buffer to which the NSRange of each thread record will be appended.
+ * @param imageRanges The buffer to which the NSRange of each binary image record will be appended.
+ *
+ * @return Returns NO if the message is malformed.
+ */
+static BOOL index_crash_report_message (NSData *data, const uint8_t *message, size_t length, NSMutableData *skeleton, NSMutableData *threadRanges, NSMutableData *imageRanges) {
+    const uint8_t *base = [data bytes];
+    const uint8_t *cursor = message;
+    const uint8_t *end = message + length;
+
+    while (cursor < end) {
+        const uint8_t *field = cursor;
+        uint64_t key;
+        uint64_t value;
+
+        if (!read_varint(&cursor, end, &key))
+            return NO;
+
+        switch (key & 0x7) {
+            case PLCRASH_REPORT_WIRETYPE_VARINT:
+                if (!read_varint(&cursor, end, &value))
+                    return NO;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_64BIT:
+                if (end - cursor < 8)
+                    return NO;
+                cursor += 8;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_32BIT:
+                if (end - cursor < 4)
+                    return NO;
+                cursor += 4;
+                break;
+
+            case PLCRASH_REPORT_WIRETYPE_LENGTH_DELIMITED: {
+                if (!read_varint(&cursor, end, &value) || value > (uint64_t) (end - cursor))
+                    return NO;
+
+                /* Record deferred records by location, without copying them */
+                NSRange range = NSMakeRange(cursor - base, (NSUInteger) value);
+                cursor += value;
+
+                if ((key >> 3) == PLCRASH_REPORT_THREADS_ID) {
+                    [threadRanges appendBytes: &range length: sizeof(range)];
+                    continue;
+                } else if ((key >> 3) == PLCRASH_REPORT_BINARY_IMAGES_ID) {
+                    [imageRanges appendBytes: &range length: sizeof(range)];
+                    continue;
+                }
+                break;
+            }
+
+            default:
+                /* Groups are not used by the crash report format */
+                return NO;
+        }
+
+        [skeleton appendBytes: field length: cursor - field];
+    }
+
+    return YES;
+}
+
+/**
+ * @internal
+ *
+ * Order image index entries by ascending base address. Entries sharing a base address are ordered by descending
+ * position in the images array, so that the reverse scan in -imageForAddress: prefers the earliest image, as a
+ * linear search would.
+ */
+static int image_index_entry_compare (const void *a, const void *b) {
+    const struct plcrash_report_image_index_entry *lhs = a;
+    const struct plcrash_report_image_index_entry *rhs = b;
+
+    if (lhs->base < rhs->base)
+        return -1;
+    else if (lhs->base > rhs->base)
+        return 1;
+    else if (lhs->position > rhs->position)
+        return -1;
+    else if (lhs->position < rhs->position)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "CrashReporter.h"
+#import "PLCrashReportTextFormatter.h"
+#import "PLCrashReportJSONFormatter.h"
+#import "PLCrashTestThread.h"
+
+#import <malloc/malloc.h>
+#import <mach/mach_time.h>
+
+/** The number of times each benchmark is run over the report corpus. */
+#define BENCHMARK_ITERATIONS 10
+
+/**
+ * Environment variable naming a directory of .plcrash reports to be benchmarked in addition to the generated corpus,
+ * allowing results to be gathered over a corpus of real reports.
+ */
+#define BENCHMARK_CORPUS_ENV "PLCRASH_BENCHMARK_CORPUS"
+
+/** A generated corpus entry; the number of additional threads, and the synthetic stack depth of each thread. */
+typedef struct benchmark_corpus_shape {
+    /** The number of threads spawned prior to generating the report. */
+    unsigned int threads;
+
+    /** The number of synthetic frames pushed by each spawned thread. */
+    unsigned int depth;
+} benchmark_corpus_shape_t;
+
+/** The generated corpus; reports ranging from a handful of threads to several hundred deep stacks. */
+static const benchmark_corpus_shape_t benchmark_corpus_shapes[] = {
+    { 0, 0 },
+    { 16, 32 },
+    { 64, 64 },
+    { 256, 128 }
+};
+
+/**
+ * Throughput benchmarks for report decoding and formatting.
+ *
+ * Each benchmark decodes or formats every report in the corpus, reporting MB/s and reports/s, along with the largest
+ * increase in heap use observed while a single report's decoded and formatted output were live, via NSLog(). The
+ * tests verify only that every operation succeeded; the results are intended for comparing runs, and for sizing the
+ * hosts that convert reports in bulk.
+ *
+ * The corpus consists of live reports generated with a range of thread counts and stack depths, along with any
+ * reports found in the directory named by the PLCRASH_BENCHMARK_CORPUS environment variable.
+ */
+@interface PLCrashReportBenchmarkTests : SenTestCase {
+@private
+    /** The encoded reports, as NSData instances. */
+    NSMutableArray *_corpus;
+
+    /** The total size of the encoded reports, in bytes. */
+    uint64_t _corpusBytes;
+}
+@end
+
+@implementation PLCrashReportBenchmarkTests
+
+- (void) setUp {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSError *error;
+
+    _corpus = [[NSMutableArray alloc] init];
+    _corpusBytes = 0;
+
+    /* Generate live reports of each shape */
+    for (size_t i = 0; i < sizeof(benchmark_corpus_shapes) / sizeof(benchmark_corpus_shapes[0]); i++) {
+        const benchmark_corpus_shape_t *shape = &benchmark_corpus_shapes[i];
+        plcrash_test_thread_t *threads = calloc(shape->threads, sizeof(plcrash_test_thread_t));
+
+        for (unsigned int j = 0; j < shape->threads; j++)
+            plcrash_test_thread_spawn_depth(&threads[j], shape->depth);
+
+        NSData *data = [reporter generateLiveReportAndReturnError: &error];
+        STAssertNotNil(data, @"Failed to generate live report: %@", error);
+        if (data != nil)
+            [_corpus addObject: data];
+
+        for (unsigned int j = 0; j < shape->threads; j++)
+            plcrash_test_thread_stop(&threads[j]);
+        free(threads);
+    }
+
+    /* Add any externally supplied reports */
+    const char *corpusDir = getenv(BENCHMARK_CORPUS_ENV);
+    if (corpusDir != NULL) {
+        NSString *directory = [[NSFileManager defaultManager] stringWithFileSystemRepresentation: corpusDir length: strlen(corpusDir)];
+        for (NSString *entry in [[NSFileManager defaultManager] contentsOfDirectoryAtPath: directory error: NULL]) {
+            if (![[entry pathExtension] isEqualToString: @"plcrash"])
+                continue;
+
+            NSData *data = [NSData dataWithContentsOfFile: [directory stringByAppendingPathComponent: entry]];
+            if (data != nil)
+                [_corpus addObject: data];
+        }
+    }
+
+    for (NSData *data in _corpus)
+        _corpusBytes += [data length];
+}
+
+- (void) tearDown {
+    [_corpus release];
+}
+
+/* Return the number of bytes currently allocated from the default malloc zone */
+static size_t benchmark_heap_in_use (void) {
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+}
+
+/**
+ * Run @a operation over every report in the corpus BENCHMARK_ITERATIONS times, logging the results as @a name.
+ * Objects autoreleased by @a operation are released after each report, and the release is included in the elapsed
+ * time.
+ */
+- (void) benchmark: (NSString *) name operation: (BOOL (^)(NSData *data)) operation {
+    mach_timebase_info_data_t timebase;
+    uint64_t elapsed = 0;
+    uint64_t reports = 0;
+    uint64_t bytes = 0;
+    size_t peakHeap = 0;
+
+    mach_timebase_info(&timebase);
+
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        for (NSData *data in _corpus) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            size_t heapBefore = benchmark_heap_in_use();
+
+            uint64_t start = mach_absolute_time();
+            BOOL success = operation(data);
+            elapsed += mach_absolute_time() - start;
+
+            /* The decoded report and formatted output remain live until the pool is drained */
+            size_t heapAfter = benchmark_heap_in_use();
+            if (heapAfter > heapBefore && heapAfter - heapBefore > peakHeap)
+                peakHeap = heapAfter - heapBefore;
+
+            start = mach_absolute_time();
+            [pool drain];
+            elapsed += mach_absolute_time() - start;
+
+            STAssertTrue(success, @"%@: operation failed", name);
+            reports++;
+            bytes += [data length];
+        }
+    }
+
+    double seconds = (double) (elapsed * timebase.numer / timebase.denom) / NSEC_PER_SEC;
+    if (seconds <= 0)
+        return;
+
+    NSLog(@"%@: %.2f MB/s, %.1f reports/s, %zu KB peak heap/report (%llu reports, %llu bytes)", name,
+          (double) bytes / seconds / (1024.0 * 1024.0), (double) reports / seconds, peakHeap / 1024,
+          (unsigned long long) reports, (unsigned long long) bytes);
+}
+
+/**
+ * Benchmark -[PLCrashReport initWithData:options:error:] with each decoding mode.
+ */
+- (void) testDecodeBenchmark {
+    STAssertTrue([_corpus count] > 0, @"The corpus is empty");
+    NSLog(@"Report corpus: %lu reports, %llu bytes", (unsigned long) [_corpus count], (unsigned long long) _corpusBytes);
+
+    [self benchmark: @"decode (eager)" operation: ^BOOL (NSData *data) {
+        return [[[PLCrashReport alloc] initWithData: data error: NULL] autorelease] != nil;
+    }];
+
+    [self benchmark: @"decode (lazy)" operation: ^BOOL (NSData *data) {
+        return [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: NULL] autorelease] != nil;
+    }];
+
+    [self benchmark: @"decode (concurrent)" operation: ^BOOL (NSData *data) {
+        return [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionConcurrent error: NULL] autorelease] != nil;
+    }];
+}
+
+/**
+ * Benchmark decoding and formatting via the text and JSON formatters. The flat path decodes lazily, reading frames
+ * from the decoded threads' flat storage; see -[PLCrashReportTextFormatter formatReportData:error:].
+ */
+- (void) testFormatBenchmark {
+    PLCrashReportTextFormatter *textFormatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF8StringEncoding] autorelease];
+    PLCrashReportJSONFormatter *jsonFormatter = [[[PLCrashReportJSONFormatter alloc] init] autorelease];
+
+    STAssertTrue([_corpus count] > 0, @"The corpus is empty");
+
+    [self benchmark: @"text formatter (eager decode)" operation: ^BOOL (NSData *data) {
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: NULL] autorelease];
+        return report != nil && [textFormatter formatReport: report error: NULL] != nil;
+    }];
+
+    [self benchmark: @"text formatter (flat)" operation: ^BOOL (NSData *data) {
+        return [textFormatter formatReportData: data error: NULL] != nil;
+    }];
+
+    [self benchmark: @"JSON formatter (lazy decode)" operation: ^BOOL (NSData *data) {
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: NULL] autorelease];
+        return report != nil && [jsonFormatter formatReport: report error: NULL] != nil;
+    }];
+}
+
+@end
@@ -48,6 +48,9 @@
 
     /** 128-bit object UUID. May be nil. */
     NSString *_imageUUID;
+
+    /** Last path component of the image name, or nil if not yet computed. */
+    NSString *_imageFileName;
 }
 
 - (id) initWithCodeType: (PLCrashReportProcessorInfo *) processorInfo
@@ -87,4 +90,16 @@
  */
 @property(nonatomic, readonly) NSString *imageUUID;
 
+/**
+ * The last path component of the image name, or nil if the image name is unavailable. The value is computed
+ * on first access and cached.
+ */
+@property(nonatomic, readonly) NSString *imageFileName;
+
+/**
+ * The Apple crash report architecture name for the image's code type (eg, "armv7s", "x86_64"), or "???" if
+ * the code type is unavailable or unknown.
+ */
+@property(nonatomic, readonly) NSString *architectureName;
+
 @end
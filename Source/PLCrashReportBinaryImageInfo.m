@@ -28,6 +28,9 @@
 
 #import "PLCrashReportBinaryImageInfo.h"
 
+#import <libkern/OSAtomic.h>
+#import "PLCrashCompatConstants.h"
+
 /**
  * Crash Log binary image info. Represents an executable or shared library.
  */
@@ -93,8 +96,73 @@
     [_processorInfo release];
     [_imageName release];
     [_imageUUID release];
+    [_imageFileName release];
 
     [super dealloc];
 }
 
+// property getter. The file name is computed once; concurrent first accesses race to publish their result.
+- (NSString *) imageFileName {
+    NSString *fileName = _imageFileName;
+    if (fileName != nil || _imageName == nil)
+        return fileName;
+
+    fileName = [[_imageName lastPathComponent] retain];
+    if (!OSAtomicCompareAndSwapPtrBarrier(nil, fileName, (void * volatile *) &_imageFileName)) {
+        [fileName release];
+        fileName = _imageFileName;
+    }
+
+    return fileName;
+}
+
+// property getter. Returns a constant string; no per-image state is required.
+- (NSString *) architectureName {
+    if (_processorInfo == nil || _processorInfo.typeEncoding != PLCrashReportProcessorTypeEncodingMach)
+        return @"???";
+
+    switch (_processorInfo.type) {
+        case CPU_TYPE_ARM:
+            /* Apple includes subtype for ARM binaries. */
+            switch (_processorInfo.subtype) {
+                case CPU_SUBTYPE_ARM_V6:
+                    return @"armv6";
+
+                case CPU_SUBTYPE_ARM_V7:
+                    return @"armv7";
+
+                case CPU_SUBTYPE_ARM_V7S:
+                    return @"armv7s";
+
+                default:
+                    return @"arm-unknown";
+            }
+
+        case CPU_TYPE_ARM64:
+            /* Apple includes subtype for ARM64 binaries. */
+            switch (_processorInfo.subtype) {
+                case CPU_SUBTYPE_ARM_ALL:
+                    return @"arm64";
+
+                case CPU_SUBTYPE_ARM_V8:
+                    return @"armv8";
+
+                default:
+                    return @"arm64-unknown";
+            }
+
+        case CPU_TYPE_X86:
+            return @"i386";
+
+        case CPU_TYPE_X86_64:
+            return @"x86_64";
+
+        case CPU_TYPE_POWERPC:
+            return @"powerpc";
+
+        default:
+            return @"???";
+    }
+}
+
 @end
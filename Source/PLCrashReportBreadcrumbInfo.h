@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@interface PLCrashReportBreadcrumbInfo : NSObject {
+@private
+    /** The time at which the breadcrumb was recorded. */
+    NSDate *_timestamp;
+
+    /** The breadcrumb message. */
+    NSString *_message;
+}
+
++ (NSArray *) breadcrumbsWithRingData: (NSData *) ringData;
+
+- (id) initWithTimestamp: (NSDate *) timestamp message: (NSString *) message;
+
+/**
+ * The time at which the breadcrumb was recorded.
+ */
+@property(nonatomic, readonly) NSDate *timestamp;
+
+/**
+ * The breadcrumb message. Messages that exceeded the breadcrumb ring's entry size were truncated when recorded.
+ */
+@property(nonatomic, readonly) NSString *message;
+
+@end
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportBreadcrumbInfo.h"
+#import "PLCrashAsyncBreadcrumbs.h"
+
+/**
+ * @internal
+ *
+ * Breadcrumb enumeration callback; appends a PLCrashReportBreadcrumbInfo instance to the NSMutableArray
+ * provided via @a context.
+ */
+static void breadcrumb_info_append (uint64_t timestamp, const char *message, size_t length, void *context) {
+    NSMutableArray *breadcrumbs = context;
+
+    /* Truncation may have split a multibyte sequence; fall back on a lossy decoding */
+    NSString *str = [[NSString alloc] initWithBytes: message length: length encoding: NSUTF8StringEncoding];
+    if (str == nil)
+        str = [[NSString alloc] initWithBytes: message length: length encoding: NSISOLatin1StringEncoding];
+
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970: (NSTimeInterval) timestamp / 1000000.0];
+    PLCrashReportBreadcrumbInfo *info = [[PLCrashReportBreadcrumbInfo alloc] initWithTimestamp: date message: str];
+    [breadcrumbs addObject: info];
+
+    [info release];
+    [str release];
+}
+
+/**
+ * Crash log breadcrumb information.
+ *
+ * Describes a single application breadcrumb, as recorded via PLCrashReporter::appendBreadcrumb: prior to the crash.
+ */
+@implementation PLCrashReportBreadcrumbInfo
+
+/**
+ * Decode the breadcrumbs contained in a raw breadcrumb ring, as written to a crash report.
+ *
+ * @param ringData The raw ring data.
+ *
+ * @return Returns the ring's breadcrumbs (PLCrashReportBreadcrumbInfo), oldest first, or nil if @a ringData is not a
+ * valid breadcrumb ring.
+ */
++ (NSArray *) breadcrumbsWithRingData: (NSData *) ringData {
+    NSMutableArray *breadcrumbs = [NSMutableArray array];
+
+    /* The ring is decoded in place; copy it to ensure the required alignment */
+    void *ring = malloc([ringData length]);
+    if (ring == NULL)
+        return nil;
+    memcpy(ring, [ringData bytes], [ringData length]);
+
+    plcrash_error_t err = plcrash_async_breadcrumbs_enumerate(ring, [ringData length], breadcrumb_info_append, breadcrumbs);
+    free(ring);
+
+    if (err != PLCRASH_ESUCCESS)
+        return nil;
+
+    return breadcrumbs;
+}
+
+/**
+ * Initialize with the provided breadcrumb information.
+ *
+ * @param timestamp The time at which the breadcrumb was recorded.
+ * @param message The breadcrumb message.
+ */
+- (id) initWithTimestamp: (NSDate *) timestamp message: (NSString *) message {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _timestamp = [timestamp retain];
+    _message = [message retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_timestamp release];
+    [_message release];
+    [super dealloc];
+}
+
+@synthesize timestamp = _timestamp;
+@synthesize message = _message;
+
+@end
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+#import "PLCrashReport.h"
+
+/** The magic identifier of a crash report bundle, not NUL terminated. */
+#define PLCRASH_REPORT_BUNDLE_MAGIC "plcrbnd"
+
+/** The magic identifier terminating a crash report bundle's trailer, not NUL terminated. */
+#define PLCRASH_REPORT_BUNDLE_TRAILER_MAGIC "plcrbidx"
+
+/** The crash report bundle format version. */
+#define PLCRASH_REPORT_BUNDLE_VERSION 1
+
+/**
+ * Crash report bundle file header.
+ */
+struct PLCrashReportBundleHeader {
+    /** Bundle magic identifier (#PLCRASH_REPORT_BUNDLE_MAGIC), not NUL terminated. */
+    char magic[7];
+
+    /** Bundle format version (#PLCRASH_REPORT_BUNDLE_VERSION). */
+    uint8_t version;
+} __attribute__((packed));
+
+/**
+ * A crash report bundle index entry. All values are little-endian.
+ */
+struct PLCrashReportBundleIndexEntry {
+    /** The offset of the report's data from the start of the bundle. */
+    uint64_t offset;
+
+    /** The length of the report's data. */
+    uint64_t length;
+} __attribute__((packed));
+
+/**
+ * Crash report bundle trailer, terminating the bundle. All values are little-endian.
+ */
+struct PLCrashReportBundleTrailer {
+    /** The offset of the first PLCrashReportBundleIndexEntry from the start of the bundle. */
+    uint64_t index_offset;
+
+    /** The number of index entries, and reports. */
+    uint64_t count;
+
+    /** Trailer magic identifier (#PLCRASH_REPORT_BUNDLE_TRAILER_MAGIC), not NUL terminated. */
+    char magic[8];
+} __attribute__((packed));
+
+@interface PLCrashReportBundle : NSObject {
+@private
+    /** The bundle data. */
+    NSData *_data;
+
+    /** The index entries, within _data. */
+    const struct PLCrashReportBundleIndexEntry *_index;
+
+    /** The number of reports in the bundle. */
+    NSUInteger _count;
+}
+
++ (NSData *) bundleDataWithReportData: (NSArray *) reports compress: (BOOL) compress error: (NSError **) outError;
+
+- (id) initWithData: (NSData *) data error: (NSError **) outError;
+- (id) initWithContentsOfFile: (NSString *) path error: (NSError **) outError;
+
+- (NSData *) reportDataAtIndex: (NSUInteger) index;
+- (PLCrashReport *) reportAtIndex: (NSUInteger) index options: (PLCrashReportDecodingOptions) options error: (NSError **) outError;
+
+/**
+ * The number of reports in the bundle.
+ */
+@property(nonatomic, readonly) NSUInteger count;
+
+@end
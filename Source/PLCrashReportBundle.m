@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportBundle.h"
+#import "PLCrashReporterNSError.h"
+
+#import <libkern/OSByteOrder.h>
+
+/**
+ * A bundle of encoded crash reports, supporting random access to each report.
+ *
+ * Bundles allow multiple reports to be submitted in a single request. A bundle consists of a PLCrashReportBundleHeader,
+ * followed by the data of each report, exactly as would be stored in an individual report file (and optionally
+ * compressed), followed by an index of PLCrashReportBundleIndexEntry values locating each report, and finally a
+ * fixed-size PLCrashReportBundleTrailer locating the index. A reader -- including a server splitting a bundle into
+ * individual reports -- may thus locate any report from the trailer and index alone, without parsing or copying the
+ * other reports.
+ */
+@implementation PLCrashReportBundle
+
+@synthesize count = _count;
+
+/**
+ * Pack the encoded crash reports in @a reports into a single bundle.
+ *
+ * @param reports An array of NSData instances, each containing an encoded crash report, as returned by
+ * PLCrashReporter::loadPendingCrashReportDataAndReturnError: or stored in a queued report file.
+ * @param compress If YES, each report that is not already compressed will be compressed via
+ * PLCrashReport::compressedDataWithReportData:error:.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the bundle could not be created. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the bundle data, or nil on error.
+ */
++ (NSData *) bundleDataWithReportData: (NSArray *) reports compress: (BOOL) compress error: (NSError **) outError {
+    NSMutableData *bundle = [NSMutableData data];
+    NSMutableData *index = [NSMutableData dataWithCapacity: [reports count] * sizeof(struct PLCrashReportBundleIndexEntry)];
+
+    struct PLCrashReportBundleHeader header;
+    memcpy(header.magic, PLCRASH_REPORT_BUNDLE_MAGIC, sizeof(header.magic));
+    header.version = PLCRASH_REPORT_BUNDLE_VERSION;
+    [bundle appendBytes: &header length: sizeof(header)];
+
+    for (NSData *report in reports) {
+        NSData *data = report;
+        if (compress && (data = [PLCrashReport compressedDataWithReportData: report error: outError]) == nil)
+            return nil;
+
+        struct PLCrashReportBundleIndexEntry entry = {
+            .offset = OSSwapHostToLittleInt64([bundle length]),
+            .length = OSSwapHostToLittleInt64([data length])
+        };
+        [index appendBytes: &entry length: sizeof(entry)];
+        [bundle appendData: data];
+    }
+
+    struct PLCrashReportBundleTrailer trailer;
+    trailer.index_offset = OSSwapHostToLittleInt64([bundle length]);
+    trailer.count = OSSwapHostToLittleInt64([reports count]);
+    memcpy(trailer.magic, PLCRASH_REPORT_BUNDLE_TRAILER_MAGIC, sizeof(trailer.magic));
+
+    [bundle appendData: index];
+    [bundle appendBytes: &trailer length: sizeof(trailer)];
+
+    return bundle;
+}
+
+/**
+ * Initialize with the provided bundle data. Only the header, trailer, and index are validated; the reports
+ * themselves are not read until requested.
+ *
+ * @param data Bundle data, as returned by PLCrashReportBundle::bundleDataWithReportData:compress:error:.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the bundle could not be read. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the initialized bundle, or nil if the bundle is invalid.
+ */
+- (id) initWithData: (NSData *) data error: (NSError **) outError {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    const struct PLCrashReportBundleHeader *header = [data bytes];
+    const struct PLCrashReportBundleTrailer *trailer;
+    uint64_t length = [data length];
+
+    if (length < sizeof(*header) + sizeof(*trailer) ||
+        memcmp(header->magic, PLCRASH_REPORT_BUNDLE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != PLCRASH_REPORT_BUNDLE_VERSION)
+    {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode invalid crash report bundle header", nil);
+        [self release];
+        return nil;
+    }
+
+    trailer = (const struct PLCrashReportBundleTrailer *) ((const uint8_t *) [data bytes] + length - sizeof(*trailer));
+    uint64_t indexOffset = OSSwapLittleToHostInt64(trailer->index_offset);
+    uint64_t count = OSSwapLittleToHostInt64(trailer->count);
+    uint64_t indexEnd = length - sizeof(*trailer);
+
+    /* Validate the index location; the count is bounded before computing the index size, preventing overflow */
+    if (memcmp(trailer->magic, PLCRASH_REPORT_BUNDLE_TRAILER_MAGIC, sizeof(trailer->magic)) != 0 ||
+        indexOffset < sizeof(*header) || indexOffset > indexEnd ||
+        count > (indexEnd - indexOffset) / sizeof(struct PLCrashReportBundleIndexEntry) ||
+        indexOffset + count * sizeof(struct PLCrashReportBundleIndexEntry) != indexEnd)
+    {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode truncated or corrupt crash report bundle index", nil);
+        [self release];
+        return nil;
+    }
+
+    /* Validate each entry against the report data region */
+    const struct PLCrashReportBundleIndexEntry *index = (const struct PLCrashReportBundleIndexEntry *) ((const uint8_t *) [data bytes] + indexOffset);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t offset = OSSwapLittleToHostInt64(index[i].offset);
+        uint64_t entryLength = OSSwapLittleToHostInt64(index[i].length);
+
+        if (offset < sizeof(*header) || offset > indexOffset || entryLength > indexOffset - offset) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode corrupt crash report bundle index entry", nil);
+            [self release];
+            return nil;
+        }
+    }
+
+    _data = [data copy];
+    _index = (const struct PLCrashReportBundleIndexEntry *) ((const uint8_t *) [_data bytes] + indexOffset);
+    _count = (NSUInteger) count;
+
+    return self;
+}
+
+/**
+ * Initialize with the bundle at @a path. The file is memory-mapped, and only the reports that are requested are
+ * paged in.
+ *
+ * @param path The bundle path.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the bundle could not be read. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the initialized bundle, or nil if the bundle could not be read or is invalid.
+ */
+- (id) initWithContentsOfFile: (NSString *) path error: (NSError **) outError {
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: outError];
+    if (data == nil) {
+        [self release];
+        return nil;
+    }
+
+    return [self initWithData: data error: outError];
+}
+
+- (void) dealloc {
+    [_data release];
+    [super dealloc];
+}
+
+/**
+ * Return the encoded data of the report at @a index, exactly as it was added to the bundle. The data may be
+ * compressed, and may be decoded directly via PLCrashReport::initWithData:error:.
+ *
+ * @param index The report index. Must be less than PLCrashReportBundle::count.
+ */
+- (NSData *) reportDataAtIndex: (NSUInteger) index {
+    NSParameterAssert(index < _count);
+
+    NSRange range = NSMakeRange((NSUInteger) OSSwapLittleToHostInt64(_index[index].offset), (NSUInteger) OSSwapLittleToHostInt64(_index[index].length));
+    return [_data subdataWithRange: range];
+}
+
+/**
+ * Decode the report at @a index. No other report in the bundle is read.
+ *
+ * @param index The report index. Must be less than PLCrashReportBundle::count.
+ * @param options The decoding options.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be decoded. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the decoded report, or nil on error.
+ */
+- (PLCrashReport *) reportAtIndex: (NSUInteger) index options: (PLCrashReportDecodingOptions) options error: (NSError **) outError {
+    return [[[PLCrashReport alloc] initWithData: [self reportDataAtIndex: index] options: options error: outError] autorelease];
+}
+
+@end
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashReportBundle.h"
+#import "PLCrashReporter.h"
+#import "PLCrashAsyncCompressor.h"
+
+#import <libkern/OSByteOrder.h>
+
+@interface PLCrashReportBundleTests : SenTestCase {
+    /** Encoded live reports. */
+    NSArray *_reports;
+}
+@end
+
+@implementation PLCrashReportBundleTests
+
+- (void) setUp {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSMutableArray *reports = [NSMutableArray array];
+    NSError *error;
+
+    for (NSUInteger i = 0; i < 3; i++) {
+        NSData *data = [reporter generateLiveReportAndReturnError: &error];
+        STAssertNotNil(data, @"Failed to generate live report: %@", error);
+        [reports addObject: data];
+    }
+
+    _reports = [reports copy];
+}
+
+- (void) tearDown {
+    [_reports release];
+}
+
+/**
+ * Verify that each report may be retrieved and decoded from an uncompressed bundle.
+ */
+- (void) testRoundTrip {
+    NSError *error;
+    NSData *data = [PLCrashReportBundle bundleDataWithReportData: _reports compress: NO error: &error];
+    STAssertNotNil(data, @"Failed to create bundle: %@", error);
+
+    PLCrashReportBundle *bundle = [[[PLCrashReportBundle alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(bundle, @"Failed to read bundle: %@", error);
+    STAssertEquals(bundle.count, [_reports count], @"Incorrect report count");
+
+    /* Read the reports in reverse, verifying that no report depends on those preceding it */
+    for (NSUInteger i = bundle.count; i > 0; i--) {
+        STAssertEqualObjects([bundle reportDataAtIndex: i - 1], [_reports objectAtIndex: i - 1], @"Incorrect data for report %lu", (unsigned long) i - 1);
+
+        PLCrashReport *report = [bundle reportAtIndex: i - 1 options: PLCrashReportDecodingOptionLazy error: &error];
+        STAssertNotNil(report, @"Failed to decode report: %@", error);
+        STAssertNotNil(report.crashedThread, @"Report is missing a crashed thread");
+    }
+}
+
+/**
+ * Verify that compressed bundle reports are compressed, and decode transparently.
+ */
+- (void) testCompressed {
+    NSError *error;
+    NSData *data = [PLCrashReportBundle bundleDataWithReportData: _reports compress: YES error: &error];
+    STAssertNotNil(data, @"Failed to create bundle: %@", error);
+
+    PLCrashReportBundle *bundle = [[[PLCrashReportBundle alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(bundle, @"Failed to read bundle: %@", error);
+
+    for (NSUInteger i = 0; i < bundle.count; i++) {
+        NSData *reportData = [bundle reportDataAtIndex: i];
+        STAssertTrue(plcrash_async_compressed_is_compressed([reportData bytes], [reportData length]), @"Report %lu was not compressed", (unsigned long) i);
+        STAssertNotNil([bundle reportAtIndex: i options: 0 error: &error], @"Failed to decode report: %@", error);
+    }
+}
+
+/**
+ * Verify handling of empty, truncated, and corrupt bundles.
+ */
+- (void) testInvalid {
+    NSError *error;
+
+    NSData *empty = [PLCrashReportBundle bundleDataWithReportData: [NSArray array] compress: NO error: &error];
+    PLCrashReportBundle *bundle = [[[PLCrashReportBundle alloc] initWithData: empty error: &error] autorelease];
+    STAssertNotNil(bundle, @"Failed to read empty bundle: %@", error);
+    STAssertEquals(bundle.count, (NSUInteger) 0, @"Incorrect report count");
+
+    NSData *data = [PLCrashReportBundle bundleDataWithReportData: _reports compress: NO error: &error];
+    NSData *truncated = [data subdataWithRange: NSMakeRange(0, [data length] - 1)];
+    STAssertNil([[[PLCrashReportBundle alloc] initWithData: truncated error: NULL] autorelease], @"A truncated bundle should be rejected");
+
+    /* Point the first index entry beyond the report data */
+    NSMutableData *corrupt = [[data mutableCopy] autorelease];
+    struct PLCrashReportBundleTrailer trailer;
+    [corrupt getBytes: &trailer range: NSMakeRange([corrupt length] - sizeof(trailer), sizeof(trailer))];
+    uint64_t offset = OSSwapHostToLittleInt64([corrupt length]);
+    [corrupt replaceBytesInRange: NSMakeRange((NSUInteger) OSSwapLittleToHostInt64(trailer.index_offset), sizeof(offset)) withBytes: &offset];
+    STAssertNil([[[PLCrashReportBundle alloc] initWithData: corrupt error: NULL] autorelease], @"A corrupt index should be rejected");
+}
+
+@end
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@interface PLCrashReportFrameRepeatInfo : NSObject {
+@private
+    /** Index of the first frame of the repeated run. */
+    NSUInteger _frameIndex;
+
+    /** Number of frames in the repeated run. */
+    NSUInteger _frameCount;
+
+    /** Number of omitted repetitions of the run. */
+    NSUInteger _repeatCount;
+}
+
+- (id) initWithFrameIndex: (NSUInteger) frameIndex frameCount: (NSUInteger) frameCount repeatCount: (NSUInteger) repeatCount;
+
+/**
+ * The index of the run's first frame within the thread's stack frames.
+ */
+@property(nonatomic, readonly) NSUInteger frameIndex;
+
+/**
+ * The number of frames in the run.
+ */
+@property(nonatomic, readonly) NSUInteger frameCount;
+
+/**
+ * The number of additional times the run was repeated. The repetitions are not included in the thread's stack
+ * frames, and immediately follow the run's first occurrence.
+ */
+@property(nonatomic, readonly) NSUInteger repeatCount;
+
+@end
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportFrameRepeatInfo.h"
+
+/**
+ * Crash log repeated stack frame information.
+ *
+ * Describes a run of consecutively repeated stack frames, such as those produced by recursion, that was collapsed into
+ * its first occurrence when the crash report was written.
+ */
+@implementation PLCrashReportFrameRepeatInfo
+
+/**
+ * Initialize with the provided run information.
+ */
+- (id) initWithFrameIndex: (NSUInteger) frameIndex frameCount: (NSUInteger) frameCount repeatCount: (NSUInteger) repeatCount {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _frameIndex = frameIndex;
+    _frameCount = frameCount;
+    _repeatCount = repeatCount;
+
+    return self;
+}
+
+@synthesize frameIndex = _frameIndex;
+@synthesize frameCount = _frameCount;
+@synthesize repeatCount = _repeatCount;
+
+@end
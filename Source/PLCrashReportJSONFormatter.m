@@ -0,0 +1,649 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "CrashReporter/CrashReporter.h"
+
+#import "PLCrashReportJSONFormatter.h"
+#import "PLCrashReportTextWriter.h"
+
+@interface PLCrashReportJSONFormatter (PrivateMethods)
++ (void) writeCrashReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) json;
++ (void) writeThread: (PLCrashReportThreadInfo *) thread toWriter: (PLCrashReportTextWriter *) json;
++ (void) writeImage: (PLCrashReportBinaryImageInfo *) imageInfo toWriter: (PLCrashReportTextWriter *) json;
+- (BOOL) formatReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) writer error: (NSError **) outError;
+@end
+
+/**
+ * @internal
+ *
+ * Write @a length bytes of UTF-8 text to @a json as a quoted JSON string, escaping quotes, backslashes, and
+ * control characters. Non-ASCII characters are written as UTF-8.
+ */
+static void json_utf8_string (PLCrashReportTextWriter *json, const char *text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    const char *run = text;
+
+    [json appendUTF8: "\"" length: 1];
+    for (const char *p = text; p < text + length; p++) {
+        unsigned char c = (unsigned char) *p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        /* Flush the unescaped run preceding this character */
+        [json appendUTF8: run length: p - run];
+        run = p + 1;
+
+        switch (c) {
+            case '"':  [json appendUTF8: "\\\"" length: 2]; break;
+            case '\\': [json appendUTF8: "\\\\" length: 2]; break;
+            case '\n': [json appendUTF8: "\\n" length: 2]; break;
+            case '\r': [json appendUTF8: "\\r" length: 2]; break;
+            case '\t': [json appendUTF8: "\\t" length: 2]; break;
+            default: {
+                char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                [json appendUTF8: escape length: sizeof(escape)];
+                break;
+            }
+        }
+    }
+    [json appendUTF8: run length: (text + length) - run];
+    [json appendUTF8: "\"" length: 1];
+}
+
+/**
+ * @internal
+ *
+ * Write @a string to @a json as a quoted JSON string, or as null if @a string is nil.
+ */
+static void json_string (PLCrashReportTextWriter *json, NSString *string) {
+    const char *utf8 = [string UTF8String];
+    if (utf8 == NULL) {
+        [json appendUTF8: "null" length: 4];
+        return;
+    }
+
+    json_utf8_string(json, utf8, strlen(utf8));
+}
+
+/**
+ * @internal
+ *
+ * Write an object member name to @a json, preceded by a separator unless this is the first member of the
+ * enclosing object.
+ *
+ * @param json The output writer.
+ * @param first The enclosing object's first-member flag; cleared on return.
+ * @param name The member name. Member names are ASCII literals, and are not escaped.
+ */
+static void json_key (PLCrashReportTextWriter *json, BOOL *first, const char *name) {
+    if (!*first)
+        [json appendUTF8: "," length: 1];
+    *first = NO;
+
+    [json appendUTF8: "\"" length: 1];
+    [json appendCString: name];
+    [json appendUTF8: "\":" length: 2];
+}
+
+/**
+ * @internal
+ *
+ * Write @a value to @a json as a quoted "0x"-prefixed hexadecimal string. Addresses are written as strings, as JSON
+ * numbers are not reliably decoded with 64-bit precision.
+ */
+static void json_hex (PLCrashReportTextWriter *json, uint64_t value) {
+    [json appendUTF8: "\"0x" length: 3];
+    [json appendHex: value digits: 1];
+    [json appendUTF8: "\"" length: 1];
+}
+
+/**
+ * @internal
+ *
+ * Write @a value to @a json as a decimal number.
+ */
+static void json_integer (PLCrashReportTextWriter *json, int64_t value) {
+    [json appendDecimal: value width: 0];
+}
+
+/**
+ * @internal
+ *
+ * Write @a value to @a json as a boolean.
+ */
+static void json_bool (PLCrashReportTextWriter *json, BOOL value) {
+    if (value)
+        [json appendUTF8: "true" length: 4];
+    else
+        [json appendUTF8: "false" length: 5];
+}
+
+/**
+ * @internal
+ *
+ * Write @a date to @a json as whole seconds since the UNIX epoch, or as null if @a date is nil.
+ */
+static void json_date (PLCrashReportTextWriter *json, NSDate *date) {
+    if (date == nil) {
+        [json appendUTF8: "null" length: 4];
+        return;
+    }
+
+    json_integer(json, (int64_t) [date timeIntervalSince1970]);
+}
+
+/**
+ * @internal
+ *
+ * Write @a processorInfo to @a json as an object, or as null if @a processorInfo is nil.
+ */
+static void json_processor (PLCrashReportTextWriter *json, PLCrashReportProcessorInfo *processorInfo) {
+    if (processorInfo == nil) {
+        [json appendUTF8: "null" length: 4];
+        return;
+    }
+
+    BOOL first = YES;
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &first, "encoding");
+    switch (processorInfo.typeEncoding) {
+        case PLCrashReportProcessorTypeEncodingMach:
+            [json appendCString: "\"mach\""];
+            break;
+
+        default:
+            [json appendCString: "\"unknown\""];
+            break;
+    }
+    json_key(json, &first, "type");
+    json_integer(json, (int64_t) processorInfo.type);
+    json_key(json, &first, "subtype");
+    json_integer(json, (int64_t) processorInfo.subtype);
+    [json appendUTF8: "}" length: 1];
+}
+
+/**
+ * Formats PLCrashReport data as JSON.
+ *
+ * The report is written as a single JSON object, incrementally and without building an intermediate object graph;
+ * stack frames and registers are read from the thread records' flat storage, and no per-frame objects are created.
+ * When combined with PLCrashReportDecodingOptionLazy and the stream or file descriptor output methods, the formatted
+ * text is never held in memory in full.
+ *
+ * Addresses are written as "0x"-prefixed hexadecimal strings, and dates as whole seconds since the UNIX epoch. Output
+ * is always encoded as UTF-8.
+ */
+@implementation PLCrashReportJSONFormatter
+
+/**
+ * Format the provided @a report as JSON, and return the formatted result as a string.
+ *
+ * @param report The report to format.
+ *
+ * @return Returns the formatted result on success, or nil if an error occurs.
+ */
++ (NSString *) stringValueForCrashReport: (PLCrashReport *) report {
+    NSMutableString *result = [NSMutableString string];
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithString: result] autorelease];
+
+    [self writeCrashReport: report toWriter: writer];
+    [writer flush];
+
+    return result;
+}
+
+// from PLCrashReportFormatter protocol
+- (NSData *) formatReport: (PLCrashReport *) report error: (NSError **) outError {
+    NSMutableData *data = [NSMutableData data];
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithData: data encoding: NSUTF8StringEncoding] autorelease];
+
+    if (![self formatReport: report toWriter: writer error: outError])
+        return nil;
+
+    return data;
+}
+
+/**
+ * Format the provided @a report, incrementally writing the JSON text to @a stream.
+ *
+ * @param report Report to be formatted.
+ * @param stream An open output stream to which the formatted report will be written.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be written. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if writing to @a stream failed.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toOutputStream: (NSOutputStream *) stream error: (NSError **) outError {
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithOutputStream: stream encoding: NSUTF8StringEncoding] autorelease];
+    return [self formatReport: report toWriter: writer error: outError];
+}
+
+/**
+ * Format the provided @a report, incrementally writing the JSON text to the file descriptor @a fd.
+ *
+ * @param report Report to be formatted.
+ * @param fd An open file descriptor to which the formatted report will be written. The caller retains ownership
+ * of the descriptor.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be written. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if writing to @a fd failed.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toFileDescriptor: (int) fd error: (NSError **) outError {
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithFileDescriptor: fd encoding: NSUTF8StringEncoding] autorelease];
+    return [self formatReport: report toWriter: writer error: outError];
+}
+
+@end
+
+
+@implementation PLCrashReportJSONFormatter (PrivateMethods)
+
+/**
+ * Format @a report to @a writer, flushing any remaining output.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) writer error: (NSError **) outError {
+    [PLCrashReportJSONFormatter writeCrashReport: report toWriter: writer];
+    if (![writer flush]) {
+        if (outError != NULL)
+            *outError = writer.error;
+        return NO;
+    }
+
+    return YES;
+}
+
+/**
+ * Write @a thread to @a json as an object.
+ */
++ (void) writeThread: (PLCrashReportThreadInfo *) thread toWriter: (PLCrashReportTextWriter *) json {
+    BOOL first = YES;
+
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &first, "number");
+    json_integer(json, thread.threadNumber);
+    json_key(json, &first, "crashed");
+    json_bool(json, thread.crashed);
+
+    if (thread.dispatchQueueLabel != nil) {
+        json_key(json, &first, "dispatch_queue");
+        json_string(json, thread.dispatchQueueLabel);
+    }
+
+    if (thread.secondaryCrashSignalInfo != nil) {
+        PLCrashReportSignalInfo *signalInfo = thread.secondaryCrashSignalInfo;
+        BOOL member = YES;
+
+        json_key(json, &first, "secondary_crash");
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &member, "name");
+        json_string(json, signalInfo.name);
+        json_key(json, &member, "code");
+        json_string(json, signalInfo.code);
+        json_key(json, &member, "address");
+        json_hex(json, signalInfo.address);
+        [json appendUTF8: "}" length: 1];
+    }
+
+    /* Frames are read from the flat frame storage; PLCrashReportStackFrameInfo instances are never created */
+    const uint64_t *pcs = thread.instructionPointers;
+    json_key(json, &first, "frames");
+    [json appendUTF8: "[" length: 1];
+    for (NSUInteger i = 0; i < thread.frameCount; i++) {
+        BOOL frameFirst = YES;
+
+        if (i > 0)
+            [json appendUTF8: "," length: 1];
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &frameFirst, "pc");
+        json_hex(json, pcs[i]);
+
+        NSString *symbolName = [thread symbolNameAtIndex: i];
+        if (symbolName != nil) {
+            json_key(json, &frameFirst, "symbol");
+            json_string(json, symbolName);
+            json_key(json, &frameFirst, "symbol_start");
+            json_hex(json, [thread symbolStartAddressAtIndex: i]);
+        }
+        [json appendUTF8: "}" length: 1];
+    }
+    [json appendUTF8: "]" length: 1];
+
+    if (thread.omittedFrameCount > 0) {
+        json_key(json, &first, "omitted_frame_count");
+        json_integer(json, thread.omittedFrameCount);
+        json_key(json, &first, "omitted_frame_index");
+        json_integer(json, thread.omittedFrameIndex);
+    }
+
+    if ([thread.frameRepeats count] > 0) {
+        BOOL repeatFirst = YES;
+
+        json_key(json, &first, "frame_repeats");
+        [json appendUTF8: "[" length: 1];
+        for (PLCrashReportFrameRepeatInfo *repeat in thread.frameRepeats) {
+            BOOL memberFirst = YES;
+
+            if (!repeatFirst)
+                [json appendUTF8: "," length: 1];
+            repeatFirst = NO;
+
+            [json appendUTF8: "{" length: 1];
+            json_key(json, &memberFirst, "index");
+            json_integer(json, repeat.frameIndex);
+            json_key(json, &memberFirst, "count");
+            json_integer(json, repeat.frameCount);
+            json_key(json, &memberFirst, "repeat_count");
+            json_integer(json, repeat.repeatCount);
+            [json appendUTF8: "}" length: 1];
+        }
+        [json appendUTF8: "]" length: 1];
+    }
+
+    if (thread.registerCount > 0) {
+        BOOL regFirst = YES;
+        const uint64_t *values = thread.registerValues;
+
+        json_key(json, &first, "registers");
+        [json appendUTF8: "{" length: 1];
+        for (NSUInteger i = 0; i < thread.registerCount; i++) {
+            if (!regFirst)
+                [json appendUTF8: "," length: 1];
+            regFirst = NO;
+
+            json_string(json, [thread registerNameAtIndex: i]);
+            [json appendUTF8: ":" length: 1];
+            json_hex(json, values[i]);
+        }
+        [json appendUTF8: "}" length: 1];
+    }
+
+    [json appendUTF8: "}" length: 1];
+}
+
+/**
+ * Write @a imageInfo to @a json as an object.
+ */
++ (void) writeImage: (PLCrashReportBinaryImageInfo *) imageInfo toWriter: (PLCrashReportTextWriter *) json {
+    BOOL first = YES;
+
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &first, "base");
+    json_hex(json, imageInfo.imageBaseAddress);
+    json_key(json, &first, "size");
+    json_integer(json, (int64_t) imageInfo.imageSize);
+    json_key(json, &first, "name");
+    json_string(json, imageInfo.imageName);
+    json_key(json, &first, "uuid");
+    json_string(json, imageInfo.hasImageUUID ? imageInfo.imageUUID : nil);
+    json_key(json, &first, "arch");
+    json_string(json, imageInfo.architectureName);
+    [json appendUTF8: "}" length: 1];
+}
+
+/**
+ * Write @a report to @a json as a single JSON object.
+ *
+ * @param report The report to format.
+ * @param json The output writer.
+ */
++ (void) writeCrashReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) json {
+    BOOL first = YES;
+    BOOL member;
+
+    [json appendUTF8: "{" length: 1];
+
+    /* Report identifier */
+    if (report.uuidRef != NULL) {
+        NSString *uuid = [(NSString *) CFUUIDCreateString(NULL, report.uuidRef) autorelease];
+        json_key(json, &first, "uuid");
+        json_string(json, uuid);
+    }
+
+    /* System */
+    PLCrashReportSystemInfo *systemInfo = report.systemInfo;
+    json_key(json, &first, "system");
+    member = YES;
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &member, "os");
+    switch (systemInfo.operatingSystem) {
+        case PLCrashReportOperatingSystemMacOSX:
+            json_string(json, @"Mac OS X");
+            break;
+        case PLCrashReportOperatingSystemiPhoneOS:
+            json_string(json, @"iPhone OS");
+            break;
+        case PLCrashReportOperatingSystemiPhoneSimulator:
+            json_string(json, @"iPhone Simulator");
+            break;
+        default:
+            json_string(json, @"Unknown");
+            break;
+    }
+    json_key(json, &member, "os_version");
+    json_string(json, systemInfo.operatingSystemVersion);
+    json_key(json, &member, "os_build");
+    json_string(json, systemInfo.operatingSystemBuild);
+    json_key(json, &member, "timestamp");
+    json_date(json, systemInfo.timestamp);
+    [json appendUTF8: "}" length: 1];
+
+    /* Machine */
+    if (report.hasMachineInfo) {
+        PLCrashReportMachineInfo *machineInfo = report.machineInfo;
+
+        json_key(json, &first, "machine");
+        member = YES;
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &member, "model");
+        json_string(json, machineInfo.modelName);
+        json_key(json, &member, "processor");
+        json_processor(json, machineInfo.processorInfo);
+        json_key(json, &member, "processor_count");
+        json_integer(json, machineInfo.processorCount);
+        json_key(json, &member, "logical_processor_count");
+        json_integer(json, machineInfo.logicalProcessorCount);
+        [json appendUTF8: "}" length: 1];
+    }
+
+    /* Application */
+    PLCrashReportApplicationInfo *applicationInfo = report.applicationInfo;
+    json_key(json, &first, "application");
+    member = YES;
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &member, "identifier");
+    json_string(json, applicationInfo.applicationIdentifier);
+    json_key(json, &member, "version");
+    json_string(json, applicationInfo.applicationVersion);
+    json_key(json, &member, "marketing_version");
+    json_string(json, applicationInfo.applicationMarketingVersion);
+    [json appendUTF8: "}" length: 1];
+
+    /* Process */
+    if (report.hasProcessInfo) {
+        PLCrashReportProcessInfo *processInfo = report.processInfo;
+
+        json_key(json, &first, "process");
+        member = YES;
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &member, "name");
+        json_string(json, processInfo.processName);
+        json_key(json, &member, "pid");
+        json_integer(json, processInfo.processID);
+        json_key(json, &member, "path");
+        json_string(json, processInfo.processPath);
+        json_key(json, &member, "start_time");
+        json_date(json, processInfo.processStartTime);
+        json_key(json, &member, "parent_name");
+        json_string(json, processInfo.parentProcessName);
+        json_key(json, &member, "parent_pid");
+        json_integer(json, processInfo.parentProcessID);
+        json_key(json, &member, "native");
+        json_bool(json, processInfo.native);
+        [json appendUTF8: "}" length: 1];
+    }
+
+    /* Signal */
+    PLCrashReportSignalInfo *signalInfo = report.signalInfo;
+    json_key(json, &first, "signal");
+    member = YES;
+    [json appendUTF8: "{" length: 1];
+    json_key(json, &member, "name");
+    json_string(json, signalInfo.name);
+    json_key(json, &member, "code");
+    json_string(json, signalInfo.code);
+    json_key(json, &member, "address");
+    json_hex(json, signalInfo.address);
+    [json appendUTF8: "}" length: 1];
+
+    /* Mach exception */
+    if (report.machExceptionInfo != nil) {
+        PLCrashReportMachExceptionInfo *machExceptionInfo = report.machExceptionInfo;
+        BOOL codeFirst = YES;
+
+        json_key(json, &first, "mach_exception");
+        member = YES;
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &member, "type");
+        json_integer(json, (int64_t) machExceptionInfo.type);
+        json_key(json, &member, "codes");
+        [json appendUTF8: "[" length: 1];
+        for (NSNumber *code in machExceptionInfo.codes) {
+            if (!codeFirst)
+                [json appendUTF8: "," length: 1];
+            codeFirst = NO;
+            json_hex(json, [code unsignedLongLongValue]);
+        }
+        [json appendUTF8: "]}" length: 2];
+    }
+
+    /* Uncaught exception */
+    if (report.hasExceptionInfo) {
+        PLCrashReportExceptionInfo *exceptionInfo = report.exceptionInfo;
+
+        json_key(json, &first, "exception");
+        member = YES;
+        [json appendUTF8: "{" length: 1];
+        json_key(json, &member, "name");
+        json_string(json, exceptionInfo.exceptionName);
+        json_key(json, &member, "reason");
+        json_string(json, exceptionInfo.exceptionReason);
+
+        if (exceptionInfo.stackFrames != nil) {
+            BOOL frameFirst = YES;
+
+            json_key(json, &member, "frames");
+            [json appendUTF8: "[" length: 1];
+            for (PLCrashReportStackFrameInfo *frameInfo in exceptionInfo.stackFrames) {
+                BOOL frameMember = YES;
+
+                if (!frameFirst)
+                    [json appendUTF8: "," length: 1];
+                frameFirst = NO;
+
+                [json appendUTF8: "{" length: 1];
+                json_key(json, &frameMember, "pc");
+                json_hex(json, frameInfo.instructionPointer);
+                if (frameInfo.symbolInfo != nil) {
+                    json_key(json, &frameMember, "symbol");
+                    json_string(json, frameInfo.symbolInfo.symbolName);
+                    json_key(json, &frameMember, "symbol_start");
+                    json_hex(json, frameInfo.symbolInfo.startAddress);
+                }
+                [json appendUTF8: "}" length: 1];
+            }
+            [json appendUTF8: "]" length: 1];
+        }
+        [json appendUTF8: "}" length: 1];
+    }
+
+    /* Launch crash state */
+    if (report.launchCrashCount > 0) {
+        json_key(json, &first, "launch_crash_count");
+        json_integer(json, report.launchCrashCount);
+        json_key(json, &first, "stack_hash");
+        json_hex(json, report.stackHash);
+    }
+
+    json_key(json, &first, "reduced");
+    json_bool(json, report.isReducedReport);
+
+    json_key(json, &first, "truncated");
+    json_bool(json, report.truncated);
+
+    /* Threads */
+    json_key(json, &first, "threads");
+    [json appendUTF8: "[" length: 1];
+    member = YES;
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        if (!member)
+            [json appendUTF8: "," length: 1];
+        member = NO;
+        [self writeThread: thread toWriter: json];
+    }
+    [json appendUTF8: "]" length: 1];
+
+    /* Images */
+    json_key(json, &first, "images");
+    [json appendUTF8: "[" length: 1];
+    member = YES;
+    for (PLCrashReportBinaryImageInfo *imageInfo in report.images) {
+        if (!member)
+            [json appendUTF8: "," length: 1];
+        member = NO;
+        [self writeImage: imageInfo toWriter: json];
+    }
+    [json appendUTF8: "]" length: 1];
+
+    /* Breadcrumbs */
+    if ([report.breadcrumbs count] > 0) {
+        json_key(json, &first, "breadcrumbs");
+        [json appendUTF8: "[" length: 1];
+        member = YES;
+        for (PLCrashReportBreadcrumbInfo *breadcrumb in report.breadcrumbs) {
+            BOOL crumbMember = YES;
+
+            if (!member)
+                [json appendUTF8: "," length: 1];
+            member = NO;
+
+            [json appendUTF8: "{" length: 1];
+            json_key(json, &crumbMember, "timestamp");
+            json_date(json, breadcrumb.timestamp);
+            json_key(json, &crumbMember, "message");
+            json_string(json, breadcrumb.message);
+            [json appendUTF8: "}" length: 1];
+        }
+        [json appendUTF8: "]" length: 1];
+    }
+
+    [json appendUTF8: "}\n" length: 2];
+}
+
+@end
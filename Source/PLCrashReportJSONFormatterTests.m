@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashReport.h"
+#import "PLCrashReporter.h"
+#import "PLCrashReportJSONFormatter.h"
+
+@interface PLCrashReportJSONFormatterTests : SenTestCase {
+@private
+    /** Encoded live report data. */
+    NSData *_reportData;
+
+    /** The decoded live report. */
+    PLCrashReport *_report;
+}
+@end
+
+@implementation PLCrashReportJSONFormatterTests
+
+- (void) setUp {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    _reportData = [[reporter generateLiveReportAndReturnError: &error] retain];
+    STAssertNotNil(_reportData, @"Failed to generate live report: %@", error);
+
+    _report = [[PLCrashReport alloc] initWithData: _reportData error: &error];
+    STAssertNotNil(_report, @"Could not parse geneated live report: %@", error);
+}
+
+- (void) tearDown {
+    [_report release];
+    [_reportData release];
+}
+
+/**
+ * Verify that the output is valid JSON, and matches the report.
+ */
+- (void) testFormatReport {
+    PLCrashReportJSONFormatter *formatter = [[[PLCrashReportJSONFormatter alloc] init] autorelease];
+    NSError *error;
+
+    NSData *data = [formatter formatReport: _report error: &error];
+    STAssertNotNil(data, @"Failed to format report: %@", error);
+    STAssertEqualObjects(data, [[PLCrashReportJSONFormatter stringValueForCrashReport: _report] dataUsingEncoding: NSUTF8StringEncoding], @"Formatted data does not match");
+
+    NSDictionary *json = [NSJSONSerialization JSONObjectWithData: data options: 0 error: &error];
+    STAssertNotNil(json, @"Output is not valid JSON: %@", error);
+
+    NSArray *threads = [json objectForKey: @"threads"];
+    STAssertEquals([threads count], [_report.threads count], @"Incorrect thread count");
+    for (NSUInteger i = 0; i < [threads count]; i++) {
+        PLCrashReportThreadInfo *thread = [_report.threads objectAtIndex: i];
+        NSArray *frames = [[threads objectAtIndex: i] objectForKey: @"frames"];
+
+        STAssertEquals([frames count], thread.frameCount, @"Incorrect frame count");
+        for (NSUInteger f = 0; f < [frames count]; f++) {
+            NSString *pc = [NSString stringWithFormat: @"0x%" PRIx64, [thread instructionPointerAtIndex: f]];
+            STAssertEqualObjects([[frames objectAtIndex: f] objectForKey: @"pc"], pc, @"Incorrect frame address");
+        }
+    }
+
+    NSArray *images = [json objectForKey: @"images"];
+    STAssertEquals([images count], [_report.images count], @"Incorrect image count");
+    for (NSUInteger i = 0; i < [images count]; i++) {
+        PLCrashReportBinaryImageInfo *imageInfo = [_report.images objectAtIndex: i];
+        STAssertEqualObjects([[images objectAtIndex: i] objectForKey: @"name"], imageInfo.imageName, @"Incorrect image name");
+    }
+
+    STAssertEqualObjects([[json objectForKey: @"signal"] objectForKey: @"name"], _report.signalInfo.name, @"Incorrect signal name");
+}
+
+/**
+ * Verify that lazily decoded reports produce identical output.
+ */
+- (void) testFormatLazyReport {
+    NSError *error;
+    PLCrashReport *lazy = [[[PLCrashReport alloc] initWithData: _reportData options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+    STAssertNotNil(lazy, @"Could not lazily decode report: %@", error);
+
+    STAssertEqualObjects([PLCrashReportJSONFormatter stringValueForCrashReport: lazy],
+                         [PLCrashReportJSONFormatter stringValueForCrashReport: _report],
+                         @"Lazy decoding produced different output");
+}
+
+/**
+ * Verify streaming output to an NSOutputStream.
+ */
+- (void) testFormatReportToOutputStream {
+    NSString *expected = [PLCrashReportJSONFormatter stringValueForCrashReport: _report];
+    PLCrashReportJSONFormatter *formatter = [[[PLCrashReportJSONFormatter alloc] init] autorelease];
+    NSError *error;
+
+    NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+    [stream open];
+    STAssertTrue([formatter formatReport: _report toOutputStream: stream error: &error], @"Failed to write report: %@", error);
+
+    NSData *data = [stream propertyForKey: NSStreamDataWrittenToMemoryStreamKey];
+    [stream close];
+
+    STAssertEqualObjects(data, [expected dataUsingEncoding: NSUTF8StringEncoding], @"Streamed data does not match");
+
+    /* Writes to an invalid descriptor must fail */
+    error = nil;
+    STAssertFalse([formatter formatReport: _report toFileDescriptor: -1 error: &error], @"Write to an invalid descriptor succeeded");
+    STAssertNotNil(error, @"No error returned");
+}
+
+@end
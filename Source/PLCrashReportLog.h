@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+@interface PLCrashReportLog : NSObject {
+@private
+    /** The segment directory. */
+    NSString *_directory;
+
+    /** The size at which a segment is sealed, and a new segment is started. */
+    NSUInteger _segmentSize;
+
+    /** The current segment's file descriptor, or -1 if no segment is open for writing. */
+    int _fd;
+
+    /** The current segment's length, in bytes. Only valid if _fd is open. */
+    uint64_t _segmentLength;
+
+    /** YES once the last segment left by a previous instance has been considered for resumption. */
+    BOOL _resumeChecked;
+}
+
+- (id) initWithDirectory: (NSString *) directory segmentSize: (NSUInteger) segmentSize;
+
+- (BOOL) appendReportData: (NSData *) data error: (NSError **) outError;
+
+- (NSEnumerator *) recordEnumerator;
+
+- (BOOL) compactRetainingRecordsPassingTest: (BOOL (^)(NSData *record)) predicate error: (NSError **) outError;
+- (BOOL) purgeAndReturnError: (NSError **) outError;
+
+@end
@@ -0,0 +1,659 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportLog.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsyncChecksum.h"
+
+#import <errno.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/stat.h>
+#import <sys/uio.h>
+
+/** @internal
+ * The magic value identifying a report log segment ('plsg'). */
+#define PLCRASH_REPORT_LOG_SEGMENT_MAGIC 0x706c7367
+
+/** @internal
+ * The magic value identifying a report log record ('plrc'). */
+#define PLCRASH_REPORT_LOG_RECORD_MAGIC 0x706c7263
+
+/** @internal
+ * The current segment version, in which records are checksummed with CRC-32C. Segments of any version other than
+ * this or PLCRASH_REPORT_LOG_VERSION_CRC32 are ignored. */
+#define PLCRASH_REPORT_LOG_VERSION 2
+
+/** @internal
+ * The legacy segment version, in which records are checksummed with CRC-32 (ISO-HDLC). Legacy segments are read,
+ * but never appended to. */
+#define PLCRASH_REPORT_LOG_VERSION_CRC32 1
+
+/** @internal
+ * Records are padded to this alignment, ensuring that each record header may be read directly from a mapped segment. */
+#define PLCRASH_REPORT_LOG_ALIGNMENT 8
+
+/** @internal
+ * File extension used for report log segments. */
+static NSString *PLCRASH_REPORT_LOG_SEGMENT_EXTENSION = @"plseg";
+
+/**
+ * @internal
+ *
+ * The header written at the start of each segment.
+ */
+typedef struct plcrash_report_log_segment_header {
+    /** PLCRASH_REPORT_LOG_SEGMENT_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_REPORT_LOG_VERSION. */
+    uint32_t version;
+} plcrash_report_log_segment_header_t;
+
+/**
+ * @internal
+ *
+ * The header preceding each record. The record's data directly follows the header, and is padded with zeros to
+ * PLCRASH_REPORT_LOG_ALIGNMENT.
+ */
+typedef struct plcrash_report_log_record_header {
+    /** PLCRASH_REPORT_LOG_RECORD_MAGIC. */
+    uint32_t magic;
+
+    /** The length of the record's data, in bytes, excluding padding. */
+    uint32_t length;
+
+    /** The checksum of the record's data; CRC-32C in current segments, or CRC-32 in PLCRASH_REPORT_LOG_VERSION_CRC32
+     * segments. */
+    uint32_t checksum;
+
+    /** Reserved; must be 0. */
+    uint32_t reserved;
+} plcrash_report_log_record_header_t;
+
+/**
+ * @internal
+ *
+ * Return the CRC-32 (ISO-HDLC, as used by zlib) of @a len bytes of @a data, as used by PLCRASH_REPORT_LOG_VERSION_CRC32
+ * segments.
+ */
+static uint32_t plcrash_report_log_crc32 (const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+
+    return ~crc;
+}
+
+/**
+ * @internal
+ *
+ * Return the checksum of @a len bytes of @a data, as used by records in a segment of @a version.
+ */
+static uint32_t plcrash_report_log_checksum (uint32_t version, const void *data, size_t len) {
+    if (version == PLCRASH_REPORT_LOG_VERSION_CRC32)
+        return plcrash_report_log_crc32(data, len);
+
+    return plcrash_async_crc32c(0, data, len);
+}
+
+/**
+ * @internal
+ *
+ * Return the total size of a record holding @a length bytes of data, including its header and padding.
+ */
+static uint64_t plcrash_report_log_record_size (uint64_t length) {
+    uint64_t size = sizeof(plcrash_report_log_record_header_t) + length;
+    return (size + PLCRASH_REPORT_LOG_ALIGNMENT - 1) & ~((uint64_t) PLCRASH_REPORT_LOG_ALIGNMENT - 1);
+}
+
+
+/**
+ * @internal
+ *
+ * A record's data, referencing the mapped segment from which it was read. The segment mapping is retained for the
+ * lifetime of the record; no data is copied.
+ */
+@interface PLCrashReportLogRecordData : NSData {
+@private
+    /** The mapped segment containing the record. */
+    NSData *_segment;
+
+    /** The record's data, within _segment. */
+    const void *_bytes;
+
+    /** The record's length. */
+    NSUInteger _length;
+}
+
+- (id) initWithSegment: (NSData *) segment range: (NSRange) range;
+
+@end
+
+@implementation PLCrashReportLogRecordData
+
+/**
+ * Initialize a record referencing @a range of @a segment.
+ */
+- (id) initWithSegment: (NSData *) segment range: (NSRange) range {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _segment = [segment retain];
+    _bytes = (const uint8_t *) [segment bytes] + range.location;
+    _length = range.length;
+
+    return self;
+}
+
+- (void) dealloc {
+    [_segment release];
+    [super dealloc];
+}
+
+// from NSData
+- (const void *) bytes {
+    return _bytes;
+}
+
+// from NSData
+- (NSUInteger) length {
+    return _length;
+}
+
+@end
+
+
+/**
+ * @internal
+ *
+ * Enumerates the records of a report log, mapping a single segment at a time.
+ */
+@interface PLCrashReportLogEnumerator : NSEnumerator {
+@private
+    /** The enumerated segment paths. */
+    NSEnumerator *_segments;
+
+    /** The currently mapped segment, or nil. */
+    NSData *_segment;
+
+    /** The offset of the next record within _segment. */
+    NSUInteger _offset;
+
+    /** The version of _segment. */
+    uint32_t _version;
+}
+
+- (id) initWithSegmentPaths: (NSArray *) paths;
+
+@end
+
+@implementation PLCrashReportLogEnumerator
+
+/**
+ * Initialize a new enumerator over the records of the segments at @a paths, in order.
+ */
+- (id) initWithSegmentPaths: (NSArray *) paths {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _segments = [[paths objectEnumerator] retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_segments release];
+    [_segment release];
+    [super dealloc];
+}
+
+/**
+ * Map the next valid segment, returning NO if no segments remain.
+ */
+- (BOOL) mapNextSegment {
+    NSString *path;
+
+    [_segment release];
+    _segment = nil;
+
+    while ((path = [_segments nextObject]) != nil) {
+        NSData *segment = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedAlways error: NULL];
+        if (segment == nil || [segment length] < sizeof(plcrash_report_log_segment_header_t))
+            continue;
+
+        const plcrash_report_log_segment_header_t *header = [segment bytes];
+        if (header->magic != PLCRASH_REPORT_LOG_SEGMENT_MAGIC)
+            continue;
+
+        if (header->version != PLCRASH_REPORT_LOG_VERSION && header->version != PLCRASH_REPORT_LOG_VERSION_CRC32)
+            continue;
+
+        _segment = [segment retain];
+        _offset = sizeof(*header);
+        _version = header->version;
+        return YES;
+    }
+
+    return NO;
+}
+
+// from NSEnumerator
+- (id) nextObject {
+    while (_segment != nil || [self mapNextSegment]) {
+        NSUInteger available = [_segment length] - _offset;
+        const plcrash_report_log_record_header_t *header = (const plcrash_report_log_record_header_t *) ((const uint8_t *) [_segment bytes] + _offset);
+
+        /* A missing or invalid record terminates the segment; a torn append may only occur at the segment's tail */
+        if (available < sizeof(*header) || header->magic != PLCRASH_REPORT_LOG_RECORD_MAGIC ||
+            plcrash_report_log_record_size(header->length) > available ||
+            plcrash_report_log_checksum(_version, header + 1, header->length) != header->checksum)
+        {
+            [self mapNextSegment];
+            continue;
+        }
+
+        NSRange range = NSMakeRange(_offset + sizeof(*header), header->length);
+        _offset += (NSUInteger) plcrash_report_log_record_size(header->length);
+
+        return [[[PLCrashReportLogRecordData alloc] initWithSegment: _segment range: range] autorelease];
+    }
+
+    return nil;
+}
+
+@end
+
+
+@interface PLCrashReportLog (PrivateMethods)
+
+- (NSArray *) segmentPaths;
+- (NSString *) pathForSegment: (uint64_t) number;
+- (BOOL) openSegmentForRecordSize: (uint64_t) recordSize error: (NSError **) outError;
+- (BOOL) resumeSegmentAtPath: (NSString *) path recordSize: (uint64_t) recordSize;
+- (void) closeSegment;
+
+@end
+
+/**
+ * An append-only log of crash reports.
+ *
+ * Reports are appended as length-prefixed, checksummed records to a sequence of segment files; once a segment
+ * reaches the configured segment size, it is sealed, and a new segment is started. Each report is appended with a
+ * single write, and no per-report files are created or deleted, minimizing file system metadata updates when
+ * storing a high volume of reports, such as those captured by PLCrashHangDetector.
+ *
+ * Records are read via PLCrashReportLog::recordEnumerator, which maps each segment and returns the records' data
+ * without copying. Records are removed in bulk via PLCrashReportLog::compactRetainingRecordsPassingTest:error:,
+ * which rewrites the segments containing discarded records.
+ *
+ * A record left incomplete by a failed or interrupted append is detected by its checksum, and ignored, along with
+ * any bytes that follow it in the same segment; appends following a failed write always start a new segment. The
+ * last segment written by a previous instance is resumed only if it ends in a complete record.
+ */
+@implementation PLCrashReportLog
+
+/**
+ * Initialize a new report log.
+ *
+ * @param directory The directory in which segments will be stored. The directory will be created on first append, if
+ * it does not already exist. Only a single PLCrashReportLog instance should reference a given directory.
+ * @param segmentSize The size, in bytes, at which a segment is sealed. A report larger than the segment size is
+ * written to a segment of its own.
+ */
+- (id) initWithDirectory: (NSString *) directory segmentSize: (NSUInteger) segmentSize {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _directory = [directory copy];
+    _segmentSize = segmentSize;
+    _fd = -1;
+
+    return self;
+}
+
+- (void) dealloc {
+    [self closeSegment];
+    [_directory release];
+    [super dealloc];
+}
+
+/**
+ * Append a report to the log.
+ *
+ * @param data The report data.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be appended. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) appendReportData: (NSData *) data error: (NSError **) outError {
+    if ([data length] > UINT32_MAX) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"The report exceeds the maximum record size", nil);
+        return NO;
+    }
+
+    plcrash_report_log_record_header_t header = {
+        .magic = PLCRASH_REPORT_LOG_RECORD_MAGIC,
+        .length = (uint32_t) [data length],
+        .checksum = plcrash_report_log_checksum(PLCRASH_REPORT_LOG_VERSION, [data bytes], [data length]),
+        .reserved = 0
+    };
+    uint64_t recordSize = plcrash_report_log_record_size(header.length);
+    static const uint8_t padding[PLCRASH_REPORT_LOG_ALIGNMENT] = { 0 };
+
+    struct iovec iov[] = {
+        { .iov_base = &header, .iov_len = sizeof(header) },
+        { .iov_base = (void *) [data bytes], .iov_len = [data length] },
+        { .iov_base = (void *) padding, .iov_len = (size_t) (recordSize - sizeof(header) - [data length]) }
+    };
+
+    @synchronized (self) {
+        if (![self openSegmentForRecordSize: recordSize error: outError])
+            return NO;
+
+        /* The record is written with a single O_APPEND write */
+        ssize_t written;
+        do {
+            written = writev(_fd, iov, sizeof(iov) / sizeof(iov[0]));
+        } while (written < 0 && errno == EINTR);
+
+        if (written < 0 || (uint64_t) written != recordSize) {
+            /* Any partially written record will be ignored by readers; start a new segment on the next append, rather
+             * than writing past it */
+            plcrash_populate_posix_error(outError, (written < 0) ? errno : EIO, @"Could not append to the report log");
+            [self closeSegment];
+            return NO;
+        }
+
+        _segmentLength += recordSize;
+    }
+
+    return YES;
+}
+
+/**
+ * Return an enumerator over the data of all records in the log, in the order in which they were appended. Each
+ * segment is memory-mapped only while its records are enumerated, and each returned NSData instance references the
+ * mapped segment directly, without copying the record's data.
+ *
+ * Records appended after the enumerator is created may not be returned.
+ *
+ * @return An enumerator of NSData instances.
+ */
+- (NSEnumerator *) recordEnumerator {
+    @synchronized (self) {
+        return [[[PLCrashReportLogEnumerator alloc] initWithSegmentPaths: [self segmentPaths]] autorelease];
+    }
+}
+
+/**
+ * Compact the log, discarding all records for which @a predicate returns NO.
+ *
+ * Segments are rewritten starting from the first segment containing a discarded record; leading segments in which
+ * every record is retained are left in place. Retained records are appended to new segments, in order, before the
+ * rewritten segments are removed. If compaction is interrupted, records may thus be duplicated, but are never lost.
+ *
+ * @param predicate Called with the data of each record; return YES to retain the record. The predicate must not
+ * call back into the log.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the log could not be compacted. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error. On error, all records -- including those to be discarded -- are
+ * retained.
+ */
+- (BOOL) compactRetainingRecordsPassingTest: (BOOL (^)(NSData *record)) predicate error: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    @synchronized (self) {
+        /* Seal the current segment; retained records are always written to new segments */
+        [self closeSegment];
+        _resumeChecked = YES;
+
+        NSArray *segments = [self segmentPaths];
+        NSMutableArray *rewritten = [NSMutableArray arrayWithCapacity: [segments count]];
+        BOOL rewriting = NO;
+
+        for (NSString *path in segments) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSMutableArray *retained = [NSMutableArray array];
+            NSUInteger total = 0;
+
+            PLCrashReportLogEnumerator *records = [[[PLCrashReportLogEnumerator alloc] initWithSegmentPaths: [NSArray arrayWithObject: path]] autorelease];
+            for (NSData *record in records) {
+                total++;
+                if (predicate(record))
+                    [retained addObject: record];
+            }
+
+            /* Leave leading segments untouched until the first segment with a discarded record */
+            if (!rewriting && [retained count] == total) {
+                [pool drain];
+                continue;
+            }
+            rewriting = YES;
+
+            NSError *error = nil;
+            BOOL appended = YES;
+            for (NSData *record in retained) {
+                if (!(appended = [self appendReportData: record error: &error]))
+                    break;
+            }
+
+            /* The error must outlive the pool */
+            [error retain];
+            [pool drain];
+            [error autorelease];
+
+            if (!appended) {
+                if (outError != NULL)
+                    *outError = error;
+                return NO;
+            }
+
+            [rewritten addObject: path];
+        }
+
+        /* Seal the final rewritten segment, and remove the originals */
+        [self closeSegment];
+        for (NSString *path in rewritten) {
+            if (![fm removeItemAtPath: path error: outError])
+                return NO;
+        }
+    }
+
+    return YES;
+}
+
+/**
+ * Remove all records from the log.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the log could not be purged. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) purgeAndReturnError: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    @synchronized (self) {
+        [self closeSegment];
+
+        for (NSString *path in [self segmentPaths]) {
+            if (![fm removeItemAtPath: path error: outError])
+                return NO;
+        }
+    }
+
+    return YES;
+}
+
+@end
+
+
+@implementation PLCrashReportLog (PrivateMethods)
+
+/**
+ * Return the paths of all segments in the log, in order.
+ */
+- (NSArray *) segmentPaths {
+    NSArray *entries = [[NSFileManager defaultManager] contentsOfDirectoryAtPath: _directory error: NULL];
+    NSMutableArray *paths = [NSMutableArray arrayWithCapacity: [entries count]];
+
+    /* Segment names are fixed-width sequence numbers, so lexical order is segment order */
+    for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+        if ([[entry pathExtension] isEqualToString: PLCRASH_REPORT_LOG_SEGMENT_EXTENSION])
+            [paths addObject: [_directory stringByAppendingPathComponent: entry]];
+    }
+
+    return paths;
+}
+
+/**
+ * Return the path of the segment with sequence number @a number.
+ */
+- (NSString *) pathForSegment: (uint64_t) number {
+    NSString *name = [NSString stringWithFormat: @"%016llx", (unsigned long long) number];
+    return [[_directory stringByAppendingPathComponent: name] stringByAppendingPathExtension: PLCRASH_REPORT_LOG_SEGMENT_EXTENSION];
+}
+
+/**
+ * Ensure that a segment with room for a record of @a recordSize bytes is open for writing, sealing the current
+ * segment and starting a new segment as required.
+ */
+- (BOOL) openSegmentForRecordSize: (uint64_t) recordSize error: (NSError **) outError {
+    /* Use the current segment if it has room; an empty segment accepts a record of any size */
+    if (_fd >= 0) {
+        if (_segmentLength == sizeof(plcrash_report_log_segment_header_t) || _segmentLength + recordSize <= _segmentSize)
+            return YES;
+
+        [self closeSegment];
+    }
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+    if (![fm fileExistsAtPath: _directory] && ![fm createDirectoryAtPath: _directory withIntermediateDirectories: YES attributes: nil error: outError])
+        return NO;
+
+    uint64_t number = 0;
+    NSString *last = [[self segmentPaths] lastObject];
+    if (last != nil) {
+        /* Resume appending to the last segment left unsealed by a previous instance, if it ends in a complete record */
+        if (!_resumeChecked) {
+            _resumeChecked = YES;
+            if ([self resumeSegmentAtPath: last recordSize: recordSize])
+                return YES;
+        }
+
+        unsigned long long lastNumber = 0;
+        [[NSScanner scannerWithString: [[last lastPathComponent] stringByDeletingPathExtension]] scanHexLongLong: &lastNumber];
+        number = lastNumber + 1;
+    }
+
+    NSString *path = [self pathForSegment: number];
+    int fd = open([path fileSystemRepresentation], O_WRONLY|O_APPEND|O_CREAT|O_EXCL, 0644);
+    if (fd < 0) {
+        plcrash_populate_posix_error(outError, errno, @"Could not create a report log segment");
+        return NO;
+    }
+
+    plcrash_report_log_segment_header_t header = {
+        .magic = PLCRASH_REPORT_LOG_SEGMENT_MAGIC,
+        .version = PLCRASH_REPORT_LOG_VERSION
+    };
+    if (write(fd, &header, sizeof(header)) != sizeof(header)) {
+        plcrash_populate_posix_error(outError, errno, @"Could not write the report log segment header");
+        close(fd);
+        unlink([path fileSystemRepresentation]);
+        return NO;
+    }
+
+    _fd = fd;
+    _segmentLength = sizeof(header);
+
+    return YES;
+}
+
+/**
+ * Reopen the segment at @a path for writing, if it is of the current version, has room for a record of @a recordSize
+ * bytes, and its records exactly span the segment; a segment ending in an incomplete record is never reopened.
+ */
+- (BOOL) resumeSegmentAtPath: (NSString *) path recordSize: (uint64_t) recordSize {
+    int fd = open([path fileSystemRepresentation], O_RDWR|O_APPEND);
+    if (fd < 0)
+        return NO;
+
+    struct stat sb;
+    plcrash_report_log_segment_header_t header;
+    if (fstat(fd, &sb) != 0 || (uint64_t) sb.st_size + recordSize > _segmentSize ||
+        pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != PLCRASH_REPORT_LOG_SEGMENT_MAGIC || header.version != PLCRASH_REPORT_LOG_VERSION)
+    {
+        close(fd);
+        return NO;
+    }
+
+    /* Walk the record headers; the record data itself is not validated */
+    uint64_t offset = sizeof(header);
+    while (offset < (uint64_t) sb.st_size) {
+        plcrash_report_log_record_header_t record;
+        if (pread(fd, &record, sizeof(record), (off_t) offset) != sizeof(record) || record.magic != PLCRASH_REPORT_LOG_RECORD_MAGIC)
+            break;
+
+        offset += plcrash_report_log_record_size(record.length);
+    }
+
+    if (offset != (uint64_t) sb.st_size) {
+        close(fd);
+        return NO;
+    }
+
+    _fd = fd;
+    _segmentLength = offset;
+
+    return YES;
+}
+
+/**
+ * Close the current segment, if any. The next append will start a new segment.
+ */
+- (void) closeSegment {
+    if (_fd < 0)
+        return;
+
+    close(_fd);
+    _fd = -1;
+}
+
+@end
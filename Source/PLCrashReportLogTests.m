@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashReportLog.h"
+
+@interface PLCrashReportLogTests : SenTestCase {
+    /** Temporary log directory. */
+    NSString *_logDir;
+}
+@end
+
+@implementation PLCrashReportLogTests
+
+- (void) setUp {
+    _logDir = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _logDir error: NULL];
+    [_logDir release];
+}
+
+/** Return test record data, identified by @a value. */
+- (NSData *) recordWithValue: (uint8_t) value length: (NSUInteger) length {
+    NSMutableData *data = [NSMutableData dataWithLength: length];
+    memset([data mutableBytes], value, length);
+    return data;
+}
+
+/** Return the number of segment files in the log directory. */
+- (NSUInteger) segmentCount {
+    return [[[NSFileManager defaultManager] contentsOfDirectoryAtPath: _logDir error: NULL] count];
+}
+
+/** Return all records in @a log. */
+- (NSArray *) recordsInLog: (PLCrashReportLog *) log {
+    NSMutableArray *records = [NSMutableArray array];
+    for (NSData *record in [log recordEnumerator])
+        [records addObject: record];
+    return records;
+}
+
+/**
+ * Verify that appended records are returned in order, and that segments are sealed at the configured size.
+ */
+- (void) testAppendAndEnumerate {
+    NSError *error;
+    PLCrashReportLog *log = [[[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 256] autorelease];
+
+    STAssertEquals([[self recordsInLog: log] count], (NSUInteger) 0, @"A missing log should be empty");
+
+    for (uint8_t i = 0; i < 10; i++)
+        STAssertTrue([log appendReportData: [self recordWithValue: i length: 50 + i] error: &error], @"Failed to append record: %@", error);
+
+    /* Records larger than the segment size are written to a segment of their own */
+    STAssertTrue([log appendReportData: [self recordWithValue: 0xFF length: 1024] error: &error], @"Failed to append record: %@", error);
+
+    NSArray *records = [self recordsInLog: log];
+    STAssertEquals([records count], (NSUInteger) 11, @"Incorrect record count");
+    for (uint8_t i = 0; i < 10; i++)
+        STAssertEqualObjects([records objectAtIndex: i], [self recordWithValue: i length: 50 + i], @"Incorrect record %u", i);
+    STAssertEqualObjects([records lastObject], [self recordWithValue: 0xFF length: 1024], @"Incorrect oversized record");
+
+    STAssertTrue([self segmentCount] > 1, @"Segments were not sealed");
+}
+
+/**
+ * Verify that a record with an invalid checksum terminates its segment, and that a new instance does not resume
+ * appending to that segment.
+ */
+- (void) testCorruptRecord {
+    NSError *error;
+    PLCrashReportLog *log = [[[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 4096] autorelease];
+    STAssertTrue([log appendReportData: [self recordWithValue: 1 length: 16] error: &error], @"Failed to append record: %@", error);
+    STAssertTrue([log appendReportData: [self recordWithValue: 2 length: 16] error: &error], @"Failed to append record: %@", error);
+
+    /* Corrupt the second record's data */
+    NSString *segment = [_logDir stringByAppendingPathComponent: [[[NSFileManager defaultManager] contentsOfDirectoryAtPath: _logDir error: NULL] lastObject]];
+    NSMutableData *contents = [NSMutableData dataWithContentsOfFile: segment];
+    ((uint8_t *) [contents mutableBytes])[[contents length] - 1] ^= 0xFF;
+    STAssertTrue([contents writeToFile: segment atomically: NO], @"Could not write segment");
+
+    /* Truncate the segment mid-record, as per a torn append */
+    [contents setLength: [contents length] - 4];
+    STAssertTrue([contents writeToFile: segment atomically: NO], @"Could not write segment");
+
+    PLCrashReportLog *resumed = [[[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 4096] autorelease];
+    STAssertTrue([resumed appendReportData: [self recordWithValue: 3 length: 16] error: &error], @"Failed to append record: %@", error);
+
+    NSArray *records = [self recordsInLog: resumed];
+    STAssertEquals([records count], (NSUInteger) 2, @"Incorrect record count");
+    STAssertEqualObjects([records objectAtIndex: 0], [self recordWithValue: 1 length: 16], @"Incorrect record");
+    STAssertEqualObjects([records objectAtIndex: 1], [self recordWithValue: 3 length: 16], @"Incorrect record");
+    STAssertEquals([self segmentCount], (NSUInteger) 2, @"The damaged segment should not have been resumed");
+}
+
+/**
+ * Verify that a new instance resumes appending to an intact, unsealed segment.
+ */
+- (void) testResume {
+    NSError *error;
+    PLCrashReportLog *log = [[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 4096];
+    STAssertTrue([log appendReportData: [self recordWithValue: 1 length: 16] error: &error], @"Failed to append record: %@", error);
+    [log release];
+
+    log = [[[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 4096] autorelease];
+    STAssertTrue([log appendReportData: [self recordWithValue: 2 length: 16] error: &error], @"Failed to append record: %@", error);
+
+    STAssertEquals([[self recordsInLog: log] count], (NSUInteger) 2, @"Incorrect record count");
+    STAssertEquals([self segmentCount], (NSUInteger) 1, @"The segment should have been resumed");
+}
+
+/**
+ * Verify that compaction discards rejected records, preserving the order of retained records.
+ */
+- (void) testCompact {
+    NSError *error;
+    PLCrashReportLog *log = [[[PLCrashReportLog alloc] initWithDirectory: _logDir segmentSize: 256] autorelease];
+
+    for (uint8_t i = 0; i < 20; i++)
+        STAssertTrue([log appendReportData: [self recordWithValue: i length: 40] error: &error], @"Failed to append record: %@", error);
+
+    /* Retain odd records, and those in the leading segment */
+    BOOL compacted = [log compactRetainingRecordsPassingTest: ^BOOL (NSData *record) {
+        uint8_t value = ((const uint8_t *) [record bytes])[0];
+        return (value < 3) || (value % 2) == 1;
+    } error: &error];
+    STAssertTrue(compacted, @"Failed to compact log: %@", error);
+
+    NSArray *records = [self recordsInLog: log];
+    NSMutableArray *expected = [NSMutableArray array];
+    for (uint8_t i = 0; i < 20; i++) {
+        if (i < 3 || (i % 2) == 1)
+            [expected addObject: [self recordWithValue: i length: 40]];
+    }
+    STAssertEqualObjects(records, expected, @"Incorrect records after compaction");
+
+    /* Appends following compaction must follow the retained records */
+    STAssertTrue([log appendReportData: [self recordWithValue: 0xAA length: 40] error: &error], @"Failed to append record: %@", error);
+    STAssertEqualObjects([[self recordsInLog: log] lastObject], [self recordWithValue: 0xAA length: 40], @"Incorrect final record");
+
+    STAssertTrue([log purgeAndReturnError: &error], @"Failed to purge log: %@", error);
+    STAssertEquals([[self recordsInLog: log] count], (NSUInteger) 0, @"The log was not purged");
+}
+
+@end
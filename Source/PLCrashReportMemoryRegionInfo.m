@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportMemoryRegionInfo.h"
+
+/**
+ * Crash log memory region information.
+ *
+ * Describes a range of the crashed thread's memory -- such as its stack, or the memory referenced by one of its
+ * registers -- as captured at the time of the crash.
+ */
+@implementation PLCrashReportMemoryRegionInfo
+
+/**
+ * Initialize with the provided memory region information.
+ *
+ * @param address The address of the region's first byte.
+ * @param data The region's contents.
+ */
+- (id) initWithAddress: (uint64_t) address data: (NSData *) data {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _address = address;
+    _data = [data retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_data release];
+    [super dealloc];
+}
+
+@synthesize address = _address;
+@synthesize data = _data;
+
+@end
@@ -27,6 +27,7 @@
  */
 
 #import <Foundation/Foundation.h>
+#import "PLCrashReportSymbolInfo.h"
 
 @interface PLCrashReportRegisterInfo : NSObject {
 @private
@@ -35,9 +36,13 @@
     
     /** Register value */
     uint64_t _registerValue;
+
+    /** Symbol referenced by the register value, if annotated. Otherwise, will be nil. */
+    PLCrashReportSymbolInfo *_symbolInfo;
 }
 
 - (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue;
+- (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo;
 
 /**
  * Register name.
@@ -49,4 +54,11 @@
  */
 @property(nonatomic, readonly) uint64_t registerValue;
 
+/**
+ * The symbol referenced by the register value, as annotated when the report was written. This is only available
+ * if register annotation was enabled (see PLCrashReporterConfig::shouldAnnotateRegisters), and the value fell
+ * within a known symbol; otherwise, this property will be nil.
+ */
+@property(nonatomic, readonly) PLCrashReportSymbolInfo *symbolInfo;
+
 @end
@@ -38,21 +38,35 @@
  * Initialize with the provided name and value.
  */
 - (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue {
+    return [self initWithRegisterName: registerName registerValue: registerValue symbolInfo: nil];
+}
+
+/**
+ * Initialize with the provided name, value, and referenced symbol.
+ *
+ * @param registerName The register name.
+ * @param registerValue The register value.
+ * @param symbolInfo The symbol referenced by @a registerValue, or nil if unknown.
+ */
+- (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo {
     if ((self = [super init]) == nil)
         return nil;
     
     _registerName = [registerName retain];
     _registerValue = registerValue;
+    _symbolInfo = [symbolInfo retain];
     
     return self;
 }
 
 - (void) dealloc {
     [_registerName release];
+    [_symbolInfo release];
     [super dealloc];
 }
 
 @synthesize registerName = _registerName;
 @synthesize registerValue = _registerValue;
+@synthesize symbolInfo = _symbolInfo;
 
 @end
@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportSymbolicator.h"
+#import "PLCrashReport.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsyncCompressor.h"
+#import "PLCrashAsyncChecksum.h"
+
+#import "crash_report.pb-c.h"
+
+#import <dlfcn.h>
+#import <mach-o/dyld.h>
+#import <mach-o/loader.h>
+#import <objc/runtime.h>
+
+/**
+ * @internal
+ *
+ * An Objective-C method index entry.
+ */
+struct plcrash_symbolicator_method {
+    /** The method's implementation address. */
+    uintptr_t imp;
+
+    /** The class (or, for class methods, the metaclass) implementing the method. */
+    Class cls;
+
+    /** The method selector. */
+    SEL sel;
+};
+
+/**
+ * @internal
+ *
+ * A report binary image, indexed by its base address.
+ */
+struct plcrash_symbolicator_image {
+    /** The image's base address, as recorded in the report. */
+    uint64_t base_address;
+
+    /** The image's size, as recorded in the report. */
+    uint64_t size;
+
+    /** The image's currently loaded Mach-O header, or NULL if the image is not loaded in this process. */
+    const struct mach_header *header;
+};
+
+static int method_entry_compare (const void *a, const void *b);
+static int image_entry_compare (const void *a, const void *b);
+static NSData *image_uuid (const struct mach_header *header);
+static BOOL image_text_range (const struct mach_header *header, uintptr_t *outStart, uintptr_t *outEnd);
+
+@interface PLCrashReportSymbolicator (PrivateMethods)
+- (NSData *) methodIndexForImage: (const struct mach_header *) header;
+- (char *) copySymbolForAddress: (uintptr_t) pc image: (const struct mach_header *) header startAddress: (uintptr_t *) outStart;
+- (void) symbolicateFrames: (Plcrash__CrashReport__Thread__StackFrame **) frames
+                     count: (size_t) count
+                    images: (struct plcrash_symbolicator_image *) images
+                imageCount: (size_t) imageCount;
+@end
+
+/**
+ * @internal
+ *
+ * Symbolicates crash reports written without crash-time symbolication (see
+ * PLCrashReporterSymbolicationStrategyDeferred).
+ *
+ * Frames are matched, by image UUID, against the images loaded in the current process, and their symbols are resolved
+ * using the standard dyld symbol lookup and a complete index of the Objective-C runtime's registered methods. Neither
+ * is async-safe, and this class must not be used from a crash handler.
+ *
+ * Symbol lookup is only valid if the crashed process' images match those loaded in the current process; this holds
+ * for an application symbolicating its own reports on the next launch, but not across application or OS updates.
+ * Frames within images that are not loaded, or whose UUIDs do not match, are left unsymbolicated.
+ */
+@implementation PLCrashReportSymbolicator
+
+/**
+ * Initialize a new symbolicator, indexing the images currently loaded in this process.
+ */
+- (id) init {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _loadedImages = [[NSMutableDictionary alloc] init];
+    _methodIndices = [[NSMutableDictionary alloc] init];
+
+    uint32_t count = _dyld_image_count();
+    for (uint32_t i = 0; i < count; i++) {
+        const struct mach_header *header = _dyld_get_image_header(i);
+        if (header == NULL)
+            continue;
+
+        NSData *uuid = image_uuid(header);
+        if (uuid != nil)
+            [_loadedImages setObject: [NSNumber numberWithUnsignedLongLong: (uintptr_t) header] forKey: uuid];
+    }
+
+    return self;
+}
+
+- (void) dealloc {
+    [_loadedImages release];
+    [_methodIndices release];
+
+    [super dealloc];
+}
+
+/**
+ * Symbolicate all unsymbolicated stack frames within the encoded crash report @a data, returning the re-encoded report.
+ * Frames that already provide symbol information are left unmodified.
+ *
+ * Checksummed reports are verified, and compressed reports are transparently decompressed; the returned report is
+ * always uncompressed, and carries no checksum.
+ *
+ * @param data An encoded crash report.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the report could not
+ * be symbolicated. If no error occurs, this parameter will be left unmodified. You may specify NULL for this parameter,
+ * and no error information will be provided.
+ *
+ * @return Returns the symbolicated report, or nil on error.
+ */
+- (NSData *) symbolicateReportData: (NSData *) data error: (NSError **) outError {
+    plcrash_error_t err;
+    size_t content_length;
+
+    /* Verify and strip the checksum trailer, if any */
+    if ((err = plcrash_async_checksum_trailer_verify([data bytes], [data length], &content_length)) == PLCRASH_EINVALID_DATA) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode corrupt crash log (checksum mismatch)", nil);
+        return nil;
+    } else if (err == PLCRASH_ESUCCESS) {
+        data = [data subdataWithRange: NSMakeRange(0, content_length)];
+    }
+
+    /* Decompress the report, if necessary */
+    if (plcrash_async_compressed_is_compressed([data bytes], [data length])) {
+        size_t length;
+        if ((err = plcrash_async_compressed_decoded_length([data bytes], [data length], &length)) != PLCRASH_ESUCCESS) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode truncated, corrupt, or unsupported compressed crash log", nil);
+            return nil;
+        }
+
+        NSMutableData *decoded = [NSMutableData dataWithLength: length];
+        if ((err = plcrash_async_compressed_decode([data bytes], [data length], [decoded mutableBytes], length, &length)) != PLCRASH_ESUCCESS) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode truncated or corrupt compressed crash log", nil);
+            return nil;
+        }
+        [decoded setLength: length];
+        data = decoded;
+    }
+
+    /* Validate the file header */
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    if (sizeof(struct PLCrashReportFileHeader) >= [data length]) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode truncated crash log", nil);
+        return nil;
+    }
+
+    if (memcmp(header->magic, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) != 0 || header->version != PLCRASH_REPORT_FILE_VERSION) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decode invalid or unsupported crash log header", nil);
+        return nil;
+    }
+
+    Plcrash__CrashReport *report = plcrash__crash_report__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    if (report == NULL) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"An unknown error occured decoding the crash report", nil);
+        return nil;
+    }
+
+    /* Map the report's images to the currently loaded images */
+    struct plcrash_symbolicator_image *images = calloc(report->n_binary_images > 0 ? report->n_binary_images : 1, sizeof(*images));
+    size_t imageCount = 0;
+    for (size_t i = 0; i < report->n_binary_images; i++) {
+        Plcrash__CrashReport__BinaryImage *image = report->binary_images[i];
+        if (image->uuid.len == 0)
+            continue;
+
+        NSNumber *loaded = [_loadedImages objectForKey: [NSData dataWithBytesNoCopy: image->uuid.data length: image->uuid.len freeWhenDone: NO]];
+        if (loaded == nil)
+            continue;
+
+        images[imageCount].base_address = image->base_address;
+        images[imageCount].size = image->size;
+        images[imageCount].header = (const struct mach_header *) (uintptr_t) [loaded unsignedLongLongValue];
+        imageCount++;
+    }
+    qsort(images, imageCount, sizeof(*images), image_entry_compare);
+
+    /* Symbolicate the threads and the exception backtrace */
+    for (size_t i = 0; i < report->n_threads; i++)
+        [self symbolicateFrames: report->threads[i]->frames count: report->threads[i]->n_frames images: images imageCount: imageCount];
+
+    if (report->exception != NULL)
+        [self symbolicateFrames: report->exception->frames count: report->exception->n_frames images: images imageCount: imageCount];
+
+    free(images);
+
+    /* Re-encode the report */
+    size_t packedSize = plcrash__crash_report__get_packed_size(report);
+    NSMutableData *result = [NSMutableData dataWithLength: sizeof(struct PLCrashReportFileHeader) + packedSize];
+    uint8_t *output = [result mutableBytes];
+
+    memcpy(output, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
+    output[strlen(PLCRASH_REPORT_FILE_MAGIC)] = PLCRASH_REPORT_FILE_VERSION;
+    plcrash__crash_report__pack(report, output + sizeof(struct PLCrashReportFileHeader));
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) report, &protobuf_c_system_allocator);
+    return result;
+}
+
+@end
+
+@implementation PLCrashReportSymbolicator (PrivateMethods)
+
+/**
+ * Symbolicate all unsymbolicated @a frames.
+ *
+ * @param frames The frames to symbolicate.
+ * @param count The number of frames.
+ * @param images The loaded report images, sorted by base address.
+ * @param imageCount The number of images.
+ */
+- (void) symbolicateFrames: (Plcrash__CrashReport__Thread__StackFrame **) frames
+                     count: (size_t) count
+                    images: (struct plcrash_symbolicator_image *) images
+                imageCount: (size_t) imageCount
+{
+    for (size_t i = 0; i < count; i++) {
+        Plcrash__CrashReport__Thread__StackFrame *frame = frames[i];
+        if (frame->symbol != NULL)
+            continue;
+
+        /* Find the last image with a base address <= pc */
+        size_t lo = 0;
+        size_t hi = imageCount;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (images[mid].base_address <= frame->pc)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo == 0)
+            continue;
+
+        struct plcrash_symbolicator_image *image = &images[lo - 1];
+        if (frame->pc - image->base_address >= image->size)
+            continue;
+
+        /* Translate the PC into this process' address space, and the symbol address back again */
+        uint64_t delta = (uintptr_t) image->header - image->base_address;
+        uintptr_t start;
+        char *name = [self copySymbolForAddress: (uintptr_t) (frame->pc + delta) image: image->header startAddress: &start];
+        if (name == NULL)
+            continue;
+
+        Plcrash__CrashReport__Symbol *symbol = malloc(sizeof(*symbol));
+        if (symbol == NULL) {
+            free(name);
+            continue;
+        }
+
+        plcrash__crash_report__symbol__init(symbol);
+        symbol->name = name;
+        symbol->start_address = (uint64_t) start - delta;
+        frame->symbol = symbol;
+    }
+}
+
+/**
+ * Find the best-matching symbol for @a pc within the loaded image @a header, returning a newly allocated copy of
+ * its name, or NULL if no symbol is found. The caller is responsible for free()ing the returned name.
+ *
+ * When both the dyld symbol lookup and the Objective-C method index return a result, the symbol with the closest
+ * start address is used.
+ *
+ * @param pc The address to symbolicate.
+ * @param header The loaded image containing @a pc.
+ * @param outStart On success, the symbol's start address.
+ */
+- (char *) copySymbolForAddress: (uintptr_t) pc image: (const struct mach_header *) header startAddress: (uintptr_t *) outStart {
+    uintptr_t symbolStart = 0;
+    const char *symbolName = NULL;
+
+    /* Symbol table */
+    Dl_info info;
+    if (dladdr((void *) pc, &info) != 0 && info.dli_fbase == header && info.dli_sname != NULL && info.dli_saddr != NULL) {
+        /* Stripped symbols are replaced by <redacted> on iOS; these are no better than no symbol at all */
+        if (strcmp(info.dli_sname, "<redacted>") != 0) {
+            symbolStart = (uintptr_t) info.dli_saddr;
+            symbolName = info.dli_sname;
+        }
+    }
+
+    /* Objective-C methods */
+    NSData *index = [self methodIndexForImage: header];
+    const struct plcrash_symbolicator_method *methods = [index bytes];
+    size_t lo = 0;
+    size_t hi = [index length] / sizeof(*methods);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (methods[mid].imp <= pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo > 0 && methods[lo - 1].imp >= symbolStart) {
+        const struct plcrash_symbolicator_method *method = &methods[lo - 1];
+        char *name = NULL;
+        if (asprintf(&name, "%c[%s %s]", class_isMetaClass(method->cls) ? '+' : '-', class_getName(method->cls), sel_getName(method->sel)) < 0)
+            return NULL;
+
+        *outStart = method->imp;
+        return name;
+    }
+
+    if (symbolName == NULL)
+        return NULL;
+
+    /* dladdr() strips the leading underscore from C symbol names; restore it, matching the names written at crash
+     * time. Objective-C method symbols are not prefixed. */
+    char *name = NULL;
+    if (symbolName[0] == '-' || symbolName[0] == '+')
+        name = strdup(symbolName);
+    else if (asprintf(&name, "_%s", symbolName) < 0)
+        name = NULL;
+
+    if (name != NULL)
+        *outStart = symbolStart;
+    return name;
+}
+
+/**
+ * Return the sorted Objective-C method index for the loaded image @a header, building it on first use.
+ *
+ * The index contains the class and instance methods of all classes defined by the image, restricted to those
+ * implemented within the image's __TEXT segment.
+ *
+ * @param header The loaded image.
+ */
+- (NSData *) methodIndexForImage: (const struct mach_header *) header {
+    NSNumber *key = [NSNumber numberWithUnsignedLongLong: (uintptr_t) header];
+    NSData *cached = [_methodIndices objectForKey: key];
+    if (cached != nil)
+        return cached;
+
+    NSMutableData *index = [NSMutableData data];
+    [_methodIndices setObject: index forKey: key];
+
+    Dl_info info;
+    uintptr_t textStart, textEnd;
+    if (dladdr(header, &info) == 0 || info.dli_fname == NULL || !image_text_range(header, &textStart, &textEnd))
+        return index;
+
+    unsigned int classCount = 0;
+    const char **classNames = objc_copyClassNamesForImage(info.dli_fname, &classCount);
+    for (unsigned int i = 0; i < classCount; i++) {
+        Class cls = objc_getClass(classNames[i]);
+        if (cls == Nil)
+            continue;
+
+        /* Instance methods, followed by the metaclass' class methods */
+        Class classes[] = { cls, object_getClass(cls) };
+        for (size_t c = 0; c < sizeof(classes) / sizeof(classes[0]); c++) {
+            unsigned int methodCount = 0;
+            Method *methodList = class_copyMethodList(classes[c], &methodCount);
+            for (unsigned int m = 0; m < methodCount; m++) {
+                struct plcrash_symbolicator_method entry;
+                entry.imp = (uintptr_t) method_getImplementation(methodList[m]);
+                entry.cls = classes[c];
+                entry.sel = method_getName(methodList[m]);
+
+                /* Skip category methods implemented by other images */
+                if (entry.imp < textStart || entry.imp >= textEnd)
+                    continue;
+
+                [index appendBytes: &entry length: sizeof(entry)];
+            }
+            free(methodList);
+        }
+    }
+    free(classNames);
+
+    qsort([index mutableBytes], [index length] / sizeof(struct plcrash_symbolicator_method), sizeof(struct plcrash_symbolicator_method), method_entry_compare);
+    return index;
+}
+
+@end
+
+/**
+ * @internal
+ *
+ * Compare two plcrash_symbolicator_method entries by implementation address.
+ */
+static int method_entry_compare (const void *a, const void *b) {
+    const struct plcrash_symbolicator_method *lhs = a;
+    const struct plcrash_symbolicator_method *rhs = b;
+
+    if (lhs->imp < rhs->imp)
+        return -1;
+    else if (lhs->imp > rhs->imp)
+        return 1;
+    return 0;
+}
+
+/**
+ * @internal
+ *
+ * Compare two plcrash_symbolicator_image entries by base address.
+ */
+static int image_entry_compare (const void *a, const void *b) {
+    const struct plcrash_symbolicator_image *lhs = a;
+    const struct plcrash_symbolicator_image *rhs = b;
+
+    if (lhs->base_address < rhs->base_address)
+        return -1;
+    else if (lhs->base_address > rhs->base_address)
+        return 1;
+    return 0;
+}
+
+/**
+ * @internal
+ *
+ * Return the first load command of type @a type within the loaded image @a header, or NULL if not found.
+ */
+static const struct load_command *image_find_command (const struct mach_header *header, uint32_t type) {
+    const uint8_t *cursor;
+
+    if (header->magic == MH_MAGIC_64)
+        cursor = (const uint8_t *) header + sizeof(struct mach_header_64);
+    else
+        cursor = (const uint8_t *) header + sizeof(struct mach_header);
+
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        const struct load_command *cmd = (const struct load_command *) cursor;
+        if (cmd->cmd == type)
+            return cmd;
+
+        cursor += cmd->cmdsize;
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Return the LC_UUID of the loaded image @a header, or nil if the image does not define a UUID.
+ */
+static NSData *image_uuid (const struct mach_header *header) {
+    const struct uuid_command *cmd = (const struct uuid_command *) image_find_command(header, LC_UUID);
+    if (cmd == NULL)
+        return nil;
+
+    return [NSData dataWithBytes: cmd->uuid length: sizeof(cmd->uuid)];
+}
+
+/**
+ * @internal
+ *
+ * Determine the loaded address range of the __TEXT segment of the loaded image @a header. The segment begins
+ * at the image's Mach-O header.
+ */
+static BOOL image_text_range (const struct mach_header *header, uintptr_t *outStart, uintptr_t *outEnd) {
+    const uint8_t *cursor;
+
+    if (header->magic == MH_MAGIC_64)
+        cursor = (const uint8_t *) header + sizeof(struct mach_header_64);
+    else
+        cursor = (const uint8_t *) header + sizeof(struct mach_header);
+
+    /* Executables are preceded by __PAGEZERO, and the __TEXT segment may not be the first */
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        const struct load_command *cmd = (const struct load_command *) cursor;
+        cursor += cmd->cmdsize;
+
+        uint64_t vmsize;
+        if (cmd->cmd == LC_SEGMENT_64) {
+            const struct segment_command_64 *segment = (const struct segment_command_64 *) cmd;
+            if (strncmp(segment->segname, SEG_TEXT, sizeof(segment->segname)) != 0)
+                continue;
+            vmsize = segment->vmsize;
+        } else if (cmd->cmd == LC_SEGMENT) {
+            const struct segment_command *segment = (const struct segment_command *) cmd;
+            if (strncmp(segment->segname, SEG_TEXT, sizeof(segment->segname)) != 0)
+                continue;
+            vmsize = segment->vmsize;
+        } else {
+            continue;
+        }
+
+        *outStart = (uintptr_t) header;
+        *outEnd = (uintptr_t) header + (uintptr_t) vmsize;
+        return YES;
+    }
+
+    return NO;
+}
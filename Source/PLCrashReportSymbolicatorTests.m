@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashReport.h"
+#import "PLCrashReporter.h"
+#import "PLCrashReportSymbolicator.h"
+
+@interface PLCrashReporter (PLCrashReportSymbolicatorTestsPrivate)
+- (NSString *) crashReportPath;
+@end
+
+@interface PLCrashReportSymbolicatorTests : SenTestCase {
+@private
+    /** A crash reporter configured for deferred symbolication. */
+    PLCrashReporter *_reporter;
+}
+@end
+
+@implementation PLCrashReportSymbolicatorTests
+
+- (void) setUp {
+    PLCrashReporterConfig *config = [[[PLCrashReporterConfig alloc] initWithSignalHandlerType: PLCrashReporterSignalHandlerTypeBSD
+                                                                        symbolicationStrategy: PLCrashReporterSymbolicationStrategyDeferred] autorelease];
+    _reporter = [[PLCrashReporter alloc] initWithConfiguration: config];
+}
+
+- (void) tearDown {
+    [_reporter release];
+}
+
+/**
+ * Verify that deferred reports are written without symbols, and that symbolication fills them in.
+ */
+- (void) testSymbolicateReport {
+    NSError *error;
+    NSData *reportData = [_reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(report, @"Could not parse generated live report: %@", error);
+    STAssertTrue([report.crashedThread.stackFrames count] > 0, @"No frames in the crashed thread");
+
+    for (PLCrashReportStackFrameInfo *frame in report.crashedThread.stackFrames)
+        STAssertNil(frame.symbolInfo, @"Deferred report frame was symbolicated at write time");
+
+    /* Symbolicate */
+    PLCrashReportSymbolicator *symbolicator = [[[PLCrashReportSymbolicator alloc] init] autorelease];
+    NSData *symbolicatedData = [symbolicator symbolicateReportData: reportData error: &error];
+    STAssertNotNil(symbolicatedData, @"Failed to symbolicate report: %@", error);
+
+    PLCrashReport *symbolicated = [[[PLCrashReport alloc] initWithData: symbolicatedData error: &error] autorelease];
+    STAssertNotNil(symbolicated, @"Could not parse symbolicated report: %@", error);
+    STAssertEquals([symbolicated.crashedThread.stackFrames count], [report.crashedThread.stackFrames count], @"Frame count changed");
+
+    /* This method must be found via its ObjC metadata or the symbol table, at the correct address */
+    BOOL found = NO;
+    for (PLCrashReportStackFrameInfo *frame in symbolicated.crashedThread.stackFrames) {
+        PLCrashReportSymbolInfo *symbol = frame.symbolInfo;
+        if (symbol == nil)
+            continue;
+
+        STAssertTrue(symbol.startAddress <= frame.instructionPointer, @"Symbol %@ starts after its frame's PC", symbol.symbolName);
+        if ([symbol.symbolName isEqualToString: @"-[PLCrashReportSymbolicatorTests testSymbolicateReport]"]) {
+            STAssertEquals(symbol.startAddress, (uint64_t) (uintptr_t) [self methodForSelector: _cmd], @"Incorrect start address");
+            found = YES;
+        }
+    }
+    STAssertTrue(found, @"The test method was not symbolicated");
+
+    /* Existing symbols are preserved on re-symbolication */
+    NSData *resymbolicated = [symbolicator symbolicateReportData: symbolicatedData error: &error];
+    STAssertNotNil(resymbolicated, @"Failed to re-symbolicate report: %@", error);
+    STAssertEqualObjects(resymbolicated, symbolicatedData, @"Re-symbolication modified the report");
+}
+
+/**
+ * Verify that the pending report is symbolicated in place, preserving its compression.
+ */
+- (void) testSymbolicatePendingReport {
+    NSError *error;
+    PLMutableCrashReporterConfig *config = [[[PLMutableCrashReporterConfig alloc] initWithSignalHandlerType: PLCrashReporterSignalHandlerTypeBSD
+                                                                                      symbolicationStrategy: PLCrashReporterSymbolicationStrategyDeferred] autorelease];
+    config.shouldCompressReports = YES;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    /* Install the pending report */
+    NSString *directory = [[reporter crashReportPath] stringByDeletingLastPathComponent];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: directory withIntermediateDirectories: YES attributes: nil error: &error], @"Failed to create report directory: %@", error);
+    STAssertTrue([reportData writeToFile: [reporter crashReportPath] options: NSDataWritingAtomic error: &error], @"Failed to write report: %@", error);
+
+    STAssertTrue([reporter symbolicatePendingCrashReportAndReturnError: &error], @"Failed to symbolicate pending report: %@", error);
+
+    NSData *pendingData = [reporter loadPendingCrashReportDataAndReturnError: &error];
+    STAssertNotNil(pendingData, @"Failed to load pending report: %@", error);
+    STAssertTrue(memcmp([pendingData bytes], "plcrlz4", 7) == 0, @"Symbolicated report was not compressed");
+
+    PLCrashReport *report = [reporter loadPendingCrashReportAndReturnError: &error];
+    STAssertNotNil(report, @"Could not load pending report: %@", error);
+
+    NSUInteger symbolicated = 0;
+    for (PLCrashReportStackFrameInfo *frame in report.crashedThread.stackFrames) {
+        if (frame.symbolInfo != nil)
+            symbolicated++;
+    }
+    STAssertTrue(symbolicated > 0, @"No frames were symbolicated");
+
+    STAssertTrue([reporter purgePendingCrashReportAndReturnError: &error], @"Failed to purge pending report: %@", error);
+}
+
+@end
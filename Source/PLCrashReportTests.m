@@ -44,6 +44,8 @@
 #import <mach-o/arch.h>
 #import <mach-o/dyld.h>
 
+#import <malloc/malloc.h>
+
 @interface PLCrashReportTests : SenTestCase {
 @private
     /* Path to crash log */
@@ -239,6 +241,23 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
     for (PLCrashReportThreadInfo *threadInfo in crashLog.threads) {
         STAssertNotNil(threadInfo.stackFrames, @"Thread stackframe list is nil");
         STAssertNotNil(threadInfo.registers, @"Thread register list is nil");
+
+        /* The flat frame and register storage must match the object facades */
+        STAssertEquals(threadInfo.frameCount, [threadInfo.stackFrames count], @"Incorrect frame count");
+        for (NSUInteger i = 0; i < threadInfo.frameCount; i++) {
+            PLCrashReportStackFrameInfo *frame = [threadInfo.stackFrames objectAtIndex: i];
+            STAssertEquals(threadInfo.instructionPointers[i], frame.instructionPointer, @"Incorrect instruction pointer");
+            STAssertEquals([threadInfo symbolStartAddressAtIndex: i], frame.symbolInfo.startAddress, @"Incorrect symbol address");
+            STAssertEqualObjects([threadInfo symbolNameAtIndex: i], frame.symbolInfo.symbolName, @"Incorrect symbol name");
+        }
+
+        STAssertEquals(threadInfo.registerCount, [threadInfo.registers count], @"Incorrect register count");
+        for (NSUInteger i = 0; i < threadInfo.registerCount; i++) {
+            PLCrashReportRegisterInfo *reg = [threadInfo.registers objectAtIndex: i];
+            STAssertEquals(threadInfo.registerValues[i], reg.registerValue, @"Incorrect register value");
+            STAssertEqualStrings([threadInfo registerNameAtIndex: i], reg.registerName, @"Incorrect register name");
+        }
+
         if (thrNumber > 0) {
             STAssertTrue(lastThreadNumber < threadInfo.threadNumber, @"Threads are listed out of order.");
         }
@@ -250,6 +269,18 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
                 STAssertNotNil(registerInfo.registerName, @"Register name is nil");
             }
 
+            /* The register names implied by the compact register state must match the host's thread state */
+            plcrash_async_thread_state_t state;
+            thread_t self = mach_thread_self();
+            STAssertEquals(plcrash_async_thread_state_mach_thread_init(&state, self), PLCRASH_ESUCCESS, @"Failed to fetch thread state");
+            mach_port_deallocate(mach_task_self(), self);
+
+            STAssertEquals(threadInfo.registerCount, (NSUInteger) plcrash_async_thread_state_get_reg_count(&state), @"Incorrect register count");
+            for (NSUInteger i = 0; i < threadInfo.registerCount; i++) {
+                NSString *name = [NSString stringWithUTF8String: plcrash_async_thread_state_get_reg_name(&state, (plcrash_regnum_t) i)];
+                STAssertEqualStrings([threadInfo registerNameAtIndex: i], name, @"Incorrect register name");
+            }
+
             /* Symbol information should be available for an ObjC frame in our binary */
             STAssertNotEquals((NSUInteger)0, [threadInfo.stackFrames count], @"Zero stack frames returned");
             PLCrashReportStackFrameInfo *stackFrame = [threadInfo.stackFrames objectAtIndex: 0];
@@ -296,4 +327,485 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
 }
 
 
+/**
+ * Write a crash report for the current thread to our log path, returning the report data.
+ */
+- (NSData *) writeTestReport {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_dynloader_t *loader = NULL;
+
+    plcrash_log_signal_info_t info;
+    plcrash_log_bsd_signal_info_t bsd_info;
+    {
+        bsd_info.address = method_getImplementation(class_getInstanceMethod([self class], _cmd));
+        bsd_info.code = SEGV_MAPERR;
+        bsd_info.signo = SIGSEGV;
+
+        info.mach_info = NULL;
+        info.bsd_info = &bsd_info;
+    }
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_dynloader_new(&loader, _allocator, mach_task_self()), @"Failed to create loader reference");
+
+    struct plcr_live_report_context ctx = {
+        .writer = &writer,
+        .file = &file,
+        .dynamic_loader = loader,
+        .info = &info
+    };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_thread_state_current(plcr_live_report_callback, &ctx), @"Writing crash log failed");
+
+    plcrash_async_dynloader_free(loader);
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    return [NSData dataWithContentsOfFile: _logPath options: NSDataReadingMappedIfSafe error: nil];
+}
+
+/**
+ * Verify that lazily decoded reports match eagerly decoded reports.
+ */
+- (void) testLazyDecode {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *eager = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(eager, @"Could not decode crash log: %@", error);
+
+    /* Fetch only the crashed thread */
+    PLCrashReport *lazy = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+    STAssertNotNil(lazy, @"Could not lazily decode crash log: %@", error);
+    STAssertEqualStrings(lazy.signalInfo.name, eager.signalInfo.name, @"Signal is incorrect");
+
+    PLCrashReportThreadInfo *crashed = lazy.crashedThread;
+    STAssertNotNil(crashed, @"No crashed thread found");
+    STAssertTrue(crashed.crashed, @"Returned thread is not the crashed thread");
+    STAssertEquals(crashed.threadNumber, eager.crashedThread.threadNumber, @"Incorrect crashed thread");
+    STAssertEquals([crashed.stackFrames count], [eager.crashedThread.stackFrames count], @"Incorrect frame count");
+
+    /* Materialize the remaining records, and compare against the eagerly decoded report */
+    STAssertEquals([lazy.threads count], [eager.threads count], @"Incorrect thread count");
+    for (NSUInteger i = 0; i < [eager.threads count]; i++) {
+        PLCrashReportThreadInfo *expected = [eager.threads objectAtIndex: i];
+        PLCrashReportThreadInfo *actual = [lazy.threads objectAtIndex: i];
+
+        STAssertEquals(actual.threadNumber, expected.threadNumber, @"Incorrect thread number");
+        STAssertEquals(actual.crashed, expected.crashed, @"Incorrect crashed state");
+        STAssertEquals([actual.registers count], [expected.registers count], @"Incorrect register count");
+        STAssertEquals([actual.stackFrames count], [expected.stackFrames count], @"Incorrect frame count");
+        for (NSUInteger f = 0; f < [expected.stackFrames count]; f++) {
+            PLCrashReportStackFrameInfo *expectedFrame = [expected.stackFrames objectAtIndex: f];
+            PLCrashReportStackFrameInfo *actualFrame = [actual.stackFrames objectAtIndex: f];
+            STAssertEquals(actualFrame.instructionPointer, expectedFrame.instructionPointer, @"Incorrect frame address");
+        }
+    }
+
+    STAssertEquals([lazy.images count], [eager.images count], @"Incorrect image count");
+    for (NSUInteger i = 0; i < [eager.images count]; i++) {
+        PLCrashReportBinaryImageInfo *expected = [eager.images objectAtIndex: i];
+        PLCrashReportBinaryImageInfo *actual = [lazy.images objectAtIndex: i];
+
+        STAssertEqualStrings(actual.imageName, expected.imageName, @"Incorrect image name");
+        STAssertEquals(actual.imageBaseAddress, expected.imageBaseAddress, @"Incorrect image address");
+    }
+
+    /* Verify that image lookup works once the thread records have been released */
+    PLCrashReportStackFrameInfo *frame = [crashed.stackFrames objectAtIndex: 0];
+    STAssertNotNil([lazy imageForAddress: frame.instructionPointer], @"Could not find image for crashed frame");
+}
+
+/**
+ * Verify that concurrently decoded reports match serially decoded reports.
+ */
+- (void) testConcurrentDecode {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *serial = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(serial, @"Could not decode crash log: %@", error);
+
+    PLCrashReport *concurrent = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionConcurrent error: &error] autorelease];
+    STAssertNotNil(concurrent, @"Could not concurrently decode crash log: %@", error);
+
+    STAssertEquals([concurrent.threads count], [serial.threads count], @"Incorrect thread count");
+    for (NSUInteger i = 0; i < [serial.threads count]; i++) {
+        PLCrashReportThreadInfo *expected = [serial.threads objectAtIndex: i];
+        PLCrashReportThreadInfo *actual = [concurrent.threads objectAtIndex: i];
+
+        STAssertEquals(actual.threadNumber, expected.threadNumber, @"Incorrect thread number");
+        STAssertEquals(actual.crashed, expected.crashed, @"Incorrect crashed state");
+        STAssertEquals([actual.registers count], [expected.registers count], @"Incorrect register count");
+        STAssertEquals([actual.stackFrames count], [expected.stackFrames count], @"Incorrect frame count");
+        for (NSUInteger f = 0; f < [expected.stackFrames count]; f++) {
+            PLCrashReportStackFrameInfo *expectedFrame = [expected.stackFrames objectAtIndex: f];
+            PLCrashReportStackFrameInfo *actualFrame = [actual.stackFrames objectAtIndex: f];
+            STAssertEquals(actualFrame.instructionPointer, expectedFrame.instructionPointer, @"Incorrect frame address");
+        }
+    }
+
+    STAssertEquals([concurrent.images count], [serial.images count], @"Incorrect image count");
+    for (NSUInteger i = 0; i < [serial.images count]; i++) {
+        PLCrashReportBinaryImageInfo *expected = [serial.images objectAtIndex: i];
+        PLCrashReportBinaryImageInfo *actual = [concurrent.images objectAtIndex: i];
+
+        STAssertEqualStrings(actual.imageName, expected.imageName, @"Incorrect image name");
+        STAssertEquals(actual.imageBaseAddress, expected.imageBaseAddress, @"Incorrect image address");
+    }
+}
+
+/**
+ * Verify that reports converted to the version 2 format decode to the same threads, registers and symbols.
+ */
+- (void) testConvertV2 {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *v1 = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(v1, @"Could not decode crash log: %@", error);
+
+    NSData *converted = [PLCrashReport v2DataWithReportData: data error: &error];
+    STAssertNotNil(converted, @"Could not convert crash log: %@", error);
+    if (converted == nil)
+        return;
+
+    const struct PLCrashReportFileHeader *header = [converted bytes];
+    STAssertEquals(header->version, (uint8_t) PLCRASH_REPORT_FILE_VERSION_V2, @"Converted report is not in the version 2 format");
+
+    PLCrashReport *v2 = [[[PLCrashReport alloc] initWithData: converted error: &error] autorelease];
+    STAssertNotNil(v2, @"Could not decode converted crash log: %@", error);
+
+    STAssertEqualStrings(v2.signalInfo.name, v1.signalInfo.name, @"Signal is incorrect");
+    STAssertEqualStrings(v2.exceptionInfo.exceptionName, v1.exceptionInfo.exceptionName, @"Exception is incorrect");
+    STAssertEquals([v2.images count], [v1.images count], @"Incorrect image count");
+
+    /* The crashed thread is converted first; the remaining threads keep their order */
+    STAssertEquals([v2.threads count], [v1.threads count], @"Incorrect thread count");
+    STAssertTrue([[v2.threads objectAtIndex: 0] crashed], @"The crashed thread was not converted first");
+
+    for (PLCrashReportThreadInfo *expected in v1.threads) {
+        PLCrashReportThreadInfo *actual = nil;
+        for (PLCrashReportThreadInfo *thr in v2.threads) {
+            if (thr.threadNumber == expected.threadNumber)
+                actual = thr;
+        }
+
+        STAssertNotNil(actual, @"Thread %ld was not converted", (long) expected.threadNumber);
+        if (actual == nil)
+            continue;
+
+        STAssertEquals(actual.crashed, expected.crashed, @"Incorrect crashed state");
+
+        STAssertEquals([actual.registers count], [expected.registers count], @"Incorrect register count");
+        for (NSUInteger r = 0; r < [expected.registers count] && r < [actual.registers count]; r++) {
+            PLCrashReportRegisterInfo *expectedReg = [expected.registers objectAtIndex: r];
+            PLCrashReportRegisterInfo *actualReg = [actual.registers objectAtIndex: r];
+            STAssertEqualStrings(actualReg.registerName, expectedReg.registerName, @"Incorrect register name");
+            STAssertEquals(actualReg.registerValue, expectedReg.registerValue, @"Incorrect value for %@", expectedReg.registerName);
+        }
+
+        STAssertEquals([actual.stackFrames count], [expected.stackFrames count], @"Incorrect frame count");
+        for (NSUInteger f = 0; f < [expected.stackFrames count] && f < [actual.stackFrames count]; f++) {
+            PLCrashReportStackFrameInfo *expectedFrame = [expected.stackFrames objectAtIndex: f];
+            PLCrashReportStackFrameInfo *actualFrame = [actual.stackFrames objectAtIndex: f];
+            STAssertEquals(actualFrame.instructionPointer, expectedFrame.instructionPointer, @"Incorrect frame address");
+
+            if (expectedFrame.symbolInfo != nil && expectedFrame.symbolInfo.startAddress <= expectedFrame.instructionPointer) {
+                STAssertEqualStrings(actualFrame.symbolInfo.symbolName, expectedFrame.symbolInfo.symbolName, @"Incorrect symbol name");
+                STAssertEquals(actualFrame.symbolInfo.startAddress, expectedFrame.symbolInfo.startAddress, @"Incorrect symbol address");
+            }
+        }
+    }
+
+    /* Version 2 reports may themselves be converted */
+    STAssertNotNil([PLCrashReport v2DataWithReportData: converted error: &error], @"Could not convert a version 2 report: %@", error);
+}
+
+/**
+ * Verify that a truncated report is decoded up to its incomplete trailing record, both eagerly and lazily.
+ */
+- (void) testDecodeTruncated {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *complete = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(complete, @"Could not decode crash log: %@", error);
+    STAssertFalse(complete.truncated, @"Complete report marked as truncated");
+
+    data = [data subdataWithRange: NSMakeRange(0, [data length] - 1)];
+    PLCrashReportDecodingOptions options[] = { PLCrashReportDecodingOptionNone, PLCrashReportDecodingOptionLazy };
+    for (size_t i = 0; i < sizeof(options) / sizeof(options[0]); i++) {
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data options: options[i] error: &error] autorelease];
+        STAssertNotNil(report, @"Could not decode truncated crash log: %@", error);
+        STAssertTrue(report.truncated, @"Report not marked as truncated");
+        STAssertEqualStrings(report.signalInfo.name, complete.signalInfo.name, @"Signal is incorrect");
+        STAssertNotNil(report.crashedThread, @"The crashed thread should precede the truncated record");
+    }
+
+    /* Data that ends within the report's required records can't be decoded */
+    data = [data subdataWithRange: NSMakeRange(0, 16)];
+    STAssertNil([[[PLCrashReport alloc] initWithData: data error: &error] autorelease], @"Decoded a report without its required records");
+    STAssertNotNil(error, @"No error returned");
+}
+
+
+/* Return the number of bytes currently allocated from the default malloc zone */
+static size_t report_test_heap_in_use (void) {
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+}
+
+/**
+ * Verify that the decoding arena is released when decoding of a truncated or corrupt report fails. Each failed decode
+ * allocates an arena of at least 4KB; the reports are decoded repeatedly, such that a leaked arena would be apparent
+ * in the heap's growth.
+ */
+- (void) testDecodeFailureReleasesArena {
+    NSData *data = [self writeTestReport];
+    const NSUInteger iterations = 256;
+
+    /* A report truncated within its required records */
+    NSData *truncated = [data subdataWithRange: NSMakeRange(0, 16)];
+
+    /* A complete report followed by a thread record with an invalid wire type; the report's framing is intact, but the
+     * record can't be unpacked */
+    NSMutableData *corrupt = [NSMutableData dataWithData: data];
+    const uint8_t invalid_thread[] = { (3 << 3) | 2, 0x01, 0x0F };
+    [corrupt appendBytes: invalid_thread length: sizeof(invalid_thread)];
+
+    NSData *reports[] = { truncated, corrupt };
+    PLCrashReportDecodingOptions options[] = { PLCrashReportDecodingOptionNone, PLCrashReportDecodingOptionConcurrent };
+    for (size_t r = 0; r < sizeof(reports) / sizeof(reports[0]); r++) {
+        for (size_t o = 0; o < sizeof(options) / sizeof(options[0]); o++) {
+            /* Verify that decoding fails, and let any one-time allocations settle */
+            NSError *error = nil;
+            STAssertNil([[[PLCrashReport alloc] initWithData: reports[r] options: options[o] error: &error] autorelease], @"Decoded an invalid report");
+            STAssertNotNil(error, @"No error returned");
+
+            size_t heapBefore = report_test_heap_in_use();
+            for (NSUInteger i = 0; i < iterations; i++) {
+                NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+                [[[PLCrashReport alloc] initWithData: reports[r] options: options[o] error: NULL] autorelease];
+                [pool drain];
+            }
+            size_t heapAfter = report_test_heap_in_use();
+
+            size_t growth = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+            STAssertTrue(growth < iterations * 1024, @"Heap grew by %zu bytes over %lu failed decodes of report %zu", growth, (unsigned long) iterations, r);
+        }
+    }
+}
+
+/**
+ * Verify that the objects vended by a report remain valid once the report -- and its decoding arena -- have been
+ * released.
+ */
+- (void) testDecodedObjectsOutliveReport {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *reference = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(reference, @"Could not decode crash log: %@", error);
+
+    PLCrashReportDecodingOptions options[] = { PLCrashReportDecodingOptionNone, PLCrashReportDecodingOptionLazy };
+    for (size_t o = 0; o < sizeof(options) / sizeof(options[0]); o++) {
+        NSArray *threads;
+        NSArray *images;
+        PLCrashReportSignalInfo *signalInfo;
+        PLCrashReportSystemInfo *systemInfo;
+
+        /* Decode and release the report, retaining only the vended objects */
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        PLCrashReport *report = [[PLCrashReport alloc] initWithData: data options: options[o] error: &error];
+        STAssertNotNil(report, @"Could not decode crash log: %@", error);
+
+        threads = [report.threads retain];
+        images = [report.images retain];
+        signalInfo = [report.signalInfo retain];
+        systemInfo = [report.systemInfo retain];
+
+        [report release];
+        [pool drain];
+
+        /* The retained objects must match those of a live report */
+        STAssertEqualStrings(signalInfo.name, reference.signalInfo.name, @"Signal is incorrect");
+        STAssertEqualStrings(systemInfo.operatingSystemVersion, reference.systemInfo.operatingSystemVersion, @"OS version is incorrect");
+
+        STAssertEquals([threads count], [reference.threads count], @"Incorrect thread count");
+        for (NSUInteger i = 0; i < [threads count] && i < [reference.threads count]; i++) {
+            PLCrashReportThreadInfo *expected = [reference.threads objectAtIndex: i];
+            PLCrashReportThreadInfo *actual = [threads objectAtIndex: i];
+
+            STAssertEquals([actual.registers count], [expected.registers count], @"Incorrect register count");
+            for (NSUInteger r = 0; r < [expected.registers count] && r < [actual.registers count]; r++)
+                STAssertEqualStrings([[actual.registers objectAtIndex: r] registerName], [[expected.registers objectAtIndex: r] registerName], @"Incorrect register name");
+
+            STAssertEquals([actual.stackFrames count], [expected.stackFrames count], @"Incorrect frame count");
+            for (NSUInteger f = 0; f < [expected.stackFrames count] && f < [actual.stackFrames count]; f++) {
+                PLCrashReportStackFrameInfo *expectedFrame = [expected.stackFrames objectAtIndex: f];
+                PLCrashReportStackFrameInfo *actualFrame = [actual.stackFrames objectAtIndex: f];
+                STAssertEquals(actualFrame.instructionPointer, expectedFrame.instructionPointer, @"Incorrect frame address");
+                if (expectedFrame.symbolInfo != nil)
+                    STAssertEqualStrings(actualFrame.symbolInfo.symbolName, expectedFrame.symbolInfo.symbolName, @"Incorrect symbol name");
+            }
+        }
+
+        STAssertEquals([images count], [reference.images count], @"Incorrect image count");
+        for (NSUInteger i = 0; i < [images count] && i < [reference.images count]; i++) {
+            PLCrashReportBinaryImageInfo *expected = [reference.images objectAtIndex: i];
+            PLCrashReportBinaryImageInfo *actual = [images objectAtIndex: i];
+            STAssertEqualStrings(actual.imageName, expected.imageName, @"Incorrect image name");
+            STAssertEqualStrings(actual.imageUUID, expected.imageUUID, @"Incorrect image UUID");
+        }
+
+        [threads release];
+        [images release];
+        [signalInfo release];
+        [systemInfo release];
+    }
+}
+
+/**
+ * Decode @a data eagerly and lazily, touching the lazily decoded records, as is done by the fuzz harness's report
+ * target. Returns a bitmask of the decodes that succeeded.
+ */
+static unsigned int report_test_fuzz_decode (NSData *data) {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    unsigned int decoded = 0;
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: NULL] autorelease];
+    if (report != nil)
+        decoded |= 1 << 0;
+
+    report = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: NULL] autorelease];
+    if (report != nil) {
+        decoded |= 1 << 1;
+        [report crashedThread];
+        [report threads];
+        [report images];
+    }
+
+    [pool drain];
+    return decoded;
+}
+
+/**
+ * Verify that a report may be decoded repeatedly in-process from mutated inputs, as is done by the persistent fuzz
+ * harness: each input must decode identically when it is run again, and no state may accumulate across inputs.
+ */
+- (void) testDecodeMutatedReportsInProcess {
+    NSData *data = [self writeTestReport];
+    const NSUInteger inputCount = 128;
+    uint32_t seed = 0x5EED;
+
+    /* Produce a fixed set of inputs, each with a few bytes of the report replaced */
+    NSMutableArray *inputs = [NSMutableArray arrayWithCapacity: inputCount];
+    for (NSUInteger i = 0; i < inputCount; i++) {
+        NSMutableData *input = [NSMutableData dataWithData: data];
+        uint8_t *bytes = [input mutableBytes];
+        for (int m = 0; m < 4; m++) {
+            seed = seed * 1103515245 + 12345;
+            size_t offset = (seed >> 8) % [input length];
+            seed = seed * 1103515245 + 12345;
+            bytes[offset] = (uint8_t) (seed >> 16);
+        }
+        [inputs addObject: input];
+    }
+
+    /* Run every input once, recording the results and letting any one-time allocations settle */
+    unsigned int results[inputCount];
+    for (NSUInteger i = 0; i < inputCount; i++)
+        results[i] = report_test_fuzz_decode([inputs objectAtIndex: i]);
+
+    /* Each subsequent run must match the first, and must not grow the heap */
+    size_t heapBefore = report_test_heap_in_use();
+    for (int pass = 0; pass < 2; pass++) {
+        for (NSUInteger i = 0; i < inputCount; i++)
+            STAssertEquals(report_test_fuzz_decode([inputs objectAtIndex: i]), results[i], @"Input %lu decoded differently when run again", (unsigned long) i);
+    }
+    size_t heapAfter = report_test_heap_in_use();
+
+    size_t growth = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+    STAssertTrue(growth < inputCount * 1024, @"Heap grew by %zu bytes over %lu repeated inputs", growth, (unsigned long) inputCount * 2);
+
+    /* The unmodified report still decodes */
+    STAssertEquals(report_test_fuzz_decode(data), 3U, @"The unmodified report failed to decode");
+}
+
+/**
+ * Verify that indexed image lookups match a linear search of the report's images.
+ */
+- (void) testImageForAddress {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode crash log: %@", error);
+
+    NSMutableArray *addresses = [NSMutableArray array];
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames)
+            [addresses addObject: [NSNumber numberWithUnsignedLongLong: frame.instructionPointer]];
+    }
+
+    /* Image boundaries, and addresses outside of any image */
+    for (PLCrashReportBinaryImageInfo *imageInfo in report.images) {
+        [addresses addObject: [NSNumber numberWithUnsignedLongLong: imageInfo.imageBaseAddress]];
+        [addresses addObject: [NSNumber numberWithUnsignedLongLong: imageInfo.imageBaseAddress - 1]];
+        [addresses addObject: [NSNumber numberWithUnsignedLongLong: imageInfo.imageBaseAddress + imageInfo.imageSize]];
+        [addresses addObject: [NSNumber numberWithUnsignedLongLong: imageInfo.imageBaseAddress + imageInfo.imageSize - 1]];
+    }
+    [addresses addObject: [NSNumber numberWithUnsignedLongLong: 0]];
+    [addresses addObject: [NSNumber numberWithUnsignedLongLong: UINT64_MAX]];
+
+    for (NSNumber *number in addresses) {
+        uint64_t address = [number unsignedLongLongValue];
+
+        PLCrashReportBinaryImageInfo *expected = nil;
+        for (PLCrashReportBinaryImageInfo *imageInfo in report.images) {
+            if (imageInfo.imageBaseAddress <= address && address < (imageInfo.imageBaseAddress + imageInfo.imageSize)) {
+                expected = imageInfo;
+                break;
+            }
+        }
+
+        STAssertEquals([report imageForAddress: address], expected, @"Incorrect image returned for 0x%" PRIx64, address);
+    }
+}
+
+/**
+ * Verify the cached sorted image list and the derived image values.
+ */
+- (void) testSortedImages {
+    NSData *data = [self writeTestReport];
+    NSError *error = nil;
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode crash log: %@", error);
+
+    NSArray *sorted = report.sortedImages;
+    STAssertEquals([sorted count], [report.images count], @"Incorrect sorted image count");
+    STAssertTrue(report.sortedImages == sorted, @"The sorted image list should be cached");
+
+    for (NSUInteger i = 1; i < [sorted count]; i++) {
+        PLCrashReportBinaryImageInfo *prev = [sorted objectAtIndex: i - 1];
+        PLCrashReportBinaryImageInfo *cur = [sorted objectAtIndex: i];
+        STAssertTrue(prev.imageBaseAddress <= cur.imageBaseAddress, @"Images are not sorted");
+    }
+
+    for (PLCrashReportBinaryImageInfo *imageInfo in sorted) {
+        STAssertEqualObjects(imageInfo.imageFileName, [imageInfo.imageName lastPathComponent], @"Incorrect file name");
+        STAssertTrue(imageInfo.imageFileName == imageInfo.imageFileName, @"The file name should be cached");
+        STAssertNotNil(imageInfo.architectureName, @"Missing architecture name");
+    }
+}
+
 @end
@@ -45,6 +45,24 @@ typedef enum {
     PLCrashReportTextFormatiOS = 0
 } PLCrashReportTextFormat;
 
+/**
+ * Text formatter options.
+ *
+ * @ingroup enums
+ */
+typedef NS_OPTIONS(NSUInteger, PLCrashReportTextFormatterOptions) {
+    /** No options. */
+    PLCrashReportTextFormatterOptionNone = 0,
+
+    /**
+     * Demangle Swift and C++ symbol names. Each report's unique symbol names are demangled concurrently, and the
+     * results are memoized process-wide; symbols shared by many reports are only demangled once.
+     *
+     * Swift names are only demangled if the Swift runtime is loaded in the formatting process.
+     */
+    PLCrashReportTextFormatterOptionDemangleSymbols = 1 << 0,
+};
+
 
 @interface PLCrashReportTextFormatter : NSObject <PLCrashReportFormatter> {
 @private
@@ -53,10 +71,20 @@ typedef enum {
 
     /** Encoding to use for string output. */
     NSStringEncoding _stringEncoding;
+
+    /** Formatter options. */
+    PLCrashReportTextFormatterOptions _options;
 }
 
 + (NSString *) stringValueForCrashReport: (PLCrashReport *) report withTextFormat: (PLCrashReportTextFormat) textFormat;
 
 - (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding;
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding options: (PLCrashReportTextFormatterOptions) options;
+
+- (BOOL) formatReport: (PLCrashReport *) report toOutputStream: (NSOutputStream *) stream error: (NSError **) outError;
+- (BOOL) formatReport: (PLCrashReport *) report toFileDescriptor: (int) fd error: (NSError **) outError;
+
+- (NSData *) formatReportData: (NSData *) data error: (NSError **) outError;
+- (BOOL) formatReportData: (NSData *) data toFileDescriptor: (int) fd error: (NSError **) outError;
 
 @end
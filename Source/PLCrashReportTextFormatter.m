@@ -32,14 +32,26 @@
 #import "CrashReporter/CrashReporter.h"
 
 #import "PLCrashReportTextFormatter.h"
+#import "PLCrashReportTextWriter.h"
+#import "PLCrashSymbolDemangler.h"
 #import "PLCrashCompatConstants.h"
 
 @interface PLCrashReportTextFormatter (PrivateAPI)
-static NSInteger binaryImageSort(id binary1, id binary2, void *context);
-+ (NSString *) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
-                     frameIndex: (NSUInteger) frameIndex
-                         report: (PLCrashReport *) report
-                           lp64: (BOOL) lp64;
++ (void) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+         demangledSymbols: (NSDictionary *) demangledSymbols
+                 toWriter: (PLCrashReportTextWriter *) text;
+- (BOOL) formatReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) writer error: (NSError **) outError;
+- (NSDictionary *) demangledSymbolsForReport: (PLCrashReport *) report;
++ (void) writeStackFrame: (uint64_t) instructionPointer
+              symbolName: (NSString *) symbolName
+      symbolStartAddress: (uint64_t) symbolStartAddress
+              frameIndex: (NSUInteger) frameIndex
+                  report: (PLCrashReport *) report
+                    lp64: (BOOL) lp64
+        imageColumnCache: (CFMutableDictionaryRef) imageColumnCache
+        demangledSymbols: (NSDictionary *) demangledSymbols
+                toWriter: (PLCrashReportTextWriter *) text;
 @end
 
 
@@ -59,9 +71,202 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
  * @return Returns the formatted result on success, or nil if an error occurs.
  */
 + (NSString *) stringValueForCrashReport: (PLCrashReport *) report withTextFormat: (PLCrashReportTextFormat) textFormat {
-	NSMutableString* text = [NSMutableString string];
+    NSMutableString *result = [NSMutableString string];
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithString: result] autorelease];
+
+    [self writeCrashReport: report withTextFormat: textFormat demangledSymbols: nil toWriter: writer];
+    [writer flush];
+
+    return result;
+}
+
+/**
+ * Initialize with the request string encoding and output format.
+ *
+ * @param textFormat Format to use for the generated text crash report.
+ * @param stringEncoding Encoding to use when writing to the output stream.
+ */
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding {
+    return [self initWithTextFormat: textFormat stringEncoding: stringEncoding options: PLCrashReportTextFormatterOptionNone];
+}
+
+/**
+ * Initialize with the request string encoding, output format, and formatter options.
+ *
+ * @param textFormat Format to use for the generated text crash report.
+ * @param stringEncoding Encoding to use when writing to the output stream.
+ * @param options Formatter options.
+ */
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding options: (PLCrashReportTextFormatterOptions) options {
+    if ((self = [super init]) == nil)
+        return nil;
+    
+    _textFormat = textFormat;
+    _stringEncoding = stringEncoding;
+    _options = options;
+
+    return self;
+}
+
+// from PLCrashReportFormatter protocol
+- (NSData *) formatReport: (PLCrashReport *) report error: (NSError **) outError {
+    NSMutableData *data = [NSMutableData data];
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithData: data encoding: _stringEncoding] autorelease];
+
+    /* The text is encoded incrementally; the full report is never held as a string. */
+    [PLCrashReportTextFormatter writeCrashReport: report withTextFormat: _textFormat demangledSymbols: [self demangledSymbolsForReport: report] toWriter: writer];
+    [writer flush];
+
+    return data;
+}
+
+/**
+ * Format the provided @a report, incrementally writing the encoded text to @a stream. The full report text will
+ * not be held in memory.
+ *
+ * @param report Report to be formatted.
+ * @param stream An open output stream to which the formatted report will be written.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be written. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if writing to @a stream failed.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toOutputStream: (NSOutputStream *) stream error: (NSError **) outError {
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithOutputStream: stream encoding: _stringEncoding] autorelease];
+    return [self formatReport: report toWriter: writer error: outError];
+}
+
+/**
+ * Format the provided @a report, incrementally writing the encoded text to the file descriptor @a fd. The full
+ * report text will not be held in memory.
+ *
+ * @param report Report to be formatted.
+ * @param fd An open file descriptor to which the formatted report will be written. The caller retains ownership
+ * of the descriptor.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be written. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if writing to @a fd failed.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toFileDescriptor: (int) fd error: (NSError **) outError {
+    PLCrashReportTextWriter *writer = [[[PLCrashReportTextWriter alloc] initWithFileDescriptor: fd encoding: _stringEncoding] autorelease];
+    return [self formatReport: report toWriter: writer error: outError];
+}
+
+/**
+ * Decode and format the encoded crash report @a data.
+ *
+ * The report is decoded with PLCrashReportDecodingOptionLazy, and its thread and image records are only decoded as
+ * they are formatted. Stack frames and registers are read from the decoded thread records' flat storage; no per-frame
+ * objects are created. This is the preferred entry point for bulk conversion of encoded reports.
+ *
+ * @param data Encoded crash report data, as returned by PLCrashReporter.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be decoded. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the formatted report data on success, or nil on failure.
+ */
+- (NSData *) formatReportData: (NSData *) data error: (NSError **) outError {
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: outError] autorelease];
+    if (report == nil)
+        return nil;
+
+    return [self formatReport: report error: outError];
+}
+
+/**
+ * Decode the encoded crash report @a data, incrementally writing the formatted text to the file descriptor @a fd.
+ * See formatReportData:error: for details.
+ *
+ * @param data Encoded crash report data, as returned by PLCrashReporter.
+ * @param fd An open file descriptor to which the formatted report will be written. The caller retains ownership
+ * of the descriptor.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be decoded or written. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the report could not be decoded, or writing to @a fd failed.
+ */
+- (BOOL) formatReportData: (NSData *) data toFileDescriptor: (int) fd error: (NSError **) outError {
+    PLCrashReport *report = [[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: outError];
+    if (report == nil)
+        return NO;
+
+    BOOL result = [self formatReport: report toFileDescriptor: fd error: outError];
+    [report release];
+
+    return result;
+}
+
+@end
+
+
+@implementation PLCrashReportTextFormatter (PrivateMethods)
+
+/**
+ * Format @a report to @a writer, flushing any remaining output.
+ */
+- (BOOL) formatReport: (PLCrashReport *) report toWriter: (PLCrashReportTextWriter *) writer error: (NSError **) outError {
+    [PLCrashReportTextFormatter writeCrashReport: report withTextFormat: _textFormat demangledSymbols: [self demangledSymbolsForReport: report] toWriter: writer];
+    if (![writer flush]) {
+        if (outError != NULL)
+            *outError = writer.error;
+        return NO;
+    }
+
+    return YES;
+}
+
+/**
+ * If PLCrashReportTextFormatterOptionDemangleSymbols is enabled, return a dictionary mapping each of @a report's
+ * mangled symbol names to its demangled form. Otherwise, returns nil.
+ */
+- (NSDictionary *) demangledSymbolsForReport: (PLCrashReport *) report {
+    if (!(_options & PLCrashReportTextFormatterOptionDemangleSymbols))
+        return nil;
+
+    /* Collect the report's unique symbol names; these are demangled together, allowing the uncached names to be
+     * demangled concurrently */
+    NSMutableSet *symbols = [NSMutableSet set];
+    for (PLCrashReportStackFrameInfo *frame in report.exceptionInfo.stackFrames) {
+        if (frame.symbolInfo.symbolName != nil)
+            [symbols addObject: frame.symbolInfo.symbolName];
+    }
+
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        NSUInteger frameCount = thread.frameCount;
+        for (NSUInteger i = 0; i < frameCount; i++) {
+            NSString *symbolName = [thread symbolNameAtIndex: i];
+            if (symbolName != nil)
+                [symbols addObject: symbolName];
+        }
+    }
+
+    return [PLCrashSymbolDemangler demangledNamesForSymbols: symbols];
+}
+
+/**
+ * Format @a report as human-readable text in the given @a textFormat, appending the result to @a text.
+ *
+ * @param report The report to format.
+ * @param textFormat The text format to use.
+ * @param demangledSymbols A dictionary mapping mangled symbol names to their demangled form, or nil.
+ * @param text The output writer.
+ */
++ (void) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+         demangledSymbols: (NSDictionary *) demangledSymbols
+                 toWriter: (PLCrashReportTextWriter *) text
+{
 	boolean_t lp64 = true; // quiesce GCC uninitialized value warning
 
+    /* Padded UTF-8 image name columns, shared by all formatted stack frames. Keyed by the (non-retained) image
+     * info instance, which remains valid for the lifetime of the report. */
+    CFMutableDictionaryRef imageColumnCache = CFDictionaryCreateMutable(NULL, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+
 	/* Header */
 	
     /* Map to apple style OS nane */
@@ -251,12 +456,8 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
     [text appendFormat: @"Exception Type:  %@\n", report.signalInfo.name];
     [text appendFormat: @"Exception Codes: %@ at 0x%" PRIx64 "\n", report.signalInfo.code, report.signalInfo.address];
     
-    for (PLCrashReportThreadInfo *thread in report.threads) {
-        if (thread.crashed) {
-            [text appendFormat: @"Crashed Thread:  %ld\n", (long) thread.threadNumber];
-            break;
-        }
-    }
+    if (report.crashedThread != nil)
+        [text appendFormat: @"Crashed Thread:  %ld\n", (long) report.crashedThread.threadNumber];
     
     [text appendString: @"\n"];
     
@@ -280,7 +481,15 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
          * post-processed report, Apple writes this out as full frame entries. We use the latter format. */
         for (NSUInteger frame_idx = 0; frame_idx < [exception.stackFrames count]; frame_idx++) {
             PLCrashReportStackFrameInfo *frameInfo = [exception.stackFrames objectAtIndex: frame_idx];
-            [text appendString: [self formatStackFrame: frameInfo frameIndex: frame_idx report: report lp64: lp64]];
+            [self writeStackFrame: frameInfo.instructionPointer
+                       symbolName: frameInfo.symbolInfo.symbolName
+               symbolStartAddress: frameInfo.symbolInfo.startAddress
+                       frameIndex: frame_idx
+                           report: report
+                             lp64: lp64
+                 imageColumnCache: imageColumnCache
+                 demangledSymbols: demangledSymbols
+                         toWriter: text];
         }
         [text appendString: @"\n"];
     }
@@ -289,16 +498,50 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
     PLCrashReportThreadInfo *crashed_thread = nil;
     NSInteger maxThreadNum = 0;
     for (PLCrashReportThreadInfo *thread in report.threads) {
+        /* As with Apple's reports, the queue label precedes the thread's backtrace */
+        if (thread.dispatchQueueLabel != nil)
+            [text appendFormat: @"Thread %ld name:  Dispatch queue: %@\n", (long) thread.threadNumber, thread.dispatchQueueLabel];
+
         if (thread.crashed) {
             [text appendFormat: @"Thread %ld Crashed:\n", (long) thread.threadNumber];
             crashed_thread = thread;
+        } else if (thread.secondaryCrashSignalInfo != nil) {
+            PLCrashReportSignalInfo *signal = thread.secondaryCrashSignalInfo;
+            [text appendFormat: @"Thread %ld Also Crashed (%@ %@ at 0x%" PRIx64 "):\n", (long) thread.threadNumber,
+                signal.name, signal.code, signal.address];
         } else {
             [text appendFormat: @"Thread %ld:\n", (long) thread.threadNumber];
         }
-        for (NSUInteger frame_idx = 0; frame_idx < [thread.stackFrames count]; frame_idx++) {
-            PLCrashReportStackFrameInfo *frameInfo = [thread.stackFrames objectAtIndex: frame_idx];
-            [text appendString: [self formatStackFrame: frameInfo frameIndex: frame_idx report: report lp64: lp64]];
+        /* Frames are read from the thread's flat frame storage, rather than via stackFrames, which would create an
+         * object for each frame */
+        NSUInteger frameCount = thread.frameCount;
+        for (NSUInteger frame_idx = 0; frame_idx < frameCount; frame_idx++) {
+
+            /* Note frames omitted from a truncated backtrace */
+            if (thread.omittedFrameCount > 0 && thread.omittedFrameIndex == frame_idx)
+                [text appendFormat: @"...  (%lu frames omitted)\n", (unsigned long) thread.omittedFrameCount];
+
+            [self writeStackFrame: [thread instructionPointerAtIndex: frame_idx]
+                       symbolName: [thread symbolNameAtIndex: frame_idx]
+               symbolStartAddress: [thread symbolStartAddressAtIndex: frame_idx]
+                       frameIndex: frame_idx
+                           report: report
+                             lp64: lp64
+                 imageColumnCache: imageColumnCache
+                 demangledSymbols: demangledSymbols
+                         toWriter: text];
+
+            /* Note the repetitions of a collapsed run that ends with this frame */
+            for (PLCrashReportFrameRepeatInfo *repeat in thread.frameRepeats) {
+                if (repeat.frameIndex + repeat.frameCount - 1 != frame_idx)
+                    continue;
+
+                [text appendFormat: @"...  (frames %lu-%lu repeated %lu more times)\n", (unsigned long) repeat.frameIndex,
+                    (unsigned long) frame_idx, (unsigned long) repeat.repeatCount];
+            }
         }
+        if (thread.omittedFrameCount > 0 && thread.omittedFrameIndex >= frameCount)
+            [text appendFormat: @"...  (%lu frames omitted)\n", (unsigned long) thread.omittedFrameCount];
         [text appendString: @"\n"];
 
         /* Track the highest thread number */
@@ -308,33 +551,34 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
     /* Registers */
     if (crashed_thread != nil) {
         [text appendFormat: @"Thread %ld crashed with %@ Thread State:\n", (long) crashed_thread.threadNumber, codeType];
-        
+
+        /* Apple uses 'ip' rather than 'r12' on ARM */
+        BOOL remapIP = NO;
+        if (report.machineInfo != nil && report.machineInfo.processorInfo.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
+            PLCrashReportProcessorInfo *pinfo = report.machineInfo.processorInfo;
+            cpu_type_t arch_type = pinfo.type & ~CPU_ARCH_MASK;
+            if (arch_type == CPU_TYPE_ARM)
+                remapIP = YES;
+        }
+
         int regColumn = 0;
-        for (PLCrashReportRegisterInfo *reg in crashed_thread.registers) {
-            NSString *reg_fmt;
-            
-            /* Use 32-bit or 64-bit fixed width format for the register values */
-            if (lp64)
-                reg_fmt = @"%6s: 0x%016" PRIx64 " ";
-            else
-                reg_fmt = @"%6s: 0x%08" PRIx64 " ";
-            
+        for (NSUInteger reg_idx = 0; reg_idx < crashed_thread.registerCount; reg_idx++) {
             /* Remap register names to match Apple's crash reports */
-            NSString *regName = reg.registerName;
-            if (report.machineInfo != nil && report.machineInfo.processorInfo.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
-                PLCrashReportProcessorInfo *pinfo = report.machineInfo.processorInfo;
-                cpu_type_t arch_type = pinfo.type & ~CPU_ARCH_MASK;
-
-                /* Apple uses 'ip' rather than 'r12' on ARM */
-                if (arch_type == CPU_TYPE_ARM && [regName isEqual: @"r12"]) {
-                    regName = @"ip";
-                }
-            }
-            [text appendFormat: reg_fmt, [regName UTF8String], reg.registerValue];
+            const char *regName = [[crashed_thread registerNameAtIndex: reg_idx] UTF8String];
+            if (regName == NULL)
+                regName = "";
+            else if (remapIP && strcmp(regName, "r12") == 0)
+                regName = "ip";
+
+            /* Use 32-bit or 64-bit fixed width format for the register values */
+            [text appendCString: regName width: 6];
+            [text appendUTF8: ": 0x" length: 4];
+            [text appendHex: [crashed_thread registerValueAtIndex: reg_idx] digits: lp64 ? 16 : 8];
+            [text appendUTF8: " " length: 1];
 
             regColumn++;
             if (regColumn == 4) {
-                [text appendString: @"\n"];
+                [text appendUTF8: "\n" length: 1];
                 regColumn = 0;
             }
         }
@@ -347,170 +591,120 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
     
     /* Images. The iPhone crash report format sorts these in ascending order, by the base address */
     [text appendString: @"Binary Images:\n"];
-    for (PLCrashReportBinaryImageInfo *imageInfo in [report.images sortedArrayUsingFunction: binaryImageSort context: nil]) {
-        NSString *uuid;
+    for (PLCrashReportBinaryImageInfo *imageInfo in report.sortedImages) {
+        const char *uuid;
         /* Fetch the UUID if it exists */
         if (imageInfo.hasImageUUID)
-            uuid = imageInfo.imageUUID;
+            uuid = [imageInfo.imageUUID UTF8String];
         else
-            uuid = @"???";
-        
-        /* Determine the architecture string */
-        NSString *archName = @"???";
-        if (imageInfo.codeType != nil && imageInfo.codeType.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
-            switch (imageInfo.codeType.type) {
-                case CPU_TYPE_ARM:
-                    /* Apple includes subtype for ARM binaries. */
-                    switch (imageInfo.codeType.subtype) {
-                        case CPU_SUBTYPE_ARM_V6:
-                            archName = @"armv6";
-                            break;
-
-                        case CPU_SUBTYPE_ARM_V7:
-                            archName = @"armv7";
-                            break;
-                            
-                        case CPU_SUBTYPE_ARM_V7S:
-                            archName = @"armv7s";
-                            break;
-
-                        default:
-                            archName = @"arm-unknown";
-                            break;
-                    }
-                    break;
-                    
-                case CPU_TYPE_ARM64:
-                    /* Apple includes subtype for ARM64 binaries. */
-                    switch (imageInfo.codeType.subtype) {
-                        case CPU_SUBTYPE_ARM_ALL:
-                            archName = @"arm64";
-                            break;
-
-                        case CPU_SUBTYPE_ARM_V8:
-                            archName = @"armv8";
-                            break;
-
-                        default:
-                            archName = @"arm64-unknown";
-                            break;
-                    }
-                    break;
-                    
-                case CPU_TYPE_X86:
-                    archName = @"i386";
-                    break;
-                    
-                case CPU_TYPE_X86_64:
-                    archName = @"x86_64";
-                    break;
-
-                case CPU_TYPE_POWERPC:
-                    archName = @"powerpc";
-                    break;
-
-                default:
-                    // Use the default archName value (initialized above).
-                    break;
-            }
-        }
+            uuid = "???";
 
         /* Determine if this is the main executable */
-        NSString *binaryDesignator = @" ";
+        const char *binaryDesignator = " ";
         if ([imageInfo.imageName isEqual: report.processInfo.processPath])
-            binaryDesignator = @"+";
+            binaryDesignator = "+";
         
         /* base_address - terminating_address [designator]file_name arch <uuid> file_path */
-        NSString *fmt = nil;
-        if (lp64) {
-            fmt = @"%18#" PRIx64 " - %18#" PRIx64 " %@%@ %@  <%@> %@\n";
-        } else {
-            fmt = @"%10#" PRIx64 " - %10#" PRIx64 " %@%@ %@  <%@> %@\n";
-        }
-
-        [text appendFormat: fmt,
-                            imageInfo.imageBaseAddress,
-                            imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1), // The Apple format uses an inclusive range
-                            binaryDesignator,
-                            [imageInfo.imageName lastPathComponent],
-                            archName,
-                            uuid,
-                            imageInfo.imageName];
+        int addressWidth = lp64 ? 18 : 10;
+        [text appendAlternateHex: imageInfo.imageBaseAddress width: addressWidth];
+        [text appendUTF8: " - " length: 3];
+        // The Apple format uses an inclusive range
+        [text appendAlternateHex: imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1) width: addressWidth];
+        [text appendUTF8: " " length: 1];
+        [text appendCString: binaryDesignator];
+        [text appendString: imageInfo.imageFileName];
+        [text appendUTF8: " " length: 1];
+        [text appendString: imageInfo.architectureName];
+        [text appendUTF8: "  <" length: 3];
+        [text appendCString: uuid];
+        [text appendUTF8: "> " length: 2];
+        [text appendString: imageInfo.imageName];
+        [text appendUTF8: "\n" length: 1];
     }
-    
 
-    return text;
+    CFRelease(imageColumnCache);
 }
 
 /**
- * Initialize with the request string encoding and output format.
+ * Write a stack frame line for display in a thread backtrace.
  *
- * @param textFormat Format to use for the generated text crash report.
- * @param stringEncoding Encoding to use when writing to the output stream.
- */
-- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding {
-    if ((self = [super init]) == nil)
-        return nil;
-    
-    _textFormat = textFormat;
-    _stringEncoding = stringEncoding;
-
-    return self;
-}
-
-// from PLCrashReportFormatter protocol
-- (NSData *) formatReport: (PLCrashReport *) report error: (NSError **) outError {
-    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: _textFormat];
-    return [text dataUsingEncoding: _stringEncoding allowLossyConversion: YES];
-}
-		 
-@end
-
-
-@implementation PLCrashReportTextFormatter (PrivateMethods)
-
-/**
- * Format a stack frame for display in a thread backtrace.
- *
- * @param frameInfo The stack frame to format
+ * @param instructionPointer The frame's instruction pointer.
+ * @param symbolName The frame's symbol name, or nil if no symbol information is available.
+ * @param symbolStartAddress The frame's symbol start address. Ignored if @a symbolName is nil.
  * @param frameIndex The frame's index
  * @param report The report from which this frame was acquired.
  * @param lp64 If YES, the report was generated by an LP64 system.
- *
- * @return Returns a formatted frame line.
+ * @param imageColumnCache A cache of padded UTF-8 image name columns, keyed by image info instance.
+ * @param demangledSymbols A dictionary mapping mangled symbol names to their demangled form, or nil.
+ * @param text The output writer.
  */
-+ (NSString *) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
-                     frameIndex: (NSUInteger) frameIndex
-                         report: (PLCrashReport *) report
-                           lp64: (BOOL) lp64
++ (void) writeStackFrame: (uint64_t) instructionPointer
+              symbolName: (NSString *) symbolName
+      symbolStartAddress: (uint64_t) symbolStartAddress
+              frameIndex: (NSUInteger) frameIndex
+                  report: (PLCrashReport *) report
+                    lp64: (BOOL) lp64
+        imageColumnCache: (CFMutableDictionaryRef) imageColumnCache
+        demangledSymbols: (NSDictionary *) demangledSymbols
+                toWriter: (PLCrashReportTextWriter *) text
 {
+    /* Width of the image name column */
+    static const NSUInteger imageColumnWidth = 35;
+
     /* Base image address containing instrumention pointer, offset of the IP from that base
      * address, and the associated image name */
     uint64_t baseAddress = 0x0;
     uint64_t pcOffset = 0x0;
-    NSString *imageName = @"\?\?\?";
-    NSString *symbolString = nil;
-    
-    PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress: frameInfo.instructionPointer];
+
+    PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress: instructionPointer];
     if (imageInfo != nil) {
-        imageName = [imageInfo.imageName lastPathComponent];
         baseAddress = imageInfo.imageBaseAddress;
-        pcOffset = frameInfo.instructionPointer - imageInfo.imageBaseAddress;
+        pcOffset = instructionPointer - imageInfo.imageBaseAddress;
     }
 
+    /* The padded column is computed once per image; frames outside any known image share the kCFNull entry. The
+     * width is measured in UTF-16 characters, as with printf's %-35S. */
+    const void *imageKey = imageInfo != nil ? (const void *) imageInfo : (const void *) kCFNull;
+    NSData *imageColumn = (NSData *) CFDictionaryGetValue(imageColumnCache, imageKey);
+    if (imageColumn == nil) {
+        NSString *imageName = imageInfo.imageFileName;
+        if (imageName == nil)
+            imageName = @"\?\?\?";
+        NSMutableData *column = [NSMutableData dataWithData: [imageName dataUsingEncoding: NSUTF8StringEncoding]];
+        for (NSUInteger i = [imageName length]; i < imageColumnWidth; i++)
+            [column appendBytes: " " length: 1];
+
+        CFDictionarySetValue(imageColumnCache, imageKey, column);
+        imageColumn = column;
+    }
+
+    [text appendDecimal: (int64_t) frameIndex width: -4];
+    [text appendUTF8: [imageColumn bytes] length: [imageColumn length]];
+    [text appendUTF8: " 0x" length: 3];
+    [text appendHex: instructionPointer digits: lp64 ? 16 : 8];
+    [text appendUTF8: " " length: 1];
+
     /* If symbol info is available, the format used in Apple's reports is Sym + OffsetFromSym. Otherwise,
      * the format used is imageBaseAddress + offsetToIP */
-    if (frameInfo.symbolInfo != nil) {
-        NSString *symbolName = frameInfo.symbolInfo.symbolName;
+    NSString *demangledName = symbolName != nil ? [demangledSymbols objectForKey: symbolName] : nil;
+    if (demangledName != nil) {
+        /* The demangled name does not include the symbol prefix */
+        [text appendString: demangledName];
+        [text appendUTF8: " + " length: 3];
+        [text appendDecimal: (int64_t) (instructionPointer - symbolStartAddress) width: 0];
+    } else if (symbolName != nil) {
+        const char *symbol = [symbolName UTF8String];
+        if (symbol == NULL)
+            symbol = "";
 
         /* Apple strips the _ symbol prefix in their reports. Only OS X makes use of an
          * underscore symbol prefix by default. */
-        if ([symbolName rangeOfString: @"_"].location == 0 && [symbolName length] > 1) {
+        if (symbol[0] == '_' && symbol[1] != '\0') {
             switch (report.systemInfo.operatingSystem) {
                 case PLCrashReportOperatingSystemMacOSX:
                 case PLCrashReportOperatingSystemiPhoneOS:
                 case PLCrashReportOperatingSystemiPhoneSimulator:
-                    symbolName = [symbolName substringFromIndex: 1];
+                    symbol++;
                     break;
 
                 default:
@@ -518,37 +712,18 @@ static NSInteger binaryImageSort(id binary1, id binary2, void *context);
                     break;
             }
         }
-        
-        
-        uint64_t symOffset = frameInfo.instructionPointer - frameInfo.symbolInfo.startAddress;
-        symbolString = [NSString stringWithFormat: @"%@ + %" PRId64, symbolName, symOffset];
+
+        [text appendCString: symbol];
+        [text appendUTF8: " + " length: 3];
+        [text appendDecimal: (int64_t) (instructionPointer - symbolStartAddress) width: 0];
     } else {
-        symbolString = [NSString stringWithFormat: @"0x%" PRIx64 " + %" PRId64, baseAddress, pcOffset];
+        [text appendUTF8: "0x" length: 2];
+        [text appendHex: baseAddress digits: 1];
+        [text appendUTF8: " + " length: 3];
+        [text appendDecimal: (int64_t) pcOffset width: 0];
     }
 
-    /* Note that width specifiers are ignored for %@, but work for C strings.
-     * UTF-8 is not correctly handled with %s (it depends on the system encoding), but
-     * UTF-16 is supported via %S, so we use it here */
-    return [NSString stringWithFormat: @"%-4ld%-35S 0x%0*" PRIx64 " %@\n",
-            (long) frameIndex,
-            (const uint16_t *)[imageName cStringUsingEncoding: NSUTF16StringEncoding],
-            lp64 ? 16 : 8, frameInfo.instructionPointer,
-            symbolString];
-}
-
-/**
- * Sort PLCrashReportBinaryImageInfo instances by their starting address.
- */
-static NSInteger binaryImageSort(id binary1, id binary2, void *context) {
-    uint64_t addr1 = [binary1 imageBaseAddress];
-    uint64_t addr2 = [binary2 imageBaseAddress];
-    
-    if (addr1 < addr2)
-        return NSOrderedAscending;
-    else if (addr1 > addr2)
-        return NSOrderedDescending;
-    else
-        return NSOrderedSame;
+    [text appendUTF8: "\n" length: 1];
 }
 
 @end
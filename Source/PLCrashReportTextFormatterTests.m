@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashReport.h"
+#import "PLCrashReporter.h"
+#import "PLCrashReportTextFormatter.h"
+
+#import <fcntl.h>
+
+@interface PLCrashReportTextFormatterTests : SenTestCase {
+@private
+    /** A decoded live report. */
+    PLCrashReport *_report;
+}
+@end
+
+@implementation PLCrashReportTextFormatterTests
+
+- (void) setUp {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    _report = [[PLCrashReport alloc] initWithData: reportData error: &error];
+    STAssertNotNil(_report, @"Could not parse geneated live report: %@", error);
+}
+
+- (void) tearDown {
+    [_report release];
+}
+
+/**
+ * Verify that formatted data matches the string formatter output.
+ */
+- (void) testFormatReport {
+    NSString *expected = [PLCrashReportTextFormatter stringValueForCrashReport: _report withTextFormat: PLCrashReportTextFormatiOS];
+    STAssertTrue([expected rangeOfString: @"Binary Images:\n"].location != NSNotFound, @"Missing binary image section");
+
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF8StringEncoding] autorelease];
+    NSData *data = [formatter formatReport: _report error: NULL];
+    STAssertEqualObjects(data, [expected dataUsingEncoding: NSUTF8StringEncoding], @"Formatted data does not match");
+}
+
+/**
+ * Verify streaming output to an NSOutputStream.
+ */
+- (void) testFormatReportToOutputStream {
+    NSString *expected = [PLCrashReportTextFormatter stringValueForCrashReport: _report withTextFormat: PLCrashReportTextFormatiOS];
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF8StringEncoding] autorelease];
+    NSError *error;
+
+    NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+    [stream open];
+    STAssertTrue([formatter formatReport: _report toOutputStream: stream error: &error], @"Failed to write report: %@", error);
+
+    NSData *data = [stream propertyForKey: NSStreamDataWrittenToMemoryStreamKey];
+    [stream close];
+
+    STAssertEqualObjects(data, [expected dataUsingEncoding: NSUTF8StringEncoding], @"Streamed data does not match");
+}
+
+/**
+ * Verify streaming output to a file descriptor, including error reporting.
+ */
+- (void) testFormatReportToFileDescriptor {
+    NSString *expected = [PLCrashReportTextFormatter stringValueForCrashReport: _report withTextFormat: PLCrashReportTextFormatiOS];
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF8StringEncoding] autorelease];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSError *error;
+
+    int fd = open([path fileSystemRepresentation], O_RDWR|O_CREAT|O_EXCL, 0644);
+    STAssertTrue(fd >= 0, @"Could not open test output file");
+
+    STAssertTrue([formatter formatReport: _report toFileDescriptor: fd error: &error], @"Failed to write report: %@", error);
+    close(fd);
+
+    STAssertEqualObjects([NSData dataWithContentsOfFile: path], [expected dataUsingEncoding: NSUTF8StringEncoding], @"Written data does not match");
+    STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: path error: &error], @"Could not remove output file");
+
+    /* Writes to an invalid descriptor must fail */
+    error = nil;
+    STAssertFalse([formatter formatReport: _report toFileDescriptor: -1 error: &error], @"Write to an invalid descriptor succeeded");
+    STAssertNotNil(error, @"No error returned");
+}
+
+/**
+ * Verify that the binary image lines match the equivalent Foundation-formatted output.
+ */
+- (void) testFormatBinaryImages {
+    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: _report withTextFormat: PLCrashReportTextFormatiOS];
+    BOOL lp64 = (_report.machineInfo.processorInfo.type & CPU_ARCH_ABI64) != 0;
+
+    for (PLCrashReportBinaryImageInfo *imageInfo in _report.images) {
+        NSString *fmt = lp64 ? @"%18#" PRIx64 " - %18#" PRIx64 " " : @"%10#" PRIx64 " - %10#" PRIx64 " ";
+        NSString *range = [NSString stringWithFormat: fmt, imageInfo.imageBaseAddress,
+                           imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1)];
+        NSString *suffix = [NSString stringWithFormat: @"%@  <%@> %@\n", [imageInfo.imageName lastPathComponent],
+                            imageInfo.hasImageUUID ? imageInfo.imageUUID : @"???", imageInfo.imageName];
+
+        NSRange line = [text rangeOfString: range];
+        STAssertTrue(line.location != NSNotFound, @"Missing image range %@", range);
+        STAssertTrue([text rangeOfString: suffix].location != NSNotFound, @"Missing image line for %@", imageInfo.imageName);
+    }
+}
+
+/**
+ * Verify output in an encoding other than the writer's internal UTF-8.
+ */
+- (void) testFormatReportUTF16 {
+    NSString *expected = [PLCrashReportTextFormatter stringValueForCrashReport: _report withTextFormat: PLCrashReportTextFormatiOS];
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF16LittleEndianStringEncoding] autorelease];
+
+    NSData *data = [formatter formatReport: _report error: NULL];
+    NSString *decoded = [[[NSString alloc] initWithData: data encoding: NSUTF16LittleEndianStringEncoding] autorelease];
+    STAssertEqualObjects(decoded, expected, @"Formatted UTF-16 data does not match");
+}
+
+/**
+ * Verify that formatting encoded report data matches formatting of the decoded report.
+ */
+- (void) testFormatReportData {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(report, @"Could not parse geneated live report: %@", error);
+
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: PLCrashReportTextFormatiOS stringEncoding: NSUTF8StringEncoding] autorelease];
+    NSData *expected = [formatter formatReport: report error: NULL];
+
+    STAssertEqualObjects([formatter formatReportData: reportData error: &error], expected, @"Formatted data does not match");
+
+    /* Invalid report data must fail to decode */
+    error = nil;
+    STAssertNil([formatter formatReportData: [NSData dataWithBytes: "junk" length: 4] error: &error], @"Invalid data was formatted");
+    STAssertNotNil(error, @"No error returned");
+}
+
+/**
+ * Verify that reports mapped from disk and decoded lazily, with the crashed thread accessed before the remainder of the
+ * report is formatted, produce the same text as an eagerly decoded report when formatted concurrently on an operation
+ * queue, as is done by CrashViewer and the QuickLook generator.
+ */
+- (void) testFormatLazyReportsConcurrently {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    STAssertTrue([reportData writeToFile: path options: NSDataWritingAtomic error: &error], @"Failed to write report: %@", error);
+
+    PLCrashReport *eager = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(eager, @"Could not parse generated live report: %@", error);
+    NSString *expected = [PLCrashReportTextFormatter stringValueForCrashReport: eager withTextFormat: PLCrashReportTextFormatiOS];
+
+    /* Format several lazily decoded copies of the report at once */
+    NSUInteger count = 8;
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity: count];
+    for (NSUInteger i = 0; i < count; i++)
+        [results addObject: [NSNull null]];
+
+    NSOperationQueue *queue = [[[NSOperationQueue alloc] init] autorelease];
+    queue.maxConcurrentOperationCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    for (NSUInteger i = 0; i < count; i++) {
+        [queue addOperationWithBlock: ^{
+            NSData *mapped = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: NULL];
+            PLCrashReport *report = [[[PLCrashReport alloc] initWithData: mapped options: PLCrashReportDecodingOptionLazy error: NULL] autorelease];
+
+            /* The crashed thread is available prior to formatting, and must be unchanged by the full decode */
+            NSInteger crashedNumber = report.crashedThread.threadNumber;
+            NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: PLCrashReportTextFormatiOS];
+            if (report.crashedThread == nil || report.crashedThread.threadNumber != crashedNumber)
+                text = nil;
+
+            @synchronized (results) {
+                if (text != nil)
+                    [results replaceObjectAtIndex: i withObject: text];
+            }
+        }];
+    }
+    [queue waitUntilAllOperationsAreFinished];
+
+    for (NSUInteger i = 0; i < count; i++)
+        STAssertEqualObjects([results objectAtIndex: i], expected, @"Lazily decoded report %lu does not match", (unsigned long) i);
+
+    STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: path error: &error], @"Could not remove report file");
+}
+
+@end
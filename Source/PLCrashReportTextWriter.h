@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * @internal
+ * Output destinations supported by PLCrashReportTextWriter.
+ */
+typedef enum {
+    /** Append to an NSMutableString. */
+    PLCrashReportTextWriterSinkString = 0,
+
+    /** Append encoded bytes to an NSMutableData. */
+    PLCrashReportTextWriterSinkData,
+
+    /** Write encoded bytes to an open NSOutputStream. */
+    PLCrashReportTextWriterSinkStream,
+
+    /** Write encoded bytes to a file descriptor. */
+    PLCrashReportTextWriterSinkFileDescriptor
+} PLCrashReportTextWriterSink;
+
+/**
+ * @internal
+ *
+ * Accumulates formatted report text in a bounded buffer, flushing the encoded text to the output
+ * destination as the buffer fills. Shared by the text and JSON report formatters.
+ */
+@interface PLCrashReportTextWriter : NSObject {
+@private
+    /** Output destination type. */
+    PLCrashReportTextWriterSink _sink;
+
+    /** Pending UTF-8 encoded text. */
+    char *_bytes;
+
+    /** Number of bytes pending in _bytes. */
+    size_t _length;
+
+    /** Allocated size of _bytes. */
+    size_t _capacity;
+
+    /** Output string, if writing to PLCrashReportTextWriterSinkString. */
+    NSMutableString *_string;
+
+    /** Output encoding. */
+    NSStringEncoding _encoding;
+
+    /** Output data, if writing to PLCrashReportTextWriterSinkData. */
+    NSMutableData *_data;
+
+    /** Output stream, if writing to PLCrashReportTextWriterSinkStream. */
+    NSOutputStream *_stream;
+
+    /** Output file descriptor, if writing to PLCrashReportTextWriterSinkFileDescriptor. */
+    int _fd;
+
+    /** The first error that occured while writing output, or nil. */
+    NSError *_error;
+}
+
+- (id) initWithString: (NSMutableString *) string;
+- (id) initWithData: (NSMutableData *) data encoding: (NSStringEncoding) encoding;
+- (id) initWithOutputStream: (NSOutputStream *) stream encoding: (NSStringEncoding) encoding;
+- (id) initWithFileDescriptor: (int) fd encoding: (NSStringEncoding) encoding;
+
+- (void) appendString: (NSString *) string;
+- (void) appendFormat: (NSString *) format, ... NS_FORMAT_FUNCTION(1,2);
+- (void) appendUTF8: (const char *) bytes length: (size_t) length;
+- (void) appendCString: (const char *) string;
+- (void) appendCString: (const char *) string width: (int) width;
+- (void) appendHex: (uint64_t) value digits: (int) digits;
+- (void) appendAlternateHex: (uint64_t) value width: (int) width;
+- (void) appendDecimal: (int64_t) value width: (int) width;
+- (BOOL) flush;
+
+/** The first error that occured while writing output, or nil. */
+@property(nonatomic, readonly) NSError *error;
+
+@end
+
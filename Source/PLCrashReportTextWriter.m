@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportTextWriter.h"
+#import "CrashReporter/CrashReporter.h"
+
+#import <errno.h>
+#import <unistd.h>
+
+/** @internal
+ * Number of bytes buffered by PLCrashReportTextWriter before the text is flushed. String output is
+ * not flushed until the report is complete. */
+#define PLCRASH_TEXT_WRITER_BUFFER_SIZE (16 * 1024)
+
+/** @internal
+ * Maximum number of characters produced by the PLCrashReportTextWriter number formatting methods, excluding padding. */
+#define PLCRASH_TEXT_WRITER_NUMBER_MAX 24
+
+/** @internal
+ * Lowercase hexadecimal digit pairs, indexed by byte value. */
+static const char plcrash_text_hex_pairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+/**
+ * @internal
+ *
+ * Format @a value as lowercase hexadecimal, zero-padded to at least @a digits digits, writing the digits to the
+ * end of @a buf. This matches printf's %0<digits>x.
+ *
+ * @param value The value to format.
+ * @param digits The minimum number of digits; at most 16.
+ * @param buf The output buffer; must be at least PLCRASH_TEXT_WRITER_NUMBER_MAX bytes.
+ *
+ * @return Returns a pointer to the first formatted digit. The digits extend to buf + PLCRASH_TEXT_WRITER_NUMBER_MAX.
+ */
+static char *plcrash_text_format_hex (uint64_t value, int digits, char *buf) {
+    char *end = buf + PLCRASH_TEXT_WRITER_NUMBER_MAX;
+    char *p = end;
+
+    /* Emit two digits per table lookup */
+    do {
+        const char *pair = &plcrash_text_hex_pairs[(value & 0xff) * 2];
+        *--p = pair[1];
+        *--p = pair[0];
+        value >>= 8;
+    } while (value != 0);
+
+    /* Drop the leading zero of the final pair */
+    if (*p == '0' && end - p > 1)
+        p++;
+
+    while (end - p < digits)
+        *--p = '0';
+
+    return p;
+}
+
+/**
+ * @internal
+ *
+ * Format @a value as signed decimal, writing the digits to the end of @a buf. This matches printf's %lld.
+ *
+ * @param value The value to format.
+ * @param buf The output buffer; must be at least PLCRASH_TEXT_WRITER_NUMBER_MAX bytes.
+ *
+ * @return Returns a pointer to the first formatted character. The text extends to buf + PLCRASH_TEXT_WRITER_NUMBER_MAX.
+ */
+static char *plcrash_text_format_decimal (int64_t value, char *buf) {
+    char *p = buf + PLCRASH_TEXT_WRITER_NUMBER_MAX;
+
+    /* Negate via the unsigned type, which is well-defined for INT64_MIN */
+    uint64_t magnitude = value < 0 ? (0 - (uint64_t) value) : (uint64_t) value;
+    do {
+        *--p = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+        *--p = '-';
+
+    return p;
+}
+
+@implementation PLCrashReportTextWriter
+
+@synthesize error = _error;
+
+/**
+ * Initialize a writer that appends all output to @a string.
+ */
+- (id) initWithString: (NSMutableString *) string {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _sink = PLCrashReportTextWriterSinkString;
+    _string = [string retain];
+
+    return self;
+}
+
+/**
+ * Initialize a writer that appends the output, encoded with @a encoding, to @a data.
+ */
+- (id) initWithData: (NSMutableData *) data encoding: (NSStringEncoding) encoding {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _sink = PLCrashReportTextWriterSinkData;
+    _data = [data retain];
+    _encoding = encoding;
+
+    return self;
+}
+
+/**
+ * Initialize a writer that writes the output, encoded with @a encoding, to the open @a stream.
+ */
+- (id) initWithOutputStream: (NSOutputStream *) stream encoding: (NSStringEncoding) encoding {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _sink = PLCrashReportTextWriterSinkStream;
+    _stream = [stream retain];
+    _encoding = encoding;
+
+    return self;
+}
+
+/**
+ * Initialize a writer that writes the output, encoded with @a encoding, to @a fd.
+ */
+- (id) initWithFileDescriptor: (int) fd encoding: (NSStringEncoding) encoding {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _sink = PLCrashReportTextWriterSinkFileDescriptor;
+    _fd = fd;
+    _encoding = encoding;
+
+    return self;
+}
+
+- (void) dealloc {
+    free(_bytes);
+    [_string release];
+    [_data release];
+    [_stream release];
+    [_error release];
+
+    [super dealloc];
+}
+
+/**
+ * Append @a length bytes of UTF-8 encoded text to the output. The text must not end within a multibyte sequence.
+ */
+- (void) appendUTF8: (const char *) bytes length: (size_t) length {
+    if (_length + length > _capacity) {
+        size_t capacity = MAX(_capacity * 2, PLCRASH_TEXT_WRITER_BUFFER_SIZE);
+        while (capacity < _length + length)
+            capacity *= 2;
+
+        char *grown = realloc(_bytes, capacity);
+        if (grown == NULL) {
+            NSLog(@"Could not allocate %zu bytes for report text", capacity);
+            return;
+        }
+
+        _bytes = grown;
+        _capacity = capacity;
+    }
+
+    memcpy(_bytes + _length, bytes, length);
+    _length += length;
+
+    if (_sink != PLCrashReportTextWriterSinkString && _length >= PLCRASH_TEXT_WRITER_BUFFER_SIZE)
+        [self flush];
+}
+
+/**
+ * Append the NUL-terminated UTF-8 @a string to the output.
+ */
+- (void) appendCString: (const char *) string {
+    [self appendUTF8: string length: strlen(string)];
+}
+
+/**
+ * Append the NUL-terminated UTF-8 @a string to the output, padded with spaces to @a width bytes. As with printf's
+ * %*s, a negative @a width left-aligns the string.
+ */
+- (void) appendCString: (const char *) string width: (int) width {
+    static const char spaces[] = "                                                                ";
+    size_t length = strlen(string);
+    BOOL leftAlign = (width < 0);
+    size_t padding = 0;
+
+    if (leftAlign)
+        width = -width;
+    if (length < (size_t) width)
+        padding = width - length;
+
+    if (leftAlign)
+        [self appendUTF8: string length: length];
+
+    while (padding > 0) {
+        size_t chunk = MIN(padding, sizeof(spaces) - 1);
+        [self appendUTF8: spaces length: chunk];
+        padding -= chunk;
+    }
+
+    if (!leftAlign)
+        [self appendUTF8: string length: length];
+}
+
+/**
+ * Append @a value as lowercase hexadecimal, zero-padded to at least @a digits digits. This is equivalent to
+ * appending a string formatted with "%0*" PRIx64.
+ */
+- (void) appendHex: (uint64_t) value digits: (int) digits {
+    char buf[PLCRASH_TEXT_WRITER_NUMBER_MAX];
+    char *p = plcrash_text_format_hex(value, MIN(digits, 16), buf);
+    [self appendUTF8: p length: (buf + sizeof(buf)) - p];
+}
+
+/**
+ * Append @a value as lowercase hexadecimal with a 0x prefix, right-aligned to @a width characters. As with printf's
+ * alternate form, a zero value is written without a prefix. This is equivalent to appending a string formatted
+ * with "%*#" PRIx64.
+ */
+- (void) appendAlternateHex: (uint64_t) value width: (int) width {
+    char buf[PLCRASH_TEXT_WRITER_NUMBER_MAX + 1];
+    char *p = plcrash_text_format_hex(value, 1, buf);
+
+    if (value != 0) {
+        *--p = 'x';
+        *--p = '0';
+    }
+
+    buf[PLCRASH_TEXT_WRITER_NUMBER_MAX] = '\0';
+    [self appendCString: p width: width];
+}
+
+/**
+ * Append @a value as signed decimal, padded with spaces to @a width characters. As with printf's %*lld, a negative
+ * @a width left-aligns the value.
+ */
+- (void) appendDecimal: (int64_t) value width: (int) width {
+    char buf[PLCRASH_TEXT_WRITER_NUMBER_MAX + 1];
+    char *p = plcrash_text_format_decimal(value, buf);
+
+    buf[PLCRASH_TEXT_WRITER_NUMBER_MAX] = '\0';
+    [self appendCString: p width: width];
+}
+
+/**
+ * Append @a string to the output.
+ */
+- (void) appendString: (NSString *) string {
+    const char *utf8 = [string UTF8String];
+    if (utf8 != NULL)
+        [self appendCString: utf8];
+}
+
+/**
+ * Append a formatted string to the output.
+ */
+- (void) appendFormat: (NSString *) format, ... {
+    va_list ap;
+
+    va_start(ap, format);
+    NSString *string = [[NSString alloc] initWithFormat: format arguments: ap];
+    va_end(ap);
+
+    [self appendString: string];
+    [string release];
+}
+
+/**
+ * Encode and write all pending output. String output is converted once, when the writer is first flushed
+ * after the report is complete.
+ *
+ * @return Returns YES on success, or NO if an error has occured writing output. Once an error has occured, all
+ * further output is discarded.
+ */
+- (BOOL) flush {
+    if (_error != nil) {
+        _length = 0;
+        return NO;
+    }
+
+    if (_length == 0)
+        return YES;
+
+    /* Text is buffered as UTF-8; any other output encoding requires a conversion */
+    const uint8_t *bytes = (const uint8_t *) _bytes;
+    NSUInteger remaining = _length;
+    NSData *encoded = nil;
+
+    if (_sink == PLCrashReportTextWriterSinkString || _encoding != NSUTF8StringEncoding) {
+        NSString *text = [[NSString alloc] initWithBytesNoCopy: _bytes length: _length encoding: NSUTF8StringEncoding freeWhenDone: NO];
+        if (_sink == PLCrashReportTextWriterSinkString) {
+            [_string appendString: text];
+        } else {
+            encoded = [text dataUsingEncoding: _encoding allowLossyConversion: YES];
+            bytes = [encoded bytes];
+            remaining = [encoded length];
+        }
+        [text release];
+    }
+
+    _length = 0;
+
+    switch (_sink) {
+        case PLCrashReportTextWriterSinkString:
+            break;
+
+        case PLCrashReportTextWriterSinkData:
+            [_data appendBytes: bytes length: remaining];
+            break;
+
+        case PLCrashReportTextWriterSinkStream:
+            while (remaining > 0) {
+                NSInteger written = [_stream write: bytes maxLength: remaining];
+                if (written <= 0) {
+                    _error = [[_stream streamError] retain];
+                    if (_error == nil) {
+                        _error = [[NSError errorWithDomain: PLCrashReporterErrorDomain code: PLCrashReporterErrorOperatingSystem userInfo: [NSDictionary dictionaryWithObject: @"Output stream reached capacity" forKey: NSLocalizedDescriptionKey]] retain];
+                    }
+                    return NO;
+                }
+
+                bytes += written;
+                remaining -= written;
+            }
+            break;
+
+        case PLCrashReportTextWriterSinkFileDescriptor:
+            while (remaining > 0) {
+                ssize_t written = write(_fd, bytes, remaining);
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+
+                    _error = [[NSError errorWithDomain: NSPOSIXErrorDomain code: errno userInfo: nil] retain];
+                    return NO;
+                }
+
+                bytes += written;
+                remaining -= written;
+            }
+            break;
+    }
+
+    return YES;
+}
+
+@end
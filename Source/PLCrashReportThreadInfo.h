@@ -30,20 +30,67 @@
 
 #import "PLCrashReportStackFrameInfo.h"
 #import "PLCrashReportRegisterInfo.h"
+#import "PLCrashReportFrameRepeatInfo.h"
+#import "PLCrashReportSignalInfo.h"
 
 @interface PLCrashReportThreadInfo : NSObject {
 @private
     /** The thread number. Should be unique within a given crash log. */
     NSInteger _threadNumber;
 
-    /** Ordered list of PLCrashReportStackFrame instances */
-    NSArray *_stackFrames;
+    /** The number of stack frames. */
+    NSUInteger _frameCount;
+
+    /** The frame instruction pointers, in backtrace order. */
+    uint64_t *_instructionPointers;
+
+    /** The frame symbol start addresses. Entries for frames without symbol information are 0. */
+    uint64_t *_symbolStartAddresses;
+
+    /** The frame symbol end addresses. Entries for frames without symbol information, or for which the end address is unknown, are 0. */
+    uint64_t *_symbolEndAddresses;
+
+    /** The frame symbol names. Entries for frames without symbol information are nil. */
+    NSString **_symbolNames;
 
     /** YES if this thread crashed. */
     BOOL _crashed;
 
-    /** List of PLCrashReportRegister instances. Will be empty if _crashed is NO. */
+    /** The number of registers. Will be 0 if _crashed is NO. */
+    NSUInteger _registerCount;
+
+    /** The register values. */
+    uint64_t *_registerValues;
+
+    /** The register names. */
+    NSString **_registerNames;
+
+    /** The names of the symbols referenced by the register values. Entries for unannotated registers are nil. */
+    NSString **_registerSymbolNames;
+
+    /** The start addresses of the symbols referenced by the register values. Entries for unannotated registers are 0. */
+    uint64_t *_registerSymbolStartAddresses;
+
+    /** Ordered list of PLCrashReportStackFrame instances, or nil if not yet created from the frame storage. */
+    NSArray *_stackFrames;
+
+    /** List of PLCrashReportRegister instances, or nil if not yet created from the register storage. */
     NSArray *_registers;
+
+    /** Ordered list of PLCrashReportFrameRepeatInfo instances. */
+    NSArray *_frameRepeats;
+
+    /** The number of frames omitted from the truncated backtrace. */
+    NSUInteger _omittedFrameCount;
+
+    /** The index at which frames were omitted. */
+    NSUInteger _omittedFrameIndex;
+
+    /** The signal information of a secondary crash, or nil. */
+    PLCrashReportSignalInfo *_secondaryCrashSignalInfo;
+
+    /** The label of the dispatch queue the thread was servicing, or nil. */
+    NSString *_dispatchQueueLabel;
 }
 
 - (id) initWithThreadNumber: (NSInteger) threadNumber
@@ -51,11 +98,113 @@
                     crashed: (BOOL) crashed
                   registers: (NSArray *) registers;
 
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                stackFrames: (NSArray *) stackFrames
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel
+        registerSymbolNames: (NSString * const *) registerSymbolNames
+registerSymbolStartAddresses: (const uint64_t *) registerSymbolStartAddresses;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                    crashed: (BOOL) crashed
+          stackOfThreadInfo: (PLCrashReportThreadInfo *) thread;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                    crashed: (BOOL) crashed
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel
+          stackOfThreadInfo: (PLCrashReportThreadInfo *) thread;
+
+- (uint64_t) instructionPointerAtIndex: (NSUInteger) frameIndex;
+- (NSString *) symbolNameAtIndex: (NSUInteger) frameIndex;
+- (uint64_t) symbolStartAddressAtIndex: (NSUInteger) frameIndex;
+
+- (NSString *) registerNameAtIndex: (NSUInteger) registerIndex;
+- (uint64_t) registerValueAtIndex: (NSUInteger) registerIndex;
+- (NSString *) registerSymbolNameAtIndex: (NSUInteger) registerIndex;
+
 /**
  * Application thread number.
  */
 @property(nonatomic, readonly) NSInteger threadNumber;
 
+/**
+ * The number of frames in the thread backtrace.
+ */
+@property(nonatomic, readonly) NSUInteger frameCount;
+
+/**
+ * The frame instruction pointers, as a C array of frameCount values ordered as stackFrames. The array is owned by
+ * the receiver and remains valid for its lifetime.
+ *
+ * Consumers that only require frame addresses should prefer this accessor to stackFrames, which creates an object
+ * for each frame.
+ */
+@property(nonatomic, readonly) const uint64_t *instructionPointers;
+
 /**
  * Thread backtrace. Provides an array of PLCrashReportStackFrameInfo instances.
  * The array is ordered, last callee to first.
@@ -74,4 +223,44 @@
  */
 @property(nonatomic, readonly) NSArray *registers;
 
+/**
+ * The number of registers in the thread's register state.
+ */
+@property(nonatomic, readonly) NSUInteger registerCount;
+
+/**
+ * The register values, as a C array of registerCount values ordered as registers. The array is owned by the receiver
+ * and remains valid for its lifetime.
+ */
+@property(nonatomic, readonly) const uint64_t *registerValues;
+
+/**
+ * Runs of consecutively repeated stack frames that were collapsed when the backtrace was written, as an ordered
+ * list of PLCrashReportFrameRepeatInfo instances. Only the first occurrence of each run is included in stackFrames.
+ */
+@property(nonatomic, readonly) NSArray *frameRepeats;
+
+/**
+ * The number of frames omitted from the backtrace when it was truncated, or 0 if no frames were omitted.
+ */
+@property(nonatomic, readonly) NSUInteger omittedFrameCount;
+
+/**
+ * The index within stackFrames at which frames were omitted; the omitted frames immediately precede the frame at
+ * this index. Only meaningful if omittedFrameCount is non-zero.
+ */
+@property(nonatomic, readonly) NSUInteger omittedFrameIndex;
+
+/**
+ * If this thread crashed while the crashed thread's report was being written, the signal information of its crash;
+ * otherwise nil. The thread's stackFrames and registers reflect its state at the time of its crash.
+ */
+@property(nonatomic, readonly) PLCrashReportSignalInfo *secondaryCrashSignalInfo;
+
+/**
+ * The label of the dispatch queue the thread was servicing at the time of the crash, or nil if the thread was not
+ * servicing a queue, or the queue had no label.
+ */
+@property(nonatomic, readonly) NSString *dispatchQueueLabel;
+
 @end
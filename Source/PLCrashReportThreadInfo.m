@@ -42,29 +42,535 @@
                 stackFrames: (NSArray *) stackFrames
                     crashed: (BOOL) crashed
                   registers: (NSArray *) registers
+{
+    return [self initWithThreadNumber: threadNumber
+                          stackFrames: stackFrames
+                              crashed: crashed
+                            registers: registers
+                         frameRepeats: [NSArray array]
+                    omittedFrameCount: 0
+                    omittedFrameIndex: 0];
+}
+
+/**
+ * Initialize the crash log thread information, including the description of a truncated or collapsed backtrace.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                stackFrames: (NSArray *) stackFrames
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+{
+    NSUInteger frameCount = [stackFrames count];
+    NSUInteger registerCount = [registers count];
+
+    /* Flatten the frame and register instances into temporary arrays */
+    uint64_t *values = malloc(sizeof(uint64_t) * (frameCount * 3 + registerCount * 2) + 1);
+    NSString **names = malloc(sizeof(NSString *) * (frameCount + registerCount * 2) + 1);
+
+    uint64_t *pcs = values;
+    uint64_t *starts = pcs + frameCount;
+    uint64_t *ends = starts + frameCount;
+    uint64_t *regValues = ends + frameCount;
+    uint64_t *regSymbolStarts = regValues + registerCount;
+    NSString **symbolNames = names;
+    NSString **regNames = names + frameCount;
+    NSString **regSymbolNames = regNames + registerCount;
+
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        PLCrashReportStackFrameInfo *frame = [stackFrames objectAtIndex: i];
+        PLCrashReportSymbolInfo *symbol = frame.symbolInfo;
+
+        pcs[i] = frame.instructionPointer;
+        starts[i] = symbol.startAddress;
+        ends[i] = symbol.endAddress;
+        symbolNames[i] = symbol.symbolName;
+    }
+
+    for (NSUInteger i = 0; i < registerCount; i++) {
+        PLCrashReportRegisterInfo *reg = [registers objectAtIndex: i];
+        regNames[i] = reg.registerName;
+        regValues[i] = reg.registerValue;
+        regSymbolNames[i] = reg.symbolInfo.symbolName;
+        regSymbolStarts[i] = reg.symbolInfo.startAddress;
+    }
+
+    self = [self initWithThreadNumber: threadNumber
+                           frameCount: frameCount
+                  instructionPointers: pcs
+                          symbolNames: symbolNames
+                 symbolStartAddresses: starts
+                   symbolEndAddresses: ends
+                              crashed: crashed
+                        registerCount: registerCount
+                        registerNames: regNames
+                       registerValues: regValues
+                         frameRepeats: frameRepeats
+                    omittedFrameCount: omittedFrameCount
+                    omittedFrameIndex: omittedFrameIndex
+             secondaryCrashSignalInfo: nil
+                   dispatchQueueLabel: nil
+                  registerSymbolNames: regSymbolNames
+         registerSymbolStartAddresses: regSymbolStarts];
+    free(values);
+    free(names);
+
+    if (self == nil)
+        return nil;
+
+    /* The caller's instances are already available; vend them as-is */
+    _stackFrames = [stackFrames retain];
+    _registers = [registers retain];
+
+    return self;
+}
+
+/**
+ * Initialize the crash log thread information from flat frame and register arrays. The arrays are copied; no
+ * per-frame or per-register objects are created until stackFrames or registers is accessed.
+ *
+ * @param threadNumber The thread number.
+ * @param frameCount The number of stack frames.
+ * @param instructionPointers The @a frameCount frame instruction pointers, last callee to first.
+ * @param symbolNames The @a frameCount frame symbol names. An entry of nil marks a frame without symbol information.
+ * @param symbolStartAddresses The @a frameCount frame symbol start addresses.
+ * @param symbolEndAddresses The @a frameCount frame symbol end addresses, or 0 where unknown.
+ * @param crashed YES if this thread crashed.
+ * @param registerCount The number of registers.
+ * @param registerNames The @a registerCount register names.
+ * @param registerValues The @a registerCount register values.
+ * @param frameRepeats Ordered list of PLCrashReportFrameRepeatInfo instances.
+ * @param omittedFrameCount The number of frames omitted from a truncated backtrace.
+ * @param omittedFrameIndex The index at which frames were omitted.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+{
+    return [self initWithThreadNumber: threadNumber
+                           frameCount: frameCount
+                  instructionPointers: instructionPointers
+                          symbolNames: symbolNames
+                 symbolStartAddresses: symbolStartAddresses
+                   symbolEndAddresses: symbolEndAddresses
+                              crashed: crashed
+                        registerCount: registerCount
+                        registerNames: registerNames
+                       registerValues: registerValues
+                         frameRepeats: frameRepeats
+                    omittedFrameCount: omittedFrameCount
+                    omittedFrameIndex: omittedFrameIndex
+             secondaryCrashSignalInfo: nil];
+}
+
+/**
+ * Initialize the crash log thread information from flat frame and register arrays, for a thread that may have crashed
+ * while the crashed thread's report was being written.
+ *
+ * @param threadNumber The thread number.
+ * @param frameCount The number of stack frames.
+ * @param instructionPointers The @a frameCount frame instruction pointers, last callee to first.
+ * @param symbolNames The @a frameCount frame symbol names. An entry of nil marks a frame without symbol information.
+ * @param symbolStartAddresses The @a frameCount frame symbol start addresses.
+ * @param symbolEndAddresses The @a frameCount frame symbol end addresses, or 0 where unknown.
+ * @param crashed YES if this thread crashed.
+ * @param registerCount The number of registers.
+ * @param registerNames The @a registerCount register names.
+ * @param registerValues The @a registerCount register values.
+ * @param frameRepeats Ordered list of PLCrashReportFrameRepeatInfo instances.
+ * @param omittedFrameCount The number of frames omitted from a truncated backtrace.
+ * @param omittedFrameIndex The index at which frames were omitted.
+ * @param secondaryCrashSignalInfo The signal information of the thread's secondary crash, or nil.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo
+{
+    return [self initWithThreadNumber: threadNumber
+                           frameCount: frameCount
+                  instructionPointers: instructionPointers
+                          symbolNames: symbolNames
+                 symbolStartAddresses: symbolStartAddresses
+                   symbolEndAddresses: symbolEndAddresses
+                              crashed: crashed
+                        registerCount: registerCount
+                        registerNames: registerNames
+                       registerValues: registerValues
+                         frameRepeats: frameRepeats
+                    omittedFrameCount: omittedFrameCount
+                    omittedFrameIndex: omittedFrameIndex
+             secondaryCrashSignalInfo: secondaryCrashSignalInfo
+                   dispatchQueueLabel: nil];
+}
+
+/**
+ * Initialize the crash log thread information from flat frame and register arrays.
+ *
+ * @param threadNumber The thread number.
+ * @param frameCount The number of stack frames.
+ * @param instructionPointers The @a frameCount frame instruction pointers, last callee to first.
+ * @param symbolNames The @a frameCount frame symbol names. An entry of nil marks a frame without symbol information.
+ * @param symbolStartAddresses The @a frameCount frame symbol start addresses.
+ * @param symbolEndAddresses The @a frameCount frame symbol end addresses, or 0 where unknown.
+ * @param crashed YES if this thread crashed.
+ * @param registerCount The number of registers.
+ * @param registerNames The @a registerCount register names.
+ * @param registerValues The @a registerCount register values.
+ * @param frameRepeats Ordered list of PLCrashReportFrameRepeatInfo instances.
+ * @param omittedFrameCount The number of frames omitted from a truncated backtrace.
+ * @param omittedFrameIndex The index at which frames were omitted.
+ * @param secondaryCrashSignalInfo The signal information of the thread's secondary crash, or nil.
+ * @param dispatchQueueLabel The label of the dispatch queue the thread was servicing, or nil.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel
+{
+    return [self initWithThreadNumber: threadNumber
+                           frameCount: frameCount
+                  instructionPointers: instructionPointers
+                          symbolNames: symbolNames
+                 symbolStartAddresses: symbolStartAddresses
+                   symbolEndAddresses: symbolEndAddresses
+                              crashed: crashed
+                        registerCount: registerCount
+                        registerNames: registerNames
+                       registerValues: registerValues
+                         frameRepeats: frameRepeats
+                    omittedFrameCount: omittedFrameCount
+                    omittedFrameIndex: omittedFrameIndex
+             secondaryCrashSignalInfo: secondaryCrashSignalInfo
+                   dispatchQueueLabel: dispatchQueueLabel
+                  registerSymbolNames: NULL
+         registerSymbolStartAddresses: NULL];
+}
+
+/**
+ * Initialize the crash log thread information from flat frame and register arrays, including the symbols referenced
+ * by the register values.
+ *
+ * @param threadNumber The thread number.
+ * @param frameCount The number of stack frames.
+ * @param instructionPointers The @a frameCount frame instruction pointers, last callee to first.
+ * @param symbolNames The @a frameCount frame symbol names. An entry of nil marks a frame without symbol information.
+ * @param symbolStartAddresses The @a frameCount frame symbol start addresses.
+ * @param symbolEndAddresses The @a frameCount frame symbol end addresses, or 0 where unknown.
+ * @param crashed YES if this thread crashed.
+ * @param registerCount The number of registers.
+ * @param registerNames The @a registerCount register names.
+ * @param registerValues The @a registerCount register values.
+ * @param frameRepeats Ordered list of PLCrashReportFrameRepeatInfo instances.
+ * @param omittedFrameCount The number of frames omitted from a truncated backtrace.
+ * @param omittedFrameIndex The index at which frames were omitted.
+ * @param secondaryCrashSignalInfo The signal information of the thread's secondary crash, or nil.
+ * @param dispatchQueueLabel The label of the dispatch queue the thread was servicing, or nil.
+ * @param registerSymbolNames The @a registerCount names of the symbols referenced by the register values, or NULL if
+ * the registers were not annotated. An entry of nil marks a register without symbol information.
+ * @param registerSymbolStartAddresses The @a registerCount start addresses of the symbols referenced by the register
+ * values, or NULL if the registers were not annotated.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameCount: (NSUInteger) frameCount
+        instructionPointers: (const uint64_t *) instructionPointers
+                symbolNames: (NSString * const *) symbolNames
+       symbolStartAddresses: (const uint64_t *) symbolStartAddresses
+         symbolEndAddresses: (const uint64_t *) symbolEndAddresses
+                    crashed: (BOOL) crashed
+              registerCount: (NSUInteger) registerCount
+              registerNames: (NSString * const *) registerNames
+             registerValues: (const uint64_t *) registerValues
+               frameRepeats: (NSArray *) frameRepeats
+          omittedFrameCount: (NSUInteger) omittedFrameCount
+          omittedFrameIndex: (NSUInteger) omittedFrameIndex
+   secondaryCrashSignalInfo: (PLCrashReportSignalInfo *) secondaryCrashSignalInfo
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel
+        registerSymbolNames: (NSString * const *) registerSymbolNames
+registerSymbolStartAddresses: (const uint64_t *) registerSymbolStartAddresses
 {
     if ((self = [super init]) == nil)
         return nil;
 
+    /* All value arrays share a single allocation, followed by the name arrays. The value arrays are placed first to
+     * preserve their alignment. */
+    size_t valueCount = frameCount * 3 + registerCount * 2;
+    size_t nameCount = frameCount + registerCount * 2;
+    uint8_t *storage = malloc(sizeof(uint64_t) * valueCount + sizeof(NSString *) * nameCount + 1);
+    if (storage == NULL) {
+        [self release];
+        return nil;
+    }
+
+    _frameCount = frameCount;
+    _instructionPointers = (uint64_t *) storage;
+    _symbolStartAddresses = _instructionPointers + frameCount;
+    _symbolEndAddresses = _symbolStartAddresses + frameCount;
+    _registerValues = _symbolEndAddresses + frameCount;
+    _symbolNames = (NSString **) (storage + sizeof(uint64_t) * valueCount);
+    _registerNames = _symbolNames + frameCount;
+    _registerSymbolStartAddresses = _registerValues + registerCount;
+    _registerSymbolNames = _registerNames + registerCount;
+    _registerCount = registerCount;
+
+    memcpy(_instructionPointers, instructionPointers, sizeof(uint64_t) * frameCount);
+    memcpy(_symbolStartAddresses, symbolStartAddresses, sizeof(uint64_t) * frameCount);
+    memcpy(_symbolEndAddresses, symbolEndAddresses, sizeof(uint64_t) * frameCount);
+    memcpy(_registerValues, registerValues, sizeof(uint64_t) * registerCount);
+
+    for (NSUInteger i = 0; i < frameCount; i++)
+        _symbolNames[i] = [symbolNames[i] retain];
+
+    for (NSUInteger i = 0; i < registerCount; i++)
+        _registerNames[i] = [registerNames[i] retain];
+
+    for (NSUInteger i = 0; i < registerCount; i++) {
+        _registerSymbolNames[i] = registerSymbolNames != NULL ? [registerSymbolNames[i] retain] : nil;
+        _registerSymbolStartAddresses[i] = registerSymbolStartAddresses != NULL ? registerSymbolStartAddresses[i] : 0;
+    }
+
     _threadNumber = threadNumber;
-    _stackFrames = [stackFrames retain];
     _crashed = crashed;
-    _registers = [registers retain];
+    _frameRepeats = [frameRepeats retain];
+    _omittedFrameCount = omittedFrameCount;
+    _omittedFrameIndex = omittedFrameIndex;
+    _secondaryCrashSignalInfo = [secondaryCrashSignalInfo retain];
+    _dispatchQueueLabel = [dispatchQueueLabel copy];
+
+    return self;
+}
+
+/**
+ * Initialize the crash log thread information for a thread whose stack was identical to that of @a thread. The
+ * receiver vends @a thread's frames, frame repeats and omitted frame information, and has no registers.
+ *
+ * @param threadNumber The thread number.
+ * @param crashed YES if this thread crashed.
+ * @param thread The thread whose stack was written in full.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                    crashed: (BOOL) crashed
+          stackOfThreadInfo: (PLCrashReportThreadInfo *) thread
+{
+    return [self initWithThreadNumber: threadNumber crashed: crashed dispatchQueueLabel: nil stackOfThreadInfo: thread];
+}
+
+/**
+ * Initialize the crash log thread information for a thread whose stack was identical to that of @a thread, and which
+ * was servicing the dispatch queue labeled @a dispatchQueueLabel.
+ *
+ * @param threadNumber The thread number.
+ * @param crashed YES if this thread crashed.
+ * @param dispatchQueueLabel The label of the dispatch queue the thread was servicing, or nil.
+ * @param thread The thread whose stack was written in full.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                    crashed: (BOOL) crashed
+         dispatchQueueLabel: (NSString *) dispatchQueueLabel
+          stackOfThreadInfo: (PLCrashReportThreadInfo *) thread
+{
+    self = [self initWithThreadNumber: threadNumber
+                           frameCount: thread->_frameCount
+                  instructionPointers: thread->_instructionPointers
+                          symbolNames: thread->_symbolNames
+                 symbolStartAddresses: thread->_symbolStartAddresses
+                   symbolEndAddresses: thread->_symbolEndAddresses
+                              crashed: crashed
+                        registerCount: 0
+                        registerNames: thread->_registerNames
+                       registerValues: thread->_registerValues
+                         frameRepeats: thread->_frameRepeats
+                    omittedFrameCount: thread->_omittedFrameCount
+                    omittedFrameIndex: thread->_omittedFrameIndex
+             secondaryCrashSignalInfo: nil
+                   dispatchQueueLabel: dispatchQueueLabel];
+    if (self == nil)
+        return nil;
+
+    /* Share the frame instances, if they've already been created */
+    @synchronized (thread) {
+        _stackFrames = [thread->_stackFrames retain];
+    }
 
     return self;
 }
 
 - (void) dealloc {
+    /* The storage is a single allocation based at _instructionPointers */
+    if (_instructionPointers != NULL) {
+        for (NSUInteger i = 0; i < _frameCount; i++)
+            [_symbolNames[i] release];
+
+        for (NSUInteger i = 0; i < _registerCount; i++) {
+            [_registerNames[i] release];
+            [_registerSymbolNames[i] release];
+        }
+
+        free(_instructionPointers);
+    }
+
     [_stackFrames release];
     [_registers release];
+    [_frameRepeats release];
+    [_secondaryCrashSignalInfo release];
+    [_dispatchQueueLabel release];
     [super dealloc];
 }
 
+/**
+ * Return the instruction pointer of the frame at @a frameIndex.
+ */
+- (uint64_t) instructionPointerAtIndex: (NSUInteger) frameIndex {
+    NSParameterAssert(frameIndex < _frameCount);
+    return _instructionPointers[frameIndex];
+}
+
+/**
+ * Return the symbol name of the frame at @a frameIndex, or nil if the frame has no symbol information.
+ */
+- (NSString *) symbolNameAtIndex: (NSUInteger) frameIndex {
+    NSParameterAssert(frameIndex < _frameCount);
+    return _symbolNames[frameIndex];
+}
+
+/**
+ * Return the symbol start address of the frame at @a frameIndex, or 0 if the frame has no symbol information.
+ */
+- (uint64_t) symbolStartAddressAtIndex: (NSUInteger) frameIndex {
+    NSParameterAssert(frameIndex < _frameCount);
+    return _symbolStartAddresses[frameIndex];
+}
+
+/**
+ * Return the name of the register at @a registerIndex.
+ */
+- (NSString *) registerNameAtIndex: (NSUInteger) registerIndex {
+    NSParameterAssert(registerIndex < _registerCount);
+    return _registerNames[registerIndex];
+}
+
+/**
+ * Return the value of the register at @a registerIndex.
+ */
+- (uint64_t) registerValueAtIndex: (NSUInteger) registerIndex {
+    NSParameterAssert(registerIndex < _registerCount);
+    return _registerValues[registerIndex];
+}
+
+/**
+ * Return the name of the symbol referenced by the value of the register at @a registerIndex, or nil if the register
+ * was not annotated with symbol information.
+ */
+- (NSString *) registerSymbolNameAtIndex: (NSUInteger) registerIndex {
+    NSParameterAssert(registerIndex < _registerCount);
+    return _registerSymbolNames[registerIndex];
+}
+
+// property getter
+- (const uint64_t *) instructionPointers {
+    return _instructionPointers;
+}
+
+// property getter
+- (const uint64_t *) registerValues {
+    return _registerValues;
+}
+
+// property getter. Creates the frame instances from the frame storage on first access.
+- (NSArray *) stackFrames {
+    @synchronized (self) {
+        if (_stackFrames != nil)
+            return _stackFrames;
+
+        NSMutableArray *frames = [[NSMutableArray alloc] initWithCapacity: _frameCount];
+        for (NSUInteger i = 0; i < _frameCount; i++) {
+            PLCrashReportSymbolInfo *symbolInfo = nil;
+            if (_symbolNames[i] != nil) {
+                symbolInfo = [[[PLCrashReportSymbolInfo alloc] initWithSymbolName: _symbolNames[i]
+                                                                     startAddress: _symbolStartAddresses[i]
+                                                                       endAddress: _symbolEndAddresses[i]] autorelease];
+            }
+
+            PLCrashReportStackFrameInfo *frameInfo = [[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: _instructionPointers[i]
+                                                                                                           symbolInfo: symbolInfo];
+            [frames addObject: frameInfo];
+            [frameInfo release];
+        }
+
+        _stackFrames = frames;
+        return _stackFrames;
+    }
+}
+
+// property getter. Creates the register instances from the register storage on first access.
+- (NSArray *) registers {
+    @synchronized (self) {
+        if (_registers != nil)
+            return _registers;
+
+        NSMutableArray *registers = [[NSMutableArray alloc] initWithCapacity: _registerCount];
+        for (NSUInteger i = 0; i < _registerCount; i++) {
+            PLCrashReportSymbolInfo *symbolInfo = nil;
+            if (_registerSymbolNames[i] != nil) {
+                symbolInfo = [[[PLCrashReportSymbolInfo alloc] initWithSymbolName: _registerSymbolNames[i]
+                                                                     startAddress: _registerSymbolStartAddresses[i]
+                                                                       endAddress: 0] autorelease];
+            }
+
+            PLCrashReportRegisterInfo *regInfo = [[PLCrashReportRegisterInfo alloc] initWithRegisterName: _registerNames[i]
+                                                                                         registerValue: _registerValues[i]
+                                                                                            symbolInfo: symbolInfo];
+            [registers addObject: regInfo];
+            [regInfo release];
+        }
+
+        _registers = registers;
+        return _registers;
+    }
+}
+
 @synthesize threadNumber = _threadNumber;
-@synthesize stackFrames = _stackFrames;
+@synthesize frameCount = _frameCount;
 @synthesize crashed = _crashed;
-@synthesize registers = _registers;
+@synthesize registerCount = _registerCount;
+@synthesize frameRepeats = _frameRepeats;
+@synthesize omittedFrameCount = _omittedFrameCount;
+@synthesize omittedFrameIndex = _omittedFrameIndex;
+@synthesize secondaryCrashSignalInfo = _secondaryCrashSignalInfo;
+@synthesize dispatchQueueLabel = _dispatchQueueLabel;
 
 
 @end
-
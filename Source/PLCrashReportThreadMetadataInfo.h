@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+@interface PLCrashReportThreadMetadataInfo : NSObject {
+@private
+    /** The thread number of the described thread. */
+    NSInteger _threadNumber;
+
+    /** The thread's total user time, in nanoseconds. */
+    uint64_t _userTime;
+
+    /** The thread's total system time, in nanoseconds. */
+    uint64_t _systemTime;
+
+    /** The thread's scaled CPU usage. */
+    uint32_t _cpuUsage;
+
+    /** The thread's scheduling policy. */
+    int32_t _schedulingPolicy;
+
+    /** The thread's run state. */
+    int32_t _runState;
+
+    /** The thread's flags. */
+    uint32_t _flags;
+
+    /** The number of seconds the thread has been sleeping. */
+    uint32_t _sleepTime;
+
+    /** The thread's current scheduled priority. */
+    int32_t _currentPriority;
+
+    /** The thread's base priority. */
+    int32_t _basePriority;
+
+    /** The thread's maximum priority. */
+    int32_t _maxPriority;
+}
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                   userTime: (uint64_t) userTime
+                 systemTime: (uint64_t) systemTime
+                   cpuUsage: (uint32_t) cpuUsage
+           schedulingPolicy: (int32_t) schedulingPolicy
+                   runState: (int32_t) runState
+                      flags: (uint32_t) flags
+                  sleepTime: (uint32_t) sleepTime
+            currentPriority: (int32_t) currentPriority
+               basePriority: (int32_t) basePriority
+                maxPriority: (int32_t) maxPriority;
+
+/**
+ * The thread number of the described thread, matching PLCrashReportThreadInfo::threadNumber.
+ */
+@property(nonatomic, readonly) NSInteger threadNumber;
+
+/**
+ * The total user time consumed by the thread, in nanoseconds.
+ */
+@property(nonatomic, readonly) uint64_t userTime;
+
+/**
+ * The total system time consumed by the thread, in nanoseconds.
+ */
+@property(nonatomic, readonly) uint64_t systemTime;
+
+/**
+ * The total CPU time consumed by the thread, in nanoseconds.
+ */
+@property(nonatomic, readonly) uint64_t totalTime;
+
+/**
+ * The thread's recent CPU usage, scaled by TH_USAGE_SCALE (1000 == 100%).
+ */
+@property(nonatomic, readonly) uint32_t cpuUsage;
+
+/**
+ * The thread's scheduling policy (POLICY_TIMESHARE, POLICY_RR, or POLICY_FIFO).
+ */
+@property(nonatomic, readonly) int32_t schedulingPolicy;
+
+/**
+ * The thread's run state (TH_STATE_RUNNING, TH_STATE_WAITING, etc).
+ */
+@property(nonatomic, readonly) int32_t runState;
+
+/**
+ * The thread's flags (TH_FLAGS_SWAPPED, TH_FLAGS_IDLE, etc).
+ */
+@property(nonatomic, readonly) uint32_t flags;
+
+/**
+ * The number of seconds that the thread has been sleeping.
+ */
+@property(nonatomic, readonly) uint32_t sleepTime;
+
+/**
+ * The thread's current scheduled priority, or 0 if unavailable.
+ */
+@property(nonatomic, readonly) int32_t currentPriority;
+
+/**
+ * The thread's base priority, or 0 if unavailable.
+ */
+@property(nonatomic, readonly) int32_t basePriority;
+
+/**
+ * The thread's maximum priority, or 0 if unavailable.
+ */
+@property(nonatomic, readonly) int32_t maxPriority;
+
+@end
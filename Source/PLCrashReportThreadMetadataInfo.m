@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashReportThreadMetadataInfo.h"
+
+/**
+ * Crash log thread metadata.
+ *
+ * Describes a thread's CPU usage and scheduling state, as captured immediately after the process' threads were
+ * suspended. This may be used to determine which threads were consuming CPU -- or were blocked -- at the time the
+ * report was written.
+ */
+@implementation PLCrashReportThreadMetadataInfo
+
+/**
+ * Initialize with the provided thread metadata.
+ *
+ * @param threadNumber The thread number of the described thread.
+ * @param userTime The thread's total user time, in nanoseconds.
+ * @param systemTime The thread's total system time, in nanoseconds.
+ * @param cpuUsage The thread's CPU usage, scaled by TH_USAGE_SCALE.
+ * @param schedulingPolicy The thread's scheduling policy.
+ * @param runState The thread's run state.
+ * @param flags The thread's flags.
+ * @param sleepTime The number of seconds the thread has been sleeping.
+ * @param currentPriority The thread's current scheduled priority.
+ * @param basePriority The thread's base priority.
+ * @param maxPriority The thread's maximum priority.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                   userTime: (uint64_t) userTime
+                 systemTime: (uint64_t) systemTime
+                   cpuUsage: (uint32_t) cpuUsage
+           schedulingPolicy: (int32_t) schedulingPolicy
+                   runState: (int32_t) runState
+                      flags: (uint32_t) flags
+                  sleepTime: (uint32_t) sleepTime
+            currentPriority: (int32_t) currentPriority
+               basePriority: (int32_t) basePriority
+                maxPriority: (int32_t) maxPriority
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _threadNumber = threadNumber;
+    _userTime = userTime;
+    _systemTime = systemTime;
+    _cpuUsage = cpuUsage;
+    _schedulingPolicy = schedulingPolicy;
+    _runState = runState;
+    _flags = flags;
+    _sleepTime = sleepTime;
+    _currentPriority = currentPriority;
+    _basePriority = basePriority;
+    _maxPriority = maxPriority;
+
+    return self;
+}
+
+- (uint64_t) totalTime {
+    return _userTime + _systemTime;
+}
+
+@synthesize threadNumber = _threadNumber;
+@synthesize userTime = _userTime;
+@synthesize systemTime = _systemTime;
+@synthesize cpuUsage = _cpuUsage;
+@synthesize schedulingPolicy = _schedulingPolicy;
+@synthesize runState = _runState;
+@synthesize flags = _flags;
+@synthesize sleepTime = _sleepTime;
+@synthesize currentPriority = _currentPriority;
+@synthesize basePriority = _basePriority;
+@synthesize maxPriority = _maxPriority;
+
+@end
@@ -32,6 +32,8 @@
 #import "PLCrashReporterConfig.h"
 #import "PLCrashMacros.h"
 
+@class PLCrashReport;
+
 @class PLCrashMachExceptionServer;
 @class PLCrashMachExceptionPortSet;
 
@@ -81,6 +83,33 @@ typedef struct PLCrashReporterCallbacks {
     PLCrashReporterPostCrashSignalCallback handleSignal;
 } PLCrashReporterCallbacks;
 
+/**
+ * @ingroup enums
+ * Steps performed when processing a pending crash report via
+ * PLCrashReporter::processPendingCrashReportWithOptions:completionHandler:.
+ */
+typedef NS_OPTIONS(NSUInteger, PLCrashReporterProcessingOptions) {
+    /** Only load the pending crash report. */
+    PLCrashReporterProcessingOptionNone = 0,
+
+    /** Symbolicate the pending report in place prior to loading it; see
+     * PLCrashReporter::symbolicatePendingCrashReportAndReturnError:. */
+    PLCrashReporterProcessingOptionSymbolicate = 1 << 0,
+
+    /** Format the report as text, using PLCrashReportTextFormatiOS. */
+    PLCrashReporterProcessingOptionFormat = 1 << 1,
+
+    /** Move the pending report to the queue of reports awaiting submission once it has been loaded; see
+     * PLCrashReporter::queuePendingCrashReportAndReturnError:. */
+    PLCrashReporterProcessingOptionQueue = 1 << 2,
+
+    /** Purge the pending report once it has been loaded. Ignored if PLCrashReporterProcessingOptionQueue is set. */
+    PLCrashReporterProcessingOptionPurge = 1 << 3
+};
+
+/** @internal Opaque live report sampler state. */
+typedef struct plcr_live_report_sampler plcr_live_report_sampler_t;
+
 @interface PLCrashReporter : NSObject {
 @private
     /** Reporter configuration */
@@ -109,6 +138,15 @@ typedef struct PLCrashReporterCallbacks {
 
     /** Path to the crash reporter internal data directory */
     NSString *_crashReportDirectory;
+
+    /** State reused across live reports, or NULL if no live report has been generated. */
+    plcr_live_report_sampler_t *_liveReportSampler;
+
+    /** Idle samplers used to write live reports concurrently with _liveReportSampler, or NULL. */
+    plcr_live_report_sampler_t *_idleLiveReportSamplers;
+
+    /** The breadcrumb ring, or NULL if breadcrumbs are disabled or the reporter has not been enabled. */
+    struct plcrash_async_breadcrumbs * volatile _breadcrumbs;
 }
 
 + (PLCrashReporter *) sharedReporter PLCR_DEPRECATED;
@@ -116,23 +154,58 @@ typedef struct PLCrashReporterCallbacks {
 - (instancetype) initWithConfiguration: (PLCrashReporterConfig *) config;
 
 - (BOOL) hasPendingCrashReport;
+- (void) hasPendingCrashReportWithCompletionHandler: (void (^)(BOOL hasPendingReport)) handler;
+
+- (NSUInteger) launchCrashCount;
 
 - (NSData *) loadPendingCrashReportData;
 - (NSData *) loadPendingCrashReportDataAndReturnError: (NSError **) outError;
+- (PLCrashReport *) loadPendingCrashReportAndReturnError: (NSError **) outError;
 
 - (NSData *) generateLiveReportWithThread: (thread_t) thread;
 - (NSData *) generateLiveReportWithThread: (thread_t) thread error: (NSError **) outError;
 - (NSData *) generateLiveReportWithThread: (thread_t) thread exception: (NSException *) exception error: (NSError **) outError;
+- (NSData *) generateLiveReportWithThread: (thread_t) thread threadFilter: (BOOL (^)(thread_t thread)) filter error: (NSError **) outError;
+- (NSData *) generateLiveReportWithThread: (thread_t) thread exception: (NSException *) exception threadFilter: (BOOL (^)(thread_t thread)) filter error: (NSError **) outError;
 
 - (NSData *) generateLiveReport;
 - (NSData *) generateLiveReportAndReturnError: (NSError **) outError;
 - (NSData *) generateLiveReportWithException: (NSException *) exception error: (NSError **) outError;
 
+- (NSData *) generateLiveTraceSampleAndReturnError: (NSError **) outError;
+- (void) resetLiveTrace;
+
+- (BOOL) resolveSharedImageListForReport: (PLCrashReport *) report error: (NSError **) outError;
+- (BOOL) purgeSharedImageListsAndReturnError: (NSError **) outError;
+
 - (BOOL) purgePendingCrashReport;
 - (BOOL) purgePendingCrashReportAndReturnError: (NSError **) outError;
 
+- (BOOL) symbolicatePendingCrashReportAndReturnError: (NSError **) outError;
+- (void) symbolicatePendingCrashReportWithCompletionHandler: (void (^)(BOOL success, NSError *error)) handler;
+
+- (BOOL) queuePendingCrashReportAndReturnError: (NSError **) outError;
+- (BOOL) queueSharedCrashReportsAndReturnError: (NSError **) outError;
+
+- (void) processPendingCrashReportWithOptions: (PLCrashReporterProcessingOptions) options
+                            completionHandler: (void (^)(PLCrashReport *report, NSString *text, NSError *error)) handler;
+- (NSEnumerator *) queuedCrashReportEnumerator;
+- (NSData *) queuedCrashReportBundleCompressingReports: (BOOL) compress error: (NSError **) outError;
+- (BOOL) purgeQueuedCrashReportsAndReturnError: (NSError **) outError;
+
+- (NSUInteger) duplicateCrashCountForReport: (PLCrashReport *) report;
+- (BOOL) purgeDuplicateCrashOccurrencesAndReturnError: (NSError **) outError;
+
 - (BOOL) enableCrashReporter;
 - (BOOL) enableCrashReporterAndReturnError: (NSError **) outError;
+- (BOOL) enableCrashReporterWithDeferredSetupAndReturnError: (NSError **) outError;
+
+- (void) appendBreadcrumb: (NSString *) message;
+- (NSArray *) loadPreviousSessionBreadcrumbsAndReturnError: (NSError **) outError;
+
+- (BOOL) registerAttachmentNamed: (NSString *) name address: (const void *) address length: (NSUInteger) length error: (NSError **) outError;
+- (BOOL) registerAttachmentNamed: (NSString *) name path: (NSString *) path offset: (off_t) offset length: (NSUInteger) length error: (NSError **) outError;
+- (BOOL) unregisterAttachmentNamed: (NSString *) name;
 
 - (void) setCrashCallbacks: (PLCrashReporterCallbacks *) callbacks;
 
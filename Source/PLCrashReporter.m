@@ -37,16 +37,25 @@
 #import "PLCrashFeatureConfig.h"
 
 #import "PLCrashAsync.h"
+#import "PLCrashAsyncCompressor.h"
 #import "PLCrashLogWriter.h"
 #import "PLCrashFrameWalker.h"
 
 #import "PLCrashAsyncMachExceptionInfo.h"
 
 #import "PLCrashReporterNSError.h"
+#import "PLCrashReportSymbolicator.h"
+#import "PLCrashQueuedReportIndex.h"
+#import "PLCrashAsyncReportSlots.h"
+#import "PLCrashScheduler.h"
 
 #import <libkern/OSAtomic.h>
+#import <objc/runtime.h>
 
 #import <fcntl.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <mach/mach_time.h>
 
 #define NSDEBUG(msg, args...) {\
     NSLog(@"[PLCrashReporter] " msg, ## args); \
@@ -60,10 +69,79 @@ static NSString *PLCRASH_CACHE_DIR = @"com.plausiblelabs.crashreporter.data";
  * Crash Report file name. */
 static NSString *PLCRASH_LIVE_CRASHREPORT = @"live_report.plcrash";
 
+/** @internal
+ * Pre-sized, memory-mapped crash report file name. The file is renamed to PLCRASH_LIVE_CRASHREPORT
+ * once a report has been written. */
+static NSString *PLCRASH_MAPPED_CRASHREPORT = @"mapped_report.plcrash";
+
 /** @internal
  * Directory containing crash reports queued for sending. */
 static NSString *PLCRASH_QUEUED_DIR = @"queued_reports";
 
+/** @internal
+ * File extension used for queued crash reports. */
+static NSString *PLCRASH_QUEUED_REPORT_EXTENSION = @"plcrash";
+
+/** @internal
+ * Queued report index file name, within PLCRASH_QUEUED_DIR (see PLCrashQueuedReportIndex.h). */
+static NSString *PLCRASH_QUEUED_INDEX = @"queue_index";
+
+/** @internal
+ * Duplicate crash occurrence log file name, within PLCRASH_QUEUED_DIR (see
+ * PLCrashReporterConfig::shouldSuppressDuplicateCrashes). */
+static NSString *PLCRASH_QUEUED_OCCURRENCES = @"occurrences";
+
+/** @internal
+ * Memory-mapped breadcrumb ring file name. */
+static NSString *PLCRASH_BREADCRUMBS = @"breadcrumbs.plcrash";
+
+/** @internal
+ * The previous session's breadcrumb ring; PLCRASH_BREADCRUMBS is moved here when the crash reporter is enabled. */
+static NSString *PLCRASH_PREVIOUS_BREADCRUMBS = @"previous_breadcrumbs.plcrash";
+
+/** @internal
+ * Directory containing the cached image indexes (see PLCrashReporterConfig::shouldCacheImageIndexes). */
+static NSString *PLCRASH_IMAGE_INDEX_CACHE_DIR = @"image_indexes";
+
+/** @internal
+ * Directory containing the shared live report image lists (see PLCrashReporterConfig::shouldShareLiveReportImageLists). */
+static NSString *PLCRASH_IMAGE_LIST_DIR = @"image_lists";
+
+/** @internal
+ * Persisted crash loop state file name (see PLCrashReporterConfig::crashLoopThreshold). */
+static NSString *PLCRASH_CRASH_LOOP_STATE = @"crash_loop_state";
+
+/** @internal
+ * Temporary file to which the crash loop state is written prior to being renamed over PLCRASH_CRASH_LOOP_STATE. */
+static NSString *PLCRASH_CRASH_LOOP_STATE_TMP = @"crash_loop_state.tmp";
+
+/** @internal
+ * Persisted crash memory sizing samples file name (see PLCrashReporterConfig::shouldAdaptCrashMemorySizing). */
+static NSString *PLCRASH_MEMORY_SIZING_STATE = @"memory_sizing";
+
+/** @internal
+ * Temporary file to which the crash handler writes the memory sizing samples prior to renaming them over
+ * PLCRASH_MEMORY_SIZING_STATE. */
+static NSString *PLCRASH_MEMORY_SIZING_STATE_TMP = @"memory_sizing.tmp";
+
+/** @internal
+ * Temporary file to which live reports write the memory sizing samples; this is distinct from
+ * PLCRASH_MEMORY_SIZING_STATE_TMP, as a crash may occur while a live report's samples are being written. */
+static NSString *PLCRASH_MEMORY_SIZING_STATE_LIVE_TMP = @"memory_sizing.live.tmp";
+
+/** @internal
+ * Shared report slot file name, created beneath PLCRASH_CACHE_DIR within the shared report container (see
+ * PLCrashReporterConfig::sharedReportContainerPath). */
+static NSString *PLCRASH_SHARED_REPORT_SLOTS = @"shared_report_slots";
+
+/** @internal
+ * Temporary file to which a shared slot's report is copied prior to being queued. */
+static NSString *PLCRASH_SHARED_REPORT_TMP = @"shared_report.tmp";
+
+/** @internal
+ * The number of slots created in a new shared report slot file. */
+#define SHARED_REPORT_SLOT_COUNT 8
+
 /** @internal
  * Maximum number of bytes that will be written to the crash report.
  * Used as a safety measure in case of implementation malfunction.
@@ -75,6 +153,137 @@ static NSString *PLCRASH_QUEUED_DIR = @"queued_reports";
  */
 #define MAX_REPORT_BYTES (256 * 1024)
 
+/**
+ * @internal
+ * Maximum number of bytes that will be written to a shared image list file. A typical image record requires fewer than
+ * 200 bytes.
+ */
+#define MAX_IMAGE_LIST_BYTES (1024 * 1024)
+
+/**
+ * @internal
+ * Maximum number of threads tracked by a live trace; additional threads are counted, but omitted from each sample.
+ */
+#define MAX_TRACE_THREADS 256
+
+/**
+ * @internal
+ * Maximum number of worker threads used to unwind thread stacks when generating a live report. The
+ * actual number of workers is further limited by the number of logical processors.
+ */
+#define MAX_LIVE_REPORT_UNWIND_WORKERS 4
+
+/**
+ * @internal
+ * Maximum number of idle samplers retained for live reports written concurrently with another live report. Further
+ * samplers are freed once their report has been written.
+ */
+#define MAX_IDLE_LIVE_REPORT_SAMPLERS 2
+
+/**
+ * @internal
+ * Number of bytes of each thread's stack copied when generating a live report, if enabled via
+ * PLCrashReporterConfig::shouldSnapshotLiveReportStacks. Threads are resumed once their stacks have been copied,
+ * rather than remaining suspended for the duration of the report's generation.
+ */
+#define LIVE_REPORT_STACK_SNAPSHOT_BYTES (64 * 1024)
+
+/**
+ * @internal
+ * Number of spare page regions pre-allocated for the crash-time writer's allocator when enabling the crash reporter,
+ * allowing the allocator to grow without calling vm_allocate() from within the crash handler.
+ */
+#define CRASH_ALLOCATOR_RESERVE_REGIONS 2
+
+/**
+ * @internal
+ * Size of a single breadcrumb ring entry, in bytes, including the entry's 24-byte header.
+ */
+#define BREADCRUMB_ENTRY_BYTES 256
+
+/**
+ * @internal
+ * Number of bytes of memory captured around each register value that references readable memory, when memory
+ * capture is enabled.
+ */
+#define MEMORY_CAPTURE_REGISTER_BYTES 256
+
+/**
+ * @internal
+ * Number of seconds after the crash reporter is enabled during which a crash is considered a launch crash. A launch
+ * that survives this interval resets the persisted launch crash count.
+ */
+#define CRASH_LOOP_LAUNCH_INTERVAL 10.0
+
+/** @internal
+ * Magic value identifying a valid plcrash_crash_loop_state_t record. */
+#define CRASH_LOOP_STATE_MAGIC 0x706c636cU /* 'plcl' */
+
+/**
+ * @internal
+ * The persisted crash loop state.
+ */
+typedef struct plcrash_crash_loop_state {
+    /** CRASH_LOOP_STATE_MAGIC */
+    uint32_t magic;
+
+    /** The number of consecutive launches that terminated in a launch crash. */
+    uint32_t launch_crash_count;
+
+    /** The stack hash of the most recent launch crash, or 0 if unavailable. */
+    uint64_t stack_hash;
+} plcrash_crash_loop_state_t;
+
+/**
+ * @internal
+ * The sorted, unique, non-zero stack hashes of the queued reports, consulted by the crash handler to suppress duplicate
+ * crashes (see PLCrashReporterConfig::shouldSuppressDuplicateCrashes).
+ */
+typedef struct plcrash_queued_stack_hashes {
+    /** The number of hashes. */
+    size_t count;
+
+    /** The hashes, in ascending order. */
+    uint64_t hashes[];
+} plcrash_queued_stack_hashes_t;
+
+/** @internal
+ * Magic value identifying a valid plcrash_memory_sizing_state_t record. */
+#define MEMORY_SIZING_STATE_MAGIC 0x706c6d73U /* 'plms' */
+
+/**
+ * @internal
+ * Number of reports for which memory sizing samples are retained; older samples are replaced by newer samples.
+ */
+#define MEMORY_SIZING_SAMPLES 32
+
+/**
+ * @internal
+ * Headroom, as a fraction of the observed 99th percentile, added when sizing the crash-time arena and class cache.
+ */
+#define MEMORY_SIZING_HEADROOM 0.25
+
+/**
+ * @internal
+ * The persisted crash memory sizing samples.
+ */
+typedef struct plcrash_memory_sizing_state {
+    /** MEMORY_SIZING_STATE_MAGIC */
+    uint32_t magic;
+
+    /** The number of valid samples, up to MEMORY_SIZING_SAMPLES. */
+    uint32_t count;
+
+    /** The index at which the next sample will be written. */
+    uint32_t next;
+
+    /** The high-water mark of each report's writer arena, in bytes. */
+    uint32_t arena_bytes[MEMORY_SIZING_SAMPLES];
+
+    /** The number of Objective-C class cache entries used by each report. */
+    uint32_t objc_class_count[MEMORY_SIZING_SAMPLES];
+} plcrash_memory_sizing_state_t;
+
 /**
  * @internal
  * Fatal signals to be monitored.
@@ -109,6 +318,86 @@ typedef struct signal_handler_ctx {
     /** Dynamic loader instance */
     plcrash_async_dynloader_t *dynamic_loader;
 
+    /** Pre-allocated report write buffer, or NULL to use the plcrash_async_file_t default buffer. */
+    void *write_buffer;
+
+    /** The size of write_buffer, in bytes. */
+    size_t write_buffer_size;
+
+    /** Path to the pre-sized report file backing mapped_report, or NULL if unavailable. */
+    const char *mapped_path;
+
+    /** Open file descriptor for mapped_path. */
+    int mapped_fd;
+
+    /** A MAP_SHARED mapping of MAX_REPORT_BYTES of mapped_fd, or NULL if the mapped writer is unavailable. */
+    void *mapped_report;
+
+    /** The shared report slots to which reports are preferentially written, or NULL if shared report slots are
+     * disabled or unavailable. */
+    plcrash_async_report_slots_t *report_slots;
+
+    /** Pre-allocated report compressor, or NULL if reports should be written uncompressed. */
+    plcrash_async_compressor_t *compressor;
+
+    /** If true, a CRC-32C checksum trailer is appended to the written report. */
+    bool checksum;
+
+    /** The number of bytes of storage to preallocate when opening the output file from the crash handler, or 0. */
+    off_t preallocation_size;
+
+    /** The policy used to flush the written report to stable storage. */
+    plcrash_async_file_sync_t sync_policy;
+
+    /** The number of consecutive launch crashes at which crash loop reporting is enabled, or 0 if crash loop
+     * detection is disabled. */
+    uint32_t crash_loop_threshold;
+
+    /** Path to the persisted crash loop state, or NULL if crash loop detection is disabled. */
+    const char *crash_loop_path;
+
+    /** Path to the temporary file used to atomically replace crash_loop_path. */
+    const char *crash_loop_tmp_path;
+
+    /** The mach_absolute_time() prior to which a crash is considered a launch crash. */
+    uint64_t launch_deadline;
+
+    /** The crash loop state read at launch. */
+    plcrash_crash_loop_state_t crash_loop_state;
+
+    /** Path to the duplicate crash occurrence log, or NULL if duplicate crash suppression is disabled. */
+    const char *occurrence_path;
+
+    /** The stack hashes of the queued reports, or NULL if duplicate crash suppression is disabled. The table is
+     * replaced atomically as reports are queued; replaced tables are never freed, as they may be in use by the crash
+     * handler. */
+    plcrash_queued_stack_hashes_t * volatile queued_stack_hashes;
+
+    /** Path to the persisted memory sizing samples, or NULL if adaptive memory sizing is disabled. */
+    const char *memory_sizing_path;
+
+    /** Path to the temporary file used by the crash handler to atomically replace memory_sizing_path. */
+    const char *memory_sizing_tmp_path;
+
+    /** Path to the temporary file used by live reports to atomically replace memory_sizing_path. */
+    const char *memory_sizing_live_tmp_path;
+
+    /** The memory sizing samples read at launch, updated as each report is written. Live report updates are
+     * serialized via memory_sizing_lock. */
+    plcrash_memory_sizing_state_t memory_sizing_state;
+
+    /** The initial size of the writer arena derived from memory_sizing_state at launch, or 0 if no samples were
+     * available. */
+    size_t sized_arena_bytes;
+
+    /** The standby class cache capacity derived from memory_sizing_state at launch, or 0 if no samples were
+     * available. */
+    size_t sized_class_capacity;
+
+    /** The buffer to which debug output is written while writing a report. Only initialized if enabled by the
+     * reporter's configuration. */
+    plcrash_async_debug_log_t debug_log;
+
 #if PLCRASH_FEATURE_MACH_EXCEPTIONS
     /* Previously registered Mach exception ports, if any. Will be left uninitialized if PLCrashReporterSignalHandlerTypeMach
      * is not enabled. */
@@ -123,6 +412,88 @@ typedef struct signal_handler_ctx {
  */
 static plcrashreporter_handler_ctx_t signal_handler_context;
 
+/**
+ * @internal
+ *
+ * The thread elected to write the fatal crash report, or MACH_PORT_NULL if no fatal crash has occured. See
+ * plcrash_crash_elect().
+ */
+static volatile int32_t crash_reporter_thread = MACH_PORT_NULL;
+
+/**
+ * @internal
+ *
+ * Set once the elected thread has written its report and restored the default signal handlers.
+ */
+static volatile bool crash_report_finished = false;
+
+/**
+ * @internal
+ *
+ * Threads that crashed while the elected thread's report was being written.
+ */
+static plcrash_log_secondary_crashes_t secondary_crashes;
+
+/**
+ * @internal
+ *
+ * Registered report attachments, written by the crash handler and live reports. Modifications are serialized via
+ * attachments_lock.
+ */
+static plcrash_log_attachments_t attachments;
+
+/**
+ * @internal
+ *
+ * A file mapping owned by a registered attachment. See -[PLCrashReporter registerAttachmentNamed:path:offset:length:error:].
+ */
+typedef struct plcr_attachment_mapping {
+    /** The name of the owning attachment, or an empty string if unused. */
+    char name[PLCRASH_LOG_ATTACHMENT_NAME_MAX];
+
+    /** The page-aligned base address of the mapping. */
+    void *base;
+
+    /** The size of the mapping, in bytes. */
+    size_t size;
+} plcr_attachment_mapping_t;
+
+/** @internal File mappings owned by registered attachments. Protected by attachments_lock. */
+static plcr_attachment_mapping_t attachment_mappings[PLCRASH_LOG_MAX_ATTACHMENTS];
+
+/** @internal Serializes modifications of attachments and attachment_mappings. */
+static pthread_mutex_t attachments_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @internal
+ *
+ * Return the current process' shared cache info, locating the shared cache on first call. The info is never
+ * freed, and may be used from crash handlers once returned.
+ *
+ * @return Returns the shared cache info, or NULL if the shared cache's local symbols are not available.
+ */
+static const plcrash_async_shared_cache_info_t *plcr_shared_cache_info (void) {
+    static plcrash_async_shared_cache_info_t info;
+    static bool initialized = false;
+    static bool found = false;
+
+    /* Once we drop 10.5 support, this may be converted to dispatch_once() */
+    static OSSpinLock onceLock = OS_SPINLOCK_INIT;
+    OSSpinLockLock(&onceLock); {
+        if (!initialized) {
+            plcrash_error_t err = plcrash_nasync_shared_cache_info_init(&info);
+            if (err == PLCRASH_ESUCCESS)
+                found = true;
+            else if (err != PLCRASH_ENOTFOUND)
+                NSDEBUG("Could not locate the shared cache local symbols: %d", err);
+
+            initialized = true;
+        }
+    } OSSpinLockUnlock(&onceLock);
+
+    return found ? &info : NULL;
+}
+
 
 /**
  * @internal
@@ -136,666 +507,2957 @@ static PLCrashReporterCallbacks crashCallbacks = {
 };
 
 /**
- * Write a fatal crash report.
+ * @internal
  *
- * @param sigctx Fatal handler context.
- * @param crashed_thread The crashed thread.
- * @param thread_state The crashed thread's state.
- * @param siginfo The signal information.
+ * Create all missing parent directories of @a path. This function is async-safe.
  *
- * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error value if the report could not be written.
+ * @param path The absolute path whose parent directories should be created.
+ *
+ * @return Returns true if all parent directories exist on return, or false on error.
  */
-static plcrash_error_t plcrash_write_report (plcrashreporter_handler_ctx_t *sigctx, thread_t crashed_thread, plcrash_async_thread_state_t *thread_state, plcrash_log_signal_info_t *siginfo) {
-    plcrash_async_file_t file;
-    plcrash_error_t err;
+static bool plcrash_create_parent_directories (const char *path) {
+    char buffer[PATH_MAX];
+    size_t len = strlen(path);
 
-    /* Open the output file */
-    int fd = open(sigctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
-    if (fd < 0) {
-        PLCF_DEBUG("Could not open the crashlog output file: %s", strerror(errno));
-        return PLCRASH_EINTERNAL;
-    }
-    
-    /* Initialize the output context */
-    plcrash_async_file_init(&file, fd, MAX_REPORT_BYTES);
-    
-    /* Write the crash log using the already-initialized writer */
-    err = plcrash_log_writer_write(&sigctx->writer, crashed_thread, sigctx->dynamic_loader, &file, siginfo, thread_state);
+    if (len >= sizeof(buffer))
+        return false;
+    memcpy(buffer, path, len + 1);
 
-    /* Close the writer; this may also fail (but shouldn't) */
-    if (plcrash_log_writer_close(&sigctx->writer) != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Failed to close the log writer");
-        plcrash_async_file_close(&file);
-        return PLCRASH_EINTERNAL;
-    }
-    
-    /* Finished */
-    if (!plcrash_async_file_flush(&file)) {
-        PLCF_DEBUG("Failed to flush output file");
-        plcrash_async_file_close(&file);
-        return PLCRASH_EINTERNAL;
-    }
-    
-    if (!plcrash_async_file_close(&file)) {
-        PLCF_DEBUG("Failed to close output file");
-        return PLCRASH_EINTERNAL;
+    /* Create each intermediate component in turn; the final component is the file itself. */
+    for (char *p = buffer + 1; *p != '\0'; p++) {
+        if (*p != '/')
+            continue;
+
+        *p = '\0';
+        if (mkdir(buffer, 0755) != 0 && errno != EEXIST) {
+            PLCF_DEBUG("Could not create the crash report directory: %s", strerror(errno));
+            return false;
+        }
+        *p = '/';
     }
 
-    return err;
+    return true;
 }
 
 /**
  * @internal
  *
- * Signal handler callback.
+ * Read the persisted crash loop state from @a path. If the file does not exist or is invalid, @a state is reset to
+ * a zero launch crash count.
+ *
+ * @param path The crash loop state path.
+ * @param state The state to be populated.
  */
-static bool signal_handler_callback (int signal, siginfo_t *info, pl_ucontext_t *uap, void *context, PLCrashSignalHandlerCallback *next) {
-    plcrashreporter_handler_ctx_t *sigctx = context;
-    plcrash_async_thread_state_t thread_state;
-    plcrash_log_signal_info_t signal_info;
-    plcrash_log_bsd_signal_info_t bsd_signal_info;
-    
-    /* Remove all signal handlers -- if the crash reporting code fails, the default terminate
-     * action will occur.
-     *
-     * NOTE: SA_RESETHAND breaks SA_SIGINFO on ARM, so we reset the handlers manually.
-     * http://openradar.appspot.com/11839803
-     *
-     * TODO: When forwarding signals (eg, to Mono's runtime), resetting the signal handlers
-     * could result in incorrect runtime behavior; we should revisit resetting the
-     * signal handlers once we address double-fault handling.
-     */
-    for (int i = 0; i < monitored_signals_count; i++) {
-        struct sigaction sa;
-        
-        memset(&sa, 0, sizeof(sa));
-        sa.sa_handler = SIG_DFL;
-        sigemptyset(&sa.sa_mask);
-        
-        sigaction(monitored_signals[i], &sa, NULL);
-    }
+static void plcrash_crash_loop_read_state (const char *path, plcrash_crash_loop_state_t *state) {
+    plcrash_crash_loop_state_t result;
 
-    /* Extract the thread state */
-    // XXX_ARM64 rdar://14970271 -- In the Xcode 5 GM SDK, _STRUCT_MCONTEXT is not correctly
-    // defined as _STRUCT_MCONTEXT64 when building for arm64; this requires the pl_mcontext_t
-    // cast.
-    plcrash_async_thread_state_mcontext_init(&thread_state, (pl_mcontext_t *) uap->uc_mcontext);
-    
-    /* Set up the BSD signal info */
-    bsd_signal_info.signo = info->si_signo;
-    bsd_signal_info.code = info->si_code;
-    bsd_signal_info.address = info->si_addr;
-    
-    signal_info.bsd_info = &bsd_signal_info;
-    signal_info.mach_info = NULL;
+    memset(state, 0, sizeof(*state));
+    state->magic = CRASH_LOOP_STATE_MAGIC;
 
-    /* Write the report */
-    if (plcrash_write_report(sigctx, pl_mach_thread_self(), &thread_state, &signal_info) != PLCRASH_ESUCCESS)
-        return false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
 
-    /* Call any post-crash callback */
-    if (crashCallbacks.handleSignal != NULL)
-        crashCallbacks.handleSignal(info, uap, crashCallbacks.context);
-    
-    return false;
-}
+    if (read(fd, &result, sizeof(result)) == sizeof(result) && result.magic == CRASH_LOOP_STATE_MAGIC)
+        *state = result;
 
-#if PLCRASH_FEATURE_MACH_EXCEPTIONS
-/* State and callback used to generate thread state for the calling mach thread. */
-struct mach_exception_callback_live_cb_ctx {
-    plcrashreporter_handler_ctx_t *sigctx;
-    thread_t crashed_thread;
-    plcrash_log_signal_info_t *siginfo;
-};
+    close(fd);
+}
 
-static plcrash_error_t mach_exception_callback_live_cb (plcrash_async_thread_state_t *state, void *ctx) {
-    struct mach_exception_callback_live_cb_ctx *plcr_ctx = ctx;
-    return plcrash_write_report(plcr_ctx->sigctx, plcr_ctx->crashed_thread, state, plcr_ctx->siginfo);
-}
-
-static kern_return_t mach_exception_callback (task_t task, thread_t thread, exception_type_t exception_type, mach_exception_data_t code, mach_msg_type_number_t code_count, void *context) {
-    plcrashreporter_handler_ctx_t *sigctx = context;
-    plcrash_log_signal_info_t signal_info;
-    plcrash_log_bsd_signal_info_t bsd_signal_info;
-    plcrash_log_mach_signal_info_t mach_signal_info;
-    plcrash_error_t err;
-
-    /* Let any other registered server attempt to handle the exception */
-    if (PLCrashMachExceptionForward(task, thread, exception_type, code, code_count, &sigctx->port_set) == KERN_SUCCESS)
-        return KERN_SUCCESS;
-    
-    /* Set up the BSD signal info */
-    siginfo_t si;
-    if (!plcrash_async_mach_exception_get_siginfo(exception_type, code, code_count, CPU_TYPE_ANY, &si)) {
-        PLCF_DEBUG("Unexpected error mapping Mach exception to a POSIX signal");
-        return KERN_FAILURE;
-    }
-
-    bsd_signal_info.signo = si.si_signo;
-    bsd_signal_info.code = si.si_code;
-    bsd_signal_info.address = si.si_addr;
+/**
+ * @internal
+ *
+ * Atomically replace the persisted crash loop state at @a path with @a state, writing the new state to @a tmp_path
+ * and renaming it into place. This function is async-safe.
+ *
+ * @param path The crash loop state path.
+ * @param tmp_path The temporary path to which the state will be written prior to being renamed to @a path.
+ * @param state The state to be written.
+ *
+ * @return Returns true on success, or false if the state could not be written.
+ */
+static bool plcrash_crash_loop_write_state (const char *path, const char *tmp_path, const plcrash_crash_loop_state_t *state) {
+    int fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0 && errno == ENOENT && plcrash_create_parent_directories(tmp_path))
+        fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
 
-    signal_info.bsd_info = &bsd_signal_info;
-    
-    /* Set up the Mach signal info */
-    mach_signal_info.type = exception_type;
-    mach_signal_info.code = code;
-    mach_signal_info.code_count = code_count;
-    signal_info.mach_info = &mach_signal_info;
-    
-    /* Write the report */
-    struct mach_exception_callback_live_cb_ctx live_ctx = {
-        .sigctx = sigctx,
-        .crashed_thread = thread,
-        .siginfo = &signal_info
-    };
-    if ((err = plcrash_async_thread_state_current(mach_exception_callback_live_cb, &live_ctx)) != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Failed to write live report: %d", err);
+    if (fd < 0) {
+        PLCF_DEBUG("Could not open the crash loop state file: %s", strerror(errno));
         return false;
     }
 
-    /* Call any post-crash callback */
-    if (crashCallbacks.handleSignal != NULL) {
-        /*
-         * The legacy signal-based callback assumes the availability of a ucontext_t; we mock
-         * an empty value here for the purpose of maintaining backwards compatibility. This behavior
-         * is defined in the PLCrashReporterCallbacks API documentation.
-         */
-        ucontext_t uctx;
-        _STRUCT_MCONTEXT mctx;
-        
-        /* Populate the mctx */
-        plcrash_async_memset(&mctx, 0, sizeof(mctx));
+    ssize_t written = plcrash_async_writen(fd, state, sizeof(*state));
+    close(fd);
 
-        /* Configure the ucontext */
-        plcrash_async_memset(&uctx, 0, sizeof(uctx));
-        uctx.uc_mcsize = sizeof(mctx);
-        uctx.uc_mcontext = &mctx;
-    
-        crashCallbacks.handleSignal(&si, &uctx, crashCallbacks.context);
+    if (written != sizeof(*state) || rename(tmp_path, path) != 0) {
+        PLCF_DEBUG("Could not write the crash loop state file: %s", strerror(errno));
+        unlink(tmp_path);
+        return false;
     }
 
-    return KERN_FAILURE;
+    return true;
 }
-#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
 
 /**
  * @internal
  *
- * Uncaught exception handler. Sets the plcrash_log_writer_t's uncaught exception
- * field, and then triggers a SIGTRAP (synchronous exception) to cause a normal
- * exception dump.
- *
- * XXX: It is possible that another crash may occur between setting the uncaught 
- * exception field, and triggering the signal handler.
+ * Serializes live report updates of plcrashreporter_handler_ctx_t::memory_sizing_state.
  */
-static void uncaught_exception_handler (NSException *exception) {
-    /* Set the uncaught exception */
-    plcrash_log_writer_set_exception(&signal_handler_context.writer, exception);
-
-    /* Synchronously trigger the crash handler */
-    abort();
-}
+static pthread_mutex_t memory_sizing_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/**
+ * @internal
+ *
+ * Read the persisted memory sizing samples from @a path. If the file does not exist or is invalid, @a state is reset
+ * to contain no samples.
+ *
+ * @param path The memory sizing state path.
+ * @param state The state to be populated.
+ */
+static void plcrash_memory_sizing_read_state (const char *path, plcrash_memory_sizing_state_t *state) {
+    plcrash_memory_sizing_state_t result;
 
-@interface PLCrashReporter (PrivateMethods)
-
-- (id) initWithBundle: (NSBundle *) bundle configuration: (PLCrashReporterConfig *) configuration;
-- (id) initWithApplicationIdentifier: (NSString *) applicationIdentifier appVersion: (NSString *) applicationVersion appMarketingVersion: (NSString *) applicationMarketingVersion configuration: (PLCrashReporterConfig *) configuration;
-
-- (PLCrashMachExceptionServer *) enableMachExceptionServerWithPreviousPortSet: (PLCrashMachExceptionPortSet **) previousPortSet
-                                                                     callback: (PLCrashMachExceptionHandlerCallback) callback
-                                                                      context: (void *) context
-                                                                        error: (NSError **) outError;
-
-- (plcrash_async_symbol_strategy_t) mapToAsyncSymbolicationStrategy: (PLCrashReporterSymbolicationStrategy) strategy;
+    memset(state, 0, sizeof(*state));
+    state->magic = MEMORY_SIZING_STATE_MAGIC;
 
-- (BOOL) populateCrashReportDirectoryAndReturnError: (NSError **) outError;
-- (NSString *) crashReportDirectory;
-- (NSString *) queuedCrashReportDirectory;
-- (NSString *) crashReportPath;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
 
-@end
+    if (read(fd, &result, sizeof(result)) == sizeof(result) && result.magic == MEMORY_SIZING_STATE_MAGIC &&
+        result.count <= MEMORY_SIZING_SAMPLES && result.next < MEMORY_SIZING_SAMPLES)
+    {
+        *state = result;
+    }
 
+    close(fd);
+}
 
 /**
- * Crash Reporter.
+ * @internal
  *
- * A PLCrashReporter instance manages process-wide handling of crashes.
+ * Append the memory used by @a writer's most recent report to @a state, and atomically replace the persisted samples
+ * at @a path, writing the new samples to @a tmp_path and renaming them into place. This function is async-safe.
+ *
+ * @param path The memory sizing state path.
+ * @param tmp_path The temporary path to which the samples will be written prior to being renamed to @a path.
+ * @param state The samples to be updated and written.
+ * @param writer The writer that wrote the report.
+ *
+ * @return Returns true on success, or false if the samples could not be written.
  */
-@implementation PLCrashReporter
+static bool plcrash_memory_sizing_record (const char *path, const char *tmp_path, plcrash_memory_sizing_state_t *state, plcrash_log_writer_t *writer) {
+    size_t arena_bytes;
+    size_t objc_class_count;
+
+    plcrash_log_writer_get_memory_usage(writer, &arena_bytes, &objc_class_count);
+    state->arena_bytes[state->next] = (uint32_t) MIN(arena_bytes, UINT32_MAX);
+    state->objc_class_count[state->next] = (uint32_t) MIN(objc_class_count, UINT32_MAX);
+    state->next = (state->next + 1) % MEMORY_SIZING_SAMPLES;
+    if (state->count < MEMORY_SIZING_SAMPLES)
+        state->count++;
+
+    int fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        PLCF_DEBUG("Could not open the memory sizing state file: %s", strerror(errno));
+        return false;
+    }
 
-+ (void) initialize {
-    if (![[self class] isEqual: [PLCrashReporter class]])
-        return;
-}
+    ssize_t written = plcrash_async_writen(fd, state, sizeof(*state));
+    close(fd);
 
+    if (written != sizeof(*state) || rename(tmp_path, path) != 0) {
+        PLCF_DEBUG("Could not write the memory sizing state file: %s", strerror(errno));
+        unlink(tmp_path);
+        return false;
+    }
 
-/* (Deprecated) Crash reporter singleton. */
-static PLCrashReporter *sharedReporter = nil;
+    return true;
+}
 
 /**
- * Return the default crash reporter instance. The returned instance will be configured
- * appropriately for release deployment.
+ * @internal
  *
- * @deprecated As of PLCrashReporter 1.2, the default reporter instance has been deprecated, and API
- * clients should initialize a crash reporter instance directly.
+ * Comparison function for sorting memory sizing samples.
  */
-+ (PLCrashReporter *) sharedReporter {
-    /* Once we drop 10.5 support, this may be converted to dispatch_once() */
-    static OSSpinLock onceLock = OS_SPINLOCK_INIT;
-    OSSpinLockLock(&onceLock); {
-        if (sharedReporter == nil)
-            sharedReporter = [[PLCrashReporter alloc] initWithBundle: [NSBundle mainBundle] configuration: [PLCrashReporterConfig defaultConfiguration]];
-    } OSSpinLockUnlock(&onceLock);
-
-    return sharedReporter;
+static int plcrash_memory_sizing_compare (const void *a, const void *b) {
+    uint32_t lhs = *(const uint32_t *) a;
+    uint32_t rhs = *(const uint32_t *) b;
+
+    if (lhs < rhs)
+        return -1;
+    else if (lhs > rhs)
+        return 1;
+    return 0;
 }
 
 /**
- * Initialize a new PLCrashReporter instance with a default configuration appropraite
- * for release deployment.
+ * @internal
+ *
+ * Comparison function for sorting queued report stack hashes.
  */
-- (instancetype) init {
-    return [self initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]];
+static int plcrash_queued_stack_hash_compare (const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *) a;
+    uint64_t rhs = *(const uint64_t *) b;
+
+    if (lhs < rhs)
+        return -1;
+    else if (lhs > rhs)
+        return 1;
+    return 0;
 }
 
 /**
- * Initialize a new PLCrashReporter instance with the given configuration.
+ * @internal
  *
- * @param configuration The configuration to be used by this reporter instance.
+ * Return the 99th percentile of the @a count values in @a samples, plus MEMORY_SIZING_HEADROOM, or 0 if @a count is 0.
  */
-- (instancetype) initWithConfiguration: (PLCrashReporterConfig *) configuration {
-    return [self initWithBundle: [NSBundle mainBundle] configuration: configuration];
-}
+static size_t plcrash_memory_sizing_p99 (const uint32_t *samples, uint32_t count) {
+    uint32_t sorted[MEMORY_SIZING_SAMPLES];
 
+    if (count == 0)
+        return 0;
 
-/**
- * Returns YES if the application has previously crashed and
- * an pending crash report is available.
- */
-- (BOOL) hasPendingCrashReport {
-    /* Check for a live crash report file */
-    return [[NSFileManager defaultManager] fileExistsAtPath: [self crashReportPath]];
-}
+    memcpy(sorted, samples, sizeof(sorted[0]) * count);
+    qsort(sorted, count, sizeof(sorted[0]), plcrash_memory_sizing_compare);
 
+    /* The nearest-rank percentile; with fewer than 100 samples, this is the largest sample */
+    size_t value = sorted[(count * 99 + 99) / 100 - 1];
+    return value + (size_t) (value * MEMORY_SIZING_HEADROOM);
+}
 
 /**
- * If an application has a pending crash report, this method returns the crash
- * report data.
+ * @internal
  *
- * You may use this to submit the report to your own HTTP server, over e-mail, or even parse and
- * introspect the report locally using the PLCrashReport API.
+ * Update the persisted crash loop state for a launch crash, and configure the writer's crash loop record.
  *
- * @return Returns nil if the crash report data could not be loaded.
+ * @param sigctx Fatal handler context.
+ * @param hash The crashed thread's stack hash, or 0 if unavailable. A hash of 0 is never considered a duplicate.
+ *
+ * @return Returns false if the crash duplicates the previous launch crash of an ongoing crash loop, and no report
+ * should be written.
  */
-- (NSData *) loadPendingCrashReportData {
-    return [self loadPendingCrashReportDataAndReturnError: NULL];
-}
+static bool plcrash_crash_loop_update (plcrashreporter_handler_ctx_t *sigctx, uint64_t hash) {
+    plcrash_crash_loop_state_t *previous = &sigctx->crash_loop_state;
+    bool looping = (previous->launch_crash_count >= sigctx->crash_loop_threshold);
+
+    plcrash_crash_loop_state_t state = {
+        .magic = CRASH_LOOP_STATE_MAGIC,
+        .launch_crash_count = previous->launch_crash_count + 1,
+        .stack_hash = hash
+    };
+    plcrash_crash_loop_write_state(sigctx->crash_loop_path, sigctx->crash_loop_tmp_path, &state);
+
+    if (looping && hash != 0 && hash == previous->stack_hash)
+        return false;
 
+    plcrash_log_writer_set_crash_loop(&sigctx->writer, state.launch_crash_count, hash, looping);
+    return true;
+}
 
 /**
- * If an application has a pending crash report, this method returns the crash
- * report data.
+ * @internal
  *
- * You may use this to submit the report to your own HTTP server, over e-mail, or even parse and
- * introspect the report locally using the PLCrashReport API.
- 
- * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
- * will contain an error object indicating why the pending crash report could not be
- * loaded. If no error occurs, this parameter will be left unmodified. You may specify
- * nil for this parameter, and no error information will be provided.
+ * Record a duplicate crash occurrence in place of a new report if @a hash matches the stack hash of a queued report.
  *
- * @return Returns nil if the crash report data could not be loaded.
+ * @param sigctx Fatal handler context.
+ * @param queued_hashes The stack hashes of the queued reports, or NULL.
+ * @param hash The crashed thread's stack hash, or 0 if unavailable. A hash of 0 is never considered a duplicate.
+ * @param siginfo The signal information.
+ *
+ * @return Returns true if an occurrence was recorded, and no report should be written.
  */
-- (NSData *) loadPendingCrashReportDataAndReturnError: (NSError **) outError {
-    /* Load the (memory mapped) data */
-    return [NSData dataWithContentsOfFile: [self crashReportPath] options: NSMappedRead error: outError];
-}
+static bool plcrash_duplicate_crash_record (plcrashreporter_handler_ctx_t *sigctx, const plcrash_queued_stack_hashes_t *queued_hashes, uint64_t hash, plcrash_log_signal_info_t *siginfo) {
+    if (queued_hashes == NULL || hash == 0)
+        return false;
 
+    /* Binary search of the sorted hashes */
+    size_t lo = 0;
+    size_t hi = queued_hashes->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (queued_hashes->hashes[mid] < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-/**
- * Purge a pending crash report.
- *
- * @return Returns YES on success, or NO on error.
- */
-- (BOOL) purgePendingCrashReport {
-    return [self purgePendingCrashReportAndReturnError: NULL];
-}
+    if (lo == queued_hashes->count || queued_hashes->hashes[lo] != hash)
+        return false;
 
+    plcrash_queued_report_occurrence_t occurrence;
+    memset(&occurrence, 0, sizeof(occurrence));
+    occurrence.stack_hash = hash;
 
-/**
- * Purge a pending crash report.
- *
- * @return Returns YES on success, or NO on error.
- */
-- (BOOL) purgePendingCrashReportAndReturnError: (NSError **) outError {
-    return [[NSFileManager defaultManager] removeItemAtPath: [self crashReportPath] error: outError];
-}
+    time_t now;
+    if (time(&now) != (time_t) -1)
+        occurrence.timestamp = (uint64_t) now * 1000;
+
+    if (siginfo->bsd_info != NULL) {
+        occurrence.signo = (uint16_t) siginfo->bsd_info->signo;
+        occurrence.code = siginfo->bsd_info->code;
+    }
 
+    /* If the occurrence can not be recorded, fall back on writing a full report */
+    return plcrash_queued_report_occurrence_append(sigctx->occurrence_path, &occurrence) == PLCRASH_ESUCCESS;
+}
 
 /**
- * Enable the crash reporter. Once called, all application crashes will
- * result in a crash report being written prior to application exit.
- *
- * @return Returns YES on success, or NO if the crash reporter could
- * not be enabled.
+ * Write a fatal crash report.
  *
- * @par Registering Multiple Reporters
+ * @param sigctx Fatal handler context.
+ * @param crashed_thread The crashed thread.
+ * @param thread_state The crashed thread's state.
+ * @param siginfo The signal information.
  *
- * Only one PLCrashReporter instance may be enabled in a process; attempting to enable an additional instance
- * will return NO, and the reporter will not be enabled. This restriction may be removed in a future release.
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error value if the report could not be written.
  */
-- (BOOL) enableCrashReporter {
-    return [self enableCrashReporterAndReturnError: nil];
-}
+static plcrash_error_t plcrash_write_report (plcrashreporter_handler_ctx_t *sigctx, thread_t crashed_thread, plcrash_async_thread_state_t *thread_state, plcrash_log_signal_info_t *siginfo) {
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+    bool mapped = (sigctx->mapped_report != NULL);
+    bool slotted = false;
+    uint32_t slot_index = 0;
+    int fd;
+
+    /* The crashed thread's stack hash is only computed if required by crash loop detection (for crashes within the
+     * launch interval) or duplicate crash suppression */
+    plcrash_queued_stack_hashes_t *queued_hashes = sigctx->queued_stack_hashes;
+    bool launch_crash = (sigctx->crash_loop_path != NULL && mach_absolute_time() < sigctx->launch_deadline);
+    uint64_t hash = 0;
+    if (launch_crash || queued_hashes != NULL) {
+        if (plcrash_log_writer_stack_hash(&sigctx->writer, mach_task_self(), crashed_thread, sigctx->dynamic_loader, thread_state, &hash) != PLCRASH_ESUCCESS)
+            hash = 0;
+    }
 
+    /* Skip duplicate crashes within a crash loop entirely, keeping the recovery launch fast */
+    if (launch_crash && !plcrash_crash_loop_update(sigctx, hash))
+        return PLCRASH_ESUCCESS;
+
+    /* Record crashes that duplicate a queued report as a compact occurrence, rather than writing a new report */
+    if (plcrash_duplicate_crash_record(sigctx, queued_hashes, hash, siginfo))
+        return PLCRASH_ESUCCESS;
+
+    /* Prefer a slot in the shared report slot file; no file is created, and the slot is only published once the
+     * report is complete. If all slots are in use, fall back on our own report file. */
+    void *slot_data;
+    size_t slot_size;
+    if (sigctx->report_slots != NULL && plcrash_async_report_slots_claim(sigctx->report_slots, &slot_index, &slot_data, &slot_size)) {
+        slotted = true;
+        mapped = false;
+        plcrash_async_file_init_memory(&file, slot_data, MIN(slot_size, MAX_REPORT_BYTES));
+    } else if (mapped) {
+        /* Use the pre-sized, pre-faulted mapping; no open() or write() calls are required. The mapping
+         * may only be used once. */
+        fd = sigctx->mapped_fd;
+        plcrash_async_file_init_mapped(&file, fd, sigctx->mapped_report, MAX_REPORT_BYTES);
+        sigctx->mapped_report = NULL;
+    } else {
+        /* Open the output file. If the crash occured before a deferred setup created the report directory, create
+         * it now. */
+        fd = open(sigctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+        if (fd < 0 && errno == ENOENT && plcrash_create_parent_directories(sigctx->path))
+            fd = open(sigctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+
+        if (fd < 0) {
+            PLCF_DEBUG("Could not open the crashlog output file: %s", strerror(errno));
+            return PLCRASH_EINTERNAL;
+        }
 
+        /* Reserve the report's storage up front, rather than allocating blocks as each buffer is written */
+        if (sigctx->preallocation_size > 0)
+            plcrash_async_file_preallocate(fd, sigctx->preallocation_size);
 
-/**
- * Enable the crash reporter. Once called, all application crashes will
- * result in a crash report being written prior to application exit.
- *
- * This method must only be invoked once. Further invocations will throw
- * a PLCrashReporterException.
- *
- * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
- * will contain an error in the PLCrashReporterErrorDomain indicating why the Crash Reporter
- * could not be enabled. If no error occurs, this parameter will be left unmodified. You may
- * specify nil for this parameter, and no error information will be provided.
- *
- * @return Returns YES on success, or NO if the crash reporter could
- * not be enabled.
- *
- * @par Registering Multiple Reporters
- *
- * Only one PLCrashReporter instance may be enabled in a process; attempting to enable an additional instance
- * will return NO and a PLCrashReporterErrorResourceBusy error, and the reporter will not be enabled.
- * This restriction may be removed in a future release.
+        /* Initialize the output context */
+        plcrash_async_file_init_buffer(&file, fd, MAX_REPORT_BYTES, sigctx->write_buffer, sigctx->write_buffer_size);
+    }
+
+    if (!slotted)
+        plcrash_async_file_set_sync(&file, sigctx->sync_policy);
+
+    /* Checksum the report, if enabled. This must precede compression, which writes the compressed report header. */
+    if (sigctx->checksum)
+        plcrash_async_file_set_checksum(&file);
+
+    /* Compress the report, if enabled */
+    if (sigctx->compressor != NULL)
+        plcrash_async_file_set_compressor(&file, sigctx->compressor);
+    
+    /* Write the crash log using the already-initialized writer */
+    err = plcrash_log_writer_write(&sigctx->writer, crashed_thread, sigctx->dynamic_loader, &file, siginfo, thread_state);
+
+    /* Close the writer; this may also fail (but shouldn't) */
+    if (plcrash_log_writer_close(&sigctx->writer) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to close the log writer");
+        plcrash_async_file_close(&file);
+        if (slotted)
+            plcrash_async_report_slots_release(sigctx->report_slots, slot_index);
+        return PLCRASH_EINTERNAL;
+    }
+    
+    /* Finished */
+    if (!plcrash_async_file_flush(&file)) {
+        PLCF_DEBUG("Failed to flush output file");
+        plcrash_async_file_close(&file);
+        if (slotted)
+            plcrash_async_report_slots_release(sigctx->report_slots, slot_index);
+        return PLCRASH_EINTERNAL;
+    }
+    
+    if (!plcrash_async_file_close(&file)) {
+        PLCF_DEBUG("Failed to close output file");
+        if (slotted)
+            plcrash_async_report_slots_release(sigctx->report_slots, slot_index);
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Publish the completed report to the host application */
+    if (slotted)
+        plcrash_async_report_slots_commit(sigctx->report_slots, slot_index, (size_t) plcrash_async_file_position(&file), sigctx->sync_policy != PLCRASH_ASYNC_FILE_SYNC_NONE);
+
+    /* Record the memory used by the report, allowing the next launch to size the writer accordingly */
+    if (sigctx->memory_sizing_path != NULL)
+        plcrash_memory_sizing_record(sigctx->memory_sizing_path, sigctx->memory_sizing_tmp_path, &sigctx->memory_sizing_state, &sigctx->writer);
+
+    /* Move the completed report into place */
+    if (mapped && rename(sigctx->mapped_path, sigctx->path) != 0) {
+        PLCF_DEBUG("Failed to move the mapped crash report into place: %s", strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    return err;
+}
+
+/**
+ * @internal
+ *
+ * Create (or replace) the file at @a path, size it to @a size bytes, and map it into memory for use
+ * with plcrash_async_file_init_mapped(). The mapped pages are touched here, prior to any crash, so that
+ * writes from the crash handler do not need to fault in new pages.
+ *
+ * @param path The path of the file to be created.
+ * @param size The size of the file and mapping, in bytes.
+ * @param preallocate If true, the file's storage is reserved via F_PREALLOCATE before it is sized.
+ * @param fd On success, will be set to the open file descriptor.
+ * @param mapping On success, will be set to the address of the MAP_SHARED mapping.
+ *
+ * @return Returns true on success, or false if the file could not be created or mapped.
+ */
+static bool plcrash_map_report_file (const char *path, size_t size, bool preallocate, int *fd, void **mapping) {
+    int mfd = open(path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (mfd < 0) {
+        PLCF_DEBUG("Could not open the mapped crashlog output file: %s", strerror(errno));
+        return false;
+    }
+
+    /* Ask for contiguous storage; ftruncate() alone may leave the file sparse, deferring block allocation until the
+     * crash handler writes to the mapping. This is non-fatal. */
+    if (preallocate)
+        plcrash_async_file_preallocate(mfd, size);
+
+    if (ftruncate(mfd, size) != 0) {
+        PLCF_DEBUG("Could not size the mapped crashlog output file: %s", strerror(errno));
+        close(mfd);
+        unlink(path);
+        return false;
+    }
+
+    void *addr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, mfd, 0);
+    if (addr == MAP_FAILED) {
+        PLCF_DEBUG("Could not map the crashlog output file: %s", strerror(errno));
+        close(mfd);
+        unlink(path);
+        return false;
+    }
+
+    /* Fault in the mapping */
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE)
+        ((volatile uint8_t *) addr)[offset] = 0;
+
+    *fd = mfd;
+    *mapping = addr;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Elect @a thread to write the fatal crash report. A single compare-and-swap decides the election; exactly one
+ * crashing thread is elected, and all later callers -- including a re-entrant crash of the elected thread -- lose.
+ *
+ * @param thread The crashing thread.
+ *
+ * @return Returns true if @a thread was elected.
+ */
+static bool plcrash_crash_elect (thread_t thread) {
+    return OSAtomicCompareAndSwap32Barrier(MACH_PORT_NULL, (int32_t) thread, &crash_reporter_thread);
+}
+
+/**
+ * @internal
+ *
+ * Park a crashing thread that lost the crash reporter election until the elected thread has finished writing its
+ * report. The wait is a timed Mach thread switch, requiring neither locks nor allocation; the parked thread will
+ * also be suspended by the writer for the duration of the report.
+ */
+static void plcrash_crash_park (void) {
+    while (!crash_report_finished)
+        thread_switch(MACH_PORT_NULL, SWITCH_OPTION_WAIT, 1);
+}
+
+/**
+ * @internal
+ *
+ * Remove all signal handlers -- if the crash reporting code fails, the default terminate action will occur.
+ *
+ * NOTE: SA_RESETHAND breaks SA_SIGINFO on ARM, so we reset the handlers manually.
+ * http://openradar.appspot.com/11839803
+ *
+ * TODO: When forwarding signals (eg, to Mono's runtime), resetting the signal handlers
+ * could result in incorrect runtime behavior; we should revisit resetting the
+ * signal handlers once we address double-fault handling.
+ */
+static void plcrash_reset_signal_handlers (void) {
+    for (int i = 0; i < monitored_signals_count; i++) {
+        struct sigaction sa;
+        
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = SIG_DFL;
+        sigemptyset(&sa.sa_mask);
+        
+        sigaction(monitored_signals[i], &sa, NULL);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Signal handler callback.
+ */
+static bool signal_handler_callback (int signal, siginfo_t *info, pl_ucontext_t *uap, void *context, PLCrashSignalHandlerCallback *next) {
+    plcrashreporter_handler_ctx_t *sigctx = context;
+    plcrash_async_thread_state_t thread_state;
+    plcrash_log_signal_info_t signal_info;
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    thread_t self = pl_mach_thread_self();
+
+    /* Extract the thread state */
+    // XXX_ARM64 rdar://14970271 -- In the Xcode 5 GM SDK, _STRUCT_MCONTEXT is not correctly
+    // defined as _STRUCT_MCONTEXT64 when building for arm64; this requires the pl_mcontext_t
+    // cast.
+    plcrash_async_thread_state_mcontext_init(&thread_state, (pl_mcontext_t *) uap->uc_mcontext);
+    
+    /* Set up the BSD signal info */
+    bsd_signal_info.signo = info->si_signo;
+    bsd_signal_info.code = info->si_code;
+    bsd_signal_info.address = info->si_addr;
+    
+    signal_info.bsd_info = &bsd_signal_info;
+    signal_info.mach_info = NULL;
+
+    /* Only a single crashing thread may use the writer. The signal handlers remain installed while the report is
+     * written, so that threads crashing concurrently are recorded as secondary crashes and parked, rather than
+     * terminating the process before the report has been written. */
+    if (!plcrash_crash_elect(self)) {
+        /* A re-entrant crash of the elected thread; fall through to the default action */
+        if ((thread_t) crash_reporter_thread == self) {
+            plcrash_reset_signal_handlers();
+            return false;
+        }
+
+        plcrash_log_secondary_crashes_add(&secondary_crashes, self, &bsd_signal_info, &thread_state);
+        plcrash_crash_park();
+
+        /* The default handlers have been restored; the signal will be re-raised, terminating the process */
+        return false;
+    }
+
+    /* Write the report */
+    plcrash_error_t err = plcrash_write_report(sigctx, self, &thread_state, &signal_info);
+
+    plcrash_reset_signal_handlers();
+    crash_report_finished = true;
+
+    if (err != PLCRASH_ESUCCESS)
+        return false;
+
+    /* Call any post-crash callback */
+    if (crashCallbacks.handleSignal != NULL)
+        crashCallbacks.handleSignal(info, uap, crashCallbacks.context);
+    
+    return false;
+}
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+/* State and callback used to generate thread state for the calling mach thread. */
+struct mach_exception_callback_live_cb_ctx {
+    plcrashreporter_handler_ctx_t *sigctx;
+    thread_t crashed_thread;
+    plcrash_log_signal_info_t *siginfo;
+};
+
+static plcrash_error_t mach_exception_callback_live_cb (plcrash_async_thread_state_t *state, void *ctx) {
+    struct mach_exception_callback_live_cb_ctx *plcr_ctx = ctx;
+    return plcrash_write_report(plcr_ctx->sigctx, plcr_ctx->crashed_thread, state, plcr_ctx->siginfo);
+}
+
+static kern_return_t mach_exception_callback (task_t task, thread_t thread, exception_type_t exception_type, mach_exception_data_t code, mach_msg_type_number_t code_count, void *context) {
+    plcrashreporter_handler_ctx_t *sigctx = context;
+    plcrash_log_signal_info_t signal_info;
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    plcrash_log_mach_signal_info_t mach_signal_info;
+    plcrash_error_t err;
+
+    /* Any other registered server has already been given the opportunity to handle the exception; the exception server
+     * forwards to sigctx->port_set prior to issuing this callback. */
+    
+    /* Set up the BSD signal info */
+    siginfo_t si;
+    if (!plcrash_async_mach_exception_get_siginfo(exception_type, code, code_count, CPU_TYPE_ANY, &si)) {
+        PLCF_DEBUG("Unexpected error mapping Mach exception to a POSIX signal");
+        return KERN_FAILURE;
+    }
+
+    bsd_signal_info.signo = si.si_signo;
+    bsd_signal_info.code = si.si_code;
+    bsd_signal_info.address = si.si_addr;
+
+    signal_info.bsd_info = &bsd_signal_info;
+    
+    /* Set up the Mach signal info */
+    mach_signal_info.type = exception_type;
+    mach_signal_info.code = code;
+    mach_signal_info.code_count = code_count;
+    signal_info.mach_info = &mach_signal_info;
+
+    /* Exceptions are delivered serially, and a report has already been written for (or is being written by) the
+     * elected thread. */
+    if (!plcrash_crash_elect(thread))
+        return KERN_FAILURE;
+
+    /* Write the report */
+    struct mach_exception_callback_live_cb_ctx live_ctx = {
+        .sigctx = sigctx,
+        .crashed_thread = thread,
+        .siginfo = &signal_info
+    };
+    if ((err = plcrash_async_thread_state_current(mach_exception_callback_live_cb, &live_ctx)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to write live report: %d", err);
+        return false;
+    }
+
+    /* Call any post-crash callback */
+    if (crashCallbacks.handleSignal != NULL) {
+        /*
+         * The legacy signal-based callback assumes the availability of a ucontext_t; we mock
+         * an empty value here for the purpose of maintaining backwards compatibility. This behavior
+         * is defined in the PLCrashReporterCallbacks API documentation.
+         */
+        ucontext_t uctx;
+        _STRUCT_MCONTEXT mctx;
+        
+        /* Populate the mctx */
+        plcrash_async_memset(&mctx, 0, sizeof(mctx));
+
+        /* Configure the ucontext */
+        plcrash_async_memset(&uctx, 0, sizeof(uctx));
+        uctx.uc_mcsize = sizeof(mctx);
+        uctx.uc_mcontext = &mctx;
+    
+        crashCallbacks.handleSignal(&si, &uctx, crashCallbacks.context);
+    }
+
+    return KERN_FAILURE;
+}
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+
+/**
+ * @internal
+ *
+ * Uncaught exception handler. Sets the plcrash_log_writer_t's uncaught exception
+ * field, and then triggers a SIGTRAP (synchronous exception) to cause a normal
+ * exception dump.
+ *
+ * XXX: It is possible that another crash may occur between setting the uncaught 
+ * exception field, and triggering the signal handler.
+ */
+static void uncaught_exception_handler (NSException *exception) {
+    /* Set the uncaught exception */
+    plcrash_log_writer_set_exception(&signal_handler_context.writer, exception);
+
+    /* Synchronously trigger the crash handler */
+    abort();
+}
+
+
+/**
+ * @internal
+ *
+ * Enumerates the reports in a queued crash report directory, mapping and decoding a single report
+ * per call to -nextObject.
+ */
+@interface PLCrashReporterQueuedReportEnumerator : NSEnumerator {
+@private
+    /** The queued report directory. */
+    NSString *_directory;
+
+    /** The enumerated report identifiers. */
+    NSEnumerator *_identifiers;
+}
+
+- (id) initWithDirectory: (NSString *) directory identifiers: (NSArray *) identifiers;
+
+@end
+
+@implementation PLCrashReporterQueuedReportEnumerator
+
+/**
+ * Initialize a new enumerator over the reports in @a directory.
+ *
+ * @param directory The queued report directory.
+ * @param identifiers The identifiers of the reports to be enumerated, in queue order.
+ */
+- (id) initWithDirectory: (NSString *) directory identifiers: (NSArray *) identifiers {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _directory = [directory retain];
+    _identifiers = [[identifiers objectEnumerator] retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_directory release];
+    [_identifiers release];
+    [super dealloc];
+}
+
+// from NSEnumerator
+- (id) nextObject {
+    NSString *identifier;
+
+    while ((identifier = [_identifiers nextObject]) != nil) {
+        NSString *path = [[_directory stringByAppendingPathComponent: identifier] stringByAppendingPathExtension: PLCRASH_QUEUED_REPORT_EXTENSION];
+        NSError *error;
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+        if (report == nil) {
+            /* Skip (but leave in place) reports that can not be decoded */
+            NSDEBUG(@"Could not decode queued crash report %@: %@", path, error);
+            continue;
+        }
+
+        return report;
+    }
+
+    return nil;
+}
+
+@end
+
+
+/**
+ * @internal
+ *
+ * The maximum number of frames included in the hash computed by plcrash_queued_report_stack_hash().
+ */
+#define MAX_QUEUED_REPORT_STACK_HASH_FRAMES 32
+
+/**
+ * @internal
+ *
+ * Return a hash of @a report's crashed thread stack, for inclusion in the queued report index, or 0 if the report
+ * has no crashed thread. The hash is computed as per plcrash_log_writer_stack_hash(), and the writer's own hash is
+ * used where the report provides one.
+ */
+static uint64_t plcrash_queued_report_stack_hash (PLCrashReport *report) {
+    if (report.stackHash != 0)
+        return report.stackHash;
+
+    PLCrashReportThreadInfo *thread = report.crashedThread;
+    if (thread == nil)
+        return 0;
+
+    uint64_t result = 14695981039346656037ULL;
+    NSUInteger count = 0;
+    for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+        if (count++ == MAX_QUEUED_REPORT_STACK_HASH_FRAMES)
+            break;
+
+        uint64_t offset = 0;
+        PLCrashReportBinaryImageInfo *image = [report imageForAddress: frame.instructionPointer];
+        if (image != nil) {
+            for (const char *c = [image.imageName UTF8String]; c != NULL && *c != '\0'; c++) {
+                result ^= (uint8_t) *c;
+                result *= 1099511628211ULL;
+            }
+            offset = frame.instructionPointer - image.imageBaseAddress;
+        }
+
+        result ^= offset;
+        result *= 1099511628211ULL;
+    }
+
+    return result;
+}
+
+
+@interface PLCrashReporter (PrivateMethods)
+
+- (id) initWithBundle: (NSBundle *) bundle configuration: (PLCrashReporterConfig *) configuration;
+- (id) initWithApplicationIdentifier: (NSString *) applicationIdentifier appVersion: (NSString *) applicationVersion appMarketingVersion: (NSString *) applicationMarketingVersion configuration: (PLCrashReporterConfig *) configuration;
+
+- (PLCrashMachExceptionServer *) enableMachExceptionServerWithPreviousPortSet: (PLCrashMachExceptionPortSet **) previousPortSet
+                                                                     callback: (PLCrashMachExceptionHandlerCallback) callback
+                                                                      context: (void *) context
+                                                                        error: (NSError **) outError;
+
+- (PLCrashReporterSymbolicationStrategy) writerSymbolicationStrategy;
+- (plcrash_async_symbol_strategy_t) mapToAsyncSymbolicationStrategy: (PLCrashReporterSymbolicationStrategy) strategy;
+- (BOOL) writeReportData: (NSData *) data toPath: (NSString *) path compress: (BOOL) compress error: (NSError **) outError;
+
+- (BOOL) enableCrashReporterDeferringSetup: (BOOL) deferSetup error: (NSError **) outError;
+- (void) completeDeferredSetup;
+- (void) enableBreadcrumbs;
+- (void) prefaultCrashMemory;
+- (size_t) standbyClassCapacity;
+
+- (plcr_live_report_sampler_t *) newLiveReportSamplerAndReturnError: (NSError **) outError;
+- (plcr_live_report_sampler_t *) lockLiveReportSamplerAndReturnError: (NSError **) outError;
+- (void) unlockLiveReportSampler: (plcr_live_report_sampler_t *) sampler;
+- (void) prepareLiveReportSampler: (plcr_live_report_sampler_t *) sampler;
+- (void) updateSharedImageListForSampler: (plcr_live_report_sampler_t *) sampler;
+
+- (BOOL) populateCrashReportDirectoryAndReturnError: (NSError **) outError;
+- (NSString *) crashReportDirectory;
+- (NSString *) queuedCrashReportDirectory;
+- (NSString *) queuedCrashReportIndexPath;
+- (NSArray *) queuedCrashReportIdentifiers;
+- (NSArray *) rebuildQueuedCrashReportIndex;
+- (NSString *) queuedCrashReportOccurrencePath;
+- (void) publishQueuedStackHashes;
+- (NSString *) sharedImageListDirectory;
+- (NSString *) crashReportPath;
+- (NSString *) sharedReportSlotsPath;
+- (BOOL) queueCrashReportAtPath: (NSString *) reportPath error: (NSError **) outError;
+
+- (void) scheduleProcessingBlock: (dispatch_block_t) block;
+
+@end
+
+
+/**
+ * Crash Reporter.
+ *
+ * A PLCrashReporter instance manages process-wide handling of crashes.
+ */
+@implementation PLCrashReporter
+
++ (void) initialize {
+    if (![[self class] isEqual: [PLCrashReporter class]])
+        return;
+}
+
+
+/* (Deprecated) Crash reporter singleton. */
+static PLCrashReporter *sharedReporter = nil;
+
+/**
+ * Return the default crash reporter instance. The returned instance will be configured
+ * appropriately for release deployment.
+ *
+ * @deprecated As of PLCrashReporter 1.2, the default reporter instance has been deprecated, and API
+ * clients should initialize a crash reporter instance directly.
+ */
++ (PLCrashReporter *) sharedReporter {
+    /* Once we drop 10.5 support, this may be converted to dispatch_once() */
+    static OSSpinLock onceLock = OS_SPINLOCK_INIT;
+    OSSpinLockLock(&onceLock); {
+        if (sharedReporter == nil)
+            sharedReporter = [[PLCrashReporter alloc] initWithBundle: [NSBundle mainBundle] configuration: [PLCrashReporterConfig defaultConfiguration]];
+    } OSSpinLockUnlock(&onceLock);
+
+    return sharedReporter;
+}
+
+/**
+ * Initialize a new PLCrashReporter instance with a default configuration appropraite
+ * for release deployment.
+ */
+- (instancetype) init {
+    return [self initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]];
+}
+
+/**
+ * Initialize a new PLCrashReporter instance with the given configuration.
+ *
+ * @param configuration The configuration to be used by this reporter instance.
+ */
+- (instancetype) initWithConfiguration: (PLCrashReporterConfig *) configuration {
+    return [self initWithBundle: [NSBundle mainBundle] configuration: configuration];
+}
+
+
+/**
+ * Returns YES if the application has previously crashed and
+ * an pending crash report is available.
+ */
+- (BOOL) hasPendingCrashReport {
+    /* Check for a live crash report file */
+    return [[NSFileManager defaultManager] fileExistsAtPath: [self crashReportPath]];
+}
+
+/**
+ * Returns the number of consecutive prior launches that terminated in a launch crash, as read when the crash reporter
+ * was enabled. Applications may use this value to enter a safe mode while crash looping.
+ *
+ * Returns 0 if the crash reporter has not been enabled, or if PLCrashReporterConfig::crashLoopThreshold is 0.
+ */
+- (NSUInteger) launchCrashCount {
+    if (!_enabled || signal_handler_context.crash_loop_path == NULL)
+        return 0;
+
+    return signal_handler_context.crash_loop_state.launch_crash_count;
+}
+
+/**
+ * Asynchronously determine whether a pending crash report is available, without blocking the calling thread on
+ * file system access; see hasPendingCrashReport.
+ *
+ * @param handler The block to be called on the main queue with the result.
+ */
+- (void) hasPendingCrashReportWithCompletionHandler: (void (^)(BOOL hasPendingReport)) handler {
+    [self scheduleProcessingBlock: ^{
+        BOOL hasPendingReport = [self hasPendingCrashReport];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            handler(hasPendingReport);
+        });
+    }];
+}
+
+
+/**
+ * If an application has a pending crash report, this method returns the crash
+ * report data.
+ *
+ * You may use this to submit the report to your own HTTP server, over e-mail, or even parse and
+ * introspect the report locally using the PLCrashReport API.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ */
+- (NSData *) loadPendingCrashReportData {
+    return [self loadPendingCrashReportDataAndReturnError: NULL];
+}
+
+
+/**
+ * If an application has a pending crash report, this method returns the crash
+ * report data.
+ *
+ * You may use this to submit the report to your own HTTP server, over e-mail, or even parse and
+ * introspect the report locally using the PLCrashReport API.
+ 
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * loaded. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ */
+- (NSData *) loadPendingCrashReportDataAndReturnError: (NSError **) outError {
+    /* Load the (memory mapped) data */
+    return [NSData dataWithContentsOfFile: [self crashReportPath] options: NSMappedRead error: outError];
+}
+
+
+/**
+ * If an application has a pending crash report, this method returns the decoded crash report.
+ *
+ * The report is memory-mapped and decoded lazily (see PLCrashReportDecodingOptionLazy); thread and binary
+ * image records are only decoded, and only paged in, on first access.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * loaded. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns nil if the crash report could not be loaded.
+ */
+- (PLCrashReport *) loadPendingCrashReportAndReturnError: (NSError **) outError {
+    return [[[PLCrashReport alloc] initWithContentsOfFile: [self crashReportPath] options: PLCrashReportDecodingOptionLazy error: outError] autorelease];
+}
+
+
+/**
+ * Purge a pending crash report.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) purgePendingCrashReport {
+    return [self purgePendingCrashReportAndReturnError: NULL];
+}
+
+
+/**
+ * Purge a pending crash report.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) purgePendingCrashReportAndReturnError: (NSError **) outError {
+    return [[NSFileManager defaultManager] removeItemAtPath: [self crashReportPath] error: outError];
+}
+
+
+/**
+ * Symbolicate a pending crash report that was written with PLCrashReporterSymbolicationStrategyDeferred, rewriting
+ * the report in place. Frames that already provide symbol information are left unmodified.
+ *
+ * Symbols are resolved against the images loaded in the current process, which must match those of the crashed
+ * process; this should be called on the launch following the crash, prior to any application or OS update.
+ * Frames within images that are no longer loaded will remain unsymbolicated.
+ *
+ * Symbolication may be expensive, and this method should not be called from the main thread; see
+ * symbolicatePendingCrashReportWithCompletionHandler:.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * symbolicated. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) symbolicatePendingCrashReportAndReturnError: (NSError **) outError {
+    NSData *data = [self loadPendingCrashReportDataAndReturnError: outError];
+    if (data == nil)
+        return NO;
+
+    PLCrashReportSymbolicator *symbolicator = [[[PLCrashReportSymbolicator alloc] init] autorelease];
+    NSData *symbolicated = [symbolicator symbolicateReportData: data error: outError];
+    if (symbolicated == nil)
+        return NO;
+
+    /* Preserve the report's compression */
+    BOOL compress = plcrash_async_compressed_is_compressed([data bytes], [data length]);
+    return [self writeReportData: symbolicated toPath: [self crashReportPath] compress: compress error: outError];
+}
+
+/**
+ * Asynchronously symbolicate a pending crash report on a background queue; see
+ * symbolicatePendingCrashReportAndReturnError:.
+ *
+ * @param handler The block to be called on the main queue once symbolication has completed. If symbolication failed,
+ * @a error will describe the failure. May be nil.
+ */
+- (void) symbolicatePendingCrashReportWithCompletionHandler: (void (^)(BOOL success, NSError *error)) handler {
+    [self scheduleProcessingBlock: ^{
+        NSError *error = nil;
+        BOOL success = [self symbolicatePendingCrashReportAndReturnError: &error];
+
+        /* The error is autoreleased within the processing block's pool */
+        [error retain];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (handler != nil)
+                handler(success, error);
+            [error release];
+        });
+    }];
+}
+
+
+/**
+ * Move the pending crash report to the queue of reports awaiting submission, making room for a new pending
+ * report. Queued reports may be later retrieved via queuedCrashReportEnumerator.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * queued. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) queuePendingCrashReportAndReturnError: (NSError **) outError {
+    return [self queueCrashReportAtPath: [self crashReportPath] error: outError];
+}
+
+/**
+ * @internal
+ *
+ * Report slot enumeration callback; records each complete slot's index and a copy of its report in the
+ * NSMutableArray provided as @a context.
+ */
+static void plcr_collect_shared_report (uint32_t index, pid_t pid, uint64_t timestamp, const void *data, size_t length, void *context) {
+    NSMutableArray *reports = context;
+    [reports addObject: [NSArray arrayWithObjects: [NSNumber numberWithUnsignedInt: index], [NSData dataWithBytes: data length: length], nil]];
+}
+
+/**
+ * Move the reports written to the shared report slots -- by this process, or by any other process configured with
+ * the same PLCrashReporterConfig::sharedReportContainerPath -- to this crash reporter's queue of reports awaiting
+ * submission, freeing their slots. Queued reports may be later retrieved via queuedCrashReportEnumerator.
+ *
+ * Pending reports are located with a single scan of the slot descriptors at the start of the shared file; slots that
+ * are free, or that are still being written by a running process, are not read. This is intended to be called by
+ * the host application at launch. If shared report slots are not configured, or no report has yet been written, this
+ * method does nothing.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the shared crash reports could not be
+ * queued. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error. Reports queued prior to the error are removed from their slots; all
+ * others are left in place.
+ */
+- (BOOL) queueSharedCrashReportsAndReturnError: (NSError **) outError {
+    NSString *slotsPath = [self sharedReportSlotsPath];
+    if (slotsPath == nil || ![[NSFileManager defaultManager] fileExistsAtPath: slotsPath])
+        return YES;
+
+    plcrash_async_report_slots_t slots;
+    if (plcrash_nasync_report_slots_open(&slots, [slotsPath fileSystemRepresentation], SHARED_REPORT_SLOT_COUNT, MAX_REPORT_BYTES) != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not open the shared crash report slots", nil);
+        return NO;
+    }
+
+    NSMutableArray *reports = [NSMutableArray array];
+    plcrash_nasync_report_slots_enumerate(&slots, plcr_collect_shared_report, reports);
+
+    /* Each report is written to a temporary file, and then queued as if it were our own pending report */
+    NSString *tmpPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_SHARED_REPORT_TMP];
+    BOOL result = YES;
+    for (NSArray *entry in reports) {
+        if (![self populateCrashReportDirectoryAndReturnError: outError] ||
+            ![[entry objectAtIndex: 1] writeToFile: tmpPath options: NSDataWritingAtomic error: outError] ||
+            ![self queueCrashReportAtPath: tmpPath error: outError])
+        {
+            result = NO;
+            break;
+        }
+
+        plcrash_async_report_slots_release(&slots, [[entry objectAtIndex: 0] unsignedIntValue]);
+    }
+
+    plcrash_nasync_report_slots_close(&slots);
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Move the report at @a reportPath to the queue of reports awaiting submission, indexing its size and stack hash.
+ *
+ * @param reportPath The report to be queued.
+ * @param outError If an error occurs, will contain an error object describing the failure. May be nil.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) queueCrashReportAtPath: (NSString *) reportPath error: (NSError **) outError {
+    if (![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    /* Queued reports are named by the time at which they were queued, and are enumerated in that order */
+    uint64_t timestamp = (uint64_t) ([[NSDate date] timeIntervalSince1970] * 1000.0);
+    NSString *name = [NSString stringWithFormat: @"%016llx-%@", (unsigned long long) timestamp, [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSString *path = [[[self queuedCrashReportDirectory] stringByAppendingPathComponent: name] stringByAppendingPathExtension: PLCRASH_QUEUED_REPORT_EXTENSION];
+
+    /* Record the report's size and stack hash in the index, allowing the queue to be listed and prioritized without
+     * reading the reports themselves */
+    uint64_t size = [[fm attributesOfItemAtPath: reportPath error: NULL] fileSize];
+    uint64_t stackHash = 0;
+    PLCrashReport *report = [[PLCrashReport alloc] initWithContentsOfFile: reportPath options: PLCrashReportDecodingOptionLazy error: NULL];
+    if (report != nil)
+        stackHash = plcrash_queued_report_stack_hash(report);
+    [report release];
+
+    @synchronized (self) {
+        const char *indexPath = [[self queuedCrashReportIndexPath] fileSystemRepresentation];
+
+        /* Index any reports queued prior to the index' creation before appending our own */
+        if (access(indexPath, F_OK) != 0)
+            [self rebuildQueuedCrashReportIndex];
+
+        if (![fm moveItemAtPath: reportPath toPath: path error: outError])
+            return NO;
+
+        plcrash_queued_report_record_t record;
+        if (plcrash_queued_report_record_init(&record, [name UTF8String], PLCRASH_QUEUED_REPORT_STATE_PENDING, timestamp, size, stackHash) != PLCRASH_ESUCCESS ||
+            plcrash_queued_report_index_append(indexPath, &record) != PLCRASH_ESUCCESS)
+        {
+            /* Discard the now incomplete index; it will be rebuilt from the queued report directory on next use */
+            NSDEBUG(@"Could not index queued crash report %@", path);
+            unlink(indexPath);
+        }
+
+        /* Suppress later crashes duplicating this report */
+        if (_enabled)
+            [self publishQueuedStackHashes];
+    }
+
+    return YES;
+}
+
+/**
+ * Asynchronously process the pending crash report on a background queue, performing each of the steps
+ * requested in @a options -- symbolication, loading, formatting, and queueing or purging the report -- off the
+ * calling thread. This allows the pending report to be handled at launch without delaying the application's
+ * startup.
+ *
+ * Requests are processed serially, in the order submitted, along with those of
+ * symbolicatePendingCrashReportWithCompletionHandler: and hasPendingCrashReportWithCompletionHandler:.
+ *
+ * @param options The processing steps to be performed.
+ * @param handler The block to be called on the main queue once processing has completed. If no report is pending,
+ * @a report, @a text, and @a error will all be nil. If processing failed, @a error will describe the failure, and
+ * the pending report will be left in place. @a text is only provided if PLCrashReporterProcessingOptionFormat was
+ * requested. May be nil.
+ */
+- (void) processPendingCrashReportWithOptions: (PLCrashReporterProcessingOptions) options
+                            completionHandler: (void (^)(PLCrashReport *report, NSString *text, NSError *error)) handler
+{
+    [self scheduleProcessingBlock: ^{
+        NSError *error = nil;
+        PLCrashReport *report = nil;
+        NSString *text = nil;
+
+        if ([self hasPendingCrashReport]) {
+            /* Symbolication failure is non-fatal; the unsymbolicated report remains usable */
+            if ((options & PLCrashReporterProcessingOptionSymbolicate) && ![self symbolicatePendingCrashReportAndReturnError: &error])
+                NSDEBUG(@"Could not symbolicate the pending crash report: %@", error);
+            error = nil;
+
+            report = [self loadPendingCrashReportAndReturnError: &error];
+
+            if (report != nil && (options & PLCrashReporterProcessingOptionFormat))
+                text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: PLCrashReportTextFormatiOS];
+
+            if (report != nil && (options & PLCrashReporterProcessingOptionQueue)) {
+                if (![self queuePendingCrashReportAndReturnError: &error])
+                    report = nil;
+            } else if (report != nil && (options & PLCrashReporterProcessingOptionPurge)) {
+                if (![self purgePendingCrashReportAndReturnError: &error])
+                    report = nil;
+            }
+
+            if (report == nil)
+                text = nil;
+        }
+
+        /* The results are autoreleased within the processing block's pool */
+        [report retain];
+        [text retain];
+        [error retain];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (handler != nil)
+                handler(report, text, error);
+            [report release];
+            [text release];
+            [error release];
+        });
+    }];
+}
+
+
+/**
+ * Return an enumerator over all queued crash reports, in the order in which they were queued. Each report
+ * is memory-mapped and lazily decoded (see PLCrashReportDecodingOptionLazy) only when it is returned by the
+ * enumerator, allowing a large queue to be processed without loading every report at once. Reports that
+ * can not be decoded are skipped.
+ *
+ * The queue is listed from the queued report index, rather than by enumerating the queued report directory.
+ *
+ * To bound memory use, callers should release each report (eg, by draining an autorelease pool) prior to
+ * fetching the next.
+ *
+ * @return An enumerator of PLCrashReport instances.
+ */
+- (NSEnumerator *) queuedCrashReportEnumerator {
+    return [[[PLCrashReporterQueuedReportEnumerator alloc] initWithDirectory: [self queuedCrashReportDirectory]
+                                                                          identifiers: [self queuedCrashReportIdentifiers]] autorelease];
+}
+
+
+/**
+ * Pack all queued crash reports, in the order in which they were queued, into a single PLCrashReportBundle, allowing
+ * the queue to be submitted in a single request. The queued reports are not modified, and should be purged once the
+ * bundle has been submitted.
+ *
+ * @param compress If YES, each queued report that is not already compressed will be compressed in the bundle.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the bundle could not be created. If no error occurs, this parameter
+ * will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the bundle data, or nil on error. If no reports are queued, an empty bundle is returned.
+ */
+- (NSData *) queuedCrashReportBundleCompressingReports: (BOOL) compress error: (NSError **) outError {
+    NSString *directory = [self queuedCrashReportDirectory];
+    NSMutableArray *reports = [NSMutableArray array];
+
+    for (NSString *identifier in [self queuedCrashReportIdentifiers]) {
+        NSString *path = [[directory stringByAppendingPathComponent: identifier] stringByAppendingPathExtension: PLCRASH_QUEUED_REPORT_EXTENSION];
+        NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: NULL];
+        if (data == nil) {
+            NSDEBUG(@"Could not read queued crash report %@", path);
+            continue;
+        }
+
+        [reports addObject: data];
+    }
+
+    return [PLCrashReportBundle bundleDataWithReportData: reports compress: compress error: outError];
+}
+
+
+/**
+ * Purge all queued crash reports.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the queued crash reports could not be
+ * purged. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) purgeQueuedCrashReportsAndReturnError: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *directory = [self queuedCrashReportDirectory];
+
+    @synchronized (self) {
+        const char *indexPath = [[self queuedCrashReportIndexPath] fileSystemRepresentation];
+
+        for (NSString *identifier in [self queuedCrashReportIdentifiers]) {
+            NSString *path = [[directory stringByAppendingPathComponent: identifier] stringByAppendingPathExtension: PLCRASH_QUEUED_REPORT_EXTENSION];
+            if (![fm removeItemAtPath: path error: outError] && [fm fileExistsAtPath: path]) {
+                /* Discard the index, which no longer reflects the directory contents; it will be rebuilt on next use */
+                unlink(indexPath);
+                return NO;
+            }
+        }
+
+        if (access(indexPath, F_OK) == 0 && plcrash_queued_report_index_write(indexPath, NULL, 0) != PLCRASH_ESUCCESS)
+            unlink(indexPath);
+
+        /* The occurrences of the purged reports are no longer meaningful */
+        unlink([[self queuedCrashReportOccurrencePath] fileSystemRepresentation]);
+        if (_enabled)
+            [self publishQueuedStackHashes];
+    }
+
+    return YES;
+}
+
+/**
+ * Return the number of crashes recorded as duplicates of @a report, rather than written as new reports. Duplicates
+ * are only recorded if enabled via PLCrashReporterConfig::shouldSuppressDuplicateCrashes, and only for reports that
+ * were queued via queuePendingCrashReportAndReturnError: prior to the duplicate crash.
+ *
+ * @param report A queued crash report, as returned by queuedCrashReportEnumerator.
+ *
+ * @return Returns the number of recorded duplicates of @a report, or 0 if none are available.
+ */
+- (NSUInteger) duplicateCrashCountForReport: (PLCrashReport *) report {
+    uint64_t hash = plcrash_queued_report_stack_hash(report);
+    if (hash == 0)
+        return 0;
+
+    NSData *data;
+    @synchronized (self) {
+        data = [NSData dataWithContentsOfFile: [self queuedCrashReportOccurrencePath] options: NSDataReadingMappedIfSafe error: NULL];
+    }
+
+    /* Any trailing partial record is ignored */
+    const plcrash_queued_report_occurrence_t *occurrences = [data bytes];
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < [data length] / sizeof(*occurrences); i++) {
+        if (occurrences[i].magic != PLCRASH_QUEUED_REPORT_OCCURRENCE_MAGIC || occurrences[i].version != PLCRASH_QUEUED_REPORT_OCCURRENCE_VERSION)
+            continue;
+
+        if (occurrences[i].stack_hash == hash)
+            count++;
+    }
+
+    return count;
+}
+
+/**
+ * Purge all recorded duplicate crash occurrences. Applications should call this method once the duplicate counts of
+ * the queued reports have been submitted.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the occurrences could not be purged. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be
+ * provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) purgeDuplicateCrashOccurrencesAndReturnError: (NSError **) outError {
+    @synchronized (self) {
+        if (unlink([[self queuedCrashReportOccurrencePath] fileSystemRepresentation]) != 0 && errno != ENOENT) {
+            plcrash_populate_posix_error(outError, errno, @"Could not remove the duplicate crash occurrences");
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+
+/**
+ * Enable the crash reporter. Once called, all application crashes will
+ * result in a crash report being written prior to application exit.
+ *
+ * @return Returns YES on success, or NO if the crash reporter could
+ * not be enabled.
+ *
+ * @par Registering Multiple Reporters
+ *
+ * Only one PLCrashReporter instance may be enabled in a process; attempting to enable an additional instance
+ * will return NO, and the reporter will not be enabled. This restriction may be removed in a future release.
+ */
+- (BOOL) enableCrashReporter {
+    return [self enableCrashReporterAndReturnError: nil];
+}
+
+
+
+/**
+ * Enable the crash reporter. Once called, all application crashes will
+ * result in a crash report being written prior to application exit.
+ *
+ * This method must only be invoked once. Further invocations will throw
+ * a PLCrashReporterException.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error in the PLCrashReporterErrorDomain indicating why the Crash Reporter
+ * could not be enabled. If no error occurs, this parameter will be left unmodified. You may
+ * specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the crash reporter could
+ * not be enabled.
+ *
+ * @par Registering Multiple Reporters
+ *
+ * Only one PLCrashReporter instance may be enabled in a process; attempting to enable an additional instance
+ * will return NO and a PLCrashReporterErrorResourceBusy error, and the reporter will not be enabled.
+ * This restriction may be removed in a future release.
+ */
+- (BOOL) enableCrashReporterAndReturnError: (NSError **) outError {
+    return [self enableCrashReporterDeferringSetup: NO error: outError];
+}
+
+/**
+ * Enable the crash reporter, deferring the more expensive parts of its setup. The crash handlers are installed
+ * before this method returns; fetching the host and process information, creating the crash report directory,
+ * mapping the report file, and locating the shared cache symbols are then performed on a background queue.
+ *
+ * A crash that occurs before the deferred setup completes will still be reported, but the report will omit the host
+ * and process information that had not yet been fetched.
+ *
+ * This method must only be invoked once. Further invocations will throw
+ * a PLCrashReporterException.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error in the PLCrashReporterErrorDomain indicating why the Crash Reporter
+ * could not be enabled. If no error occurs, this parameter will be left unmodified. You may
+ * specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the crash reporter could
+ * not be enabled.
+ *
+ * @sa PLCrashReporter::enableCrashReporterAndReturnError:
+ */
+- (BOOL) enableCrashReporterWithDeferredSetupAndReturnError: (NSError **) outError {
+    return [self enableCrashReporterDeferringSetup: YES error: outError];
+}
+
+/**
+ * @internal
+ *
+ * Enable the crash reporter.
+ *
+ * @param deferSetup If YES, the writer's host information, the crash report directory, the mapped report file, and
+ * the symbol standby cache are set up from a background queue after the crash handlers have been installed.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error in the PLCrashReporterErrorDomain indicating why the Crash Reporter
+ * could not be enabled.
+ *
+ * @return Returns YES on success, or NO if the crash reporter could not be enabled.
+ */
+- (BOOL) enableCrashReporterDeferringSetup: (BOOL) deferSetup error: (NSError **) outError {
+    /* Prevent enabling more than one crash reporter, process wide. We can not support multiple chained reporters
+     * due to the use of NSUncaughtExceptionHandler (it doesn't support chaining or assocation of context with the callbacks), as
+     * well as our legacy approach of deregistering any signal handlers upon the first signal. Once PLCrashUncaughtExceptionHandler is
+     * implemented, and we support double-fault handling without resetting the signal handlers, we can support chaining of multiple
+     * crash reporters. */
+    {
+        static BOOL enforceOne = NO;
+        pthread_mutex_t enforceOneLock = PTHREAD_MUTEX_INITIALIZER;
+        pthread_mutex_lock(&enforceOneLock); {
+            if (enforceOne) {
+                pthread_mutex_unlock(&enforceOneLock);
+                plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"A PLCrashReporter instance has already been enabled", nil);
+                return NO;
+            }
+            enforceOne = YES;
+        } pthread_mutex_unlock(&enforceOneLock);
+    }
+    
+    plcrash_error_t err;
+
+    /* Check for programmer error */
+    if (_enabled)
+        [NSException raise: PLCrashReporterException format: @"The crash reporter has alread been enabled"];
+
+    /* Create the directory tree */
+    if (!deferSetup && ![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    /*
+     * Set up the signal handler context.
+     */
+
+
+    /* The shared report slots. When available, these take the place of our own pre-sized report file and write
+     * buffer; reports are only written to our own data directory should all slots be in use. This is non-fatal. */
+    if (_config.sharedReportContainerPath != nil) {
+        NSString *slotsPath = [self sharedReportSlotsPath];
+        plcrash_async_report_slots_t *slots = malloc(sizeof(*slots)); // NOTE: would leak if this were not a singleton struct
+        if ([[NSFileManager defaultManager] createDirectoryAtPath: [slotsPath stringByDeletingLastPathComponent] withIntermediateDirectories: YES attributes: nil error: NULL] &&
+            plcrash_nasync_report_slots_open(slots, [slotsPath fileSystemRepresentation], SHARED_REPORT_SLOT_COUNT, MAX_REPORT_BYTES) == PLCRASH_ESUCCESS)
+        {
+            signal_handler_context.report_slots = slots;
+        } else {
+            NSDEBUG(@"Could not open the shared report slots at %@", slotsPath);
+            free(slots);
+        }
+    }
+
+    /* The pre-sized, memory-mapped report file. If it can't be created, we fall back on writing the report via write().
+     * When setup is deferred, the file is mapped by -completeDeferredSetup. */
+    NSString *mappedPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_MAPPED_CRASHREPORT];
+    signal_handler_context.mapped_path = strdup([mappedPath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+    if (deferSetup || signal_handler_context.report_slots != NULL || !plcrash_map_report_file(signal_handler_context.mapped_path, MAX_REPORT_BYTES, _config.reportFilePreallocationSize > 0, &signal_handler_context.mapped_fd, &signal_handler_context.mapped_report))
+        signal_handler_context.mapped_report = NULL;
+
+    /* The report write buffer, used if the mapped report is unavailable; this must be allocated prior to the crash. When
+     * setup is deferred, the buffer is always allocated, as it will be used until the mapped report is published. It
+     * is not required when writing to the shared report slots. */
+    BOOL needsWriteBuffer = (signal_handler_context.mapped_report == NULL && signal_handler_context.report_slots == NULL && _config.writeBufferSize > 0);
+
+    /* The pre-crash page-guarded allocator, sized to include the write buffer only if it is to be allocated */
+    err = plcrash_async_allocator_create(&signal_handler_context._precrash_allocator, PAGE_SIZE + (needsWriteBuffer ? _config.writeBufferSize : 0)); // NOTE: would leak if this were not a singleton struct
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"An unexpected error occured allocating our page-guarded allocator", nil);
+        return NO;
+    }
+
+    if (needsWriteBuffer) {
+        err = plcrash_async_allocator_alloc(signal_handler_context._precrash_allocator, &signal_handler_context.write_buffer, _config.writeBufferSize); // NOTE: would leak if this were not a singleton struct
+        if (err != PLCRASH_ESUCCESS) {
+            plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"An unexpected error occured allocating the crash report write buffer", nil);
+            return NO;
+        }
+        signal_handler_context.write_buffer_size = _config.writeBufferSize;
+    }
+
+    /* File preallocation and sync policy */
+    signal_handler_context.preallocation_size = (off_t) MIN(_config.reportFilePreallocationSize, MAX_REPORT_BYTES);
+    signal_handler_context.checksum = _config.shouldChecksumReports;
+    switch (_config.fileSyncPolicy) {
+        case PLCrashReporterFileSyncPolicyNone:
+            signal_handler_context.sync_policy = PLCRASH_ASYNC_FILE_SYNC_NONE;
+            break;
+        case PLCrashReporterFileSyncPolicyFSync:
+            signal_handler_context.sync_policy = PLCRASH_ASYNC_FILE_SYNC_FSYNC;
+            break;
+        case PLCrashReporterFileSyncPolicyFullFSync:
+            signal_handler_context.sync_policy = PLCRASH_ASYNC_FILE_SYNC_FULLFSYNC;
+            break;
+    }
+
+    /* Crash loop detection. The persisted launch crash count is reset once this launch survives the launch interval. */
+    if (_config.crashLoopThreshold > 0) {
+        NSString *statePath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_CRASH_LOOP_STATE];
+        NSString *tmpPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_CRASH_LOOP_STATE_TMP];
+        const char *crashLoopPath = strdup([statePath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+        const char *crashLoopTmpPath = strdup([tmpPath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+
+        plcrash_crash_loop_read_state(crashLoopPath, &signal_handler_context.crash_loop_state);
+        signal_handler_context.crash_loop_threshold = (uint32_t) MIN(_config.crashLoopThreshold, UINT32_MAX);
+        signal_handler_context.crash_loop_tmp_path = crashLoopTmpPath;
+
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        uint64_t interval = (uint64_t) (CRASH_LOOP_LAUNCH_INTERVAL * NSEC_PER_SEC) * timebase.denom / timebase.numer;
+        signal_handler_context.launch_deadline = mach_absolute_time() + interval;
+
+        /* The path is set last; the crash handler ignores crash loops until it is non-NULL */
+        signal_handler_context.crash_loop_path = crashLoopPath;
+
+        if (signal_handler_context.crash_loop_state.launch_crash_count > 0) {
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (CRASH_LOOP_LAUNCH_INTERVAL * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+                plcrash_crash_loop_state_t state = { .magic = CRASH_LOOP_STATE_MAGIC, .launch_crash_count = 0, .stack_hash = 0 };
+                plcrash_crash_loop_write_state(crashLoopPath, crashLoopTmpPath, &state);
+            });
+        }
+    }
+
+    /* Duplicate crash suppression. The queued report hashes are published once the occurrence path has been set. */
+    if (_config.shouldSuppressDuplicateCrashes) {
+        signal_handler_context.occurrence_path = strdup([[self queuedCrashReportOccurrencePath] fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+        [self publishQueuedStackHashes];
+    }
+
+    /* The report compressor; its buffers must also be allocated prior to the crash */
+    if (_config.shouldCompressReports) {
+        err = plcrash_nasync_compressor_new(&signal_handler_context.compressor, signal_handler_context._precrash_allocator); // NOTE: would leak if this were not a singleton struct
+        if (err != PLCRASH_ESUCCESS) {
+            plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"An unexpected error occured allocating the crash report compressor", nil);
+            return NO;
+        }
+    }
+
+    /* Saved path to the output file */
+    signal_handler_context.path = strdup([[self crashReportPath] UTF8String]); // NOTE: would leak if this were not a singleton struct
+    
+    /* The dynamic loader reference required for image list reading. */
+    err = plcrash_nasync_dynloader_new(&signal_handler_context.dynamic_loader, signal_handler_context._precrash_allocator, mach_task_self()); // NOTE: would leak if this were not a singleton struct
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCRashReporterErrorNotFound, @"Failed fetch the dyld image info for the current process", nil);
+        return NO;
+    }
+
+    /* Maintain the image list incrementally, rather than re-reading and re-parsing all images at crash time. This is
+     * non-fatal; on failure, the loader will read the image list from dyld. */
+    if ((err = plcrash_nasync_dynloader_enable_image_monitor(signal_handler_context.dynamic_loader)) != PLCRASH_ESUCCESS)
+        NSDEBUG("Could not enable the dynamic loader image monitor: %d", err);
+
+    /* If enabled, cache each image's indexes across launches. The cache must be enabled prior to the index builds
+     * below. This is non-fatal; on failure, the indexes are simply rebuilt on each launch. */
+    BOOL cacheIndexes = NO;
+    if (err == PLCRASH_ESUCCESS && _config.shouldCacheImageIndexes) {
+        NSString *cachePath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_IMAGE_INDEX_CACHE_DIR];
+        if ([[NSFileManager defaultManager] createDirectoryAtPath: cachePath withIntermediateDirectories: YES attributes: nil error: NULL]) {
+            if ((err = plcrash_nasync_dynloader_enable_index_cache(signal_handler_context.dynamic_loader, [cachePath fileSystemRepresentation])) == PLCRASH_ESUCCESS) {
+                cacheIndexes = YES;
+            } else {
+                NSDEBUG("Could not enable the image index cache: %d", err);
+            }
+        } else {
+            NSDEBUG("Could not create the image index cache directory %@", cachePath);
+        }
+        err = PLCRASH_ESUCCESS;
+    }
+
+    /* When ObjC symbolication or index caching is enabled, index each image in the background, allowing crash-time
+     * lookups to avoid parsing all class metadata (and, if caching, scanning each symbol table). This is also
+     * non-fatal; lookups fall back on parsing when no index is available. */
+    if (err == PLCRASH_ESUCCESS && (cacheIndexes || ([self writerSymbolicationStrategy] & PLCrashReporterSymbolicationStrategyObjC))) {
+        if ((err = plcrash_nasync_dynloader_enable_objc_method_index(signal_handler_context.dynamic_loader)) != PLCRASH_ESUCCESS)
+            NSDEBUG("Could not enable the ObjC method index: %d", err);
+    }
+    
+    /* Crash log writer instance */
+    assert(_applicationIdentifier != nil);
+    assert(_applicationVersion != nil);
+    if (deferSetup) {
+        plcrash_log_writer_init_deferred(&signal_handler_context.writer, _applicationIdentifier, _applicationVersion, _applicationMarketingVersion, [self mapToAsyncSymbolicationStrategy: [self writerSymbolicationStrategy]], false);
+    } else {
+        plcrash_log_writer_init(&signal_handler_context.writer, _applicationIdentifier, _applicationVersion, _applicationMarketingVersion, [self mapToAsyncSymbolicationStrategy: [self writerSymbolicationStrategy]], false);
+    }
+
+    /* Size the crash-time arena and class cache from the memory used by previous reports. This must precede any
+     * other writer configuration, as the writer's arena is replaced. */
+    if (_config.shouldAdaptCrashMemorySizing) {
+        NSString *statePath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_MEMORY_SIZING_STATE];
+        NSString *tmpPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_MEMORY_SIZING_STATE_TMP];
+        NSString *liveTmpPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_MEMORY_SIZING_STATE_LIVE_TMP];
+        plcrash_memory_sizing_state_t *state = &signal_handler_context.memory_sizing_state;
+
+        plcrash_memory_sizing_read_state([statePath fileSystemRepresentation], state);
+        signal_handler_context.sized_arena_bytes = round_page(plcrash_memory_sizing_p99(state->arena_bytes, state->count));
+        signal_handler_context.sized_class_capacity = plcrash_memory_sizing_p99(state->objc_class_count, state->count);
+
+        if (signal_handler_context.sized_arena_bytes > 0) {
+            if ((err = plcrash_log_writer_set_allocator_size(&signal_handler_context.writer, signal_handler_context.sized_arena_bytes)) != PLCRASH_ESUCCESS)
+                NSDEBUG("Could not resize the crash-time allocator: %d", err);
+        }
+
+        signal_handler_context.memory_sizing_tmp_path = strdup([tmpPath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+        signal_handler_context.memory_sizing_live_tmp_path = strdup([liveTmpPath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+
+        /* The path is set last; reports are not recorded until it is non-NULL */
+        OSMemoryBarrier();
+        signal_handler_context.memory_sizing_path = strdup([statePath fileSystemRepresentation]); // NOTE: would leak if this were not a singleton struct
+    }
+
+    /* Locate the shared cache's local symbols prior to any crash */
+    if (!deferSetup && ([self writerSymbolicationStrategy] & PLCrashReporterSymbolicationStrategySharedCache))
+        plcrash_log_writer_set_shared_cache_info(&signal_handler_context.writer, plcr_shared_cache_info());
+
+    /* Unique symbol names within the report; these are otherwise repeated for every frame */
+    if ([self writerSymbolicationStrategy] != PLCrashReporterSymbolicationStrategyNone)
+        plcrash_log_writer_set_symbol_interning(&signal_handler_context.writer, true);
+
+    /* Apply the configured frame limits */
+    plcrash_log_writer_set_frame_limits(&signal_handler_context.writer, (uint32_t) MIN(_config.maxThreadFrames, UINT32_MAX),
+                                        (uint32_t) MIN(_config.maxReportFrames, UINT32_MAX), (uint32_t) MIN(_config.tailThreadFrames, UINT32_MAX));
+
+    /* Bound the time spent writing the report */
+    if (_config.writeTimeBudget > 0)
+        plcrash_log_writer_set_time_budget(&signal_handler_context.writer, (uint64_t) (_config.writeTimeBudget * NSEC_PER_SEC));
+
+    /* Only write full records for the images referenced by the report */
+    if (_config.shouldCompactUnreferencedImages)
+        plcrash_log_writer_set_compact_images(&signal_handler_context.writer, true);
+
+    /* Recover frames that can not otherwise be unwound */
+    if (_config.shouldScanStacks)
+        plcrash_log_writer_set_stack_scan(&signal_handler_context.writer, true);
+
+    /* Annotate crashed thread registers with the symbols they reference */
+    if (_config.shouldAnnotateRegisters)
+        plcrash_log_writer_set_register_annotation(&signal_handler_context.writer, true);
+
+    /* Write registers as a compact register state */
+    if (_config.shouldWriteCompactRegisterState)
+        plcrash_log_writer_set_register_state(&signal_handler_context.writer, true);
+
+    /* Write identical thread stacks once */
+    if (_config.shouldCollapseIdenticalThreadStacks)
+        plcrash_log_writer_set_collapse_stacks(&signal_handler_context.writer, true);
+
+    /* Write thread frames as packed arrays */
+    if (_config.shouldPackThreadFrames)
+        plcrash_log_writer_set_packed_frames(&signal_handler_context.writer, true);
+
+    /* Write crash reports in the version 2 format */
+    if (_config.shouldWriteV2Reports)
+        plcrash_log_writer_set_v2_format(&signal_handler_context.writer, true);
+
+    /* Unwind idle threads shallowly */
+    if (_config.idleThreadFrames > 0)
+        plcrash_log_writer_set_idle_thread_frames(&signal_handler_context.writer, (uint32_t) MIN(_config.idleThreadFrames, UINT32_MAX));
+
+    /* Select cheaper options for reports that would otherwise be truncated */
+    if (_config.shouldFitReportsToSizeLimit)
+        plcrash_log_writer_set_size_policy(&signal_handler_context.writer, true);
+
+    /* Record threads that crash while the report is being written */
+    plcrash_log_writer_set_secondary_crashes(&signal_handler_context.writer, &secondary_crashes);
+
+    /* Write any registered attachments */
+    plcrash_log_writer_set_attachments(&signal_handler_context.writer, &attachments);
+
+    /* Record the cost of writing the report */
+    if (_config.shouldRecordWriterStatistics)
+        plcrash_log_writer_set_instrumentation(&signal_handler_context.writer, true);
+
+    /* Record each thread's scheduling state and CPU usage */
+    if (_config.shouldRecordThreadMetadata)
+        plcrash_log_writer_set_thread_metadata(&signal_handler_context.writer, true);
+
+    /* Capture the crashed thread's stack and register-referenced memory */
+    if (_config.memoryCaptureBudget > 0) {
+        plcrash_log_writer_set_memory_capture(&signal_handler_context.writer, _config.memoryCaptureBudget,
+                                              MEMORY_CAPTURE_REGISTER_BYTES, _config.memoryCaptureBudget);
+    }
+
+    /* Buffer debug output while writing a report, flushing it once the report is complete */
+    if (_config.debugLogBufferSize > 0) {
+        if ((err = plcrash_nasync_debug_log_init(&signal_handler_context.debug_log, _config.debugLogBufferSize)) == PLCRASH_ESUCCESS)
+            plcrash_log_writer_set_debug_log(&signal_handler_context.writer, &signal_handler_context.debug_log, _config.shouldEmbedDebugLog);
+        else
+            NSDEBUG("Could not allocate the debug output buffer, debug output will be unbuffered: %d", err);
+    }
+
+    /* Bound the memory retained by the crash-path caches; this must precede preparation of the standby cache */
+    if (_config.cacheMemoryLimit > 0)
+        plcrash_log_writer_set_cache_budget(&signal_handler_context.writer, _config.cacheMemoryLimit);
+
+    /* Reserve storage for an uncaught exception, allowing it to be captured without allocating; on failure, the
+     * exception handler falls back on allocating storage at the time of the exception */
+    if ((err = plcrash_log_writer_reserve_exception(&signal_handler_context.writer, signal_handler_context.writer.max_thread_frames)) != PLCRASH_ESUCCESS)
+        NSDEBUG("Could not reserve uncaught exception storage: %d", err);
+
+    /* The breadcrumb ring. When setup is deferred, the ring is created by -completeDeferredSetup. */
+    if (!deferSetup)
+        [self enableBreadcrumbs];
+
+    /* Reserve spare allocator pages; failure is non-fatal, as the allocator can still fall back on vm_allocate() */
+    if ((err = plcrash_log_writer_set_allocator_reserve(&signal_handler_context.writer, CRASH_ALLOCATOR_RESERVE_REGIONS)) != PLCRASH_ESUCCESS)
+        NSDEBUG("Could not pre-allocate crash-time allocator reserve: %d", err);
+
+    /* Place the writer in hot standby, moving symbol cache setup out of the crash handler. The ObjC class cache
+     * is sized from the currently registered classes, or from the use observed by previous reports. */
+    if (!deferSetup && signal_handler_context.writer.symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
+        if ((err = plcrash_log_writer_prepare_standby(&signal_handler_context.writer, [self standbyClassCapacity])) != PLCRASH_ESUCCESS)
+            NSDEBUG("Could not prepare the standby symbol cache: %d", err);
+    }
+
+    /* Crash-path memory; when setup is deferred, this is performed by -completeDeferredSetup */
+    if (!deferSetup && _config.shouldPrefaultCrashMemory)
+        [self prefaultCrashMemory];
+    
+    
+
+    /*
+     * Enable the signal handler
+     */
+    switch (_config.signalHandlerType) {
+        case PLCrashReporterSignalHandlerTypeBSD:
+            for (size_t i = 0; i < monitored_signals_count; i++) {
+                if (![[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: monitored_signals[i] callback: &signal_handler_callback context: &signal_handler_context error: outError])
+                    return NO;
+            }
+            break;
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+        case PLCrashReporterSignalHandlerTypeMach: {
+            /* We still need to use signal handlers to catch SIGABRT in-process. The kernel sends an EXC_CRASH mach exception
+             * to denote SIGABRT termination. In that case, catching the Mach exception in-process leads to process deadlock
+             * in an uninterruptable wait. Thus, we fall back on BSD signal handlers for SIGABRT, and do not register for
+             * EXC_CRASH. */
+            if (![[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: SIGABRT callback: &signal_handler_callback context: &signal_handler_context error: outError])
+                return NO;
+            
+            /* Enable the server. */
+            _machServer = [self enableMachExceptionServerWithPreviousPortSet: &_previousMachPorts
+                                                                    callback: &mach_exception_callback
+                                                                     context: &signal_handler_context
+                                                                       error: outError];
+            if (_machServer == nil)
+                return NO;
+
+            /* Forward exceptions to the previously registered ports prior to issuing our callback */
+            [_machServer setForwardPortSet: &signal_handler_context.port_set];
+            
+            /* Acquire references to the autoreleased values */
+            [_machServer retain];
+            [_previousMachPorts retain];
+            
+            /*
+             * MEMORY WARNING: To ensure that our instance survives for the lifetime of the callback registration,
+             * we retain it here. This is necessary to ensure that the Mach exception server instance and previous port set
+             * survive for the lifetime of the callback. Since there's currently no support for *deregistering* a crash reporter,
+             * this simply results in the reporter living forever.
+             */
+            [self retain];
+            
+            /*
+             * Save the previous ports. There's a race condition here, in that an exception that is delivered before (or during)
+             * setting the previous port values will see a fully and/or partially configured port set. This could be an issue
+             * when interoperating with managed runtimes, where NULL dereferences may trigger exception handling
+             * in a common runtime case.
+             *
+             * TODO: Investigate use of (async-safe) locking to close the window in which an exception would not be safely forwarded.
+             * This issue also exists (and is noted with a TODO) in PLCrashSignalHandler.
+             */
+            signal_handler_context.port_set = [_previousMachPorts asyncSafeRepresentation];
+            break;
+        }
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+    }
+
+    /* Set the uncaught exception handler */
+    NSSetUncaughtExceptionHandler(&uncaught_exception_handler);
+
+    /* Complete the remaining setup now that the handlers are in place; the reporter is never deregistered, and
+     * the block's reference to self will not outlive it. */
+    if (deferSetup) {
+        plcrash_error_t err = plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_UTILITY, 0, DISPATCH_TIME_FOREVER, ^{
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            [self completeDeferredSetup];
+            [pool drain];
+        }, NULL);
+
+        /* The handlers are already in place; only the remaining setup is lost */
+        if (err != PLCRASH_ESUCCESS)
+            NSDEBUG(@"Could not schedule the deferred crash reporter setup: %d", err);
+    }
+
+    /* Success */
+    _enabled = YES;
+    return YES;
+}
+
+/**
+ * @internal
+ *
+ * Perform the setup deferred by -enableCrashReporterWithDeferredSetupAndReturnError:. Each step is published to the
+ * crash handler as it completes; a crash occuring before (or during) this method will be written with whatever has
+ * been published so far.
+ */
+- (void) completeDeferredSetup {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    plcrash_error_t err;
+    NSError *error = nil;
+
+    /* Host and process information */
+    if ((err = plcrash_log_writer_populate_host_info(&signal_handler_context.writer)) != PLCRASH_ESUCCESS)
+        NSDEBUG(@"Could not fetch the host information: %d", err);
+
+    /* The directory tree; if this fails, the crash handler will attempt to create it at crash time */
+    if (![self populateCrashReportDirectoryAndReturnError: &error]) {
+        NSDEBUG(@"Could not create the crash report directory: %@", error);
+    } else {
+        /* The mapped report file, unless reports are written to the shared report slots; the descriptor must be visible
+         * before the mapping is published */
+        int mapped_fd;
+        void *mapped_report;
+        if (signal_handler_context.report_slots == NULL && plcrash_map_report_file(signal_handler_context.mapped_path, MAX_REPORT_BYTES, _config.reportFilePreallocationSize > 0, &mapped_fd, &mapped_report)) {
+            signal_handler_context.mapped_fd = mapped_fd;
+            OSMemoryBarrier();
+            signal_handler_context.mapped_report = mapped_report;
+        }
+
+        /* The breadcrumb ring */
+        [self enableBreadcrumbs];
+    }
+
+    /* Shared cache symbols, and the symbol standby cache */
+    if ([self writerSymbolicationStrategy] & PLCrashReporterSymbolicationStrategySharedCache)
+        plcrash_log_writer_set_shared_cache_info(&signal_handler_context.writer, plcr_shared_cache_info());
+
+    if (signal_handler_context.writer.symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
+        if ((err = plcrash_log_writer_prepare_standby(&signal_handler_context.writer, [self standbyClassCapacity])) != PLCRASH_ESUCCESS)
+            NSDEBUG(@"Could not prepare the standby symbol cache: %d", err);
+    }
+
+    /* Crash-path memory; this must follow the standby cache's preparation */
+    if (_config.shouldPrefaultCrashMemory)
+        [self prefaultCrashMemory];
+
+    [pool drain];
+}
+
+/**
+ * @internal
+ *
+ * Fault in and wire the memory touched by the crash handler -- the writer's scratch arena and standby class cache,
+ * the pre-crash allocator backing the write buffer and compressor, and the mapped report file -- and schedule a
+ * background pass advising the kernel that the symbol tables of all loaded images will be needed. Failures are
+ * non-fatal; the memory is simply faulted in at crash time.
+ */
+- (void) prefaultCrashMemory {
+    plcrash_error_t err;
+
+    if ((err = plcrash_log_writer_prefault(&signal_handler_context.writer, true)) != PLCRASH_ESUCCESS)
+        NSDEBUG(@"Could not wire the crash log writer's memory: %d", err);
+
+    if ((err = plcrash_nasync_allocator_prefault(signal_handler_context._precrash_allocator, true)) != PLCRASH_ESUCCESS)
+        NSDEBUG(@"Could not wire the pre-crash allocator's memory: %d", err);
+
+    /* Wiring the shared file mapping faults in its pages without dirtying them */
+    if (signal_handler_context.mapped_report != NULL && mlock(signal_handler_context.mapped_report, MAX_REPORT_BYTES) != 0)
+        NSDEBUG(@"Could not wire the mapped report: %s", strerror(errno));
+
+    /* Read ahead each image's __LINKEDIT symbol and string tables. Images loaded after this pass are not advised. */
+    plcrash_async_dynloader_t *loader = signal_handler_context.dynamic_loader;
+    plcrash_async_allocator_t *allocator = signal_handler_context._precrash_allocator;
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, DISPATCH_TIME_FOREVER, ^{
+        plcrash_async_image_list_t *images;
+        if (plcrash_async_dynloader_read_image_list(loader, allocator, &images) != PLCRASH_ESUCCESS)
+            return;
+
+        for (size_t i = 0; i < plcrash_async_image_list_count(images); i++)
+            plcrash_nasync_macho_advise_linkedit(plcrash_async_image_list_get_image(images, i));
+
+        plcrash_async_image_list_free(images);
+    }, NULL);
+}
+
+/**
+ * @internal
+ *
+ * Create the breadcrumb ring, if enabled by the configuration, and publish it to the crash handler. Any ring left by
+ * the previous session is first moved to PLCRASH_PREVIOUS_BREADCRUMBS. Must be called once the crash report
+ * directory has been created.
+ */
+- (void) enableBreadcrumbs {
+    if (_config.breadcrumbCapacity == 0)
+        return;
+
+    NSString *path = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_BREADCRUMBS];
+    NSString *previousPath = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_PREVIOUS_BREADCRUMBS];
+    if (rename([path fileSystemRepresentation], [previousPath fileSystemRepresentation]) != 0 && errno != ENOENT)
+        NSDEBUG(@"Could not preserve the previous breadcrumb file: %s", strerror(errno));
+
+    plcrash_async_breadcrumbs_t *ring = malloc(sizeof(*ring)); // NOTE: would leak if this were not a singleton struct
+    if (ring == NULL)
+        return;
+
+    plcrash_error_t err = plcrash_nasync_breadcrumbs_init(ring, [path fileSystemRepresentation], (uint32_t) MIN(_config.breadcrumbCapacity, UINT32_MAX), BREADCRUMB_ENTRY_BYTES);
+    if (err != PLCRASH_ESUCCESS) {
+        NSDEBUG(@"Could not create the breadcrumb ring: %d", err);
+        free(ring);
+        return;
+    }
+
+    /* The ring must be fully initialized before it is visible to appending threads or the crash handler */
+    OSMemoryBarrier();
+    _breadcrumbs = ring;
+    plcrash_log_writer_set_breadcrumbs(&signal_handler_context.writer, ring);
+}
+
+/**
+ * Record a breadcrumb, to be included in any subsequent crash report. Breadcrumbs are written to a fixed-size,
+ * memory-mapped ring without locking, and may be recorded from any thread.
+ *
+ * Breadcrumbs are only recorded if enabled via PLCrashReporterConfig::breadcrumbCapacity, and once the crash reporter
+ * has been enabled; otherwise, this method does nothing. Messages longer than 232 bytes, as encoded in UTF-8, are
+ * truncated.
+ *
+ * @param message The breadcrumb message.
+ */
+- (void) appendBreadcrumb: (NSString *) message {
+    plcrash_async_breadcrumbs_t *ring = _breadcrumbs;
+    if (ring == NULL)
+        return;
+
+    const char *utf8 = [message UTF8String];
+    if (utf8 == NULL)
+        return;
+
+    plcrash_async_breadcrumbs_append(ring, utf8, strlen(utf8));
+}
+
+/**
+ * Load the breadcrumbs recorded by the previous session. The breadcrumb ring is backed by a file, and its contents
+ * persist even if the previous session terminated without writing a crash report.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the breadcrumbs could not be loaded. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the previous session's breadcrumbs (PLCrashReportBreadcrumbInfo), oldest first, or nil if no
+ * breadcrumbs are available.
+ */
+- (NSArray *) loadPreviousSessionBreadcrumbsAndReturnError: (NSError **) outError {
+    NSString *path = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_PREVIOUS_BREADCRUMBS];
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: outError];
+    if (data == nil)
+        return nil;
+
+    NSArray *breadcrumbs = [PLCrashReportBreadcrumbInfo breadcrumbsWithRingData: data];
+    if (breadcrumbs == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"The previous breadcrumb file is invalid", nil);
+        return nil;
+    }
+
+    return breadcrumbs;
+}
+
+/**
+ * @internal
+ *
+ * Release the file mapping owned by the attachment @a name, if any. Must be called with attachments_lock held, after
+ * the attachment has been removed or replaced.
+ *
+ * A report being written concurrently may still read from the released mapping; the writer reads attachments without
+ * dereferencing them directly, and any bytes that are no longer mapped are zero-filled.
+ */
+static void plcr_attachment_release_mapping (const char *name) {
+    for (size_t i = 0; i < PLCRASH_LOG_MAX_ATTACHMENTS; i++) {
+        plcr_attachment_mapping_t *mapping = &attachment_mappings[i];
+        if (mapping->base == NULL || strcmp(mapping->name, name) != 0)
+            continue;
+
+        munmap(mapping->base, mapping->size);
+        mapping->base = NULL;
+        mapping->name[0] = '\0';
+    }
+}
+
+/**
+ * Register @a length bytes at @a address as an attachment named @a name, replacing any existing attachment of the same
+ * name. The memory is not copied; it is read when a report is written, and its contents at the time of the crash are
+ * written to the report's attachments (see PLCrashReport::attachments). Attachments are included in both crash reports
+ * and live reports.
+ *
+ * Registration is process-wide, and at most 8 attachments may be registered at once. The memory must remain allocated
+ * until the attachment is unregistered; if it is not readable at the time of the crash, it will be zero-filled.
+ *
+ * @param name The attachment name. Must be shorter than 64 bytes, as encoded in UTF-8.
+ * @param address The attachment's data.
+ * @param length The length of the attachment's data, in bytes. Must not exceed UINT32_MAX.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the attachment could not be registered. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the attachment could not be registered.
+ */
+- (BOOL) registerAttachmentNamed: (NSString *) name address: (const void *) address length: (NSUInteger) length error: (NSError **) outError {
+    const char *cname = [name UTF8String];
+    if (cname == NULL || strlen(cname) >= PLCRASH_LOG_ATTACHMENT_NAME_MAX || length > UINT32_MAX) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Invalid attachment name or length", nil);
+        return NO;
+    }
+
+    BOOL result;
+    pthread_mutex_lock(&attachments_lock); {
+        result = plcrash_log_attachments_add(&attachments, cname, (pl_vm_address_t) address, (uint32_t) length);
+        if (result)
+            plcr_attachment_release_mapping(cname);
+    } pthread_mutex_unlock(&attachments_lock);
+
+    if (!result)
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"The maximum number of attachments are already registered", nil);
+
+    return result;
+}
+
+/**
+ * Register @a length bytes of the file at @a path, starting at @a offset, as an attachment named @a name, replacing
+ * any existing attachment of the same name. The region is mapped shared and read-only, and is not copied; the file's
+ * contents at the time of the crash are written to the report. The mapping is retained until the attachment is
+ * unregistered or replaced.
+ *
+ * @param name The attachment name. Must be shorter than 64 bytes, as encoded in UTF-8.
+ * @param path The path of the file to be attached.
+ * @param offset The offset of the attached region within the file.
+ * @param length The length of the attached region, in bytes. Must not exceed UINT32_MAX.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the attachment could not be registered. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the attachment could not be registered.
+ *
+ * @sa registerAttachmentNamed:address:length:error:
+ */
+- (BOOL) registerAttachmentNamed: (NSString *) name path: (NSString *) path offset: (off_t) offset length: (NSUInteger) length error: (NSError **) outError {
+    const char *cname = [name UTF8String];
+    if (cname == NULL || strlen(cname) >= PLCRASH_LOG_ATTACHMENT_NAME_MAX || length == 0 || length > UINT32_MAX || offset < 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Invalid attachment name or file region", nil);
+        return NO;
+    }
+
+    int fd = open([path fileSystemRepresentation], O_RDONLY);
+    if (fd < 0) {
+        plcrash_populate_posix_error(outError, errno, @"Could not open the attachment file");
+        return NO;
+    }
+
+    /* Map the enclosing pages; the mapping remains valid once the descriptor is closed */
+    off_t page_offset = offset - (offset % PAGE_SIZE);
+    size_t size = (size_t) (offset - page_offset) + length;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, page_offset);
+    int mmap_errno = errno;
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        plcrash_populate_posix_error(outError, mmap_errno, @"Could not map the attachment file");
+        return NO;
+    }
+
+    BOOL result = NO;
+    pthread_mutex_lock(&attachments_lock); {
+        plcr_attachment_mapping_t *mapping = NULL;
+        for (size_t i = 0; i < PLCRASH_LOG_MAX_ATTACHMENTS && mapping == NULL; i++) {
+            if (attachment_mappings[i].base == NULL)
+                mapping = &attachment_mappings[i];
+        }
+
+        pl_vm_address_t address = (pl_vm_address_t) base + (pl_vm_address_t) (offset - page_offset);
+        if (mapping != NULL && plcrash_log_attachments_add(&attachments, cname, address, (uint32_t) length)) {
+            plcr_attachment_release_mapping(cname);
+
+            strlcpy(mapping->name, cname, sizeof(mapping->name));
+            mapping->base = base;
+            mapping->size = size;
+            result = YES;
+        }
+    } pthread_mutex_unlock(&attachments_lock);
+
+    if (!result) {
+        munmap(base, size);
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"The maximum number of attachments are already registered", nil);
+    }
+
+    return result;
+}
+
+/**
+ * Unregister the attachment named @a name. Any file mapping owned by the attachment is released.
+ *
+ * @param name The attachment name.
+ *
+ * @return Returns YES if the attachment was unregistered, or NO if no attachment named @a name was registered.
+ */
+- (BOOL) unregisterAttachmentNamed: (NSString *) name {
+    const char *cname = [name UTF8String];
+    if (cname == NULL)
+        return NO;
+
+    BOOL result;
+    pthread_mutex_lock(&attachments_lock); {
+        result = plcrash_log_attachments_remove(&attachments, cname);
+        if (result)
+            plcr_attachment_release_mapping(cname);
+    } pthread_mutex_unlock(&attachments_lock);
+
+    return result;
+}
+
+/**
+ * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
+ * This may be used to log current process state without actually crashing. The crash report data will be
+ * returned on success.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report.
+ *
+ * @return Returns nil if the crash report data could not be generated.
+ *
+ * @sa PLCrashReporter::generateLiveReportWithThread:exception:error:
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread {
+    return [self generateLiveReportWithThread: thread error: NULL];
+}
+
+/**
+ * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
+ * This may be used to log current process state without actually crashing. The crash report data will be
+ * returned on success.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the crash report could not be generated or loaded. If no
+ * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
+ * error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ *
+ * @sa PLCrashReporter::generateLiveReportWithThread:exception:error:
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread error: (NSError **) outError {
+    return [self generateLiveReportWithThread: thread exception: nil error: outError];
+}
+
+
+/* State and callback used by -generateLiveReportWithThread */
+struct plcr_live_report_context {
+    plcrash_log_writer_t *writer;
+    plcrash_async_dynloader_t *loader;
+    plcrash_async_file_t *file;
+    plcrash_log_signal_info_t *info;
+};
+static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *state, void *ctx) {
+    struct plcr_live_report_context *plcr_ctx = ctx;
+    return plcrash_log_writer_write(plcr_ctx->writer, pl_mach_thread_self(), plcr_ctx->loader, plcr_ctx->file, plcr_ctx->info, state);
+}
+
+
+/**
+ * @internal
+ *
+ * State retained across calls to -generateLiveReportWithThread:exception:error:, allowing repeated live reports to
+ * reuse an already initialized writer, dynamic loader, compressor, and symbol cache; only the thread states and
+ * frames must be fetched for each report.
+ */
+struct plcr_live_report_sampler {
+    /** Serializes use of the sampler; the writer may only be used to write one report at a time. */
+    pthread_mutex_t lock;
+
+    /** Allocator backing the dynamic loader and compressor. */
+    plcrash_async_allocator_t *allocator;
+
+    /** Dynamic loader instance. */
+    plcrash_async_dynloader_t *loader;
+
+    /** Report compressor, or NULL if reports should be written uncompressed. */
+    plcrash_async_compressor_t *compressor;
+
+    /** The configured writer; its standby symbol cache is retained across reports. */
+    plcrash_log_writer_t writer;
+
+    /** If true, @a writer has been initialized, and must be freed. */
+    bool writer_initialized;
+
+    /** The loader's image unload count at the time the writer's standby cache was prepared. */
+    uint32_t unload_count;
+
+    /** The session identifier written to the sampler's shared image lists. */
+    uint8_t image_list_session[16];
+
+    /** If true, a shared image list has been written for @a image_list_generation. */
+    bool has_image_list;
+
+    /** The generation of the most recently written shared image list. */
+    uint32_t image_list_generation;
+
+    /** Live trace state, or NULL if no trace sample has been generated. */
+    plcrash_log_trace_t *trace;
+
+    /** The next idle sampler, if this sampler is idle. See -lockLiveReportSamplerAndReturnError:. */
+    plcr_live_report_sampler_t *next_idle;
+};
+
+/**
+ * @internal
+ *
+ * Free all resources associated with @a sampler.
  */
-- (BOOL) enableCrashReporterAndReturnError: (NSError **) outError {
-    /* Prevent enabling more than one crash reporter, process wide. We can not support multiple chained reporters
-     * due to the use of NSUncaughtExceptionHandler (it doesn't support chaining or assocation of context with the callbacks), as
-     * well as our legacy approach of deregistering any signal handlers upon the first signal. Once PLCrashUncaughtExceptionHandler is
-     * implemented, and we support double-fault handling without resetting the signal handlers, we can support chaining of multiple
-     * crash reporters. */
-    {
-        static BOOL enforceOne = NO;
-        pthread_mutex_t enforceOneLock = PTHREAD_MUTEX_INITIALIZER;
-        pthread_mutex_lock(&enforceOneLock); {
-            if (enforceOne) {
-                pthread_mutex_unlock(&enforceOneLock);
-                plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"A PLCrashReporter instance has already been enabled", nil);
-                return NO;
-            }
-            enforceOne = YES;
-        } pthread_mutex_unlock(&enforceOneLock);
-    }
-    
-    plcrash_error_t err;
+static void plcr_live_report_sampler_free (plcr_live_report_sampler_t *sampler) {
+    if (sampler->trace != NULL)
+        plcrash_log_trace_free(sampler->trace);
 
-    /* Check for programmer error */
-    if (_enabled)
-        [NSException raise: PLCrashReporterException format: @"The crash reporter has alread been enabled"];
+    if (sampler->writer_initialized)
+        plcrash_log_writer_free(&sampler->writer);
 
-    /* Create the directory tree */
-    if (![self populateCrashReportDirectoryAndReturnError: outError])
-        return NO;
+    if (sampler->compressor != NULL)
+        plcrash_nasync_compressor_free(sampler->compressor);
+
+    if (sampler->loader != NULL)
+        plcrash_async_dynloader_free(sampler->loader);
+
+    if (sampler->allocator != NULL)
+        plcrash_async_allocator_free(sampler->allocator);
+
+    pthread_mutex_destroy(&sampler->lock);
+    free(sampler);
+}
+
+/**
+ * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
+ * This may be used to log current process state without actually crashing. The crash report data will be
+ * returned on success.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report.
+ * @param exception An exception to be included as the report's uncaught exception, or nil.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the crash report could not be generated or loaded. If no
+ * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
+ * error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread exception: (NSException *) exception error: (NSError **) outError {
+    return [self generateLiveReportWithThread: thread exception: exception threadFilter: nil error: outError];
+}
+
+/**
+ * Generate a live crash report for a given @a thread, including only @a thread and the threads selected by
+ * @a filter. Only the selected threads are suspended and walked, and only the binary images referenced by the selected
+ * threads are included; the cost of the report is independent of the total number of threads in the process. This
+ * may be used to cheaply snapshot, for example, the main thread and a small number of named worker threads.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report. This thread is always
+ * included.
+ * @param filter A block returning YES for each thread to be included in the report. The block is called for each of
+ * the process' threads prior to any thread being suspended.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the crash report could not be generated or loaded. If no
+ * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
+ * error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread threadFilter: (BOOL (^)(thread_t thread)) filter error: (NSError **) outError {
+    return [self generateLiveReportWithThread: thread exception: nil threadFilter: filter error: outError];
+}
+
+/**
+ * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
+ * This may be used to log current process state without actually crashing. The crash report data will be
+ * returned on success.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report.
+ * @param exception An exception to be included as the report's uncaught exception, or nil.
+ * @param filter If non-nil, a block returning YES for each thread to be included in the report; @a thread is always
+ * included. See generateLiveReportWithThread:threadFilter:error:.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the crash report could not be generated or loaded. If no
+ * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
+ * error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be loaded.
+ *
+ * @note Live reports may be generated concurrently from multiple threads. Each concurrent report is written with its
+ * own writer state and output buffer, and the threads writing other live reports are neither suspended by, nor
+ * included in, the report.
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread exception: (NSException *) exception threadFilter: (BOOL (^)(thread_t thread)) filter error: (NSError **) outError {
+    plcr_live_report_sampler_t *sampler;
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+    NSData *data = nil;
 
     /*
-     * Set up the signal handler context.
+     * Allocate the output buffer. The report is written directly to memory; as all other threads will be suspended
+     * while the report is written, the buffer can not be grown during writing, and is instead sized to the maximum
+     * report size up front.
      */
+    void *buffer = malloc(MAX_REPORT_BYTES);
+    if (buffer == NULL) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the live crash report buffer", nil);
+        return nil;
+    }
 
+    /* Select the filtered threads. The send rights returned by task_threads() are held until the report has been
+     * written, ensuring that the selected port names remain valid. */
+    thread_act_array_t threads = NULL;
+    mach_msg_type_number_t thread_count = 0;
+    thread_t *selected = NULL;
+    uint32_t selected_count = 0;
+    if (filter != nil) {
+        if (task_threads(mach_task_self(), &threads, &thread_count) != KERN_SUCCESS) {
+            plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to fetch the thread list", nil);
+            free(buffer);
+            return nil;
+        }
 
-    /* The pre-crash page-guarded allocator */
-    err = plcrash_async_allocator_create(&signal_handler_context._precrash_allocator, PAGE_SIZE); // NOTE: would leak if this were not a singleton struct
-    if (err != PLCRASH_ESUCCESS) {
-        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"An unexpected error occured allocating our page-guarded allocator", nil);
-        return NO;
+        selected = malloc(sizeof(thread_t) * MAX(thread_count, 1));
+        for (mach_msg_type_number_t i = 0; i < thread_count && selected != NULL; i++) {
+            if (threads[i] != thread && filter(threads[i]))
+                selected[selected_count++] = threads[i];
+        }
     }
 
-    /* Saved path to the output file */
-    signal_handler_context.path = strdup([[self crashReportPath] UTF8String]); // NOTE: would leak if this were not a singleton struct
+    /* Lock a sampler; each concurrent live report is written using its own sampler */
+    if ((sampler = [self lockLiveReportSamplerAndReturnError: outError]) == NULL) {
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++)
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        if (threads != NULL)
+            vm_deallocate(mach_task_self(), (vm_address_t) threads, sizeof(thread_t) * thread_count);
+        free(selected);
+        free(buffer);
+        return nil;
+    }
+
+    /* An empty filter still restricts the report to the crashed thread */
+    if (filter != nil)
+        plcrash_log_writer_set_thread_filter(&sampler->writer, selected != NULL ? selected : &thread, selected_count);
+
+    /* Include the breadcrumb ring, which may have been created since the sampler was */
+    plcrash_log_writer_set_breadcrumbs(&sampler->writer, _breadcrumbs);
+    plcrash_log_writer_set_attachments(&sampler->writer, &attachments);
+
+    [self prepareLiveReportSampler: sampler];
+
+    /* Provide the exception, if any */
+    if (exception != nil)
+        plcrash_log_writer_set_exception(&sampler->writer, exception);
+
+    /* Initialize the output context */
+    plcrash_async_file_init_memory(&file, buffer, MAX_REPORT_BYTES);
+    if (sampler->compressor != NULL)
+        plcrash_async_file_set_compressor(&file, sampler->compressor);
     
-    /* The dynamic loader reference required for image list reading. */
-    err = plcrash_nasync_dynloader_new(&signal_handler_context.dynamic_loader, signal_handler_context._precrash_allocator, mach_task_self()); // NOTE: would leak if this were not a singleton struct
+    /* Mock up a SIGTRAP-based signal info */
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    plcrash_log_signal_info_t signal_info;
+    bsd_signal_info.signo = SIGTRAP;
+    bsd_signal_info.code = TRAP_TRACE;
+    bsd_signal_info.address = __builtin_return_address(0);
+
+    signal_info.bsd_info = &bsd_signal_info;
+    signal_info.mach_info = NULL;
+
+    /* Write the crash log using the sampler's already-initialized writer */
+    if (thread == pl_mach_thread_self()) {
+        struct plcr_live_report_context ctx = {
+            .writer = &sampler->writer,
+            .loader = sampler->loader,
+            .file = &file,
+            .info = &signal_info
+        };
+        err = plcrash_async_thread_state_current(plcr_live_report_callback, &ctx);
+    } else {
+        err = plcrash_log_writer_write(&sampler->writer, thread, sampler->loader, &file, &signal_info, NULL);
+    }
+    plcrash_log_writer_close(&sampler->writer);
+    plcrash_log_writer_set_thread_filter(&sampler->writer, NULL, 0);
+
+    /* Record the memory used by the report; live reports exercise the same writer paths as crash reports */
+    if (err == PLCRASH_ESUCCESS && signal_handler_context.memory_sizing_path != NULL) {
+        pthread_mutex_lock(&memory_sizing_lock);
+        plcrash_memory_sizing_record(signal_handler_context.memory_sizing_path, signal_handler_context.memory_sizing_live_tmp_path,
+                                     &signal_handler_context.memory_sizing_state, &sampler->writer);
+        pthread_mutex_unlock(&memory_sizing_lock);
+    }
+
+    /* Flush the data */
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    [self unlockLiveReportSampler: sampler];
+
+    /* Release the filtered thread list */
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++)
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    if (threads != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) threads, sizeof(thread_t) * thread_count);
+    free(selected);
+
+    /* Check for write failure */
     if (err != PLCRASH_ESUCCESS) {
-        plcrash_populate_error(outError, PLCRashReporterErrorNotFound, @"Failed fetch the dyld image info for the current process", nil);
-        return NO;
+        NSLog(@"Write failed with error %s", plcrash_async_strerror(err));
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the crash report", nil);
+        free(buffer);
+        return nil;
     }
-    
-    /* Crash log writer instance */
-    assert(_applicationIdentifier != nil);
-    assert(_applicationVersion != nil);
-    plcrash_log_writer_init(&signal_handler_context.writer, _applicationIdentifier, _applicationVersion, _applicationMarketingVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], false);
-    
-    
 
-    /*
-     * Enable the signal handler
-     */
-    switch (_config.signalHandlerType) {
-        case PLCrashReporterSignalHandlerTypeBSD:
-            for (size_t i = 0; i < monitored_signals_count; i++) {
-                if (![[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: monitored_signals[i] callback: &signal_handler_callback context: &signal_handler_context error: outError])
-                    return NO;
-            }
-            break;
+    /* Trim the buffer to the written length (generally performed in-place), and transfer ownership to the returned NSData */
+    size_t length = (size_t) plcrash_async_file_position(&file);
+    void *trimmed = realloc(buffer, length > 0 ? length : 1);
+    if (trimmed != NULL)
+        buffer = trimmed;
 
-#if PLCRASH_FEATURE_MACH_EXCEPTIONS
-        case PLCrashReporterSignalHandlerTypeMach: {
-            /* We still need to use signal handlers to catch SIGABRT in-process. The kernel sends an EXC_CRASH mach exception
-             * to denote SIGABRT termination. In that case, catching the Mach exception in-process leads to process deadlock
-             * in an uninterruptable wait. Thus, we fall back on BSD signal handlers for SIGABRT, and do not register for
-             * EXC_CRASH. */
-            if (![[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: SIGABRT callback: &signal_handler_callback context: &signal_handler_context error: outError])
-                return NO;
-            
-            /* Enable the server. */
-            _machServer = [self enableMachExceptionServerWithPreviousPortSet: &_previousMachPorts
-                                                                    callback: &mach_exception_callback
-                                                                     context: &signal_handler_context
-                                                                       error: outError];
-            if (_machServer == nil)
-                return NO;
-            
-            /* Acquire references to the autoreleased values */
-            [_machServer retain];
-            [_previousMachPorts retain];
-            
-            /*
-             * MEMORY WARNING: To ensure that our instance survives for the lifetime of the callback registration,
-             * we retain it here. This is necessary to ensure that the Mach exception server instance and previous port set
-             * survive for the lifetime of the callback. Since there's currently no support for *deregistering* a crash reporter,
-             * this simply results in the reporter living forever.
-             */
-            [self retain];
-            
-            /*
-             * Save the previous ports. There's a race condition here, in that an exception that is delivered before (or during)
-             * setting the previous port values will see a fully and/or partially configured port set. This could be an issue
-             * when interoperating with managed runtimes, where NULL dereferences may trigger exception handling
-             * in a common runtime case.
-             *
-             * TODO: Investigate use of (async-safe) locking to close the window in which an exception would not be safely forwarded.
-             * This issue also exists (and is noted with a TODO) in PLCrashSignalHandler.
-             */
-            signal_handler_context.port_set = [_previousMachPorts asyncSafeRepresentation];
-            break;
+    data = [NSData dataWithBytesNoCopy: buffer length: length freeWhenDone: YES];
+    return data;
+}
+
+/**
+ * @internal
+ *
+ * Acquire and lock a sampler with which to write a live report. If the shared sampler is in use by another live report,
+ * an idle concurrent sampler is used, or a new sampler is created; concurrent live reports never share a writer,
+ * allocator, symbol cache, or output buffer. The sampler must be released via -unlockLiveReportSampler:.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the sampler could not be created.
+ *
+ * @return Returns the locked sampler, or NULL on failure.
+ */
+- (plcr_live_report_sampler_t *) lockLiveReportSamplerAndReturnError: (NSError **) outError {
+    plcr_live_report_sampler_t *sampler;
+
+    /* Fetch (or create) the shared sampler */
+    @synchronized (self) {
+        if (_liveReportSampler == NULL && (_liveReportSampler = [self newLiveReportSamplerAndReturnError: outError]) == NULL)
+            return NULL;
+        sampler = _liveReportSampler;
+    }
+
+    if (pthread_mutex_trylock(&sampler->lock) == 0)
+        return sampler;
+
+    /* The shared sampler is busy; use an idle concurrent sampler, if any */
+    @synchronized (self) {
+        sampler = _idleLiveReportSamplers;
+        if (sampler != NULL)
+            _idleLiveReportSamplers = sampler->next_idle;
+    }
+
+    if (sampler == NULL && (sampler = [self newLiveReportSamplerAndReturnError: outError]) == NULL)
+        return NULL;
+
+    sampler->next_idle = NULL;
+    pthread_mutex_lock(&sampler->lock);
+    return sampler;
+}
+
+/**
+ * @internal
+ *
+ * Unlock a sampler acquired via -lockLiveReportSamplerAndReturnError:. A concurrent sampler is retained for reuse by
+ * later concurrent reports, up to MAX_IDLE_LIVE_REPORT_SAMPLERS, and is otherwise freed.
+ */
+- (void) unlockLiveReportSampler: (plcr_live_report_sampler_t *) sampler {
+    pthread_mutex_unlock(&sampler->lock);
+
+    @synchronized (self) {
+        if (sampler == _liveReportSampler)
+            return;
+
+        NSUInteger idle = 0;
+        for (plcr_live_report_sampler_t *s = _idleLiveReportSamplers; s != NULL; s = s->next_idle)
+            idle++;
+
+        if (idle < MAX_IDLE_LIVE_REPORT_SAMPLERS) {
+            sampler->next_idle = _idleLiveReportSamplers;
+            _idleLiveReportSamplers = sampler;
+            return;
         }
-#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
     }
 
-    /* Set the uncaught exception handler */
-    NSSetUncaughtExceptionHandler(&uncaught_exception_handler);
+    plcr_live_report_sampler_free(sampler);
+}
+
+/**
+ * @internal
+ *
+ * Return the number of Objective-C classes for which room should be reserved in a writer's standby symbol cache.
+ */
+- (size_t) standbyClassCapacity {
+    if (!([self writerSymbolicationStrategy] & PLCrashReporterSymbolicationStrategyObjC))
+        return 0;
+
+    size_t registered = (size_t) MAX(objc_getClassList(NULL, 0), 0);
+
+    /* The cache only holds the classes encountered while symbolicating a report, typically a small fraction of those
+     * registered; prefer the use observed by previous reports, if any. */
+    if (signal_handler_context.sized_class_capacity > 0)
+        return MIN(signal_handler_context.sized_class_capacity, registered);
+
+    return registered;
+}
+
+/**
+ * @internal
+ *
+ * Prepare @a sampler's writer for a new live report or trace sample. The standby cache is re-prepared if any image has
+ * been unloaded since it was last prepared, as it may hold references to the unloaded image's classes. The sampler's
+ * lock must be held.
+ */
+- (void) prepareLiveReportSampler: (plcr_live_report_sampler_t *) sampler {
+    plcrash_error_t err;
+
+    plcrash_log_writer_reset(&sampler->writer);
+    if (sampler->writer.symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
+        uint32_t unload_count = 0;
+        bool monitored = plcrash_async_dynloader_image_unload_count(sampler->loader, &unload_count);
+
+        if (!sampler->writer.has_standby_cache || !monitored || unload_count != sampler->unload_count) {
+            if ((err = plcrash_log_writer_prepare_standby(&sampler->writer, [self standbyClassCapacity])) != PLCRASH_ESUCCESS)
+                NSDEBUG(@"Could not prepare the live report symbol cache: %d", err);
+
+            /* Without the image monitor, there is no way to detect unloaded images; the cache is consumed by the
+             * report, and re-prepared for each subsequent report. */
+            plcrash_log_writer_set_retain_standby(&sampler->writer, monitored);
+            sampler->unload_count = unload_count;
+        }
+    }
+
+    /* Reference the shared image list, writing a new list if any image has been loaded or unloaded since the last was
+     * written */
+    if (_config.shouldShareLiveReportImageLists)
+        [self updateSharedImageListForSampler: sampler];
+}
+
+/**
+ * Sample the stacks of all threads in the current process, other than the calling thread, returning the sample as
+ * trace data to be appended to a trace file.
+ *
+ * The data returned by the first call (and by the first call following resetLiveTrace) begins with the trace file
+ * header and trace header, and includes the complete stacks of all threads. Each subsequent sample includes only those
+ * threads that have started or whose stacks have changed since the previous sample, and for each such thread, only the
+ * innermost frames that have changed; threads that have exited are listed by identifier. The concatenated samples form
+ * a single Trace message, as defined by crash_report.proto.
+ *
+ * Samples share the live report writer's symbol cache and shared image list configuration, and are not compressed.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the sample could not be generated. If no error occurs,
+ * this parameter will be left unmodified. You may specify nil for this parameter, and no error information
+ * will be provided.
+ *
+ * @return Returns the sample data, or nil if the sample could not be generated.
+ */
+- (NSData *) generateLiveTraceSampleAndReturnError: (NSError **) outError {
+    plcr_live_report_sampler_t *sampler;
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+
+    /* Fetch (or create) the sampler */
+    @synchronized (self) {
+        if (_liveReportSampler == NULL && (_liveReportSampler = [self newLiveReportSamplerAndReturnError: outError]) == NULL)
+            return nil;
+        sampler = _liveReportSampler;
+    }
+
+    /* As with live reports, the buffer can not be grown while threads are suspended, and is sized up front */
+    void *buffer = malloc(MAX_REPORT_BYTES);
+    if (buffer == NULL) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the live trace buffer", nil);
+        return nil;
+    }
+
+    pthread_mutex_lock(&sampler->lock);
+
+    if (sampler->trace == NULL && (err = plcrash_log_trace_new(&sampler->trace, MAX_TRACE_THREADS)) != PLCRASH_ESUCCESS) {
+        pthread_mutex_unlock(&sampler->lock);
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the live trace", nil);
+        free(buffer);
+        return nil;
+    }
+
+    [self prepareLiveReportSampler: sampler];
 
-    /* Success */
-    _enabled = YES;
-    return YES;
+    plcrash_async_file_init_memory(&file, buffer, MAX_REPORT_BYTES);
+    err = plcrash_log_writer_write_trace_sample(&sampler->writer, sampler->trace, sampler->loader, &file);
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    pthread_mutex_unlock(&sampler->lock);
+
+    if (err != PLCRASH_ESUCCESS) {
+        NSLog(@"Trace sample failed with error %s", plcrash_async_strerror(err));
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the trace sample", nil);
+        free(buffer);
+        return nil;
+    }
+
+    /* Trim the buffer to the written length, and transfer ownership to the returned NSData */
+    size_t length = (size_t) plcrash_async_file_position(&file);
+    void *trimmed = realloc(buffer, length > 0 ? length : 1);
+    if (trimmed != NULL)
+        buffer = trimmed;
+
+    return [NSData dataWithBytesNoCopy: buffer length: length freeWhenDone: YES];
 }
 
 /**
- * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
- * This may be used to log current process state without actually crashing. The crash report data will be
- * returned on success.
+ * Start a new live trace. The next call to generateLiveTraceSampleAndReturnError: returns the header of a new trace
+ * stream, followed by the complete stacks of all threads.
+ */
+- (void) resetLiveTrace {
+    plcr_live_report_sampler_t *sampler;
+
+    @synchronized (self) {
+        sampler = _liveReportSampler;
+    }
+
+    if (sampler == NULL)
+        return;
+
+    pthread_mutex_lock(&sampler->lock);
+    if (sampler->trace != NULL)
+        plcrash_log_trace_reset(sampler->trace);
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+/**
+ * @internal
  *
- * @param thread The thread which will be marked as the failing thread in the generated report.
+ * Ensure that a shared image list matching the current image list generation has been written for @a sampler, and
+ * configure the sampler's writer to reference it. If the image list can not be written, the writer is configured to
+ * include the images in each report. The sampler's lock must be held.
+ */
+- (void) updateSharedImageListForSampler: (plcr_live_report_sampler_t *) sampler {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *directory = [self sharedImageListDirectory];
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+    uint32_t generation;
+
+    /* Without the image monitor, there is no generation with which to reference the list */
+    if (!plcrash_async_dynloader_image_generation(sampler->loader, &generation)) {
+        plcrash_log_writer_set_shared_image_list(&sampler->writer, NULL, 0);
+        return;
+    }
+
+    if (sampler->has_image_list && generation == sampler->image_list_generation)
+        return;
+
+    /* From here on, the previous image list is stale */
+    sampler->has_image_list = false;
+    plcrash_log_writer_set_shared_image_list(&sampler->writer, NULL, 0);
+
+    NSError *error;
+    if (![fm fileExistsAtPath: directory] && ![fm createDirectoryAtPath: directory withIntermediateDirectories: YES attributes: nil error: &error]) {
+        NSDEBUG(@"Could not create the shared image list directory: %@", error);
+        return;
+    }
+
+    /* The list's generation is not known until it has been written; it is written to a temporary file, and then moved
+     * into place. */
+    NSString *tmpPath = [directory stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    int fd = open([tmpPath fileSystemRepresentation], O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        NSDEBUG(@"Could not open the shared image list file: %s", strerror(errno));
+        return;
+    }
+
+    plcrash_async_file_init(&file, fd, MAX_IMAGE_LIST_BYTES);
+    err = plcrash_log_writer_write_image_list(sampler->loader, sampler->allocator, sampler->image_list_session, &file, &generation);
+    if (!plcrash_async_file_close(&file) && err == PLCRASH_ESUCCESS)
+        err = PLCRASH_OUTPUT_ERR;
+
+    if (err != PLCRASH_ESUCCESS) {
+        NSDEBUG(@"Could not write the shared image list: %d", err);
+        unlink([tmpPath fileSystemRepresentation]);
+        return;
+    }
+
+    NSData *session = [NSData dataWithBytes: sampler->image_list_session length: sizeof(sampler->image_list_session)];
+    NSString *path = [directory stringByAppendingPathComponent: [PLCrashReport sharedImageListFileNameForSessionID: session generation: generation]];
+    if (rename([tmpPath fileSystemRepresentation], [path fileSystemRepresentation]) != 0) {
+        NSDEBUG(@"Could not move the shared image list into place: %s", strerror(errno));
+        unlink([tmpPath fileSystemRepresentation]);
+        return;
+    }
+
+    sampler->has_image_list = true;
+    sampler->image_list_generation = generation;
+    plcrash_log_writer_set_shared_image_list(&sampler->writer, sampler->image_list_session, generation);
+}
+
+/**
+ * Resolve the binary images of a live report that references a shared image list (see
+ * PLCrashReporterConfig::shouldShareLiveReportImageLists), loading the image list from the crash reporter's data
+ * directory. If the report does not reference a shared image list, this method does nothing.
  *
- * @return Returns nil if the crash report data could not be generated.
+ * @param report The report to be resolved.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the image list could not be resolved. If no error occurs,
+ * this parameter will be left unmodified. You may specify nil for this parameter, and no error information
+ * will be provided.
  *
- * @sa PLCrashReporter::generateLiveReportWithThread:exception:error:
+ * @return Returns YES on success, or NO if the referenced image list could not be loaded.
  */
-- (NSData *) generateLiveReportWithThread: (thread_t) thread {
-    return [self generateLiveReportWithThread: thread error: NULL];
+- (BOOL) resolveSharedImageListForReport: (PLCrashReport *) report error: (NSError **) outError {
+    if (!report.hasSharedImageList)
+        return YES;
+
+    NSString *path = [[self sharedImageListDirectory] stringByAppendingPathComponent: report.sharedImageListFileName];
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: outError];
+    if (data == nil)
+        return NO;
+
+    return [report resolveSharedImageListWithData: data error: outError];
 }
 
 /**
- * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
- * This may be used to log current process state without actually crashing. The crash report data will be
- * returned on success.
+ * Purge all shared image lists. Live reports generated prior to the purge that reference a shared image list can no
+ * longer be resolved via resolveSharedImageListForReport:error:.
  *
- * @param thread The thread which will be marked as the failing thread in the generated report.
  * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
- * will contain an error object indicating why the crash report could not be generated or loaded. If no
- * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
- * error information will be provided.
- *
- * @return Returns nil if the crash report data could not be loaded.
+ * will contain an error object indicating why the image lists could not be purged. If no error occurs,
+ * this parameter will be left unmodified. You may specify nil for this parameter, and no error information
+ * will be provided.
  *
- * @sa PLCrashReporter::generateLiveReportWithThread:exception:error:
+ * @return Returns YES on success, or NO on error.
  */
-- (NSData *) generateLiveReportWithThread: (thread_t) thread error: (NSError **) outError {
-    return [self generateLiveReportWithThread: thread exception: nil error: outError];
-}
+- (BOOL) purgeSharedImageListsAndReturnError: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *directory = [self sharedImageListDirectory];
+    plcr_live_report_sampler_t *sampler;
+    BOOL result = YES;
 
+    @synchronized (self) {
+        sampler = _liveReportSampler;
+    }
 
-/* State and callback used by -generateLiveReportWithThread */
-struct plcr_live_report_context {
-    plcrash_log_writer_t *writer;
-    plcrash_async_dynloader_t *loader;
-    plcrash_async_file_t *file;
-    plcrash_log_signal_info_t *info;
-};
-static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *state, void *ctx) {
-    struct plcr_live_report_context *plcr_ctx = ctx;
-    return plcrash_log_writer_write(plcr_ctx->writer, pl_mach_thread_self(), plcr_ctx->loader, plcr_ctx->file, plcr_ctx->info, state);
-}
+    /* The sampler's current image list is removed; ensure that it is rewritten prior to the next report */
+    if (sampler != NULL)
+        pthread_mutex_lock(&sampler->lock);
+
+    NSArray *entries = [fm contentsOfDirectoryAtPath: directory error: NULL];
+    for (NSString *entry in entries) {
+        if (![fm removeItemAtPath: [directory stringByAppendingPathComponent: entry] error: outError]) {
+            result = NO;
+            break;
+        }
+    }
+
+    if (sampler != NULL) {
+        sampler->has_image_list = false;
+        plcrash_log_writer_set_shared_image_list(&sampler->writer, NULL, 0);
+        pthread_mutex_unlock(&sampler->lock);
+    }
 
+    return result;
+}
 
 /**
- * Generate a live crash report for a given @a thread, without triggering an actual crash condition.
- * This may be used to log current process state without actually crashing. The crash report data will be
- * returned on success.
+ * @internal
  *
- * @param thread The thread which will be marked as the failing thread in the generated report.
- * @param exception An exception to be included as the report's uncaught exception, or nil.
- * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
- * will contain an error object indicating why the crash report could not be generated or loaded. If no
- * error occurs, this parameter will be left unmodified. You may specify nil for this parameter, and no
- * error information will be provided.
+ * Create a new live report sampler, configured from the receiver's configuration.
  *
- * @return Returns nil if the crash report data could not be loaded.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the sampler could not be created.
  *
- * @todo Implement in-memory, rather than requiring writing of the report to disk.
+ * @return Returns the new sampler, or NULL on failure. The sampler must be freed via plcr_live_report_sampler_free().
  */
-- (NSData *) generateLiveReportWithThread: (thread_t) thread exception: (NSException *) exception error: (NSError **) outError {
-    plcrash_log_writer_t writer;
-    plcrash_async_file_t file;
+- (plcr_live_report_sampler_t *) newLiveReportSamplerAndReturnError: (NSError **) outError {
+    plcr_live_report_sampler_t *sampler = calloc(1, sizeof(*sampler));
     plcrash_error_t err;
-    NSData *data = nil;
-
-    /* Open the output file */
-    NSString *templateStr = [NSTemporaryDirectory() stringByAppendingPathComponent: @"live_crash_report.XXXXXX"];
-    char *path = strdup([templateStr fileSystemRepresentation]);
-    
-    int fd = mkstemp(path);
-    if (fd < 0) {
-        plcrash_populate_posix_error(outError, errno, NSLocalizedString(@"Failed to create temporary path", @"Error opening temporary output path"));
-        free(path);
 
-        return nil;
+    if (sampler == NULL) {
+        plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the live report sampler", nil);
+        return NULL;
     }
+    pthread_mutex_init(&sampler->lock, NULL);
 
-    /* Initialize the output context */
-    plcrash_log_writer_init(&writer, _applicationIdentifier, _applicationVersion, _applicationMarketingVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], true);
-    plcrash_async_file_init(&file, fd, MAX_REPORT_BYTES);
-
-    /* Provide the exception, if any */
-    if (exception != nil)
-        plcrash_log_writer_set_exception(&writer, exception);
-    
-    /* Mock up a SIGTRAP-based signal info */
-    plcrash_log_bsd_signal_info_t bsd_signal_info;
-    plcrash_log_signal_info_t signal_info;
-    bsd_signal_info.signo = SIGTRAP;
-    bsd_signal_info.code = TRAP_TRACE;
-    bsd_signal_info.address = __builtin_return_address(0);
+    /* Generate the session identifier with which shared image lists are written */
+    CFUUIDRef session = CFUUIDCreate(NULL);
+    CFUUIDBytes sessionBytes = CFUUIDGetUUIDBytes(session);
+    memcpy(sampler->image_list_session, &sessionBytes, sizeof(sampler->image_list_session));
+    CFRelease(session);
 
-    signal_info.bsd_info = &bsd_signal_info;
-    signal_info.mach_info = NULL;
-    
-    /* Instantiate a dynamic loader instance. */
-    plcrash_async_allocator_t *allocator = NULL;
-    plcrash_async_dynloader_t *loader = NULL;
-    
-    err = plcrash_async_allocator_create(&allocator, PAGE_SIZE);
+    err = plcrash_async_magazine_allocator_create(&sampler->allocator, PAGE_SIZE);
     if (err != PLCRASH_ESUCCESS) {
         plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"An unexpected error occured allocating our page-guarded allocator", nil);
-        goto cleanup;
+        goto error;
     }
     
-    err = plcrash_nasync_dynloader_new(&loader, allocator, mach_task_self());
+    err = plcrash_nasync_dynloader_new(&sampler->loader, sampler->allocator, mach_task_self());
     if (err != PLCRASH_ESUCCESS) {
         plcrash_populate_error(outError, PLCRashReporterErrorNotFound, @"Failed fetch the dyld image info for the current process", nil);
-        goto cleanup;
-    }
-    
-    /* Write the crash log using the already-initialized writer */
-    if (thread == pl_mach_thread_self()) {
-        struct plcr_live_report_context ctx = {
-            .writer = &writer,
-            .loader = loader,
-            .file = &file,
-            .info = &signal_info
-        };
-        err = plcrash_async_thread_state_current(plcr_live_report_callback, &ctx);
-    } else {
-        err = plcrash_log_writer_write(&writer, thread, loader, &file, &signal_info, NULL);
+        goto error;
     }
-    plcrash_log_writer_close(&writer);
-
-    /* Flush the data */
-    plcrash_async_file_flush(&file);
-    plcrash_async_file_close(&file);
 
-    /* Check for write failure */
-    if (err != PLCRASH_ESUCCESS) {
-        NSLog(@"Write failed with error %s", plcrash_async_strerror(err));
-        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the crash report to disk", nil);
-        data = nil;
-        goto cleanup;
+    /* Maintain the image list incrementally; this also provides the unload count used to invalidate the standby
+     * cache. Failure is non-fatal. */
+    if ((err = plcrash_nasync_dynloader_enable_image_monitor(sampler->loader)) != PLCRASH_ESUCCESS)
+        NSDEBUG(@"Could not enable the live report image monitor: %d", err);
+
+    /* Compress the report, if enabled */
+    if (_config.shouldCompressReports) {
+        err = plcrash_nasync_compressor_new(&sampler->compressor, sampler->allocator);
+        if (err != PLCRASH_ESUCCESS) {
+            plcrash_populate_error(outError, PLCRashReporterErrorInsufficientMemory, @"Failed to allocate the crash report compressor", nil);
+            goto error;
+        }
     }
 
-    data = [NSData dataWithContentsOfFile: [NSString stringWithUTF8String: path]];
-    if (data == nil) {
-        /* This should only happen if our data is deleted out from under us */
-        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, NSLocalizedString(@"Unable to open live crash report for reading", nil), nil);
-        goto cleanup;
+    /* Initialize the writer */
+    err = plcrash_log_writer_init(&sampler->writer, _applicationIdentifier, _applicationVersion, _applicationMarketingVersion, [self mapToAsyncSymbolicationStrategy: [self writerSymbolicationStrategy]], true);
+    sampler->writer_initialized = true;
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the live report writer", nil);
+        goto error;
     }
 
-cleanup:
-    /* Finished -- clean up. */
-    plcrash_log_writer_free(&writer);
-    plcrash_async_dynloader_free(loader);
-    plcrash_async_allocator_free(allocator);
-
-    if (unlink(path) != 0) {
-        /* This shouldn't fail, but if it does, there's no use in returning nil */
-        NSLog(@"Failure occured deleting live crash report: %s", strerror(errno));
+    if (signal_handler_context.sized_arena_bytes > 0) {
+        if ((err = plcrash_log_writer_set_allocator_size(&sampler->writer, signal_handler_context.sized_arena_bytes)) != PLCRASH_ESUCCESS)
+            NSDEBUG(@"Could not resize the live report allocator: %d", err);
     }
 
-    free(path);
-    return data;
+    if ([self writerSymbolicationStrategy] & PLCrashReporterSymbolicationStrategySharedCache)
+        plcrash_log_writer_set_shared_cache_info(&sampler->writer, plcr_shared_cache_info());
+    if ([self writerSymbolicationStrategy] != PLCrashReporterSymbolicationStrategyNone)
+        plcrash_log_writer_set_symbol_interning(&sampler->writer, true);
+    plcrash_log_writer_set_frame_limits(&sampler->writer, (uint32_t) MIN(_config.maxThreadFrames, UINT32_MAX),
+                                        (uint32_t) MIN(_config.maxReportFrames, UINT32_MAX), (uint32_t) MIN(_config.tailThreadFrames, UINT32_MAX));
+    if (_config.shouldCompactUnreferencedImages)
+        plcrash_log_writer_set_compact_images(&sampler->writer, true);
+    if (_config.shouldScanStacks)
+        plcrash_log_writer_set_stack_scan(&sampler->writer, true);
+    if (_config.shouldAnnotateRegisters)
+        plcrash_log_writer_set_register_annotation(&sampler->writer, true);
+    if (_config.shouldWriteCompactRegisterState)
+        plcrash_log_writer_set_register_state(&sampler->writer, true);
+    if (_config.shouldCollapseIdenticalThreadStacks)
+        plcrash_log_writer_set_collapse_stacks(&sampler->writer, true);
+    if (_config.shouldPackThreadFrames)
+        plcrash_log_writer_set_packed_frames(&sampler->writer, true);
+    if (_config.idleThreadFrames > 0)
+        plcrash_log_writer_set_idle_thread_frames(&sampler->writer, (uint32_t) MIN(_config.idleThreadFrames, UINT32_MAX));
+    if (_config.shouldFitReportsToSizeLimit)
+        plcrash_log_writer_set_size_policy(&sampler->writer, true);
+    if (_config.shouldRecordWriterStatistics)
+        plcrash_log_writer_set_instrumentation(&sampler->writer, true);
+    if (_config.shouldRecordThreadMetadata)
+        plcrash_log_writer_set_thread_metadata(&sampler->writer, true);
+
+    /* Unwind threads in parallel; this is only safe for live reports, as workers are started via pthread_create() */
+    plcrash_log_writer_set_unwind_workers(&sampler->writer, MIN(sampler->writer.machine_info.logical_processor_count, MAX_LIVE_REPORT_UNWIND_WORKERS));
+    if (_config.shouldPipelineLiveReports)
+        plcrash_log_writer_set_pipelined(&sampler->writer, true);
+    if (_config.shouldSnapshotLiveReportStacks)
+        plcrash_log_writer_set_stack_snapshot_size(&sampler->writer, LIVE_REPORT_STACK_SNAPSHOT_BYTES);
+
+    /* Live reports may be written concurrently from multiple threads, each of which must not suspend the others */
+    plcrash_log_writer_set_concurrent(&sampler->writer, true);
+
+    return sampler;
+
+error:
+    plcr_live_report_sampler_free(sampler);
+    return NULL;
 }
 
 
@@ -888,7 +3550,7 @@ cleanup:
         return nil;
 
     /* Save the configuration */
-    _config = [configuration retain];
+    _config = [configuration copy];
     _applicationIdentifier = [applicationIdentifier retain];
     _applicationVersion = [applicationVersion retain];
     _applicationMarketingVersion = [applicationMarketingVersion retain];
@@ -896,10 +3558,14 @@ cleanup:
     /* No occurances of '/' should ever be in a bundle ID, but just to be safe, we escape them */
     NSString *appIdPath = [applicationIdentifier stringByReplacingOccurrencesOfString: @"/" withString: @"_"];
     
-    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
-    NSString *cacheDir = [paths objectAtIndex: 0];
+    /* Use the configured volume, if any; otherwise, the user's caches directory */
+    NSString *cacheDir = configuration.reportVolumePath;
+    if (cacheDir == nil) {
+        NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
+        cacheDir = [paths objectAtIndex: 0];
+    }
     _crashReportDirectory = [[[cacheDir stringByAppendingPathComponent: PLCRASH_CACHE_DIR] stringByAppendingPathComponent: appIdPath] retain];
-    
+
     return self;
 }
 
@@ -989,7 +3655,25 @@ cleanup:
     
     /* Create the server */
     NSError *osError;
-    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: callback context: context error: &osError] autorelease];
+    plcrash_exception_server_sched_t scheduling;
+    switch (_config.machExceptionThreadScheduling) {
+        case PLCrashReporterThreadSchedulingHighQoS:
+            scheduling = PLCRASH_EXCEPTION_SERVER_SCHED_HIGH_QOS;
+            break;
+        case PLCrashReporterThreadSchedulingTimeConstraint:
+            scheduling = PLCRASH_EXCEPTION_SERVER_SCHED_TIME_CONSTRAINT;
+            break;
+        default:
+            scheduling = PLCRASH_EXCEPTION_SERVER_SCHED_DEFAULT;
+            break;
+    }
+
+    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: callback
+                                                                                      contexts: &context
+                                                                                   threadCount: 1
+                                                                                    scheduling: scheduling
+                                                                                wiredStackSize: _config.machExceptionThreadStackSize
+                                                                                         error: &osError] autorelease];
     if (server == nil) {
         plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to instantiate the Mach exception server.", osError);
         return nil;
@@ -1026,9 +3710,44 @@ cleanup:
     [_applicationVersion release];
     [_applicationMarketingVersion release];
 
+    if (_liveReportSampler != NULL)
+        plcr_live_report_sampler_free(_liveReportSampler);
+
+    while (_idleLiveReportSamplers != NULL) {
+        plcr_live_report_sampler_t *next = _idleLiveReportSamplers->next_idle;
+        plcr_live_report_sampler_free(_idleLiveReportSamplers);
+        _idleLiveReportSamplers = next;
+    }
+
     [super dealloc];
 }
 
+/**
+ * Return the symbolication strategy to be applied when writing reports. If symbolication is deferred, no symbolication
+ * is performed by the writer.
+ */
+- (PLCrashReporterSymbolicationStrategy) writerSymbolicationStrategy {
+    if (_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategyDeferred)
+        return PLCrashReporterSymbolicationStrategyNone;
+
+    return _config.symbolicationStrategy;
+}
+
+/**
+ * Write the uncompressed report @a data to @a path, replacing any existing file atomically.
+ *
+ * @param data The report data.
+ * @param path The destination path.
+ * @param compress If YES, the report will be compressed.
+ * @param outError On failure, the reason the report could not be written.
+ */
+- (BOOL) writeReportData: (NSData *) data toPath: (NSString *) path compress: (BOOL) compress error: (NSError **) outError {
+    if (compress && (data = [PLCrashReport compressedDataWithReportData: data error: outError]) == nil)
+        return NO;
+
+    return [data writeToFile: path options: NSDataWritingAtomic error: outError];
+}
+
 /**
  * Map the configuration defined @a strategy to the backing plcrash_async_symbol_strategy_t representation.
  *
@@ -1045,6 +3764,12 @@ cleanup:
     
     if (strategy & PLCrashReporterSymbolicationStrategyObjC)
         result |= PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC;
+
+    if (strategy & PLCrashReporterSymbolicationStrategySharedCache)
+        result |= PLCRASH_ASYNC_SYMBOL_STRATEGY_SHARED_CACHE;
+
+    if (strategy & PLCrashReporterSymbolicationStrategyEmbedded)
+        result |= PLCRASH_ASYNC_SYMBOL_STRATEGY_EMBEDDED;
     
     return result;
 }
@@ -1091,6 +3816,169 @@ cleanup:
 }
 
 
+/**
+ * Return the path to the queued report index.
+ */
+- (NSString *) queuedCrashReportIndexPath {
+    return [[self queuedCrashReportDirectory] stringByAppendingPathComponent: PLCRASH_QUEUED_INDEX];
+}
+
+
+/**
+ * Return the path to the duplicate crash occurrence log.
+ */
+- (NSString *) queuedCrashReportOccurrencePath {
+    return [[self queuedCrashReportDirectory] stringByAppendingPathComponent: PLCRASH_QUEUED_OCCURRENCES];
+}
+
+
+/**
+ * Return the identifiers of all queued reports, in queue order, as read from the queued report index. If the index
+ * is missing or invalid, it will be rebuilt from the queued report directory.
+ *
+ * Reports whose most recent index record marks them as removed are excluded.
+ */
+- (NSArray *) queuedCrashReportIdentifiers {
+    plcrash_queued_report_index_t index;
+    plcrash_error_t err;
+
+    @synchronized (self) {
+        if ((err = plcrash_queued_report_index_map(&index, [[self queuedCrashReportIndexPath] fileSystemRepresentation])) != PLCRASH_ESUCCESS) {
+            if (err != PLCRASH_ENOTFOUND)
+                NSDEBUG(@"Rebuilding queued report index: %s", plcrash_async_strerror(err));
+            return [self rebuildQueuedCrashReportIndex];
+        }
+
+        /* Later records supersede earlier records for the same report */
+        NSMutableArray *identifiers = [NSMutableArray arrayWithCapacity: index.count];
+        NSMutableDictionary *states = [NSMutableDictionary dictionaryWithCapacity: index.count];
+        for (size_t i = 0; i < index.count; i++) {
+            NSString *identifier = [NSString stringWithUTF8String: index.records[i].report_id];
+            if (identifier == nil)
+                continue;
+
+            if ([states objectForKey: identifier] == nil)
+                [identifiers addObject: identifier];
+            [states setObject: [NSNumber numberWithUnsignedShort: index.records[i].state] forKey: identifier];
+        }
+
+        plcrash_queued_report_index_unmap(&index);
+
+        NSIndexSet *removed = [identifiers indexesOfObjectsPassingTest: ^BOOL (id identifier, NSUInteger idx, BOOL *stop) {
+            return [[states objectForKey: identifier] unsignedShortValue] == PLCRASH_QUEUED_REPORT_STATE_REMOVED;
+        }];
+        [identifiers removeObjectsAtIndexes: removed];
+
+        return identifiers;
+    }
+}
+
+
+/**
+ * Rebuild the queued report index from the contents of the queued report directory, returning the identifiers of
+ * all queued reports in queue order. The stack hashes of the re-indexed reports are not recorded.
+ */
+- (NSArray *) rebuildQueuedCrashReportIndex {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *directory = [self queuedCrashReportDirectory];
+
+    /* A missing directory is equivalent to an empty queue */
+    NSArray *entries = [fm contentsOfDirectoryAtPath: directory error: NULL];
+    if (entries == nil)
+        return [NSArray array];
+
+    NSMutableArray *identifiers = [NSMutableArray arrayWithCapacity: [entries count]];
+    NSMutableData *records = [NSMutableData dataWithCapacity: [entries count] * sizeof(plcrash_queued_report_record_t)];
+
+    /* Queued report names are prefixed with a fixed-width timestamp, so lexical order is queue order */
+    for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+        if (![[entry pathExtension] isEqualToString: PLCRASH_QUEUED_REPORT_EXTENSION])
+            continue;
+
+        NSString *identifier = [entry stringByDeletingPathExtension];
+        unsigned long long timestamp = 0;
+        [[NSScanner scannerWithString: identifier] scanHexLongLong: &timestamp];
+        uint64_t size = [[fm attributesOfItemAtPath: [directory stringByAppendingPathComponent: entry] error: NULL] fileSize];
+
+        plcrash_queued_report_record_t record;
+        if (plcrash_queued_report_record_init(&record, [identifier UTF8String], PLCRASH_QUEUED_REPORT_STATE_PENDING, timestamp, size, 0) != PLCRASH_ESUCCESS) {
+            NSDEBUG(@"Skipping queued crash report with an overlong name: %@", entry);
+            continue;
+        }
+
+        [records appendBytes: &record length: sizeof(record)];
+        [identifiers addObject: identifier];
+    }
+
+    if (plcrash_queued_report_index_write([[self queuedCrashReportIndexPath] fileSystemRepresentation], [records bytes], [identifiers count]) != PLCRASH_ESUCCESS)
+        NSDEBUG(@"Could not write queued report index");
+
+    return identifiers;
+}
+
+
+/**
+ * Publish the stack hashes of all queued reports to the crash handler, allowing crashes that duplicate a queued report
+ * to be recorded as occurrences rather than written as new reports. Has no effect unless duplicate crash suppression
+ * is enabled.
+ */
+- (void) publishQueuedStackHashes {
+    if (signal_handler_context.occurrence_path == NULL)
+        return;
+
+    @synchronized (self) {
+        plcrash_queued_report_index_t index;
+        NSMutableDictionary *hashes = [NSMutableDictionary dictionary];
+
+        /* Later records supersede earlier records for the same report. A missing index is equivalent to an empty
+         * queue; reports indexed by rebuildQueuedCrashReportIndex have no recorded hash. */
+        if (plcrash_queued_report_index_map(&index, [[self queuedCrashReportIndexPath] fileSystemRepresentation]) == PLCRASH_ESUCCESS) {
+            for (size_t i = 0; i < index.count; i++) {
+                NSString *identifier = [NSString stringWithUTF8String: index.records[i].report_id];
+                if (identifier == nil)
+                    continue;
+
+                if (index.records[i].state == PLCRASH_QUEUED_REPORT_STATE_REMOVED || index.records[i].stack_hash == 0)
+                    [hashes removeObjectForKey: identifier];
+                else
+                    [hashes setObject: [NSNumber numberWithUnsignedLongLong: index.records[i].stack_hash] forKey: identifier];
+            }
+
+            plcrash_queued_report_index_unmap(&index);
+        }
+
+        NSArray *values = [hashes allValues];
+        plcrash_queued_stack_hashes_t *table = malloc(sizeof(*table) + sizeof(table->hashes[0]) * [values count]);
+        if (table == NULL)
+            return;
+
+        for (NSUInteger i = 0; i < [values count]; i++)
+            table->hashes[i] = [[values objectAtIndex: i] unsignedLongLongValue];
+
+        /* Sort, and discard duplicate hashes */
+        size_t count = 0;
+        qsort(table->hashes, [values count], sizeof(table->hashes[0]), plcrash_queued_stack_hash_compare);
+        for (NSUInteger i = 0; i < [values count]; i++) {
+            if (count == 0 || table->hashes[count - 1] != table->hashes[i])
+                table->hashes[count++] = table->hashes[i];
+        }
+        table->count = count;
+
+        /* The replaced table is leaked, as it may be in use by a concurrent crash */
+        OSMemoryBarrier();
+        signal_handler_context.queued_stack_hashes = table;
+    }
+}
+
+
+/**
+ * Return the path to the shared live report image lists.
+ */
+- (NSString *) sharedImageListDirectory {
+    return [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_IMAGE_LIST_DIR];
+}
+
+
 /**
  * Return the path to live crash report (which may not yet, or ever, exist).
  */
@@ -1099,5 +3987,38 @@ cleanup:
 }
 
 
+/**
+ * Return the path to the shared report slot file, or nil if shared report slots are not configured.
+ */
+- (NSString *) sharedReportSlotsPath {
+    if (_config.sharedReportContainerPath == nil)
+        return nil;
+
+    NSString *dir = [_config.sharedReportContainerPath stringByAppendingPathComponent: PLCRASH_CACHE_DIR];
+    return [dir stringByAppendingPathComponent: PLCRASH_SHARED_REPORT_SLOTS];
+}
+
+/**
+ * Submit @a block to the shared background scheduler at utility QoS. Processing blocks are executed serially, in the
+ * order submitted, each within its own autorelease pool.
+ *
+ * If the block can not be submitted, it is executed on a global queue, ensuring that its completion handler is
+ * still called.
+ */
+- (void) scheduleProcessingBlock: (dispatch_block_t) block {
+    dispatch_block_t pooled = ^{
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        block();
+        [pool drain];
+    };
+
+    plcrash_error_t err = plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_UTILITY, 0, DISPATCH_TIME_FOREVER, pooled, NULL);
+    if (err != PLCRASH_ESUCCESS) {
+        NSDEBUG(@"Could not schedule report processing: %d", err);
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), pooled);
+    }
+}
+
+
 
 @end
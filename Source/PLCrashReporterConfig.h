@@ -28,6 +28,7 @@
 
 #import <Foundation/Foundation.h>
 #import "PLCrashFeatureConfig.h"
+#import "PLCrashMacros.h"
 
 /**
  * @ingroup enums
@@ -132,20 +133,206 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
      * it may return incorrect data should the runtime be changed incompatibly.
      */
     PLCrashReporterSymbolicationStrategyObjC = 1 << 1,
+
+    /**
+     * Use the dyld shared cache's local symbols to find function names within system libraries. On iOS, system
+     * library symbols are stripped from the in-memory symbol tables, and will otherwise be reported as '\<redacted>'.
+     * This requires that the shared cache's local symbols be readable by the process; if they are not, this strategy
+     * will simply not return any results.
+     */
+    PLCrashReporterSymbolicationStrategySharedCache = 1 << 2,
+
+    /**
+     * Defer symbolication until the next launch. Only the frames' PCs, and the binary images' UUIDs and load addresses,
+     * are written at crash time, substantially reducing the work performed by the crash handler. The pending report may
+     * then be symbolicated via -[PLCrashReporter symbolicatePendingCrashReportAndReturnError:], using the images loaded
+     * in the new process.
+     *
+     * When set, all other symbolication strategies are ignored.
+     */
+    PLCrashReporterSymbolicationStrategyDeferred = 1 << 3,
+
+    /**
+     * Use a symbol table embedded in the binary at build time to find the names of functions stripped from the
+     * binary's own symbol table. The table is generated from the unstripped binary via the plcrashutil embed-symbols
+     * command, and linked into the final binary's __PLCRASH,__syms section. Images without an embedded symbol table
+     * are unaffected.
+     */
+    PLCrashReporterSymbolicationStrategyEmbedded = 1 << 4,
     
     /**
      * Enable all available symbolication strategies.
      */
-    PLCrashReporterSymbolicationStrategyAll = (PLCrashReporterSymbolicationStrategySymbolTable|PLCrashReporterSymbolicationStrategyObjC)
+    PLCrashReporterSymbolicationStrategyAll = (PLCrashReporterSymbolicationStrategySymbolTable|PLCrashReporterSymbolicationStrategyObjC|PLCrashReporterSymbolicationStrategySharedCache|
+                                               PLCrashReporterSymbolicationStrategyEmbedded)
+};
+
+/**
+ * @ingroup enums
+ * Policies for flushing a written crash report to stable storage.
+ */
+typedef NS_ENUM(NSUInteger, PLCrashReporterFileSyncPolicy) {
+    /**
+     * Do not explicitly flush the report. The report is handed to the kernel via write(2) or a shared mapping, and
+     * will survive the process' termination, but may be lost should the device lose power or panic before the
+     * data is written back.
+     */
+    PLCrashReporterFileSyncPolicyNone = 0,
+
+    /**
+     * Call fsync(2) prior to closing the report. This pushes the report to the storage device, but the device may
+     * continue to hold the data in its own volatile write cache.
+     */
+    PLCrashReporterFileSyncPolicyFSync = 1,
+
+    /**
+     * Issue F_FULLFSYNC prior to closing the report, asking the storage device to flush its write cache. This is
+     * the most durable option, and also the most expensive; if the file system does not support F_FULLFSYNC,
+     * fsync(2) is used instead.
+     */
+    PLCrashReporterFileSyncPolicyFullFSync = 2
+};
+
+/**
+ * @ingroup enums
+ * Scheduling policies for the Mach exception server's thread.
+ */
+typedef NS_ENUM(NSUInteger, PLCrashReporterThreadScheduling) {
+    /** Use the default scheduling; the thread competes with all other threads of the same priority. */
+    PLCrashReporterThreadSchedulingDefault = 0,
+
+    /**
+     * Run at the user-interactive quality-of-service class, or at the maximum priority of the default scheduling
+     * policy on releases that predate QoS classes.
+     */
+    PLCrashReporterThreadSchedulingHighQoS = 1,
+
+    /**
+     * Run under the Mach time constraint (real-time) policy, scheduling the thread ahead of all non-realtime threads
+     * upon receipt of an exception. The kernel will demote the thread to the default policy should it exceed its
+     * requested computation time, as may occur while writing a large report.
+     */
+    PLCrashReporterThreadSchedulingTimeConstraint = 2
 };
 
-@interface PLCrashReporterConfig : NSObject {
+@interface PLCrashReporterConfig : NSObject <NSCopying, NSMutableCopying> {
 @private
     /** The configured signal handler type. */
     PLCrashReporterSignalHandlerType _signalHandlerType;
     
     /** The configured symbolication strategy. */
     PLCrashReporterSymbolicationStrategy _symbolicationStrategy;
+
+    /** The configured crash report write buffer size, in bytes. */
+    NSUInteger _writeBufferSize;
+
+    /** If true, crash reports will be written compressed. */
+    BOOL _shouldCompressReports;
+
+    /** The maximum number of stack frames to be written for a single thread. */
+    NSUInteger _maxThreadFrames;
+
+    /** The maximum number of stack frames to be written across all threads, or 0 if unlimited. */
+    NSUInteger _maxReportFrames;
+
+    /** The number of frames to be retained from the bottom of a truncated thread's stack, or 0. */
+    NSUInteger _tailThreadFrames;
+
+    /** The time budget for writing a crash report, in seconds, or 0 if unlimited. */
+    NSTimeInterval _writeTimeBudget;
+
+    /** If true, unreferenced binary images will be written as compact records. */
+    BOOL _shouldCompactUnreferencedImages;
+
+    /** If true, writer statistics will be recorded in each report. */
+    BOOL _shouldRecordWriterStatistics;
+
+    /** The number of bytes to preallocate for the crash report file, or 0. */
+    NSUInteger _reportFilePreallocationSize;
+
+    /** The policy used to flush written crash reports to stable storage. */
+    PLCrashReporterFileSyncPolicy _fileSyncPolicy;
+
+    /** The directory beneath which crash reports will be stored, or nil to use the user's caches directory. */
+    NSString *_reportVolumePath;
+
+    /** The number of breadcrumbs to be retained for inclusion in crash reports, or 0. */
+    NSUInteger _breadcrumbCapacity;
+
+    /** The maximum number of bytes of the crashed thread's memory to be included in crash reports, or 0. */
+    NSUInteger _memoryCaptureBudget;
+
+    /** If YES, frames that can not otherwise be unwound will be recovered by scanning the stack. */
+    BOOL _shouldScanStacks;
+
+    /** If YES, image symbol and ObjC method indexes are cached on disk across launches. */
+    BOOL _shouldCacheImageIndexes;
+
+    /** If YES, threads with identical stacks are written once, and referenced by their duplicates. */
+    BOOL _shouldCollapseIdenticalThreadStacks;
+
+    /** The maximum number of frames to be written for an idle thread, or 0 if idle threads are unwound in full. */
+    NSUInteger _idleThreadFrames;
+
+    /** If YES, live reports reference a shared image list file rather than including their binary images. */
+    BOOL _shouldShareLiveReportImageLists;
+
+    /** The number of consecutive launch crashes after which reduced reports are written, or 0 if disabled. */
+    NSUInteger _crashLoopThreshold;
+
+    /** If YES, crash-path memory is prefaulted and wired at enable time. */
+    BOOL _shouldPrefaultCrashMemory;
+
+    /** The maximum number of bytes retained by crash-path caches, or 0 if unlimited. */
+    NSUInteger _cacheMemoryLimit;
+
+    /** The size of the buffer to which crash-path debug output is written, or 0 if unbuffered. */
+    NSUInteger _debugLogBufferSize;
+
+    /** If YES, buffered debug output is embedded in each crash report. */
+    BOOL _shouldEmbedDebugLog;
+
+    /** The scheduling policy applied to the Mach exception server's thread. */
+    PLCrashReporterThreadScheduling _machExceptionThreadScheduling;
+
+    /** The size of the Mach exception server's pre-allocated and wired stack, or 0. */
+    NSUInteger _machExceptionThreadStackSize;
+
+    /** If YES, live reports are written by a pipeline of concurrent unwind, symbolication and encode stages. */
+    BOOL _shouldPipelineLiveReports;
+
+    /** If true, each thread's scheduling state and CPU usage will be recorded in each report. */
+    BOOL _shouldRecordThreadMetadata;
+
+    /** If YES, thread frames are written as packed PC and symbol arrays. */
+    BOOL _shouldPackThreadFrames;
+
+    /** If YES, the crash-time arena and class cache are sized from previously observed use. */
+    BOOL _shouldAdaptCrashMemorySizing;
+
+    /** If YES, crashes duplicating a queued report are recorded as occurrences rather than written as reports. */
+    BOOL _shouldSuppressDuplicateCrashes;
+
+    /** If YES, cheaper writer options are selected for reports estimated to exceed the report size limit. */
+    BOOL _shouldFitReportsToSizeLimit;
+
+    /** The shared container in which reports are written to preallocated slots, or nil. */
+    NSString *_sharedReportContainerPath;
+
+    /** If YES, a CRC-32C checksum trailer will be appended to each written report. */
+    BOOL _shouldChecksumReports;
+
+    /** If YES, crashed thread register values are annotated with the symbols they reference. */
+    BOOL _shouldAnnotateRegisters;
+
+    /** If YES, thread registers are written as a compact register state. */
+    BOOL _shouldWriteCompactRegisterState;
+
+    /** If YES, live reports are written from snapshots of each thread's registers and stack. */
+    BOOL _shouldSnapshotLiveReportStacks;
+
+    /** If YES, crash reports are written in the version 2 report format. */
+    BOOL _shouldWriteV2Reports;
 }
 
 + (instancetype) defaultConfiguration;
@@ -153,6 +340,635 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
 - (instancetype) init;
 - (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
                      symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath
+                     shouldChecksumReports: (BOOL) shouldChecksumReports PLCR_DEPRECATED;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath
+                     shouldChecksumReports: (BOOL) shouldChecksumReports
+                   shouldAnnotateRegisters: (BOOL) shouldAnnotateRegisters PLCR_DEPRECATED;
 
 /** The configured signal handler type. */
 @property(nonatomic, readonly) PLCrashReporterSignalHandlerType signalHandlerType;
@@ -160,6 +976,384 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
 /** The configured symbolication strategy. */
 @property(nonatomic, readonly) PLCrashReporterSymbolicationStrategy symbolicationStrategy;
 
+/**
+ * The size, in bytes, of the buffer used when writing crash reports. The buffer is allocated when the
+ * crash reporter is enabled; larger values reduce the number of write(2) calls issued from within the
+ * crash handler. A value of 0 selects the minimal built-in buffer.
+ */
+@property(nonatomic, readonly) NSUInteger writeBufferSize;
+
+/**
+ * If YES, crash reports will be compressed as they are written. Compressed reports are transparently decompressed
+ * by PLCrashReport, but can not be read by earlier PLCrashReporter releases.
+ */
+@property(nonatomic, readonly) BOOL shouldCompressReports;
+
+/**
+ * The maximum number of stack frames to be written for a single thread. Values larger than the default of 512 frames
+ * are clamped to the default.
+ */
+@property(nonatomic, readonly) NSUInteger maxThreadFrames;
+
+/**
+ * The maximum number of stack frames to be written across all threads of a report, or 0 if unlimited. Threads are
+ * written in order; once the budget has been exhausted, the remaining threads are written without a backtrace.
+ */
+@property(nonatomic, readonly) NSUInteger maxReportFrames;
+
+/**
+ * If non-zero, the number of frames to be retained from the bottom of a thread's stack when the stack exceeds
+ * maxThreadFrames. The first maxThreadFrames - tailThreadFrames frames are written, followed by the last
+ * tailThreadFrames frames, and the number of frames omitted between the two is recorded in the report.
+ *
+ * In this mode, runs of frames that repeat consecutively -- as produced by unbounded recursion -- are also collapsed
+ * into their first occurrence and a repeat count, and do not count against maxThreadFrames. Reports written in this
+ * mode can not be fully interpreted by earlier PLCrashReporter releases, which will present the written frames as a
+ * complete backtrace.
+ *
+ * This is clamped to 64 frames, and to half of maxThreadFrames.
+ */
+@property(nonatomic, readonly) NSUInteger tailThreadFrames;
+
+/**
+ * If non-zero, the wall-clock time, in seconds, within which a crash report should be written. The crashed thread,
+ * binary images, exception and signal information are written first, and the remaining threads are then written
+ * using progressively cheaper unwinding strategies -- disabling symbolication, and then all but frame pointer based
+ * unwinding -- as the budget is used up. Once the budget is exhausted, the remaining threads are written without
+ * backtraces.
+ *
+ * This is intended for platforms on which a watchdog will terminate a process that takes too long to exit, in which
+ * case a crash report that takes too long to write would be lost entirely.
+ */
+@property(nonatomic, readonly) NSTimeInterval writeTimeBudget;
+
+/**
+ * If YES, full binary image records -- including the image's path, size, and code type -- are only written for the
+ * images containing a reported stack frame or register value. The remaining images are recorded by base address and
+ * UUID alone, and are available via PLCrashReport::compactImages.
+ *
+ * Most reports reference only a small fraction of the process' loaded images; this reduces both the size of the
+ * report and the work performed by the crash handler.
+ */
+@property(nonatomic, readonly) BOOL shouldCompactUnreferencedImages;
+
+/**
+ * If YES, each crash report records the time spent in each phase of writing the report -- reading the image list,
+ * suspending threads, unwinding, symbolication, writing binary images, and writing to disk -- along with counts of
+ * memory object mappings, task memory reads, and allocator growth. This is intended for measuring the reporter's
+ * own crash-time overhead, and adds a small cost to every report written.
+ */
+@property(nonatomic, readonly) BOOL shouldRecordWriterStatistics;
+
+/**
+ * If non-zero, the number of bytes of storage to reserve for the crash report file via F_PREALLOCATE. Storage is
+ * reserved when the crash reporter is enabled for the pre-sized report file, and when the report file is opened from
+ * within the crash handler otherwise, so that writing the report does not require the file system to allocate
+ * blocks as the file grows. Values larger than the maximum report size are clamped to that size.
+ */
+@property(nonatomic, readonly) NSUInteger reportFilePreallocationSize;
+
+/**
+ * The policy used to flush a crash report to stable storage once it has been written. Defaults to
+ * PLCrashReporterFileSyncPolicyNone. Flushing is performed from within the crash handler, and its cost depends
+ * heavily on the storage device.
+ */
+@property(nonatomic, readonly) PLCrashReporterFileSyncPolicy fileSyncPolicy;
+
+/**
+ * The path of a directory, on the volume on which crash reports should be stored, beneath which the crash reporter
+ * will create its data directory. If nil, the user's caches directory is used.
+ */
+@property(nonatomic, readonly, copy) NSString *reportVolumePath;
+
+/**
+ * If non-zero, the number of breadcrumbs recorded via PLCrashReporter::appendBreadcrumb: to be retained for inclusion
+ * in crash reports; this is rounded up to a power of two. Breadcrumbs are written to a fixed-size ring, backed by a
+ * file in the crash reporter's data directory, that is created when the crash reporter is enabled; once the ring is
+ * full, the oldest breadcrumbs are overwritten. Defaults to 0, disabling breadcrumbs.
+ */
+@property(nonatomic, readonly) NSUInteger breadcrumbCapacity;
+
+/**
+ * If non-zero, the maximum number of bytes of the crashed thread's memory to be included in crash reports: the
+ * thread's stack, beginning at its stack pointer, followed by the memory surrounding each register value that
+ * references readable memory. The memory is available via PLCrashReport::memoryRegions. Captured memory may contain
+ * sensitive user data. Defaults to 0, disabling memory capture.
+ */
+@property(nonatomic, readonly) NSUInteger memoryCaptureBudget;
+
+/**
+ * If YES, a frame that can not be unwound via compact unwind, DWARF, or frame pointer data -- such as a frameless leaf
+ * function, or a frame with a corrupt frame pointer -- will be recovered by scanning the stack for a return address,
+ * rather than terminating the thread's backtrace. Scanning may produce spurious frames from stale return addresses
+ * left on the stack. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldScanStacks;
+
+/**
+ * If YES, a symbol index and (when ObjC symbolication is enabled) an ObjC method index are built for each loaded image
+ * on a low-priority background queue, allowing crash-time symbolication to binary search the indexes rather than
+ * scanning each image's symbol table and parsing its ObjC metadata. The indexes are cached within the crash reporter's
+ * data directory, keyed by each image's UUID; later launches load the cached indexes without rebuilding them.
+ * Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldCacheImageIndexes;
+
+/**
+ * If YES, the stack of each non-crashed thread that is identical to that of a previously written thread -- as is
+ * typical of idle worker threads -- is replaced by a reference to that thread, reducing the size of the report and
+ * the time spent writing and decoding it. The referenced thread's stack is provided by PLCrashReport for each of its
+ * duplicates. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldCollapseIdenticalThreadStacks;
+
+/**
+ * The maximum number of stack frames to be written for a non-crashed thread parked in one of the kernel syscall stubs
+ * in which idle threads wait -- such as mach_msg_trap or __workq_kernreturn. Such threads are unwound using only
+ * frame pointers, substantially reducing the time spent writing reports for processes with many idle threads. A value
+ * of 8 is typically sufficient to identify the thread's owner. Defaults to 0, in which case idle threads are unwound in
+ * full.
+ */
+@property(nonatomic, readonly) NSUInteger idleThreadFrames;
+
+/**
+ * If YES, the binary images of live reports generated via PLCrashReporter::generateLiveReportWithThread: and related
+ * methods are written once to a shared image list file in the crash reporter's data directory, and each report
+ * references that file in place of including its own binary images. The file is rewritten only when an image is loaded
+ * or unloaded, eliminating the majority of each report's size for processes that sample live reports repeatedly. Such
+ * reports must be resolved against their image list via PLCrashReporter::resolveSharedImageListForReport:error: (or
+ * PLCrashReport::resolveSharedImageListWithData:error:) prior to their images being available. Crash reports written
+ * by the signal handler always include their images. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldShareLiveReportImageLists;
+
+/**
+ * The number of consecutive launches that may end in a crash before the process is considered to be in a crash loop.
+ * A crash within the first seconds after the crash reporter is enabled counts as a launch crash; the count is persisted
+ * in the crash reporter's data directory, and is reset once a launch survives the launch interval. While in a crash
+ * loop, each further launch crash is written as a reduced report containing only the crashed thread, the exception,
+ * and the images they reference, and a crash whose stack hash matches that of the previous launch crash is not
+ * reported at all. This bounds the time spent writing and processing reports while the application is unable to
+ * launch. Defaults to 0, in which case crash loop detection is disabled.
+ */
+@property(nonatomic, readonly) NSUInteger crashLoopThreshold;
+
+/**
+ * If YES, the memory touched while writing a crash report -- the crash-time allocator pages, the Objective-C class
+ * cache, and the report write buffer or mapped report file -- is faulted in and wired via mlock() when the crash
+ * reporter is enabled, avoiding first-touch page faults from within the crash handler, which are slow and may fail
+ * outright under memory pressure. The symbol and string tables of loaded images are also read ahead via
+ * madvise(MADV_WILLNEED) from a background queue. Wiring is subject to the process' wired memory limit; on failure,
+ * the memory is still prefaulted. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldPrefaultCrashMemory;
+
+/**
+ * The maximum number of bytes of memory to be retained by the caches used while writing a report -- the Objective-C
+ * class cache, the symbol table mappings, and the DWARF and compact unwind caches. Once the limit is reached, the least
+ * recently used cache that can release its memory is asked to do so, and a cache that cannot be accommodated is
+ * bypassed; symbolication and unwinding remain correct, but may be slower. Defaults to 0, in which case the caches
+ * are not limited.
+ */
+@property(nonatomic, readonly) NSUInteger cacheMemoryLimit;
+
+/**
+ * The size, in bytes, of an in-memory ring buffer to which the crash reporter's debug output is written while a
+ * crash report is being written. The buffered output is written to stderr with a single write once the report is
+ * complete; if the output exceeds the buffer, only the most recent output is retained. Defaults to 0, in which case
+ * each debug message is written directly to stderr.
+ *
+ * Debug output is only emitted by non-release builds of the crash reporter.
+ */
+@property(nonatomic, readonly) NSUInteger debugLogBufferSize;
+
+/**
+ * If YES, and debugLogBufferSize is non-zero, the buffered debug output is also written to each crash report, and is
+ * available via PLCrashReport::debugLog. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldEmbedDebugLog;
+
+/**
+ * The scheduling policy applied to the Mach exception server's thread, bounding the delay between an exception and
+ * the start of the crash handler on a heavily loaded system. Failure to apply the policy is not fatal. Only applies to
+ * PLCrashReporterSignalHandlerTypeMach. Defaults to PLCrashReporterThreadSchedulingDefault.
+ */
+@property(nonatomic, readonly) PLCrashReporterThreadScheduling machExceptionThreadScheduling;
+
+/**
+ * If non-zero, the Mach exception server's thread runs on a pre-allocated stack of at least this many bytes, guarded
+ * by an inaccessible page, which is faulted in and wired via mlock() when the crash reporter is enabled; handling an
+ * exception will not incur page faults on the handler's stack. Wiring is subject to the process' wired memory limit; on
+ * failure, the stack is still prefaulted. Only applies to PLCrashReporterSignalHandlerTypeMach. Defaults to 0, in which
+ * case the default thread stack is used.
+ */
+@property(nonatomic, readonly) NSUInteger machExceptionThreadStackSize;
+
+/**
+ * If YES, live reports are written by a three-stage pipeline: a dedicated thread unwinds each thread's stack, a second
+ * thread symbolicates the unwound frames, and the calling thread encodes and writes each thread as soon as it has been
+ * symbolicated. The stages run concurrently, and the time spent writing the report's threads is bounded by the
+ * slowest stage rather than the sum of all three. This replaces the parallel unwinding otherwise used by live
+ * reports. Has no effect on crash reports. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldPipelineLiveReports;
+
+/**
+ * If YES, each report records the scheduling state and CPU usage of every thread, gathered with a single thread_info()
+ * call per thread while the threads are suspended (see PLCrashReport::threadMetadata). This allows the threads of a
+ * live report or hang report to be ranked by CPU consumption. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldRecordThreadMetadata;
+
+/**
+ * If YES, each thread's frames are written as a packed array of PCs and a packed array of references into the report's
+ * symbol string table, rather than as a message per frame. This reduces the size of reports and the cost of writing
+ * them, and the PCs of each thread are decoded as a single contiguous array. Reports written in this form can not be
+ * read by decoders older than this release. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldPackThreadFrames;
+
+/**
+ * If YES, the peak use of the crash-time writer's scratch arena and the number of Objective-C classes cached while
+ * writing each crash report and live report are recorded in the crash report directory, and the next launch
+ * pre-allocates the arena and class cache from the 99th percentile of the recorded samples, rather than from a fixed
+ * 64KB arena and the number of registered classes. This avoids both allocator growth via vm_allocate() from within the
+ * crash handler and the resident memory of an oversized class cache. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldAdaptCrashMemorySizing;
+
+/**
+ * If YES, a crash whose crashed thread stack hash matches that of a report already in the queue of reports awaiting
+ * submission (see PLCrashReporter::queuePendingCrashReportAndReturnError:) is not written as a new report. The crash
+ * handler instead appends a compact occurrence record, holding the crash's time and signal, to the queue directory,
+ * and duplicates may be counted via PLCrashReporter::duplicateCrashCountForReport:. This avoids the cost of writing,
+ * and later uploading, reports for a crash that has already been captured. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldSuppressDuplicateCrashes;
+
+/**
+ * If YES, the encoded size of each report is estimated from the number of threads, the configured frame limits and the
+ * loaded images before any thread is written. Should the estimate exceed the report size limit, packed frames,
+ * collapsing of identical thread stacks, compact records for unreferenced images, and shallow unwinding of idle threads
+ * are enabled in turn until the report is estimated to fit. The crashed thread is always written in full. Without this
+ * option, a report that exceeds the limit is truncated. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldFitReportsToSizeLimit;
+
+/**
+ * The path of a directory shared by an application and its extensions -- typically an App Group container -- in
+ * which crash reports will be written to a single, preallocated file of fixed-size report slots. Each process that
+ * enables a crash reporter with the same container maps the same file, and a crashing process claims a free slot
+ * at crash time; no per-process report file is created. Pending reports from every process may then be collected by
+ * the host application via PLCrashReporter::queueSharedCrashReportsAndReturnError:. Should all slots be in use, the
+ * report is written to the crash reporter's own data directory. If nil, shared report slots are disabled. Defaults
+ * to nil.
+ */
+@property(nonatomic, readonly, copy) NSString *sharedReportContainerPath;
+
+/**
+ * If YES, a CRC-32C checksum of each crash report is computed as it is written, and appended to the report as a
+ * trailer. The checksum is verified by PLCrashReport prior to decoding, and corrupt reports are rejected with
+ * PLCrashReporterErrorCrashReportInvalid. Checksummed reports can not be read by earlier PLCrashReporter releases.
+ *
+ * Where available, the checksum is computed using the CPU's CRC-32C instructions (SSE4.2 or ARMv8 CRC32). Reports
+ * written with the single-pass (backpatched) encoding are checksummed in one additional read of the written report
+ * when it is closed; compressed reports are checksummed as they are written.
+ */
+@property(nonatomic, readonly) BOOL shouldChecksumReports;
+
+/**
+ * If YES, each register value written for a crashed thread is annotated with the symbol it references, available via
+ * PLCrashReportRegisterInfo::symbolInfo. This avoids a separate symbolication pass over the register values when the
+ * report is processed.
+ *
+ * Annotation only uses the per-image sorted symbol indexes, performing a binary search per register; values within
+ * images for which no symbol index has been built are not annotated. Symbol indexes are built when
+ * shouldCacheImageIndexes is enabled. Annotated reports remain readable by earlier PLCrashReporter releases, which
+ * ignore the annotations.
+ *
+ * Annotations are only written with the compact register state; see shouldWriteCompactRegisterState.
+ */
+@property(nonatomic, readonly) BOOL shouldAnnotateRegisters;
+
+/**
+ * If YES, each thread's registers are written as a single compact register state -- the Mach CPU type and a packed
+ * sequence of register values -- rather than as a named value per register. This reduces report size and writing time.
+ *
+ * Earlier PLCrashReporter releases will find no register values in reports written with the compact register state.
+ */
+@property(nonatomic, readonly) BOOL shouldWriteCompactRegisterState;
+
+/**
+ * If YES, live and hang reports capture each thread's registers and the top of its stack, and resume all threads
+ * before unwinding and writing the report. This shortens the period for which the process is suspended to the time
+ * required to copy the stacks.
+ *
+ * Snapshotted stacks are unwound using frame pointers only; frames of functions that do not maintain a frame pointer
+ * may be missing from the report. Has no effect on crash reports. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldSnapshotLiveReportStacks;
+
+/**
+ * If YES, crash reports are written in the version 2 report format (#PLCRASH_REPORT_FILE_VERSION_V2), which carries
+ * each thread's registers in a per-architecture message and its frames as packed arrays referencing a single symbol
+ * string table. Only the report, host, process, signal and exception information, the threads and the binary images
+ * are written; the options that add other content to a report have no effect on version 2 reports.
+ *
+ * Earlier PLCrashReporter releases can not decode version 2 reports. Defaults to NO.
+ */
+@property(nonatomic, readonly) BOOL shouldWriteV2Reports;
+
 
 @end
 
+/**
+ * A mutable PLCrashReporterConfig. All options default to the values used by -[PLCrashReporterConfig init], and may be
+ * set individually prior to creating a PLCrashReporter; see the PLCrashReporterConfig documentation of each option.
+ *
+ * The crash reporter copies its configuration, and later changes to a mutable configuration have no effect on
+ * an already initialized crash reporter.
+ */
+@interface PLMutableCrashReporterConfig : PLCrashReporterConfig
+
+@property(nonatomic, readwrite) PLCrashReporterSignalHandlerType signalHandlerType;
+@property(nonatomic, readwrite) PLCrashReporterSymbolicationStrategy symbolicationStrategy;
+@property(nonatomic, readwrite) NSUInteger writeBufferSize;
+@property(nonatomic, readwrite) BOOL shouldCompressReports;
+@property(nonatomic, readwrite) NSUInteger maxThreadFrames;
+@property(nonatomic, readwrite) NSUInteger maxReportFrames;
+@property(nonatomic, readwrite) NSUInteger tailThreadFrames;
+@property(nonatomic, readwrite) NSTimeInterval writeTimeBudget;
+@property(nonatomic, readwrite) BOOL shouldCompactUnreferencedImages;
+@property(nonatomic, readwrite) BOOL shouldRecordWriterStatistics;
+@property(nonatomic, readwrite) NSUInteger reportFilePreallocationSize;
+@property(nonatomic, readwrite) PLCrashReporterFileSyncPolicy fileSyncPolicy;
+@property(nonatomic, copy) NSString *reportVolumePath;
+@property(nonatomic, readwrite) NSUInteger breadcrumbCapacity;
+@property(nonatomic, readwrite) NSUInteger memoryCaptureBudget;
+@property(nonatomic, readwrite) BOOL shouldScanStacks;
+@property(nonatomic, readwrite) BOOL shouldCacheImageIndexes;
+@property(nonatomic, readwrite) BOOL shouldCollapseIdenticalThreadStacks;
+@property(nonatomic, readwrite) NSUInteger idleThreadFrames;
+@property(nonatomic, readwrite) BOOL shouldShareLiveReportImageLists;
+@property(nonatomic, readwrite) NSUInteger crashLoopThreshold;
+@property(nonatomic, readwrite) BOOL shouldPrefaultCrashMemory;
+@property(nonatomic, readwrite) NSUInteger cacheMemoryLimit;
+@property(nonatomic, readwrite) NSUInteger debugLogBufferSize;
+@property(nonatomic, readwrite) BOOL shouldEmbedDebugLog;
+@property(nonatomic, readwrite) PLCrashReporterThreadScheduling machExceptionThreadScheduling;
+@property(nonatomic, readwrite) NSUInteger machExceptionThreadStackSize;
+@property(nonatomic, readwrite) BOOL shouldPipelineLiveReports;
+@property(nonatomic, readwrite) BOOL shouldRecordThreadMetadata;
+@property(nonatomic, readwrite) BOOL shouldPackThreadFrames;
+@property(nonatomic, readwrite) BOOL shouldAdaptCrashMemorySizing;
+@property(nonatomic, readwrite) BOOL shouldSuppressDuplicateCrashes;
+@property(nonatomic, readwrite) BOOL shouldFitReportsToSizeLimit;
+@property(nonatomic, copy) NSString *sharedReportContainerPath;
+@property(nonatomic, readwrite) BOOL shouldChecksumReports;
+@property(nonatomic, readwrite) BOOL shouldAnnotateRegisters;
+@property(nonatomic, readwrite) BOOL shouldWriteCompactRegisterState;
+@property(nonatomic, readwrite) BOOL shouldSnapshotLiveReportStacks;
+@property(nonatomic, readwrite) BOOL shouldWriteV2Reports;
+
+@end
@@ -28,6 +28,61 @@
 
 #import "PLCrashReporterConfig.h"
 
+/**
+ * @internal
+ * The default crash report write buffer size. This is large enough to hold a typical report in its entirety,
+ * allowing the report to be written with a single write(2).
+ */
+#define PLCRASH_DEFAULT_WRITE_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @internal
+ * The default maximum number of stack frames written for a single thread.
+ */
+#define PLCRASH_DEFAULT_MAX_THREAD_FRAMES 512
+
+@interface PLCrashReporterConfig ()
+@property(nonatomic, readwrite) PLCrashReporterSignalHandlerType signalHandlerType;
+@property(nonatomic, readwrite) PLCrashReporterSymbolicationStrategy symbolicationStrategy;
+@property(nonatomic, readwrite) NSUInteger writeBufferSize;
+@property(nonatomic, readwrite) BOOL shouldCompressReports;
+@property(nonatomic, readwrite) NSUInteger maxThreadFrames;
+@property(nonatomic, readwrite) NSUInteger maxReportFrames;
+@property(nonatomic, readwrite) NSUInteger tailThreadFrames;
+@property(nonatomic, readwrite) NSTimeInterval writeTimeBudget;
+@property(nonatomic, readwrite) BOOL shouldCompactUnreferencedImages;
+@property(nonatomic, readwrite) BOOL shouldRecordWriterStatistics;
+@property(nonatomic, readwrite) NSUInteger reportFilePreallocationSize;
+@property(nonatomic, readwrite) PLCrashReporterFileSyncPolicy fileSyncPolicy;
+@property(nonatomic, readwrite, copy) NSString *reportVolumePath;
+@property(nonatomic, readwrite) NSUInteger breadcrumbCapacity;
+@property(nonatomic, readwrite) NSUInteger memoryCaptureBudget;
+@property(nonatomic, readwrite) BOOL shouldScanStacks;
+@property(nonatomic, readwrite) BOOL shouldCacheImageIndexes;
+@property(nonatomic, readwrite) BOOL shouldCollapseIdenticalThreadStacks;
+@property(nonatomic, readwrite) NSUInteger idleThreadFrames;
+@property(nonatomic, readwrite) BOOL shouldShareLiveReportImageLists;
+@property(nonatomic, readwrite) NSUInteger crashLoopThreshold;
+@property(nonatomic, readwrite) BOOL shouldPrefaultCrashMemory;
+@property(nonatomic, readwrite) NSUInteger cacheMemoryLimit;
+@property(nonatomic, readwrite) NSUInteger debugLogBufferSize;
+@property(nonatomic, readwrite) BOOL shouldEmbedDebugLog;
+@property(nonatomic, readwrite) PLCrashReporterThreadScheduling machExceptionThreadScheduling;
+@property(nonatomic, readwrite) NSUInteger machExceptionThreadStackSize;
+@property(nonatomic, readwrite) BOOL shouldPipelineLiveReports;
+@property(nonatomic, readwrite) BOOL shouldRecordThreadMetadata;
+@property(nonatomic, readwrite) BOOL shouldPackThreadFrames;
+@property(nonatomic, readwrite) BOOL shouldAdaptCrashMemorySizing;
+@property(nonatomic, readwrite) BOOL shouldSuppressDuplicateCrashes;
+@property(nonatomic, readwrite) BOOL shouldFitReportsToSizeLimit;
+@property(nonatomic, readwrite, copy) NSString *sharedReportContainerPath;
+@property(nonatomic, readwrite) BOOL shouldChecksumReports;
+@property(nonatomic, readwrite) BOOL shouldAnnotateRegisters;
+@property(nonatomic, readwrite) BOOL shouldWriteCompactRegisterState;
+@property(nonatomic, readwrite) BOOL shouldSnapshotLiveReportStacks;
+@property(nonatomic, readwrite) BOOL shouldWriteV2Reports;
+@end
+
 /**
  * Crash Reporter Configuration.
  *
@@ -37,6 +92,43 @@
 
 @synthesize signalHandlerType = _signalHandlerType;
 @synthesize symbolicationStrategy = _symbolicationStrategy;
+@synthesize writeBufferSize = _writeBufferSize;
+@synthesize shouldCompressReports = _shouldCompressReports;
+@synthesize maxThreadFrames = _maxThreadFrames;
+@synthesize maxReportFrames = _maxReportFrames;
+@synthesize tailThreadFrames = _tailThreadFrames;
+@synthesize writeTimeBudget = _writeTimeBudget;
+@synthesize shouldCompactUnreferencedImages = _shouldCompactUnreferencedImages;
+@synthesize shouldRecordWriterStatistics = _shouldRecordWriterStatistics;
+@synthesize reportFilePreallocationSize = _reportFilePreallocationSize;
+@synthesize fileSyncPolicy = _fileSyncPolicy;
+@synthesize reportVolumePath = _reportVolumePath;
+@synthesize breadcrumbCapacity = _breadcrumbCapacity;
+@synthesize memoryCaptureBudget = _memoryCaptureBudget;
+@synthesize shouldScanStacks = _shouldScanStacks;
+@synthesize shouldCacheImageIndexes = _shouldCacheImageIndexes;
+@synthesize shouldCollapseIdenticalThreadStacks = _shouldCollapseIdenticalThreadStacks;
+@synthesize idleThreadFrames = _idleThreadFrames;
+@synthesize shouldShareLiveReportImageLists = _shouldShareLiveReportImageLists;
+@synthesize crashLoopThreshold = _crashLoopThreshold;
+@synthesize shouldPrefaultCrashMemory = _shouldPrefaultCrashMemory;
+@synthesize cacheMemoryLimit = _cacheMemoryLimit;
+@synthesize debugLogBufferSize = _debugLogBufferSize;
+@synthesize shouldEmbedDebugLog = _shouldEmbedDebugLog;
+@synthesize machExceptionThreadScheduling = _machExceptionThreadScheduling;
+@synthesize machExceptionThreadStackSize = _machExceptionThreadStackSize;
+@synthesize shouldPipelineLiveReports = _shouldPipelineLiveReports;
+@synthesize shouldRecordThreadMetadata = _shouldRecordThreadMetadata;
+@synthesize shouldPackThreadFrames = _shouldPackThreadFrames;
+@synthesize shouldAdaptCrashMemorySizing = _shouldAdaptCrashMemorySizing;
+@synthesize shouldSuppressDuplicateCrashes = _shouldSuppressDuplicateCrashes;
+@synthesize shouldFitReportsToSizeLimit = _shouldFitReportsToSizeLimit;
+@synthesize sharedReportContainerPath = _sharedReportContainerPath;
+@synthesize shouldChecksumReports = _shouldChecksumReports;
+@synthesize shouldAnnotateRegisters = _shouldAnnotateRegisters;
+@synthesize shouldWriteCompactRegisterState = _shouldWriteCompactRegisterState;
+@synthesize shouldSnapshotLiveReportStacks = _shouldSnapshotLiveReportStacks;
+@synthesize shouldWriteV2Reports = _shouldWriteV2Reports;
 
 /**
  * Return the default local configuration.
@@ -54,7 +146,8 @@
 }
 
 /**
- * Initialize a new PLCrashReporterConfig instance.
+ * Initialize a new PLCrashReporterConfig instance. All other options are set to their defaults; use
+ * PLMutableCrashReporterConfig to configure them.
  *
  * @param signalHandlerType The requested signal handler type.
  * @param symbolicationStrategy A local symbolication strategy.
@@ -67,8 +160,2858 @@
 
     _signalHandlerType = signalHandlerType;
     _symbolicationStrategy = symbolicationStrategy;
+    _writeBufferSize = PLCRASH_DEFAULT_WRITE_BUFFER_SIZE;
+    _shouldCompressReports = NO;
+    _maxThreadFrames = PLCRASH_DEFAULT_MAX_THREAD_FRAMES;
+    _maxReportFrames = 0;
+    _tailThreadFrames = 0;
+    _writeTimeBudget = 0;
+    _shouldCompactUnreferencedImages = NO;
+    _shouldRecordWriterStatistics = NO;
+    _reportFilePreallocationSize = 0;
+    _fileSyncPolicy = PLCrashReporterFileSyncPolicyNone;
+    _breadcrumbCapacity = 0;
+    _memoryCaptureBudget = 0;
+    _shouldScanStacks = NO;
+    _shouldCacheImageIndexes = NO;
+    _shouldCollapseIdenticalThreadStacks = NO;
+    _idleThreadFrames = 0;
+    _shouldShareLiveReportImageLists = NO;
+    _crashLoopThreshold = 0;
+    _shouldPrefaultCrashMemory = NO;
+    _cacheMemoryLimit = 0;
+    _debugLogBufferSize = 0;
+    _shouldEmbedDebugLog = NO;
+    _machExceptionThreadScheduling = PLCrashReporterThreadSchedulingDefault;
+    _machExceptionThreadStackSize = 0;
+    _shouldPipelineLiveReports = NO;
+    _shouldRecordThreadMetadata = NO;
+    _shouldPackThreadFrames = NO;
+    _shouldAdaptCrashMemorySizing = NO;
+    _shouldSuppressDuplicateCrashes = NO;
+    _shouldFitReportsToSizeLimit = NO;
+    _shouldChecksumReports = NO;
+    _shouldAnnotateRegisters = NO;
+    _shouldWriteCompactRegisterState = NO;
+    _shouldSnapshotLiveReportStacks = NO;
+    _shouldWriteV2Reports = NO;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
 
     return self;
 }
 
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ * @param shouldSuppressDuplicateCrashes If YES, a crash whose stack hash matches that of a queued crash report is recorded as a compact occurrence rather than as a full report.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+    _shouldSuppressDuplicateCrashes = shouldSuppressDuplicateCrashes;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ * @param shouldSuppressDuplicateCrashes If YES, a crash whose stack hash matches that of a queued crash report is recorded as a compact occurrence rather than as a full report.
+ * @param shouldFitReportsToSizeLimit If YES, cheaper writer options are selected for any report whose estimated size exceeds the report size limit.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+    _shouldSuppressDuplicateCrashes = shouldSuppressDuplicateCrashes;
+    _shouldFitReportsToSizeLimit = shouldFitReportsToSizeLimit;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ * @param shouldSuppressDuplicateCrashes If YES, a crash whose stack hash matches that of a queued crash report is recorded as a compact occurrence rather than as a full report.
+ * @param shouldFitReportsToSizeLimit If YES, cheaper writer options are selected for any report whose estimated size exceeds the report size limit.
+ * @param sharedReportContainerPath The path of a directory shared with other processes -- typically an App Group container -- in which crash reports should be written to a shared file of preallocated report slots, or nil to write reports to the crash reporter's own data directory.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+    _shouldSuppressDuplicateCrashes = shouldSuppressDuplicateCrashes;
+    _shouldFitReportsToSizeLimit = shouldFitReportsToSizeLimit;
+    _sharedReportContainerPath = [sharedReportContainerPath copy];
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ * @param shouldSuppressDuplicateCrashes If YES, a crash whose stack hash matches that of a queued crash report is recorded as a compact occurrence rather than as a full report.
+ * @param shouldFitReportsToSizeLimit If YES, cheaper writer options are selected for any report whose estimated size exceeds the report size limit.
+ * @param sharedReportContainerPath The path of a directory shared with other processes -- typically an App Group container -- in which crash reports should be written to a shared file of preallocated report slots, or nil to write reports to the crash reporter's own data directory.
+ * @param shouldChecksumReports If YES, a CRC-32C checksum trailer will be appended to each written report, allowing corruption to be detected prior to decoding.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath
+                     shouldChecksumReports: (BOOL) shouldChecksumReports
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+    _shouldSuppressDuplicateCrashes = shouldSuppressDuplicateCrashes;
+    _shouldFitReportsToSizeLimit = shouldFitReportsToSizeLimit;
+    _sharedReportContainerPath = [sharedReportContainerPath copy];
+    _shouldChecksumReports = shouldChecksumReports;
+
+    return self;
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @deprecated Use PLMutableCrashReporterConfig to configure options other than the signal handler type and
+ * symbolication strategy.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param writeBufferSize The size, in bytes, of the buffer to be used when writing crash reports, or 0 to
+ * use the minimal built-in buffer.
+ * @param shouldCompressReports If YES, crash reports will be compressed as they are written.
+ * @param maxThreadFrames The maximum number of stack frames to be written for a single thread.
+ * @param maxReportFrames The maximum number of stack frames to be written across all threads, or 0 for no limit.
+ * @param tailThreadFrames The number of frames to be retained from the bottom of a truncated thread's stack, or 0 to
+ * simply truncate the stack at @a maxThreadFrames.
+ * @param writeTimeBudget The time, in seconds, within which a crash report should be written, or 0 for no limit.
+ * @param shouldCompactUnreferencedImages If YES, binary images not referenced by the report's frames or registers
+ * will be written as compact records.
+ * @param shouldRecordWriterStatistics If YES, the cost of writing each crash report will be recorded in the report.
+ * @param reportFilePreallocationSize The number of bytes to preallocate for the crash report file, or 0.
+ * @param fileSyncPolicy The policy used to flush written crash reports to stable storage.
+ * @param reportVolumePath The directory beneath which crash reports will be stored, or nil to use the user's caches
+ * directory.
+ * @param breadcrumbCapacity The number of breadcrumbs to be retained for inclusion in crash reports, or 0 to disable
+ * breadcrumbs.
+ * @param memoryCaptureBudget The maximum number of bytes of the crashed thread's memory to be included in crash
+ * reports, or 0 to disable memory capture.
+ * @param shouldScanStacks If YES, frames that can not be unwound via compact unwind, DWARF, or frame pointer data
+ * will be recovered by scanning the stack for return addresses.
+ * @param shouldCacheImageIndexes If YES, the symbol and ObjC method indexes built for each loaded image are cached
+ * on
+ * disk, keyed by the image's UUID, and loaded by later launches rather than rebuilt.
+ * @param shouldCollapseIdenticalThreadStacks If YES, the stack of each non-crashed thread that is identical to that
+ * of
+ * a previously written thread will be replaced by a reference to that thread.
+ * @param idleThreadFrames The maximum number of stack frames to be written for a thread parked in an idle syscall
+ * stub, or 0 to unwind idle threads in full.
+ * @param shouldShareLiveReportImageLists If YES, live reports reference a shared image list written once per set of
+ * loaded images, rather than including their own binary images. See shouldShareLiveReportImageLists.
+ * @param crashLoopThreshold The number of consecutive launch crashes after which subsequent launch crashes are
+ * written
+ * as reduced reports, and duplicate launch crashes are not reported. Pass 0 to disable crash loop detection.
+ * @param shouldPrefaultCrashMemory If YES, the memory used to write a crash report is prefaulted and wired when the
+ * crash reporter is enabled, and the symbol tables of loaded images are read ahead in the background. See
+ * shouldPrefaultCrashMemory.
+ * @param cacheMemoryLimit The maximum number of bytes of memory to be retained by the caches used while writing a
+ * report, or 0 if unlimited. See cacheMemoryLimit.
+ * @param debugLogBufferSize The size of the in-memory buffer to which debug output is written while writing a
+ * report, or 0 to write debug output directly to stderr. See debugLogBufferSize.
+ * @param shouldEmbedDebugLog If YES, the buffered debug output is also written to each crash report. See
+ * shouldEmbedDebugLog.
+ * @param machExceptionThreadScheduling The scheduling policy to be applied to the Mach exception server's thread.
+ * See machExceptionThreadScheduling.
+ * @param machExceptionThreadStackSize The size of the Mach exception server thread's pre-allocated and wired stack,
+ * or 0. See machExceptionThreadStackSize.
+ * @param shouldPipelineLiveReports If YES, live reports are unwound, symbolicated and encoded by concurrent pipeline
+ * stages. See shouldPipelineLiveReports.
+ * @param shouldRecordThreadMetadata If YES, each thread's scheduling state and CPU usage will be recorded in each report.
+ * @param shouldPackThreadFrames If YES, each thread's frames will be written as packed arrays of PCs and symbol references.
+ * @param shouldAdaptCrashMemorySizing If YES, the crash-time writer's arena and Objective-C class cache are sized from the use observed by previous reports.
+ * @param shouldSuppressDuplicateCrashes If YES, a crash whose stack hash matches that of a queued crash report is recorded as a compact occurrence rather than as a full report.
+ * @param shouldFitReportsToSizeLimit If YES, cheaper writer options are selected for any report whose estimated size exceeds the report size limit.
+ * @param sharedReportContainerPath The path of a directory shared with other processes -- typically an App Group container -- in which crash reports should be written to a shared file of preallocated report slots, or nil to write reports to the crash reporter's own data directory.
+ * @param shouldChecksumReports If YES, a CRC-32C checksum trailer will be appended to each written report, allowing corruption to be detected prior to decoding.
+ * @param shouldAnnotateRegisters If YES, crashed thread register values will be annotated with the symbols they reference.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                           writeBufferSize: (NSUInteger) writeBufferSize
+                     shouldCompressReports: (BOOL) shouldCompressReports
+                           maxThreadFrames: (NSUInteger) maxThreadFrames
+                           maxReportFrames: (NSUInteger) maxReportFrames
+                          tailThreadFrames: (NSUInteger) tailThreadFrames
+                           writeTimeBudget: (NSTimeInterval) writeTimeBudget
+           shouldCompactUnreferencedImages: (BOOL) shouldCompactUnreferencedImages
+              shouldRecordWriterStatistics: (BOOL) shouldRecordWriterStatistics
+               reportFilePreallocationSize: (NSUInteger) reportFilePreallocationSize
+                            fileSyncPolicy: (PLCrashReporterFileSyncPolicy) fileSyncPolicy
+                          reportVolumePath: (NSString *) reportVolumePath
+                        breadcrumbCapacity: (NSUInteger) breadcrumbCapacity
+                       memoryCaptureBudget: (NSUInteger) memoryCaptureBudget
+                          shouldScanStacks: (BOOL) shouldScanStacks
+                   shouldCacheImageIndexes: (BOOL) shouldCacheImageIndexes
+       shouldCollapseIdenticalThreadStacks: (BOOL) shouldCollapseIdenticalThreadStacks
+                          idleThreadFrames: (NSUInteger) idleThreadFrames
+           shouldShareLiveReportImageLists: (BOOL) shouldShareLiveReportImageLists
+                        crashLoopThreshold: (NSUInteger) crashLoopThreshold
+                 shouldPrefaultCrashMemory: (BOOL) shouldPrefaultCrashMemory
+                          cacheMemoryLimit: (NSUInteger) cacheMemoryLimit
+                        debugLogBufferSize: (NSUInteger) debugLogBufferSize
+                       shouldEmbedDebugLog: (BOOL) shouldEmbedDebugLog
+             machExceptionThreadScheduling: (PLCrashReporterThreadScheduling) machExceptionThreadScheduling
+              machExceptionThreadStackSize: (NSUInteger) machExceptionThreadStackSize
+                 shouldPipelineLiveReports: (BOOL) shouldPipelineLiveReports
+                shouldRecordThreadMetadata: (BOOL) shouldRecordThreadMetadata
+                    shouldPackThreadFrames: (BOOL) shouldPackThreadFrames
+              shouldAdaptCrashMemorySizing: (BOOL) shouldAdaptCrashMemorySizing
+            shouldSuppressDuplicateCrashes: (BOOL) shouldSuppressDuplicateCrashes
+               shouldFitReportsToSizeLimit: (BOOL) shouldFitReportsToSizeLimit
+                 sharedReportContainerPath: (NSString *) sharedReportContainerPath
+                     shouldChecksumReports: (BOOL) shouldChecksumReports
+                   shouldAnnotateRegisters: (BOOL) shouldAnnotateRegisters
+{
+    if ((self = [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy]) == nil)
+        return nil;
+
+    _writeBufferSize = writeBufferSize;
+    _shouldCompressReports = shouldCompressReports;
+    _maxThreadFrames = maxThreadFrames;
+    _maxReportFrames = maxReportFrames;
+    _tailThreadFrames = tailThreadFrames;
+    _writeTimeBudget = writeTimeBudget;
+    _shouldCompactUnreferencedImages = shouldCompactUnreferencedImages;
+    _shouldRecordWriterStatistics = shouldRecordWriterStatistics;
+    _reportFilePreallocationSize = reportFilePreallocationSize;
+    _fileSyncPolicy = fileSyncPolicy;
+    _reportVolumePath = [reportVolumePath copy];
+    _breadcrumbCapacity = breadcrumbCapacity;
+    _memoryCaptureBudget = memoryCaptureBudget;
+    _shouldScanStacks = shouldScanStacks;
+    _shouldCacheImageIndexes = shouldCacheImageIndexes;
+    _shouldCollapseIdenticalThreadStacks = shouldCollapseIdenticalThreadStacks;
+    _idleThreadFrames = idleThreadFrames;
+    _shouldShareLiveReportImageLists = shouldShareLiveReportImageLists;
+    _crashLoopThreshold = crashLoopThreshold;
+    _shouldPrefaultCrashMemory = shouldPrefaultCrashMemory;
+    _cacheMemoryLimit = cacheMemoryLimit;
+    _debugLogBufferSize = debugLogBufferSize;
+    _shouldEmbedDebugLog = shouldEmbedDebugLog;
+    _machExceptionThreadScheduling = machExceptionThreadScheduling;
+    _machExceptionThreadStackSize = machExceptionThreadStackSize;
+    _shouldPipelineLiveReports = shouldPipelineLiveReports;
+    _shouldRecordThreadMetadata = shouldRecordThreadMetadata;
+    _shouldPackThreadFrames = shouldPackThreadFrames;
+    _shouldAdaptCrashMemorySizing = shouldAdaptCrashMemorySizing;
+    _shouldSuppressDuplicateCrashes = shouldSuppressDuplicateCrashes;
+    _shouldFitReportsToSizeLimit = shouldFitReportsToSizeLimit;
+    _sharedReportContainerPath = [sharedReportContainerPath copy];
+    _shouldChecksumReports = shouldChecksumReports;
+    _shouldAnnotateRegisters = shouldAnnotateRegisters;
+
+    return self;
+}
+
+/**
+ * @internal
+ *
+ * Return a new instance of @a cls holding this configuration's values.
+ */
+- (id) copyWithClass: (Class) cls zone: (NSZone *) zone {
+    PLCrashReporterConfig *copy = [[cls allocWithZone: zone] initWithSignalHandlerType: _signalHandlerType symbolicationStrategy: _symbolicationStrategy];
+    if (copy == nil)
+        return nil;
+
+    copy->_writeBufferSize = _writeBufferSize;
+    copy->_shouldCompressReports = _shouldCompressReports;
+    copy->_maxThreadFrames = _maxThreadFrames;
+    copy->_maxReportFrames = _maxReportFrames;
+    copy->_tailThreadFrames = _tailThreadFrames;
+    copy->_writeTimeBudget = _writeTimeBudget;
+    copy->_shouldCompactUnreferencedImages = _shouldCompactUnreferencedImages;
+    copy->_shouldRecordWriterStatistics = _shouldRecordWriterStatistics;
+    copy->_reportFilePreallocationSize = _reportFilePreallocationSize;
+    copy->_fileSyncPolicy = _fileSyncPolicy;
+    copy->_reportVolumePath = [_reportVolumePath copy];
+    copy->_breadcrumbCapacity = _breadcrumbCapacity;
+    copy->_memoryCaptureBudget = _memoryCaptureBudget;
+    copy->_shouldScanStacks = _shouldScanStacks;
+    copy->_shouldCacheImageIndexes = _shouldCacheImageIndexes;
+    copy->_shouldCollapseIdenticalThreadStacks = _shouldCollapseIdenticalThreadStacks;
+    copy->_idleThreadFrames = _idleThreadFrames;
+    copy->_shouldShareLiveReportImageLists = _shouldShareLiveReportImageLists;
+    copy->_crashLoopThreshold = _crashLoopThreshold;
+    copy->_shouldPrefaultCrashMemory = _shouldPrefaultCrashMemory;
+    copy->_cacheMemoryLimit = _cacheMemoryLimit;
+    copy->_debugLogBufferSize = _debugLogBufferSize;
+    copy->_shouldEmbedDebugLog = _shouldEmbedDebugLog;
+    copy->_machExceptionThreadScheduling = _machExceptionThreadScheduling;
+    copy->_machExceptionThreadStackSize = _machExceptionThreadStackSize;
+    copy->_shouldPipelineLiveReports = _shouldPipelineLiveReports;
+    copy->_shouldRecordThreadMetadata = _shouldRecordThreadMetadata;
+    copy->_shouldPackThreadFrames = _shouldPackThreadFrames;
+    copy->_shouldAdaptCrashMemorySizing = _shouldAdaptCrashMemorySizing;
+    copy->_shouldSuppressDuplicateCrashes = _shouldSuppressDuplicateCrashes;
+    copy->_shouldFitReportsToSizeLimit = _shouldFitReportsToSizeLimit;
+    copy->_sharedReportContainerPath = [_sharedReportContainerPath copy];
+    copy->_shouldChecksumReports = _shouldChecksumReports;
+    copy->_shouldAnnotateRegisters = _shouldAnnotateRegisters;
+    copy->_shouldWriteCompactRegisterState = _shouldWriteCompactRegisterState;
+    copy->_shouldSnapshotLiveReportStacks = _shouldSnapshotLiveReportStacks;
+    copy->_shouldWriteV2Reports = _shouldWriteV2Reports;
+
+    return copy;
+}
+
+// from NSCopying protocol
+- (id) copyWithZone: (NSZone *) zone {
+    /* Immutable instances may be shared */
+    if ([self class] == [PLCrashReporterConfig class])
+        return [self retain];
+
+    return [self copyWithClass: [PLCrashReporterConfig class] zone: zone];
+}
+
+// from NSMutableCopying protocol
+- (id) mutableCopyWithZone: (NSZone *) zone {
+    return [self copyWithClass: [PLMutableCrashReporterConfig class] zone: zone];
+}
+
+- (void) dealloc {
+    [_reportVolumePath release];
+    [_sharedReportContainerPath release];
+    [super dealloc];
+}
+
+@end
+
+/**
+ * Mutable Crash Reporter Configuration.
+ *
+ * The setters are provided by PLCrashReporterConfig's internal readwrite property declarations.
+ */
+@implementation PLMutableCrashReporterConfig
+
+@dynamic signalHandlerType;
+@dynamic symbolicationStrategy;
+@dynamic writeBufferSize;
+@dynamic shouldCompressReports;
+@dynamic maxThreadFrames;
+@dynamic maxReportFrames;
+@dynamic tailThreadFrames;
+@dynamic writeTimeBudget;
+@dynamic shouldCompactUnreferencedImages;
+@dynamic shouldRecordWriterStatistics;
+@dynamic reportFilePreallocationSize;
+@dynamic fileSyncPolicy;
+@dynamic reportVolumePath;
+@dynamic breadcrumbCapacity;
+@dynamic memoryCaptureBudget;
+@dynamic shouldScanStacks;
+@dynamic shouldCacheImageIndexes;
+@dynamic shouldCollapseIdenticalThreadStacks;
+@dynamic idleThreadFrames;
+@dynamic shouldShareLiveReportImageLists;
+@dynamic crashLoopThreshold;
+@dynamic shouldPrefaultCrashMemory;
+@dynamic cacheMemoryLimit;
+@dynamic debugLogBufferSize;
+@dynamic shouldEmbedDebugLog;
+@dynamic machExceptionThreadScheduling;
+@dynamic machExceptionThreadStackSize;
+@dynamic shouldPipelineLiveReports;
+@dynamic shouldRecordThreadMetadata;
+@dynamic shouldPackThreadFrames;
+@dynamic shouldAdaptCrashMemorySizing;
+@dynamic shouldSuppressDuplicateCrashes;
+@dynamic shouldFitReportsToSizeLimit;
+@dynamic sharedReportContainerPath;
+@dynamic shouldChecksumReports;
+@dynamic shouldAnnotateRegisters;
+@dynamic shouldWriteCompactRegisterState;
+@dynamic shouldSnapshotLiveReportStacks;
+@dynamic shouldWriteV2Reports;
+
 @end
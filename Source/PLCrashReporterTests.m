@@ -30,9 +30,15 @@
 
 #import "PLCrashReport.h"
 #import "PLCrashReporter.h"
+#import "PLCrashReportBundle.h"
 #import "PLCrashFrameWalker.h"
 #import "PLCrashTestThread.h"
 
+@interface PLCrashReporter (PLCrashReporterTestsPrivate)
+- (NSString *) crashReportPath;
+- (NSString *) queuedCrashReportDirectory;
+@end
+
 @interface PLCrashReporterTests : SenTestCase
 @end
 
@@ -120,4 +126,261 @@
     STAssertEqualStrings([[report signalInfo] code], @"TRAP_TRACE", @"Incorrect signal code");
 }
 
+/**
+ * Test generation of repeated live reports from a single reporter, which reuses its writer across reports.
+ */
+- (void) testGenerateRepeatedLiveReports {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    NSMutableSet *uuids = [NSMutableSet set];
+
+    for (int i = 0; i < 3; i++) {
+        /* Only the second report includes an exception; it must not carry over into the third */
+        NSException *exc = nil;
+        if (i == 1)
+            exc = [NSException exceptionWithName: NSInvalidArgumentException reason: @"Testing" userInfo: nil];
+
+        NSData *reportData = [reporter generateLiveReportWithThread: pl_mach_thread_self() exception: exc error: &error];
+        STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+        STAssertNotNil(report, @"Could not parse geneated live report: %@", error);
+        STAssertTrue(report.uuidRef != NULL, @"Missing report UUID");
+
+        CFStringRef uuid = CFUUIDCreateString(NULL, report.uuidRef);
+        STAssertFalse([uuids containsObject: (NSString *) uuid], @"Report UUID was reused");
+        [uuids addObject: (NSString *) uuid];
+        CFRelease(uuid);
+
+        if (i == 1) {
+            STAssertNotNil(report.exceptionInfo, @"Missing exception info");
+        } else {
+            STAssertNil(report.exceptionInfo, @"Unexpected exception info");
+        }
+    }
+}
+
+/**
+ * Test concurrent generation of live reports from multiple threads using a single reporter.
+ */
+- (void) testGenerateConcurrentLiveReports {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    const size_t count = 4;
+    __block NSData *reports[count];
+
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        reports[i] = [[reporter generateLiveReportWithThread: pl_mach_thread_self() error: NULL] retain];
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        NSError *error;
+        STAssertNotNil(reports[i], @"Failed to generate live report %zu", i);
+
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reports[i] error: &error] autorelease];
+        STAssertNotNil(report, @"Could not parse geneated live report: %@", error);
+        [reports[i] release];
+    }
+}
+
+/**
+ * Test generation of a live crash report using the minimal built-in write buffer.
+ */
+- (void) testGenerateLiveReportDefaultWriteBuffer {
+    NSError *error;
+    PLMutableCrashReporterConfig *config = [[[PLMutableCrashReporterConfig alloc] init] autorelease];
+    config.writeBufferSize = 0;
+    STAssertEquals(config.writeBufferSize, (NSUInteger) 0, @"Incorrect write buffer size");
+
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(report, @"Could not parse geneated live report: %@", error);
+}
+
+/**
+ * Test generation of a live crash report from snapshotted thread stacks.
+ */
+- (void) testGenerateLiveReportStackSnapshots {
+    NSError *error;
+    STAssertFalse([PLCrashReporterConfig defaultConfiguration].shouldSnapshotLiveReportStacks, @"Stack snapshots should be disabled by default");
+
+    PLMutableCrashReporterConfig *config = [[[PLMutableCrashReporterConfig alloc] init] autorelease];
+    config.shouldSnapshotLiveReportStacks = YES;
+
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(report, @"Could not parse geneated live report: %@", error);
+    STAssertTrue([report.threads count] > 0, @"No threads were written");
+}
+
+
+/**
+ * Test placement of the crash report directory on a configured volume.
+ */
+- (void) testReportVolumePath {
+    NSString *volumePath = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    PLMutableCrashReporterConfig *config = [[[PLMutableCrashReporterConfig alloc] init] autorelease];
+    config.writeBufferSize = 0;
+    config.reportFilePreallocationSize = 64 * 1024;
+    config.fileSyncPolicy = PLCrashReporterFileSyncPolicyFullFSync;
+    config.reportVolumePath = volumePath;
+    STAssertEquals(config.reportFilePreallocationSize, (NSUInteger) 64 * 1024, @"Incorrect preallocation size");
+    STAssertEquals(config.fileSyncPolicy, PLCrashReporterFileSyncPolicyFullFSync, @"Incorrect sync policy");
+
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
+    STAssertTrue([[reporter crashReportPath] hasPrefix: volumePath], @"Report path %@ is not on the configured volume", [reporter crashReportPath]);
+}
+
+/**
+ * Test copying between mutable and immutable configurations.
+ */
+- (void) testConfigurationCopy {
+    PLMutableCrashReporterConfig *mutableConfig = [[[PLMutableCrashReporterConfig alloc] init] autorelease];
+    STAssertEquals(mutableConfig.writeBufferSize, [PLCrashReporterConfig defaultConfiguration].writeBufferSize, @"Mutable configuration does not use the defaults");
+
+    mutableConfig.maxThreadFrames = 64;
+    mutableConfig.reportVolumePath = @"/tmp";
+
+    /* An immutable copy retains the configured values, and is unaffected by later changes */
+    PLCrashReporterConfig *config = [[mutableConfig copy] autorelease];
+    STAssertFalse([config isKindOfClass: [PLMutableCrashReporterConfig class]], @"Copy is mutable");
+    mutableConfig.maxThreadFrames = 32;
+    STAssertEquals(config.maxThreadFrames, (NSUInteger) 64, @"Incorrect frame limit");
+    STAssertEqualObjects(config.reportVolumePath, @"/tmp", @"Incorrect volume path");
+
+    /* Immutable copies of immutable configurations are shared */
+    STAssertEquals([[config copy] autorelease], config, @"Immutable configuration was not shared");
+
+    PLMutableCrashReporterConfig *mutableCopy = [[config mutableCopy] autorelease];
+    STAssertEquals(mutableCopy.maxThreadFrames, (NSUInteger) 64, @"Incorrect frame limit");
+}
+
+/**
+ * Test that the deprecated option initializers forward to the equivalent mutable configuration.
+ */
+- (void) testDeprecatedConfigurationInitializers {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated"
+    PLCrashReporterConfig *config = [[[PLCrashReporterConfig alloc] initWithSignalHandlerType: PLCrashReporterSignalHandlerTypeMach
+                                                                        symbolicationStrategy: PLCrashReporterSymbolicationStrategyAll
+                                                                              writeBufferSize: 1024
+                                                                        shouldCompressReports: YES
+                                                                              maxThreadFrames: 64
+                                                                              maxReportFrames: 256
+                                                                             tailThreadFrames: 8] autorelease];
+#pragma clang diagnostic pop
+
+    STAssertEquals(config.signalHandlerType, PLCrashReporterSignalHandlerTypeMach, @"Incorrect signal handler type");
+    STAssertEquals(config.symbolicationStrategy, PLCrashReporterSymbolicationStrategyAll, @"Incorrect symbolication strategy");
+    STAssertEquals(config.writeBufferSize, (NSUInteger) 1024, @"Incorrect write buffer size");
+    STAssertTrue(config.shouldCompressReports, @"Compression was not enabled");
+    STAssertEquals(config.maxThreadFrames, (NSUInteger) 64, @"Incorrect frame limit");
+    STAssertEquals(config.maxReportFrames, (NSUInteger) 256, @"Incorrect report frame limit");
+    STAssertEquals(config.tailThreadFrames, (NSUInteger) 8, @"Incorrect tail frame count");
+
+    /* Options not provided to the initializer retain their defaults */
+    PLCrashReporterConfig *defaults = [PLCrashReporterConfig defaultConfiguration];
+    STAssertEquals(config.writeTimeBudget, defaults.writeTimeBudget, @"Incorrect default time budget");
+    STAssertEquals(config.fileSyncPolicy, defaults.fileSyncPolicy, @"Incorrect default sync policy");
+    STAssertNil(config.reportVolumePath, @"Incorrect default volume path");
+}
+
+/**
+ * Test loading, queueing, and enumeration of pending crash reports.
+ */
+- (void) testQueuedReports {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    STAssertTrue([reporter purgeQueuedCrashReportsAndReturnError: &error], @"Failed to purge queued reports: %@", error);
+
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    /* Install and queue two pending reports */
+    NSString *directory = [[reporter crashReportPath] stringByDeletingLastPathComponent];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: directory withIntermediateDirectories: YES attributes: nil error: &error], @"Failed to create report directory: %@", error);
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        STAssertTrue([reportData writeToFile: [reporter crashReportPath] options: NSDataWritingAtomic error: &error], @"Failed to write report: %@", error);
+        STAssertTrue([reporter hasPendingCrashReport], @"No pending report");
+
+        PLCrashReport *report = [reporter loadPendingCrashReportAndReturnError: &error];
+        STAssertNotNil(report, @"Could not load pending report: %@", error);
+        STAssertEqualStrings([[report signalInfo] name], @"SIGTRAP", @"Incorrect signal name");
+
+        STAssertTrue([reporter queuePendingCrashReportAndReturnError: &error], @"Failed to queue report: %@", error);
+        STAssertFalse([reporter hasPendingCrashReport], @"Queued report is still pending");
+    }
+
+    /* Enumerate the queue */
+    NSUInteger count = 0;
+    for (PLCrashReport *report in [reporter queuedCrashReportEnumerator]) {
+        STAssertNotNil(report.crashedThread, @"Queued report is missing a crashed thread");
+        count++;
+    }
+    STAssertEquals(count, (NSUInteger) 2, @"Incorrect number of queued reports");
+
+    /* A missing index must be rebuilt from the queued report directory */
+    NSString *indexPath = [[reporter queuedCrashReportDirectory] stringByAppendingPathComponent: @"queue_index"];
+    STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: indexPath error: &error], @"Failed to remove queue index: %@", error);
+    count = 0;
+    for (PLCrashReport *report in [reporter queuedCrashReportEnumerator])
+        count++;
+    STAssertEquals(count, (NSUInteger) 2, @"Incorrect number of queued reports after rebuilding the index");
+    STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath: indexPath], @"Queue index was not rebuilt");
+
+    /* Bundle the queue */
+    NSData *bundleData = [reporter queuedCrashReportBundleCompressingReports: YES error: &error];
+    STAssertNotNil(bundleData, @"Failed to bundle queued reports: %@", error);
+    PLCrashReportBundle *bundle = [[[PLCrashReportBundle alloc] initWithData: bundleData error: &error] autorelease];
+    STAssertNotNil(bundle, @"Failed to read queued report bundle: %@", error);
+    STAssertEquals(bundle.count, (NSUInteger) 2, @"Incorrect number of bundled reports");
+
+    /* Purge the queue */
+    STAssertTrue([reporter purgeQueuedCrashReportsAndReturnError: &error], @"Failed to purge queued reports: %@", error);
+    STAssertNil([[reporter queuedCrashReportEnumerator] nextObject], @"Queue was not purged");
+}
+
+/**
+ * Test asynchronous processing of a pending crash report.
+ */
+- (void) testProcessPendingCrashReport {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    STAssertTrue([reporter purgeQueuedCrashReportsAndReturnError: &error], @"Failed to purge queued reports: %@", error);
+
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    NSString *directory = [[reporter crashReportPath] stringByDeletingLastPathComponent];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: directory withIntermediateDirectories: YES attributes: nil error: &error], @"Failed to create report directory: %@", error);
+    STAssertTrue([reportData writeToFile: [reporter crashReportPath] options: NSDataWritingAtomic error: &error], @"Failed to write report: %@", error);
+
+    /* Process the report, and wait for the completion handler to run on the main queue */
+    __block BOOL completed = NO;
+    [reporter processPendingCrashReportWithOptions: PLCrashReporterProcessingOptionFormat|PLCrashReporterProcessingOptionQueue
+                                 completionHandler: ^(PLCrashReport *report, NSString *text, NSError *processingError) {
+        STAssertTrue([NSThread isMainThread], @"Completion handler was not called on the main thread");
+        STAssertNotNil(report, @"Could not process pending report: %@", processingError);
+        STAssertNotNil(text, @"Report was not formatted");
+        STAssertEqualStrings([[report signalInfo] name], @"SIGTRAP", @"Incorrect signal name");
+        completed = YES;
+    }];
+
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow: 10.0];
+    while (!completed && [timeout timeIntervalSinceNow] > 0)
+        [[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+
+    STAssertTrue(completed, @"Completion handler was not called");
+    STAssertFalse([reporter hasPendingCrashReport], @"Processed report is still pending");
+    STAssertNotNil([[reporter queuedCrashReportEnumerator] nextObject], @"Processed report was not queued");
+
+    STAssertTrue([reporter purgeQueuedCrashReportsAndReturnError: &error], @"Failed to purge queued reports: %@", error);
+}
+
 @end
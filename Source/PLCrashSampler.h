@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+@interface PLCrashSamplerSample : NSObject {
+@private
+    /** The time at which the sample was captured, in mach_absolute_time() units. */
+    uint64_t _machTimestamp;
+
+    /** The sampled instruction pointers (NSNumber), beginning with the innermost frame. */
+    NSArray *_instructionPointers;
+}
+
+- (id) initWithMachTimestamp: (uint64_t) machTimestamp instructionPointers: (NSArray *) instructionPointers;
+
+- (NSArray *) symbolNames;
+
+/**
+ * The time at which the sample was captured, in mach_absolute_time() units.
+ */
+@property(nonatomic, readonly) uint64_t machTimestamp;
+
+/**
+ * The sampled frames' instruction pointers (NSNumber), beginning with the innermost frame.
+ */
+@property(nonatomic, readonly) NSArray *instructionPointers;
+
+@end
+
+
+/** @internal Opaque sampler state. */
+typedef struct plcrash_sampler_state plcrash_sampler_state_t;
+
+@interface PLCrashSampler : NSObject {
+@private
+    /** Sampler state shared with the sampling thread. */
+    plcrash_sampler_state_t *_state;
+
+    /** YES if the sampling thread is running. */
+    BOOL _running;
+}
+
+- (id) initWithThread: (thread_t) thread
+       samplingInterval: (NSTimeInterval) samplingInterval
+      maximumFrameCount: (NSUInteger) maximumFrameCount
+               capacity: (NSUInteger) capacity;
+
+- (BOOL) startAndReturnError: (NSError **) outError;
+- (void) stop;
+
+- (NSArray *) drainSamples;
+
+/**
+ * The number of samples that were discarded because the sample buffer was full. Samples must be drained via
+ * PLCrashSampler::drainSamples at least once per @a capacity samples to avoid dropping samples.
+ */
+@property(nonatomic, readonly) NSUInteger droppedSampleCount;
+
+@end
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashSampler.h"
+#import "PLCrashReporterNSError.h"
+
+#import "PLCrashAsyncSampleBuffer.h"
+#import "PLCrashFrameWalker.h"
+#import "PLCrashFrameStackUnwind.h"
+
+#import <pthread.h>
+#import <libkern/OSAtomic.h>
+#import <dlfcn.h>
+#import <mach/mach_time.h>
+
+/**
+ * @internal
+ *
+ * Sampler state shared between a PLCrashSampler instance and its sampling thread.
+ */
+struct plcrash_sampler_state {
+    /** The target thread. A send right is held for the lifetime of the state. */
+    thread_t thread;
+
+    /** The sampling interval, in mach_absolute_time() units. */
+    uint64_t interval;
+
+    /** The sample buffer. The sampling thread is the sole producer. */
+    plcrash_async_sample_buffer_t buffer;
+
+    /** The sampling thread. */
+    pthread_t pthread;
+
+    /** Set to false to request that the sampling thread exit. */
+    volatile bool running;
+};
+
+/**
+ * @internal
+ *
+ * Capture a single sample of @a state's target thread.
+ *
+ * The target thread is suspended only for the duration of the frame pointer walk; no locks are acquired
+ * and no memory is allocated while it is suspended, as the target may hold the corresponding locks.
+ */
+static void plcrash_sampler_capture (plcrash_sampler_state_t *state) {
+    /* Only frame pointers are walked; the DWARF and compact unwind readers are too costly to run at sampling rates */
+    plframe_cursor_frame_reader_t *readers[] = { plframe_cursor_read_frame_ptr };
+    plframe_cursor_t cursor;
+    plcrash_greg_t pc;
+
+    plcrash_async_sample_t *sample = plcrash_async_sample_buffer_reserve(&state->buffer);
+    if (sample == NULL)
+        return;
+
+    if (thread_suspend(state->thread) != KERN_SUCCESS)
+        return;
+
+    sample->timestamp = mach_absolute_time();
+    sample->frame_count = 0;
+
+    if (plframe_cursor_thread_init(&cursor, mach_task_self(), state->thread, NULL) == PLFRAME_ESUCCESS) {
+        while (sample->frame_count < state->buffer.max_frames) {
+            if (plframe_cursor_next_with_readers(&cursor, readers, sizeof(readers) / sizeof(readers[0])) != PLFRAME_ESUCCESS)
+                break;
+
+            if (plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc) != PLFRAME_ESUCCESS)
+                break;
+
+            sample->pcs[sample->frame_count++] = pc;
+        }
+    }
+
+    thread_resume(state->thread);
+    plframe_cursor_free(&cursor);
+
+    if (sample->frame_count > 0)
+        plcrash_async_sample_buffer_commit(&state->buffer);
+}
+
+/**
+ * @internal
+ *
+ * Sampling thread entry point.
+ */
+static void *plcrash_sampler_thread (void *arg) {
+    plcrash_sampler_state_t *state = arg;
+    uint64_t deadline = mach_absolute_time();
+
+    while (state->running) {
+        /* If we've fallen behind, skip the missed samples rather than issuing them back-to-back */
+        deadline += state->interval;
+        uint64_t now = mach_absolute_time();
+        if (deadline < now)
+            deadline = now;
+        else
+            mach_wait_until(deadline);
+
+        plcrash_sampler_capture(state);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * A single stack sample captured by a PLCrashSampler.
+ */
+@implementation PLCrashSamplerSample
+
+/**
+ * Initialize with the provided sample data.
+ *
+ * @param machTimestamp The time at which the sample was captured, in mach_absolute_time() units.
+ * @param instructionPointers The sampled instruction pointers (NSNumber), beginning with the innermost frame.
+ */
+- (id) initWithMachTimestamp: (uint64_t) machTimestamp instructionPointers: (NSArray *) instructionPointers {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _machTimestamp = machTimestamp;
+    _instructionPointers = [instructionPointers retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_instructionPointers release];
+    [super dealloc];
+}
+
+/**
+ * Symbolicate the sample's instruction pointers using the symbol tables of the images loaded in the current
+ * process. Symbolication is deferred to export time to keep the cost of sampling low.
+ *
+ * @return Returns an array of symbol names (NSString), one per instruction pointer. Instruction pointers that could not
+ * be symbolicated are represented by NSNull.
+ */
+- (NSArray *) symbolNames {
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity: [_instructionPointers count]];
+
+    for (NSNumber *ip in _instructionPointers) {
+        Dl_info info;
+        if (dladdr((const void *) (uintptr_t) [ip unsignedLongLongValue], &info) != 0 && info.dli_sname != NULL) {
+            [names addObject: [NSString stringWithUTF8String: info.dli_sname]];
+        } else {
+            [names addObject: [NSNull null]];
+        }
+    }
+
+    return names;
+}
+
+@synthesize machTimestamp = _machTimestamp;
+@synthesize instructionPointers = _instructionPointers;
+
+@end
+
+
+/**
+ * A low-overhead stack sampling profiler.
+ *
+ * PLCrashSampler periodically suspends a target thread from a dedicated sampling thread and records the target's
+ * instruction pointers, as recovered via frame pointer unwinding. Samples are written to a fixed-capacity lock-free
+ * buffer and are symbolicated only when drained, allowing for sampling rates in the 1-10kHz range, as is required
+ * to attribute short main thread hangs.
+ *
+ * Since only frame pointers are walked, frames in code compiled without frame pointers may be omitted.
+ */
+@implementation PLCrashSampler
+
+/**
+ * Initialize a new sampler.
+ *
+ * @param thread The thread to be sampled. A send right to the thread is retained by the sampler.
+ * @param samplingInterval The interval between samples, in seconds.
+ * @param maximumFrameCount The maximum number of frames to be recorded per sample.
+ * @param capacity The maximum number of undrained samples to be buffered. Samples captured while the buffer is full
+ * are dropped.
+ *
+ * @return Returns the initialized sampler, or nil if the sample buffer could not be allocated.
+ */
+- (id) initWithThread: (thread_t) thread
+       samplingInterval: (NSTimeInterval) samplingInterval
+      maximumFrameCount: (NSUInteger) maximumFrameCount
+               capacity: (NSUInteger) capacity
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    if (maximumFrameCount > UINT32_MAX || capacity > UINT32_MAX) {
+        [self release];
+        return nil;
+    }
+
+    _state = calloc(1, sizeof(*_state));
+    if (_state == NULL) {
+        [self release];
+        return nil;
+    }
+
+    if (plcrash_nasync_sample_buffer_init(&_state->buffer, (uint32_t) capacity, (uint32_t) maximumFrameCount) != PLCRASH_ESUCCESS) {
+        free(_state);
+        _state = NULL;
+        [self release];
+        return nil;
+    }
+
+    /* Convert the interval to mach_absolute_time() units */
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    _state->interval = (uint64_t) ((samplingInterval * NSEC_PER_SEC) * timebase.denom / timebase.numer);
+
+    /* Hold our own send right to the target thread */
+    _state->thread = thread;
+    mach_port_mod_refs(mach_task_self(), thread, MACH_PORT_RIGHT_SEND, 1);
+
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+
+    if (_state != NULL) {
+        mach_port_mod_refs(mach_task_self(), _state->thread, MACH_PORT_RIGHT_SEND, -1);
+        plcrash_nasync_sample_buffer_free(&_state->buffer);
+        free(_state);
+    }
+
+    [super dealloc];
+}
+
+/**
+ * Start sampling the target thread.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the sampler could not be started. If no error occurs, this parameter will be left unmodified.
+ * You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the sampler could not be started.
+ */
+- (BOOL) startAndReturnError: (NSError **) outError {
+    if (_running) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The sampler is already running", nil);
+        return NO;
+    }
+
+    _state->running = true;
+    OSMemoryBarrier();
+
+    int ret = pthread_create(&_state->pthread, NULL, plcrash_sampler_thread, _state);
+    if (ret != 0) {
+        _state->running = false;
+        plcrash_populate_posix_error(outError, ret, @"Could not create the sampling thread");
+        return NO;
+    }
+
+    _running = YES;
+    return YES;
+}
+
+/**
+ * Stop sampling the target thread, waiting for any in-progress sample to complete. Samples captured prior to
+ * stopping remain available via PLCrashSampler::drainSamples.
+ */
+- (void) stop {
+    if (!_running)
+        return;
+
+    _state->running = false;
+    OSMemoryBarrier();
+    pthread_join(_state->pthread, NULL);
+
+    _running = NO;
+}
+
+/**
+ * Remove and return all buffered samples, oldest first.
+ *
+ * This method may be called while the sampler is running, but must not be called concurrently from multiple threads.
+ *
+ * @return Returns an array of PLCrashSamplerSample instances.
+ */
+- (NSArray *) drainSamples {
+    NSMutableArray *samples = [NSMutableArray array];
+    const plcrash_async_sample_t *sample;
+
+    while ((sample = plcrash_async_sample_buffer_peek(&_state->buffer)) != NULL) {
+        NSMutableArray *ips = [NSMutableArray arrayWithCapacity: sample->frame_count];
+        for (uint32_t i = 0; i < sample->frame_count; i++)
+            [ips addObject: [NSNumber numberWithUnsignedLongLong: sample->pcs[i]]];
+
+        PLCrashSamplerSample *s = [[PLCrashSamplerSample alloc] initWithMachTimestamp: sample->timestamp instructionPointers: ips];
+        plcrash_async_sample_buffer_consume(&_state->buffer);
+
+        [samples addObject: s];
+        [s release];
+    }
+
+    return samples;
+}
+
+- (NSUInteger) droppedSampleCount {
+    return plcrash_async_sample_buffer_dropped(&_state->buffer);
+}
+
+@end
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "SenTestCompat.h"
+
+#import "PLCrashSampler.h"
+#import "PLCrashAsyncSampleBuffer.h"
+#import "PLCrashTestThread.h"
+
+@interface PLCrashSamplerTests : SenTestCase {}
+@end
+
+@implementation PLCrashSamplerTests
+
+/**
+ * Verify that samples are returned in order, and that samples are dropped and counted when the buffer is full.
+ */
+- (void) testSampleBufferOrdering {
+    plcrash_async_sample_buffer_t buffer;
+    STAssertEquals(plcrash_nasync_sample_buffer_init(&buffer, 3, 2), PLCRASH_ESUCCESS, @"Failed to initialize buffer");
+    STAssertEquals(buffer.slot_count, (uint32_t) 4, @"Capacity was not rounded to a power of two");
+
+    STAssertTrue(plcrash_async_sample_buffer_peek(&buffer) == NULL, @"Empty buffer returned a sample");
+
+    /* Fill the buffer */
+    for (uint32_t i = 0; i < 4; i++) {
+        plcrash_async_sample_t *sample = plcrash_async_sample_buffer_reserve(&buffer);
+        STAssertNotNULL(sample, @"Failed to reserve sample %u", i);
+        sample->timestamp = i;
+        sample->frame_count = 1;
+        sample->pcs[0] = i;
+        plcrash_async_sample_buffer_commit(&buffer);
+    }
+
+    STAssertTrue(plcrash_async_sample_buffer_reserve(&buffer) == NULL, @"Reserved a sample in a full buffer");
+    STAssertEquals(plcrash_async_sample_buffer_dropped(&buffer), (uint32_t) 1, @"Dropped sample was not counted");
+
+    /* Drain the buffer */
+    for (uint32_t i = 0; i < 4; i++) {
+        const plcrash_async_sample_t *sample = plcrash_async_sample_buffer_peek(&buffer);
+        STAssertNotNULL(sample, @"Missing sample %u", i);
+        STAssertEquals(sample->timestamp, (uint64_t) i, @"Samples returned out of order");
+        STAssertEquals(sample->pcs[0], (uint64_t) i, @"Incorrect sample contents");
+        plcrash_async_sample_buffer_consume(&buffer);
+    }
+
+    STAssertTrue(plcrash_async_sample_buffer_peek(&buffer) == NULL, @"Drained buffer returned a sample");
+    STAssertNotNULL(plcrash_async_sample_buffer_reserve(&buffer), @"Failed to reserve a sample after draining");
+
+    plcrash_nasync_sample_buffer_free(&buffer);
+}
+
+/**
+ * Sample a waiting thread, and verify that its frames were recorded.
+ */
+- (void) testSampleThread {
+    plcrash_test_thread_t thr;
+    plcrash_test_thread_spawn(&thr);
+
+    PLCrashSampler *sampler = [[[PLCrashSampler alloc] initWithThread: pthread_mach_thread_np(thr.thread)
+                                                     samplingInterval: 0.001
+                                                    maximumFrameCount: 64
+                                                             capacity: 1024] autorelease];
+    STAssertNotNil(sampler, @"Failed to create sampler");
+
+    NSError *error;
+    STAssertTrue([sampler startAndReturnError: &error], @"Failed to start sampler: %@", error);
+    STAssertFalse([sampler startAndReturnError: NULL], @"Started a running sampler");
+    usleep(50000);
+    [sampler stop];
+
+    plcrash_test_thread_stop(&thr);
+
+    NSArray *samples = [sampler drainSamples];
+    STAssertTrue([samples count] > 0, @"No samples were captured");
+    STAssertEquals([[sampler drainSamples] count], (NSUInteger) 0, @"Samples were not drained");
+
+    uint64_t lastTimestamp = 0;
+    for (PLCrashSamplerSample *sample in samples) {
+        STAssertTrue([sample.instructionPointers count] > 0, @"Sample contains no frames");
+        STAssertTrue([sample.instructionPointers count] <= 64, @"Sample exceeds the maximum frame count");
+        STAssertEquals([[sample symbolNames] count], [sample.instructionPointers count], @"Symbol count does not match frame count");
+        STAssertTrue(sample.machTimestamp >= lastTimestamp, @"Samples returned out of order");
+        lastTimestamp = sample.machTimestamp;
+    }
+}
+
+@end
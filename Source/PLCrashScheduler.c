@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PLCrashScheduler.h"
+
+#include <Block.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <libkern/OSAtomic.h>
+
+#if defined(__has_include) && __has_include(<pthread/qos.h>)
+#include <pthread/qos.h>
+#define PLCRASH_SCHEDULER_HAS_QOS 1
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_scheduler Background Work Scheduler
+ *
+ * A single process-wide scheduler for work performed off the crash path: index building, persistent cache
+ * maintenance, read-ahead, and pending report processing. Subsystems submit their work here rather than creating
+ * their own threads or queues, ensuring that at most one such work item executes at a time, and that none execute
+ * above QOS_CLASS_UTILITY.
+ *
+ * Pending work is ordered by QoS class, then by deadline, then by submission order. Each work item is dispatched
+ * individually to the global queue of its QoS class, allowing later utility work to run ahead of earlier background
+ * work; work is not preempted once started.
+ *
+ * Work may be coalesced by key: while work with a given key is pending, further submissions with the same key are
+ * merged into the pending work. Pending work may be cancelled, and work with a deadline is promoted to
+ * PLCRASH_SCHEDULER_QOS_UTILITY once its deadline passes.
+ *
+ * None of the scheduler functions are async-safe.
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Work item states.
+ */
+typedef enum {
+    /** The work is queued, and may be coalesced, expedited, or cancelled. */
+    PLCRASH_SCHEDULER_WORK_PENDING = 0,
+
+    /** The work is executing. */
+    PLCRASH_SCHEDULER_WORK_RUNNING = 1,
+
+    /** The work has completed. */
+    PLCRASH_SCHEDULER_WORK_FINISHED = 2,
+
+    /** The work was cancelled prior to execution. */
+    PLCRASH_SCHEDULER_WORK_CANCELLED = 3
+} plcrash_scheduler_work_state_t;
+
+/**
+ * @internal
+ *
+ * A submitted work item. All mutable fields other than @a refcount are guarded by the scheduler lock.
+ */
+struct plcrash_scheduler_work {
+    /** Reference count; held by the pending queue, any deadline timer, and each caller-held reference. */
+    volatile int32_t refcount;
+
+    /** The current work state. */
+    plcrash_scheduler_work_state_t state;
+
+    /** The QoS class at which the work will be executed. */
+    plcrash_scheduler_qos_t qos;
+
+    /** The coalescing key, or 0. */
+    uintptr_t key;
+
+    /** The work deadline, or DISPATCH_TIME_FOREVER. */
+    dispatch_time_t deadline;
+
+    /** Submission sequence number, preserving submission order among otherwise equal work. */
+    uint64_t sequence;
+
+    /** The work function. */
+    plcrash_scheduler_function_t function;
+
+    /** The context release function, or NULL. */
+    plcrash_scheduler_function_t release;
+
+    /** The work context. */
+    void *context;
+
+    /** Group entered on submission, and left once the work has finished or been cancelled. */
+    dispatch_group_t group;
+
+    /** The next pending work item, or NULL. */
+    struct plcrash_scheduler_work *next;
+};
+
+/**
+ * @internal
+ *
+ * The shared scheduler state.
+ */
+static struct {
+    /** Lock guarding all scheduler state. */
+    pthread_mutex_t lock;
+
+    /** Pending work, in execution order. */
+    plcrash_scheduler_work_t *pending;
+
+    /** The next submission sequence number. */
+    uint64_t sequence;
+
+    /** True if a drain has been dispatched and has not yet completed. */
+    bool draining;
+} scheduler = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .pending = NULL,
+    .sequence = 0,
+    .draining = false
+};
+
+static void plcrash_scheduler_drain (void *unused);
+
+/**
+ * @internal
+ *
+ * Acquire an additional reference to @a work.
+ */
+static plcrash_scheduler_work_t *plcrash_scheduler_work_retain (plcrash_scheduler_work_t *work) {
+    OSAtomicIncrement32Barrier(&work->refcount);
+    return work;
+}
+
+/**
+ * @internal
+ *
+ * Return the global queue for @a qos, falling back on the corresponding queue priority where QoS classes are
+ * unavailable.
+ */
+static dispatch_queue_t plcrash_scheduler_queue (plcrash_scheduler_qos_t qos) {
+    dispatch_queue_t queue = NULL;
+
+#ifdef PLCRASH_SCHEDULER_HAS_QOS
+    queue = dispatch_get_global_queue(qos == PLCRASH_SCHEDULER_QOS_UTILITY ? QOS_CLASS_UTILITY : QOS_CLASS_BACKGROUND, 0);
+#endif
+
+    if (queue == NULL)
+        queue = dispatch_get_global_queue(qos == PLCRASH_SCHEDULER_QOS_UTILITY ? DISPATCH_QUEUE_PRIORITY_LOW : DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0);
+
+    return queue;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a a should be executed before @a b.
+ */
+static bool plcrash_scheduler_precedes (const plcrash_scheduler_work_t *a, const plcrash_scheduler_work_t *b) {
+    if (a->qos != b->qos)
+        return a->qos > b->qos;
+
+    if (a->deadline != b->deadline)
+        return a->deadline < b->deadline;
+
+    return a->sequence < b->sequence;
+}
+
+/**
+ * @internal
+ *
+ * Insert @a work into the pending queue in execution order. The scheduler lock must be held.
+ */
+static void plcrash_scheduler_insert_locked (plcrash_scheduler_work_t *work) {
+    plcrash_scheduler_work_t **link = &scheduler.pending;
+    while (*link != NULL && !plcrash_scheduler_precedes(work, *link))
+        link = &(*link)->next;
+
+    work->next = *link;
+    *link = work;
+}
+
+/**
+ * @internal
+ *
+ * Remove @a work from the pending queue. The scheduler lock must be held, and @a work must be pending.
+ */
+static void plcrash_scheduler_remove_locked (plcrash_scheduler_work_t *work) {
+    plcrash_scheduler_work_t **link = &scheduler.pending;
+    while (*link != work)
+        link = &(*link)->next;
+
+    *link = work->next;
+    work->next = NULL;
+}
+
+/**
+ * @internal
+ *
+ * Raise pending @a work to @a qos and @a deadline, if either is more urgent than its current QoS class and deadline,
+ * and reposition it in the pending queue. The scheduler lock must be held.
+ */
+static void plcrash_scheduler_promote_locked (plcrash_scheduler_work_t *work, plcrash_scheduler_qos_t qos, dispatch_time_t deadline) {
+    if (work->state != PLCRASH_SCHEDULER_WORK_PENDING)
+        return;
+
+    if (qos <= work->qos && deadline >= work->deadline)
+        return;
+
+    plcrash_scheduler_remove_locked(work);
+    if (qos > work->qos)
+        work->qos = qos;
+    if (deadline < work->deadline)
+        work->deadline = deadline;
+    plcrash_scheduler_insert_locked(work);
+}
+
+/**
+ * @internal
+ *
+ * Dispatch a drain of the pending queue, if one is not already outstanding. The scheduler lock must be held.
+ */
+static void plcrash_scheduler_schedule_locked (void) {
+    if (scheduler.draining || scheduler.pending == NULL)
+        return;
+
+    scheduler.draining = true;
+    dispatch_async_f(plcrash_scheduler_queue(scheduler.pending->qos), NULL, plcrash_scheduler_drain);
+}
+
+/**
+ * @internal
+ *
+ * Mark @a work as complete with @a state, releasing its context and the pending queue's reference. The scheduler
+ * lock must not be held.
+ */
+static void plcrash_scheduler_complete (plcrash_scheduler_work_t *work, plcrash_scheduler_work_state_t state) {
+    if (work->release != NULL)
+        work->release(work->context);
+
+    pthread_mutex_lock(&scheduler.lock);
+    work->state = state;
+    pthread_mutex_unlock(&scheduler.lock);
+
+    dispatch_group_leave(work->group);
+    plcrash_nasync_scheduler_work_release(work);
+}
+
+/**
+ * @internal
+ *
+ * Execute the first pending work item, and then dispatch a drain for the next, at that work's QoS class.
+ */
+static void plcrash_scheduler_drain (void *unused) {
+    plcrash_scheduler_work_t *work;
+
+    pthread_mutex_lock(&scheduler.lock);
+    if ((work = scheduler.pending) != NULL) {
+        scheduler.pending = work->next;
+        work->next = NULL;
+        work->state = PLCRASH_SCHEDULER_WORK_RUNNING;
+    }
+    pthread_mutex_unlock(&scheduler.lock);
+
+    if (work != NULL) {
+        work->function(work->context);
+        plcrash_scheduler_complete(work, PLCRASH_SCHEDULER_WORK_FINISHED);
+    }
+
+    pthread_mutex_lock(&scheduler.lock);
+    scheduler.draining = false;
+    plcrash_scheduler_schedule_locked();
+    pthread_mutex_unlock(&scheduler.lock);
+}
+
+/**
+ * @internal
+ *
+ * Deadline timer callback; promotes the work to PLCRASH_SCHEDULER_QOS_UTILITY if still pending, and releases the
+ * timer's reference.
+ */
+static void plcrash_scheduler_deadline (void *context) {
+    plcrash_scheduler_work_t *work = context;
+
+    pthread_mutex_lock(&scheduler.lock);
+    plcrash_scheduler_promote_locked(work, PLCRASH_SCHEDULER_QOS_UTILITY, work->deadline);
+    plcrash_scheduler_schedule_locked();
+    pthread_mutex_unlock(&scheduler.lock);
+
+    plcrash_nasync_scheduler_work_release(work);
+}
+
+/**
+ * Submit @a function for execution on the shared background scheduler.
+ *
+ * @param qos The QoS class at which @a function will be executed.
+ * @param key A coalescing key, or 0. If work with the same non-zero key is pending, @a function is not scheduled;
+ * @a release is called immediately with @a context, and the pending work is raised to @a qos and @a deadline if
+ * either is more urgent. Keys are compared by value, and should be addresses owned by the submitting subsystem.
+ * @param deadline The time by which the work should run, as returned by dispatch_time() relative to
+ * DISPATCH_TIME_NOW, or DISPATCH_TIME_FOREVER. Once the deadline passes, pending work is promoted to
+ * PLCRASH_SCHEDULER_QOS_UTILITY. Among work of the same QoS class, work with an earlier deadline is executed first.
+ * @param function The work function.
+ * @param release A function to be called with @a context once the work has finished, been cancelled, or been
+ * coalesced, or NULL.
+ * @param context The context to be passed to @a function and @a release.
+ * @param[out] work On success, if non-NULL, a reference to the submitted work -- or, if coalesced, to the pending
+ * work -- which must be released via plcrash_nasync_scheduler_work_release().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the work could not be allocated. On failure,
+ * @a release is not called.
+ */
+plcrash_error_t plcrash_nasync_scheduler_submit (plcrash_scheduler_qos_t qos,
+                                                 uintptr_t key,
+                                                 dispatch_time_t deadline,
+                                                 plcrash_scheduler_function_t function,
+                                                 plcrash_scheduler_function_t release,
+                                                 void *context,
+                                                 plcrash_scheduler_work_t **work)
+{
+    plcrash_scheduler_work_t *item;
+
+    /* Coalesce with any pending work sharing our key */
+    if (key != 0) {
+        pthread_mutex_lock(&scheduler.lock);
+        for (item = scheduler.pending; item != NULL; item = item->next) {
+            if (item->key != key)
+                continue;
+
+            plcrash_scheduler_promote_locked(item, qos, deadline);
+            if (work != NULL)
+                *work = plcrash_scheduler_work_retain(item);
+            pthread_mutex_unlock(&scheduler.lock);
+
+            if (release != NULL)
+                release(context);
+            return PLCRASH_ESUCCESS;
+        }
+        pthread_mutex_unlock(&scheduler.lock);
+    }
+
+    if ((item = calloc(1, sizeof(*item))) == NULL)
+        return PLCRASH_ENOMEM;
+
+    if ((item->group = dispatch_group_create()) == NULL) {
+        free(item);
+        return PLCRASH_ENOMEM;
+    }
+
+    item->refcount = 1;
+    item->state = PLCRASH_SCHEDULER_WORK_PENDING;
+    item->qos = qos;
+    item->key = key;
+    item->deadline = deadline;
+    item->function = function;
+    item->release = release;
+    item->context = context;
+    dispatch_group_enter(item->group);
+
+    if (work != NULL)
+        *work = plcrash_scheduler_work_retain(item);
+
+    /* The deadline timer holds its own reference, released once it fires */
+    if (deadline != DISPATCH_TIME_FOREVER && qos != PLCRASH_SCHEDULER_QOS_UTILITY)
+        dispatch_after_f(deadline, plcrash_scheduler_queue(PLCRASH_SCHEDULER_QOS_UTILITY), plcrash_scheduler_work_retain(item), plcrash_scheduler_deadline);
+
+    pthread_mutex_lock(&scheduler.lock);
+    item->sequence = scheduler.sequence++;
+    plcrash_scheduler_insert_locked(item);
+    plcrash_scheduler_schedule_locked();
+    pthread_mutex_unlock(&scheduler.lock);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * plcrash_nasync_scheduler_submit_block() work function.
+ */
+static void plcrash_scheduler_invoke_block (void *context) {
+    dispatch_block_t block = context;
+    block();
+}
+
+/**
+ * @internal
+ *
+ * plcrash_nasync_scheduler_submit_block() release function.
+ */
+static void plcrash_scheduler_release_block (void *context) {
+    Block_release(context);
+}
+
+/**
+ * Submit @a block for execution on the shared background scheduler. Refer to plcrash_nasync_scheduler_submit() for
+ * a description of the parameters; the block is copied, and released once the work has finished, been cancelled, or
+ * been coalesced.
+ */
+plcrash_error_t plcrash_nasync_scheduler_submit_block (plcrash_scheduler_qos_t qos,
+                                                       uintptr_t key,
+                                                       dispatch_time_t deadline,
+                                                       dispatch_block_t block,
+                                                       plcrash_scheduler_work_t **work)
+{
+    dispatch_block_t copy = Block_copy(block);
+    plcrash_error_t err;
+
+    if ((err = plcrash_nasync_scheduler_submit(qos, key, deadline, plcrash_scheduler_invoke_block, plcrash_scheduler_release_block, copy, work)) != PLCRASH_ESUCCESS)
+        Block_release(copy);
+
+    return err;
+}
+
+/**
+ * Cancel @a work, if it has not yet started.
+ *
+ * @param work The work to cancel.
+ *
+ * @return Returns true if the work was cancelled, and will not execute; its release function will have been called
+ * prior to return. Returns false if the work has already started, finished, or been cancelled.
+ */
+bool plcrash_nasync_scheduler_cancel (plcrash_scheduler_work_t *work) {
+    pthread_mutex_lock(&scheduler.lock);
+    if (work->state != PLCRASH_SCHEDULER_WORK_PENDING) {
+        pthread_mutex_unlock(&scheduler.lock);
+        return false;
+    }
+
+    plcrash_scheduler_remove_locked(work);
+    work->state = PLCRASH_SCHEDULER_WORK_CANCELLED;
+    pthread_mutex_unlock(&scheduler.lock);
+
+    plcrash_scheduler_complete(work, PLCRASH_SCHEDULER_WORK_CANCELLED);
+    return true;
+}
+
+/**
+ * Cancel the pending work with the non-zero @a key, if any. Refer to plcrash_nasync_scheduler_cancel().
+ *
+ * @param key The coalescing key of the work to cancel.
+ *
+ * @return Returns true if pending work was cancelled, false otherwise.
+ */
+bool plcrash_nasync_scheduler_cancel_key (uintptr_t key) {
+    plcrash_scheduler_work_t *work;
+
+    if (key == 0)
+        return false;
+
+    /* Coalescing ensures that at most one pending work item has a given key */
+    pthread_mutex_lock(&scheduler.lock);
+    for (work = scheduler.pending; work != NULL; work = work->next) {
+        if (work->key == key)
+            break;
+    }
+
+    if (work == NULL) {
+        pthread_mutex_unlock(&scheduler.lock);
+        return false;
+    }
+
+    plcrash_scheduler_remove_locked(work);
+    work->state = PLCRASH_SCHEDULER_WORK_CANCELLED;
+    pthread_mutex_unlock(&scheduler.lock);
+
+    plcrash_scheduler_complete(work, PLCRASH_SCHEDULER_WORK_CANCELLED);
+    return true;
+}
+
+/**
+ * Promote pending @a work to PLCRASH_SCHEDULER_QOS_UTILITY, and move it ahead of all other pending work of that class
+ * without an earlier deadline. Has no effect if the work has already started.
+ *
+ * @param work The work to expedite.
+ */
+void plcrash_nasync_scheduler_expedite (plcrash_scheduler_work_t *work) {
+    pthread_mutex_lock(&scheduler.lock);
+    plcrash_scheduler_promote_locked(work, PLCRASH_SCHEDULER_QOS_UTILITY, dispatch_time(DISPATCH_TIME_NOW, 0));
+    plcrash_scheduler_schedule_locked();
+    pthread_mutex_unlock(&scheduler.lock);
+}
+
+/**
+ * Expedite @a work via plcrash_nasync_scheduler_expedite(), and wait for it to finish or be cancelled.
+ *
+ * @param work The work to wait on.
+ * @param timeout The time at which to stop waiting, or DISPATCH_TIME_FOREVER.
+ *
+ * @return Returns true if the work finished or was cancelled prior to @a timeout, false otherwise.
+ *
+ * @warning This must not be called from scheduled work, as the scheduler executes one work item at a time.
+ */
+bool plcrash_nasync_scheduler_wait (plcrash_scheduler_work_t *work, dispatch_time_t timeout) {
+    plcrash_nasync_scheduler_expedite(work);
+    return dispatch_group_wait(work->group, timeout) == 0;
+}
+
+/**
+ * Release a reference to @a work returned by plcrash_nasync_scheduler_submit(). Releasing the reference has no effect
+ * on the work's execution.
+ *
+ * @param work The work reference to release.
+ */
+void plcrash_nasync_scheduler_work_release (plcrash_scheduler_work_t *work) {
+    if (OSAtomicDecrement32Barrier(&work->refcount) != 0)
+        return;
+
+    dispatch_release(work->group);
+    free(work);
+}
+
+/**
+ * @}
+ */
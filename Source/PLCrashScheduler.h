@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef PLCRASH_SCHEDULER_H
+#define PLCRASH_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <dispatch/dispatch.h>
+
+#include "PLCrashAsync.h"
+
+PLCR_C_BEGIN_DECLS
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * The QoS class at which scheduled work is executed.
+ */
+typedef enum {
+    /** Work that is not time sensitive, such as index building and read-ahead. Executed at QOS_CLASS_BACKGROUND. */
+    PLCRASH_SCHEDULER_QOS_BACKGROUND = 0,
+
+    /** Work whose results are awaited, such as pending report processing. Executed at QOS_CLASS_UTILITY. */
+    PLCRASH_SCHEDULER_QOS_UTILITY = 1,
+} plcrash_scheduler_qos_t;
+
+/**
+ * @internal
+ *
+ * A scheduler work function, called with the context supplied to plcrash_nasync_scheduler_submit().
+ */
+typedef void (*plcrash_scheduler_function_t)(void *context);
+
+/** @internal Opaque reference to submitted work. */
+typedef struct plcrash_scheduler_work plcrash_scheduler_work_t;
+
+plcrash_error_t plcrash_nasync_scheduler_submit (plcrash_scheduler_qos_t qos,
+                                                 uintptr_t key,
+                                                 dispatch_time_t deadline,
+                                                 plcrash_scheduler_function_t function,
+                                                 plcrash_scheduler_function_t release,
+                                                 void *context,
+                                                 plcrash_scheduler_work_t **work);
+
+#ifdef __BLOCKS__
+plcrash_error_t plcrash_nasync_scheduler_submit_block (plcrash_scheduler_qos_t qos,
+                                                       uintptr_t key,
+                                                       dispatch_time_t deadline,
+                                                       dispatch_block_t block,
+                                                       plcrash_scheduler_work_t **work);
+#endif
+
+bool plcrash_nasync_scheduler_cancel (plcrash_scheduler_work_t *work);
+bool plcrash_nasync_scheduler_cancel_key (uintptr_t key);
+void plcrash_nasync_scheduler_expedite (plcrash_scheduler_work_t *work);
+bool plcrash_nasync_scheduler_wait (plcrash_scheduler_work_t *work, dispatch_time_t timeout);
+void plcrash_nasync_scheduler_work_release (plcrash_scheduler_work_t *work);
+
+/**
+ * @}
+ */
+
+PLCR_C_END_DECLS
+
+#endif /* PLCRASH_SCHEDULER_H */
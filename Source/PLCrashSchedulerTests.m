@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashScheduler.h"
+
+#import <libkern/OSAtomic.h>
+
+@interface PLCrashSchedulerTests : SenTestCase {
+    /** Semaphore on which the blocking work waits. */
+    dispatch_semaphore_t _unblock;
+
+    /** Work occupying the scheduler, or NULL. */
+    plcrash_scheduler_work_t *_blocker;
+}
+@end
+
+/** Context for counting work functions. */
+typedef struct scheduler_test_ctx {
+    /** Number of times the work function was called. */
+    volatile int32_t calls;
+
+    /** Number of times the release function was called. */
+    volatile int32_t releases;
+} scheduler_test_ctx_t;
+
+static void count_call (void *context) {
+    OSAtomicIncrement32Barrier(&((scheduler_test_ctx_t *) context)->calls);
+}
+
+static void count_release (void *context) {
+    OSAtomicIncrement32Barrier(&((scheduler_test_ctx_t *) context)->releases);
+}
+
+@implementation PLCrashSchedulerTests
+
+- (void) setUp {
+    _unblock = dispatch_semaphore_create(0);
+    _blocker = NULL;
+}
+
+- (void) tearDown {
+    if (_blocker != NULL) {
+        dispatch_semaphore_signal(_unblock);
+        plcrash_nasync_scheduler_wait(_blocker, DISPATCH_TIME_FOREVER);
+        plcrash_nasync_scheduler_work_release(_blocker);
+    }
+
+    dispatch_release(_unblock);
+}
+
+/**
+ * Occupy the scheduler until -unblock is called, so that subsequently submitted work remains pending.
+ */
+- (void) block {
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t unblock = _unblock;
+
+    STAssertEquals(plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_UTILITY, 0, DISPATCH_TIME_FOREVER, ^{
+        dispatch_semaphore_signal(started);
+        dispatch_semaphore_wait(unblock, DISPATCH_TIME_FOREVER);
+    }, &_blocker), PLCRASH_ESUCCESS, @"Failed to submit blocking work");
+
+    STAssertEquals(dispatch_semaphore_wait(started, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), 0L, @"Blocking work did not start");
+    dispatch_release(started);
+}
+
+- (void) unblock {
+    dispatch_semaphore_signal(_unblock);
+    plcrash_nasync_scheduler_wait(_blocker, DISPATCH_TIME_FOREVER);
+    plcrash_nasync_scheduler_work_release(_blocker);
+    _blocker = NULL;
+}
+
+/**
+ * Verify that submitted work is executed, and its context released.
+ */
+- (void) testSubmit {
+    scheduler_test_ctx_t ctx = { 0, 0 };
+    plcrash_scheduler_work_t *work;
+
+    STAssertEquals(plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, DISPATCH_TIME_FOREVER, count_call, count_release, &ctx, &work), PLCRASH_ESUCCESS, @"Submit failed");
+    STAssertTrue(plcrash_nasync_scheduler_wait(work, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), @"Work did not complete");
+    STAssertEquals(ctx.calls, 1, @"Work was not executed exactly once");
+    STAssertEquals(ctx.releases, 1, @"Context was not released exactly once");
+
+    STAssertFalse(plcrash_nasync_scheduler_cancel(work), @"Cancelled completed work");
+    plcrash_nasync_scheduler_work_release(work);
+}
+
+/**
+ * Verify that pending work is ordered by QoS class, then by deadline, then by submission order.
+ */
+- (void) testOrdering {
+    NSMutableArray *order = [NSMutableArray array];
+    plcrash_scheduler_work_t *last;
+
+    [self block];
+
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, DISPATCH_TIME_FOREVER, ^{ [order addObject: @"background-1"]; }, NULL);
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, DISPATCH_TIME_FOREVER, ^{ [order addObject: @"background-2"]; }, &last);
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, dispatch_time(DISPATCH_TIME_NOW, 3600 * NSEC_PER_SEC), ^{ [order addObject: @"deadline"]; }, NULL);
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_UTILITY, 0, DISPATCH_TIME_FOREVER, ^{ [order addObject: @"utility"]; }, NULL);
+
+    [self unblock];
+    STAssertTrue(plcrash_nasync_scheduler_wait(last, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), @"Work did not complete");
+    plcrash_nasync_scheduler_work_release(last);
+
+    NSArray *expected = [NSArray arrayWithObjects: @"utility", @"deadline", @"background-1", @"background-2", nil];
+    STAssertEqualObjects(order, expected, @"Incorrect execution order");
+}
+
+/**
+ * Verify that pending work with a passed deadline is promoted ahead of earlier utility work without a deadline.
+ */
+- (void) testDeadlinePromotion {
+    NSMutableArray *order = [NSMutableArray array];
+    plcrash_scheduler_work_t *last;
+
+    [self block];
+
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_UTILITY, 0, DISPATCH_TIME_FOREVER, ^{ [order addObject: @"utility"]; }, &last);
+    plcrash_nasync_scheduler_submit_block(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_MSEC), ^{ [order addObject: @"deadline"]; }, NULL);
+
+    /* Allow the deadline to pass */
+    usleep(100 * 1000);
+
+    [self unblock];
+    STAssertTrue(plcrash_nasync_scheduler_wait(last, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), @"Work did not complete");
+    plcrash_nasync_scheduler_work_release(last);
+
+    NSArray *expected = [NSArray arrayWithObjects: @"deadline", @"utility", nil];
+    STAssertEqualObjects(order, expected, @"Deadline work was not promoted");
+}
+
+/**
+ * Verify that pending work with the same key is coalesced.
+ */
+- (void) testCoalescing {
+    scheduler_test_ctx_t first = { 0, 0 };
+    scheduler_test_ctx_t second = { 0, 0 };
+    plcrash_scheduler_work_t *work1;
+    plcrash_scheduler_work_t *work2;
+
+    [self block];
+
+    uintptr_t key = (uintptr_t) &first;
+    plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, key, DISPATCH_TIME_FOREVER, count_call, count_release, &first, &work1);
+    plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, key, DISPATCH_TIME_FOREVER, count_call, count_release, &second, &work2);
+    STAssertEquals(work1, work2, @"Work was not coalesced");
+    STAssertEquals(second.releases, 1, @"The coalesced context was not released");
+
+    [self unblock];
+    STAssertTrue(plcrash_nasync_scheduler_wait(work1, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)), @"Work did not complete");
+    STAssertEquals(first.calls, 1, @"Coalesced work was not executed exactly once");
+    STAssertEquals(second.calls, 0, @"The coalesced function was executed");
+
+    plcrash_nasync_scheduler_work_release(work1);
+    plcrash_nasync_scheduler_work_release(work2);
+}
+
+/**
+ * Verify that pending work may be cancelled by reference and by key.
+ */
+- (void) testCancel {
+    scheduler_test_ctx_t ctx = { 0, 0 };
+    scheduler_test_ctx_t keyed = { 0, 0 };
+    plcrash_scheduler_work_t *work;
+
+    [self block];
+
+    plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, 0, DISPATCH_TIME_FOREVER, count_call, count_release, &ctx, &work);
+    plcrash_nasync_scheduler_submit(PLCRASH_SCHEDULER_QOS_BACKGROUND, (uintptr_t) &keyed, DISPATCH_TIME_FOREVER, count_call, count_release, &keyed, NULL);
+
+    STAssertTrue(plcrash_nasync_scheduler_cancel(work), @"Failed to cancel pending work");
+    STAssertFalse(plcrash_nasync_scheduler_cancel(work), @"Cancelled work twice");
+    STAssertEquals(ctx.releases, 1, @"Cancelled context was not released");
+
+    STAssertTrue(plcrash_nasync_scheduler_cancel_key((uintptr_t) &keyed), @"Failed to cancel pending work by key");
+    STAssertFalse(plcrash_nasync_scheduler_cancel_key((uintptr_t) &keyed), @"Cancelled keyed work twice");
+    STAssertEquals(keyed.releases, 1, @"Cancelled context was not released");
+
+    /* Cancelled work is complete */
+    STAssertTrue(plcrash_nasync_scheduler_wait(work, DISPATCH_TIME_NOW), @"Cancelled work is not complete");
+
+    [self unblock];
+    STAssertEquals(ctx.calls, 0, @"Cancelled work was executed");
+    STAssertEquals(keyed.calls, 0, @"Cancelled work was executed");
+
+    plcrash_nasync_scheduler_work_release(work);
+}
+
+@end
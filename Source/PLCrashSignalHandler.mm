@@ -32,12 +32,16 @@
 #import "PLCrashFrameWalker.h"
 #import "PLCrashReporterNSError.h"
 
-#import "PLCrashAsyncLinkedList.hpp"
-
 #import <signal.h>
 #import <unistd.h>
+#import <libkern/OSAtomic.h>
 
-using namespace plcrash::async;
+/**
+ * @internal
+ *
+ * The maximum number of callbacks that may be registered for a single signal.
+ */
+#define PLCRASH_SIGNAL_MAX_CALLBACKS 8
 
 /**
  * @internal
@@ -72,16 +76,36 @@ struct PLCrashSignalHandlerCallback {
 /**
  * @internal
  *
- * A registered POSIX signal handler action. This is used to represent previously
- * registered signal handlers that have been replaced by the PLCrashSignalHandler's
- * global signal handler.
+ * An immutable per-signal dispatch table. Tables are never modified once published; registration of a new callback
+ * instead publishes a new copy of the table, allowing the signal handler to dispatch via an indexed load without
+ * any reader synchronization.
  */
-struct plcrash_signal_handler_action {
-    /** Signal type. */
-    int signo;
-    
-    /** Signal handler action. */
-    struct sigaction action;
+struct plcrash_signal_table {
+    /** Registered callbacks, in dispatch order. */
+    plcrash_signal_user_callback callbacks[PLCRASH_SIGNAL_MAX_CALLBACKS];
+
+    /** The number of valid entries in @a callbacks. */
+    uint32_t callback_count;
+
+    /** If true, @a previous_action contains the POSIX signal handler action replaced by PLCrashSignalHandler. */
+    bool has_previous_action;
+
+    /** The previously registered signal handler action. Only valid if @a has_previous_action is true. */
+    struct sigaction previous_action;
+};
+
+/**
+ * @internal
+ *
+ * Position within a plcrash_signal_table, used as the context of a forwarding PLCrashSignalHandlerCallback.
+ */
+struct plcrash_signal_table_cursor {
+    /** The table being dispatched. */
+    const plcrash_signal_table *table;
+
+    /** The index of the next callback to be executed; if equal to the table's callback count, the previous
+     * action (if any) is next. */
+    uint32_t index;
 };
 
 /**
@@ -90,98 +114,72 @@ struct plcrash_signal_handler_action {
  */
 static struct {
     /** @internal
-     * Registered callbacks. */
-    async_list<plcrash_signal_user_callback> callbacks;
-    
-    /** @internal
-     * Originaly registered signal handlers. This list should only be mutated in
-     * -[PLCrashSignalHandler registerHandlerWithSignal:error:] with the appropriate locks held. */
-    async_list<plcrash_signal_handler_action> previous_actions;
+     * Published dispatch tables, indexed by signal number, or NULL if no handler has been registered. Tables should only
+     * be published from -[PLCrashSignalHandler registerHandlerForSignal:callback:context:error:] with the appropriate
+     * locks held. Superseded tables are never freed, as a signal handler may still be dispatching via an older table;
+     * registration is rare and bounded by PLCRASH_SIGNAL_MAX_CALLBACKS per signal. */
+    plcrash_signal_table * volatile tables[NSIG];
 } shared_handler_context;
 
+/** @internal
+ * Serializes publication of the dispatch tables. */
+static pthread_mutex_t registration_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
- * Finds and executes the first matching signal handler in the shared previous_actions list; this is used
- * to support executing process-wide POSIX signal handlers that were previously registered before being replaced by
+ * Executes the POSIX signal handler previously registered in @a table, if any; this is used to support executing
+ * process-wide POSIX signal handlers that were previously registered before being replaced by
  * PLCrashSignalHandler::registerHandlerForSignal:.
  */
-static bool previous_action_callback (int signo, siginfo_t *info, ucontext_t *uap, void *context, PLCrashSignalHandlerCallback *nextHandler) {
-    bool handled = false;
+static bool previous_action_dispatch (const plcrash_signal_table *table, int signo, siginfo_t *info, ucontext_t *uap) {
+    if (!table->has_previous_action)
+        return false;
 
-    /* Let any additional handler execute */
-    if (PLCrashSignalHandlerForward(nextHandler, signo, info, uap))
+    // TODO - Should we handle the other flags, eg, SA_RESETHAND, SA_ONSTACK? */
+    const struct sigaction *action = &table->previous_action;
+    if (action->sa_flags & SA_SIGINFO) {
+        action->sa_sigaction(signo, info, (void *) uap);
         return true;
+    }
 
-    shared_handler_context.previous_actions.set_reading(true); {
-        /* Find the first matching handler */
-        async_list<plcrash_signal_handler_action>::node *next = NULL;
-        while ((next = shared_handler_context.previous_actions.next(next)) != NULL) {
-            /* Skip non-matching entries */
-            if (next->value().signo != signo)
-                continue;
-
-            /* Found a match */
-            // TODO - Should we handle the other flags, eg, SA_RESETHAND, SA_ONSTACK? */
-            if (next->value().action.sa_flags & SA_SIGINFO) {
-                next->value().action.sa_sigaction(signo, info, (void *) uap);
-                handled = true;
-            } else {
-                void (*next_handler)(int) = next->value().action.sa_handler;
-                if (next_handler == SIG_IGN) {
-                    /* Ignored */
-                    handled = true;
-
-                } else if (next_handler == SIG_DFL) {
-                    /* Default handler should be run, be we have no mechanism to pass through to
-                     * the default handler; mark the signal as unhandled. */
-                    handled = false;
-
-                } else {
-                    /* Handler registered, execute it */
-                    next_handler(signo);
-                    handled = true;
-                }
-            }
-            
-            /* Handler was found; iteration done */
-            break;
-        }
-    } shared_handler_context.previous_actions.set_reading(false);
+    void (*next_handler)(int) = action->sa_handler;
+    if (next_handler == SIG_IGN) {
+        /* Ignored */
+        return true;
+    } else if (next_handler == SIG_DFL) {
+        /* Default handler should be run, be we have no mechanism to pass through to
+         * the default handler; mark the signal as unhandled. */
+        return false;
+    }
 
-    return handled;
+    /* Handler registered, execute it */
+    next_handler(signo);
+    return true;
 }
 
 /*
- * Recursively iterates the actual callbacks registered in our shared_handler_context. To begin iteration,
- * provide a value of NULL for 'context'.
+ * Dispatches the signal to the callback at the cursor's position (or the previous action, if all callbacks have been
+ * executed), providing the following entry as the forwarding target.
  */
 static bool internal_callback_iterator (int signo, siginfo_t *info, ucontext_t *uap, void *context) {
-    /* Call the next handler in the chain. If this is the last handler in the chain, pass it the original signal
-     * handlers. */
-    bool handled = false;
-    shared_handler_context.callbacks.set_reading(true); {
-        async_list<plcrash_signal_user_callback>::node *prev = (async_list<plcrash_signal_user_callback>::node *) context;
-        async_list<plcrash_signal_user_callback>::node *current = shared_handler_context.callbacks.next(prev);
-
-        /* Check for end-of-list */
-        if (current == NULL) {
-            shared_handler_context.callbacks.set_reading(false);
-            return false;
-        }
-        
-        /* Check if any additional handlers are registered. If so, provide the next handler as the forwarding target. */
-        if (shared_handler_context.callbacks.next(current) != NULL) {
-            PLCrashSignalHandlerCallback next_handler = {
-                .callback = internal_callback_iterator,
-                .context = current
-            };
-            handled = current->value().callback(signo, info, uap, current->value().context, &next_handler);
-        } else {
-            /* Otherwise, we've hit the final handler in the list. */
-            handled = current->value().callback(signo, info, uap, current->value().context, NULL);
-        }
-    } shared_handler_context.callbacks.set_reading(false);
+    const plcrash_signal_table_cursor *cursor = (const plcrash_signal_table_cursor *) context;
+    const plcrash_signal_table *table = cursor->table;
+
+    /* Check for end-of-list; pass the signal to the original signal handler */
+    if (cursor->index >= table->callback_count)
+        return previous_action_dispatch(table, signo, info, uap);
+
+    /* Provide the next entry as the forwarding target. */
+    const plcrash_signal_user_callback *current = &table->callbacks[cursor->index];
+    plcrash_signal_table_cursor next = {
+        .table = table,
+        .index = cursor->index + 1
+    };
+    PLCrashSignalHandlerCallback next_handler = {
+        .callback = internal_callback_iterator,
+        .context = &next
+    };
 
-    return handled;
+    return current->callback(signo, info, uap, current->context, &next_handler);
 };
 
 /** 
@@ -195,10 +193,24 @@ static bool internal_callback_iterator (int signo, siginfo_t *info, ucontext_t *
  * @param uapVoid A ucontext_t pointer argument.
  */
 void plcrash_signal_handler (int signo, siginfo_t *info, void *uapVoid) {
+    /* Fetch the signal's current dispatch table. */
+    const plcrash_signal_table *table = NULL;
+    if (signo > 0 && signo < NSIG)
+        table = shared_handler_context.tables[signo];
+
     /* Start iteration; we currently re-raise the signal if not handled by callbacks; this should be revisited
      * in the future, as the signal may not be raised on the expected thread.
      */
-    if (!internal_callback_iterator(signo, info, (ucontext_t *) uapVoid, NULL))
+    bool handled = false;
+    if (table != NULL) {
+        plcrash_signal_table_cursor cursor = {
+            .table = table,
+            .index = 0
+        };
+        handled = internal_callback_iterator(signo, info, (ucontext_t *) uapVoid, &cursor);
+    }
+
+    if (!handled)
         raise(signo);
 }
 
@@ -258,19 +270,14 @@ static PLCrashSignalHandler *sharedHandler;
  * and should be avoided in production code.
  */
 + (void) resetHandlers {
-    /* Reset all saved signal handlers */
-    shared_handler_context.previous_actions.set_reading(true); {
-        async_list<plcrash_signal_handler_action>::node *next = NULL;
-        while ((next = shared_handler_context.previous_actions.next(next)) != NULL)
-            shared_handler_context.previous_actions.nasync_remove_node(next);
-    } shared_handler_context.previous_actions.set_reading(false);
-
-    /* Reset all callbacks */
-    shared_handler_context.callbacks.set_reading(true); {
-        async_list<plcrash_signal_user_callback>::node *next = NULL;
-        while ((next = shared_handler_context.callbacks.next(next)) != NULL)
-            shared_handler_context.callbacks.nasync_remove_node(next);
-    } shared_handler_context.callbacks.set_reading(false);
+    pthread_mutex_lock(&registration_lock); {
+        /* Reset all callbacks and saved signal handlers. The superseded tables are not freed, as a signal handler
+         * may still be dispatching via the table. */
+        for (int signo = 0; signo < NSIG; signo++) {
+            if (shared_handler_context.tables[signo] != NULL)
+                OSAtomicCompareAndSwapPtrBarrier(shared_handler_context.tables[signo], NULL, (void * volatile *) &shared_handler_context.tables[signo]);
+        }
+    } pthread_mutex_unlock(&registration_lock);
 }
 
 /**
@@ -298,20 +305,26 @@ static PLCrashSignalHandler *sharedHandler;
 }
 
 /**
- * Register a signal handler for the given @a signo, if not yet registered. If a handler has already been registered,
+ * Register a signal handler for the given @a signo, if not yet registered, and publish a new dispatch table for
+ * @a signo with @a callback prepended to any existing callbacks. If a handler has already been registered,
  * no changes will be made to the existing handler.
  *
  * We register only one signal handler for any given signal number; All instances share the same async-safe/thread-safe
- * ordered list of callbacks.
+ * per-signal dispatch tables.
  *
  * @param signo The signal number for which a handler should be registered.
+ * @param callback The callback to be added to the signal's dispatch table.
  * @param outError A pointer to an NSError object variable. If an error occurs, this
  * pointer will contain an error object indicating why the signal handlers could not be
  * registered. If no error occurs, this parameter will be left unmodified.
  */
-- (BOOL) registerHandlerWithSignal: (int) signo error: (NSError **) outError {
-    static pthread_mutex_t registerHandlers = PTHREAD_MUTEX_INITIALIZER;
-    pthread_mutex_lock(&registerHandlers); {
+- (BOOL) registerHandlerWithSignal: (int) signo callback: (plcrash_signal_user_callback) callback error: (NSError **) outError {
+    if (signo <= 0 || signo >= NSIG) {
+        plcrash_populate_posix_error(outError, EINVAL, @"Invalid signal number");
+        return NO;
+    }
+
+    pthread_mutex_lock(&registration_lock); {
         static BOOL singleShotInitialization = NO;
 
         /* Perform operations that only need to be done once per process.
@@ -327,34 +340,42 @@ static PLCrashSignalHandler *sharedHandler;
             if (sigaltstack(&_sigstk, 0) < 0) {
                 /* This should only fail if we supply invalid arguments to sigaltstack() */
                 plcrash_populate_posix_error(outError, errno, @"Could not initialize alternative signal stack");
+                pthread_mutex_unlock(&registration_lock);
                 return NO;
             }
-            
-            /*
-             * Add the pass-through sigaction callback as the last element in the callback list.
-             */
-            plcrash_signal_user_callback sa = {
-                .callback = previous_action_callback,
-                .context = NULL
-            };
-            shared_handler_context.callbacks.nasync_append(sa);
+
+            singleShotInitialization = YES;
+        }
+
+        /* Fetch the current table, if any */
+        plcrash_signal_table *current = shared_handler_context.tables[signo];
+        if (current != NULL && current->callback_count == PLCRASH_SIGNAL_MAX_CALLBACKS) {
+            plcrash_populate_posix_error(outError, ENOSPC, @"The maximum number of callbacks has been registered for this signal");
+            pthread_mutex_unlock(&registration_lock);
+            return NO;
+        }
+
+        /* Construct the new table prior to registering our signal handler; once the handler is registered, the
+         * table must be published without any failure path. */
+        plcrash_signal_table *table = (plcrash_signal_table *) calloc(1, sizeof(*table));
+        if (table == NULL) {
+            plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate signal dispatch table");
+            pthread_mutex_unlock(&registration_lock);
+            return NO;
+        }
+
+        table->callbacks[0] = callback;
+        table->callback_count = 1;
+        if (current != NULL) {
+            for (uint32_t i = 0; i < current->callback_count; i++)
+                table->callbacks[table->callback_count++] = current->callbacks[i];
+
+            table->has_previous_action = current->has_previous_action;
+            table->previous_action = current->previous_action;
         }
-        
-        /* Check whether the signal already has a registered handler. */
-        BOOL isRegistered = NO;
-        shared_handler_context.previous_actions.set_reading(true); {
-            /* Find the first matching handler */
-            async_list<plcrash_signal_handler_action>::node *next = NULL;
-            while ((next = shared_handler_context.previous_actions.next(next)) != NULL) {
-                if (next->value().signo == signo) {
-                    isRegistered = YES;
-                    break;
-                }
-            }
-        } shared_handler_context.previous_actions.set_reading(false);
 
         /* Register handler for the requested signal */
-        if (!isRegistered) {
+        if (current == NULL) {
             struct sigaction sa;
             struct sigaction sa_prev;
             
@@ -368,6 +389,8 @@ static PLCrashSignalHandler *sharedHandler;
             if (sigaction(signo, &sa, &sa_prev) != 0) {
                 int err = errno;
                 plcrash_populate_posix_error(outError, err, @"Failed to register signal handler");
+                free(table);
+                pthread_mutex_unlock(&registration_lock);
                 return NO;
             }
             
@@ -375,16 +398,20 @@ static PLCrashSignalHandler *sharedHandler;
              * we may not call the previous signal handler if signal occurs prior to our saving
              * the caller's handler.
              *
+             * If the previous action is our own handler (eg, after +resetHandlers), it must not be chained to.
+             *
              * TODO - Investigate use of async-safe locking to avoid this condition. See also:
              * The PLCrashReporter class's enabling of Mach exceptions.
              */
-            plcrash_signal_handler_action act = {
-                .signo = signo,
-                .action = sa_prev
-            };
-            shared_handler_context.previous_actions.nasync_append(act);
+            if (!((sa_prev.sa_flags & SA_SIGINFO) && sa_prev.sa_sigaction == &plcrash_signal_handler)) {
+                table->has_previous_action = true;
+                table->previous_action = sa_prev;
+            }
         }
-    } pthread_mutex_unlock(&registerHandlers);
+
+        /* Publish the fully initialized table */
+        OSAtomicCompareAndSwapPtrBarrier(current, table, (void * volatile *) &shared_handler_context.tables[signo]);
+    } pthread_mutex_unlock(&registration_lock);
     
     return YES;
 }
@@ -395,6 +422,8 @@ static PLCrashSignalHandler *sharedHandler;
  * @param signo The signal for which a signal handler should be registered. Note that multiple callbacks may be registered
  * for a single signal, with chaining handled appropriately by the receiver. If multiple callbacks are registered, they may
  * <em>optionally</em> forward the signal to the next callback (and the original signal handler, if any was registered) via PLCrashSignalHandlerForward.
+ * The callback will only be issued for @a signo; at most PLCRASH_SIGNAL_MAX_CALLBACKS callbacks may be registered for
+ * any one signal.
  * @param callback Callback to be issued upon receipt of a signal. The callback will execute on the crashed thread.
  * @param context Context to be passed to the callback. May be NULL.
  * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error object indicating why
@@ -410,18 +439,12 @@ static PLCrashSignalHandler *sharedHandler;
                           context: (void *) context
                             error: (NSError **) outError
 {
-    /* Register the actual signal handler, if necessary */
-    if (![self registerHandlerWithSignal: signo error: outError])
-        return NO;
-    
-    /* Add the new callback to the shared state list. */
+    /* Register the actual signal handler, if necessary, and publish the new callback. */
     plcrash_signal_user_callback reg = {
         .callback = callback,
         .context = context
     };
-    shared_handler_context.callbacks.nasync_prepend(reg);
-    
-    return YES;
+    return [self registerHandlerWithSignal: signo callback: reg error: outError];
 }
 
 @end
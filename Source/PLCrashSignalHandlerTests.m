@@ -167,4 +167,50 @@ static void sa_handler_cb (int signo) {
 }
 
 
+static bool counting_crash_cb (int signal, siginfo_t *siginfo, ucontext_t *uap, void *context, PLCrashSignalHandlerCallback *next) {
+    /* Note that we ran */
+    int *count = (int *) context;
+    (*count)++;
+
+    return true;
+}
+
+/**
+ * Verify that callbacks are only dispatched for the signal for which they were registered, and that the most
+ * recently registered callback is dispatched first.
+ */
+- (void) testPerSignalDispatch {
+    NSError *error;
+    int busCount = 0;
+    int trapCount = 0;
+    int latestTrapCount = 0;
+
+    STAssertTrue([[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: SIGBUS
+                                                                       callback: &counting_crash_cb
+                                                                        context: &busCount
+                                                                          error: &error], @"Could not register signal handler: %@", error);
+    STAssertTrue([[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: SIGTRAP
+                                                                       callback: &counting_crash_cb
+                                                                        context: &trapCount
+                                                                          error: &error], @"Could not register signal handler: %@", error);
+    STAssertTrue([[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: SIGTRAP
+                                                                       callback: &counting_crash_cb
+                                                                        context: &latestTrapCount
+                                                                          error: &error], @"Could not register signal handler: %@", error);
+
+    /* Dispatch SIGTRAP; the callback handles the signal, and does not forward it */
+    siginfo_t si;
+    ucontext_t uc;
+    plcrash_signal_handler(SIGTRAP, &si, &uc);
+
+    STAssertEquals(latestTrapCount, 1, @"Most recently registered SIGTRAP callback did not run");
+    STAssertEquals(trapCount, 0, @"Earlier SIGTRAP callback should not run unless forwarded");
+    STAssertEquals(busCount, 0, @"SIGBUS callback should not run for SIGTRAP");
+
+    /* Dispatch SIGBUS */
+    plcrash_signal_handler(SIGBUS, &si, &uc);
+    STAssertEquals(busCount, 1, @"SIGBUS callback did not run");
+    STAssertEquals(latestTrapCount, 1, @"SIGTRAP callback should not run for SIGBUS");
+}
+
 @end
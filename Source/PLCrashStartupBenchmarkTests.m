@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import <objc/runtime.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <signal.h>
+
+#import "CrashReporter.h"
+#import "PLCrashLogWriter.h"
+#import "PLCrashAsyncAllocator.h"
+#import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashFeatureConfig.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+#import "PLCrashMachExceptionServer.h"
+#import "PLCrashMachExceptionPort.h"
+#import "PLCrashMachExceptionPortSet.h"
+#endif
+
+/** The number of times each configuration is benchmarked. */
+#define STARTUP_BENCHMARK_ITERATIONS 5
+
+/**
+ * The enable steps measured by the startup benchmark, in the order performed by
+ * -[PLCrashReporter enableCrashReporterAndReturnError:].
+ */
+typedef enum {
+    /** Creation of the crash report directory tree. */
+    STARTUP_STEP_DIRECTORY = 0,
+
+    /** Creation of the pre-crash allocator and report write buffer. */
+    STARTUP_STEP_ALLOCATOR,
+
+    /** Creation of the dynamic loader reference. */
+    STARTUP_STEP_DYNLOADER,
+
+    /** Initialization of the log writer, including the host and process information sysctls. */
+    STARTUP_STEP_WRITER_INIT,
+
+    /** Preparation of the standby symbol and ObjC class caches. */
+    STARTUP_STEP_STANDBY,
+
+    /** Faulting in and wiring of the crash-path memory. */
+    STARTUP_STEP_PREFAULT,
+
+    /** Installation of the signal handlers. */
+    STARTUP_STEP_SIGNAL_HANDLERS,
+
+    /** Creation of the Mach exception server thread and registration of its port. */
+    STARTUP_STEP_MACH_SERVER,
+
+    /** The number of steps. */
+    STARTUP_STEP_COUNT
+} startup_step_t;
+
+/** Step names, indexed by startup_step_t. */
+static const char *startup_step_names[STARTUP_STEP_COUNT] = {
+    "directory",
+    "allocator",
+    "dynloader",
+    "writer init",
+    "standby cache",
+    "prefault",
+    "signal handlers",
+    "mach server"
+};
+
+/** A reporter configuration benchmarked by the startup benchmark. */
+typedef struct startup_config {
+    /** If true, symbolicate via the symbol table and ObjC metadata. */
+    bool symbolicate;
+
+    /** If true, prefault and wire the crash-path memory (see PLCrashReporterConfig::shouldPrefaultCrashMemory). */
+    bool prefault;
+
+    /** If true, defer the directory, host information, standby cache, and prefault steps, as performed by
+     * -[PLCrashReporter enableCrashReporterWithDeferredSetupAndReturnError:]. */
+    bool deferred;
+
+    /** If true, use the Mach exception handler (see PLCrashReporterSignalHandlerTypeMach). */
+    bool mach;
+} startup_config_t;
+
+/** Results of benchmarking a single configuration. */
+typedef struct startup_result {
+    /** Total elapsed time of each step, in nanoseconds. */
+    uint64_t step_ns[STARTUP_STEP_COUNT];
+
+    /** Total elapsed time of the steps performed prior to the enable call returning, in nanoseconds. */
+    uint64_t launch_ns;
+
+    /** Total elapsed time of the deferred steps, in nanoseconds. */
+    uint64_t deferred_ns;
+
+    /** Largest increase in resident memory observed once all steps were complete, in bytes. */
+    int64_t resident_bytes;
+
+    /** Largest increase in the task's physical footprint (its dirty memory) observed once all steps were
+     * complete, in bytes. */
+    int64_t dirty_bytes;
+} startup_result_t;
+
+/**
+ * Startup cost benchmarks for enabling the crash reporter.
+ *
+ * A reporter may only be enabled once per process, and can not be disabled; rather than enabling a reporter, these
+ * tests replay the steps performed by -[PLCrashReporter enableCrashReporterAndReturnError:] for each combination of
+ * symbolication, prefaulting, deferred setup, and handler type, tearing the resulting state down after each run.
+ * Signal handlers and exception ports are restored once measured.
+ *
+ * The wall time of each step, and the resident and dirty memory retained once all steps are complete, are reported
+ * via NSLog(); the tests verify only that every step succeeded.
+ */
+@interface PLCrashStartupBenchmarkTests : SenTestCase {
+@private
+    /** Temporary directory in which the crash report directory tree is created. */
+    NSString *_testDirectory;
+}
+@end
+
+@implementation PLCrashStartupBenchmarkTests
+
+- (void) setUp {
+    _testDirectory = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _testDirectory error: NULL];
+    [_testDirectory release];
+}
+
+/* Return the task's current resident size and physical footprint */
+static void startup_task_memory (int64_t *resident, int64_t *dirty) {
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) {
+        *resident = 0;
+        *dirty = 0;
+        return;
+    }
+
+    *resident = (int64_t) info.resident_size;
+    *dirty = (int64_t) info.phys_footprint;
+}
+
+/* Return the nanoseconds elapsed since @a start */
+static uint64_t startup_elapsed_ns (uint64_t start) {
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    return (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+}
+
+/* No-op signal handler, installed in place of the reporter's handler */
+static void startup_signal_handler (int signo, siginfo_t *info, void *uapv) {
+}
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+/* Exception callback, installed in place of the reporter's callback; declines all exceptions */
+static kern_return_t startup_exception_callback (task_t task, thread_t thread, exception_type_t exception_type,
+                                                 mach_exception_data_t code, mach_msg_type_number_t code_count, void *context)
+{
+    return KERN_FAILURE;
+}
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+
+/**
+ * Perform the enable steps for @a config once, adding the results to @a result.
+ */
+- (void) runConfiguration: (const startup_config_t *) config result: (startup_result_t *) result {
+    static const int signals[] = { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV, SIGTRAP };
+    const size_t signal_count = sizeof(signals) / sizeof(signals[0]);
+    struct sigaction previous_actions[sizeof(signals) / sizeof(signals[0])];
+
+    PLCrashReporterConfig *reporterConfig = [PLCrashReporterConfig defaultConfiguration];
+    plcrash_async_symbol_strategy_t strategy = config->symbolicate ? PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL : PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE;
+    NSString *reportDirectory = [_testDirectory stringByAppendingPathComponent: @"reports"];
+    NSDictionary *attributes = [NSDictionary dictionaryWithObject: [NSNumber numberWithUnsignedLong: 0755] forKey: NSFilePosixPermissions];
+    uint64_t step_ns[STARTUP_STEP_COUNT] = { 0 };
+    uint64_t deferred_host_info_ns = 0;
+    bool deferred_steps[STARTUP_STEP_COUNT] = { false };
+    plcrash_async_allocator_t *allocator = NULL;
+    plcrash_async_dynloader_t *loader = NULL;
+    plcrash_log_writer_t writer;
+    int64_t base_resident, base_dirty;
+    int64_t resident, dirty;
+    uint64_t start;
+
+    startup_task_memory(&base_resident, &base_dirty);
+
+    /* Steps performed on launch */
+    if (!config->deferred) {
+        start = mach_absolute_time();
+        STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: [reportDirectory stringByAppendingPathComponent: @"queued"] withIntermediateDirectories: YES attributes: attributes error: NULL], @"Failed to create the report directory");
+        step_ns[STARTUP_STEP_DIRECTORY] = startup_elapsed_ns(start);
+    }
+
+    start = mach_absolute_time();
+    STAssertEquals(plcrash_async_allocator_create(&allocator, PAGE_SIZE + [reporterConfig writeBufferSize]), PLCRASH_ESUCCESS, @"Failed to create the allocator");
+    if ([reporterConfig writeBufferSize] > 0) {
+        void *buffer;
+        STAssertEquals(plcrash_async_allocator_alloc(allocator, &buffer, [reporterConfig writeBufferSize]), PLCRASH_ESUCCESS, @"Failed to allocate the write buffer");
+    }
+    step_ns[STARTUP_STEP_ALLOCATOR] = startup_elapsed_ns(start);
+
+    start = mach_absolute_time();
+    STAssertEquals(plcrash_nasync_dynloader_new(&loader, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create the dynamic loader");
+    step_ns[STARTUP_STEP_DYNLOADER] = startup_elapsed_ns(start);
+
+    start = mach_absolute_time();
+    if (config->deferred) {
+        STAssertEquals(plcrash_log_writer_init_deferred(&writer, @"test.id", @"1.0", @"1.0", strategy, false), PLCRASH_ESUCCESS, @"Failed to initialize the writer");
+    } else {
+        STAssertEquals(plcrash_log_writer_init(&writer, @"test.id", @"1.0", @"1.0", strategy, false), PLCRASH_ESUCCESS, @"Failed to initialize the writer");
+    }
+    step_ns[STARTUP_STEP_WRITER_INIT] = startup_elapsed_ns(start);
+
+    /* Install the handlers */
+    start = mach_absolute_time();
+    for (size_t i = 0; i < signal_count; i++) {
+        if (config->mach && signals[i] != SIGABRT) {
+            sigaction(signals[i], NULL, &previous_actions[i]);
+            continue;
+        }
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_sigaction = &startup_signal_handler;
+        STAssertEquals(sigaction(signals[i], &sa, &previous_actions[i]), 0, @"Failed to install signal handler: %s", strerror(errno));
+    }
+    step_ns[STARTUP_STEP_SIGNAL_HANDLERS] = startup_elapsed_ns(start);
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    PLCrashMachExceptionServer *server = nil;
+    PLCrashMachExceptionPortSet *previousPorts = nil;
+    if (config->mach) {
+        NSError *error;
+        start = mach_absolute_time();
+        void *context = NULL;
+        server = [[PLCrashMachExceptionServer alloc] initWithCallBack: &startup_exception_callback
+                                                             contexts: &context
+                                                          threadCount: 1
+                                                           scheduling: PLCRASH_EXCEPTION_SERVER_SCHED_DEFAULT
+                                                       wiredStackSize: [reporterConfig machExceptionThreadStackSize]
+                                                                error: &error];
+        STAssertNotNil(server, @"Failed to create the exception server: %@", error);
+
+        PLCrashMachExceptionPort *port = [server exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+        STAssertNotNil(port, @"Failed to create the exception port: %@", error);
+        STAssertTrue([port registerForTask: mach_task_self() previousPortSet: &previousPorts error: &error], @"Failed to register the exception port: %@", error);
+        [previousPorts retain];
+        step_ns[STARTUP_STEP_MACH_SERVER] = startup_elapsed_ns(start);
+    }
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+
+    /* Steps performed on launch, or in the background if deferred */
+    if (config->deferred) {
+        start = mach_absolute_time();
+        STAssertEquals(plcrash_log_writer_populate_host_info(&writer), PLCRASH_ESUCCESS, @"Failed to populate host info");
+        deferred_host_info_ns = startup_elapsed_ns(start);
+        step_ns[STARTUP_STEP_WRITER_INIT] += deferred_host_info_ns;
+
+        start = mach_absolute_time();
+        STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: [reportDirectory stringByAppendingPathComponent: @"queued"] withIntermediateDirectories: YES attributes: attributes error: NULL], @"Failed to create the report directory");
+        step_ns[STARTUP_STEP_DIRECTORY] = startup_elapsed_ns(start);
+
+        deferred_steps[STARTUP_STEP_DIRECTORY] = true;
+        deferred_steps[STARTUP_STEP_STANDBY] = true;
+        deferred_steps[STARTUP_STEP_PREFAULT] = true;
+    }
+
+    if (config->symbolicate) {
+        start = mach_absolute_time();
+        STAssertEquals(plcrash_log_writer_prepare_standby(&writer, (size_t) MAX(objc_getClassList(NULL, 0), 0)), PLCRASH_ESUCCESS, @"Failed to prepare the standby cache");
+        step_ns[STARTUP_STEP_STANDBY] = startup_elapsed_ns(start);
+    }
+
+    if (config->prefault) {
+        start = mach_absolute_time();
+        STAssertEquals(plcrash_log_writer_prefault(&writer, true), PLCRASH_ESUCCESS, @"Failed to prefault the writer");
+        STAssertEquals(plcrash_nasync_allocator_prefault(allocator, true), PLCRASH_ESUCCESS, @"Failed to prefault the allocator");
+        step_ns[STARTUP_STEP_PREFAULT] = startup_elapsed_ns(start);
+    }
+
+    /* Record the memory retained by the enabled reporter */
+    startup_task_memory(&resident, &dirty);
+    result->resident_bytes = MAX(result->resident_bytes, resident - base_resident);
+    result->dirty_bytes = MAX(result->dirty_bytes, dirty - base_dirty);
+
+    /* When deferred, the host information is fetched in the background; it is reported with the writer init step */
+    for (int i = 0; i < STARTUP_STEP_COUNT; i++) {
+        result->step_ns[i] += step_ns[i];
+        if (deferred_steps[i])
+            result->deferred_ns += step_ns[i];
+        else
+            result->launch_ns += step_ns[i];
+    }
+    result->launch_ns -= deferred_host_info_ns;
+    result->deferred_ns += deferred_host_info_ns;
+
+    /* Tear down */
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    if (server != nil) {
+        for (PLCrashMachExceptionPort *port in [previousPorts set])
+            [port registerForTask: mach_task_self() previousPortSet: NULL error: NULL];
+
+        [previousPorts release];
+        [server release];
+    }
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+
+    for (size_t i = 0; i < signal_count; i++)
+        sigaction(signals[i], &previous_actions[i], NULL);
+
+    plcrash_log_writer_free(&writer);
+    plcrash_async_dynloader_free(loader);
+    plcrash_async_allocator_free(allocator);
+
+    [[NSFileManager defaultManager] removeItemAtPath: reportDirectory error: NULL];
+}
+
+/**
+ * Benchmark the enable steps for each combination of symbolication, prefaulting, deferred setup, and handler type.
+ */
+- (void) testEnableBenchmark {
+    for (unsigned int i = 0; i < 16; i++) {
+        startup_config_t config = {
+            .symbolicate = (i & 1) != 0,
+            .prefault = (i & 2) != 0,
+            .deferred = (i & 4) != 0,
+            .mach = (i & 8) != 0
+        };
+
+#if !PLCRASH_FEATURE_MACH_EXCEPTIONS
+        if (config.mach)
+            continue;
+#endif
+
+        startup_result_t result;
+        memset(&result, 0, sizeof(result));
+
+        for (int j = 0; j < STARTUP_BENCHMARK_ITERATIONS; j++) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            [self runConfiguration: &config result: &result];
+            [pool drain];
+        }
+
+        NSMutableString *steps = [NSMutableString string];
+        for (int j = 0; j < STARTUP_STEP_COUNT; j++) {
+            [steps appendFormat: @"%s%s: %llu us", j == 0 ? "" : ", ", startup_step_names[j],
+                (unsigned long long) (result.step_ns[j] / STARTUP_BENCHMARK_ITERATIONS / NSEC_PER_USEC)];
+        }
+
+        NSLog(@"enable (%s, %s, %s, %s): %llu us at launch, %llu us deferred; %lld KB resident, %lld KB dirty; %@",
+              config.symbolicate ? "symbolicate" : "no symbolication",
+              config.prefault ? "prefault" : "no prefault",
+              config.deferred ? "deferred setup" : "immediate setup",
+              config.mach ? "mach" : "bsd",
+              (unsigned long long) (result.launch_ns / STARTUP_BENCHMARK_ITERATIONS / NSEC_PER_USEC),
+              (unsigned long long) (result.deferred_ns / STARTUP_BENCHMARK_ITERATIONS / NSEC_PER_USEC),
+              (long long) (result.resident_bytes / 1024), (long long) (result.dirty_bytes / 1024), steps);
+    }
+}
+
+@end
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * @internal
+ *
+ * Demangles Swift and C++ symbol names for display in formatted reports.
+ *
+ * Demangled names are memoized in a process-wide cache keyed by the mangled name; as the same symbols appear in
+ * nearly every report, most names are demangled once per process. All methods are thread-safe.
+ *
+ * C++ names are demangled via __cxa_demangle(). Swift names are demangled via the Swift runtime's swift_demangle()
+ * if the runtime is loaded in the current process; otherwise, Swift names are left mangled.
+ */
+@interface PLCrashSymbolDemangler : NSObject
+
++ (NSString *) demangledNameForSymbol: (NSString *) symbol;
++ (NSDictionary *) demangledNamesForSymbols: (NSSet *) symbols;
+
+@end
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "PLCrashSymbolDemangler.h"
+
+#import <dlfcn.h>
+
+/** @internal
+ * The maximum number of names retained by the memo cache. */
+#define PLCRASH_DEMANGLE_CACHE_LIMIT (64 * 1024)
+
+/** @internal
+ * The minimum number of uncached names for which demangledNamesForSymbols: will demangle concurrently. */
+#define PLCRASH_DEMANGLE_CONCURRENT_MIN 32
+
+/* Provided by libc++abi; declared here to avoid requiring C++ compilation of this file. */
+extern char *__cxa_demangle (const char *mangled_name, char *output_buffer, size_t *length, int *status);
+
+/** The Swift runtime's demangler; see swift/Runtime/Debug.h. */
+typedef char *(*plcrash_swift_demangle_fn) (const char *mangled_name, size_t mangled_name_length, char *output_buffer,
+                                            size_t *output_buffer_size, uint32_t flags);
+
+/**
+ * @internal
+ *
+ * Demangles Swift and C++ symbol names.
+ */
+@implementation PLCrashSymbolDemangler
+
+/* Return the process-wide memo cache. Names that could not be demangled are cached as NSNull. */
+static NSCache *demangle_cache (void) {
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        [cache setCountLimit: PLCRASH_DEMANGLE_CACHE_LIMIT];
+    });
+
+    return cache;
+}
+
+/* Return the Swift runtime's demangler, or NULL if the runtime is not loaded. */
+static plcrash_swift_demangle_fn swift_demangler (void) {
+    static plcrash_swift_demangle_fn fn = NULL;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        fn = (plcrash_swift_demangle_fn) dlsym(RTLD_DEFAULT, "swift_demangle");
+    });
+
+    return fn;
+}
+
+/* Return YES if @a name has the prefix @a prefix. */
+static BOOL has_prefix (const char *name, const char *prefix) {
+    return strncmp(name, prefix, strlen(prefix)) == 0;
+}
+
+/*
+ * Demangle @a symbol, returning nil if it is not a mangled Swift or C++ name, or could not be demangled. The leading
+ * underscore added to all C symbols by Darwin is ignored.
+ */
+static NSString *demangle_symbol (NSString *symbol) {
+    const char *name = [symbol UTF8String];
+    if (name == NULL)
+        return nil;
+
+    if (name[0] == '_' && name[1] != '\0')
+        name++;
+
+    char *demangled = NULL;
+
+    if (has_prefix(name, "_Z")) {
+        /* Itanium C++ ABI */
+        int status;
+        demangled = __cxa_demangle(name, NULL, NULL, &status);
+        if (status != 0) {
+            free(demangled);
+            demangled = NULL;
+        }
+    } else if (has_prefix(name, "$s") || has_prefix(name, "$S") || has_prefix(name, "$e") || has_prefix(name, "_T0")) {
+        /* Swift 5, Swift 4.x, embedded Swift, and Swift 4.0 */
+        plcrash_swift_demangle_fn fn = swift_demangler();
+        if (fn != NULL)
+            demangled = fn(name, strlen(name), NULL, NULL, 0);
+    }
+
+    if (demangled == NULL)
+        return nil;
+
+    NSString *result = [NSString stringWithUTF8String: demangled];
+    free(demangled);
+
+    return result;
+}
+
+/**
+ * Return the demangled form of @a symbol, or nil if @a symbol is not a mangled Swift or C++ name. Results are memoized.
+ *
+ * @param symbol The symbol name, as recorded in the report.
+ */
++ (NSString *) demangledNameForSymbol: (NSString *) symbol {
+    NSCache *cache = demangle_cache();
+
+    id cached = [cache objectForKey: symbol];
+    if (cached == nil) {
+        cached = demangle_symbol(symbol);
+        if (cached == nil)
+            cached = [NSNull null];
+        [cache setObject: cached forKey: symbol];
+    }
+
+    return cached == [NSNull null] ? nil : cached;
+}
+
+/**
+ * Demangle all of @a symbols, returning a dictionary mapping each mangled name to its demangled form. Names that are
+ * not mangled Swift or C++ names are omitted from the result.
+ *
+ * Names that are not already memoized are demangled concurrently.
+ *
+ * @param symbols A set of symbol names, as recorded in the report.
+ */
++ (NSDictionary *) demangledNamesForSymbols: (NSSet *) symbols {
+    NSCache *cache = demangle_cache();
+    NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity: [symbols count]];
+    NSMutableArray *uncached = [NSMutableArray array];
+
+    /* Resolve any memoized names */
+    for (NSString *symbol in symbols) {
+        id cached = [cache objectForKey: symbol];
+        if (cached == nil)
+            [uncached addObject: symbol];
+        else if (cached != [NSNull null])
+            [result setObject: cached forKey: symbol];
+    }
+
+    const NSUInteger count = [uncached count];
+    if (count == 0)
+        return result;
+
+    /* Demangle the remainder; each result is written to its own slot, requiring no further synchronization */
+    id *demangled = calloc(count, sizeof(id));
+    void (^demangle)(size_t) = ^(size_t i) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        demangled[i] = [demangle_symbol([uncached objectAtIndex: i]) retain];
+        [pool drain];
+    };
+
+    if (count >= PLCRASH_DEMANGLE_CONCURRENT_MIN) {
+        dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), demangle);
+    } else {
+        for (NSUInteger i = 0; i < count; i++)
+            demangle(i);
+    }
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *symbol = [uncached objectAtIndex: i];
+        if (demangled[i] != nil) {
+            [result setObject: demangled[i] forKey: symbol];
+            [cache setObject: demangled[i] forKey: symbol];
+            [demangled[i] release];
+        } else {
+            [cache setObject: [NSNull null] forKey: symbol];
+        }
+    }
+    free(demangled);
+
+    return result;
+}
+
+@end
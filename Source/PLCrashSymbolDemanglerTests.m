@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#import "SenTestCompat.h"
+
+#import "PLCrashSymbolDemangler.h"
+
+@interface PLCrashSymbolDemanglerTests : SenTestCase @end
+
+@implementation PLCrashSymbolDemanglerTests
+
+- (void) testDemangleCPlusPlus {
+    STAssertEqualObjects([PLCrashSymbolDemangler demangledNameForSymbol: @"__ZN3foo3barEv"], @"foo::bar()", @"Incorrect demangled name");
+
+    /* Symbols without the Darwin underscore prefix must also be demangled */
+    STAssertEqualObjects([PLCrashSymbolDemangler demangledNameForSymbol: @"_ZN3foo3barEi"], @"foo::bar(int)", @"Incorrect demangled name");
+
+    /* Memoized results must match */
+    STAssertEqualObjects([PLCrashSymbolDemangler demangledNameForSymbol: @"__ZN3foo3barEv"], @"foo::bar()", @"Incorrect memoized name");
+}
+
+- (void) testUnmangledSymbols {
+    STAssertNil([PLCrashSymbolDemangler demangledNameForSymbol: @"_main"], @"C symbols should not be demangled");
+    STAssertNil([PLCrashSymbolDemangler demangledNameForSymbol: @"-[NSObject description]"], @"ObjC symbols should not be demangled");
+    STAssertNil([PLCrashSymbolDemangler demangledNameForSymbol: @"__Z"], @"Malformed names should not be demangled");
+}
+
+/**
+ * Verify that a batch of names large enough to be demangled concurrently is demangled correctly.
+ */
+- (void) testDemangleSymbols {
+    NSMutableSet *symbols = [NSMutableSet set];
+    for (NSUInteger i = 0; i < 256; i++) {
+        NSString *name = [NSString stringWithFormat: @"bar%lu", (unsigned long) i];
+        [symbols addObject: [NSString stringWithFormat: @"__ZN3foo%lu%@Ev", (unsigned long) [name length], name]];
+    }
+    [symbols addObject: @"_main"];
+
+    NSDictionary *demangled = [PLCrashSymbolDemangler demangledNamesForSymbols: symbols];
+    STAssertEquals([demangled count], (NSUInteger) 256, @"Incorrect number of demangled names");
+    STAssertNil([demangled objectForKey: @"_main"], @"C symbols should be omitted");
+
+    for (NSUInteger i = 0; i < 256; i++) {
+        NSString *name = [NSString stringWithFormat: @"bar%lu", (unsigned long) i];
+        NSString *symbol = [NSString stringWithFormat: @"__ZN3foo%lu%@Ev", (unsigned long) [name length], name];
+        NSString *expected = [NSString stringWithFormat: @"foo::%@()", name];
+        STAssertEqualObjects([demangled objectForKey: symbol], expected, @"Incorrect demangled name");
+    }
+
+    /* A second pass is served entirely from the memo cache */
+    STAssertEqualObjects([PLCrashSymbolDemangler demangledNamesForSymbols: symbols], demangled, @"Memoized results differ");
+}
+
+@end
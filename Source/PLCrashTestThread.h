@@ -53,10 +53,14 @@ typedef struct plcrash_test_thread {
     
     /** Thread signaling (used to inform waiting callee that thread is active) */
     pthread_cond_t cond;
+
+    /** The number of synthetic frames to be pushed prior to waiting. */
+    unsigned int depth;
 } plcrash_test_thread_t;
 
 
 void plcrash_test_thread_spawn (plcrash_test_thread_t *thread);
+void plcrash_test_thread_spawn_depth (plcrash_test_thread_t *thread, unsigned int depth);
 void plcrash_test_thread_stop (plcrash_test_thread_t *thread);
 
 /**
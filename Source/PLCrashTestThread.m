@@ -37,10 +37,17 @@
  * @{
  */
 
-/* Thread entry point; simply waits to be asked to exit. */
-static void *test_thread_entry (void *arg) {
-    plcrash_test_thread_t *args = arg;
-    
+/* Recurse until the requested depth has been reached, and then wait to be asked to exit. */
+static void __attribute__((noinline)) test_thread_wait (plcrash_test_thread_t *args, unsigned int depth) {
+    volatile unsigned int frame_depth = depth;
+
+    /* Push another frame; the volatile read following the call prevents this from being optimized into a loop */
+    if (depth < args->depth) {
+        test_thread_wait(args, depth + 1);
+        (void) frame_depth;
+        return;
+    }
+
     /* Acquire the lock and inform our caller that we're active */
     pthread_mutex_lock(&args->lock);
     pthread_cond_signal(&args->cond);
@@ -48,14 +55,27 @@ static void *test_thread_entry (void *arg) {
     /* Wait for a shut down request, and then drop the acquired lock immediately */
     pthread_cond_wait(&args->cond, &args->lock);
     pthread_mutex_unlock(&args->lock);
-    
+}
+
+/* Thread entry point; simply waits to be asked to exit. */
+static void *test_thread_entry (void *arg) {
+    test_thread_wait(arg, 0);
     return NULL;
 }
 
 
 /** Spawn a test thread that may be used as an iterable stack. (For testing only!) */
 void plcrash_test_thread_spawn (plcrash_test_thread_t *args) {
+    plcrash_test_thread_spawn_depth(args, 0);
+}
+
+/**
+ * Spawn a test thread that pushes @a depth additional frames prior to waiting, for use as a synthetic deep
+ * stack. (For testing only!)
+ */
+void plcrash_test_thread_spawn_depth (plcrash_test_thread_t *args, unsigned int depth) {
     /* Initialize the args */
+    args->depth = depth;
     pthread_mutex_init(&args->lock, NULL);
     pthread_cond_init(&args->cond, NULL);
     
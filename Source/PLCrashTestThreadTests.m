@@ -29,6 +29,7 @@
 #import "SenTestCompat.h"
 
 #import "PLCrashAsyncThread.h"
+#import "PLCrashFrameWalker.h"
 #import "PLCrashTestThread.h"
 
 @interface PLCrashTestThreadTests : SenTestCase {
@@ -49,4 +50,30 @@
     plcrash_test_thread_stop(&thr);
 }
 
+/**
+ * Verify that a test thread spawned with a requested depth pushes the requested number of frames.
+ */
+- (void) testDepth {
+    plcrash_async_allocator_t *allocator;
+    plcrash_async_image_list_t *image_list;
+    plcrash_test_thread_t thr;
+    plframe_cursor_t cursor;
+    size_t frames = 0;
+
+    STAssertEquals(plcrash_async_allocator_create(&allocator, PAGE_SIZE*2), PLCRASH_ESUCCESS, @"Failed to create allocator");
+    STAssertEquals(plcrash_nasync_image_list_new(&image_list, allocator, mach_task_self()), PLCRASH_ESUCCESS, @"Failed to create image list");
+
+    plcrash_test_thread_spawn_depth(&thr, 64);
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(thr.thread), image_list), @"Failed to initialize cursor");
+    while (plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS)
+        frames++;
+    plframe_cursor_free(&cursor);
+    plcrash_test_thread_stop(&thr);
+
+    STAssertTrue(frames > 64, @"Only %zu frames were found", frames);
+
+    plcrash_async_image_list_free(image_list);
+    plcrash_async_allocator_free(allocator);
+}
+
 @end
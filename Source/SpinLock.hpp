@@ -32,6 +32,9 @@
 #include "PLCrashAsync.h"
 #include "PLCrashMacros.h"
 
+#include <mach/mach.h>
+#include <mach/thread_switch.h>
+
 /**
  * @internal
  * @ingroup plcrash_async
@@ -48,10 +51,38 @@ PLCR_CPP_BEGIN_ASYNC_NS
  */
 class SpinLock {
 public:
+    /**
+     * Spin policy flags, controlling how lock() waits on a contended lock.
+     */
+    typedef enum {
+        /** Issue a processor pause/yield hint between acquisition attempts. */
+        SpinPause = 1 << 0,
+
+        /** Exponentially increase the number of pause hints issued between acquisition attempts, up to max_backoff. */
+        SpinBackoff = 1 << 1,
+
+        /**
+         * After thread_switch_threshold failed acquisition attempts, depress the calling thread's priority via the
+         * async-safe thread_switch() trap, allowing a descheduled lock holder to run.
+         */
+        SpinThreadSwitch = 1 << 2,
+
+        /** The default spin policy. */
+        SpinDefault = SpinPause | SpinBackoff | SpinThreadSwitch,
+    } SpinPolicy;
+
+    /** The maximum number of pause hints issued between acquisition attempts when SpinBackoff is enabled. */
+    static constexpr uint32_t max_backoff = 1024;
+
+    /** The number of failed acquisition attempts after which SpinThreadSwitch will yield the processor. */
+    static constexpr uint32_t thread_switch_threshold = 16;
+
     /**
      * Construct a new spin lock.
+     *
+     * @param policy A bitwise OR of SpinPolicy flags.
      */
-    SpinLock () : _mtx(0) {
+    SpinLock (uint32_t policy = SpinDefault) : _mtx(0), _policy(policy), _contention(0) {
         /* Make sure everyone sees an initialized _mtx value. */
         __sync_synchronize();
     }
@@ -70,7 +101,29 @@ public:
 
     /** Acquire the lock. */
     inline void lock () {
-        while (!tryLock());
+        if (tryLock())
+            return;
+
+        /* Record the contention */
+        __sync_fetch_and_add(&_contention, 1);
+
+        uint32_t backoff = 1;
+        for (uint32_t attempts = 1; ; attempts++) {
+            if (_policy & SpinPause) {
+                for (uint32_t i = 0; i < backoff; i++)
+                    pause();
+            }
+
+            if ((_policy & SpinThreadSwitch) && attempts >= thread_switch_threshold)
+                thread_switch(MACH_PORT_NULL, SWITCH_OPTION_DEPRESS, 1);
+
+            /* Only retry the CAS once the lock appears free, avoiding needless cache line invalidation */
+            if (_mtx == 0 && tryLock())
+                return;
+
+            if ((_policy & SpinBackoff) && backoff < max_backoff)
+                backoff <<= 1;
+        }
     }
 
     /** Release the lock. */
@@ -84,9 +137,29 @@ public:
         }
     }
 
+    /** Return the number of lock() calls that found the lock already held. */
+    inline uint32_t contention_count () {
+        return _contention;
+    }
+
 private:
+    /** Issue a processor-specific spin-wait hint. */
+    static inline void pause () {
+#if defined(__i386__) || defined(__x86_64__)
+        __asm__ __volatile__ ("pause");
+#elif defined(__arm__) || defined(__arm64__)
+        __asm__ __volatile__ ("yield");
+#endif
+    }
+
     /** Lock state; a value of '1' is locked, '0' is unlocked. */
     volatile uint32_t _mtx = 0;
+
+    /** The SpinPolicy flags. */
+    const uint32_t _policy;
+
+    /** Contention counter; see contention_count(). */
+    volatile uint32_t _contention;
 };
 
 PLCR_CPP_END_ASYNC_NS
@@ -29,6 +29,8 @@
 #import "SenTestCompat.h"
 #import "SpinLock.hpp"
 
+#import <pthread.h>
+
 using namespace plcrash::async;
 
 @interface PLCrashAsyncSpinLockTests : SenTestCase @end
@@ -47,5 +49,36 @@ using namespace plcrash::async;
     l.unlock();
 }
 
+static void *contend_lock (void *ctx) {
+    SpinLock *l = (SpinLock *) ctx;
+    l->lock();
+    l->unlock();
+    return NULL;
+}
+
+/* Verify that contended acquisition is recorded, and that each spin policy eventually acquires the lock. */
+- (void) testContention {
+    uint32_t policies[] = { 0, SpinLock::SpinPause, SpinLock::SpinPause | SpinLock::SpinBackoff, SpinLock::SpinDefault };
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        SpinLock l(policies[i]);
+        STAssertEquals(l.contention_count(), (uint32_t) 0, @"Unexpected contention");
+
+        /* Hold the lock while a second thread attempts to acquire it */
+        l.lock();
+
+        pthread_t thr;
+        STAssertEquals(pthread_create(&thr, NULL, contend_lock, &l), 0, @"Failed to create thread");
+        while (l.contention_count() == 0)
+            usleep(100);
+
+        l.unlock();
+        STAssertEquals(pthread_join(thr, NULL), 0, @"Failed to join thread");
+
+        STAssertEquals(l.contention_count(), (uint32_t) 1, @"Contention was not recorded for policy %u", policies[i]);
+        STAssertTrue(l.tryLock(), @"The lock was not released");
+        l.unlock();
+    }
+}
 
 @end
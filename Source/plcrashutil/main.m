@@ -32,6 +32,27 @@
 #import <stdlib.h>
 #import <stdio.h>
 #import <getopt.h>
+#import <libkern/OSAtomic.h>
+#import <fcntl.h>
+#import <errno.h>
+#import <inttypes.h>
+#import <sys/socket.h>
+#import <sys/un.h>
+
+#import <mach-o/arch.h>
+#import <mach-o/fat.h>
+#import <mach-o/loader.h>
+#import <mach-o/nlist.h>
+
+#import "PLCrashAsyncEmbeddedSymbols.h"
+#import "PLCrashAsyncAllocator.h"
+#import "PLCrashAsyncChecksum.h"
+#import "PLCrashAsyncCompressor.h"
+#import "PLCrashAsyncDynamicLoader.h"
+#import "PLCrashAsyncInstrumentation.h"
+#import "PLCrashAsyncMachOImage.h"
+#import "PLCrashAsyncVirtualTask.h"
+#import "PLCrashFrameWalker.h"
 
 /*
  * Print command line usage.
@@ -39,34 +60,394 @@
 static void print_usage () {
     fprintf(stderr, "Usage: plcrashutil <command> <options>\n"
                     "Commands:\n"
-                    "  convert --format=<format> <file>\n"
-                    "      Covert a plcrash file to the given format.\n\n"
+                    "  convert [--demangle] --format=<format> <file>\n"
+                    "      Covert a plcrash file to the given format. If --demangle is specified, Swift\n"
+                    "      and C++ symbol names are demangled.\n\n"
+                    "  convert --batch [--demangle] [--jobs=<count>] [--output-dir=<dir>] --format=<format> <dir|->\n"
+                    "      Concurrently convert all plcrash files within the given directory, or the\n"
+                    "      newline-separated list of paths read from stdin if '-' is specified.\n"
+                    "      Each report is written to <dir>/<name>.crash if an output directory is\n"
+                    "      given; otherwise, reports are written to stdout in completion order, each\n"
+                    "      preceded by a '==> <path> <==' header.\n\n"
+                    "  bucket [--jobs=<count>] [--frames=<count>] <file|dir|-> ...\n"
+                    "      Group plcrash files by crash signature -- the exception or signal, and the\n"
+                    "      top frames of the crashing stack -- and print the number of reports in each\n"
+                    "      bucket, most frequent first. Directories are expanded to their files, and '-'\n"
+                    "      reads newline-separated paths from stdin.\n\n"
+                    "  stats <file|dir|-> ...\n"
+                    "      Report the encoded size of each top-level section and field type across the\n"
+                    "      given plcrash files -- frames, symbols, registers, binary images, and symbol\n"
+                    "      strings -- along with the proportion of duplicate thread stacks and strings.\n"
+                    "      Reports are walked in their encoded form, without being decoded.\n\n"
+                    "  embed-symbols [--arch=<arch>] <binary> <output>\n"
+                    "      Extract the symbol table of an unstripped Mach-O binary into a sorted table\n"
+                    "      that may be linked into the stripped binary, allowing its functions to be\n"
+                    "      symbolicated at crash time. The --arch option is required for universal\n"
+                    "      binaries. Link the output into the final binary via:\n"
+                    "        -Wl,-sectcreate,__PLCRASH,__syms,<output>\n\n"
+                    "  unwind [--jobs=<count>] --binaries=<dir> <file|dir|-> ...\n"
+                    "      Re-unwind the threads of plcrash files offline, using the stack memory captured\n"
+                    "      in each report and the Mach-O binaries found within <dir>, matched by UUID.\n"
+                    "      Binaries (rather than dSYMs) are required, as the unwinder relies on their\n"
+                    "      compact unwind and eh_frame sections.\n\n"
+                    "  unwind --recording=<recording> <file>\n"
+                    "      Deterministically replay the unwinding of a plcrash file against the memory\n"
+                    "      recorded while the report was written, reporting the time spent and the\n"
+                    "      number of memory reads performed.\n\n"
+                    "  serve [--jobs=<count>] [--cache=<count>] [--socket=<path>] --dsyms=<dir>\n"
+                    "      Run a long-lived symbolication service. Report paths are read one per line\n"
+                    "      from stdin (or from each connection to the given Unix domain socket), and\n"
+                    "      each report's threads are symbolicated against the dSYMs or binaries found\n"
+                    "      within <dir>, matched by UUID. Symbol tables are memory-mapped and indexed\n"
+                    "      once, with at most --cache images (default 64) kept resident.\n\n"
                     "      Supported formats:\n"
                     "        ios - Standard Apple iOS-compatible text crash log\n"
                     "        iphone - Synonym for 'iOS'.\n");
 }
 
+/*
+ * Return the list of report paths to be converted in batch mode; @a input is either a directory, or "-" to
+ * read newline-separated paths from stdin.
+ */
+static NSArray *batch_input_paths (const char *input) {
+    NSMutableArray *paths = [NSMutableArray array];
+
+    /* Read paths from stdin */
+    if (strcmp(input, "-") == 0) {
+        char *line = NULL;
+        size_t linecap = 0;
+        ssize_t len;
+
+        while ((len = getline(&line, &linecap, stdin)) > 0) {
+            if (line[len - 1] == '\n')
+                line[--len] = '\0';
+            if (len > 0)
+                [paths addObject: [NSString stringWithUTF8String: line]];
+        }
+
+        free(line);
+        return paths;
+    }
+
+    /* Enumerate the directory's regular files */
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *dir = [NSString stringWithUTF8String: input];
+    NSError *error;
+    NSArray *entries = [fm contentsOfDirectoryAtPath: dir error: &error];
+    if (entries == nil) {
+        fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+        return nil;
+    }
+
+    for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+        NSString *path = [dir stringByAppendingPathComponent: entry];
+        BOOL isDir;
+        if ([fm fileExistsAtPath: path isDirectory: &isDir] && !isDir)
+            [paths addObject: path];
+    }
+
+    return paths;
+}
+
+/*
+ * Convert all reports in @a paths concurrently, using @a jobs workers. Returns the number of reports that
+ * could not be converted.
+ */
+static int32_t batch_convert (NSArray *paths, PLCrashReportTextFormat textFormat, PLCrashReportTextFormatterOptions options, NSString *outputDir, NSUInteger jobs) {
+    const NSUInteger count = [paths count];
+    __block volatile int32_t next = 0;
+    __block volatile int32_t failures = 0;
+
+    /* Serializes writes to stdout */
+    dispatch_queue_t outputQueue = dispatch_queue_create("plcrashutil.output", DISPATCH_QUEUE_SERIAL);
+
+    /* Each worker claims reports until none remain, reusing a single formatter instance. Demangled names are
+     * memoized process-wide, and are shared by all workers. */
+    dispatch_apply(jobs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        PLCrashReportTextFormatter *formatter = [[PLCrashReportTextFormatter alloc] initWithTextFormat: textFormat stringEncoding: NSUTF8StringEncoding options: options];
+        int32_t idx;
+
+        while ((idx = OSAtomicIncrement32Barrier(&next) - 1) < (int32_t) count) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSString *path = [paths objectAtIndex: idx];
+            NSError *error;
+
+            /* Map and decode the report */
+            PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path
+                                                                          options: PLCrashReportDecodingOptionNone
+                                                                            error: &error] autorelease];
+            if (report == nil) {
+                fprintf(stderr, "Could not load crash log %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+                OSAtomicIncrement32(&failures);
+                [pool release];
+                continue;
+            }
+
+            BOOL formatted;
+            if (outputDir != nil) {
+                /* Stream the output directly to the report's output file */
+                NSString *name = [[[path lastPathComponent] stringByDeletingPathExtension] stringByAppendingPathExtension: @"crash"];
+                NSString *outputPath = [outputDir stringByAppendingPathComponent: name];
+                int fd = open([outputPath fileSystemRepresentation], O_WRONLY|O_CREAT|O_TRUNC, 0644);
+                if (fd < 0) {
+                    fprintf(stderr, "Could not open %s: %s\n", [outputPath fileSystemRepresentation], strerror(errno));
+                    OSAtomicIncrement32(&failures);
+                    [pool release];
+                    continue;
+                }
+
+                formatted = [formatter formatReport: report toFileDescriptor: fd error: &error];
+                close(fd);
+            } else {
+                /* Format to memory, and then write the complete report to stdout, preventing interleaving of
+                 * concurrently formatted reports */
+                NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+                [stream open];
+                formatted = [formatter formatReport: report toOutputStream: stream error: &error];
+                [stream close];
+
+                if (formatted) {
+                    NSData *data = [stream propertyForKey: NSStreamDataWrittenToMemoryStreamKey];
+                    dispatch_sync(outputQueue, ^{
+                        fprintf(stdout, "==> %s <==\n", [path fileSystemRepresentation]);
+                        fwrite([data bytes], 1, [data length], stdout);
+                        fputc('\n', stdout);
+                    });
+                }
+            }
+
+            if (!formatted) {
+                fprintf(stderr, "Could not write crash log %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+                OSAtomicIncrement32(&failures);
+            }
+
+            [pool release];
+        }
+
+        [formatter release];
+    });
+
+    dispatch_release(outputQueue);
+    fflush(stdout);
+
+    return failures;
+}
+
+/*
+ * Return a description of @a frame for use in a crash signature. Symbolicated frames are described by image and
+ * symbol name, which are stable across builds; otherwise, the image-relative offset is used, qualified by the image
+ * UUID.
+ */
+static NSString *bucket_frame_description (PLCrashReport *report, PLCrashReportStackFrameInfo *frame) {
+    PLCrashReportBinaryImageInfo *image = [report imageForAddress: frame.instructionPointer];
+    if (image == nil)
+        return [NSString stringWithFormat: @"???+0x%llx", (unsigned long long) frame.instructionPointer];
+
+    NSString *imageName = [image.imageName lastPathComponent];
+    if (frame.symbolInfo != nil)
+        return [NSString stringWithFormat: @"%@`%@", imageName, frame.symbolInfo.symbolName];
+
+    return [NSString stringWithFormat: @"%@+0x%llx (%@)", imageName, (unsigned long long) (frame.instructionPointer - image.imageBaseAddress),
+            image.hasImageUUID ? image.imageUUID : @"no uuid"];
+}
+
+/*
+ * Compute the crash signature of @a report from the exception or signal, and the top @a frames frames
+ * of the exception's backtrace or, if unavailable, of the crashed thread.
+ */
+static NSString *bucket_signature (PLCrashReport *report, NSUInteger frames) {
+    NSMutableString *signature = [NSMutableString string];
+    NSArray *stackFrames = nil;
+
+    if (report.hasExceptionInfo) {
+        [signature appendString: report.exceptionInfo.exceptionName];
+        stackFrames = report.exceptionInfo.stackFrames;
+    } else {
+        [signature appendFormat: @"%@ (%@)", report.signalInfo.name, report.signalInfo.code];
+    }
+
+    /* Only the crashed thread is decoded when using lazy decoding */
+    if ([stackFrames count] == 0)
+        stackFrames = report.crashedThread.stackFrames;
+
+    NSUInteger count = MIN(frames, [stackFrames count]);
+    for (NSUInteger i = 0; i < count; i++)
+        [signature appendFormat: @" | %@", bucket_frame_description(report, [stackFrames objectAtIndex: i])];
+
+    return signature;
+}
+
+/*
+ * Run a bucketing pass.
+ */
+static int bucket_command (int argc, char *argv[]) {
+    long jobs = 0;
+    long frames = 5;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "jobs",       required_argument,      NULL,          'j' },
+        { "frames",     required_argument,      NULL,          'n' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "j:n:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Invalid job count\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            case 'n':
+                frames = strtol(optarg, NULL, 10);
+                if (frames <= 0) {
+                    fprintf(stderr, "Invalid frame count\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "No input files supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    /* Collect the input paths */
+    NSMutableArray *paths = [NSMutableArray array];
+    for (int i = 0; i < argc; i++) {
+        BOOL isDir = NO;
+        if (strcmp(argv[i], "-") == 0 || ([[NSFileManager defaultManager] fileExistsAtPath: [NSString stringWithUTF8String: argv[i]] isDirectory: &isDir] && isDir)) {
+            NSArray *expanded = batch_input_paths(argv[i]);
+            if (expanded == nil)
+                return 1;
+            [paths addObjectsFromArray: expanded];
+        } else {
+            [paths addObject: [NSString stringWithUTF8String: argv[i]]];
+        }
+    }
+
+    if (jobs == 0)
+        jobs = [[NSProcessInfo processInfo] activeProcessorCount];
+
+    /* Compute the signatures concurrently; each worker accumulates its own counts, which are merged once all
+     * workers have finished. */
+    const NSUInteger count = [paths count];
+    NSMutableArray *workerBuckets = [NSMutableArray arrayWithCapacity: jobs];
+    for (long i = 0; i < jobs; i++)
+        [workerBuckets addObject: [NSCountedSet set]];
+
+    __block volatile int32_t next = 0;
+    __block volatile int32_t failures = 0;
+    dispatch_apply(jobs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        NSCountedSet *buckets = [workerBuckets objectAtIndex: worker];
+        int32_t idx;
+
+        while ((idx = OSAtomicIncrement32Barrier(&next) - 1) < (int32_t) count) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSString *path = [paths objectAtIndex: idx];
+            NSError *error;
+
+            /* Map the report, deferring decoding of all but the records required for the signature */
+            PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path
+                                                                          options: PLCrashReportDecodingOptionLazy
+                                                                            error: &error] autorelease];
+            if (report == nil) {
+                fprintf(stderr, "Could not load crash log %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+                OSAtomicIncrement32(&failures);
+            } else {
+                [buckets addObject: bucket_signature(report, (NSUInteger) frames)];
+            }
+
+            [pool release];
+        }
+    });
+
+    NSCountedSet *buckets = [NSCountedSet set];
+    for (NSCountedSet *workerSet in workerBuckets) {
+        for (NSString *signature in workerSet) {
+            for (NSUInteger i = 0; i < [workerSet countForObject: signature]; i++)
+                [buckets addObject: signature];
+        }
+    }
+
+    /* Emit the buckets, most frequent first */
+    NSArray *sorted = [[buckets allObjects] sortedArrayUsingComparator: ^NSComparisonResult (id lhs, id rhs) {
+        NSUInteger lhsCount = [buckets countForObject: lhs];
+        NSUInteger rhsCount = [buckets countForObject: rhs];
+        if (lhsCount != rhsCount)
+            return lhsCount > rhsCount ? NSOrderedAscending : NSOrderedDescending;
+        return [lhs compare: rhs];
+    }];
+
+    for (NSString *signature in sorted)
+        fprintf(stdout, "%lu\t%s\n", (unsigned long) [buckets countForObject: signature], [signature UTF8String]);
+    fflush(stdout);
+
+    if (failures > 0)
+        fprintf(stderr, "%d of %lu crash logs could not be loaded\n", failures, (unsigned long) count);
+
+    return failures > 0 ? 1 : 0;
+}
+
 /*
  * Run a conversion.
  */
 static int convert_command (int argc, char *argv[]) {
     const char *format = "iphone";
     const char *input_file;
+    const char *output_dir = NULL;
     FILE *output = stdout;
+    BOOL batch = NO;
+    long jobs = 0;
+    PLCrashReportTextFormatterOptions options = PLCrashReportTextFormatterOptionNone;
 
     /* options descriptor */
     static struct option longopts[] = {
         { "format",     required_argument,      NULL,          'f' },
+        { "batch",      no_argument,            NULL,          'b' },
+        { "demangle",   no_argument,            NULL,          'd' },
+        { "jobs",       required_argument,      NULL,          'j' },
+        { "output-dir", required_argument,      NULL,          'o' },
         { NULL,         0,                      NULL,           0 }
     };    
 
     /* Read the options */
     char ch;
-    while ((ch = getopt_long(argc, argv, "f:", longopts, NULL)) != -1) {
+    while ((ch = getopt_long(argc, argv, "f:bdj:o:", longopts, NULL)) != -1) {
         switch (ch) {
             case 'f':
                 format = optarg;
                 break;
+            case 'b':
+                batch = YES;
+                break;
+            case 'd':
+                options |= PLCrashReportTextFormatterOptionDemangleSymbols;
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Invalid job count\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            case 'o':
+                output_dir = optarg;
+                break;
             default:
                 print_usage();
                 return 1;
@@ -94,28 +475,1820 @@ static int convert_command (int argc, char *argv[]) {
         return 1;
     }
 
-    /* Try reading the file in */
+    /* Batch conversion */
+    if (batch) {
+        NSArray *paths = batch_input_paths(input_file);
+        if (paths == nil)
+            return 1;
+
+        if (jobs == 0)
+            jobs = [[NSProcessInfo processInfo] activeProcessorCount];
+
+        NSString *outputDir = output_dir != NULL ? [NSString stringWithUTF8String: output_dir] : nil;
+        int32_t failures = batch_convert(paths, textFormat, options, outputDir, (NSUInteger) jobs);
+        if (failures > 0) {
+            fprintf(stderr, "%d of %lu crash logs could not be converted\n", failures, (unsigned long) [paths count]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    /* Map and decode the report */
+    NSError *error;
+    PLCrashReport *crashLog = [[PLCrashReport alloc] initWithContentsOfFile: [NSString stringWithUTF8String: input_file]
+                                                                    options: PLCrashReportDecodingOptionNone
+                                                                      error: &error];
+    if (crashLog == nil) {
+        fprintf(stderr, "Could not load crash log: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    /* Format the report, streaming the output */
+    PLCrashReportTextFormatter *formatter = [[[PLCrashReportTextFormatter alloc] initWithTextFormat: textFormat stringEncoding: NSUTF8StringEncoding options: options] autorelease];
+    fflush(output);
+    if (![formatter formatReport: crashLog toFileDescriptor: fileno(output) error: &error]) {
+        fprintf(stderr, "Could not write crash log: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+    return 0;
+}
+
+/** A symbol extracted by embed_symbols_command(). */
+struct embed_symbol {
+    /** The symbol's unslid address. */
+    uint64_t address;
+
+    /** The symbol's offset within the source string table. */
+    uint32_t strx;
+
+    /** True if the symbol is external. */
+    bool external;
+};
+
+/*
+ * Order symbols by address, placing external symbols before local symbols at the same address.
+ */
+static int embed_symbol_compare (const void *a, const void *b) {
+    const struct embed_symbol *lhs = a;
+    const struct embed_symbol *rhs = b;
+
+    if (lhs->address != rhs->address)
+        return lhs->address < rhs->address ? -1 : 1;
+
+    if (lhs->external != rhs->external)
+        return lhs->external ? -1 : 1;
+
+    return 0;
+}
+
+/*
+ * Locate the Mach-O image for @a arch within @a data, which may be a thin or universal binary. If @a arch is NULL,
+ * the binary must be thin.
+ */
+static BOOL embed_symbols_find_image (NSData *data, const NXArchInfo *arch, const uint8_t **image, size_t *length) {
+    const uint8_t *bytes = [data bytes];
+    size_t size = [data length];
+    uint32_t magic;
+
+    if (size < sizeof(magic)) {
+        fprintf(stderr, "Input is not a Mach-O binary\n");
+        return NO;
+    }
+    memcpy(&magic, bytes, sizeof(magic));
+
+    /* Thin binaries */
+    if (magic == MH_MAGIC || magic == MH_MAGIC_64) {
+        if (arch != NULL) {
+            const struct mach_header *header = (const struct mach_header *) bytes;
+            if (size < sizeof(*header) || header->cputype != arch->cputype) {
+                fprintf(stderr, "Input does not contain architecture %s\n", arch->name);
+                return NO;
+            }
+        }
+
+        *image = bytes;
+        *length = size;
+        return YES;
+    }
+
+    if (magic != FAT_CIGAM && magic != FAT_CIGAM_64) {
+        fprintf(stderr, "Input is not a native-endian Mach-O binary\n");
+        return NO;
+    }
+
+    /* Universal binaries; the fat headers are always big-endian */
+    if (arch == NULL) {
+        fprintf(stderr, "Input is a universal binary; an architecture must be specified via --arch\n");
+        return NO;
+    }
+
+    bool fat64 = (magic == FAT_CIGAM_64);
+    size_t arch_size = fat64 ? sizeof(struct fat_arch_64) : sizeof(struct fat_arch);
+    if (size < sizeof(struct fat_header)) {
+        fprintf(stderr, "Truncated universal binary header\n");
+        return NO;
+    }
+
+    uint32_t nfat_arch = OSSwapBigToHostInt32(((const struct fat_header *) bytes)->nfat_arch);
+    if ((size - sizeof(struct fat_header)) / arch_size < nfat_arch) {
+        fprintf(stderr, "Truncated universal binary header\n");
+        return NO;
+    }
+
+    for (uint32_t i = 0; i < nfat_arch; i++) {
+        const uint8_t *entry = bytes + sizeof(struct fat_header) + i * arch_size;
+        cpu_type_t cputype;
+        uint64_t offset;
+        uint64_t arch_length;
+
+        if (fat64) {
+            const struct fat_arch_64 *fa = (const struct fat_arch_64 *) entry;
+            cputype = (cpu_type_t) OSSwapBigToHostInt32(fa->cputype);
+            offset = OSSwapBigToHostInt64(fa->offset);
+            arch_length = OSSwapBigToHostInt64(fa->size);
+        } else {
+            const struct fat_arch *fa = (const struct fat_arch *) entry;
+            cputype = (cpu_type_t) OSSwapBigToHostInt32(fa->cputype);
+            offset = OSSwapBigToHostInt32(fa->offset);
+            arch_length = OSSwapBigToHostInt32(fa->size);
+        }
+
+        if (cputype != arch->cputype)
+            continue;
+
+        if (offset > size || arch_length > size - offset) {
+            fprintf(stderr, "Universal binary slice for %s exceeds the file\n", arch->name);
+            return NO;
+        }
+
+        *image = bytes + offset;
+        *length = (size_t) arch_length;
+        return YES;
+    }
+
+    fprintf(stderr, "Input does not contain architecture %s\n", arch->name);
+    return NO;
+}
+
+/*
+ * Generate an embedded symbol table; see PLCrashAsyncEmbeddedSymbols.h for the format.
+ */
+static int embed_symbols_command (int argc, char *argv[]) {
+    const NXArchInfo *arch = NULL;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "arch",       required_argument,      NULL,          'a' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "a:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'a':
+                if ((arch = NXGetArchInfoFromName(optarg)) == NULL) {
+                    fprintf(stderr, "Unknown architecture %s\n", optarg);
+                    print_usage();
+                    return 1;
+                }
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 2) {
+        fprintf(stderr, "An input binary and output file must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
     NSError *error;
-    NSData *data = [NSData dataWithContentsOfFile: [NSString stringWithUTF8String: input_file] 
-                                          options: NSMappedRead error: &error];
+    NSData *data = [NSData dataWithContentsOfFile: [NSString stringWithUTF8String: argv[0]] options: NSDataReadingMappedIfSafe error: &error];
     if (data == nil) {
-        fprintf(stderr, "Could not read input file: %s\n", [[error localizedDescription] UTF8String]);
+        fprintf(stderr, "Could not read %s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
         return 1;
     }
-    
-    /* Decode it */
-    PLCrashReport *crashLog = [[PLCrashReport alloc] initWithData: data error: &error];
-    if (crashLog == nil) {
-        fprintf(stderr, "Could not decode crash log: %s\n", [[error localizedDescription] UTF8String]);
+
+    const uint8_t *image;
+    size_t length;
+    if (!embed_symbols_find_image(data, arch, &image, &length))
+        return 1;
+
+    /* Parse the header, and find the symbol table */
+    const struct mach_header *header = (const struct mach_header *) image;
+    if (length < sizeof(struct mach_header) || (header->magic != MH_MAGIC && header->magic != MH_MAGIC_64)) {
+        fprintf(stderr, "Invalid Mach-O header\n");
+        return 1;
+    }
+
+    bool m64 = (header->magic == MH_MAGIC_64);
+    size_t cmd_offset = m64 ? sizeof(struct mach_header_64) : sizeof(struct mach_header);
+    if (length < cmd_offset || header->sizeofcmds > length - cmd_offset) {
+        fprintf(stderr, "Mach-O load commands exceed the file\n");
+        return 1;
+    }
+
+    const struct symtab_command *symtab = NULL;
+    size_t cmd_end = cmd_offset + header->sizeofcmds;
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        if (cmd_end - cmd_offset < sizeof(struct load_command)) {
+            fprintf(stderr, "Truncated Mach-O load command\n");
+            return 1;
+        }
+
+        const struct load_command *lc = (const struct load_command *) (image + cmd_offset);
+        if (lc->cmdsize < sizeof(struct load_command) || lc->cmdsize > cmd_end - cmd_offset) {
+            fprintf(stderr, "Invalid Mach-O load command size\n");
+            return 1;
+        }
+
+        if (lc->cmd == LC_SYMTAB && lc->cmdsize >= sizeof(struct symtab_command))
+            symtab = (const struct symtab_command *) lc;
+
+        cmd_offset += lc->cmdsize;
+    }
+
+    if (symtab == NULL) {
+        fprintf(stderr, "Input has no symbol table\n");
+        return 1;
+    }
+
+    size_t nlist_size = m64 ? sizeof(struct nlist_64) : sizeof(struct nlist);
+    if (symtab->symoff > length || (length - symtab->symoff) / nlist_size < symtab->nsyms ||
+        symtab->stroff > length || symtab->strsize > length - symtab->stroff)
+    {
+        fprintf(stderr, "Symbol table exceeds the file\n");
+        return 1;
+    }
+
+    const char *strings = (const char *) image + symtab->stroff;
+
+    /* Collect all named symbols defined within a section; debugging entries are skipped */
+    struct embed_symbol *symbols = malloc(sizeof(struct embed_symbol) * MAX(symtab->nsyms, 1));
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < symtab->nsyms; i++) {
+        const uint8_t *entry = image + symtab->symoff + i * nlist_size;
+        uint32_t n_strx;
+        uint8_t n_type;
+        uint16_t n_desc;
+        uint64_t n_value;
+
+        if (m64) {
+            const struct nlist_64 *nl = (const struct nlist_64 *) entry;
+            n_strx = nl->n_un.n_strx;
+            n_type = nl->n_type;
+            n_desc = nl->n_desc;
+            n_value = nl->n_value;
+        } else {
+            const struct nlist *nl = (const struct nlist *) entry;
+            n_strx = nl->n_un.n_strx;
+            n_type = nl->n_type;
+            n_desc = (uint16_t) nl->n_desc;
+            n_value = nl->n_value;
+        }
+
+        if ((n_type & N_STAB) != 0 || (n_type & N_TYPE) != N_SECT)
+            continue;
+
+        if (n_strx == 0 || n_strx >= symtab->strsize || strings[n_strx] == '\0')
+            continue;
+
+        if (memchr(strings + n_strx, '\0', symtab->strsize - n_strx) == NULL)
+            continue;
+
+        /* We have to set the low-order bit ourselves for ARM THUMB functions, as is done by the runtime symbol
+         * table reader. */
+        if (n_desc & N_ARM_THUMB_DEF)
+            n_value |= 1;
+
+        symbols[count].address = n_value;
+        symbols[count].strx = n_strx;
+        symbols[count].external = (n_type & N_EXT) != 0;
+        count++;
+    }
+
+    /* Sort by address, retaining a single (preferably external) symbol per address */
+    qsort(symbols, count, sizeof(struct embed_symbol), embed_symbol_compare);
+
+    NSMutableData *entries = [NSMutableData data];
+    NSMutableData *names = [NSMutableData data];
+    uint32_t written = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (i > 0 && symbols[i].address == symbols[i - 1].address)
+            continue;
+
+        const char *name = strings + symbols[i].strx;
+        plcrash_async_embedded_symbol_t entry;
+        entry.address = symbols[i].address;
+        entry.name_offset = (uint32_t) [names length];
+        entry.reserved = 0;
+
+        [entries appendBytes: &entry length: sizeof(entry)];
+        [names appendBytes: name length: strlen(name) + 1];
+        written++;
+    }
+    free(symbols);
+
+    /* Write the table */
+    plcrash_async_embedded_symbols_header_t table_header;
+    table_header.magic = PLCRASH_EMBEDDED_SYMBOLS_MAGIC;
+    table_header.version = PLCRASH_EMBEDDED_SYMBOLS_VERSION;
+    table_header.symbol_count = written;
+    table_header.strings_size = (uint32_t) [names length];
+
+    NSMutableData *output = [NSMutableData dataWithBytes: &table_header length: sizeof(table_header)];
+    [output appendData: entries];
+    [output appendData: names];
+
+    if (![output writeToFile: [NSString stringWithUTF8String: argv[1]] options: NSDataWritingAtomic error: &error]) {
+        fprintf(stderr, "Could not write %s: %s\n", argv[1], [[error localizedDescription] UTF8String]);
         return 1;
     }
 
-    /* Format the report */
-    NSString* report = [PLCrashReportTextFormatter stringValueForCrashReport: crashLog withTextFormat: textFormat];
-    fprintf(output, "%s", [report UTF8String]);     
+    fprintf(stderr, "Wrote %" PRIu32 " symbols (%lu bytes)\n", written, (unsigned long) [output length]);
     return 0;
 }
 
+/*
+ * Iterate the load commands of the Mach-O image at @a image, calling @a block with each. Returns NO if the
+ * image's header or load commands are malformed.
+ */
+static BOOL unwind_load_commands (const uint8_t *image, size_t length, void (^block)(const struct load_command *lc)) {
+    const struct mach_header *header = (const struct mach_header *) image;
+    if (length < sizeof(struct mach_header) || (header->magic != MH_MAGIC && header->magic != MH_MAGIC_64))
+        return NO;
+
+    size_t cmd_offset = (header->magic == MH_MAGIC_64) ? sizeof(struct mach_header_64) : sizeof(struct mach_header);
+    if (length < cmd_offset || header->sizeofcmds > length - cmd_offset)
+        return NO;
+
+    size_t cmd_end = cmd_offset + header->sizeofcmds;
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        if (cmd_end - cmd_offset < sizeof(struct load_command))
+            return NO;
+
+        const struct load_command *lc = (const struct load_command *) (image + cmd_offset);
+        if (lc->cmdsize < sizeof(struct load_command) || lc->cmdsize > cmd_end - cmd_offset)
+            return NO;
+
+        block(lc);
+        cmd_offset += lc->cmdsize;
+    }
+
+    return YES;
+}
+
+/*
+ * Record the LC_UUID of the Mach-O slice at @a offset within the file at @a path in @a index, keyed by the UUID's
+ * lowercase hex representation, as used by PLCrashReportBinaryImageInfo.
+ */
+static void unwind_index_slice (NSMutableDictionary *index, NSString *path, const uint8_t *bytes, size_t offset, size_t length) {
+    __block NSString *uuid = nil;
+
+    unwind_load_commands(bytes + offset, length, ^(const struct load_command *lc) {
+        if (lc->cmd != LC_UUID || lc->cmdsize < sizeof(struct uuid_command))
+            return;
+
+        const uint8_t *u = ((const struct uuid_command *) lc)->uuid;
+        uuid = [NSString stringWithFormat: @"%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
+                u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], u[8], u[9], u[10], u[11], u[12], u[13], u[14], u[15]];
+    });
+
+    if (uuid == nil || [index objectForKey: uuid] != nil)
+        return;
+
+    [index setObject: [NSDictionary dictionaryWithObjectsAndKeys:
+                       path, @"path",
+                       [NSNumber numberWithUnsignedLongLong: offset], @"offset",
+                       [NSNumber numberWithUnsignedLongLong: length], @"length", nil]
+              forKey: uuid];
+}
+
+/*
+ * Recursively scan @a dir for thin and universal Mach-O files, returning a dictionary mapping each slice's UUID
+ * to its location.
+ */
+static NSDictionary *unwind_index_binaries (NSString *dir) {
+    NSMutableDictionary *index = [NSMutableDictionary dictionary];
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    for (NSString *entry in [fm enumeratorAtPath: dir]) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSString *path = [dir stringByAppendingPathComponent: entry];
+        BOOL isDir;
+
+        if (![fm fileExistsAtPath: path isDirectory: &isDir] || isDir) {
+            [pool release];
+            continue;
+        }
+
+        NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: NULL];
+        const uint8_t *bytes = [data bytes];
+        size_t size = [data length];
+        uint32_t magic = 0;
+
+        if (size >= sizeof(magic))
+            memcpy(&magic, bytes, sizeof(magic));
+
+        if (magic == MH_MAGIC || magic == MH_MAGIC_64) {
+            unwind_index_slice(index, path, bytes, 0, size);
+        } else if ((magic == FAT_CIGAM || magic == FAT_CIGAM_64) && size >= sizeof(struct fat_header)) {
+            /* The fat headers are always big-endian */
+            bool fat64 = (magic == FAT_CIGAM_64);
+            size_t arch_size = fat64 ? sizeof(struct fat_arch_64) : sizeof(struct fat_arch);
+            uint32_t nfat_arch = OSSwapBigToHostInt32(((const struct fat_header *) bytes)->nfat_arch);
+
+            for (uint32_t i = 0; i < nfat_arch && sizeof(struct fat_header) + (i + 1) * arch_size <= size; i++) {
+                const uint8_t *arch = bytes + sizeof(struct fat_header) + i * arch_size;
+                uint64_t offset, length;
+
+                if (fat64) {
+                    offset = OSSwapBigToHostInt64(((const struct fat_arch_64 *) arch)->offset);
+                    length = OSSwapBigToHostInt64(((const struct fat_arch_64 *) arch)->size);
+                } else {
+                    offset = OSSwapBigToHostInt32(((const struct fat_arch *) arch)->offset);
+                    length = OSSwapBigToHostInt32(((const struct fat_arch *) arch)->size);
+                }
+
+                if (offset <= size && length <= size - offset)
+                    unwind_index_slice(index, path, bytes, (size_t) offset, (size_t) length);
+            }
+        }
+
+        [pool release];
+    }
+
+    return index;
+}
+
+/*
+ * Populate @a vtask with the segments of the Mach-O slice @a image, as loaded at @a base. Segment contents are
+ * copied from the file, and zero-filled to the segment's VM size.
+ */
+static BOOL unwind_add_image (plcrash_async_vtask_t *vtask, uint64_t base, const uint8_t *image, size_t length) {
+    __block uint64_t text_vmaddr = 0;
+    __block BOOL found_text = NO;
+
+    /* The image's load address corresponds to the __TEXT segment's vmaddr */
+    if (!unwind_load_commands(image, length, ^(const struct load_command *lc) {
+        if (lc->cmd == LC_SEGMENT_64 && lc->cmdsize >= sizeof(struct segment_command_64)) {
+            const struct segment_command_64 *seg = (const struct segment_command_64 *) lc;
+            if (strncmp(seg->segname, SEG_TEXT, sizeof(seg->segname)) == 0) {
+                text_vmaddr = seg->vmaddr;
+                found_text = YES;
+            }
+        } else if (lc->cmd == LC_SEGMENT && lc->cmdsize >= sizeof(struct segment_command)) {
+            const struct segment_command *seg = (const struct segment_command *) lc;
+            if (strncmp(seg->segname, SEG_TEXT, sizeof(seg->segname)) == 0) {
+                text_vmaddr = seg->vmaddr;
+                found_text = YES;
+            }
+        }
+    }) || !found_text) {
+        return NO;
+    }
+
+    unwind_load_commands(image, length, ^(const struct load_command *lc) {
+        const char *segname;
+        uint64_t vmaddr, vmsize, fileoff, filesize;
+
+        if (lc->cmd == LC_SEGMENT_64 && lc->cmdsize >= sizeof(struct segment_command_64)) {
+            const struct segment_command_64 *seg = (const struct segment_command_64 *) lc;
+            segname = seg->segname;
+            vmaddr = seg->vmaddr;
+            vmsize = seg->vmsize;
+            fileoff = seg->fileoff;
+            filesize = seg->filesize;
+        } else if (lc->cmd == LC_SEGMENT && lc->cmdsize >= sizeof(struct segment_command)) {
+            const struct segment_command *seg = (const struct segment_command *) lc;
+            segname = seg->segname;
+            vmaddr = seg->vmaddr;
+            vmsize = seg->vmsize;
+            fileoff = seg->fileoff;
+            filesize = seg->filesize;
+        } else {
+            return;
+        }
+
+        if (strncmp(segname, SEG_PAGEZERO, 16) == 0 || vmsize == 0 || vmaddr < text_vmaddr)
+            return;
+
+        if (fileoff > length)
+            filesize = 0;
+        else
+            filesize = MIN(filesize, MIN(vmsize, length - fileoff));
+
+        plcrash_nasync_vtask_add_region(vtask, (pl_vm_address_t) (base + (vmaddr - text_vmaddr)), image + fileoff, filesize, vmsize);
+    });
+
+    return YES;
+}
+
+/* Symbol lookup result, populated by unwind_symbol_cb() */
+struct unwind_symbol {
+    pl_vm_address_t address;
+    char name[256];
+};
+
+static void unwind_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    struct unwind_symbol *sym = ctx;
+    sym->address = address;
+    strlcpy(sym->name, name, sizeof(sym->name));
+}
+
+/*
+ * Re-unwind all threads of @a report for which register state was recorded, appending the resulting backtraces
+ * to @a output. If @a recording is non-NULL, the task's memory is replayed from the recording made while the report
+ * was written; otherwise, it is reconstructed from the report's captured memory and the matching @a binaries.
+ */
+static BOOL unwind_report (PLCrashReport *report, NSDictionary *binaries, const char *recording, NSMutableString *output) {
+    plcrash_async_allocator_t *allocator;
+    plcrash_async_image_list_t *image_list;
+    plcrash_async_vtask_t vtask;
+    cpu_type_t cpu_type;
+
+    /* Determine the target's CPU type */
+    PLCrashReportProcessorInfo *processor = [report hasMachineInfo] ? report.machineInfo.processorInfo : report.systemInfo.processorInfo;
+    if (processor == nil || processor.typeEncoding != PLCrashReportProcessorTypeEncodingMach) {
+        [output appendString: @"Report does not provide a Mach CPU type\n"];
+        return NO;
+    }
+    cpu_type = (cpu_type_t) processor.type;
+
+    plcrash_error_t err = (recording != NULL) ? plcrash_nasync_vtask_init_recording(&vtask, recording) : plcrash_nasync_vtask_init(&vtask);
+    if (err != PLCRASH_ESUCCESS) {
+        [output appendFormat: @"Could not create virtual task: %s\n", plcrash_async_strerror(err)];
+        return NO;
+    }
+
+    if (plcrash_async_allocator_create(&allocator, PAGE_SIZE * 4) != PLCRASH_ESUCCESS) {
+        plcrash_nasync_vtask_free(&vtask);
+        [output appendString: @"Could not create allocator\n"];
+        return NO;
+    }
+
+    /* Populate the task with the captured memory; a recording already contains all memory read by the writer */
+    for (PLCrashReportMemoryRegionInfo *region in (recording == NULL ? report.memoryRegions : nil)) {
+        NSData *data = region.data;
+        plcrash_nasync_vtask_add_region(&vtask, (pl_vm_address_t) region.address, [data bytes], [data length], [data length]);
+    }
+
+    /* Populate the task with the matching binaries; images without a binary can not be unwound through */
+    NSMutableData *headers = [NSMutableData data];
+    NSMutableArray *names = [NSMutableArray array];
+    NSMutableData *namePtrs = [NSMutableData data];
+
+    for (PLCrashReportBinaryImageInfo *imageInfo in report.images) {
+        if (recording == NULL) {
+            NSDictionary *binary = imageInfo.hasImageUUID ? [binaries objectForKey: [imageInfo.imageUUID lowercaseString]] : nil;
+            if (binary == nil)
+                continue;
+
+            NSData *data = [NSData dataWithContentsOfFile: [binary objectForKey: @"path"] options: NSDataReadingMappedIfSafe error: NULL];
+            size_t offset = (size_t) [[binary objectForKey: @"offset"] unsignedLongLongValue];
+            size_t length = (size_t) [[binary objectForKey: @"length"] unsignedLongLongValue];
+            if (data == nil || offset > [data length] || length > [data length] - offset)
+                continue;
+
+            if (!unwind_add_image(&vtask, imageInfo.imageBaseAddress, (const uint8_t *) [data bytes] + offset, length))
+                continue;
+        }
+
+        pl_vm_address_t header = (pl_vm_address_t) imageInfo.imageBaseAddress;
+        const char *name = [imageInfo.imageName UTF8String];
+        [headers appendBytes: &header length: sizeof(header)];
+        [names addObject: imageInfo.imageName];
+        [namePtrs appendBytes: &name length: sizeof(name)];
+    }
+
+    if (plcrash_nasync_image_list_new_with_headers(&image_list, allocator, plcrash_async_vtask_port(&vtask), [headers bytes],
+                                                   [namePtrs bytes], [names count]) != PLCRASH_ESUCCESS)
+    {
+        plcrash_async_allocator_free(allocator);
+        plcrash_nasync_vtask_free(&vtask);
+        [output appendString: @"Could not create image list\n"];
+        return NO;
+    }
+
+    uint64_t start = mach_absolute_time();
+    NSUInteger total_frames = 0;
+
+    /* Map each image's unwind sections once, rather than once per frame */
+    plcrash_async_macho_section_cache_t section_cache;
+    plcrash_async_macho_section_cache_init(&section_cache);
+
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        plcrash_async_thread_state_t thread_state;
+        plframe_cursor_t cursor;
+        plframe_error_t ferr;
+
+        if ([thread.registers count] == 0)
+            continue;
+
+        if (plcrash_async_thread_state_init(&thread_state, cpu_type) != PLCRASH_ESUCCESS) {
+            [output appendFormat: @"Unsupported CPU type %" PRIu64 "\n", processor.type];
+            break;
+        }
+
+        /* Restore the thread's register state, matching registers by name */
+        size_t reg_count = plcrash_async_thread_state_get_reg_count(&thread_state);
+        for (PLCrashReportRegisterInfo *reg in thread.registers) {
+            for (plcrash_regnum_t regnum = 0; regnum < reg_count; regnum++) {
+                const char *name = plcrash_async_thread_state_get_reg_name(&thread_state, regnum);
+                if (name != NULL && strcasecmp(name, [reg.registerName UTF8String]) == 0) {
+                    plcrash_async_thread_state_set_reg(&thread_state, regnum, (plcrash_greg_t) reg.registerValue);
+                    break;
+                }
+            }
+        }
+
+        [output appendFormat: @"Thread %ld%@:\n", (long) thread.threadNumber, thread.crashed ? @" Crashed" : @""];
+
+        if ((ferr = plframe_cursor_init(&cursor, plcrash_async_vtask_port(&vtask), &thread_state, image_list)) != PLFRAME_ESUCCESS) {
+            [output appendFormat: @"Could not initialize frame cursor: %s\n\n", plframe_strerror(ferr)];
+            continue;
+        }
+        plframe_cursor_set_section_cache(&cursor, &section_cache);
+
+        /* Bound the walk, in case the captured stack is corrupt or cyclic */
+        for (NSUInteger frame = 0; frame < 512 && (ferr = plframe_cursor_next(&cursor)) == PLFRAME_ESUCCESS; frame++, total_frames++) {
+            plcrash_greg_t pc = 0;
+            plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc);
+
+            plcrash_async_macho_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pc);
+            struct unwind_symbol sym = { 0, "" };
+            if (image != NULL)
+                plcrash_async_macho_find_symbol_by_pc(image, (pl_vm_address_t) pc, unwind_symbol_cb, &sym);
+
+            const char *image_name = (image != NULL && image->name != NULL) ? strrchr(image->name, '/') : NULL;
+            image_name = (image_name != NULL) ? image_name + 1 : (image != NULL ? image->name : "???");
+
+            if (sym.name[0] != '\0') {
+                [output appendFormat: @"%-4lu %-32s 0x%016" PRIx64 " %s + %" PRIu64 "\n", (unsigned long) frame, image_name,
+                    (uint64_t) pc, sym.name, (uint64_t) (pc - sym.address)];
+            } else {
+                [output appendFormat: @"%-4lu %-32s 0x%016" PRIx64 "\n", (unsigned long) frame, image_name, (uint64_t) pc];
+            }
+        }
+
+        if (ferr != PLFRAME_ESUCCESS && ferr != PLFRAME_ENOFRAME)
+            [output appendFormat: @"Unwinding terminated: %s\n", plframe_strerror(ferr)];
+        [output appendString: @"\n"];
+
+        plframe_cursor_free(&cursor);
+    }
+
+    if (recording != NULL) {
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        uint64_t elapsed_ns = ((mach_absolute_time() - start) * timebase.numer) / timebase.denom;
+        [output appendFormat: @"Replayed %lu frames in %llu us\n", (unsigned long) total_frames, (unsigned long long) (elapsed_ns / 1000)];
+    }
+
+    plcrash_async_macho_section_cache_free(&section_cache);
+    plcrash_async_image_list_free(image_list);
+    plcrash_async_allocator_free(allocator);
+    plcrash_nasync_vtask_free(&vtask);
+
+    return YES;
+}
+
+/*
+ * Re-unwind crash reports offline.
+ */
+static int unwind_command (int argc, char *argv[]) {
+    const char *binaries_dir = NULL;
+    const char *recording = NULL;
+    long jobs = 0;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "jobs",       required_argument,      NULL,          'j' },
+        { "binaries",   required_argument,      NULL,          'b' },
+        { "recording",  required_argument,      NULL,          'r' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "j:b:r:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Invalid job count\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            case 'b':
+                binaries_dir = optarg;
+                break;
+            case 'r':
+                recording = optarg;
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (binaries_dir == NULL && recording == NULL) {
+        fprintf(stderr, "A binaries directory or recording must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (argc < 1) {
+        fprintf(stderr, "No input files supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    /* A recording is specific to the report written while it was made */
+    if (recording != NULL) {
+        if (argc != 1) {
+            fprintf(stderr, "A recording may only be replayed against a single crash log\n");
+            print_usage();
+            return 1;
+        }
+
+        plcrash_async_instrumentation_t instr;
+        plcrash_async_instrumentation_init(&instr);
+
+        NSError *error;
+        NSString *path = [NSString stringWithUTF8String: argv[0]];
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path options: PLCrashReportDecodingOptionNone error: &error] autorelease];
+        if (report == nil) {
+            fprintf(stderr, "Could not load crash log %s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+
+        /* Count the reads served from the recording */
+        NSMutableString *output = [NSMutableString string];
+        plcrash_async_instrumentation_set_current(&instr);
+        BOOL replayed = unwind_report(report, nil, recording, output);
+        plcrash_async_instrumentation_set_current(NULL);
+
+        fprintf(stdout, "%s", [output UTF8String]);
+        fprintf(stdout, "%lld task reads, %lld memory object mappings\n",
+                (long long) instr.counters[PLCRASH_ASYNC_COUNTER_TASK_MEMCPY], (long long) instr.counters[PLCRASH_ASYNC_COUNTER_MOBJECT_MAPS]);
+        fflush(stdout);
+
+        return replayed ? 0 : 1;
+    }
+
+    /* Collect the input paths */
+    NSMutableArray *paths = [NSMutableArray array];
+    for (int i = 0; i < argc; i++) {
+        BOOL isDir = NO;
+        if (strcmp(argv[i], "-") == 0 || ([[NSFileManager defaultManager] fileExistsAtPath: [NSString stringWithUTF8String: argv[i]] isDirectory: &isDir] && isDir)) {
+            NSArray *expanded = batch_input_paths(argv[i]);
+            if (expanded == nil)
+                return 1;
+            [paths addObjectsFromArray: expanded];
+        } else {
+            [paths addObject: [NSString stringWithUTF8String: argv[i]]];
+        }
+    }
+
+    NSDictionary *binaries = unwind_index_binaries([NSString stringWithUTF8String: binaries_dir]);
+    if ([binaries count] == 0)
+        fprintf(stderr, "Warning: no Mach-O binaries found in %s\n", binaries_dir);
+
+    if (jobs == 0)
+        jobs = [[NSProcessInfo processInfo] activeProcessorCount];
+
+    const NSUInteger count = [paths count];
+    __block volatile int32_t next = 0;
+    __block volatile int32_t failures = 0;
+
+    /* Serializes writes to stdout */
+    dispatch_queue_t outputQueue = dispatch_queue_create("plcrashutil.output", DISPATCH_QUEUE_SERIAL);
+
+    dispatch_apply(jobs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        int32_t idx;
+
+        while ((idx = OSAtomicIncrement32Barrier(&next) - 1) < (int32_t) count) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSString *path = [paths objectAtIndex: idx];
+            NSError *error;
+
+            PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path
+                                                                          options: PLCrashReportDecodingOptionNone
+                                                                            error: &error] autorelease];
+            if (report == nil) {
+                fprintf(stderr, "Could not load crash log %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+                OSAtomicIncrement32(&failures);
+                [pool release];
+                continue;
+            }
+
+            /* Unwind to memory, and then write the complete output to stdout, preventing interleaving */
+            NSMutableString *output = [NSMutableString string];
+            if (!unwind_report(report, binaries, NULL, output))
+                OSAtomicIncrement32(&failures);
+
+            dispatch_sync(outputQueue, ^{
+                fprintf(stdout, "==> %s <==\n%s", [path fileSystemRepresentation], [output UTF8String]);
+            });
+
+            [pool release];
+        }
+    });
+
+    dispatch_release(outputQueue);
+    fflush(stdout);
+
+    if (failures > 0)
+        fprintf(stderr, "%d of %lu crash logs could not be unwound\n", failures, (unsigned long) count);
+
+    return failures > 0 ? 1 : 0;
+}
+
+/* A Mach-O segment, as laid out in the file backing a serve_image_source */
+struct serve_segment {
+    uint64_t vmaddr;
+    uint64_t vmsize;
+    uint64_t fileoff;
+    uint64_t filesize;
+};
+
+/*
+ * Virtual task memory source presenting a mapped Mach-O slice (eg, a dSYM's DWARF file) at its unslid VM addresses,
+ * serving each segment directly from the file mapping.
+ */
+struct serve_image_source {
+    const uint8_t *slice;
+    size_t length;
+    struct serve_segment *segments;
+    size_t count;
+};
+
+/* Return the segment of @a src containing @a address, or NULL */
+static const struct serve_segment *serve_find_segment (const struct serve_image_source *src, pl_vm_address_t address) {
+    for (size_t i = 0; i < src->count; i++) {
+        if (address >= src->segments[i].vmaddr && address - src->segments[i].vmaddr < src->segments[i].vmsize)
+            return &src->segments[i];
+    }
+
+    return NULL;
+}
+
+static plcrash_error_t serve_source_copy (void *ctx, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    const struct serve_image_source *src = ctx;
+    const struct serve_segment *seg = serve_find_segment(src, address);
+    if (seg == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    uint64_t offset = address - seg->vmaddr;
+    if (len > seg->vmsize - offset)
+        return PLCRASH_ENOTFOUND;
+
+    /* Bytes beyond the segment's file contents are zero-fill */
+    uint64_t in_file = (offset < seg->filesize) ? MIN(len, seg->filesize - offset) : 0;
+    memcpy(dest, src->slice + seg->fileoff + offset, (size_t) in_file);
+    memset((uint8_t *) dest + in_file, 0, (size_t) (len - in_file));
+
+    return PLCRASH_ESUCCESS;
+}
+
+static plcrash_error_t serve_source_map (void *ctx, pl_vm_address_t address, pl_vm_size_t length, bool require_full,
+                                         pl_vm_address_t *local, pl_vm_size_t *available)
+{
+    const struct serve_image_source *src = ctx;
+    const struct serve_segment *seg = serve_find_segment(src, address);
+    if (seg == NULL)
+        return PLCRASH_ENOMEM;
+
+    uint64_t offset = address - seg->vmaddr;
+    if (offset >= seg->filesize)
+        return PLCRASH_ENOMEM;
+
+    uint64_t remaining = seg->filesize - offset;
+    if (require_full && remaining < length)
+        return PLCRASH_ENOMEM;
+
+    /* Memory objects require that the local mapping share the target's page offset */
+    pl_vm_address_t mapped = (pl_vm_address_t) (uintptr_t) (src->slice + seg->fileoff + offset);
+    if ((mapped & vm_page_mask) != (address & vm_page_mask))
+        return PLCRASH_ENOMEM;
+
+    *local = mapped;
+    *available = MIN(remaining, length);
+    return PLCRASH_ESUCCESS;
+}
+
+static const plcrash_async_vtask_source_t serve_image_source_ops = {
+    .copy = serve_source_copy,
+    .map = serve_source_map,
+    .free = NULL
+};
+
+/*
+ * A resident, indexed symbol table loaded from a dSYM or binary, shared by all serve workers.
+ */
+@interface PLCrashUtilSymbolImage : NSObject {
+@private
+    /** The mapped file. */
+    NSData *_data;
+
+    /** The memory source presenting the slice at its VM addresses. */
+    struct serve_image_source _source;
+
+    /** The virtual task backed by _source. */
+    plcrash_async_vtask_t _vtask;
+
+    /** The allocator backing _image. */
+    plcrash_async_allocator_t *_allocator;
+
+    /** The parsed image. */
+    plcrash_async_macho_t _image;
+}
+
+- (id) initWithPath: (NSString *) path offset: (size_t) offset length: (size_t) length;
+- (BOOL) findSymbolForOffset: (uint64_t) offset name: (NSString **) name symbolOffset: (uint64_t *) symbolOffset;
+
+@end
+
+/* Symbol lookup result, populated by serve_symbol_cb() */
+struct serve_symbol {
+    pl_vm_address_t address;
+    NSString *name;
+};
+
+static void serve_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    struct serve_symbol *sym = ctx;
+    sym->address = address;
+    sym->name = [NSString stringWithUTF8String: name];
+}
+
+@implementation PLCrashUtilSymbolImage
+
+- (id) initWithPath: (NSString *) path offset: (size_t) offset length: (size_t) length {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _data = [[NSData alloc] initWithContentsOfFile: path options: NSDataReadingMappedAlways error: NULL];
+    if (_data == nil || offset > [_data length] || length > [_data length] - offset) {
+        [self release];
+        return nil;
+    }
+
+    /* Collect the segments. In a dSYM, __TEXT carries no file contents; the header and load commands are served from
+     * the start of the file in its place. */
+    const uint8_t *slice = (const uint8_t *) [_data bytes] + offset;
+    const struct mach_header *header = (const struct mach_header *) slice;
+    NSMutableData *segments = [NSMutableData data];
+    __block uint64_t text_vmaddr = 0;
+    __block BOOL found_text = NO;
+
+    BOOL parsed = unwind_load_commands(slice, length, ^(const struct load_command *lc) {
+        struct serve_segment seg;
+        const char *segname;
+
+        if (lc->cmd == LC_SEGMENT_64 && lc->cmdsize >= sizeof(struct segment_command_64)) {
+            const struct segment_command_64 *sc = (const struct segment_command_64 *) lc;
+            segname = sc->segname;
+            seg = (struct serve_segment) { sc->vmaddr, sc->vmsize, sc->fileoff, sc->filesize };
+        } else if (lc->cmd == LC_SEGMENT && lc->cmdsize >= sizeof(struct segment_command)) {
+            const struct segment_command *sc = (const struct segment_command *) lc;
+            segname = sc->segname;
+            seg = (struct serve_segment) { sc->vmaddr, sc->vmsize, sc->fileoff, sc->filesize };
+        } else {
+            return;
+        }
+
+        if (strncmp(segname, SEG_TEXT, 16) == 0) {
+            size_t cmds_end = ((header->magic == MH_MAGIC_64) ? sizeof(struct mach_header_64) : sizeof(struct mach_header)) + header->sizeofcmds;
+            seg.fileoff = 0;
+            seg.filesize = MAX(seg.filesize, cmds_end);
+            text_vmaddr = seg.vmaddr;
+            found_text = YES;
+        }
+
+        /* Discard segments whose file contents exceed the slice */
+        if (seg.vmsize == 0 || seg.fileoff > length || seg.filesize > length - seg.fileoff)
+            return;
+
+        [segments appendBytes: &seg length: sizeof(seg)];
+    });
+
+    if (!parsed || !found_text) {
+        [self release];
+        return nil;
+    }
+
+    _source.slice = slice;
+    _source.length = length;
+    _source.count = [segments length] / sizeof(struct serve_segment);
+    _source.segments = malloc([segments length]);
+    memcpy(_source.segments, [segments bytes], [segments length]);
+
+    if (plcrash_nasync_vtask_init_source(&_vtask, &serve_image_source_ops, &_source) != PLCRASH_ESUCCESS) {
+        free(_source.segments);
+        _source.segments = NULL;
+        [self release];
+        return nil;
+    }
+
+    if (plcrash_async_allocator_create(&_allocator, PAGE_SIZE * 4) != PLCRASH_ESUCCESS) {
+        _allocator = NULL;
+        [self release];
+        return nil;
+    }
+
+    if (plcrash_async_macho_init(&_image, _allocator, plcrash_async_vtask_port(&_vtask), [path fileSystemRepresentation], (pl_vm_address_t) text_vmaddr) != PLCRASH_ESUCCESS) {
+        plcrash_async_allocator_free(_allocator);
+        _allocator = NULL;
+        [self release];
+        return nil;
+    }
+
+    /* Build the address index once; all subsequent lookups are binary searches */
+    plcrash_nasync_macho_build_symbol_index(&_image);
+
+    return self;
+}
+
+- (void) dealloc {
+    if (_allocator != NULL) {
+        plcrash_async_macho_free(&_image);
+        plcrash_async_allocator_free(_allocator);
+    }
+
+    if (_source.segments != NULL) {
+        plcrash_nasync_vtask_free(&_vtask);
+        free(_source.segments);
+    }
+
+    [_data release];
+    [super dealloc];
+}
+
+/*
+ * Look up the symbol containing the image-relative @a offset.
+ */
+- (BOOL) findSymbolForOffset: (uint64_t) offset name: (NSString **) name symbolOffset: (uint64_t *) symbolOffset {
+    struct serve_symbol sym = { 0, nil };
+    pl_vm_address_t pc = _image.text_vmaddr + offset;
+
+    if (plcrash_async_macho_find_symbol_by_pc(&_image, pc, serve_symbol_cb, &sym) != PLCRASH_ESUCCESS || sym.name == nil)
+        return NO;
+
+    *name = sym.name;
+    *symbolOffset = pc - sym.address;
+    return YES;
+}
+
+@end
+
+/*
+ * A least-recently-used cache of resident symbol images, keyed by UUID.
+ */
+struct serve_cache {
+    /** Maps UUIDs to binary locations, as returned by unwind_index_binaries(). */
+    NSDictionary *index;
+
+    /** Maps UUIDs to loaded PLCrashUtilSymbolImage instances. */
+    NSMutableDictionary *images;
+
+    /** Loaded UUIDs, least recently used first. */
+    NSMutableArray *order;
+
+    /** The maximum number of resident images. */
+    NSUInteger capacity;
+};
+
+/*
+ * Return the (retained and autoreleased) symbol image for @a uuid, loading it if necessary, or nil if unavailable.
+ * Images evicted from the cache remain valid for as long as a caller retains them.
+ */
+static PLCrashUtilSymbolImage *serve_cache_image (struct serve_cache *cache, NSString *uuid) {
+    PLCrashUtilSymbolImage *image;
+
+    @synchronized (cache->images) {
+        image = [cache->images objectForKey: uuid];
+        if (image != nil) {
+            [cache->order removeObject: uuid];
+            [cache->order addObject: uuid];
+            return [[image retain] autorelease];
+        }
+
+        NSDictionary *binary = [cache->index objectForKey: uuid];
+        if (binary == nil)
+            return nil;
+
+        image = [[[PLCrashUtilSymbolImage alloc] initWithPath: [binary objectForKey: @"path"]
+                                                       offset: (size_t) [[binary objectForKey: @"offset"] unsignedLongLongValue]
+                                                       length: (size_t) [[binary objectForKey: @"length"] unsignedLongLongValue]] autorelease];
+        if (image == nil)
+            return nil;
+
+        [cache->images setObject: image forKey: uuid];
+        [cache->order addObject: uuid];
+
+        while ([cache->order count] > cache->capacity) {
+            [cache->images removeObjectForKey: [cache->order objectAtIndex: 0]];
+            [cache->order removeObjectAtIndex: 0];
+        }
+    }
+
+    return image;
+}
+
+/*
+ * Symbolicate all threads of the report at @a path, returning the formatted output.
+ */
+static NSString *serve_symbolicate_report (struct serve_cache *cache, NSString *path) {
+    NSMutableString *output = [NSMutableString stringWithFormat: @"==> %@ <==\n", path];
+    NSError *error;
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithContentsOfFile: path options: PLCrashReportDecodingOptionNone error: &error] autorelease];
+    if (report == nil) {
+        [output appendFormat: @"error: %@\n\n", [error localizedDescription]];
+        return output;
+    }
+
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        [output appendFormat: @"Thread %ld%@:\n", (long) thread.threadNumber, thread.crashed ? @" Crashed" : @""];
+
+        NSUInteger frameIndex = 0;
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+            uint64_t pc = frame.instructionPointer;
+            PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress: pc];
+            NSString *imageName = imageInfo != nil ? [imageInfo.imageName lastPathComponent] : @"???";
+            NSString *symbol = nil;
+            uint64_t symbolOffset = 0;
+
+            if (imageInfo != nil && imageInfo.hasImageUUID) {
+                PLCrashUtilSymbolImage *image = serve_cache_image(cache, [imageInfo.imageUUID lowercaseString]);
+                [image findSymbolForOffset: pc - imageInfo.imageBaseAddress name: &symbol symbolOffset: &symbolOffset];
+            }
+
+            if (symbol != nil) {
+                [output appendFormat: @"%-4lu %-32s 0x%016" PRIx64 " %@ + %" PRIu64 "\n", (unsigned long) frameIndex,
+                    [imageName UTF8String], pc, symbol, symbolOffset];
+            } else {
+                [output appendFormat: @"%-4lu %-32s 0x%016" PRIx64 "\n", (unsigned long) frameIndex, [imageName UTF8String], pc];
+            }
+
+            frameIndex++;
+        }
+
+        [output appendString: @"\n"];
+    }
+
+    return output;
+}
+
+/*
+ * Read newline-separated report paths from @a in until EOF, symbolicating each on the shared worker pool and
+ * writing the results to @a out in completion order.
+ */
+static void serve_stream (struct serve_cache *cache, FILE *in, FILE *out, dispatch_semaphore_t workers) {
+    dispatch_queue_t outputQueue = dispatch_queue_create("plcrashutil.serve.output", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    char *line = NULL;
+    size_t linecap = 0;
+    ssize_t len;
+
+    while ((len = getline(&line, &linecap, in)) > 0) {
+        if (line[len - 1] == '\n')
+            line[--len] = '\0';
+        if (len == 0)
+            continue;
+
+        NSString *path = [[NSString alloc] initWithUTF8String: line];
+
+        /* Bound the number of reports in flight across all connections */
+        dispatch_semaphore_wait(workers, DISPATCH_TIME_FOREVER);
+        dispatch_group_async(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSString *result = serve_symbolicate_report(cache, path);
+
+            dispatch_sync(outputQueue, ^{
+                fputs([result UTF8String], out);
+                fflush(out);
+            });
+
+            [pool release];
+            dispatch_semaphore_signal(workers);
+        });
+
+        [path release];
+    }
+
+    free(line);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    dispatch_release(group);
+    dispatch_release(outputQueue);
+}
+
+/*
+ * Run a long-lived symbolication service.
+ */
+static int serve_command (int argc, char *argv[]) {
+    const char *dsyms_dir = NULL;
+    const char *socket_path = NULL;
+    long jobs = 0;
+    long cache_size = 64;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "jobs",       required_argument,      NULL,          'j' },
+        { "dsyms",      required_argument,      NULL,          'd' },
+        { "socket",     required_argument,      NULL,          's' },
+        { "cache",      required_argument,      NULL,          'c' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "j:d:s:c:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                if (jobs <= 0) {
+                    fprintf(stderr, "Invalid job count\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            case 'c':
+                cache_size = strtol(optarg, NULL, 10);
+                if (cache_size <= 0) {
+                    fprintf(stderr, "Invalid cache size\n");
+                    print_usage();
+                    return 1;
+                }
+                break;
+            case 'd':
+                dsyms_dir = optarg;
+                break;
+            case 's':
+                socket_path = optarg;
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+
+    if (dsyms_dir == NULL) {
+        fprintf(stderr, "A dSYM directory must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (jobs == 0)
+        jobs = [[NSProcessInfo processInfo] activeProcessorCount];
+
+    /* Index the available dSYMs by UUID; the symbol tables themselves are loaded on demand */
+    struct serve_cache cache;
+    cache.index = [unwind_index_binaries([NSString stringWithUTF8String: dsyms_dir]) retain];
+    cache.images = [[NSMutableDictionary alloc] init];
+    cache.order = [[NSMutableArray alloc] init];
+    cache.capacity = (NSUInteger) cache_size;
+
+    fprintf(stderr, "Indexed %lu images\n", (unsigned long) [cache.index count]);
+
+    dispatch_semaphore_t workers = dispatch_semaphore_create(jobs);
+
+    if (socket_path == NULL) {
+        serve_stream(&cache, stdin, stdout, workers);
+    } else {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlcpy(addr.sun_path, socket_path, sizeof(addr.sun_path)) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "Socket path is too long\n");
+            return 1;
+        }
+
+        int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(socket_path);
+        if (sock < 0 || bind(sock, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(sock, SOMAXCONN) != 0) {
+            fprintf(stderr, "Could not listen on %s: %s\n", socket_path, strerror(errno));
+            return 1;
+        }
+
+        /* Each connection is a request stream, served concurrently with all others */
+        for (;;) {
+            int conn = accept(sock, NULL, NULL);
+            if (conn < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                /* Connections may still be in flight; the cache is left to be reclaimed on exit */
+                fprintf(stderr, "accept() failed: %s\n", strerror(errno));
+                close(sock);
+                unlink(socket_path);
+                return 1;
+            }
+
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+                FILE *in = fdopen(conn, "r");
+                FILE *out = fdopen(dup(conn), "w");
+
+                if (in != NULL && out != NULL)
+                    serve_stream(&cache, in, out, workers);
+
+                if (out != NULL)
+                    fclose(out);
+                if (in != NULL)
+                    fclose(in);
+                else
+                    close(conn);
+
+                [pool release];
+            });
+        }
+    }
+
+    dispatch_release(workers);
+    [cache.order release];
+    [cache.images release];
+    [cache.index release];
+
+    return 0;
+}
+
+/** The number of top-level CrashReport fields tracked individually by the stats command; higher field numbers are
+ * tallied together. */
+#define STATS_SECTION_COUNT 32
+
+/** Top-level CrashReport section names, indexed by field number. */
+static const char *stats_section_names[STATS_SECTION_COUNT] = {
+    [1] = "system_info",
+    [2] = "application_info",
+    [3] = "threads",
+    [4] = "binary_images",
+    [5] = "exception",
+    [6] = "signal",
+    [7] = "process_info",
+    [8] = "machine_info",
+    [9] = "report_info",
+    [10] = "symbol_strings",
+    [11] = "compact_binary_images",
+    [12] = "writer_stats",
+    [13] = "breadcrumbs",
+    [14] = "memory_regions",
+    [15] = "shared_image_list",
+    [16] = "crash_loop",
+    [17] = "debug_log",
+    [18] = "attachments",
+    [19] = "thread_metadata",
+};
+
+/**
+ * Report composition totals accumulated by the stats command. All sizes are encoded bytes, including each field's
+ * key and length prefix.
+ */
+struct stats_totals {
+    /** The number of reports analyzed. */
+    uint64_t reports;
+
+    /** The total size of the decompressed reports, excluding the file header. */
+    uint64_t report_bytes;
+
+    /** The total size of the report files, as stored. */
+    uint64_t file_bytes;
+
+    /** Bytes per top-level section, indexed by field number; index 0 holds any field numbered beyond the table. */
+    uint64_t section_bytes[STATS_SECTION_COUNT];
+
+    /** Thread frame records (Thread.frames), including their symbols. */
+    uint64_t frame_bytes;
+
+    /** Frame symbol records (StackFrame.symbol), including their names. */
+    uint64_t frame_symbol_bytes;
+
+    /** Symbol names written inline within frame symbols (Symbol.name). */
+    uint64_t symbol_name_bytes;
+
+    /** Packed frame PCs and symbols (Thread.frame_pcs, Thread.frame_symbols). */
+    uint64_t packed_frame_bytes;
+
+    /** Thread registers (Thread.registers, Thread.register_state). */
+    uint64_t register_bytes;
+
+    /** All other thread fields. */
+    uint64_t thread_other_bytes;
+
+    /** Binary image paths (BinaryImage.name). */
+    uint64_t image_name_bytes;
+
+    /** All other binary image fields, and compact binary image records. */
+    uint64_t image_other_bytes;
+
+    /** The number of threads, and the number of frames they contain. */
+    uint64_t threads;
+    uint64_t frames;
+
+    /** The number of threads whose stack duplicated that of an earlier thread in the same report. */
+    uint64_t duplicate_stacks;
+
+    /** The number of threads written as a reference to a duplicate thread (Thread.duplicate_of_thread). */
+    uint64_t collapsed_stacks;
+
+    /** The number of symbol and image name strings, and their total size. */
+    uint64_t strings;
+    uint64_t string_bytes;
+
+    /** The number of strings that duplicated an earlier string in the same report, and their total size. */
+    uint64_t duplicate_strings;
+    uint64_t duplicate_string_bytes;
+};
+
+/*
+ * Read a varint from @a p, advancing @a p. Returns NO if the varint is truncated or malformed.
+ */
+static BOOL stats_read_varint (const uint8_t **p, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end)
+            return NO;
+
+        uint8_t byte = *(*p)++;
+        result |= (uint64_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+/*
+ * Iterate the fields of the encoded protobuf message at @a data, calling @a block with each field's number, wire type,
+ * value bytes (the payload of length-delimited fields, or the encoded value of all others), and total encoded size.
+ * Returns NO if the message is malformed.
+ */
+static BOOL stats_walk_message (const uint8_t *data, size_t length, void (^block)(uint32_t field, uint32_t wire_type, const uint8_t *value, size_t value_length, size_t field_length)) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+
+    while (p < end) {
+        const uint8_t *start = p;
+        uint64_t key;
+        uint64_t len;
+
+        if (!stats_read_varint(&p, end, &key))
+            return NO;
+
+        const uint8_t *value = p;
+        switch (key & 0x7) {
+            case 0:
+                if (!stats_read_varint(&p, end, &len))
+                    return NO;
+                break;
+            case 1:
+                if (end - p < 8)
+                    return NO;
+                p += 8;
+                break;
+            case 2:
+                if (!stats_read_varint(&p, end, &len) || len > (uint64_t) (end - p))
+                    return NO;
+                value = p;
+                p += len;
+                break;
+            case 5:
+                if (end - p < 4)
+                    return NO;
+                p += 4;
+                break;
+            default:
+                /* Groups are not used by the report format */
+                return NO;
+        }
+
+        block((uint32_t) (key >> 3), (uint32_t) (key & 0x7), value, (size_t) (p - value), (size_t) (p - start));
+    }
+
+    return YES;
+}
+
+/* Fold @a length bytes at @a data into the FNV-1a hash @a hash */
+static uint64_t stats_hash (uint64_t hash, const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* Record the string @a value in @a strings, updating the duplicate string totals */
+static void stats_record_string (struct stats_totals *totals, NSMutableSet *strings, const uint8_t *value, size_t length) {
+    NSData *string = [NSData dataWithBytes: value length: length];
+
+    totals->strings++;
+    totals->string_bytes += length;
+    if ([strings containsObject: string]) {
+        totals->duplicate_strings++;
+        totals->duplicate_string_bytes += length;
+    } else {
+        [strings addObject: string];
+    }
+}
+
+/*
+ * Accumulate the composition of the encoded CrashReport message at @a data into @a totals. Returns NO if the message
+ * is malformed.
+ */
+static BOOL stats_analyze_report (const uint8_t *data, size_t length, struct stats_totals *totals) {
+    NSMutableSet *stacks = [NSMutableSet set];
+    NSMutableSet *strings = [NSMutableSet set];
+    __block BOOL valid = YES;
+
+    valid = stats_walk_message(data, length, ^(uint32_t field, uint32_t wire_type, const uint8_t *value, size_t value_length, size_t field_length) {
+        totals->section_bytes[field < STATS_SECTION_COUNT ? field : 0] += field_length;
+        if (wire_type != 2)
+            return;
+
+        switch (field) {
+            case 3: {
+                /* Thread */
+                __block uint64_t stack_hash = 0xcbf29ce484222325ULL;
+                __block BOOL has_stack = NO;
+                __block size_t accounted = 0;
+
+                totals->threads++;
+                valid &= stats_walk_message(value, value_length, ^(uint32_t thread_field, uint32_t thread_wire_type, const uint8_t *thread_value, size_t thread_value_length, size_t thread_field_length) {
+                    switch (thread_field) {
+                        case 2:
+                            /* StackFrame */
+                            totals->frames++;
+                            totals->frame_bytes += thread_field_length;
+                            accounted += thread_field_length;
+                            stack_hash = stats_hash(stack_hash, thread_value, thread_value_length);
+                            has_stack = YES;
+
+                            valid &= stats_walk_message(thread_value, thread_value_length, ^(uint32_t frame_field, uint32_t frame_wire_type, const uint8_t *frame_value, size_t frame_value_length, size_t frame_field_length) {
+                                if (frame_field != 6 || frame_wire_type != 2)
+                                    return;
+
+                                totals->frame_symbol_bytes += frame_field_length;
+                                valid &= stats_walk_message(frame_value, frame_value_length, ^(uint32_t symbol_field, uint32_t symbol_wire_type, const uint8_t *symbol_value, size_t symbol_value_length, size_t symbol_field_length) {
+                                    if (symbol_field != 1 || symbol_wire_type != 2)
+                                        return;
+
+                                    totals->symbol_name_bytes += symbol_field_length;
+                                    stats_record_string(totals, strings, symbol_value, symbol_value_length);
+                                });
+                            });
+                            break;
+
+                        case 4:
+                        case 8:
+                            /* Registers */
+                            totals->register_bytes += thread_field_length;
+                            accounted += thread_field_length;
+                            break;
+
+                        case 9:
+                            /* Collapsed duplicate stack */
+                            totals->collapsed_stacks++;
+                            break;
+
+                        case 12:
+                        case 13:
+                            /* Packed frames */
+                            totals->packed_frame_bytes += thread_field_length;
+                            accounted += thread_field_length;
+                            if (thread_field == 12) {
+                                stack_hash = stats_hash(stack_hash, thread_value, thread_value_length);
+                                has_stack = YES;
+
+                                for (size_t i = 0; i < thread_value_length; i++) {
+                                    if ((thread_value[i] & 0x80) == 0)
+                                        totals->frames++;
+                                }
+                            }
+                            break;
+                    }
+                });
+
+                totals->thread_other_bytes += field_length - accounted;
+
+                if (has_stack) {
+                    NSNumber *key = [NSNumber numberWithUnsignedLongLong: stack_hash];
+                    if ([stacks containsObject: key])
+                        totals->duplicate_stacks++;
+                    else
+                        [stacks addObject: key];
+                }
+                break;
+            }
+
+            case 4: {
+                /* BinaryImage */
+                __block size_t name_length = 0;
+                valid &= stats_walk_message(value, value_length, ^(uint32_t image_field, uint32_t image_wire_type, const uint8_t *image_value, size_t image_value_length, size_t image_field_length) {
+                    if (image_field != 3 || image_wire_type != 2)
+                        return;
+
+                    name_length += image_field_length;
+                    stats_record_string(totals, strings, image_value, image_value_length);
+                });
+
+                totals->image_name_bytes += name_length;
+                totals->image_other_bytes += field_length - name_length;
+                break;
+            }
+
+            case 10:
+                /* StringTable */
+                valid &= stats_walk_message(value, value_length, ^(uint32_t string_field, uint32_t string_wire_type, const uint8_t *string_value, size_t string_value_length, size_t string_field_length) {
+                    if (string_field == 1 && string_wire_type == 2)
+                        stats_record_string(totals, strings, string_value, string_value_length);
+                });
+                break;
+
+            case 11:
+                /* CompactBinaryImage */
+                totals->image_other_bytes += field_length;
+                break;
+        }
+    }) && valid;
+
+    return valid;
+}
+
+/* Print a single composition row */
+static void stats_print_row (const char *name, uint64_t bytes, uint64_t total) {
+    fprintf(stdout, "  %-28s %12llu  %5.1f%%\n", name, (unsigned long long) bytes, total > 0 ? (double) bytes * 100.0 / (double) total : 0.0);
+}
+
+/*
+ * Report the encoded composition of a set of crash reports.
+ */
+static int stats_command (int argc, char *argv[]) {
+    if (argc < 1) {
+        fprintf(stderr, "No input files supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    /* Collect the input paths */
+    NSMutableArray *paths = [NSMutableArray array];
+    for (int i = 0; i < argc; i++) {
+        BOOL isDir = NO;
+        if (strcmp(argv[i], "-") == 0 || ([[NSFileManager defaultManager] fileExistsAtPath: [NSString stringWithUTF8String: argv[i]] isDirectory: &isDir] && isDir)) {
+            NSArray *expanded = batch_input_paths(argv[i]);
+            if (expanded == nil)
+                return 1;
+            [paths addObjectsFromArray: expanded];
+        } else {
+            [paths addObject: [NSString stringWithUTF8String: argv[i]]];
+        }
+    }
+
+    /* Walk each report's encoded message; reports are never decoded */
+    struct stats_totals totals;
+    memset(&totals, 0, sizeof(totals));
+    int failures = 0;
+
+    for (NSString *path in paths) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSError *error;
+        NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: &error];
+        if (data == nil) {
+            fprintf(stderr, "Could not read crash log %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+            failures++;
+            [pool release];
+            continue;
+        }
+
+        NSUInteger fileLength = [data length];
+
+        /* Verify and strip the checksum trailer, if any */
+        size_t contentLength;
+        plcrash_error_t verr = plcrash_async_checksum_trailer_verify([data bytes], [data length], &contentLength);
+        if (verr == PLCRASH_EINVALID_DATA) {
+            fprintf(stderr, "Checksum mismatch in crash log %s\n", [path fileSystemRepresentation]);
+            failures++;
+            [pool release];
+            continue;
+        }
+        data = [data subdataWithRange: NSMakeRange(0, contentLength)];
+
+        /* Decompress the report, if necessary */
+        if (plcrash_async_compressed_is_compressed([data bytes], [data length])) {
+            size_t length;
+            NSMutableData *decoded = nil;
+            if (plcrash_async_compressed_decoded_length([data bytes], [data length], &length) == PLCRASH_ESUCCESS) {
+                decoded = [NSMutableData dataWithLength: length];
+                if (plcrash_async_compressed_decode([data bytes], [data length], [decoded mutableBytes], length, &length) != PLCRASH_ESUCCESS)
+                    decoded = nil;
+                else
+                    [decoded setLength: length];
+            }
+
+            if (decoded == nil) {
+                fprintf(stderr, "Could not decompress crash log %s\n", [path fileSystemRepresentation]);
+                failures++;
+                [pool release];
+                continue;
+            }
+            data = decoded;
+        }
+
+        const struct PLCrashReportFileHeader *header = [data bytes];
+        if ([data length] <= sizeof(struct PLCrashReportFileHeader) || memcmp(header->magic, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) != 0) {
+            fprintf(stderr, "Invalid crash log header in %s\n", [path fileSystemRepresentation]);
+            failures++;
+            [pool release];
+            continue;
+        }
+
+        size_t length = [data length] - sizeof(struct PLCrashReportFileHeader);
+        struct stats_totals report = totals;
+        if (!stats_analyze_report(header->data, length, &report)) {
+            fprintf(stderr, "Could not parse crash log %s\n", [path fileSystemRepresentation]);
+            failures++;
+        } else {
+            totals = report;
+            totals.reports++;
+            totals.report_bytes += length;
+            totals.file_bytes += fileLength;
+        }
+
+        [pool release];
+    }
+
+    if (totals.reports == 0) {
+        fprintf(stderr, "No crash logs could be parsed\n");
+        return 1;
+    }
+
+    /* Sections */
+    fprintf(stdout, "%llu reports, %llu encoded bytes (%llu bytes as stored), %llu bytes/report\n\n",
+            (unsigned long long) totals.reports, (unsigned long long) totals.report_bytes, (unsigned long long) totals.file_bytes,
+            (unsigned long long) (totals.report_bytes / totals.reports));
+
+    fprintf(stdout, "Sections:\n");
+    for (unsigned int i = 1; i < STATS_SECTION_COUNT; i++) {
+        if (totals.section_bytes[i] == 0)
+            continue;
+
+        if (stats_section_names[i] != NULL) {
+            stats_print_row(stats_section_names[i], totals.section_bytes[i], totals.report_bytes);
+        } else {
+            char name[32];
+            snprintf(name, sizeof(name), "field %u", i);
+            stats_print_row(name, totals.section_bytes[i], totals.report_bytes);
+        }
+    }
+    if (totals.section_bytes[0] > 0)
+        stats_print_row("other", totals.section_bytes[0], totals.report_bytes);
+
+    /* Field types */
+    fprintf(stdout, "\nField types:\n");
+    stats_print_row("frames (excluding symbols)", totals.frame_bytes - totals.frame_symbol_bytes, totals.report_bytes);
+    stats_print_row("frame symbols (excl. names)", totals.frame_symbol_bytes - totals.symbol_name_bytes, totals.report_bytes);
+    stats_print_row("inline symbol names", totals.symbol_name_bytes, totals.report_bytes);
+    stats_print_row("packed frames", totals.packed_frame_bytes, totals.report_bytes);
+    stats_print_row("registers", totals.register_bytes, totals.report_bytes);
+    stats_print_row("other thread fields", totals.thread_other_bytes, totals.report_bytes);
+    stats_print_row("binary image names", totals.image_name_bytes, totals.report_bytes);
+    stats_print_row("other binary image fields", totals.image_other_bytes, totals.report_bytes);
+    stats_print_row("symbol string table", totals.section_bytes[10], totals.report_bytes);
+
+    /* Duplication */
+    fprintf(stdout, "\nDuplication:\n");
+    fprintf(stdout, "  %llu threads, %llu frames (%.1f frames/thread)\n", (unsigned long long) totals.threads, (unsigned long long) totals.frames,
+            totals.threads > 0 ? (double) totals.frames / (double) totals.threads : 0.0);
+    fprintf(stdout, "  duplicate stacks: %llu of %llu threads (%.1f%%); %llu already collapsed\n",
+            (unsigned long long) totals.duplicate_stacks, (unsigned long long) totals.threads,
+            totals.threads > 0 ? (double) totals.duplicate_stacks * 100.0 / (double) totals.threads : 0.0,
+            (unsigned long long) totals.collapsed_stacks);
+    fprintf(stdout, "  duplicate strings: %llu of %llu (%.1f%%), %llu of %llu bytes (%.1f%%)\n",
+            (unsigned long long) totals.duplicate_strings, (unsigned long long) totals.strings,
+            totals.strings > 0 ? (double) totals.duplicate_strings * 100.0 / (double) totals.strings : 0.0,
+            (unsigned long long) totals.duplicate_string_bytes, (unsigned long long) totals.string_bytes,
+            totals.string_bytes > 0 ? (double) totals.duplicate_string_bytes * 100.0 / (double) totals.string_bytes : 0.0);
+    fflush(stdout);
+
+    if (failures > 0)
+        fprintf(stderr, "%d of %lu crash logs could not be parsed\n", failures, (unsigned long) [paths count]);
+
+    return failures > 0 ? 1 : 0;
+}
+
 int main (int argc, char *argv[]) {
     NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
     int ret = 0;
@@ -128,6 +2301,19 @@ int main (int argc, char *argv[]) {
     /* Convert command */
     if (strcmp(argv[1], "convert") == 0) {
         ret = convert_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "bucket") == 0) {
+        ret = bucket_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "stats") == 0) {
+        ret = stats_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "unwind") == 0) {
+        /* getopt_long() skips argv[0]; pass the command name in its place */
+        ret = unwind_command(argc - 1, argv + 1);
+    } else if (strcmp(argv[1], "serve") == 0) {
+        /* getopt_long() skips argv[0]; pass the command name in its place */
+        ret = serve_command(argc - 1, argv + 1);
+    } else if (strcmp(argv[1], "embed-symbols") == 0) {
+        /* getopt_long() skips argv[0]; pass the command name in its place */
+        ret = embed_symbols_command(argc - 1, argv + 1);
     } else {
         print_usage();
         ret = 1;
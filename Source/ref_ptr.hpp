@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2014 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_REF_PTR_H
+#define PLCRASH_ASYNC_REF_PTR_H
+
+#include "AsyncAllocatable.hpp"
+#include "AsyncAllocator.hpp"
+
+#include "PLCrashMacros.h"
+
+#include "async_stl.hpp"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * @{
+ */
+
+PLCR_CPP_BEGIN_ASYNC_NS
+namespace refcount {
+
+/**
+ * @internal
+ *
+ * A RefCounted count policy that uses atomic operations, allowing references to be shared across threads.
+ */
+class AtomicCount {
+public:
+    /** Atomically increment @a count. */
+    static inline void increment (volatile size_t *count) noexcept {
+        __sync_fetch_and_add(count, 1);
+    }
+
+    /** Atomically decrement @a count, returning true if the count has reached zero. */
+    static inline bool decrement (volatile size_t *count) noexcept {
+        return __sync_fetch_and_sub(count, 1) == 1;
+    }
+};
+
+/**
+ * @internal
+ *
+ * A RefCounted count policy that uses plain loads and stores. This may only be used for objects that are confined
+ * to a single thread, such as those allocated by the crash handler while all other threads are suspended.
+ */
+class NonAtomicCount {
+public:
+    /** Increment @a count. */
+    static inline void increment (volatile size_t *count) noexcept {
+        *count = *count + 1;
+    }
+
+    /** Decrement @a count, returning true if the count has reached zero. */
+    static inline bool decrement (volatile size_t *count) noexcept {
+        *count = *count - 1;
+        return *count == 0;
+    }
+};
+
+} /* namespace refcount */
+
+/**
+ * Base class for objects managed by ref_ptr. Unlike shared_ptr, the reference count is stored in the object itself;
+ * no separate reference counted value is allocated, and a reference may be acquired from a plain pointer.
+ *
+ * The object is destroyed via its (virtual) destructor, and deallocated via its AsyncAllocator, when the last
+ * reference is released.
+ *
+ * @tparam CountPolicy The reference count policy; either refcount::AtomicCount, or refcount::NonAtomicCount for
+ * thread-confined objects.
+ */
+template <class CountPolicy = refcount::AtomicCount> class RefCounted : public AsyncAllocatable {
+public:
+    /** Construct a new instance with a reference count of 0; the first reference is acquired by ref_ptr. */
+    RefCounted () : _refs(0) { }
+
+    /* Copy/move are not supported; the reference count belongs to a single object. */
+    RefCounted (const RefCounted &) = delete;
+    RefCounted (RefCounted &&) = delete;
+
+    RefCounted &operator= (const RefCounted &) = delete;
+    RefCounted &operator= (RefCounted &&) = delete;
+
+    /** Acquire a reference to this object. */
+    inline void retain () const noexcept {
+        CountPolicy::increment(&_refs);
+    }
+
+    /** Release a reference to this object, destroying the object if this was the last reference. */
+    inline void release () const noexcept {
+        if (CountPolicy::decrement(&_refs))
+            delete this;
+    }
+
+    /**
+     * Return the current reference count.
+     *
+     * @warning The reference count is not a reliable indicator of object lifetime or liveness, and should not be used
+     * outside of testing or debugging.
+     */
+    inline size_t referenceCount () const {
+        return _refs;
+    }
+
+protected:
+    virtual ~RefCounted () {
+        PLCF_ASSERT(_refs == 0);
+    }
+
+private:
+    /** The object's reference count. */
+    mutable volatile size_t _refs;
+};
+
+/**
+ * The ref_ptr class holds a strong reference to an intrusively reference counted object.
+ *
+ * @tparam T The referenced object type; this must be a subclass of RefCounted.
+ *
+ * @par Thread Safety
+ *
+ * Reference counting is thread-safe if the referenced object uses the refcount::AtomicCount policy. A single ref_ptr
+ * instance, however, must not be concurrently mutated -- or accessed during mutation -- without external
+ * synchronization.
+ */
+template <typename T> class ref_ptr {
+    /* Grant access to internal elements of other template instantiations */
+    template <typename U> friend class ref_ptr;
+
+public:
+    /**
+     * Construct an empty reference.
+     */
+    constexpr ref_ptr () noexcept : _ptr(nullptr) { }
+
+    /**
+     * Construct an empty reference.
+     */
+    constexpr ref_ptr (atl::nullptr_t) noexcept : _ptr(nullptr) { }
+
+    /**
+     * Construct a reference to @a ptr, acquiring a new reference.
+     *
+     * @param ptr The referenced object, or nullptr.
+     */
+    explicit ref_ptr (T *ptr) noexcept : _ptr(ptr) {
+        if (_ptr != nullptr)
+            _ptr->retain();
+    }
+
+    /**
+     * Construct a reference by acquiring a new reference to the object referenced by @a other.
+     */
+    ref_ptr (const ref_ptr<T> &other) noexcept : ref_ptr(other._ptr) { }
+
+    /**
+     * Construct a reference by acquiring a new reference to the object referenced by @a other, where U* is
+     * convertible to T*.
+     */
+    template <typename U> ref_ptr (const ref_ptr<U> &other) noexcept : ref_ptr(other._ptr) { }
+
+    /**
+     * Construct a reference by moving the reference held by @a other; the reference count is not modified.
+     */
+    ref_ptr (ref_ptr<T> &&other) noexcept : _ptr(other._ptr) {
+        other._ptr = nullptr;
+    }
+
+    /** Release the reference, if any. */
+    ~ref_ptr () {
+        if (_ptr != nullptr)
+            _ptr->release();
+    }
+
+    /**
+     * Copy assignment.
+     */
+    ref_ptr &operator= (const ref_ptr<T> &other) noexcept {
+        reset(other._ptr);
+        return *this;
+    }
+
+    /**
+     * Move assignment.
+     */
+    ref_ptr &operator= (ref_ptr<T> &&other) noexcept {
+        if (this != &other) {
+            T *previous = _ptr;
+            _ptr = other._ptr;
+            other._ptr = nullptr;
+
+            if (previous != nullptr)
+                previous->release();
+        }
+        return *this;
+    }
+
+    /**
+     * Construct a new instance of @a T, using @a args as the parameter list for the constructor of @a T, and return
+     * a reference to it. If allocation fails, an empty reference is returned.
+     *
+     * @param allocator The allocator to be used to instantiate the new instance.
+     * @param args The arguments with which an instance of @a T will be constructed.
+     */
+    template <class ...Args> static ref_ptr<T> make_ref (AsyncAllocator *allocator, Args&&... args) {
+        return ref_ptr<T>(new (allocator) T(atl::forward<Args>(args)...));
+    }
+
+    /**
+     * Return true if this reference is empty.
+     */
+    inline bool isEmpty (void) const {
+        return _ptr == nullptr;
+    }
+
+    /**
+     * Return true if this reference is *not* empty.
+     */
+    inline explicit operator bool () const {
+        return !isEmpty();
+    }
+
+    /**
+     * Return the current reference count for the managed object, or 0 if there is no managed object.
+     *
+     * @warning The reference count is not a reliable indicator of object lifetime or liveness, and should not be used
+     * outside of testing or debugging.
+     */
+    inline size_t referenceCount (void) const {
+        return _ptr == nullptr ? 0 : _ptr->referenceCount();
+    }
+
+    inline size_t use_count (void) const {
+        return referenceCount();
+    }
+
+    /** Returns a pointer to the managed object. */
+    inline T* get (void) const {
+        return _ptr;
+    }
+
+    /** Dereferences the pointer to the managed object */
+    inline T& operator *() const {
+        return *_ptr;
+    }
+
+    /** Dereferences the pointer to the managed object */
+    inline T* operator ->() const {
+        return _ptr;
+    }
+
+    /** Release ownership of the managed object, if any. Upon return, the reference will be empty. */
+    inline void clear () {
+        reset(nullptr);
+    }
+
+private:
+    /**
+     * Replace the managed object with @a ptr, acquiring a reference to @a ptr before releasing the current object.
+     * This ordering permits self-assignment.
+     */
+    inline void reset (T *ptr) noexcept {
+        if (ptr != nullptr)
+            ptr->retain();
+
+        T *previous = _ptr;
+        _ptr = ptr;
+
+        if (previous != nullptr)
+            previous->release();
+    }
+
+    /** The managed object, or nullptr. */
+    T *_ptr;
+};
+
+/**
+ * Construct an object of type @a T and wrap it in a ref_ptr, using @a args as the parameter list for the
+ * constructor of @a T. If allocation fails, an empty reference is returned.
+ *
+ * @param allocator The allocator to be used to instantiate the new instance.
+ * @param args The arguments with which an instance of @a T will be constructed.
+ *
+ * @tparam T The object type; this must be a subclass of RefCounted.
+ */
+template <class T, class ...Args> ref_ptr<T> make_ref (AsyncAllocator *allocator, Args&&... args) {
+    return ref_ptr<T>::make_ref(allocator, atl::forward<Args>(args)...);
+};
+
+/**
+ * Compare two references, returning true if the referenced objects are equal.
+ */
+template <class T, class U> inline bool operator== (const ref_ptr<T> &ptr1, const ref_ptr<U> &ptr2) {
+    return ptr1.get() == ptr2.get();
+}
+
+/**
+ * Compare two references, returning true if the referenced objects are not equal.
+ */
+template <class T, class U> inline bool operator!= (const ref_ptr<T> &ptr1, const ref_ptr<U> &ptr2) {
+    return !(ptr1 == ptr2);
+}
+
+/**
+ * Compare a reference to a pointer, returning true if the reference is empty.
+ */
+template <class T> inline bool operator== (const ref_ptr<T> &ptr, atl::nullptr_t) {
+    return ptr.isEmpty();
+}
+
+/**
+ * Compare a reference to a pointer, returning true if the reference is empty.
+ */
+template <class U> inline bool operator== (atl::nullptr_t, const ref_ptr<U> &ptr) {
+    return ptr.isEmpty();
+}
+
+/**
+ * Compare a reference to a pointer, returning true if the reference is not empty.
+ */
+template <class T> inline bool operator!= (const ref_ptr<T> &ptr, atl::nullptr_t) {
+    return !ptr.isEmpty();
+}
+
+/**
+ * Compare a reference to a pointer, returning true if the reference is not empty.
+ */
+template <class U> inline bool operator!= (atl::nullptr_t, const ref_ptr<U> &ptr) {
+    return !ptr.isEmpty();
+}
+
+PLCR_CPP_END_ASYNC_NS
+
+/**
+ * @}
+ */
+
+#endif /* PLCRASH_ASYNC_REF_PTR_H */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2014 - 2015 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ref_ptr.hpp"
+
+#include "PLCrashCatchTest.hpp"
+
+PLCR_CPP_BEGIN_ASYNC_NS
+
+/* A ref_ptr-managed test class that records its destruction. */
+template <class CountPolicy> class ExampleRefCounted : public RefCounted<CountPolicy> {
+public:
+    ExampleRefCounted (int v, size_t *destCount) : val(v), _destCount(destCount) {}
+    ~ExampleRefCounted () {
+        *_destCount = *_destCount + 1;
+    }
+
+    int val;
+
+private:
+    size_t *_destCount;
+};
+
+/* Intrusive reference tests, run for each count policy. */
+template <class CountPolicy> static void test_ref_ptr (void) {
+    typedef ExampleRefCounted<CountPolicy> Example;
+
+    AsyncAllocator *allocator;
+    REQUIRE(AsyncAllocator::Create(&allocator, PAGE_SIZE) == PLCRASH_ESUCCESS);
+
+    /* Tracks the number of times Example's destructor was invoked. */
+    size_t destCount = 0;
+
+    WHEN("Constructing references") {
+        auto ptr = make_ref<Example>(allocator, 42, &destCount);
+
+        THEN("Object value should be dereferenceable by value and pointer-to-value") {
+            REQUIRE((*ptr).val == 42);
+            REQUIRE((ptr.get())->val == 42);
+            REQUIRE(ptr->val == 42);
+        }
+
+        THEN("Reference count should start at 1") {
+            REQUIRE(!ptr.isEmpty());
+            REQUIRE(ptr.referenceCount() == 1);
+        }
+
+        THEN("A reference acquired from a plain pointer should share the object's count") {
+            ref_ptr<Example> other(ptr.get());
+            REQUIRE(other.referenceCount() == 2);
+            REQUIRE(other == ptr);
+        }
+    }
+
+    WHEN("Operating on an empty reference") {
+        ref_ptr<Example> ptr;
+
+        THEN("Reference count should be 0") {
+            REQUIRE(ptr.referenceCount() == 0);
+            REQUIRE(ptr.isEmpty());
+            REQUIRE(ptr.get() == nullptr);
+            REQUIRE(ptr == nullptr);
+            REQUIRE(!ptr);
+        }
+    }
+
+    WHEN("Copying and moving references") {
+        auto ptr = make_ref<Example>(allocator, 42, &destCount);
+
+        THEN("Reference count should increase after copy construction and assignment") {
+            auto copied = ptr;
+            REQUIRE(ptr.referenceCount() == 2);
+
+            ref_ptr<Example> assigned;
+            assigned = ptr;
+            REQUIRE(ptr.referenceCount() == 3);
+        }
+
+        THEN("Reference count should remain constant after self-assignment") {
+            auto &self = ptr;
+            ptr = self;
+            REQUIRE(ptr.referenceCount() == 1);
+        }
+
+        THEN("Reference count should remain constant after move construction and assignment") {
+            ref_ptr<Example> moved(atl::move(ptr));
+            REQUIRE(ptr.isEmpty());
+            REQUIRE(moved.referenceCount() == 1);
+
+            ref_ptr<Example> assigned;
+            assigned = atl::move(moved);
+            REQUIRE(moved.isEmpty());
+            REQUIRE(assigned.referenceCount() == 1);
+        }
+    }
+
+    WHEN("Releasing references") {
+        THEN("The object's destructor should be executed once (and only once) after the last reference is released") {
+            {
+                auto ptr = make_ref<Example>(allocator, 42, &destCount);
+                auto copied = ptr;
+
+                ptr.clear();
+                REQUIRE(ptr.isEmpty());
+                REQUIRE(destCount == 0);
+                REQUIRE(copied.referenceCount() == 1);
+            }
+
+            REQUIRE(destCount == 1);
+        }
+    }
+
+    /* Clean up */
+    delete allocator;
+}
+
+TEST_CASE("Intrusive References") {
+    test_ref_ptr<refcount::AtomicCount>();
+}
+
+TEST_CASE("Non-Atomic Intrusive References") {
+    test_ref_ptr<refcount::NonAtomicCount>();
+}
+
+PLCR_CPP_END_ASYNC_NS
@@ -15,13 +15,18 @@ void CancelPreviewGeneration (void *thisInterface, QLPreviewRequestRef preview);
 OSStatus GeneratePreviewForURL (void *thisInterface, QLPreviewRequestRef preview, CFURLRef url, CFStringRef contentTypeUTI, CFDictionaryRef options)
 {
     @autoreleasepool {
-        NSData *data = [NSData dataWithContentsOfURL: (__bridge NSURL *)url];
+        /* Map the report; with lazy decoding, records that are never formatted are never paged in */
+        NSData *data = [NSData dataWithContentsOfURL: (__bridge NSURL *)url options: NSDataReadingMappedIfSafe error: NULL];
         if (!data)
             return noErr;
         
-        PLCrashReport *report = [[PLCrashReport alloc] initWithData: data error: NULL];
+        PLCrashReport *report = [[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: NULL];
         if (!report)
             return noErr;
+
+        /* Formatting decodes the deferred thread and image records; skip it if the preview is no longer needed */
+        if (QLPreviewRequestIsCancelled(preview))
+            return noErr;
         
         NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report
                                                                 withTextFormat: PLCrashReportTextFormatiOS];
@@ -33,5 +38,5 @@ OSStatus GeneratePreviewForURL (void *thisInterface, QLPreviewRequestRef preview
 
 void CancelPreviewGeneration (void *thisInterface, QLPreviewRequestRef preview)
 {
-    // Implement only if supported
+    // Cancellation is polled via QLPreviewRequestIsCancelled()
 }
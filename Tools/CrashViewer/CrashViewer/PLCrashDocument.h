@@ -28,6 +28,14 @@
 
 #import <Cocoa/Cocoa.h>
 
+@class PLCrashReport;
+
 @interface PLCrashDocument : NSDocument
+
+/** The lazily decoded report, or nil if the document was read as text. The report's text is formatted by the window
+ * controller, off the main thread. */
+@property(nonatomic, strong) PLCrashReport *report;
+
+/** The report text, or nil if it has not yet been formatted. */
 @property(nonatomic, copy) NSString *reportText;
 @end
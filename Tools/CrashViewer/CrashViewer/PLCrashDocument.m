@@ -36,6 +36,12 @@
 
 @implementation PLCrashDocument
 
++ (BOOL) canConcurrentlyReadDocumentsOfType: (NSString *)typeName
+{
+    /* Reading does not touch any shared state; this allows a batch of documents to be read in parallel */
+    return YES;
+}
+
 - (void)makeWindowControllers
 {
     PLCrashWindowController *controller = [[PLCrashWindowController alloc] initWithWindowNibName: @"PLCrashWindow"];
@@ -46,13 +52,12 @@
 - (BOOL) readFromData: (NSData *)data ofType: (NSString *)typeName error: (__autoreleasing NSError **)outError
 {
     if ([typeName isEqual: @"PLCrash"]) {
-        PLCrashReport *report = [[PLCrashReport alloc] initWithData: data error: outError];
+        /* Thread and image records are decoded when the report is formatted */
+        PLCrashReport *report = [[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: outError];
         if (!report)
             return NO;
 
-        NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report
-                                                                withTextFormat: PLCrashReportTextFormatiOS];
-        self.reportText = text;
+        self.report = report;
         return YES;
     } else if ([typeName isEqual: @"com.apple.crashreport"] || [typeName isEqual: @"public.plain-text"]) {
         NSString *text = [[NSString alloc] initWithData: data encoding: NSUTF8StringEncoding];
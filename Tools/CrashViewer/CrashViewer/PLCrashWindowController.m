@@ -30,11 +30,14 @@
 #import "PLAsyncTask.h"
 #import "PLCrashDocument.h"
 #import "PLProgressIndicatorController.h"
+#import <CrashReporter/CrashReporter.h>
 
 @interface PLCrashWindowController ()
 /** The currently executing symbolication task, if any. */
 @property(nonatomic, retain) PLAsyncTask *symbolicationTask;
 
+@property(nonatomic, retain) NSOperation *formattingOperation;
+
 /** The progress wheel displayed in the window. Used on pre-10.10 systems. */
 @property(nonatomic, retain) NSProgressIndicator *indicator;
 
@@ -64,21 +67,121 @@
     [super windowDidLoad];
 
     self.textView.font = [NSFont fontWithName: @"Menlo" size: 12];
-    self.textView.string = [self.document reportText];
 
-    if (self.symbolicationCommand.length) {
+    if ([self.document reportText]) {
+        self.textView.string = [self.document reportText];
+        [self reportTextDidLoad];
+    } else {
+        self.textView.string = @"";
         [self addProgressIndicator];
-        [self startSymbolicatingCrash: [self.document reportText]];
+        [self startFormattingReport: [self.document report]];
     }
 }
 
 - (void) windowWillClose: (NSNotification *)notification
 {
     self.closing = YES;
+    [self.formattingOperation cancel];
     if (self.symbolicationTask)
         [self.symbolicationTask terminate];
 }
 
+- (void) reportTextDidLoad
+{
+    if (self.symbolicationCommand.length) {
+        [self addProgressIndicator];
+        [self startSymbolicatingCrash: [self.document reportText]];
+    }
+}
+
+/**
+ * Returns the queue on which reports are formatted. This is shared by all windows, so that opening a large batch of
+ * reports neither blocks the main thread nor starts more concurrent formatting work than there are processors.
+ */
++ (NSOperationQueue *) formattingQueue
+{
+    static NSOperationQueue *queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = [[NSOperationQueue alloc] init];
+        queue.name = @"coop.plausible.CrashViewer.formatting";
+        queue.maxConcurrentOperationCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    });
+    return queue;
+}
+
+/**
+ * Format @a report in the background. A summary of the crashed thread is displayed as soon as it has been decoded,
+ * and is replaced by the full report once the remaining threads and images have been decoded and formatted.
+ */
+- (void) startFormattingReport: (PLCrashReport *)report
+{
+    NSBlockOperation *operation = [[NSBlockOperation alloc] init];
+    __weak NSBlockOperation *weakOperation = operation;
+
+    [operation addExecutionBlock: ^{
+        /* With lazy decoding, this decodes only the crashed thread's record */
+        NSString *summary = [PLCrashWindowController crashedThreadSummaryForReport: report];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (self.closing || [self.document reportText])
+                return;
+            self.textView.string = summary;
+        });
+
+        if (weakOperation.isCancelled)
+            return;
+
+        NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report
+                                                                withTextFormat: PLCrashReportTextFormatiOS];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            self.formattingOperation = nil;
+            [self removeProgressIndicator];
+            if (self.closing)
+                return;
+
+            [self.document setReportText: text];
+            self.textView.string = text;
+            [self reportTextDidLoad];
+        });
+    }];
+
+    self.formattingOperation = operation;
+    [[PLCrashWindowController formattingQueue] addOperation: operation];
+}
+
+/**
+ * Returns a brief description of @a report's exception and crashed thread, for display while the full report is
+ * being formatted.
+ */
++ (NSString *) crashedThreadSummaryForReport: (PLCrashReport *)report
+{
+    NSMutableString *summary = [NSMutableString string];
+
+    if (report.exceptionInfo)
+        [summary appendFormat: @"Application Specific Information:\n*** Terminating app due to uncaught exception '%@', reason: '%@'\n\n",
+            report.exceptionInfo.exceptionName, report.exceptionInfo.exceptionReason];
+
+    [summary appendFormat: @"Exception Type:  %@\nException Codes: %@ at 0x%" PRIx64 "\n",
+        report.signalInfo.name, report.signalInfo.code, report.signalInfo.address];
+
+    PLCrashReportThreadInfo *thread = report.crashedThread;
+    if (thread) {
+        [summary appendFormat: @"\nThread %ld Crashed:\n", (long) thread.threadNumber];
+        NSUInteger frameIndex = 0;
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+            if (frame.symbolInfo)
+                [summary appendFormat: @"%-4lu0x%016" PRIx64 " %@ + %" PRIu64 "\n", (unsigned long) frameIndex, frame.instructionPointer,
+                    frame.symbolInfo.symbolName, frame.instructionPointer - frame.symbolInfo.startAddress];
+            else
+                [summary appendFormat: @"%-4lu0x%016" PRIx64 "\n", (unsigned long) frameIndex, frame.instructionPointer];
+            frameIndex++;
+        }
+    }
+
+    [summary appendString: @"\nFormatting the remaining threads and binary images...\n"];
+    return summary;
+}
+
 /** The command to execute to symbolicate a crash log. This may be nil. */
 - (NSString *) symbolicationCommand
 {